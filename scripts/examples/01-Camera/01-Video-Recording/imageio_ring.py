@@ -0,0 +1,54 @@
+# This work is licensed under the MIT license.
+# Copyright (c) 2013-2023 OpenMV LLC. All rights reserved.
+# https://github.com/openmv/openmv/blob/master/LICENSE
+#
+# Image Ring Stream Pre-Trigger Recording Example
+#
+# Note: You will need an SD card to run this example.
+#
+# This example shows how to use a ring ImageIO stream to keep the last few seconds of
+# compressed video in memory. Once something happens the frames before the event are
+# saved to an image stream file and recording continues to the same file.
+# Note: While this should work on any board, the board should have an SDRAM to be of any use.
+import sensor
+import image
+import time
+import random
+
+# Number of frames to keep before the event and to record after it.
+PRE_FRAMES = 60
+POST_FRAMES = 200
+
+sensor.reset()  # Reset and initialize the sensor.
+sensor.set_pixformat(sensor.RGB565)  # Set pixel format to RGB565 (or GRAYSCALE)
+sensor.set_framesize(sensor.QVGA)  # Set frame size to QVGA (320x240)
+sensor.skip_frames(time=2000)
+
+# The ring holds the last PRE_FRAMES JPEG frames, overwriting the oldest frame when full.
+ring = image.ImageIO((320, 240, sensor.JPEG), PRE_FRAMES, ring=True)
+
+clock = time.clock()
+
+while True:
+    last = None
+    while True:
+        clock.tick()
+        img = sensor.snapshot()
+        # Trigger on a large change of the average brightness.
+        mean = img.get_statistics().l_mean()
+        ring.write(img.compress(quality=90))
+        print(clock.fps())
+        if last is not None and abs(mean - last) > 20:
+            break
+        last = mean
+
+    stream = image.ImageIO("/ring-%d.bin" % random.getrandbits(32), "w")
+    ring.save(stream)  # The frames before the event.
+
+    for i in range(POST_FRAMES):
+        clock.tick()
+        stream.write(sensor.snapshot().compress(quality=90))
+        print(clock.fps())
+
+    stream.close()
+    print("Restarting...")
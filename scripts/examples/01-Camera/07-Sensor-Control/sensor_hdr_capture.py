@@ -0,0 +1,27 @@
+# This work is licensed under the MIT license.
+# Copyright (c) 2013-2023 OpenMV LLC. All rights reserved.
+# https://github.com/openmv/openmv/blob/master/LICENSE
+#
+# Sensor HDR Capture Example
+#
+# This example shows off capturing bracketed exposures and fusing them on-device
+# into one image that keeps detail in both the shadows and the highlights.
+
+import sensor
+import time
+
+sensor.reset()  # Reset and initialize the sensor.
+sensor.set_pixformat(sensor.RGB565)  # Set pixel format to RGB565 (or GRAYSCALE)
+sensor.set_framesize(sensor.QVGA)  # Set frame size to QVGA (320x240)
+sensor.skip_frames(time=2000)  # Wait for settings take effect.
+clock = time.clock()  # Create a clock object to track the FPS.
+
+# Bracket around the exposure auto exposure settled on.
+exposure_us = sensor.get_exposure_us()
+exposures = [exposure_us // 4, exposure_us, exposure_us * 4]
+
+while True:
+    clock.tick()  # Update the FPS clock.
+    # Increase latency if the sensor takes more than one frame to apply a new exposure.
+    img = sensor.snapshot_hdr(exposures, latency=1)
+    print(clock.fps())
@@ -0,0 +1,30 @@
+# This work is licensed under the MIT license.
+# Copyright (c) 2013-2023 OpenMV LLC. All rights reserved.
+# https://github.com/openmv/openmv/blob/master/LICENSE
+#
+# Dual Output Example
+#
+# This example shows off capturing a full resolution frame together with a decimated
+# copy for processing from the same sensor readout. The copy is written line by line
+# during capture so no scale() pass or frame size switch is needed.
+
+import sensor
+import time
+
+sensor.reset()  # Reset and initialize the sensor.
+sensor.set_pixformat(sensor.GRAYSCALE)  # Set pixel format to GRAYSCALE (or RGB565)
+sensor.set_framesize(sensor.VGA)  # Set frame size to VGA (640x480)
+sensor.skip_frames(time=2000)  # Wait for settings take effect.
+clock = time.clock()  # Create a clock object to track the FPS.
+
+# Also capture an 80x60 copy of every frame.
+sensor.set_dual_output(8)
+
+while True:
+    clock.tick()  # Update the FPS clock.
+    img = sensor.snapshot()  # Take a picture and return the full resolution image.
+    small = sensor.get_dual_fb()  # The decimated copy of the same frame.
+    blobs = small.find_blobs([(200, 255)], pixels_threshold=4)
+    for b in blobs:
+        img.draw_rectangle([v * 8 for v in b.rect()], color=255)
+    print(len(blobs), clock.fps())
@@ -0,0 +1,43 @@
+# This work is licensed under the MIT license.
+# Copyright (c) 2013-2023 OpenMV LLC. All rights reserved.
+# https://github.com/openmv/openmv/blob/master/LICENSE
+#
+# Batch Drawing
+#
+# This example shows off drawing many primitives with one draw_batch() call. Each primitive
+# is a (type, ...) tuple taking the same positional arguments as the matching draw method,
+# which is much cheaper than calling the draw methods one at a time for large overlays.
+
+import sensor
+import image
+import time
+from random import randint
+
+sensor.reset()
+sensor.set_pixformat(sensor.RGB565)  # or GRAYSCALE...
+sensor.set_framesize(sensor.QVGA)  # or QQVGA...
+sensor.skip_frames(time=2000)
+clock = time.clock()
+
+while True:
+    clock.tick()
+
+    img = sensor.snapshot()
+
+    batch = []
+    for i in range(50):
+        x = randint(0, img.width() - 1)
+        y = randint(0, img.height() - 1)
+        color = (randint(128, 255), randint(128, 255), randint(128, 255))
+
+        # (DRAW_RECTANGLE, x, y, w, h, [color, [thickness, [fill]]])
+        batch.append((image.DRAW_RECTANGLE, x - 10, y - 10, 20, 20, color))
+        # (DRAW_CROSS, x, y, [color, [size, [thickness]]])
+        batch.append((image.DRAW_CROSS, x, y, color, 5))
+        # (DRAW_STRING, x, y, text, [color, [scale]])
+        batch.append((image.DRAW_STRING, x - 10, y - 22, str(i), color))
+
+    # Primitives without a color or thickness use the ones passed to draw_batch().
+    img.draw_batch(batch, color=(255, 255, 255), thickness=1)
+
+    print(clock.fps())
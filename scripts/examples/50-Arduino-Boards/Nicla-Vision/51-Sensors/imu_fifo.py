@@ -0,0 +1,27 @@
+# This work is licensed under the MIT license.
+# Copyright (c) 2013-2023 OpenMV LLC. All rights reserved.
+# https://github.com/openmv/openmv/blob/master/LICENSE
+#
+# IMU FIFO Example
+#
+# This example shows off reading the IMU samples taken while each frame was exposed. The IMU
+# batches samples in its FIFO so the script only needs to read them once per frame.
+
+import sensor
+import imu
+
+sensor.reset()  # Reset and initialize the sensor.
+sensor.set_pixformat(sensor.GRAYSCALE)  # Set pixel format to GRAYSCALE (or RGB565)
+sensor.set_framesize(sensor.QVGA)  # Set frame size to QVGA (320x240)
+sensor.skip_frames(time=2000)  # Wait for settings take effect.
+
+imu.fifo_enable(True, rate=833)  # Accelerometer and gyro samples at 833 Hz.
+
+while True:
+    img = sensor.snapshot()
+    info = img.frame_info()
+    # Samples are (timestamp_us, (x, y, z) mg, (x, y, z) mdps), timestamps use the same
+    # clock as the frame timestamps.
+    samples = imu.fifo_read(info["sof_us"], info["eof_us"])
+    if samples:
+        print(len(samples), samples[-1][2])
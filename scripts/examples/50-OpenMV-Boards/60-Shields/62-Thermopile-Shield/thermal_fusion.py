@@ -0,0 +1,51 @@
+# This work is licensed under the MIT license.
+# Copyright (c) 2013-2024 OpenMV LLC. All rights reserved.
+# https://github.com/openmv/openmv/blob/master/LICENSE
+#
+# Thermal Fusion Demo
+#
+# This example shows off how to fuse the thermal image with the main camera's
+# video in one pass. The registration maps camera pixels to thermal pixels and
+# is computed once, here from the field of view ratio of the two sensors.
+
+import sensor
+import image
+import time
+import fir
+
+# Field of view of the camera relative to the thermal sensor and the camera
+# position of the thermal image's top-left corner, measure these for your setup.
+SCALE = 0.8
+X_OFFSET = 0
+Y_OFFSET = 0
+
+sensor.reset()
+sensor.set_pixformat(sensor.RGB565)
+sensor.set_framesize(sensor.QQVGA)
+sensor.skip_frames(time=2000)
+
+# Initialize the thermal sensor
+fir.init()
+w, h = fir.width(), fir.height()
+
+# Camera to thermal pixel mapping (2x3 affine matrix).
+s = min(w / sensor.width(), h / sensor.height()) * SCALE
+registration = [[s, 0, -X_OFFSET * s], [0, s, -Y_OFFSET * s]]
+
+# FPS clock
+clock = time.clock()
+
+while True:
+    clock.tick()
+
+    img = sensor.snapshot()
+
+    try:
+        ir = fir.snapshot(pixformat=sensor.GRAYSCALE)
+    except OSError:
+        continue
+
+    img.fuse(ir, registration, alpha=128, color_palette=image.PALETTE_IRONBOW)
+
+    # Print FPS.
+    print(clock.fps())
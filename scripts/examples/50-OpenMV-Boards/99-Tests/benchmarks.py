@@ -0,0 +1,83 @@
+# This work is licensed under the MIT license.
+# Copyright (c) 2013-2023 OpenMV LLC. All rights reserved.
+# https://github.com/openmv/openmv/blob/master/LICENSE
+#
+# OpenMV Benchmarks.
+#
+# Runs each kernel in unittest/benchmark on every resolution and pixel format it
+# supports and prints one JSON object per line with the average ms/frame and the
+# fb_alloc high-water mark. Use tools/pyopenmv_benchmark.py to collect the results.
+#
+import os
+import gc
+import omv
+import json
+import time
+import image
+
+TEST_DIR = "unittest"
+BENCH_DIR = "unittest/benchmark"
+DATA_DIR = "unittest/data"
+ITERATIONS = 10
+
+ALL_RESOLUTIONS = {"QQVGA": (160, 120), "QVGA": (320, 240), "VGA": (640, 480)}
+ALL_PIXFORMATS = {"GRAYSCALE": image.GRAYSCALE, "RGB565": image.RGB565}
+
+if not (TEST_DIR in os.listdir("") and "benchmark" in os.listdir(TEST_DIR)):
+    raise Exception("Benchmark dir not found!")
+
+
+def run_benchmark(test, resolution, pixformat):
+    result = {
+        "board": omv.board_type(),
+        "firmware": omv.version_string(),
+        "test": test[:-3],
+        "resolution": resolution,
+        "pixformat": pixformat,
+    }
+    try:
+        w, h = ALL_RESOLUTIONS[resolution]
+        gc.collect()
+        src = image.Image("/".join((DATA_DIR, SOURCE)))
+        total_us = 0
+        peak = 0
+        for i in range(ITERATIONS):
+            img = image.Image(w, h, ALL_PIXFORMATS[pixformat], copy_to_fb=True)
+            img.draw_image(src, 0, 0, x_scale=w / src.width(), y_scale=h / src.height())
+            args = setup(img)
+            omv.fb_alloc_peak(reset=True)
+            start = time.ticks_us()
+            benchmark(args)
+            total_us += time.ticks_diff(time.ticks_us(), start)
+            peak = max(peak, omv.fb_alloc_peak())
+            args = None
+            gc.collect()
+        result["status"] = "PASSED"
+        result["ms"] = total_us / (ITERATIONS * 1000)
+        result["fb_alloc_peak"] = peak
+    except Exception as e:
+        result["status"] = "DISABLED" if "unavailable" in str(e) else "SKIPPED"
+        result["error"] = str(e)
+    return result
+
+
+# Don't let IDE frame buffer compression skew the timings.
+omv.disable_fb(True)
+
+for test in sorted(os.listdir(BENCH_DIR)):
+    if test.endswith(".py"):
+        # Defaults, overridden by the benchmark script.
+        SOURCE = "blobs.ppm"
+        RESOLUTIONS = tuple(sorted(ALL_RESOLUTIONS))
+        PIXFORMATS = tuple(sorted(ALL_PIXFORMATS))
+
+        def setup(img):
+            return img
+
+        exec(open("/".join((BENCH_DIR, test))).read())
+        for resolution in RESOLUTIONS:
+            for pixformat in PIXFORMATS:
+                print(json.dumps(run_benchmark(test, resolution, pixformat)))
+
+omv.disable_fb(False)
+print("\nAll benchmarks done.\n\n")
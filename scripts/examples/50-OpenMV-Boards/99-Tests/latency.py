@@ -0,0 +1,112 @@
+# This work is licensed under the MIT license.
+# Copyright (c) 2013-2023 OpenMV LLC. All rights reserved.
+# https://github.com/openmv/openmv/blob/master/LICENSE
+#
+# Glass-to-Glass Latency Test.
+#
+# Turns on an LED that the camera can see (an external LED on a pin, or the board LED
+# pointed at with a mirror), waits for the frame that shows it, sends the frame to the
+# output and prints one JSON object per line with the times relative to the LED turning
+# on. Frame times come from the frame metadata (see image.get_frame_info()). Use
+# tools/pyopenmv_latency.py to collect the results and compute the latency distributions.
+#
+import omv
+import json
+import time
+import random
+import sensor
+import machine
+
+FRAMESIZE = "QVGA"
+PIXFORMAT = "GRAYSCALE"
+OUTPUT = "ide"  # "none", "ide" (frame buffer to the IDE over USB) or "display" (SPI LCD).
+LED = "LED_BLUE"  # Board LED name, or None to use PIN.
+PIN = "P0"  # Pin driving an external LED.
+ROI = None  # Area that the LED lights up, None for the whole frame.
+THRESHOLD = 16  # Mean brightness increase for a frame to count as lit.
+SAMPLES = 100
+TIMEOUT_MS = 1000  # Per sample.
+
+sensor.reset()
+sensor.set_framesize(getattr(sensor, FRAMESIZE))
+sensor.set_pixformat(getattr(sensor, PIXFORMAT))
+sensor.skip_frames(time=2000)
+# The LED must not change the exposure.
+sensor.set_auto_gain(False)
+sensor.set_auto_exposure(False)
+sensor.set_auto_whitebal(False)
+
+if LED:
+    light = machine.LED(LED)
+else:
+    light = machine.Pin(PIN, machine.Pin.OUT)
+
+lcd = None
+if OUTPUT == "display":
+    import display
+
+    lcd = display.SPIDisplay()
+
+
+def output(img):
+    if OUTPUT == "ide":
+        img.flush()
+    elif lcd:
+        lcd.write(img)
+
+
+def mean(img):
+    return img.get_statistics(roi=ROI).l_mean() if ROI else img.get_statistics().l_mean()
+
+
+def wait_for(lit, level, t0):
+    frames = 0
+    while time.ticks_diff(time.ticks_ms(), t0) < TIMEOUT_MS:
+        img = sensor.snapshot()
+        frames += 1
+        if (mean(img) >= level) == lit:
+            return img, frames
+    return None, frames
+
+
+light.off()
+level = sum(mean(sensor.snapshot()) for i in range(10)) / 10 + THRESHOLD
+
+for i in range(SAMPLES):
+    # Decorrelate the LED from the frame timing.
+    time.sleep_us(random.randint(0, 50000))
+
+    light.on()
+    t0 = time.ticks_us()
+    img, frames = wait_for(True, level, time.ticks_ms())
+    t_detect = time.ticks_us()
+
+    result = {
+        "board": omv.board_type(),
+        "firmware": omv.version_string(),
+        "framesize": FRAMESIZE,
+        "pixformat": PIXFORMAT,
+        "output": OUTPUT,
+        "sample": i,
+        "frames": frames,
+    }
+
+    if img is None:
+        result["status"] = "TIMEOUT"
+    else:
+        info = img.get_frame_info()
+        output(img)
+        t_output = time.ticks_us()
+        result["status"] = "OK"
+        result["exposure_us"] = info["exposure_us"]
+        result["sof_us"] = time.ticks_diff(info["sof_us"], t0)
+        result["eof_us"] = time.ticks_diff(info["eof_us"], t0)
+        result["detect_us"] = time.ticks_diff(t_detect, t0)
+        result["output_us"] = time.ticks_diff(t_output, t0)
+
+    print(json.dumps(result))
+
+    light.off()
+    wait_for(False, level, time.ticks_ms())
+
+print("All samples done.")
@@ -0,0 +1,108 @@
+# This work is licensed under the MIT license.
+# Copyright (c) 2013-2023 OpenMV LLC. All rights reserved.
+# https://github.com/openmv/openmv/blob/master/LICENSE
+#
+# OpenMV Performance Regression Suite.
+#
+# Plays the recorded ImageIO datasets in unittest/data through each pipeline in
+# unittest/perf and prints one JSON object per line with the per-stage times, the
+# profiler stats (if enabled) and the fb_alloc and heap high-water marks. Datasets
+# are recorded with the ImageIO examples, MJPEG datasets are decoded to PIXFORMAT.
+# Use tools/pyopenmv_perf.py to collect the results and compare them to a baseline.
+#
+import os
+import gc
+import omv
+import json
+import time
+import image
+
+TEST_DIR = "unittest"
+PERF_DIR = "unittest/perf"
+DATA_DIR = "unittest/data"
+FRAMES = 100  # Max frames per dataset.
+
+if not (TEST_DIR in os.listdir("") and "perf" in os.listdir(TEST_DIR)):
+    raise Exception("Perf dir not found!")
+
+
+def profile(reset=False):
+    try:
+        return omv.profile(reset=reset)
+    except Exception:
+        return {}
+
+
+def run_pipeline(test):
+    result = {
+        "board": omv.board_type(),
+        "firmware": omv.version_string(),
+        "test": test[:-3],
+        "dataset": DATASET,
+    }
+    try:
+        if DATASET not in os.listdir(DATA_DIR):
+            raise Exception("Dataset unavailable")
+        gc.collect()
+        setup()
+        stream = image.ImageIO("/".join((DATA_DIR, DATASET)), "r")
+        pixformat = getattr(image, PIXFORMAT) if PIXFORMAT else None
+        stages = {}
+        last = [0]
+
+        def mark(name):
+            now = time.ticks_us()
+            us = time.ticks_diff(now, last[0])
+            s = stages.setdefault(name, [0, us, us])
+            s[0] += us
+            s[1] = min(s[1], us)
+            s[2] = max(s[2], us)
+            last[0] = time.ticks_us()
+
+        omv.fb_alloc_peak(reset=True)
+        omv.umm_stats(reset=True)
+        profile(reset=True)
+        frames = 0
+        while frames < FRAMES:
+            last[0] = time.ticks_us()
+            if pixformat is None:
+                img = stream.read(loop=False, pause=False)
+            else:
+                img = stream.read(loop=False, pause=False, pixformat=pixformat)
+            if img is None:
+                break
+            mark("read")
+            pipeline(img, mark)
+            frames += 1
+        stream.close()
+
+        if not frames:
+            raise Exception("Empty dataset")
+        result["status"] = "PASSED"
+        result["frames"] = frames
+        # {stage: (mean_ms, min_ms, max_ms)}
+        result["stages"] = {k: (v[0] / (frames * 1000), v[1] / 1000, v[2] / 1000) for k, v in stages.items()}
+        result["ms"] = sum(v[0] for v in stages.values()) / (frames * 1000)
+        # {name: (count, avg_us, max_us)} of the profiled functions that ran.
+        result["profile"] = {k: (v[0], v[2], v[3]) for k, v in profile().items() if v[0]}
+        result["fb_alloc_peak"] = omv.fb_alloc_peak()
+        result["heap_peak"] = omv.umm_stats()[2]
+    except Exception as e:
+        result["status"] = "DISABLED" if "unavailable" in str(e) else "SKIPPED"
+        result["error"] = str(e)
+    return result
+
+
+for test in sorted(os.listdir(PERF_DIR)):
+    if test.endswith(".py"):
+        # Defaults, overridden by the pipeline script.
+        PIXFORMAT = None
+
+        def setup():
+            pass
+
+        exec(open("/".join((PERF_DIR, test))).read())
+        print(json.dumps(run_pipeline(test)))
+        gc.collect()
+
+print("\nAll pipelines done.\n\n")
@@ -13,6 +13,11 @@ import socket
 import struct
 import time
 
+try:
+    import _rpc
+except ImportError:
+    _rpc = None
+
 
 class rpc:
     _COMMAND_HEADER_PACKET_MAGIC = 0x1209
@@ -70,7 +75,9 @@ class rpc:
 
     def __init__(self):  # private
         self.__crc_16 = self.__def_crc_16
-        if omv.board_type() == "H7":
+        if _rpc is not None:
+            self.__crc_16 = _rpc.crc16
+        elif omv.board_type() == "H7":
             import stm
             stm.mem32[stm.RCC + stm.RCC_AHB4ENR] = stm.mem32[stm.RCC + stm.RCC_AHB4ENR] | (1 << 19)
             stm.mem32[stm.CRC + stm.CRC_POL] = 0x1021
@@ -89,6 +96,10 @@ class rpc:
     def _get_packet(self, magic_value, payload_buf_tuple, timeout):  # private
         packet = self.get_bytes(payload_buf_tuple[0], timeout)
         if packet is not None:
+            if _rpc is not None:
+                if _rpc.check_packet(magic_value, packet):
+                    return payload_buf_tuple[1]
+                return None
             magic = packet[0] | (packet[1] << 8)
             crc = packet[-2] | (packet[-1] << 8)
             if magic == magic_value and crc == self.__crc_16(packet, len(packet) - 2):
@@ -96,6 +107,8 @@ class rpc:
         return None
 
     def _set_packet(self, magic_value, payload=bytes()):  # private
+        if _rpc is not None:
+            return _rpc.set_packet(magic_value, payload)
         new_payload = bytearray(len(payload) + 4)
         new_payload[:2] = struct.pack("<H", magic_value)
         new_payload[2:-2] = payload
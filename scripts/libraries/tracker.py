@@ -0,0 +1,117 @@
+"""
+Tracking-by-detection for the image find_* detectors (find_apriltags, find_qrcodes,
+find_datamatrices and find_barcodes).
+
+Each frame the detector only runs on ROIs predicted from the last frame's detections.
+A full-frame scan runs every `full_scan` frames, when nothing is tracked, or when a
+tracked target is missed. With motion=True the ROIs are shifted by the global motion
+between frames (image.find_displacement() on a small grayscale copy of the frame).
+
+Example:
+import sensor
+from tracker import Tracker
+tracker = Tracker("find_apriltags", full_scan=10)
+while True:
+    img = sensor.snapshot()
+    for tag in tracker.find(img):
+        img.draw_rectangle(tag.rect())
+"""
+
+import image
+
+
+def _key(obj):
+    # Something that identifies the same target across frames.
+    for attr in ("id", "payload"):
+        if hasattr(obj, attr):
+            return getattr(obj, attr)()
+    return None
+
+
+class Tracker:
+    def __init__(self, method, full_scan=10, margin=0.5, min_size=32, motion=False, **kwargs):
+        self._method = method
+        self._full_scan = full_scan
+        self._margin = margin
+        self._min_size = min_size
+        self._motion = motion
+        self._kwargs = kwargs
+        self._frame = 0
+        self._tracks = []  # (key, rect, dx, dy)
+        self._prev = None
+        self.full_scans = 0
+
+    def _scan(self, img, roi=None):
+        find = getattr(img, self._method)
+        if roi is None:
+            self.full_scans += 1
+            return find(**self._kwargs)
+        return find(roi=roi, **self._kwargs)
+
+    def _global_motion(self, img):
+        if not self._motion:
+            return 0, 0
+        scale = 4
+        small = img.to_grayscale(x_scale=1 / scale, y_scale=1 / scale, hint=image.AREA, copy=True)
+        prev, self._prev = self._prev, small
+        if prev is None or prev.width() != small.width() or prev.height() != small.height():
+            return 0, 0
+        d = small.find_displacement(prev)
+        if d.response() < 0.1:
+            return 0, 0
+        return d.x_translation() * scale, d.y_translation() * scale
+
+    def _predict(self, img, track, gx, gy):
+        key, (x, y, w, h), dx, dy = track
+        mx = max(int(w * self._margin), (self._min_size - w) // 2, 0)
+        my = max(int(h * self._margin), (self._min_size - h) // 2, 0)
+        x = int(x + dx + gx) - mx
+        y = int(y + dy + gy) - my
+        x0, y0 = max(x, 0), max(y, 0)
+        x1, y1 = min(x + w + (2 * mx), img.width()), min(y + h + (2 * my), img.height())
+        if x1 <= x0 or y1 <= y0:
+            return None
+        return (x0, y0, x1 - x0, y1 - y0)
+
+    def reset(self):
+        self._tracks = []
+        self._prev = None
+
+    def find(self, img):
+        gx, gy = self._global_motion(img)
+        full = (not self._tracks) or (self._full_scan and (self._frame % self._full_scan) == 0)
+        self._frame += 1
+
+        results = []
+        if not full:
+            for track in self._tracks:
+                roi = self._predict(img, track, gx, gy)
+                found = None
+                if roi is not None:
+                    for obj in self._scan(img, roi):
+                        if _key(obj) == track[0]:
+                            found = obj
+                            break
+                if found is None:
+                    # Lost it (or something new may have appeared), rescan the frame.
+                    full = True
+                    break
+                if not any(_key(r) == track[0] and r.rect() == found.rect() for r in results):
+                    results.append(found)
+
+        if full:
+            results = self._scan(img)
+
+        # Update the tracks with the per-target velocity.
+        tracks = []
+        for obj in results:
+            key, rect = _key(obj), obj.rect()
+            dx = dy = 0
+            for t in self._tracks:
+                if t[0] == key:
+                    dx = (rect[0] + rect[2] / 2) - (t[1][0] + t[1][2] / 2) - gx
+                    dy = (rect[1] + rect[3] / 2) - (t[1][1] + t[1][3] / 2) - gy
+                    break
+            tracks.append((key, rect, dx, dy))
+        self._tracks = tracks
+        return results
@@ -0,0 +1,2 @@
+def benchmark(img):
+    img.mean(1)
@@ -0,0 +1,2 @@
+def benchmark(img):
+    img.gaussian(1)
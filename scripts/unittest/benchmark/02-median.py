@@ -0,0 +1,2 @@
+def benchmark(img):
+    img.median(1)
@@ -0,0 +1,2 @@
+def benchmark(img):
+    img.erode(1)
@@ -0,0 +1,5 @@
+def benchmark(img):
+    thresholds = [(0, 100, 56, 95, 41, 74),  # generic_red_thresholds
+                  (0, 100, -128, -22, -128, 99),  # generic_green_thresholds
+                  (0, 100, -128, 98, -128, -16)]     # generic_blue_thresholds
+    img.find_blobs(thresholds, pixels_threshold=200, area_threshold=200)
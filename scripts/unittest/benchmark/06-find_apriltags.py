@@ -0,0 +1,7 @@
+SOURCE = "apriltags.pgm"
+PIXFORMATS = ("GRAYSCALE",)
+RESOLUTIONS = ("QQVGA", "QVGA")
+
+
+def benchmark(img):
+    img.find_apriltags()
@@ -0,0 +1,6 @@
+SOURCE = "qrcode.pgm"
+PIXFORMATS = ("GRAYSCALE",)
+
+
+def benchmark(img):
+    img.find_qrcodes()
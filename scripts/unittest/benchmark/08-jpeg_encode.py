@@ -0,0 +1,2 @@
+def benchmark(img):
+    img.to_jpeg(quality=90)
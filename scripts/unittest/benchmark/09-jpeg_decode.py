@@ -0,0 +1,6 @@
+def setup(img):
+    return img.to_jpeg(quality=90, copy=True)
+
+
+def benchmark(jpg):
+    jpg.to_rgb565(copy=True)
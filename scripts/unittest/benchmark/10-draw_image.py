@@ -0,0 +1,8 @@
+def setup(img):
+    return (img, img.copy(x_scale=0.5, y_scale=0.5))
+
+
+def benchmark(args):
+    import image
+    img, small = args
+    img.draw_image(small, 0, 0, x_scale=2.0, y_scale=2.0, hint=image.BILINEAR)
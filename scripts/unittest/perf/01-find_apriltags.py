@@ -0,0 +1,10 @@
+DATASET = "apriltags.bin"
+PIXFORMAT = "GRAYSCALE"
+
+
+def pipeline(img, mark):
+    tags = img.find_apriltags()
+    mark("find_apriltags")
+    for tag in tags:
+        img.draw_rectangle(tag.rect())
+    mark("draw")
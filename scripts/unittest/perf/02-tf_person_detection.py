@@ -0,0 +1,17 @@
+DATASET = "people.bin"
+PIXFORMAT = "GRAYSCALE"
+MODEL = "person_detection.tflite"  # Copy the model to the camera's storage.
+
+
+def setup():
+    global net
+    import tf
+
+    net = tf.Model(MODEL, load_to_fb=True)
+
+
+def pipeline(img, mark):
+    person = net.predict(img)[-1]
+    mark("predict")
+    img.draw_string(0, 0, "%.2f" % person)
+    mark("draw")
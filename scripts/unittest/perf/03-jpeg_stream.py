@@ -0,0 +1,8 @@
+DATASET = "stream.bin"
+
+
+def pipeline(img, mark):
+    jpg = img.to_jpeg(quality=90)
+    mark("to_jpeg")
+    jpg.flush()
+    mark("flush")
@@ -8,4 +8,8 @@ def unittest(data_path, temp_path):
 
     # Find objects
     objects = img.find_features(cascade, threshold=0.75, scale_factor=1.25)
-    return (objects and objects[0] == (189, 53, 88, 88) and objects[1] == (12, 11, 107, 107))
+
+    # A shared pyramid must find the same objects
+    pyramid = img.pyramid(levels=8, scale_factor=1.25)
+    shared = img.find_features(cascade, threshold=0.75, scale_factor=1.25, pyramid=pyramid)
+    return (objects and objects[0] == (189, 53, 88, 88) and objects[1] == (12, 11, 107, 107) and shared == objects)
@@ -0,0 +1,10 @@
+def unittest(data_path, temp_path):
+    import image
+    # Chained filters run band by band must match filtering the whole image.
+    ref = image.Image("unittest/data/blobs.ppm", copy_to_fb=True).to_grayscale()
+    ref.mean(1).erode(1)
+    img = image.Image("unittest/data/blobs.ppm").to_grayscale()
+    img.chain(lambda band: band.mean(1).erode(1), radius=2, rows=8)
+    img.difference(ref)
+    stats = img.get_statistics()
+    return (stats.max() == 0) and (stats.min() == 0)
@@ -0,0 +1,19 @@
+def unittest(data_path, temp_path):
+    import image
+    e = 0.0000001
+    img = image.Image("unittest/data/blobs.ppm", copy_to_fb=True)
+    cache = img.get_histogram_cache(tile=16)
+
+    for roi in ((0, 0, 320, 240), (5, 7, 100, 50), (30, 40, 8, 8), (300, 200, 20, 40)):
+        hist1 = img.get_histogram(roi=roi)
+        hist2 = cache.get_histogram(roi=roi)
+        for bins1, bins2 in ((hist1.l_bins(), hist2.l_bins()),
+                             (hist1.a_bins(), hist2.a_bins()),
+                             (hist1.b_bins(), hist2.b_bins())):
+            for a, b in zip(bins1, bins2):
+                if abs(a - b) > e:
+                    return False
+        if img.get_statistics(roi=roi)[0:] != cache.get_statistics(roi=roi)[0:]:
+            return False
+
+    return True
@@ -0,0 +1,10 @@
+def unittest(data_path, temp_path):
+    import image
+    # A pipeline must match running its operators over the whole image.
+    ref = image.Image("unittest/data/blobs.ppm", copy_to_fb=True).to_grayscale()
+    ref.median(1).mean(2).open(1)
+    img = image.Image("unittest/data/blobs.ppm").to_grayscale()
+    image.Pipeline([("median", 1), ("mean", 2), ("open", 1)], rows=8).run(img)
+    img.difference(ref)
+    stats = img.get_statistics()
+    return (stats.max() == 0) and (stats.min() == 0)
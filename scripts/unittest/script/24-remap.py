@@ -0,0 +1,12 @@
+def unittest(data_path, temp_path):
+    import image
+    # The default rotation correction is the identity (up to float rounding in its matrix
+    # inverse), composing with it must not change a map.
+    ref = image.Image("unittest/data/blobs.ppm", copy_to_fb=True).to_grayscale()
+    lens = ref.lens_corr_map(strength=1.8)
+    both = lens.compose(ref.rotation_corr_map())
+    ref.remap(lens)
+    img = image.Image("unittest/data/blobs.ppm").to_grayscale()
+    img.remap(both)
+    img.difference(ref)
+    return img.get_statistics().max() <= 1
@@ -0,0 +1,11 @@
+def unittest(data_path, temp_path):
+    import image
+    # The fused ISP pass must match running ccm() and gamma() one after the other.
+    ccm = [[1.2, -0.1, -0.1], [-0.1, 1.1, 0.0], [0.0, -0.2, 1.2]]
+    ref = image.Image("unittest/data/blobs.ppm", copy_to_fb=True)
+    ref.ccm(ccm).gamma(gamma=2.2, contrast=1.1)
+    img = image.Image("unittest/data/blobs.ppm")
+    stats = img.isp(ccm=ccm, gamma=2.2, contrast=1.1)
+    img.difference(ref)
+    diff = img.get_statistics()
+    return (diff.max() == 0) and (len(stats) == 3)
@@ -0,0 +1,19 @@
+def unittest(data_path, temp_path):
+    import image
+    # A pipeline must match running its operators over the whole image, also for binary images.
+    ref = image.Image("unittest/data/blobs.ppm", copy_to_fb=True).to_grayscale().to_bitmap()
+    ref.mode(1).midpoint(1).dilate(1)
+    img = image.Image("unittest/data/blobs.ppm").to_grayscale().to_bitmap()
+    image.Pipeline([("mode", 1), ("midpoint", 1), ("dilate", 1)], rows=1).run(img)
+    img.difference(ref)
+    stats = img.get_statistics()
+    if (stats.max() != 0) or (stats.min() != 0):
+        return False
+    # Midpoint results must not depend on the band the pixels are in.
+    ref = image.Image("unittest/data/blobs.ppm", copy_to_fb=True).to_grayscale()
+    ref.midpoint(1, bias=0.5)
+    img = image.Image("unittest/data/blobs.ppm").to_grayscale()
+    image.Pipeline([("midpoint", 1, 0.5)], rows=4).run(img)
+    img.difference(ref)
+    stats = img.get_statistics()
+    return (stats.max() == 0) and (stats.min() == 0)
@@ -170,6 +170,7 @@ uint8_t  USBD_CDC_TransmitPacket     (USBD_HandleTypeDef *pdev);
 
 uint8_t  USBD_VCP_Connected      (void);
 uint8_t  USBD_IDE_Connected      (void);
+void     CDC_Process             (void);
 
 /**
   * @}
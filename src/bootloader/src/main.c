@@ -27,6 +27,16 @@ void __flash_led() {
     HAL_Delay(100);
 }
 
+// Processes the received commands while waiting, toggles the LED at the same rate as above.
+static void __process_flash_led() {
+    static uint32_t ticks = 0;
+    CDC_Process();
+    if ((HAL_GetTick() - ticks) >= 100) {
+        ticks = HAL_GetTick();
+        HAL_GPIO_TogglePin(OMV_BOOT_LED_PORT, OMV_BOOT_LED_PIN);
+    }
+}
+
 void __attribute__((noreturn)) __fatal_error() {
     while (1) {
         __flash_led();
@@ -86,12 +96,12 @@ int main() {
             uint32_t start = HAL_GetTick();
             while (!USBD_IDE_Connected()
                    && (HAL_GetTick() - start) < IDE_TIMEOUT) {
-                __flash_led();
+                __process_flash_led();
             }
 
             // Wait for new firmware image if the IDE is connected
             while (USBD_IDE_Connected()) {
-                __flash_led();
+                __process_flash_led();
             }
         }
     }
@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <string.h>
 #include "flash.h"
 #include "usbdev/usbd_cdc.h"
 #include "omv_boardconfig.h"
@@ -21,15 +22,24 @@ uint32_t UserTxBufPtrIn = 0;    /* Increment this pointer or roll it back to
                                    start address when data are received over USART */
 uint32_t UserTxBufPtrOut = 0;   /* Increment this pointer or roll it back to
                                    start address when data are sent over USB */
-uint8_t UserRxBuffer[APP_RX_DATA_SIZE];/* Received Data over USB are stored in this buffer */
 uint8_t UserTxBuffer[APP_TX_DATA_SIZE];/* Received Data over UART (CDC interface) are stored in this buffer */
 
 static volatile uint8_t ide_connected = 0;
 static volatile uint8_t vcp_connected = 0;
 
-#define FLASH_BUF_SIZE  (CDC_DATA_MAX_PACKET_SIZE)
+// Received packets are queued and processed by CDC_Process() in the main loop, so USB keeps
+// receiving while the flash is being erased or programmed. Packets are received in place.
+#define RX_QUEUE_SIZE   (8)
+static uint32_t rx_queue[RX_QUEUE_SIZE][CDC_DATA_MAX_PACKET_SIZE / 4];
+static volatile uint32_t rx_queue_len[RX_QUEUE_SIZE];
+static volatile uint32_t rx_queue_head=0;
+static volatile uint32_t rx_queue_tail=0;
+static volatile uint8_t  rx_paused=0;
+
+// Flash is programmed in 1KiB blocks, which also keeps the unlock/lock overhead down.
+#define FLASH_BUF_SIZE  (1024)
 static volatile uint32_t flash_buf_idx=0;
-static volatile uint8_t  flash_buf[FLASH_BUF_SIZE];
+static uint32_t flash_buf[FLASH_BUF_SIZE / 4];
 static const    uint32_t flash_layout[3] = OMV_BOOT_FLASH_LAYOUT;
 #if defined(OMV_BOOT_QSPIF_LAYOUT)
 #define QSPIF_BUF_SIZE  OMV_BOOT_QSPIF_PAGE_SIZE
@@ -49,6 +59,7 @@ static int8_t CDC_Itf_Init(void);
 static int8_t CDC_Itf_DeInit(void);
 static int8_t CDC_Itf_Control(uint8_t cmd, uint8_t* pbuf, uint16_t length);
 static int8_t CDC_Itf_Receive(uint8_t* pbuf, uint32_t *Len);
+static void CDC_Itf_Process(uint8_t *Buf, uint32_t Len);
 
 enum bootldr_cmd {
     BOOTLDR_START           = 0xABCD0001,
@@ -80,7 +91,10 @@ static int8_t CDC_Itf_Init(void)
 {
     // Set Application Buffers
     USBD_CDC_SetTxBuffer(&USBD_Device, UserTxBuffer, 0);
-    USBD_CDC_SetRxBuffer(&USBD_Device, UserRxBuffer);
+    rx_queue_head = 0;
+    rx_queue_tail = 0;
+    rx_paused = 0;
+    USBD_CDC_SetRxBuffer(&USBD_Device, (uint8_t *) rx_queue[0]);
 
     return (USBD_OK);
 }
@@ -209,9 +223,48 @@ void CDC_Tx(uint8_t *buf, uint32_t len)
  */
 static int8_t CDC_Itf_Receive(uint8_t *Buf, uint32_t *Len)
 {
-    static volatile uint32_t flash_offset;
+    rx_queue_len[rx_queue_head % RX_QUEUE_SIZE] = *Len;
+    rx_queue_head++;
+
+    // Receive the next packet into the next free slot, or NAK until one is processed.
+    if ((rx_queue_head - rx_queue_tail) < RX_QUEUE_SIZE) {
+        USBD_CDC_SetRxBuffer(&USBD_Device, (uint8_t *) rx_queue[rx_queue_head % RX_QUEUE_SIZE]);
+        USBD_CDC_ReceivePacket(&USBD_Device);
+    } else {
+        rx_paused = 1;
+    }
+    return USBD_OK;
+}
+
+/**
+ * @brief  CDC_Process
+ *         Processes the received packets, called from the main loop.
+ * @param  None
+ * @retval None
+ */
+void CDC_Process(void)
+{
+    while (rx_queue_tail != rx_queue_head) {
+        uint32_t slot = rx_queue_tail % RX_QUEUE_SIZE;
+        CDC_Itf_Process((uint8_t *) rx_queue[slot], rx_queue_len[slot]);
+        rx_queue_tail++;
+
+        if (rx_paused) {
+            // The receive IRQ can't run until the queue is full again, restart it.
+            rx_paused = 0;
+            __disable_irq();
+            USBD_CDC_SetRxBuffer(&USBD_Device, (uint8_t *) rx_queue[rx_queue_head % RX_QUEUE_SIZE]);
+            USBD_CDC_ReceivePacket(&USBD_Device);
+            __enable_irq();
+        }
+    }
+}
+
+static void CDC_Itf_Process(uint8_t *Buf, uint32_t Len)
+{
+    static uint32_t flash_offset;
     #if defined(OMV_BOOT_QSPIF_LAYOUT)
-    static volatile uint32_t qspif_offset=0;
+    static uint32_t qspif_offset=0;
     #endif
 
     uint32_t *cmd_buf = (uint32_t*) Buf;
@@ -242,16 +295,21 @@ static int8_t CDC_Itf_Receive(uint8_t *Buf, uint32_t *Len)
 
         case BOOTLDR_FLASH_WRITE: {
             uint8_t *buf =  Buf + 4;
-            uint32_t len = *Len - 4;
-            for (int i=0; i<len; i++) {
-                flash_buf[flash_buf_idx++] = buf[i];
+            uint32_t len = Len - 4;
+            while (len) {
+                uint32_t n = FLASH_BUF_SIZE - flash_buf_idx;
+                n = (len < n) ? len : n;
+                memcpy(((uint8_t *) flash_buf) + flash_buf_idx, buf, n);
+                flash_buf_idx += n;
+                buf += n;
+                len -= n;
                 if (flash_buf_idx == FLASH_BUF_SIZE) {
                     flash_buf_idx = 0;
-                    flash_write((uint32_t*)flash_buf, flash_offset, FLASH_BUF_SIZE);
+                    flash_write(flash_buf, flash_offset, FLASH_BUF_SIZE);
                     flash_offset += FLASH_BUF_SIZE;
                 }
             }
-            break; 
+            break;
         }
 
         case BOOTLDR_QSPIF_LAYOUT:
@@ -269,7 +327,7 @@ static int8_t CDC_Itf_Receive(uint8_t *Buf, uint32_t *Len)
         case BOOTLDR_QSPIF_WRITE: {
             #if defined(OMV_BOOT_QSPIF_LAYOUT)
             uint8_t *buf =  Buf + 4;
-            uint32_t len = *Len - 4;
+            uint32_t len = Len - 4;
             for (int i=0; i<len; i++) {
                 qspif_buf[qspif_buf_idx++] = buf[i];
                 if (qspif_buf_idx == QSPIF_BUF_SIZE) {
@@ -294,11 +352,14 @@ static int8_t CDC_Itf_Receive(uint8_t *Buf, uint32_t *Len)
         case BOOTLDR_RESET: {
             ide_connected = 0;
             if (flash_buf_idx) {
-                // Pad and flush the last packet
-                for (int i=flash_buf_idx; i<FLASH_BUF_SIZE; i++) {
-                    flash_buf[i] = 0xFF;
-                }
-                flash_write((uint32_t*)flash_buf, flash_offset, FLASH_BUF_SIZE);
+                // Pad the last block to the flash word size and flush it.
+                #if defined(MCU_SERIES_H7)
+                uint32_t size = (flash_buf_idx + 31) & ~31;
+                #else
+                uint32_t size = (flash_buf_idx + 3) & ~3;
+                #endif
+                memset(((uint8_t *) flash_buf) + flash_buf_idx, 0xFF, size - flash_buf_idx);
+                flash_write(flash_buf, flash_offset, size);
             }
             #if defined(OMV_BOOT_QSPIF_LAYOUT)
             if (qspif_buf_idx) {
@@ -312,10 +373,6 @@ static int8_t CDC_Itf_Receive(uint8_t *Buf, uint32_t *Len)
             break;
         }
     }
-
-    // Initiate next USB packet transfer
-    USBD_CDC_ReceivePacket(&USBD_Device);
-    return USBD_OK;
 }
 
 
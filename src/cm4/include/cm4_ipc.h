@@ -0,0 +1,71 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2023 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2023 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * CM7 <-> CM4 job queue, shared by both cores.
+ *
+ * The queue lives at OMV_CM4_IPC_ORIGIN (the end of the CM4 RAM). The CM7 fills a free
+ * slot, marks it pending and takes/releases CM4_IPC_HSEM_ID, which raises the CM4 HSEM
+ * notification interrupt. The CM4 claims the slot (pending -> running), runs the kernel, marks
+ * the slot done and sends an event. Claiming and revoking (pending -> free) a slot are done while
+ * holding CM4_IPC_LOCK_HSEM_ID, so a job the CM7 gave up on is either never started or finished.
+ * The CM4 has no data cache, so all cache maintenance is done by the CM7.
+ */
+#ifndef __CM4_IPC_H__
+#define __CM4_IPC_H__
+#include <stdint.h>
+#include <stdbool.h>
+#include "omv_boardconfig.h"
+
+#define CM4_IPC_MAGIC           (0x34344D43)    // "CM44", set by the CM4 when it's ready.
+#define CM4_IPC_HSEM_ID         (1U)            // HSEM 0 is used by the boot handshake.
+#define CM4_IPC_LOCK_HSEM_ID    (2U)            // Guards the pending -> running/free transitions.
+#define CM4_IPC_JOBS            (4)
+#define CM4_IPC_JOB_ARGS        (14)
+#define CM4_IPC                 ((cm4_ipc_t *) OMV_CM4_IPC_ORIGIN)
+
+typedef enum {
+    CM4_JOB_FREE,
+    CM4_JOB_PENDING,
+    CM4_JOB_RUNNING,
+    CM4_JOB_DONE,
+} cm4_job_state_t;
+
+// Row band kernels, args are: data, stride (bytes), x, w, y_start, y_end, then:
+// Tile kernels (imlib_task_tiles()) get their tile result and the kernel argument.
+typedef enum {
+    CM4_KERNEL_HISTOGRAM_GRAYSCALE, // uint32_t *hist (256 bins, incremented), tile kernel.
+    CM4_KERNEL_LUT_GRAYSCALE,       // const uint8_t *lut (256 entries, applied in place).
+    CM4_KERNEL_MAX
+} cm4_kernel_t;
+
+// Each job is 64 bytes, so jobs never share a CM7 cache line.
+typedef struct cm4_job {
+    volatile uint32_t state;
+    uint32_t kernel;
+    uint32_t args[CM4_IPC_JOB_ARGS];
+} cm4_job_t;
+
+typedef struct cm4_ipc {
+    volatile uint32_t magic;
+    uint32_t reserved[7];
+    cm4_job_t jobs[CM4_IPC_JOBS];
+} cm4_ipc_t;
+
+#if defined(CORE_CM7)
+// Returns true if the CM4 firmware is running the job loop.
+bool cm4_ipc_ready();
+// Returns true if the CM4 can access the given memory (i.e. it's not in the CM7 TCMs).
+bool cm4_ipc_accessible(const void *addr, uint32_t size);
+// Queues a kernel on the CM4. Returns NULL if the CM4 isn't ready or the queue is full.
+cm4_job_t *cm4_ipc_submit(cm4_kernel_t kernel, const uint32_t *args, int n_args);
+// Waits for a job to finish and frees its slot. On timeout, a job the CM4 hasn't started is
+// revoked (its slot is freed and false is returned), one it's running is waited for, since
+// the CM4 is still using its buffers.
+bool cm4_ipc_wait(cm4_job_t *job, uint32_t timeout);
+#endif
+#endif // __CM4_IPC_H__
@@ -0,0 +1,51 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2023 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2023 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * CM4 row band kernels, only built when a board enables OMV_ENABLE_CM4 (none does yet).
+ */
+#include <stdint.h>
+#include "cm4_ipc.h"
+
+static void kernel_histogram_grayscale(const uint32_t *args) {
+    uint8_t *data = (uint8_t *) args[0];
+    uint32_t stride = args[1];
+    uint32_t *hist = (uint32_t *) args[6];
+
+    for (uint32_t y = args[4]; y < args[5]; y++) {
+        uint8_t *row_ptr = data + (y * stride) + args[2];
+        for (uint32_t x = 0; x < args[3]; x++) {
+            hist[row_ptr[x]] += 1;
+        }
+    }
+}
+
+static void kernel_lut_grayscale(const uint32_t *args) {
+    uint8_t *data = (uint8_t *) args[0];
+    uint32_t stride = args[1];
+    const uint8_t *lut = (const uint8_t *) args[6];
+
+    for (uint32_t y = args[4]; y < args[5]; y++) {
+        uint8_t *row_ptr = data + (y * stride) + args[2];
+        for (uint32_t x = 0; x < args[3]; x++) {
+            row_ptr[x] = lut[row_ptr[x]];
+        }
+    }
+}
+
+void cm4_kernel_run(cm4_job_t *job) {
+    switch (job->kernel) {
+        case CM4_KERNEL_HISTOGRAM_GRAYSCALE:
+            kernel_histogram_grayscale(job->args);
+            break;
+        case CM4_KERNEL_LUT_GRAYSCALE:
+            kernel_lut_grayscale(job->args);
+            break;
+        default:
+            break;
+    }
+}
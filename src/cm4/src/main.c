@@ -1,4 +1,6 @@
 #include STM32_HAL_H
+#include <stdbool.h>
+#include "cm4_ipc.h"
 #define HSEM_ID_0    (0U)    /* HW semaphore 0*/
 #define LED_RED      GPIO_PIN_5
 #define LED_GREEN    GPIO_PIN_6
@@ -23,6 +25,61 @@ void blink_led(uint32_t led) {
     __GPIOK_CLK_DISABLE();
 }
 
+#if defined(OMV_CM4_IPC_ORIGIN)
+void cm4_kernel_run(cm4_job_t *job);
+
+void HAL_HSEM_FreeCallback(uint32_t mask) {
+    // The IRQ handler disables the notification, re-enable it for the next job.
+    if (mask & __HAL_HSEM_SEMID_TO_MASK(CM4_IPC_HSEM_ID)) {
+        HAL_HSEM_ActivateNotification(__HAL_HSEM_SEMID_TO_MASK(CM4_IPC_HSEM_ID));
+    }
+}
+
+// Takes a pending job, unless the CM7 revoked it.
+static bool cm4_ipc_claim(cm4_job_t *job) {
+    while (HAL_HSEM_FastTake(CM4_IPC_LOCK_HSEM_ID) != HAL_OK) {
+    }
+
+    bool claimed = (job->state == CM4_JOB_PENDING);
+    if (claimed) {
+        job->state = CM4_JOB_RUNNING;
+    }
+
+    __DSB();
+    HAL_HSEM_Release(CM4_IPC_LOCK_HSEM_ID, 0);
+    return claimed;
+}
+
+static void cm4_ipc_main(void) {
+    cm4_ipc_t *ipc = CM4_IPC;
+
+    for (int i = 0; i < CM4_IPC_JOBS; i++) {
+        ipc->jobs[i].state = CM4_JOB_FREE;
+    }
+
+    HAL_HSEM_ActivateNotification(__HAL_HSEM_SEMID_TO_MASK(CM4_IPC_HSEM_ID));
+    __DSB();
+    ipc->magic = CM4_IPC_MAGIC;
+
+    while (1) {
+        for (int i = 0; i < CM4_IPC_JOBS; i++) {
+            cm4_job_t *job = &ipc->jobs[i];
+            if ((job->state == CM4_JOB_PENDING) && cm4_ipc_claim(job)) {
+                cm4_kernel_run(job);
+                __DSB();
+                job->state = CM4_JOB_DONE;
+                __DSB();
+                // Wake up the CM7 if it's waiting in WFE.
+                __SEV();
+            }
+        }
+        // The notification interrupt sets the event register, so a job
+        // submitted after the scan above doesn't get lost.
+        __WFE();
+    }
+}
+#endif
+
 int main(void) {
     HAL_Init();
 
@@ -46,6 +103,11 @@ int main(void) {
     // Deactivate HSEM notification for Cortex-M4
     HAL_HSEM_DeactivateNotification(__HAL_HSEM_SEMID_TO_MASK(HSEM_ID_0));
 
+    #if defined(OMV_CM4_IPC_ORIGIN)
+    // The CM7 is up, run jobs instead of entering standby.
+    cm4_ipc_main();
+    #endif
+
     // HW semaphore Clock disable
     __HAL_RCC_HSEM_CLK_DISABLE();
 
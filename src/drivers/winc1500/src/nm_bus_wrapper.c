@@ -15,6 +15,8 @@
 #include "py/mphal.h"
 
 #include "omv_boardconfig.h"
+#include "omv_common.h"
+#include "omv_cache.h"
 #include "omv_gpio.h"
 #include "omv_spi.h"
 
@@ -25,8 +27,10 @@
 
 #define NM_BUS_MAX_TRX_SZ   (4096)
 #define NM_BUS_SPI_TIMEOUT  (1000)
+#define NM_BUS_DMA_MIN_SIZE (64) // Smaller transfers are faster without DMA setup.
 
 static omv_spi_t spi_bus;
+static volatile bool spi_bus_dma_done;
 
 tstrNmBusCapabilities egstrNmBusCapabilities = {
 	NM_BUS_MAX_TRX_SZ
@@ -40,6 +44,7 @@ sint8 nm_bus_init(void *pvinit) {
 
     spi_config.baudrate    = OMV_WINC_SPI_BAUDRATE;
     spi_config.nss_enable  = false; // Soft NSS
+    spi_config.dma_flags   = OMV_SPI_DMA_NORMAL;
 
     if (omv_spi_init(&spi_bus, &spi_config) != 0) {
         result = M2M_ERR_BUS_FAIL;
@@ -55,6 +60,77 @@ sint8 nm_bus_deinit(void) {
 	return M2M_SUCCESS;
 }
 
+// Data blocks (e.g. socket payloads sent straight from Python buffers or the frame buffer) are
+// sent with DMA if the DMA can reach the buffer. The DMA moves words, and received data must not
+// share a dirty cache line with anything else, as the line is invalidated after the transfer.
+static bool nm_bus_dma_buffer(const uint8 *buf, uint16 size, bool rx) {
+    uint32_t addr = (uint32_t) buf;
+
+    if ((size < NM_BUS_DMA_MIN_SIZE) || ((addr | size) & 3)) {
+        return false;
+    }
+
+    #if defined(OMV_DTCM_ORIGIN)
+    if ((addr < (OMV_DTCM_ORIGIN + OMV_DTCM_LENGTH)) && ((addr + size) > OMV_DTCM_ORIGIN)) {
+        return false;
+    }
+    #endif
+
+    #if defined(OMV_ITCM_ORIGIN)
+    if ((addr < (OMV_ITCM_ORIGIN + OMV_ITCM_LENGTH)) && ((addr + size) > OMV_ITCM_ORIGIN)) {
+        return false;
+    }
+    #endif
+
+    if (rx && (omv_cache_get_policy(buf, size) == OMV_CACHE_WRITE_BACK) &&
+        ((addr | size) & (OMV_ALLOC_ALIGNMENT - 1))) {
+        return false;
+    }
+
+    return true;
+}
+
+static void nm_bus_dma_callback(omv_spi_t *spi, void *userdata, void *buf) {
+    spi_bus_dma_done = true;
+}
+
+static int nm_bus_dma_rw(omv_spi_transfer_t *spi_xfer) {
+    if (spi_xfer->rxbuf) {
+        omv_cache_clean_invalidate(spi_xfer->rxbuf, spi_xfer->size);
+    }
+
+    if (spi_xfer->txbuf != spi_xfer->rxbuf) {
+        omv_cache_clean(spi_xfer->txbuf, spi_xfer->size);
+    }
+
+    spi_bus_dma_done = false;
+    spi_xfer->flags = OMV_SPI_XFER_DMA;
+    spi_xfer->callback = nm_bus_dma_callback;
+
+    if (omv_spi_transfer_start(&spi_bus, spi_xfer) != 0) {
+        return -1;
+    }
+
+    for (mp_uint_t start = mp_hal_ticks_ms(); !spi_bus_dma_done; ) {
+        if ((mp_hal_ticks_ms() - start) > spi_xfer->timeout) {
+            omv_spi_transfer_abort(&spi_bus);
+            return -1;
+        }
+        __WFI();
+    }
+
+    if (spi_bus.xfer_flags & OMV_SPI_XFER_FAILED) {
+        return -1;
+    }
+
+    if (spi_xfer->rxbuf) {
+        // Drop lines speculatively read while the DMA was writing.
+        omv_cache_invalidate(spi_xfer->rxbuf, spi_xfer->size);
+    }
+
+    return 0;
+}
+
 static sint8 nm_bus_rw(uint8 *txbuf, uint8 *rxbuf, uint16 size) {
     sint8 result = M2M_SUCCESS;
     omv_spi_transfer_t spi_xfer = {
@@ -73,8 +149,13 @@ static sint8 nm_bus_rw(uint8 *txbuf, uint8 *rxbuf, uint16 size) {
         spi_xfer.rxbuf = rxbuf;
     }
 
+    bool dma = nm_bus_dma_buffer(spi_xfer.txbuf, size, false) &&
+               ((spi_xfer.rxbuf == NULL) || nm_bus_dma_buffer(spi_xfer.rxbuf, size, true));
+
     omv_gpio_write(spi_bus.cs, 0);
-    omv_spi_transfer_start(&spi_bus, &spi_xfer);
+    if ((dma ? nm_bus_dma_rw(&spi_xfer) : omv_spi_transfer_start(&spi_bus, &spi_xfer)) != 0) {
+        result = M2M_ERR_BUS_FAIL;
+    }
     omv_gpio_write(spi_bus.cs, 1);
 
     return result;
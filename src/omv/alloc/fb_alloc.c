@@ -15,6 +15,7 @@
 
 extern char _fballoc;
 static char *pointer = &_fballoc;
+static char *pointer_peak = &_fballoc; // High-water mark (the stack grows down).
 
 #if defined(FB_ALLOC_STATS)
 static uint32_t alloc_bytes;
@@ -31,6 +32,58 @@ static char *pointer_overlay = &_fballoc_overlay_end;
 // Use fb_alloc_free_till_mark_permanent() instead.
 #define FB_PERMANENT_FLAG         0x2
 
+#if OMV_FB_ALLOC_TAGS_ENABLE
+// Live allocations (oldest first) and a copy of them taken at the high-water mark.
+// Allocations nested deeper than FB_ALLOC_TAGS_MAX are not recorded.
+static fb_alloc_tag_t tags[FB_ALLOC_TAGS_MAX];
+static fb_alloc_tag_t peak_tags[FB_ALLOC_TAGS_MAX];
+static int tags_count;
+static int peak_tags_count;
+#endif
+
+// Open frame arenas, innermost last. An arena owns everything on the stack below its mark.
+typedef struct fb_alloc_arena {
+    char *base; // the arena's mark.
+    char *top; // end of the arena's own allocations.
+    uint32_t id;
+} fb_alloc_arena_t;
+
+static fb_alloc_arena_t arenas[FB_ALLOC_ARENAS_MAX];
+static int arenas_count;
+static uint32_t arenas_id;
+
+// Tag allocations with the address they were called from.
+#define FB_ALLOC_CALLER()         __builtin_return_address(0)
+
+// Pushes the block at new_pointer (its size is already saved) and updates the high-water mark.
+static void fb_alloc_push(char *new_pointer, void *tag) {
+    pointer = new_pointer;
+    #if OMV_FB_ALLOC_TAGS_ENABLE
+    if (tags_count < FB_ALLOC_TAGS_MAX) {
+        tags[tags_count].block = pointer;
+        tags[tags_count].tag = tag;
+        tags[tags_count].size = *((uint32_t *) pointer);
+        tags_count += 1;
+    }
+    #endif
+    if (pointer < pointer_peak) {
+        pointer_peak = pointer;
+        #if OMV_FB_ALLOC_TAGS_ENABLE
+        memcpy(peak_tags, tags, tags_count * sizeof(fb_alloc_tag_t));
+        peak_tags_count = tags_count;
+        #endif
+    }
+}
+
+// Drops the tags of blocks that were popped off the stack.
+static void fb_alloc_pop_tags() {
+    #if OMV_FB_ALLOC_TAGS_ENABLE
+    while (tags_count && (tags[tags_count - 1].block < pointer)) {
+        tags_count -= 1;
+    }
+    #endif
+}
+
 char *fb_alloc_stack_pointer() {
     return pointer;
 }
@@ -41,11 +94,36 @@ MP_WEAK NORETURN void fb_alloc_fail() {
 
 void fb_alloc_init0() {
     pointer = &_fballoc;
+    pointer_peak = &_fballoc;
+    arenas_count = 0;
+    #if OMV_FB_ALLOC_TAGS_ENABLE
+    tags_count = 0;
+    peak_tags_count = 0;
+    #endif
     #if defined(OMV_FB_OVERLAY_MEMORY)
     pointer_overlay = &_fballoc_overlay_end;
     #endif
 }
 
+uint32_t fb_alloc_peak() {
+    return &_fballoc - pointer_peak;
+}
+
+void fb_alloc_reset_peak() {
+    pointer_peak = pointer;
+    #if OMV_FB_ALLOC_TAGS_ENABLE
+    memcpy(peak_tags, tags, tags_count * sizeof(fb_alloc_tag_t));
+    peak_tags_count = tags_count;
+    #endif
+}
+
+#if OMV_FB_ALLOC_TAGS_ENABLE
+int fb_alloc_get_tags(const fb_alloc_tag_t **list, bool peak) {
+    *list = peak ? peak_tags : tags;
+    return peak ? peak_tags_count : tags_count;
+}
+#endif
+
 uint32_t fb_avail() {
     uint32_t temp = pointer - framebuffer_get_buffers_end() - sizeof(uint32_t);
     return (temp < sizeof(uint32_t)) ? 0 : temp;
@@ -64,7 +142,7 @@ void fb_alloc_mark() {
     // meaning that the value below is always 8 or more but never 4. So,
     // we will use a size value of 4 as a marker in the alloc stack.
     *((uint32_t *) new_pointer) = sizeof(uint32_t); // Save size.
-    pointer = new_pointer;
+    fb_alloc_push(new_pointer, FB_ALLOC_CALLER());
     #if defined(FB_ALLOC_STATS)
     alloc_bytes = 0;
     alloc_bytes_peak = 0;
@@ -82,6 +160,7 @@ static void int_fb_alloc_free_till_mark(bool free_permanent) {
     while (pointer < &_fballoc) {
         uint32_t size = *((uint32_t *) pointer);
         if ((!free_permanent) && (size & FB_PERMANENT_FLAG)) {
+            fb_alloc_pop_tags();
             return;
         }
         size &= ~FB_PERMANENT_FLAG;
@@ -97,6 +176,7 @@ static void int_fb_alloc_free_till_mark(bool free_permanent) {
             break;                           // Break on first marker.
         }
     }
+    fb_alloc_pop_tags();
     #if defined(FB_ALLOC_STATS)
     printf("fb_alloc peak memory: %lu\n", alloc_bytes_peak);
     #endif
@@ -116,8 +196,7 @@ void fb_alloc_free_till_mark_past_mark_permanent() {
     int_fb_alloc_free_till_mark(true);
 }
 
-// returns null pointer without error if size==0
-void *fb_alloc(uint32_t size, int hints) {
+static void *int_fb_alloc(uint32_t size, int hints, void *tag) {
     if (!size) {
         return NULL;
     }
@@ -139,7 +218,7 @@ void *fb_alloc(uint32_t size, int hints) {
 
     // size is always 4/8/12/etc. so the value below must be 8 or more.
     *((uint32_t *) new_pointer) = size + sizeof(uint32_t); // Save size.
-    pointer = new_pointer;
+    fb_alloc_push(new_pointer, tag);
 
     #if defined(FB_ALLOC_STATS)
     alloc_bytes += size;
@@ -160,7 +239,7 @@ void *fb_alloc(uint32_t size, int hints) {
     #endif
 
     if (hints & FB_ALLOC_CACHE_ALIGN) {
-        int offset = ((uint32_t) result) % OMV_ALLOC_ALIGNMENT;
+        int offset = ((uintptr_t) result) % OMV_ALLOC_ALIGNMENT;
         if (offset) {
             result += OMV_ALLOC_ALIGNMENT - offset;
         }
@@ -169,14 +248,19 @@ void *fb_alloc(uint32_t size, int hints) {
     return result;
 }
 
+// returns null pointer without error if size==0
+void *fb_alloc(uint32_t size, int hints) {
+    return int_fb_alloc(size, hints, FB_ALLOC_CALLER());
+}
+
 // returns null pointer without error if passed size==0
 void *fb_alloc0(uint32_t size, int hints) {
-    void *mem = fb_alloc(size, hints);
+    void *mem = int_fb_alloc(size, hints, FB_ALLOC_CALLER());
     memset(mem, 0, size); // does nothing if size is zero.
     return mem;
 }
 
-void *fb_alloc_all(uint32_t *size, int hints) {
+static void *int_fb_alloc_all(uint32_t *size, int hints, void *tag) {
     uint32_t temp = pointer - framebuffer_get_buffers_end() - sizeof(uint32_t);
 
     if (temp < sizeof(uint32_t)) {
@@ -198,7 +282,7 @@ void *fb_alloc_all(uint32_t *size, int hints) {
 
     // size is always 4/8/12/etc. so the value below must be 8 or more.
     *((uint32_t *) new_pointer) = *size + sizeof(uint32_t); // Save size.
-    pointer = new_pointer;
+    fb_alloc_push(new_pointer, tag);
 
     #if defined(FB_ALLOC_STATS)
     alloc_bytes += *size;
@@ -218,7 +302,7 @@ void *fb_alloc_all(uint32_t *size, int hints) {
     #endif
 
     if (hints & FB_ALLOC_CACHE_ALIGN) {
-        int offset = ((uint32_t) result) % OMV_ALLOC_ALIGNMENT;
+        int offset = ((uintptr_t) result) % OMV_ALLOC_ALIGNMENT;
         if (offset) {
             int inc = OMV_ALLOC_ALIGNMENT - offset;
             result += inc;
@@ -231,13 +315,88 @@ void *fb_alloc_all(uint32_t *size, int hints) {
     return result;
 }
 
+void *fb_alloc_all(uint32_t *size, int hints) {
+    return int_fb_alloc_all(size, hints, FB_ALLOC_CALLER());
+}
+
 // returns null pointer without error if returned size==0
 void *fb_alloc0_all(uint32_t *size, int hints) {
-    void *mem = fb_alloc_all(size, hints);
+    void *mem = int_fb_alloc_all(size, hints, FB_ALLOC_CALLER());
     memset(mem, 0, *size); // does nothing if size is zero.
     return mem;
 }
 
+uint32_t fb_alloc_arena_open() {
+    if (arenas_count == FB_ALLOC_ARENAS_MAX) {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Too many nested frame arenas"));
+    }
+
+    fb_alloc_mark();
+
+    // Ids are never reused so images that outlive their arena can be detected.
+    arenas_id = (arenas_id + 1) ? (arenas_id + 1) : 1;
+
+    fb_alloc_arena_t *arena = &arenas[arenas_count++];
+    arena->base = pointer;
+    arena->top = pointer;
+    arena->id = arenas_id;
+    return arena->id;
+}
+
+void fb_alloc_arena_close(uint32_t id) {
+    int i = arenas_count - 1;
+
+    while ((i >= 0) && (arenas[i].id != id)) {
+        i -= 1;
+    }
+
+    if (i < 0) {
+        return;
+    }
+
+    // Closing an arena also closes the arenas opened after it.
+    char *base = arenas[i].base;
+    arenas_count = i;
+
+    // Pops the marks left behind by exceptions too, stops at permanent allocations.
+    while (pointer <= base) {
+        char *old_pointer = pointer;
+        int_fb_alloc_free_till_mark(false);
+        if (pointer == old_pointer) {
+            break;
+        }
+    }
+}
+
+void *fb_alloc_arena(uint32_t size, int hints) {
+    if ((!arenas_count) || (pointer != arenas[arenas_count - 1].top)
+        || ((size + OMV_ALLOC_ALIGNMENT) > fb_avail())) {
+        return NULL;
+    }
+
+    void *result = int_fb_alloc(size, hints, FB_ALLOC_CALLER());
+    arenas[arenas_count - 1].top = pointer;
+    return result;
+}
+
+uint32_t fb_alloc_arena_id(void *ptr) {
+    for (int i = arenas_count - 1; i >= 0; i--) {
+        if ((((char *) ptr) >= pointer) && (((char *) ptr) < arenas[i].base)) {
+            return arenas[i].id;
+        }
+    }
+    return 0;
+}
+
+bool fb_alloc_arena_is_open(uint32_t id) {
+    for (int i = arenas_count - 1; i >= 0; i--) {
+        if (arenas[i].id == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void fb_free() {
     if (pointer < &_fballoc) {
         uint32_t size = *((uint32_t *) pointer);
@@ -254,6 +413,7 @@ void fb_free() {
         #endif
         pointer += size; // Get size and pop.
     }
+    fb_alloc_pop_tags();
 }
 
 void fb_free_all() {
@@ -272,4 +432,5 @@ void fb_free_all() {
         #endif
         pointer += size; // Get size and pop.
     }
+    fb_alloc_pop_tags();
 }
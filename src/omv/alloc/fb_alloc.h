@@ -52,14 +52,36 @@
 #ifndef __FB_ALLOC_H__
 #define __FB_ALLOC_H__
 #include <stdint.h>
+#include <stdbool.h>
+#include "omv_boardconfig.h"
 #define FB_ALLOC_NO_HINT         0
 #define FB_ALLOC_PREFER_SPEED    1
 #define FB_ALLOC_PREFER_SIZE     2
 #define FB_ALLOC_CACHE_ALIGN     4
+
+#ifndef OMV_FB_ALLOC_TAGS_ENABLE
+#define OMV_FB_ALLOC_TAGS_ENABLE (0)
+#endif
+#define FB_ALLOC_TAGS_MAX        64
+#define FB_ALLOC_ARENAS_MAX      8
+
+// A live allocation (or mark) tagged with the return address of its call site.
+// Use addr2line on the firmware ELF file to map the tag to a source line.
+typedef struct fb_alloc_tag {
+    char *block;
+    void *tag;
+    uint32_t size; // Includes the size word, marks are 4 bytes.
+} fb_alloc_tag_t;
+
 char *fb_alloc_stack_pointer();
 void fb_alloc_fail();
 void fb_alloc_init0();
 uint32_t fb_avail();
+uint32_t fb_alloc_peak(); // bytes used at the high-water mark since init or the last reset.
+void fb_alloc_reset_peak(); // restarts the high-water mark from the current usage.
+#if OMV_FB_ALLOC_TAGS_ENABLE
+int fb_alloc_get_tags(const fb_alloc_tag_t **list, bool peak); // live or high-water allocations, oldest first.
+#endif
 void fb_alloc_mark();
 void fb_alloc_free_till_mark();
 void fb_alloc_mark_permanent(); // tag memory that should not be popped on exception
@@ -68,6 +90,13 @@ void *fb_alloc(uint32_t size, int hints);
 void *fb_alloc0(uint32_t size, int hints);
 void *fb_alloc_all(uint32_t *size, int hints); // returns pointer and sets size
 void *fb_alloc0_all(uint32_t *size, int hints); // returns pointer and sets size
+// Frame arenas: fb_alloc_arena() allocations persist until the arena is closed. It returns NULL
+// if the stack is full or the innermost open arena is not at its top (a mark was pushed since).
+uint32_t fb_alloc_arena_open(); // returns the arena's id.
+void fb_alloc_arena_close(uint32_t id); // frees everything allocated since the arena opened.
+void *fb_alloc_arena(uint32_t size, int hints);
+uint32_t fb_alloc_arena_id(void *ptr); // id of the innermost open arena holding ptr, or 0.
+bool fb_alloc_arena_is_open(uint32_t id);
 void fb_free();
 void fb_free_all();
 #endif /* __FF_ALLOC_H__ */
@@ -20,9 +20,6 @@
 #define UMM_H_ATTPACKPRE
 #define UMM_H_ATTPACKSUF    __attribute__((__packed__))
 
-#define UMM_BEST_FIT
-#undef  UMM_FIRST_FIT
-
 /*
  * A couple of macros to make it easier to protect the memory allocator
  * in a multitasking system. You should set these macros up to use whatever
@@ -69,6 +66,32 @@ unsigned short int umm_numblocks = 0;
 #define UMM_NFREE(b)         (UMM_BLOCK(b).body.free.next)
 #define UMM_PFREE(b)         (UMM_BLOCK(b).body.free.prev)
 #define UMM_DATA(b)          (UMM_BLOCK(b).body.data)
+#define UMM_SIZE(b)          ((UMM_NBLOCK(b) & UMM_BLOCKNO_MASK) - (b))
+
+/*
+ * Free blocks are kept in size-class bins instead of a single list. Bins below
+ * UMM_SMALL_BINS hold blocks of exactly (bin + 1) blocks, so small requests are
+ * served from the head of their bin in O(1). The other bins hold blocks of
+ * (2^k, 2^(k+1)] blocks, these are searched for the best fit in the request's
+ * own bin only, and then the head of the next non-empty bin is split, which
+ * keeps the large free blocks together and the scan time bounded.
+ *
+ * A free block with PFREE == 0 is the head of its bin, block 0 is never free.
+ */
+#define UMM_SMALL_BINS       (8)
+#define UMM_NUM_BINS         (UMM_SMALL_BINS + 12)
+
+static unsigned short int umm_bins[UMM_NUM_BINS];
+static uint32_t umm_bin_map;    // Bit n set if bin n isn't empty.
+static umm_stats_t umm_stats_data;
+
+static inline uint32_t umm_bin(unsigned short int blocks) {
+    if (blocks <= UMM_SMALL_BINS) {
+        return blocks - 1;
+    }
+    // 9-16 blocks is bin 8, 17-32 blocks is bin 9, ... 16385-32768 blocks is bin 19.
+    return (31 - __builtin_clz(blocks - 1)) + UMM_SMALL_BINS - 3;
+}
 
 NORETURN void umm_alloc_fail() {
     mp_raise_msg(&mp_type_MemoryError, MP_ERROR_TEXT("Out of fast frame buffer stack memory"));
@@ -122,16 +145,65 @@ static void umm_split_block(unsigned short int c,
 /* ------------------------------------------------------------------------ */
 
 static void umm_disconnect_from_free_list(unsigned short int c) {
-    /* Disconnect this block from the FREE list */
+    /* Disconnect this block from the FREE list of its bin */
+
+    uint32_t bin = umm_bin(UMM_SIZE(c));
+
+    if (UMM_PFREE(c)) {
+        UMM_NFREE(UMM_PFREE(c)) = UMM_NFREE(c);
+    } else if (!(umm_bins[bin] = UMM_NFREE(c))) {
+        umm_bin_map &= ~(1UL << bin);
+    }
 
-    UMM_NFREE(UMM_PFREE(c)) = UMM_NFREE(c);
-    UMM_PFREE(UMM_NFREE(c)) = UMM_PFREE(c);
+    if (UMM_NFREE(c)) {
+        UMM_PFREE(UMM_NFREE(c)) = UMM_PFREE(c);
+    }
 
     /* And clear the free block indicator */
 
     UMM_NBLOCK(c) &= (~UMM_FREELIST_MASK);
 }
 
+static void umm_connect_to_free_list(unsigned short int c) {
+    /* Add this block to the head of the FREE list of its bin */
+
+    uint32_t bin = umm_bin(UMM_SIZE(c));
+
+    UMM_NFREE(c) = umm_bins[bin];
+    UMM_PFREE(c) = 0;
+
+    if (umm_bins[bin]) {
+        UMM_PFREE(umm_bins[bin]) = c;
+    }
+
+    umm_bins[bin] = c;
+    umm_bin_map |= 1UL << bin;
+
+    UMM_NBLOCK(c) |= UMM_FREELIST_MASK;
+}
+
+/* ------------------------------------------------------------------------ */
+
+static size_t umm_free_bytes(size_t *largest) {
+    size_t total = 0;
+    *largest = 0;
+
+    for (uint32_t bin = 0; bin < UMM_NUM_BINS; bin++) {
+        for (unsigned short int c = umm_bins[bin]; c; c = UMM_NFREE(c)) {
+            size_t size = UMM_SIZE(c) * sizeof(umm_block);
+            total += size;
+            *largest = (size > *largest) ? size : *largest;
+        }
+    }
+
+    return total;
+}
+
+static void umm_update_stats() {
+    umm_stats_data.heap_size = umm_numblocks * sizeof(umm_block);
+    umm_stats_data.free = umm_free_bytes(&umm_stats_data.largest_free);
+}
+
 /* ------------------------------------------------------------------------
  * The umm_assimilate_up() function assumes that UMM_NBLOCK(c) does NOT
  * have the UMM_FREELIST_MASK bit set!
@@ -186,6 +258,9 @@ void umm_init_x(size_t size) {
     umm_heap = (umm_block *) UMM_MALLOC_CFG_HEAP_ADDR;
     umm_numblocks = (UMM_MALLOC_CFG_HEAP_SIZE / sizeof(umm_block));
     memset(umm_heap, 0x00, UMM_MALLOC_CFG_HEAP_SIZE);
+    memset(umm_bins, 0x00, sizeof(umm_bins));
+    umm_bin_map = 0;
+    umm_stats_data.used = 0;
 
     /* setup initial blank heap structure */
     {
@@ -198,15 +273,11 @@ void umm_init_x(size_t size) {
 
         /* setup the 0th `umm_block`, which just points to the 1st */
         UMM_NBLOCK(block_0th) = block_1th;
-        UMM_NFREE(block_0th) = block_1th;
-        UMM_PFREE(block_0th) = block_1th;
 
         /*
          * Now, we need to set the whole heap space as a huge free block. We should
          * not touch the 0th `umm_block`, since it's special: the 0th `umm_block`
-         * is the head of the free block list. It's a part of the heap invariant.
-         *
-         * See the detailed explanation at the beginning of the file.
+         * is never free, so 0 terminates the bin lists. It's a part of the heap invariant.
          */
 
         /*
@@ -215,14 +286,10 @@ void umm_init_x(size_t size) {
          * - next `umm_block`: the latest one
          * - prev `umm_block`: the 0th
          *
-         * Plus, it's a free `umm_block`, so we need to apply `UMM_FREELIST_MASK`
-         *
-         * And it's the last free block, so the next free block is 0.
+         * Plus, it's a free `umm_block`, so it's added to its bin.
          */
-        UMM_NBLOCK(block_1th) = block_last | UMM_FREELIST_MASK;
-        UMM_NFREE(block_1th) = 0;
+        UMM_NBLOCK(block_1th) = block_last;
         UMM_PBLOCK(block_1th) = block_0th;
-        UMM_PFREE(block_1th) = block_0th;
 
         /*
          * latest `umm_block` has pointers:
@@ -234,6 +301,25 @@ void umm_init_x(size_t size) {
          */
         UMM_NBLOCK(block_last) = 0;
         UMM_PBLOCK(block_last) = block_1th;
+
+        umm_connect_to_free_list(block_1th);
+    }
+
+    umm_update_stats();
+}
+
+void umm_deinit() {
+    umm_update_stats();
+    umm_heap = NULL;
+    fb_free();
+}
+
+void umm_stats(umm_stats_t *stats, bool reset) {
+    *stats = umm_stats_data;
+
+    if (reset) {
+        umm_stats_data.peak = umm_stats_data.used;
+        umm_stats_data.failures = 0;
     }
 }
 
@@ -243,6 +329,27 @@ void umm_init(void) {
 
 /* ------------------------------------------------------------------------ */
 
+static void umm_free_block(unsigned short int c) {
+
+    /* Now let's assimilate this block with the next one if possible. */
+
+    umm_assimilate_up(c);
+
+    /* Then assimilate with the previous block if possible */
+
+    if (UMM_NBLOCK(UMM_PBLOCK(c)) & UMM_FREELIST_MASK) {
+
+        DBGLOG_DEBUG("Assimilate down to next block, which is FREE\n");
+
+        /* The merged block is bigger, so it may belong to another bin. */
+
+        umm_disconnect_from_free_list(UMM_PBLOCK(c));
+        c = umm_assimilate_down(c, 0);
+    }
+
+    umm_connect_to_free_list(c);
+}
+
 void umm_free(void *ptr) {
 
     unsigned short int c;
@@ -255,15 +362,6 @@ void umm_free(void *ptr) {
         return;
     }
 
-    /*
-     * FIXME: At some point it might be a good idea to add a check to make sure
-     *        that the pointer we're being asked to free up is actually within
-     *        the umm_heap!
-     *
-     * NOTE:  See the new umm_info() function that you can use to see if a ptr is
-     *        on the free list!
-     */
-
     /* Protect the critical section... */
     UMM_CRITICAL_ENTRY();
 
@@ -273,32 +371,9 @@ void umm_free(void *ptr) {
 
     DBGLOG_DEBUG("Freeing block %6i\n", c);
 
-    /* Now let's assimilate this block with the next one if possible. */
-
-    umm_assimilate_up(c);
-
-    /* Then assimilate with the previous block if possible */
-
-    if (UMM_NBLOCK(UMM_PBLOCK(c)) & UMM_FREELIST_MASK) {
-
-        DBGLOG_DEBUG("Assimilate down to next block, which is FREE\n");
-
-        c = umm_assimilate_down(c, UMM_FREELIST_MASK);
-    } else {
-        /*
-         * The previous block is not a free block, so add this one to the head
-         * of the free list
-         */
-
-        DBGLOG_DEBUG("Just add to head of free list\n");
+    umm_stats_data.used -= UMM_SIZE(c) * sizeof(umm_block);
 
-        UMM_PFREE(UMM_NFREE(0)) = c;
-        UMM_NFREE(c) = UMM_NFREE(0);
-        UMM_PFREE(c) = 0;
-        UMM_NFREE(0) = c;
-
-        UMM_NBLOCK(c) |= UMM_FREELIST_MASK;
-    }
+    umm_free_block(c);
 
     /* Release the critical section... */
     UMM_CRITICAL_EXIT();
@@ -309,11 +384,8 @@ void umm_free(void *ptr) {
 void *umm_malloc(size_t size) {
     unsigned short int blocks;
     unsigned short int blockSize = 0;
-
-    unsigned short int bestSize;
-    unsigned short int bestBlock;
-
     unsigned short int cf;
+    uint32_t bin;
 
     if (umm_heap == NULL) {
         umm_init();
@@ -335,100 +407,84 @@ void *umm_malloc(size_t size) {
     /* Protect the critical section... */
     UMM_CRITICAL_ENTRY();
 
-    blocks = umm_blocks(size);
-
-    /*
-     * Now we can scan through the free list until we find a space that's big
-     * enough to hold the number of blocks we need.
-     *
-     * This part may be customized to be a best-fit, worst-fit, or first-fit
-     * algorithm
-     */
+    blocks = (size < (umm_numblocks * sizeof(umm_block))) ? umm_blocks(size) : UMM_BLOCKNO_MASK;
+    bin = umm_bin(blocks);
+    cf = 0;
 
-    cf = UMM_NFREE(0);
+    if (bin < UMM_SMALL_BINS) {
+        /* Any block in an exact size bin fits. */
+        cf = umm_bins[bin];
+    } else {
+        /* Best fit within the bin, blocks in it may be smaller than requested. */
+        unsigned short int bestSize = UMM_BLOCKNO_MASK + 1;
 
-    bestBlock = UMM_NFREE(0);
-    bestSize = 0x7FFF;
+        for (unsigned short int c = umm_bins[bin]; c; c = UMM_NFREE(c)) {
+            blockSize = UMM_SIZE(c);
 
-    while (cf) {
-        blockSize = (UMM_NBLOCK(cf) & UMM_BLOCKNO_MASK) - cf;
+            DBGLOG_TRACE("Looking at block %6i size %6i\n", c, blockSize);
 
-        DBGLOG_TRACE("Looking at block %6i size %6i\n", cf, blockSize);
+            if ((blockSize >= blocks) && (blockSize < bestSize)) {
+                cf = c;
+                bestSize = blockSize;
 
-        #if defined UMM_BEST_FIT
-        if ( (blockSize >= blocks) && (blockSize < bestSize) ) {
-            bestBlock = cf;
-            bestSize = blockSize;
-        }
-        #elif defined UMM_FIRST_FIT
-        /* This is the first block that fits! */
-        if ( (blockSize >= blocks) ) {
-            break;
+                if (blockSize == blocks) {
+                    break;
+                }
+            }
         }
-        #else
-        #error "No UMM_*_FIT is defined - check umm_malloc_cfg.h"
-        #endif
-
-        cf = UMM_NFREE(cf);
     }
 
-    if (0x7FFF != bestSize) {
-        cf = bestBlock;
-        blockSize = bestSize;
-    }
-
-    if (UMM_NBLOCK(cf) & UMM_BLOCKNO_MASK && blockSize >= blocks) {
-        /*
-         * This is an existing block in the memory heap, we just need to split off
-         * what we need, unlink it from the free list and mark it as in use, and
-         * link the rest of the block back into the freelist as if it was a new
-         * block on the free list...
-         */
-
-        if (blockSize == blocks) {
-            /* It's an exact fit and we don't need to split off a block. */
-            DBGLOG_DEBUG("Allocating %6i blocks starting at %6i - exact\n", blocks, cf);
-
-            /* Disconnect this block from the FREE list */
+    if (!cf) {
+        /* Any block in a bigger bin fits, split the first one of the smallest. */
+        uint32_t map = (bin < (UMM_NUM_BINS - 1)) ? (umm_bin_map & (~0UL << (bin + 1))) : 0;
 
-            umm_disconnect_from_free_list(cf);
-
-        } else {
-            /* It's not an exact fit and we need to split off a block. */
-            DBGLOG_DEBUG("Allocating %6i blocks starting at %6i - existing\n", blocks, cf);
-
-            /*
-             * split current free block `cf` into two blocks. The first one will be
-             * returned to user, so it's not free, and the second one will be free.
-             */
-            umm_split_block(cf, blocks, UMM_FREELIST_MASK /*new block is free*/);
-
-            /*
-             * `umm_split_block()` does not update the free pointers (it affects
-             * only free flags), but effectively we've just moved beginning of the
-             * free block from `cf` to `cf + blocks`. So we have to adjust pointers
-             * to and from adjacent free blocks.
-             */
-
-            /* previous free block */
-            UMM_NFREE(UMM_PFREE(cf) ) = cf + blocks;
-            UMM_PFREE(cf + blocks) = UMM_PFREE(cf);
-
-            /* next free block */
-            UMM_PFREE(UMM_NFREE(cf) ) = cf + blocks;
-            UMM_NFREE(cf + blocks) = UMM_NFREE(cf);
+        if (map) {
+            cf = umm_bins[__builtin_ctz(map)];
         }
-    } else {
+    }
+
+    if (!cf) {
         /* Out of memory */
 
         DBGLOG_DEBUG("Can't allocate %5i blocks\n", blocks);
 
+        umm_stats_data.failures++;
+        umm_update_stats();
+
         /* Release the critical section... */
         UMM_CRITICAL_EXIT();
 
         return( (void *) NULL);
     }
 
+    blockSize = UMM_SIZE(cf);
+
+    /* Disconnect this block from the FREE list */
+
+    umm_disconnect_from_free_list(cf);
+
+    if (blockSize > blocks) {
+        /* It's not an exact fit and we need to split off a block. */
+        DBGLOG_DEBUG("Allocating %6i blocks starting at %6i - existing\n", blocks, cf);
+
+        /*
+         * split current free block `cf` into two blocks. The first one will be
+         * returned to user, and the second one goes back to the bin of its size.
+         * Its neighbours are used, so there's nothing to assimilate.
+         */
+        umm_split_block(cf, blocks, 0);
+        umm_connect_to_free_list(cf + blocks);
+    } else {
+        /* It's an exact fit and we don't need to split off a block. */
+        DBGLOG_DEBUG("Allocating %6i blocks starting at %6i - exact\n", blocks, cf);
+    }
+
+    umm_stats_data.used += blocks * sizeof(umm_block);
+
+    if (umm_stats_data.used > umm_stats_data.peak) {
+        umm_stats_data.peak = umm_stats_data.used;
+    }
+
     /* Release the critical section... */
     UMM_CRITICAL_EXIT();
 
@@ -441,6 +497,7 @@ void *umm_realloc(void *ptr, size_t size) {
 
     unsigned short int blocks;
     unsigned short int blockSize;
+    unsigned short int oldBlockSize;
     unsigned short int prevBlockSize = 0;
     unsigned short int nextBlockSize = 0;
 
@@ -497,7 +554,7 @@ void *umm_realloc(void *ptr, size_t size) {
 
     /* Figure out how big this block is ... the free bit is not set :-) */
 
-    blockSize = (UMM_NBLOCK(c) - c);
+    blockSize = oldBlockSize = (UMM_NBLOCK(c) - c);
 
     /* Figure out how many bytes are in this block */
 
@@ -587,7 +644,11 @@ void *umm_realloc(void *ptr, size_t size) {
                          blocks);
             /* This space intentionally left blnk */
         }
-        blockSize = blocks;
+
+        /* Release the critical section... */
+        UMM_CRITICAL_EXIT();
+
+        return(ptr);
     }
 
     /* Now all we need to do is figure out if the block fit exactly or if we
@@ -597,7 +658,14 @@ void *umm_realloc(void *ptr, size_t size) {
     if (blockSize > blocks) {
         DBGLOG_DEBUG("split and free %i blocks from %i\n", blocks, blockSize);
         umm_split_block(c, blocks, 0);
-        umm_free( (void *) &UMM_DATA(c + blocks) );
+        umm_free_block(c + blocks);
+        blockSize = blocks;
+    }
+
+    umm_stats_data.used += (blockSize - oldBlockSize) * (int) sizeof(umm_block);
+
+    if (umm_stats_data.used > umm_stats_data.peak) {
+        umm_stats_data.peak = umm_stats_data.used;
     }
 
     /* Release the critical section... */
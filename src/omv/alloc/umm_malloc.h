@@ -12,8 +12,23 @@
 #ifndef __UMM_MALLOC_H__
 #define __UMM_MALLOC_H__
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct umm_stats {
+    size_t heap_size;       // Size of the current (or last) heap.
+    size_t used;            // Bytes allocated, including block headers.
+    size_t peak;            // Max bytes allocated since the last reset.
+    size_t free;            // Bytes free.
+    size_t largest_free;    // Largest free block.
+    uint32_t failures;      // Failed allocations since the last reset.
+} umm_stats_t;
+
 void umm_alloc_fail();
 void  umm_init_x(size_t size);   // Min of 2.5KB - Max of 640 KB.
+void  umm_deinit();              // Frees the heap, must be the last fb_alloc.
+// Free space is sampled when the heap is created, freed, or an allocation fails.
+void  umm_stats(umm_stats_t *stats, bool reset);
 void *umm_malloc(size_t size);
 void *umm_calloc(size_t num, size_t size);
 void *umm_realloc(void *ptr, size_t size);
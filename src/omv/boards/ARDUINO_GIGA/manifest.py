@@ -6,6 +6,7 @@ require("dht")
 require("neopixel")
 freeze ("$(OMV_LIB_DIR)/", "modbus.py")
 freeze ("$(OMV_LIB_DIR)/", "pid.py")
+freeze ("$(OMV_LIB_DIR)/", "tracker.py")
 freeze ("$(OMV_LIB_DIR)/", "gt911.py")
 freeze ("$(OMV_LIB_DIR)/", "st7701.py")
 freeze ("$(OMV_LIB_DIR)/", "machine.py")
@@ -20,6 +20,9 @@ extern unsigned char *OMV_BOARD_UID_ADDR;    // Unique address.
 #define OMV_BOARD_UID_SIZE         2         // Unique ID size in words.
 #define OMV_BOARD_UID_OFFSET       4         // Bytes offset for multi-word UIDs.
 
+// Run imlib jobs on core1.
+#define OMV_CORE1_ENABLE           (1)
+
 // JPEG configuration.
 #define OMV_JPEG_CODEC_ENABLE      (0)
 #define OMV_JPEG_QUALITY_LOW       (35)
@@ -93,6 +96,9 @@ extern unsigned char *OMV_BOARD_UID_ADDR;    // Unique address.
 #define OMV_PDM_CLK_PIN            (23)
 #define OMV_PDM_DIN_PIN            (22)
 
+// Memory copy DMA config.
+#define OMV_MEMCPY_DMA_CHANNEL     (2)
+
 // Camera interface
 #define OMV_CSI_PIO                (pio0)
 #define OMV_CSI_SM                 (0)
@@ -134,7 +134,8 @@
 #define OMV_AXI_SRAM_ORIGIN                   0x24000000
 #define OMV_AXI_SRAM_LENGTH                   512K
 #define OMV_CM4_RAM_ORIGIN                    0x38000000 // Cortex-M4 memory @SRAM4.
-#define OMV_CM4_RAM_LENGTH                    16K
+#define OMV_CM4_RAM_LENGTH                    15K
+#define OMV_CM4_IPC_ORIGIN                    0x38003C00 // Last 1K of CM4 memory, CM7 <-> CM4 job queue.
 
 // Flash configuration.
 #define OMV_FLASH_FFS_ORIGIN                  0x08020000
@@ -169,6 +170,7 @@
 #define OMV_MDMA_CHANNEL_DCMI_1               (1)
 #define OMV_MDMA_CHANNEL_JPEG_IN              (7) // in has a lower pri than out
 #define OMV_MDMA_CHANNEL_JPEG_OUT             (6) // out has a higher pri than in
+#define OMV_MDMA_CHANNEL_MEMCPY               (8) // memory copies have the lowest pri
 
 // AXI QoS - Low-High (0:15) - default 0
 #define OMV_AXI_QOS_MDMA_R_PRI                15 // Max pri to move data.
@@ -7,6 +7,7 @@ require("dht")
 require("neopixel")
 freeze ("$(OMV_LIB_DIR)/", "modbus.py")
 freeze ("$(OMV_LIB_DIR)/", "pid.py")
+freeze ("$(OMV_LIB_DIR)/", "tracker.py")
 freeze ("$(OMV_LIB_DIR)/", "lora.py")
 freeze ("$(OMV_LIB_DIR)/", "ssd1306.py")
 freeze ("$(OMV_LIB_DIR)/", "tb6612.py")
@@ -144,7 +144,8 @@
 #define OMV_DRAM_ORIGIN                     0xC0000000
 #define OMV_DRAM_LENGTH                     8M
 #define OMV_CM4_RAM_ORIGIN                  0x30044000    // Cortex-M4 memory.
-#define OMV_CM4_RAM_LENGTH                  16K
+#define OMV_CM4_RAM_LENGTH                  15K
+#define OMV_CM4_IPC_ORIGIN                  0x30047C00    // Last 1K of CM4 memory, CM7 <-> CM4 job queue.
 #define OMV_CM4_FLASH_ORIGIN                0x08020000
 #define OMV_CM4_FLASH_LENGTH                128K
 
@@ -179,6 +180,7 @@
 #define OMV_MDMA_CHANNEL_DCMI_1             (1)
 #define OMV_MDMA_CHANNEL_JPEG_IN            (7) // in has a lower pri than out
 #define OMV_MDMA_CHANNEL_JPEG_OUT           (6) // out has a higher pri than in
+#define OMV_MDMA_CHANNEL_MEMCPY             (8) // memory copies have the lowest pri
 
 // AXI QoS - Low-High (0:15) - default 0
 #define OMV_AXI_QOS_MDMA_R_PRI              14    // Max pri to move data.
@@ -242,6 +244,10 @@
 // shield, so it can't be enabled for the two boards at the same time.
 //#define OMV_CSI_FSYNC_PIN                    (&omv_pin_C15_GPIO)
 
+// The INT pin is only an input here, so motion detection interrupts from the
+// Himax shield can wake the MCU without conflicting with the breakout board.
+#define OMV_CSI_INT_PIN                     (&omv_pin_C15_GPIO)
+
 // GPIO.3 is connected to the powerdown pin on the Portenta breakout board,
 // and to the STROBE pin on the Himax shield, however it's not actually
 // used on the Himax shield and can be safely enable for the two boards.
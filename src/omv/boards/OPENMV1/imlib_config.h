@@ -20,9 +20,15 @@
 // Enable LAB LUT
 //#define IMLIB_ENABLE_LAB_LUT
 
+// Enable the compact LAB tables when the LAB LUT does not fit in flash
+//#define IMLIB_ENABLE_LAB_LUT_COMPACT
+
 // Enable YUV LUT
 //#define IMLIB_ENABLE_YUV_LUT
 
+// Enable the Helium (MVE) kernels, requires CPU=cortex-m55 (untested on hardware)
+//#define IMLIB_ENABLE_HELIUM
+
 // Enable linpolar()
 //#define IMLIB_ENABLE_LINPOLAR
 
@@ -35,6 +41,9 @@
 // Enable rotation_corr()
 //#define IMLIB_ENABLE_ROTATION_CORR
 
+// Enable remap(), lens_corr_map() and rotation_corr_map()
+//#define IMLIB_ENABLE_REMAP
+
 // Enable phasecorrelate()
 #if defined(IMLIB_ENABLE_ROTATION_CORR)
 //#define IMLIB_ENABLE_FIND_DISPLACEMENT
@@ -43,6 +52,9 @@
 // Enable get_similarity()
 //#define IMLIB_ENABLE_GET_SIMILARITY
 
+// Enable get_histogram_cache()
+//#define IMLIB_ENABLE_HISTOGRAM_CACHE
+
 // Enable find_lines()
 //#define IMLIB_ENABLE_FIND_LINES
 
@@ -18,6 +18,12 @@
 #define OMV_BOARD_UID_SIZE                    3             // Unique ID size in words.
 #define OMV_BOARD_UID_OFFSET                  4             // Bytes offset for multi-word UIDs.
 
+// Enable the DWT cycle counter profiler (omv.profile()).
+#define OMV_PROFILE_ENABLE                    (1)
+
+// Tag fb_alloc allocations with their call site (omv.fb_alloc_stack()).
+#define OMV_FB_ALLOC_TAGS_ENABLE              (1)
+
 // JPEG configuration.
 #define OMV_JPEG_CODEC_ENABLE                 (1)
 #define OMV_JPEG_QUALITY_LOW                  (50)
@@ -171,11 +177,17 @@
 //#define OMV_DMA_REGION_D3_BASE  (OMV_SRAM4_ORIGIN+(0*1024))
 //#define OMV_DMA_REGION_D3_SIZE  MPU_REGION_SIZE_64KB
 
+// Frame buffer region cache policy (write-back if not defined).
+//#define OMV_FB_REGION_BASE      (OMV_AXI_SRAM_ORIGIN)
+//#define OMV_FB_REGION_SIZE      MPU_REGION_SIZE_512KB
+//#define OMV_FB_REGION_POLICY    OMV_CACHE_WRITE_THROUGH
+
 // MDMA configuration
 #define OMV_MDMA_CHANNEL_DCMI_0               (0)
 #define OMV_MDMA_CHANNEL_DCMI_1               (1)
 #define OMV_MDMA_CHANNEL_JPEG_IN              (7) // in has a lower pri than out
 #define OMV_MDMA_CHANNEL_JPEG_OUT             (6) // out has a higher pri than in
+#define OMV_MDMA_CHANNEL_MEMCPY               (8) // memory copies have the lowest pri
 
 // AXI QoS - Low-High (0:15) - default 0
 #define OMV_AXI_QOS_MDMA_R_PRI                15 // Max pri to move data.
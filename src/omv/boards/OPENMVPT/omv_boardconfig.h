@@ -18,6 +18,12 @@
 #define OMV_BOARD_UID_SIZE                      3            // Unique ID size in words.
 #define OMV_BOARD_UID_OFFSET                    4            // Bytes offset for multi-word UIDs.
 
+// Enable the DWT cycle counter profiler (omv.profile()).
+#define OMV_PROFILE_ENABLE                    (1)
+
+// Tag fb_alloc allocations with their call site (omv.fb_alloc_stack()).
+#define OMV_FB_ALLOC_TAGS_ENABLE              (1)
+
 // JPEG configuration.
 #define OMV_JPEG_CODEC_ENABLE                   (1)
 #define OMV_JPEG_QUALITY_LOW                    (50)
@@ -117,13 +123,15 @@
 #define OMV_FB_OVERLAY_MEMORY                   AXI_SRAM // Fast fb_alloc memory.
 #define OMV_FB_OVERLAY_SIZE                     (496K)  // Fast fb_alloc memory size.
 #define OMV_JPEG_MEMORY                         DRAM    // JPEG buffer memory buffer.
-#define OMV_JPEG_BUF_SIZE                       (1024 * 1024) // IDE JPEG buffer (header + data).
+#define OMV_JPEG_BUF_SIZE                       (960 * 1024) // IDE JPEG buffer (header + data).
 #define OMV_GC_BLOCK0_MEMORY                    DRAM    // Extra GC block 0.
 #define OMV_GC_BLOCK0_SIZE                      (8M)
 #define OMV_DMA_MEMORY                          SRAM3   // DMA buffers memory.
 #define OMV_VOSPI_MEMORY                        SRAM4   // VoSPI buffer memory.
 #define OMV_SDRAM_SIZE                          (64 * 1024 * 1024)  // This needs to be here for UVC firmware.
 #define OMV_MSC_BUF_SIZE                        (2K)    // USB MSC bot data
+#define OMV_MSC_CACHE_MEMORY                    DRAM    // USB MSC read-ahead cache memory
+#define OMV_MSC_CACHE_SIZE                      (64K)   // USB MSC read-ahead cache
 #define OMV_VFS_BUF_SIZE                        (1K)    // VFS struct + FATFS file buffer (624 bytes)
 #define OMV_LINE_BUF_SIZE                       (11 * 1024) // Image line buffer round(2592 * 2BPP * 2 buffers).
 
@@ -174,6 +182,7 @@
 #define OMV_MDMA_CHANNEL_DCMI_1                 (1)
 #define OMV_MDMA_CHANNEL_JPEG_IN                (7) // in has a lower pri than out
 #define OMV_MDMA_CHANNEL_JPEG_OUT               (6) // out has a higher pri than in
+#define OMV_MDMA_CHANNEL_MEMCPY                 (8) // memory copies have the lowest pri
 
 // AXI QoS - Low-High (0:15) - default 0
 #define OMV_AXI_QOS_MDMA_R_PRI                  14 // Max pri to move data.
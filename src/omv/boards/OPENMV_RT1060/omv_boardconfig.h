@@ -18,6 +18,12 @@
 #define OMV_BOARD_UID_SIZE              3            // Unique ID size in words.
 #define OMV_BOARD_UID_OFFSET            12           // Bytes offset for multi-word UIDs.
 
+// Enable the DWT cycle counter profiler (omv.profile()).
+#define OMV_PROFILE_ENABLE              (1)
+
+// Tag fb_alloc allocations with their call site (omv.fb_alloc_stack()).
+#define OMV_FB_ALLOC_TAGS_ENABLE        (1)
+
 // JPEG configuration.
 #define OMV_JPEG_CODEC_ENABLE           (0)
 #define OMV_JPEG_QUALITY_LOW            (50)
@@ -190,6 +196,11 @@
 #define OMV_FIR_LEPTON_SCLK_PIN         (&omv_pin_LPSPI3_SCLK)
 #define OMV_FIR_LEPTON_SSEL_PIN         (&omv_pin_LPSPI3_GPIO)
 
+// Memory copy DMA configuration.
+#define OMV_MEMCPY_DMA                  (DMA0)
+#define OMV_MEMCPY_DMA_MUX              (DMAMUX)
+#define OMV_MEMCPY_DMA_CHANNEL          (6U)
+
 // Camera interface configuration.
 #define OMV_CSI_BASE                    (CSI)
 #define OMV_CSI_DMA                     (DMA0)
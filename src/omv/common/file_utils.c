@@ -18,6 +18,7 @@
 #include "fb_alloc.h"
 #include "file_utils.h"
 #define FF_MIN(x, y)    (((x) < (y))?(x):(y))
+#define FF_MAX(x, y)    (((x) > (y))?(x):(y))
 
 NORETURN static void ff_read_fail(FIL *fp) {
     if (fp) {
@@ -167,11 +168,50 @@ static uint8_t *file_buffer_pointer = 0;
 static uint32_t file_buffer_size = 0;
 static uint32_t file_buffer_index = 0;
 
+// Write-behind queue: writes to the queued file are copied into a RAM ring and written
+// out later in cluster aligned chunks by file_queue_step() (from a background task) so
+// a slow write doesn't hold up the caller. The byte at file offset N is stored at
+// ring[N % size] so the chunks written to FatFs from sector boundaries are aligned.
+
+static FIL *file_queue_fp = NULL;
+static uint8_t *file_queue_buffer = NULL;
+static uint32_t file_queue_size = 0;
+static uint32_t file_queue_chunk = 0;
+static uint32_t file_queue_count = 0;
+
+// Read-ahead ring: the reverse of the queue. file_prefetch_step() (from a background task)
+// reads cluster aligned chunks past the read position into the ring so reads are served
+// from RAM. The ring holds [start, start + count) of the file, and f_tell() is at the end.
+
+static FIL *file_prefetch_fp = NULL;
+static uint8_t *file_prefetch_buffer = NULL;
+static uint32_t file_prefetch_size = 0;
+static uint32_t file_prefetch_chunk = 0;
+static uint32_t file_prefetch_start = 0;
+static uint32_t file_prefetch_count = 0;
+
+// Preallocated file, truncated to the current position when it's closed.
+static FIL *file_prealloc_fp = NULL;
+
 void file_buffer_init0() {
     file_buffer_offset = 0;
     file_buffer_pointer = 0;
     file_buffer_size = 0;
     file_buffer_index = 0;
+    file_queue_fp = NULL;
+    file_queue_count = 0;
+    file_prefetch_fp = NULL;
+    file_prefetch_count = 0;
+    file_prealloc_fp = NULL;
+}
+
+// Returns the largest power of two sectors up to a cluster that's no larger than size.
+static uint32_t file_chunk_size(FIL *fp, uint32_t size) {
+    uint32_t chunk = fp->obj.fs->csize * FF_MIN_SS;
+    while ((chunk > FF_MIN_SS) && (chunk > size)) {
+        chunk /= 2;
+    }
+    return chunk;
 }
 
 OMV_ATTR_ALWAYS_INLINE static void file_fill(FIL *fp) {
@@ -210,13 +250,250 @@ OMV_ATTR_ALWAYS_INLINE static void file_flush(FIL *fp) {
     }
 }
 
+// Writes the queued data up to the next chunk boundary, or less (if partial) at the end.
+static bool file_queue_write_chunk(FIL *fp, bool partial) {
+    uint32_t position = f_tell(fp);
+    uint32_t chunk = file_queue_chunk - (position % file_queue_chunk);
+
+    if ((!file_queue_count) || ((!partial) && (file_queue_count < chunk))) {
+        return false;
+    }
+
+    UINT bytes;
+    uint32_t can_do = FF_MIN(chunk, file_queue_count);
+    FRESULT res = f_write(fp, file_queue_buffer + (position % file_queue_size), can_do, &bytes);
+    if ((res != FR_OK) || (bytes != can_do)) {
+        // The queued data is lost, and the file gets closed below.
+        file_queue_fp = NULL;
+        file_queue_count = 0;
+        if (res != FR_OK) {
+            file_raise_error(fp, res);
+        }
+        ff_write_fail(fp);
+    }
+
+    file_queue_count -= can_do;
+    return true;
+}
+
+static void file_queue_flush(FIL *fp) {
+    if (fp == file_queue_fp) {
+        while (file_queue_write_chunk(fp, true)) {
+        }
+    }
+}
+
+static void file_queue_write(FIL *fp, const void *data, size_t size) {
+    while (size) {
+        if (file_queue_count == file_queue_size) {
+            // The ring is full so the caller has to wait for the card.
+            file_queue_write_chunk(fp, true);
+        }
+
+        uint32_t index = (f_tell(fp) + file_queue_count) % file_queue_size;
+        uint32_t can_do = FF_MIN(size, FF_MIN(file_queue_size - file_queue_count, file_queue_size - index));
+        memcpy(file_queue_buffer + index, data, can_do);
+        file_queue_count += can_do;
+        data += can_do;
+        size -= can_do;
+    }
+}
+
+void file_queue_on(FIL *fp, void *buffer, uint32_t size) {
+    if (file_queue_fp) {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Another file is already queued!"));
+    }
+
+    // A chunk is a cluster (or less with a small ring), the ring holds a whole number of them.
+    uint32_t chunk = file_chunk_size(fp, size / 2);
+
+    if (size < (chunk * 2)) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Queue size too small!"));
+    }
+
+    file_queue_buffer = buffer;
+    file_queue_chunk = chunk;
+    file_queue_size = (size / chunk) * chunk;
+    file_queue_count = 0;
+    file_queue_fp = fp;
+}
+
+void file_queue_off(FIL *fp) {
+    if (fp == file_queue_fp) {
+        file_queue_flush(fp);
+        file_queue_fp = NULL;
+    }
+}
+
+bool file_queue_step(FIL *fp) {
+    return (fp == file_queue_fp) && file_queue_write_chunk(fp, false);
+}
+
+uint32_t file_queue_pending(FIL *fp) {
+    return (fp == file_queue_fp) ? file_queue_count : 0;
+}
+
+// Reads the file from the end of the ring up to the next chunk boundary (or the end of the
+// file) if there's room for it. Returns false if nothing was read.
+static bool file_prefetch_read_chunk(FIL *fp) {
+    uint32_t position = f_tell(fp);
+    uint32_t chunk = file_prefetch_chunk - (position % file_prefetch_chunk);
+    uint32_t can_do = FF_MIN(chunk, f_size(fp) - position);
+
+    if ((!can_do) || ((file_prefetch_size - file_prefetch_count) < chunk)) {
+        return false;
+    }
+
+    UINT bytes;
+    FRESULT res = f_read(fp, file_prefetch_buffer + (position % file_prefetch_size), can_do, &bytes);
+    if (res != FR_OK) {
+        file_prefetch_fp = NULL;
+        file_raise_error(fp, res);
+    }
+    if (bytes != can_do) {
+        file_prefetch_fp = NULL;
+        ff_read_fail(fp);
+    }
+
+    file_prefetch_count += can_do;
+    return true;
+}
+
+// Throws away the data read ahead and moves the file back to the read position.
+static void file_prefetch_drop(FIL *fp) {
+    if ((fp == file_prefetch_fp) && file_prefetch_count) {
+        file_prefetch_count = 0;
+        FRESULT res = f_lseek(fp, file_prefetch_start);
+        if (res != FR_OK) {
+            file_prefetch_fp = NULL;
+            file_raise_error(fp, res);
+        }
+    }
+}
+
+static void file_prefetch_read(FIL *fp, uint8_t *data, size_t size) {
+    while (size) {
+        if (!file_prefetch_count) {
+            // Reads as many whole chunks as possible past the ring when the caller is waiting
+            // for more than a chunk, otherwise it waits for the next chunk.
+            if ((size >= file_prefetch_chunk) && (!(((uintptr_t) data) % 4))) {
+                UINT bytes;
+                uint32_t can_do = (size / file_prefetch_chunk) * file_prefetch_chunk;
+                FRESULT res = f_read(fp, data, can_do, &bytes);
+                if (res != FR_OK) {
+                    file_prefetch_fp = NULL;
+                    file_raise_error(fp, res);
+                }
+                if (bytes != can_do) {
+                    file_prefetch_fp = NULL;
+                    ff_read_fail(fp);
+                }
+                file_prefetch_start += can_do;
+                data += can_do;
+                size -= can_do;
+                continue;
+            }
+
+            if (!file_prefetch_read_chunk(fp)) {
+                file_prefetch_fp = NULL;
+                ff_read_fail(fp);
+            }
+        }
+
+        uint32_t index = file_prefetch_start % file_prefetch_size;
+        uint32_t can_do = FF_MIN(size, FF_MIN(file_prefetch_count, file_prefetch_size - index));
+        memcpy(data, file_prefetch_buffer + index, can_do);
+        file_prefetch_start += can_do;
+        file_prefetch_count -= can_do;
+        data += can_do;
+        size -= can_do;
+    }
+}
+
+void file_prefetch_on(FIL *fp, void *buffer, uint32_t size) {
+    if (file_prefetch_fp) {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Another file is already prefetched!"));
+    }
+
+    // A chunk is a cluster (or less with a small ring), the ring holds a whole number of them
+    // so one can be read while the caller reads another.
+    uint32_t chunk = file_chunk_size(fp, size / 2);
+
+    if (size < (chunk * 2)) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Prefetch size too small!"));
+    }
+
+    file_prefetch_buffer = buffer;
+    file_prefetch_chunk = chunk;
+    file_prefetch_size = (size / chunk) * chunk;
+    file_prefetch_start = f_tell(fp);
+    file_prefetch_count = 0;
+    file_prefetch_fp = fp;
+}
+
+void file_prefetch_off(FIL *fp) {
+    if (fp == file_prefetch_fp) {
+        file_prefetch_drop(fp);
+        file_prefetch_fp = NULL;
+    }
+}
+
+bool file_prefetch_step(FIL *fp) {
+    return (fp == file_prefetch_fp) && file_prefetch_read_chunk(fp);
+}
+
+void file_preallocate(FIL *fp, uint32_t size) {
+    uint32_t position = f_tell(fp);
+
+    if (size <= f_size(fp)) {
+        return;
+    }
+
+    #if FF_USE_EXPAND
+    FRESULT res = f_expand(fp, size, 1);
+    #else
+    // Seeking past the end of a file opened for writing allocates the cluster chain
+    // in one go, new clusters come from after the last one allocated so the chain is
+    // contiguous on a card that isn't fragmented. It stops early if the disk is full.
+    FRESULT res = f_lseek(fp, size);
+    if ((res == FR_OK) && (f_tell(fp) != size)) {
+        res = FR_DENIED;
+    }
+    #endif
+
+    if (res == FR_OK) {
+        res = f_lseek(fp, position);
+    }
+
+    if (res != FR_OK) {
+        file_raise_error(fp, res);
+    }
+
+    file_prealloc_fp = fp;
+}
+
 void file_buffer_on(FIL *fp) {
-    file_buffer_offset = f_tell(fp) % 4;
-    file_buffer_pointer = fb_alloc_all(&file_buffer_size, FB_ALLOC_PREFER_SIZE) + file_buffer_offset;
-    if (!file_buffer_size) {
+    uint32_t size;
+    uint8_t *buffer = fb_alloc_all(&size, FB_ALLOC_PREFER_SIZE);
+    uint32_t align = (OMV_ALLOC_ALIGNMENT - (((uintptr_t) buffer) % OMV_ALLOC_ALIGNMENT)) % OMV_ALLOC_ALIGNMENT;
+    if (size <= align) {
         mp_raise_msg(&mp_type_MemoryError, MP_ERROR_TEXT("No memory!"));
     }
-    file_buffer_size -= file_buffer_offset;
+    buffer += align;
+    size -= align;
+
+    // The buffer starts on a cache line and holds whole sectors, and the first transfer ends
+    // on a sector boundary, so every transfer after it moves whole sectors straight between
+    // the disk and the buffer (with DMA) instead of going through the FatFs window.
+    if (size >= FF_MIN_SS) {
+        size = (size / FF_MIN_SS) * FF_MIN_SS;
+        file_buffer_offset = f_tell(fp) % FF_MIN_SS;
+    } else {
+        file_buffer_offset = f_tell(fp) % 4;
+    }
+
+    file_buffer_pointer = buffer + file_buffer_offset;
+    file_buffer_size = size - file_buffer_offset;
     file_buffer_index = 0;
     if (fp->flag & FA_READ) {
         uint32_t file_remaining = f_size(fp) - f_tell(fp);
@@ -262,20 +539,50 @@ void file_close(FIL *fp) {
         file_buffer_off(fp);
     }
 
-    FRESULT res = f_close(fp);
+    file_queue_off(fp);
+    file_prefetch_off(fp);
+
+    FRESULT res = FR_OK;
+    if (fp == file_prealloc_fp) {
+        file_prealloc_fp = NULL;
+        res = f_truncate(fp);
+    }
+
+    if (res == FR_OK) {
+        res = f_close(fp);
+    }
     if (res != FR_OK) {
         file_raise_error(fp, res);
     }
 }
 
 void file_seek(FIL *fp, UINT offset) {
+    file_queue_flush(fp);
+
+    if (fp == file_prefetch_fp) {
+        // Seeking forward within the ring just skips the data read ahead.
+        uint32_t skip = offset - file_prefetch_start;
+        if ((offset >= file_prefetch_start) && (skip <= file_prefetch_count)) {
+            file_prefetch_start = offset;
+            file_prefetch_count -= skip;
+            return;
+        }
+        file_prefetch_count = 0;
+    }
+
     FRESULT res = f_lseek(fp, offset);
     if (res != FR_OK) {
         file_raise_error(fp, res);
     }
+
+    if (fp == file_prefetch_fp) {
+        file_prefetch_start = f_tell(fp);
+    }
 }
 
 void file_truncate(FIL *fp) {
+    file_queue_flush(fp);
+    file_prefetch_drop(fp);
     FRESULT res = f_truncate(fp);
     if (res != FR_OK) {
         file_raise_error(fp, res);
@@ -283,6 +590,7 @@ void file_truncate(FIL *fp) {
 }
 
 void file_sync(FIL *fp) {
+    file_queue_flush(fp);
     FRESULT res = f_sync(fp);
     if (res != FR_OK) {
         file_raise_error(fp, res);
@@ -290,6 +598,9 @@ void file_sync(FIL *fp) {
 }
 
 uint32_t file_tell(FIL *fp) {
+    if (fp == file_prefetch_fp) {
+        return file_prefetch_start;
+    }
     if (file_buffer_pointer) {
         if (fp->flag & FA_READ) {
             return f_tell(fp) - file_buffer_size + file_buffer_index;
@@ -297,7 +608,7 @@ uint32_t file_tell(FIL *fp) {
             return f_tell(fp) + file_buffer_index;
         }
     }
-    return f_tell(fp);
+    return f_tell(fp) + file_queue_pending(fp);
 }
 
 uint32_t file_size(FIL *fp) {
@@ -308,10 +619,26 @@ uint32_t file_size(FIL *fp) {
             return f_size(fp) + file_buffer_index;
         }
     }
-    return f_size(fp);
+    if (fp == file_prealloc_fp) {
+        return f_tell(fp) + file_queue_pending(fp);
+    }
+    return FF_MAX(f_size(fp), f_tell(fp) + file_queue_pending(fp));
 }
 
 void file_read(FIL *fp, void *data, size_t size) {
+    if (fp == file_prefetch_fp) {
+        if (data == NULL) {
+            if (size > (f_size(fp) - file_prefetch_start)) {
+                file_prefetch_fp = NULL;
+                ff_read_fail(fp);
+            }
+            file_seek(fp, file_prefetch_start + size);
+        } else {
+            file_prefetch_read(fp, data, size);
+        }
+        return;
+    }
+
     if (data == NULL) {
         uint8_t byte;
         if (file_buffer_pointer) {
@@ -364,7 +691,11 @@ void file_read(FIL *fp, void *data, size_t size) {
 }
 
 void file_write(FIL *fp, const void *data, size_t size) {
-    if (file_buffer_pointer) {
+    file_prefetch_drop(fp);
+
+    if (fp == file_queue_fp) {
+        file_queue_write(fp, data, size);
+    } else if (file_buffer_pointer) {
         // We get a massive speed boost by buffering up as much data as possible
         // before a write to the SD card. So much so that the time wasted by
         // all these operations does not cost us.
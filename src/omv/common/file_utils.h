@@ -36,7 +36,19 @@ void file_buffer_init0();
 void file_buffer_on(FIL *fp);  // Calls fb_alloc_all()
 void file_buffer_off(FIL *fp); // Calls fb_free()
 
+// Write-behind queue functions (one file at a time).
+void file_queue_on(FIL *fp, void *buffer, uint32_t size);
+void file_queue_off(FIL *fp); // Flushes the queue.
+bool file_queue_step(FIL *fp); // Writes one chunk, returns false if there's less queued.
+uint32_t file_queue_pending(FIL *fp);
+
+// Read-ahead ring functions (one file at a time).
+void file_prefetch_on(FIL *fp, void *buffer, uint32_t size);
+void file_prefetch_off(FIL *fp); // Moves the file back to the read position.
+bool file_prefetch_step(FIL *fp); // Reads one chunk, returns false if the ring is full or at the end.
+
 void file_open(FIL *fp, const char *path, bool buffered, uint32_t flags);
+void file_preallocate(FIL *fp, uint32_t size); // Truncated to the current position on close.
 void file_close(FIL *fp);
 void file_seek(FIL *fp, UINT offset);
 void file_truncate(FIL *fp);
@@ -0,0 +1,108 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Memory region cache policies and cache maintenance.
+ */
+#include "omv_boardconfig.h"
+#include "omv_cache.h"
+
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+typedef struct {
+    uint32_t number;
+    uint32_t base;
+    uint32_t size;  // MPU_REGION_SIZE_xxx code.
+    omv_cache_policy_t policy;
+} omv_cache_region_t;
+
+// Higher region numbers take priority where regions overlap, so they're listed first.
+static const omv_cache_region_t omv_cache_regions[] = {
+    #if defined(OMV_DMA_REGION_D1_BASE)
+    { 15, OMV_DMA_REGION_D1_BASE, OMV_DMA_REGION_D1_SIZE, OMV_CACHE_DISABLED },
+    #endif
+    #if defined(OMV_DMA_REGION_D2_BASE)
+    { 14, OMV_DMA_REGION_D2_BASE, OMV_DMA_REGION_D2_SIZE, OMV_CACHE_DISABLED },
+    #endif
+    #if defined(OMV_DMA_REGION_D3_BASE)
+    { 13, OMV_DMA_REGION_D3_BASE, OMV_DMA_REGION_D3_SIZE, OMV_CACHE_DISABLED },
+    #endif
+    #if defined(OMV_FB_REGION_BASE)
+    { 12, OMV_FB_REGION_BASE, OMV_FB_REGION_SIZE, OMV_FB_REGION_POLICY },
+    #endif
+    { 0, 0, 0, OMV_CACHE_WRITE_BACK }, // Terminator.
+};
+
+// The region size code n covers 2^(n + 1) bytes.
+static inline uint64_t omv_cache_region_end(const omv_cache_region_t *region) {
+    return region->base + (1ULL << (region->size + 1));
+}
+
+void omv_cache_mpu_init() {
+    // Nothing to configure, keep the MPU setup of the bootloader/ROM.
+    if (!omv_cache_regions[0].size) {
+        return;
+    }
+
+    __DSB(); __ISB();
+    ARM_MPU_Disable();
+
+    uint32_t n_regions = (MPU->TYPE & MPU_TYPE_DREGION_Msk) >> MPU_TYPE_DREGION_Pos;
+    for (uint32_t i = 0; i < n_regions; i++) {
+        ARM_MPU_ClrRegion(i);
+    }
+
+    for (const omv_cache_region_t *region = omv_cache_regions; region->size; region++) {
+        // TEX, C, B: Normal memory, write-back write/read allocate, write-through no write allocate, or non-cacheable.
+        uint32_t tex = (region->policy == OMV_CACHE_WRITE_THROUGH) ? 0 : 1;
+        uint32_t c = (region->policy == OMV_CACHE_DISABLED) ? 0 : 1;
+        uint32_t b = (region->policy == OMV_CACHE_WRITE_BACK) ? 1 : 0;
+        ARM_MPU_SetRegionEx(region->number, ARM_MPU_RBAR(region->number, region->base),
+                            ARM_MPU_RASR(0, ARM_MPU_AP_FULL, tex, 0, c, b, 0x00, region->size));
+    }
+
+    ARM_MPU_Enable(MPU_CTRL_PRIVDEFENA_Msk);
+    __DSB(); __ISB();
+}
+
+omv_cache_policy_t omv_cache_get_policy(const void *addr, uint32_t size) {
+    uint64_t start = (uint32_t) addr;
+    uint64_t end = start + size;
+
+    for (const omv_cache_region_t *region = omv_cache_regions; region->size; region++) {
+        if ((start >= region->base) && (end <= omv_cache_region_end(region))) {
+            return region->policy;
+        }
+    }
+
+    return OMV_CACHE_WRITE_BACK;
+}
+
+void omv_cache_clean(const void *addr, uint32_t size) {
+    if (omv_cache_get_policy(addr, size) == OMV_CACHE_WRITE_BACK) {
+        SCB_CleanDCache_by_Addr((uint32_t *) addr, size);
+    }
+}
+
+void omv_cache_invalidate(void *addr, uint32_t size) {
+    if (omv_cache_get_policy(addr, size) != OMV_CACHE_DISABLED) {
+        SCB_InvalidateDCache_by_Addr(addr, size);
+    }
+}
+
+void omv_cache_clean_invalidate(void *addr, uint32_t size) {
+    switch (omv_cache_get_policy(addr, size)) {
+        case OMV_CACHE_WRITE_BACK:
+            SCB_CleanInvalidateDCache_by_Addr(addr, size);
+            break;
+        case OMV_CACHE_WRITE_THROUGH:
+            SCB_InvalidateDCache_by_Addr(addr, size);
+            break;
+        default:
+            break;
+    }
+}
+#endif // __DCACHE_PRESENT
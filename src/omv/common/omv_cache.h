@@ -0,0 +1,55 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Memory region cache policies and cache maintenance.
+ *
+ * The MPU regions are configured once from the board config. Cache maintenance
+ * goes through the helpers below, which do only what the policy of the region
+ * an address is in requires. Nothing is needed for non-cacheable memory, and
+ * nothing is dirty in write-through memory. Memory outside of the regions is write-back.
+ */
+#ifndef __OMV_CACHE_H__
+#define __OMV_CACHE_H__
+#include <stdint.h>
+#include CMSIS_MCU_H
+
+typedef enum {
+    OMV_CACHE_WRITE_BACK,       // Fastest for the CPU, clean before DMA reads and invalidate after DMA writes.
+    OMV_CACHE_WRITE_THROUGH,    // Writes go to memory, only invalidate after DMA writes.
+    OMV_CACHE_DISABLED,         // No maintenance, slowest for the CPU.
+} omv_cache_policy_t;
+
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+// Configures the regions in the board config, call with the caches disabled.
+void omv_cache_mpu_init();
+// The policy of the memory [addr, addr + size), write-back if it spans more than one region.
+omv_cache_policy_t omv_cache_get_policy(const void *addr, uint32_t size);
+// Before a peripheral reads the memory.
+void omv_cache_clean(const void *addr, uint32_t size);
+// After a peripheral wrote the memory.
+void omv_cache_invalidate(void *addr, uint32_t size);
+// Before a peripheral writes memory the CPU wrote to before.
+void omv_cache_clean_invalidate(void *addr, uint32_t size);
+#else
+static inline void omv_cache_mpu_init() {
+}
+
+static inline omv_cache_policy_t omv_cache_get_policy(const void *addr, uint32_t size) {
+    return OMV_CACHE_DISABLED;
+}
+
+static inline void omv_cache_clean(const void *addr, uint32_t size) {
+}
+
+static inline void omv_cache_invalidate(void *addr, uint32_t size) {
+}
+
+static inline void omv_cache_clean_invalidate(void *addr, uint32_t size) {
+}
+#endif // __DCACHE_PRESENT
+#endif // __OMV_CACHE_H__
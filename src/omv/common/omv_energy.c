@@ -0,0 +1,157 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Energy accounting.
+ */
+#include <string.h>
+#include "py/mphal.h"
+#include CMSIS_MCU_H
+#include "trace.h"
+#include "omv_energy.h"
+
+#ifndef __weak
+#define __weak    __attribute__((weak))
+#endif
+
+typedef struct _omv_energy_state_t {
+    bool initialized;
+    uint32_t last_us;           // Time of the last update.
+    uint32_t frame_us;          // Time of the last frame.
+    uint64_t frame_start_nj;    // Total energy at the last frame.
+    int cpu_index;
+    omv_energy_sensor_t sensor;
+    uint32_t periph;            // Active peripherals mask.
+    omv_energy_stats_t stats;
+} omv_energy_state_t;
+
+static omv_energy_state_t omv_energy;
+
+static const uint16_t omv_energy_sensor_mw[OMV_ENERGY_SENSOR_STATES] = {
+    [OMV_ENERGY_SENSOR_ON] = OMV_ENERGY_SENSOR_ON_MW,
+    [OMV_ENERGY_SENSOR_SLEEP] = OMV_ENERGY_SENSOR_SLEEP_MW,
+    [OMV_ENERGY_SENSOR_OFF] = 0,
+};
+
+static const uint16_t omv_energy_periph_mw[OMV_ENERGY_PERIPH_MAX] = {
+    [OMV_ENERGY_PERIPH_WIFI] = OMV_ENERGY_WIFI_MW,
+    [OMV_ENERGY_PERIPH_DISPLAY] = OMV_ENERGY_DISPLAY_MW,
+};
+
+__weak int32_t omv_energy_read_power_mw() {
+    return -1;
+}
+
+// Returns the time in state slot of a frequency, frequencies past the last slot share it.
+static int omv_energy_cpu_index(uint32_t mhz) {
+    omv_energy_stats_t *stats = &omv_energy.stats;
+
+    for (int i = 0; i < OMV_ENERGY_CPU_FREQS; i++) {
+        if ((stats->cpu_mhz[i] == mhz) || (!stats->cpu_mhz[i])) {
+            stats->cpu_mhz[i] = mhz;
+            return i;
+        }
+    }
+
+    return OMV_ENERGY_CPU_FREQS - 1;
+}
+
+static uint32_t omv_energy_estimate_mw() {
+    const omv_energy_stats_t *stats = &omv_energy.stats;
+    uint32_t mw = OMV_ENERGY_BASE_MW + omv_energy_sensor_mw[omv_energy.sensor];
+
+    mw += (stats->cpu_mhz[omv_energy.cpu_index] * OMV_ENERGY_CPU_UW_PER_MHZ) / 1000;
+
+    for (int i = 0; i < OMV_ENERGY_PERIPH_MAX; i++) {
+        if (omv_energy.periph & (1 << i)) {
+            mw += omv_energy_periph_mw[i];
+        }
+    }
+
+    return mw;
+}
+
+// Charges the time since the last update to the current states.
+static void omv_energy_update() {
+    omv_energy_stats_t *stats = &omv_energy.stats;
+    uint32_t now = mp_hal_ticks_us();
+
+    if (!omv_energy.initialized) {
+        omv_energy.initialized = true;
+        omv_energy.last_us = now;
+        omv_energy.frame_us = now;
+        omv_energy.cpu_index = omv_energy_cpu_index(SystemCoreClock / 1000000);
+        omv_energy.sensor = OMV_ENERGY_SENSOR_ON;
+        return;
+    }
+
+    uint32_t us = now - omv_energy.last_us;
+    int32_t mw = omv_energy_read_power_mw();
+
+    stats->measured = mw >= 0;
+    stats->total_nj += ((uint64_t) ((mw >= 0) ? mw : omv_energy_estimate_mw())) * us;
+    stats->cpu_us[omv_energy.cpu_index] += us;
+    stats->sensor_us[omv_energy.sensor] += us;
+
+    for (int i = 0; i < OMV_ENERGY_PERIPH_MAX; i++) {
+        if (omv_energy.periph & (1 << i)) {
+            stats->periph_us[i] += us;
+        }
+    }
+
+    omv_energy.last_us = now;
+}
+
+void omv_energy_set_cpu(uint32_t mhz) {
+    omv_energy_update();
+    omv_energy.cpu_index = omv_energy_cpu_index(mhz);
+    TRACE_EVENT(TRACE_PROF_POWER_STATE, TRACE_EVENT_INSTANT);
+}
+
+void omv_energy_set_sensor(omv_energy_sensor_t state) {
+    omv_energy_update();
+    omv_energy.sensor = state;
+    TRACE_EVENT(TRACE_PROF_POWER_STATE, TRACE_EVENT_INSTANT);
+}
+
+void omv_energy_set_periph(omv_energy_periph_t periph, bool active) {
+    omv_energy_update();
+    if (active) {
+        omv_energy.periph |= 1 << periph;
+    } else {
+        omv_energy.periph &= ~(1 << periph);
+    }
+    TRACE_EVENT(TRACE_PROF_POWER_STATE, TRACE_EVENT_INSTANT);
+}
+
+void omv_energy_frame() {
+    omv_energy_stats_t *stats = &omv_energy.stats;
+    omv_energy_update();
+    stats->frame_nj = stats->total_nj - omv_energy.frame_start_nj;
+    stats->frame_us = omv_energy.last_us - omv_energy.frame_us;
+    stats->frames += 1;
+    omv_energy.frame_start_nj = stats->total_nj;
+    omv_energy.frame_us = omv_energy.last_us;
+}
+
+const omv_energy_stats_t *omv_energy_get() {
+    omv_energy_update();
+    return &omv_energy.stats;
+}
+
+void omv_energy_reset() {
+    omv_energy_stats_t *stats = &omv_energy.stats;
+    omv_energy_update();
+
+    // Keep the frequency slot of the current state.
+    uint16_t mhz = stats->cpu_mhz[omv_energy.cpu_index];
+    memset(stats, 0, sizeof(omv_energy_stats_t));
+    stats->cpu_mhz[0] = mhz;
+    omv_energy.cpu_index = 0;
+    omv_energy.frame_start_nj = 0;
+    omv_energy.frame_us = omv_energy.last_us;
+}
@@ -0,0 +1,87 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Energy accounting.
+ *
+ * Tracks the time spent in each power state (CPU frequency, sensor and peripheral states)
+ * and integrates the power of the current state over time. The power is read from the board's
+ * current sense ADC if it has one (see omv_energy_read_power_mw()), otherwise it's estimated
+ * from the OMV_ENERGY_xxx board config constants. State changes are timeline events too.
+ */
+#ifndef __OMV_ENERGY_H__
+#define __OMV_ENERGY_H__
+#include <stdint.h>
+#include <stdbool.h>
+#include "omv_boardconfig.h"
+
+// Estimated power draw in mW, boards override these with measured values.
+#ifndef OMV_ENERGY_BASE_MW
+#define OMV_ENERGY_BASE_MW              (30)    // Board idle, CPU clock gated.
+#endif
+
+#ifndef OMV_ENERGY_CPU_UW_PER_MHZ
+#define OMV_ENERGY_CPU_UW_PER_MHZ       (250)   // CPU and bus matrix per MHz.
+#endif
+
+#ifndef OMV_ENERGY_SENSOR_ON_MW
+#define OMV_ENERGY_SENSOR_ON_MW         (60)
+#endif
+
+#ifndef OMV_ENERGY_SENSOR_SLEEP_MW
+#define OMV_ENERGY_SENSOR_SLEEP_MW      (5)
+#endif
+
+#ifndef OMV_ENERGY_WIFI_MW
+#define OMV_ENERGY_WIFI_MW              (250)
+#endif
+
+#ifndef OMV_ENERGY_DISPLAY_MW
+#define OMV_ENERGY_DISPLAY_MW           (40)
+#endif
+
+// Number of CPU frequencies with their own time in state.
+#define OMV_ENERGY_CPU_FREQS            (8)
+
+typedef enum {
+    OMV_ENERGY_SENSOR_ON,
+    OMV_ENERGY_SENSOR_SLEEP,
+    OMV_ENERGY_SENSOR_OFF,
+    OMV_ENERGY_SENSOR_STATES
+} omv_energy_sensor_t;
+
+typedef enum {
+    OMV_ENERGY_PERIPH_WIFI,
+    OMV_ENERGY_PERIPH_DISPLAY,
+    OMV_ENERGY_PERIPH_MAX
+} omv_energy_periph_t;
+
+typedef struct _omv_energy_stats_t {
+    uint64_t total_nj;          // Since the last reset.
+    uint64_t frame_nj;          // Between the last two frames.
+    uint32_t frame_us;
+    uint32_t frames;
+    bool measured;              // The power was read from the current sense ADC.
+    uint16_t cpu_mhz[OMV_ENERGY_CPU_FREQS];     // 0 if unused.
+    uint64_t cpu_us[OMV_ENERGY_CPU_FREQS];
+    uint64_t sensor_us[OMV_ENERGY_SENSOR_STATES];
+    uint64_t periph_us[OMV_ENERGY_PERIPH_MAX];  // Active time.
+} omv_energy_stats_t;
+
+// Call after the CPU frequency changed.
+void omv_energy_set_cpu(uint32_t mhz);
+void omv_energy_set_sensor(omv_energy_sensor_t state);
+void omv_energy_set_periph(omv_energy_periph_t periph, bool active);
+// Call once per frame, the energy since the previous call is the frame energy.
+void omv_energy_frame();
+// Returns the stats updated to now.
+const omv_energy_stats_t *omv_energy_get();
+// Clears the stats, keeping the current states.
+void omv_energy_reset();
+// Returns the board power draw in mW, or -1 without a current sense ADC (the default).
+int32_t omv_energy_read_power_mw();
+#endif // __OMV_ENERGY_H__
@@ -38,20 +38,46 @@ typedef enum omv_i2c_xfer_flags {
     OMV_I2C_XFER_RESTART =   (1 << 3),
 } omv_i2c_xfer_flags_t;
 
-typedef struct _omv_i2c {
+typedef struct _omv_i2c omv_i2c_t;
+typedef struct _omv_i2c_transfer omv_i2c_transfer_t;
+
+// Called when a queued transfer completes or fails, possibly from an IRQ. Callbacks may
+// submit more transfers, e.g. to read the next block of registers.
+typedef void (*omv_i2c_callback_t) (omv_i2c_t *i2c, omv_i2c_transfer_t *xfer, void *userdata);
+
+// A queued transfer writes wlen bytes (usually a register address) and then reads rlen
+// bytes after a repeated start. Either part may be empty.
+typedef struct _omv_i2c_transfer {
+    uint8_t slv_addr;
+    uint8_t *wbuf;
+    uint32_t wlen;
+    uint8_t *rbuf;
+    uint32_t rlen;
+    void *userdata;
+    omv_i2c_callback_t callback;
+    // Set to 1 while queued, then 0 on success or -1 on failure.
+    volatile int status;
+    struct _omv_i2c_transfer *next;
+} omv_i2c_transfer_t;
+
+struct _omv_i2c {
     uint32_t id;
     uint32_t speed;
     uint32_t initialized;
     omv_gpio_t scl_pin;
     omv_gpio_t sda_pin;
     omv_i2c_dev_t inst;
+    // Transfer queue, the head is the transfer in progress.
+    omv_i2c_transfer_t *xfer_head;
+    omv_i2c_transfer_t *xfer_tail;
+    volatile bool xfer_busy;
     #ifdef OMV_I2C_PORT_BITS
     // Additional port-specific fields like device base pointer,
     // dma handles, more I/Os etc... are included directly here,
     // so that they can be accessible from this struct.
     OMV_I2C_PORT_BITS
     #endif
-} omv_i2c_t;
+};
 
 int omv_i2c_init(omv_i2c_t *i2c, uint32_t bus_id, uint32_t speed);
 int omv_i2c_deinit(omv_i2c_t *i2c);
@@ -69,4 +95,21 @@ int omv_i2c_readw2(omv_i2c_t *i2c, uint8_t slv_addr, uint16_t reg_addr,  uint16_
 int omv_i2c_writew2(omv_i2c_t *i2c, uint8_t slv_addr, uint16_t reg_addr, uint16_t reg_data);
 int omv_i2c_read_bytes(omv_i2c_t *i2c, uint8_t slv_addr, uint8_t *buf, int len, uint32_t flags);
 int omv_i2c_write_bytes(omv_i2c_t *i2c, uint8_t slv_addr, uint8_t *buf, int len, uint32_t flags);
+
+// Queues a transfer and returns right away, the transfer must stay valid until it completes.
+// Transfers run in order. Don't mix the blocking functions above with pending transfers.
+int omv_i2c_transfer_submit(omv_i2c_t *i2c, omv_i2c_transfer_t *xfer);
+// Waits for a queued transfer and returns its status. On timeout the queue is aborted.
+int omv_i2c_transfer_wait(omv_i2c_t *i2c, omv_i2c_transfer_t *xfer, uint32_t timeout);
+// Blocking transfer through the queue.
+int omv_i2c_transfer(omv_i2c_t *i2c, omv_i2c_transfer_t *xfer);
+// Fails all queued transfers and stops the one in progress.
+void omv_i2c_transfer_abort(omv_i2c_t *i2c);
+
+// Port hooks. transfer_start returns 1 if the transfer is running in the background, in which
+// case the port calls omv_i2c_transfer_complete() when it's done, or its status if it already
+// completed. Ports without background transfers use the default which calls the functions above.
+int omv_i2c_transfer_start(omv_i2c_t *i2c, omv_i2c_transfer_t *xfer);
+void omv_i2c_transfer_stop(omv_i2c_t *i2c);
+void omv_i2c_transfer_complete(omv_i2c_t *i2c, int status);
 #endif // __OMV_I2C_H__
@@ -0,0 +1,163 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Queued I2C transfers.
+ */
+#include <stddef.h>
+#include "cmsis_compiler.h"
+#include "py/mphal.h"
+#include "omv_i2c.h"
+
+#ifndef __weak
+#define __weak    __attribute__((weak))
+#endif
+
+#define OMV_I2C_XFER_QUEUED    (1)
+
+// Ports without background transfers run them with the blocking functions, so
+// queued transfers complete before omv_i2c_transfer_submit() returns.
+__weak int omv_i2c_transfer_start(omv_i2c_t *i2c, omv_i2c_transfer_t *xfer) {
+    if (xfer->wlen && omv_i2c_write_bytes(i2c, xfer->slv_addr, xfer->wbuf, xfer->wlen,
+                                          xfer->rlen ? OMV_I2C_XFER_NO_STOP : OMV_I2C_XFER_NO_FLAGS)) {
+        return -1;
+    }
+
+    if (xfer->rlen && omv_i2c_read_bytes(i2c, xfer->slv_addr, xfer->rbuf, xfer->rlen, OMV_I2C_XFER_NO_FLAGS)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+__weak void omv_i2c_transfer_stop(omv_i2c_t *i2c) {
+
+}
+
+// Removes the transfer at the head of the queue and runs its callback.
+static void omv_i2c_transfer_finish(omv_i2c_t *i2c, int status) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    omv_i2c_transfer_t *xfer = i2c->xfer_head;
+
+    if (xfer) {
+        i2c->xfer_head = xfer->next;
+        if (!i2c->xfer_head) {
+            i2c->xfer_tail = NULL;
+        }
+    }
+
+    __set_PRIMASK(primask);
+
+    if (xfer) {
+        xfer->status = status;
+        if (xfer->callback) {
+            xfer->callback(i2c, xfer, xfer->userdata);
+        }
+    }
+}
+
+// Starts queued transfers until one is left running in the background or the queue is empty.
+static void omv_i2c_transfer_next(omv_i2c_t *i2c) {
+    for (;;) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        omv_i2c_transfer_t *xfer = i2c->xfer_head;
+
+        if (i2c->xfer_busy || !xfer) {
+            __set_PRIMASK(primask);
+            return;
+        }
+
+        i2c->xfer_busy = true;
+        __set_PRIMASK(primask);
+
+        int status = (xfer->wlen || xfer->rlen) ? omv_i2c_transfer_start(i2c, xfer) : 0;
+
+        // The port calls omv_i2c_transfer_complete() which starts the next transfer.
+        if (status == OMV_I2C_XFER_QUEUED) {
+            return;
+        }
+
+        omv_i2c_transfer_finish(i2c, status);
+        i2c->xfer_busy = false;
+    }
+}
+
+void omv_i2c_transfer_complete(omv_i2c_t *i2c, int status) {
+    omv_i2c_transfer_finish(i2c, status);
+    i2c->xfer_busy = false;
+    omv_i2c_transfer_next(i2c);
+}
+
+int omv_i2c_transfer_submit(omv_i2c_t *i2c, omv_i2c_transfer_t *xfer) {
+    if (!i2c->initialized) {
+        return -1;
+    }
+
+    xfer->status = OMV_I2C_XFER_QUEUED;
+    xfer->next = NULL;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (i2c->xfer_tail) {
+        i2c->xfer_tail->next = xfer;
+    } else {
+        i2c->xfer_head = xfer;
+    }
+
+    i2c->xfer_tail = xfer;
+    __set_PRIMASK(primask);
+
+    omv_i2c_transfer_next(i2c);
+    return 0;
+}
+
+int omv_i2c_transfer_wait(omv_i2c_t *i2c, omv_i2c_transfer_t *xfer, uint32_t timeout) {
+    mp_uint_t tick_start = mp_hal_ticks_ms();
+    while (xfer->status == OMV_I2C_XFER_QUEUED) {
+        if ((mp_hal_ticks_ms() - tick_start) >= timeout) {
+            omv_i2c_transfer_abort(i2c);
+            break;
+        }
+        __WFI();
+    }
+    return xfer->status;
+}
+
+int omv_i2c_transfer(omv_i2c_t *i2c, omv_i2c_transfer_t *xfer) {
+    if (omv_i2c_transfer_submit(i2c, xfer) != 0) {
+        return -1;
+    }
+    return omv_i2c_transfer_wait(i2c, xfer, 1000);
+}
+
+void omv_i2c_transfer_abort(omv_i2c_t *i2c) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (i2c->xfer_busy) {
+        omv_i2c_transfer_stop(i2c);
+    }
+
+    omv_i2c_transfer_t *xfer = i2c->xfer_head;
+    i2c->xfer_head = NULL;
+    i2c->xfer_tail = NULL;
+    i2c->xfer_busy = false;
+    __set_PRIMASK(primask);
+
+    for (omv_i2c_transfer_t *next; xfer; xfer = next) {
+        next = xfer->next;
+        xfer->status = -1;
+        if (xfer->callback) {
+            xfer->callback(i2c, xfer, xfer->userdata);
+        }
+    }
+}
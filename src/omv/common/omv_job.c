@@ -0,0 +1,87 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Background jobs.
+ */
+#include "py/mphal.h"
+#include "py/runtime.h"
+#include "pendsv.h"
+#include "omv_job.h"
+
+static omv_job_t *omv_job_head;
+static omv_job_t *omv_job_tail;
+static bool omv_job_running;
+
+#if defined(PENDSV_DISPATCH_NUM_SLOTS)
+static void omv_job_dispatch(void) {
+    omv_job_run();
+}
+#endif
+
+bool omv_job_submit(omv_job_t *job, omv_job_func_t func, void *arg) {
+    mp_uint_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+
+    if (job->pending) {
+        MICROPY_END_ATOMIC_SECTION(atomic_state);
+        return false;
+    }
+
+    job->func = func;
+    job->arg = arg;
+    job->next = NULL;
+    job->pending = true;
+
+    if (omv_job_tail) {
+        omv_job_tail->next = job;
+    } else {
+        omv_job_head = job;
+    }
+
+    omv_job_tail = job;
+    MICROPY_END_ATOMIC_SECTION(atomic_state);
+
+    #if defined(PENDSV_DISPATCH_NUM_SLOTS)
+    pendsv_schedule_dispatch(PENDSV_DISPATCH_JOB, omv_job_dispatch);
+    #endif
+    return true;
+}
+
+void omv_job_run() {
+    mp_uint_t atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+
+    // Jobs run one at a time and in order, if PendSV preempts the main thread while it's
+    // running jobs it returns right away and the jobs it was dispatched for run here.
+    if (omv_job_running) {
+        MICROPY_END_ATOMIC_SECTION(atomic_state);
+        return;
+    }
+
+    omv_job_running = true;
+
+    for (omv_job_t *job; (job = omv_job_head); ) {
+        omv_job_head = job->next;
+        if (!omv_job_head) {
+            omv_job_tail = NULL;
+        }
+        MICROPY_END_ATOMIC_SECTION(atomic_state);
+
+        job->func(job->arg);
+        job->pending = false;
+
+        atomic_state = MICROPY_BEGIN_ATOMIC_SECTION();
+    }
+
+    omv_job_running = false;
+    MICROPY_END_ATOMIC_SECTION(atomic_state);
+}
+
+void omv_job_wait(omv_job_t *job) {
+    while (job->pending) {
+        omv_job_run();
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Background jobs.
+ *
+ * Jobs are short C functions queued from IRQs or the main thread. They run in order from
+ * PendSV, so after all other IRQs and preempting the main thread between bytecodes or in
+ * blocking waits, and from omv_job_run(). Jobs must not use the MicroPython heap, fb_alloc
+ * or anything else the main thread may be using; they may schedule MicroPython callbacks.
+ */
+#ifndef __OMV_JOB_H__
+#define __OMV_JOB_H__
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef void (*omv_job_func_t) (void *arg);
+
+typedef struct omv_job {
+    omv_job_func_t func;
+    void *arg;
+    struct omv_job *next;
+    volatile bool pending;
+} omv_job_t;
+
+// Queues a job, the job struct must stay valid until it has run.
+// Returns false if the job is still pending from a previous submit.
+bool omv_job_submit(omv_job_t *job, omv_job_func_t func, void *arg);
+// Returns true if the job was submitted and hasn't run yet.
+static inline bool omv_job_pending(omv_job_t *job) {
+    return job->pending;
+}
+// Runs all queued jobs in the caller's context, for blocking waits.
+void omv_job_run();
+// Waits for the job, running queued jobs meanwhile. Must not be called from a job.
+void omv_job_wait(omv_job_t *job);
+#endif // __OMV_JOB_H__
@@ -0,0 +1,76 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * DMA memory copy.
+ */
+#include <string.h>
+#include "omv_common.h"
+#include "omv_cache.h"
+#include "omv_memcpy.h"
+
+#ifndef __weak
+#define __weak    __attribute__((weak))
+#endif
+
+// Ports without a DMA channel for memory copies.
+__weak size_t omv_memcpy_dma_start(void *dst, const void *src, size_t size) {
+    return 0;
+}
+
+__weak bool omv_memcpy_dma_busy() {
+    return false;
+}
+
+void omv_memcpy_start(omv_memcpy_t *xfer, void *dst, const void *src, size_t size) {
+    uint8_t *dst8 = dst;
+    const uint8_t *src8 = src;
+
+    xfer->dst = NULL;
+    xfer->size = 0;
+
+    // The DMA only writes whole cache lines, so the CPU can copy the head and tail meanwhile.
+    size_t head = (-((uintptr_t) dst8)) & (OMV_ALLOC_ALIGNMENT - 1);
+
+    if ((size >= OMV_MEMCPY_DMA_MIN_SIZE) && (size > head) && (!omv_memcpy_dma_busy())) {
+        size_t body = (size - head) & ~(OMV_ALLOC_ALIGNMENT - 1);
+        // Dirty destination lines are dropped, they'd be evicted over the DMA data otherwise.
+        omv_cache_clean(src8 + head, body);
+        omv_cache_invalidate(dst8 + head, body);
+        xfer->size = omv_memcpy_dma_start(dst8 + head, src8 + head, body);
+    }
+
+    if (!xfer->size) {
+        memcpy(dst8, src8, size);
+        return;
+    }
+
+    xfer->dst = dst8 + head;
+    memcpy(dst8, src8, head);
+    memcpy(xfer->dst + xfer->size, src8 + head + xfer->size, size - head - xfer->size);
+}
+
+bool omv_memcpy_busy(omv_memcpy_t *xfer) {
+    return xfer->size && omv_memcpy_dma_busy();
+}
+
+void omv_memcpy_wait(omv_memcpy_t *xfer) {
+    if (xfer->size) {
+        while (omv_memcpy_dma_busy()) {
+        }
+        // Drop lines speculatively read while the DMA was writing.
+        omv_cache_invalidate(xfer->dst, xfer->size);
+        xfer->size = 0;
+    }
+}
+
+void *omv_memcpy(void *dst, const void *src, size_t size) {
+    omv_memcpy_t xfer;
+    omv_memcpy_start(&xfer, dst, src, size);
+    omv_memcpy_wait(&xfer);
+    return dst;
+}
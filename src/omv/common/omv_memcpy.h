@@ -0,0 +1,43 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * DMA memory copy.
+ *
+ * Copies of at least OMV_MEMCPY_DMA_MIN_SIZE bytes are moved by a DMA channel if the port has
+ * one free, while the CPU copies the unaligned head and tail and then returns to the caller.
+ * Everything else is copied by the CPU before omv_memcpy_start() returns.
+ */
+#ifndef __OMV_MEMCPY_H__
+#define __OMV_MEMCPY_H__
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "omv_boardconfig.h"
+
+#ifndef OMV_MEMCPY_DMA_MIN_SIZE
+#define OMV_MEMCPY_DMA_MIN_SIZE     (4096)
+#endif
+
+typedef struct _omv_memcpy {
+    uint8_t *dst;   // DMA destination.
+    size_t size;    // Bytes the DMA is moving, 0 if none.
+} omv_memcpy_t;
+
+// Starts copying, the destination can't be used until omv_memcpy_wait() returns.
+void omv_memcpy_start(omv_memcpy_t *xfer, void *dst, const void *src, size_t size);
+bool omv_memcpy_busy(omv_memcpy_t *xfer);
+// Must be called once for each started copy.
+void omv_memcpy_wait(omv_memcpy_t *xfer);
+// Blocking copy, for sizes above the threshold the DMA doesn't stall the core on the bus.
+void *omv_memcpy(void *dst, const void *src, size_t size);
+
+// Implemented by ports, dst is cache line aligned and size is a multiple of the cache line.
+// Returns the number of bytes (from the start) the DMA is moving, or 0 if it can't.
+size_t omv_memcpy_dma_start(void *dst, const void *src, size_t size);
+bool omv_memcpy_dma_busy();
+#endif // __OMV_MEMCPY_H__
@@ -78,6 +78,34 @@ typedef struct _omv_spi {
     #endif
 } omv_spi_t;
 
+// A segment of a chained transfer. Segments are sent as rows of size bytes that are stride bytes
+// apart, e.g. a window of a frame buffer, and can drive the D/C pin low for command bytes.
+typedef struct _omv_spi_segment {
+    const void *txbuf;
+    uint32_t size;
+    uint32_t rows;      // 0 is the same as 1.
+    uint32_t stride;
+    bool cmd;
+} omv_spi_segment_t;
+
+// Sends a list of segments with DMA, each transfer is started from the completion IRQ of the
+// previous one and segments are split into transfers of at most max_size frames.
+typedef struct _omv_spi_chain {
+    omv_spi_segment_t *segments;
+    uint32_t n_segments;
+    uint32_t frame_size;    // Bytes per SPI frame.
+    uint32_t max_size;      // Frames per transfer.
+    omv_gpio_t dc_pin;      // D/C pin, or NULL.
+    void *userdata;
+    // Called from the IRQ once all segments are sent, it may start the chain again.
+    omv_spi_callback_t callback;
+    volatile bool busy;
+    volatile bool failed;
+    uint32_t segment;
+    uint32_t row;
+    uint32_t offset;
+} omv_spi_chain_t;
+
 int omv_spi_init(omv_spi_t *spi, omv_spi_config_t *config);
 // Default config: MASTER | FDX | 10MHz | 8 bits | MSB FIRST | NSS HARD | NSS/CPHA/CPOL LOW.
 int omv_spi_default_config(omv_spi_config_t *config, uint32_t bus_id);
@@ -85,5 +113,7 @@ int omv_spi_deinit(omv_spi_t *spi);
 int omv_spi_set_baudrate(omv_spi_t *spi, uint32_t baudrate);
 int omv_spi_transfer_start(omv_spi_t *spi, omv_spi_transfer_t *xfer);
 int omv_spi_transfer_abort(omv_spi_t *spi);
+int omv_spi_chain_start(omv_spi_t *spi, omv_spi_chain_t *chain);
+int omv_spi_chain_abort(omv_spi_t *spi, omv_spi_chain_t *chain);
 
 #endif // __OMV_SPI_H__
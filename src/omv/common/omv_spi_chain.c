@@ -0,0 +1,110 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Chained SPI transfers.
+ */
+#include <stddef.h>
+#include "cmsis_compiler.h"
+#include "omv_gpio.h"
+#include "omv_spi.h"
+
+static void omv_spi_chain_callback(omv_spi_t *spi, void *userdata, void *buf);
+
+// Starts the next transfer of the chain, or calls the chain's callback at the end.
+static void omv_spi_chain_next(omv_spi_t *spi, omv_spi_chain_t *chain) {
+    for (; chain->segment < chain->n_segments; chain->segment++, chain->row = 0) {
+        omv_spi_segment_t *segment = &chain->segments[chain->segment];
+        uint32_t rows = segment->rows ? segment->rows : 1;
+
+        for (; chain->row < rows; chain->row++, chain->offset = 0) {
+            // Partial frames at the end of a row are not sent.
+            if ((segment->size - chain->offset) < chain->frame_size) {
+                continue;
+            }
+
+            if (chain->dc_pin && (chain->row == 0) && (chain->offset == 0)) {
+                omv_gpio_write(chain->dc_pin, !segment->cmd);
+            }
+
+            uint32_t size = segment->size - chain->offset;
+            if (size > (chain->max_size * chain->frame_size)) {
+                size = chain->max_size * chain->frame_size;
+            }
+
+            omv_spi_transfer_t xfer = {
+                .txbuf = ((uint8_t *) segment->txbuf) + (chain->row * segment->stride) + chain->offset,
+                .size = size / chain->frame_size,
+                .flags = OMV_SPI_XFER_DMA,
+                .userdata = chain,
+                .callback = omv_spi_chain_callback,
+            };
+
+            chain->offset += size;
+
+            if (omv_spi_transfer_start(spi, &xfer) != 0) {
+                chain->failed = true;
+                break;
+            }
+
+            return;
+        }
+
+        if (chain->failed) {
+            break;
+        }
+    }
+
+    chain->busy = false;
+
+    if (chain->callback) {
+        chain->callback(spi, chain->userdata, NULL);
+    }
+}
+
+static void omv_spi_chain_callback(omv_spi_t *spi, void *userdata, void *buf) {
+    omv_spi_chain_t *chain = (omv_spi_chain_t *) userdata;
+
+    if (!chain->busy) {
+        return;
+    }
+
+    if (spi->xfer_flags & OMV_SPI_XFER_FAILED) {
+        chain->failed = true;
+        chain->segment = chain->n_segments;
+    }
+
+    omv_spi_chain_next(spi, chain);
+}
+
+int omv_spi_chain_start(omv_spi_t *spi, omv_spi_chain_t *chain) {
+    if (chain->busy || !chain->frame_size || !chain->max_size) {
+        return -1;
+    }
+
+    chain->busy = true;
+    chain->failed = false;
+    chain->segment = 0;
+    chain->row = 0;
+    chain->offset = 0;
+
+    // When started from thread mode the first transfer's completion IRQ must not run until
+    // the transfer has been started and the bus unlocked, the IRQ starts the next transfer.
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    omv_spi_chain_next(spi, chain);
+    __set_PRIMASK(primask);
+    return chain->failed ? -1 : 0;
+}
+
+int omv_spi_chain_abort(omv_spi_t *spi, omv_spi_chain_t *chain) {
+    if (chain->busy) {
+        chain->busy = false;
+        omv_spi_transfer_abort(spi);
+    }
+    return 0;
+}
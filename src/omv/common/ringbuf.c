@@ -1,42 +1,101 @@
 /*
  * This file is part of the OpenMV project.
  *
- * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
- * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
  *
  * This work is licensed under the MIT license, see the file LICENSE for details.
  *
- * Simple Ring Buffer implementation.
+ * Lock-free single-producer single-consumer ring buffer.
  */
 #include <string.h>
 #include "ringbuf.h"
 
-void ring_buf_init(ring_buf_t *buf) {
-    memset(buf, 0, sizeof(*buf));
+// Orders the data accesses against the index updates (DMB on ARM), the other side may be
+// running on another core or be a bus master reading the indices.
+#define RING_BUF_BARRIER()    __sync_synchronize()
+
+void ring_buf_init(ring_buf_t *buf, uint8_t *data, uint32_t size) {
+    buf->head = 0;
+    buf->tail = 0;
+    buf->mask = size - 1;
+    buf->data = data;
+}
+
+uint32_t ring_buf_peek_write(ring_buf_t *buf, uint8_t **ptr) {
+    uint32_t head = buf->head;
+    uint32_t offset = head & buf->mask;
+    uint32_t len = buf->mask + 1 - (head - buf->tail);
+    uint32_t contig = buf->mask + 1 - offset;
+    *ptr = buf->data + offset;
+    return (len < contig) ? len : contig;
 }
 
-int ring_buf_empty(ring_buf_t *buf) {
-    return (buf->head == buf->tail);
+void ring_buf_commit_write(ring_buf_t *buf, uint32_t len) {
+    RING_BUF_BARRIER();
+    buf->head += len;
 }
 
-void ring_buf_put(ring_buf_t *buf, uint8_t c) {
-    if ((buf->tail + 1) % BUFFER_SIZE == buf->head) {
-        /*buffer is full*/
-        return;
+uint32_t ring_buf_write(ring_buf_t *buf, const void *src, uint32_t len) {
+    const uint8_t *p = src;
+    uint32_t total = 0;
+
+    // At most two copies, up to the end of the buffer and then from the start.
+    for (int i = 0; i < 2 && len; i++) {
+        uint8_t *ptr;
+        uint32_t n = ring_buf_peek_write(buf, &ptr);
+        n = (len < n) ? len : n;
+        memcpy(ptr, p + total, n);
+        ring_buf_commit_write(buf, n);
+        total += n;
+        len -= n;
     }
 
-    buf->data[buf->tail] = c;
-    buf->tail = (buf->tail + 1) % BUFFER_SIZE;
+    return total;
 }
 
-uint8_t ring_buf_get(ring_buf_t *buf) {
-    uint8_t c;
-    if (buf->head == buf->tail) {
-        /*buffer is empty*/
-        return 0;
+bool ring_buf_put(ring_buf_t *buf, uint8_t c) {
+    return ring_buf_write(buf, &c, 1) == 1;
+}
+
+uint32_t ring_buf_peek_read(ring_buf_t *buf, uint8_t **ptr) {
+    uint32_t tail = buf->tail;
+    uint32_t offset = tail & buf->mask;
+    uint32_t len = buf->head - tail;
+    uint32_t contig = buf->mask + 1 - offset;
+    // Don't read the data before the head that published it.
+    RING_BUF_BARRIER();
+    *ptr = buf->data + offset;
+    return (len < contig) ? len : contig;
+}
+
+void ring_buf_commit_read(ring_buf_t *buf, uint32_t len) {
+    RING_BUF_BARRIER();
+    buf->tail += len;
+}
+
+uint32_t ring_buf_read(ring_buf_t *buf, void *dst, uint32_t len) {
+    uint8_t *p = dst;
+    uint32_t total = 0;
+
+    for (int i = 0; i < 2 && len; i++) {
+        uint8_t *ptr;
+        uint32_t n = ring_buf_peek_read(buf, &ptr);
+        n = (len < n) ? len : n;
+        memcpy(p + total, ptr, n);
+        ring_buf_commit_read(buf, n);
+        total += n;
+        len -= n;
     }
 
-    c = buf->data[buf->head];
-    buf->head = (buf->head + 1) % BUFFER_SIZE;
-    return c;
+    return total;
+}
+
+int ring_buf_get(ring_buf_t *buf) {
+    uint8_t c;
+    return ring_buf_read(buf, &c, 1) ? c : -1;
+}
+
+void ring_buf_flush(ring_buf_t *buf) {
+    buf->tail = buf->head;
 }
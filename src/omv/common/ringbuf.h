@@ -1,26 +1,57 @@
 /*
  * This file is part of the OpenMV project.
  *
- * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
- * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
  *
  * This work is licensed under the MIT license, see the file LICENSE for details.
  *
- * Simple Ring Buffer implementation.
+ * Lock-free single-producer single-consumer ring buffer.
+ *
+ * The producer only writes the head and the consumer only writes the tail, so one side may
+ * run in an IRQ (or PendSV) without locking. Both indices are free-running and wrapped with
+ * the size mask, the size must be a power of two. The peek/commit calls return contiguous
+ * regions for copying or DMA in place, the data must be written (read) before the commit.
  */
 #ifndef __RING_BUFFER_H__
 #define __RING_BUFFER_H__
 #include <stdint.h>
-#define BUFFER_SIZE    (1024)
+#include <stdbool.h>
 
 typedef struct ring_buffer {
     volatile uint32_t head;
     volatile uint32_t tail;
-    uint8_t data[BUFFER_SIZE];
+    uint32_t mask;
+    uint8_t *data;
 } ring_buf_t;
 
-void ring_buf_init(ring_buf_t *buf);
-int ring_buf_empty(ring_buf_t *buf);
-void ring_buf_put(ring_buf_t *buf, uint8_t c);
-uint8_t ring_buf_get(ring_buf_t *buf);
+void ring_buf_init(ring_buf_t *buf, uint8_t *data, uint32_t size);
+
+// Bytes that can be read.
+static inline uint32_t ring_buf_avail(ring_buf_t *buf) {
+    return buf->head - buf->tail;
+}
+
+// Bytes that can be written.
+static inline uint32_t ring_buf_free(ring_buf_t *buf) {
+    return buf->mask + 1 - (buf->head - buf->tail);
+}
+
+static inline bool ring_buf_empty(ring_buf_t *buf) {
+    return buf->head == buf->tail;
+}
+
+// Producer side, return the number of bytes written (or free contiguous bytes for peek).
+uint32_t ring_buf_write(ring_buf_t *buf, const void *src, uint32_t len);
+uint32_t ring_buf_peek_write(ring_buf_t *buf, uint8_t **ptr);
+void ring_buf_commit_write(ring_buf_t *buf, uint32_t len);
+bool ring_buf_put(ring_buf_t *buf, uint8_t c);
+
+// Consumer side, return the number of bytes read (or available contiguous bytes for peek).
+uint32_t ring_buf_read(ring_buf_t *buf, void *dst, uint32_t len);
+uint32_t ring_buf_peek_read(ring_buf_t *buf, uint8_t **ptr);
+void ring_buf_commit_read(ring_buf_t *buf, uint32_t len);
+int ring_buf_get(ring_buf_t *buf);
+// Drops all buffered data.
+void ring_buf_flush(ring_buf_t *buf);
 #endif /* __RING_BUFFER_H__ */
@@ -173,8 +173,21 @@ typedef enum {
     IOCTL_HIMAX_MD_WINDOW,
     IOCTL_HIMAX_MD_THRESHOLD,
     IOCTL_HIMAX_OSC_ENABLE,
+    IOCTL_SET_OUTPUT_WINDOW,
+    IOCTL_GET_OUTPUT_WINDOW,
 } ioctl_t;
 
+// Flags for sensor_write_regs().
+#define SENSOR_REGS_ADDR16          (1 << 0)    // 16-bit register addresses.
+#define SENSOR_REGS_CACHED          (1 << 1)    // Skip registers the cache says already hold the value.
+#define SENSOR_REGS_BURST           (1 << 2)    // Write runs of consecutive addresses in one transfer.
+#define SENSOR_REGS_PAGED           (1 << 3)    // Register addresses are relative to a page register.
+#define SENSOR_REGS_PAGE_REG(reg)   (SENSOR_REGS_PAGED | ((reg) << 8))
+
+// Register table entries for sensor_write_regs().
+#define SENSOR_REG8(addr, data)     {(uint8_t) (addr), (uint8_t) (data)}
+#define SENSOR_REG16(addr, data)    {(uint8_t) ((addr) >> 8), (uint8_t) (addr), (uint8_t) (data)}
+
 typedef enum {
     SENSOR_ERROR_NO_ERROR              =  0,
     SENSOR_ERROR_CTL_FAILED            = -1,
@@ -236,9 +249,24 @@ typedef enum {
 #define SENSOR_HW_FLAGS_YUV422        (SUBFORMAT_ID_YUV422)
 #define SENSOR_HW_FLAGS_YVU422        (SUBFORMAT_ID_YVU422)
 
+// The JPEG frame size comes from the DMA counters, rounded up to the transfer size, so the
+// EOI marker is only looked for in the last few bytes instead of scanning the frame buffer.
+#define SENSOR_JPEG_EOI_SEARCH        (64)
+
 typedef void (*vsync_cb_t) (uint32_t vsync);
 typedef void (*frame_cb_t) ();
 
+// Firmware auto exposure/gain loop state, see sensor_set_ae().
+typedef struct sensor_ae {
+    bool enable;
+    uint8_t target;             // Target mean brightness (0-255).
+    uint8_t settle;             // Frames to skip before the last update shows up.
+    int32_t exposure_us;        // Exposure set by the loop.
+    int32_t exposure_us_max;    // Exposure is raised up to this before any gain is added.
+    float gain_db;              // Gain set by the loop.
+    float gain_db_ceiling;
+} sensor_ae_t;
+
 typedef struct _sensor sensor_t;
 typedef struct _sensor {
     union {
@@ -281,11 +309,24 @@ typedef struct _sensor {
     bool drop_frame;            // Set to true to drop the current frame.
     uint32_t last_frame_ms;     // Last sampled frame timestamp in milliseconds.
     bool last_frame_ms_valid;   // Last sampled frame timestamp in milliseconds valid.
+    bool trigger;               // Set to true when frames are started by the trigger pin.
+    volatile bool triggered;    // Set by the trigger IRQ until the frame is received.
+    volatile uint32_t trigger_us; // Timestamp of the last trigger in microseconds.
+    bool trigger_master;        // Set to true when frame sync pulses are driven for other cameras.
+    volatile uint32_t sync_seq; // Count of frame sync pulses since trigger mode was enabled.
+    int32_t exposure_us;        // Last sampled exposure, attached to captured frames.
+    float gain_db;              // Last sampled gain, attached to captured frames.
+    uint32_t info_ms;           // Time exposure and gain were last sampled in milliseconds.
+    sensor_ae_t ae;             // Firmware auto exposure/gain loop.
     gainceiling_t gainceiling;  // AGC gainceiling
     bool hmirror;               // Horizontal Mirror
     bool vflip;                 // Vertical Flip
     bool transpose;             // Transpose Image
     bool auto_rotation;         // Rotate Image Automatically
+    pixformat_t debayer;        // Convert BAYER/YUV422 frames to this format during capture, or 0.
+    uint32_t dual_scale;        // Also capture a copy decimated by this factor after the image, or 0.
+    bool hw_windowing;          // Set to true when the sensor only outputs the window.
+    bool byte_select;           // Set to true when the capture hardware drops the UV bytes of YUV422.
     bool detected;              // Set to true when the sensor is initialized.
 
     omv_i2c_t i2c_bus;          // SCCB/I2C bus.
@@ -334,6 +375,14 @@ int sensor_init();
 // Detect and initialize the image sensor.
 int sensor_probe_init(uint32_t bus_id, uint32_t bus_speed);
 
+// Load/store the probe results kept across boots (zeros if there are none). Ports with some
+// retained storage replace these so that a wake from reset/standby skips the bus scan.
+void sensor_probe_cache_load(uint32_t cache[2]);
+void sensor_probe_cache_store(const uint32_t cache[2]);
+
+// Returns the bus the sensor was found on by the last probe, or -1 if unknown.
+int sensor_probe_cache_bus();
+
 // This function is called after a setting that may require reconfiguring
 // the hardware changes, such as window size, frame size, or pixel format.
 int sensor_config(sensor_config_t config);
@@ -362,12 +411,32 @@ int sensor_sleep(int enable);
 // Shutdown mode.
 int sensor_shutdown(int enable);
 
+// Trigger mode, frames are captured on an edge of the trigger pin. Snapshot arms the capture
+// and the trigger IRQ starts the exposure right away through the frame sync pin. In master mode
+// snapshot drives the frame sync pin itself, which is wired to the trigger pins of the other
+// cameras. Frames are numbered by sync pulse so the frames of all cameras can be matched up.
+int sensor_set_trigger(bool enable, bool master);
+
+// Waits for the sensor's motion detection interrupt with the MCU sleeping, motion detection
+// must be configured with sensor_ioctl() first. Returns SENSOR_ERROR_CAPTURE_TIMEOUT if no
+// motion was detected within timeout ms (0 waits forever). The stop mode, if supported by
+// the port, also stops the sensor clock so the sensor runs from its own oscillator.
+int sensor_wait_for_motion(uint32_t timeout, bool stop_mode);
+
+// Sleeps until the next interrupt, in stop mode if supported by the port.
+void sensor_wait_for_interrupt(bool stop_mode);
+
 // Read a sensor register.
 int sensor_read_reg(uint16_t reg_addr);
 
 // Write a sensor register.
 int sensor_write_reg(uint16_t reg_addr, uint16_t reg_data);
 
+// Write a register table, made of {addr, data} or {addr_h, addr_l, data} entries and
+// ending with a zero (high) address byte. Every write updates a small register cache.
+// Paged tables must write the page register before any register that's not on page 0.
+int sensor_write_regs(sensor_t *sensor, const uint8_t *regs, uint32_t flags);
+
 // Set the sensor pixel format.
 int sensor_set_pixformat(pixformat_t pixformat);
 
@@ -389,6 +458,14 @@ bool sensor_get_cropped();
 // Set window size.
 int sensor_set_windowing(int x, int y, int w, int h);
 
+// Return the window offset within the frame the sensor outputs.
+uint32_t sensor_get_src_x();
+uint32_t sensor_get_src_y();
+
+// Return the size of the frame the sensor outputs.
+uint32_t sensor_get_src_width();
+uint32_t sensor_get_src_height();
+
 // Set the sensor contrast level (from -3 to +3).
 int sensor_set_contrast(int level);
 
@@ -420,6 +497,17 @@ int sensor_set_auto_exposure(int enable, int exposure_us);
 // Get the exposure value.
 int sensor_get_exposure_us(int *get_exposure_us);
 
+// Enable/disable the firmware auto exposure/gain loop. Sensors without a usable
+// AEC/AGC only need manual exposure and gain control to use it.
+int sensor_set_ae(bool enable, int target, int exposure_us_max, float gain_db_ceiling);
+
+// Meter a captured frame and update exposure and gain for the next frames.
+void sensor_update_ae(image_t *image);
+
+// Capture one frame at each exposure and fuse them into image. latency is the number of
+// frames the sensor takes to apply a new exposure. Leaves auto exposure off.
+int sensor_snapshot_hdr(image_t *image, const int *exposures_us, int n, int latency);
+
 // Enable auto white balance or set value manually.
 int sensor_set_auto_whitebal(int enable, float r_gain_db, float g_gain_db, float b_gain_db);
 
@@ -456,6 +544,24 @@ int sensor_set_auto_rotation(bool enable);
 // Get transpose mode state.
 bool sensor_get_auto_rotation();
 
+// Convert BAYER/YUV422 frames to GRAYSCALE/RGB565 as they are captured, or 0 to disable.
+int sensor_set_debayer(pixformat_t pixformat);
+
+// Get the capture debayer format.
+pixformat_t sensor_get_debayer();
+
+// Also capture a copy of each frame decimated by an integer factor, or 0 to disable.
+int sensor_set_dual_output(uint32_t scale);
+
+// Get the dual output decimation factor.
+uint32_t sensor_get_dual_output();
+
+// Get the decimated copy stored after the current frame, returns -1 if there's none.
+int sensor_get_dual_image(image_t *image);
+
+// Write the decimated copy of one captured line, src points to the first pixel of the window.
+void sensor_dual_copy_line(uint8_t *src, uint32_t line, uint8_t *data);
+
 // Set the number of virtual frame buffers.
 int sensor_set_framebuffers(int count);
 
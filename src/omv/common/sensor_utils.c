@@ -10,6 +10,7 @@
  * implementations of common functions that can be replaced by port-specific drivers.
  */
 #if MICROPY_PY_SENSOR
+#include <math.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -31,6 +32,7 @@
 #include "frogeye2020.h"
 #include "gc2145.h"
 #include "framebuffer.h"
+#include "fb_alloc.h"
 #include "unaligned_memcpy.h"
 #include "omv_boardconfig.h"
 #include "omv_gpio.h"
@@ -48,10 +50,32 @@
 #define OMV_CSI_POWER_DELAY (10)
 #endif
 
+// Number of wired CSI data lines, RAW10/RAW12 capture needs 10/12.
+#ifndef OMV_CSI_DATA_BITS
+#define OMV_CSI_DATA_BITS (8)
+#endif
+
 #ifndef __weak
 #define __weak    __attribute__((weak))
 #endif
 
+#define SENSOR_PROBE_CACHE_MAGIC    (0xCA)
+
+#define SENSOR_REGS_CACHE_SIZE  (256)   // Must be a power of 2.
+#define SENSOR_REGS_BURST_MAX   (32)    // Data bytes per burst write.
+
+// Direct mapped cache of register values written with sensor_write_regs(). Entries are
+// valid[24] | key[23:8] | data[7:0], where the key is the (page relative) register address.
+static uint32_t sensor_regs_cache[SENSOR_REGS_CACHE_SIZE];
+
+static uint32_t *sensor_regs_cache_entry(uint32_t key) {
+    return &sensor_regs_cache[((key * 0x9E3779B1U) >> 24) & (SENSOR_REGS_CACHE_SIZE - 1)];
+}
+
+static void sensor_regs_cache_invalidate() {
+    memset(sensor_regs_cache, 0, sizeof(sensor_regs_cache));
+}
+
 // Sensor frame size/resolution table.
 const int resolution[][2] = {
     {0,    0   },
@@ -129,6 +153,7 @@ __weak int sensor_reset() {
     sensor.last_frame_ms = 0;
     sensor.last_frame_ms_valid = false;
     sensor.gainceiling = 0;
+    sensor.ae.enable = false;
     sensor.hmirror = false;
     sensor.vflip = false;
     sensor.transpose = false;
@@ -137,6 +162,10 @@ __weak int sensor_reset() {
     #else
     sensor.auto_rotation = false;
     #endif // MICROPY_PY_IMU
+    sensor.debayer = 0;
+    sensor.dual_scale = 0;
+    sensor.hw_windowing = false;
+    sensor.byte_select = false;
     sensor.vsync_callback = NULL;
     sensor.frame_callback = NULL;
 
@@ -169,6 +198,9 @@ __weak int sensor_reset() {
     // Re-enable the bus.
     omv_i2c_enable(&sensor.i2c_bus, true);
 
+    // The sensor registers are back to their defaults.
+    sensor_regs_cache_invalidate();
+
     // Call sensor-specific reset function
     if (sensor.reset != NULL
         && sensor.reset(&sensor) != 0) {
@@ -181,81 +213,151 @@ __weak int sensor_reset() {
     return 0;
 }
 
+// Reads the chip ID of a supported sensor at slv_addr, returns slv_addr or 0 if unsupported.
+static int sensor_detect_addr(uint8_t slv_addr) {
+    switch (slv_addr) {
+        #if (OMV_OV2640_ENABLE == 1)
+        case OV2640_SLV_ADDR: // Or OV9650.
+            omv_i2c_readb(&sensor.i2c_bus, slv_addr, OV_CHIP_ID, &sensor.chip_id);
+            return slv_addr;
+        #endif // (OMV_OV2640_ENABLE == 1)
+
+        #if (OMV_OV5640_ENABLE == 1) || (OMV_GC2145_ENABLE == 1)
+        // OV5640 and GC2145 share the same I2C address
+        case OV5640_SLV_ADDR:   // Or GC2145
+            // Try to read GC2145 chip ID first
+            omv_i2c_readb(&sensor.i2c_bus, slv_addr, GC_CHIP_ID, &sensor.chip_id);
+            if (sensor.chip_id != GC2145_ID) {
+                // If it fails, try reading OV5640 chip ID.
+                omv_i2c_readb2(&sensor.i2c_bus, slv_addr, OV5640_CHIP_ID, &sensor.chip_id);
+            }
+            return slv_addr;
+        #endif // (OMV_OV5640_ENABLE == 1) || (OMV_GC2145_ENABLE == 1)
+
+        #if (OMV_OV7725_ENABLE == 1) || (OMV_OV7670_ENABLE == 1) || (OMV_OV7690_ENABLE == 1)
+        case OV7725_SLV_ADDR: // Or OV7690 or OV7670.
+            omv_i2c_readb(&sensor.i2c_bus, slv_addr, OV_CHIP_ID, &sensor.chip_id);
+            return slv_addr;
+        #endif //(OMV_OV7725_ENABLE == 1) || (OMV_OV7670_ENABLE == 1) || (OMV_OV7690_ENABLE == 1)
+
+        #if (OMV_MT9V0XX_ENABLE == 1)
+        case MT9V0XX_SLV_ADDR:
+            omv_i2c_readw(&sensor.i2c_bus, slv_addr, ON_CHIP_ID, &sensor.chip_id_w);
+            return slv_addr;
+        #endif //(OMV_MT9V0XX_ENABLE == 1)
+
+        #if (OMV_MT9M114_ENABLE == 1)
+        case MT9M114_SLV_ADDR:
+            omv_i2c_readw2(&sensor.i2c_bus, slv_addr, ON_CHIP_ID, &sensor.chip_id_w);
+            return slv_addr;
+        #endif // (OMV_MT9M114_ENABLE == 1)
+
+        #if (OMV_LEPTON_ENABLE == 1)
+        case LEPTON_SLV_ADDR:
+            sensor.chip_id = LEPTON_ID;
+            return slv_addr;
+        #endif // (OMV_LEPTON_ENABLE == 1)
+
+        #if (OMV_HM01B0_ENABLE == 1) || (OMV_HM0360_ENABLE == 1)
+        case HM0XX0_SLV_ADDR:
+            omv_i2c_readb2(&sensor.i2c_bus, slv_addr, HIMAX_CHIP_ID, &sensor.chip_id);
+            return slv_addr;
+        #endif // (OMV_HM01B0_ENABLE == 1) || (OMV_HM0360_ENABLE == 1)
+
+        #if (OMV_FROGEYE2020_ENABLE == 1)
+        case FROGEYE2020_SLV_ADDR:
+            sensor.chip_id_w = FROGEYE2020_ID;
+            return slv_addr;
+        #endif // (OMV_FROGEYE2020_ENABLE == 1)
+
+        #if (OMV_PAG7920_ENABLE == 1)
+        case PAG7920_SLV_ADDR:
+            omv_i2c_readw(&sensor.i2c_bus, slv_addr, ON_CHIP_ID, &sensor.chip_id_w);
+            sensor.chip_id_w = (sensor.chip_id_w << 8) | (sensor.chip_id_w >> 8);
+            return slv_addr;
+        #endif // (OMV_PAG7920_ENABLE == 1)
+    }
+
+    return 0;
+}
+
 static int sensor_detect() {
     uint8_t devs_list[OMV_CSI_MAX_DEVICES];
     int n_devs = omv_i2c_scan(&sensor.i2c_bus, devs_list, OMV_ARRAY_SIZE(devs_list));
 
     for (int i = 0; i < OMV_MIN(n_devs, OMV_CSI_MAX_DEVICES); i++) {
-        uint8_t slv_addr = devs_list[i];
-        switch (slv_addr) {
-            #if (OMV_OV2640_ENABLE == 1)
-            case OV2640_SLV_ADDR: // Or OV9650.
-                omv_i2c_readb(&sensor.i2c_bus, slv_addr, OV_CHIP_ID, &sensor.chip_id);
-                return slv_addr;
-            #endif // (OMV_OV2640_ENABLE == 1)
-
-            #if (OMV_OV5640_ENABLE == 1) || (OMV_GC2145_ENABLE == 1)
-            // OV5640 and GC2145 share the same I2C address
-            case OV5640_SLV_ADDR:   // Or GC2145
-                // Try to read GC2145 chip ID first
-                omv_i2c_readb(&sensor.i2c_bus, slv_addr, GC_CHIP_ID, &sensor.chip_id);
-                if (sensor.chip_id != GC2145_ID) {
-                    // If it fails, try reading OV5640 chip ID.
-                    omv_i2c_readb2(&sensor.i2c_bus, slv_addr, OV5640_CHIP_ID, &sensor.chip_id);
-                }
-                return slv_addr;
-            #endif // (OMV_OV5640_ENABLE == 1) || (OMV_GC2145_ENABLE == 1)
-
-            #if (OMV_OV7725_ENABLE == 1) || (OMV_OV7670_ENABLE == 1) || (OMV_OV7690_ENABLE == 1)
-            case OV7725_SLV_ADDR: // Or OV7690 or OV7670.
-                omv_i2c_readb(&sensor.i2c_bus, slv_addr, OV_CHIP_ID, &sensor.chip_id);
-                return slv_addr;
-            #endif //(OMV_OV7725_ENABLE == 1) || (OMV_OV7670_ENABLE == 1) || (OMV_OV7690_ENABLE == 1)
-
-            #if (OMV_MT9V0XX_ENABLE == 1)
-            case MT9V0XX_SLV_ADDR:
-                omv_i2c_readw(&sensor.i2c_bus, slv_addr, ON_CHIP_ID, &sensor.chip_id_w);
-                return slv_addr;
-            #endif //(OMV_MT9V0XX_ENABLE == 1)
-
-            #if (OMV_MT9M114_ENABLE == 1)
-            case MT9M114_SLV_ADDR:
-                omv_i2c_readw2(&sensor.i2c_bus, slv_addr, ON_CHIP_ID, &sensor.chip_id_w);
-                return slv_addr;
-            #endif // (OMV_MT9M114_ENABLE == 1)
-
-            #if (OMV_LEPTON_ENABLE == 1)
-            case LEPTON_SLV_ADDR:
-                sensor.chip_id = LEPTON_ID;
-                return slv_addr;
-            #endif // (OMV_LEPTON_ENABLE == 1)
-
-            #if (OMV_HM01B0_ENABLE == 1) || (OMV_HM0360_ENABLE == 1)
-            case HM0XX0_SLV_ADDR:
-                omv_i2c_readb2(&sensor.i2c_bus, slv_addr, HIMAX_CHIP_ID, &sensor.chip_id);
-                return slv_addr;
-            #endif // (OMV_HM01B0_ENABLE == 1) || (OMV_HM0360_ENABLE == 1)
-
-            #if (OMV_FROGEYE2020_ENABLE == 1)
-            case FROGEYE2020_SLV_ADDR:
-                sensor.chip_id_w = FROGEYE2020_ID;
-                return slv_addr;
-            #endif // (OMV_FROGEYE2020_ENABLE == 1)
-
-            #if (OMV_PAG7920_ENABLE == 1)
-            case PAG7920_SLV_ADDR:
-                omv_i2c_readw(&sensor.i2c_bus, slv_addr, ON_CHIP_ID, &sensor.chip_id_w);
-                sensor.chip_id_w = (sensor.chip_id_w << 8) | (sensor.chip_id_w >> 8);
-                return slv_addr;
-            #endif // (OMV_PAG7920_ENABLE == 1)
+        if (sensor_detect_addr(devs_list[i])) {
+            return devs_list[i];
         }
     }
 
     return 0;
 }
 
+__weak void sensor_probe_cache_load(uint32_t cache[2]) {
+    cache[0] = 0;
+    cache[1] = 0;
+}
+
+__weak void sensor_probe_cache_store(const uint32_t cache[2]) {
+}
+
+int sensor_probe_cache_bus() {
+    uint32_t cache[2];
+    sensor_probe_cache_load(cache);
+    return ((cache[0] >> 24) == SENSOR_PROBE_CACHE_MAGIC) ? ((cache[0] >> 16) & 0xFF) : -1;
+}
+
+// Power up and reset the sensor with the polarities found by the last full probe, then check
+// that the same sensor still answers at the same address. This skips the bus scan sweep.
+static bool sensor_probe_cached(uint32_t bus_id, uint32_t bus_speed) {
+    uint32_t cache[2];
+    sensor_probe_cache_load(cache);
+
+    if (((cache[0] >> 24) != SENSOR_PROBE_CACHE_MAGIC) || (((cache[0] >> 16) & 0xFF) != bus_id)) {
+        return false;
+    }
+
+    uint8_t slv_addr = cache[0] >> 8;
+    sensor.pwdn_pol = (cache[0] & 0x01) ? ACTIVE_HIGH : ACTIVE_LOW;
+    sensor.reset_pol = (cache[0] & 0x02) ? ACTIVE_HIGH : ACTIVE_LOW;
+
+    #if defined(OMV_CSI_POWER_PIN)
+    omv_gpio_write(OMV_CSI_POWER_PIN, (sensor.pwdn_pol == ACTIVE_HIGH) ? 1 : 0);
+    mp_hal_delay_ms(10);
+
+    omv_gpio_write(OMV_CSI_POWER_PIN, (sensor.pwdn_pol == ACTIVE_HIGH) ? 0 : 1);
+    mp_hal_delay_ms(OMV_CSI_POWER_DELAY);
+    #endif
+
+    #if defined(OMV_CSI_RESET_PIN)
+    omv_gpio_write(OMV_CSI_RESET_PIN, (sensor.reset_pol == ACTIVE_HIGH) ? 1 : 0);
+    mp_hal_delay_ms(10);
+
+    omv_gpio_write(OMV_CSI_RESET_PIN, (sensor.reset_pol == ACTIVE_HIGH) ? 0 : 1);
+    mp_hal_delay_ms(OMV_CSI_RESET_DELAY);
+    #endif
+
+    // Initialize the camera bus.
+    omv_i2c_init(&sensor.i2c_bus, bus_id, bus_speed);
+    mp_hal_delay_ms(10);
+
+    sensor.chip_id_w = 0;
+    if ((sensor_detect_addr(slv_addr) != slv_addr) || (sensor.chip_id_w != cache[1])) {
+        return false;
+    }
+
+    sensor.slv_addr = slv_addr;
+    return true;
+}
+
 int sensor_probe_init(uint32_t bus_id, uint32_t bus_speed) {
     int init_ret = 0;
+    bool cached = sensor_probe_cached(bus_id, bus_speed);
+
+    if (cached) {
+        goto sensor_detected;
+    }
 
     #if defined(OMV_CSI_POWER_PIN)
     sensor.pwdn_pol = ACTIVE_HIGH;
@@ -325,6 +427,14 @@ int sensor_probe_init(uint32_t bus_id, uint32_t bus_speed) {
         }
     }
 
+sensor_detected:;
+    // Remember what was found before the init code changes it.
+    uint32_t cache[2] = {
+        (SENSOR_PROBE_CACHE_MAGIC << 24) | ((bus_id & 0xFF) << 16) | (sensor.slv_addr << 8) |
+        ((sensor.reset_pol == ACTIVE_HIGH) << 1) | (sensor.pwdn_pol == ACTIVE_HIGH),
+        sensor.chip_id_w
+    };
+
     // A supported sensor was detected, try to initialize it.
     switch (sensor.chip_id_w) {
         #if (OMV_OV2640_ENABLE == 1)
@@ -475,10 +585,20 @@ int sensor_probe_init(uint32_t bus_id, uint32_t bus_speed) {
     }
 
     if (init_ret != 0) {
+        if (cached) {
+            // Something else is connected now, forget it and do the full probe.
+            sensor_probe_cache_store((const uint32_t [2]) {0, 0});
+            return sensor_probe_init(bus_id, bus_speed);
+        }
         // Sensor init failed.
         return SENSOR_ERROR_ISC_INIT_FAILED;
     }
 
+    // SPI sensors can't be checked with a single register read.
+    if (sensor.slv_addr) {
+        sensor_probe_cache_store(cache);
+    }
+
     return 0;
 }
 
@@ -546,6 +666,70 @@ __weak int sensor_shutdown(int enable) {
     return ret;
 }
 
+__weak int sensor_set_trigger(bool enable, bool master) {
+    return SENSOR_ERROR_CTL_UNSUPPORTED;
+}
+
+#if defined(OMV_CSI_INT_PIN)
+static volatile bool sensor_motion = false;
+
+static void sensor_motion_callback(void *data) {
+    sensor_motion = true;
+}
+#endif
+
+__weak void sensor_wait_for_interrupt(bool stop_mode) {
+    MICROPY_EVENT_POLL_HOOK
+}
+
+__weak int sensor_wait_for_motion(uint32_t timeout, bool stop_mode) {
+    #if defined(OMV_CSI_INT_PIN)
+    // Disable any ongoing frame capture.
+    sensor_abort(true, false);
+
+    // Check if the control is supported.
+    if (sensor.ioctl == NULL) {
+        return SENSOR_ERROR_CTL_UNSUPPORTED;
+    }
+
+    // The sensor keeps the interrupt pin asserted until cleared.
+    if (sensor_ioctl(IOCTL_HIMAX_MD_CLEAR) != 0) {
+        return SENSOR_ERROR_CTL_FAILED;
+    }
+
+    // The external clock stops with the MCU in stop mode.
+    if (stop_mode && (sensor_ioctl(IOCTL_HIMAX_OSC_ENABLE, 1) != 0)) {
+        return SENSOR_ERROR_CTL_FAILED;
+    }
+
+    sensor_motion = false;
+    omv_gpio_config(OMV_CSI_INT_PIN, OMV_GPIO_MODE_IT_RISE, OMV_GPIO_PULL_DOWN, OMV_GPIO_SPEED_LOW, -1);
+    omv_gpio_irq_register(OMV_CSI_INT_PIN, sensor_motion_callback, NULL);
+    omv_gpio_irq_enable(OMV_CSI_INT_PIN, true);
+
+    // SysTick doesn't run in stop mode, so timeouts are only checked after a wakeup.
+    for (mp_uint_t start = mp_hal_ticks_ms(); !sensor_motion;) {
+        if (timeout && ((mp_hal_ticks_ms() - start) >= timeout)) {
+            break;
+        }
+        sensor_wait_for_interrupt(stop_mode);
+    }
+
+    omv_gpio_irq_enable(OMV_CSI_INT_PIN, false);
+    omv_gpio_deinit(OMV_CSI_INT_PIN);
+
+    if (stop_mode) {
+        sensor_ioctl(IOCTL_HIMAX_OSC_ENABLE, 0);
+    }
+
+    // Clear the interrupt for the next wait.
+    sensor_ioctl(IOCTL_HIMAX_MD_CLEAR);
+    return sensor_motion ? 0 : SENSOR_ERROR_CAPTURE_TIMEOUT;
+    #else
+    return SENSOR_ERROR_CTL_UNSUPPORTED;
+    #endif
+}
+
 __weak int sensor_read_reg(uint16_t reg_addr) {
     int ret;
 
@@ -568,6 +752,9 @@ __weak int sensor_write_reg(uint16_t reg_addr, uint16_t reg_data) {
         return SENSOR_ERROR_CTL_UNSUPPORTED;
     }
 
+    // The register may be one that's cached.
+    sensor_regs_cache_invalidate();
+
     // Call the sensor specific function.
     if (sensor.write_reg(&sensor, reg_addr, reg_data) == -1) {
         return SENSOR_ERROR_IO_ERROR;
@@ -576,6 +763,79 @@ __weak int sensor_write_reg(uint16_t reg_addr, uint16_t reg_data) {
     return 0;
 }
 
+static int sensor_regs_write_run(sensor_t *sensor, uint16_t addr, const uint8_t *data, int len, uint32_t flags) {
+    if (len == 1) {
+        return (flags & SENSOR_REGS_ADDR16)
+            ? omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, addr, data[0])
+            : omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, addr, data[0]);
+    }
+
+    // The sensor auto-increments the address after each data byte.
+    uint8_t buf[2 + SENSOR_REGS_BURST_MAX];
+    int n = 0;
+    if (flags & SENSOR_REGS_ADDR16) {
+        buf[n++] = addr >> 8;
+    }
+    buf[n++] = addr;
+    memcpy(buf + n, data, len);
+    return omv_i2c_write_bytes(&sensor->i2c_bus, sensor->slv_addr, buf, n + len, OMV_I2C_XFER_NO_FLAGS);
+}
+
+int sensor_write_regs(sensor_t *sensor, const uint8_t *regs, uint32_t flags) {
+    int ret = 0;
+    int stride = (flags & SENSOR_REGS_ADDR16) ? 3 : 2;
+    int page_reg = (flags & SENSOR_REGS_PAGED) ? ((flags >> 8) & 0xFF) : -1;
+    uint32_t page = 0;
+
+    // The pending run of registers with consecutive addresses.
+    uint8_t run[SENSOR_REGS_BURST_MAX];
+    uint16_t run_addr = 0;
+    int run_len = 0;
+
+    for (; regs[0]; regs += stride) {
+        uint16_t addr = (flags & SENSOR_REGS_ADDR16) ? ((regs[0] << 8) | regs[1]) : regs[0];
+        uint8_t data = regs[stride - 1];
+        bool is_page = (addr == page_reg);
+
+        // The page register is always written as it's also changed outside of the cache.
+        uint32_t key = is_page ? 0 : (((page_reg >= 0) ? (page << 8) : 0) | addr);
+        uint32_t *entry = sensor_regs_cache_entry(key);
+        uint32_t value = (1 << 24) | (key << 8) | data;
+        bool skip = (!is_page) && (flags & SENSOR_REGS_CACHED) && (*entry == value);
+
+        if (run_len && (skip || is_page || (!(flags & SENSOR_REGS_BURST)) ||
+                        (addr != (run_addr + run_len)) || (run_len == SENSOR_REGS_BURST_MAX))) {
+            ret |= sensor_regs_write_run(sensor, run_addr, run, run_len, flags);
+            run_len = 0;
+        }
+
+        if (is_page) {
+            ret |= sensor_regs_write_run(sensor, addr, &data, 1, flags);
+            page = data;
+            continue;
+        }
+
+        if (!skip) {
+            if (!run_len) {
+                run_addr = addr;
+            }
+            run[run_len++] = data;
+            *entry = value;
+        }
+    }
+
+    if (run_len) {
+        ret |= sensor_regs_write_run(sensor, run_addr, run, run_len, flags);
+    }
+
+    // Nothing can be trusted after a failed write.
+    if (ret != 0) {
+        sensor_regs_cache_invalidate();
+    }
+
+    return ret;
+}
+
 __weak int sensor_set_pixformat(pixformat_t pixformat) {
     // Check if the value has changed.
     if (sensor.pixformat == pixformat) {
@@ -599,6 +859,14 @@ __weak int sensor_set_pixformat(pixformat_t pixformat) {
         return SENSOR_ERROR_PIXFORMAT_UNSUPPORTED;
     }
 
+    // Packed RAW frames are packed one line at a time, so they can't be transposed either.
+    if (((pixformat == PIXFORMAT_RAW10) && (OMV_CSI_DATA_BITS < 10)) ||
+        ((pixformat == PIXFORMAT_RAW12) && (OMV_CSI_DATA_BITS < 12)) ||
+        (((pixformat == PIXFORMAT_RAW10) || (pixformat == PIXFORMAT_RAW12)) &&
+         (sensor.transpose || sensor.auto_rotation))) {
+        return SENSOR_ERROR_PIXFORMAT_UNSUPPORTED;
+    }
+
     // Disable any ongoing frame capture.
     sensor_abort(true, false);
 
@@ -622,6 +890,16 @@ __weak int sensor_set_pixformat(pixformat_t pixformat) {
     // Set pixel format
     sensor.pixformat = pixformat;
 
+    // Capture conversion only applies to BAYER and YUV422 frames.
+    if ((pixformat != PIXFORMAT_BAYER) && (pixformat != PIXFORMAT_YUV422)) {
+        sensor.debayer = 0;
+    }
+
+    // The decimated copy only supports GRAYSCALE and RGB565 frames.
+    if ((pixformat != PIXFORMAT_GRAYSCALE) && (pixformat != PIXFORMAT_RGB565)) {
+        sensor.dual_scale = 0;
+    }
+
     // Skip the first frame.
     MAIN_FB()->pixfmt = PIXFORMAT_INVALID;
 
@@ -649,6 +927,9 @@ __weak int sensor_set_framesize(framesize_t framesize) {
         return SENSOR_ERROR_CTL_UNSUPPORTED;
     }
 
+    // Changing the frame size resets the sensor's output window.
+    sensor.hw_windowing = false;
+
     if (sensor.set_framesize(&sensor, framesize) != 0) {
         return SENSOR_ERROR_CTL_FAILED;
     }
@@ -729,9 +1010,11 @@ __weak bool sensor_get_cropped() {
 __weak uint32_t sensor_get_src_bpp() {
     switch (sensor.pixformat) {
         case PIXFORMAT_GRAYSCALE:
-            return sensor.hw_flags.gs_bpp;
+            return sensor.byte_select ? 1 : sensor.hw_flags.gs_bpp;
         case PIXFORMAT_RGB565:
         case PIXFORMAT_YUV422:
+        case PIXFORMAT_RAW10:
+        case PIXFORMAT_RAW12:
             return 2;
         case PIXFORMAT_BAYER:
         case PIXFORMAT_JPEG:
@@ -743,11 +1026,17 @@ __weak uint32_t sensor_get_src_bpp() {
 
 __weak uint32_t sensor_get_dst_bpp() {
     switch (sensor.pixformat) {
-        case PIXFORMAT_GRAYSCALE:
         case PIXFORMAT_BAYER:
+            return (sensor.debayer == PIXFORMAT_RGB565) ? 2 : 1;
+        case PIXFORMAT_YUV422:
+            return (sensor.debayer == PIXFORMAT_GRAYSCALE) ? 1 : 2;
+        case PIXFORMAT_GRAYSCALE:
             return 1;
         case PIXFORMAT_RGB565:
-        case PIXFORMAT_YUV422:
+            return 2;
+        case PIXFORMAT_RAW10:
+        case PIXFORMAT_RAW12:
+            // Rounded up, packed frames take 1.25 or 1.5 bytes per pixel.
             return 2;
         default:
             return 0;
@@ -779,6 +1068,20 @@ __weak int sensor_set_windowing(int x, int y, int w, int h) {
     MAIN_FB()->w = MAIN_FB()->u = w;
     MAIN_FB()->h = MAIN_FB()->v = h;
 
+    // Prefer having the sensor output only the window, which cuts the pixel clock and line time,
+    // and fall back to cropping lines on the host. Even offsets keep the bayer/yuv phase intact
+    // and a width that's a multiple of 16 keeps the line DMA friendly for any pixel format.
+    bool hw_windowing = false;
+    if (sensor_get_cropped() && !(x % 2) && !(y % 2) && !(w % 16)) {
+        hw_windowing = (sensor_ioctl(IOCTL_SET_OUTPUT_WINDOW, x, y, w, h) == 0);
+    }
+
+    if (!hw_windowing && sensor.hw_windowing) {
+        sensor_ioctl(IOCTL_SET_OUTPUT_WINDOW, 0, 0, 0, 0);
+    }
+
+    sensor.hw_windowing = hw_windowing;
+
     // Pickout a good buffer count for the user.
     framebuffer_auto_adjust_buffers();
 
@@ -786,6 +1089,22 @@ __weak int sensor_set_windowing(int x, int y, int w, int h) {
     return sensor_config(SENSOR_CONFIG_WINDOWING);
 }
 
+__weak uint32_t sensor_get_src_x() {
+    return sensor.hw_windowing ? 0 : MAIN_FB()->x;
+}
+
+__weak uint32_t sensor_get_src_y() {
+    return sensor.hw_windowing ? 0 : MAIN_FB()->y;
+}
+
+__weak uint32_t sensor_get_src_width() {
+    return sensor.hw_windowing ? MAIN_FB()->u : resolution[sensor.framesize][0];
+}
+
+__weak uint32_t sensor_get_src_height() {
+    return sensor.hw_windowing ? MAIN_FB()->v : resolution[sensor.framesize][1];
+}
+
 __weak int sensor_set_contrast(int level) {
     // Check if the control is supported.
     if (sensor.set_contrast == NULL) {
@@ -884,6 +1203,9 @@ __weak int sensor_set_auto_gain(int enable, float gain_db, float gain_db_ceiling
         return SENSOR_ERROR_CTL_UNSUPPORTED;
     }
 
+    // User settings take over from the firmware loop.
+    sensor.ae.enable = false;
+
     // Call the sensor specific function.
     if (sensor.set_auto_gain(&sensor, enable, gain_db, gain_db_ceiling) != 0) {
         return SENSOR_ERROR_CTL_FAILED;
@@ -912,6 +1234,9 @@ __weak int sensor_set_auto_exposure(int enable, int exposure_us) {
         return SENSOR_ERROR_CTL_UNSUPPORTED;
     }
 
+    // User settings take over from the firmware loop.
+    sensor.ae.enable = false;
+
     // Call the sensor specific function.
     if (sensor.set_auto_exposure(&sensor, enable, exposure_us) != 0) {
         return SENSOR_ERROR_CTL_FAILED;
@@ -934,6 +1259,235 @@ __weak int sensor_get_exposure_us(int *exposure_us) {
     return 0;
 }
 
+#define SENSOR_AE_GRID          (32)    // Metering samples per row and column.
+#define SENSOR_AE_SETTLE        (2)     // Frames captured before new settings show up.
+#define SENSOR_AE_DEADBAND      (8)     // Brightness error that's left alone.
+#define SENSOR_AE_CLIPPED       (248)   // Samples at or above this are clipped.
+#define SENSOR_AE_EXPOSURE_MIN  (10)
+
+__weak int sensor_set_ae(bool enable, int target, int exposure_us_max, float gain_db_ceiling) {
+    if (!enable) {
+        sensor.ae.enable = false;
+        return 0;
+    }
+
+    // Check if the controls are supported.
+    if ((sensor.set_auto_exposure == NULL) || (sensor.get_exposure_us == NULL)) {
+        return SENSOR_ERROR_CTL_UNSUPPORTED;
+    }
+
+    if ((target < 1) || (target > 254) || (gain_db_ceiling < 0.0f)) {
+        return SENSOR_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Start from the current settings.
+    int exposure_us;
+    if (sensor.get_exposure_us(&sensor, &exposure_us) != 0) {
+        return SENSOR_ERROR_CTL_FAILED;
+    }
+
+    float gain_db = 0.0f;
+    if ((sensor.set_auto_gain == NULL)
+        || (sensor.get_gain_db == NULL)
+        || (sensor.get_gain_db(&sensor, &gain_db) != 0)) {
+        // Exposure only, gain stays where it is.
+        gain_db = gain_db_ceiling = 0.0f;
+    }
+
+    if (exposure_us_max <= 0) {
+        exposure_us_max = 1000000 / (sensor.framerate ? sensor.framerate : 30);
+    }
+
+    // Turn off the sensor's own loops so they don't fight this one.
+    if ((sensor.set_auto_exposure(&sensor, 0, exposure_us) != 0)
+        || ((sensor.set_auto_gain != NULL) && (sensor.set_auto_gain(&sensor, 0, gain_db, NAN) != 0))) {
+        return SENSOR_ERROR_CTL_FAILED;
+    }
+
+    sensor.ae.target = target;
+    sensor.ae.settle = SENSOR_AE_SETTLE;
+    sensor.ae.exposure_us = IM_MAX(exposure_us, SENSOR_AE_EXPOSURE_MIN);
+    sensor.ae.exposure_us_max = IM_MAX(exposure_us_max, SENSOR_AE_EXPOSURE_MIN);
+    sensor.ae.gain_db = IM_CLAMP(gain_db, 0.0f, gain_db_ceiling);
+    sensor.ae.gain_db_ceiling = gain_db_ceiling;
+    sensor.ae.enable = true;
+    return 0;
+}
+
+// Returns the mean brightness of a grid of samples, or -1 for formats that can't be metered.
+static int sensor_ae_meter(image_t *image, int *count, int *clipped) {
+    bool bayer = false;
+
+    switch (image->pixfmt) {
+        case PIXFORMAT_GRAYSCALE:
+        case PIXFORMAT_RGB565:
+        case PIXFORMAT_YUV_ANY:
+            break;
+        case PIXFORMAT_BAYER_ANY:
+            bayer = true;
+            break;
+        default:
+            return -1;
+    }
+
+    // Bayer samples are 2x2 quads on even coordinates.
+    int x_step = IM_MAX(image->w / SENSOR_AE_GRID, 2) & ~1;
+    int y_step = IM_MAX(image->h / SENSOR_AE_GRID, 2) & ~1;
+    int x_end = image->w - bayer, y_end = image->h - bayer;
+    uint32_t sum = 0;
+
+    *count = *clipped = 0;
+
+    for (int y = (y_step / 2) & ~1; y < y_end; y += y_step) {
+        for (int x = (x_step / 2) & ~1; x < x_end; x += x_step) {
+            int v;
+
+            switch (image->pixfmt) {
+                case PIXFORMAT_GRAYSCALE: {
+                    v = IMAGE_GET_GRAYSCALE_PIXEL(image, x, y);
+                    break;
+                }
+                case PIXFORMAT_RGB565: {
+                    v = COLOR_RGB565_TO_Y(IMAGE_GET_RGB565_PIXEL(image, x, y));
+                    break;
+                }
+                case PIXFORMAT_YUV_ANY: {
+                    v = IMAGE_GET_YUV_PIXEL(image, x, y) & 0xff;
+                    break;
+                }
+                default: {
+                    v = (IMAGE_GET_BAYER_PIXEL(image, x, y) + IMAGE_GET_BAYER_PIXEL(image, x + 1, y) +
+                         IMAGE_GET_BAYER_PIXEL(image, x, y + 1) + IMAGE_GET_BAYER_PIXEL(image, x + 1, y + 1)) >> 2;
+                    break;
+                }
+            }
+
+            sum += v;
+            *count += 1;
+            *clipped += (v >= SENSOR_AE_CLIPPED);
+        }
+    }
+
+    return *count ? (sum / *count) : -1;
+}
+
+__weak void sensor_update_ae(image_t *image) {
+    sensor_ae_t *ae = &sensor.ae;
+
+    if (!ae->enable) {
+        return;
+    }
+
+    // Frames captured before the last update took effect say nothing new.
+    if (ae->settle) {
+        ae->settle -= 1;
+        return;
+    }
+
+    int count, clipped;
+    int mean = sensor_ae_meter(image, &count, &clipped);
+    if (mean < 0) {
+        return;
+    }
+
+    float ratio = ae->target / (float) IM_MAX(mean, 1);
+
+    // Clipped highlights hide how far over the target the scene is, so never brighten
+    // and keep pulling down while more than 1/16th of the samples are clipped.
+    if (clipped > (count / 16)) {
+        ratio = IM_MIN(ratio, 0.75f);
+    } else if (abs(mean - ae->target) <= SENSOR_AE_DEADBAND) {
+        return;
+    }
+
+    ratio = IM_CLAMP(ratio, 0.25f, 4.0f);
+
+    // Fill exposure first since it adds no noise, then make up the rest with gain.
+    float total = ae->exposure_us * powf(10.0f, ae->gain_db / 20.0f) * ratio;
+    int exposure_us = IM_MAX((int) IM_MIN(total, (float) ae->exposure_us_max), SENSOR_AE_EXPOSURE_MIN);
+    float gain_db = IM_CLAMP(20.0f * log10f(total / exposure_us), 0.0f, ae->gain_db_ceiling);
+
+    if ((exposure_us == ae->exposure_us) && (fabsf(gain_db - ae->gain_db) < 0.1f)) {
+        return;
+    }
+
+    // The frame has already been captured, don't wait for the settings to settle.
+    bool disable_delays = sensor.disable_delays;
+    sensor.disable_delays = true;
+
+    if (exposure_us != ae->exposure_us) {
+        sensor.set_auto_exposure(&sensor, 0, exposure_us);
+        ae->exposure_us = exposure_us;
+    }
+
+    if (fabsf(gain_db - ae->gain_db) >= 0.1f) {
+        sensor.set_auto_gain(&sensor, 0, gain_db, NAN);
+        ae->gain_db = gain_db;
+    }
+
+    sensor.disable_delays = disable_delays;
+    ae->settle = SENSOR_AE_SETTLE;
+}
+
+__weak int sensor_snapshot_hdr(image_t *image, const int *exposures_us, int n, int latency) {
+    // Check if the control is supported.
+    if (sensor.set_auto_exposure == NULL) {
+        return SENSOR_ERROR_CTL_UNSUPPORTED;
+    }
+
+    if ((n < 2) || (n > IMLIB_HDR_MAX_FRAMES) || (latency < 0)) {
+        return SENSOR_ERROR_INVALID_ARGUMENT;
+    }
+
+    // The bracket replaces the firmware exposure loop.
+    sensor.ae.enable = false;
+
+    bool disable_delays = sensor.disable_delays;
+    sensor.disable_delays = true;
+
+    image_t frames[IMLIB_HDR_MAX_FRAMES - 1];
+    int ret = 0;
+    fb_alloc_mark();
+
+    for (int i = 0; (i < n) && (!ret); i++) {
+        // Exposure is written between frames, queued frames still have the old exposure.
+        if (sensor.set_auto_exposure(&sensor, 0, exposures_us[i]) != 0) {
+            ret = SENSOR_ERROR_CTL_FAILED;
+            break;
+        }
+
+        sensor_abort(true, false);
+
+        // Frames are tagged with the exposure that was programmed for them.
+        sensor.exposure_us = exposures_us[i];
+        sensor.info_ms = mp_hal_ticks_ms();
+
+        // Skip the frames exposed before the sensor latched the new exposure.
+        for (int j = 0; (j <= latency) && (!ret); j++) {
+            ret = sensor.snapshot(&sensor, image, 0);
+        }
+
+        if ((!ret) && (image->pixfmt != PIXFORMAT_GRAYSCALE) && (image->pixfmt != PIXFORMAT_RGB565)) {
+            ret = SENSOR_ERROR_PIXFORMAT_UNSUPPORTED;
+        }
+
+        // The last exposure stays in the frame buffer and receives the fused image.
+        if ((!ret) && (i < (n - 1))) {
+            frames[i] = *image;
+            frames[i].data = fb_alloc(image_size(image), FB_ALLOC_PREFER_SPEED);
+            memcpy(frames[i].data, image->data, image_size(image));
+        }
+    }
+
+    if (!ret) {
+        imlib_hdr_fuse(image, frames, n - 1);
+    }
+
+    fb_alloc_free_till_mark();
+    sensor.disable_delays = disable_delays;
+    return ret;
+}
+
 __weak int sensor_set_auto_whitebal(int enable, float r_gain_db, float g_gain_db, float b_gain_db) {
     // Check if the control is supported.
     if (sensor.set_auto_whitebal == NULL) {
@@ -1067,7 +1621,9 @@ __weak int sensor_set_transpose(bool enable) {
     // Disable any ongoing frame capture.
     sensor_abort(true, false);
 
-    if ((sensor.pixformat == PIXFORMAT_YUV422) || (sensor.pixformat == PIXFORMAT_JPEG)) {
+    if ((sensor.pixformat == PIXFORMAT_YUV422) || (sensor.pixformat == PIXFORMAT_JPEG)
+        || (sensor.pixformat == PIXFORMAT_RAW10) || (sensor.pixformat == PIXFORMAT_RAW12)
+        || sensor.debayer || sensor.dual_scale) {
         return SENSOR_ERROR_PIXFORMAT_UNSUPPORTED;
     }
 
@@ -1091,7 +1647,9 @@ __weak int sensor_set_auto_rotation(bool enable) {
     sensor_abort(true, false);
 
     // Operation not supported on JPEG images.
-    if ((sensor.pixformat == PIXFORMAT_YUV422) || (sensor.pixformat == PIXFORMAT_JPEG)) {
+    if ((sensor.pixformat == PIXFORMAT_YUV422) || (sensor.pixformat == PIXFORMAT_JPEG)
+        || (sensor.pixformat == PIXFORMAT_RAW10) || (sensor.pixformat == PIXFORMAT_RAW12)
+        || sensor.debayer || sensor.dual_scale) {
         return SENSOR_ERROR_PIXFORMAT_UNSUPPORTED;
     }
 
@@ -1104,6 +1662,83 @@ __weak bool sensor_get_auto_rotation() {
     return sensor.auto_rotation;
 }
 
+__weak int sensor_set_debayer(pixformat_t pixformat) {
+    return SENSOR_ERROR_CTL_UNSUPPORTED;
+}
+
+__weak pixformat_t sensor_get_debayer() {
+    return sensor.debayer;
+}
+
+__weak int sensor_set_dual_output(uint32_t scale) {
+    return SENSOR_ERROR_CTL_UNSUPPORTED;
+}
+
+__weak uint32_t sensor_get_dual_output() {
+    return sensor.dual_scale;
+}
+
+// Size of the decimated copy kept after the image.
+static uint32_t sensor_get_dual_size() {
+    if (!sensor.dual_scale) {
+        return 0;
+    }
+
+    return (MAIN_FB()->u / sensor.dual_scale) * (MAIN_FB()->v / sensor.dual_scale) * sensor_get_dst_bpp();
+}
+
+int sensor_get_dual_image(image_t *image) {
+    if ((!sensor.dual_scale) || (framebuffer_get_depth() < 0)
+        || ((MAIN_FB()->pixfmt != PIXFORMAT_GRAYSCALE) && (MAIN_FB()->pixfmt != PIXFORMAT_RGB565))) {
+        return -1;
+    }
+
+    image_t main;
+    framebuffer_init_image(&main);
+
+    image->w = main.w / sensor.dual_scale;
+    image->h = main.h / sensor.dual_scale;
+    image->pixfmt = main.pixfmt;
+    image->pixels = main.pixels + image_size(&main);
+    return ((image->w && image->h) ? 0 : -1);
+}
+
+void sensor_dual_copy_line(uint8_t *src, uint32_t line, uint8_t *data) {
+    uint32_t scale = sensor.dual_scale;
+    uint32_t w = MAIN_FB()->u / scale;
+
+    if ((line % scale) || ((line / scale) >= (MAIN_FB()->v / scale))) {
+        return;
+    }
+
+    // Source pixels are picked directly from the line buffer, so YUV422 grayscale samples
+    // the Y bytes and byte swapped RGB565 is fixed up here.
+    if (sensor.pixformat == PIXFORMAT_GRAYSCALE) {
+        uint32_t step = scale * sensor_get_src_bpp();
+        uint8_t *dst = data + (MAIN_FB()->u * MAIN_FB()->v) + ((line / scale) * w);
+
+        for (uint32_t x = 0; x < w; x++, src += step) {
+            dst[x] = *src;
+        }
+    } else {
+        uint16_t *src16 = (uint16_t *) src;
+        uint16_t *dst16 = ((uint16_t *) data) + (MAIN_FB()->u * MAIN_FB()->v) + ((line / scale) * w);
+
+        #if !OMV_CSI_HW_SWAP_ENABLE
+        if (sensor.hw_flags.rgb_swap) {
+            for (uint32_t x = 0; x < w; x++, src16 += scale) {
+                dst16[x] = __REV16(*src16);
+            }
+            return;
+        }
+        #endif
+
+        for (uint32_t x = 0; x < w; x++, src16 += scale) {
+            dst16[x] = *src16;
+        }
+    }
+}
+
 __weak int sensor_set_framebuffers(int count) {
     // Disable any ongoing frame capture.
     sensor_abort(true, false);
@@ -1190,6 +1825,16 @@ __weak const uint16_t *sensor_get_color_palette() {
 __weak int sensor_check_framebuffer_size() {
     uint32_t bpp = sensor_get_dst_bpp();
     uint32_t size = framebuffer_get_buffer_size();
+
+    // The raw rows being debayered are kept after the image.
+    if (sensor.debayer && (sensor.pixformat == PIXFORMAT_BAYER)) {
+        uint32_t rows_size = MAIN_FB()->u * DEBAYER_STREAM_ROWS;
+        size = (size > rows_size) ? (size - rows_size) : 0;
+    }
+
+    // The decimated copy is kept after the image.
+    size = (size > sensor_get_dual_size()) ? (size - sensor_get_dual_size()) : 0;
+
     return (((MAIN_FB()->u * MAIN_FB()->v * bpp) <= size) ? 0 : -1);
 }
 
@@ -1197,6 +1842,15 @@ __weak int sensor_auto_crop_framebuffer() {
     uint32_t bpp = sensor_get_dst_bpp();
     uint32_t size = framebuffer_get_buffer_size();
 
+    // The raw rows being debayered are kept after the image.
+    if (sensor.debayer && (sensor.pixformat == PIXFORMAT_BAYER)) {
+        uint32_t rows_size = MAIN_FB()->u * DEBAYER_STREAM_ROWS;
+        size = (size > rows_size) ? (size - rows_size) : 0;
+    }
+
+    // The decimated copy is kept after the image.
+    size = (size > sensor_get_dual_size()) ? (size - sensor_get_dual_size()) : 0;
+
     // If the pixformat is NULL/JPEG there we can't do anything to check if it fits before hand.
     if (!bpp) {
         return 0;
@@ -1276,6 +1930,13 @@ __weak int sensor_auto_crop_framebuffer() {
         MAIN_FB()->y -= 1;
     }
 
+    // Move the sensor's output window along, or fall back to cropping on the host.
+    if (sensor.hw_windowing && (sensor_ioctl(IOCTL_SET_OUTPUT_WINDOW, MAIN_FB()->x, MAIN_FB()->y,
+                                             MAIN_FB()->u, MAIN_FB()->v) != 0)) {
+        sensor_ioctl(IOCTL_SET_OUTPUT_WINDOW, 0, 0, 0, 0);
+        sensor.hw_windowing = false;
+    }
+
     // Pickout a good buffer count for the user.
     framebuffer_auto_adjust_buffers();
     return 0;
@@ -1319,7 +1980,7 @@ __weak int sensor_copy_line(void *dma, uint8_t *src, uint8_t *dst) {
                 break;
             }
             #endif
-            if (sensor.hw_flags.gs_bpp == 1) {
+            if ((sensor.hw_flags.gs_bpp == 1) || sensor.byte_select) {
                 // 1BPP GRAYSCALE.
                 if (!sensor.transpose) {
                     unaligned_memcpy(dst, src, MAIN_FB()->u);
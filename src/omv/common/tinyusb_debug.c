@@ -11,11 +11,12 @@
 
 #include "omv_boardconfig.h"
 #if (OMV_TUSBDBG_ENABLE == 1)
+#include <string.h>
 #include "py/runtime.h"
 #include "py/stream.h"
 #include "py/mphal.h"
-#include "py/ringbuf.h"
 #include "pendsv.h"
+#include "ringbuf.h"
 
 #include "tusb.h"
 #include "usbdbg.h"
@@ -34,24 +35,23 @@ typedef struct __attribute__((packed)) {
 }
 usbdbg_cmd_t;
 
+// Written by the main thread and read by the debug task in PendSV, the ring is lock-free.
 static uint8_t debug_ringbuf_array[512];
 static volatile bool tinyusb_debug_mode = false;
-ringbuf_t debug_ringbuf = { debug_ringbuf_array, sizeof(debug_ringbuf_array) };
+static ring_buf_t debug_ringbuf = { 0, 0, sizeof(debug_ringbuf_array) - 1, debug_ringbuf_array };
 
 uint32_t usb_cdc_buf_len() {
-    return ringbuf_avail((ringbuf_t *) &debug_ringbuf);
+    return ring_buf_avail(&debug_ringbuf);
 }
 
 uint32_t usb_cdc_get_buf(uint8_t *buf, uint32_t len) {
-    for (int i = 0; i < len; i++) {
-        buf[i] = ringbuf_get((ringbuf_t *) &debug_ringbuf);
-    }
+    uint32_t bytes = ring_buf_read(&debug_ringbuf, buf, len);
+    memset(buf + bytes, 0, len - bytes);
     return len;
 }
 
 void tud_cdc_line_coding_cb(uint8_t itf, cdc_line_coding_t const *coding) {
-    debug_ringbuf.iget = 0;
-    debug_ringbuf.iput = 0;
+    ring_buf_flush(&debug_ringbuf);
 
     if (0) {
         #if defined(MICROPY_BOARD_ENTER_BOOTLOADER)
@@ -83,11 +83,8 @@ extern mp_uint_t __real_mp_hal_stdout_tx_strn(const char *str, mp_uint_t len);
 mp_uint_t __wrap_mp_hal_stdout_tx_strn(const char *str, mp_uint_t len) {
     if (tinyusb_debug_enabled()) {
         if (tud_cdc_connected()) {
-            for (int i = 0; i < len; i++) {
-                NVIC_DisableIRQ(PendSV_IRQn);
-                ringbuf_put((ringbuf_t *) &debug_ringbuf, str[i]);
-                NVIC_EnableIRQ(PendSV_IRQn);
-            }
+            // Whatever doesn't fit is dropped, as before.
+            ring_buf_write(&debug_ringbuf, str, len);
         }
         return len;
     } else {
@@ -6,11 +6,16 @@
  *
  * This work is licensed under the MIT license, see the file LICENSE for details.
  *
- * Trace buffer.
+ * Trace buffer and cycle counter profiler.
  */
 #include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
 #include "cmsis_compiler.h"
 #include "trace.h"
+#if OMV_PROFILE_ENABLE
+#include CMSIS_MCU_H
+#endif
 
 #define TRACEBUF_SIZE    (256)
 typedef struct _tracebuf_t {
@@ -20,11 +25,48 @@ typedef struct _tracebuf_t {
 
 static tracebuf_t tracebuf;
 
+#if OMV_PROFILE_ENABLE
+static trace_prof_t trace_prof[TRACE_PROF_MAX];
+
+typedef struct _trace_timeline_t {
+    uint32_t head;              // Total events recorded, the ring index wraps.
+    bool frozen;
+    trace_event_t events[TRACE_TIMELINE_SIZE];
+} trace_timeline_t;
+
+static trace_timeline_t trace_timeline;
+
+static const char *const trace_prof_names[TRACE_PROF_MAX] = {
+    [TRACE_PROF_SNAPSHOT] = "sensor_snapshot",
+    [TRACE_PROF_FIND_BLOBS] = "imlib_find_blobs",
+    [TRACE_PROF_DRAW_IMAGE] = "imlib_draw_image",
+    [TRACE_PROF_JPEG_COMPRESS] = "jpeg_compress",
+    [TRACE_PROF_TF_INVOKE] = "libtf_invoke",
+    [TRACE_PROF_DISPLAY_WRITE] = "display_write",
+    [TRACE_PROF_FRAME_START] = "frame_start",
+    [TRACE_PROF_FRAME_END] = "frame_end",
+    [TRACE_PROF_USBDBG_SEND] = "usbdbg_send",
+    [TRACE_PROF_POWER_STATE] = "power_state",
+};
+#endif
+
 void trace_init() {
     tracebuf.idx = 0;
     for (int i = 0; i < TRACEBUF_SIZE; i++) {
         tracebuf.buf[i] = 0;
     }
+
+    #if OMV_PROFILE_ENABLE
+    // Enable the DWT cycle counter.
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    #if defined(__CORE_CM7_H_GENERIC)
+    DWT->LAR = 0xC5ACCE55;
+    #endif
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    trace_prof_reset();
+    trace_timeline_reset();
+    #endif
 }
 
 void trace_insert(uint32_t x) {
@@ -34,3 +76,61 @@ void trace_insert(uint32_t x) {
     }
     __enable_irq();
 }
+
+#if OMV_PROFILE_ENABLE
+void trace_prof_reset() {
+    memset(trace_prof, 0, sizeof(trace_prof));
+    for (int i = 0; i < TRACE_PROF_MAX; i++) {
+        trace_prof[i].min = UINT32_MAX;
+    }
+}
+
+void trace_prof_update(trace_prof_id_t id, uint32_t cycles) {
+    trace_prof_t *prof = &trace_prof[id];
+    prof->count += 1;
+    prof->total += cycles;
+    prof->min = (cycles < prof->min) ? cycles : prof->min;
+    prof->max = (cycles > prof->max) ? cycles : prof->max;
+    // Bin by log4(cycles), 32-bit cycles map exactly to 16 bins.
+    prof->hist[(31 - __CLZ(cycles | 1)) / 2] += 1;
+}
+
+const char *trace_prof_name(trace_prof_id_t id) {
+    return trace_prof_names[id];
+}
+
+const trace_prof_t *trace_prof_get(trace_prof_id_t id) {
+    return &trace_prof[id];
+}
+
+void trace_event(trace_prof_id_t id, trace_event_phase_t phase, uint32_t cycles) {
+    // Events are recorded from IRQs too.
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!trace_timeline.frozen) {
+        trace_event_t *event = &trace_timeline.events[trace_timeline.head++ % TRACE_TIMELINE_SIZE];
+        event->cycles = cycles;
+        event->id = id;
+        event->phase = phase;
+        event->irq = __get_IPSR();
+    }
+    __set_PRIMASK(primask);
+}
+
+uint32_t trace_timeline_freeze() {
+    trace_timeline.frozen = true;
+    return (trace_timeline.head < TRACE_TIMELINE_SIZE) ? trace_timeline.head : TRACE_TIMELINE_SIZE;
+}
+
+const trace_event_t *trace_timeline_get(uint32_t index) {
+    uint32_t oldest = (trace_timeline.head < TRACE_TIMELINE_SIZE) ? 0 : (trace_timeline.head - TRACE_TIMELINE_SIZE);
+    return &trace_timeline.events[(oldest + index) % TRACE_TIMELINE_SIZE];
+}
+
+void trace_timeline_reset() {
+    __disable_irq();
+    trace_timeline.head = 0;
+    trace_timeline.frozen = false;
+    __enable_irq();
+}
+#endif // OMV_PROFILE_ENABLE
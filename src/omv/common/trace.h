@@ -6,11 +6,110 @@
  *
  * This work is licensed under the MIT license, see the file LICENSE for details.
  *
- * Trace buffer.
+ * Trace buffer and cycle counter profiler.
  */
 #ifndef __TRACE_H__
 #define __TRACE_H__
 #include <stdint.h>
+#include "omv_boardconfig.h"
+
+#ifndef OMV_PROFILE_ENABLE
+#define OMV_PROFILE_ENABLE      (0)
+#endif
+
+// Each bin counts the samples in [4^i, 4^(i + 1)) cycles.
+#define TRACE_PROF_HIST_BINS    (16)
+
+// Timeline ring size in events, must be a power of 2.
+#define TRACE_TIMELINE_SIZE     (1024)
+
+// Profiler probes, keep in sync with the names in trace.c.
+typedef enum {
+    TRACE_PROF_SNAPSHOT,
+    TRACE_PROF_FIND_BLOBS,
+    TRACE_PROF_DRAW_IMAGE,
+    TRACE_PROF_JPEG_COMPRESS,
+    TRACE_PROF_TF_INVOKE,
+    TRACE_PROF_DISPLAY_WRITE,
+    TRACE_PROF_FRAME_START,     // Timeline only, first line of a frame received.
+    TRACE_PROF_FRAME_END,       // Timeline only, last line of a frame received.
+    TRACE_PROF_USBDBG_SEND,     // Timeline only, frame transfer to the IDE.
+    TRACE_PROF_POWER_STATE,     // Timeline only, energy accounting state change.
+    TRACE_PROF_MAX
+} trace_prof_id_t;
+
+// Timeline event phases.
+typedef enum {
+    TRACE_EVENT_BEGIN,
+    TRACE_EVENT_END,
+    TRACE_EVENT_INSTANT,
+} trace_event_phase_t;
+
+// Note: this is also the record layout sent to the IDE by USBDBG_PROFILE_DUMP.
+typedef struct _trace_prof_t {
+    uint64_t total;
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t hist[TRACE_PROF_HIST_BINS];
+} trace_prof_t;
+
+// Note: this is also the record layout sent to the IDE by USBDBG_TIMELINE_DUMP.
+typedef struct _trace_event_t {
+    uint32_t cycles;
+    uint8_t id;                 // trace_prof_id_t
+    uint8_t phase;              // trace_event_phase_t
+    uint16_t irq;               // Active exception number, 0 in thread mode.
+} trace_event_t;
+
+// Scoped probe state, updated when the enclosing scope exits.
+typedef struct _trace_prof_scope_t {
+    trace_prof_id_t id;
+    uint32_t start;
+} trace_prof_scope_t;
+
 void trace_init();
 void trace_insert(uint32_t x);
+
+#if OMV_PROFILE_ENABLE
+// DWT_CYCCNT is at the same address on all ARMv7-M and ARMv8-M cores.
+#define TRACE_DWT_CYCCNT        (*((volatile uint32_t *) 0xE0001004))
+
+void trace_prof_reset();
+void trace_prof_update(trace_prof_id_t id, uint32_t cycles);
+const char *trace_prof_name(trace_prof_id_t id);
+const trace_prof_t *trace_prof_get(trace_prof_id_t id);
+
+// Records an event into the timeline ring, overwriting the oldest event when full.
+void trace_event(trace_prof_id_t id, trace_event_phase_t phase, uint32_t cycles);
+// Stops recording and returns the number of events in the ring.
+uint32_t trace_timeline_freeze();
+// Returns the event at index (0 is the oldest) while frozen.
+const trace_event_t *trace_timeline_get(uint32_t index);
+// Empties the ring and resumes recording.
+void trace_timeline_reset();
+
+static inline trace_prof_scope_t trace_prof_scope_begin(trace_prof_id_t id) {
+    trace_prof_scope_t scope = { id, TRACE_DWT_CYCCNT };
+    trace_event(id, TRACE_EVENT_BEGIN, scope.start);
+    return scope;
+}
+
+static inline void trace_prof_scope_end(trace_prof_scope_t *scope) {
+    uint32_t end = TRACE_DWT_CYCCNT;
+    trace_event(scope->id, TRACE_EVENT_END, end);
+    trace_prof_update(scope->id, end - scope->start);
+}
+
+// Measures from this point to the end of the enclosing scope (including early returns).
+// Note: scopes left by an exception (nlr jump) are not recorded.
+#define TRACE_PROF_SCOPE(id)                                                 \
+    trace_prof_scope_t __attribute__((cleanup(trace_prof_scope_end), unused)) \
+    trace_prof_scope = trace_prof_scope_begin(id)
+
+#define TRACE_EVENT(id, phase)  trace_event((id), (phase), TRACE_DWT_CYCCNT)
+#else
+#define TRACE_PROF_SCOPE(id)
+#define TRACE_EVENT(id, phase)
+#endif // OMV_PROFILE_ENABLE
 #endif /* __TRACE_H__ */
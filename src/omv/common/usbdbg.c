@@ -24,14 +24,26 @@
 #include "sensor.h"
 #endif
 #include "framebuffer.h"
+#include "fb_alloc.h"
+#include "trace.h"
 #include "usbdbg.h"
 #include "omv_boardconfig.h"
 #include "py_image.h"
 
+// USBDBG_FRAME_STREAM sends a header (uint32_t seq, w, h, size as in USBDBG_FRAME_SIZE) followed
+// by the frame, zero-padded to the requested length. The requested length is the host's credit: a
+// frame that doesn't fit stays locked and the rest is read with USBDBG_FRAME_DUMP. seq is the
+// capture sequence number of the frame, synchronized cameras number frames by frame sync pulse.
+#define USBDBG_FRAME_STREAM_HDR_SIZE    (16)
+
 static int xfer_bytes;
 static int xfer_length;
 static enum usbdbg_cmd cmd;
 
+static int frame_offset;
+static int frame_length;
+static jpegbuffer_slot_t *frame_slot;
+
 static volatile bool script_ready;
 static volatile bool script_running;
 static volatile bool irq_enabled;
@@ -168,32 +180,80 @@ void usbdbg_data_in(void *buffer, int length) {
         }
 
         case USBDBG_FRAME_SIZE:
-            // Return 0 if FB is locked or not ready.
+            // Return 0 if no frame is ready.
             ((uint32_t *) buffer)[0] = 0;
-            // Try to lock FB. If header size == 0 frame is not ready
-            if (mutex_try_lock_alternate(&JPEG_FB()->lock, MUTEX_TID_IDE)) {
-                // If header size == 0 frame is not ready
-                if (JPEG_FB()->size == 0) {
-                    // unlock FB
-                    mutex_unlock(&JPEG_FB()->lock, MUTEX_TID_IDE);
-                } else {
-                    // Return header w, h and size/bpp
-                    ((uint32_t *) buffer)[0] = JPEG_FB()->w;
-                    ((uint32_t *) buffer)[1] = JPEG_FB()->h;
-                    ((uint32_t *) buffer)[2] = JPEG_FB()->size;
-                }
+            // The frame is held until it has been dumped.
+            frame_slot = framebuffer_jpeg_read_begin();
+            if (frame_slot) {
+                // Return header w, h and size/bpp
+                ((uint32_t *) buffer)[0] = frame_slot->w;
+                ((uint32_t *) buffer)[1] = frame_slot->h;
+                ((uint32_t *) buffer)[2] = frame_slot->size;
             }
             cmd = USBDBG_NONE;
             break;
 
         case USBDBG_FRAME_DUMP:
             if (xfer_bytes < xfer_length) {
-                memcpy(buffer, JPEG_FB()->pixels + xfer_bytes, length);
+                if (!xfer_bytes) {
+                    TRACE_EVENT(TRACE_PROF_USBDBG_SEND, TRACE_EVENT_BEGIN);
+                }
+                if (frame_slot) {
+                    memcpy(buffer, frame_slot->pixels + frame_offset + xfer_bytes, length);
+                } else {
+                    memset(buffer, 0, length);
+                }
                 xfer_bytes += length;
                 if (xfer_bytes == xfer_length) {
+                    TRACE_EVENT(TRACE_PROF_USBDBG_SEND, TRACE_EVENT_END);
                     cmd = USBDBG_NONE;
-                    JPEG_FB()->w = 0; JPEG_FB()->h = 0; JPEG_FB()->size = 0;
-                    mutex_unlock(&JPEG_FB()->lock, MUTEX_TID_IDE);
+                    frame_slot = NULL;
+                    framebuffer_jpeg_read_end();
+                }
+            }
+            break;
+
+        case USBDBG_FRAME_STREAM:
+            if (xfer_bytes < xfer_length) {
+                uint8_t *buf = buffer;
+                int offset = 0;
+
+                if (!xfer_bytes) {
+                    TRACE_EVENT(TRACE_PROF_USBDBG_SEND, TRACE_EVENT_BEGIN);
+                    uint32_t header[4] = { 0, 0, 0, 0 };
+                    frame_length = 0;
+                    frame_slot = framebuffer_jpeg_read_begin();
+                    if (frame_slot) {
+                        header[0] = frame_slot->seq;
+                        header[1] = frame_slot->w;
+                        header[2] = frame_slot->h;
+                        header[3] = frame_slot->size;
+                        frame_length = (frame_slot->size > 2) ? frame_slot->size :
+                                       (frame_slot->w * frame_slot->h * frame_slot->size);
+                    }
+                    offset = IM_MIN(length, USBDBG_FRAME_STREAM_HDR_SIZE);
+                    memcpy(buf, header, offset);
+                }
+
+                // Position of buf[offset] in the frame.
+                int pos = xfer_bytes + offset - USBDBG_FRAME_STREAM_HDR_SIZE;
+                int n = IM_MAX(IM_MIN(frame_length - pos, length - offset), 0);
+                if (n) {
+                    memcpy(buf + offset, frame_slot->pixels + pos, n);
+                }
+                memset(buf + offset + n, 0, length - offset - n);
+
+                xfer_bytes += length;
+                if (xfer_bytes == xfer_length) {
+                    TRACE_EVENT(TRACE_PROF_USBDBG_SEND, TRACE_EVENT_END);
+                    cmd = USBDBG_NONE;
+                    if (frame_length) {
+                        frame_offset = xfer_length - USBDBG_FRAME_STREAM_HDR_SIZE;
+                        if (frame_offset >= frame_length) {
+                            frame_slot = NULL;
+                            framebuffer_jpeg_read_end();
+                        }
+                    }
                 }
             }
             break;
@@ -220,6 +280,121 @@ void usbdbg_data_in(void *buffer, int length) {
             cmd = USBDBG_NONE;
             break;
         }
+
+        case USBDBG_PROFILE_SIZE: {
+            // Return the number of probes, the record size and the cycle counter frequency.
+            // Zero probes are returned if the profiler is disabled.
+            uint32_t *buf = buffer;
+            #if OMV_PROFILE_ENABLE
+            buf[0] = TRACE_PROF_MAX;
+            buf[1] = sizeof(trace_prof_t);
+            buf[2] = SystemCoreClock;
+            #else
+            buf[0] = buf[1] = buf[2] = 0;
+            #endif
+            cmd = USBDBG_NONE;
+            break;
+        }
+
+        case USBDBG_PROFILE_DUMP:
+            if (xfer_bytes < xfer_length) {
+                memset(buffer, 0, length);
+                #if OMV_PROFILE_ENABLE
+                // Stream the probe records in enum order, zero-padded past the end.
+                int size = TRACE_PROF_MAX * sizeof(trace_prof_t);
+                if (xfer_bytes < size) {
+                    memcpy(buffer, ((uint8_t *) trace_prof_get(0)) + xfer_bytes, IM_MIN(length, size - xfer_bytes));
+                }
+                #endif
+                xfer_bytes += length;
+                if (xfer_bytes == xfer_length) {
+                    cmd = USBDBG_NONE;
+                }
+            }
+            break;
+
+        case USBDBG_TIMELINE_SIZE: {
+            // Stop recording and return the number of events, the record size and the cycle
+            // counter frequency. Zero events are returned if the profiler is disabled.
+            uint32_t *buf = buffer;
+            #if OMV_PROFILE_ENABLE
+            buf[0] = trace_timeline_freeze();
+            buf[1] = sizeof(trace_event_t);
+            buf[2] = SystemCoreClock;
+            #else
+            buf[0] = buf[1] = buf[2] = 0;
+            #endif
+            cmd = USBDBG_NONE;
+            break;
+        }
+
+        case USBDBG_TIMELINE_DUMP:
+            if (xfer_bytes < xfer_length) {
+                memset(buffer, 0, length);
+                #if OMV_PROFILE_ENABLE
+                // Stream the events oldest first, then empty the ring and resume recording.
+                for (int i = 0; i < length; i += sizeof(trace_event_t)) {
+                    uint32_t index = (xfer_bytes + i) / sizeof(trace_event_t);
+                    if (index < TRACE_TIMELINE_SIZE) {
+                        memcpy(((uint8_t *) buffer) + i, trace_timeline_get(index),
+                               IM_MIN((int) sizeof(trace_event_t), length - i));
+                    }
+                }
+                #endif
+                xfer_bytes += length;
+                if (xfer_bytes == xfer_length) {
+                    #if OMV_PROFILE_ENABLE
+                    trace_timeline_reset();
+                    #endif
+                    cmd = USBDBG_NONE;
+                }
+            }
+            break;
+
+        case USBDBG_FB_ALLOC_SIZE: {
+            // Return the fb_alloc high-water mark and the number of live and high-water tags.
+            uint32_t *buf = buffer;
+            buf[0] = fb_alloc_peak();
+            buf[1] = buf[2] = 0;
+            #if OMV_FB_ALLOC_TAGS_ENABLE
+            const fb_alloc_tag_t *tags;
+            buf[1] = fb_alloc_get_tags(&tags, false);
+            buf[2] = fb_alloc_get_tags(&tags, true);
+            #endif
+            cmd = USBDBG_NONE;
+            break;
+        }
+
+        case USBDBG_FB_ALLOC_DUMP:
+            if (xfer_bytes < xfer_length) {
+                memset(buffer, 0, length);
+                #if OMV_FB_ALLOC_TAGS_ENABLE
+                // Stream (tag, size) word pairs for the live tags followed by the high-water tags.
+                const fb_alloc_tag_t *live, *peak;
+                int n_live = fb_alloc_get_tags(&live, false);
+                int n_peak = fb_alloc_get_tags(&peak, true);
+                for (int i = 0; i < length; i += sizeof(uint32_t)) {
+                    int word = (xfer_bytes + i) / sizeof(uint32_t);
+                    int index = word / 2;
+                    const fb_alloc_tag_t *tag = NULL;
+                    if (index < n_live) {
+                        tag = &live[index];
+                    } else if ((index - n_live) < n_peak) {
+                        tag = &peak[index - n_live];
+                    }
+                    if (tag) {
+                        uint32_t value = (word & 1) ? tag->size : ((uint32_t) tag->tag);
+                        memcpy(((uint8_t *) buffer) + i, &value, IM_MIN((int) sizeof(uint32_t), length - i));
+                    }
+                }
+                #endif
+                xfer_bytes += length;
+                if (xfer_bytes == xfer_length) {
+                    cmd = USBDBG_NONE;
+                }
+            }
+            break;
+
         default: /* error */
             break;
     }
@@ -230,15 +405,26 @@ void usbdbg_data_out(void *buffer, int length) {
         case USBDBG_FB_ENABLE: {
             uint32_t enable = *((int32_t *) buffer);
             JPEG_FB()->enabled = enable;
+            JPEG_FB()->delta_valid = 0;
             if (enable == 0) {
-                // When disabling framebuffer, the IDE might still be holding FB lock.
-                // If the IDE is not the current lock owner, this operation is ignored.
-                mutex_unlock(&JPEG_FB()->lock, MUTEX_TID_IDE);
+                // When disabling framebuffer, the IDE might still be holding a frame.
+                frame_slot = NULL;
+                framebuffer_jpeg_read_end();
             }
             cmd = USBDBG_NONE;
             break;
         }
 
+        case USBDBG_FB_DELTA: {
+            // Tile size (16 or 32) of the delta packets, 0 to send whole frames. The next packet
+            // is always a key frame.
+            uint32_t tile = *((uint32_t *) buffer);
+            JPEG_FB()->delta_tile = ((tile == 16) || (tile == 32)) ? tile : 0;
+            JPEG_FB()->delta_valid = 0;
+            cmd = USBDBG_NONE;
+            break;
+        }
+
         case USBDBG_SCRIPT_EXEC:
             // check if GC is locked before allocating memory for vstr. If GC was locked
             // at least once before the script is fully uploaded xfer_bytes will be less
@@ -358,6 +544,8 @@ void usbdbg_control(void *buffer, uint8_t request, uint32_t length) {
     cmd = (enum usbdbg_cmd) request;
     switch (cmd) {
         case USBDBG_FW_VERSION:
+            // The IDE (re)connects, it needs a whole frame even if it's unchanged.
+            JPEG_FB()->delta_valid = 0;
             xfer_bytes = 0;
             xfer_length = length;
             break;
@@ -365,6 +553,7 @@ void usbdbg_control(void *buffer, uint8_t request, uint32_t length) {
         case USBDBG_FRAME_SIZE:
             xfer_bytes = 0;
             xfer_length = length;
+            frame_offset = 0;
             break;
 
         case USBDBG_FRAME_DUMP:
@@ -372,6 +561,11 @@ void usbdbg_control(void *buffer, uint8_t request, uint32_t length) {
             xfer_length = length;
             break;
 
+        case USBDBG_FRAME_STREAM:
+            xfer_bytes = 0;
+            xfer_length = length;
+            break;
+
         case USBDBG_ARCH_STR:
             xfer_bytes = 0;
             xfer_length = length;
@@ -433,7 +627,8 @@ void usbdbg_control(void *buffer, uint8_t request, uint32_t length) {
             break;
         }
 
-        case USBDBG_FB_ENABLE: {
+        case USBDBG_FB_ENABLE:
+        case USBDBG_FB_DELTA: {
             xfer_bytes = 0;
             xfer_length = length;
             break;
@@ -460,6 +655,24 @@ void usbdbg_control(void *buffer, uint8_t request, uint32_t length) {
             xfer_length = length;
             break;
 
+        case USBDBG_PROFILE_SIZE:
+        case USBDBG_PROFILE_DUMP:
+            xfer_bytes = 0;
+            xfer_length = length;
+            break;
+
+        case USBDBG_TIMELINE_SIZE:
+        case USBDBG_TIMELINE_DUMP:
+            xfer_bytes = 0;
+            xfer_length = length;
+            break;
+
+        case USBDBG_FB_ALLOC_SIZE:
+        case USBDBG_FB_ALLOC_DUMP:
+            xfer_bytes = 0;
+            xfer_length = length;
+            break;
+
         default: /* error */
             cmd = USBDBG_NONE;
             break;
@@ -49,6 +49,14 @@ enum usbdbg_cmd {
     USBDBG_SENSOR_ID       =0x90,
     USBDBG_TX_INPUT        =0x11,
     USBDBG_SET_TIME        =0x12,
+    USBDBG_PROFILE_SIZE    =0x93,
+    USBDBG_PROFILE_DUMP    =0x94,
+    USBDBG_FB_ALLOC_SIZE   =0x95,
+    USBDBG_FB_ALLOC_DUMP   =0x96,
+    USBDBG_FB_DELTA        =0x17,
+    USBDBG_FRAME_STREAM    =0x97,
+    USBDBG_TIMELINE_SIZE   =0x98,
+    USBDBG_TIMELINE_DUMP   =0x99,
 };
 
 void usbdbg_init();
@@ -5127,6 +5127,9 @@ struct quad
     // H: tag coordinates ([-1,1] at the black corners) to pixels
     // Hinv: pixels to tag
     matd_t *H, *Hinv;
+
+    // The black border is outside the white border, so this can't be a tag.
+    bool reversed_border;
 };
 
 // Represents a tag family. Every tag belongs to a tag family. Tag
@@ -5148,6 +5151,11 @@ struct apriltag_family
     // minimum hamming distance between any two codes. (e.g. 36h11 => 11)
     uint32_t h;
 
+    // Hash table of the codes in flash (see apriltag_tab.c), 2^hash_bits
+    // slots holding the index of a code or APRILTAG_HASH_EMPTY.
+    const uint16_t *hash;
+    uint32_t hash_bits;
+
     // The codes in the family.
     uint64_t codes[];
 };
@@ -5192,6 +5200,22 @@ struct apriltag_detector
     ///////////////////////////////////////////////////////////////
     // User-configurable parameters.
 
+    // How many tasks should the quad fitting and decoding stages be
+    // split into? (See workerpool_run()).
+    int nthreads;
+
+    // detection of quads can be done on a lower-resolution image,
+    // improving speed at a cost of pose accuracy and a slight
+    // decrease in detection rate. Decoding the binary payload is
+    // still done at full resolution.
+    int quad_decimate;
+
+    // What Gaussian blur should be applied to the segmented image
+    // (used for quad detection?)  Parameter is the standard deviation
+    // in pixels.  Very noisy images benefit from non-zero values
+    // (e.g. 0.8). Negative values sharpen the image instead.
+    float quad_sigma;
+
     // When non-zero, the edges of the each quad are adjusted to "snap
     // to" strong gradients nearby. This is useful when decimation is
     // employed, as it can increase the quality of the initial quad
@@ -5220,6 +5244,11 @@ struct apriltag_detector
 
     struct apriltag_quad_thresh_params qtp;
 
+    // When non-NULL, quads are fitted regardless of the border polarity
+    // and all of them are appended to this array (for find_rects). Only
+    // quads with the tag polarity are decoded.
+    zarray_t *rect_quads;
+
     ///////////////////////////////////////////////////////////////
     // Statistics relating to last processed frame
 
@@ -5322,11 +5351,15 @@ void apriltag_detections_destroy(zarray_t *detections);
 //////// "tag16h5"
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+extern const uint16_t tag16h5_hash[64];
+
 const apriltag_family_t tag16h5 = {
     .ncodes = 30,
     .black_border = 1,
     .d = 4,
     .h = 5,
+    .hash = tag16h5_hash,
+    .hash_bits = 6,
     .codes = {
         0x000000000000231bUL,
         0x0000000000002ea5UL,
@@ -5365,11 +5398,15 @@ const apriltag_family_t tag16h5 = {
 //////// "tag25h7"
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+extern const uint16_t tag25h7_hash[512];
+
 const apriltag_family_t tag25h7 = {
     .ncodes = 242,
     .black_border = 1,
     .d = 5,
     .h = 7,
+    .hash = tag25h7_hash,
+    .hash_bits = 9,
     .codes = {
         0x00000000004b770dUL,
         0x00000000011693e6UL,
@@ -5620,11 +5657,15 @@ const apriltag_family_t tag25h7 = {
 //////// "tag25h9"
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+extern const uint16_t tag25h9_hash[64];
+
 const apriltag_family_t tag25h9 = {
     .ncodes = 35,
     .black_border = 1,
     .d = 5,
     .h = 9,
+    .hash = tag25h9_hash,
+    .hash_bits = 6,
     .codes = {
         0x000000000155cbf1UL,
         0x0000000001e4d1b6UL,
@@ -5668,11 +5709,15 @@ const apriltag_family_t tag25h9 = {
 //////// "tag36h10"
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+extern const uint16_t tag36h10_hash[4096];
+
 const apriltag_family_t tag36h10 = {
     .ncodes = 2320,
     .black_border = 1,
     .d = 6,
     .h = 10,
+    .hash = tag36h10_hash,
+    .hash_bits = 12,
     .codes = {
         0x00000001ca92a687UL,
         0x000000020521ac4cUL,
@@ -8002,11 +8047,15 @@ const apriltag_family_t tag36h10 = {
 //////// "tag36h11"
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+extern const uint16_t tag36h11_hash[1024];
+
 const apriltag_family_t tag36h11 = {
     .ncodes = 587,
     .black_border = 1,
     .d = 6,
     .h = 11,
+    .hash = tag36h11_hash,
+    .hash_bits = 10,
     .codes = {
         0x0000000d5d628584UL,
         0x0000000d97f18b49UL,
@@ -8602,11 +8651,15 @@ const apriltag_family_t tag36h11 = {
 //////// "artoolkit"
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+extern const uint16_t artoolkit_hash[1024];
+
 const apriltag_family_t artoolkit = {
     .ncodes = 512,
     .black_border = 1,
     .d = 6,
     .h = 7,
+    .hash = artoolkit_hash,
+    .hash_bits = 10,
     .codes = {
         0x0006dc269c27UL,
         0x0006d4229e26UL,
@@ -9218,6 +9271,59 @@ static inline uint32_t unionfind_connect(unionfind_t *uf, uint32_t aid, uint32_t
 //////// "union_find.c"
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////// "workerpool.h"
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The upstream detector runs the quad fitting and decoding stages on a pthread pool. Here
+// tasks are queued and then run in order on the calling core by workerpool_run(). Each task
+// only writes to its own outputs, which are merged in task order afterwards, so the results
+// don't depend on how (or where) the tasks are run. Note that the umm heap is not reentrant,
+// a port that runs tasks in parallel must give each core its own heap.
+#define WORKERPOOL_MAX_TASKS (8)
+
+typedef struct workerpool
+{
+    int ntasks;
+    void (*f[WORKERPOOL_MAX_TASKS])(void *p);
+    void *p[WORKERPOOL_MAX_TASKS];
+} workerpool_t;
+
+static void workerpool_init(workerpool_t *wp)
+{
+    wp->ntasks = 0;
+}
+
+static void workerpool_run(workerpool_t *wp)
+{
+    for (int i = 0; i < wp->ntasks; i++) {
+        wp->f[i](wp->p[i]);
+    }
+
+    wp->ntasks = 0;
+}
+
+static void workerpool_add_task(workerpool_t *wp, void (*f)(void *p), void *p)
+{
+    if (wp->ntasks == WORKERPOOL_MAX_TASKS) {
+        workerpool_run(wp);
+    }
+
+    wp->f[wp->ntasks] = f;
+    wp->p[wp->ntasks] = p;
+    wp->ntasks++;
+}
+
+// Number of tasks to split n work items into.
+static int workerpool_ntasks(apriltag_detector_t *td, int n)
+{
+    return IM_MAX(IM_MIN(IM_MIN(td->nthreads, WORKERPOOL_MAX_TASKS), n), 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////// "workerpool.c"
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////// "apriltag_quad_thresh.c"
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -9782,7 +9888,8 @@ int fit_quad(apriltag_detector_t *td, image_u8_t *im, zarray_t *cluster, struct
     }
 
     // Ensure that the black border is inside the white border.
-    if ((!overrideMode) && (dot < 0))
+    quad->reversed_border = dot < 0;
+    if ((!overrideMode) && quad->reversed_border)
         return 0;
 
     // we now sort the points according to theta. This is a preparatory
@@ -10583,6 +10690,51 @@ image_u8_t *threshold(apriltag_detector_t *td, image_u8_t *im)
     return threshim;
 }
 
+struct quad_task
+{
+    apriltag_detector_t *td;
+    image_u8_t *im;
+    zarray_t *clusters;
+    int cidx0, cidx1; // [cidx0, cidx1)
+    zarray_t *quads;
+    bool overrideMode;
+};
+
+static void do_quad_task(void *p)
+{
+    struct quad_task *task = (struct quad_task*) p;
+    apriltag_detector_t *td = task->td;
+    image_u8_t *im = task->im;
+    int w = im->width, h = im->height;
+
+    for (int i = task->cidx0; i < task->cidx1; i++) {
+
+        zarray_t *cluster;
+        zarray_get(task->clusters, i, &cluster);
+
+        if (zarray_size(cluster) < td->qtp.min_cluster_pixels)
+            continue;
+
+        // a cluster should contain only boundary points around the
+        // tag. it cannot be bigger than the whole screen. (Reject
+        // large connected blobs that will be prohibitively slow to
+        // fit quads to.) A typical point along an edge is added three
+        // times (because it has 3 neighbors). The maximum perimeter
+        // is 2w+2h.
+        if (zarray_size(cluster) > 3*(2*w+2*h)) {
+            continue;
+        }
+
+        struct quad quad;
+        memset(&quad, 0, sizeof(struct quad));
+
+        if (fit_quad(td, im, cluster, &quad, task->overrideMode)) {
+
+            zarray_add_fail_ok(task->quads, &quad);
+        }
+    }
+}
+
 zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im, bool overrideMode)
 {
     ////////////////////////////////////////////////////////
@@ -10732,31 +10884,40 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im, bool ove
     zarray_t *quads = zarray_create_fail_ok(sizeof(struct quad));
 
     if (quads) {
-        for (int i = 0; i < sz; i++) {
+        workerpool_t wp;
+        workerpool_init(&wp);
 
-            zarray_t *cluster;
-            zarray_get(clusters, i, &cluster);
+        struct quad_task tasks[WORKERPOOL_MAX_TASKS];
+        int ntasks = workerpool_ntasks(td, sz);
+        int chunksize = (sz + ntasks - 1) / ntasks;
 
-            if (zarray_size(cluster) < td->qtp.min_cluster_pixels)
-                continue;
+        for (int i = 0; i < ntasks; i++) {
+            tasks[i].td = td;
+            tasks[i].im = im;
+            tasks[i].clusters = clusters;
+            tasks[i].cidx0 = IM_MIN(i * chunksize, sz);
+            tasks[i].cidx1 = IM_MIN((i + 1) * chunksize, sz);
+            tasks[i].quads = i ? zarray_create_fail_ok(sizeof(struct quad)) : quads;
+            tasks[i].overrideMode = overrideMode;
 
-            // a cluster should contain only boundary points around the
-            // tag. it cannot be bigger than the whole screen. (Reject
-            // large connected blobs that will be prohibitively slow to
-            // fit quads to.) A typical point along an edge is added three
-            // times (because it has 3 neighbors). The maximum perimeter
-            // is 2w+2h.
-            if (zarray_size(cluster) > 3*(2*w+2*h)) {
-                continue;
-            }
+            if (tasks[i].quads)
+                workerpool_add_task(&wp, do_quad_task, &tasks[i]);
+        }
 
-            struct quad quad;
-            memset(&quad, 0, sizeof(struct quad));
+        workerpool_run(&wp);
 
-            if (fit_quad(td, im, cluster, &quad, overrideMode)) {
+        // merge the per-task quads in order.
+        for (int i = 1; i < ntasks; i++) {
+            if (!tasks[i].quads)
+                continue;
 
-                zarray_add_fail_ok(quads, &quad);
+            for (int j = 0; j < zarray_size(tasks[i].quads); j++) {
+                struct quad *quad;
+                zarray_get_volatile(tasks[i].quads, j, &quad);
+                zarray_add_fail_ok(quads, quad);
             }
+
+            zarray_destroy(tasks[i].quads);
         }
     }
 
@@ -10983,12 +11144,71 @@ int popcount64c(uint64_t x)
     return (x * h01) >> 56;  //returns left 8 bits of x + (x<<8) + (x<<16) + (x<<24) + ...
 }
 
+#define APRILTAG_HASH_MULT  0x9E3779B97F4A7C15ULL
+#define APRILTAG_HASH_EMPTY 0xFFFF
+
+// returns the index of code in the family or -1 (see gen_apriltag_tab.py).
+static int quick_decode_lookup(apriltag_family_t *tf, uint64_t code)
+{
+    uint32_t mask = (1 << tf->hash_bits) - 1;
+
+    for (uint32_t i = (code * APRILTAG_HASH_MULT) >> (64 - tf->hash_bits); ; i = (i + 1) & mask) {
+        uint16_t id = tf->hash[i];
+
+        if (id == APRILTAG_HASH_EMPTY) {
+            return -1;
+        }
+
+        if (tf->codes[id] == code) {
+            return id;
+        }
+    }
+}
+
+// Codes are at least h bits apart in all rotations, so a code read with at
+// most one bit error (and no more than threshold) is the only match for any
+// rotation and the search below would return it. These are looked up in the
+// hash table instead of compared with every code.
+static bool quick_decode_codeword_hash(apriltag_family_t *tf, uint64_t rcode,
+                                       struct quick_decode_entry *entry, int threshold)
+{
+    int nbits = (threshold > 0) ? (tf->d * tf->d) : 0;
+    uint64_t rcodes[4];
+
+    for (int ridx = 0; ridx < 4; ridx++) {
+        rcodes[ridx] = rcode;
+        rcode = rotate90(rcode, tf->d);
+    }
+
+    // b = -1 looks up the codes as read, then with each bit flipped.
+    for (int b = -1; b < nbits; b++) {
+        for (int ridx = 0; ridx < 4; ridx++) {
+            int id = quick_decode_lookup(tf, (b < 0) ? rcodes[ridx] : (rcodes[ridx] ^ (1ULL << b)));
+            if (id >= 0) {
+                entry->rcode = rcodes[ridx];
+                entry->id = id;
+                entry->hamming = (b >= 0);
+                entry->rotation = ridx;
+                entry->hmirror = false;
+                entry->vflip = false;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 // returns an entry with hamming set to 255 if no decode was found.
 static void quick_decode_codeword(apriltag_family_t *tf, uint64_t rcode,
                                   struct quick_decode_entry *entry)
 {
     int threshold = imax(tf->h - tf->d - 1, 0);
 
+    if (quick_decode_codeword_hash(tf, rcode, entry, threshold)) {
+        return;
+    }
+
     for (int ridx = 0; ridx < 4; ridx++) {
 
         for (int i = 0, j = tf->ncodes; i < j; i++) {
@@ -11112,6 +11332,10 @@ apriltag_detector_t *apriltag_detector_create()
 
     td->tag_families = zarray_create(sizeof(apriltag_family_t*));
 
+    td->nthreads = 1;
+    td->quad_decimate = 1;
+    td->quad_sigma = 0.0;
+
     td->refine_edges = 1;
     td->refine_pose = 0;
     td->refine_decode = 0;
@@ -11703,145 +11927,297 @@ int prefer_smaller(int pref, float q0, float q1)
     return 0;
 }
 
-zarray_t *apriltag_detector_detect(apriltag_detector_t *td, image_u8_t *im_orig)
+struct quad_decode_task
 {
-    if (zarray_size(td->tag_families) == 0) {
-        zarray_t *s = zarray_create(sizeof(apriltag_detection_t*));
-        printf("apriltag.c: No tag families enabled.");
-        return s;
-    }
+    int i0, i1; // [i0, i1)
+    zarray_t *quads;
+    apriltag_detector_t *td;
 
-    ///////////////////////////////////////////////////////////
-    // Step 1. Detect quads according to requested image decimation
-    // and blurring parameters.
+    image_u8_t *im;
+    zarray_t *detections;
+};
 
-//    zarray_t *quads = apriltag_quad_gradient(td, im_orig);
-    zarray_t *quads = apriltag_quad_thresh(td, im_orig, false);
+static void quad_decode_task(void *_u)
+{
+    struct quad_decode_task *task = (struct quad_decode_task*) _u;
+    apriltag_detector_t *td = task->td;
+    image_u8_t *im_orig = task->im;
 
-    zarray_t *detections = zarray_create(sizeof(apriltag_detection_t*));
+    for (int i = task->i0; i < task->i1; i++) {
+        struct quad *quad_original;
+        zarray_get_volatile(task->quads, i, &quad_original);
 
-    td->nquads = zarray_size(quads);
+        // refine edges is not dependent upon the tag family, thus
+        // apply this optimization BEFORE the other work.
+        //if (td->quad_decimate > 1 && td->refine_edges) {
+        if (td->refine_edges) {
+            refine_edges(td, im_orig, quad_original);
+        }
 
-    ////////////////////////////////////////////////////////////////
-    // Step 2. Decode tags from each quad.
-    if (1) {
-        for (int i = 0; i < zarray_size(quads); i++) {
-            struct quad *quad_original;
-            zarray_get_volatile(quads, i, &quad_original);
+        // make sure the homographies are computed...
+        if (quad_update_homographies(quad_original))
+            continue;
 
-            // refine edges is not dependent upon the tag family, thus
-            // apply this optimization BEFORE the other work.
-            //if (td->quad_decimate > 1 && td->refine_edges) {
-            if (td->refine_edges) {
-                refine_edges(td, im_orig, quad_original);
+        for (int famidx = 0; famidx < zarray_size(td->tag_families); famidx++) {
+            apriltag_family_t *family;
+            zarray_get(td->tag_families, famidx, &family);
+
+            float goodness = 0;
+
+            // since the geometry of tag families can vary, start any
+            // optimization process over with the original quad.
+            struct quad *quad = quad_copy(quad_original);
+
+            // improve the quad corner positions by minimizing the
+            // variance within each intra-bit area.
+            if (td->refine_pose) {
+                // NB: We potentially step an integer
+                // number of times in each direction. To make each
+                // sample as useful as possible, the step sizes should
+                // not be integer multiples of each other. (I.e.,
+                // probably don't use 1, 0.5, 0.25, etc.)
+
+                // XXX Tunable
+                float stepsizes[] = { 1, .4, .16, .064 };
+                int nstepsizes = sizeof(stepsizes)/sizeof(float);
+
+                goodness = optimize_quad_generic(family, im_orig, quad, stepsizes, nstepsizes, score_goodness, NULL);
             }
 
-            // make sure the homographies are computed...
-            if (quad_update_homographies(quad_original))
-                continue;
+            if (td->refine_decode) {
+                // this optimizes decodability, but we don't report
+                // that value to the user.  (so discard return value.)
+                // XXX Tunable
+                float stepsizes[] = { .4 };
+                int nstepsizes = sizeof(stepsizes)/sizeof(float);
+
+                optimize_quad_generic(family, im_orig, quad, stepsizes, nstepsizes, score_decodability, NULL);
+            }
 
-            for (int famidx = 0; famidx < zarray_size(td->tag_families); famidx++) {
-                apriltag_family_t *family;
-                zarray_get(td->tag_families, famidx, &family);
+            struct quick_decode_entry entry;
 
-                float goodness = 0;
+            float decision_margin = quad_decode(family, im_orig, quad, &entry, NULL);
 
-                // since the geometry of tag families can vary, start any
-                // optimization process over with the original quad.
-                struct quad *quad = quad_copy(quad_original);
+            if (entry.hamming < 255 && decision_margin >= 0) {
+                apriltag_detection_t *det = calloc(1, sizeof(apriltag_detection_t));
 
-                // improve the quad corner positions by minimizing the
-                // variance within each intra-bit area.
-                if (td->refine_pose) {
-                    // NB: We potentially step an integer
-                    // number of times in each direction. To make each
-                    // sample as useful as possible, the step sizes should
-                    // not be integer multiples of each other. (I.e.,
-                    // probably don't use 1, 0.5, 0.25, etc.)
+                det->family = family;
+                det->id = entry.id;
+                det->hamming = entry.hamming;
+                det->goodness = goodness;
+                det->decision_margin = decision_margin;
 
-                    // XXX Tunable
-                    float stepsizes[] = { 1, .4, .16, .064 };
-                    int nstepsizes = sizeof(stepsizes)/sizeof(float);
+                float theta = -entry.rotation * M_PI / 2.0;
+                float c = cos(theta), s = sin(theta);
 
-                    goodness = optimize_quad_generic(family, im_orig, quad, stepsizes, nstepsizes, score_goodness, NULL);
+                // Fix the rotation of our homography to properly orient the tag
+                matd_t *R = matd_create(3,3);
+                MATD_EL(R, 0, 0) = c;
+                MATD_EL(R, 0, 1) = -s;
+                MATD_EL(R, 1, 0) = s;
+                MATD_EL(R, 1, 1) = c;
+                MATD_EL(R, 2, 2) = 1;
+
+                matd_t *RHMirror = matd_create(3,3);
+                MATD_EL(RHMirror, 0, 0) = entry.hmirror ? -1 : 1;
+                MATD_EL(RHMirror, 1, 1) = 1;
+                MATD_EL(RHMirror, 2, 2) = entry.hmirror ? -1 : 1;
+
+                matd_t *RVFlip = matd_create(3,3);
+                MATD_EL(RVFlip, 0, 0) = 1;
+                MATD_EL(RVFlip, 1, 1) = entry.vflip ? -1 : 1;
+                MATD_EL(RVFlip, 2, 2) = entry.vflip ? -1 : 1;
+
+                det->H = matd_op("M*M*M*M", quad->H, R, RHMirror, RVFlip);
+
+                matd_destroy(R);
+                matd_destroy(RHMirror);
+                matd_destroy(RVFlip);
+
+                homography_project(det->H, 0, 0, &det->c[0], &det->c[1]);
+
+                // [-1, -1], [1, -1], [1, 1], [-1, 1], Desired points
+                // [-1, 1], [1, 1], [1, -1], [-1, -1], FLIP Y
+                // adjust the points in det->p so that they correspond to
+                // counter-clockwise around the quad, starting at -1,-1.
+                for (int i = 0; i < 4; i++) {
+                    int tcx = (i == 1 || i == 2) ? 1 : -1;
+                    int tcy = (i < 2) ? 1 : -1;
+
+                    float p[2];
+
+                    homography_project(det->H, tcx, tcy, &p[0], &p[1]);
+
+                    det->p[i][0] = p[0];
+                    det->p[i][1] = p[1];
                 }
 
-                if (td->refine_decode) {
-                    // this optimizes decodability, but we don't report
-                    // that value to the user.  (so discard return value.)
-                    // XXX Tunable
-                    float stepsizes[] = { .4 };
-                    int nstepsizes = sizeof(stepsizes)/sizeof(float);
+                zarray_add(task->detections, &det);
+            }
+
+            quad_destroy(quad);
+        }
+    }
+}
+
+// Box filters and subsamples src by d into dst (which must be src->width / d by
+// src->height / d).
+static void image_u8_decimate(image_u8_t *dst, const image_u8_t *src, int d)
+{
+    int area = d * d;
+
+    for (int y = 0; y < dst->height; y++) {
+        uint8_t *dst_row = dst->buf + (y * dst->stride);
+
+        for (int x = 0; x < dst->width; x++) {
+            int acc = 0;
 
-                    optimize_quad_generic(family, im_orig, quad, stepsizes, nstepsizes, score_decodability, NULL);
+            for (int j = 0; j < d; j++) {
+                const uint8_t *src_row = src->buf + (((y * d) + j) * src->stride) + (x * d);
+
+                for (int i = 0; i < d; i++) {
+                    acc += src_row[i];
                 }
+            }
 
-                struct quick_decode_entry entry;
+            dst_row[x] = acc / area;
+        }
+    }
+}
 
-                float decision_margin = quad_decode(family, im_orig, quad, &entry, NULL);
+// Gaussian blurs (sigma > 0) or unsharp masks (sigma < 0) the image in place.
+static void image_u8_gaussian(image_u8_t *im, float sigma)
+{
+    float s = fabsf(sigma);
+    int ksize = IM_MIN(IM_MAX(ceilf(s * 2), 1), 4);
+    int n = (ksize * 2) + 1;
+    int *krn = fb_alloc(n * n * sizeof(int), FB_ALLOC_NO_HINT);
+    int m = 0;
 
-                if (entry.hamming < 255 && decision_margin >= 0) {
-                    apriltag_detection_t *det = calloc(1, sizeof(apriltag_detection_t));
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            int r2 = ((i - ksize) * (i - ksize)) + ((j - ksize) * (j - ksize));
+            int k = fast_roundf(256 * expf(-r2 / (2 * s * s)));
+            krn[(i * n) + j] = (sigma < 0) ? -k : k;
+            m += k;
+        }
+    }
 
-                    det->family = family;
-                    det->id = entry.id;
-                    det->hamming = entry.hamming;
-                    det->goodness = goodness;
-                    det->decision_margin = decision_margin;
+    if (sigma < 0) {
+        // 2 * pixel - blurred pixel.
+        krn[(ksize * n) + ksize] += m * 2;
+    }
 
-                    float theta = -entry.rotation * M_PI / 2.0;
-                    float c = cos(theta), s = sin(theta);
+    image_t img;
+    img.w = im->width;
+    img.h = im->height;
+    img.pixfmt = PIXFORMAT_GRAYSCALE;
+    img.data = im->buf;
 
-                    // Fix the rotation of our homography to properly orient the tag
-                    matd_t *R = matd_create(3,3);
-                    MATD_EL(R, 0, 0) = c;
-                    MATD_EL(R, 0, 1) = -s;
-                    MATD_EL(R, 1, 0) = s;
-                    MATD_EL(R, 1, 1) = c;
-                    MATD_EL(R, 2, 2) = 1;
+    imlib_morph(&img, ksize, krn, 1.0f / m, 0.0f, false, 0, false, NULL);
+    fb_free(); // krn
+}
 
-                    matd_t *RHMirror = matd_create(3,3);
-                    MATD_EL(RHMirror, 0, 0) = entry.hmirror ? -1 : 1;
-                    MATD_EL(RHMirror, 1, 1) = 1;
-                    MATD_EL(RHMirror, 2, 2) = entry.hmirror ? -1 : 1;
+zarray_t *apriltag_detector_detect(apriltag_detector_t *td, image_u8_t *im_orig)
+{
+    if (zarray_size(td->tag_families) == 0) {
+        zarray_t *s = zarray_create(sizeof(apriltag_detection_t*));
+        printf("apriltag.c: No tag families enabled.");
+        return s;
+    }
 
-                    matd_t *RVFlip = matd_create(3,3);
-                    MATD_EL(RVFlip, 0, 0) = 1;
-                    MATD_EL(RVFlip, 1, 1) = entry.vflip ? -1 : 1;
-                    MATD_EL(RVFlip, 2, 2) = entry.vflip ? -1 : 1;
+    ///////////////////////////////////////////////////////////
+    // Step 1. Detect quads according to requested image decimation
+    // and blurring parameters.
 
-                    det->H = matd_op("M*M*M*M", quad->H, R, RHMirror, RVFlip);
+    image_u8_t quad_im_s, *quad_im = im_orig;
 
-                    matd_destroy(R);
-                    matd_destroy(RHMirror);
-                    matd_destroy(RVFlip);
+    if ((td->quad_decimate > 1) || (td->quad_sigma != 0)) {
+        int d = IM_MAX(td->quad_decimate, 1);
+        quad_im_s.width = im_orig->width / d;
+        quad_im_s.height = im_orig->height / d;
+        quad_im_s.stride = quad_im_s.width;
+        quad_im_s.buf = fb_alloc(quad_im_s.width * quad_im_s.height, FB_ALLOC_NO_HINT);
+        quad_im = &quad_im_s;
 
-                    homography_project(det->H, 0, 0, &det->c[0], &det->c[1]);
+        // the original image is still needed at full resolution (and
+        // unfiltered) for refine_edges and decoding.
+        image_u8_decimate(quad_im, im_orig, d);
 
-                    // [-1, -1], [1, -1], [1, 1], [-1, 1], Desired points
-                    // [-1, 1], [1, 1], [1, -1], [-1, -1], FLIP Y
-                    // adjust the points in det->p so that they correspond to
-                    // counter-clockwise around the quad, starting at -1,-1.
-                    for (int i = 0; i < 4; i++) {
-                        int tcx = (i == 1 || i == 2) ? 1 : -1;
-                        int tcy = (i < 2) ? 1 : -1;
+        if (td->quad_sigma != 0) {
+            image_u8_gaussian(quad_im, td->quad_sigma);
+        }
+    }
 
-                        float p[2];
+//    zarray_t *quads = apriltag_quad_gradient(td, im_orig);
+    zarray_t *quads = apriltag_quad_thresh(td, quad_im, td->rect_quads != NULL);
 
-                        homography_project(det->H, tcx, tcy, &p[0], &p[1]);
+    if (quad_im != im_orig) {
+        fb_free(); // quad_im_s.buf
 
-                        det->p[i][0] = p[0];
-                        det->p[i][1] = p[1];
-                    }
+        // adjust the quad corners so that they correspond to the
+        // center of the decimated blocks in the full resolution image.
+        if (td->quad_decimate > 1) {
+            for (int i = 0; i < zarray_size(quads); i++) {
+                struct quad *q;
+                zarray_get_volatile(quads, i, &q);
 
-                    zarray_add(detections, &det);
+                for (int j = 0; j < 4; j++) {
+                    q->p[j][0] = (q->p[j][0] * td->quad_decimate) + ((td->quad_decimate - 1) * 0.5f);
+                    q->p[j][1] = (q->p[j][1] * td->quad_decimate) + ((td->quad_decimate - 1) * 0.5f);
                 }
+            }
+        }
+    }
+
+    if (td->rect_quads) {
+        zarray_add_all(td->rect_quads, quads);
+
+        for (int i = 0; i < zarray_size(quads); i++) {
+            struct quad *q;
+            zarray_get_volatile(quads, i, &q);
 
-                quad_destroy(quad);
+            if (q->reversed_border) {
+                zarray_remove_index(quads, i, 0);
+                i--; // retry the same index
             }
         }
     }
 
+    zarray_t *detections = zarray_create(sizeof(apriltag_detection_t*));
+
+    td->nquads = zarray_size(quads);
+
+    ////////////////////////////////////////////////////////////////
+    // Step 2. Decode tags from each quad.
+    if (1) {
+        workerpool_t wp;
+        workerpool_init(&wp);
+
+        struct quad_decode_task tasks[WORKERPOOL_MAX_TASKS];
+        int ntasks = workerpool_ntasks(td, zarray_size(quads));
+        int chunksize = (zarray_size(quads) + ntasks - 1) / ntasks;
+
+        for (int i = 0; i < ntasks; i++) {
+            tasks[i].i0 = IM_MIN(i * chunksize, zarray_size(quads));
+            tasks[i].i1 = IM_MIN((i + 1) * chunksize, zarray_size(quads));
+            tasks[i].quads = quads;
+            tasks[i].td = td;
+            tasks[i].im = im_orig;
+            tasks[i].detections = i ? zarray_create(sizeof(apriltag_detection_t*)) : detections;
+
+            workerpool_add_task(&wp, quad_decode_task, &tasks[i]);
+        }
+
+        workerpool_run(&wp);
+
+        // merge the per-task detections in order.
+        for (int i = 1; i < ntasks; i++) {
+            zarray_add_all(detections, tasks[i].detections);
+            zarray_destroy(tasks[i].detections);
+        }
+    }
+
     ////////////////////////////////////////////////////////////////
     // Step 3. Reconcile detections--- don't report the same tag more
     // than once. (Allow non-overlapping duplicate detections.)
@@ -11946,202 +12322,47 @@ void apriltag_detections_destroy(zarray_t *detections)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void imlib_find_apriltags(list_t *out, image_t *ptr, rectangle_t *roi, apriltag_families_t families,
-                          float fx, float fy, float cx, float cy)
+#ifdef IMLIB_ENABLE_FIND_RECTS
+// Refines, de-duplicates and scores the quads found on the grayscale roi (im) of ptr. Destroys detections.
+static void find_rects_from_quads(list_t *out, image_t *ptr, rectangle_t *roi, uint32_t threshold,
+                                  apriltag_detector_t *td, image_u8_t *im, zarray_t *detections)
 {
-    // Frame Buffer Memory Usage...
-    // -> GRAYSCALE Input Image = w*h*1
-    // -> GRAYSCALE Threhsolded Image = w*h*1
-    // -> UnionFind = w*h*2 (+w*h*1 for hash table)
-    size_t resolution = roi->w * roi->h;
-    size_t fb_alloc_need = resolution * (1 + 1 + 2 + 1); // read above...
-    umm_init_x(((fb_avail() - fb_alloc_need) / resolution) * resolution);
-    apriltag_detector_t *td = apriltag_detector_create();
+    td->nquads = zarray_size(detections);
 
-    if (families & TAG16H5) {
-        apriltag_detector_add_family(td, (apriltag_family_t *) &tag16h5);
-    }
+    ////////////////////////////////////////////////////////////////
+    // Decode tags from each quad.
+    if (1) {
+        for (int i = 0; i < zarray_size(detections); i++) {
+            struct quad *quad_original;
+            zarray_get_volatile(detections, i, &quad_original);
 
-    if (families & TAG25H7) {
-        apriltag_detector_add_family(td, (apriltag_family_t *) &tag25h7);
-    }
+            // refine edges is not dependent upon the tag family, thus
+            // apply this optimization BEFORE the other work.
+            //if (td->quad_decimate > 1 && td->refine_edges) {
+            if (td->refine_edges) {
+                refine_edges(td, im, quad_original);
+            }
 
-    if (families & TAG25H9) {
-        apriltag_detector_add_family(td, (apriltag_family_t *) &tag25h9);
+            // make sure the homographies are computed...
+            if (quad_update_homographies(quad_original))
+                continue;
+        }
     }
 
-    if (families & TAG36H10) {
-        apriltag_detector_add_family(td, (apriltag_family_t *) &tag36h10);
-    }
+    ////////////////////////////////////////////////////////////////
+    // Reconcile detections--- don't report the same tag more
+    // than once. (Allow non-overlapping duplicate detections.)
+    if (1) {
+        zarray_t *poly0 = g2d_polygon_create_zeros(4);
+        zarray_t *poly1 = g2d_polygon_create_zeros(4);
 
-    if (families & TAG36H11) {
-        apriltag_detector_add_family(td, (apriltag_family_t *) &tag36h11);
-    }
+        for (int i0 = 0; i0 < zarray_size(detections); i0++) {
 
-    if (families & ARTOOLKIT) {
-        apriltag_detector_add_family(td, (apriltag_family_t *) &artoolkit);
-    }
+            struct quad *det0;
+            zarray_get_volatile(detections, i0, &det0);
 
-    image_t img;
-    img.w = roi->w;
-    img.h = roi->h;
-    img.pixfmt = PIXFORMAT_GRAYSCALE;
-    img.data = fb_alloc(image_size(&img), FB_ALLOC_NO_HINT);
-    imlib_draw_image(&img, ptr, 0, 0, 1.f, 1.f, roi, -1, 256, NULL, NULL, 0, NULL, NULL, NULL);
-
-    image_u8_t im;
-    im.width = roi->w;
-    im.height = roi->h;
-    im.stride = roi->w;
-    im.buf = img.data;
-
-    zarray_t *detections = apriltag_detector_detect(td, &im);
-    list_init(out, sizeof(find_apriltags_list_lnk_data_t));
-
-    for (int i = 0, j = zarray_size(detections); i < j; i++) {
-        apriltag_detection_t *det;
-        zarray_get(detections, i, &det);
-
-        find_apriltags_list_lnk_data_t lnk_data;
-        rectangle_init(&(lnk_data.rect), fast_roundf(det->p[0][0]) + roi->x, fast_roundf(det->p[0][1]) + roi->y, 0, 0);
-
-        for (size_t k = 1, l = (sizeof(det->p) / sizeof(det->p[0])); k < l; k++) {
-            rectangle_t temp;
-            rectangle_init(&temp, fast_roundf(det->p[k][0]) + roi->x, fast_roundf(det->p[k][1]) + roi->y, 0, 0);
-            rectangle_united(&(lnk_data.rect), &temp);
-        }
-
-        // Add corners...
-        lnk_data.corners[0].x = fast_roundf(det->p[3][0]) + roi->x; // top-left
-        lnk_data.corners[0].y = fast_roundf(det->p[3][1]) + roi->y; // top-left
-        lnk_data.corners[1].x = fast_roundf(det->p[2][0]) + roi->x; // top-right
-        lnk_data.corners[1].y = fast_roundf(det->p[2][1]) + roi->y; // top-right
-        lnk_data.corners[2].x = fast_roundf(det->p[1][0]) + roi->x; // bottom-right
-        lnk_data.corners[2].y = fast_roundf(det->p[1][1]) + roi->y; // bottom-right
-        lnk_data.corners[3].x = fast_roundf(det->p[0][0]) + roi->x; // bottom-left
-        lnk_data.corners[3].y = fast_roundf(det->p[0][1]) + roi->y; // bottom-left
-
-        lnk_data.id = det->id;
-        lnk_data.family = 0;
-
-        if(det->family == &tag16h5) {
-            lnk_data.family |= TAG16H5;
-        }
-
-        if(det->family == &tag25h7) {
-            lnk_data.family |= TAG25H7;
-        }
-
-        if(det->family == &tag25h9) {
-            lnk_data.family |= TAG25H9;
-        }
-
-        if(det->family == &tag36h10) {
-            lnk_data.family |= TAG36H10;
-        }
-
-        if(det->family == &tag36h11) {
-            lnk_data.family |= TAG36H11;
-        }
-
-        if(det->family == &artoolkit) {
-            lnk_data.family |= ARTOOLKIT;
-        }
-
-        lnk_data.hamming = det->hamming;
-        lnk_data.centroid_x = det->c[0] + roi->x;
-        lnk_data.centroid_y = det->c[1] + roi->y;
-        lnk_data.goodness = det->goodness / 255.0; // scale to [0:1]
-        lnk_data.decision_margin = det->decision_margin / 255.0; // scale to [0:1]
-
-        matd_t *pose = homography_to_pose(det->H, -fx, fy, cx, cy);
-
-        lnk_data.x_translation = MATD_EL(pose, 0, 3);
-        lnk_data.y_translation = MATD_EL(pose, 1, 3);
-        lnk_data.z_translation = MATD_EL(pose, 2, 3);
-        lnk_data.x_rotation = fast_atan2f(MATD_EL(pose, 2, 1), MATD_EL(pose, 2, 2));
-        lnk_data.y_rotation = fast_atan2f(-MATD_EL(pose, 2, 0), fast_sqrtf(sq(MATD_EL(pose, 2, 1)) + sq(MATD_EL(pose, 2, 2))));
-        lnk_data.z_rotation = fast_atan2f(MATD_EL(pose, 1, 0), MATD_EL(pose, 0, 0));
-
-        matd_destroy(pose);
-
-        list_push_back(out, &lnk_data);
-    }
-
-    apriltag_detections_destroy(detections);
-    fb_free(); // grayscale_image;
-    apriltag_detector_destroy(td);
-    fb_free(); // umm_init_x();
-}
-
-#ifdef IMLIB_ENABLE_FIND_RECTS
-void imlib_find_rects(list_t *out, image_t *ptr, rectangle_t *roi, uint32_t threshold)
-{
-    // Frame Buffer Memory Usage...
-    // -> GRAYSCALE Input Image = w*h*1
-    // -> GRAYSCALE Threhsolded Image = w*h*1
-    // -> UnionFind = w*h*2 (+w*h*1 for hash table)
-    size_t resolution = roi->w * roi->h;
-    size_t fb_alloc_need = resolution * (1 + 1 + 2 + 2); // read above...
-    umm_init_x(((fb_avail() - fb_alloc_need) / resolution) * resolution);
-    apriltag_detector_t *td = apriltag_detector_create();
-
-    image_t img;
-    img.w = roi->w;
-    img.h = roi->h;
-    img.pixfmt = PIXFORMAT_GRAYSCALE;
-    img.data = fb_alloc(image_size(&img), FB_ALLOC_NO_HINT);
-    imlib_draw_image(&img, ptr, 0, 0, 1.f, 1.f, roi, -1, 256, NULL, NULL, 0, NULL, NULL, NULL);
-
-    image_u8_t im;
-    im.width = roi->w;
-    im.height = roi->h;
-    im.stride = roi->w;
-    im.buf = img.data;
-
-    ///////////////////////////////////////////////////////////
-    // Detect quads according to requested image decimation
-    // and blurring parameters.
-
-//    zarray_t *detections = apriltag_quad_gradient(td, &im, true);
-    zarray_t *detections = apriltag_quad_thresh(td, &im, true);
-
-    td->nquads = zarray_size(detections);
-
-    ////////////////////////////////////////////////////////////////
-    // Decode tags from each quad.
-    if (1) {
-        for (int i = 0; i < zarray_size(detections); i++) {
-            struct quad *quad_original;
-            zarray_get_volatile(detections, i, &quad_original);
-
-            // refine edges is not dependent upon the tag family, thus
-            // apply this optimization BEFORE the other work.
-            //if (td->quad_decimate > 1 && td->refine_edges) {
-            if (td->refine_edges) {
-                refine_edges(td, &im, quad_original);
-            }
-
-            // make sure the homographies are computed...
-            if (quad_update_homographies(quad_original))
-                continue;
-        }
-    }
-
-    ////////////////////////////////////////////////////////////////
-    // Reconcile detections--- don't report the same tag more
-    // than once. (Allow non-overlapping duplicate detections.)
-    if (1) {
-        zarray_t *poly0 = g2d_polygon_create_zeros(4);
-        zarray_t *poly1 = g2d_polygon_create_zeros(4);
-
-        for (int i0 = 0; i0 < zarray_size(detections); i0++) {
-
-            struct quad *det0;
-            zarray_get_volatile(detections, i0, &det0);
-
-            for (int k = 0; k < 4; k++)
-                zarray_set(poly0, k, det0->p[k], NULL);
+            for (int k = 0; k < 4; k++)
+                zarray_set(poly0, k, det0->p[k], NULL);
 
             for (int i1 = i0+1; i1 < zarray_size(detections); i1++) {
 
@@ -12264,28 +12485,256 @@ void imlib_find_rects(list_t *out, image_t *ptr, rectangle_t *roi, uint32_t thre
     fb_free(); // theta_buffer
 
     zarray_destroy(detections);
+}
+#endif //IMLIB_ENABLE_FIND_RECTS
+
+// The pose matrices and their SVD fit in a small heap.
+#define APRILTAG_POSE_HEAP_SIZE    (4096)
+
+// Solves the pose from the scaled homography, the matrices are allocated with umm.
+static void apriltag_solve_pose(find_apriltags_list_lnk_data_t *tag)
+{
+    matd_t *H = matd_create_data(3, 3, tag->pose_h);
+    matd_t *pose = homography_to_pose(H, 1, 1, 0, 0);
+
+    tag->x_translation = MATD_EL(pose, 0, 3);
+    tag->y_translation = MATD_EL(pose, 1, 3);
+    tag->z_translation = MATD_EL(pose, 2, 3);
+    tag->x_rotation = fast_atan2f(MATD_EL(pose, 2, 1), MATD_EL(pose, 2, 2));
+    tag->y_rotation = fast_atan2f(-MATD_EL(pose, 2, 0), fast_sqrtf(sq(MATD_EL(pose, 2, 1)) + sq(MATD_EL(pose, 2, 2))));
+    tag->z_rotation = fast_atan2f(MATD_EL(pose, 1, 0), MATD_EL(pose, 0, 0));
+    tag->has_pose = true;
+
+    matd_destroy(pose);
+    matd_destroy(H);
+}
+
+void imlib_apriltag_pose(find_apriltags_list_lnk_data_t *tag)
+{
+    if (!tag->has_pose) {
+        fb_alloc_mark();
+        umm_init_x(APRILTAG_POSE_HEAP_SIZE);
+        apriltag_solve_pose(tag);
+        umm_deinit();
+        fb_alloc_free_till_mark();
+    }
+}
+
+void imlib_find_apriltags(list_t *out, image_t *ptr, rectangle_t *roi, apriltag_families_t families,
+                          float fx, float fy, float cx, float cy, int decimate, float sigma, bool refine_edges,
+                          bool pose, pool_t *pool, list_t *rects_out, uint32_t rects_threshold)
+{
+    #ifdef IMLIB_ENABLE_FIND_RECTS
+    // The quads of an undecimated and unblurred image are the same ones find_rects() looks for.
+    bool share_quads = rects_out && (decimate == 1) && (sigma == 0);
+    #else
+    bool share_quads = false;
+    #endif
+
+    // Frame Buffer Memory Usage...
+    // -> GRAYSCALE Input Image = w*h*1
+    // -> GRAYSCALE Decimated/Filtered Image = (w/d)*(h/d)*1 (+morph line buffers)
+    // -> GRAYSCALE Threhsolded Image = (w/d)*(h/d)*1
+    // -> UnionFind = (w/d)*(h/d)*2 (+(w/d)*(h/d)*1 for hash table)
+    size_t resolution = roi->w * roi->h;
+    size_t quad_resolution = (roi->w / decimate) * (roi->h / decimate);
+    size_t fb_alloc_need = resolution + (quad_resolution * (1 + 1 + 2 + 1)); // read above...
+    if ((decimate > 1) || (sigma != 0)) {
+        fb_alloc_need += quad_resolution + ((roi->w / decimate) * 10) + 1024;
+    }
+    umm_init_x(((fb_avail() - fb_alloc_need) / resolution) * resolution);
+    apriltag_detector_t *td = apriltag_detector_create();
+    td->quad_decimate = decimate;
+    td->quad_sigma = sigma;
+    td->refine_edges = refine_edges;
+
+    if (families & TAG16H5) {
+        apriltag_detector_add_family(td, (apriltag_family_t *) &tag16h5);
+    }
+
+    if (families & TAG25H7) {
+        apriltag_detector_add_family(td, (apriltag_family_t *) &tag25h7);
+    }
+
+    if (families & TAG25H9) {
+        apriltag_detector_add_family(td, (apriltag_family_t *) &tag25h9);
+    }
+
+    if (families & TAG36H10) {
+        apriltag_detector_add_family(td, (apriltag_family_t *) &tag36h10);
+    }
+
+    if (families & TAG36H11) {
+        apriltag_detector_add_family(td, (apriltag_family_t *) &tag36h11);
+    }
+
+    if (families & ARTOOLKIT) {
+        apriltag_detector_add_family(td, (apriltag_family_t *) &artoolkit);
+    }
+
+    image_t img;
+    img.w = roi->w;
+    img.h = roi->h;
+    img.pixfmt = PIXFORMAT_GRAYSCALE;
+    img.data = fb_alloc(image_size(&img), FB_ALLOC_NO_HINT);
+    imlib_draw_image(&img, ptr, 0, 0, 1.f, 1.f, roi, -1, 256, NULL, NULL, 0, NULL, NULL, NULL);
+
+    image_u8_t im;
+    im.width = roi->w;
+    im.height = roi->h;
+    im.stride = roi->w;
+    im.buf = img.data;
+
+    if (share_quads) {
+        td->rect_quads = zarray_create(sizeof(struct quad));
+    }
+
+    zarray_t *detections = apriltag_detector_detect(td, &im);
+    list_init_pool(out, sizeof(find_apriltags_list_lnk_data_t), pool);
+
+    for (int i = 0, j = zarray_size(detections); i < j; i++) {
+        apriltag_detection_t *det;
+        zarray_get(detections, i, &det);
+
+        find_apriltags_list_lnk_data_t lnk_data;
+        rectangle_init(&(lnk_data.rect), fast_roundf(det->p[0][0]) + roi->x, fast_roundf(det->p[0][1]) + roi->y, 0, 0);
+
+        for (size_t k = 1, l = (sizeof(det->p) / sizeof(det->p[0])); k < l; k++) {
+            rectangle_t temp;
+            rectangle_init(&temp, fast_roundf(det->p[k][0]) + roi->x, fast_roundf(det->p[k][1]) + roi->y, 0, 0);
+            rectangle_united(&(lnk_data.rect), &temp);
+        }
+
+        // Add corners...
+        lnk_data.corners[0].x = fast_roundf(det->p[3][0]) + roi->x; // top-left
+        lnk_data.corners[0].y = fast_roundf(det->p[3][1]) + roi->y; // top-left
+        lnk_data.corners[1].x = fast_roundf(det->p[2][0]) + roi->x; // top-right
+        lnk_data.corners[1].y = fast_roundf(det->p[2][1]) + roi->y; // top-right
+        lnk_data.corners[2].x = fast_roundf(det->p[1][0]) + roi->x; // bottom-right
+        lnk_data.corners[2].y = fast_roundf(det->p[1][1]) + roi->y; // bottom-right
+        lnk_data.corners[3].x = fast_roundf(det->p[0][0]) + roi->x; // bottom-left
+        lnk_data.corners[3].y = fast_roundf(det->p[0][1]) + roi->y; // bottom-left
+
+        lnk_data.id = det->id;
+        lnk_data.family = 0;
+
+        if(det->family == &tag16h5) {
+            lnk_data.family |= TAG16H5;
+        }
+
+        if(det->family == &tag25h7) {
+            lnk_data.family |= TAG25H7;
+        }
+
+        if(det->family == &tag25h9) {
+            lnk_data.family |= TAG25H9;
+        }
+
+        if(det->family == &tag36h10) {
+            lnk_data.family |= TAG36H10;
+        }
+
+        if(det->family == &tag36h11) {
+            lnk_data.family |= TAG36H11;
+        }
+
+        if(det->family == &artoolkit) {
+            lnk_data.family |= ARTOOLKIT;
+        }
+
+        lnk_data.hamming = det->hamming;
+        lnk_data.centroid_x = det->c[0] + roi->x;
+        lnk_data.centroid_y = det->c[1] + roi->y;
+        lnk_data.goodness = det->goodness / 255.0; // scale to [0:1]
+        lnk_data.decision_margin = det->decision_margin / 255.0; // scale to [0:1]
+
+        // Folds the camera matrix into the homography, homography_to_pose(H, -fx, fy, cx, cy)
+        // is homography_to_pose(pose_h, 1, 1, 0, 0).
+        for (int k = 0; k < 3; k++) {
+            float h2 = MATD_EL(det->H, 2, k);
+            lnk_data.pose_h[k] = (MATD_EL(det->H, 0, k) - (cx * h2)) / -fx;
+            lnk_data.pose_h[3 + k] = (MATD_EL(det->H, 1, k) - (cy * h2)) / fy;
+            lnk_data.pose_h[6 + k] = h2;
+        }
+
+        lnk_data.has_pose = false;
+
+        if (pose) {
+            apriltag_solve_pose(&lnk_data);
+        }
+
+        list_push_back(out, &lnk_data);
+    }
+
+    apriltag_detections_destroy(detections);
+
+    #ifdef IMLIB_ENABLE_FIND_RECTS
+    if (share_quads) {
+        td->refine_edges = true;
+        find_rects_from_quads(rects_out, ptr, roi, rects_threshold, td, &im, td->rect_quads);
+        td->rect_quads = NULL;
+    }
+    #endif
+
+    fb_free(); // grayscale_image;
+    apriltag_detector_destroy(td);
+    umm_deinit();
+
+    #ifdef IMLIB_ENABLE_FIND_RECTS
+    if (rects_out && (!share_quads)) {
+        imlib_find_rects(rects_out, ptr, roi, rects_threshold);
+    }
+    #endif
+}
+
+#ifdef IMLIB_ENABLE_FIND_RECTS
+void imlib_find_rects(list_t *out, image_t *ptr, rectangle_t *roi, uint32_t threshold)
+{
+    // Frame Buffer Memory Usage...
+    // -> GRAYSCALE Input Image = w*h*1
+    // -> GRAYSCALE Threhsolded Image = w*h*1
+    // -> UnionFind = w*h*2 (+w*h*1 for hash table)
+    size_t resolution = roi->w * roi->h;
+    size_t fb_alloc_need = resolution * (1 + 1 + 2 + 2); // read above...
+    umm_init_x(((fb_avail() - fb_alloc_need) / resolution) * resolution);
+    apriltag_detector_t *td = apriltag_detector_create();
+
+    image_t img;
+    img.w = roi->w;
+    img.h = roi->h;
+    img.pixfmt = PIXFORMAT_GRAYSCALE;
+    img.data = fb_alloc(image_size(&img), FB_ALLOC_NO_HINT);
+    imlib_draw_image(&img, ptr, 0, 0, 1.f, 1.f, roi, -1, 256, NULL, NULL, 0, NULL, NULL, NULL);
+
+    image_u8_t im;
+    im.width = roi->w;
+    im.height = roi->h;
+    im.stride = roi->w;
+    im.buf = img.data;
+
+    ///////////////////////////////////////////////////////////
+    // Detect quads according to requested image decimation
+    // and blurring parameters.
+
+//    zarray_t *detections = apriltag_quad_gradient(td, &im, true);
+    zarray_t *detections = apriltag_quad_thresh(td, &im, true);
+
+    find_rects_from_quads(out, ptr, roi, threshold, td, &im, detections);
+
     fb_free(); // grayscale_image;
     apriltag_detector_destroy(td);
-    fb_free(); // umm_init_x();
+    umm_deinit();
 }
 #endif //IMLIB_ENABLE_FIND_RECTS
 
 #ifdef IMLIB_ENABLE_ROTATION_CORR
 // http://jepsonsblog.blogspot.com/2012/11/rotation-in-3d-using-opencvs.html
-void imlib_rotation_corr(image_t *img, float x_rotation, float y_rotation, float z_rotation,
-                         float x_translation, float y_translation,
-                         float zoom, float fov, float *corners)
+// Returns the matrix mapping output pixels to source pixels, or NULL if it is singular. The
+// matrices are allocated with umm, which the caller must have initialized.
+static matd_t *rotation_corr_matrix(int w, int h, float x_rotation, float y_rotation, float z_rotation,
+                                    float x_translation, float y_translation,
+                                    float zoom, float fov, float *corners)
 {
-    // Create a tmp copy of the image to pull pixels from.
-    size_t size = image_size(img);
-    void *data = fb_alloc(size, FB_ALLOC_NO_HINT);
-    memcpy(data, img->data, size);
-    memset(img->data, 0, size);
-
-    umm_init_x(fb_avail());
-
-    int w = img->w;
-    int h = img->h;
     float z = (fast_sqrtf((w * w) + (h * h)) / 2) / tanf(fov / 2);
     float z_z = z * zoom;
 
@@ -12375,6 +12824,37 @@ void imlib_rotation_corr(image_t *img, float x_rotation, float y_rotation, float
         zarray_destroy(correspondences);
     }
 
+    matd_destroy(T3);
+    matd_destroy(T2);
+    matd_destroy(T1);
+    matd_destroy(A2);
+    matd_destroy(T);
+    matd_destroy(R);
+    matd_destroy(RZ);
+    matd_destroy(RY);
+    matd_destroy(RX);
+    matd_destroy(A1);
+
+    return T4;
+}
+
+void imlib_rotation_corr(image_t *img, float x_rotation, float y_rotation, float z_rotation,
+                         float x_translation, float y_translation,
+                         float zoom, float fov, float *corners)
+{
+    // Create a tmp copy of the image to pull pixels from.
+    size_t size = image_size(img);
+    void *data = fb_alloc(size, FB_ALLOC_NO_HINT);
+    memcpy(data, img->data, size);
+    memset(img->data, 0, size);
+
+    umm_init_x(fb_avail());
+
+    int w = img->w;
+    int h = img->h;
+    matd_t *T4 = rotation_corr_matrix(w, h, x_rotation, y_rotation, z_rotation,
+                                      x_translation, y_translation, zoom, fov, corners);
+
     if (T4) {
         float T4_00 = MATD_EL(T4, 0, 0), T4_01 = MATD_EL(T4, 0, 1), T4_02 = MATD_EL(T4, 0, 2);
         float T4_10 = MATD_EL(T4, 1, 0), T4_11 = MATD_EL(T4, 1, 1), T4_12 = MATD_EL(T4, 1, 2);
@@ -12520,20 +13000,36 @@ void imlib_rotation_corr(image_t *img, float x_rotation, float y_rotation, float
         matd_destroy(T4);
     }
 
-    matd_destroy(T3);
-    matd_destroy(T2);
-    matd_destroy(T1);
-    matd_destroy(A2);
-    matd_destroy(T);
-    matd_destroy(R);
-    matd_destroy(RZ);
-    matd_destroy(RY);
-    matd_destroy(RX);
-    matd_destroy(A1);
-
-    fb_free(); // umm_init_x();
+    umm_deinit();
 
     fb_free();
 }
+
+#ifdef IMLIB_ENABLE_REMAP
+void imlib_remap_rotation_corr(remap_t *map, float x_rotation, float y_rotation, float z_rotation,
+                               float x_translation, float y_translation,
+                               float zoom, float fov, float *corners)
+{
+    umm_init_x(fb_avail());
+
+    matd_t *T4 = rotation_corr_matrix(map->w, map->h, x_rotation, y_rotation, z_rotation,
+                                      x_translation, y_translation, zoom, fov, corners);
+
+    // A singular transform maps everything outside of the image like imlib_rotation_corr().
+    float T[9] = {0};
+
+    if (T4) {
+        for (int i = 0; i < 9; i++) {
+            T[i] = MATD_EL(T4, i / 3, i % 3);
+        }
+
+        matd_destroy(T4);
+    }
+
+    umm_deinit();
+
+    imlib_remap_homography(map, T);
+}
+#endif //IMLIB_ENABLE_REMAP
 #endif //IMLIB_ENABLE_ROTATION_CORR *INDENT-ON*
 #pragma GCC diagnostic pop
@@ -0,0 +1,867 @@
+#include <stdint.h>
+
+const uint16_t tag16h5_hash[64] = {
+    0xFFFF, 0xFFFF, 0x0010, 0x0008, 0xFFFF, 0xFFFF, 0x0011, 0x0016,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0006, 0x001A, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0000, 0x0003, 0xFFFF, 0xFFFF, 0xFFFF, 0x001D, 0x001C,
+    0xFFFF, 0x000C, 0xFFFF, 0xFFFF, 0xFFFF, 0x0018, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0013, 0xFFFF, 0xFFFF, 0xFFFF, 0x0012,
+    0xFFFF, 0x0005, 0xFFFF, 0xFFFF, 0x0007, 0x000B, 0xFFFF, 0x0014,
+    0x000D, 0x0002, 0x000E, 0x000F, 0x0004, 0x0019, 0x001B, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0009, 0x000A, 0x0001, 0x0015, 0xFFFF, 0x0017
+};
+
+const uint16_t tag25h7_hash[512] = {
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x004E, 0x00C5, 0x0069, 0xFFFF,
+    0xFFFF, 0x0002, 0xFFFF, 0x0011, 0x0020, 0x0007, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x003C, 0x003F, 0x007E, 0xFFFF, 0x0045, 0x0093,
+    0xFFFF, 0xFFFF, 0x0099, 0x00AA, 0x009C, 0xFFFF, 0xFFFF, 0x0004,
+    0xFFFF, 0x0013, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x006D, 0xFFFF,
+    0xFFFF, 0x005C, 0xFFFF, 0xFFFF, 0x0080, 0xFFFF, 0x00B7, 0xFFFF,
+    0xFFFF, 0x0067, 0xFFFF, 0xFFFF, 0xFFFF, 0x000F, 0xFFFF, 0x0014,
+    0xFFFF, 0x0062, 0xFFFF, 0xFFFF, 0xFFFF, 0x00D7, 0x00A6, 0x007C,
+    0x003E, 0x0098, 0x00A8, 0x00BC, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x000E, 0x007A, 0xFFFF, 0x0005, 0x00BF, 0x00D9, 0x0033,
+    0x0058, 0x0064, 0x0090, 0x00B1, 0x00F1, 0x00E7, 0xFFFF, 0x004C,
+    0xFFFF, 0xFFFF, 0x0066, 0x00B8, 0x00BE, 0xFFFF, 0xFFFF, 0x009A,
+    0x0001, 0xFFFF, 0x00BA, 0xFFFF, 0xFFFF, 0xFFFF, 0x00C6, 0x00AE,
+    0x00D4, 0x00D5, 0xFFFF, 0x0079, 0x0040, 0x005E, 0x009E, 0x00DC,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0003, 0x0012,
+    0x001E, 0x002B, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x00E5, 0xFFFF, 0x00EB, 0xFFFF, 0x004A, 0xFFFF, 0xFFFF, 0x004F,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x001D, 0x0025, 0x001F, 0xFFFF, 0xFFFF,
+    0x007B, 0xFFFF, 0x008A, 0x00EC, 0xFFFF, 0xFFFF, 0xFFFF, 0x0087,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0068, 0xFFFF, 0xFFFF, 0xFFFF, 0x00C2,
+    0x000D, 0xFFFF, 0x0010, 0x0030, 0xFFFF, 0xFFFF, 0x003A, 0x00DE,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0041, 0x005D, 0xFFFF, 0x0081,
+    0x00D1, 0xFFFF, 0x00A9, 0xFFFF, 0x0051, 0xFFFF, 0x001C, 0x002A,
+    0x00DB, 0xFFFF, 0xFFFF, 0xFFFF, 0x003B, 0x0097, 0x00A3, 0xFFFF,
+    0x0082, 0xFFFF, 0xFFFF, 0xFFFF, 0x0094, 0x00B6, 0x0075, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0089, 0x006B, 0x0024, 0xFFFF, 0x0036, 0x00AF,
+    0x00A5, 0x00AC, 0xFFFF, 0xFFFF, 0xFFFF, 0x00DD, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x00C0, 0x004D, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00D3,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0063, 0x0037, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0085, 0xFFFF, 0xFFFF, 0xFFFF, 0x0019, 0xFFFF, 0x001B, 0x0000,
+    0x0029, 0x0095, 0x00C3, 0x00E8, 0xFFFF, 0x00D0, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0046, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0027, 0x0072, 0x0073, 0x007D,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00A7,
+    0xFFFF, 0x0071, 0x0078, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x000A,
+    0xFFFF, 0x000B, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0096, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0083, 0x0049,
+    0xFFFF, 0x00A0, 0x0060, 0x00C8, 0x008F, 0x00E6, 0x00CF, 0x00CC,
+    0x002C, 0xFFFF, 0xFFFF, 0x0039, 0x00BD, 0x00EE, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0052,
+    0x00B5, 0xFFFF, 0xFFFF, 0x0018, 0x00B2, 0x000C, 0x001A, 0x002D,
+    0x0035, 0x009B, 0x00E2, 0x006E, 0x0091, 0x0044, 0x00CE, 0x0043,
+    0x005F, 0x00EA, 0xFFFF, 0x004B, 0x008B, 0x0054, 0x0070, 0x00C9,
+    0x0009, 0x00DF, 0x0031, 0x00E0, 0x002E, 0x0032, 0x00A4, 0x00A1,
+    0x00DA, 0x00E1, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x006A,
+    0xFFFF, 0x006F, 0xFFFF, 0xFFFF, 0xFFFF, 0x0016, 0x0086, 0x0023,
+    0x0034, 0xFFFF, 0x002F, 0x009D, 0xFFFF, 0x0038, 0x003D, 0x008E,
+    0xFFFF, 0xFFFF, 0x0047, 0xFFFF, 0xFFFF, 0x0050, 0x00F0, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0015, 0xFFFF, 0xFFFF, 0x00B9, 0xFFFF, 0x00C1,
+    0xFFFF, 0xFFFF, 0x0055, 0x0057, 0x0042, 0x005B, 0x00E9, 0xFFFF,
+    0x0048, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0006, 0x00CD,
+    0x008D, 0xFFFF, 0xFFFF, 0x00B0, 0xFFFF, 0xFFFF, 0x00E3, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00A2, 0x00B4, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x00D8, 0xFFFF, 0x00BB, 0x00AB, 0x00D2, 0x0008, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x00ED, 0x0059, 0x0056, 0xFFFF, 0xFFFF,
+    0x00D6, 0xFFFF, 0x0074, 0xFFFF, 0x00CA, 0xFFFF, 0x0088, 0x00C7,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0021, 0x00B3, 0x0022, 0x0028,
+    0x006C, 0x00EF, 0xFFFF, 0xFFFF, 0x0076, 0x005A, 0x007F, 0xFFFF,
+    0x0092, 0xFFFF, 0xFFFF, 0xFFFF, 0x008C, 0xFFFF, 0x0053, 0xFFFF,
+    0xFFFF, 0x0061, 0x0017, 0xFFFF, 0xFFFF, 0xFFFF, 0x0065, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0077, 0x0084, 0x009F,
+    0x00CB, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00E4,
+    0x0026, 0xFFFF, 0xFFFF, 0x00AD, 0xFFFF, 0x00C4, 0xFFFF, 0xFFFF
+};
+
+const uint16_t tag25h9_hash[64] = {
+    0x000C, 0xFFFF, 0x0008, 0xFFFF, 0x0000, 0x000F, 0x000D, 0x0010,
+    0x0012, 0x0014, 0x001B, 0xFFFF, 0x0017, 0x0020, 0xFFFF, 0x0003,
+    0x0004, 0x000B, 0x001D, 0x001E, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0005, 0xFFFF, 0x0007, 0xFFFF, 0xFFFF, 0x000A, 0x0016, 0xFFFF,
+    0x001C, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0006, 0x0009, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0022, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x000E, 0x001F, 0x0019, 0xFFFF, 0x0018, 0xFFFF, 0x0002,
+    0x0013, 0x001A, 0x0001, 0xFFFF, 0x0015, 0x0011, 0x0021, 0xFFFF
+};
+
+const uint16_t tag36h10_hash[4096] = {
+    0x0018, 0xFFFF, 0xFFFF, 0xFFFF, 0x08C1, 0xFFFF, 0x0617, 0x0880,
+    0xFFFF, 0xFFFF, 0x0867, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x036E, 0x0834, 0xFFFF, 0x0574, 0xFFFF, 0xFFFF, 0x0408, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0869, 0xFFFF, 0x0216, 0x02DD, 0x0783, 0xFFFF,
+    0x025D, 0x05E0, 0xFFFF, 0xFFFF, 0xFFFF, 0x03D9, 0x07C0, 0xFFFF,
+    0x0277, 0x0318, 0x03F5, 0x0414, 0x0537, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0363, 0x073A, 0xFFFF, 0x02BA, 0x052E, 0xFFFF, 0x01BA, 0x0726,
+    0x07D8, 0x0707, 0x0827, 0xFFFF, 0x02CC, 0x063C, 0x07CE, 0x0555,
+    0x0355, 0x0757, 0x029A, 0xFFFF, 0xFFFF, 0x075F, 0x077A, 0x012A,
+    0x038F, 0x0892, 0xFFFF, 0xFFFF, 0x0337, 0x04DD, 0xFFFF, 0xFFFF,
+    0x07AF, 0x03A0, 0x036A, 0x0125, 0x077D, 0xFFFF, 0x043A, 0x06DE,
+    0xFFFF, 0x08C8, 0x049E, 0xFFFF, 0xFFFF, 0x0357, 0x04F1, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x087F, 0x08EC, 0x08A9, 0x04A7, 0x06F2, 0x0616,
+    0xFFFF, 0xFFFF, 0x05B2, 0xFFFF, 0x03BA, 0x0576, 0x0829, 0x03A9,
+    0xFFFF, 0xFFFF, 0x0619, 0x0839, 0x0382, 0x08B5, 0x0252, 0x029D,
+    0x011D, 0x048B, 0x0498, 0xFFFF, 0x0265, 0x01D8, 0x0847, 0x00F4,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x05C3,
+    0xFFFF, 0x04DE, 0x03AD, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0246,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0868, 0x04A0, 0x03F1, 0x05DA,
+    0xFFFF, 0x0376, 0xFFFF, 0x00CE, 0xFFFF, 0xFFFF, 0x0298, 0xFFFF,
+    0x0332, 0x03A1, 0x0715, 0xFFFF, 0x0340, 0x0432, 0xFFFF, 0x00A9,
+    0x02C4, 0x0562, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x074C, 0x0500, 0x0526, 0xFFFF, 0xFFFF, 0x009B,
+    0x0065, 0xFFFF, 0xFFFF, 0xFFFF, 0x024E, 0x0193, 0xFFFF, 0x07FB,
+    0x089A, 0x00BE, 0x009C, 0x001C, 0x030E, 0x068C, 0x02FB, 0x022B,
+    0x060C, 0xFFFF, 0xFFFF, 0x00E1, 0xFFFF, 0x0068, 0x026D, 0x0675,
+    0x0697, 0x00D2, 0x069E, 0x004D, 0x0787, 0x07D1, 0x057F, 0x063D,
+    0x0025, 0x085A, 0xFFFF, 0xFFFF, 0xFFFF, 0x0319, 0x03E9, 0x0495,
+    0x076C, 0xFFFF, 0x00A0, 0x0027, 0x006D, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x02A4, 0x0070, 0x0724, 0x07EC,
+    0x033C, 0x07FA, 0x01CE, 0x0054, 0x0227, 0x063B, 0x06B9, 0xFFFF,
+    0x0391, 0x002D, 0xFFFF, 0x023D, 0x0436, 0x008A, 0xFFFF, 0x01C0,
+    0x01F2, 0xFFFF, 0xFFFF, 0x0033, 0x0549, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0533, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x06D5, 0x0035, 0x0074,
+    0x017B, 0x0480, 0x073F, 0xFFFF, 0xFFFF, 0x0800, 0x0304, 0x06C5,
+    0x085E, 0x03B5, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x038D, 0xFFFF,
+    0x0520, 0xFFFF, 0xFFFF, 0xFFFF, 0x088B, 0x064A, 0xFFFF, 0x080E,
+    0x0606, 0x0612, 0x0653, 0x0338, 0x07DA, 0xFFFF, 0x0164, 0x07AC,
+    0xFFFF, 0xFFFF, 0x0825, 0x0421, 0x04F3, 0x02BF, 0x043C, 0x044D,
+    0x0559, 0x054E, 0x01C2, 0x0736, 0x06B8, 0x074B, 0x0840, 0x0898,
+    0x050F, 0x06A6, 0xFFFF, 0x0165, 0xFFFF, 0x01E4, 0x01DD, 0x04E7,
+    0xFFFF, 0x0409, 0xFFFF, 0xFFFF, 0x05BC, 0xFFFF, 0x0224, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x06E0, 0x03BD, 0x0237, 0x088D, 0x0492, 0x0784,
+    0x050E, 0x070C, 0xFFFF, 0x01E2, 0x01DE, 0xFFFF, 0x0223, 0xFFFF,
+    0xFFFF, 0x03A7, 0x0488, 0x0790, 0x07A5, 0xFFFF, 0x046E, 0x013E,
+    0xFFFF, 0x0397, 0x0502, 0x0738, 0x058D, 0xFFFF, 0xFFFF, 0x034D,
+    0xFFFF, 0xFFFF, 0x0234, 0x0656, 0xFFFF, 0xFFFF, 0x0556, 0x019F,
+    0xFFFF, 0x0327, 0x0618, 0xFFFF, 0x03CA, 0xFFFF, 0x012F, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0818, 0xFFFF, 0xFFFF, 0x04F4, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x03A2, 0x02C2, 0x07CB, 0x0815, 0x086A, 0x0407, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0734, 0xFFFF, 0x038A, 0xFFFF, 0xFFFF, 0x060F,
+    0x0378, 0xFFFF, 0xFFFF, 0xFFFF, 0x0503, 0x05E3, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0538, 0xFFFF, 0x05DD, 0xFFFF, 0x0708,
+    0xFFFF, 0xFFFF, 0x041F, 0x0194, 0x0211, 0x0118, 0x00FB, 0x00C2,
+    0x02AB, 0x0478, 0x0123, 0x0577, 0x072A, 0xFFFF, 0xFFFF, 0x011B,
+    0xFFFF, 0xFFFF, 0x0879, 0xFFFF, 0x06C1, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0614, 0x00C3, 0x0076, 0x0196,
+    0x065A, 0x07C6, 0x0292, 0x035D, 0x081E, 0xFFFF, 0x017C, 0x0602,
+    0xFFFF, 0x0078, 0x022A, 0x07CD, 0xFFFF, 0x0798, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x042C, 0xFFFF, 0x08FB, 0xFFFF, 0x0101, 0xFFFF,
+    0x008F, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x003B,
+    0x0356, 0x00F3, 0x0593, 0x00B4, 0x0003, 0x0256, 0x067B, 0x0718,
+    0x00C8, 0x074E, 0x07E9, 0xFFFF, 0x0604, 0xFFFF, 0xFFFF, 0x0007,
+    0x005D, 0xFFFF, 0x00E8, 0x00A7, 0x003F, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x08D1, 0xFFFF, 0xFFFF, 0x04F9, 0x02EB, 0xFFFF, 0xFFFF,
+    0x0456, 0x0271, 0x042E, 0x0096, 0xFFFF, 0x047B, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x007E, 0x0207, 0x062E, 0x070E, 0x07F5, 0x087B, 0x0350,
+    0x0534, 0x0557, 0x01EE, 0x05F3, 0x0044, 0x07C5, 0x07EF, 0xFFFF,
+    0xFFFF, 0x082A, 0x0013, 0x08C2, 0x0283, 0xFFFF, 0x0386, 0xFFFF,
+    0xFFFF, 0x07CC, 0xFFFF, 0xFFFF, 0x0061, 0xFFFF, 0xFFFF, 0x05CF,
+    0x01B4, 0xFFFF, 0xFFFF, 0x083B, 0x0384, 0x04E8, 0xFFFF, 0xFFFF,
+    0x059F, 0xFFFF, 0x05D4, 0x0812, 0xFFFF, 0xFFFF, 0x04AC, 0x08EA,
+    0xFFFF, 0xFFFF, 0x07B0, 0xFFFF, 0xFFFF, 0x05D1, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x04C9, 0x0163, 0xFFFF, 0xFFFF,
+    0x03FE, 0x0813, 0x064C, 0x0573, 0xFFFF, 0x07F0, 0xFFFF, 0x0335,
+    0x015D, 0xFFFF, 0xFFFF, 0xFFFF, 0x0858, 0x05E5, 0x0284, 0x0799,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x072B, 0xFFFF, 0xFFFF, 0x037F, 0x08B1,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x047A, 0x015E, 0xFFFF,
+    0xFFFF, 0x03C7, 0xFFFF, 0xFFFF, 0xFFFF, 0x04D2, 0xFFFF, 0x0688,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0236, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x054C, 0x02D4, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x06FE, 0xFFFF, 0x0231, 0xFFFF, 0xFFFF, 0x08C6,
+    0x0780, 0xFFFF, 0x031E, 0x01D7, 0x0531, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0278, 0x027D, 0x0584, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0212, 0x02A5, 0xFFFF, 0x0905, 0xFFFF, 0x0663, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x07ED, 0xFFFF, 0xFFFF, 0xFFFF, 0x0652, 0xFFFF,
+    0xFFFF, 0x066A, 0xFFFF, 0xFFFF, 0x0331, 0xFFFF, 0xFFFF, 0x043F,
+    0x070B, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x04FA, 0x0517, 0x032E, 0xFFFF, 0xFFFF, 0x012D,
+    0xFFFF, 0xFFFF, 0x0466, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00DD, 0x022D, 0x04D3,
+    0xFFFF, 0x0711, 0x0411, 0xFFFF, 0x067E, 0xFFFF, 0x020F, 0x06CB,
+    0x036D, 0x0098, 0x07EA, 0x07BE, 0x0470, 0xFFFF, 0xFFFF, 0x0081,
+    0x04CD, 0xFFFF, 0xFFFF, 0x00DF, 0x009A, 0x0063, 0x080C, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x026A, 0x02C3, 0x00F7, 0x032A, 0x0494,
+    0x0654, 0x020E, 0xFFFF, 0xFFFF, 0x02DA, 0x03D2, 0x043E, 0x071F,
+    0x077F, 0xFFFF, 0x02F6, 0x03D6, 0xFFFF, 0x00EC, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0661, 0xFFFF, 0x0352, 0x081D, 0x0020, 0xFFFF, 0x04A8,
+    0xFFFF, 0x00AC, 0x02CD, 0xFFFF, 0x042B, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0462, 0xFFFF, 0x01E9, 0x0086, 0x04AB, 0x0204,
+    0x04FB, 0x0634, 0x0316, 0x0806, 0x08FC, 0xFFFF, 0xFFFF, 0x0087,
+    0x090F, 0xFFFF, 0x08E5, 0xFFFF, 0xFFFF, 0x07AB, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x00D3, 0x01C8, 0xFFFF, 0x04A2, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x002C, 0x0072, 0x017A, 0x04AF, 0x0218, 0x050A, 0xFFFF, 0x07E6,
+    0xFFFF, 0xFFFF, 0x0515, 0x0032, 0x041B, 0x0816, 0x0785, 0x0862,
+    0x0056, 0x0660, 0x04FF, 0x064D, 0x0747, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x04F2, 0x079D, 0xFFFF, 0x03C1, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x05F4, 0xFFFF, 0x0161, 0x049F,
+    0x076E, 0x0529, 0xFFFF, 0xFFFF, 0x061A, 0x0388, 0x07B3, 0x0889,
+    0x08DB, 0x08F6, 0x05A0, 0x040B, 0x06D3, 0xFFFF, 0xFFFF, 0x065C,
+    0x0347, 0x0172, 0x02D8, 0x0477, 0x05C4, 0x0797, 0xFFFF, 0x05E9,
+    0xFFFF, 0x07C4, 0x0158, 0x0233, 0x084F, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x01FF, 0x04A9, 0x0748, 0x07B5, 0x08DE, 0x01FE,
+    0x0303, 0x03AE, 0x0449, 0x0568, 0x0582, 0x0525, 0x0626, 0x065B,
+    0x0716, 0x0253, 0xFFFF, 0x01FA, 0xFFFF, 0xFFFF, 0x0213, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x07DF, 0x0802, 0x029B, 0x070A,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0891, 0xFFFF, 0xFFFF, 0x08D0, 0xFFFF,
+    0xFFFF, 0x0901, 0xFFFF, 0x07D3, 0xFFFF, 0x0137, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x04BA, 0x088E, 0x0150, 0xFFFF,
+    0x08A0, 0x01AF, 0xFFFF, 0x044A, 0xFFFF, 0xFFFF, 0x0595, 0x0524,
+    0x0682, 0xFFFF, 0x0312, 0xFFFF, 0x010E, 0x02DC, 0x03A4, 0x03B9,
+    0x0596, 0x05ED, 0x08A1, 0x0902, 0x051F, 0x05AE, 0xFFFF, 0x02E4,
+    0xFFFF, 0x0144, 0x04B3, 0xFFFF, 0x048A, 0x08E1, 0xFFFF, 0x0877,
+    0xFFFF, 0x0210, 0x03B3, 0xFFFF, 0xFFFF, 0xFFFF, 0x0383, 0x05CA,
+    0x0460, 0x06B6, 0xFFFF, 0xFFFF, 0xFFFF, 0x08F0, 0xFFFF, 0x03DF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x05A6, 0xFFFF, 0xFFFF, 0x02F7, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x018C, 0x0259, 0x026C, 0x026F, 0x0373,
+    0x051A, 0x052D, 0x089B, 0x02F0, 0x08DA, 0xFFFF, 0x05B0, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x08E4, 0xFFFF, 0x0124, 0x0590, 0x0381, 0x0404,
+    0xFFFF, 0x0128, 0x018D, 0x0375, 0x0410, 0xFFFF, 0xFFFF, 0x02A9,
+    0x0713, 0xFFFF, 0xFFFF, 0xFFFF, 0x011C, 0x0108, 0x0706, 0x08A4,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0447, 0x05DF, 0x008E, 0x005B, 0x024C,
+    0x0296, 0x03B8, 0x03FB, 0x06A4, 0x0302, 0xFFFF, 0xFFFF, 0x00B3,
+    0x00D8, 0xFFFF, 0xFFFF, 0x02FE, 0x056C, 0x00A6, 0x0345, 0x07DC,
+    0x0874, 0x00F2, 0x0343, 0x03B0, 0x0002, 0x0184, 0x0394, 0x00C7,
+    0x0527, 0x003D, 0x06BD, 0x06FA, 0x07B8, 0xFFFF, 0x03FC, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x030F, 0x07AD, 0xFFFF, 0x078B, 0x0493, 0x08B7,
+    0x08C7, 0x057D, 0x05B6, 0x0329, 0x03CD, 0xFFFF, 0x007C, 0x07FE,
+    0x07B9, 0xFFFF, 0x00BB, 0x020A, 0x022C, 0x05AC, 0x03B4, 0x00CA,
+    0x0528, 0x0615, 0x046C, 0x0699, 0x0811, 0x0610, 0x08E7, 0x04C7,
+    0x0808, 0x090A, 0x090B, 0xFFFF, 0x0167, 0x042F, 0x04EC, 0x084D,
+    0x04A5, 0x020B, 0x0592, 0xFFFF, 0xFFFF, 0x02A7, 0x0301, 0x0611,
+    0xFFFF, 0x06B3, 0x0268, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0413, 0x07FF, 0xFFFF, 0x04E2, 0xFFFF, 0x043B, 0xFFFF,
+    0x0735, 0xFFFF, 0x0795, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0550, 0xFFFF, 0x001A, 0xFFFF, 0xFFFF, 0x0341, 0xFFFF, 0x01C5,
+    0x07D2, 0xFFFF, 0xFFFF, 0x055A, 0x0581, 0x05CE, 0x066C, 0xFFFF,
+    0xFFFF, 0x0666, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0239, 0x0691,
+    0x0157, 0xFFFF, 0x0247, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x039A,
+    0x0587, 0x0730, 0x0823, 0x0541, 0xFFFF, 0x01DC, 0x025E, 0xFFFF,
+    0xFFFF, 0x06F5, 0x050B, 0xFFFF, 0x01FB, 0xFFFF, 0xFFFF, 0x05C2,
+    0x089D, 0x063E, 0x033E, 0x03C0, 0x0307, 0x0360, 0x0756, 0x03DD,
+    0x08CA, 0xFFFF, 0x03EB, 0x084A, 0xFFFF, 0x08F2, 0xFFFF, 0x03A3,
+    0xFFFF, 0x0324, 0x0741, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0893, 0xFFFF, 0x014D, 0x03D0, 0xFFFF, 0xFFFF, 0x080D, 0xFFFF,
+    0x0570, 0x06C0, 0xFFFF, 0xFFFF, 0x0509, 0x0147, 0xFFFF, 0xFFFF,
+    0x0369, 0xFFFF, 0xFFFF, 0xFFFF, 0x07C3, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0154, 0xFFFF, 0xFFFF, 0x0536,
+    0x01D3, 0xFFFF, 0x048F, 0xFFFF, 0x0133, 0x04C8, 0x0623, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x020D, 0x06F4, 0xFFFF, 0xFFFF, 0x055E,
+    0xFFFF, 0xFFFF, 0x08FD, 0xFFFF, 0xFFFF, 0x04B1, 0x0695, 0x04BB,
+    0x06DA, 0x0792, 0x070D, 0x081C, 0xFFFF, 0xFFFF, 0x03AB, 0x0578,
+    0xFFFF, 0x00F5, 0x0442, 0xFFFF, 0x0134, 0x011F, 0x0403, 0x047C,
+    0x047E, 0x03C3, 0x0264, 0x05AD, 0x03F4, 0x06FB, 0xFFFF, 0x031F,
+    0x03D5, 0x0545, 0x0323, 0x0374, 0x06AE, 0x0127, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00FE, 0x035A, 0x0600, 0x0188,
+    0xFFFF, 0xFFFF, 0x01A5, 0x02A0, 0x0354, 0x05B3, 0xFFFF, 0x0627,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0673, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x00EB, 0xFFFF, 0x0287, 0xFFFF, 0x01F3, 0xFFFF,
+    0xFFFF, 0x0832, 0xFFFF, 0xFFFF, 0x00FF, 0x0760, 0xFFFF, 0x004B,
+    0xFFFF, 0x0851, 0x0342, 0x0289, 0x009D, 0x001F, 0x04CC, 0xFFFF,
+    0x0371, 0x0085, 0xFFFF, 0x08CE, 0xFFFF, 0xFFFF, 0x05D2, 0x006B,
+    0x088C, 0xFFFF, 0x022E, 0xFFFF, 0x06C7, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x009F, 0x046B, 0x0181, 0x0807, 0xFFFF, 0xFFFF, 0x0871,
+    0xFFFF, 0xFFFF, 0x0178, 0x0687, 0x035F, 0x002A, 0x006F, 0x02B7,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x066B, 0x06D2, 0x073D, 0x01CC, 0x0071,
+    0x00A1, 0x076B, 0x0764, 0xFFFF, 0xFFFF, 0x0055, 0x052B, 0x05EB,
+    0xFFFF, 0xFFFF, 0x07DB, 0x0031, 0x08E8, 0xFFFF, 0xFFFF, 0x0899,
+    0x03FD, 0x0249, 0x049A, 0x0471, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x075D, 0x04B2, 0x023E, 0xFFFF, 0x07F8,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0484, 0x01E6, 0x07C1, 0x07DE,
+    0x0810, 0x0828, 0x08B0, 0xFFFF, 0x042A, 0x030D, 0x05D0, 0x04EF,
+    0x027A, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0328, 0x03E8, 0x0820,
+    0x071E, 0xFFFF, 0xFFFF, 0x07BD, 0xFFFF, 0xFFFF, 0xFFFF, 0x01FD,
+    0xFFFF, 0x07A6, 0x045C, 0xFFFF, 0xFFFF, 0x068E, 0x0875, 0xFFFF,
+    0x0882, 0xFFFF, 0xFFFF, 0xFFFF, 0x0644, 0x0365, 0x039C, 0x0768,
+    0xFFFF, 0x0637, 0x0215, 0xFFFF, 0xFFFF, 0x03DA, 0xFFFF, 0x0507,
+    0x03D8, 0x013C, 0x02D6, 0x0704, 0xFFFF, 0x060D, 0x0202, 0xFFFF,
+    0xFFFF, 0x03A8, 0x0906, 0x0143, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x032C, 0xFFFF, 0xFFFF,
+    0x03E0, 0x02A1, 0x04B9, 0xFFFF, 0x03F7, 0x040F, 0xFFFF, 0xFFFF,
+    0x0399, 0x01DF, 0x02B2, 0x0640, 0xFFFF, 0xFFFF, 0xFFFF, 0x0138,
+    0x057B, 0xFFFF, 0x05FB, 0xFFFF, 0xFFFF, 0x06E3, 0x08F1, 0xFFFF,
+    0xFFFF, 0x071B, 0xFFFF, 0xFFFF, 0xFFFF, 0x033A, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0393, 0x03CB, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x010F,
+    0x01AA, 0x0199, 0x02C5, 0x03E4, 0x028B, 0x055C, 0x0380, 0x03A5,
+    0x069A, 0x0263, 0x02D5, 0x06FC, 0x019A, 0x029E, 0x0763, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x03CF, 0x0389, 0x04EA, 0x01F7, 0x02F9, 0x0837,
+    0x0523, 0x08A6, 0x08ED, 0xFFFF, 0xFFFF, 0x0720, 0xFFFF, 0x055D,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x02CB, 0x03E7, 0x04FC,
+    0x07CA, 0xFFFF, 0xFFFF, 0xFFFF, 0x0418, 0x0195, 0x03AA, 0x0712,
+    0x06E6, 0x0372, 0xFFFF, 0xFFFF, 0x0111, 0x017D, 0x08DD, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0351, 0xFFFF, 0xFFFF, 0x06AA, 0xFFFF, 0x02D2,
+    0xFFFF, 0xFFFF, 0x059A, 0xFFFF, 0x04B0, 0x0107, 0x02EF, 0xFFFF,
+    0x0077, 0x05BF, 0xFFFF, 0x00F0, 0x03ED, 0x008D, 0x05A8, 0x0624,
+    0x00FD, 0x04AD, 0x0561, 0x0079, 0x0605, 0x038E, 0x00D7, 0x00B2,
+    0x00F1, 0x0743, 0xFFFF, 0x03C4, 0xFFFF, 0x00A5, 0x030A, 0xFFFF,
+    0x081F, 0xFFFF, 0xFFFF, 0x06A8, 0xFFFF, 0x0269, 0x0607, 0x087D,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x02EA, 0x03E3, 0x0006, 0xFFFF,
+    0x0402, 0x0705, 0x044C, 0x0594, 0x024B, 0x065F, 0xFFFF, 0xFFFF,
+    0x0093, 0x0009, 0xFFFF, 0x06C8, 0x0175, 0x0516, 0x0040, 0x073E,
+    0x0203, 0x078D, 0x00BA, 0x071D, 0x000B, 0x08A2, 0x08BB, 0x08F5,
+    0xFFFF, 0xFFFF, 0x071C, 0xFFFF, 0x01CF, 0x02C0, 0x0208, 0x000F,
+    0x0248, 0x0540, 0x08D9, 0xFFFF, 0x0043, 0x089F, 0x08E3, 0x03C2,
+    0x0586, 0xFFFF, 0x0205, 0x04BD, 0x0819, 0xFFFF, 0xFFFF, 0x068A,
+    0xFFFF, 0x07A2, 0xFFFF, 0x032D, 0x0016, 0x03C9, 0x01BB, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0855, 0x021B, 0xFFFF, 0x08E0, 0xFFFF, 0x0285,
+    0x0441, 0x0543, 0x069C, 0x076A, 0xFFFF, 0x02B3, 0x0680, 0x086C,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x02E7, 0x06CE, 0xFFFF, 0x035B,
+    0x0876, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x055B, 0xFFFF, 0x0759,
+    0xFFFF, 0xFFFF, 0x0731, 0x03A6, 0x074D, 0x053A, 0x01BF, 0x08C0,
+    0xFFFF, 0x061D, 0x0659, 0xFFFF, 0x0744, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x05A5, 0x07F7, 0xFFFF, 0x02BB, 0x034F, 0x0444, 0xFFFF,
+    0xFFFF, 0x01B2, 0x02C6, 0xFFFF, 0x0518, 0x0566, 0x0665, 0x071A,
+    0x036B, 0x079F, 0x0803, 0x08B3, 0xFFFF, 0x0443, 0x01A8, 0xFFFF,
+    0x03EF, 0x05BB, 0x05F1, 0xFFFF, 0x01E0, 0x0385, 0x06E2, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0904, 0xFFFF, 0x024F, 0x02A2, 0x0437, 0x07B7,
+    0x013B, 0xFFFF, 0x01AC, 0x0583, 0x014E, 0x0146, 0x0753, 0xFFFF,
+    0xFFFF, 0x01A6, 0x0425, 0x012B, 0x01DB, 0xFFFF, 0xFFFF, 0x014F,
+    0x025B, 0x01FC, 0x0481, 0x053F, 0x045D, 0x0564, 0xFFFF, 0xFFFF,
+    0x0483, 0xFFFF, 0x059C, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x034C, 0x01A3, 0x0599, 0x02AA, 0xFFFF,
+    0xFFFF, 0x08E2, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0103, 0x08BF,
+    0x08B2, 0xFFFF, 0xFFFF, 0x0297, 0xFFFF, 0xFFFF, 0x0519, 0xFFFF,
+    0xFFFF, 0x032B, 0x00DC, 0xFFFF, 0x0129, 0x010C, 0x040E, 0x0639,
+    0x06A1, 0xFFFF, 0xFFFF, 0x046A, 0xFFFF, 0xFFFF, 0x04AA, 0x0833,
+    0x0717, 0xFFFF, 0x01A1, 0xFFFF, 0xFFFF, 0xFFFF, 0x0306, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0645, 0x07A1, 0x0767, 0xFFFF, 0x0192, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x00BD, 0x040D, 0xFFFF, 0xFFFF, 0x02DE, 0xFFFF,
+    0x00AA, 0x0083, 0x00D1, 0x036C, 0x05F8, 0x0420, 0x060B, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x00EA, 0x0406, 0x004A, 0x0189, 0x0511, 0x05EF,
+    0x0779, 0x0457, 0x067A, 0x06E1, 0x0430, 0x0771, 0xFFFF, 0x08EF,
+    0xFFFF, 0x0106, 0x00E0, 0xFFFF, 0xFFFF, 0x001E, 0xFFFF, 0xFFFF,
+    0x0698, 0xFFFF, 0x04AE, 0x05DB, 0x02C1, 0xFFFF, 0xFFFF, 0x0024,
+    0x0490, 0x08D7, 0x04C0, 0x00AE, 0x0370, 0x07B1, 0x01F4, 0x021A,
+    0x00E2, 0xFFFF, 0x0026, 0x08DC, 0xFFFF, 0x0446, 0x0339, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x06DC, 0x006E, 0x02AE, 0x0260, 0x0291,
+    0x038C, 0x0089, 0x00AF, 0x028F, 0x04E9, 0x0554, 0x0667, 0x08A3,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x00B1, 0x05EC, 0x06E8, 0x047D, 0x07B4,
+    0x07E3, 0x0842, 0x0030, 0x0434, 0xFFFF, 0xFFFF, 0x0569, 0x0769,
+    0x072E, 0x0358, 0x01BC, 0x0809, 0xFFFF, 0x02D9, 0x02E1, 0x05FD,
+    0x051D, 0x008B, 0x053B, 0x088A, 0x0646, 0x07BF, 0x07E0, 0x0075,
+    0x0037, 0x016A, 0x06B7, 0x01EA, 0xFFFF, 0x005A, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x05D6, 0x0613, 0x0038, 0x0452, 0x0684, 0xFFFF, 0x08B4,
+    0xFFFF, 0x048C, 0xFFFF, 0xFFFF, 0xFFFF, 0x0455, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0149, 0x04D1, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x01E1, 0x0589, 0xFFFF, 0xFFFF, 0xFFFF, 0x0650,
+    0x06EF, 0x06FD, 0xFFFF, 0xFFFF, 0x04D0, 0x0678, 0xFFFF, 0x0579,
+    0xFFFF, 0x08CD, 0xFFFF, 0xFFFF, 0x045B, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0214, 0x06AC, 0xFFFF, 0x015C, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x012E, 0x01B0, 0x057E, 0xFFFF,
+    0x0346, 0x07E8, 0x037B, 0x0686, 0xFFFF, 0xFFFF, 0x0890, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x03F9, 0x0486, 0x04FE, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x05E8, 0xFFFF, 0x0155, 0x059E, 0xFFFF, 0xFFFF,
+    0x0222, 0x0433, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0221, 0xFFFF,
+    0x0151, 0x075B, 0x0844, 0x08C9, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x058A, 0x0244, 0x078C, 0x0598, 0x08C5, 0x01D6, 0x0395,
+    0x0423, 0x0320, 0xFFFF, 0x046D, 0xFFFF, 0x05AA, 0x06A7, 0x081B,
+    0x056E, 0x06DB, 0x027F, 0x07C2, 0x087E, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x027E, 0xFFFF, 0x0139, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x069F, 0x0117, 0xFFFF, 0x00E3, 0xFFFF, 0xFFFF, 0x0651, 0xFFFF,
+    0x081A, 0x0243, 0x05B8, 0x083C, 0xFFFF, 0x05C5, 0xFFFF, 0x06CF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x048D, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00D4, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0886, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x00D5, 0xFFFF, 0xFFFF, 0xFFFF, 0x06D7, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x05D9, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x06E9, 0x078E,
+    0x0396, 0x0817, 0x0392, 0xFFFF, 0x04D8, 0x04EE, 0x00D6, 0xFFFF,
+    0x005C, 0x083F, 0xFFFF, 0x00E6, 0x0445, 0x04C5, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0001, 0xFFFF, 0x08FF, 0xFFFF, 0x03D7,
+    0x06EB, 0xFFFF, 0xFFFF, 0xFFFF, 0x00B7, 0x055F, 0x0005, 0x0180,
+    0x0887, 0x08CB, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0288, 0x00B8,
+    0xFFFF, 0x0008, 0x04BE, 0xFFFF, 0xFFFF, 0x007B, 0x02AD, 0x04CE,
+    0x0464, 0x00DB, 0x00B9, 0x005F, 0xFFFF, 0xFFFF, 0xFFFF, 0x0630,
+    0xFFFF, 0x0041, 0x01C3, 0x04BC, 0x05FA, 0x01CA, 0x000E, 0x0539,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0080, 0xFFFF, 0xFFFF, 0xFFFF, 0x016C,
+    0x0174, 0x0012, 0xFFFF, 0x0521, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0671, 0x089E, 0xFFFF, 0x05BD, 0x0238, 0x07C9, 0x03EC, 0x0267,
+    0xFFFF, 0xFFFF, 0x0732, 0xFFFF, 0xFFFF, 0x05F2, 0x0062, 0x0305,
+    0x06F1, 0xFFFF, 0xFFFF, 0x0047, 0xFFFF, 0x07A7, 0x04D6, 0x0628,
+    0xFFFF, 0x0019, 0x072C, 0x07E7, 0x02A8, 0x05A3, 0x06B4, 0x0159,
+    0x06A2, 0x07F3, 0x0439, 0x0853, 0x0865, 0x050D, 0x0485, 0x05FE,
+    0x0255, 0x034B, 0x07D9, 0x08F8, 0xFFFF, 0xFFFF, 0xFFFF, 0x07F9,
+    0xFFFF, 0x03DC, 0x079E, 0x0168, 0xFFFF, 0x082B, 0x085F, 0x086D,
+    0x0721, 0x07A8, 0x03B2, 0xFFFF, 0xFFFF, 0x0669, 0xFFFF, 0xFFFF,
+    0x01E3, 0xFFFF, 0xFFFF, 0x05B5, 0x069D, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0419, 0xFFFF, 0x0451, 0x0467, 0x0670, 0x049D,
+    0x0838, 0xFFFF, 0x0141, 0xFFFF, 0x07D7, 0x015A, 0x0903, 0x07FD,
+    0x08AC, 0xFFFF, 0x0377, 0x0153, 0x0479, 0x01B9, 0x04C6, 0x0560,
+    0x06A3, 0x014C, 0x01B6, 0x0909, 0xFFFF, 0x06C6, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0885, 0xFFFF, 0xFFFF, 0x0631, 0x0435, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0791, 0xFFFF, 0xFFFF, 0x06B2, 0x08F4, 0x0276, 0x0417, 0x05E2,
+    0x0861, 0xFFFF, 0x0148, 0x053D, 0x02A3, 0x085D, 0x067C, 0xFFFF,
+    0xFFFF, 0x07A4, 0x08AF, 0xFFFF, 0x04A6, 0xFFFF, 0x0232, 0x02ED,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x012C, 0xFFFF, 0x06AF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x01A9, 0x021D, 0x033F, 0x03C6, 0x06E5,
+    0x0774, 0xFFFF, 0x0544, 0xFFFF, 0x02FF, 0x08AA, 0x00E9, 0x0322,
+    0x0742, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x076D, 0xFFFF, 0x00CD, 0x028E, 0x04D9, 0x04E6, 0x080B, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0299, 0xFFFF, 0xFFFF, 0xFFFF, 0x0681, 0xFFFF,
+    0x01D4, 0xFFFF, 0xFFFF, 0x0099, 0x0859, 0x010D, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00F6, 0x019E, 0xFFFF, 0x0257,
+    0x01D5, 0x06D8, 0x00AB, 0x0758, 0x0049, 0x04B6, 0x07BB, 0x0864,
+    0x020C, 0x001B, 0x0066, 0x08A7, 0x0176, 0x04F0, 0x05A2, 0x061F,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x03C5, 0x0608, 0x0100, 0x0796,
+    0x07BA, 0x004C, 0x018A, 0x0835, 0x085B, 0xFFFF, 0x006A, 0x0023,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0558, 0x0050, 0x02FA, 0x05A9, 0x0514,
+    0x009E, 0x00C0, 0x045E, 0x0551, 0x07D5, 0x08AB, 0x0333, 0xFFFF,
+    0x0426, 0x02BC, 0x0722, 0x06F9, 0x0029, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0088, 0x04B7, 0xFFFF, 0x087C, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x033B, 0x049B, 0x0585, 0x01C9, 0x02BE, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0073, 0x002F, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x066F, 0xFFFF, 0xFFFF, 0x01E5, 0xFFFF, 0x0567,
+    0x0171, 0x06ED, 0xFFFF, 0x0422, 0x062F, 0x084C, 0x06CA, 0x0036,
+    0x07CF, 0x0822, 0xFFFF, 0x0801, 0x0217, 0x06D0, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0454, 0x03E6, 0xFFFF, 0x01EF, 0x05B1, 0x0400,
+    0x0475, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x04D5, 0x0553, 0xFFFF, 0x0664, 0x016F, 0x05B4,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x05C6, 0x056A, 0xFFFF, 0x073C, 0x0364,
+    0x0225, 0x0270, 0x0620, 0x0860, 0x08A8, 0xFFFF, 0x05C7, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0166, 0x06D9, 0xFFFF,
+    0x0390, 0xFFFF, 0x07B2, 0x02A6, 0x0689, 0x02E8, 0x03B7, 0x0330,
+    0x05E4, 0x06F0, 0x0755, 0x013D, 0x061B, 0xFFFF, 0x0821, 0xFFFF,
+    0x06EC, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0693, 0xFFFF, 0xFFFF, 0x04E3, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0873, 0xFFFF, 0x051E, 0x030B, 0x0591, 0xFFFF,
+    0x0121, 0x07F2, 0x0474, 0xFFFF, 0x0300, 0x02AC, 0x0220, 0x041E,
+    0x0313, 0x05AF, 0x06E4, 0x08BC, 0x06A9, 0xFFFF, 0x013F, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0152, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0729, 0x062C, 0xFFFF, 0xFFFF, 0xFFFF, 0x02C9, 0x056F,
+    0x0250, 0x0857, 0xFFFF, 0xFFFF, 0x0679, 0x07A9, 0xFFFF, 0x00F9,
+    0x0428, 0xFFFF, 0x0648, 0xFFFF, 0x0368, 0xFFFF, 0x025A, 0xFFFF,
+    0xFFFF, 0x0532, 0x02F3, 0x06BC, 0x01D9, 0x0831, 0x089C, 0x0674,
+    0x08AD, 0x086E, 0xFFFF, 0x032F, 0x022F, 0xFFFF, 0x00C1, 0x0242,
+    0x0258, 0x0110, 0x090D, 0xFFFF, 0x0459, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x068D, 0xFFFF, 0x0274, 0xFFFF, 0xFFFF, 0x0349, 0x07EE,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x086B, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x04CF, 0xFFFF, 0x0230, 0x00E5, 0xFFFF, 0x0448,
+    0x0362, 0x04C2, 0xFFFF, 0xFFFF, 0xFFFF, 0x05C8, 0x0366, 0x029C,
+    0x082F, 0x02E5, 0xFFFF, 0xFFFF, 0x0530, 0x01D1, 0x019C, 0x0317,
+    0x05A7, 0x017F, 0xFFFF, 0xFFFF, 0xFFFF, 0x003A, 0xFFFF, 0xFFFF,
+    0x0173, 0x061C, 0x0091, 0x0000, 0x02DF, 0x042D, 0xFFFF, 0xFFFF,
+    0x003C, 0xFFFF, 0x0497, 0x0737, 0xFFFF, 0xFFFF, 0x0004, 0xFFFF,
+    0x00E7, 0x02FD, 0x007A, 0x003E, 0x07DD, 0xFFFF, 0x00D9, 0x0092,
+    0x03CE, 0x07F1, 0xFFFF, 0x08C4, 0xFFFF, 0xFFFF, 0x07D4, 0xFFFF,
+    0xFFFF, 0x02EE, 0x005E, 0x0095, 0x041D, 0x08F7, 0xFFFF, 0x01E7,
+    0x05A1, 0x0638, 0xFFFF, 0xFFFF, 0xFFFF, 0x0169, 0x000D, 0x062D,
+    0x063F, 0xFFFF, 0x00A8, 0x01E8, 0x02B4, 0xFFFF, 0x01EC, 0x0777,
+    0x0482, 0xFFFF, 0xFFFF, 0x04E0, 0x058B, 0xFFFF, 0x0046, 0xFFFF,
+    0x0461, 0x01ED, 0x051B, 0x0015, 0x04F5, 0xFFFF, 0xFFFF, 0x0751,
+    0xFFFF, 0x01C4, 0x0427, 0x07A0, 0x06BF, 0xFFFF, 0xFFFF, 0x02E2,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0272, 0xFFFF, 0x06D6, 0x02D1,
+    0x0308, 0x0361, 0x0897, 0xFFFF, 0x03BE, 0x02E0, 0x02FC, 0x06AB,
+    0x0814, 0xFFFF, 0xFFFF, 0xFFFF, 0x04A4, 0x0580, 0x05BE, 0x0692,
+    0xFFFF, 0xFFFF, 0x024A, 0x03FA, 0x057A, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0469, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0429, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0145, 0x02E6, 0x03F3, 0x0279, 0x0633, 0x06BA, 0x07AA,
+    0x05EA, 0x041A, 0x07C8, 0x03BF, 0x0883, 0x05DC, 0xFFFF, 0x0863,
+    0x085C, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0750, 0x07F6, 0xFFFF, 0x013A,
+    0xFFFF, 0x0636, 0x0325, 0x084E, 0xFFFF, 0xFFFF, 0x01B1, 0x0311,
+    0x0690, 0x0472, 0x08C3, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x019D,
+    0x04E5, 0x01AE, 0x065D, 0xFFFF, 0xFFFF, 0xFFFF, 0x0658, 0x0740,
+    0x0765, 0x0843, 0xFFFF, 0xFFFF, 0x0424, 0x04F6, 0x0254, 0x0142,
+    0x0588, 0x0126, 0x054F, 0x0245, 0x0727, 0xFFFF, 0x065E, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0326, 0xFFFF,
+    0x049C, 0x0542, 0x0109, 0x06AD, 0xFFFF, 0xFFFF, 0x028C, 0x052A,
+    0x08DF, 0xFFFF, 0xFFFF, 0x03EE, 0x06B0, 0x010B, 0x02B1, 0x0465,
+    0x05F6, 0xFFFF, 0xFFFF, 0x03C8, 0xFFFF, 0x0136, 0x041C, 0x02DB,
+    0x02EC, 0x00CC, 0x02CF, 0x090C, 0xFFFF, 0xFFFF, 0x00DE, 0xFFFF,
+    0x0866, 0xFFFF, 0xFFFF, 0x0548, 0x00CF, 0x01A7, 0x026E, 0x0115,
+    0x037E, 0x0870, 0xFFFF, 0xFFFF, 0x0379, 0x045A, 0x06F6, 0x00D0,
+    0x0082, 0xFFFF, 0xFFFF, 0x0872, 0x05F0, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x083E, 0x0197, 0x0048, 0x02F8, 0x0739, 0x00F8, 0x0563,
+    0x0788, 0xFFFF, 0x059B, 0x08F9, 0xFFFF, 0xFFFF, 0x03EA, 0xFFFF,
+    0x02E3, 0xFFFF, 0x0752, 0x078A, 0x001D, 0x036F, 0x0401, 0xFFFF,
+    0x02C7, 0x07F4, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0069, 0x0022,
+    0x05C9, 0x0761, 0x00AD, 0x05AB, 0x004F, 0x06B1, 0x05CD, 0x00BF,
+    0x02CE, 0x03D1, 0xFFFF, 0x06A0, 0x00ED, 0x0793, 0x0052, 0x08BD,
+    0xFFFF, 0xFFFF, 0x016D, 0xFFFF, 0x0597, 0xFFFF, 0x0510, 0x0505,
+    0xFFFF, 0x0053, 0x0703, 0x0846, 0x0848, 0x016E, 0x023B, 0x02F2,
+    0x05E7, 0xFFFF, 0x03BC, 0x00B0, 0x0160, 0x0266, 0x0884, 0x0781,
+    0x03D3, 0x0504, 0x0206, 0x0458, 0x02B6, 0x02AF, 0x01CB, 0x05D5,
+    0x05EE, 0x04A1, 0x05D7, 0x06C2, 0x0034, 0x0229, 0xFFFF, 0x0826,
+    0xFFFF, 0x0058, 0x02B5, 0x02BD, 0x03F6, 0x06F3, 0x0881, 0xFFFF,
+    0x08EB, 0xFFFF, 0x0499, 0xFFFF, 0x067D, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x01B7, 0x027B, 0x06E7, 0x0804, 0xFFFF, 0x037A, 0x03B6, 0xFFFF,
+    0x01C1, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0453, 0x04C1,
+    0x04E1, 0x07D0, 0x06C3, 0xFFFF, 0xFFFF, 0x078F, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0314, 0x0655, 0x08F3, 0xFFFF, 0x04DB, 0xFFFF, 0xFFFF,
+    0x03AC, 0xFFFF, 0xFFFF, 0xFFFF, 0x03BB, 0xFFFF, 0xFFFF, 0x0841,
+    0xFFFF, 0x02D0, 0xFFFF, 0x079A, 0xFFFF, 0x06F7, 0xFFFF, 0x014B,
+    0x090E, 0x02F4, 0x0888, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x06EA, 0xFFFF, 0xFFFF, 0x0281, 0x05F7, 0x01AD, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x04ED, 0x054D, 0x068F, 0xFFFF, 0xFFFF, 0x037D,
+    0x05E6, 0x060E, 0xFFFF, 0xFFFF, 0x082D, 0xFFFF, 0x021E, 0x0552,
+    0xFFFF, 0xFFFF, 0x044F, 0x033D, 0xFFFF, 0xFFFF, 0x08B6, 0x0438,
+    0x06C4, 0x07C7, 0xFFFF, 0xFFFF, 0x03D4, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0845, 0x03B1,
+    0xFFFF, 0x086F, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x083A, 0xFFFF, 0xFFFF, 0x04C3, 0x062A, 0x0719, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0275, 0x0116, 0x067F, 0xFFFF,
+    0x08CF, 0x04CA, 0xFFFF, 0xFFFF, 0x0609, 0xFFFF, 0x04DA, 0xFFFF,
+    0xFFFF, 0x00FA, 0xFFFF, 0xFFFF, 0xFFFF, 0x08D4, 0x0694, 0x06C9,
+    0xFFFF, 0x0854, 0xFFFF, 0x056D, 0x0830, 0x057C, 0x0635, 0x0762,
+    0xFFFF, 0xFFFF, 0x0772, 0x079B, 0x0131, 0x011A, 0x02B9, 0x00FC,
+    0xFFFF, 0xFFFF, 0x0387, 0xFFFF, 0x00EF, 0x0789, 0xFFFF, 0xFFFF,
+    0x05D3, 0xFFFF, 0xFFFF, 0x00A4, 0x058C, 0x07E5, 0x0112, 0xFFFF,
+    0x01A2, 0x008C, 0x018E, 0x0334, 0x035C, 0x00C4, 0x08D3, 0x08EE,
+    0xFFFF, 0x01F1, 0x0262, 0xFFFF, 0x0209, 0x04EB, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0725, 0x0187, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0310, 0x0359, 0xFFFF, 0xFFFF, 0x0039, 0x058F, 0x0629,
+    0xFFFF, 0x0090, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x079C, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x00B6, 0xFFFF, 0xFFFF, 0xFFFF, 0x0508,
+    0x00C9, 0xFFFF, 0x0398, 0x070F, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x06BE, 0xFFFF,
+    0xFFFF, 0x0094, 0x04F8, 0x000A, 0x0185, 0x01BD, 0x039F, 0x04B4,
+    0x06BB, 0xFFFF, 0xFFFF, 0xFFFF, 0x00BC, 0x000C, 0x0060, 0x0348,
+    0x0572, 0x0625, 0x0042, 0xFFFF, 0x0896, 0x0201, 0xFFFF, 0x05B7,
+    0x0011, 0x06D4, 0x0489, 0xFFFF, 0xFFFF, 0x0045, 0xFFFF, 0xFFFF,
+    0x0775, 0xFFFF, 0x0782, 0x0014, 0x0647, 0x0714, 0xFFFF, 0x08CC,
+    0x08A5, 0x03F0, 0x02B8, 0x01B5, 0x044B, 0xFFFF, 0x0017, 0xFFFF,
+    0xFFFF, 0x04E4, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0766,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x031B, 0x07A3, 0x0431, 0x05CC, 0x068B,
+    0x0878, 0x087A, 0xFFFF, 0x08FA, 0x0701, 0x0565, 0x038B, 0x0546,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x04C4, 0x0156,
+    0x08B8, 0x0662, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x058E, 0x0773,
+    0xFFFF, 0xFFFF, 0x053C, 0xFFFF, 0xFFFF, 0xFFFF, 0x015F, 0x07E4,
+    0xFFFF, 0x04D7, 0xFFFF, 0xFFFF, 0x0344, 0xFFFF, 0xFFFF, 0x0282,
+    0xFFFF, 0xFFFF, 0x075C, 0xFFFF, 0x0140, 0x053E, 0x0280, 0x0754,
+    0x0491, 0xFFFF, 0x0405, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x08FE,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x01B8, 0x028D, 0x07BC, 0xFFFF,
+    0xFFFF, 0x0657, 0xFFFF, 0x0416, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x01F9, 0xFFFF, 0x056B, 0xFFFF, 0x040A, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x014A, 0x025C, 0x05FC, 0x07AE, 0xFFFF, 0xFFFF, 0x05D8, 0x0132,
+    0x01B3, 0x0895, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0745,
+    0xFFFF, 0x0786, 0xFFFF, 0x0643, 0x01AB, 0x01D2, 0x0649, 0x03CC,
+    0x08E6, 0x0113, 0x0102, 0x031C, 0x027C, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0894, 0x0513, 0xFFFF, 0xFFFF, 0x0685, 0x01A4, 0x029F,
+    0xFFFF, 0x011E, 0xFFFF, 0x01F6, 0x01A0, 0x0367, 0x0710, 0x0114,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x010A, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0487, 0xFFFF, 0x0104, 0xFFFF, 0xFFFF, 0x0135, 0x0251, 0x0677,
+    0xFFFF, 0x00CB, 0x054A, 0x08D2, 0xFFFF, 0x0105, 0xFFFF, 0x06A5,
+    0xFFFF, 0x0120, 0x031A, 0x06B5, 0xFFFF, 0xFFFF, 0x021C, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0190, 0x051C, 0x0622, 0x072F, 0x0907,
+    0xFFFF, 0x08D6, 0x0522, 0xFFFF, 0xFFFF, 0x0064, 0x024D, 0x050C,
+    0x088F, 0x01CD, 0x0261, 0x0273, 0x02F5, 0x077C, 0x06FF, 0x064B,
+    0xFFFF, 0x0186, 0x0506, 0xFFFF, 0xFFFF, 0xFFFF, 0x074F, 0xFFFF,
+    0xFFFF, 0x0575, 0x04B8, 0x0067, 0xFFFF, 0xFFFF, 0x01D0, 0xFFFF,
+    0x0084, 0x0805, 0xFFFF, 0xFFFF, 0x023C, 0x02E9, 0x0021, 0x0700,
+    0x06D1, 0x0794, 0x034A, 0x004E, 0x035E, 0x0603, 0x0177, 0x07B6,
+    0x006C, 0x03E2, 0x077E, 0xFFFF, 0xFFFF, 0xFFFF, 0x0051, 0x018B,
+    0xFFFF, 0xFFFF, 0x023A, 0x08BA, 0x0028, 0xFFFF, 0xFFFF, 0x084B,
+    0x016B, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x002B, 0xFFFF,
+    0x0728, 0xFFFF, 0xFFFF, 0xFFFF, 0x0286, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x00A2, 0x002E, 0xFFFF, 0x08D8, 0xFFFF, 0x03DB, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0415, 0x00A3, 0x0309, 0x0642, 0xFFFF, 0xFFFF,
+    0x0824, 0x0057, 0x082E, 0x039B, 0x03F2, 0xFFFF, 0xFFFF, 0x0228,
+    0x025F, 0x0295, 0xFFFF, 0xFFFF, 0x0059, 0x03FF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x05DE, 0x05C0, 0x0770, 0x02F1, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x05CB, 0x034E, 0x0219, 0x0290, 0x0315, 0xFFFF, 0x0200,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x03F8, 0x04B5, 0xFFFF, 0xFFFF, 0x0632,
+    0x0733, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x015B, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0746, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0778, 0x05C1, 0xFFFF, 0x03AF, 0x08BE,
+    0x030C, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x01DA, 0x02D7, 0x040C,
+    0x048E, 0x0672, 0x073B, 0x05BA, 0x0162, 0x0440, 0xFFFF, 0x0749,
+    0x082C, 0xFFFF, 0x0547, 0xFFFF, 0xFFFF, 0x059D, 0xFFFF, 0xFFFF,
+    0x0641, 0x03DE, 0xFFFF, 0x064E, 0xFFFF, 0xFFFF, 0xFFFF, 0x04F7,
+    0x07FC, 0xFFFF, 0x0294, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x04CB, 0x0836, 0xFFFF, 0xFFFF, 0x0683, 0x0353, 0x021F, 0x0235,
+    0x052F, 0x08E9, 0xFFFF, 0xFFFF, 0xFFFF, 0x0198, 0x0709, 0x075A,
+    0x0450, 0x02CA, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0463, 0x05E1, 0x03E1, 0x060A, 0x066E, 0x0336,
+    0x01F8, 0x028A, 0x0293, 0x0601, 0x0776, 0x0908, 0xFFFF, 0x0496,
+    0x02D3, 0xFFFF, 0x0122, 0xFFFF, 0xFFFF, 0xFFFF, 0x0130, 0x0696,
+    0x08AE, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x05F9, 0xFFFF,
+    0x08B9, 0xFFFF, 0x0182, 0x0501, 0x072D, 0xFFFF, 0x05A4, 0x043D,
+    0x0856, 0x00EE, 0x02B0, 0x0241, 0x039E, 0x0119, 0x052C, 0x03E5,
+    0x075E, 0x0849, 0x08D5, 0xFFFF, 0xFFFF, 0xFFFF, 0x04BF, 0x080A,
+    0xFFFF, 0x07E2, 0x01F5, 0xFFFF, 0x026B, 0x02C8, 0x04DF, 0xFFFF,
+    0x019B, 0x0723, 0x0183, 0xFFFF, 0x00E4, 0x044E, 0x061E, 0x0676,
+    0x062B, 0x0900, 0xFFFF, 0xFFFF, 0x074A, 0x017E, 0xFFFF, 0xFFFF,
+    0x00C5, 0xFFFF, 0xFFFF, 0xFFFF, 0x066D, 0x07D6, 0x0321, 0x04D4,
+    0x06EE, 0x07E1, 0x0850, 0x0571, 0xFFFF, 0xFFFF, 0xFFFF, 0x046F,
+    0x0468, 0x05FF, 0x06CD, 0xFFFF, 0xFFFF, 0x00C6, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x076F, 0xFFFF, 0x00B5, 0x018F, 0x031D, 0x037C, 0x023F,
+    0x047F, 0x0191, 0x01C7, 0x04DC, 0x04FD, 0x05F5, 0x0668, 0x06DF,
+    0x083D, 0x0852, 0xFFFF, 0x06CC, 0xFFFF, 0x06DD, 0x0702, 0xFFFF,
+    0x00DA, 0xFFFF, 0x039D, 0x077B, 0xFFFF, 0x06F8, 0xFFFF, 0x007D,
+    0x04A3, 0x045F, 0x0512, 0x0473, 0x0097, 0x054B, 0x0476, 0x0179,
+    0x0240, 0x007F, 0x0412, 0x05B9, 0xFFFF, 0x01EB, 0x0226, 0xFFFF,
+    0x0010, 0x01C6, 0x07EB, 0xFFFF, 0x063A, 0xFFFF, 0xFFFF, 0x0621,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x01BE, 0xFFFF, 0x069B, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x01F0,
+    0x0535, 0x0170, 0x064F, 0x080F, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF
+};
+
+const uint16_t tag36h11_hash[1024] = {
+    0x0097, 0xFFFF, 0x01DE, 0xFFFF, 0x008E, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0184, 0xFFFF, 0x01EA, 0xFFFF, 0xFFFF, 0xFFFF, 0x01C2, 0xFFFF,
+    0x00BF, 0x0101, 0x014C, 0x0173, 0xFFFF, 0xFFFF, 0x00AB, 0x018D,
+    0xFFFF, 0x0078, 0x01EF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0176,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x013C,
+    0xFFFF, 0x0064, 0x0059, 0xFFFF, 0x0006, 0x00D3, 0x00F1, 0x004D,
+    0xFFFF, 0x0054, 0x004E, 0x0072, 0x000F, 0x00C6, 0x0012, 0x00E9,
+    0x00F6, 0x0015, 0xFFFF, 0xFFFF, 0x0017, 0x0099, 0x001B, 0x0136,
+    0x017D, 0x001C, 0x0172, 0x01C3, 0x0228, 0x0092, 0xFFFF, 0x021B,
+    0x01D9, 0xFFFF, 0xFFFF, 0xFFFF, 0x0132, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0190, 0x00AD, 0xFFFF, 0x008D, 0x0205, 0xFFFF, 0xFFFF, 0x014F,
+    0xFFFF, 0xFFFF, 0x0148, 0x01C4, 0xFFFF, 0xFFFF, 0x017A, 0xFFFF,
+    0x01B1, 0x0168, 0x00DA, 0xFFFF, 0xFFFF, 0x023C, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x01CD, 0xFFFF, 0x005E, 0x00A7, 0x01B8,
+    0x022D, 0xFFFF, 0xFFFF, 0xFFFF, 0x00AA, 0x00C5, 0x00F3, 0x01D2,
+    0xFFFF, 0xFFFF, 0x0061, 0x011C, 0xFFFF, 0x006E, 0x0218, 0x0024,
+    0x003C, 0x0048, 0x0249, 0xFFFF, 0x0027, 0x00A3, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x002A, 0x0238, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x00C0, 0xFFFF, 0xFFFF, 0x00F7, 0xFFFF, 0xFFFF, 0xFFFF, 0x01CB,
+    0x0095, 0x021C, 0xFFFF, 0xFFFF, 0xFFFF, 0x0225, 0xFFFF, 0xFFFF,
+    0x01DF, 0xFFFF, 0xFFFF, 0x00E0, 0x0087, 0x0111, 0x010E, 0x01CC,
+    0x0106, 0xFFFF, 0xFFFF, 0x023E, 0x017B, 0xFFFF, 0x0163, 0xFFFF,
+    0xFFFF, 0x00C8, 0x01CE, 0xFFFF, 0x0248, 0xFFFF, 0xFFFF, 0x013E,
+    0x0062, 0x0074, 0x0085, 0x00F8, 0x0128, 0x0065, 0x012E, 0x0210,
+    0x0053, 0xFFFF, 0xFFFF, 0x000A, 0xFFFF, 0x010A, 0x000E, 0x00F4,
+    0x0011, 0x0183, 0x0033, 0x0014, 0x0035, 0x00B0, 0x01B7, 0x00EC,
+    0x0043, 0x0219, 0x0222, 0x0227, 0x00D7, 0x00CA, 0x022F, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x01C9, 0x0109, 0x016B, 0x020B, 0x01D4,
+    0xFFFF, 0xFFFF, 0x01FB, 0x01FD, 0x00E5, 0x015A, 0xFFFF, 0xFFFF,
+    0x00BD, 0xFFFF, 0x00A6, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x01DD,
+    0xFFFF, 0x007A, 0x00FA, 0x0135, 0x01BB, 0x023B, 0x00A8, 0x0108,
+    0x020A, 0x0169, 0x0050, 0x0067, 0x0051, 0x023A, 0x00B3, 0x003A,
+    0x0236, 0x0023, 0x0185, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0041,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0123, 0x0003,
+    0xFFFF, 0xFFFF, 0x0164, 0xFFFF, 0xFFFF, 0xFFFF, 0x0226, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x01A7, 0xFFFF, 0xFFFF, 0xFFFF, 0x0177,
+    0x015B, 0xFFFF, 0xFFFF, 0x00AE, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00BE, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x00E1, 0xFFFF, 0xFFFF, 0x007C, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x012C, 0x0063, 0x01B5, 0x01D1, 0x0162,
+    0x0104, 0x01D3, 0x0206, 0x016D, 0x019A, 0x0200, 0xFFFF, 0x018C,
+    0xFFFF, 0xFFFF, 0x017F, 0x0221, 0xFFFF, 0x0013, 0x0055, 0x0042,
+    0x0119, 0x01AE, 0x001A, 0x00F9, 0x0037, 0x01D6, 0x0182, 0x0244,
+    0x001E, 0x00FD, 0x01AA, 0x01D0, 0xFFFF, 0xFFFF, 0x01C5, 0x0242,
+    0xFFFF, 0x0209, 0x008A, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x013F, 0x00DF, 0x01D5, 0x021A, 0x0240, 0x0089, 0xFFFF, 0x0122,
+    0xFFFF, 0x0088, 0xFFFF, 0xFFFF, 0xFFFF, 0x008B, 0x017C, 0x01F7,
+    0x022A, 0x023D, 0x0201, 0x0245, 0xFFFF, 0xFFFF, 0x0239, 0x007F,
+    0x0079, 0x0086, 0x01FE, 0x006D, 0x0217, 0x00F0, 0x00BA, 0x0189,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0143, 0x0066, 0xFFFF, 0x00C4,
+    0x00D5, 0xFFFF, 0x0022, 0x0058, 0x021E, 0x0178, 0x009F, 0x0198,
+    0x01DA, 0x00E2, 0x00CB, 0xFFFF, 0xFFFF, 0x0049, 0x018B, 0xFFFF,
+    0x002C, 0xFFFF, 0xFFFF, 0x01BD, 0x0235, 0x0114, 0x01FF, 0x0230,
+    0x010D, 0xFFFF, 0xFFFF, 0xFFFF, 0x0118, 0xFFFF, 0xFFFF, 0x022B,
+    0xFFFF, 0xFFFF, 0x022C, 0x00EB, 0x013D, 0x00C9, 0x01E3, 0xFFFF,
+    0xFFFF, 0x0156, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x010B, 0x0155, 0xFFFF, 0x0220, 0xFFFF, 0x0084,
+    0x00A9, 0xFFFF, 0xFFFF, 0xFFFF, 0x011B, 0x0131, 0x00BC, 0x00A1,
+    0x00A5, 0x01DB, 0x00E3, 0x002E, 0x01E5, 0x004C, 0x01E1, 0x01AC,
+    0x01C8, 0x000D, 0x005C, 0x01ED, 0x016E, 0x01F4, 0x01F8, 0x0211,
+    0x00F2, 0x0243, 0x015D, 0x0098, 0x0019, 0x00C3, 0xFFFF, 0xFFFF,
+    0x0110, 0x0216, 0xFFFF, 0x01F2, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x01BA, 0xFFFF, 0x0154, 0x016C,
+    0x0188, 0xFFFF, 0x0112, 0x01A6, 0xFFFF, 0x01A9, 0x0124, 0xFFFF,
+    0xFFFF, 0x00FB, 0xFFFF, 0x0138, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x01F9, 0x01A2, 0xFFFF, 0x022E, 0xFFFF, 0xFFFF,
+    0x006C, 0xFFFF, 0x0080, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0174, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0039, 0x001F,
+    0x0046, 0x0068, 0x0120, 0x0193, 0x01F6, 0x00FE, 0x01EB, 0x024A,
+    0x0070, 0x00CD, 0xFFFF, 0xFFFF, 0x0028, 0x00A0, 0x0052, 0x00D0,
+    0x00EF, 0xFFFF, 0xFFFF, 0x0002, 0x002D, 0x0151, 0x020D, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0146, 0xFFFF, 0xFFFF, 0x013B, 0xFFFF, 0xFFFF, 0x019B, 0x008C,
+    0xFFFF, 0x01EC, 0x0232, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x00D6, 0x0126, 0x014B, 0xFFFF, 0x00BB, 0xFFFF, 0x00E4,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00D9, 0x01EE, 0xFFFF,
+    0xFFFF, 0x0165, 0x004A, 0x019C, 0x004B, 0x00DD, 0x0007, 0x0030,
+    0x00B8, 0x00D4, 0x00D8, 0x000C, 0x0237, 0x0241, 0x0113, 0xFFFF,
+    0xFFFF, 0x0180, 0xFFFF, 0xFFFF, 0x01B0, 0x01E0, 0x011D, 0x004F,
+    0x0196, 0x0233, 0xFFFF, 0x0096, 0xFFFF, 0x0129, 0x0147, 0x01E4,
+    0x01B9, 0xFFFF, 0xFFFF, 0x0204, 0xFFFF, 0x0117, 0xFFFF, 0xFFFF,
+    0x00B1, 0x015C, 0x00EE, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x01B2, 0x00AC, 0xFFFF, 0x023F, 0xFFFF, 0x00CE, 0x0142,
+    0x014E, 0x0171, 0x0140, 0xFFFF, 0xFFFF, 0x00ED, 0x016F, 0x0179,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0077, 0x0150, 0x01A8, 0xFFFF, 0x005F,
+    0xFFFF, 0x011A, 0x0207, 0x0057, 0xFFFF, 0x0038, 0xFFFF, 0x012A,
+    0xFFFF, 0x0045, 0x0187, 0x0047, 0x0020, 0x0073, 0x0069, 0x006F,
+    0x01AD, 0x01C0, 0x01C1, 0x01A5, 0x00A2, 0x0040, 0x00B7, 0x00FF,
+    0x0102, 0x01CA, 0x01D7, 0xFFFF, 0x016A, 0x0001, 0xFFFF, 0xFFFF,
+    0x0005, 0x00CC, 0x0213, 0xFFFF, 0xFFFF, 0x00AF, 0x00C1, 0x01C6,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0144, 0x00D1, 0x014A, 0x0195, 0x019F,
+    0xFFFF, 0xFFFF, 0x0186, 0x018F, 0x0202, 0x0152, 0x008F, 0x0137,
+    0x0160, 0x007B, 0x021F, 0x013A, 0x01F5, 0x00EA, 0x0166, 0x0208,
+    0x01A1, 0x021D, 0x012F, 0xFFFF, 0xFFFF, 0xFFFF, 0x00DE, 0xFFFF,
+    0xFFFF, 0x01A4, 0x011F, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0076, 0x0115, 0x0009, 0x005B, 0x000B, 0x01BF, 0x01F1,
+    0x0010, 0x0032, 0x006B, 0x0231, 0x0234, 0x0016, 0x009C, 0x011E,
+    0x0056, 0x0036, 0x0212, 0x0246, 0xFFFF, 0x0130, 0x0192, 0x01C7,
+    0x009D, 0x010F, 0xFFFF, 0xFFFF, 0xFFFF, 0x01CF, 0x0159, 0x009A,
+    0x0091, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00F5, 0x0197, 0x020F,
+    0xFFFF, 0xFFFF, 0x0153, 0xFFFF, 0x0134, 0xFFFF, 0x00DB, 0x0139,
+    0x01DC, 0x00C7, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0107, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0133, 0x0141, 0xFFFF, 0xFFFF, 0xFFFF, 0x0044, 0x00B9, 0x0158,
+    0x01F3, 0x0060, 0xFFFF, 0x015F, 0x00B5, 0x0191, 0x01A0, 0x0224,
+    0x015E, 0x0229, 0x00B4, 0x0194, 0x003E, 0xFFFF, 0x0026, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x002B, 0x0000,
+    0x00FC, 0xFFFF, 0x01FC, 0x0170, 0xFFFF, 0xFFFF, 0xFFFF, 0x01F0,
+    0xFFFF, 0x00E7, 0x009B, 0x00E8, 0x019E, 0xFFFF, 0xFFFF, 0x010C,
+    0xFFFF, 0xFFFF, 0x0090, 0xFFFF, 0x0149, 0x0199, 0x0181, 0x01FA,
+    0x01AF, 0x0116, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0081, 0x0215,
+    0xFFFF, 0x00CF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0082, 0xFFFF,
+    0x01E6, 0x0125, 0xFFFF, 0x007D, 0x0145, 0xFFFF, 0x0071, 0xFFFF,
+    0x005A, 0x020E, 0x0075, 0x002F, 0x0008, 0x006A, 0x0031, 0x0100,
+    0x0103, 0x00D2, 0x0157, 0x01D8, 0x01E8, 0xFFFF, 0x0034, 0x0127,
+    0x005D, 0x014D, 0x0018, 0x019D, 0xFFFF, 0xFFFF, 0xFFFF, 0x001D,
+    0x018E, 0xFFFF, 0xFFFF, 0xFFFF, 0x0093, 0x0214, 0x00C2, 0xFFFF,
+    0xFFFF, 0x018A, 0xFFFF, 0xFFFF, 0xFFFF, 0x0161, 0x0094, 0x01BC,
+    0x0223, 0xFFFF, 0xFFFF, 0x0203, 0x0247, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0083, 0xFFFF, 0x0105, 0xFFFF, 0x00E6, 0x007E, 0x01E2,
+    0xFFFF, 0x0121, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00B6, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x020C, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x01A3, 0xFFFF,
+    0x00A4, 0x012D, 0x0021, 0x003B, 0x00DC, 0x0025, 0x003D, 0x00B2,
+    0x0175, 0x003F, 0x009E, 0x01B4, 0x01E7, 0x0029, 0x01E9, 0x017E,
+    0x012B, 0x01B3, 0x01BE, 0xFFFF, 0x0004, 0x0167, 0x01AB, 0x01B6
+};
+
+const uint16_t artoolkit_hash[1024] = {
+    0x008E, 0xFFFF, 0xFFFF, 0x00E4, 0x01C6, 0x0084, 0xFFFF, 0x00ED,
+    0x005E, 0x008D, 0x01CF, 0xFFFF, 0xFFFF, 0x0054, 0x01C5, 0xFFFF,
+    0xFFFF, 0x005D, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0036, 0x0042, 0x00F2, 0x01A7, 0x003F, 0x004B,
+    0x0092, 0x009B, 0x00FB, 0x0035, 0x0041, 0x00F1, 0x0117, 0x0091,
+    0x0177, 0x01D3, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0023, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00DE, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0128, 0xFFFF, 0x00D4, 0xFFFF, 0xFFFF, 0x00DD, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0066, 0xFFFF, 0x0006, 0x00B6,
+    0x006F, 0x00C2, 0x000F, 0x00BF, 0x00CB, 0x0065, 0xFFFF, 0x0005,
+    0x00B5, 0x00C1, 0x0147, 0x0197, 0x01F7, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00A3, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0073, 0x01A8,
+    0x0013, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0178, 0xFFFF,
+    0x0118, 0x00E6, 0xFFFF, 0x0086, 0xFFFF, 0x00EF, 0xFFFF, 0x008F,
+    0xFFFF, 0xFFFF, 0x00E5, 0x0056, 0x01C7, 0x0085, 0xFFFF, 0x005F,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0055, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0037, 0x0043, 0x00F3, 0xFFFF, 0x0093, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x013C, 0x0148, 0x01F8, 0x0198, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x012A,
+    0xFFFF, 0x00D6, 0xFFFF, 0xFFFF, 0x00DF, 0x0120, 0xFFFF, 0xFFFF,
+    0x0129, 0xFFFF, 0x00D5, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x0067, 0xFFFF, 0x0007, 0x00B7, 0x00C3,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x016C, 0xFFFF, 0x010C, 0x01BC,
+    0x01C8, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x01AA, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x01A0, 0xFFFF, 0xFFFF, 0x017A, 0x0038, 0x011A, 0x01A9,
+    0xFFFF, 0xFFFF, 0x0170, 0xFFFF, 0x0110, 0xFFFF, 0x0179, 0xFFFF,
+    0x00E7, 0x0119, 0xFFFF, 0x0087, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x01EC, 0xFFFF, 0x0057, 0x018C, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x015C, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0068,
+    0x013E, 0x0008, 0x00B8, 0x014A, 0x019A, 0x0134, 0x0140, 0x01F0,
+    0x01FA, 0x013D, 0x0149, 0x0190, 0x01F9, 0x0199, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0122, 0xFFFF, 0xFFFF, 0xFFFF, 0x012B, 0xFFFF,
+    0x00D7, 0xFFFF, 0xFFFF, 0xFFFF, 0x0121, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x01DC, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x016E, 0x002C, 0x00E8, 0x010E, 0x0088, 0x0164,
+    0x01BE, 0x0104, 0x01B4, 0x016D, 0x01C0, 0x010D, 0x0058, 0x01BD,
+    0x01C9, 0x01CA, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x01A2,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x003A, 0x01AB, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0030, 0x0172, 0x0112, 0x01A1, 0x0039, 0x017B, 0x011B, 0xFFFF,
+    0xFFFF, 0x0171, 0xFFFF, 0x0111, 0xFFFF, 0xFFFF, 0xFFFF, 0x01EE,
+    0x00AC, 0x018E, 0xFFFF, 0xFFFF, 0x01E4, 0xFFFF, 0xFFFF, 0x0184,
+    0x007C, 0x015E, 0x001C, 0x018D, 0x00D8, 0x01ED, 0xFFFF, 0x0154,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x015D, 0xFFFF, 0x006A, 0xFFFF, 0x000A,
+    0x00BA, 0xFFFF, 0xFFFF, 0x0060, 0x0136, 0x0000, 0x0069, 0x00B0,
+    0x013F, 0x0009, 0x00B9, 0x0142, 0x014B, 0x0135, 0x0141, 0x0192,
+    0x0191, 0x019B, 0x01F1, 0x01F2, 0x01FB, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0123, 0xFFFF, 0x004C, 0x00FC, 0x01DE, 0x009C,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x01D4, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x01DD, 0x002E, 0x00EA, 0xFFFF, 0x008A, 0x0166, 0x0024, 0xFFFF,
+    0x00E0, 0x0106, 0x002D, 0x0080, 0x00E9, 0x005A, 0x0089, 0x010F,
+    0x0165, 0x0105, 0x0050, 0x016F, 0x01B5, 0x01B6, 0x0059, 0x01BF,
+    0x01C1, 0x01C2, 0x01CB, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0032,
+    0x01A3, 0x00CC, 0x003B, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0173,
+    0x0031, 0x0113, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00AE, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x00A4, 0x01E6, 0x0186, 0x007E, 0x00AD,
+    0x001E, 0x018F, 0x00DA, 0x01EF, 0x0074, 0x0156, 0x0014, 0x007D,
+    0x00D0, 0x015F, 0x001D, 0x00D9, 0x0185, 0x01E5, 0x0155, 0xFFFF,
+    0xFFFF, 0x0062, 0xFFFF, 0x0002, 0x006B, 0x00B2, 0xFFFF, 0x000B,
+    0x00BB, 0xFFFF, 0x0061, 0x0137, 0x0001, 0x00B1, 0x0143, 0x0193,
+    0x01F3, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x004E, 0x00FE, 0xFFFF, 0x009E, 0xFFFF, 0xFFFF,
+    0x0044, 0x00F4, 0x01D6, 0x0094, 0x004D, 0x00FD, 0x01DF, 0x009D,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x01D5, 0x0026, 0xFFFF, 0x00E2, 0xFFFF,
+    0x002F, 0x0082, 0x00EB, 0xFFFF, 0x008B, 0x0167, 0x0025, 0x00E1,
+    0x0052, 0x0081, 0x0107, 0x01B7, 0x005B, 0x01C3, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0051, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00CE,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00C4, 0x0033, 0xFFFF,
+    0xFFFF, 0x00CD, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0138, 0xFFFF,
+    0xFFFF, 0x00A6, 0xFFFF, 0xFFFF, 0xFFFF, 0x00AF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0076, 0x00A5, 0x0016, 0x007F, 0x00D2, 0x0187,
+    0x001F, 0x00DB, 0x01E7, 0x0075, 0x0157, 0x0015, 0xFFFF, 0x00D1,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0063, 0xFFFF, 0x0003, 0x00B3, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0168, 0xFFFF, 0xFFFF, 0x0108, 0x01B8, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0046, 0x00F6,
+    0xFFFF, 0x0096, 0x004F, 0x00FF, 0xFFFF, 0x009F, 0xFFFF, 0x0045,
+    0x00F5, 0x01D7, 0x0095, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0027, 0x00E3, 0xFFFF, 0x0083,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x012C, 0xFFFF, 0x01E8, 0x0053,
+    0x0188, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0158, 0xFFFF, 0xFFFF, 0x00C6, 0xFFFF, 0xFFFF, 0xFFFF, 0x00CF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x00C5, 0x013A, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0130, 0xFFFF, 0xFFFF, 0xFFFF, 0x0139, 0xFFFF,
+    0xFFFF, 0x00A7, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0077, 0x01AC, 0x0017, 0xFFFF, 0x00D3, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x017C, 0xFFFF, 0xFFFF, 0x011C, 0x01D8, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x016A, 0x0028,
+    0xFFFF, 0x010A, 0x01BA, 0xFFFF, 0x0160, 0xFFFF, 0x0100, 0x01B0,
+    0x0169, 0xFFFF, 0x0109, 0x01B9, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0047, 0x00F7, 0xFFFF,
+    0x0097, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x014C, 0x01FC,
+    0xFFFF, 0x019C, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x012E, 0xFFFF, 0x00A8, 0x01EA, 0x018A, 0xFFFF,
+    0x0124, 0x01E0, 0xFFFF, 0x0180, 0x012D, 0x0078, 0x015A, 0x0018,
+    0x0189, 0x01E9, 0xFFFF, 0x0150, 0xFFFF, 0xFFFF, 0xFFFF, 0x0159,
+    0xFFFF, 0xFFFF, 0x00C7, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0132, 0xFFFF, 0xFFFF, 0x01CC, 0x013B, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0131, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x01AE,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x01A4, 0xFFFF, 0x017E,
+    0x003C, 0x0048, 0x00F8, 0x011E, 0x0098, 0x0174, 0x01AD, 0x0114,
+    0x01DA, 0x017D, 0x01D0, 0x011D, 0xFFFF, 0x002A, 0x01D9, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x0162, 0x0020, 0x0102, 0x01B2, 0x016B, 0x0029,
+    0x010B, 0x01BB, 0xFFFF, 0x0161, 0xFFFF, 0xFFFF, 0x0101, 0x01B1,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0x006C, 0xFFFF, 0x000C, 0x00BC, 0x00C8, 0x014E,
+    0x019E, 0x0144, 0x01F4, 0x01FE, 0x0194, 0x014D, 0x01FD, 0xFFFF,
+    0x019D, 0xFFFF, 0x00AA, 0xFFFF, 0xFFFF, 0xFFFF, 0x0126, 0x01E2,
+    0x00A0, 0x0182, 0x012F, 0x007A, 0x00A9, 0x001A, 0x018B, 0x0125,
+    0x0070, 0x01E1, 0x0010, 0x0152, 0x0079, 0x015B, 0x0019, 0x0181,
+    0x01EB, 0xFFFF, 0xFFFF, 0x0151, 0xFFFF, 0xFFFF, 0xFFFF, 0x00EC,
+    0xFFFF, 0x01CE, 0x008C, 0xFFFF, 0xFFFF, 0xFFFF, 0x01C4, 0x0133,
+    0xFFFF, 0xFFFF, 0x005C, 0x01CD, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x01A6, 0xFFFF, 0xFFFF, 0x003E, 0x004A,
+    0x00FA, 0x01AF, 0x009A, 0x0176, 0x0034, 0x0040, 0x00F0, 0x0116,
+    0x003D, 0x0049, 0x0090, 0x0099, 0x00F9, 0x011F, 0x0175, 0x0115,
+    0x017F, 0x0022, 0x01A5, 0x01D1, 0x01D2, 0x002B, 0x01DB, 0xFFFF,
+    0xFFFF, 0x0163, 0x0021, 0xFFFF, 0x0103, 0x01B3, 0xFFFF, 0x00DC,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x006E, 0xFFFF, 0xFFFF, 0x000E, 0x00BE, 0x00CA, 0x0064, 0x0146,
+    0x0004, 0x00B4, 0x006D, 0x00C0, 0x000D, 0x00BD, 0x00C9, 0x014F,
+    0x0196, 0x0145, 0x019F, 0x01F5, 0x0195, 0x01F6, 0x00A2, 0x01FF,
+    0xFFFF, 0xFFFF, 0x00AB, 0xFFFF, 0xFFFF, 0x0127, 0x0072, 0x00A1,
+    0x0012, 0x0183, 0x007B, 0x01E3, 0x001B, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0071, 0x0153, 0x0011, 0xFFFF, 0xFFFF, 0xFFFF, 0x00EE, 0xFFFF
+};
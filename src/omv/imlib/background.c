@@ -0,0 +1,112 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Background subtraction with a running mean and variance per pixel.
+ */
+#include "imlib.h"
+#include "xalloc.h"
+
+// Each pixel's state is one word, so a frame is classified and learned in a single pass.
+#define BG_STATE(mean, var)    (((var) << 16) | (mean))
+#define BG_MEAN(state)         ((state) & 0xFFFF) // Q8
+#define BG_VAR(state)          ((state) >> 16)    // Q4
+#define BG_FG_RATE_SHIFT       (2)                // Foreground is learned 4x slower.
+
+void imlib_background_init(background_model_t *bg, image_t *img, int rate, float threshold, float min_std) {
+    bg->w = img->w;
+    bg->h = img->h;
+    bg->rate = IM_CLAMP(rate, 0, 15);
+    bg->threshold = fast_roundf(threshold * threshold * 16.0f);
+    bg->min_var = IM_CLAMP(fast_roundf(min_std * min_std * 16.0f), 1, UINT16_MAX);
+    bg->state = xalloc(img->w * img->h * sizeof(uint32_t));
+    bg->mask.w = img->w;
+    bg->mask.h = img->h;
+    bg->mask.pixfmt = PIXFORMAT_BINARY;
+    bg->mask.data = xalloc0(image_size(&bg->mask));
+
+    // The first frame is the background, with the smallest variance.
+    imlib_background_reset(bg, img);
+}
+
+void imlib_background_reset(background_model_t *bg, image_t *img) {
+    for (int y = 0, i = 0; y < bg->h; y++) {
+        for (int x = 0; x < bg->w; x++, i++) {
+            bg->state[i] = BG_STATE(IM_TO_GS_PIXEL(img, x, y) << 8, bg->min_var);
+        }
+    }
+}
+
+void imlib_background_free(background_model_t *bg) {
+    xfree(bg->mask.data);
+    xfree(bg->state);
+    bg->mask.data = NULL;
+    bg->state = NULL;
+}
+
+// Classifies one pixel against its state and learns it. Returns true for foreground.
+static inline bool background_pixel(background_model_t *bg, uint32_t *state, int pixel, bool learn) {
+    uint32_t s = *state;
+    int mean = BG_MEAN(s);
+    int var = BG_VAR(s);
+    int d = (pixel << 8) - mean;                // Q8
+    int d_q4 = d >> 4;
+    uint32_t d2 = (d_q4 * d_q4) >> 4;           // Q4
+    bool fg = (d2 << 4) > (bg->threshold * var);
+
+    if (learn) {
+        int rate = bg->rate + (fg ? BG_FG_RATE_SHIFT : 0);
+        mean += d >> rate;
+        var += ((int) IM_MIN(d2, 0xFFFFu) - var) >> rate;
+        *state = BG_STATE(mean, IM_MAX(var, (int) bg->min_var));
+    }
+
+    return fg;
+}
+
+int imlib_background_update(background_model_t *bg, image_t *img, bool learn) {
+    int count = 0;
+
+    for (int y = 0; y < bg->h; y++) {
+        uint32_t *state = bg->state + (y * bg->w);
+        uint32_t *mask_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bg->mask, y);
+
+        // The mask is written a word (32 pixels) at a time.
+        for (int x = 0; x < bg->w; x += UINT32_T_BITS) {
+            int n = IM_MIN((int) UINT32_T_BITS, bg->w - x);
+            uint32_t bits = 0;
+
+            switch (img->pixfmt) {
+                case PIXFORMAT_GRAYSCALE: {
+                    uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y) + x;
+                    for (int i = 0; i < n; i++) {
+                        bits |= background_pixel(bg, state + x + i, row_ptr[i], learn) << i;
+                    }
+                    break;
+                }
+                case PIXFORMAT_RGB565: {
+                    uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y) + x;
+                    for (int i = 0; i < n; i++) {
+                        bits |= background_pixel(bg, state + x + i, COLOR_RGB565_TO_Y(row_ptr[i]), learn) << i;
+                    }
+                    break;
+                }
+                default: {
+                    for (int i = 0; i < n; i++) {
+                        bits |= background_pixel(bg, state + x + i, IM_TO_GS_PIXEL(img, x + i, y), learn) << i;
+                    }
+                    break;
+                }
+            }
+
+            mask_row_ptr[x >> UINT32_T_SHIFT] = bits;
+            count += __builtin_popcount(bits);
+        }
+    }
+
+    return count;
+}
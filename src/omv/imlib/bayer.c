@@ -57,37 +57,45 @@ pixformat_t imlib_bayer_shift(pixformat_t pixfmt, int x, int y, bool transpose)
     }
 }
 
-void imlib_debayer_line(int x_start, int x_end, int y_row, void *dst_row_ptr, pixformat_t pixfmt, image_t *src) {
-    int src_w = src->w, w_limit = src_w - 1, w_limit_m_1 = w_limit - 1;
-    int src_h = src->h, h_limit = src_h - 1, h_limit_m_1 = h_limit - 1;
+static inline uint8_t *debayer_row(uint8_t *data, int y, int w, int rows) {
+    return data + ((rows ? (y % rows) : y) * w);
+}
 
-    int y_row_odd = y_row & 1;
-    int y = (y_row / 2) * 2;
-    uint8_t *rowptr_grgr_0, *rowptr_bgbg_1, *rowptr_grgr_2, *rowptr_bgbg_3;
+// Gets the 4 rows around the row pair starting at the even row y, kept in bounds. The rows are
+// stored one after the other in data, or in a ring of that many rows if rows is not zero.
+static void debayer_row_ptrs(uint8_t **rowptr, int y, int src_w, int src_h, uint8_t *data, int rows) {
+    int h_limit = src_h - 1, h_limit_m_1 = h_limit - 1;
 
     // keep row pointers in bounds
     if (y == 0) {
-        rowptr_bgbg_1 = src->data;
-        rowptr_grgr_2 = rowptr_bgbg_1 + ((src_h >= 2) ? src_w : 0);
-        rowptr_bgbg_3 = rowptr_bgbg_1 + ((src_h >= 3) ? (src_w * 2) : 0);
-        rowptr_grgr_0 = rowptr_grgr_2;
+        rowptr[1] = debayer_row(data, 0, src_w, rows);
+        rowptr[2] = debayer_row(data, (src_h >= 2) ? 1 : 0, src_w, rows);
+        rowptr[3] = debayer_row(data, (src_h >= 3) ? 2 : 0, src_w, rows);
+        rowptr[0] = rowptr[2];
     } else if (y == h_limit_m_1) {
-        rowptr_grgr_0 = src->data + ((y - 1) * src_w);
-        rowptr_bgbg_1 = rowptr_grgr_0 + src_w;
-        rowptr_grgr_2 = rowptr_bgbg_1 + src_w;
-        rowptr_bgbg_3 = rowptr_bgbg_1;
+        rowptr[0] = debayer_row(data, y - 1, src_w, rows);
+        rowptr[1] = debayer_row(data, y, src_w, rows);
+        rowptr[2] = debayer_row(data, y + 1, src_w, rows);
+        rowptr[3] = rowptr[1];
     } else if (y >= h_limit) {
-        rowptr_grgr_0 = src->data + ((y - 1) * src_w);
-        rowptr_bgbg_1 = rowptr_grgr_0 + src_w;
-        rowptr_grgr_2 = rowptr_grgr_0;
-        rowptr_bgbg_3 = rowptr_bgbg_1;
+        rowptr[0] = debayer_row(data, y - 1, src_w, rows);
+        rowptr[1] = debayer_row(data, y, src_w, rows);
+        rowptr[2] = rowptr[0];
+        rowptr[3] = rowptr[1];
     } else {
         // get 4 neighboring rows
-        rowptr_grgr_0 = src->data + ((y - 1) * src_w);
-        rowptr_bgbg_1 = rowptr_grgr_0 + src_w;
-        rowptr_grgr_2 = rowptr_bgbg_1 + src_w;
-        rowptr_bgbg_3 = rowptr_grgr_2 + src_w;
+        rowptr[0] = debayer_row(data, y - 1, src_w, rows);
+        rowptr[1] = debayer_row(data, y, src_w, rows);
+        rowptr[2] = debayer_row(data, y + 1, src_w, rows);
+        rowptr[3] = debayer_row(data, y + 2, src_w, rows);
     }
+}
+
+static void debayer_line(int x_start, int x_end, int y_row_odd, uint8_t **rowptr, int src_w,
+                         pixformat_t src_pixfmt, void *dst_row_ptr, pixformat_t pixfmt) {
+    int w_limit = src_w - 1, w_limit_m_1 = w_limit - 1;
+    uint8_t *rowptr_grgr_0 = rowptr[0], *rowptr_bgbg_1 = rowptr[1];
+    uint8_t *rowptr_grgr_2 = rowptr[2], *rowptr_bgbg_3 = rowptr[3];
 
     // If the image is an odd width this will go for the last loop and we drop the last column.
     if (!y_row_odd) {
@@ -145,7 +153,7 @@ void imlib_debayer_line(int x_start, int x_end, int y_row, void *dst_row_ptr, pi
 
             int r_pixels_0, g_pixels_0, b_pixels_0;
 
-            switch (src->pixfmt) {
+            switch (src_pixfmt) {
                 case PIXFORMAT_BAYER_BGGR: {
                     #if defined(ARM_MATH_DSP)
                     int row_02 = __UHADD8(row_grgr_0, row_grgr_2);
@@ -353,7 +361,7 @@ void imlib_debayer_line(int x_start, int x_end, int y_row, void *dst_row_ptr, pi
 
             int r_pixels_1, g_pixels_1, b_pixels_1;
 
-            switch (src->pixfmt) {
+            switch (src_pixfmt) {
                 case PIXFORMAT_BAYER_BGGR: {
                     #if defined(ARM_MATH_DSP)
                     int row_13 = __UHADD8(row_bgbg_1, row_bgbg_3);
@@ -509,6 +517,12 @@ void imlib_debayer_line(int x_start, int x_end, int y_row, void *dst_row_ptr, pi
     }
 }
 
+void imlib_debayer_line(int x_start, int x_end, int y_row, void *dst_row_ptr, pixformat_t pixfmt, image_t *src) {
+    uint8_t *rowptr[4];
+    debayer_row_ptrs(rowptr, (y_row / 2) * 2, src->w, src->h, src->data, 0);
+    debayer_line(x_start, x_end, y_row & 1, rowptr, src->w, src->pixfmt, dst_row_ptr, pixfmt);
+}
+
 // Does no bounds checking on the destination. Destination must be mutable.
 void imlib_debayer_image(image_t *dst, image_t *src) {
     int src_w = src->w, w_limit = src_w - 1, w_limit_m_1 = w_limit - 1;
@@ -935,3 +949,53 @@ void imlib_debayer_image(image_t *dst, image_t *src) {
         }
     }
 }
+
+void imlib_debayer_stream_init(debayer_stream_t *stream, int w, int h, pixformat_t pixfmt, uint8_t *rows) {
+    stream->w = w;
+    stream->h = h;
+    stream->pixfmt = pixfmt;
+    stream->rows = rows;
+}
+
+static void debayer_stream_pair(debayer_stream_t *stream, int y, image_t *dst) {
+    uint8_t *rowptr[4];
+    debayer_row_ptrs(rowptr, y, stream->w, stream->h, stream->rows, DEBAYER_STREAM_ROWS);
+
+    for (int i = y, ii = IM_MIN(y + 2, stream->h); i < ii; i++) {
+        void *row_ptr = NULL;
+
+        switch (dst->pixfmt) {
+            case PIXFORMAT_BINARY: {
+                row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(dst, i);
+                break;
+            }
+            case PIXFORMAT_GRAYSCALE: {
+                row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(dst, i);
+                break;
+            }
+            case PIXFORMAT_RGB565: {
+                row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(dst, i);
+                break;
+            }
+            default: {
+                return;
+            }
+        }
+
+        debayer_line(0, stream->w, i & 1, rowptr, stream->w, stream->pixfmt, row_ptr, dst->pixfmt);
+    }
+}
+
+// Rows must be pushed in order starting from row 0. A row pair is debayered once the row after
+// it is pushed, the last pair once the last row is pushed. Matches imlib_debayer_image().
+void imlib_debayer_stream_push(debayer_stream_t *stream, int y, const uint8_t *src_row, image_t *dst) {
+    memcpy(stream->rows + ((y % DEBAYER_STREAM_ROWS) * stream->w), src_row, stream->w);
+
+    if ((y >= 2) && !(y % 2)) {
+        debayer_stream_pair(stream, y - 2, dst);
+    }
+
+    if (y == (stream->h - 1)) {
+        debayer_stream_pair(stream, (y / 2) * 2, dst);
+    }
+}
@@ -125,7 +125,45 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
     bmp.pixfmt = PIXFORMAT_BINARY;
     bmp.data = fb_alloc0(image_size(&bmp), FB_ALLOC_NO_HINT);
 
+    // With several thresholds all of them are tested at once per pixel using per-channel
+    // masks, a pixel is set if any threshold passes (or if any fails when inverted).
+    bool use_masks = (list_size(thresholds) > 1) && (list_size(thresholds) <= COLOR_THRESHOLDS_MASKS_MAX)
+                     && ((img->pixfmt == PIXFORMAT_GRAYSCALE) || (img->pixfmt == PIXFORMAT_RGB565));
+
+    if (use_masks) {
+        color_thresholds_masks_t *masks = fb_alloc(sizeof(color_thresholds_masks_t), FB_ALLOC_NO_HINT);
+        imlib_color_thresholds_masks_init(masks, thresholds);
+        uint32_t fail = invert ? masks->all : 0;
+
+        for (int y = 0, yy = img->h; y < yy; y++) {
+            uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+            if (img->pixfmt == PIXFORMAT_GRAYSCALE) {
+                uint8_t *old_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+                for (int x = 0, xx = img->w; x < xx; x++) {
+                    uint32_t mask = imlib_grayscale_thresholds_mask(masks, IMAGE_GET_GRAYSCALE_PIXEL_FAST(old_row_ptr, x));
+                    if (mask != fail) {
+                        IMAGE_SET_BINARY_PIXEL_FAST(bmp_row_ptr, x);
+                    }
+                }
+            } else {
+                uint16_t *old_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+                for (int x = 0, xx = img->w; x < xx; x++) {
+                    uint32_t mask = imlib_rgb565_thresholds_mask(masks, IMAGE_GET_RGB565_PIXEL_FAST(old_row_ptr, x));
+                    if (mask != fail) {
+                        IMAGE_SET_BINARY_PIXEL_FAST(bmp_row_ptr, x);
+                    }
+                }
+            }
+        }
+
+        fb_free(); // masks
+    }
+
     list_for_each(it, thresholds) {
+        if (use_masks) {
+            break;
+        }
+
         color_thresholds_list_lnk_data_t *lnk_data = list_get_data(it);
 
         switch (img->pixfmt) {
@@ -157,11 +195,7 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
                 for (int y = 0, yy = img->h; y < yy; y++) {
                     uint16_t *old_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
                     uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
-                    for (int x = 0, xx = img->w; x < xx; x++) {
-                        if (COLOR_THRESHOLD_RGB565(IMAGE_GET_RGB565_PIXEL_FAST(old_row_ptr, x), lnk_data, invert)) {
-                            IMAGE_SET_BINARY_PIXEL_FAST(bmp_row_ptr, x);
-                        }
-                    }
+                    imlib_rgb565_threshold_row(bmp_row_ptr, old_row_ptr, 0, img->w, lnk_data, invert);
                 }
                 break;
             }
@@ -346,7 +380,7 @@ void imlib_b_and_line_op(image_t *img, int line, void *other, void *data, bool v
 }
 
 void imlib_b_and(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_b_and_line_op, mask);
+    imlib_image_operation_mask(img, path, other, scalar, imlib_b_and_line_op, NULL, mask);
 }
 
 static void imlib_b_nand_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -456,7 +490,7 @@ static void imlib_b_nand_line_op(image_t *img, int line, void *other, void *data
 }
 
 void imlib_b_nand(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_b_nand_line_op, mask);
+    imlib_image_operation_mask(img, path, other, scalar, imlib_b_nand_line_op, NULL, mask);
 }
 
 void imlib_b_or_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -566,7 +600,7 @@ void imlib_b_or_line_op(image_t *img, int line, void *other, void *data, bool vf
 }
 
 void imlib_b_or(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_b_or_line_op, mask);
+    imlib_image_operation_mask(img, path, other, scalar, imlib_b_or_line_op, NULL, mask);
 }
 
 static void imlib_b_nor_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -676,7 +710,7 @@ static void imlib_b_nor_line_op(image_t *img, int line, void *other, void *data,
 }
 
 void imlib_b_nor(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_b_nor_line_op,  mask);
+    imlib_image_operation_mask(img, path, other, scalar, imlib_b_nor_line_op, NULL, mask);
 }
 
 void imlib_b_xor_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -786,7 +820,7 @@ void imlib_b_xor_line_op(image_t *img, int line, void *other, void *data, bool v
 }
 
 void imlib_b_xor(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_b_xor_line_op, mask);
+    imlib_image_operation_mask(img, path, other, scalar, imlib_b_xor_line_op, NULL, mask);
 }
 
 static void imlib_b_xnor_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -896,10 +930,130 @@ static void imlib_b_xnor_line_op(image_t *img, int line, void *other, void *data
 }
 
 void imlib_b_xnor(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_b_xnor_line_op, mask);
+    imlib_image_operation_mask(img, path, other, scalar, imlib_b_xnor_line_op, NULL, mask);
+}
+
+// dst[x] = src[x + s] for a binary row, fill is used past either end of the row.
+static void imlib_erode_dilate_shift(uint32_t *dst, const uint32_t *src, int words, int s, uint32_t fill) {
+    for (int i = 0; i < words; i++) {
+        int b = (i << UINT32_T_SHIFT) + s;
+        int q = b >> UINT32_T_SHIFT; // floor
+        int r = b & UINT32_T_MASK;
+        uint32_t lo = ((q >= 0) && (q < words)) ? src[q] : fill;
+        uint32_t hi = (((q + 1) >= 0) && ((q + 1) < words)) ? src[q + 1] : fill;
+        dst[i] = r ? ((lo >> r) | (hi << (UINT32_T_BITS - r))) : lo;
+    }
+}
+
+// Erodes (ANDs) or dilates (ORs) the ((ksize*2)+1) pixels around each pixel of a binary row.
+static void imlib_erode_dilate_row(uint32_t *dst, const uint32_t *src, uint32_t *tmp,
+                                   int w, int ksize, int e_or_d) {
+    int words = (w + UINT32_T_MASK) >> UINT32_T_SHIFT;
+    uint32_t fill = e_or_d ? 0 : 0xFFFFFFFF;
+
+    // Pixels past the end of the row must not change the result.
+    memcpy(dst, src, words * sizeof(uint32_t));
+    if (w & UINT32_T_MASK) {
+        uint32_t pad = 0xFFFFFFFF << (w & UINT32_T_MASK);
+        dst[words - 1] = e_or_d ? (dst[words - 1] & ~pad) : (dst[words - 1] | pad);
+    }
+
+    // The window is [x - ksize, x] combined with [x, x + ksize], each is grown by doubling
+    // its length so the edges of the row never need pixels from outside of it.
+    for (int dir = -1; dir <= 1; dir += 2) {
+        uint32_t *acc = tmp + ((dir > 0) * words);
+        memcpy(acc, dst, words * sizeof(uint32_t));
+
+        for (int len = 1; len <= ksize; ) {
+            int s = IM_MIN(len, ksize + 1 - len);
+            imlib_erode_dilate_shift(tmp + (2 * words), acc, words, dir * s, fill);
+            for (int i = 0; i < words; i++) {
+                acc[i] = e_or_d ? (acc[i] | tmp[(2 * words) + i]) : (acc[i] & tmp[(2 * words) + i]);
+            }
+            len += s;
+        }
+    }
+
+    for (int i = 0; i < words; i++) {
+        dst[i] = e_or_d ? (tmp[i] | tmp[words + i]) : (tmp[i] & tmp[words + i]);
+    }
+}
+
+// Binary images with the default threshold are eroded by ANDing (and dilated by ORing) 32
+// pixels at a time. The square kernel is separable, so each row is done first and then
+// the rows of each window are combined. Pixels outside of the image repeat the edge pixels,
+// which are already in the window, so they never change the result.
+static void imlib_erode_dilate_binary(image_t *img, int ksize, int e_or_d, image_t *mask) {
+    int words = IMAGE_BINARY_LINE_LEN(img);
+    int brows = (ksize * 2) + 1;
+    uint32_t *rows = fb_alloc(words * (brows + 5) * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    uint32_t *tmp = rows + (words * brows); // 3 rows
+    uint32_t *out = tmp + (words * 3);
+    uint32_t *sel = out + words;
+    mask_runs_t runs;
+
+    if (mask) {
+        imlib_mask_runs_init(&runs, mask, img->w, img->h, false);
+    }
+
+    for (int y = 0, yy = IM_MIN(ksize, img->h); y < yy; y++) {
+        imlib_erode_dilate_row(rows + ((y % brows) * words),
+                               IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y), tmp, img->w, ksize, e_or_d);
+    }
+
+    for (int y = 0; y < img->h; y++) {
+        uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
+
+        // Row (y + ksize) is still untouched as only rows <= y have been written.
+        if ((y + ksize) < img->h) {
+            imlib_erode_dilate_row(rows + (((y + ksize) % brows) * words),
+                                   IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y + ksize), tmp, img->w, ksize, e_or_d);
+        }
+
+        // Rows without mask pixels don't change.
+        if (mask && (MASK_RUNS_ROW_BEGIN(&runs, y) == MASK_RUNS_ROW_END(&runs, y))) {
+            continue;
+        }
+
+        int j_start = IM_MAX(y - ksize, 0);
+        int j_end = IM_MIN(y + ksize, img->h - 1);
+        memcpy(out, rows + ((j_start % brows) * words), words * sizeof(uint32_t));
+
+        for (int j = j_start + 1; j <= j_end; j++) {
+            uint32_t *k_row_ptr = rows + ((j % brows) * words);
+            for (int i = 0; i < words; i++) {
+                out[i] = e_or_d ? (out[i] | k_row_ptr[i]) : (out[i] & k_row_ptr[i]);
+            }
+        }
+
+        // Only update the valid (and masked) pixels.
+        if (mask) {
+            imlib_mask_runs_row_bits(&runs, y, sel);
+        } else {
+            memset(sel, 0xFF, words * sizeof(uint32_t));
+            if (img->w & UINT32_T_MASK) {
+                sel[words - 1] = ~(0xFFFFFFFF << (img->w & UINT32_T_MASK));
+            }
+        }
+
+        for (int i = 0; i < words; i++) {
+            row_ptr[i] = (row_ptr[i] & ~sel[i]) | (out[i] & sel[i]);
+        }
+    }
+
+    if (mask) {
+        imlib_mask_runs_free(&runs);
+    }
+    fb_free(); // rows
 }
 
 static void imlib_erode_dilate(image_t *img, int ksize, int threshold, int e_or_d, image_t *mask) {
+    // Erode normally requires all pixels to be set and dilate normally requires one.
+    if ((img->pixfmt == PIXFORMAT_BINARY) && (threshold == (e_or_d ? 0 : (imlib_ksize_to_n(ksize) - 1)))) {
+        imlib_erode_dilate_binary(img, ksize, e_or_d, mask);
+        return;
+    }
+
     int brows = ksize + 1;
     image_t buf;
     buf.w = img->w;
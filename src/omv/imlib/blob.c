@@ -9,6 +9,7 @@
  * Blob detection code.
  */
 #include "imlib.h"
+#include "trace.h"
 
 typedef struct xylr {
     int16_t x, y, l, r, t_l, b_l;
@@ -122,12 +123,293 @@ static float calc_roundness(float blob_a, float blob_b, float blob_c) {
     return IM_DIV(roundness_min, roundness_max);
 }
 
+// Seed bitmap pre-pass. Marks every sampled (x/y stride) pixel in the roi that passes the
+// threshold so the blob scan below can skip whole words of non-matching/visited pixels.
+static void find_blobs_seeds(image_t *seeds, image_t *ptr, rectangle_t *roi, unsigned int x_stride,
+                             unsigned int y_stride, color_thresholds_list_lnk_data_t *lnk_data, bool invert) {
+    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
+        uint32_t *seed_row = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(seeds, y);
+        memset(seed_row, 0, IMAGE_BINARY_LINE_LEN_BYTES(seeds));
+        int x = roi->x + (y % x_stride), xx = roi->x + roi->w;
+
+        switch (ptr->pixfmt) {
+            case PIXFORMAT_BINARY: {
+                uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(ptr, y);
+                if (x_stride == 1) {
+                    // Thresholding a 1-bit pixel is a fixed function of its value.
+                    uint32_t pass_0 = COLOR_THRESHOLD_BINARY(0, lnk_data, invert) ? 0xFFFFFFFF : 0;
+                    uint32_t pass_1 = COLOR_THRESHOLD_BINARY(1, lnk_data, invert) ? 0xFFFFFFFF : 0;
+                    for (int i = x >> UINT32_T_SHIFT, ii = (xx - 1) >> UINT32_T_SHIFT; i <= ii; i++) {
+                        uint32_t mask = 0xFFFFFFFF;
+                        if (i == (x >> UINT32_T_SHIFT)) {
+                            mask &= 0xFFFFFFFF << (x & UINT32_T_MASK);
+                        }
+                        if (i == ii) {
+                            mask &= 0xFFFFFFFF >> (UINT32_T_MASK - ((xx - 1) & UINT32_T_MASK));
+                        }
+                        seed_row[i] = ((row_ptr[i] & pass_1) | (~row_ptr[i] & pass_0)) & mask;
+                    }
+                } else {
+                    for (; x < xx; x += x_stride) {
+                        if (COLOR_THRESHOLD_BINARY(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
+                            IMAGE_SET_BINARY_PIXEL_FAST(seed_row, x);
+                        }
+                    }
+                }
+                break;
+            }
+            case PIXFORMAT_GRAYSCALE: {
+                uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(ptr, y);
+                #if defined(ARM_MATH_DSP)
+                if (x_stride == 1) {
+                    uint32_t l_min = lnk_data->LMin * 0x01010101;
+                    uint32_t l_max = lnk_data->LMax * 0x01010101;
+                    uint32_t flip = invert ? 0xF : 0;
+
+                    for (; (x < xx) && (x & 3); x++) {
+                        if (COLOR_THRESHOLD_GRAYSCALE(IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
+                            IMAGE_SET_BINARY_PIXEL_FAST(seed_row, x);
+                        }
+                    }
+
+                    // Compare 4 pixels at a time using the GE flags (p >= min and max >= p).
+                    for (; (x + 3) < xx; x += 4) {
+                        uint32_t pixels = *((uint32_t *) (row_ptr + x));
+                        __USUB8(pixels, l_min);
+                        uint32_t ge = __SEL(0xFFFFFFFF, 0);
+                        __USUB8(l_max, pixels);
+                        ge = __SEL(ge, 0);
+                        // Gather one bit per byte into the low nibble.
+                        uint32_t bits = (((ge & 0x08040201) * 0x01010101) >> 24) ^ flip;
+                        seed_row[x >> UINT32_T_SHIFT] |= bits << (x & UINT32_T_MASK);
+                    }
+                }
+                #endif
+                for (; x < xx; x += x_stride) {
+                    if (COLOR_THRESHOLD_GRAYSCALE(IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
+                        IMAGE_SET_BINARY_PIXEL_FAST(seed_row, x);
+                    }
+                }
+                break;
+            }
+            case PIXFORMAT_RGB565: {
+                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(ptr, y);
+                if (x_stride == 1) {
+                    imlib_rgb565_threshold_row(seed_row, row_ptr, x, xx, lnk_data, invert);
+                    break;
+                }
+                for (; x < xx; x += x_stride) {
+                    if (COLOR_THRESHOLD_RGB565(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
+                        IMAGE_SET_BINARY_PIXEL_FAST(seed_row, x);
+                    }
+                }
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+}
+
+// Returns the next seed on the row at or after x which has not been visited yet, or xx if none.
+// Without a seed bitmap this returns the next sampled column instead (x_stride phase).
+static inline int find_blobs_next_seed(uint32_t *seed_row, uint32_t *bmp_row, int x, int xx,
+                                       int phase, unsigned int x_stride) {
+    if (!seed_row) {
+        if (x <= phase) {
+            return IM_MIN(phase, xx);
+        }
+        int rem = (x - phase) % x_stride;
+        x += rem ? (x_stride - rem) : 0;
+        return IM_MIN(x, xx);
+    }
+
+    if (x >= xx) {
+        return xx;
+    }
+
+    int i = x >> UINT32_T_SHIFT;
+    uint32_t word = seed_row[i] & ~bmp_row[i] & (0xFFFFFFFF << (x & UINT32_T_MASK));
+
+    while (!word) {
+        if ((++i << UINT32_T_SHIFT) >= xx) {
+            return xx;
+        }
+        word = seed_row[i] & ~bmp_row[i];
+    }
+
+    x = (i << UINT32_T_SHIFT) + __builtin_ctz(word);
+    return IM_MIN(x, xx);
+}
+
+static void find_blobs_merge(find_blobs_list_lnk_data_t *dst, find_blobs_list_lnk_data_t *src,
+                             unsigned int x_hist_bins_max, unsigned int y_hist_bins_max) {
+    // Have to merge these first before merging rects.
+    if (x_hist_bins_max) {
+        merge_bins(dst->rect.x,
+                   dst->rect.x + dst->rect.w - 1,
+                   &dst->x_hist_bins,
+                   &dst->x_hist_bins_count,
+                   src->rect.x,
+                   src->rect.x + src->rect.w - 1,
+                   &src->x_hist_bins,
+                   &src->x_hist_bins_count,
+                   x_hist_bins_max);
+    }
+    if (y_hist_bins_max) {
+        merge_bins(dst->rect.y,
+                   dst->rect.y + dst->rect.h - 1,
+                   &dst->y_hist_bins,
+                   &dst->y_hist_bins_count,
+                   src->rect.y,
+                   src->rect.y + src->rect.h - 1,
+                   &src->y_hist_bins,
+                   &src->y_hist_bins_count,
+                   y_hist_bins_max);
+    }
+    // Merge corners...
+    for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
+        float z_dst = (dst->corners[i].x * cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i]) +
+                      (dst->corners[i].y * sin_table[FIND_BLOBS_ANGLE_RESOLUTION * i]);
+        float z_src = (src->corners[i].x * cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i]) +
+                      (src->corners[i].y * cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i]);
+        if (z_src < z_dst) {
+            dst->corners[i].x = src->corners[i].x;
+            dst->corners[i].y = src->corners[i].y;
+        }
+    }
+    // Merge rects...
+    rectangle_united(&dst->rect, &src->rect);
+    // Merge counters...
+    dst->pixels += src->pixels; // won't overflow
+    dst->perimeter += src->perimeter; // won't overflow
+    dst->code |= src->code; // won't overflow
+    dst->count += src->count; // won't overflow
+    // Merge accumulators...
+    dst->centroid_x_acc += src->centroid_x_acc;
+    dst->centroid_y_acc += src->centroid_y_acc;
+    dst->rotation_acc_x += src->rotation_acc_x;
+    dst->rotation_acc_y += src->rotation_acc_y;
+    dst->roundness_acc += src->roundness_acc;
+    // Compute current values...
+    dst->centroid_x = dst->centroid_x_acc / dst->pixels;
+    dst->centroid_y = dst->centroid_y_acc / dst->pixels;
+    dst->rotation = fast_atan2f(dst->rotation_acc_y / dst->pixels,
+                                dst->rotation_acc_x / dst->pixels);
+    dst->roundness = dst->roundness_acc / dst->pixels;
+}
+
+static int find_blobs_compare_x(const void *a, const void *b) {
+    const find_blobs_list_lnk_data_t *blob_a = list_get_data((*((list_lnk_t **) a)));
+    const find_blobs_list_lnk_data_t *blob_b = list_get_data((*((list_lnk_t **) b)));
+    return blob_a->rect.x - blob_b->rect.x;
+}
+
+static size_t find_blobs_find_root(size_t *parent, size_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// Merges blobs whose rects (grown by margin) overlap until no more merge. Blobs are swept in x
+// order so only neighbours are compared, and merged into the root of their union-find set.
+// Merged rects can grow to overlap blobs the sweep already passed, so passes repeat until one
+// merges nothing.
+static void find_blobs_merge_all(list_t *out, int margin,
+                                 bool (*merge_cb) (void *, find_blobs_list_lnk_data_t *, find_blobs_list_lnk_data_t *),
+                                 void *merge_cb_arg, unsigned int x_hist_bins_max, unsigned int y_hist_bins_max) {
+    size_t n = list_size(out);
+
+    if (n < 2) {
+        return;
+    }
+
+    list_lnk_t **lnks = fb_alloc(n * sizeof(list_lnk_t *), FB_ALLOC_NO_HINT);
+    size_t *parent = fb_alloc(n * sizeof(size_t), FB_ALLOC_NO_HINT);
+
+    for (bool merge_occured = true; merge_occured && (n > 1);) {
+        merge_occured = false;
+
+        size_t i = 0;
+        list_for_each(it, out) {
+            lnks[i++] = it;
+        }
+
+        qsort(lnks, n, sizeof(list_lnk_t *), find_blobs_compare_x);
+
+        for (i = 0; i < n; i++) {
+            parent[i] = i;
+        }
+
+        for (i = 0; i < n; i++) {
+            find_blobs_list_lnk_data_t *blob = list_get_data(lnks[i]);
+            int x_end = blob->rect.x + blob->rect.w + IM_MAX(margin, 0);
+
+            for (size_t j = i + 1; j < n; j++) {
+                find_blobs_list_lnk_data_t *tmp_blob = list_get_data(lnks[j]);
+
+                if (tmp_blob->rect.x >= x_end) {
+                    break;
+                }
+
+                size_t root_i = find_blobs_find_root(parent, i);
+                size_t root_j = find_blobs_find_root(parent, j);
+
+                if (root_i == root_j) {
+                    continue;
+                }
+
+                find_blobs_list_lnk_data_t *dst = list_get_data(lnks[root_i]);
+                find_blobs_list_lnk_data_t *src = list_get_data(lnks[root_j]);
+
+                rectangle_t temp;
+                temp.x = __SSAT(src->rect.x - margin, 16);
+                temp.y = __SSAT(src->rect.y - margin, 16);
+                temp.w = __USAT(src->rect.w + (margin * 2), 15);
+                temp.h = __USAT(src->rect.h + (margin * 2), 15);
+
+                if (rectangle_overlap(&dst->rect, &temp)
+                    && ((merge_cb_arg == NULL) || merge_cb(merge_cb_arg, dst, src))) {
+                    find_blobs_merge(dst, src, x_hist_bins_max, y_hist_bins_max);
+                    parent[root_j] = root_i;
+                    merge_occured = true;
+                }
+            }
+        }
+
+        // Merged blobs are removed, the others keep their order in the list.
+        size_t count = 0;
+        for (i = 0; i < n; i++) {
+            if (parent[i] != i) {
+                list_remove(out, lnks[i], NULL);
+            } else {
+                count += 1;
+            }
+        }
+
+        n = count;
+    }
+
+    fb_free(); // parent
+    fb_free(); // lnks
+}
+
 void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int x_stride, unsigned int y_stride,
                       list_t *thresholds, bool invert, unsigned int area_threshold, unsigned int pixels_threshold,
                       bool merge, int margin,
                       bool (*threshold_cb) (void *, find_blobs_list_lnk_data_t *), void *threshold_cb_arg,
                       bool (*merge_cb) (void *, find_blobs_list_lnk_data_t *, find_blobs_list_lnk_data_t *), void *merge_cb_arg,
-                      unsigned int x_hist_bins_max, unsigned int y_hist_bins_max) {
+                      unsigned int x_hist_bins_max, unsigned int y_hist_bins_max, unsigned int properties,
+                      pool_t *pool) {
+    TRACE_PROF_SCOPE(TRACE_PROF_FIND_BLOBS);
+
+    // Without FIND_BLOBS_PROP_CORNERS only the 4 bounding corners (the rect) are tracked.
+    int corners_step = (properties & FIND_BLOBS_PROP_CORNERS) ? 1 : (FIND_BLOBS_CORNERS_RESOLUTION / 4);
+    bool moments = properties & FIND_BLOBS_PROP_MOMENTS;
+
     // Same size as the image so we don't have to translate.
     image_t bmp;
     bmp.w = ptr->w;
@@ -135,6 +417,16 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
     bmp.pixfmt = PIXFORMAT_BINARY;
     bmp.data = fb_alloc0(image_size(&bmp), FB_ALLOC_NO_HINT);
 
+    // Optional seed bitmap, the scan falls back to testing every sampled pixel without it.
+    image_t seeds;
+    seeds.w = ptr->w;
+    seeds.h = ptr->h;
+    seeds.pixfmt = PIXFORMAT_BINARY;
+    seeds.data = NULL;
+    if (fb_avail() >= (image_size(&seeds) + (ptr->w * sizeof(uint16_t)) + (ptr->h * sizeof(uint16_t)) + 1024)) {
+        seeds.data = fb_alloc(image_size(&seeds), FB_ALLOC_PREFER_SPEED);
+    }
+
     uint16_t *x_hist_bins = NULL;
     if (x_hist_bins_max) {
         x_hist_bins = fb_alloc(ptr->w * sizeof(uint16_t), FB_ALLOC_NO_HINT);
@@ -149,18 +441,29 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
     size_t lifo_len;
     lifo_alloc_all(&lifo, &lifo_len, sizeof(xylr_t));
 
-    list_init(out, sizeof(find_blobs_list_lnk_data_t));
+    list_init_pool(out, sizeof(find_blobs_list_lnk_data_t), pool);
 
     size_t code = 0;
     list_for_each(it, thresholds) {
         color_thresholds_list_lnk_data_t *lnk_data = list_get_data(it);
+        uint32_t *seed_row_ptr = NULL;
+
+        if (seeds.data) {
+            find_blobs_seeds(&seeds, ptr, roi, x_stride, y_stride, lnk_data, invert);
+        }
 
         switch (ptr->pixfmt) {
             case PIXFORMAT_BINARY: {
                 for (int y = roi->y, yy = roi->y + roi->h, y_max = yy - 1; y < yy; y += y_stride) {
                     uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(ptr, y);
                     uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
-                    for (int x = roi->x + (y % x_stride), xx = roi->x + roi->w, x_max = xx - 1; x < xx; x += x_stride) {
+                    int x_phase = roi->x + (y % x_stride);
+                    if (seeds.data) {
+                        seed_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&seeds, y);
+                    }
+                    for (int xx = roi->x + roi->w, x_max = xx - 1,
+                         x = find_blobs_next_seed(seed_row_ptr, bmp_row_ptr, roi->x, xx, x_phase, x_stride); x < xx;
+                         x = find_blobs_next_seed(seed_row_ptr, bmp_row_ptr, x + 1, xx, x_phase, x_stride)) {
                         if ((!IMAGE_GET_BINARY_PIXEL_FAST(bmp_row_ptr, x))
                             && COLOR_THRESHOLD_BINARY(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
                             int old_x = x;
@@ -170,7 +473,7 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                             point_t corners[FIND_BLOBS_CORNERS_RESOLUTION];
                             int corners_n[FIND_BLOBS_CORNERS_RESOLUTION];
                             // These values are initialized to their maximum before we minimize.
-                            for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
+                            for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i += corners_step) {
                                 corners[i].x =
                                     IM_CLAMP(x_max * sign(cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i]), 0, x_max);
                                 corners[i].y =
@@ -221,11 +524,10 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                                 }
 
                                 int sum = sum_m_to_n(left, right);
-                                int sum_2 = sum_2_m_to_n(left, right);
                                 int cnt = right - left + 1;
                                 int avg = sum / cnt;
 
-                                for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
+                                for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i += corners_step) {
                                     int x_new = (cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i] > 0) ? left :
                                                 ((cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i] == 0) ? avg :
                                                  right);
@@ -247,9 +549,11 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                                 blob_perimeter += 2;
                                 blob_cx += sum;
                                 blob_cy += y * cnt;
-                                blob_a += sum_2;
-                                blob_b += y * sum;
-                                blob_c += y * y * cnt;
+                                if (moments) {
+                                    blob_a += sum_2_m_to_n(left, right);
+                                    blob_b += y * sum;
+                                    blob_c += y * y * cnt;
+                                }
 
                                 if (y_hist_bins) {
                                     y_hist_bins[y] += cnt;
@@ -361,6 +665,11 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                                 }
                             }
 
+                            // Untracked corners take the value of the bounding corner before them.
+                            for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
+                                corners[i] = corners[i - (i % corners_step)];
+                            }
+
                             rectangle_t rect;
                             rect.x = corners[(FIND_BLOBS_CORNERS_RESOLUTION * 0) / 4].x; // l
                             rect.y = corners[(FIND_BLOBS_CORNERS_RESOLUTION * 1) / 4].y; // t
@@ -403,9 +712,9 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                                 lnk_blob.centroid_x = b_mx;
                                 lnk_blob.centroid_y = b_my;
                                 lnk_blob.rotation =
-                                    (small_blob_a !=
-                                     small_blob_c) ? (fast_atan2f(2 * small_blob_b, small_blob_a - small_blob_c) / 2.0f) : 0.0f;
-                                lnk_blob.roundness = calc_roundness(small_blob_a, small_blob_b, small_blob_c);
+                                    (moments && (small_blob_a != small_blob_c)) ?
+                                    (fast_atan2f(2 * small_blob_b, small_blob_a - small_blob_c) / 2.0f) : 0.0f;
+                                lnk_blob.roundness = moments ? calc_roundness(small_blob_a, small_blob_b, small_blob_c) : 0.0f;
                                 lnk_blob.x_hist_bins_count = 0;
                                 lnk_blob.x_hist_bins = NULL;
                                 lnk_blob.y_hist_bins_count = 0;
@@ -466,7 +775,13 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                 for (int y = roi->y, yy = roi->y + roi->h, y_max = yy - 1; y < yy; y += y_stride) {
                     uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(ptr, y);
                     uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
-                    for (int x = roi->x + (y % x_stride), xx = roi->x + roi->w, x_max = xx - 1; x < xx; x += x_stride) {
+                    int x_phase = roi->x + (y % x_stride);
+                    if (seeds.data) {
+                        seed_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&seeds, y);
+                    }
+                    for (int xx = roi->x + roi->w, x_max = xx - 1,
+                         x = find_blobs_next_seed(seed_row_ptr, bmp_row_ptr, roi->x, xx, x_phase, x_stride); x < xx;
+                         x = find_blobs_next_seed(seed_row_ptr, bmp_row_ptr, x + 1, xx, x_phase, x_stride)) {
                         if ((!IMAGE_GET_BINARY_PIXEL_FAST(bmp_row_ptr, x))
                             && COLOR_THRESHOLD_GRAYSCALE(IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
                             int old_x = x;
@@ -476,7 +791,7 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                             point_t corners[FIND_BLOBS_CORNERS_RESOLUTION];
                             int corners_n[FIND_BLOBS_CORNERS_RESOLUTION];
                             // These values are initialized to their maximum before we minimize.
-                            for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
+                            for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i += corners_step) {
                                 corners[i].x =
                                     IM_CLAMP(x_max * sign(cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i]), 0, x_max);
                                 corners[i].y =
@@ -527,11 +842,10 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                                 }
 
                                 int sum = sum_m_to_n(left, right);
-                                int sum_2 = sum_2_m_to_n(left, right);
                                 int cnt = right - left + 1;
                                 int avg = sum / cnt;
 
-                                for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
+                                for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i += corners_step) {
                                     int x_new = (cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i] > 0) ? left :
                                                 ((cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i] == 0) ? avg :
                                                  right);
@@ -553,9 +867,11 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                                 blob_perimeter += 2;
                                 blob_cx += sum;
                                 blob_cy += y * cnt;
-                                blob_a += sum_2;
-                                blob_b += y * sum;
-                                blob_c += y * y * cnt;
+                                if (moments) {
+                                    blob_a += sum_2_m_to_n(left, right);
+                                    blob_b += y * sum;
+                                    blob_c += y * y * cnt;
+                                }
 
                                 if (y_hist_bins) {
                                     y_hist_bins[y] += cnt;
@@ -667,6 +983,11 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                                 }
                             }
 
+                            // Untracked corners take the value of the bounding corner before them.
+                            for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
+                                corners[i] = corners[i - (i % corners_step)];
+                            }
+
                             rectangle_t rect;
                             rect.x = corners[(FIND_BLOBS_CORNERS_RESOLUTION * 0) / 4].x; // l
                             rect.y = corners[(FIND_BLOBS_CORNERS_RESOLUTION * 1) / 4].y; // t
@@ -709,9 +1030,9 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                                 lnk_blob.centroid_x = b_mx;
                                 lnk_blob.centroid_y = b_my;
                                 lnk_blob.rotation =
-                                    (small_blob_a !=
-                                     small_blob_c) ? (fast_atan2f(2 * small_blob_b, small_blob_a - small_blob_c) / 2.0f) : 0.0f;
-                                lnk_blob.roundness = calc_roundness(small_blob_a, small_blob_b, small_blob_c);
+                                    (moments && (small_blob_a != small_blob_c)) ?
+                                    (fast_atan2f(2 * small_blob_b, small_blob_a - small_blob_c) / 2.0f) : 0.0f;
+                                lnk_blob.roundness = moments ? calc_roundness(small_blob_a, small_blob_b, small_blob_c) : 0.0f;
                                 lnk_blob.x_hist_bins_count = 0;
                                 lnk_blob.x_hist_bins = NULL;
                                 lnk_blob.y_hist_bins_count = 0;
@@ -772,7 +1093,13 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                 for (int y = roi->y, yy = roi->y + roi->h, y_max = yy - 1; y < yy; y += y_stride) {
                     uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(ptr, y);
                     uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
-                    for (int x = roi->x + (y % x_stride), xx = roi->x + roi->w, x_max = xx - 1; x < xx; x += x_stride) {
+                    int x_phase = roi->x + (y % x_stride);
+                    if (seeds.data) {
+                        seed_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&seeds, y);
+                    }
+                    for (int xx = roi->x + roi->w, x_max = xx - 1,
+                         x = find_blobs_next_seed(seed_row_ptr, bmp_row_ptr, roi->x, xx, x_phase, x_stride); x < xx;
+                         x = find_blobs_next_seed(seed_row_ptr, bmp_row_ptr, x + 1, xx, x_phase, x_stride)) {
                         if ((!IMAGE_GET_BINARY_PIXEL_FAST(bmp_row_ptr, x))
                             && COLOR_THRESHOLD_RGB565(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
                             int old_x = x;
@@ -782,7 +1109,7 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                             point_t corners[FIND_BLOBS_CORNERS_RESOLUTION];
                             int corners_n[FIND_BLOBS_CORNERS_RESOLUTION];
                             // Ensures that maximum goes all the way to the edge of the image.
-                            for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
+                            for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i += corners_step) {
                                 corners[i].x =
                                     IM_CLAMP(x_max * sign(cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i]), 0, x_max);
                                 corners[i].y =
@@ -833,11 +1160,10 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                                 }
 
                                 int sum = sum_m_to_n(left, right);
-                                int sum_2 = sum_2_m_to_n(left, right);
                                 int cnt = right - left + 1;
                                 int avg = sum / cnt;
 
-                                for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
+                                for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i += corners_step) {
                                     int x_new = (cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i] > 0) ? left :
                                                 ((cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i] == 0) ? avg :
                                                  right);
@@ -859,9 +1185,11 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                                 blob_perimeter += 2;
                                 blob_cx += sum;
                                 blob_cy += y * cnt;
-                                blob_a += sum_2;
-                                blob_b += y * sum;
-                                blob_c += y * y * cnt;
+                                if (moments) {
+                                    blob_a += sum_2_m_to_n(left, right);
+                                    blob_b += y * sum;
+                                    blob_c += y * y * cnt;
+                                }
 
                                 if (y_hist_bins) {
                                     y_hist_bins[y] += cnt;
@@ -973,6 +1301,11 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                                 }
                             }
 
+                            // Untracked corners take the value of the bounding corner before them.
+                            for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
+                                corners[i] = corners[i - (i % corners_step)];
+                            }
+
                             rectangle_t rect;
                             rect.x = corners[(FIND_BLOBS_CORNERS_RESOLUTION * 0) / 4].x; // l
                             rect.y = corners[(FIND_BLOBS_CORNERS_RESOLUTION * 1) / 4].y; // t
@@ -1015,9 +1348,9 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                                 lnk_blob.centroid_x = b_mx;
                                 lnk_blob.centroid_y = b_my;
                                 lnk_blob.rotation =
-                                    (small_blob_a !=
-                                     small_blob_c) ? (fast_atan2f(2 * small_blob_b, small_blob_a - small_blob_c) / 2.0f) : 0.0f;
-                                lnk_blob.roundness = calc_roundness(small_blob_a, small_blob_b, small_blob_c);
+                                    (moments && (small_blob_a != small_blob_c)) ?
+                                    (fast_atan2f(2 * small_blob_b, small_blob_a - small_blob_c) / 2.0f) : 0.0f;
+                                lnk_blob.roundness = moments ? calc_roundness(small_blob_a, small_blob_b, small_blob_c) : 0.0f;
                                 lnk_blob.x_hist_bins_count = 0;
                                 lnk_blob.x_hist_bins = NULL;
                                 lnk_blob.y_hist_bins_count = 0;
@@ -1089,99 +1422,13 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
     if (x_hist_bins) {
         fb_free();
     }
+    if (seeds.data) {
+        fb_free();
+    }
     fb_free(); // bitmap
 
     if (merge) {
-        for (;;) {
-            bool merge_occured = false;
-
-            list_t out_temp;
-            list_init(&out_temp, sizeof(find_blobs_list_lnk_data_t));
-
-            while (list_size(out)) {
-                find_blobs_list_lnk_data_t lnk_blob;
-                list_pop_front(out, &lnk_blob);
-
-                for (size_t k = 0, l = list_size(out); k < l; k++) {
-                    find_blobs_list_lnk_data_t tmp_blob;
-                    list_pop_front(out, &tmp_blob);
-
-                    rectangle_t temp;
-                    temp.x = __SSAT(tmp_blob.rect.x - margin, 16);
-                    temp.y = __SSAT(tmp_blob.rect.y - margin, 16);
-                    temp.w = __USAT(tmp_blob.rect.w + (margin * 2), 15);
-                    temp.h = __USAT(tmp_blob.rect.h + (margin * 2), 15);
-
-                    if (rectangle_overlap(&(lnk_blob.rect), &temp)
-                        && ((merge_cb_arg == NULL) || merge_cb(merge_cb_arg, &lnk_blob, &tmp_blob))) {
-                        // Have to merge these first before merging rects.
-                        if (x_hist_bins_max) {
-                            merge_bins(lnk_blob.rect.x,
-                                       lnk_blob.rect.x + lnk_blob.rect.w - 1,
-                                       &lnk_blob.x_hist_bins,
-                                       &lnk_blob.x_hist_bins_count,
-                                       tmp_blob.rect.x,
-                                       tmp_blob.rect.x + tmp_blob.rect.w - 1,
-                                       &tmp_blob.x_hist_bins,
-                                       &tmp_blob.x_hist_bins_count,
-                                       x_hist_bins_max);
-                        }
-                        if (y_hist_bins_max) {
-                            merge_bins(lnk_blob.rect.y,
-                                       lnk_blob.rect.y + lnk_blob.rect.h - 1,
-                                       &lnk_blob.y_hist_bins,
-                                       &lnk_blob.y_hist_bins_count,
-                                       tmp_blob.rect.y,
-                                       tmp_blob.rect.y + tmp_blob.rect.h - 1,
-                                       &tmp_blob.y_hist_bins,
-                                       &tmp_blob.y_hist_bins_count,
-                                       y_hist_bins_max);
-                        }
-                        // Merge corners...
-                        for (int i = 0; i < FIND_BLOBS_CORNERS_RESOLUTION; i++) {
-                            float z_dst = (lnk_blob.corners[i].x * cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i]) +
-                                          (lnk_blob.corners[i].y * sin_table[FIND_BLOBS_ANGLE_RESOLUTION * i]);
-                            float z_src = (tmp_blob.corners[i].x * cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i]) +
-                                          (tmp_blob.corners[i].y * cos_table[FIND_BLOBS_ANGLE_RESOLUTION * i]);
-                            if (z_src < z_dst) {
-                                lnk_blob.corners[i].x = tmp_blob.corners[i].x;
-                                lnk_blob.corners[i].y = tmp_blob.corners[i].y;
-                            }
-                        }
-                        // Merge rects...
-                        rectangle_united(&(lnk_blob.rect), &(tmp_blob.rect));
-                        // Merge counters...
-                        lnk_blob.pixels += tmp_blob.pixels; // won't overflow
-                        lnk_blob.perimeter += tmp_blob.perimeter; // won't overflow
-                        lnk_blob.code |= tmp_blob.code; // won't overflow
-                        lnk_blob.count += tmp_blob.count; // won't overflow
-                        // Merge accumulators...
-                        lnk_blob.centroid_x_acc += tmp_blob.centroid_x_acc;
-                        lnk_blob.centroid_y_acc += tmp_blob.centroid_y_acc;
-                        lnk_blob.rotation_acc_x += tmp_blob.rotation_acc_x;
-                        lnk_blob.rotation_acc_y += tmp_blob.rotation_acc_y;
-                        lnk_blob.roundness_acc += tmp_blob.roundness_acc;
-                        // Compute current values...
-                        lnk_blob.centroid_x = lnk_blob.centroid_x_acc / lnk_blob.pixels;
-                        lnk_blob.centroid_y = lnk_blob.centroid_y_acc / lnk_blob.pixels;
-                        lnk_blob.rotation = fast_atan2f(lnk_blob.rotation_acc_y / lnk_blob.pixels,
-                                                        lnk_blob.rotation_acc_x / lnk_blob.pixels);
-                        lnk_blob.roundness = lnk_blob.roundness_acc / lnk_blob.pixels;
-                        merge_occured = true;
-                    } else {
-                        list_push_back(out, &tmp_blob);
-                    }
-                }
-
-                list_push_back(&out_temp, &lnk_blob);
-            }
-
-            list_copy(out, &out_temp);
-
-            if (!merge_occured) {
-                break;
-            }
-        }
+        find_blobs_merge_all(out, margin, merge_cb, merge_cb_arg, x_hist_bins_max, y_hist_bins_max);
     }
 }
 
@@ -1215,9 +1462,7 @@ void imlib_flood_fill_int(image_t *out, image_t *img, int x, int y,
                     right++;
                 }
 
-                for (int i = left; i <= right; i++) {
-                    IMAGE_SET_BINARY_PIXEL_FAST(out_row, i);
-                }
+                imlib_binary_fill_row(out_row, left, right + 1, 1);
 
                 int top_left = left;
                 int bot_left = left;
@@ -1332,9 +1577,7 @@ void imlib_flood_fill_int(image_t *out, image_t *img, int x, int y,
                     right++;
                 }
 
-                for (int i = left; i <= right; i++) {
-                    IMAGE_SET_BINARY_PIXEL_FAST(out_row, i);
-                }
+                imlib_binary_fill_row(out_row, left, right + 1, 1);
 
                 int top_left = left;
                 int bot_left = left;
@@ -1449,9 +1692,7 @@ void imlib_flood_fill_int(image_t *out, image_t *img, int x, int y,
                     right++;
                 }
 
-                for (int i = left; i <= right; i++) {
-                    IMAGE_SET_BINARY_PIXEL_FAST(out_row, i);
-                }
+                imlib_binary_fill_row(out_row, left, right + 1, 1);
 
                 int top_left = left;
                 int bot_left = left;
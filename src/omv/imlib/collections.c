@@ -33,6 +33,10 @@ void bitmap_bit_set(bitmap_t *ptr, size_t index) {
     ptr->data[index >> CHAR_SHIFT] |= 1 << (index & CHAR_MASK);
 }
 
+void bitmap_bit_reset(bitmap_t *ptr, size_t index) {
+    ptr->data[index >> CHAR_SHIFT] &= ~(1 << (index & CHAR_MASK));
+}
+
 bool bitmap_bit_get(bitmap_t *ptr, size_t index) {
     return (ptr->data[index >> CHAR_SHIFT] >> (index & CHAR_MASK)) & 1;
 }
@@ -179,12 +183,78 @@ void fifo_peek(fifo_t *ptr, void *data) {
     memcpy(data, ptr->data + (ptr->tail * ptr->data_len), ptr->data_len);
 }
 
+// Pool
+void pool_alloc(pool_t *ptr, size_t size, size_t block_len) {
+    ptr->size = size;
+    ptr->block_len = ((block_len + sizeof(void *) - 1) / sizeof(void *)) * sizeof(void *);
+    ptr->data = (char *) fb_alloc(size * ptr->block_len, FB_ALLOC_NO_HINT);
+    pool_clear(ptr);
+}
+
+void pool_free(pool_t *ptr) {
+    if (ptr->data) {
+        fb_free();
+    }
+}
+
+void pool_clear(pool_t *ptr) {
+    // Thread the free list through the blocks.
+    ptr->free = NULL;
+    for (size_t i = ptr->size; i; i--) {
+        void **block = (void **) (ptr->data + ((i - 1) * ptr->block_len));
+        *block = ptr->free;
+        ptr->free = block;
+    }
+}
+
+bool pool_contains(pool_t *ptr, void *block) {
+    return ((char *) block >= ptr->data) && ((char *) block < (ptr->data + (ptr->size * ptr->block_len)));
+}
+
+void *pool_take(pool_t *ptr) {
+    void **block = ptr->free;
+    if (block) {
+        ptr->free = *block;
+    }
+    return block;
+}
+
+void pool_give(pool_t *ptr, void *block) {
+    *((void **) block) = ptr->free;
+    ptr->free = block;
+}
+
 // Linked List
 void list_init(list_t *ptr, size_t data_len) {
+    list_init_pool(ptr, data_len, NULL);
+}
+
+void list_init_pool(list_t *ptr, size_t data_len, pool_t *pool) {
     ptr->head = NULL;
     ptr->tail = NULL;
     ptr->size = 0;
     ptr->data_len = data_len;
+    ptr->pool = (pool && ((sizeof(list_lnk_t) + data_len) <= pool->block_len)) ? pool : NULL;
+}
+
+// Allocates a pool on the frame buffer stack for the links of lists of data_len elements.
+// The pool is sized to a small fraction of the free memory so it doesn't starve the caller.
+void list_pool_alloc(pool_t *pool, size_t data_len) {
+    size_t block_len = sizeof(list_lnk_t) + data_len;
+    pool_alloc(pool, IM_MIN((size_t) LIST_POOL_SIZE_MAX, (fb_avail() / 16) / block_len), block_len);
+}
+
+static list_lnk_t *list_lnk_alloc(list_t *ptr) {
+    list_lnk_t *lnk = ptr->pool ? pool_take(ptr->pool) : NULL;
+    return lnk ? lnk : ((list_lnk_t *) xalloc(sizeof(list_lnk_t) + ptr->data_len));
+}
+
+static void list_lnk_free(list_t *ptr, list_lnk_t *lnk) {
+    if (ptr->pool && pool_contains(ptr->pool, lnk)) {
+        pool_give(ptr->pool, lnk);
+    } else {
+        xfree(lnk);
+    }
 }
 
 void list_copy(list_t *dst, list_t *src) {
@@ -194,7 +264,7 @@ void list_copy(list_t *dst, list_t *src) {
 void list_free(list_t *ptr) {
     for (list_lnk_t *i = ptr->head; i; ) {
         list_lnk_t *j = i->next;
-        xfree(i);
+        list_lnk_free(ptr, i);
         i = j;
     }
 }
@@ -257,7 +327,7 @@ static void list_unlink(list_t *src, list_lnk_t *lnk) {
 }
 
 void list_insert(list_t *ptr, list_lnk_t *lnk, void *data) {
-    list_lnk_t *tmp = (list_lnk_t *) xalloc(sizeof(list_lnk_t) + ptr->data_len);
+    list_lnk_t *tmp = list_lnk_alloc(ptr);
     memcpy(tmp->data, data, ptr->data_len);
     list_link(ptr, lnk, tmp);
 }
@@ -276,7 +346,7 @@ void list_remove(list_t *ptr, list_lnk_t *lnk, void *data) {
     }
 
     list_unlink(ptr, lnk);
-    xfree(lnk);
+    list_lnk_free(ptr, lnk);
 }
 
 void list_pop_front(list_t *ptr, void *data) {
@@ -288,6 +358,13 @@ void list_pop_back(list_t *ptr, void *data) {
 }
 
 void list_move(list_t *dst, list_t *src, list_lnk_t *before, list_lnk_t *lnk) {
+    if (dst->pool != src->pool) {
+        // The link must be released to the allocator it came from.
+        list_insert(dst, before, lnk->data);
+        list_remove(src, lnk, NULL);
+        return;
+    }
+
     list_unlink(src, lnk);
     list_link(dst, before, lnk);
 }
@@ -23,6 +23,7 @@ void bitmap_alloc(bitmap_t *ptr, size_t size);
 void bitmap_free(bitmap_t *ptr);
 void bitmap_clear(bitmap_t *ptr);
 void bitmap_bit_set(bitmap_t *ptr, size_t index);
+void bitmap_bit_reset(bitmap_t *ptr, size_t index);
 bool bitmap_bit_get(bitmap_t *ptr, size_t index);
 #define BITMAP_COMPUTE_ROW_INDEX(image, y)    (((image)->w) * (y))
 #define BITMAP_COMPUTE_INDEX(row_index, x)    ((row_index) + (x))
@@ -69,6 +70,21 @@ void fifo_dequeue(fifo_t *ptr, void *data);
 void fifo_poke(fifo_t *ptr, void *data);
 void fifo_peek(fifo_t *ptr, void *data);
 
+// Pool (fixed size blocks)
+typedef struct pool {
+    size_t size;
+    size_t block_len;
+    char *data;
+    void *free;
+} pool_t;
+
+void pool_alloc(pool_t *ptr, size_t size, size_t block_len);
+void pool_free(pool_t *ptr);
+void pool_clear(pool_t *ptr);
+bool pool_contains(pool_t *ptr, void *block);
+void *pool_take(pool_t *ptr); // returns NULL when the pool is exhausted.
+void pool_give(pool_t *ptr, void *block);
+
 // Linked List
 typedef struct list_lnk {
     struct list_lnk *next;
@@ -81,9 +97,15 @@ typedef struct list {
     list_lnk_t *tail;
     size_t size;
     size_t data_len;
+    pool_t *pool;
 } list_t;
 
+// Lists with a pool take their links from it, falling back to the heap when it's empty.
+#define LIST_POOL_SIZE_MAX    (128)
+
 void list_init(list_t *ptr, size_t data_len);
+void list_init_pool(list_t *ptr, size_t data_len, pool_t *pool);
+void list_pool_alloc(pool_t *pool, size_t data_len);
 void list_copy(list_t *dst, list_t *src);
 void list_free(list_t *ptr);
 void list_clear(list_t *ptr);
@@ -11,6 +11,7 @@
 #include <float.h>
 #include <stdio.h>
 #include "imlib.h"
+#include "py/mphal.h"
 #ifdef IMLIB_ENABLE_DATAMATRICES
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-variable"
@@ -482,7 +483,7 @@ extern DmtxMessage *dmtxDecodeMosaicRegion(DmtxDecode *dec, DmtxRegion *reg, int
 /* dmtxregion.c */
 extern DmtxRegion *dmtxRegionCreate(DmtxRegion *reg);
 extern DmtxPassFail dmtxRegionDestroy(DmtxRegion **reg);
-extern DmtxRegion *dmtxRegionFindNext(DmtxDecode *dec, int max_iterations, int *current_iterations);
+extern DmtxRegion *dmtxRegionFindNext(DmtxDecode *dec, int max_iterations, int *current_iterations, uint32_t start_us, uint32_t timeout_us);
 extern DmtxRegion *dmtxRegionScanPixel(DmtxDecode *dec, int x, int y);
 extern DmtxPassFail dmtxRegionUpdateCorners(DmtxDecode *dec, DmtxRegion *reg, DmtxVector2 p00,
       DmtxVector2 p10, DmtxVector2 p11, DmtxVector2 p01);
@@ -2243,14 +2244,17 @@ dmtxRegionDestroy(DmtxRegion **reg)
  * \return Detected region (if found)
  */
 extern DmtxRegion *
-dmtxRegionFindNext(DmtxDecode *dec, int max_iterations, int *current_iterations)
+dmtxRegionFindNext(DmtxDecode *dec, int max_iterations, int *current_iterations, uint32_t start_us, uint32_t timeout_us)
 {
    int locStatus;
    DmtxPixelLoc loc;
    DmtxRegion   *reg;
 
-   /* Continue until we find a region or run out of chances */
+   /* Continue until we find a region or run out of chances (or time) */
    for(; *current_iterations < max_iterations; *current_iterations += 1) {
+      if(timeout_us && ((mp_hal_ticks_us() - start_us) >= timeout_us))
+         break;
+
       locStatus = PopGridLocation(&(dec->grid), &loc);
       if(locStatus == DmtxRangeEnd)
          break;
@@ -6305,8 +6309,74 @@ dmtxMatrix3Print(DmtxMatrix3 m)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void imlib_find_datamatrices(list_t *out, image_t *ptr, rectangle_t *roi, int effort)
+// Decodes region and adds it to out if it is a valid code. Destroys region.
+static void imlib_find_datamatrices_add(list_t *out, image_t *ptr, rectangle_t *roi,
+                                        DmtxDecode *decode, DmtxRegion *region)
+{
+    DmtxMessage *message = dmtxDecodeMatrixRegion(decode, region, DmtxUndefined);
+
+    if (message) {
+        find_datamatrices_list_lnk_data_t lnk_data;
+
+        DmtxVector2 p[4];
+
+        p[0].X = p[0].Y = p[1].Y = p[3].X = 0.0;
+        p[1].X = p[3].Y = p[2].X = p[2].Y = 1.0;
+
+        dmtxMatrix3VMultiplyBy(&p[0], region->fit2raw);
+        dmtxMatrix3VMultiplyBy(&p[1], region->fit2raw);
+        dmtxMatrix3VMultiplyBy(&p[2], region->fit2raw);
+        dmtxMatrix3VMultiplyBy(&p[3], region->fit2raw);
+
+        int height = dmtxDecodeGetProp(decode, DmtxPropHeight);
+
+        rectangle_init(&(lnk_data.rect),
+                       fast_roundf(p[0].X) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x),
+                       height - 1 - fast_roundf(p[0].Y) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y), 0, 0);
+
+        for (size_t k = 1, l = (sizeof(p) / sizeof(p[0])); k < l; k++) {
+            rectangle_t temp;
+            rectangle_init(&temp, fast_roundf(p[k].X) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x),
+                    height - 1 - fast_roundf(p[k].Y) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y), 0, 0);
+            rectangle_united(&(lnk_data.rect), &temp);
+        }
+
+        // Add corners...
+        lnk_data.corners[0].x =              fast_roundf(p[3].X) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x); // top-left
+        lnk_data.corners[0].y = height - 1 - fast_roundf(p[3].Y) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y); // top-left
+        lnk_data.corners[1].x =              fast_roundf(p[2].X) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x); // top-right
+        lnk_data.corners[1].y = height - 1 - fast_roundf(p[2].Y) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y); // top-right
+        lnk_data.corners[2].x =              fast_roundf(p[1].X) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x); // bottom-right
+        lnk_data.corners[2].y = height - 1 - fast_roundf(p[1].Y) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y); // bottom-right
+        lnk_data.corners[3].x =              fast_roundf(p[0].X) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x); // bottom-left
+        lnk_data.corners[3].y = height - 1 - fast_roundf(p[0].Y) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y); // bottom-left
+
+        // Payload is NOT already null terminated.
+        lnk_data.payload_len = message->outputIdx;
+        lnk_data.payload = xalloc(message->outputIdx);
+        memcpy(lnk_data.payload, message->output, message->outputIdx);
+
+        int rotate = fast_roundf((((2 * M_PI) + fast_atan2f(p[1].Y - p[0].Y, p[1].X - p[0].X)) * 180) / M_PI);
+        if(rotate >= 360) rotate -= 360;
+
+        lnk_data.rotation = rotate;
+        lnk_data.rows = dmtxGetSymbolAttribute(DmtxSymAttribSymbolRows, region->sizeIdx);
+        lnk_data.columns = dmtxGetSymbolAttribute(DmtxSymAttribSymbolCols, region->sizeIdx);
+        lnk_data.capacity = dmtxGetSymbolAttribute(DmtxSymAttribSymbolDataWords, region->sizeIdx);
+        lnk_data.padding = message->padCount;
+
+        list_push_back(out, &lnk_data);
+
+        dmtxMessageDestroy(&message);
+    }
+
+    dmtxRegionDestroy(&region);
+}
+
+void imlib_find_datamatrices(list_t *out, image_t *ptr, rectangle_t *roi, int effort, uint32_t timeout_us,
+                             rectangle_t *hints, size_t hints_len)
 {
+    uint32_t start_us = mp_hal_ticks_us();
     uint8_t *grayscale_image = (ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? ptr->data : fb_alloc(roi->w * roi->h, FB_ALLOC_NO_HINT);
 
     if (ptr->pixfmt != PIXFORMAT_GRAYSCALE) {
@@ -6325,81 +6395,69 @@ void imlib_find_datamatrices(list_t *out, image_t *ptr, rectangle_t *roi, int ef
                                        (ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? ptr->h : roi->h,
                                        DmtxPack8bppK);
 
+    int x_min = (ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? roi->x : 0;
+    int y_min = (ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? roi->y : 0;
+    int x_max = x_min + (roi->w - 1);
+    int y_max = y_min + (roi->h - 1);
+
     DmtxDecode *decode = dmtxDecodeCreate(image, 1);
-    dmtxDecodeSetProp(decode, DmtxPropXmin, (ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? roi->x : 0);
-    dmtxDecodeSetProp(decode, DmtxPropYmin, (ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? roi->y : 0);
-    dmtxDecodeSetProp(decode, DmtxPropXmax, ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? roi->x : 0) + (roi->w - 1));
-    dmtxDecodeSetProp(decode, DmtxPropYmax, ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? roi->y : 0) + (roi->h - 1));
+    dmtxDecodeSetProp(decode, DmtxPropXmin, x_min);
+    dmtxDecodeSetProp(decode, DmtxPropYmin, y_min);
+    dmtxDecodeSetProp(decode, DmtxPropXmax, x_max);
+    dmtxDecodeSetProp(decode, DmtxPropYmax, y_max);
 
     list_init(out, sizeof(find_datamatrices_list_lnk_data_t));
 
-    int max_iterations = effort;
-    int current_iterations = 0;
-    for (DmtxRegion *region = dmtxRegionFindNext(decode, max_iterations, &current_iterations); region; region = dmtxRegionFindNext(decode, max_iterations, &current_iterations)) {
-        DmtxMessage *message = dmtxDecodeMatrixRegion(decode, region, DmtxUndefined);
-
-        if (message) {
-            find_datamatrices_list_lnk_data_t lnk_data;
-
-            DmtxVector2 p[4];
-
-            p[0].X = p[0].Y = p[1].Y = p[3].X = 0.0;
-            p[1].X = p[3].Y = p[2].X = p[2].Y = 1.0;
-
-            dmtxMatrix3VMultiplyBy(&p[0], region->fit2raw);
-            dmtxMatrix3VMultiplyBy(&p[1], region->fit2raw);
-            dmtxMatrix3VMultiplyBy(&p[2], region->fit2raw);
-            dmtxMatrix3VMultiplyBy(&p[3], region->fit2raw);
-
-            int height = dmtxDecodeGetProp(decode, DmtxPropHeight);
+    // Scan the midlines of the hinted areas (e.g. last frame's codes) before the search grid. The
+    // midlines of a code's bounding box cross its L-shaped finder edges. Decoded codes are marked
+    // in the decode cache so the grid search doesn't find them again.
+    int height = dmtxDecodeGetProp(decode, DmtxPropHeight);
+    int gap = IM_MAX(dmtxDecodeGetProp(decode, DmtxPropScanGap), 1);
+
+    for (size_t i = 0; i < hints_len; i++) {
+        int hx = hints[i].x - ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x);
+        int hy = hints[i].y - ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y);
+        int hx_min = IM_MAX(hx, x_min);
+        int hy_min = IM_MAX(hy, y_min);
+        int hx_max = IM_MIN(hx + hints[i].w - 1, x_max);
+        int hy_max = IM_MIN(hy + hints[i].h - 1, y_max);
+        int hx_mid = (hx_min + hx_max) / 2;
+        int hy_mid = (hy_min + hy_max) / 2;
+
+        for (int x = hx_min; (x <= hx_max) && (hy_min <= hy_max); x += gap) {
+            if (timeout_us && ((mp_hal_ticks_us() - start_us) >= timeout_us)) {
+                break;
+            }
 
-            rectangle_init(&(lnk_data.rect),
-                           fast_roundf(p[0].X) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x),
-                           height - 1 - fast_roundf(p[0].Y) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y), 0, 0);
+            DmtxRegion *region = dmtxRegionScanPixel(decode, x, height - 1 - hy_mid);
+            if (region) {
+                imlib_find_datamatrices_add(out, ptr, roi, decode, region);
+            }
+        }
 
-            for (size_t k = 1, l = (sizeof(p) / sizeof(p[0])); k < l; k++) {
-                rectangle_t temp;
-                rectangle_init(&temp, fast_roundf(p[k].X) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x),
-                        height - 1 - fast_roundf(p[k].Y) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y), 0, 0);
-                rectangle_united(&(lnk_data.rect), &temp);
+        for (int y = hy_min; (y <= hy_max) && (hx_min <= hx_max); y += gap) {
+            if (timeout_us && ((mp_hal_ticks_us() - start_us) >= timeout_us)) {
+                break;
             }
 
-            // Add corners...
-            lnk_data.corners[0].x =              fast_roundf(p[3].X) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x); // top-left
-            lnk_data.corners[0].y = height - 1 - fast_roundf(p[3].Y) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y); // top-left
-            lnk_data.corners[1].x =              fast_roundf(p[2].X) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x); // top-right
-            lnk_data.corners[1].y = height - 1 - fast_roundf(p[2].Y) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y); // top-right
-            lnk_data.corners[2].x =              fast_roundf(p[1].X) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x); // bottom-right
-            lnk_data.corners[2].y = height - 1 - fast_roundf(p[1].Y) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y); // bottom-right
-            lnk_data.corners[3].x =              fast_roundf(p[0].X) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x); // bottom-left
-            lnk_data.corners[3].y = height - 1 - fast_roundf(p[0].Y) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y); // bottom-left
-
-            // Payload is NOT already null terminated.
-            lnk_data.payload_len = message->outputIdx;
-            lnk_data.payload = xalloc(message->outputIdx);
-            memcpy(lnk_data.payload, message->output, message->outputIdx);
-
-            int rotate = fast_roundf((((2 * M_PI) + fast_atan2f(p[1].Y - p[0].Y, p[1].X - p[0].X)) * 180) / M_PI);
-            if(rotate >= 360) rotate -= 360;
-
-            lnk_data.rotation = rotate;
-            lnk_data.rows = dmtxGetSymbolAttribute(DmtxSymAttribSymbolRows, region->sizeIdx);
-            lnk_data.columns = dmtxGetSymbolAttribute(DmtxSymAttribSymbolCols, region->sizeIdx);
-            lnk_data.capacity = dmtxGetSymbolAttribute(DmtxSymAttribSymbolDataWords, region->sizeIdx);
-            lnk_data.padding = message->padCount;
-
-            list_push_back(out, &lnk_data);
-
-            dmtxMessageDestroy(&message);
+            DmtxRegion *region = dmtxRegionScanPixel(decode, hx_mid, height - 1 - y);
+            if (region) {
+                imlib_find_datamatrices_add(out, ptr, roi, decode, region);
+            }
         }
+    }
 
-        dmtxRegionDestroy(&region);
+    int max_iterations = effort;
+    int current_iterations = 0;
+    for (DmtxRegion *region = dmtxRegionFindNext(decode, max_iterations, &current_iterations, start_us, timeout_us); region;
+         region = dmtxRegionFindNext(decode, max_iterations, &current_iterations, start_us, timeout_us)) {
+        imlib_find_datamatrices_add(out, ptr, roi, decode, region);
     }
 
     dmtxDecodeDestroy(&decode);
     dmtxImageDestroy(&image);
 
-    fb_free(); // umm_init_x();
+    umm_deinit();
     if (ptr->pixfmt != PIXFORMAT_GRAYSCALE) {
         fb_free(); // grayscale_image;
     }
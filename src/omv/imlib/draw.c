@@ -11,11 +11,15 @@
 #include "font.h"
 #include "imlib.h"
 #include "unaligned_memcpy.h"
+#include "omv_memcpy.h"
+#include "trace.h"
 
 #ifdef IMLIB_ENABLE_DMA2D
 #include STM32_HAL_H
 #include "dma.h"
 #include "omv_common.h"
+// Smaller fills are faster on the CPU than setting up a transfer.
+#define IMLIB_DMA2D_FILL_MIN_PIXELS    (256)
 #endif
 
 void *imlib_compute_row_ptr(const image_t *img, int y) {
@@ -77,14 +81,101 @@ void imlib_set_pixel(image_t *img, int x, int y, int p) {
     }
 }
 
+// Writes v to bits [x_start, x_end) of a binary row, a word at a time.
+void imlib_binary_fill_row(uint32_t *row_ptr, int x_start, int x_end, int v) {
+    if (x_start >= x_end) {
+        return;
+    }
+
+    size_t i = x_start >> UINT32_T_SHIFT;
+    size_t j = (x_end - 1) >> UINT32_T_SHIFT;
+    uint32_t fill = (v & 1) ? UINT32_MAX : 0;
+    uint32_t head = UINT32_MAX << (x_start & UINT32_T_MASK);
+    uint32_t tail = UINT32_MAX >> (UINT32_T_MASK - ((x_end - 1) & UINT32_T_MASK));
+
+    if (i == j) {
+        head &= tail;
+        row_ptr[i] = (row_ptr[i] & ~head) | (fill & head);
+        return;
+    }
+
+    row_ptr[i] = (row_ptr[i] & ~head) | (fill & head);
+
+    for (i += 1; i < j; i++) {
+        row_ptr[i] = fill;
+    }
+
+    row_ptr[j] = (row_ptr[j] & ~tail) | (fill & tail);
+}
+
+// Fills pixels [x_start, x_end) of row y, clipped to the image. The pixel format is
+// dispatched once per span rather than per pixel.
+static void imlib_fill_row_span(image_t *img, int y, int x_start, int x_end, int c) {
+    x_start = IM_MAX(x_start, 0);
+    x_end = IM_MIN(x_end, img->w);
+
+    if ((y < 0) || (y >= img->h) || (x_start >= x_end)) {
+        return;
+    }
+
+    switch (img->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            imlib_binary_fill_row(IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y), x_start, x_end, c);
+            break;
+        }
+        case PIXFORMAT_GRAYSCALE: {
+            memset(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y) + x_start, c, x_end - x_start);
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y) + x_start;
+            int n = x_end - x_start;
+
+            // Align to a word and write two pixels per store.
+            if (((uintptr_t) ptr) & 2) {
+                *ptr++ = c;
+                n -= 1;
+            }
+
+            uint32_t *ptr32 = (uint32_t *) ptr;
+            uint32_t c32 = (((uint16_t) c) << 16) | ((uint16_t) c);
+
+            for (; n >= 2; n -= 2) {
+                *ptr32++ = c32;
+            }
+
+            if (n) {
+                *((uint16_t *) ptr32) = c;
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
 // https://stackoverflow.com/questions/1201200/fast-algorithm-for-drawing-filled-circles
+// Each row of the disc is one span, x * x <= r0 * r0 - y * y.
 static void point_fill(image_t *img, int cx, int cy, int r0, int r1, int c) {
+    int r0_sq = r0 * r0;
+
     for (int y = r0; y <= r1; y++) {
-        for (int x = r0; x <= r1; x++) {
-            if (((x * x) + (y * y)) <= (r0 * r0)) {
-                imlib_set_pixel(img, cx + x, cy + y, c);
-            }
+        int t = r0_sq - (y * y);
+
+        if (t < 0) {
+            continue;
         }
+
+        int s = fast_floorf(fast_sqrtf(t));
+        while ((s * s) > t) {
+            s--;
+        }
+        while (((s + 1) * (s + 1)) <= t) {
+            s++;
+        }
+
+        imlib_fill_row_span(img, cy + y, cx + IM_MAX(r0, -s), cx + IM_MIN(r1, s) + 1, c);
     }
 }
 
@@ -246,26 +337,109 @@ void imlib_draw_line(image_t *img, int x0, int y0, int x1, int y1, int c, int th
 }
 
 static void xLine(image_t *img, int x1, int x2, int y, int c) {
-    while (x1 <= x2) {
-        imlib_set_pixel(img, x1++, y, c);
-    }
+    imlib_fill_row_span(img, y, x1, x2 + 1, c);
 }
 
 static void yLine(image_t *img, int x, int y1, int y2, int c) {
-    while (y1 <= y2) {
-        imlib_set_pixel(img, x, y1++, c);
-    }
-}
+    y1 = IM_MAX(y1, 0);
+    y2 = IM_MIN(y2, img->h - 1);
 
-void imlib_draw_rectangle(image_t *img, int rx, int ry, int rw, int rh, int c, int thickness, bool fill) {
-    if (fill) {
+    if ((x < 0) || (x >= img->w) || (y1 > y2)) {
+        return;
+    }
 
-        for (int y = ry, yy = ry + rh; y < yy; y++) {
-            for (int x = rx, xx = rx + rw; x < xx; x++) {
-                imlib_set_pixel(img, x, y, c);
+    switch (img->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            for (int y = y1; y <= y2; y++) {
+                IMAGE_PUT_BINARY_PIXEL_FAST(IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y), x, c);
+            }
+            break;
+        }
+        case PIXFORMAT_GRAYSCALE: {
+            uint8_t *ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y1) + x;
+            for (int y = y1; y <= y2; y++, ptr += img->w) {
+                *ptr = c;
             }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y1) + x;
+            for (int y = y1; y <= y2; y++, ptr += img->w) {
+                *ptr = c;
+            }
+            break;
         }
+        default: {
+            break;
+        }
+    }
+}
+
+#ifdef IMLIB_ENABLE_DMA2D
+// Fills a (clipped) rectangle of an RGB565 image using DMA2D register-to-memory mode.
+static bool imlib_dma2d_fill(image_t *img, rectangle_t *r, int c) {
+    uint16_t *dst = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, r->y) + r->x;
+
+    if ((img->pixfmt != PIXFORMAT_RGB565)
+        || ((r->w * r->h) < IMLIB_DMA2D_FILL_MIN_PIXELS)
+        || (!DMA_BUFFER(dst))) {
+        return false;
+    }
+
+    DMA2D_HandleTypeDef dma2d = {};
+    dma2d.Instance = DMA2D;
+    dma2d.Init.Mode = DMA2D_R2M;
+    dma2d.Init.ColorMode = DMA2D_OUTPUT_RGB565;
+    dma2d.Init.OutputOffset = img->w - r->w;
+    #if defined(MCU_SERIES_F7) || defined(MCU_SERIES_H7)
+    dma2d.Init.AlphaInverted = DMA2D_REGULAR_ALPHA;
+    dma2d.Init.RedBlueSwap = DMA2D_RB_REGULAR;
+    #endif
+    HAL_DMA2D_Init(&dma2d);
+
+    #if defined(MCU_SERIES_F7) || defined(MCU_SERIES_H7)
+    // Write back any dirty lines sharing the area before DMA2D overwrites it.
+    uint32_t size = (((r->h - 1) * img->w) + r->w) * sizeof(uint16_t);
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t *) dst, size);
+    #endif
+
+    // The HAL expects the color in ARGB8888 and converts it to the output format.
+    uint32_t argb = (0xff << 24) | (COLOR_RGB565_TO_R8(c) << 16) | (COLOR_RGB565_TO_G8(c) << 8) | COLOR_RGB565_TO_B8(c);
+    HAL_DMA2D_Start(&dma2d, argb, (uint32_t) dst, r->w, r->h);
+    HAL_DMA2D_PollForTransfer(&dma2d, 1000);
+
+    #if defined(MCU_SERIES_F7) || defined(MCU_SERIES_H7)
+    SCB_InvalidateDCache_by_Addr((uint32_t *) dst, size);
+    #endif
+    HAL_DMA2D_DeInit(&dma2d);
+    return true;
+}
+#endif
+
+static void imlib_fill_rectangle(image_t *img, int rx, int ry, int rw, int rh, int c) {
+    int x_start = IM_MAX(rx, 0), x_end = IM_MIN(rx + rw, img->w);
+    int y_start = IM_MAX(ry, 0), y_end = IM_MIN(ry + rh, img->h);
 
+    if ((x_start >= x_end) || (y_start >= y_end)) {
+        return;
+    }
+
+    rectangle_t r = {x_start, y_start, x_end - x_start, y_end - y_start};
+
+    #ifdef IMLIB_ENABLE_DMA2D
+    if (imlib_dma2d_fill(img, &r, c)) {
+        return;
+    }
+    #endif
+
+    for (int y = r.y, yy = r.y + r.h; y < yy; y++) {
+        imlib_fill_row_span(img, y, r.x, r.x + r.w, c);
+    }
+}
+
+void imlib_draw_rectangle(image_t *img, int rx, int ry, int rw, int rh, int c, int thickness, bool fill) {
+    if (fill) {
+        imlib_fill_rectangle(img, rx, ry, rw, rh, c);
     } else if (thickness > 0) {
         int thickness0 = (thickness - 0) / 2;
         int thickness1 = (thickness - 1) / 2;
@@ -344,10 +518,94 @@ static void scratch_draw_pixel(image_t *img,
     point_fill(img, x0 + dx, y0 + dy + fast_floorf((dx * shear_dy) / shear_dx), r0, r1, c);
 }
 
+// Filled shapes are rasterized as vertical runs per column and drawn as one span per row.
+// Columns left or right of the image are merged into the edge columns since spans are
+// clipped anyway.
+typedef struct scratch_fill {
+    int *col_lo;
+    int *col_hi;
+    int *row_lo;
+    int *row_hi;
+} scratch_fill_t;
+
+static void scratch_fill_alloc(image_t *img, scratch_fill_t *fill) {
+    fill->col_lo = fb_alloc(((img->w * 2) + (img->h * 2)) * sizeof(int), FB_ALLOC_NO_HINT);
+    fill->col_hi = fill->col_lo + img->w;
+    fill->row_lo = fill->col_hi + img->w;
+    fill->row_hi = fill->row_lo + img->h;
+
+    for (int x = 0; x < img->w; x++) {
+        fill->col_lo[x] = INT_MAX;
+        fill->col_hi[x] = INT_MIN;
+    }
+}
+
+static void scratch_fill_column(image_t *img, scratch_fill_t *fill, int x, int y0, int y1) {
+    x = IM_MIN(IM_MAX(x, 0), img->w - 1);
+    y0 = IM_MAX(y0, 0);
+    y1 = IM_MIN(y1, img->h - 1);
+
+    if (y0 <= y1) {
+        fill->col_lo[x] = IM_MIN(fill->col_lo[x], y0);
+        fill->col_hi[x] = IM_MAX(fill->col_hi[x], y1);
+    }
+}
+
+// Sweeping the columns from one side, each row takes the first column that reaches it,
+// so every row is visited once per side instead of once per pixel.
+static void scratch_fill_sweep(image_t *img, scratch_fill_t *fill, int *row_x, int x_start, int x_step) {
+    int lo = INT_MAX, hi = INT_MIN;
+
+    for (int x = x_start; (0 <= x) && (x < img->w); x += x_step) {
+        int col_lo = fill->col_lo[x];
+        int col_hi = fill->col_hi[x];
+
+        if (col_lo > col_hi) {
+            continue;
+        }
+
+        if (lo > hi) {
+            lo = col_lo;
+            hi = col_lo - 1;
+        }
+
+        for (int y = col_lo; y < lo; y++) {
+            row_x[y] = x;
+        }
+
+        for (int y = hi + 1; y <= col_hi; y++) {
+            row_x[y] = x;
+        }
+
+        lo = IM_MIN(lo, col_lo);
+        hi = IM_MAX(hi, col_hi);
+    }
+}
+
+static void scratch_fill_draw(image_t *img, scratch_fill_t *fill, int c) {
+    scratch_fill_sweep(img, fill, fill->row_lo, 0, 1);
+    scratch_fill_sweep(img, fill, fill->row_hi, img->w - 1, -1);
+
+    int lo = INT_MAX, hi = INT_MIN;
+    for (int x = 0; x < img->w; x++) {
+        if (fill->col_lo[x] <= fill->col_hi[x]) {
+            lo = IM_MIN(lo, fill->col_lo[x]);
+            hi = IM_MAX(hi, fill->col_hi[x]);
+        }
+    }
+
+    for (int y = lo; y <= hi; y++) {
+        imlib_fill_row_span(img, y, fill->row_lo[y], fill->row_hi[y] + 1, c);
+    }
+
+    fb_free();
+}
+
 // https://scratch.mit.edu/projects/50039326/
-static void scratch_draw_line(image_t *img, int x0, int y0, int dx, int dy0, int dy1, float shear_dx, float shear_dy, int c) {
+static void scratch_draw_line(image_t *img, scratch_fill_t *fill, int x0, int y0, int dx, int dy0, int dy1,
+                              float shear_dx, float shear_dy) {
     int y = y0 + fast_floorf((dx * shear_dy) / shear_dx);
-    yLine(img, x0 + dx, y + dy0, y + dy1, c);
+    scratch_fill_column(img, fill, x0 + dx, y + dy0, y + dy1);
 }
 
 // https://scratch.mit.edu/projects/50039326/
@@ -373,10 +631,15 @@ static void scratch_draw_sheared_ellipse(image_t *img,
         int y = height;
         int sigma = (2 * b_squared) + (a_squared * (1 - (2 * height)));
 
+        scratch_fill_t fill = { 0 };
+        if (filled) {
+            scratch_fill_alloc(img, &fill);
+        }
+
         while ((b_squared * x) <= (a_squared * y)) {
             if (filled) {
-                scratch_draw_line(img, x0, y0, x, -y, y, shear_dx, shear_dy, c);
-                scratch_draw_line(img, x0, y0, -x, -y, y, shear_dx, shear_dy, c);
+                scratch_draw_line(img, &fill, x0, y0, x, -y, y, shear_dx, shear_dy);
+                scratch_draw_line(img, &fill, x0, y0, -x, -y, y, shear_dx, shear_dy);
             } else {
                 scratch_draw_pixel(img, x0, y0, x, y, shear_dx, shear_dy, -thickness0, thickness1, c);
                 scratch_draw_pixel(img, x0, y0, -x, y, shear_dx, shear_dy, -thickness0, thickness1, c);
@@ -399,8 +662,8 @@ static void scratch_draw_sheared_ellipse(image_t *img,
 
         while ((a_squared * y) <= (b_squared * x)) {
             if (filled) {
-                scratch_draw_line(img, x0, y0, x, -y, y, shear_dx, shear_dy, c);
-                scratch_draw_line(img, x0, y0, -x, -y, y, shear_dx, shear_dy, c);
+                scratch_draw_line(img, &fill, x0, y0, x, -y, y, shear_dx, shear_dy);
+                scratch_draw_line(img, &fill, x0, y0, -x, -y, y, shear_dx, shear_dy);
             } else {
                 scratch_draw_pixel(img, x0, y0, x, y, shear_dx, shear_dy, -thickness0, thickness1, c);
                 scratch_draw_pixel(img, x0, y0, -x, y, shear_dx, shear_dy, -thickness0, thickness1, c);
@@ -416,6 +679,10 @@ static void scratch_draw_sheared_ellipse(image_t *img,
             sigma += a_squared * ((4 * y) + 6);
             y += 1;
         }
+
+        if (filled) {
+            scratch_fill_draw(img, &fill, c);
+        }
     }
 }
 
@@ -484,6 +751,49 @@ void imlib_draw_ellipse(image_t *img, int cx, int cy, int rx, int ry, int rotati
 
 // char rotation == 0, 90, 180, 360, etc.
 // string rotation == 0, 90, 180, 360, etc.
+// first[i] is the first scaled pixel sampling glyph row/column i or after, so [first[i], first[i + 1])
+// are the scaled pixels of row/column i.
+static void glyph_scale_map(int *first, int n, float scale) {
+    for (int i = 0, x = 0, xx = fast_floorf(n * scale); i <= n; i++) {
+        while ((x < xx) && (fast_floorf(x / scale) < i)) {
+            x++;
+        }
+        first[i] = x;
+    }
+}
+
+// Draws an upright glyph as one filled rectangle per run of set pixels in each glyph row.
+static void imlib_draw_glyph(image_t *img, const glyph_t *g, int x_off, int y_off, int c,
+                             const int *col_first, const int *row_first, bool hmirror, bool vflip) {
+    int w = col_first[g->w], h = row_first[g->h];
+
+    for (int y = 0; y < g->h; y++) {
+        int y_start = row_first[y], y_end = row_first[y + 1];
+
+        if ((y_start == y_end) || (!g->data[y])) {
+            continue;
+        }
+
+        for (int x = 0; x < g->w; ) {
+            if (!(g->data[y] & (1 << (g->w - 1 - x)))) {
+                x++;
+                continue;
+            }
+
+            int x_run = x;
+            while ((x < g->w) && (g->data[y] & (1 << (g->w - 1 - x)))) {
+                x++;
+            }
+
+            int x_start = col_first[x_run], x_end = col_first[x];
+            imlib_fill_rectangle(img,
+                                 x_off + (hmirror ? (w - x_end) : x_start),
+                                 y_off + (vflip ? (h - y_end) : y_start),
+                                 x_end - x_start, y_end - y_start, c);
+        }
+    }
+}
+
 void imlib_draw_string(image_t *img,
                        int x_off,
                        int y_off,
@@ -525,6 +835,16 @@ void imlib_draw_string(image_t *img,
     int org_y_off = y_off;
     const int anchor = x_off;
 
+    // Upright glyphs are drawn in runs. All glyphs share the same size so the scaled pixel ranges
+    // of each glyph row and column are computed once.
+    bool upright = (!char_rotation) && (!string_rotation);
+    int col_first[8 + 1], row_first[sizeof(font[0].data) + 1];
+
+    if (upright) {
+        glyph_scale_map(col_first, font[0].w, scale);
+        glyph_scale_map(row_first, font[0].h, scale);
+    }
+
     for (char ch, last = '\0'; (ch = *str); str++, last = ch) {
 
         if ((last == '\r') && (ch == '\n')) {
@@ -583,13 +903,17 @@ void imlib_draw_string(image_t *img,
             }
         }
 
-        for (int y = 0, yy = fast_floorf(g->h * scale); y < yy; y++) {
-            for (int x = 0, xx = fast_floorf(g->w * scale); x < xx; x++) {
-                if (g->data[fast_floorf(y / scale)] & (1 << (g->w - 1 - fast_floorf(x / scale)))) {
-                    int16_t x_tmp = x_off + (char_hmirror ? (xx - x - 1) : x), y_tmp = y_off + (char_vflip ? (yy - y - 1) : y);
-                    point_rotate(x_tmp, y_tmp, IM_DEG2RAD(char_rotation), x_off + (xx / 2), y_off + (yy / 2), &x_tmp, &y_tmp);
-                    point_rotate(x_tmp, y_tmp, IM_DEG2RAD(string_rotation), org_x_off, org_y_off, &x_tmp, &y_tmp);
-                    imlib_set_pixel(img, x_tmp, y_tmp, c);
+        if (upright) {
+            imlib_draw_glyph(img, g, x_off, y_off, c, col_first, row_first, char_hmirror, char_vflip);
+        } else {
+            for (int y = 0, yy = fast_floorf(g->h * scale); y < yy; y++) {
+                for (int x = 0, xx = fast_floorf(g->w * scale); x < xx; x++) {
+                    if (g->data[fast_floorf(y / scale)] & (1 << (g->w - 1 - fast_floorf(x / scale)))) {
+                        int16_t x_tmp = x_off + (char_hmirror ? (xx - x - 1) : x), y_tmp = y_off + (char_vflip ? (yy - y - 1) : y);
+                        point_rotate(x_tmp, y_tmp, IM_DEG2RAD(char_rotation), x_off + (xx / 2), y_off + (yy / 2), &x_tmp, &y_tmp);
+                        point_rotate(x_tmp, y_tmp, IM_DEG2RAD(string_rotation), org_x_off, org_y_off, &x_tmp, &y_tmp);
+                        imlib_set_pixel(img, x_tmp, y_tmp, c);
+                    }
                 }
             }
         }
@@ -2864,6 +3188,36 @@ void imlib_draw_row(int x_start, int x_end, int y_row, imlib_draw_row_data_t *da
     #undef BLEND_RGB566
 }
 
+// Interpolates w output columns of a grayscale source row horizontally, the output keeps
+// 8 fractional bits (0 to 255 * 256).
+static void imlib_draw_image_bilinear_grayscale_row(uint16_t *h_row_ptr,
+                                                    const uint8_t *src_row_ptr,
+                                                    int w,
+                                                    long src_x_accum,
+                                                    long src_x_frac,
+                                                    int w_start,
+                                                    int w_limit) {
+    for (int i = 0; i < w; i++, src_x_accum += src_x_frac) {
+        int src_x_index = src_x_accum >> 16;
+        int pixel_0, pixel_1;
+
+        // keep pixels in bounds
+        if (src_x_index < w_start) {
+            pixel_0 = pixel_1 = src_row_ptr[w_start];
+        } else if (src_x_index >= w_limit) {
+            pixel_0 = pixel_1 = src_row_ptr[w_limit];
+        } else {
+            pixel_0 = src_row_ptr[src_x_index];
+            pixel_1 = src_row_ptr[src_x_index + 1];
+        }
+
+        long smuad_x = (src_x_accum >> 8) & 0xff;
+        smuad_x |= (256 - smuad_x) << 16;
+
+        h_row_ptr[i] = __SMUAD(smuad_x, (pixel_0 << 16) | pixel_1);
+    }
+}
+
 static void imlib_draw_image_scale_and_center_helper(image_t *dst_img,
                                                      int src_img_w,
                                                      int src_img_h,
@@ -2995,21 +3349,98 @@ void imlib_draw_image_get_bounds(image_t *dst_img,
     return;
 }
 
-void imlib_draw_image(image_t *dst_img,
-                      image_t *src_img,
-                      int dst_x_start,
-                      int dst_y_start,
-                      float x_scale,
-                      float y_scale,
-                      rectangle_t *roi,
-                      int rgb_channel,
-                      int alpha,
-                      const uint16_t *color_palette,
-                      const uint8_t *alpha_palette,
-                      image_hint_t hint,
-                      imlib_draw_row_callback_t callback,
-                      void *callback_arg,
-                      void *dst_row_override) {
+#if (OMV_JPEG_CODEC_ENABLE == 0)
+static void int_imlib_draw_image(image_t *dst_img,
+                                 image_t *src_img,
+                                 int dst_x_start,
+                                 int dst_y_start,
+                                 float x_scale,
+                                 float y_scale,
+                                 rectangle_t *roi,
+                                 int rgb_channel,
+                                 int alpha,
+                                 const uint16_t *color_palette,
+                                 const uint8_t *alpha_palette,
+                                 image_hint_t hint,
+                                 imlib_draw_row_callback_t callback,
+                                 void *callback_arg,
+                                 void *dst_row_override,
+                                 int dst_y_min,
+                                 int dst_y_max);
+
+typedef struct imlib_draw_image_jpeg_data {
+    image_t *dst_img;
+    int dst_x_start;
+    int dst_y_start;
+    float x_scale;
+    float y_scale;
+    rectangle_t *roi;
+    int rgb_channel;
+    int alpha;
+    const uint16_t *color_palette;
+    const uint8_t *alpha_palette;
+    image_hint_t hint;
+    imlib_draw_row_callback_t callback;
+    void *callback_arg;
+    void *dst_row_override;
+    int dst_y; // next destination row to draw
+    int dst_y_end;
+    int src_y_offset; // roi offset in scaled source rows
+    int src_y_lookahead; // source rows read past the current one
+    int h_start;
+    int h_limit;
+} imlib_draw_image_jpeg_data_t;
+
+// Draws every destination row whose source rows have been decoded so far. This must compute the
+// source rows the same way int_imlib_draw_image() does when it is clipped to [dst_y, y).
+static bool imlib_draw_image_jpeg_cb(image_t *img, int y_start, int y_end, void *arg) {
+    imlib_draw_image_jpeg_data_t *data = (imlib_draw_image_jpeg_data_t *) arg;
+    int src_y_start = (data->dst_y - data->dst_y_start) + data->src_y_offset;
+    long src_y_frac = fast_floorf(65536.0f / data->y_scale);
+    long src_y_accum = fast_floorf((src_y_start << 16) / data->y_scale);
+    int y = data->dst_y;
+
+    if (data->hint & IMAGE_HINT_BILINEAR) {
+        src_y_accum -= 0x8000;
+    }
+
+    for (; y < data->dst_y_end; y++, src_y_accum += src_y_frac) {
+        int src_y_index = IM_MIN(IM_MAX((src_y_accum >> 16), data->h_start), data->h_limit);
+        int src_y_index_end = IM_MIN(IM_MAX((src_y_accum >> 16) + data->src_y_lookahead, data->h_start), data->h_limit);
+        if ((src_y_index < y_start) || (src_y_index_end >= y_end)) {
+            break;
+        }
+    }
+
+    if (y > data->dst_y) {
+        int_imlib_draw_image(data->dst_img, img, data->dst_x_start, data->dst_y_start, data->x_scale, data->y_scale,
+                             data->roi, data->rgb_channel, data->alpha, data->color_palette, data->alpha_palette,
+                             data->hint, data->callback, data->callback_arg, data->dst_row_override, data->dst_y, y);
+        data->dst_y = y;
+    }
+
+    // Stop decoding once the last destination row is drawn.
+    return data->dst_y < data->dst_y_end;
+}
+#endif
+
+static void int_imlib_draw_image(image_t *dst_img,
+                                 image_t *src_img,
+                                 int dst_x_start,
+                                 int dst_y_start,
+                                 float x_scale,
+                                 float y_scale,
+                                 rectangle_t *roi,
+                                 int rgb_channel,
+                                 int alpha,
+                                 const uint16_t *color_palette,
+                                 const uint8_t *alpha_palette,
+                                 image_hint_t hint,
+                                 imlib_draw_row_callback_t callback,
+                                 void *callback_arg,
+                                 void *dst_row_override,
+                                 int dst_y_min,
+                                 int dst_y_max) {
     int dst_delta_x = 1; // positive direction
     if (x_scale < 0.f) {
         // flip X
@@ -3082,14 +3513,14 @@ void imlib_draw_image(image_t *dst_img,
         return;
     }
 
-    // Clamp start y to image bounds.
+    // Clamp start y to image bounds (or to the rows being drawn).
     int src_y_start = 0;
-    if (dst_y_start < 0) {
-        src_y_start -= dst_y_start; // this is an add because dst_y_start is negative
-        dst_y_start = 0;
+    if (dst_y_start < dst_y_min) {
+        src_y_start = dst_y_min - dst_y_start;
+        dst_y_start = dst_y_min;
     }
 
-    if (dst_y_start >= dst_img->h) {
+    if (dst_y_start >= dst_y_max) {
         return;
     }
     int src_y_dst_height = src_height_scaled - src_y_start;
@@ -3103,10 +3534,10 @@ void imlib_draw_image(image_t *dst_img,
         dst_x_end = dst_img->w;
     }
 
-    // Clamp end y to image bounds.
+    // Clamp end y to image bounds (or to the rows being drawn).
     int dst_y_end = dst_y_start + src_y_dst_height;
-    if (dst_y_end > dst_img->h) {
-        dst_y_end = dst_img->h;
+    if (dst_y_end > dst_y_max) {
+        dst_y_end = dst_y_max;
     }
 
     if (dst_delta_x < 0) {
@@ -3222,13 +3653,65 @@ void imlib_draw_image(image_t *dst_img,
     bool is_yuv_color_conversion = src_img->is_yuv && !dst_img->is_yuv;
     bool is_color_conversion = is_bayer_color_conversion || is_yuv_color_conversion;
 
+    // Nearest neighbor and integer area downscaling read rows and pixels front to back at least
+    // as fast as they write them, so every output pixel lands on source pixels that have already
+    // been read. This holds as long as source pixels are no smaller than destination pixels.
+    bool can_scale_in_place = (!(hint & (IMAGE_HINT_BICUBIC | IMAGE_HINT_BILINEAR | IMAGE_HINT_TRANSPOSE)))
+                              && (!((hint & IMAGE_HINT_AREA) && ((src_x_frac & 0xFFFF) || (src_y_frac & 0xFFFF))))
+                              && (dst_delta_x == 1) && (dst_delta_y == 1)
+                              && (dst_x_start == 0) && (dst_y_start == 0)
+                              && (src_x_frac >= 65536) && (src_y_frac >= 65536)
+                              && src_img->is_mutable
+                              && (src_img->pixfmt != PIXFORMAT_BINARY) && (dst_img->pixfmt != PIXFORMAT_BINARY)
+                              && ((src_img_row_bytes / src_img->w) >= (dst_img_row_bytes / dst_img->w));
+
     // Force a deep copy if we cannot use the image in-place.
     bool need_deep_copy = (dst_img->data == src_img->data)
-                          && (is_scaling || (src_img_row_bytes < dst_img_row_bytes) || is_color_conversion);
+                          && ((is_scaling && (!can_scale_in_place))
+                              || (src_img_row_bytes < dst_img_row_bytes) || is_color_conversion);
 
     // Force a deep copy if we are scaling.
     bool is_color_conversion_scaling = is_color_conversion && is_scaling;
 
+    #if (OMV_JPEG_CODEC_ENABLE == 0)
+    // Decode the JPEG one MCU row at a time and draw each row as soon as it's decoded. This
+    // only needs a buffer for one MCU row instead of the whole decoded image.
+    if (is_jpeg && (dst_img->data != src_img->data) && (dst_delta_y > 0)
+        && (!(hint & (IMAGE_HINT_TRANSPOSE | IMAGE_HINT_AREA | IMAGE_HINT_BICUBIC)))
+        && ((new_not_mutable_pixfmt == PIXFORMAT_BINARY)
+            || (new_not_mutable_pixfmt == PIXFORMAT_GRAYSCALE)
+            || (new_not_mutable_pixfmt == PIXFORMAT_RGB565))) {
+        imlib_draw_image_jpeg_data_t data = {
+            .dst_img = dst_img,
+            .dst_x_start = dst_x_start_backup,
+            .dst_y_start = dst_y_start_backup,
+            .x_scale = x_scale,
+            .y_scale = y_scale,
+            .roi = roi,
+            .rgb_channel = rgb_channel,
+            .alpha = alpha,
+            .color_palette = color_palette,
+            .alpha_palette = alpha_palette,
+            // The flips were folded into dst_delta_x/y above.
+            .hint = (hint & ~(IMAGE_HINT_HMIRROR | IMAGE_HINT_VFLIP)) | ((dst_delta_x < 0) ? IMAGE_HINT_HMIRROR : 0),
+            .callback = callback,
+            .callback_arg = callback_arg,
+            .dst_row_override = dst_row_override,
+            .dst_y = dst_y_start,
+            .dst_y_end = dst_y_end,
+            .src_y_offset = roi ? fast_floorf(roi->y * y_scale) : 0,
+            .src_y_lookahead = (hint & IMAGE_HINT_BILINEAR) ? 1 : 0,
+            .h_start = h_start,
+            .h_limit = h_limit,
+        };
+
+        // Keep an extra row around in case the source row advances less than expected.
+        jpeg_decompress_rows(src_img, new_not_mutable_pixfmt, data.src_y_lookahead + 1, roi,
+                             imlib_draw_image_jpeg_cb, &data);
+        return;
+    }
+    #endif
+
     // Make a deep copy of the source image.
     if (need_deep_copy || is_color_conversion_scaling || is_jpeg || is_png) {
         new_src_img.w = src_img->w; // same width as source image
@@ -3256,7 +3739,7 @@ void imlib_draw_image(image_t *dst_img,
                 }
                 case PIXFORMAT_BAYER_ANY:
                 case PIXFORMAT_YUV_ANY: {
-                    memcpy(new_src_img.data, src_img->data, size);
+                    omv_memcpy(new_src_img.data, src_img->data, size);
                     break;
                 }
                 default: {
@@ -3270,7 +3753,7 @@ void imlib_draw_image(image_t *dst_img,
             new_src_img.pixfmt = src_img->pixfmt;
             size_t size = image_size(&new_src_img);
             new_src_img.data = fb_alloc(size, FB_ALLOC_CACHE_ALIGN);
-            memcpy(new_src_img.data, src_img->data, size);
+            omv_memcpy(new_src_img.data, src_img->data, size);
         }
 
         src_img = &new_src_img;
@@ -3412,8 +3895,11 @@ void imlib_draw_image(image_t *dst_img,
     imlib_draw_row_data.callback_arg = callback_arg;
     imlib_draw_row_data.dst_row_override = dst_row_override;
     #ifdef IMLIB_ENABLE_DMA2D
+    // Grayscale to RGB565 is a pixel format conversion DMA2D can do through its CLUT.
     imlib_draw_row_data.dma2d_request = (alpha != 256) || alpha_palette ||
-                                        (hint & (IMAGE_HINT_AREA | IMAGE_HINT_BICUBIC | IMAGE_HINT_BILINEAR));
+                                        (hint & (IMAGE_HINT_AREA | IMAGE_HINT_BICUBIC | IMAGE_HINT_BILINEAR)) ||
+                                        ((dst_img->pixfmt == PIXFORMAT_RGB565) &&
+                                         (imlib_draw_row_data.src_img_pixfmt == PIXFORMAT_GRAYSCALE));
     #endif
 
     imlib_draw_row_setup(&imlib_draw_row_data);
@@ -3548,7 +4034,13 @@ void imlib_draw_image(image_t *dst_img,
                                 for (int i = src_y_index; i < src_y_index_end; i++) {
                                     uint8_t *src_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src_img, i) + src_x_index;
                                     int n = width;
-#if defined(ARM_MATH_DSP)
+#if defined(IMLIB_ENABLE_HELIUM)
+                                    // Tail predication sums the whole row without a scalar loop.
+                                    for (; n > 0; n -= 16, src_row_ptr += 16) {
+                                        mve_pred16_t p = vctp8q(n);
+                                        acc = vaddvaq_p_u8(acc, vld1q_z_u8(src_row_ptr, p), p);
+                                    }
+#elif defined(ARM_MATH_DSP)
                                     uint32_t *src_row_ptr32 = (uint32_t *) src_row_ptr;
 
                                     for (; n > 3; n -= 4) {
@@ -5118,81 +5610,74 @@ void imlib_draw_image(image_t *dst_img,
                 break;
             }
             case PIXFORMAT_GRAYSCALE: {
+                // Source rows are interpolated horizontally once into a cache of two rows
+                // (with 8 fractional bits) and output rows only blend the cached rows vertically.
+                int cache_w = dst_x_end - dst_x_start;
+                uint16_t *cache_rows[2];
+                int cache_index[2] = {-1, -1};
+                cache_rows[0] = fb_alloc(cache_w * sizeof(uint16_t) * 2, FB_ALLOC_PREFER_SPEED);
+                cache_rows[1] = cache_rows[0] + cache_w;
+
                 while (y_not_done) {
                     int src_y_index = next_src_y_index;
-                    uint8_t *src_row_ptr_0, *src_row_ptr_1;
+                    int src_y_index_0, src_y_index_1;
 
-                    // keep row pointers in bounds
+                    // keep row indexes in bounds
                     if (src_y_index < h_start) {
-                        src_row_ptr_0 = src_row_ptr_1 = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src_img, h_start);
+                        src_y_index_0 = src_y_index_1 = h_start;
                     } else if (src_y_index >= h_limit) {
-                        src_row_ptr_0 = src_row_ptr_1 = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src_img, h_limit);
+                        src_y_index_0 = src_y_index_1 = h_limit;
                     } else {
                         // get 2 neighboring rows
-                        int src_y_index_p_1 = src_y_index + 1;
-                        src_row_ptr_0 = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src_img, src_y_index);
-                        src_row_ptr_1 = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src_img, src_y_index_p_1);
+                        src_y_index_0 = src_y_index;
+                        src_y_index_1 = src_y_index + 1;
                     }
 
-                    do {
-                        // Cache the results of getting the source rows
-                        // used to mix pixels vertically
-                        long smuad_y = (src_y_accum >> 8) & 0xff;
-                        smuad_y |= (256 - smuad_y) << 16;
-
-                        // Must be called per loop to get the address of the temp buffer to blend with
-                        uint8_t *dst_row_ptr = (uint8_t *) imlib_draw_row_get_row_buffer(&imlib_draw_row_data);
-
-                        // X loop iteration variables
-                        int dst_x = dst_x_reset;
-                        long src_x_accum = src_x_accum_reset;
-                        int next_src_x_index = src_x_accum >> 16;
-                        int x = dst_x_start;
-                        bool x_not_done = x < dst_x_end;
-
-                        while (x_not_done) {
-                            int src_x_index = next_src_x_index;
-                            int pixel_00, pixel_10, pixel_01, pixel_11;
-
-                            // keep pixels in bounds
-                            if (src_x_index < w_start) {
-                                pixel_00 = pixel_10 = src_row_ptr_0[w_start];
-                                pixel_01 = pixel_11 = src_row_ptr_1[w_start];
-                            } else if (src_x_index >= w_limit) {
-                                pixel_00 = pixel_10 = src_row_ptr_0[w_limit];
-                                pixel_01 = pixel_11 = src_row_ptr_1[w_limit];
-                            } else {
-                                // get 4 neighboring pixels
-                                int src_x_index_p_1 = src_x_index + 1;
-                                pixel_00 = src_row_ptr_0[src_x_index]; pixel_10 = src_row_ptr_0[src_x_index_p_1];
-                                pixel_01 = src_row_ptr_1[src_x_index]; pixel_11 = src_row_ptr_1[src_x_index_p_1];
-                            }
-
-                            long vertical_avg_0 = (pixel_00 << 16) | pixel_01;
-                            int pixel_l = __SMLAD(smuad_y, vertical_avg_0, 128) >> 8; // vertically average
-
-                            long vertical_avg_1 = (pixel_10 << 16) | pixel_11;
-                            int pixel_r = __SMLAD(smuad_y, vertical_avg_1, 128) >> 8; // vertically average
+                    // Moving down one row keeps the bottom cached row as the new top row.
+                    uint16_t *h_row_ptr_0 = NULL, *h_row_ptr_1 = NULL;
+                    for (int i = 0; i < 2; i++) {
+                        if (cache_index[i] == src_y_index_0) {
+                            h_row_ptr_0 = cache_rows[i];
+                        }
+                        if (cache_index[i] == src_y_index_1) {
+                            h_row_ptr_1 = cache_rows[i];
+                        }
+                    }
 
-                            long horizontal_avg = (pixel_l << 16) | pixel_r;
+                    if (!h_row_ptr_0) {
+                        int i = (h_row_ptr_1 == cache_rows[0]) ? 1 : 0;
+                        imlib_draw_image_bilinear_grayscale_row(cache_rows[i],
+                                                                IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src_img,
+                                                                                                      src_y_index_0),
+                                                                cache_w, src_x_accum_reset, src_x_frac,
+                                                                w_start, w_limit);
+                        cache_index[i] = src_y_index_0;
+                        h_row_ptr_0 = cache_rows[i];
+                    }
 
-                            do {
-                                // Cache the results of getting the source pixels
-                                // used to mix pixels horizontally
-                                long smuad_x = (src_x_accum >> 8) & 0xff;
-                                smuad_x |= (256 - smuad_x) << 16;
+                    if (!h_row_ptr_1) {
+                        int i = (h_row_ptr_0 == cache_rows[0]) ? 1 : 0;
+                        imlib_draw_image_bilinear_grayscale_row(cache_rows[i],
+                                                                IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src_img,
+                                                                                                      src_y_index_1),
+                                                                cache_w, src_x_accum_reset, src_x_frac,
+                                                                w_start, w_limit);
+                        cache_index[i] = src_y_index_1;
+                        h_row_ptr_1 = cache_rows[i];
+                    }
 
-                                int pixel = __SMLAD(smuad_x, horizontal_avg, 128) >> 8; // horizontally average
+                    do {
+                        // used to mix rows vertically
+                        int weight_1 = (src_y_accum >> 8) & 0xff;
+                        int weight_0 = 256 - weight_1;
 
-                                IMAGE_PUT_GRAYSCALE_PIXEL_FAST(dst_row_ptr, dst_x, pixel);
+                        // Must be called per loop to get the address of the temp buffer to blend with
+                        uint8_t *dst_row_ptr = (uint8_t *) imlib_draw_row_get_row_buffer(&imlib_draw_row_data);
 
-                                // Increment offsets
-                                dst_x += dst_delta_x;
-                                src_x_accum += src_x_frac;
-                                next_src_x_index = src_x_accum >> 16;
-                                x_not_done = ++x < dst_x_end;
-                            } while (x_not_done && (src_x_index == next_src_x_index));
-                        } // while x
+                        for (int i = 0, dst_x = dst_x_reset; i < cache_w; i++, dst_x += dst_delta_x) {
+                            int pixel = ((h_row_ptr_0[i] * weight_0) + (h_row_ptr_1[i] * weight_1) + 32768) >> 16;
+                            IMAGE_PUT_GRAYSCALE_PIXEL_FAST(dst_row_ptr, dst_x, pixel);
+                        }
 
                         imlib_draw_row(dst_x_start, dst_x_end, dst_y, &imlib_draw_row_data);
 
@@ -5203,6 +5688,8 @@ void imlib_draw_image(image_t *dst_img,
                         y_not_done = ++y < dst_y_end;
                     } while (y_not_done && (src_y_index == next_src_y_index));
                 } // while y
+
+                fb_free(); // cache_rows
                 break;
             }
             case PIXFORMAT_RGB565: {
@@ -5685,6 +6172,175 @@ void imlib_draw_image(image_t *dst_img,
     }
 }
 
+// Maps a grayscale image through an RGB565 color palette, this is what to_rainbow()/to_ironbow()
+// and friends boil down to. The image is walked back to front so it can be converted in place.
+static void imlib_draw_image_color_palette(image_t *dst_img, image_t *src_img, const uint16_t *color_palette) {
+    const uint8_t *src8 = src_img->data;
+    uint16_t *dst16 = (uint16_t *) dst_img->data;
+    size_t n = src_img->w * src_img->h;
+
+    for (; n & 3; ) {
+        n -= 1;
+        dst16[n] = color_palette[src8[n]];
+    }
+
+    // Four pixels per source word load and two pixels per destination word store.
+    for (uint32_t *dst32 = (uint32_t *) (dst16 + n); n; ) {
+        n -= 4;
+        uint32_t pixels = *((uint32_t *) (src8 + n));
+        dst32 -= 2;
+        dst32[1] = color_palette[(pixels >> 16) & 0xFF] | (color_palette[pixels >> 24] << 16);
+        dst32[0] = color_palette[pixels & 0xFF] | (color_palette[(pixels >> 8) & 0xFF] << 16);
+    }
+}
+
+// Quantizes the GRAYSCALE/RGB565 row drawn into the row buffer into the tensor row.
+static void imlib_draw_image_tensor_row(int x_start, int x_end, int y_row, imlib_draw_row_data_t *data) {
+    image_t *tensor = (image_t *) data->callback_arg;
+    uint8_t *row_8 = IMAGE_COMPUTE_TENSOR_PIXEL_ROW_PTR(tensor, y_row) + (x_start * tensor->bpp);
+    int shift = (tensor->subfmt_id == SUBFORMAT_ID_TENSOR_INT8) ? 0x80 : 0;
+
+    if (tensor->bpp == PIXFORMAT_BPP_TENSOR_GRAY) {
+        uint8_t *src8 = ((uint8_t *) data->dst_row_override) + x_start;
+        for (int x = 0, n = x_end - x_start; x < n; x++) {
+            row_8[x] = src8[x] ^ shift;
+        }
+    } else {
+        uint16_t *src16 = ((uint16_t *) data->dst_row_override) + x_start;
+        for (int x = 0, n = x_end - x_start; x < n; x++, row_8 += 3) {
+            int pixel = src16[x];
+            row_8[0] = COLOR_RGB565_TO_R8(pixel) ^ shift;
+            row_8[1] = COLOR_RGB565_TO_G8(pixel) ^ shift;
+            row_8[2] = COLOR_RGB565_TO_B8(pixel) ^ shift;
+        }
+    }
+}
+
+// Dequantizes a tensor into a GRAYSCALE/RGB565 image of the same size.
+static void imlib_draw_image_tensor_to_image(image_t *dst_img, image_t *src_img) {
+    int shift = (src_img->subfmt_id == SUBFORMAT_ID_TENSOR_INT8) ? 0x80 : 0;
+
+    for (int y = 0; y < src_img->h; y++) {
+        uint8_t *src8 = IMAGE_COMPUTE_TENSOR_PIXEL_ROW_PTR(src_img, y);
+
+        if (dst_img->pixfmt == PIXFORMAT_GRAYSCALE) {
+            uint8_t *dst8 = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(dst_img, y);
+            for (int x = 0; x < src_img->w; x++) {
+                dst8[x] = src8[x] ^ shift;
+            }
+        } else {
+            uint16_t *dst16 = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(dst_img, y);
+            for (int x = 0; x < src_img->w; x++, src8 += 3) {
+                dst16[x] = COLOR_R8_G8_B8_TO_RGB565(src8[0] ^ shift, src8[1] ^ shift, src8[2] ^ shift);
+            }
+        }
+    }
+}
+
+// Tensors are drawn as GRAYSCALE/RGB565 one row at a time and each row is quantized into the
+// tensor while it's still in cache. Blending would read back the row buffer instead of the tensor,
+// so tensors are always drawn opaque, and tensor destinations don't take a row callback.
+static void imlib_draw_image_tensor(image_t *dst_img,
+                                    image_t *src_img,
+                                    int dst_x_start,
+                                    int dst_y_start,
+                                    float x_scale,
+                                    float y_scale,
+                                    rectangle_t *roi,
+                                    int rgb_channel,
+                                    int alpha,
+                                    const uint16_t *color_palette,
+                                    const uint8_t *alpha_palette,
+                                    image_hint_t hint,
+                                    imlib_draw_row_callback_t callback,
+                                    void *callback_arg,
+                                    void *dst_row_override) {
+    image_t new_src_img;
+
+    // Tensor rows are a different size than the GRAYSCALE/RGB565 rows, so they can't be
+    // converted in place.
+    if (src_img->is_tensor || (src_img->data == dst_img->data)) {
+        new_src_img.w = src_img->w;
+        new_src_img.h = src_img->h;
+        new_src_img.pixfmt = src_img->pixfmt;
+        new_src_img.size = src_img->size;
+
+        if (src_img->is_tensor) {
+            new_src_img.pixfmt = src_img->is_color ? PIXFORMAT_RGB565 : PIXFORMAT_GRAYSCALE;
+            new_src_img.data = fb_alloc(image_size(&new_src_img), FB_ALLOC_CACHE_ALIGN);
+            imlib_draw_image_tensor_to_image(&new_src_img, src_img);
+        } else {
+            new_src_img.data = fb_alloc(image_size(&new_src_img), FB_ALLOC_CACHE_ALIGN);
+            omv_memcpy(new_src_img.data, src_img->data, image_size(&new_src_img));
+        }
+
+        src_img = &new_src_img;
+    }
+
+    if (dst_img->is_tensor) {
+        image_t new_dst_img;
+        new_dst_img.w = dst_img->w;
+        new_dst_img.h = dst_img->h;
+        new_dst_img.pixfmt = dst_img->is_color ? PIXFORMAT_RGB565 : PIXFORMAT_GRAYSCALE;
+        new_dst_img.data = dst_img->data;
+
+        void *row_buffer = fb_alloc(image_line_size(&new_dst_img), FB_ALLOC_PREFER_SPEED | FB_ALLOC_CACHE_ALIGN);
+        int_imlib_draw_image(&new_dst_img, src_img, dst_x_start, dst_y_start, x_scale, y_scale, roi,
+                             rgb_channel, 256, color_palette, NULL, hint,
+                             imlib_draw_image_tensor_row, dst_img, row_buffer, 0, dst_img->h);
+        fb_free(); // row_buffer
+    } else {
+        int_imlib_draw_image(dst_img, src_img, dst_x_start, dst_y_start, x_scale, y_scale, roi,
+                             rgb_channel, alpha, color_palette, alpha_palette, hint,
+                             callback, callback_arg, dst_row_override, 0, dst_img->h);
+    }
+
+    if (src_img == &new_src_img) {
+        fb_free();
+    }
+}
+
+void imlib_draw_image(image_t *dst_img,
+                      image_t *src_img,
+                      int dst_x_start,
+                      int dst_y_start,
+                      float x_scale,
+                      float y_scale,
+                      rectangle_t *roi,
+                      int rgb_channel,
+                      int alpha,
+                      const uint16_t *color_palette,
+                      const uint8_t *alpha_palette,
+                      image_hint_t hint,
+                      imlib_draw_row_callback_t callback,
+                      void *callback_arg,
+                      void *dst_row_override) {
+    TRACE_PROF_SCOPE(TRACE_PROF_DRAW_IMAGE);
+
+    if (dst_img->is_tensor || src_img->is_tensor) {
+        imlib_draw_image_tensor(dst_img, src_img, dst_x_start, dst_y_start, x_scale, y_scale, roi,
+                                rgb_channel, alpha, color_palette, alpha_palette, hint,
+                                callback, callback_arg, dst_row_override);
+        return;
+    }
+
+    // Applying a color palette to a whole grayscale image doesn't need the row machinery.
+    if ((src_img->pixfmt == PIXFORMAT_GRAYSCALE) && (dst_img->pixfmt == PIXFORMAT_RGB565)
+        && (src_img->w == dst_img->w) && (src_img->h == dst_img->h)
+        && (!dst_x_start) && (!dst_y_start) && (x_scale == 1.f) && (y_scale == 1.f)
+        && ((!roi) || ((!roi->x) && (!roi->y) && (roi->w == src_img->w) && (roi->h == src_img->h)))
+        && color_palette && (alpha == 256) && (!alpha_palette) && (!callback) && (!dst_row_override)
+        && (!(hint & (IMAGE_HINT_AREA | IMAGE_HINT_BILINEAR | IMAGE_HINT_BICUBIC |
+                      IMAGE_HINT_HMIRROR | IMAGE_HINT_VFLIP | IMAGE_HINT_TRANSPOSE)))) {
+        imlib_draw_image_color_palette(dst_img, src_img, color_palette);
+        return;
+    }
+
+    int_imlib_draw_image(dst_img, src_img, dst_x_start, dst_y_start, x_scale, y_scale, roi,
+                         rgb_channel, alpha, color_palette, alpha_palette, hint,
+                         callback, callback_arg, dst_row_override, 0, dst_img->h);
+}
+
 #ifdef IMLIB_ENABLE_FLOOD_FILL
 void imlib_flood_fill(image_t *img, int x, int y,
                       float seed_threshold, float floating_threshold,
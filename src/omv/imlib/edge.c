@@ -13,13 +13,105 @@
 #include <string.h>
 #include "imlib.h"
 #include "fb_alloc.h"
-#ifdef IMLIB_ENABLE_BINARY_OPS
 
-typedef struct gvec {
-    uint16_t t;
-    uint16_t g;
-} gvec_t;
+// Vertical then horizontal pass of the separable Sobel kernels (1 2 1) x (1 0 -1) on n + 2
+// pixels of 3 rows. Both passes are done in place in gx/gy, where each value is only
+// overwritten after the last result that needs it.
+static void imlib_sobel_kernel(const uint8_t *r0, const uint8_t *r1, const uint8_t *r2,
+                               int n, int16_t *gx, int16_t *gy) {
+    int i = 0;
+
+    #if defined(ARM_MATH_DSP)
+    for (; (i + 4) <= (n + 2); i += 4) {
+        uint32_t a = *((uint32_t *) (r0 + i));
+        uint32_t b = *((uint32_t *) (r1 + i));
+        uint32_t c = *((uint32_t *) (r2 + i));
+        // Pixels 0 and 2 (even) and pixels 1 and 3 (odd) as 16-bit lanes.
+        uint32_t a_e = __UXTB16(a), a_o = __UXTB16_RORn(a, 8);
+        uint32_t b_e = __UXTB16(b), b_o = __UXTB16_RORn(b, 8);
+        uint32_t c_e = __UXTB16(c), c_o = __UXTB16_RORn(c, 8);
+        uint32_t s_e = __SADD16(__SADD16(a_e, c_e), __SADD16(b_e, b_e));
+        uint32_t s_o = __SADD16(__SADD16(a_o, c_o), __SADD16(b_o, b_o));
+        uint32_t d_e = __SSUB16(a_e, c_e);
+        uint32_t d_o = __SSUB16(a_o, c_o);
+        *((uint32_t *) (gx + i + 0)) = __PKHBT(s_e, s_o, 16);
+        *((uint32_t *) (gx + i + 2)) = __PKHTB(s_o, s_e, 16);
+        *((uint32_t *) (gy + i + 0)) = __PKHBT(d_e, d_o, 16);
+        *((uint32_t *) (gy + i + 2)) = __PKHTB(d_o, d_e, 16);
+    }
+    #endif
+
+    for (; i < (n + 2); i++) {
+        gx[i] = r0[i] + (r1[i] << 1) + r2[i];
+        gy[i] = r0[i] - r2[i];
+    }
+
+    i = 0;
+
+    #if defined(ARM_MATH_DSP)
+    for (; (i + 2) <= n; i += 2) {
+        uint32_t s_01 = *((uint32_t *) (gx + i + 0));
+        uint32_t s_23 = *((uint32_t *) (gx + i + 2));
+        uint32_t d_01 = *((uint32_t *) (gy + i + 0));
+        uint32_t d_12 = *((uint32_t *) (gy + i + 1));
+        uint32_t d_23 = *((uint32_t *) (gy + i + 2));
+        *((uint32_t *) (gx + i)) = __SSUB16(s_01, s_23);
+        *((uint32_t *) (gy + i)) = __SADD16(__SADD16(d_01, d_23), __SADD16(d_12, d_12));
+    }
+    #endif
+
+    for (; i < n; i++) {
+        gx[i] = gx[i] - gx[i + 2];
+        gy[i] = gy[i] + (gy[i + 1] * 2) + gy[i + 2];
+    }
+}
+
+void imlib_sobel_row(image_t *img, int y, int x_start, int x_end, uint8_t *lines, int16_t *gx, int16_t *gy) {
+    int n = x_end - x_start;
+    const uint8_t *rows[3];
+
+    if (n <= 0) {
+        return;
+    }
+
+    for (int j = 0; j < 3; j++) {
+        int y_j = y + j - 1;
+        switch (img->pixfmt) {
+            case PIXFORMAT_BINARY: {
+                uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y_j);
+                uint8_t *line = lines + (j * (n + 2));
+                for (int i = 0; i < (n + 2); i++) {
+                    line[i] = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x_start - 1 + i));
+                }
+                rows[j] = line;
+                break;
+            }
+            case PIXFORMAT_GRAYSCALE: {
+                rows[j] = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y_j) + x_start - 1;
+                break;
+            }
+            case PIXFORMAT_RGB565: {
+                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y_j);
+                uint8_t *line = lines + (j * (n + 2));
+                for (int i = 0; i < (n + 2); i++) {
+                    line[i] = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x_start - 1 + i));
+                }
+                rows[j] = line;
+                break;
+            }
+            default: {
+                uint8_t *line = lines + (j * (n + 2));
+                memset(line, 0, n + 2);
+                rows[j] = line;
+                break;
+            }
+        }
+    }
+
+    imlib_sobel_kernel(rows[0], rows[1], rows[2], n, gx, gy);
+}
 
+#ifdef IMLIB_ENABLE_BINARY_OPS
 void imlib_edge_simple(image_t *src, rectangle_t *roi, int low_thresh, int high_thresh) {
     imlib_morph(src, 1, kernel_high_pass_3, 1.0f, 0.0f, false, 0, false, NULL);
     list_t thresholds;
@@ -33,124 +125,125 @@ void imlib_edge_simple(image_t *src, rectangle_t *roi, int low_thresh, int high_
     imlib_erode(src, 1, 2, NULL);
 }
 
+// Quantizes the gradient angle |atan2(vy, vx)| to 0 (0), 1 (45), 2 (90) or 3 (135) degrees
+// by comparing against the bin edges (22, 67, 112 and 160 degrees) as Q12 tangents.
+static inline int canny_direction(int vx, int vy) {
+    int ay = abs(vy) << 12;
+    if (vx >= 0) {
+        if (ay <= (vx * 1655)) {
+            return 0; // tan(22)
+        } else if (ay < (vx * 9650)) {
+            return 1; // tan(67)
+        }
+        return 2;
+    } else if (ay > (-vx * 10138)) {
+        return 2; // tan(180 - 112)
+    } else if (ay > (-vx * 1491)) {
+        return 3; // tan(180 - 160)
+    }
+    return 0;
+}
+
+// Squared gradient magnitude and direction of the ROI row y, the ROI border is zero.
+static void canny_gradient_row(image_t *src, rectangle_t *roi, int y,
+                               uint32_t *mag, uint8_t *dir, int16_t *gx, int16_t *gy) {
+    if ((y <= roi->y) || (y >= (roi->y + roi->h - 1))) {
+        memset(mag, 0, roi->w * sizeof(uint32_t));
+        return;
+    }
+
+    imlib_sobel_row(src, y, roi->x + 1, roi->x + roi->w - 1, NULL, gx, gy);
+    mag[0] = mag[roi->w - 1] = 0;
+
+    for (int x = 1; x < (roi->w - 1); x++) {
+        int vx = gx[x - 1], vy = gy[x - 1];
+        mag[x] = (vx * vx) + (vy * vy);
+        dir[x] = canny_direction(vx, vy);
+    }
+}
+
 void imlib_edge_canny(image_t *src, rectangle_t *roi, int low_thresh, int high_thresh) {
-    int w = src->w;
+    int w = roi->w;
+    // Squared magnitudes threshold the same as the magnitudes.
+    uint32_t low = (low_thresh > 0) ? (low_thresh * low_thresh) : 0;
+    uint32_t high = (high_thresh > 0) ? (high_thresh * high_thresh) : 0;
 
-    gvec_t *gm = fb_alloc0(roi->w * roi->h * sizeof *gm, FB_ALLOC_NO_HINT);
+    // Rows y - 1, y and y + 1 of the gradients, so the full gradient map isn't needed.
+    uint32_t *mag = fb_alloc(w * 3 * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    uint8_t *dir = fb_alloc(w * 3, FB_ALLOC_NO_HINT);
+    int16_t *gx = fb_alloc(w * sizeof(int16_t), FB_ALLOC_NO_HINT);
+    int16_t *gy = fb_alloc(w * sizeof(int16_t), FB_ALLOC_NO_HINT);
 
     //1. Noise Reduction with a Gaussian filter
     imlib_sepconv3(src, kernel_gauss_3, 1.0f / 16.0f, 0.0f);
 
     //2. Finding Image Gradients
-    for (int gy = 1, y = roi->y + 1; y < roi->y + roi->h - 1; y++, gy++) {
-        for (int gx = 1, x = roi->x + 1; x < roi->x + roi->w - 1; x++, gx++) {
-            int vx = 0, vy = 0;
-            // sobel kernel in the horizontal direction
-            vx = src->data [(y - 1) * w + x - 1]
-                 - src->data [(y - 1) * w + x + 1]
-                 + (src->data[(y + 0) * w + x - 1] << 1)
-                 - (src->data[(y + 0) * w + x + 1] << 1)
-                 + src->data [(y + 1) * w + x - 1]
-                 - src->data [(y + 1) * w + x + 1];
-
-            // sobel kernel in the vertical direction
-            vy = src->data [(y - 1) * w + x - 1]
-                 + (src->data[(y - 1) * w + x + 0] << 1)
-                 + src->data [(y - 1) * w + x + 1]
-                 - src->data [(y + 1) * w + x - 1]
-                 - (src->data[(y + 1) * w + x + 0] << 1)
-                 - src->data [(y + 1) * w + x + 1];
-
-            // Find magnitude
-            int g = (int) fast_sqrtf(vx * vx + vy * vy);
-            // Find the direction and round angle to 0, 45, 90 or 135
-            int t = (int) fast_fabsf((atan2f(vy, vx) * 180.0f / M_PI));
-            if (t < 22) {
-                t = 0;
-            } else if (t < 67) {
-                t = 45;
-            } else if (t < 112) {
-                t = 90;
-            } else if (t < 160) {
-                t = 135;
-            } else if (t <= 180) {
-                t = 0;
-            }
+    canny_gradient_row(src, roi, roi->y, mag, dir, gx, gy);
+    canny_gradient_row(src, roi, roi->y + 1, mag + w, dir + w, gx, gy);
 
-            gm[gy * roi->w + gx].t = t;
-            gm[gy * roi->w + gx].g = g;
-        }
-    }
+    for (int gy_i = 0, y = roi->y; y < roi->y + roi->h; y++, gy_i++) {
+        uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src, y) + roi->x;
 
-    // 3. Hysteresis Thresholding
-    // 4. Non-maximum Suppression and output
-    for (int gy = 0, y = roi->y; y < roi->y + roi->h; y++, gy++) {
-        for (int gx = 0, x = roi->x; x < roi->x + roi->w; x++, gx++) {
-            int i = y * w + x;
-            gvec_t *va = NULL, *vb = NULL, *vc = &gm[gy * roi->w + gx];
-
-            // Clear the borders
-            if (y == (roi->y) || y == (roi->y + roi->h - 1) ||
-                x == (roi->x) || x == (roi->x + roi->w - 1)) {
-                src->data[i] = 0;
-                continue;
-            }
+        // The next rows gradients read this row, so they must be computed before it's written.
+        int next = (gy_i + 1) % 3;
+        canny_gradient_row(src, roi, y + 1, mag + (next * w), dir + (next * w), gx, gy);
 
-            if (vc->g < low_thresh) {
-                // Not an edge
-                src->data[i] = 0;
-                continue;
-                // Check if strong or weak edge
-            } else if (vc->g >= high_thresh ||
-                       gm[(gy - 1) * roi->w + (gx - 1)].g >= high_thresh ||
-                       gm[(gy - 1) * roi->w + (gx + 0)].g >= high_thresh ||
-                       gm[(gy - 1) * roi->w + (gx + 1)].g >= high_thresh ||
-                       gm[(gy + 0) * roi->w + (gx - 1)].g >= high_thresh ||
-                       gm[(gy + 0) * roi->w + (gx + 1)].g >= high_thresh ||
-                       gm[(gy + 1) * roi->w + (gx - 1)].g >= high_thresh ||
-                       gm[(gy + 1) * roi->w + (gx + 0)].g >= high_thresh ||
-                       gm[(gy + 1) * roi->w + (gx + 1)].g >= high_thresh) {
-                vc->g = vc->g;
-            } else {
-                // Not an edge
-                src->data[i] = 0;
+        // Clear the borders
+        if ((y == roi->y) || (y == (roi->y + roi->h - 1))) {
+            memset(row_ptr, 0, w);
+            continue;
+        }
+
+        uint32_t *m0 = mag + (((gy_i + 2) % 3) * w);
+        uint32_t *m1 = mag + ((gy_i % 3) * w);
+        uint32_t *m2 = mag + (next * w);
+        uint8_t *d1 = dir + ((gy_i % 3) * w);
+        row_ptr[0] = row_ptr[w - 1] = 0;
+
+        for (int x = 1; x < (w - 1); x++) {
+            uint32_t g = m1[x], ga, gb;
+
+            // 3. Hysteresis Thresholding
+            if ((g < low) ||
+                !((g >= high) ||
+                  (m0[x - 1] >= high) || (m0[x] >= high) || (m0[x + 1] >= high) ||
+                  (m1[x - 1] >= high) || (m1[x + 1] >= high) ||
+                  (m2[x - 1] >= high) || (m2[x] >= high) || (m2[x + 1] >= high))) {
+                row_ptr[x] = 0;
                 continue;
             }
 
-            switch (vc->t) {
+            // 4. Non-maximum Suppression and output
+            switch (d1[x]) {
                 case 0: {
-                    va = &gm[(gy + 0) * roi->w + (gx - 1)];
-                    vb = &gm[(gy + 0) * roi->w + (gx + 1)];
+                    ga = m1[x - 1];
+                    gb = m1[x + 1];
                     break;
                 }
-
-                case 45: {
-                    va = &gm[(gy + 1) * roi->w + (gx - 1)];
-                    vb = &gm[(gy - 1) * roi->w + (gx + 1)];
+                case 1: {
+                    ga = m2[x - 1];
+                    gb = m0[x + 1];
                     break;
                 }
-
-                case 90: {
-                    va = &gm[(gy + 1) * roi->w + (gx + 0)];
-                    vb = &gm[(gy - 1) * roi->w + (gx + 0)];
+                case 2: {
+                    ga = m2[x];
+                    gb = m0[x];
                     break;
                 }
-
-                case 135: {
-                    va = &gm[(gy + 1) * roi->w + (gx + 1)];
-                    vb = &gm[(gy - 1) * roi->w + (gx - 1)];
+                default: {
+                    ga = m2[x + 1];
+                    gb = m0[x - 1];
                     break;
                 }
             }
 
-            if (!(vc->g > va->g && vc->g > vb->g)) {
-                src->data[i] = 0;
-            } else {
-                src->data[i] = 255;
-            }
+            row_ptr[x] = ((g > ga) && (g > gb)) ? 255 : 0;
         }
     }
 
-    fb_free();
+    fb_free(); // gy
+    fb_free(); // gx
+    fb_free(); // dir
+    fb_free(); // mag
 }
 #endif
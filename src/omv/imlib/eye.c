@@ -9,10 +9,15 @@
  * Pupil localization using image gradients. See Fabian Timm's paper for details.
  */
 #include "imlib.h"
-#include "xalloc.h"
+#include "fb_alloc.h"
 #include "fmath.h"
 
-static void find_gradients(image_t *src, array_t *gradients, int x_off, int y_off, int box_w, int box_h) {
+// A center scores at most its weight (squared cosines are at most 1), the margin covers rounding.
+#define IRIS_BOUND_MARGIN   1.01f
+
+static int find_gradients(image_t *src, vec_t *gradients, int x_off, int y_off, int box_w, int box_h) {
+    int n = 0;
+
     for (int y = y_off; y < y_off + box_h - 3; y++) {
         for (int x = x_off; x < x_off + box_w - 3; x++) {
             int vx = 0, vy = 0, w = src->w;
@@ -34,100 +39,154 @@ static void find_gradients(image_t *src, array_t *gradients, int x_off, int y_of
 
             float m = fast_sqrtf(vx * vx + vy * vy);
             if (m > 200) {
-                vec_t *v = xalloc(sizeof(vec_t));
+                vec_t *v = &gradients[n++];
                 v->m = m;
                 v->x = vx / m;
                 v->y = vy / m;
                 v->cx = x + 1;
                 v->cy = y + 1;
-                array_push_back(gradients, v);
             }
         }
     }
+
+    return n;
 }
 
 // TODO use the gradients median not average
-static void filter_gradients(array_t *gradients) {
+static int filter_gradients(vec_t *gradients, int n) {
     float total_m = 0.0f;
-    for (int i = 0; i < array_length(gradients); i++) {
-        vec_t *v = (vec_t *) array_at(gradients, i);
-        total_m += v->m;
+    for (int i = 0; i < n; i++) {
+        total_m += gradients[i].m;
     }
 
-    float avg_m = total_m / array_length(gradients);
+    float avg_m = total_m / n;
+    int kept = 0;
 
-    for (int i = 0; i < array_length(gradients); i++) {
-        vec_t *v = (vec_t *) array_at(gradients, i);
-        float diff = (v->m - avg_m) * (v->m - avg_m);
+    for (int i = 0; i < n; i++) {
+        float diff = (gradients[i].m - avg_m) * (gradients[i].m - avg_m);
         if (fast_sqrtf(diff) > 100) {
-            array_erase(gradients, i);
+            // The gradient after a dropped one is kept untested, like the array_erase() loop this
+            // replaces did, so that the same centers win.
+            if ((i + 1) < n) {
+                gradients[kept++] = gradients[++i];
+            }
+        } else {
+            gradients[kept++] = gradients[i];
         }
     }
+
+    return kept;
 }
 
-static void find_iris(image_t *src, array_t *gradients, int x_off, int y_off, int box_w, int box_h, point_t *e) {
+static float score_center(image_t *src, vec_t *gradients, int n, int x, int y) {
+    float sum_dot = 0.0f;
+
+    for (int i = 0; i < n; i++) {
+        // get gradient vector  g
+        vec_t *v = &gradients[i];
+
+        // get vector from gradient to centor d
+        vec_t d = {x - v->cx, y - v->cy};
+
+        // normalize d vector
+        float m = fast_sqrtf(d.x * d.x + d.y * d.y);
+        d.x = d.x / m;
+        d.y = d.y / m;
+
+        // compute the dot product d.g
+        float t = (d.x * v->x) + (d.y * v->y);
+
+        // d,g should point the same direction
+        if (t > 0.0) {
+            // dark centres are more likely to be pupils than
+            // bright centres, so we use the grayscale value as weight.
+            sum_dot += t * t * (255 - src->data[y * src->w + x]);
+        }
+    }
+
+    return sum_dot / n;
+}
+
+// Scores the centers darkest first and stops once the weight of the next center is below the best
+// score, the result is the same as scoring every center in raster order.
+static void find_iris(image_t *src, vec_t *gradients, int n, int x_off, int y_off, int box_w, int box_h, point_t *e) {
+    uint32_t *order = fb_alloc(box_w * box_h * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    uint32_t bins[256] = {0};
+
+    for (int y = y_off; y < y_off + box_h; y++) {
+        for (int x = x_off; x < x_off + box_w; x++) {
+            bins[src->data[y * src->w + x]]++;
+        }
+    }
+
+    for (int i = 0, sum = 0; i < 256; i++) {
+        int count = bins[i];
+        bins[i] = sum;
+        sum += count;
+    }
+
+    for (int y = y_off, i = 0; y < y_off + box_h; y++) {
+        for (int x = x_off; x < x_off + box_w; x++, i++) {
+            order[bins[src->data[y * src->w + x]]++] = i;
+        }
+    }
+
     int max_x = 0;
     int max_y = 0;
+    uint32_t max_i = 0;
     float max_dot = 0.0f;
 
-    for (int y = y_off; y < y_off + box_h; y++) {
-        for (int x = x_off; x < x_off + box_w; x++) {
-            float sum_dot = 0.0f;
-            for (int i = 0; i < array_length(gradients); i++) {
-                // get gradient vector  g
-                vec_t *v = (vec_t *) array_at(gradients, i);
-
-                // get vector from gradient to centor d
-                vec_t d = {x - v->cx, y - v->cy};
-
-                // normalize d vector
-                float m = fast_sqrtf(d.x * d.x + d.y * d.y);
-                d.x = d.x / m;
-                d.y = d.y / m;
-
-                // compute the dot product d.g
-                float t = (d.x * v->x) + (d.y * v->y);
-
-                // d,g should point the same direction
-                if (t > 0.0) {
-                    // dark centres are more likely to be pupils than
-                    // bright centres, so we use the grayscale value as weight.
-                    sum_dot += t * t * (255 - src->data[y * src->w + x]);
-                }
-            }
-            sum_dot = sum_dot / array_length(gradients);
+    for (int j = 0; j < box_w * box_h; j++) {
+        uint32_t i = order[j];
+        int x = x_off + (i % box_w);
+        int y = y_off + (i / box_w);
 
-            if (sum_dot > max_dot) {
-                max_dot = sum_dot;
-                max_x = x;
-                max_y = y;
-            }
+        if (((255 - src->data[y * src->w + x]) * IRIS_BOUND_MARGIN) < max_dot) {
+            break;
+        }
+
+        // Ties go to the first center in raster order.
+        float sum_dot = score_center(src, gradients, n, x, y);
+        if ((sum_dot > max_dot) || ((sum_dot == max_dot) && (max_dot > 0.0f) && (i < max_i))) {
+            max_dot = sum_dot;
+            max_i = i;
+            max_x = x;
+            max_y = y;
         }
     }
 
+    fb_free(); // order
+
     e->x = max_x;
     e->y = max_y;
 }
 
 // This function should be called on an ROI detected with the eye Haar cascade.
 void imlib_find_iris(image_t *src, point_t *iris, rectangle_t *roi) {
-    array_t *iris_gradients;
-    array_alloc(&iris_gradients, xfree);
-
     // Tune these offsets to skip eyebrows and reduce window size
     int box_w = roi->w - ((int) (0.15f * roi->w));
     int box_h = roi->h - ((int) (0.40f * roi->h));
     int x_off = roi->x + ((int) (0.15f * roi->w));
     int y_off = roi->y + ((int) (0.40f * roi->h));
 
+    iris->x = 0;
+    iris->y = 0;
+
+    if ((box_w <= 3) || (box_h <= 3)) {
+        return;
+    }
+
     // find gradients with strong magnitudes
-    find_gradients(src, iris_gradients,  x_off, y_off, box_w, box_h);
+    vec_t *gradients = fb_alloc((box_w - 3) * (box_h - 3) * sizeof(vec_t), FB_ALLOC_NO_HINT);
+    int n = find_gradients(src, gradients, x_off, y_off, box_w, box_h);
 
     // filter gradients
-    filter_gradients(iris_gradients);
+    n = filter_gradients(gradients, n);
 
     // search for iriss
-    find_iris(src, iris_gradients, x_off, y_off, box_w, box_h, iris);
+    if (n) {
+        find_iris(src, gradients, n, x_off, y_off, box_w, box_h, iris);
+    }
 
-    array_free(iris_gradients);
+    fb_free(); // gradients
 }
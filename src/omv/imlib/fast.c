@@ -1,56 +1,50 @@
 /*
- * NOTE: This code is mostly auto-generated.
- * See https://www.edwardrosten.com/work/fast.html
+ * This file is part of the OpenMV project.
  *
- * Copyright (c) 2006, 2008, 2009, 2010 Edward Rosten All rights reserved.
+ * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
  *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions
- * are met:
+ * This work is licensed under the MIT license, see the file LICENSE for details.
  *
- *      *Redistributions of source code must retain the above copyright
- *       notice, this list of conditions and the following disclaimer.
- *      *Redistributions in binary form must reproduce the above copyright
- *       notice, this list of conditions and the following disclaimer in the
- *       documentation and/or other materials provided with the distribution.
- *      *Neither the name of the University of Cambridge nor the names of
- *       its contributors may be used to endorse or promote products derived
- *       from this software without specific prior written permission.
- *
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
- * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
- * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
- * A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
- * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
- * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
- * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
- * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
- * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
- * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
- * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * FAST-9 and AGAST-5_8 corner detection.
  */
 #include <stdio.h>
+#include <string.h>
 #include "imlib.h"
 #include "xalloc.h"
 #include "fb_alloc.h"
 #include "gc.h"
 
-#ifdef IMLIB_ENABLE_FAST
-
-#define MIN_MEM          (10 * 1024)
-#define MAX_CORNERS      (2000U)
-#define Compare(X, Y)    ((X) >= (Y))
+#define MIN_MEM    (10 * 1024)
 
+// A pixel is a corner if at least arc contiguous pixels on its circle of n pixels are all
+// brighter than center + threshold, or all darker than center - threshold. The circle is
+// listed in order as (x, y) offsets within radius of the center.
 typedef struct {
-    uint16_t x;
-    uint16_t y;
-    uint16_t score;
-} corner_t;
+    int n;
+    int arc;
+    int radius;
+    int8_t offsets[16][2];
+} segment_test_t;
 
-static int pixel[16];
-static corner_t *fast9_detect(image_t *image, rectangle_t *roi, int *n_corners, int b);
-static void fast9_score(image_t *image, corner_t *corners, int num_corners, int b);
-static void nonmax_suppression(corner_t *corners, int num_corners, array_t *keypoints);
+#ifdef IMLIB_ENABLE_FAST
+// Bresenham circle of radius 3.
+static const segment_test_t fast9_test = {
+    .n = 16, .arc = 9, .radius = 3,
+    .offsets = {
+        {0, 3}, {1, 3}, {2, 2}, {3, 1}, {3, 0}, {3, -1}, {2, -2}, {1, -3},
+        {0, -3}, {-1, -3}, {-2, -2}, {-3, -1}, {-3, 0}, {-3, 1}, {-2, 2}, {-1, 3}
+    }
+};
+#endif
+
+// 8-neighbourhood.
+static const segment_test_t agast58_test = {
+    .n = 8, .arc = 5, .radius = 1,
+    .offsets = {
+        {-1, 0}, {-1, -1}, {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}
+    }
+};
 
 static kp_t *alloc_keypoint(uint16_t x, uint16_t y, uint16_t score) {
     // Note must set keypoint descriptor to zeros
@@ -61,130 +55,151 @@ static kp_t *alloc_keypoint(uint16_t x, uint16_t y, uint16_t score) {
     return kpt;
 }
 
-static void make_offsets(int pixel[], int row_stride) {
-    pixel[0] = 0 + row_stride * 3;
-    pixel[1] = 1 + row_stride * 3;
-    pixel[2] = 2 + row_stride * 2;
-    pixel[3] = 3 + row_stride * 1;
-    pixel[4] = 3 + row_stride * 0;
-    pixel[5] = 3 + row_stride * -1;
-    pixel[6] = 2 + row_stride * -2;
-    pixel[7] = 1 + row_stride * -3;
-    pixel[8] = 0 + row_stride * -3;
-    pixel[9] = -1 + row_stride * -3;
-    pixel[10] = -2 + row_stride * -2;
-    pixel[11] = -3 + row_stride * -1;
-    pixel[12] = -3 + row_stride * 0;
-    pixel[13] = -3 + row_stride * 1;
-    pixel[14] = -2 + row_stride * 2;
-    pixel[15] = -1 + row_stride * 3;
+// Returns true if bits (bit k set for circle pixel k) has a run of at least arc ones around
+// the circle. The circle is repeated once so that runs wrapping past pixel n - 1 are contiguous.
+static inline bool segment_test_arc(uint32_t bits, int n, int arc) {
+    bits |= bits << n;
+    for (int run = 1; run < arc; ) {
+        int s = IM_MIN(run, arc - run);
+        bits &= bits >> s;
+        run += s;
+    }
+    return bits != 0;
 }
 
-void fast_detect(image_t *image, array_t *keypoints, int threshold, rectangle_t *roi) {
-    int num_corners = 0;
-    make_offsets(pixel, image->w);
+// The largest threshold p is still a corner for: the best arc's smallest difference minus one.
+static int segment_test_score(const uint8_t *p, const int *offsets, const segment_test_t *test) {
+    int d[32];
+    int bright = 0, dark = 0;
 
-    // Find corners
-    corner_t *corners = fast9_detect(image, roi, &num_corners, threshold);
-    if (num_corners) {
-        // Score corners
-        fast9_score(image, corners, num_corners, threshold);
-        // Non-max suppression
-        nonmax_suppression(corners, num_corners, keypoints);
+    for (int k = 0; k < test->n; k++) {
+        d[k] = d[k + test->n] = p[offsets[k]] - p[0];
     }
 
-    // Free corners;
-    fb_free();
-}
-
-static void nonmax_suppression(corner_t *corners, int num_corners, array_t *keypoints) {
-    gc_info_t info;
+    for (int k = 0; k < test->n; k++) {
+        int d_min = d[k], d_max = d[k];
+        for (int j = 1; j < test->arc; j++) {
+            d_min = IM_MIN(d_min, d[k + j]);
+            d_max = IM_MAX(d_max, d[k + j]);
+        }
+        bright = IM_MAX(bright, d_min);
+        dark = IM_MAX(dark, -d_max);
+    }
 
-    int last_row;
-    int16_t *row_start;
-    const int sz = num_corners;
+    return IM_MAX(bright, dark) - 1;
+}
 
-    /* Point above points (roughly) to the pixel above
-       the one of interest, if there is a feature there.*/
-    int point_above = 0;
-    int point_below = 0;
+// Scores row pixels [x_start, x_end) into scores[x - x_start], as score + 1 for corners and
+// 0 otherwise. Returns the number of corners.
+//
+// The arc is longer than half the circle, so it covers at least one of the pixels at 0 and
+// n/2, and one of the pixels at n/4 and 3n/4. Pixels failing that on both sides are rejected
+// before the rest of the circle is loaded.
+static int segment_test_row(const uint8_t *row, int x_start, int x_end, int threshold,
+                            const int *offsets, const segment_test_t *test, uint8_t *scores) {
+    int n = test->n, q = n / 4, count = 0;
+    int x = x_start;
+
+    #if defined(ARM_MATH_DSP)
+    // 4 centers per word. Saturation is safe: a lane at 255 (0) has nothing brighter (darker).
+    uint32_t threshold_x4 = threshold * 0x01010101;
+    for (; (x + 4) <= x_end; x += 4) {
+        const uint8_t *p = row + x;
+        uint32_t c = *((uint32_t *) p);
+        uint32_t c_hi = __UQADD8(c, threshold_x4);
+        uint32_t c_lo = __UQSUB8(c, threshold_x4);
+        uint32_t bright[4], dark[4];
+
+        for (int k = 0; k < 4; k++) {
+            uint32_t v = *((uint32_t *) (p + offsets[k * q]));
+            __USUB8(c_hi, v);
+            bright[k] = __SEL(0, 0x01010101);
+            __USUB8(v, c_lo);
+            dark[k] = __SEL(0, 0x01010101);
+        }
 
-    /* Find where each row begins (the corners are output in raster scan order).
-       A beginning of -1 signifies that there are no corners on that row. */
-    last_row = corners[sz - 1].y;
-    row_start = fb_alloc((last_row + 1) * sizeof(uint16_t), FB_ALLOC_NO_HINT);
+        uint32_t candidates = ((bright[0] | bright[2]) & (bright[1] | bright[3])) |
+                              ((dark[0] | dark[2]) & (dark[1] | dark[3]));
+        if (!candidates) {
+            continue;
+        }
 
-    for (int i = 0; i < last_row + 1; i++) {
-        row_start[i] = -1;
-    }
+        // Bit k of each lane is circle pixel k, pixels 8 to 15 go in the second word.
+        uint32_t bright_x4[2] = {0, 0}, dark_x4[2] = {0, 0};
+        for (int k = 0; k < n; k++) {
+            uint32_t v = *((uint32_t *) (p + offsets[k]));
+            __USUB8(c_hi, v);
+            bright_x4[k >> 3] |= __SEL(0, 0x01010101) << (k & 7);
+            __USUB8(v, c_lo);
+            dark_x4[k >> 3] |= __SEL(0, 0x01010101) << (k & 7);
+        }
 
-    for (int i = 0, prev_row = -1; i < sz; i++) {
-        corner_t *c = &corners[i];
-        if (c->y != prev_row) {
-            row_start[c->y] = i;
-            prev_row = c->y;
+        for (int i = 0; i < 4; i++, candidates >>= 8) {
+            if (candidates & 0xff) {
+                int shift = i * 8;
+                uint32_t bright_bits = ((bright_x4[0] >> shift) & 0xff) | (((bright_x4[1] >> shift) & 0xff) << 8);
+                uint32_t dark_bits = ((dark_x4[0] >> shift) & 0xff) | (((dark_x4[1] >> shift) & 0xff) << 8);
+                if (segment_test_arc(bright_bits, n, test->arc) || segment_test_arc(dark_bits, n, test->arc)) {
+                    scores[x + i - x_start] = segment_test_score(p + i, offsets, test) + 1;
+                    count++;
+                }
+            }
         }
     }
+    #endif
 
-    for (int i = 0; i < sz; i++) {
-        corner_t pos = corners[i];
-        uint16_t score = pos.score;
+    uint32_t mask_a = (1 << 0) | (1 << (2 * q));
+    uint32_t mask_b = (1 << q) | (1 << (3 * q));
 
-        /*Check left */
-        if (i > 0) {
-            if (corners[i - 1].x == pos.x - 1 && corners[i - 1].y == pos.y && Compare(corners[i - 1].score, score)) {
-                goto nonmax;
-            }
-        }
+    for (; x < x_end; x++) {
+        const uint8_t *p = row + x;
+        int c_hi = *p + threshold;
+        int c_lo = *p - threshold;
+        uint32_t bright_bits = 0, dark_bits = 0;
 
-        /*Check right*/
-        if (i < (sz - 1)) {
-            if (corners[i + 1].x == pos.x + 1 && corners[i + 1].y == pos.y && Compare(corners[i + 1].score, score)) {
-                goto nonmax;
-            }
+        for (int k = 0; k < n; k += q) {
+            int v = p[offsets[k]];
+            bright_bits |= (v > c_hi) << k;
+            dark_bits |= (v < c_lo) << k;
         }
 
-        /*Check above (if there is a valid row above)*/
-        if (pos.y != 0 && row_start[pos.y - 1] != -1) {
-            /*Make sure that current point_above is one row above.*/
-            if (corners[point_above].y < pos.y - 1) {
-                point_above = row_start[pos.y - 1];
-            }
-
-            /*Make point_above point to the first of the pixels above the current point, if it exists.*/
-            for (; corners[point_above].y < pos.y && corners[point_above].x < pos.x - 1; point_above++) {
+        if (!(((bright_bits & mask_a) && (bright_bits & mask_b)) ||
+              ((dark_bits & mask_a) && (dark_bits & mask_b)))) {
+            continue;
+        }
 
-            }
+        for (int k = 0; k < n; k++) {
+            int v = p[offsets[k]];
+            bright_bits |= (v > c_hi) << k;
+            dark_bits |= (v < c_lo) << k;
+        }
 
-            for (int j = point_above; corners[j].y < pos.y && corners[j].x <= pos.x + 1; j++) {
-                int x = corners[j].x;
-                if ( (x == pos.x - 1 || x == pos.x || x == pos.x + 1) && Compare(corners[j].score, score)) {
-                    goto nonmax;
-                }
-            }
+        if (segment_test_arc(bright_bits, n, test->arc) || segment_test_arc(dark_bits, n, test->arc)) {
+            scores[x - x_start] = segment_test_score(p, offsets, test) + 1;
+            count++;
         }
+    }
 
-        /*Check below (if there is anything below)*/
-        if (pos.y != last_row && row_start[pos.y + 1] != -1 && point_below < sz) {
-            /*Nothing below*/
-            if (corners[point_below].y < pos.y + 1) {
-                point_below = row_start[pos.y + 1];
-            }
+    return count;
+}
 
-            /* Make point below point to one of the pixels belowthe current point, if it exists.*/
-            for (; point_below < sz && corners[point_below].y == pos.y + 1 && corners[point_below].x < pos.x - 1;
-                 point_below++) {
-            }
+// Pushes the corners of mid that score higher than all 8 neighbours. Returns false once the
+// heap is too low to allocate more keypoints.
+static bool segment_test_nonmax_row(const uint8_t *above, const uint8_t *mid, const uint8_t *below,
+                                    int w, int x_start, int y, array_t *keypoints) {
+    gc_info_t info;
 
-            for (int j = point_below; j < sz && corners[j].y == pos.y + 1 && corners[j].x <= pos.x + 1; j++) {
-                int x = corners[j].x;
-                if ( (x == pos.x - 1 || x == pos.x || x == pos.x + 1) && Compare(corners[j].score, score)) {
-                    goto nonmax;
-                }
-            }
+    for (int i = 0; i < w; i++) {
+        int s = mid[i];
+
+        if ((!s) || (mid[i - 1] >= s) || (mid[i + 1] >= s) ||
+            (above[i - 1] >= s) || (above[i] >= s) || (above[i + 1] >= s) ||
+            (below[i - 1] >= s) || (below[i] >= s) || (below[i + 1] >= s)) {
+            continue;
         }
 
         gc_info(&info);
+
         // Allocate keypoints until we're almost out of memory
         if (info.free < MIN_MEM) {
             // Try collecting memory
@@ -192,5887 +207,72 @@ static void nonmax_suppression(corner_t *corners, int num_corners, array_t *keyp
             // If it didn't work break
             gc_info(&info);
             if (info.free < MIN_MEM) {
-                break;
+                return false;
             }
         }
-        array_push_back(keypoints, alloc_keypoint(pos.x, pos.y, pos.score));
-        nonmax:
-        ;
+
+        array_push_back(keypoints, alloc_keypoint(x_start + i, y, s - 1));
     }
 
-    // Free temp rows.
-    fb_free();
+    return true;
 }
 
-// *INDENT-OFF*
-static int fast9_corner_score(const uint8_t *p, int bstart)
-{    
-    int bmin = bstart;
-    int bmax = 255;
-    int b = (bmax + bmin)/2;
+// Detects corners one row at a time into a ring of 3 score rows. Each row is suppressed as
+// soon as the row below it is scored, so no corner list is kept.
+static void segment_test_detect(image_t *image, array_t *keypoints, int threshold, rectangle_t *roi,
+                                const segment_test_t *test) {
+    int offsets[16];
+    int x_start = roi->x + test->radius;
+    int x_end = roi->x + roi->w - test->radius;
+    int y_start = roi->y + test->radius;
+    int y_end = roi->y + roi->h - test->radius;
+
+    if ((x_end <= x_start) || (y_end <= y_start)) {
+        return;
+    }
 
-    /*Compute the score using binary search*/
-	for(;;)
-    {
-		int cb = *p + b;
-		int c_b= *p - b;
+    for (int k = 0; k < test->n; k++) {
+        offsets[k] = test->offsets[k][0] + (test->offsets[k][1] * image->w);
+    }
 
+    threshold = IM_MAX(IM_MIN(threshold, 255), 0);
 
-        if( p[pixel[0]] > cb)
-         if( p[pixel[1]] > cb)
-          if( p[pixel[2]] > cb)
-           if( p[pixel[3]] > cb)
-            if( p[pixel[4]] > cb)
-             if( p[pixel[5]] > cb)
-              if( p[pixel[6]] > cb)
-               if( p[pixel[7]] > cb)
-                if( p[pixel[8]] > cb)
-                 goto is_a_corner;
-                else
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else if( p[pixel[7]] < c_b)
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else if( p[pixel[14]] < c_b)
-                 if( p[pixel[8]] < c_b)
-                  if( p[pixel[9]] < c_b)
-                   if( p[pixel[10]] < c_b)
-                    if( p[pixel[11]] < c_b)
-                     if( p[pixel[12]] < c_b)
-                      if( p[pixel[13]] < c_b)
-                       if( p[pixel[15]] < c_b)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else if( p[pixel[6]] < c_b)
-               if( p[pixel[15]] > cb)
-                if( p[pixel[13]] > cb)
-                 if( p[pixel[14]] > cb)
-                  goto is_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else if( p[pixel[13]] < c_b)
-                 if( p[pixel[7]] < c_b)
-                  if( p[pixel[8]] < c_b)
-                   if( p[pixel[9]] < c_b)
-                    if( p[pixel[10]] < c_b)
-                     if( p[pixel[11]] < c_b)
-                      if( p[pixel[12]] < c_b)
-                       if( p[pixel[14]] < c_b)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                if( p[pixel[7]] < c_b)
-                 if( p[pixel[8]] < c_b)
-                  if( p[pixel[9]] < c_b)
-                   if( p[pixel[10]] < c_b)
-                    if( p[pixel[11]] < c_b)
-                     if( p[pixel[12]] < c_b)
-                      if( p[pixel[13]] < c_b)
-                       if( p[pixel[14]] < c_b)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[13]] > cb)
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else if( p[pixel[13]] < c_b)
-                if( p[pixel[7]] < c_b)
-                 if( p[pixel[8]] < c_b)
-                  if( p[pixel[9]] < c_b)
-                   if( p[pixel[10]] < c_b)
-                    if( p[pixel[11]] < c_b)
-                     if( p[pixel[12]] < c_b)
-                      if( p[pixel[14]] < c_b)
-                       if( p[pixel[15]] < c_b)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else if( p[pixel[5]] < c_b)
-              if( p[pixel[14]] > cb)
-               if( p[pixel[12]] > cb)
-                if( p[pixel[13]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     if( p[pixel[9]] > cb)
-                      if( p[pixel[10]] > cb)
-                       if( p[pixel[11]] > cb)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else if( p[pixel[12]] < c_b)
-                if( p[pixel[6]] < c_b)
-                 if( p[pixel[7]] < c_b)
-                  if( p[pixel[8]] < c_b)
-                   if( p[pixel[9]] < c_b)
-                    if( p[pixel[10]] < c_b)
-                     if( p[pixel[11]] < c_b)
-                      if( p[pixel[13]] < c_b)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else if( p[pixel[14]] < c_b)
-               if( p[pixel[7]] < c_b)
-                if( p[pixel[8]] < c_b)
-                 if( p[pixel[9]] < c_b)
-                  if( p[pixel[10]] < c_b)
-                   if( p[pixel[11]] < c_b)
-                    if( p[pixel[12]] < c_b)
-                     if( p[pixel[13]] < c_b)
-                      if( p[pixel[6]] < c_b)
-                       goto is_a_corner;
-                      else
-                       if( p[pixel[15]] < c_b)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               if( p[pixel[6]] < c_b)
-                if( p[pixel[7]] < c_b)
-                 if( p[pixel[8]] < c_b)
-                  if( p[pixel[9]] < c_b)
-                   if( p[pixel[10]] < c_b)
-                    if( p[pixel[11]] < c_b)
-                     if( p[pixel[12]] < c_b)
-                      if( p[pixel[13]] < c_b)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              if( p[pixel[12]] > cb)
-               if( p[pixel[13]] > cb)
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     if( p[pixel[9]] > cb)
-                      if( p[pixel[10]] > cb)
-                       if( p[pixel[11]] > cb)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else if( p[pixel[12]] < c_b)
-               if( p[pixel[7]] < c_b)
-                if( p[pixel[8]] < c_b)
-                 if( p[pixel[9]] < c_b)
-                  if( p[pixel[10]] < c_b)
-                   if( p[pixel[11]] < c_b)
-                    if( p[pixel[13]] < c_b)
-                     if( p[pixel[14]] < c_b)
-                      if( p[pixel[6]] < c_b)
-                       goto is_a_corner;
-                      else
-                       if( p[pixel[15]] < c_b)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-            else if( p[pixel[4]] < c_b)
-             if( p[pixel[13]] > cb)
-              if( p[pixel[11]] > cb)
-               if( p[pixel[12]] > cb)
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     if( p[pixel[9]] > cb)
-                      if( p[pixel[10]] > cb)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     if( p[pixel[9]] > cb)
-                      if( p[pixel[10]] > cb)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else if( p[pixel[11]] < c_b)
-               if( p[pixel[5]] < c_b)
-                if( p[pixel[6]] < c_b)
-                 if( p[pixel[7]] < c_b)
-                  if( p[pixel[8]] < c_b)
-                   if( p[pixel[9]] < c_b)
-                    if( p[pixel[10]] < c_b)
-                     if( p[pixel[12]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else if( p[pixel[13]] < c_b)
-              if( p[pixel[7]] < c_b)
-               if( p[pixel[8]] < c_b)
-                if( p[pixel[9]] < c_b)
-                 if( p[pixel[10]] < c_b)
-                  if( p[pixel[11]] < c_b)
-                   if( p[pixel[12]] < c_b)
-                    if( p[pixel[6]] < c_b)
-                     if( p[pixel[5]] < c_b)
-                      goto is_a_corner;
-                     else
-                      if( p[pixel[14]] < c_b)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                    else
-                     if( p[pixel[14]] < c_b)
-                      if( p[pixel[15]] < c_b)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              if( p[pixel[5]] < c_b)
-               if( p[pixel[6]] < c_b)
-                if( p[pixel[7]] < c_b)
-                 if( p[pixel[8]] < c_b)
-                  if( p[pixel[9]] < c_b)
-                   if( p[pixel[10]] < c_b)
-                    if( p[pixel[11]] < c_b)
-                     if( p[pixel[12]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-            else
-             if( p[pixel[11]] > cb)
-              if( p[pixel[12]] > cb)
-               if( p[pixel[13]] > cb)
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     if( p[pixel[9]] > cb)
-                      if( p[pixel[10]] > cb)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     if( p[pixel[9]] > cb)
-                      if( p[pixel[10]] > cb)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else if( p[pixel[11]] < c_b)
-              if( p[pixel[7]] < c_b)
-               if( p[pixel[8]] < c_b)
-                if( p[pixel[9]] < c_b)
-                 if( p[pixel[10]] < c_b)
-                  if( p[pixel[12]] < c_b)
-                   if( p[pixel[13]] < c_b)
-                    if( p[pixel[6]] < c_b)
-                     if( p[pixel[5]] < c_b)
-                      goto is_a_corner;
-                     else
-                      if( p[pixel[14]] < c_b)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                    else
-                     if( p[pixel[14]] < c_b)
-                      if( p[pixel[15]] < c_b)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-           else if( p[pixel[3]] < c_b)
-            if( p[pixel[10]] > cb)
-             if( p[pixel[11]] > cb)
-              if( p[pixel[12]] > cb)
-               if( p[pixel[13]] > cb)
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     if( p[pixel[9]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     if( p[pixel[9]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     if( p[pixel[9]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else if( p[pixel[10]] < c_b)
-             if( p[pixel[7]] < c_b)
-              if( p[pixel[8]] < c_b)
-               if( p[pixel[9]] < c_b)
-                if( p[pixel[11]] < c_b)
-                 if( p[pixel[6]] < c_b)
-                  if( p[pixel[5]] < c_b)
-                   if( p[pixel[4]] < c_b)
-                    goto is_a_corner;
-                   else
-                    if( p[pixel[12]] < c_b)
-                     if( p[pixel[13]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                  else
-                   if( p[pixel[12]] < c_b)
-                    if( p[pixel[13]] < c_b)
-                     if( p[pixel[14]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                 else
-                  if( p[pixel[12]] < c_b)
-                   if( p[pixel[13]] < c_b)
-                    if( p[pixel[14]] < c_b)
-                     if( p[pixel[15]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            if( p[pixel[10]] > cb)
-             if( p[pixel[11]] > cb)
-              if( p[pixel[12]] > cb)
-               if( p[pixel[13]] > cb)
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     if( p[pixel[9]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     if( p[pixel[9]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     if( p[pixel[9]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else if( p[pixel[10]] < c_b)
-             if( p[pixel[7]] < c_b)
-              if( p[pixel[8]] < c_b)
-               if( p[pixel[9]] < c_b)
-                if( p[pixel[11]] < c_b)
-                 if( p[pixel[12]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[5]] < c_b)
-                    if( p[pixel[4]] < c_b)
-                     goto is_a_corner;
-                    else
-                     if( p[pixel[13]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                   else
-                    if( p[pixel[13]] < c_b)
-                     if( p[pixel[14]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                  else
-                   if( p[pixel[13]] < c_b)
-                    if( p[pixel[14]] < c_b)
-                     if( p[pixel[15]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-          else if( p[pixel[2]] < c_b)
-           if( p[pixel[9]] > cb)
-            if( p[pixel[10]] > cb)
-             if( p[pixel[11]] > cb)
-              if( p[pixel[12]] > cb)
-               if( p[pixel[13]] > cb)
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[3]] > cb)
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else if( p[pixel[9]] < c_b)
-            if( p[pixel[7]] < c_b)
-             if( p[pixel[8]] < c_b)
-              if( p[pixel[10]] < c_b)
-               if( p[pixel[6]] < c_b)
-                if( p[pixel[5]] < c_b)
-                 if( p[pixel[4]] < c_b)
-                  if( p[pixel[3]] < c_b)
-                   goto is_a_corner;
-                  else
-                   if( p[pixel[11]] < c_b)
-                    if( p[pixel[12]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                 else
-                  if( p[pixel[11]] < c_b)
-                   if( p[pixel[12]] < c_b)
-                    if( p[pixel[13]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[11]] < c_b)
-                  if( p[pixel[12]] < c_b)
-                   if( p[pixel[13]] < c_b)
-                    if( p[pixel[14]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[11]] < c_b)
-                 if( p[pixel[12]] < c_b)
-                  if( p[pixel[13]] < c_b)
-                   if( p[pixel[14]] < c_b)
-                    if( p[pixel[15]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-          else
-           if( p[pixel[9]] > cb)
-            if( p[pixel[10]] > cb)
-             if( p[pixel[11]] > cb)
-              if( p[pixel[12]] > cb)
-               if( p[pixel[13]] > cb)
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[3]] > cb)
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    if( p[pixel[8]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else if( p[pixel[9]] < c_b)
-            if( p[pixel[7]] < c_b)
-             if( p[pixel[8]] < c_b)
-              if( p[pixel[10]] < c_b)
-               if( p[pixel[11]] < c_b)
-                if( p[pixel[6]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[4]] < c_b)
-                   if( p[pixel[3]] < c_b)
-                    goto is_a_corner;
-                   else
-                    if( p[pixel[12]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                  else
-                   if( p[pixel[12]] < c_b)
-                    if( p[pixel[13]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                 else
-                  if( p[pixel[12]] < c_b)
-                   if( p[pixel[13]] < c_b)
-                    if( p[pixel[14]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[12]] < c_b)
-                  if( p[pixel[13]] < c_b)
-                   if( p[pixel[14]] < c_b)
-                    if( p[pixel[15]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-         else if( p[pixel[1]] < c_b)
-          if( p[pixel[8]] > cb)
-           if( p[pixel[9]] > cb)
-            if( p[pixel[10]] > cb)
-             if( p[pixel[11]] > cb)
-              if( p[pixel[12]] > cb)
-               if( p[pixel[13]] > cb)
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[3]] > cb)
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              if( p[pixel[2]] > cb)
-               if( p[pixel[3]] > cb)
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-          else if( p[pixel[8]] < c_b)
-           if( p[pixel[7]] < c_b)
-            if( p[pixel[9]] < c_b)
-             if( p[pixel[6]] < c_b)
-              if( p[pixel[5]] < c_b)
-               if( p[pixel[4]] < c_b)
-                if( p[pixel[3]] < c_b)
-                 if( p[pixel[2]] < c_b)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[10]] < c_b)
-                   if( p[pixel[11]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[10]] < c_b)
-                  if( p[pixel[11]] < c_b)
-                   if( p[pixel[12]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[10]] < c_b)
-                 if( p[pixel[11]] < c_b)
-                  if( p[pixel[12]] < c_b)
-                   if( p[pixel[13]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[10]] < c_b)
-                if( p[pixel[11]] < c_b)
-                 if( p[pixel[12]] < c_b)
-                  if( p[pixel[13]] < c_b)
-                   if( p[pixel[14]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              if( p[pixel[10]] < c_b)
-               if( p[pixel[11]] < c_b)
-                if( p[pixel[12]] < c_b)
-                 if( p[pixel[13]] < c_b)
-                  if( p[pixel[14]] < c_b)
-                   if( p[pixel[15]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-          else
-           goto is_not_a_corner;
-         else
-          if( p[pixel[8]] > cb)
-           if( p[pixel[9]] > cb)
-            if( p[pixel[10]] > cb)
-             if( p[pixel[11]] > cb)
-              if( p[pixel[12]] > cb)
-               if( p[pixel[13]] > cb)
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[15]] > cb)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[3]] > cb)
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              if( p[pixel[2]] > cb)
-               if( p[pixel[3]] > cb)
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[7]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-          else if( p[pixel[8]] < c_b)
-           if( p[pixel[7]] < c_b)
-            if( p[pixel[9]] < c_b)
-             if( p[pixel[10]] < c_b)
-              if( p[pixel[6]] < c_b)
-               if( p[pixel[5]] < c_b)
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[3]] < c_b)
-                  if( p[pixel[2]] < c_b)
-                   goto is_a_corner;
-                  else
-                   if( p[pixel[11]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                 else
-                  if( p[pixel[11]] < c_b)
-                   if( p[pixel[12]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[11]] < c_b)
-                  if( p[pixel[12]] < c_b)
-                   if( p[pixel[13]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[11]] < c_b)
-                 if( p[pixel[12]] < c_b)
-                  if( p[pixel[13]] < c_b)
-                   if( p[pixel[14]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[11]] < c_b)
-                if( p[pixel[12]] < c_b)
-                 if( p[pixel[13]] < c_b)
-                  if( p[pixel[14]] < c_b)
-                   if( p[pixel[15]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-          else
-           goto is_not_a_corner;
-        else if( p[pixel[0]] < c_b)
-         if( p[pixel[1]] > cb)
-          if( p[pixel[8]] > cb)
-           if( p[pixel[7]] > cb)
-            if( p[pixel[9]] > cb)
-             if( p[pixel[6]] > cb)
-              if( p[pixel[5]] > cb)
-               if( p[pixel[4]] > cb)
-                if( p[pixel[3]] > cb)
-                 if( p[pixel[2]] > cb)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[10]] > cb)
-                   if( p[pixel[11]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[10]] > cb)
-                  if( p[pixel[11]] > cb)
-                   if( p[pixel[12]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[10]] > cb)
-                 if( p[pixel[11]] > cb)
-                  if( p[pixel[12]] > cb)
-                   if( p[pixel[13]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[10]] > cb)
-                if( p[pixel[11]] > cb)
-                 if( p[pixel[12]] > cb)
-                  if( p[pixel[13]] > cb)
-                   if( p[pixel[14]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              if( p[pixel[10]] > cb)
-               if( p[pixel[11]] > cb)
-                if( p[pixel[12]] > cb)
-                 if( p[pixel[13]] > cb)
-                  if( p[pixel[14]] > cb)
-                   if( p[pixel[15]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-          else if( p[pixel[8]] < c_b)
-           if( p[pixel[9]] < c_b)
-            if( p[pixel[10]] < c_b)
-             if( p[pixel[11]] < c_b)
-              if( p[pixel[12]] < c_b)
-               if( p[pixel[13]] < c_b)
-                if( p[pixel[14]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[3]] < c_b)
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              if( p[pixel[2]] < c_b)
-               if( p[pixel[3]] < c_b)
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-          else
-           goto is_not_a_corner;
-         else if( p[pixel[1]] < c_b)
-          if( p[pixel[2]] > cb)
-           if( p[pixel[9]] > cb)
-            if( p[pixel[7]] > cb)
-             if( p[pixel[8]] > cb)
-              if( p[pixel[10]] > cb)
-               if( p[pixel[6]] > cb)
-                if( p[pixel[5]] > cb)
-                 if( p[pixel[4]] > cb)
-                  if( p[pixel[3]] > cb)
-                   goto is_a_corner;
-                  else
-                   if( p[pixel[11]] > cb)
-                    if( p[pixel[12]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                 else
-                  if( p[pixel[11]] > cb)
-                   if( p[pixel[12]] > cb)
-                    if( p[pixel[13]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[11]] > cb)
-                  if( p[pixel[12]] > cb)
-                   if( p[pixel[13]] > cb)
-                    if( p[pixel[14]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[11]] > cb)
-                 if( p[pixel[12]] > cb)
-                  if( p[pixel[13]] > cb)
-                   if( p[pixel[14]] > cb)
-                    if( p[pixel[15]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else if( p[pixel[9]] < c_b)
-            if( p[pixel[10]] < c_b)
-             if( p[pixel[11]] < c_b)
-              if( p[pixel[12]] < c_b)
-               if( p[pixel[13]] < c_b)
-                if( p[pixel[14]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[3]] < c_b)
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-          else if( p[pixel[2]] < c_b)
-           if( p[pixel[3]] > cb)
-            if( p[pixel[10]] > cb)
-             if( p[pixel[7]] > cb)
-              if( p[pixel[8]] > cb)
-               if( p[pixel[9]] > cb)
-                if( p[pixel[11]] > cb)
-                 if( p[pixel[6]] > cb)
-                  if( p[pixel[5]] > cb)
-                   if( p[pixel[4]] > cb)
-                    goto is_a_corner;
-                   else
-                    if( p[pixel[12]] > cb)
-                     if( p[pixel[13]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                  else
-                   if( p[pixel[12]] > cb)
-                    if( p[pixel[13]] > cb)
-                     if( p[pixel[14]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                 else
-                  if( p[pixel[12]] > cb)
-                   if( p[pixel[13]] > cb)
-                    if( p[pixel[14]] > cb)
-                     if( p[pixel[15]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else if( p[pixel[10]] < c_b)
-             if( p[pixel[11]] < c_b)
-              if( p[pixel[12]] < c_b)
-               if( p[pixel[13]] < c_b)
-                if( p[pixel[14]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     if( p[pixel[9]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     if( p[pixel[9]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     if( p[pixel[9]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else if( p[pixel[3]] < c_b)
-            if( p[pixel[4]] > cb)
-             if( p[pixel[13]] > cb)
-              if( p[pixel[7]] > cb)
-               if( p[pixel[8]] > cb)
-                if( p[pixel[9]] > cb)
-                 if( p[pixel[10]] > cb)
-                  if( p[pixel[11]] > cb)
-                   if( p[pixel[12]] > cb)
-                    if( p[pixel[6]] > cb)
-                     if( p[pixel[5]] > cb)
-                      goto is_a_corner;
-                     else
-                      if( p[pixel[14]] > cb)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                    else
-                     if( p[pixel[14]] > cb)
-                      if( p[pixel[15]] > cb)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else if( p[pixel[13]] < c_b)
-              if( p[pixel[11]] > cb)
-               if( p[pixel[5]] > cb)
-                if( p[pixel[6]] > cb)
-                 if( p[pixel[7]] > cb)
-                  if( p[pixel[8]] > cb)
-                   if( p[pixel[9]] > cb)
-                    if( p[pixel[10]] > cb)
-                     if( p[pixel[12]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else if( p[pixel[11]] < c_b)
-               if( p[pixel[12]] < c_b)
-                if( p[pixel[14]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     if( p[pixel[9]] < c_b)
-                      if( p[pixel[10]] < c_b)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     if( p[pixel[9]] < c_b)
-                      if( p[pixel[10]] < c_b)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              if( p[pixel[5]] > cb)
-               if( p[pixel[6]] > cb)
-                if( p[pixel[7]] > cb)
-                 if( p[pixel[8]] > cb)
-                  if( p[pixel[9]] > cb)
-                   if( p[pixel[10]] > cb)
-                    if( p[pixel[11]] > cb)
-                     if( p[pixel[12]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-            else if( p[pixel[4]] < c_b)
-             if( p[pixel[5]] > cb)
-              if( p[pixel[14]] > cb)
-               if( p[pixel[7]] > cb)
-                if( p[pixel[8]] > cb)
-                 if( p[pixel[9]] > cb)
-                  if( p[pixel[10]] > cb)
-                   if( p[pixel[11]] > cb)
-                    if( p[pixel[12]] > cb)
-                     if( p[pixel[13]] > cb)
-                      if( p[pixel[6]] > cb)
-                       goto is_a_corner;
-                      else
-                       if( p[pixel[15]] > cb)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else if( p[pixel[14]] < c_b)
-               if( p[pixel[12]] > cb)
-                if( p[pixel[6]] > cb)
-                 if( p[pixel[7]] > cb)
-                  if( p[pixel[8]] > cb)
-                   if( p[pixel[9]] > cb)
-                    if( p[pixel[10]] > cb)
-                     if( p[pixel[11]] > cb)
-                      if( p[pixel[13]] > cb)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else if( p[pixel[12]] < c_b)
-                if( p[pixel[13]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     if( p[pixel[9]] < c_b)
-                      if( p[pixel[10]] < c_b)
-                       if( p[pixel[11]] < c_b)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               if( p[pixel[6]] > cb)
-                if( p[pixel[7]] > cb)
-                 if( p[pixel[8]] > cb)
-                  if( p[pixel[9]] > cb)
-                   if( p[pixel[10]] > cb)
-                    if( p[pixel[11]] > cb)
-                     if( p[pixel[12]] > cb)
-                      if( p[pixel[13]] > cb)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else if( p[pixel[5]] < c_b)
-              if( p[pixel[6]] > cb)
-               if( p[pixel[15]] < c_b)
-                if( p[pixel[13]] > cb)
-                 if( p[pixel[7]] > cb)
-                  if( p[pixel[8]] > cb)
-                   if( p[pixel[9]] > cb)
-                    if( p[pixel[10]] > cb)
-                     if( p[pixel[11]] > cb)
-                      if( p[pixel[12]] > cb)
-                       if( p[pixel[14]] > cb)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else if( p[pixel[13]] < c_b)
-                 if( p[pixel[14]] < c_b)
-                  goto is_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                if( p[pixel[7]] > cb)
-                 if( p[pixel[8]] > cb)
-                  if( p[pixel[9]] > cb)
-                   if( p[pixel[10]] > cb)
-                    if( p[pixel[11]] > cb)
-                     if( p[pixel[12]] > cb)
-                      if( p[pixel[13]] > cb)
-                       if( p[pixel[14]] > cb)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else if( p[pixel[6]] < c_b)
-               if( p[pixel[7]] > cb)
-                if( p[pixel[14]] > cb)
-                 if( p[pixel[8]] > cb)
-                  if( p[pixel[9]] > cb)
-                   if( p[pixel[10]] > cb)
-                    if( p[pixel[11]] > cb)
-                     if( p[pixel[12]] > cb)
-                      if( p[pixel[13]] > cb)
-                       if( p[pixel[15]] > cb)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else if( p[pixel[14]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else if( p[pixel[7]] < c_b)
-                if( p[pixel[8]] < c_b)
-                 goto is_a_corner;
-                else
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[14]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[13]] > cb)
-                if( p[pixel[7]] > cb)
-                 if( p[pixel[8]] > cb)
-                  if( p[pixel[9]] > cb)
-                   if( p[pixel[10]] > cb)
-                    if( p[pixel[11]] > cb)
-                     if( p[pixel[12]] > cb)
-                      if( p[pixel[14]] > cb)
-                       if( p[pixel[15]] > cb)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else if( p[pixel[13]] < c_b)
-                if( p[pixel[14]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              if( p[pixel[12]] > cb)
-               if( p[pixel[7]] > cb)
-                if( p[pixel[8]] > cb)
-                 if( p[pixel[9]] > cb)
-                  if( p[pixel[10]] > cb)
-                   if( p[pixel[11]] > cb)
-                    if( p[pixel[13]] > cb)
-                     if( p[pixel[14]] > cb)
-                      if( p[pixel[6]] > cb)
-                       goto is_a_corner;
-                      else
-                       if( p[pixel[15]] > cb)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else if( p[pixel[12]] < c_b)
-               if( p[pixel[13]] < c_b)
-                if( p[pixel[14]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     if( p[pixel[9]] < c_b)
-                      if( p[pixel[10]] < c_b)
-                       if( p[pixel[11]] < c_b)
-                        goto is_a_corner;
-                       else
-                        goto is_not_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-            else
-             if( p[pixel[11]] > cb)
-              if( p[pixel[7]] > cb)
-               if( p[pixel[8]] > cb)
-                if( p[pixel[9]] > cb)
-                 if( p[pixel[10]] > cb)
-                  if( p[pixel[12]] > cb)
-                   if( p[pixel[13]] > cb)
-                    if( p[pixel[6]] > cb)
-                     if( p[pixel[5]] > cb)
-                      goto is_a_corner;
-                     else
-                      if( p[pixel[14]] > cb)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                    else
-                     if( p[pixel[14]] > cb)
-                      if( p[pixel[15]] > cb)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else if( p[pixel[11]] < c_b)
-              if( p[pixel[12]] < c_b)
-               if( p[pixel[13]] < c_b)
-                if( p[pixel[14]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     if( p[pixel[9]] < c_b)
-                      if( p[pixel[10]] < c_b)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     if( p[pixel[9]] < c_b)
-                      if( p[pixel[10]] < c_b)
-                       goto is_a_corner;
-                      else
-                       goto is_not_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-           else
-            if( p[pixel[10]] > cb)
-             if( p[pixel[7]] > cb)
-              if( p[pixel[8]] > cb)
-               if( p[pixel[9]] > cb)
-                if( p[pixel[11]] > cb)
-                 if( p[pixel[12]] > cb)
-                  if( p[pixel[6]] > cb)
-                   if( p[pixel[5]] > cb)
-                    if( p[pixel[4]] > cb)
-                     goto is_a_corner;
-                    else
-                     if( p[pixel[13]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                   else
-                    if( p[pixel[13]] > cb)
-                     if( p[pixel[14]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                  else
-                   if( p[pixel[13]] > cb)
-                    if( p[pixel[14]] > cb)
-                     if( p[pixel[15]] > cb)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else if( p[pixel[10]] < c_b)
-             if( p[pixel[11]] < c_b)
-              if( p[pixel[12]] < c_b)
-               if( p[pixel[13]] < c_b)
-                if( p[pixel[14]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     if( p[pixel[9]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     if( p[pixel[9]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     if( p[pixel[9]] < c_b)
-                      goto is_a_corner;
-                     else
-                      goto is_not_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-          else
-           if( p[pixel[9]] > cb)
-            if( p[pixel[7]] > cb)
-             if( p[pixel[8]] > cb)
-              if( p[pixel[10]] > cb)
-               if( p[pixel[11]] > cb)
-                if( p[pixel[6]] > cb)
-                 if( p[pixel[5]] > cb)
-                  if( p[pixel[4]] > cb)
-                   if( p[pixel[3]] > cb)
-                    goto is_a_corner;
-                   else
-                    if( p[pixel[12]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                  else
-                   if( p[pixel[12]] > cb)
-                    if( p[pixel[13]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                 else
-                  if( p[pixel[12]] > cb)
-                   if( p[pixel[13]] > cb)
-                    if( p[pixel[14]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[12]] > cb)
-                  if( p[pixel[13]] > cb)
-                   if( p[pixel[14]] > cb)
-                    if( p[pixel[15]] > cb)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else if( p[pixel[9]] < c_b)
-            if( p[pixel[10]] < c_b)
-             if( p[pixel[11]] < c_b)
-              if( p[pixel[12]] < c_b)
-               if( p[pixel[13]] < c_b)
-                if( p[pixel[14]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[3]] < c_b)
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    if( p[pixel[8]] < c_b)
-                     goto is_a_corner;
-                    else
-                     goto is_not_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-         else
-          if( p[pixel[8]] > cb)
-           if( p[pixel[7]] > cb)
-            if( p[pixel[9]] > cb)
-             if( p[pixel[10]] > cb)
-              if( p[pixel[6]] > cb)
-               if( p[pixel[5]] > cb)
-                if( p[pixel[4]] > cb)
-                 if( p[pixel[3]] > cb)
-                  if( p[pixel[2]] > cb)
-                   goto is_a_corner;
-                  else
-                   if( p[pixel[11]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                 else
-                  if( p[pixel[11]] > cb)
-                   if( p[pixel[12]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[11]] > cb)
-                  if( p[pixel[12]] > cb)
-                   if( p[pixel[13]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[11]] > cb)
-                 if( p[pixel[12]] > cb)
-                  if( p[pixel[13]] > cb)
-                   if( p[pixel[14]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[11]] > cb)
-                if( p[pixel[12]] > cb)
-                 if( p[pixel[13]] > cb)
-                  if( p[pixel[14]] > cb)
-                   if( p[pixel[15]] > cb)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-          else if( p[pixel[8]] < c_b)
-           if( p[pixel[9]] < c_b)
-            if( p[pixel[10]] < c_b)
-             if( p[pixel[11]] < c_b)
-              if( p[pixel[12]] < c_b)
-               if( p[pixel[13]] < c_b)
-                if( p[pixel[14]] < c_b)
-                 if( p[pixel[15]] < c_b)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[3]] < c_b)
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              if( p[pixel[2]] < c_b)
-               if( p[pixel[3]] < c_b)
-                if( p[pixel[4]] < c_b)
-                 if( p[pixel[5]] < c_b)
-                  if( p[pixel[6]] < c_b)
-                   if( p[pixel[7]] < c_b)
-                    goto is_a_corner;
-                   else
-                    goto is_not_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-            else
-             goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-          else
-           goto is_not_a_corner;
-        else
-         if( p[pixel[7]] > cb)
-          if( p[pixel[8]] > cb)
-           if( p[pixel[9]] > cb)
-            if( p[pixel[6]] > cb)
-             if( p[pixel[5]] > cb)
-              if( p[pixel[4]] > cb)
-               if( p[pixel[3]] > cb)
-                if( p[pixel[2]] > cb)
-                 if( p[pixel[1]] > cb)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[10]] > cb)
-                   goto is_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[10]] > cb)
-                  if( p[pixel[11]] > cb)
-                   goto is_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[10]] > cb)
-                 if( p[pixel[11]] > cb)
-                  if( p[pixel[12]] > cb)
-                   goto is_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[10]] > cb)
-                if( p[pixel[11]] > cb)
-                 if( p[pixel[12]] > cb)
-                  if( p[pixel[13]] > cb)
-                   goto is_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              if( p[pixel[10]] > cb)
-               if( p[pixel[11]] > cb)
-                if( p[pixel[12]] > cb)
-                 if( p[pixel[13]] > cb)
-                  if( p[pixel[14]] > cb)
-                   goto is_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-            else
-             if( p[pixel[10]] > cb)
-              if( p[pixel[11]] > cb)
-               if( p[pixel[12]] > cb)
-                if( p[pixel[13]] > cb)
-                 if( p[pixel[14]] > cb)
-                  if( p[pixel[15]] > cb)
-                   goto is_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-          else
-           goto is_not_a_corner;
-         else if( p[pixel[7]] < c_b)
-          if( p[pixel[8]] < c_b)
-           if( p[pixel[9]] < c_b)
-            if( p[pixel[6]] < c_b)
-             if( p[pixel[5]] < c_b)
-              if( p[pixel[4]] < c_b)
-               if( p[pixel[3]] < c_b)
-                if( p[pixel[2]] < c_b)
-                 if( p[pixel[1]] < c_b)
-                  goto is_a_corner;
-                 else
-                  if( p[pixel[10]] < c_b)
-                   goto is_a_corner;
-                  else
-                   goto is_not_a_corner;
-                else
-                 if( p[pixel[10]] < c_b)
-                  if( p[pixel[11]] < c_b)
-                   goto is_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-               else
-                if( p[pixel[10]] < c_b)
-                 if( p[pixel[11]] < c_b)
-                  if( p[pixel[12]] < c_b)
-                   goto is_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-              else
-               if( p[pixel[10]] < c_b)
-                if( p[pixel[11]] < c_b)
-                 if( p[pixel[12]] < c_b)
-                  if( p[pixel[13]] < c_b)
-                   goto is_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-             else
-              if( p[pixel[10]] < c_b)
-               if( p[pixel[11]] < c_b)
-                if( p[pixel[12]] < c_b)
-                 if( p[pixel[13]] < c_b)
-                  if( p[pixel[14]] < c_b)
-                   goto is_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-            else
-             if( p[pixel[10]] < c_b)
-              if( p[pixel[11]] < c_b)
-               if( p[pixel[12]] < c_b)
-                if( p[pixel[13]] < c_b)
-                 if( p[pixel[14]] < c_b)
-                  if( p[pixel[15]] < c_b)
-                   goto is_a_corner;
-                  else
-                   goto is_not_a_corner;
-                 else
-                  goto is_not_a_corner;
-                else
-                 goto is_not_a_corner;
-               else
-                goto is_not_a_corner;
-              else
-               goto is_not_a_corner;
-             else
-              goto is_not_a_corner;
-           else
-            goto is_not_a_corner;
-          else
-           goto is_not_a_corner;
-         else
-          goto is_not_a_corner;
+    // Rows are padded by a zero on each side. The row before the first starts zeroed.
+    int w = x_end - x_start;
+    int stride = w + 2;
+    uint8_t *scores = fb_alloc0(stride * 3, FB_ALLOC_NO_HINT);
+    int counts[3] = {0, 0, 0};
 
-		is_a_corner:
-			bmin=b;
-			goto end_if;
+    for (int i = 0, y = y_start; y <= y_end; i++, y++) {
+        // Slot i % 3 holds row y, (i + 2) % 3 row y - 1 and (i + 1) % 3 row y - 2.
+        uint8_t *below = scores + ((i % 3) * stride) + 1;
+        uint8_t *mid = scores + (((i + 2) % 3) * stride) + 1;
+        uint8_t *above = scores + (((i + 1) % 3) * stride) + 1;
 
-		is_not_a_corner:
-			bmax=b;
-			goto end_if;
+        memset(below - 1, 0, stride);
+        counts[i % 3] = 0;
 
-		end_if:
+        if (y < y_end) {
+            counts[i % 3] = segment_test_row(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(image, y),
+                                             x_start, x_end, threshold, offsets, test, below);
+        }
 
-		if(bmin == bmax - 1 || bmin == bmax)
-			return bmin;
-		b = (bmin + bmax) / 2;
+        if (i && counts[(i + 2) % 3]) {
+            if (!segment_test_nonmax_row(above, mid, below, w, x_start, y - 1, keypoints)) {
+                break;
+            }
+        }
     }
-}
-// *INDENT-ON*
 
-static void fast9_score(image_t *image, corner_t *corners, int num_corners, int b) {
-    for (int i = 0; i < num_corners; i++) {
-        corner_t *c = &corners[i];
-        c->score = fast9_corner_score(image->pixels + c->y * image->w + c->x, b);
-    }
+    fb_free();
 }
 
-// *INDENT-OFF*
-static corner_t *fast9_detect(image_t *image, rectangle_t *roi, int *n_corners, int b)
-{
-    int num_corners = 0;
-    // Try to alloc MAX_CORNERS or the actual max corners we can alloc.
-    int max_corners = IM_MIN(MAX_CORNERS, (fb_avail() / sizeof(corner_t)));
-    corner_t *corners = (corner_t*) fb_alloc(max_corners * sizeof(corner_t), FB_ALLOC_NO_HINT);
-
-    for(int y=roi->y+3; y<roi->y+roi->h-3; y++) {
-        for(int x=roi->x+3; x<roi->x+roi->w-3; x++) {
-            const uint8_t *p = image->pixels+(y * image->w + x);
-			int cb = *p + b;
-			int c_b= *p - b;
-            if(p[pixel[0]] > cb)
-             if(p[pixel[1]] > cb)
-              if(p[pixel[2]] > cb)
-               if(p[pixel[3]] > cb)
-                if(p[pixel[4]] > cb)
-                 if(p[pixel[5]] > cb)
-                  if(p[pixel[6]] > cb)
-                   if(p[pixel[7]] > cb)
-                    if(p[pixel[8]] > cb)
-                     {}
-                    else
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      continue;
-                   else if(p[pixel[7]] < c_b)
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      continue;
-                    else if(p[pixel[14]] < c_b)
-                     if(p[pixel[8]] < c_b)
-                      if(p[pixel[9]] < c_b)
-                       if(p[pixel[10]] < c_b)
-                        if(p[pixel[11]] < c_b)
-                         if(p[pixel[12]] < c_b)
-                          if(p[pixel[13]] < c_b)
-                           if(p[pixel[15]] < c_b)
-                            {}
-                           else
-                            continue;
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                  else if(p[pixel[6]] < c_b)
-                   if(p[pixel[15]] > cb)
-                    if(p[pixel[13]] > cb)
-                     if(p[pixel[14]] > cb)
-                      {}
-                     else
-                      continue;
-                    else if(p[pixel[13]] < c_b)
-                     if(p[pixel[7]] < c_b)
-                      if(p[pixel[8]] < c_b)
-                       if(p[pixel[9]] < c_b)
-                        if(p[pixel[10]] < c_b)
-                         if(p[pixel[11]] < c_b)
-                          if(p[pixel[12]] < c_b)
-                           if(p[pixel[14]] < c_b)
-                            {}
-                           else
-                            continue;
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    if(p[pixel[7]] < c_b)
-                     if(p[pixel[8]] < c_b)
-                      if(p[pixel[9]] < c_b)
-                       if(p[pixel[10]] < c_b)
-                        if(p[pixel[11]] < c_b)
-                         if(p[pixel[12]] < c_b)
-                          if(p[pixel[13]] < c_b)
-                           if(p[pixel[14]] < c_b)
-                            {}
-                           else
-                            continue;
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[13]] > cb)
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else if(p[pixel[13]] < c_b)
-                    if(p[pixel[7]] < c_b)
-                     if(p[pixel[8]] < c_b)
-                      if(p[pixel[9]] < c_b)
-                       if(p[pixel[10]] < c_b)
-                        if(p[pixel[11]] < c_b)
-                         if(p[pixel[12]] < c_b)
-                          if(p[pixel[14]] < c_b)
-                           if(p[pixel[15]] < c_b)
-                            {}
-                           else
-                            continue;
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else if(p[pixel[5]] < c_b)
-                  if(p[pixel[14]] > cb)
-                   if(p[pixel[12]] > cb)
-                    if(p[pixel[13]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         if(p[pixel[9]] > cb)
-                          if(p[pixel[10]] > cb)
-                           if(p[pixel[11]] > cb)
-                            {}
-                           else
-                            continue;
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     continue;
-                   else if(p[pixel[12]] < c_b)
-                    if(p[pixel[6]] < c_b)
-                     if(p[pixel[7]] < c_b)
-                      if(p[pixel[8]] < c_b)
-                       if(p[pixel[9]] < c_b)
-                        if(p[pixel[10]] < c_b)
-                         if(p[pixel[11]] < c_b)
-                          if(p[pixel[13]] < c_b)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else if(p[pixel[14]] < c_b)
-                   if(p[pixel[7]] < c_b)
-                    if(p[pixel[8]] < c_b)
-                     if(p[pixel[9]] < c_b)
-                      if(p[pixel[10]] < c_b)
-                       if(p[pixel[11]] < c_b)
-                        if(p[pixel[12]] < c_b)
-                         if(p[pixel[13]] < c_b)
-                          if(p[pixel[6]] < c_b)
-                           {}
-                          else
-                           if(p[pixel[15]] < c_b)
-                            {}
-                           else
-                            continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   if(p[pixel[6]] < c_b)
-                    if(p[pixel[7]] < c_b)
-                     if(p[pixel[8]] < c_b)
-                      if(p[pixel[9]] < c_b)
-                       if(p[pixel[10]] < c_b)
-                        if(p[pixel[11]] < c_b)
-                         if(p[pixel[12]] < c_b)
-                          if(p[pixel[13]] < c_b)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[pixel[12]] > cb)
-                   if(p[pixel[13]] > cb)
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         if(p[pixel[9]] > cb)
-                          if(p[pixel[10]] > cb)
-                           if(p[pixel[11]] > cb)
-                            {}
-                           else
-                            continue;
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else if(p[pixel[12]] < c_b)
-                   if(p[pixel[7]] < c_b)
-                    if(p[pixel[8]] < c_b)
-                     if(p[pixel[9]] < c_b)
-                      if(p[pixel[10]] < c_b)
-                       if(p[pixel[11]] < c_b)
-                        if(p[pixel[13]] < c_b)
-                         if(p[pixel[14]] < c_b)
-                          if(p[pixel[6]] < c_b)
-                           {}
-                          else
-                           if(p[pixel[15]] < c_b)
-                            {}
-                           else
-                            continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else if(p[pixel[4]] < c_b)
-                 if(p[pixel[13]] > cb)
-                  if(p[pixel[11]] > cb)
-                   if(p[pixel[12]] > cb)
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         if(p[pixel[9]] > cb)
-                          if(p[pixel[10]] > cb)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         if(p[pixel[9]] > cb)
-                          if(p[pixel[10]] > cb)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    continue;
-                  else if(p[pixel[11]] < c_b)
-                   if(p[pixel[5]] < c_b)
-                    if(p[pixel[6]] < c_b)
-                     if(p[pixel[7]] < c_b)
-                      if(p[pixel[8]] < c_b)
-                       if(p[pixel[9]] < c_b)
-                        if(p[pixel[10]] < c_b)
-                         if(p[pixel[12]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else if(p[pixel[13]] < c_b)
-                  if(p[pixel[7]] < c_b)
-                   if(p[pixel[8]] < c_b)
-                    if(p[pixel[9]] < c_b)
-                     if(p[pixel[10]] < c_b)
-                      if(p[pixel[11]] < c_b)
-                       if(p[pixel[12]] < c_b)
-                        if(p[pixel[6]] < c_b)
-                         if(p[pixel[5]] < c_b)
-                          {}
-                         else
-                          if(p[pixel[14]] < c_b)
-                           {}
-                          else
-                           continue;
-                        else
-                         if(p[pixel[14]] < c_b)
-                          if(p[pixel[15]] < c_b)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  if(p[pixel[5]] < c_b)
-                   if(p[pixel[6]] < c_b)
-                    if(p[pixel[7]] < c_b)
-                     if(p[pixel[8]] < c_b)
-                      if(p[pixel[9]] < c_b)
-                       if(p[pixel[10]] < c_b)
-                        if(p[pixel[11]] < c_b)
-                         if(p[pixel[12]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[pixel[11]] > cb)
-                  if(p[pixel[12]] > cb)
-                   if(p[pixel[13]] > cb)
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         if(p[pixel[9]] > cb)
-                          if(p[pixel[10]] > cb)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         if(p[pixel[9]] > cb)
-                          if(p[pixel[10]] > cb)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else if(p[pixel[11]] < c_b)
-                  if(p[pixel[7]] < c_b)
-                   if(p[pixel[8]] < c_b)
-                    if(p[pixel[9]] < c_b)
-                     if(p[pixel[10]] < c_b)
-                      if(p[pixel[12]] < c_b)
-                       if(p[pixel[13]] < c_b)
-                        if(p[pixel[6]] < c_b)
-                         if(p[pixel[5]] < c_b)
-                          {}
-                         else
-                          if(p[pixel[14]] < c_b)
-                           {}
-                          else
-                           continue;
-                        else
-                         if(p[pixel[14]] < c_b)
-                          if(p[pixel[15]] < c_b)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else if(p[pixel[3]] < c_b)
-                if(p[pixel[10]] > cb)
-                 if(p[pixel[11]] > cb)
-                  if(p[pixel[12]] > cb)
-                   if(p[pixel[13]] > cb)
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         if(p[pixel[9]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         if(p[pixel[9]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         if(p[pixel[9]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else if(p[pixel[10]] < c_b)
-                 if(p[pixel[7]] < c_b)
-                  if(p[pixel[8]] < c_b)
-                   if(p[pixel[9]] < c_b)
-                    if(p[pixel[11]] < c_b)
-                     if(p[pixel[6]] < c_b)
-                      if(p[pixel[5]] < c_b)
-                       if(p[pixel[4]] < c_b)
-                        {}
-                       else
-                        if(p[pixel[12]] < c_b)
-                         if(p[pixel[13]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                      else
-                       if(p[pixel[12]] < c_b)
-                        if(p[pixel[13]] < c_b)
-                         if(p[pixel[14]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                     else
-                      if(p[pixel[12]] < c_b)
-                       if(p[pixel[13]] < c_b)
-                        if(p[pixel[14]] < c_b)
-                         if(p[pixel[15]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                if(p[pixel[10]] > cb)
-                 if(p[pixel[11]] > cb)
-                  if(p[pixel[12]] > cb)
-                   if(p[pixel[13]] > cb)
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         if(p[pixel[9]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         if(p[pixel[9]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         if(p[pixel[9]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else if(p[pixel[10]] < c_b)
-                 if(p[pixel[7]] < c_b)
-                  if(p[pixel[8]] < c_b)
-                   if(p[pixel[9]] < c_b)
-                    if(p[pixel[11]] < c_b)
-                     if(p[pixel[12]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[5]] < c_b)
-                        if(p[pixel[4]] < c_b)
-                         {}
-                        else
-                         if(p[pixel[13]] < c_b)
-                          {}
-                         else
-                          continue;
-                       else
-                        if(p[pixel[13]] < c_b)
-                         if(p[pixel[14]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                      else
-                       if(p[pixel[13]] < c_b)
-                        if(p[pixel[14]] < c_b)
-                         if(p[pixel[15]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-              else if(p[pixel[2]] < c_b)
-               if(p[pixel[9]] > cb)
-                if(p[pixel[10]] > cb)
-                 if(p[pixel[11]] > cb)
-                  if(p[pixel[12]] > cb)
-                   if(p[pixel[13]] > cb)
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[3]] > cb)
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else if(p[pixel[9]] < c_b)
-                if(p[pixel[7]] < c_b)
-                 if(p[pixel[8]] < c_b)
-                  if(p[pixel[10]] < c_b)
-                   if(p[pixel[6]] < c_b)
-                    if(p[pixel[5]] < c_b)
-                     if(p[pixel[4]] < c_b)
-                      if(p[pixel[3]] < c_b)
-                       {}
-                      else
-                       if(p[pixel[11]] < c_b)
-                        if(p[pixel[12]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                     else
-                      if(p[pixel[11]] < c_b)
-                       if(p[pixel[12]] < c_b)
-                        if(p[pixel[13]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[11]] < c_b)
-                      if(p[pixel[12]] < c_b)
-                       if(p[pixel[13]] < c_b)
-                        if(p[pixel[14]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[11]] < c_b)
-                     if(p[pixel[12]] < c_b)
-                      if(p[pixel[13]] < c_b)
-                       if(p[pixel[14]] < c_b)
-                        if(p[pixel[15]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               if(p[pixel[9]] > cb)
-                if(p[pixel[10]] > cb)
-                 if(p[pixel[11]] > cb)
-                  if(p[pixel[12]] > cb)
-                   if(p[pixel[13]] > cb)
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[3]] > cb)
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        if(p[pixel[8]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else if(p[pixel[9]] < c_b)
-                if(p[pixel[7]] < c_b)
-                 if(p[pixel[8]] < c_b)
-                  if(p[pixel[10]] < c_b)
-                   if(p[pixel[11]] < c_b)
-                    if(p[pixel[6]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[4]] < c_b)
-                       if(p[pixel[3]] < c_b)
-                        {}
-                       else
-                        if(p[pixel[12]] < c_b)
-                         {}
-                        else
-                         continue;
-                      else
-                       if(p[pixel[12]] < c_b)
-                        if(p[pixel[13]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                     else
-                      if(p[pixel[12]] < c_b)
-                       if(p[pixel[13]] < c_b)
-                        if(p[pixel[14]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[12]] < c_b)
-                      if(p[pixel[13]] < c_b)
-                       if(p[pixel[14]] < c_b)
-                        if(p[pixel[15]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-             else if(p[pixel[1]] < c_b)
-              if(p[pixel[8]] > cb)
-               if(p[pixel[9]] > cb)
-                if(p[pixel[10]] > cb)
-                 if(p[pixel[11]] > cb)
-                  if(p[pixel[12]] > cb)
-                   if(p[pixel[13]] > cb)
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[3]] > cb)
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[pixel[2]] > cb)
-                   if(p[pixel[3]] > cb)
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 continue;
-               else
-                continue;
-              else if(p[pixel[8]] < c_b)
-               if(p[pixel[7]] < c_b)
-                if(p[pixel[9]] < c_b)
-                 if(p[pixel[6]] < c_b)
-                  if(p[pixel[5]] < c_b)
-                   if(p[pixel[4]] < c_b)
-                    if(p[pixel[3]] < c_b)
-                     if(p[pixel[2]] < c_b)
-                      {}
-                     else
-                      if(p[pixel[10]] < c_b)
-                       if(p[pixel[11]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[10]] < c_b)
-                      if(p[pixel[11]] < c_b)
-                       if(p[pixel[12]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[10]] < c_b)
-                     if(p[pixel[11]] < c_b)
-                      if(p[pixel[12]] < c_b)
-                       if(p[pixel[13]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[10]] < c_b)
-                    if(p[pixel[11]] < c_b)
-                     if(p[pixel[12]] < c_b)
-                      if(p[pixel[13]] < c_b)
-                       if(p[pixel[14]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[pixel[10]] < c_b)
-                   if(p[pixel[11]] < c_b)
-                    if(p[pixel[12]] < c_b)
-                     if(p[pixel[13]] < c_b)
-                      if(p[pixel[14]] < c_b)
-                       if(p[pixel[15]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              if(p[pixel[8]] > cb)
-               if(p[pixel[9]] > cb)
-                if(p[pixel[10]] > cb)
-                 if(p[pixel[11]] > cb)
-                  if(p[pixel[12]] > cb)
-                   if(p[pixel[13]] > cb)
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[15]] > cb)
-                      {}
-                     else
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[3]] > cb)
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[pixel[2]] > cb)
-                   if(p[pixel[3]] > cb)
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[7]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 continue;
-               else
-                continue;
-              else if(p[pixel[8]] < c_b)
-               if(p[pixel[7]] < c_b)
-                if(p[pixel[9]] < c_b)
-                 if(p[pixel[10]] < c_b)
-                  if(p[pixel[6]] < c_b)
-                   if(p[pixel[5]] < c_b)
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[3]] < c_b)
-                      if(p[pixel[2]] < c_b)
-                       {}
-                      else
-                       if(p[pixel[11]] < c_b)
-                        {}
-                       else
-                        continue;
-                     else
-                      if(p[pixel[11]] < c_b)
-                       if(p[pixel[12]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[11]] < c_b)
-                      if(p[pixel[12]] < c_b)
-                       if(p[pixel[13]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[11]] < c_b)
-                     if(p[pixel[12]] < c_b)
-                      if(p[pixel[13]] < c_b)
-                       if(p[pixel[14]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[11]] < c_b)
-                    if(p[pixel[12]] < c_b)
-                     if(p[pixel[13]] < c_b)
-                      if(p[pixel[14]] < c_b)
-                       if(p[pixel[15]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-            else if(p[pixel[0]] < c_b)
-             if(p[pixel[1]] > cb)
-              if(p[pixel[8]] > cb)
-               if(p[pixel[7]] > cb)
-                if(p[pixel[9]] > cb)
-                 if(p[pixel[6]] > cb)
-                  if(p[pixel[5]] > cb)
-                   if(p[pixel[4]] > cb)
-                    if(p[pixel[3]] > cb)
-                     if(p[pixel[2]] > cb)
-                      {}
-                     else
-                      if(p[pixel[10]] > cb)
-                       if(p[pixel[11]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[10]] > cb)
-                      if(p[pixel[11]] > cb)
-                       if(p[pixel[12]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[10]] > cb)
-                     if(p[pixel[11]] > cb)
-                      if(p[pixel[12]] > cb)
-                       if(p[pixel[13]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[10]] > cb)
-                    if(p[pixel[11]] > cb)
-                     if(p[pixel[12]] > cb)
-                      if(p[pixel[13]] > cb)
-                       if(p[pixel[14]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[pixel[10]] > cb)
-                   if(p[pixel[11]] > cb)
-                    if(p[pixel[12]] > cb)
-                     if(p[pixel[13]] > cb)
-                      if(p[pixel[14]] > cb)
-                       if(p[pixel[15]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 continue;
-               else
-                continue;
-              else if(p[pixel[8]] < c_b)
-               if(p[pixel[9]] < c_b)
-                if(p[pixel[10]] < c_b)
-                 if(p[pixel[11]] < c_b)
-                  if(p[pixel[12]] < c_b)
-                   if(p[pixel[13]] < c_b)
-                    if(p[pixel[14]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[3]] < c_b)
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[pixel[2]] < c_b)
-                   if(p[pixel[3]] < c_b)
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else if(p[pixel[1]] < c_b)
-              if(p[pixel[2]] > cb)
-               if(p[pixel[9]] > cb)
-                if(p[pixel[7]] > cb)
-                 if(p[pixel[8]] > cb)
-                  if(p[pixel[10]] > cb)
-                   if(p[pixel[6]] > cb)
-                    if(p[pixel[5]] > cb)
-                     if(p[pixel[4]] > cb)
-                      if(p[pixel[3]] > cb)
-                       {}
-                      else
-                       if(p[pixel[11]] > cb)
-                        if(p[pixel[12]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                     else
-                      if(p[pixel[11]] > cb)
-                       if(p[pixel[12]] > cb)
-                        if(p[pixel[13]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[11]] > cb)
-                      if(p[pixel[12]] > cb)
-                       if(p[pixel[13]] > cb)
-                        if(p[pixel[14]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[11]] > cb)
-                     if(p[pixel[12]] > cb)
-                      if(p[pixel[13]] > cb)
-                       if(p[pixel[14]] > cb)
-                        if(p[pixel[15]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else if(p[pixel[9]] < c_b)
-                if(p[pixel[10]] < c_b)
-                 if(p[pixel[11]] < c_b)
-                  if(p[pixel[12]] < c_b)
-                   if(p[pixel[13]] < c_b)
-                    if(p[pixel[14]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[3]] < c_b)
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else if(p[pixel[2]] < c_b)
-               if(p[pixel[3]] > cb)
-                if(p[pixel[10]] > cb)
-                 if(p[pixel[7]] > cb)
-                  if(p[pixel[8]] > cb)
-                   if(p[pixel[9]] > cb)
-                    if(p[pixel[11]] > cb)
-                     if(p[pixel[6]] > cb)
-                      if(p[pixel[5]] > cb)
-                       if(p[pixel[4]] > cb)
-                        {}
-                       else
-                        if(p[pixel[12]] > cb)
-                         if(p[pixel[13]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                      else
-                       if(p[pixel[12]] > cb)
-                        if(p[pixel[13]] > cb)
-                         if(p[pixel[14]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                     else
-                      if(p[pixel[12]] > cb)
-                       if(p[pixel[13]] > cb)
-                        if(p[pixel[14]] > cb)
-                         if(p[pixel[15]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else if(p[pixel[10]] < c_b)
-                 if(p[pixel[11]] < c_b)
-                  if(p[pixel[12]] < c_b)
-                   if(p[pixel[13]] < c_b)
-                    if(p[pixel[14]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         if(p[pixel[9]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         if(p[pixel[9]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         if(p[pixel[9]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else if(p[pixel[3]] < c_b)
-                if(p[pixel[4]] > cb)
-                 if(p[pixel[13]] > cb)
-                  if(p[pixel[7]] > cb)
-                   if(p[pixel[8]] > cb)
-                    if(p[pixel[9]] > cb)
-                     if(p[pixel[10]] > cb)
-                      if(p[pixel[11]] > cb)
-                       if(p[pixel[12]] > cb)
-                        if(p[pixel[6]] > cb)
-                         if(p[pixel[5]] > cb)
-                          {}
-                         else
-                          if(p[pixel[14]] > cb)
-                           {}
-                          else
-                           continue;
-                        else
-                         if(p[pixel[14]] > cb)
-                          if(p[pixel[15]] > cb)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else if(p[pixel[13]] < c_b)
-                  if(p[pixel[11]] > cb)
-                   if(p[pixel[5]] > cb)
-                    if(p[pixel[6]] > cb)
-                     if(p[pixel[7]] > cb)
-                      if(p[pixel[8]] > cb)
-                       if(p[pixel[9]] > cb)
-                        if(p[pixel[10]] > cb)
-                         if(p[pixel[12]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else if(p[pixel[11]] < c_b)
-                   if(p[pixel[12]] < c_b)
-                    if(p[pixel[14]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         if(p[pixel[9]] < c_b)
-                          if(p[pixel[10]] < c_b)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         if(p[pixel[9]] < c_b)
-                          if(p[pixel[10]] < c_b)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  if(p[pixel[5]] > cb)
-                   if(p[pixel[6]] > cb)
-                    if(p[pixel[7]] > cb)
-                     if(p[pixel[8]] > cb)
-                      if(p[pixel[9]] > cb)
-                       if(p[pixel[10]] > cb)
-                        if(p[pixel[11]] > cb)
-                         if(p[pixel[12]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else if(p[pixel[4]] < c_b)
-                 if(p[pixel[5]] > cb)
-                  if(p[pixel[14]] > cb)
-                   if(p[pixel[7]] > cb)
-                    if(p[pixel[8]] > cb)
-                     if(p[pixel[9]] > cb)
-                      if(p[pixel[10]] > cb)
-                       if(p[pixel[11]] > cb)
-                        if(p[pixel[12]] > cb)
-                         if(p[pixel[13]] > cb)
-                          if(p[pixel[6]] > cb)
-                           {}
-                          else
-                           if(p[pixel[15]] > cb)
-                            {}
-                           else
-                            continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else if(p[pixel[14]] < c_b)
-                   if(p[pixel[12]] > cb)
-                    if(p[pixel[6]] > cb)
-                     if(p[pixel[7]] > cb)
-                      if(p[pixel[8]] > cb)
-                       if(p[pixel[9]] > cb)
-                        if(p[pixel[10]] > cb)
-                         if(p[pixel[11]] > cb)
-                          if(p[pixel[13]] > cb)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else if(p[pixel[12]] < c_b)
-                    if(p[pixel[13]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         if(p[pixel[9]] < c_b)
-                          if(p[pixel[10]] < c_b)
-                           if(p[pixel[11]] < c_b)
-                            {}
-                           else
-                            continue;
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   if(p[pixel[6]] > cb)
-                    if(p[pixel[7]] > cb)
-                     if(p[pixel[8]] > cb)
-                      if(p[pixel[9]] > cb)
-                       if(p[pixel[10]] > cb)
-                        if(p[pixel[11]] > cb)
-                         if(p[pixel[12]] > cb)
-                          if(p[pixel[13]] > cb)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else if(p[pixel[5]] < c_b)
-                  if(p[pixel[6]] > cb)
-                   if(p[pixel[15]] < c_b)
-                    if(p[pixel[13]] > cb)
-                     if(p[pixel[7]] > cb)
-                      if(p[pixel[8]] > cb)
-                       if(p[pixel[9]] > cb)
-                        if(p[pixel[10]] > cb)
-                         if(p[pixel[11]] > cb)
-                          if(p[pixel[12]] > cb)
-                           if(p[pixel[14]] > cb)
-                            {}
-                           else
-                            continue;
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else if(p[pixel[13]] < c_b)
-                     if(p[pixel[14]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    if(p[pixel[7]] > cb)
-                     if(p[pixel[8]] > cb)
-                      if(p[pixel[9]] > cb)
-                       if(p[pixel[10]] > cb)
-                        if(p[pixel[11]] > cb)
-                         if(p[pixel[12]] > cb)
-                          if(p[pixel[13]] > cb)
-                           if(p[pixel[14]] > cb)
-                            {}
-                           else
-                            continue;
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else if(p[pixel[6]] < c_b)
-                   if(p[pixel[7]] > cb)
-                    if(p[pixel[14]] > cb)
-                     if(p[pixel[8]] > cb)
-                      if(p[pixel[9]] > cb)
-                       if(p[pixel[10]] > cb)
-                        if(p[pixel[11]] > cb)
-                         if(p[pixel[12]] > cb)
-                          if(p[pixel[13]] > cb)
-                           if(p[pixel[15]] > cb)
-                            {}
-                           else
-                            continue;
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else if(p[pixel[14]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else if(p[pixel[7]] < c_b)
-                    if(p[pixel[8]] < c_b)
-                     {}
-                    else
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      continue;
-                   else
-                    if(p[pixel[14]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[13]] > cb)
-                    if(p[pixel[7]] > cb)
-                     if(p[pixel[8]] > cb)
-                      if(p[pixel[9]] > cb)
-                       if(p[pixel[10]] > cb)
-                        if(p[pixel[11]] > cb)
-                         if(p[pixel[12]] > cb)
-                          if(p[pixel[14]] > cb)
-                           if(p[pixel[15]] > cb)
-                            {}
-                           else
-                            continue;
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else if(p[pixel[13]] < c_b)
-                    if(p[pixel[14]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[pixel[12]] > cb)
-                   if(p[pixel[7]] > cb)
-                    if(p[pixel[8]] > cb)
-                     if(p[pixel[9]] > cb)
-                      if(p[pixel[10]] > cb)
-                       if(p[pixel[11]] > cb)
-                        if(p[pixel[13]] > cb)
-                         if(p[pixel[14]] > cb)
-                          if(p[pixel[6]] > cb)
-                           {}
-                          else
-                           if(p[pixel[15]] > cb)
-                            {}
-                           else
-                            continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else if(p[pixel[12]] < c_b)
-                   if(p[pixel[13]] < c_b)
-                    if(p[pixel[14]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         if(p[pixel[9]] < c_b)
-                          if(p[pixel[10]] < c_b)
-                           if(p[pixel[11]] < c_b)
-                            {}
-                           else
-                            continue;
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[pixel[11]] > cb)
-                  if(p[pixel[7]] > cb)
-                   if(p[pixel[8]] > cb)
-                    if(p[pixel[9]] > cb)
-                     if(p[pixel[10]] > cb)
-                      if(p[pixel[12]] > cb)
-                       if(p[pixel[13]] > cb)
-                        if(p[pixel[6]] > cb)
-                         if(p[pixel[5]] > cb)
-                          {}
-                         else
-                          if(p[pixel[14]] > cb)
-                           {}
-                          else
-                           continue;
-                        else
-                         if(p[pixel[14]] > cb)
-                          if(p[pixel[15]] > cb)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else if(p[pixel[11]] < c_b)
-                  if(p[pixel[12]] < c_b)
-                   if(p[pixel[13]] < c_b)
-                    if(p[pixel[14]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         if(p[pixel[9]] < c_b)
-                          if(p[pixel[10]] < c_b)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         if(p[pixel[9]] < c_b)
-                          if(p[pixel[10]] < c_b)
-                           {}
-                          else
-                           continue;
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                if(p[pixel[10]] > cb)
-                 if(p[pixel[7]] > cb)
-                  if(p[pixel[8]] > cb)
-                   if(p[pixel[9]] > cb)
-                    if(p[pixel[11]] > cb)
-                     if(p[pixel[12]] > cb)
-                      if(p[pixel[6]] > cb)
-                       if(p[pixel[5]] > cb)
-                        if(p[pixel[4]] > cb)
-                         {}
-                        else
-                         if(p[pixel[13]] > cb)
-                          {}
-                         else
-                          continue;
-                       else
-                        if(p[pixel[13]] > cb)
-                         if(p[pixel[14]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                      else
-                       if(p[pixel[13]] > cb)
-                        if(p[pixel[14]] > cb)
-                         if(p[pixel[15]] > cb)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else if(p[pixel[10]] < c_b)
-                 if(p[pixel[11]] < c_b)
-                  if(p[pixel[12]] < c_b)
-                   if(p[pixel[13]] < c_b)
-                    if(p[pixel[14]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         if(p[pixel[9]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         if(p[pixel[9]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         if(p[pixel[9]] < c_b)
-                          {}
-                         else
-                          continue;
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-              else
-               if(p[pixel[9]] > cb)
-                if(p[pixel[7]] > cb)
-                 if(p[pixel[8]] > cb)
-                  if(p[pixel[10]] > cb)
-                   if(p[pixel[11]] > cb)
-                    if(p[pixel[6]] > cb)
-                     if(p[pixel[5]] > cb)
-                      if(p[pixel[4]] > cb)
-                       if(p[pixel[3]] > cb)
-                        {}
-                       else
-                        if(p[pixel[12]] > cb)
-                         {}
-                        else
-                         continue;
-                      else
-                       if(p[pixel[12]] > cb)
-                        if(p[pixel[13]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                     else
-                      if(p[pixel[12]] > cb)
-                       if(p[pixel[13]] > cb)
-                        if(p[pixel[14]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[12]] > cb)
-                      if(p[pixel[13]] > cb)
-                       if(p[pixel[14]] > cb)
-                        if(p[pixel[15]] > cb)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else if(p[pixel[9]] < c_b)
-                if(p[pixel[10]] < c_b)
-                 if(p[pixel[11]] < c_b)
-                  if(p[pixel[12]] < c_b)
-                   if(p[pixel[13]] < c_b)
-                    if(p[pixel[14]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[3]] < c_b)
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        if(p[pixel[8]] < c_b)
-                         {}
-                        else
-                         continue;
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-             else
-              if(p[pixel[8]] > cb)
-               if(p[pixel[7]] > cb)
-                if(p[pixel[9]] > cb)
-                 if(p[pixel[10]] > cb)
-                  if(p[pixel[6]] > cb)
-                   if(p[pixel[5]] > cb)
-                    if(p[pixel[4]] > cb)
-                     if(p[pixel[3]] > cb)
-                      if(p[pixel[2]] > cb)
-                       {}
-                      else
-                       if(p[pixel[11]] > cb)
-                        {}
-                       else
-                        continue;
-                     else
-                      if(p[pixel[11]] > cb)
-                       if(p[pixel[12]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[11]] > cb)
-                      if(p[pixel[12]] > cb)
-                       if(p[pixel[13]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[11]] > cb)
-                     if(p[pixel[12]] > cb)
-                      if(p[pixel[13]] > cb)
-                       if(p[pixel[14]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[11]] > cb)
-                    if(p[pixel[12]] > cb)
-                     if(p[pixel[13]] > cb)
-                      if(p[pixel[14]] > cb)
-                       if(p[pixel[15]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else if(p[pixel[8]] < c_b)
-               if(p[pixel[9]] < c_b)
-                if(p[pixel[10]] < c_b)
-                 if(p[pixel[11]] < c_b)
-                  if(p[pixel[12]] < c_b)
-                   if(p[pixel[13]] < c_b)
-                    if(p[pixel[14]] < c_b)
-                     if(p[pixel[15]] < c_b)
-                      {}
-                     else
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                    else
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[3]] < c_b)
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[pixel[2]] < c_b)
-                   if(p[pixel[3]] < c_b)
-                    if(p[pixel[4]] < c_b)
-                     if(p[pixel[5]] < c_b)
-                      if(p[pixel[6]] < c_b)
-                       if(p[pixel[7]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-            else
-             if(p[pixel[7]] > cb)
-              if(p[pixel[8]] > cb)
-               if(p[pixel[9]] > cb)
-                if(p[pixel[6]] > cb)
-                 if(p[pixel[5]] > cb)
-                  if(p[pixel[4]] > cb)
-                   if(p[pixel[3]] > cb)
-                    if(p[pixel[2]] > cb)
-                     if(p[pixel[1]] > cb)
-                      {}
-                     else
-                      if(p[pixel[10]] > cb)
-                       {}
-                      else
-                       continue;
-                    else
-                     if(p[pixel[10]] > cb)
-                      if(p[pixel[11]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[10]] > cb)
-                     if(p[pixel[11]] > cb)
-                      if(p[pixel[12]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[10]] > cb)
-                    if(p[pixel[11]] > cb)
-                     if(p[pixel[12]] > cb)
-                      if(p[pixel[13]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[pixel[10]] > cb)
-                   if(p[pixel[11]] > cb)
-                    if(p[pixel[12]] > cb)
-                     if(p[pixel[13]] > cb)
-                      if(p[pixel[14]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[pixel[10]] > cb)
-                  if(p[pixel[11]] > cb)
-                   if(p[pixel[12]] > cb)
-                    if(p[pixel[13]] > cb)
-                     if(p[pixel[14]] > cb)
-                      if(p[pixel[15]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                continue;
-              else
-               continue;
-             else if(p[pixel[7]] < c_b)
-              if(p[pixel[8]] < c_b)
-               if(p[pixel[9]] < c_b)
-                if(p[pixel[6]] < c_b)
-                 if(p[pixel[5]] < c_b)
-                  if(p[pixel[4]] < c_b)
-                   if(p[pixel[3]] < c_b)
-                    if(p[pixel[2]] < c_b)
-                     if(p[pixel[1]] < c_b)
-                      {}
-                     else
-                      if(p[pixel[10]] < c_b)
-                       {}
-                      else
-                       continue;
-                    else
-                     if(p[pixel[10]] < c_b)
-                      if(p[pixel[11]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[pixel[10]] < c_b)
-                     if(p[pixel[11]] < c_b)
-                      if(p[pixel[12]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[pixel[10]] < c_b)
-                    if(p[pixel[11]] < c_b)
-                     if(p[pixel[12]] < c_b)
-                      if(p[pixel[13]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[pixel[10]] < c_b)
-                   if(p[pixel[11]] < c_b)
-                    if(p[pixel[12]] < c_b)
-                     if(p[pixel[13]] < c_b)
-                      if(p[pixel[14]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[pixel[10]] < c_b)
-                  if(p[pixel[11]] < c_b)
-                   if(p[pixel[12]] < c_b)
-                    if(p[pixel[13]] < c_b)
-                     if(p[pixel[14]] < c_b)
-                      if(p[pixel[15]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-
-            // Add corner
-            corners[num_corners].x = x;
-            corners[num_corners].y = y;
-
-            if (++num_corners == max_corners) {
-                goto done;
-            }
-		}
-    }
-
-done:
-    *n_corners = num_corners;
-    return corners;
+#ifdef IMLIB_ENABLE_FAST
+void fast_detect(image_t *image, array_t *keypoints, int threshold, rectangle_t *roi) {
+    segment_test_detect(image, keypoints, threshold, roi, &fast9_test);
 }
-// *INDENT-ON*
+#endif
 
-#endif //IMLIB_ENABLE_FAST
+void agast_detect(image_t *image, array_t *keypoints, int threshold, rectangle_t *roi) {
+    segment_test_detect(image, keypoints, threshold, roi, &agast58_test);
+}
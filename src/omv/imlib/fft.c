@@ -9,6 +9,7 @@
 #include "py/runtime.h"
 #include "py/obj.h"
 #include <arm_math.h>
+#include <arm_const_structs.h>
 #include "fb_alloc.h"
 #include "file_utils.h"
 #include "omv_common.h"
@@ -315,28 +316,25 @@ OMV_ATTR_ALWAYS_INLINE static void swap(float *a, float *b) {
 //    }
 //}
 
-// Copies 2N real pairs (or pad with zero) from in to out while bit reversing
-// their indexes.
+// Copies 2N real pairs (or pad with zero) from in to out.
 
 static void prepare_real_input(uint8_t *in, int in_len, float *out, int N_pow2) {
     for (int k = 0, l = 2 << N_pow2; k < l; k += 2) {
-        int m = bit_reverse(k, N_pow2);
-        out[m + 0] = ((k + 0) < in_len) ? in[k + 0] : 0;
-        out[m + 1] = ((k + 1) < in_len) ? in[k + 1] : 0;
+        out[k + 0] = ((k + 0) < in_len) ? in[k + 0] : 0;
+        out[k + 1] = ((k + 1) < in_len) ? in[k + 1] : 0;
 //        // Apply Hann Window (this is working on real numbers)
-//        out[m+0] *= get_hann(k+0, N_pow2);
-//        out[m+1] *= get_hann(k+1, N_pow2);
+//        out[k+0] *= get_hann(k+0, N_pow2);
+//        out[k+1] *= get_hann(k+1, N_pow2);
     }
 }
 
 static void prepare_real_input_again(float *in, int in_len, float *out, int N_pow2) {
     for (int k = 0, l = 2 << N_pow2; k < l; k += 2) {
-        int m = bit_reverse(k, N_pow2);
-        out[m + 0] = ((k + 0) < in_len) ? in[(k * 2) + 0] : 0;
-        out[m + 1] = ((k + 1) < in_len) ? in[(k * 2) + 2] : 0;
+        out[k + 0] = ((k + 0) < in_len) ? in[(k * 2) + 0] : 0;
+        out[k + 1] = ((k + 1) < in_len) ? in[(k * 2) + 2] : 0;
 //        // Apply Hann Window (this is working on real numbers)
-//        out[m+0] *= get_hann(k+0, N_pow2);
-//        out[m+1] *= get_hann(k+1, N_pow2);
+//        out[k+0] *= get_hann(k+0, N_pow2);
+//        out[k+1] *= get_hann(k+1, N_pow2);
     }
 }
 
@@ -349,41 +347,64 @@ static void prepare_real_input_again(float *in, int in_len, float *out, int N_po
 //    }
 //}
 
-// Copies N complex pairs from in to out while bit reversing their indexes. The
-// in and out arrays may be the same.
+// Bit reverses the indexes of N complex pairs in place.
 
-static void prepare_complex_input(float *in, float *out, int N_pow2, int stride) {
-    if (in == out) {
-        for (int k = 0, l = 2 << N_pow2; k < l; k += 2) {
-            int m = bit_reverse(k, N_pow2);
-            if (k < m) {
-                swap(out + (m * stride) + 0, in + (k * stride) + 0);
-                swap(out + (m * stride) + 1, in + (k * stride) + 1);
-            }
-        }
-    } else {
-        for (int k = 0, l = 2 << N_pow2; k < l; k += 2) {
-            int m = bit_reverse(k, N_pow2);
-            out[(m * stride) + 0] = in[(k * stride) + 0];
-            out[(m * stride) + 1] = in[(k * stride) + 1];
+static void bit_reverse_complex_input(float *inout, int N_pow2) {
+    for (int k = 0, l = 2 << N_pow2; k < l; k += 2) {
+        int m = bit_reverse(k, N_pow2);
+        if (k < m) {
+            swap(inout + m + 0, inout + k + 0);
+            swap(inout + m + 1, inout + k + 1);
         }
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
+#if (__ARM_ARCH >= 7)
+// CMSIS-DSP mixed radix transforms. Returns NULL for sizes without an instance.
+static const arm_cfft_instance_f32 *get_cfft_instance(int N_pow2) {
+    switch (N_pow2) {
+        case 4:
+            return &arm_cfft_sR_f32_len16;
+        case 5:
+            return &arm_cfft_sR_f32_len32;
+        case 6:
+            return &arm_cfft_sR_f32_len64;
+        case 7:
+            return &arm_cfft_sR_f32_len128;
+        case 8:
+            return &arm_cfft_sR_f32_len256;
+        case 9:
+            return &arm_cfft_sR_f32_len512;
+        default:
+            return NULL;
+    }
+}
+#endif
+
 // Performs the fft in place.
-static void do_fft(float *inout, int N_pow2, int stride) {
+static void do_fft(float *inout, int N_pow2) {
+    #if (__ARM_ARCH >= 7)
+    const arm_cfft_instance_f32 *S = get_cfft_instance(N_pow2);
+    if (S) {
+        arm_cfft_f32(S, inout, 0, 1);
+        return;
+    }
+    #endif
+
+    bit_reverse_complex_input(inout, N_pow2);
+
     int N = 2 << N_pow2;
     for (int N_pow2_i = 1; N_pow2_i <= N_pow2; N_pow2_i++) {
         int N_mul2 = 2 << N_pow2_i;
         int N_div2 = 1 << N_pow2_i;
         for (int i = 0; i < N; i += N_mul2) {
             for (int j = i, k = 0, l = i + N_div2, m = N >> N_pow2_i; j < l; j += 2, k += m) {
-                int x0_r = (j * stride) + 0;
-                int x0_i = (j * stride) + 1;
-                int x1_r = ((j + N_div2) * stride) + 0;
-                int x1_i = ((j + N_div2) * stride) + 1;
+                int x0_r = j + 0;
+                int x0_i = j + 1;
+                int x1_r = j + N_div2 + 0;
+                int x1_i = j + N_div2 + 1;
                 float tmp_r = (inout[x1_r] * get_cos(k, N_pow2)) +
                               (inout[x1_i] * get_sin(k, N_pow2));
                 float tmp_i = (inout[x1_i] * get_cos(k, N_pow2)) -
@@ -398,17 +419,28 @@ static void do_fft(float *inout, int N_pow2, int stride) {
 }
 
 // Performs the ifft in place.
-static void do_ifft(float *inout, int N_pow2, int stride) {
+static void do_ifft(float *inout, int N_pow2) {
+    #if (__ARM_ARCH >= 7)
+    const arm_cfft_instance_f32 *S = get_cfft_instance(N_pow2);
+    if (S) {
+        // Also scales the output by 1/N.
+        arm_cfft_f32(S, inout, 1, 1);
+        return;
+    }
+    #endif
+
+    bit_reverse_complex_input(inout, N_pow2);
+
     int N = 2 << N_pow2;
     for (int N_pow2_i = 1; N_pow2_i <= N_pow2; N_pow2_i++) {
         int N_mul2 = 2 << N_pow2_i;
         int N_div2 = 1 << N_pow2_i;
         for (int i = 0; i < N; i += N_mul2) {
             for (int j = i, k = 0, l = i + N_div2, m = N >> N_pow2_i; j < l; j += 2, k += m) {
-                int x0_r = (j * stride) + 0;
-                int x0_i = (j * stride) + 1;
-                int x1_r = ((j + N_div2) * stride) + 0;
-                int x1_i = ((j + N_div2) * stride) + 1;
+                int x0_r = j + 0;
+                int x0_i = j + 1;
+                int x1_r = j + N_div2 + 0;
+                int x1_i = j + N_div2 + 1;
                 float tmp_r = (inout[x1_r] * get_cos(k, N_pow2)) -
                               (inout[x1_i] * get_sin(k, N_pow2));
                 float tmp_i = (inout[x1_i] * get_cos(k, N_pow2)) +
@@ -423,13 +455,43 @@ static void do_ifft(float *inout, int N_pow2, int stride) {
 
     float div = 1.0 / (N >> 1);
     for (int i = 0; i < N; i += 2) {
-        inout[(i * stride) + 0] *= div;
-        inout[(i * stride) + 1] *= div;
+        inout[i + 0] *= div;
+        inout[i + 1] *= div;
     }
 }
 
-///////////////////////////////////////////////////////////////////////////////
+// Performs the fft (or ifft) down each column of a 2D buffer. Each column is
+// copied into a contiguous buffer first so the transform runs on unit stride
+// data instead of touching a new row for every sample.
+static void do_fft_columns(fft2d_controller_t *controller, bool inverse) {
+    int row_len = 2 << controller->w_pow2;
+    int col_len = 2 << controller->h_pow2;
+    float *col = fb_alloc(col_len * sizeof(float), FB_ALLOC_NO_HINT);
+
+    for (int i = 0; i < row_len; i += 2) {
+        float *p = controller->data + i;
 
+        for (int j = 0, k = 0; j < col_len; j += 2, k += row_len) {
+            col[j + 0] = p[k + 0];
+            col[j + 1] = p[k + 1];
+        }
+
+        if (inverse) {
+            do_ifft(col, controller->h_pow2);
+        } else {
+            do_fft(col, controller->h_pow2);
+        }
+
+        for (int j = 0, k = 0; j < col_len; j += 2, k += row_len) {
+            p[k + 0] = col[j + 0];
+            p[k + 1] = col[j + 1];
+        }
+    }
+
+    fb_free();
+}
+
+///////////////////////////////////////////////////////////////////////////////
 void fft1d_alloc(fft1d_controller_t *controller, uint8_t *buf, int len) {
     controller->d_pointer = buf;
     controller->d_len = len;
@@ -448,7 +510,7 @@ void fft1d_run(fft1d_controller_t *controller) {
     float *h_buffer = fb_alloc((1 << controller->pow2) * sizeof(float), FB_ALLOC_NO_HINT);
     prepare_real_input(controller->d_pointer, controller->d_len,
                        h_buffer, controller->pow2 - 1);
-    do_fft(h_buffer, controller->pow2 - 1, 1);
+    do_fft(h_buffer, controller->pow2 - 1);
     unpack_fft(h_buffer, controller->data, controller->pow2 - 1);
     fb_free();
 }
@@ -459,9 +521,7 @@ void ifft1d_run(fft1d_controller_t *controller) {
 
     float *h_buffer = fb_alloc((1 << controller->pow2) * sizeof(float), FB_ALLOC_NO_HINT);
     pack_fft(controller->data, h_buffer, controller->pow2 - 1);
-    prepare_complex_input(h_buffer, h_buffer,
-                          controller->pow2 - 1, 1);
-    do_ifft(h_buffer, controller->pow2 - 1, 1);
+    do_ifft(h_buffer, controller->pow2 - 1);
     memset(controller->data, 0, (2 << controller->pow2) * sizeof(float));
     memcpy(controller->data, h_buffer, (1 << controller->pow2) * sizeof(float));
     fb_free();
@@ -521,7 +581,7 @@ void fft1d_run_again(fft1d_controller_t *controller) {
     float *h_buffer = fb_alloc((1 << controller->pow2) * sizeof(float), FB_ALLOC_NO_HINT);
     prepare_real_input_again(controller->data, 1 << controller->pow2,
                              h_buffer, controller->pow2 - 1);
-    do_fft(h_buffer, controller->pow2 - 1, 1);
+    do_fft(h_buffer, controller->pow2 - 1);
     unpack_fft(h_buffer, controller->data, controller->pow2 - 1);
     fb_free();
 }
@@ -572,23 +632,13 @@ void fft2d_run(fft2d_controller_t *controller) {
         fb_free();
     }
 
-    // The above operates on the rows and this fft operates on the columns. To
-    // avoid having to transpose the array the fft takes a stride input.
-    for (int i = 0, ii = 2 << controller->w_pow2; i < ii; i += 2) {
-        float *p = controller->data + i;
-//        apply_hann_window(p, controller->h_pow2, (1 << controller->w_pow2));
-        prepare_complex_input(p, p, controller->h_pow2, (1 << controller->w_pow2));
-        do_fft(p, controller->h_pow2, (1 << controller->w_pow2));
-    }
+    // The above operates on the rows and this fft operates on the columns.
+    do_fft_columns(controller, false);
 }
 
 void ifft2d_run(fft2d_controller_t *controller) {
     // Do columns...
-    for (int i = 0, ii = 2 << controller->w_pow2; i < ii; i += 2) {
-        float *p = controller->data + i;
-        prepare_complex_input(p, p, controller->h_pow2, (1 << controller->w_pow2));
-        do_ifft(p, controller->h_pow2, (1 << controller->w_pow2));
-    }
+    do_fft_columns(controller, true);
 
     // Do rows...
     for (int i = 0, ii = 1 << controller->h_pow2; i < ii; i++) {
@@ -737,12 +787,6 @@ void fft2d_run_again(fft2d_controller_t *controller) {
         fft1d_run_again(&fft1d_controller_i);
     }
 
-    // The above operates on the rows and this fft operates on the columns. To
-    // avoid having to transpose the array the fft takes a stride input.
-    for (int i = 0, ii = 2 << controller->w_pow2; i < ii; i += 2) {
-        float *p = controller->data + i;
-//        apply_hann_window(p, controller->h_pow2, (1 << controller->w_pow2));
-        prepare_complex_input(p, p, controller->h_pow2, (1 << controller->w_pow2));
-        do_fft(p, controller->h_pow2, (1 << controller->w_pow2));
-    }
+    // The above operates on the rows and this fft operates on the columns.
+    do_fft_columns(controller, false);
 }
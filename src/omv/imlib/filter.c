@@ -11,7 +11,14 @@
 #include "fsort.h"
 #include "imlib.h"
 
+// Without a mask each row is a single run.
+#define HISTEQ_RUNS_BEGIN(y)    (mask ? MASK_RUNS_ROW_BEGIN(&runs, (y)) : &full)
+#define HISTEQ_RUNS_END(y)      (mask ? MASK_RUNS_ROW_END(&runs, (y)) : (&full + 1))
+
 void imlib_histeq(image_t *img, image_t *mask) {
+    mask_run_t full = { 0, img->w };
+    mask_runs_t runs;
+
     switch (img->pixfmt) {
         case PIXFORMAT_BINARY: {
             int a = img->w * img->h;
@@ -30,18 +37,24 @@ void imlib_histeq(image_t *img, image_t *mask) {
                 hist[i] = sum;
             }
 
+            if (mask) {
+                imlib_mask_runs_init(&runs, mask, img->w, img->h, false);
+            }
+
             for (int y = 0, yy = img->h; y < yy; y++) {
                 uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
-                for (int x = 0, xx = img->w; x < xx; x++) {
-                    if (mask && (!image_get_mask_pixel(mask, x, y))) {
-                        continue;
+                for (mask_run_t *run = HISTEQ_RUNS_BEGIN(y), *run_end = HISTEQ_RUNS_END(y); run < run_end; run++) {
+                    for (int x = run->x, xx = run->x_end; x < xx; x++) {
+                        int pixel = IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x);
+                        IMAGE_PUT_BINARY_PIXEL_FAST(row_ptr, x,
+                                                    fast_floorf((s * hist[pixel - COLOR_BINARY_MIN]) + COLOR_BINARY_MIN));
                     }
-                    int pixel = IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x);
-                    IMAGE_PUT_BINARY_PIXEL_FAST(row_ptr, x,
-                                                fast_floorf((s * hist[pixel - COLOR_BINARY_MIN]) + COLOR_BINARY_MIN));
                 }
             }
 
+            if (mask) {
+                imlib_mask_runs_free(&runs);
+            }
             fb_free();
             break;
         }
@@ -49,31 +62,41 @@ void imlib_histeq(image_t *img, image_t *mask) {
             int a = img->w * img->h;
             float s = (COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN) / ((float) a);
             uint32_t *hist = fb_alloc0((COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN + 1) * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+            rectangle_t roi = { 0, 0, img->w, img->h };
 
-            for (int y = 0, yy = img->h; y < yy; y++) {
-                uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
-                for (int x = 0, xx = img->w; x < xx; x++) {
-                    hist[IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x) - COLOR_GRAYSCALE_MIN] += 1;
-                }
-            }
+            // COLOR_GRAYSCALE_MIN is 0, so the bins are the pixel values.
+            imlib_task_histogram_grayscale(img, &roi, hist);
 
             for (int i = 0, sum = 0, ii = COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN + 1; i < ii; i++) {
                 sum += hist[i];
                 hist[i] = sum;
             }
 
+            if (!mask) {
+                uint8_t lut[COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN + 1];
+                for (int i = 0, ii = COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN + 1; i < ii; i++) {
+                    lut[i] = fast_floorf((s * hist[i]) + COLOR_GRAYSCALE_MIN);
+                }
+                imlib_task_lut_grayscale(img, &roi, lut);
+                fb_free();
+                break;
+            }
+
+            imlib_mask_runs_init(&runs, mask, img->w, img->h, false);
+
             for (int y = 0, yy = img->h; y < yy; y++) {
                 uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
-                for (int x = 0, xx = img->w; x < xx; x++) {
-                    if (mask && (!image_get_mask_pixel(mask, x, y))) {
-                        continue;
+                for (mask_run_t *run = HISTEQ_RUNS_BEGIN(y), *run_end = HISTEQ_RUNS_END(y); run < run_end; run++) {
+                    for (int x = run->x, xx = run->x_end; x < xx; x++) {
+                        int pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
+                        IMAGE_PUT_GRAYSCALE_PIXEL_FAST(row_ptr, x,
+                                                       fast_floorf((s * hist[pixel - COLOR_GRAYSCALE_MIN]) +
+                                                                   COLOR_GRAYSCALE_MIN));
                     }
-                    int pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
-                    IMAGE_PUT_GRAYSCALE_PIXEL_FAST(row_ptr, x,
-                                                   fast_floorf((s * hist[pixel - COLOR_GRAYSCALE_MIN]) + COLOR_GRAYSCALE_MIN));
                 }
             }
 
+            imlib_mask_runs_free(&runs);
             fb_free();
             break;
         }
@@ -94,24 +117,30 @@ void imlib_histeq(image_t *img, image_t *mask) {
                 hist[i] = sum;
             }
 
+            if (mask) {
+                imlib_mask_runs_init(&runs, mask, img->w, img->h, false);
+            }
+
             for (int y = 0, yy = img->h; y < yy; y++) {
                 uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
-                for (int x = 0, xx = img->w; x < xx; x++) {
-                    if (mask && (!image_get_mask_pixel(mask, x, y))) {
-                        continue;
+                for (mask_run_t *run = HISTEQ_RUNS_BEGIN(y), *run_end = HISTEQ_RUNS_END(y); run < run_end; run++) {
+                    for (int x = run->x, xx = run->x_end; x < xx; x++) {
+                        int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
+                        int r = COLOR_RGB565_TO_R8(pixel);
+                        int g = COLOR_RGB565_TO_G8(pixel);
+                        int b = COLOR_RGB565_TO_B8(pixel);
+                        uint8_t y, u, v;
+                        y = (uint8_t) (((r * 9770) + (g * 19182) + (b * 3736)) >> 15); // .299*r + .587*g + .114*b
+                        u = (uint8_t) (((b << 14) - (r * 5529) - (g * 10855)) >> 15);  // -0.168736*r + -0.331264*g + 0.5*b
+                        v = (uint8_t) (((r << 14) - (g * 13682) - (b * 2664)) >> 15);  // 0.5*r + -0.418688*g + -0.081312*b
+                        IMAGE_PUT_RGB565_PIXEL_FAST(row_ptr, x, imlib_yuv_to_rgb(fast_floorf(s * hist[y]), u, v));
                     }
-                    int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
-                    int r = COLOR_RGB565_TO_R8(pixel);
-                    int g = COLOR_RGB565_TO_G8(pixel);
-                    int b = COLOR_RGB565_TO_B8(pixel);
-                    uint8_t y, u, v;
-                    y = (uint8_t) (((r * 9770) + (g * 19182) + (b * 3736)) >> 15); // .299*r + .587*g + .114*b
-                    u = (uint8_t) (((b << 14) - (r * 5529) - (g * 10855)) >> 15);  // -0.168736*r + -0.331264*g + 0.5*b
-                    v = (uint8_t) (((r << 14) - (g * 13682) - (b * 2664)) >> 15);  // 0.5*r + -0.418688*g + -0.081312*b
-                    IMAGE_PUT_RGB565_PIXEL_FAST(row_ptr, x, imlib_yuv_to_rgb(fast_floorf(s * hist[y]), u, v));
                 }
             }
 
+            if (mask) {
+                imlib_mask_runs_free(&runs);
+            }
             fb_free();
             break;
         }
@@ -121,20 +150,114 @@ void imlib_histeq(image_t *img, image_t *mask) {
     }
 }
 
+#undef HISTEQ_RUNS_BEGIN
+#undef HISTEQ_RUNS_END
+
 // ksize == 0 -> 1x1 kernel
 // ksize == 1 -> 3x3 kernel
 // ...
 // ksize == n -> ((n*2)+1)x((n*2)+1) kernel
 //
-// To speed up this filter, we can help in two ways:
-// 1) For the 'center portion' of the image area, we don't need to check
-//   the x+y values against the boundary conditions on each pixel.
-// 2) In that same region we can take advantage of the filter property being
-//   the sum of all of the pixels by subtracting the last left edge values
-//   and adding the new right edge values instead of re-calculating the sum
-//   of every pixel. This will allow very large filters to be used without
-//   much change in performance.
+// The mean and median filters keep per column state covering the (n*2)+1 rows of the
+// window, which is updated by removing the row leaving the window and adding the row
+// entering it. The window is then slid along each row by adding the column entering the
+// window and removing the column leaving it. So, the cost per pixel doesn't depend on
+// the kernel size. Pixels outside of the image repeat the edge pixels.
 //
+#if defined(IMLIB_ENABLE_MEAN) || defined(IMLIB_ENABLE_MEDIAN)
+static int filter_channels(image_t *img) {
+    return (img->pixfmt == PIXFORMAT_RGB565) ? 3 : 1;
+}
+
+// Adds (or removes) row y to the per column channel sums.
+static void filter_sum_row(image_t *img, int y, uint32_t *cols, bool add) {
+    switch (img->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
+            for (int x = 0, xx = img->w; x < xx; x++) {
+                if (add) {
+                    cols[x] += IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x);
+                } else {
+                    cols[x] -= IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x);
+                }
+            }
+            break;
+        }
+        case PIXFORMAT_GRAYSCALE: {
+            uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+            for (int x = 0, xx = img->w; x < xx; x++) {
+                if (add) {
+                    cols[x] += IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
+                } else {
+                    cols[x] -= IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
+                }
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+            for (int x = 0, xx = img->w; x < xx; x++, cols += 3) {
+                int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
+                if (add) {
+                    cols[0] += COLOR_RGB565_TO_R5(pixel);
+                    cols[1] += COLOR_RGB565_TO_G6(pixel);
+                    cols[2] += COLOR_RGB565_TO_B5(pixel);
+                } else {
+                    cols[0] -= COLOR_RGB565_TO_R5(pixel);
+                    cols[1] -= COLOR_RGB565_TO_G6(pixel);
+                    cols[2] -= COLOR_RGB565_TO_B5(pixel);
+                }
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+// Sets up the column sums for row 0.
+static uint32_t *filter_sum_alloc(image_t *img, const int ksize) {
+    uint32_t *cols = fb_alloc0(img->w * filter_channels(img) * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    for (int j = -ksize; j <= ksize; j++) {
+        filter_sum_row(img, IM_CLAMP(j, 0, (img->h - 1)), cols, true);
+    }
+    return cols;
+}
+
+// Moves the column sums from row y to row y + 1.
+static void filter_sum_next(image_t *img, const int ksize, int y, uint32_t *cols) {
+    if ((y + 1) < img->h) {
+        filter_sum_row(img, IM_MAX(y - ksize, 0), cols, false);
+        filter_sum_row(img, IM_MIN(y + ksize + 1, img->h - 1), cols, true);
+    }
+}
+
+// Window sums of the first pixel of a row.
+static void filter_sum_start(image_t *img, const int ksize, uint32_t *cols, uint32_t *acc) {
+    int channels = filter_channels(img);
+    for (int c = 0; c < channels; c++) {
+        acc[c] = 0;
+    }
+    for (int k = -ksize; k <= ksize; k++) {
+        uint32_t *col = cols + (IM_CLAMP(k, 0, (img->w - 1)) * channels);
+        for (int c = 0; c < channels; c++) {
+            acc[c] += col[c];
+        }
+    }
+}
+
+// Slides the window sums from pixel x to pixel x + 1.
+static inline void filter_sum_slide(image_t *img, const int ksize, int x, int channels,
+                                    uint32_t *cols, uint32_t *acc) {
+    uint32_t *col_add = cols + (IM_MIN(x + ksize + 1, img->w - 1) * channels);
+    uint32_t *col_sub = cols + (IM_MAX(x - ksize, 0) * channels);
+    for (int c = 0; c < channels; c++) {
+        acc[c] += col_add[c] - col_sub[c];
+    }
+}
+#endif // defined(IMLIB_ENABLE_MEAN) || defined(IMLIB_ENABLE_MEDIAN)
+
 #ifdef IMLIB_ENABLE_MEAN
 void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset, bool invert, image_t *mask) {
     int brows = ksize + 1;
@@ -144,44 +267,27 @@ void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset
     buf.pixfmt = img->pixfmt;
 
     int32_t over32_n = 65536 / (((ksize * 2) + 1) * ((ksize * 2) + 1));
+    uint32_t acc[3];
 
     switch (img->pixfmt) {
         case PIXFORMAT_BINARY: {
             buf.data = fb_alloc(IMAGE_BINARY_LINE_LEN_BYTES(img) * brows, FB_ALLOC_NO_HINT);
+            uint32_t *cols = filter_sum_alloc(img, ksize);
 
             for (int y = 0, yy = img->h; y < yy; y++) {
-                int pixel, acc = 0;
                 uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
                 uint32_t *buf_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&buf, (y % brows));
+                filter_sum_start(img, ksize, cols, acc);
 
                 for (int x = 0, xx = img->w; x < xx; x++) {
+                    int pixel = (int) ((acc[0] * over32_n) >> 16);
+                    filter_sum_slide(img, ksize, x, 1, cols, acc);
+
                     if (mask && (!image_get_mask_pixel(mask, x, y))) {
                         IMAGE_PUT_BINARY_PIXEL_FAST(buf_row_ptr, x, IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x));
                         continue; // Short circuit.
                     }
 
-                    if (!mask && x > ksize && x < img->w - ksize && y >= ksize && y < img->h - ksize) {
-                        for (int j = -ksize; j <= ksize; j++) {
-                            uint32_t *k_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y + j);
-                            acc -= IMAGE_GET_BINARY_PIXEL_FAST(k_row_ptr, x - ksize - 1);
-                            acc += IMAGE_GET_BINARY_PIXEL_FAST(k_row_ptr, x + ksize);
-                        }
-                    } else {
-                        acc = 0;
-
-                        for (int j = -ksize; j <= ksize; j++) {
-                            int y_j = IM_CLAMP(y + j, 0, (img->h - 1));
-                            uint32_t *k_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y_j);
-
-                            for (int k = -ksize; k <= ksize; k++) {
-                                int x_k = IM_CLAMP(x + k, 0, (img->w - 1));
-                                acc += IMAGE_GET_BINARY_PIXEL_FAST(k_row_ptr, x_k);
-                            }
-                        }
-                    }
-
-                    pixel = (int) ((acc * over32_n) >> 16);
-
                     if (threshold) {
                         if (((pixel - offset) < IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x)) ^ invert) {
                             pixel = COLOR_BINARY_MAX;
@@ -193,6 +299,9 @@ void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset
                     IMAGE_PUT_BINARY_PIXEL_FAST(buf_row_ptr, x, pixel);
                 }
 
+                // Must be done before row (y - ksize) is overwritten below.
+                filter_sum_next(img, ksize, y, cols);
+
                 if (y >= ksize) {
                     // Transfer buffer lines...
                     memcpy(IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, (y - ksize)),
@@ -208,42 +317,27 @@ void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset
                        IMAGE_BINARY_LINE_LEN_BYTES(img));
             }
 
-            fb_free();
+            fb_free(); // cols
+            fb_free(); // buf.data
             break;
         }
         case PIXFORMAT_GRAYSCALE: {
             buf.data = fb_alloc(IMAGE_GRAYSCALE_LINE_LEN_BYTES(img) * brows, FB_ALLOC_NO_HINT);
+            uint32_t *cols = filter_sum_alloc(img, ksize);
 
             for (int y = 0, yy = img->h; y < yy; y++) {
-                int pixel, acc = 0;
                 uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
                 uint8_t *buf_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&buf, (y % brows));
+                filter_sum_start(img, ksize, cols, acc);
 
                 for (int x = 0, xx = img->w; x < xx; x++) {
+                    int pixel = (int) ((acc[0] * over32_n) >> 16);
+                    filter_sum_slide(img, ksize, x, 1, cols, acc);
+
                     if (mask && (!image_get_mask_pixel(mask, x, y))) {
                         IMAGE_PUT_GRAYSCALE_PIXEL_FAST(buf_row_ptr, x, IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x));
                         continue; // Short circuit.
                     }
-                    if (!mask && x > ksize && x < img->w - ksize && y >= ksize && y < img->h - ksize) {
-                        for (int j = -ksize; j <= ksize; j++) {
-                            uint8_t *k_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y + j);
-                            acc -= IMAGE_GET_GRAYSCALE_PIXEL_FAST(k_row_ptr, x - ksize - 1);
-                            acc += IMAGE_GET_GRAYSCALE_PIXEL_FAST(k_row_ptr, x + ksize);
-                        }
-                    } else {
-                        acc = 0;
-                        for (int j = -ksize; j <= ksize; j++) {
-                            int y_j = IM_CLAMP(y + j, 0, (img->h - 1));
-                            uint8_t *k_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y_j);
-
-                            for (int k = -ksize; k <= ksize; k++) {
-                                int x_k = IM_CLAMP(x + k, 0, (img->w - 1));
-                                acc += IMAGE_GET_GRAYSCALE_PIXEL_FAST(k_row_ptr, x_k);
-                            }
-                        }
-                    }
-
-                    pixel = (int) ((acc * over32_n) >> 16);
 
                     if (threshold) {
                         if (((pixel - offset) < IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x)) ^ invert) {
@@ -256,6 +350,9 @@ void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset
                     IMAGE_PUT_GRAYSCALE_PIXEL_FAST(buf_row_ptr, x, pixel);
                 }
 
+                // Must be done before row (y - ksize) is overwritten below.
+                filter_sum_next(img, ksize, y, cols);
+
                 if (y >= ksize) {
                     // Transfer buffer lines...
                     memcpy(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, (y - ksize)),
@@ -271,58 +368,30 @@ void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset
                        IMAGE_GRAYSCALE_LINE_LEN_BYTES(img));
             }
 
-            fb_free();
+            fb_free(); // cols
+            fb_free(); // buf.data
             break;
         }
         case PIXFORMAT_RGB565: {
-            int pixel, r, g, b, r_acc, g_acc, b_acc;
             buf.data = fb_alloc(IMAGE_RGB565_LINE_LEN_BYTES(img) * brows, FB_ALLOC_NO_HINT);
+            uint32_t *cols = filter_sum_alloc(img, ksize);
 
             for (int y = 0, yy = img->h; y < yy; y++) {
                 uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
                 uint16_t *buf_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(&buf, (y % brows));
+                filter_sum_start(img, ksize, cols, acc);
 
-                r_acc = g_acc = b_acc = 0;
                 for (int x = 0, xx = img->w; x < xx; x++) {
+                    int r = (int) ((acc[0] * over32_n) >> 16);
+                    int g = (int) ((acc[1] * over32_n) >> 16);
+                    int b = (int) ((acc[2] * over32_n) >> 16);
+                    int pixel = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
+                    filter_sum_slide(img, ksize, x, 3, cols, acc);
+
                     if (mask && (!image_get_mask_pixel(mask, x, y))) {
                         IMAGE_PUT_RGB565_PIXEL_FAST(buf_row_ptr, x, IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
                         continue; // Short circuit.
                     }
-                    if (!mask && x > ksize && x < img->w - ksize && y >= ksize && y < img->h - ksize) {
-                        for (int j = -ksize; j <= ksize; j++) {
-                            uint16_t *k_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y + j);
-                            // subtract last left-most pixel from the sums
-                            pixel = IMAGE_GET_RGB565_PIXEL_FAST(k_row_ptr, x - ksize - 1);
-                            r_acc -= COLOR_RGB565_TO_R5(pixel);
-                            g_acc -= COLOR_RGB565_TO_G6(pixel);
-                            b_acc -= COLOR_RGB565_TO_B5(pixel);
-                            // add new right edge pixel to the sums
-                            pixel = IMAGE_GET_RGB565_PIXEL_FAST(k_row_ptr, x + ksize);
-                            r_acc += COLOR_RGB565_TO_R5(pixel);
-                            g_acc += COLOR_RGB565_TO_G6(pixel);
-                            b_acc += COLOR_RGB565_TO_B5(pixel);
-                        }
-                    } else {
-                        // check bounds and do full sum calculations
-                        r_acc = g_acc = b_acc = 0;
-                        for (int j = -ksize; j <= ksize; j++) {
-                            int y_j = IM_CLAMP(y + j, 0, (img->h - 1));
-                            uint16_t *k_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y_j);
-
-                            for (int k = -ksize; k <= ksize; k++) {
-                                int x_k = IM_CLAMP(x + k, 0, (img->w - 1));
-                                pixel = IMAGE_GET_RGB565_PIXEL_FAST(k_row_ptr, x_k);
-                                r_acc += COLOR_RGB565_TO_R5(pixel);
-                                g_acc += COLOR_RGB565_TO_G6(pixel);
-                                b_acc += COLOR_RGB565_TO_B5(pixel);
-                            }
-                        }
-                    }
-                    int pixel;
-                    r = (int) ((r_acc * over32_n) >> 16);
-                    g = (int) ((g_acc * over32_n) >> 16);
-                    b = (int) ((b_acc * over32_n) >> 16);
-                    pixel = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
 
                     if (threshold) {
                         if (((COLOR_RGB565_TO_Y(pixel) - offset) <
@@ -336,6 +405,9 @@ void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset
                     IMAGE_PUT_RGB565_PIXEL_FAST(buf_row_ptr, x, pixel);
                 }
 
+                // Must be done before row (y - ksize) is overwritten below.
+                filter_sum_next(img, ksize, y, cols);
+
                 if (y >= ksize) {
                     // Transfer buffer lines...
                     memcpy(IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, (y - ksize)),
@@ -351,7 +423,8 @@ void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset
                        IMAGE_RGB565_LINE_LEN_BYTES(img));
             }
 
-            fb_free();
+            fb_free(); // cols
+            fb_free(); // buf.data
             break;
         }
         default: {
@@ -362,6 +435,102 @@ void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset
 #endif // IMLIB_ENABLE_MEAN
 
 #ifdef IMLIB_ENABLE_MEDIAN
+// Sliding window histograms. Each image column has a histogram of its window rows, and
+// the window histogram is the sum of the window column histograms. The bins are packed
+// into words using the smallest bin size that can hold n, which allows sliding the window
+// a column by adding and subtracting whole words (bins never go negative or above n).
+typedef struct filter_hist {
+    int size; // bytes per bin
+    int words; // words per histogram
+    uint32_t *cols;
+    uint32_t *kernel;
+} filter_hist_t;
+
+static inline void filter_hist_bin(filter_hist_t *h, uint32_t *hist, int bin, bool add) {
+    int inc = add ? 1 : -1;
+    switch (h->size) {
+        case 1: {
+            ((uint8_t *) hist)[bin] += inc;
+            break;
+        }
+        case 2: {
+            ((uint16_t *) hist)[bin] += inc;
+            break;
+        }
+        default: {
+            hist[bin] += inc;
+            break;
+        }
+    }
+}
+
+// Adds (or removes) row y to the column histograms.
+static void filter_hist_row(filter_hist_t *h, image_t *img, int y, bool add) {
+    uint32_t *hist = h->cols;
+    switch (img->pixfmt) {
+        case PIXFORMAT_GRAYSCALE: {
+            uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+            for (int x = 0, xx = img->w; x < xx; x++, hist += h->words) {
+                filter_hist_bin(h, hist, IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x) >> 2, add);
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+            for (int x = 0, xx = img->w; x < xx; x++, hist += h->words) {
+                int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
+                filter_hist_bin(h, hist, COLOR_RGB565_TO_R5(pixel), add);
+                filter_hist_bin(h, hist, COLOR_RGB565_TO_G6(pixel) + 32, add);
+                filter_hist_bin(h, hist, COLOR_RGB565_TO_B5(pixel) + 96, add);
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+// Sets up the column histograms for row 0.
+static void filter_hist_alloc(filter_hist_t *h, image_t *img, const int ksize, int bins) {
+    int n = ((ksize * 2) + 1) * ((ksize * 2) + 1);
+    h->size = (n <= UINT8_MAX) ? 1 : ((n <= UINT16_MAX) ? 2 : 4);
+    h->words = (bins * h->size) / sizeof(uint32_t);
+    h->cols = fb_alloc0(img->w * h->words * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    h->kernel = fb_alloc(h->words * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    for (int j = -ksize; j <= ksize; j++) {
+        filter_hist_row(h, img, IM_CLAMP(j, 0, (img->h - 1)), true);
+    }
+}
+
+// Moves the column histograms from row y to row y + 1.
+static void filter_hist_next(filter_hist_t *h, image_t *img, const int ksize, int y) {
+    if ((y + 1) < img->h) {
+        filter_hist_row(h, img, IM_MAX(y - ksize, 0), false);
+        filter_hist_row(h, img, IM_MIN(y + ksize + 1, img->h - 1), true);
+    }
+}
+
+// Window histogram of the first pixel of a row.
+static void filter_hist_start(filter_hist_t *h, image_t *img, const int ksize) {
+    memset(h->kernel, 0, h->words * sizeof(uint32_t));
+    for (int k = -ksize; k <= ksize; k++) {
+        uint32_t *col = h->cols + (IM_CLAMP(k, 0, (img->w - 1)) * h->words);
+        for (int i = 0; i < h->words; i++) {
+            h->kernel[i] += col[i];
+        }
+    }
+}
+
+// Slides the window histogram from pixel x to pixel x + 1.
+static inline void filter_hist_slide(filter_hist_t *h, image_t *img, const int ksize, int x) {
+    uint32_t *col_add = h->cols + (IM_MIN(x + ksize + 1, img->w - 1) * h->words);
+    uint32_t *col_sub = h->cols + (IM_MAX(x - ksize, 0) * h->words);
+    for (int i = 0; i < h->words; i++) {
+        h->kernel[i] += col_add[i] - col_sub[i];
+    }
+}
+
 static uint8_t hist_median(uint8_t *data, int len, const int cutoff) {
     int i;
 #if defined(ARM_MATH_DSP)
@@ -388,6 +557,30 @@ static uint8_t hist_median(uint8_t *data, int len, const int cutoff) {
     return i - 1;
 } /* hist_median() */
 
+// Returns the first bin in [start, start + len) where the window count reaches cutoff.
+static uint8_t filter_hist_median(filter_hist_t *h, int start, int len, const int cutoff) {
+    int i = start, sum = 0;
+    switch (h->size) {
+        case 1: {
+            return hist_median(((uint8_t *) h->kernel) + start, len, cutoff);
+        }
+        case 2: {
+            uint16_t *data = (uint16_t *) h->kernel;
+            for (; i < (start + len) && sum < cutoff; i++) {
+                sum += data[i];
+            }
+            break;
+        }
+        default: {
+            for (; i < (start + len) && sum < cutoff; i++) {
+                sum += h->kernel[i];
+            }
+            break;
+        }
+    }
+    return i - start - 1;
+}
+
 void imlib_median_filter(image_t *img, const int ksize, float percentile, bool threshold, int offset, bool invert,
                          image_t *mask) {
     int brows = ksize + 1;
@@ -398,40 +591,30 @@ void imlib_median_filter(image_t *img, const int ksize, float percentile, bool t
 
     const int n = ((ksize * 2) + 1) * ((ksize * 2) + 1);
     const int median_cutoff = fast_floorf(percentile * (float) n);
+    // The 0th percentile is the first non-empty bin.
+    const int hist_cutoff = IM_MAX(median_cutoff, 1);
+    filter_hist_t h;
 
     switch (img->pixfmt) {
         case PIXFORMAT_BINARY: {
             buf.data = fb_alloc(IMAGE_BINARY_LINE_LEN_BYTES(img) * brows, FB_ALLOC_NO_HINT);
-            int sum = 0;
+            uint32_t *cols = filter_sum_alloc(img, ksize);
+            uint32_t sum;
 
             for (int y = 0, yy = img->h; y < yy; y++) {
                 uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
                 uint32_t *buf_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&buf, (y % brows));
+                filter_sum_start(img, ksize, cols, &sum);
 
                 for (int x = 0, xx = img->w; x < xx; x++) {
+                    // The binary histogram only has 2 bins, the window count of ones is enough.
+                    int pixel = (sum >= median_cutoff);
+                    filter_sum_slide(img, ksize, x, 1, cols, &sum);
+
                     if (mask && (!image_get_mask_pixel(mask, x, y))) {
                         IMAGE_PUT_BINARY_PIXEL_FAST(buf_row_ptr, x, IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x));
                         continue; // Short circuit.
                     }
-                    if (!mask && x > ksize && x < img->w - ksize && y >= ksize && y < img->h - ksize) {
-                        for (int j = -ksize; j <= ksize; j++) {
-                            uint32_t *k_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y + j);
-                            sum -= IMAGE_GET_BINARY_PIXEL_FAST(k_row_ptr, x - ksize - 1);
-                            sum += IMAGE_GET_BINARY_PIXEL_FAST(k_row_ptr, x + ksize);
-                        }
-                    } else {
-                        sum = 0;
-                        for (int j = -ksize; j <= ksize; j++) {
-                            int y_j = IM_CLAMP(y + j, 0, (img->h - 1));
-                            uint32_t *k_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y_j);
-
-                            for (int k = -ksize; k <= ksize; k++) {
-                                int x_k = IM_CLAMP(x + k, 0, (img->w - 1));
-                                sum += IMAGE_GET_BINARY_PIXEL_FAST(k_row_ptr, x_k);
-                            }
-                        }
-                    }
-                    int pixel = (sum >= median_cutoff);
 
                     if (threshold) {
                         if (((pixel - offset) < IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x)) ^ invert) {
@@ -444,6 +627,9 @@ void imlib_median_filter(image_t *img, const int ksize, float percentile, bool t
                     IMAGE_PUT_BINARY_PIXEL_FAST(buf_row_ptr, x, pixel);
                 }
 
+                // Must be done before row (y - ksize) is overwritten below.
+                filter_sum_next(img, ksize, y, cols);
+
                 if (y >= ksize) {
                     // Transfer buffer lines...
                     memcpy(IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, (y - ksize)),
@@ -459,49 +645,30 @@ void imlib_median_filter(image_t *img, const int ksize, float percentile, bool t
                        IMAGE_BINARY_LINE_LEN_BYTES(img));
             }
 
-            fb_free();
+            fb_free(); // cols
+            fb_free(); // buf.data
             break;
         }
         case PIXFORMAT_GRAYSCALE: {
             buf.data = fb_alloc(IMAGE_GRAYSCALE_LINE_LEN_BYTES(img) * brows, FB_ALLOC_NO_HINT);
-            uint8_t *data = fb_alloc(64, FB_ALLOC_NO_HINT);
-            uint8_t pixel;
+            filter_hist_alloc(&h, img, ksize, 64);
+
             for (int y = 0, yy = img->h; y < yy; y++) {
                 uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
                 uint8_t *buf_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&buf, (y % brows));
+                filter_hist_start(&h, img, ksize);
 
                 for (int x = 0, xx = img->w; x < xx; x++) {
                     if (mask && (!image_get_mask_pixel(mask, x, y))) {
                         IMAGE_PUT_GRAYSCALE_PIXEL_FAST(buf_row_ptr, x, IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x));
+                        filter_hist_slide(&h, img, ksize, x);
                         continue; // Short circuit.
                     }
 
-                    if (!mask && x > ksize && x < img->w - ksize && y >= ksize && y < img->h - ksize) {
-                        // update histogram edges
-                        for (int j = -ksize; j <= ksize; j++) {
-                            uint8_t *k_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y + j);
-                            pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(k_row_ptr, x - ksize - 1);
-                            data[pixel >> 2]--; // remove old pixels
-                            pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(k_row_ptr, x + ksize);
-                            data[pixel >> 2]++; // add new pixels
-                        } // for j
-                    } else {
-                        // slow way
-                        memset(data, 0, 64);
-                        for (int j = -ksize; j <= ksize; j++) {
-                            int y_j = IM_CLAMP(y + j, 0, (img->h - 1));
-                            uint8_t *k_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y_j);
-
-                            for (int k = -ksize; k <= ksize; k++) {
-                                int x_k = IM_CLAMP(x + k, 0, (img->w - 1));
-                                pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(k_row_ptr, x_k);
-                                data[pixel >> 2]++;
-                            }
-                        }
-                    }
-
-                    pixel = hist_median(data, 64, median_cutoff); // find the median
+                    int pixel = filter_hist_median(&h, 0, 64, hist_cutoff); // find the median
                     pixel <<= 2; // scale it back up
+                    filter_hist_slide(&h, img, ksize, x);
+
                     if (threshold) {
                         if (((pixel - offset) < IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x)) ^ invert) {
                             pixel = COLOR_GRAYSCALE_BINARY_MAX;
@@ -513,6 +680,9 @@ void imlib_median_filter(image_t *img, const int ksize, float percentile, bool t
                     IMAGE_PUT_GRAYSCALE_PIXEL_FAST(buf_row_ptr, x, pixel);
                 }
 
+                // Must be done before row (y - ksize) is overwritten below.
+                filter_hist_next(&h, img, ksize, y);
+
                 if (y >= ksize) {
                     // Transfer buffer lines...
                     memcpy(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, (y - ksize)),
@@ -528,61 +698,33 @@ void imlib_median_filter(image_t *img, const int ksize, float percentile, bool t
                        IMAGE_GRAYSCALE_LINE_LEN_BYTES(img));
             }
 
-            fb_free();
-            fb_free();
+            fb_free(); // h.kernel
+            fb_free(); // h.cols
+            fb_free(); // buf.data
             break;
         }
         case PIXFORMAT_RGB565: {
             buf.data = fb_alloc(IMAGE_RGB565_LINE_LEN_BYTES(img) * brows, FB_ALLOC_NO_HINT);
-            uint8_t *r_data = fb_alloc(32, FB_ALLOC_NO_HINT);
-            uint8_t *g_data = fb_alloc(64, FB_ALLOC_NO_HINT);
-            uint8_t *b_data = fb_alloc(32, FB_ALLOC_NO_HINT);
-            uint8_t r, g, b;
+            // R5 bins are [0, 32), G6 bins are [32, 96) and B5 bins are [96, 128).
+            filter_hist_alloc(&h, img, ksize, 128);
+
             for (int y = 0, yy = img->h; y < yy; y++) {
                 uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
                 uint16_t *buf_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(&buf, (y % brows));
+                filter_hist_start(&h, img, ksize);
 
                 for (int x = 0, xx = img->w; x < xx; x++) {
                     if (mask && (!image_get_mask_pixel(mask, x, y))) {
                         IMAGE_PUT_RGB565_PIXEL_FAST(buf_row_ptr, x, IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
+                        filter_hist_slide(&h, img, ksize, x);
                         continue; // Short circuit.
                     }
 
-
-                    if (!mask && x > ksize && x < img->w - ksize && y >= ksize && y < img->h - ksize) {
-                        for (int j = -ksize; j <= ksize; j++) {
-                            uint16_t *k_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y + j);
-                            int pixel = IMAGE_GET_RGB565_PIXEL_FAST(k_row_ptr, x - ksize - 1);
-                            r_data[COLOR_RGB565_TO_R5(pixel)]--; // remove left pixel
-                            g_data[COLOR_RGB565_TO_G6(pixel)]--;
-                            b_data[COLOR_RGB565_TO_B5(pixel)]--;
-                            pixel = IMAGE_GET_RGB565_PIXEL_FAST(k_row_ptr, x + ksize);
-                            r_data[COLOR_RGB565_TO_R5(pixel)]++; // add right pixel
-                            g_data[COLOR_RGB565_TO_G6(pixel)]++;
-                            b_data[COLOR_RGB565_TO_B5(pixel)]++;
-                        }
-                    } else {
-                        // need to check bounds
-                        memset(r_data, 0, 32); memset(g_data, 0, 64); memset(b_data, 0, 32);
-                        for (int j = -ksize; j <= ksize; j++) {
-                            int y_j = IM_CLAMP(y + j, 0, (img->h - 1));
-                            uint16_t *k_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y_j);
-
-                            for (int k = -ksize; k <= ksize; k++) {
-                                int x_k = IM_CLAMP(x + k, 0, (img->w - 1));
-                                int pixel = IMAGE_GET_RGB565_PIXEL_FAST(k_row_ptr, x_k);
-                                r_data[COLOR_RGB565_TO_R5(pixel)]++;
-                                g_data[COLOR_RGB565_TO_G6(pixel)]++;
-                                b_data[COLOR_RGB565_TO_B5(pixel)]++;
-                            }
-                        }
-                    }
-
-                    r = hist_median(r_data, 32, median_cutoff);
-                    g = hist_median(g_data, 64, median_cutoff);
-                    b = hist_median(b_data, 32, median_cutoff);
-
+                    int r = filter_hist_median(&h, 0, 32, hist_cutoff);
+                    int g = filter_hist_median(&h, 32, 64, hist_cutoff);
+                    int b = filter_hist_median(&h, 96, 32, hist_cutoff);
                     int pixel = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
+                    filter_hist_slide(&h, img, ksize, x);
 
                     if (threshold) {
                         if (((COLOR_RGB565_TO_Y(pixel) - offset) <
@@ -596,6 +738,9 @@ void imlib_median_filter(image_t *img, const int ksize, float percentile, bool t
                     IMAGE_PUT_RGB565_PIXEL_FAST(buf_row_ptr, x, pixel);
                 }
 
+                // Must be done before row (y - ksize) is overwritten below.
+                filter_hist_next(&h, img, ksize, y);
+
                 if (y >= ksize) {
                     // Transfer buffer lines...
                     memcpy(IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, (y - ksize)),
@@ -611,10 +756,9 @@ void imlib_median_filter(image_t *img, const int ksize, float percentile, bool t
                        IMAGE_RGB565_LINE_LEN_BYTES(img));
             }
 
-            fb_free();
-            fb_free();
-            fb_free();
-            fb_free();
+            fb_free(); // h.kernel
+            fb_free(); // h.cols
+            fb_free(); // buf.data
             break;
         }
         default: {
@@ -709,7 +853,6 @@ void imlib_mode_filter(image_t *img, const int ksize, bool threshold, int offset
                        IMAGE_BINARY_LINE_LEN_BYTES(img));
             }
 
-            fb_free();
             fb_free();
             break;
         }
@@ -1066,7 +1209,8 @@ void imlib_midpoint_filter(image_t *img, const int ksize, float bias, bool thres
                                 int pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(k_row_ptr, x + k);
                                 if (pixel < min) {
                                     min = pixel;
-                                } else if (pixel > max) {
+                                }
+                                if (pixel > max) {
                                     max = pixel;
                                 }
                             }
@@ -1081,7 +1225,8 @@ void imlib_midpoint_filter(image_t *img, const int ksize, float bias, bool thres
                                 int pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(k_row_ptr, x_k);
                                 if (pixel < min) {
                                     min = pixel;
-                                } else if (pixel > max) {
+                                }
+                                if (pixel > max) {
                                     max = pixel;
                                 }
                             }
@@ -1145,17 +1290,20 @@ void imlib_midpoint_filter(image_t *img, const int ksize, float bias, bool thres
                                 int b_pixel = COLOR_RGB565_TO_B5(pixel);
                                 if (r_pixel < r_min) {
                                     r_min = r_pixel;
-                                } else if (r_pixel > r_max) {
+                                }
+                                if (r_pixel > r_max) {
                                     r_max = r_pixel;
                                 }
                                 if (g_pixel < g_min) {
                                     g_min = g_pixel;
-                                } else if (g_pixel > g_max) {
+                                }
+                                if (g_pixel > g_max) {
                                     g_max = g_pixel;
                                 }
                                 if (b_pixel < b_min) {
                                     b_min = b_pixel;
-                                } else if (b_pixel > b_max) {
+                                }
+                                if (b_pixel > b_max) {
                                     b_max = b_pixel;
                                 }
                             }
@@ -1173,17 +1321,20 @@ void imlib_midpoint_filter(image_t *img, const int ksize, float bias, bool thres
                                 int b_pixel = COLOR_RGB565_TO_B5(pixel);
                                 if (r_pixel < r_min) {
                                     r_min = r_pixel;
-                                } else if (r_pixel > r_max) {
+                                }
+                                if (r_pixel > r_max) {
                                     r_max = r_pixel;
                                 }
                                 if (g_pixel < g_min) {
                                     g_min = g_pixel;
-                                } else if (g_pixel > g_max) {
+                                }
+                                if (g_pixel > g_max) {
                                     g_max = g_pixel;
                                 }
                                 if (b_pixel < b_min) {
                                     b_min = b_pixel;
-                                } else if (b_pixel > b_max) {
+                                }
+                                if (b_pixel > b_max) {
                                     b_max = b_pixel;
                                 }
                             }
@@ -1233,6 +1384,127 @@ void imlib_midpoint_filter(image_t *img, const int ksize, float bias, bool thres
 }
 #endif // IMLIB_ENABLE_MIDPOINT
 
+//
+// Larger kernels are computed the way the CMSIS-NN int8 convolutions are. Each source row
+// is widened once to 16-bit samples per channel, with the edge pixels repeated ksize times
+// on both sides, and each kernel row is then a dot product of sample pairs and weight pairs
+// using SMLAD. The last n rows are kept, so every output pixel (borders included) runs the
+// same loop.
+//
+#if defined(ARM_MATH_DSP)
+typedef struct filter_morph {
+    int ksize;
+    int n;              // Kernel width.
+    int stride;         // Widened row length.
+    int channels;
+    uint32_t *krn;      // Per kernel row: n / 2 weight pairs followed by the last weight.
+    int16_t *rows;      // n slots of channels widened rows.
+    int16_t **lines;    // Widened kernel rows of the current output row, per channel.
+} filter_morph_t;
+
+// Returns false if the weights don't fit in 16-bits or there's not enough memory.
+static bool filter_morph_alloc(filter_morph_t *fm, image_t *img, const int ksize, const int *krn) {
+    int n = (ksize * 2) + 1, pairs = n / 2;
+
+    for (int i = 0; i < (n * n); i++) {
+        if ((krn[i] < INT16_MIN) || (krn[i] > INT16_MAX)) {
+            return false;
+        }
+    }
+
+    fm->ksize = ksize;
+    fm->n = n;
+    fm->stride = img->w + (ksize * 2);
+    fm->channels = (img->pixfmt == PIXFORMAT_RGB565) ? 3 : 1;
+
+    // One allocation so that the caller frees it with the line buffer.
+    size_t krn_size = n * (pairs + 1) * sizeof(uint32_t);
+    size_t lines_size = n * fm->channels * sizeof(int16_t *);
+    size_t rows_size = n * fm->channels * fm->stride * sizeof(int16_t);
+
+    // Fall back to the generic loop instead of running out of memory.
+    if (fb_avail() < (krn_size + lines_size + rows_size + sizeof(uint32_t))) {
+        return false;
+    }
+
+    uint8_t *data = fb_alloc(krn_size + lines_size + rows_size, FB_ALLOC_NO_HINT);
+    fm->krn = (uint32_t *) data;
+    fm->lines = (int16_t **) (data + krn_size);
+    fm->rows = (int16_t *) (data + krn_size + lines_size);
+
+    for (int j = 0, ptr = 0; j < n; j++, ptr += n) {
+        uint32_t *krn_row = fm->krn + (j * (pairs + 1));
+        for (int i = 0; i < pairs; i++) {
+            krn_row[i] = __PKHBT(krn[ptr + (i * 2)], krn[ptr + (i * 2) + 1], 16);
+        }
+        krn_row[pairs] = krn[ptr + n - 1];
+    }
+
+    return true;
+}
+
+// Widens source row r (clamped to the image) into its slot.
+static void filter_morph_widen(filter_morph_t *fm, image_t *img, int r) {
+    int16_t *dst = fm->rows + (((r + fm->ksize) % fm->n) * fm->channels * fm->stride);
+    int y = IM_CLAMP(r, 0, (img->h - 1)), ksize = fm->ksize, w = img->w;
+
+    switch (img->pixfmt) {
+        case PIXFORMAT_GRAYSCALE: {
+            uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+            for (int x = -ksize; x < (w + ksize); x++) {
+                dst[x + ksize] = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, IM_CLAMP(x, 0, (w - 1)));
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+            int16_t *r_dst = dst, *g_dst = dst + fm->stride, *b_dst = dst + (fm->stride * 2);
+            for (int x = -ksize; x < (w + ksize); x++) {
+                int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, IM_CLAMP(x, 0, (w - 1)));
+                r_dst[x + ksize] = COLOR_RGB565_TO_R5(pixel);
+                g_dst[x + ksize] = COLOR_RGB565_TO_G6(pixel);
+                b_dst[x + ksize] = COLOR_RGB565_TO_B5(pixel);
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+// Widens the rows entering the window of output row y.
+static void filter_morph_next(filter_morph_t *fm, image_t *img, int y) {
+    for (int r = y ? (y + fm->ksize) : -fm->ksize; r <= (y + fm->ksize); r++) {
+        filter_morph_widen(fm, img, r);
+    }
+
+    for (int j = 0; j < fm->n; j++) {
+        int16_t *slot = fm->rows + (((y + j) % fm->n) * fm->channels * fm->stride);
+        for (int c = 0; c < fm->channels; c++) {
+            fm->lines[(c * fm->n) + j] = slot + (c * fm->stride);
+        }
+    }
+}
+
+// Kernel sum of channel c at pixel x of the current output row.
+static inline int32_t filter_morph_dot(filter_morph_t *fm, int c, int x) {
+    int16_t **lines = fm->lines + (c * fm->n);
+    const uint32_t *krn = fm->krn;
+    int32_t acc = 0;
+
+    for (int j = 0; j < fm->n; j++) {
+        const int16_t *p = lines[j] + x;
+        for (int i = 0, ii = fm->n / 2; i < ii; i++, p += 2) {
+            acc = __SMLAD(*((uint32_t *) p), *krn++, acc);
+        }
+        acc += *p * ((int32_t) *krn++);
+    }
+
+    return acc;
+}
+#endif // defined(ARM_MATH_DSP)
+
 // http://www.fmwconcepts.com/imagemagick/digital_image_filtering.pdf
 
 void imlib_morph(image_t *img,
@@ -1323,6 +1595,8 @@ void imlib_morph(image_t *img,
             buf.data = fb_alloc(IMAGE_GRAYSCALE_LINE_LEN_BYTES(img) * brows, FB_ALLOC_NO_HINT);
 
             #if defined(ARM_MATH_DSP)
+            filter_morph_t fm;
+            bool fm_simd = (ksize > 1) && (!mask) && filter_morph_alloc(&fm, img, ksize, krn);
             int32_t krn_4, krn_2_0, krn_5_3, krn_8_6, krn_7_1, offset_int, invert_ge, invert_lt;
             if (ksize == 1) {
                 krn_4 = krn[4];
@@ -1436,6 +1710,21 @@ void imlib_morph(image_t *img,
                             IMAGE_PUT_GRAYSCALE_PIXEL_FAST(buf_row_ptr, x + 1, p1_p0 >> 16);
                         }
                     }
+                } else if (fm_simd) {
+                    filter_morph_next(&fm, img, y);
+
+                    for (int x = 0; x < img->w; x++) {
+                        int32_t tmp = (filter_morph_dot(&fm, 0, x) * m_int) + b_int;
+                        int pixel = __USAT_ASR(tmp, 8, 16);
+
+                        if (threshold) {
+                            pixel -= offset;
+                            pixel = pixel < IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
+                            pixel = (pixel ^ invert) * COLOR_GRAYSCALE_BINARY_MAX;
+                        }
+
+                        IMAGE_PUT_GRAYSCALE_PIXEL_FAST(buf_row_ptr, x, pixel);
+                    }
                 #endif
                 } else {
                     for (int x = 0; x < img->w; x++) {
@@ -1494,6 +1783,12 @@ void imlib_morph(image_t *img,
                        IMAGE_GRAYSCALE_LINE_LEN_BYTES(img));
             }
 
+            #if defined(ARM_MATH_DSP)
+            if (fm_simd) {
+                fb_free();
+            }
+            #endif
+
             fb_free();
             break;
         }
@@ -1501,6 +1796,8 @@ void imlib_morph(image_t *img,
             buf.data = fb_alloc(IMAGE_RGB565_LINE_LEN_BYTES(img) * brows, FB_ALLOC_NO_HINT);
 
             #if defined(ARM_MATH_DSP)
+            filter_morph_t fm;
+            bool fm_simd = (!mask) && filter_morph_alloc(&fm, img, ksize, krn);
             int32_t krn_5, krn_1_0, krn_4_3, krn_7_6, krn_8_2, offset_int, invert_ge, invert_lt;
             if (ksize == 1) {
                 krn_5 = krn[5];
@@ -1671,6 +1968,29 @@ void imlib_morph(image_t *img,
                             *((uint32_t *) (buf_row_ptr + x)) = p1_p0;
                         }
                     }
+                } else if (fm_simd) {
+                    filter_morph_next(&fm, img, y);
+
+                    for (int x = 0; x < img->w; x++) {
+                        int32_t r_tmp = (filter_morph_dot(&fm, 0, x) * m_int) + b_int;
+                        int r_pixel = __USAT_ASR(r_tmp, 5, 16);
+
+                        int32_t g_tmp = (filter_morph_dot(&fm, 1, x) * m_int) + b_int;
+                        int g_pixel = __USAT_ASR(g_tmp, 6, 16);
+
+                        int32_t b_tmp = (filter_morph_dot(&fm, 2, x) * m_int) + b_int;
+                        int b_pixel = __USAT_ASR(b_tmp, 5, 16);
+
+                        int pixel = COLOR_R5_G6_B5_TO_RGB565(r_pixel, g_pixel, b_pixel);
+
+                        if (threshold) {
+                            pixel = COLOR_RGB565_TO_Y(pixel) - offset;
+                            pixel = pixel < COLOR_RGB565_TO_Y(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
+                            pixel = (pixel ^ invert) * COLOR_RGB565_BINARY_MAX;
+                        }
+
+                        IMAGE_PUT_RGB565_PIXEL_FAST(buf_row_ptr, x, pixel);
+                    }
                 #endif
                 } else {
                     for (int x = 0; x < img->w; x++) {
@@ -1743,6 +2063,12 @@ void imlib_morph(image_t *img,
                        IMAGE_RGB565_LINE_LEN_BYTES(img));
             }
 
+            #if defined(ARM_MATH_DSP)
+            if (fm_simd) {
+                fb_free();
+            }
+            #endif
+
             fb_free();
             break;
         }
@@ -1752,6 +2078,140 @@ void imlib_morph(image_t *img,
     }
 }
 
+#ifdef IMLIB_ENABLE_GAUSSIAN
+// The largest ksize whose kernel sum (2^(ksize * 4)) times 255 fits in 32-bits.
+#define GAUSSIAN_BINOMIAL_MAX   (6)
+
+//
+// The binomial kernel of width n is n - 1 convolutions of [1, 1]. So, each pass of the
+// separable blur is n - 1 adds of neighboring values per pixel. Rows are blurred in place
+// (in a padded copy of the row) and the columns are blurred by a cascade of n - 1 running
+// sums, each keeping its previous row. The output is k rows behind the input, so the
+// image can be overwritten as it's read. Sums are exact, then scaled down once.
+//
+static void gaussian_row(image_t *img, int y, const int ksize, int channels, uint32_t *row) {
+    int w = img->w, stride = w + (ksize * 2);
+    y = IM_CLAMP(y, 0, (img->h - 1));
+
+    switch (img->pixfmt) {
+        case PIXFORMAT_GRAYSCALE: {
+            uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+            for (int x = -ksize; x < (w + ksize); x++) {
+                row[x + ksize] = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, IM_CLAMP(x, 0, (w - 1)));
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+            for (int x = -ksize; x < (w + ksize); x++) {
+                int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, IM_CLAMP(x, 0, (w - 1)));
+                row[x + ksize] = COLOR_RGB565_TO_R5(pixel);
+                row[stride + x + ksize] = COLOR_RGB565_TO_G6(pixel);
+                row[(stride * 2) + x + ksize] = COLOR_RGB565_TO_B5(pixel);
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+
+    for (int c = 0; c < channels; c++) {
+        uint32_t *ptr = row + (c * stride);
+        for (int i = 1; i <= (ksize * 2); i++) {
+            for (int x = 0, xx = stride - i; x < xx; x++) {
+                ptr[x] += ptr[x + 1];
+            }
+        }
+    }
+}
+
+void imlib_gaussian_filter(image_t *img, const int ksize, bool threshold, int offset, bool invert) {
+    if (ksize > GAUSSIAN_BINOMIAL_MAX) {
+        #ifdef IMLIB_ENABLE_MEAN
+        // Three stacked box filters with the same variance as the binomial kernel (ksize / 2).
+        // The threshold is applied by the last box filter.
+        int r = fast_roundf((fast_sqrtf((ksize * 2) + 1) - 1) / 2);
+        imlib_mean_filter(img, r, false, 0, false, NULL);
+        imlib_mean_filter(img, r, false, 0, false, NULL);
+        imlib_mean_filter(img, r, threshold, offset, invert, NULL);
+        #endif
+        return;
+    }
+
+    int channels = (img->pixfmt == PIXFORMAT_RGB565) ? 3 : 1;
+    int w = img->w, stride = w + (ksize * 2), stages = ksize * 2, shift = ksize * 4;
+    uint32_t *row = fb_alloc(stride * channels * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    // The previous row of each running sum.
+    uint32_t *prev = fb_alloc0(IM_MAX(stages, 1) * channels * w * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    invert = invert ? 1 : 0; // ensure binary
+
+    // Input row m is source row m - ksize and output row m - (ksize * 2).
+    for (int m = 0, mm = img->h + stages; m < mm; m++) {
+        gaussian_row(img, m - ksize, ksize, channels, row);
+
+        for (int c = 0; c < channels; c++) {
+            uint32_t *cur = row + (c * stride);
+            for (int i = 0; i < stages; i++) {
+                uint32_t *p = prev + (((i * channels) + c) * w);
+                for (int x = 0; x < w; x++) {
+                    uint32_t sum = cur[x] + p[x];
+                    p[x] = cur[x];
+                    cur[x] = sum;
+                }
+            }
+        }
+
+        int y = m - stages;
+
+        if (y < 0) {
+            continue;
+        }
+
+        switch (img->pixfmt) {
+            case PIXFORMAT_GRAYSCALE: {
+                uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+                for (int x = 0; x < w; x++) {
+                    int pixel = row[x] >> shift;
+
+                    if (threshold) {
+                        pixel -= offset;
+                        pixel = pixel < IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
+                        pixel = (pixel ^ invert) * COLOR_GRAYSCALE_BINARY_MAX;
+                    }
+
+                    IMAGE_PUT_GRAYSCALE_PIXEL_FAST(row_ptr, x, pixel);
+                }
+                break;
+            }
+            case PIXFORMAT_RGB565: {
+                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+                for (int x = 0; x < w; x++) {
+                    int pixel = COLOR_R5_G6_B5_TO_RGB565(row[x] >> shift,
+                                                         row[stride + x] >> shift,
+                                                         row[(stride * 2) + x] >> shift);
+
+                    if (threshold) {
+                        pixel = COLOR_RGB565_TO_Y(pixel) - offset;
+                        pixel = pixel < COLOR_RGB565_TO_Y(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
+                        pixel = (pixel ^ invert) * COLOR_RGB565_BINARY_MAX;
+                    }
+
+                    IMAGE_PUT_RGB565_PIXEL_FAST(row_ptr, x, pixel);
+                }
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+
+    fb_free();
+    fb_free();
+}
+#endif // IMLIB_ENABLE_GAUSSIAN
+
 #ifdef IMLIB_ENABLE_BILATERAL
 static float gaussian(float x, float sigma) {
     return fast_expf((x * x) / (-2.0f * sigma * sigma)) / (fabsf(sigma) * 2.506628f); // sqrt(2 * PI)
@@ -2077,4 +2537,167 @@ void imlib_bilateral_filter(image_t *img,
         }
     }
 }
+//
+// Bilateral grid approximation (Paris and Durand). Pixels are accumulated into the nearest
+// cell of a coarse (x, y, intensity) grid, the grid is blurred with [1, 2, 1] along each
+// axis and every pixel is then read back by trilinear interpolation of the grid at its
+// position and intensity. The cost per pixel doesn't depend on the kernel size, so it only
+// pays off for larger kernels. RGB565 images use the luminance as the intensity and blur
+// the color channels.
+//
+#define BILATERAL_GRID_FRAC     (8)
+
+// Blurs len cells that are stride int32s apart with [1, 2, 1], cells outside are 0.
+static void bilateral_grid_blur_line(int32_t *ptr, int len, int stride, int channels) {
+    for (int c = 0; c < channels; c++) {
+        int32_t prev = 0, *p = ptr + c;
+        for (int i = 0; i < len; i++, p += stride) {
+            int32_t cur = *p;
+            *p = prev + (cur * 2) + ((i < (len - 1)) ? p[stride] : 0);
+            prev = cur;
+        }
+    }
+}
+
+void imlib_bilateral_grid(image_t *img,
+                          const int ksize,
+                          float color_sigma,
+                          float space_sigma,
+                          bool threshold,
+                          int offset,
+                          bool invert) {
+    int channels = (img->pixfmt == PIXFORMAT_RGB565) ? 4 : 2; // values and weight
+    // Cell sizes, the window of the exact filter limits the spatial sigma.
+    int ss = IM_MAX(fast_roundf(IM_MIN(space_sigma * distance(ksize, ksize), ksize)), 1);
+    int sr = IM_MAX(fast_roundf(color_sigma * COLOR_GRAYSCALE_MAX), 1);
+    int gw, gh, gd = (COLOR_GRAYSCALE_MAX / sr) + 3;
+    size_t size;
+
+    // Coarsen the grid until it fits, with 1 cell of padding on each side.
+    for (;; ss++) {
+        gw = ((img->w - 1) / ss) + 3;
+        gh = ((img->h - 1) / ss) + 3;
+        size = gw * gh * gd * channels * sizeof(int32_t);
+
+        if ((size + sizeof(uint32_t)) <= fb_avail()) {
+            break;
+        }
+
+        if ((gw <= 3) && (gh <= 3)) {
+            fb_alloc_fail();
+        }
+    }
+
+    int32_t *grid = fb_alloc0(size, FB_ALLOC_NO_HINT);
+    int z_stride = channels, x_stride = gd * channels, y_stride = gw * gd * channels;
+
+    // Splat
+    for (int y = 0; y < img->h; y++) {
+        int32_t *grid_row = grid + ((((y + (ss / 2)) / ss) + 1) * y_stride);
+
+        for (int x = 0; x < img->w; x++) {
+            int32_t *cell = grid_row + ((((x + (ss / 2)) / ss) + 1) * x_stride);
+
+            if (img->pixfmt == PIXFORMAT_RGB565) {
+                int pixel = IMAGE_GET_RGB565_PIXEL_FAST(IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y), x);
+                cell += (((COLOR_RGB565_TO_Y(pixel) + (sr / 2)) / sr) + 1) * z_stride;
+                cell[0] += COLOR_RGB565_TO_R5(pixel);
+                cell[1] += COLOR_RGB565_TO_G6(pixel);
+                cell[2] += COLOR_RGB565_TO_B5(pixel);
+                cell[3] += 1;
+            } else {
+                int pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y), x);
+                cell += (((pixel + (sr / 2)) / sr) + 1) * z_stride;
+                cell[0] += pixel;
+                cell[1] += 1;
+            }
+        }
+    }
+
+    // Blur
+    for (int i = 0; i < (gw * gh); i++) {
+        bilateral_grid_blur_line(grid + (i * x_stride), gd, z_stride, channels);
+    }
+
+    for (int gy = 0; gy < gh; gy++) {
+        for (int gz = 0; gz < gd; gz++) {
+            bilateral_grid_blur_line(grid + (gy * y_stride) + (gz * z_stride), gw, x_stride, channels);
+        }
+    }
+
+    for (int gx = 0; gx < gw; gx++) {
+        for (int gz = 0; gz < gd; gz++) {
+            bilateral_grid_blur_line(grid + (gx * x_stride) + (gz * z_stride), gh, y_stride, channels);
+        }
+    }
+
+    // Slice
+    const int one = 1 << BILATERAL_GRID_FRAC;
+    invert = invert ? 1 : 0; // ensure binary
+
+    for (int y = 0; y < img->h; y++) {
+        int fy = (y << BILATERAL_GRID_FRAC) / ss;
+        int wy = fy & (one - 1);
+        int32_t *grid_row = grid + (((fy >> BILATERAL_GRID_FRAC) + 1) * y_stride);
+
+        for (int x = 0; x < img->w; x++) {
+            int fx = (x << BILATERAL_GRID_FRAC) / ss;
+            int wx = fx & (one - 1);
+            int32_t *cell = grid_row + (((fx >> BILATERAL_GRID_FRAC) + 1) * x_stride);
+            int this_pixel = (img->pixfmt == PIXFORMAT_RGB565)
+                ? IMAGE_GET_RGB565_PIXEL_FAST(IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y), x)
+                : IMAGE_GET_GRAYSCALE_PIXEL_FAST(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y), x);
+            int v = (img->pixfmt == PIXFORMAT_RGB565) ? COLOR_RGB565_TO_Y(this_pixel) : this_pixel;
+            int fz = (v << BILATERAL_GRID_FRAC) / sr;
+            int wz = fz & (one - 1);
+            cell += ((fz >> BILATERAL_GRID_FRAC) + 1) * z_stride;
+
+            int64_t acc[4] = {};
+
+            for (int i = 0; i < 8; i++) {
+                int32_t *corner = cell + ((i & 1) ? y_stride : 0) + ((i & 2) ? x_stride : 0) + ((i & 4) ? z_stride : 0);
+                int32_t w = ((i & 1) ? wy : (one - wy)) * ((i & 2) ? wx : (one - wx));
+                w = (w >> BILATERAL_GRID_FRAC) * ((i & 4) ? wz : (one - wz));
+
+                for (int c = 0; c < channels; c++) {
+                    acc[c] += ((int64_t) w) * corner[c];
+                }
+            }
+
+            int64_t w_acc = IM_MAX(acc[channels - 1], 1);
+            int pixel;
+
+            if (img->pixfmt == PIXFORMAT_RGB565) {
+                int r = IM_MIN(((acc[0] * 2) + w_acc) / (w_acc * 2), COLOR_R5_MAX);
+                int g = IM_MIN(((acc[1] * 2) + w_acc) / (w_acc * 2), COLOR_G6_MAX);
+                int b = IM_MIN(((acc[2] * 2) + w_acc) / (w_acc * 2), COLOR_B5_MAX);
+                pixel = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
+
+                if (threshold) {
+                    if (((COLOR_RGB565_TO_Y(pixel) - offset) < v) ^ invert) {
+                        pixel = COLOR_RGB565_BINARY_MAX;
+                    } else {
+                        pixel = COLOR_RGB565_BINARY_MIN;
+                    }
+                }
+
+                IMAGE_PUT_RGB565_PIXEL_FAST(IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y), x, pixel);
+            } else {
+                pixel = IM_MIN(((acc[0] * 2) + w_acc) / (w_acc * 2), COLOR_GRAYSCALE_MAX);
+
+                if (threshold) {
+                    if (((pixel - offset) < v) ^ invert) {
+                        pixel = COLOR_GRAYSCALE_BINARY_MAX;
+                    } else {
+                        pixel = COLOR_GRAYSCALE_BINARY_MIN;
+                    }
+                }
+
+                IMAGE_PUT_GRAYSCALE_PIXEL_FAST(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y), x, pixel);
+            }
+        }
+    }
+
+    fb_free();
+}
 #endif // IMLIB_ENABLE_BILATERAL
@@ -117,6 +117,50 @@ float fast_atan2f(float y, float x) {
     return (y == 0) ? 0 : ((y > 0) ? M_PI : -M_PI);
 }
 
+// tan(k + 0.5 degrees) in Q31, the rounding edges of the angles in the first octant.
+static const uint32_t atan_deg_edges[45] = {
+    0x011DF646, 0x035A0F6E, 0x0596AE89, 0x07D42D3F, 0x0A12E5C4, 0x0C533314,
+    0x0E957128, 0x10D9FD32, 0x132135DE, 0x156B7B8D, 0x17B93098, 0x1A0AB996,
+    0x1C607D9F, 0x1EBAE699, 0x211A6189, 0x237F5EE4, 0x25EA52E5, 0x285BB5F1,
+    0x2AD404F9, 0x2D53C1E4, 0x2FDB7403, 0x326BA891, 0x3504F334, 0x37A7EE91,
+    0x3A553CEA, 0x3D0D88C5, 0x3FD185AA, 0x42A1F0ED, 0x457F9287, 0x486B3E0E,
+    0x4B65D3BD, 0x4E704198, 0x518B84B0, 0x54B8AA84, 0x57F8D28C, 0x5B4D2FF0,
+    0x5EB70B65, 0x6237C54F, 0x65D0D818, 0x6983DACD, 0x6D528412, 0x713EAD6F,
+    0x754A5704, 0x7977ABC2, 0x7DC9061F,
+};
+
+int fast_atan2_deg(int y, int x) {
+    uint32_t ax = abs(x), ay = abs(y);
+    uint64_t n = ((uint64_t) ((ay > ax) ? ax : ay)) << 31;
+    uint64_t d = (ay > ax) ? ay : ax;
+    int a = 0;
+
+    if (!d) {
+        return 0;
+    }
+
+    // Counts the edges below min / max with a binary search.
+    for (int step = 32; step; step >>= 1) {
+        if (((a + step) <= 45) && (n >= (d * atan_deg_edges[a + step - 1]))) {
+            a += step;
+        }
+    }
+
+    if (ay > ax) {
+        a = 90 - a;
+    }
+
+    if (x < 0) {
+        a = 180 - a;
+    }
+
+    if (y < 0) {
+        a = 360 - a;
+    }
+
+    return (a == 360) ? 0 : a;
+}
+
 float fast_log2(float x) {
     union {
         float f; uint32_t i;
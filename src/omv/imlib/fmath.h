@@ -18,6 +18,8 @@
 
 float fast_atanf(float x);
 float fast_atan2f(float y, float x);
+// Returns atan2(y, x) rounded to whole degrees in [0, 360) without floating point.
+int fast_atan2_deg(int y, int x);
 float fast_expf(float x);
 float fast_cbrtf(float d);
 float fast_log(float x);
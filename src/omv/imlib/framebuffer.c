@@ -9,13 +9,31 @@
  * Framebuffer functions.
  */
 #include <stdio.h>
+#include "cmsis_compiler.h"
 #include "mpprint.h"
+#include "py/mphal.h"
 #include "framebuffer.h"
 #include "omv_boardconfig.h"
+#include "omv_memcpy.h"
 
 #define FB_ALIGN_SIZE_ROUND_DOWN(x)    (((x) / FRAMEBUFFER_ALIGNMENT) * FRAMEBUFFER_ALIGNMENT)
 #define FB_ALIGN_SIZE_ROUND_UP(x)      FB_ALIGN_SIZE_ROUND_DOWN(((x) + FRAMEBUFFER_ALIGNMENT - 1))
-#define CONSERVATIVE_JPEG_BUF_SIZE     (OMV_JPEG_BUF_SIZE - 64)
+#define JPEG_MAX_UNCHANGED_FRAMES      (30) // Unchanged frames skipped before one is resent.
+#define JPEG_DELTA_MAGIC               (0x44564D4F) // "OMVD"
+#define JPEG_DELTA_HEADER_SIZE         (12)
+#define JPEG_DELTA_MAX_TILES           (1200) // e.g. VGA with 16x16 tiles.
+#define JPEG_DELTA_FB_MARGIN           (4096)
+#define JPEG_RATE_QUALITY_MIN          (10)
+
+// The IDE JPEG buffer is split into slots so the encoder never waits for the reader. Small
+// buffers aren't split since a third of them would be too small for most frames.
+#ifndef OMV_JPEG_BUF_SLOTS
+#if (OMV_JPEG_BUF_SIZE >= (256 * 1024))
+#define OMV_JPEG_BUF_SLOTS             (3)
+#else
+#define OMV_JPEG_BUF_SLOTS             (1)
+#endif
+#endif
 
 extern char _fb_base;
 extern char _fb_end;
@@ -24,6 +42,15 @@ framebuffer_t *framebuffer = (framebuffer_t *) &_fb_base;
 extern char _jpeg_buf;
 jpegbuffer_t *jpeg_framebuffer = (jpegbuffer_t *) &_jpeg_buf;
 
+static int jpeg_overflow_count = 0;
+// Rate control of the IDE stream, enabled when a target is set.
+static jpeg_rate_t jpeg_rate;
+static uint32_t jpeg_rate_us;
+// Tile CRCs, size, format and tile size of the last frame sent in delta mode.
+static uint32_t jpeg_delta_crc[JPEG_DELTA_MAX_TILES];
+static int32_t jpeg_delta_w, jpeg_delta_h, jpeg_delta_tile;
+static pixformat_t jpeg_delta_pixfmt;
+
 void fb_set_streaming_enabled(bool enable) {
     framebuffer->streaming_enabled = enable;
 }
@@ -72,14 +99,23 @@ void fb_encode_for_ide(uint8_t *ptr, image_t *img) {
 }
 
 void framebuffer_init0() {
-    // Save fb_enabled flag state
+    // Save fb_enabled flag and delta tile size state
     int fb_enabled = JPEG_FB()->enabled;
+    int delta_tile = JPEG_FB()->delta_tile;
 
     // Clear framebuffers
     memset(MAIN_FB(), 0, sizeof(*MAIN_FB()));
     memset(JPEG_FB(), 0, sizeof(*JPEG_FB()));
 
-    mutex_init0(&JPEG_FB()->lock);
+    // Split the JPEG buffer into slots.
+    JPEG_FB()->ready = -1;
+    JPEG_FB()->read = -1;
+    JPEG_FB()->n_slots = IM_MIN(OMV_JPEG_BUF_SLOTS, JPEG_FB_SLOTS_MAX);
+    JPEG_FB()->slot_size = FB_ALIGN_SIZE_ROUND_DOWN((OMV_JPEG_BUF_SIZE - sizeof(jpegbuffer_t)) / JPEG_FB()->n_slots);
+
+    for (int i = 0; i < JPEG_FB()->n_slots; i++) {
+        JPEG_FB()->slots[i].pixels = JPEG_FB()->pixels + (i * JPEG_FB()->slot_size);
+    }
 
     // Enable streaming.
     MAIN_FB()->streaming_enabled = true; // controlled by the OpenMV Cam.
@@ -89,11 +125,24 @@ void framebuffer_init0() {
 
     // Set fb_enabled
     JPEG_FB()->enabled = fb_enabled; // controlled by the IDE.
+    JPEG_FB()->delta_tile = delta_tile; // controlled by the IDE.
+
+    // Disable rate control.
+    framebuffer_set_jpeg_rate(0, 0);
 
     // Setup buffering.
     framebuffer_set_buffers(1);
 }
 
+void framebuffer_set_jpeg_rate(uint32_t frame_size, uint32_t bitrate) {
+    jpeg_rate_init(&jpeg_rate, frame_size, bitrate, JPEG_RATE_QUALITY_MIN, OMV_JPEG_QUALITY_HIGH);
+    jpeg_rate_us = 0;
+
+    if (frame_size || bitrate) {
+        jpeg_framebuffer->quality = jpeg_rate.quality;
+    }
+}
+
 void framebuffer_init_image(image_t *img) {
     if (img != NULL) {
         img->w = framebuffer->w;
@@ -111,40 +160,263 @@ void framebuffer_init_from_image(image_t *img) {
     framebuffer->pixfmt = img->pixfmt;
 }
 
-static void jpegbuffer_init_from_image(image_t *img) {
-    if (img == NULL) {
-        jpeg_framebuffer->w = 0;
-        jpeg_framebuffer->h = 0;
-        jpeg_framebuffer->size = 0;
+// Synchronized cameras number frames by frame sync pulse so the host can match them up.
+static uint32_t jpegbuffer_frame_seq() {
+    frame_info_t *info = &framebuffer_get_current_buffer()->info;
+    return info->sync_seq ? info->sync_seq : info->seq;
+}
+
+// Returns a slot for the next frame that the reader doesn't hold, preferring one that doesn't
+// hold the newest unread frame either, or NULL if the reader holds the only slot.
+static jpegbuffer_slot_t *jpegbuffer_write_begin() {
+    int slot = -1;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    for (int i = 0; i < jpeg_framebuffer->n_slots; i++) {
+        if (i != jpeg_framebuffer->read) {
+            slot = i;
+            if (i != jpeg_framebuffer->ready) {
+                break;
+            }
+        }
+    }
+
+    // The newest unread frame is replaced.
+    if ((slot >= 0) && (slot == jpeg_framebuffer->ready)) {
+        jpeg_framebuffer->ready = -1;
+    }
+
+    __set_PRIMASK(primask);
+
+    if (slot < 0) {
+        return NULL;
+    }
+
+    jpeg_framebuffer->slots[slot].size = 0;
+    return &jpeg_framebuffer->slots[slot];
+}
+
+// Makes the frame in the slot the newest complete frame, if it holds one.
+static void jpegbuffer_write_end(jpegbuffer_slot_t *slot) {
+    if (slot->size) {
+        jpeg_framebuffer->ready = slot - jpeg_framebuffer->slots;
+    }
+}
+
+static void jpegbuffer_init_from_image(jpegbuffer_slot_t *slot, image_t *img) {
+    slot->w = img->w;
+    slot->h = img->h;
+    slot->size = img->size;
+    slot->seq = jpegbuffer_frame_seq();
+}
+
+jpegbuffer_slot_t *framebuffer_jpeg_read_begin() {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (jpeg_framebuffer->ready >= 0) {
+        jpeg_framebuffer->read = jpeg_framebuffer->ready;
+        jpeg_framebuffer->ready = -1;
+    }
+
+    int slot = jpeg_framebuffer->read;
+    __set_PRIMASK(primask);
+
+    return (slot >= 0) ? &jpeg_framebuffer->slots[slot] : NULL;
+}
+
+void framebuffer_jpeg_read_end() {
+    jpeg_framebuffer->read = -1;
+}
+
+// Compresses src to the JPEG buffer at offset and adjusts the JPEG quality for the next frame.
+// Returns false if it overflowed.
+static bool jpegbuffer_compress(jpegbuffer_slot_t *slot, image_t *src, uint32_t offset, uint32_t *size) {
+    image_t dst = {
+        .w = src->w,
+        .h = src->h,
+        .pixfmt = PIXFORMAT_JPEG,
+        .size = jpeg_framebuffer->slot_size - offset,
+        .pixels = slot->pixels + offset
+    };
+    // Note: lower quality saves USB bandwidth and results in a faster IDE FPS.
+    bool overflow = jpeg_compress(src, &dst, jpeg_framebuffer->quality, false, JPEG_SUBSAMPLING_AUTO);
+
+    if (jpeg_rate.frame_size || jpeg_rate.bitrate) {
+        // The bitrate is shared by the frames actually encoded for the IDE.
+        uint32_t now_us = mp_hal_ticks_us();
+        uint32_t elapsed_us = jpeg_rate_us ? (now_us - jpeg_rate_us) : 0;
+        jpeg_rate_us = now_us;
+        jpeg_framebuffer->quality = jpeg_rate_update(&jpeg_rate, dst.size, overflow, elapsed_us);
+
+        if (overflow) {
+            return false;
+        }
+
+        *size = dst.size;
+        return true;
+    }
+
+    if (overflow) {
+        // JPEG buffer overflowed, reduce JPEG quality for the next frame
+        // and skip the current frame. The IDE doesn't receive this frame.
+        if (jpeg_framebuffer->quality > 1) {
+            // Keep this quality for the next n frames
+            jpeg_overflow_count = 60;
+            jpeg_framebuffer->quality = IM_MAX(1, (jpeg_framebuffer->quality / 2));
+        }
+
+        return false;
+    }
+
+    if (jpeg_overflow_count) {
+        jpeg_overflow_count--;
+    }
+
+    // Dynamically adjust our quality if the image is huge.
+    bool big_frame_buffer = image_size(src) > OMV_JPEG_QUALITY_THRESHOLD;
+    int jpeg_quality_max = big_frame_buffer ? OMV_JPEG_QUALITY_LOW : OMV_JPEG_QUALITY_HIGH;
+
+    // No buffer overflow, increase quality up to max quality based on frame size...
+    if ((!jpeg_overflow_count) && (jpeg_framebuffer->quality < jpeg_quality_max)) {
+        jpeg_framebuffer->quality++;
+    }
+
+    *size = dst.size;
+    return true;
+}
+
+// Delta packets: a 12 byte header (uint32_t magic, uint16_t tile, uint16_t n, uint32_t offset),
+// the indices (uint16_t, row-major in the frame's tile grid) of the n changed tiles and, at offset,
+// a JPEG of the changed tiles packed left to right, top to bottom, in rows as wide as the frame.
+// A plain JPEG (key frame) is sent instead of a packet when most of the frame changed.
+static void jpegbuffer_update_delta(jpegbuffer_slot_t *slot, image_t *src) {
+    int tile = jpeg_framebuffer->delta_tile;
+    int bpp = (src->pixfmt == PIXFORMAT_GRAYSCALE) ? 1 : ((src->pixfmt == PIXFORMAT_RGB565) ? 2 : 0);
+    rectangle_t roi;
+    rectangle_init(&roi, 0, 0, src->w, src->h);
+    int n_tiles = image_fingerprint_size(&roi, tile);
+    int n_tiles_w = (src->w + tile - 1) / tile;
+
+    bool valid = jpeg_framebuffer->delta_valid
+                 && (jpeg_delta_w == src->w) && (jpeg_delta_h == src->h)
+                 && (jpeg_delta_pixfmt == src->pixfmt) && (jpeg_delta_tile == tile);
+    jpeg_framebuffer->delta_valid = false;
+
+    if ((!bpp) || (n_tiles > JPEG_DELTA_MAX_TILES)) {
+        uint32_t size;
+        if (jpegbuffer_compress(slot, src, 0, &size)) {
+            jpegbuffer_init_from_image(slot, src);
+            slot->size = size;
+        }
+        return;
+    }
+
+    fb_alloc_mark();
+    uint32_t *crc = fb_alloc(n_tiles * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    image_fingerprint(src, &roi, tile, crc);
+
+    uint32_t *header = (uint32_t *) slot->pixels;
+    uint16_t *index = (uint16_t *) (slot->pixels + JPEG_DELTA_HEADER_SIZE);
+    int n = 0;
+
+    for (int i = 0; i < n_tiles; i++) {
+        if ((!valid) || (crc[i] != jpeg_delta_crc[i])) {
+            index[n++] = i;
+        }
+    }
+
+    if (valid && (!n)) {
+        // Nothing changed, nothing to send.
+        jpeg_framebuffer->delta_valid = true;
+        fb_alloc_free_till_mark();
+        return;
+    }
+
+    uint32_t offset = FB_ALIGN_SIZE_ROUND_UP(JPEG_DELTA_HEADER_SIZE + (n * sizeof(uint16_t)));
+    int cols = IM_MIN(n, n_tiles_w);
+    image_t mosaic = {
+        .w = cols * tile,
+        .h = ((n + cols - 1) / cols) * tile,
+        .pixfmt = src->pixfmt
+    };
+    uint32_t size;
+    bool sent;
+
+    if (valid && (n <= ((n_tiles * 3) / 4)) && (fb_avail() >= (image_size(&mosaic) + JPEG_DELTA_FB_MARGIN))) {
+        mosaic.data = fb_alloc(image_size(&mosaic), FB_ALLOC_NO_HINT);
+
+        for (int i = 0; i < n; i++) {
+            int x = (index[i] % n_tiles_w) * tile;
+            int y = (index[i] / n_tiles_w) * tile;
+            int w = IM_MIN(tile, src->w - x) * bpp;
+            uint8_t *dst_ptr = mosaic.data + ((((i / cols) * tile * mosaic.w) + ((i % cols) * tile)) * bpp);
+            uint8_t *src_ptr = src->data + (((y * src->w) + x) * bpp);
+
+            for (int j = 0, jj = IM_MIN(tile, src->h - y); j < jj; j++) {
+                memcpy(dst_ptr + (j * mosaic.w * bpp), src_ptr + (j * src->w * bpp), w);
+            }
+        }
+
+        sent = jpegbuffer_compress(slot, &mosaic, offset, &size);
+
+        if (sent) {
+            header[0] = JPEG_DELTA_MAGIC;
+            header[1] = tile | (n << 16);
+            header[2] = offset;
+            size += offset;
+        }
     } else {
-        jpeg_framebuffer->w = img->w;
-        jpeg_framebuffer->h = img->h;
-        jpeg_framebuffer->size = img->size;
+        // Key frame.
+        sent = jpegbuffer_compress(slot, src, 0, &size);
     }
+
+    if (sent) {
+        memcpy(jpeg_delta_crc, crc, n_tiles * sizeof(uint32_t));
+        jpeg_delta_w = src->w;
+        jpeg_delta_h = src->h;
+        jpeg_delta_pixfmt = src->pixfmt;
+        jpeg_delta_tile = tile;
+        jpeg_framebuffer->delta_valid = true;
+        jpegbuffer_init_from_image(slot, src);
+        slot->size = size;
+    }
+
+    fb_alloc_free_till_mark();
 }
 
 void framebuffer_update_jpeg_buffer() {
-    static int overflow_count = 0;
+    #if defined(CRC_CR_REV_IN)
+    static int unchanged_count = 0;
+    static uint32_t last_crc = 0;
+    static int32_t last_w = 0, last_h = 0, last_quality = 0;
+    static pixformat_t last_pixfmt = PIXFORMAT_INVALID;
+    #endif
 
     image_t main_fb_src;
     framebuffer_init_image(&main_fb_src);
     image_t *src = &main_fb_src;
 
+    // Packed RAW frames aren't previewed, they have to be developed first.
+    if ((src->pixfmt_id == PIXFORMAT_ID_RAW10) || (src->pixfmt_id == PIXFORMAT_ID_RAW12)) {
+        return;
+    }
+
     if (src->pixfmt != PIXFORMAT_INVALID &&
         framebuffer->streaming_enabled && jpeg_framebuffer->enabled) {
         if (src->is_compressed) {
-            bool does_not_fit = false;
-
-            if (mutex_try_lock_alternate(&jpeg_framebuffer->lock, MUTEX_TID_OMV)) {
-                if (CONSERVATIVE_JPEG_BUF_SIZE < src->size) {
-                    jpegbuffer_init_from_image(NULL);
-                    does_not_fit = true;
-                } else {
-                    jpegbuffer_init_from_image(src);
-                    memcpy(jpeg_framebuffer->pixels, src->pixels, src->size);
-                }
+            bool does_not_fit = jpeg_framebuffer->slot_size < src->size;
+            jpegbuffer_slot_t *slot = does_not_fit ? NULL : jpegbuffer_write_begin();
 
-                mutex_unlock(&jpeg_framebuffer->lock, MUTEX_TID_OMV);
+            // The next delta packet is a key frame.
+            jpeg_framebuffer->delta_valid = false;
+
+            if (slot) {
+                jpegbuffer_init_from_image(slot, src);
+                omv_memcpy(slot->pixels, src->pixels, src->size);
+                jpegbuffer_write_end(slot);
             }
 
             if (does_not_fit) {
@@ -156,46 +428,59 @@ void framebuffer_update_jpeg_buffer() {
                 (MP_PYTHON_PRINTER)->print_strn((MP_PYTHON_PRINTER)->data, (const char *) temp, new_size);
                 fb_alloc_free_till_mark();
             }
-        } else if (src->pixfmt != PIXFORMAT_INVALID) {
-            if (mutex_try_lock_alternate(&jpeg_framebuffer->lock, MUTEX_TID_OMV)) {
-                image_t dst = {
-                    .w = src->w,
-                    .h = src->h,
-                    .pixfmt = PIXFORMAT_JPEG,
-                    .size = CONSERVATIVE_JPEG_BUF_SIZE,
-                    .pixels = jpeg_framebuffer->pixels
-                };
-                // Note: lower quality saves USB bandwidth and results in a faster IDE FPS.
-                bool overflow = jpeg_compress(src, &dst, jpeg_framebuffer->quality, false, JPEG_SUBSAMPLING_AUTO);
-
-                if (overflow) {
-                    // JPEG buffer overflowed, reduce JPEG quality for the next frame
-                    // and skip the current frame. The IDE doesn't receive this frame.
-                    if (jpeg_framebuffer->quality > 1) {
-                        // Keep this quality for the next n frames
-                        overflow_count = 60;
-                        jpeg_framebuffer->quality = IM_MAX(1, (jpeg_framebuffer->quality / 2));
-                    }
-
-                    jpegbuffer_init_from_image(NULL);
-                } else {
-                    if (overflow_count) {
-                        overflow_count--;
-                    }
-
-                    // Dynamically adjust our quality if the image is huge.
-                    bool big_frame_buffer = image_size(src) > OMV_JPEG_QUALITY_THRESHOLD;
-                    int jpeg_quality_max = big_frame_buffer ? OMV_JPEG_QUALITY_LOW : OMV_JPEG_QUALITY_HIGH;
-
-                    // No buffer overflow, increase quality up to max quality based on frame size...
-                    if ((!overflow_count) && (jpeg_framebuffer->quality < jpeg_quality_max)) {
-                        jpeg_framebuffer->quality++;
-                    }
-
-                    jpegbuffer_init_from_image(&dst);
+        } else if (jpeg_framebuffer->delta_tile) {
+            // Changed tiles are found against the last frame sent, so a packet that hasn't been
+            // taken by the IDE yet must not be replaced.
+            jpegbuffer_slot_t *slot = (jpeg_framebuffer->ready < 0) ? jpegbuffer_write_begin() : NULL;
+
+            if (slot) {
+                jpegbuffer_update_delta(slot, src);
+                jpegbuffer_write_end(slot);
+            }
+        } else {
+            #if defined(CRC_CR_REV_IN)
+            // Frames that are identical to the last one encoded (at the same quality) are not
+            // encoded or sent again, the IDE keeps showing the last frame. This only pays off
+            // with the CRC unit (see ports/stm32/hash.c), a software CRC costs more than it saves.
+            rectangle_t roi;
+            rectangle_init(&roi, 0, 0, src->w, src->h);
+            uint32_t crc = image_crc32(src, &roi);
+
+            if (jpeg_framebuffer->delta_valid && (crc == last_crc) && (src->w == last_w) && (src->h == last_h)
+                && (src->pixfmt == last_pixfmt) && (jpeg_framebuffer->quality == last_quality)
+                && (unchanged_count < JPEG_MAX_UNCHANGED_FRAMES)) {
+                unchanged_count++;
+                return;
+            }
+            #endif
+
+            jpegbuffer_slot_t *slot = jpegbuffer_write_begin();
+
+            if (slot) {
+                uint32_t size;
+
+                #if defined(CRC_CR_REV_IN)
+                int32_t quality = jpeg_framebuffer->quality;
+                // Cleared when the IDE (re)connects so that it always gets a first frame.
+                jpeg_framebuffer->delta_valid = false;
+                #endif
+
+                if (jpegbuffer_compress(slot, src, 0, &size)) {
+                    #if defined(CRC_CR_REV_IN)
+                    unchanged_count = 0;
+                    last_crc = crc;
+                    last_w = src->w;
+                    last_h = src->h;
+                    last_pixfmt = src->pixfmt;
+                    last_quality = quality;
+                    jpeg_framebuffer->delta_valid = true;
+                    #endif
+
+                    jpegbuffer_init_from_image(slot, src);
+                    slot->size = size;
                 }
 
-                mutex_unlock(&jpeg_framebuffer->lock, MUTEX_TID_OMV);
+                jpegbuffer_write_end(slot);
             }
         }
     }
@@ -278,7 +563,11 @@ void framebuffer_flush_buffers(bool fifo_flush) {
     if (fifo_flush) {
         // Drop all frame buffers.
         for (int32_t i = 0; i < framebuffer->n_buffers; i++) {
-            memset(framebuffer_get_buffer(i), 0, sizeof(vbuffer_t));
+            vbuffer_t *buffer = framebuffer_get_buffer(i);
+            // Pinned buffers are owned by an image object and survive a flush.
+            bool pinned = buffer->pinned;
+            memset(buffer, 0, sizeof(vbuffer_t));
+            buffer->pinned = pinned;
         }
     }
     // Move the tail pointer to the head which empties the virtual fifo while keeping the same
@@ -288,6 +577,15 @@ void framebuffer_flush_buffers(bool fifo_flush) {
     framebuffer->sampled_head = 0;
 }
 
+void framebuffer_set_latest(bool enable) {
+    framebuffer->latest = enable;
+    framebuffer_flush_buffers(false);
+}
+
+bool framebuffer_get_latest() {
+    return framebuffer->latest;
+}
+
 int framebuffer_set_buffers(int32_t n_buffers) {
     uint32_t total_size = framebuffer_raw_buffer_size();
     uint32_t size = total_size / n_buffers;
@@ -305,6 +603,18 @@ int framebuffer_set_buffers(int32_t n_buffers) {
     framebuffer->n_buffers = n_buffers;
     framebuffer->head = 0;
 
+    // Changing the buffer layout moves all vbuffers so any pins are dropped, and the image
+    // that owned the pinned pixels is invalidated like a released one.
+    for (int32_t i = 0; i < n_buffers; i++) {
+        framebuffer_get_buffer(i)->pinned = false;
+    }
+
+    if (framebuffer->pinned_image) {
+        memset(framebuffer->pinned_image, 0, sizeof(image_t));
+        framebuffer->pinned_image->pixfmt = PIXFORMAT_INVALID;
+        framebuffer->pinned_image = NULL;
+    }
+
     framebuffer_flush_buffers(true);
 
     return 0;
@@ -345,7 +655,10 @@ void framebuffer_free_current_buffer() {
 
     #ifdef __DCACHE_PRESENT
     // Make sure all cached CPU writes are discarded before returning the buffer.
-    SCB_InvalidateDCache_by_Addr(buffer->data, framebuffer_get_buffer_size());
+    // A pinned buffer is still owned by an image so its CPU writes must be kept.
+    if (!buffer->pinned) {
+        SCB_InvalidateDCache_by_Addr(buffer->data, framebuffer_get_buffer_size());
+    }
     #endif
 
     // Invalidate frame.
@@ -360,8 +673,8 @@ void framebuffer_free_current_buffer() {
 void framebuffer_setup_buffers() {
     #ifdef __DCACHE_PRESENT
     for (int32_t i = 0; i < framebuffer->n_buffers; i++) {
-        if (i != framebuffer->head) {
-            vbuffer_t *buffer = framebuffer_get_buffer(i);
+        vbuffer_t *buffer = framebuffer_get_buffer(i);
+        if ((i != framebuffer->head) && (!buffer->pinned)) {
             // Make sure all cached CPU writes are discarded before returning the buffer.
             SCB_InvalidateDCache_by_Addr(buffer->data, framebuffer_get_buffer_size());
         }
@@ -382,8 +695,8 @@ vbuffer_t *framebuffer_get_head(framebuffer_flags_t flags) {
         if (framebuffer->head == framebuffer->tail) {
             return NULL;
         }
-        // Triple Buffer Mode.
-    } else if (framebuffer->n_buffers == 3) {
+        // Triple Buffer Mode (or freshest frame policy).
+    } else if ((framebuffer->n_buffers == 3) || framebuffer->latest) {
         int32_t sampled_tail = framebuffer->tail;
         if (framebuffer->head == sampled_tail) {
             return NULL;
@@ -434,13 +747,24 @@ vbuffer_t *framebuffer_get_tail(framebuffer_flags_t flags) {
             framebuffer->check_head = true;
             return NULL;
         }
-        // Triple Buffer Mode.
-    } else if (framebuffer->n_buffers == 3) {
+        // Triple Buffer Mode (or freshest frame policy).
+    } else if ((framebuffer->n_buffers == 3) || framebuffer->latest) {
         // For triple buffering we are never writing where tail or head
-        // (which may instantly update to be equal to tail) is.
-        if (new_tail == framebuffer->sampled_head) {
+        // (which may instantly update to be equal to tail) is. Pinned buffers are skipped too.
+        int32_t i = 1;
+        for (; i < framebuffer->n_buffers; i++) {
+            if ((new_tail != framebuffer->sampled_head) && (!framebuffer_get_buffer(new_tail)->pinned)) {
+                break;
+            }
             new_tail = (new_tail + 1) % framebuffer->n_buffers;
         }
+
+        // No free buffer (the head, tail and pinned buffers are all different).
+        if (i == framebuffer->n_buffers) {
+            // Setup to check head again.
+            framebuffer->check_head = true;
+            return NULL;
+        }
         // Video FIFO Mode.
     } else {
         if (new_tail == framebuffer->sampled_head) {
@@ -463,6 +787,12 @@ vbuffer_t *framebuffer_get_tail(framebuffer_flags_t flags) {
         // Trigger reset on the frame buffer the next time it is used.
         buffer->reset_state = true;
 
+        // Zero is reserved for frames without capture metadata.
+        if (!++framebuffer->frame_seq) {
+            framebuffer->frame_seq = 1;
+        }
+        buffer->info.seq = framebuffer->frame_seq;
+
         // Mark the frame buffer ready in single buffer mode.
         if (framebuffer->n_buffers == 1) {
             buffer->waiting_for_data = false;
@@ -476,6 +806,48 @@ vbuffer_t *framebuffer_get_tail(framebuffer_flags_t flags) {
     return buffer;
 }
 
+vbuffer_t *framebuffer_get_current_buffer() {
+    return framebuffer_get_buffer(framebuffer->head);
+}
+
+vbuffer_t *framebuffer_pin_current_buffer(image_t *image) {
+    // Triple buffer mode always has one spare buffer to capture to while the head is pinned.
+    if ((framebuffer->n_buffers != 3) || (framebuffer->pixfmt == PIXFORMAT_INVALID)) {
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < framebuffer->n_buffers; i++) {
+        if (framebuffer_get_buffer(i)->pinned) {
+            return NULL;
+        }
+    }
+
+    vbuffer_t *buffer = framebuffer_get_buffer(framebuffer->head);
+    buffer->pinned = true;
+    framebuffer->pinned_image = image;
+    return buffer;
+}
+
+void framebuffer_release_buffer(image_t *image) {
+    // The pin was dropped if the buffers were laid out again.
+    if ((!image) || (framebuffer->pinned_image != image)) {
+        return;
+    }
+
+    framebuffer->pinned_image = NULL;
+
+    for (int32_t i = 0; i < framebuffer->n_buffers; i++) {
+        vbuffer_t *buffer = framebuffer_get_buffer(i);
+        if (buffer->pinned) {
+            #ifdef __DCACHE_PRESENT
+            // Make sure all cached CPU writes are discarded before DMA can write to it again.
+            SCB_InvalidateDCache_by_Addr(buffer->data, framebuffer_get_buffer_size());
+            #endif
+            buffer->pinned = false;
+        }
+    }
+}
+
 char *framebuffer_get_buffers_end() {
     return (char *) (framebuffer->data + framebuffer_total_buffer_size());
 }
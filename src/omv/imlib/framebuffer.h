@@ -12,7 +12,6 @@
 #define __FRAMEBUFFER_H__
 #include <stdint.h>
 #include "imlib.h"
-#include "mutex.h"
 #include "omv_common.h"
 
 // DMA Buffers need to be aligned by cache lines or 16 bytes.
@@ -30,10 +29,18 @@ typedef struct framebuffer {
     int32_t streaming_enabled;
     uint32_t raw_buffer_size;
     int32_t n_buffers;
+    // Capture writes at the tail and the script reads at the head, they're the only consumer. The
+    // IDE preview is encoded from the frame the script holds, so it never reads the FIFO itself.
     int32_t head;
     volatile int32_t tail;
     bool check_head;
     int32_t sampled_head;
+    // Sequence number of the last completed frame.
+    volatile uint32_t frame_seq;
+    // Freshest frame policy (see framebuffer_set_latest()).
+    bool latest;
+    // Image that owns the pinned buffer (see framebuffer_pin_current_buffer()).
+    image_t *pinned_image;
     OMV_ATTR_ALIGNED(uint8_t data[], FRAMEBUFFER_ALIGNMENT);
 } framebuffer_t;
 
@@ -44,6 +51,18 @@ typedef enum {
     FB_PEEK     =   (1 << 0),   // If set, will not move the head/tail.
 } framebuffer_flags_t;
 
+// Capture metadata of a frame.
+typedef struct frame_info {
+    uint32_t seq;           // Sequence number of the frame.
+    uint32_t sync_seq;      // Frame sync pulse the frame was exposed on, shared by synchronized cameras.
+    uint32_t sof_us;        // Start of frame (or exposure trigger) time in microseconds.
+    uint32_t eof_us;        // End of frame time in microseconds.
+    int32_t exposure_us;    // Exposure in effect for the frame, or -1 if unknown.
+    float gain_db;          // Gain in effect for the frame.
+    uint32_t age_us;        // Time from the end of frame to snapshot() returning the frame.
+    uint32_t dropped;       // Frames captured but never returned since the previous snapshot().
+} frame_info_t;
+
 typedef struct vbuffer {
     // Used by snapshot code to figure out the jpeg size (bpp).
     int32_t offset;
@@ -51,16 +70,35 @@ typedef struct vbuffer {
     // Used internally by frame buffer code.
     volatile bool waiting_for_data;
     bool reset_state;
+    // Set while an image object owns the buffer (see framebuffer_pin_current_buffer()).
+    volatile bool pinned;
+    // Capture metadata, filled in while the frame is received.
+    frame_info_t info;
     // Image data array.
     OMV_ATTR_ALIGNED(uint8_t data[], FRAMEBUFFER_ALIGNMENT);
 } vbuffer_t;
 
-typedef struct jpegbuffer {
+#define JPEG_FB_SLOTS_MAX    (3)
+
+typedef struct jpegbuffer_slot {
     int32_t w, h;
     int32_t size;
+    uint32_t seq;           // Capture sequence number of the frame (see frame_info_t).
+    uint8_t *pixels;
+} jpegbuffer_slot_t;
+
+typedef struct jpegbuffer {
     int32_t enabled;
     int32_t quality;
-    omv_mutex_t lock;
+    int32_t delta_tile;     // Non-zero to send changed tiles (see USBDBG_FB_DELTA).
+    int32_t delta_valid;    // Cleared to make the next delta packet a key frame (or send the next frame).
+    // Slots are handed between the encoder and the reader only by changing these indices with
+    // interrupts disabled, so neither side ever waits for the other.
+    volatile int32_t ready; // Newest complete frame, -1 if none.
+    volatile int32_t read;  // Frame held by the reader, -1 if none.
+    int32_t n_slots;
+    uint32_t slot_size;
+    jpegbuffer_slot_t slots[JPEG_FB_SLOTS_MAX];
     OMV_ATTR_ALIGNED(uint8_t pixels[], FRAMEBUFFER_ALIGNMENT);
 } jpegbuffer_t;
 
@@ -101,6 +139,11 @@ void framebuffer_init_from_image(image_t *img);
 // if the src is JPEG and fits in the JPEG buffer, or encode and stream src image to the IDE if not.
 void framebuffer_update_jpeg_buffer();
 
+// Adjusts the JPEG quality of frames sent to the IDE toward a size per frame in bytes and/or a
+// bitrate in bits per second, instead of backing off only when the JPEG buffer overflows.
+// Both 0 restores the default behavior.
+void framebuffer_set_jpeg_rate(uint32_t frame_size, uint32_t bitrate);
+
 // Clear the framebuffer FIFO. If fifo_flush is true, reset and discard all framebuffers,
 // otherwise, retain the last frame in the fifo.
 void framebuffer_flush_buffers(bool fifo_flush);
@@ -108,12 +151,29 @@ void framebuffer_flush_buffers(bool fifo_flush);
 // Controls the number of virtual buffers in the frame buffer.
 int framebuffer_set_buffers(int32_t n_buffers);
 
+// Enables the freshest frame policy. With 3 or more buffers the head always moves to the newest
+// frame and capture overwrites unread frames instead of waiting for them to be read, like triple
+// buffering does. With fewer buffers capture has nowhere else to write, so this has no effect.
+void framebuffer_set_latest(bool enable);
+bool framebuffer_get_latest();
+
 // Automatically finds the best buffering size given RAM.
 void framebuffer_auto_adjust_buffers();
 
+// Returns the vbuffer of the frame returned by the last snapshot.
+vbuffer_t *framebuffer_get_current_buffer();
+
 // Call when done with the current vbuffer to mark it as free.
 void framebuffer_free_current_buffer();
 
+// Pins the current vbuffer so that capture skips it until it is released. This is only allowed in
+// triple buffer mode and only one buffer may be pinned at a time. Returns the buffer or NULL.
+// image is the image owning the pixels, it's invalidated if the buffers are laid out again first.
+vbuffer_t *framebuffer_pin_current_buffer(image_t *image);
+
+// Releases the buffer pinned by image returning it to the FIFO (if it's still pinned).
+void framebuffer_release_buffer(image_t *image);
+
 // Call to do any heavy setup before frame capture.
 void framebuffer_setup_buffers();
 
@@ -129,6 +189,13 @@ vbuffer_t *framebuffer_get_tail(framebuffer_flags_t flags);
 // Returns a pointer to the end of the framebuffer(s).
 char *framebuffer_get_buffers_end();
 
+// Takes the newest complete JPEG frame for sending to the IDE. Returns the frame still held if
+// there's no newer one, or NULL if there's none. The frame stays valid until it's released.
+jpegbuffer_slot_t *framebuffer_jpeg_read_begin();
+
+// Releases the JPEG frame held by the reader, if any.
+void framebuffer_jpeg_read_end();
+
 // Use these macros to get a pointer to main or JPEG framebuffer.
 #define MAIN_FB()    (framebuffer)
 #define JPEG_FB()    (jpeg_framebuffer)
@@ -6,36 +6,337 @@
  *
  * This work is licensed under the MIT license, see the file LICENSE for details.
  *
- * A simple GIF encoder.
+ * A GIF encoder (LZW, with optional frame difference transparency and adaptive palette).
  */
 #include "imlib.h"
 #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
 
 #include "fb_alloc.h"
 #include "file_utils.h"
-#define BLOCK_SIZE    (126) // (2^7) - 2 // (DO NOT CHANGE!)
 
-void gif_open(FIL *fp, int width, int height, bool color, bool loop) {
-    file_buffer_on(fp);
+#define GIF_COLORS          (128)   // Palette colors (7-bit pixels).
+#define GIF_TRANSPARENT     (128)   // Transparent index (8-bit pixels).
+#define GIF_BINS            (4096)  // RGB444 histogram bins for the adaptive palette.
+#define GIF_KMEANS_ITER     (2)     // K-means passes refining the median cut palette.
+#define LZW_MAX_CODES       (4096)
+#define LZW_HASH_SIZE       (5003)  // Prime, about 80% occupied when the dictionary is full.
+#define LZW_HASH_SHIFT      (4)
+#define LZW_HASH_EMPTY      (0xFFFFFFFF)
 
-    file_write(fp, "GIF89a", 6);
-    file_write(fp, (uint16_t []) {width, height}, 4);
-    file_write(fp, (uint8_t []) {0xF6, 0x00, 0x00}, 3);
+#define GIF_RGB565_TO_FIXED(pixel) \
+    (((COLOR_RGB565_TO_R5(pixel) >> 3) << 5) | ((COLOR_RGB565_TO_G6(pixel) >> 3) << 2) | (COLOR_RGB565_TO_B5(pixel) >> 3))
+
+#define GIF_RGB565_TO_BIN(pixel) \
+    (((COLOR_RGB565_TO_R5(pixel) >> 1) << 8) | ((COLOR_RGB565_TO_G6(pixel) >> 2) << 4) | (COLOR_RGB565_TO_B5(pixel) >> 1))
+
+typedef struct gif_lzw {
+    FIL *fp;
+    uint32_t *hash; // (prefix << 20) | (pixel << 12) | code
+    uint32_t bits;
+    int n_bits;
+    int min_code_size;
+    int code_size;
+    int next_code;
+    int prefix;
+    int block_len;
+    uint8_t block[255];
+} gif_lzw_t;
+
+typedef struct gif_box {
+    uint8_t min[3];
+    uint8_t max[3];
+    uint32_t count;
+} gif_box_t;
+
+static void gif_write_palette(FIL *fp, const uint8_t *palette, int bits) {
+    file_write(fp, palette, GIF_COLORS * 3);
+    for (int i = GIF_COLORS; i < (1 << bits); i++) {
+        file_write(fp, (uint8_t []) {0, 0, 0}, 3);
+    }
+}
+
+static void gif_lzw_write_block(gif_lzw_t *lzw) {
+    if (lzw->block_len) {
+        file_write_byte(lzw->fp, lzw->block_len);
+        file_write(lzw->fp, lzw->block, lzw->block_len);
+        lzw->block_len = 0;
+    }
+}
 
-    if (color) {
-        for (int i = 0; i < 128; i++) {
-            int red = ((((i & 0x60) >> 5) * 255) + 1.5) / 3;
-            int green = ((((i & 0x1C) >> 2) * 255) + 3.5) / 7;
-            int blue = (((i & 0x3) * 255) + 1.5) / 3;
-            file_write(fp, (uint8_t []) {red, green, blue}, 3);
+static void gif_lzw_put(gif_lzw_t *lzw, int code) {
+    lzw->bits |= code << lzw->n_bits;
+    lzw->n_bits += lzw->code_size;
+    while (lzw->n_bits >= 8) {
+        lzw->block[lzw->block_len++] = lzw->bits;
+        lzw->bits >>= 8;
+        lzw->n_bits -= 8;
+        if (lzw->block_len == sizeof(lzw->block)) {
+            gif_lzw_write_block(lzw);
         }
+    }
+}
+
+static void gif_lzw_clear(gif_lzw_t *lzw) {
+    gif_lzw_put(lzw, 1 << lzw->min_code_size);
+    memset(lzw->hash, 0xFF, LZW_HASH_SIZE * sizeof(uint32_t));
+    lzw->next_code = (1 << lzw->min_code_size) + 2;
+    lzw->code_size = lzw->min_code_size + 1;
+}
+
+static void gif_lzw_init(gif_lzw_t *lzw, FIL *fp, int min_code_size) {
+    lzw->fp = fp;
+    lzw->hash = fb_alloc(LZW_HASH_SIZE * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    lzw->bits = 0;
+    lzw->n_bits = 0;
+    lzw->min_code_size = min_code_size;
+    lzw->code_size = min_code_size + 1;
+    lzw->prefix = -1;
+    lzw->block_len = 0;
+    file_write_byte(fp, min_code_size);
+    gif_lzw_clear(lzw);
+}
+
+static void gif_lzw_add(gif_lzw_t *lzw, int pixel) {
+    if (lzw->prefix < 0) {
+        lzw->prefix = pixel;
+        return;
+    }
+
+    uint32_t key = (lzw->prefix << 8) | pixel;
+    int i = (pixel << LZW_HASH_SHIFT) ^ lzw->prefix;
+    int disp = i ? (LZW_HASH_SIZE - i) : 1;
+
+    for (uint32_t entry; (entry = lzw->hash[i]) != LZW_HASH_EMPTY;) {
+        if ((entry >> 12) == key) {
+            lzw->prefix = entry & 0xFFF;
+            return;
+        }
+        if ((i -= disp) < 0) {
+            i += LZW_HASH_SIZE;
+        }
+    }
+
+    gif_lzw_put(lzw, lzw->prefix);
+
+    if (lzw->next_code < LZW_MAX_CODES) {
+        if (lzw->next_code == (1 << lzw->code_size)) {
+            lzw->code_size += 1;
+        }
+        lzw->hash[i] = (key << 12) | lzw->next_code++;
     } else {
-        for (int i = 0; i < 128; i++) {
+        gif_lzw_clear(lzw);
+    }
+
+    lzw->prefix = pixel;
+}
+
+static void gif_lzw_finish(gif_lzw_t *lzw) {
+    if (lzw->prefix >= 0) {
+        gif_lzw_put(lzw, lzw->prefix);
+    }
+    gif_lzw_put(lzw, (1 << lzw->min_code_size) + 1); // end code
+    if (lzw->n_bits) {
+        lzw->block[lzw->block_len++] = lzw->bits;
+    }
+    gif_lzw_write_block(lzw);
+    file_write_byte(lzw->fp, 0x00); // block terminator
+    fb_free(); // hash
+}
+
+// Returns row y in RGB565, converting it to the buffer if needed.
+static uint16_t *gif_get_rgb565_row(image_t *img, int y, uint16_t *buffer) {
+    if (img->is_bayer) {
+        imlib_debayer_line(0, img->w, y, buffer, PIXFORMAT_RGB565, img);
+        return buffer;
+    } else if (img->is_yuv) {
+        imlib_deyuv_line(0, img->w, y, buffer, PIXFORMAT_RGB565, img);
+        return buffer;
+    } else {
+        return IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+    }
+}
+
+static void gif_box_shrink(const uint32_t *hist, gif_box_t *box) {
+    uint8_t min[3] = {15, 15, 15}, max[3] = {0, 0, 0};
+    box->count = 0;
+
+    for (int r = box->min[0]; r <= box->max[0]; r++) {
+        for (int g = box->min[1]; g <= box->max[1]; g++) {
+            for (int b = box->min[2]; b <= box->max[2]; b++) {
+                uint32_t count = hist[(r << 8) | (g << 4) | b];
+                if (count) {
+                    min[0] = IM_MIN(min[0], r); max[0] = IM_MAX(max[0], r);
+                    min[1] = IM_MIN(min[1], g); max[1] = IM_MAX(max[1], g);
+                    min[2] = IM_MIN(min[2], b); max[2] = IM_MAX(max[2], b);
+                    box->count += count;
+                }
+            }
+        }
+    }
+
+    if (box->count) {
+        memcpy(box->min, min, 3);
+        memcpy(box->max, max, 3);
+    }
+}
+
+// Median cut of the RGB444 histogram into GIF_COLORS boxes. Fills the palette with the mean
+// color of each box, and the lut with the palette index of each (used) bin.
+static void gif_median_cut(const uint32_t *hist, uint8_t *palette, uint8_t *lut) {
+    gif_box_t *boxes = fb_alloc(GIF_COLORS * sizeof(gif_box_t), FB_ALLOC_NO_HINT);
+    int n_boxes = 1;
+
+    boxes[0] = (gif_box_t) { {0, 0, 0}, {15, 15, 15}, 0 };
+    gif_box_shrink(hist, &boxes[0]);
+
+    while (n_boxes < GIF_COLORS) {
+        // Split the most populated box that can be split along its longest axis.
+        gif_box_t *box = NULL;
+        int axis = 0;
+        for (int i = 0; i < n_boxes; i++) {
+            int a = 0;
+            for (int j = 1; j < 3; j++) {
+                if ((boxes[i].max[j] - boxes[i].min[j]) > (boxes[i].max[a] - boxes[i].min[a])) {
+                    a = j;
+                }
+            }
+            if ((boxes[i].max[a] > boxes[i].min[a]) && ((!box) || (boxes[i].count > box->count))) {
+                box = &boxes[i];
+                axis = a;
+            }
+        }
+
+        if (!box) {
+            break;
+        }
+
+        // Find the median slice along the axis.
+        uint32_t half = box->count / 2, sum = 0;
+        int split = box->min[axis];
+        for (; split < (box->max[axis] - 1); split++) {
+            gif_box_t slice = *box;
+            slice.min[axis] = slice.max[axis] = split;
+            gif_box_shrink(hist, &slice);
+            if ((sum += slice.count) >= half) {
+                break;
+            }
+        }
+
+        gif_box_t *upper = &boxes[n_boxes++];
+        *upper = *box;
+        upper->min[axis] = split + 1;
+        box->max[axis] = split;
+        gif_box_shrink(hist, box);
+        gif_box_shrink(hist, upper);
+    }
+
+    memset(palette, 0, GIF_COLORS * 3);
+
+    for (int i = 0; i < n_boxes; i++) {
+        gif_box_t *box = &boxes[i];
+        uint32_t sum[3] = {0, 0, 0};
+
+        for (int r = box->min[0]; r <= box->max[0]; r++) {
+            for (int g = box->min[1]; g <= box->max[1]; g++) {
+                for (int b = box->min[2]; b <= box->max[2]; b++) {
+                    int bin = (r << 8) | (g << 4) | b;
+                    sum[0] += hist[bin] * r;
+                    sum[1] += hist[bin] * g;
+                    sum[2] += hist[bin] * b;
+                    lut[bin] = i;
+                }
+            }
+        }
+
+        for (int j = 0; (j < 3) && box->count; j++) {
+            palette[(i * 3) + j] = ((sum[j] * 17) + (box->count / 2)) / box->count;
+        }
+    }
+
+    fb_free(); // boxes
+}
+
+// Refines the median cut palette with a few k-means passes over the used bins, weighted by
+// their counts, and remaps each bin in the lut to its nearest palette color.
+static void gif_kmeans_refine(const uint32_t *hist, uint8_t *palette, uint8_t *lut) {
+    int n = 0;
+    for (int bin = 0; bin < GIF_BINS; bin++) {
+        n += hist[bin] ? 1 : 0;
+    }
+
+    if (!n) {
+        return;
+    }
+
+    kmeans_t km = { .n = n, .k = GIF_COLORS, .dims = 3 };
+    uint16_t *bins = fb_alloc(n * sizeof(uint16_t), FB_ALLOC_NO_HINT);
+    km.weights = fb_alloc(n * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    km.labels = fb_alloc(n * sizeof(uint16_t), FB_ALLOC_NO_HINT);
+    for (int c = 0; c < 3; c++) {
+        km.points[c] = fb_alloc(n * sizeof(int16_t), FB_ALLOC_NO_HINT);
+        km.centers[c] = fb_alloc(GIF_COLORS * sizeof(int16_t), FB_ALLOC_NO_HINT);
+    }
+
+    for (int bin = 0, i = 0; bin < GIF_BINS; bin++) {
+        if (hist[bin]) {
+            bins[i] = bin;
+            km.weights[i] = hist[bin];
+            km.points[0][i] = ((bin >> 8) & 0xF) * 17;
+            km.points[1][i] = ((bin >> 4) & 0xF) * 17;
+            km.points[2][i] = (bin & 0xF) * 17;
+            i++;
+        }
+    }
+
+    for (int j = 0; j < GIF_COLORS; j++) {
+        for (int c = 0; c < 3; c++) {
+            km.centers[c][j] = palette[(j * 3) + c];
+        }
+    }
+
+    kmeans_run(&km, GIF_KMEANS_ITER, 1);
+
+    for (int j = 0; j < GIF_COLORS; j++) {
+        for (int c = 0; c < 3; c++) {
+            palette[(j * 3) + c] = km.centers[c][j];
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        lut[bins[i]] = km.labels[i];
+    }
+
+    for (int c = 2; c >= 0; c--) {
+        fb_free(); // centers
+        fb_free(); // points
+    }
+    fb_free(); // labels
+    fb_free(); // weights
+    fb_free(); // bins
+}
+
+void gif_open(FIL *fp, int width, int height, bool color, bool loop, bool transparency) {
+    int bits = transparency ? 8 : 7;
+    uint8_t palette[GIF_COLORS * 3];
+
+    for (int i = 0; i < GIF_COLORS; i++) {
+        if (color) {
+            palette[(i * 3) + 0] = ((((i & 0x60) >> 5) * 255) + 1.5) / 3;
+            palette[(i * 3) + 1] = ((((i & 0x1C) >> 2) * 255) + 3.5) / 7;
+            palette[(i * 3) + 2] = (((i & 0x3) * 255) + 1.5) / 3;
+        } else {
             int gray = ((i * 255) + 63.5) / 127;
-            file_write(fp, (uint8_t []) {gray, gray, gray}, 3);
+            memset(&palette[i * 3], gray, 3);
         }
     }
 
+    file_buffer_on(fp);
+
+    file_write(fp, "GIF89a", 6);
+    file_write(fp, (uint16_t []) {width, height}, 4);
+    file_write(fp, (uint8_t []) {0xF0 | (bits - 1), 0x00, 0x00}, 3);
+    gif_write_palette(fp, palette, bits);
+
     if (loop) {
         file_write(fp, (uint8_t []) {'!', 0xFF, 0x0B}, 3);
         file_write(fp, "NETSCAPE2.0", 11);
@@ -45,69 +346,95 @@ void gif_open(FIL *fp, int width, int height, bool color, bool loop) {
     file_buffer_off(fp);
 }
 
-void gif_add_frame(FIL *fp, image_t *img, uint16_t delay) {
+void gif_add_frame(FIL *fp, image_t *img, uint16_t delay, uint8_t *prev, bool adaptive) {
+    int bits = prev ? 8 : 7;
+    uint8_t *lut = NULL;
+    uint8_t palette[GIF_COLORS * 3];
+    uint16_t *buffer = NULL;
+
+    fb_alloc_mark();
+
+    if (!IM_IS_GS(img)) {
+        buffer = fb_alloc(img->w * sizeof(uint16_t), FB_ALLOC_NO_HINT);
+    }
+
+    // Grayscale images already get every other gray level from the fixed palette.
+    if (adaptive && (!IM_IS_GS(img))) {
+        uint32_t *hist = fb_alloc0(GIF_BINS * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+        lut = fb_alloc(GIF_BINS, FB_ALLOC_NO_HINT);
+
+        for (int y = 0; y < img->h; y++) {
+            uint16_t *row_ptr = gif_get_rgb565_row(img, y, buffer);
+            for (int x = 0; x < img->w; x++) {
+                hist[GIF_RGB565_TO_BIN(row_ptr[x])] += 1;
+            }
+        }
+
+        gif_median_cut(hist, palette, lut);
+        gif_kmeans_refine(hist, palette, lut);
+    }
+
     file_buffer_on(fp);
 
-    if (delay) {
-        file_write(fp, (uint8_t []) {'!', 0xF9, 0x04, 0x04}, 4);
+    if (delay || prev) {
+        // Do not dispose, so transparent pixels show the previous frame.
+        file_write(fp, (uint8_t []) {'!', 0xF9, 0x04, prev ? 0x05 : 0x04}, 4);
         file_write_short(fp, delay);
-        file_write_short(fp, 0); // end
+        file_write(fp, (uint8_t []) {prev ? GIF_TRANSPARENT : 0x00, 0x00}, 2); // end
     }
 
     file_write_byte(fp, 0x2C);
     file_write_long(fp, 0);
     file_write(fp, (uint16_t []) {img->w, img->h}, 4);
-    file_write(fp, (uint8_t []) {0x00, 0x07}, 2); // 7-bits
-
-    int bytes = img->h * img->w;
-    int blocks = (bytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
-
-    if (IM_IS_GS(img)) {
-        for (int y = 0; y < blocks; y++) {
-            int block_size = IM_MIN(BLOCK_SIZE, bytes - (y * BLOCK_SIZE));
-            file_write_byte(fp, 1 + block_size);
-            file_write_byte(fp, 0x80); // clear code
-            for (int x = 0; x < block_size; x++) {
-                file_write_byte(fp, img->pixels[(y * BLOCK_SIZE) + x] >> 1);
-            }
-        }
-    } else if (IM_IS_RGB565(img)) {
-        for (int y = 0; y < blocks; y++) {
-            int block_size = IM_MIN(BLOCK_SIZE, bytes - (y * BLOCK_SIZE));
-            file_write_byte(fp, 1 + block_size);
-            file_write_byte(fp, 0x80); // clear code
-            for (int x = 0; x < block_size; x++) {
-                uint16_t pixel = ((uint16_t *) img->pixels)[(y * BLOCK_SIZE) + x];
-                uint16_t r = COLOR_RGB565_TO_R5(pixel) >> 3;
-                uint16_t g = COLOR_RGB565_TO_G6(pixel) >> 3;
-                uint16_t b = COLOR_RGB565_TO_B5(pixel) >> 3;
-                file_write_byte(fp, (r << 5) | (g << 2) | b);
-            }
+
+    if (lut) {
+        file_write_byte(fp, 0x80 | (bits - 1)); // local color table
+        gif_write_palette(fp, palette, bits);
+    } else {
+        file_write_byte(fp, 0x00);
+    }
+
+    gif_lzw_t lzw;
+    gif_lzw_init(&lzw, fp, bits);
+
+    for (int y = 0; y < img->h; y++) {
+        uint8_t *prev_row = prev ? (prev + (y * img->w)) : NULL;
+        uint8_t *gs_row_ptr = NULL;
+        uint16_t *rgb_row_ptr = NULL;
+
+        if (IM_IS_GS(img)) {
+            gs_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+        } else {
+            rgb_row_ptr = gif_get_rgb565_row(img, y, buffer);
         }
-    } else if (img->is_bayer || img->is_yuv) {
-        for (int y = 0; y < blocks; y++) {
-            int block_size = IM_MIN(BLOCK_SIZE, bytes - (y * BLOCK_SIZE));
-            file_write_byte(fp, 1 + block_size);
-            file_write_byte(fp, 0x80); // clear code
-            uint16_t pixels[block_size];
-            if (img->is_bayer) {
-                imlib_debayer_line(0, block_size, y, pixels, PIXFORMAT_RGB565, img);
+
+        for (int x = 0; x < img->w; x++) {
+            int fixed, index;
+
+            if (gs_row_ptr) {
+                fixed = index = gs_row_ptr[x] >> 1;
             } else {
-                imlib_deyuv_line(0, block_size, y, pixels, PIXFORMAT_RGB565, img);
+                fixed = GIF_RGB565_TO_FIXED(rgb_row_ptr[x]);
+                index = lut ? lut[GIF_RGB565_TO_BIN(rgb_row_ptr[x])] : fixed;
             }
-            for (int x = 0; x < block_size; x++) {
-                uint16_t pixel = pixels[2];
-                uint16_t r = COLOR_RGB565_TO_R5(pixel) >> 3;
-                uint16_t g = COLOR_RGB565_TO_G6(pixel) >> 3;
-                uint16_t b = COLOR_RGB565_TO_B5(pixel) >> 3;
-                file_write_byte(fp, (r << 5) | (g << 2) | b);
+
+            // Pixels that did not change (in the fixed palette) since they were last drawn.
+            if (prev_row) {
+                if (prev_row[x] == fixed) {
+                    index = GIF_TRANSPARENT;
+                } else {
+                    prev_row[x] = fixed;
+                }
             }
+
+            gif_lzw_add(&lzw, index);
         }
     }
 
-    file_write(fp, (uint8_t []) {0x01, 0x81, 0x00}, 3); // end code
+    gif_lzw_finish(&lzw);
 
     file_buffer_off(fp);
+    fb_alloc_free_till_mark();
 }
 
 void gif_close(FIL *fp) {
@@ -14,67 +14,106 @@
 #include "py/nlr.h"
 
 #include "xalloc.h"
+#include "fb_alloc.h"
 #include "imlib.h"
 // built-in cascades
 #include "cascade.h"
 #include "file_utils.h"
 
 #ifdef IMLIB_ENABLE_FEATURES
-static int eval_weak_classifier(cascade_t *cascade, point_t pt, int t_idx, int w_idx, int r_idx) {
-    int32_t sumw = 0;
-    mw_image_t *sum = cascade->sum;
-
-    /* The node threshold is multiplied by the standard deviation of the sub window */
-    int32_t t = cascade->tree_thresh_array[t_idx] * cascade->std;
-
-    for (int i = 0; i < cascade->num_rectangles_array[t_idx]; i++) {
-        int x = cascade->rectangles_array[r_idx + (i << 2) + 0];
-        int y = cascade->rectangles_array[r_idx + (i << 2) + 1];
-        int w = cascade->rectangles_array[r_idx + (i << 2) + 2];
-        int h = cascade->rectangles_array[r_idx + (i << 2) + 3];
-        // Lookup the feature
-        sumw += imlib_integral_mw_lookup(sum, pt.x + x, y, w, h) * (cascade->weights_array[w_idx + i] << 12);
-    }
+typedef struct {
+    int x;
+    int std;
+    int32_t sumw;
+    int stage_sum;
+} haar_window_t;
+
+// Fills windows with the windows of the current row that are not homogeneous, along with their
+// standard deviation. Returns the number of windows.
+static int haar_row_windows(cascade_t *cascade, int x2, haar_window_t *windows) {
+    int win_w = cascade->window.w;
+    int win_h = cascade->window.h;
+    uint32_t n = (win_w * win_h);
+    uint32_t *sum_top = cascade->sum->data[0], *sum_bottom = cascade->sum->data[win_h];
+    uint32_t *ssq_top = cascade->ssq->data[0], *ssq_bottom = cascade->ssq->data[win_h];
+    int count = 0;
+
+    for (int x = 0; x < x2; x += cascade->step) {
+        uint32_t i_s = sum_bottom[x + win_w] + sum_top[x] - sum_top[x + win_w] - sum_bottom[x];
+        uint32_t i_sq = ssq_bottom[x + win_w] + ssq_top[x] - ssq_top[x + win_w] - ssq_bottom[x];
+        uint32_t m = i_s / n;
+        uint32_t v = i_sq / n - (m * m);
+
+        // Skip homogeneous regions.
+        if (v < (50 * 50)) {
+            continue;
+        }
 
-    if (sumw >= t) {
-        return cascade->alpha2_array[t_idx];
+        windows[count].x = x;
+        windows[count].std = fast_sqrtf(i_sq * n - (i_s * i_s));
+        count++;
     }
 
-    return cascade->alpha1_array[t_idx];
+    return count;
 }
 
-static int run_cascade_classifier(cascade_t *cascade, point_t pt) {
-    int win_w = cascade->window.w;
-    int win_h = cascade->window.h;
-    uint32_t n = (win_w * win_h);
-    uint32_t i_s = imlib_integral_mw_lookup(cascade->sum, pt.x, 0, win_w, win_h);
-    uint32_t i_sq = imlib_integral_mw_lookup(cascade->ssq, pt.x, 0, win_w, win_h);
-    uint32_t m = i_s / n;
-    uint32_t v = i_sq / n - (m * m);
-
-    // Skip homogeneous regions.
-    if (v < (50 * 50)) {
-        return 0;
-    }
+// Runs the cascade on all windows of a row, one stage at a time. Each feature is decoded once
+// per row and then evaluated on every window still alive, and the windows rejected by a stage
+// are dropped before the next one. Returns the number of windows left, which are the objects.
+static int haar_run_stages(cascade_t *cascade, haar_window_t *windows, int count) {
+    uint32_t **sum = cascade->sum->data;
+
+    for (int i = 0, w_idx = 0, r_idx = 0, t_idx = 0; (i < cascade->n_stages) && count; i++) {
+        for (int k = 0; k < count; k++) {
+            windows[k].stage_sum = 0;
+        }
 
-    cascade->std = fast_sqrtf(i_sq * n - (i_s * i_s));
-    for (int i = 0, w_idx = 0, r_idx = 0, t_idx = 0; i < cascade->n_stages; i++) {
-        int stage_sum = 0;
         for (int j = 0; j < cascade->stages_array[i]; j++, t_idx++) {
-            // Send the shifted window to a haar filter
-            stage_sum += eval_weak_classifier(cascade, pt, t_idx, w_idx, r_idx);
-            w_idx += cascade->num_rectangles_array[t_idx];
-            r_idx += cascade->num_rectangles_array[t_idx] * 4;
+            for (int k = 0; k < count; k++) {
+                windows[k].sumw = 0;
+            }
+
+            for (int r = 0; r < cascade->num_rectangles_array[t_idx]; r++, w_idx++, r_idx += 4) {
+                int x = cascade->rectangles_array[r_idx + 0];
+                int y = cascade->rectangles_array[r_idx + 1];
+                int w = cascade->rectangles_array[r_idx + 2];
+                int h = cascade->rectangles_array[r_idx + 3];
+                int32_t weight = cascade->weights_array[w_idx] << 12;
+                uint32_t *top = sum[y], *bottom = sum[y + h];
+
+                for (int k = 0; k < count; k++) {
+                    int wx = windows[k].x + x;
+                    windows[k].sumw += (int32_t) (bottom[wx + w] + top[wx] - top[wx + w] - bottom[wx]) * weight;
+                }
+            }
+
+            // The node threshold is multiplied by the standard deviation of the sub window
+            int16_t t = cascade->tree_thresh_array[t_idx];
+            int16_t alpha1 = cascade->alpha1_array[t_idx];
+            int16_t alpha2 = cascade->alpha2_array[t_idx];
+
+            for (int k = 0; k < count; k++) {
+                windows[k].stage_sum += (windows[k].sumw >= (t * windows[k].std)) ? alpha2 : alpha1;
+            }
         }
+
         // If the sum is below the stage threshold, no objects were detected
-        if (stage_sum < (cascade->threshold * cascade->stages_thresh_array[i])) {
-            return 0;
+        float stage_thresh = cascade->threshold * cascade->stages_thresh_array[i];
+        int alive = 0;
+
+        for (int k = 0; k < count; k++) {
+            if (!(windows[k].stage_sum < stage_thresh)) {
+                windows[alive++] = windows[k];
+            }
         }
+
+        count = alive;
     }
-    return 1;
+
+    return count;
 }
 
-array_t *imlib_detect_objects(image_t *image, cascade_t *cascade, rectangle_t *roi) {
+array_t *imlib_detect_objects(image_t *image, cascade_t *cascade, rectangle_t *roi, image_pyramid_t *pyramid) {
     // Integral images
     mw_image_t sum;
     mw_image_t ssq;
@@ -105,8 +144,18 @@ array_t *imlib_detect_objects(image_t *image, cascade_t *cascade, rectangle_t *r
     imlib_integral_mw_alloc(&sum, roi->w, cascade->window.h + 1);
     imlib_integral_mw_alloc(&ssq, roi->w, cascade->window.h + 1);
 
+    // One row of windows, there are never more than the scaled width.
+    haar_window_t *windows = fb_alloc(roi->w * sizeof(haar_window_t), FB_ALLOC_NO_HINT);
+
+    // A shared pyramid can only stand in for the whole image at the same scale factor.
+    if (pyramid && ((pyramid->scale_factor != cascade->scale_factor)
+                    || roi->x || roi->y || (roi->w != image->w) || (roi->h != image->h))) {
+        pyramid = NULL;
+    }
+
     // Iterate over the image pyramid
-    for (float factor = 1.0f; ; factor *= cascade->scale_factor) {
+    int level = 0;
+    for (float factor = 1.0f; ; factor *= cascade->scale_factor, level++) {
         // Set the scaled width and height
         int szw = roi->w / factor;
         int szh = roi->h / factor;
@@ -116,12 +165,23 @@ array_t *imlib_detect_objects(image_t *image, cascade_t *cascade, rectangle_t *r
             break;
         }
 
+        // Pyramid levels of the same size hold the pixels sampling the image would give, and
+        // are summed without scaling (or converting to grayscale).
+        image_t *src = image;
+        rectangle_t src_roi = *roi;
+        image_t *src_level = pyramid ? imlib_pyramid_get_level(pyramid, level) : NULL;
+
+        if (src_level && (src_level->w == szw) && (src_level->h == szh)) {
+            src = src_level;
+            rectangle_init(&src_roi, 0, 0, szw, szh);
+        }
+
         // Set the integral images scale
-        imlib_integral_mw_scale(roi, &sum, szw, szh);
-        imlib_integral_mw_scale(roi, &ssq, szw, szh);
+        imlib_integral_mw_scale(&src_roi, &sum, szw, szh);
+        imlib_integral_mw_scale(&src_roi, &ssq, szw, szh);
 
         // Compute new scaled integral images
-        imlib_integral_mw_ss(image, &sum, &ssq, roi);
+        imlib_integral_mw_ss(src, &sum, &ssq, &src_roi);
 
         // Scale the scanning step
         cascade->step = cascade->step / factor;
@@ -134,24 +194,25 @@ array_t *imlib_detect_objects(image_t *image, cascade_t *cascade, rectangle_t *r
 
         // Shift the filter window over the image.
         for (int y = 0; y < y2; y += cascade->step) {
-            for (int x = 0; x < x2; x += cascade->step) {
-                point_t p = {x, y};
-                // If an object is detected, record the coordinates of the filter window
-                if (run_cascade_classifier(cascade, p) > 0) {
-                    array_push_back(objects,
-                                    rectangle_alloc(fast_roundf(x * factor) + roi->x, fast_roundf(y * factor) + roi->y,
-                                                    fast_roundf(cascade->window.w * factor),
-                                                    fast_roundf(cascade->window.h * factor)));
-                }
+            int count = haar_run_stages(cascade, windows, haar_row_windows(cascade, x2, windows));
+
+            // Record the coordinates of the filter windows where an object was detected
+            for (int k = 0; k < count; k++) {
+                array_push_back(objects,
+                                rectangle_alloc(fast_roundf(windows[k].x * factor) + roi->x,
+                                                fast_roundf(y * factor) + roi->y,
+                                                fast_roundf(cascade->window.w * factor),
+                                                fast_roundf(cascade->window.h * factor)));
             }
 
             // If not last line, shift integral images
             if ((y + cascade->step) < y2) {
-                imlib_integral_mw_shift_ss(image, &sum, &ssq, roi, cascade->step);
+                imlib_integral_mw_shift_ss(src, &sum, &ssq, &src_roi, cascade->step);
             }
         }
     }
 
+    fb_free(); // windows
     imlib_integral_mw_free(&ssq);
     imlib_integral_mw_free(&sum);
 
@@ -163,13 +224,91 @@ array_t *imlib_detect_objects(image_t *image, cascade_t *cascade, rectangle_t *r
     return objects;
 }
 
+int imlib_load_cascade_from_buffer(cascade_t *cascade, const void *data, size_t size) {
+    const cascade_packed_t *packed = data;
+
+    if ((size < sizeof(cascade_packed_t)) || (((uintptr_t) data) % 4)
+        || (packed->magic != CASCADE_PACKED_MAGIC) || (packed->version != CASCADE_PACKED_VERSION)
+        || (packed->n_features > size) || (packed->n_rectangles > size)) {
+        return -1;
+    }
+
+    const uint32_t arrays[][2] = {
+        { packed->stages_offset, packed->n_stages * sizeof(uint8_t) },
+        { packed->stages_thresh_offset, packed->n_stages * sizeof(int16_t) },
+        { packed->tree_thresh_offset, packed->n_features * sizeof(int16_t) },
+        { packed->alpha1_offset, packed->n_features * sizeof(int16_t) },
+        { packed->alpha2_offset, packed->n_features * sizeof(int16_t) },
+        { packed->num_rectangles_offset, packed->n_features * sizeof(int8_t) },
+        { packed->weights_offset, packed->n_rectangles * sizeof(int8_t) },
+        { packed->rectangles_offset, packed->n_rectangles * sizeof(int8_t) * 4 },
+    };
+
+    for (size_t i = 0; i < (sizeof(arrays) / sizeof(arrays[0])); i++) {
+        if ((arrays[i][0] % 4) || (arrays[i][0] > size) || (arrays[i][1] > (size - arrays[i][0]))) {
+            return -1;
+        }
+    }
+
+    const uint8_t *base = data;
+    cascade->window.w = packed->window_w;
+    cascade->window.h = packed->window_h;
+    cascade->n_stages = packed->n_stages;
+    cascade->n_features = packed->n_features;
+    cascade->n_rectangles = packed->n_rectangles;
+    cascade->stages_array = (uint8_t *) (base + packed->stages_offset);
+    cascade->stages_thresh_array = (int16_t *) (base + packed->stages_thresh_offset);
+    cascade->tree_thresh_array = (int16_t *) (base + packed->tree_thresh_offset);
+    cascade->alpha1_array = (int16_t *) (base + packed->alpha1_offset);
+    cascade->alpha2_array = (int16_t *) (base + packed->alpha2_offset);
+    cascade->num_rectangles_array = (int8_t *) (base + packed->num_rectangles_offset);
+    cascade->weights_array = (int8_t *) (base + packed->weights_offset);
+    cascade->rectangles_array = (int8_t *) (base + packed->rectangles_offset);
+    cascade->data = NULL;
+
+    // The counts must match the arrays, the detector trusts them.
+    uint32_t n_features = 0, n_rectangles = 0;
+
+    for (int i = 0; i < cascade->n_stages; i++) {
+        n_features += cascade->stages_array[i];
+    }
+
+    for (int i = 0; (i < cascade->n_features) && (n_features == cascade->n_features); i++) {
+        n_rectangles += cascade->num_rectangles_array[i];
+    }
+
+    return ((n_features == cascade->n_features) && (n_rectangles == cascade->n_rectangles)) ? 0 : -1;
+}
+
 #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
 int imlib_load_cascade_from_file(cascade_t *cascade, const char *path) {
     int i;
     FIL fp;
     FRESULT res = FR_OK;
+    uint32_t magic;
+
+    file_open(&fp, path, false, FA_READ | FA_OPEN_EXISTING);
+    file_read(&fp, &magic, sizeof(magic));
 
-    file_open(&fp, path, true, FA_READ | FA_OPEN_EXISTING);
+    if (magic == CASCADE_PACKED_MAGIC) {
+        // Packed cascades are read with a single read and used in place.
+        uint32_t size = file_size(&fp);
+        void *data = xalloc(size);
+        file_seek(&fp, 0);
+        file_read(&fp, data, size);
+
+        if (imlib_load_cascade_from_buffer(cascade, data, size) != 0) {
+            xfree(data);
+            file_raise_format(&fp);
+        }
+
+        cascade->data = data;
+        file_close(&fp);
+        return FR_OK;
+    }
+
+    file_seek(&fp, 0);
+    file_buffer_on(&fp);
 
     // Read detection window size
     file_read(&fp, &cascade->window, sizeof(cascade->window));
@@ -249,6 +388,8 @@ error:
 #endif //(IMLIB_ENABLE_IMAGE_FILE_IO)
 
 int imlib_load_cascade(cascade_t *cascade, const char *path) {
+    cascade->data = NULL;
+
     // built-in cascade
     if (0) {
     #ifdef IMLIB_ENABLE_FEATURES_BUILTIN_FACE_CASCADE
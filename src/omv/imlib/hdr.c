@@ -0,0 +1,124 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Exposure fusion of bracketed frames.
+ */
+#include <math.h>
+#include "imlib.h"
+#include "fb_alloc.h"
+
+// Weight of a pixel's brightness, highest at mid-gray (Mertens sigma 0.2), Q8.
+static void hdr_exposedness_table(uint16_t *table) {
+    for (int i = 0; i < 256; i++) {
+        float d = (i - 128) / (0.2f * 255.0f);
+        table[i] = fast_roundf(expf(-0.5f * d * d) * 256.0f);
+    }
+}
+
+// Luminance of one row of a frame, rows off the image are clamped.
+static uint8_t *hdr_luma_row(image_t *img, int y, uint8_t *row) {
+    y = IM_CLAMP(y, 0, img->h - 1);
+
+    if (img->pixfmt == PIXFORMAT_GRAYSCALE) {
+        return IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+    }
+
+    uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+    for (int x = 0; x < img->w; x++) {
+        row[x] = COLOR_RGB565_TO_Y(row_ptr[x]);
+    }
+
+    return row;
+}
+
+// Per-pixel weights of one row: well-exposedness times (1 + local contrast). The weights are
+// Mertens' without the saturation term and are not blended across a pyramid.
+static void hdr_weight_row(image_t *img, int y, uint16_t *table, uint8_t *luma, uint32_t *weights) {
+    uint8_t *r0 = hdr_luma_row(img, y - 1, luma);
+    uint8_t *r1 = hdr_luma_row(img, y, luma + img->w);
+    uint8_t *r2 = hdr_luma_row(img, y + 1, luma + (img->w * 2));
+
+    for (int x = 0; x < img->w; x++) {
+        int l = r1[IM_MAX(x - 1, 0)];
+        int r = r1[IM_MIN(x + 1, img->w - 1)];
+        int laplacian = abs((r1[x] * 4) - l - r - r0[x] - r2[x]);
+        weights[x] = (table[r1[x]] * (laplacian + 1)) + 1;
+    }
+}
+
+void imlib_hdr_fuse(image_t *img, image_t *frames, int n) {
+    uint16_t table[256];
+    hdr_exposedness_table(table);
+
+    fb_alloc_mark();
+    size_t row_size = img->w * ((img->pixfmt == PIXFORMAT_GRAYSCALE) ? sizeof(uint8_t) : sizeof(uint16_t));
+    uint8_t *luma = fb_alloc(img->w * 3, FB_ALLOC_NO_HINT);
+    uint8_t *rows = fb_alloc(row_size * 2, FB_ALLOC_NO_HINT);
+    uint32_t *weights = fb_alloc(img->w * sizeof(uint32_t) * (n + 1), FB_ALLOC_NO_HINT);
+
+    for (int y = 0; y < img->h; y++) {
+        hdr_weight_row(img, y, table, luma, weights);
+
+        for (int i = 0; i < n; i++) {
+            hdr_weight_row(&frames[i], y, table, luma, weights + (img->w * (i + 1)));
+        }
+
+        // Fused rows are written back one row late since the weights of the next row still
+        // need this row of img.
+        if (img->pixfmt == PIXFORMAT_GRAYSCALE) {
+            uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+            uint8_t *out = rows + ((y & 1) * row_size);
+
+            for (int x = 0; x < img->w; x++) {
+                uint32_t sum_w = weights[x];
+                uint32_t sum = sum_w * row_ptr[x];
+
+                for (int i = 0; i < n; i++) {
+                    uint32_t w = weights[(img->w * (i + 1)) + x];
+                    sum_w += w;
+                    sum += w * IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&frames[i], y)[x];
+                }
+
+                out[x] = (sum + (sum_w / 2)) / sum_w;
+            }
+        } else {
+            uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+            uint16_t *out = (uint16_t *) (rows + ((y & 1) * row_size));
+
+            for (int x = 0; x < img->w; x++) {
+                uint32_t sum_w = weights[x];
+                int p = row_ptr[x];
+                uint32_t r = sum_w * COLOR_RGB565_TO_R5(p);
+                uint32_t g = sum_w * COLOR_RGB565_TO_G6(p);
+                uint32_t b = sum_w * COLOR_RGB565_TO_B5(p);
+
+                for (int i = 0; i < n; i++) {
+                    uint32_t w = weights[(img->w * (i + 1)) + x];
+                    int q = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(&frames[i], y)[x];
+                    sum_w += w;
+                    r += w * COLOR_RGB565_TO_R5(q);
+                    g += w * COLOR_RGB565_TO_G6(q);
+                    b += w * COLOR_RGB565_TO_B5(q);
+                }
+
+                uint32_t half = sum_w / 2;
+                out[x] = COLOR_R5_G6_B5_TO_RGB565((r + half) / sum_w, (g + half) / sum_w, (b + half) / sum_w);
+            }
+        }
+
+        if (y) {
+            memcpy(img->data + ((y - 1) * row_size), rows + (((y - 1) & 1) * row_size), row_size);
+        }
+    }
+
+    if (img->h) {
+        memcpy(img->data + ((img->h - 1) * row_size), rows + (((img->h - 1) & 1) * row_size), row_size);
+    }
+
+    fb_alloc_free_till_mark();
+}
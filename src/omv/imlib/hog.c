@@ -17,120 +17,151 @@
 #include "xalloc.h"
 
 #ifdef IMLIB_ENABLE_HOG
-#define N_BINS    (9)
-typedef struct bin {
-    int d;
-    int m;
-} bin_t;
-
-int bin_array_comp(const void *obj0, const void *obj1) {
-    const bin_t *b0 = obj0;
-    const bin_t *b1 = obj1;
-    if (b0->m < b1->m) {
-        return -1;
+#define N_BINS         (9)  // Unsigned orientations, 20 degrees per bin.
+#define BLOCK_CELLS    (2)  // Blocks are 2x2 cells.
+#define BLOCK_BINS     (BLOCK_CELLS * BLOCK_CELLS * N_BINS)
+
+// cos() and sin() of the bin boundaries (20, 40, ..., 160 degrees) in Q14.
+static const int16_t hog_bin_bounds[N_BINS - 1][2] = {
+    {15396, 5604}, {12551, 10531}, {8192, 14189}, {2845, 16135},
+    {-2845, 16135}, {-8192, 14189}, {-12551, 10531}, {-15396, 5604}
+};
+
+// Builds the orientation histogram of every cell of the roi in one pass over its rows. Each
+// cell is only computed once, so overlapping blocks and sliding windows just read the cells.
+static void hog_cells(image_t *src, rectangle_t *roi, int cell_size, int x_cells, int y_cells, uint32_t *cells) {
+    int s = src->w;
+
+    for (int y = roi->y, yy = roi->y + (y_cells * cell_size); y < yy; y++) {
+        if ((y <= 0) || (y >= (src->h - 1))) {
+            continue;
+        }
+
+        uint8_t *row = src->data + (y * s);
+        uint32_t *cell_row = cells + (((y - roi->y) / cell_size) * x_cells * N_BINS);
+
+        for (int x = IM_MAX(roi->x, 1), xx = IM_MIN(roi->x + (x_cells * cell_size), src->w - 1); x < xx; x++) {
+            int vx = row[x + 1] - row[x - 1];
+            int vy = row[x + s] - row[x - s];
+
+            // Fold the gradient into [0:180) degrees.
+            if ((vy < 0) || ((vy == 0) && (vx < 0))) {
+                vx = -vx;
+                vy = -vy;
+            }
+
+            int m = fast_roundf(fast_sqrtf((vx * vx) + (vy * vy)));
+            if (m <= 1) {
+                continue;
+            }
+
+            // The bin is the number of boundaries the gradient is counter-clockwise of.
+            int t = 0;
+            while ((t < (N_BINS - 1)) && (((hog_bin_bounds[t][0] * vy) - (hog_bin_bounds[t][1] * vx)) > 0)) {
+                t++;
+            }
+
+            cell_row[(((x - roi->x) / cell_size) * N_BINS) + t] += m;
+        }
     }
-    if (b0->m > b1->m) {
-        return 1;
+}
+
+// L2 normalizes the block of cells starting at cell (x, y) into 36 values in [0:255].
+static void hog_block(uint32_t *cells, int x_cells, int x, int y, uint8_t *out) {
+    float k = 0.0f;
+
+    for (int cy = 0; cy < BLOCK_CELLS; cy++) {
+        uint32_t *cell = cells + ((((y + cy) * x_cells) + x) * N_BINS);
+        for (int i = 0; i < (BLOCK_CELLS * N_BINS); i++) {
+            k += ((float) cell[i]) * cell[i];
+        }
+    }
+
+    float scale = (k > 0.0f) ? (255.0f / fast_sqrtf(k)) : 0.0f;
+
+    for (int cy = 0; cy < BLOCK_CELLS; cy++) {
+        uint32_t *cell = cells + ((((y + cy) * x_cells) + x) * N_BINS);
+        for (int i = 0; i < (BLOCK_CELLS * N_BINS); i++) {
+            *out++ = IM_MIN(fast_roundf(cell[i] * scale), COLOR_GRAYSCALE_MAX);
+        }
     }
+}
 
-    return 0;
+int imlib_hog_desc_size(rectangle_t *roi, int cell_size) {
+    int x_blocks = (roi->w / cell_size) - BLOCK_CELLS + 1;
+    int y_blocks = (roi->h / cell_size) - BLOCK_CELLS + 1;
+    return ((x_blocks > 0) && (y_blocks > 0)) ? (x_blocks * y_blocks * BLOCK_BINS) : 0;
 }
 
-void imlib_find_hog(image_t *src, rectangle_t *roi, int cell_size) {
-    int s = src->w;
-    int w = roi->x + roi->w - 1;
-    int h = roi->y + roi->h - 1;
-
-    int block_size = cell_size * 2;
-    int x_cells = (roi->w / cell_size);
-    int y_cells = (roi->h / cell_size);
-
-    // TODO: Assert row->w/h >= cell_size *2;
-    float *hog = fb_alloc0(x_cells * y_cells * N_BINS * sizeof *hog, FB_ALLOC_NO_HINT);
-
-    //2. Finding Image Gradients
-    for (int y = roi->y, hog_index = 0; y < h; y += block_size) {
-        for (int x = roi->x; x < w; x += block_size) {
-            float k = 0.0f;
-            for (int cy = 0; cy < block_size; cy++) {
-                for (int cx = 0; cx < block_size; cx++) {
-                    if ((y + cy) > 0 && (y + cy) < h && (x + cx) > 0 && (x + cx) < w) {
-                        // Find horizontal/vertical direction
-                        int vx = src->data[(y + cy + 0) * s + (x + cx + 1)] - src->data[(y + cy - 0) * s + (x + cx - 1)];
-                        int vy = src->data[(y + cy + 1) * s + (x + cx + 0)] - src->data[(y + cy - 1) * s + (x + cx - 0)];
-                        // Find magnitude
-                        float m = fast_sqrtf(vx * vx + vy * vy);
-                        if (((int) m) > 1) {
-                            k += m * m;
-                            // Find and quantize gradient degree
-                            // TODO atan2f is swapped for visualization
-                            int t = ((int) fast_fabsf((atan2f(vx, vy) * 180.0f / M_PI))) / 20;
-                            t = (t == 9)? 0 : t;
-
-                            // hog[((cy/cell_size) * x_cells + (cx/cell_size)) * N_BINS + t] += m;
-                            hog[hog_index + (((cy / 8) * 2 + (cx / 8)) * N_BINS) + t] += m;
-                        }
-                    }
-                }
-            }
+// Writes the descriptor of the roi: blocks at a stride of one cell in row major order, each as
+// 2 rows of 2 cells of 9 bins. The descriptor of a window inside the roi aligned to the cells is
+// the matching sub-grid of blocks, so sliding windows only need the roi to be computed once.
+void imlib_hog_desc(image_t *src, rectangle_t *roi, int cell_size, uint8_t *desc) {
+    int x_cells = roi->w / cell_size;
+    int y_cells = roi->h / cell_size;
 
-            // Normalize the last block
-            k = sqrtf(k);
-            for (int i = hog_index; i < (hog_index + (N_BINS * 4)); i++) {
-                hog[i] = hog[i] / k;
-            }
+    if (!imlib_hog_desc_size(roi, cell_size)) {
+        return;
+    }
 
-            hog_index += (N_BINS * 4);
+    uint32_t *cells = fb_alloc0(x_cells * y_cells * N_BINS * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    hog_cells(src, roi, cell_size, x_cells, y_cells, cells);
+
+    for (int y = 0; y <= (y_cells - BLOCK_CELLS); y++) {
+        for (int x = 0; x <= (x_cells - BLOCK_CELLS); x++, desc += BLOCK_BINS) {
+            hog_block(cells, x_cells, x, y, desc);
         }
     }
 
-    memset(src->pixels, 0, src->w * src->h);
+    fb_free(); // cells
+}
 
-    array_t *gds;
-    bin_t bins[9];
-    array_alloc(&gds, NULL);
+void imlib_find_hog(image_t *src, rectangle_t *roi, int cell_size) {
+    int x_cells = roi->w / cell_size;
+    int y_cells = roi->h / cell_size;
 
-    for (int i = 0; i < N_BINS; i++) {
-        array_push_back(gds, &bins[i]);
+    if ((x_cells < BLOCK_CELLS) || (y_cells < BLOCK_CELLS)) {
+        return;
     }
 
-    int l = cell_size / 2;
-    // Note cells are not ordered histograms of 4 cells
-    for (int by = 0, hog_index = 0; by < y_cells; by += 2) {
-        for (int bx = 0; bx < x_cells; bx += 2) {
-            for (int y = 0; y < 2; y++) {
-                for (int x = 0; x < 2; x++) {
-                    // Sort and draw bins
-                    for (int i = hog_index; i < hog_index + N_BINS; i++) {
-                        int m = (int) (hog[i] * 255);
-                        if (m > 255) {
-                            m = 255;
-                        } else if (m < 0) {
-                            m = 0;
-                        }
-                        bin_t *bin = array_at(gds, (i % N_BINS));
-                        bin->m = m;
-                        bin->d = ((i % N_BINS) * 20);
-                    }
+    uint32_t *cells = fb_alloc0(x_cells * y_cells * N_BINS * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    hog_cells(src, roi, cell_size, x_cells, y_cells, cells);
 
-                    array_sort(gds, bin_array_comp);
+    memset(src->pixels, 0, src->w * src->h);
 
-                    int x1 = (x + bx) * cell_size + l;
-                    int y1 = (y + by) * cell_size + l;
-                    for (int i = 0; i < N_BINS; i++) {
-                        bin_t *bin = array_at(gds, i);
-                        int x2 = l * cos_table[bin->d];
-                        int y2 = l * sin_table[bin->d];
-                        imlib_draw_line(src, (x1 - x2), (y1 + y2), (x1 + x2), (y1 - y2), bin->m, 1);
+    // Visualization uses non-overlapping blocks.
+    int l = cell_size / 2;
+    for (int by = 0; by <= (y_cells - BLOCK_CELLS); by += BLOCK_CELLS) {
+        for (int bx = 0; bx <= (x_cells - BLOCK_CELLS); bx += BLOCK_CELLS) {
+            uint8_t block[BLOCK_BINS];
+            hog_block(cells, x_cells, bx, by, block);
+
+            for (int i = 0; i < (BLOCK_CELLS * BLOCK_CELLS); i++) {
+                uint8_t *bins = block + (i * N_BINS);
+                int order[N_BINS];
+
+                // Draw the strongest bins last so they stay on top.
+                for (int j = 0; j < N_BINS; j++) {
+                    int k = j;
+                    for (; (k > 0) && (bins[order[k - 1]] > bins[j]); k--) {
+                        order[k] = order[k - 1];
                     }
+                    order[k] = j;
+                }
 
-                    hog_index += N_BINS;
+                int x1 = roi->x + ((bx + (i % BLOCK_CELLS)) * cell_size) + l;
+                int y1 = roi->y + ((by + (i / BLOCK_CELLS)) * cell_size) + l;
+                for (int j = 0; j < N_BINS; j++) {
+                    // Lines follow the edge, which is perpendicular to the bin's gradient.
+                    int d = (260 - (order[j] * 20)) % 180;
+                    int x2 = l * cos_table[d];
+                    int y2 = l * sin_table[d];
+                    imlib_draw_line(src, (x1 - x2), (y1 + y2), (x1 + x2), (y1 - y2), bins[order[j]], 1);
                 }
             }
         }
     }
 
-    xfree(gds);
-    fb_free();
+    fb_free(); // cells
 }
 #endif // IMLIB_ENABLE_HOG
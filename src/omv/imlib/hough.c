@@ -12,9 +12,14 @@
 
 #ifdef IMLIB_ENABLE_FIND_LINES
 void imlib_find_lines(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int x_stride, unsigned int y_stride,
-                      uint32_t threshold, unsigned int theta_margin, unsigned int rho_margin) {
+                      uint32_t threshold, unsigned int theta_margin, unsigned int rho_margin, pool_t *pool) {
     int r_diag_len, r_diag_len_div, theta_size, r_size, hough_divide = 1; // divides theta and rho accumulators
 
+    // Sobel gradients of one row (and its grayscale lines for binary/rgb565 images).
+    uint8_t *lines = fb_alloc(roi->w * 3, FB_ALLOC_NO_HINT);
+    int16_t *gx = fb_alloc(roi->w * sizeof(int16_t), FB_ALLOC_NO_HINT);
+    int16_t *gy = fb_alloc(roi->w * sizeof(int16_t), FB_ALLOC_NO_HINT);
+
     for (;;) {
         // shrink to fit...
         r_diag_len = fast_roundf(fast_sqrtf((roi->w * roi->w) + (roi->h * roi->h)));
@@ -32,220 +37,26 @@ void imlib_find_lines(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
 
     uint32_t *acc = fb_alloc0(sizeof(uint32_t) * theta_size * r_size, FB_ALLOC_NO_HINT);
 
-    switch (ptr->pixfmt) {
-        case PIXFORMAT_BINARY: {
-            for (int y = roi->y + 1, yy = roi->y + roi->h - 1; y < yy; y += y_stride) {
-                uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(ptr, y);
-                for (int x = roi->x + (y % x_stride) + 1, xx = roi->x + roi->w - 1; x < xx; x += x_stride) {
-                    int pixel; // Sobel Algorithm Below
-                    int x_acc = 0;
-                    int y_acc = 0;
-
-                    row_ptr -= ((ptr->w + UINT32_T_MASK) >> UINT32_T_SHIFT);
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x - 1));
-                    x_acc += pixel * +1; // x[0,0] -> pixel * +1
-                    y_acc += pixel * +1; // y[0,0] -> pixel * +1
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x));
-                    // x[0,1] -> pixel * 0
-                    y_acc += pixel * +2; // y[0,1] -> pixel * +2
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x + 1));
-                    x_acc += pixel * -1; // x[0,2] -> pixel * -1
-                    y_acc += pixel * +1; // y[0,2] -> pixel * +1
-
-                    row_ptr += ((ptr->w + UINT32_T_MASK) >> UINT32_T_SHIFT);
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x - 1));
-                    x_acc += pixel * +2; // x[1,0] -> pixel * +2
-                                         // y[1,0] -> pixel * 0
-
-                    // pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x));
-                    // x[1,1] -> pixel * 0
-                    // y[1,1] -> pixel * 0
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x + 1));
-                    x_acc += pixel * -2; // x[1,2] -> pixel * -2
-                                         // y[1,2] -> pixel * 0
-
-                    row_ptr += ((ptr->w + UINT32_T_MASK) >> UINT32_T_SHIFT);
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x - 1));
-                    x_acc += pixel * +1; // x[2,0] -> pixel * +1
-                    y_acc += pixel * -1; // y[2,0] -> pixel * -1
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x));
-                    // x[2,1] -> pixel * 0
-                    y_acc += pixel * -2; // y[2,1] -> pixel * -2
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x + 1));
-                    x_acc += pixel * -1; // x[2,2] -> pixel * -1
-                    y_acc += pixel * -1; // y[2,2] -> pixel * -1
-
-                    row_ptr -= ((ptr->w + UINT32_T_MASK) >> UINT32_T_SHIFT);
-
-                    int mag = (abs(x_acc) + abs(y_acc)) / 2;
-                    if (mag < 126) {
-                        continue;
-                    }
-
-                    int theta = fast_roundf((x_acc ? fast_atan2f(y_acc, x_acc) : 1.570796f) * 57.295780) % 180; // * (180 / PI)
-                    if (theta < 0) {
-                        theta += 180;
-                    }
-                    int rho = (fast_roundf(((x - roi->x) * cos_table[theta]) +
-                                           ((y - roi->y) * sin_table[theta])) / hough_divide) + r_diag_len_div;
-                    int acc_index = (rho * theta_size) + ((theta / hough_divide) + 1); // add offset
-                    acc[acc_index] += mag;
-                }
-            }
-            break;
-        }
-        case PIXFORMAT_GRAYSCALE: {
-            for (int y = roi->y + 1, yy = roi->y + roi->h - 1; y < yy; y += y_stride) {
-                uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(ptr, y);
-                for (int x = roi->x + (y % x_stride) + 1, xx = roi->x + roi->w - 1; x < xx; x += x_stride) {
-                    int pixel; // Sobel Algorithm Below
-                    int x_acc = 0;
-                    int y_acc = 0;
-
-                    row_ptr -= ptr->w;
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x - 1);
-                    x_acc += pixel * +1; // x[0,0] -> pixel * +1
-                    y_acc += pixel * +1; // y[0,0] -> pixel * +1
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
-                    // x[0,1] -> pixel * 0
-                    y_acc += pixel * +2; // y[0,1] -> pixel * +2
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x + 1);
-                    x_acc += pixel * -1; // x[0,2] -> pixel * -1
-                    y_acc += pixel * +1; // y[0,2] -> pixel * +1
-
-                    row_ptr += ptr->w;
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x - 1);
-                    x_acc += pixel * +2; // x[1,0] -> pixel * +2
-                                         // y[1,0] -> pixel * 0
-
-                    // pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
-                    // x[1,1] -> pixel * 0
-                    // y[1,1] -> pixel * 0
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x + 1);
-                    x_acc += pixel * -2; // x[1,2] -> pixel * -2
-                                         // y[1,2] -> pixel * 0
-
-                    row_ptr += ptr->w;
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x - 1);
-                    x_acc += pixel * +1; // x[2,0] -> pixel * +1
-                    y_acc += pixel * -1; // y[2,0] -> pixel * -1
+    for (int y = roi->y + 1, yy = roi->y + roi->h - 1; y < yy; y += y_stride) {
+        imlib_sobel_row(ptr, y, roi->x + 1, roi->x + roi->w - 1, lines, gx, gy);
+        for (int x = roi->x + (y % x_stride) + 1, xx = roi->x + roi->w - 1; x < xx; x += x_stride) {
+            int x_acc = gx[x - roi->x - 1];
+            int y_acc = gy[x - roi->x - 1];
 
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
-                    // x[2,1] -> pixel * 0
-                    y_acc += pixel * -2; // y[2,1] -> pixel * -2
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x + 1);
-                    x_acc += pixel * -1; // x[2,2] -> pixel * -1
-                    y_acc += pixel * -1; // y[2,2] -> pixel * -1
-
-                    row_ptr -= ptr->w;
-
-                    int mag = (abs(x_acc) + abs(y_acc)) / 2;
-                    if (mag < 126) {
-                        continue;
-                    }
-
-                    int theta = fast_roundf((x_acc ? fast_atan2f(y_acc, x_acc) : 1.570796f) * 57.295780) % 180; // * (180 / PI)
-                    if (theta < 0) {
-                        theta += 180;
-                    }
-                    int rho = (fast_roundf(((x - roi->x) * cos_table[theta]) +
-                                           ((y - roi->y) * sin_table[theta])) / hough_divide) + r_diag_len_div;
-                    int acc_index = (rho * theta_size) + ((theta / hough_divide) + 1); // add offset
-                    acc[acc_index] += mag;
-                }
+            int mag = (abs(x_acc) + abs(y_acc)) / 2;
+            if (mag < 126) {
+                continue;
             }
-            break;
-        }
-        case PIXFORMAT_RGB565: {
-            for (int y = roi->y + 1, yy = roi->y + roi->h - 1; y < yy; y += y_stride) {
-                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(ptr, y);
-                for (int x = roi->x + (y % x_stride) + 1, xx = roi->x + roi->w - 1; x < xx; x += x_stride) {
-                    int pixel; // Sobel Algorithm Below
-                    int x_acc = 0;
-                    int y_acc = 0;
-
-                    row_ptr -= ptr->w;
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x - 1));
-                    x_acc += pixel * +1; // x[0,0] -> pixel * +1
-                    y_acc += pixel * +1; // y[0,0] -> pixel * +1
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
-                    // x[0,1] -> pixel * 0
-                    y_acc += pixel * +2; // y[0,1] -> pixel * +2
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x + 1));
-                    x_acc += pixel * -1; // x[0,2] -> pixel * -1
-                    y_acc += pixel * +1; // y[0,2] -> pixel * +1
-
-                    row_ptr += ptr->w;
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x - 1));
-                    x_acc += pixel * +2; // x[1,0] -> pixel * +2
-                                         // y[1,0] -> pixel * 0
 
-                    // pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
-                    // x[1,1] -> pixel * 0
-                    // y[1,1] -> pixel * 0
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x + 1));
-                    x_acc += pixel * -2; // x[1,2] -> pixel * -2
-                                         // y[1,2] -> pixel * 0
-
-                    row_ptr += ptr->w;
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x - 1));
-                    x_acc += pixel * +1; // x[2,0] -> pixel * +1
-                    y_acc += pixel * -1; // y[2,0] -> pixel * -1
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
-                    // x[2,1] -> pixel * 0
-                    y_acc += pixel * -2; // y[2,1] -> pixel * -2
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x + 1));
-                    x_acc += pixel * -1; // x[2,2] -> pixel * -1
-                    y_acc += pixel * -1; // y[2,2] -> pixel * -1
-
-                    row_ptr -= ptr->w;
-
-                    int mag = (abs(x_acc) + abs(y_acc)) / 2;
-                    if (mag < 126) {
-                        continue;
-                    }
-
-                    int theta = fast_roundf((x_acc ? fast_atan2f(y_acc, x_acc) : 1.570796f) * 57.295780) % 180; // * (180 / PI)
-                    if (theta < 0) {
-                        theta += 180;
-                    }
-                    int rho = (fast_roundf(((x - roi->x) * cos_table[theta]) +
-                                           ((y - roi->y) * sin_table[theta])) / hough_divide) + r_diag_len_div;
-                    int acc_index = (rho * theta_size) + ((theta / hough_divide) + 1); // add offset
-                    acc[acc_index] += mag;
-                }
-            }
-            break;
-        }
-        default: {
-            break;
+            int theta = (x_acc ? fast_atan2_deg(y_acc, x_acc) : 90) % 180;
+            int rho = (fast_roundf(((x - roi->x) * cos_table[theta]) +
+                                   ((y - roi->y) * sin_table[theta])) / hough_divide) + r_diag_len_div;
+            int acc_index = (rho * theta_size) + ((theta / hough_divide) + 1); // add offset
+            acc[acc_index] += mag;
         }
     }
 
-    list_init(out, sizeof(find_lines_list_lnk_data_t));
+    list_init_pool(out, sizeof(find_lines_list_lnk_data_t), pool);
 
     for (int y = 1, yy = r_size - 1; y < yy; y++) {
         uint32_t *row_ptr = acc + (theta_size * y);
@@ -274,13 +85,16 @@ void imlib_find_lines(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
     }
 
     fb_free(); // acc
+    fb_free(); // gy
+    fb_free(); // gx
+    fb_free(); // lines
 
     for (;;) {
         // Merge overlapping.
         bool merge_occured = false;
 
         list_t out_temp;
-        list_init(&out_temp, sizeof(find_lines_list_lnk_data_t));
+        list_init_pool(&out_temp, sizeof(find_lines_list_lnk_data_t), out->pool);
 
         while (list_size(out)) {
             find_lines_list_lnk_data_t lnk_line;
@@ -392,7 +206,7 @@ void imlib_find_line_segments(list_t *out, image_t *ptr, rectangle_t *roi, unsig
     const unsigned int max_gap_pixels = 5;
 
     list_t temp_out;
-    imlib_find_lines(&temp_out, ptr, roi, x_stride, y_stride, threshold, theta_margin, rho_margin);
+    imlib_find_lines(&temp_out, ptr, roi, x_stride, y_stride, threshold, theta_margin, rho_margin, NULL);
     list_init(out, sizeof(find_lines_list_lnk_data_t));
 
     const int r_diag_len = fast_roundf(fast_sqrtf((roi->w * roi->w) + (roi->h * roi->h))) * 2;
@@ -483,213 +297,57 @@ void imlib_find_line_segments(list_t *out, image_t *ptr, rectangle_t *roi, unsig
 #endif //IMLIB_ENABLE_FIND_LINE_SEGMENTS
 
 #ifdef IMLIB_ENABLE_FIND_CIRCLES
+// Circle edges are packed as x (12 bits, ROIs up to 4096 wide), theta (9 bits) and magnitude (11 bits). Sobel
+// gradients of 8-bit pixels are at most 1020 per axis, so the magnitude is at most 1443.
+#define HOUGH_EDGE_PACK(x, theta, magnitude)    ((((uint32_t) (x)) << 20) | ((theta) << 11) | IM_MIN((magnitude), 0x7FF))
+#define HOUGH_EDGE_X(edge)                      ((edge) >> 20)
+#define HOUGH_EDGE_THETA(edge)                  (((edge) >> 11) & 0x1FF)
+#define HOUGH_EDGE_MAGNITUDE(edge)              ((edge) & 0x7FF)
+
 void imlib_find_circles(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int x_stride, unsigned int y_stride,
                         uint32_t threshold, unsigned int x_margin, unsigned int y_margin, unsigned int r_margin,
                         unsigned int r_min, unsigned int r_max, unsigned int r_step) {
-    uint16_t *theta_acc = fb_alloc0(sizeof(uint16_t) * roi->w * roi->h, FB_ALLOC_NO_HINT);
-    uint16_t *magnitude_acc = fb_alloc0(sizeof(uint16_t) * roi->w * roi->h, FB_ALLOC_NO_HINT);
-
-    switch (ptr->pixfmt) {
-        case PIXFORMAT_BINARY: {
-            for (int y = roi->y + 1, yy = roi->y + roi->h - 1; y < yy; y += y_stride) {
-                uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(ptr, y);
-                for (int x = roi->x + (y % x_stride) + 1, xx = roi->x + roi->w - 1; x < xx; x += x_stride) {
-                    int pixel; // Sobel Algorithm Below
-                    int x_acc = 0;
-                    int y_acc = 0;
-
-                    row_ptr -= ((ptr->w + UINT32_T_MASK) >> UINT32_T_SHIFT);
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x - 1));
-                    x_acc += pixel * +1; // x[0,0] -> pixel * +1
-                    y_acc += pixel * +1; // y[0,0] -> pixel * +1
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x));
-                    // x[0,1] -> pixel * 0
-                    y_acc += pixel * +2; // y[0,1] -> pixel * +2
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x + 1));
-                    x_acc += pixel * -1; // x[0,2] -> pixel * -1
-                    y_acc += pixel * +1; // y[0,2] -> pixel * +1
-
-                    row_ptr += ((ptr->w + UINT32_T_MASK) >> UINT32_T_SHIFT);
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x - 1));
-                    x_acc += pixel * +2; // x[1,0] -> pixel * +2
-                                         // y[1,0] -> pixel * 0
-
-                    // pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x));
-                    // x[1,1] -> pixel * 0
-                    // y[1,1] -> pixel * 0
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x + 1));
-                    x_acc += pixel * -2; // x[1,2] -> pixel * -2
-                                         // y[1,2] -> pixel * 0
-
-                    row_ptr += ((ptr->w + UINT32_T_MASK) >> UINT32_T_SHIFT);
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x - 1));
-                    x_acc += pixel * +1; // x[2,0] -> pixel * +1
-                    y_acc += pixel * -1; // y[2,0] -> pixel * -1
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x));
-                    // x[2,1] -> pixel * 0
-                    y_acc += pixel * -2; // y[2,1] -> pixel * -2
-
-                    pixel = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x + 1));
-                    x_acc += pixel * -1; // x[2,2] -> pixel * -1
-                    y_acc += pixel * -1; // y[2,2] -> pixel * -1
-
-                    row_ptr -= ((ptr->w + UINT32_T_MASK) >> UINT32_T_SHIFT);
-
-                    int theta = fast_roundf((x_acc ? fast_atan2f(y_acc, x_acc) : 1.570796f) * 57.295780) % 360; // * (180 / PI)
-                    if (theta < 0) {
-                        theta += 360;
-                    }
-                    int magnitude = fast_roundf(fast_sqrtf((x_acc * x_acc) + (y_acc * y_acc)));
-                    int index = (roi->w * (y - roi->y)) + (x - roi->x);
-
-                    theta_acc[index] = theta;
-                    magnitude_acc[index] = magnitude;
-                }
-            }
-            break;
+    // Edges with a non-zero gradient are kept row by row in a compact list instead of dense
+    // theta/magnitude maps, so each radius only visits sampled edge pixels.
+    size_t edges_max = ((roi->w + x_stride - 1) / x_stride) * roi->h;
+    uint32_t *edges = fb_alloc(sizeof(uint32_t) * edges_max, FB_ALLOC_NO_HINT);
+    uint32_t *edges_rows = fb_alloc(sizeof(uint32_t) * (roi->h + 1), FB_ALLOC_NO_HINT); // first edge of each row
+    size_t edges_count = 0;
+
+    // Sobel gradients of one row (and its grayscale lines for binary/rgb565 images).
+    uint8_t *lines = fb_alloc(roi->w * 3, FB_ALLOC_NO_HINT);
+    int16_t *gx = fb_alloc(roi->w * sizeof(int16_t), FB_ALLOC_NO_HINT);
+    int16_t *gy = fb_alloc(roi->w * sizeof(int16_t), FB_ALLOC_NO_HINT);
+
+    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+        edges_rows[y - roi->y] = edges_count;
+
+        if ((y == roi->y) || (y == (yy - 1)) || ((y - roi->y - 1) % y_stride)) {
+            continue;
         }
-        case PIXFORMAT_GRAYSCALE: {
-            for (int y = roi->y + 1, yy = roi->y + roi->h - 1; y < yy; y += y_stride) {
-                uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(ptr, y);
-                for (int x = roi->x + (y % x_stride) + 1, xx = roi->x + roi->w - 1; x < xx; x += x_stride) {
-                    int pixel; // Sobel Algorithm Below
-                    int x_acc = 0;
-                    int y_acc = 0;
-
-                    row_ptr -= ptr->w;
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x - 1);
-                    x_acc += pixel * +1; // x[0,0] -> pixel * +1
-                    y_acc += pixel * +1; // y[0,0] -> pixel * +1
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
-                    // x[0,1] -> pixel * 0
-                    y_acc += pixel * +2; // y[0,1] -> pixel * +2
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x + 1);
-                    x_acc += pixel * -1; // x[0,2] -> pixel * -1
-                    y_acc += pixel * +1; // y[0,2] -> pixel * +1
-
-                    row_ptr += ptr->w;
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x - 1);
-                    x_acc += pixel * +2; // x[1,0] -> pixel * +2
-                                         // y[1,0] -> pixel * 0
-
-                    // pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
-                    // x[1,1] -> pixel * 0
-                    // y[1,1] -> pixel * 0
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x + 1);
-                    x_acc += pixel * -2; // x[1,2] -> pixel * -2
-                                         // y[1,2] -> pixel * 0
-
-                    row_ptr += ptr->w;
 
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x - 1);
-                    x_acc += pixel * +1; // x[2,0] -> pixel * +1
-                    y_acc += pixel * -1; // y[2,0] -> pixel * -1
+        imlib_sobel_row(ptr, y, roi->x + 1, roi->x + roi->w - 1, lines, gx, gy);
+        for (int x = roi->x + (y % x_stride) + 1, xx = roi->x + roi->w - 1; x < xx; x += x_stride) {
+            int x_acc = gx[x - roi->x - 1];
+            int y_acc = gy[x - roi->x - 1];
 
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
-                    // x[2,1] -> pixel * 0
-                    y_acc += pixel * -2; // y[2,1] -> pixel * -2
-
-                    pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x + 1);
-                    x_acc += pixel * -1; // x[2,2] -> pixel * -1
-                    y_acc += pixel * -1; // y[2,2] -> pixel * -1
-
-                    row_ptr -= ptr->w;
-
-                    int theta = fast_roundf((x_acc ? fast_atan2f(y_acc, x_acc) : 1.570796f) * 57.295780) % 360; // * (180 / PI)
-                    if (theta < 0) {
-                        theta += 360;
-                    }
-                    int magnitude = fast_roundf(fast_sqrtf((x_acc * x_acc) + (y_acc * y_acc)));
-                    int index = (roi->w * (y - roi->y)) + (x - roi->x);
-
-                    theta_acc[index] = theta;
-                    magnitude_acc[index] = magnitude;
-                }
+            int magnitude = fast_roundf(fast_sqrtf((x_acc * x_acc) + (y_acc * y_acc)));
+            if (!magnitude) {
+                continue;
             }
-            break;
-        }
-        case PIXFORMAT_RGB565: {
-            for (int y = roi->y + 1, yy = roi->y + roi->h - 1; y < yy; y += y_stride) {
-                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(ptr, y);
-                for (int x = roi->x + (y % x_stride) + 1, xx = roi->x + roi->w - 1; x < xx; x += x_stride) {
-                    int pixel; // Sobel Algorithm Below
-                    int x_acc = 0;
-                    int y_acc = 0;
-
-                    row_ptr -= ptr->w;
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x - 1));
-                    x_acc += pixel * +1; // x[0,0] -> pixel * +1
-                    y_acc += pixel * +1; // y[0,0] -> pixel * +1
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
-                    // x[0,1] -> pixel * 0
-                    y_acc += pixel * +2; // y[0,1] -> pixel * +2
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x + 1));
-                    x_acc += pixel * -1; // x[0,2] -> pixel * -1
-                    y_acc += pixel * +1; // y[0,2] -> pixel * +1
-
-                    row_ptr += ptr->w;
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x - 1));
-                    x_acc += pixel * +2; // x[1,0] -> pixel * +2
-                                         // y[1,0] -> pixel * 0
-
-                    // pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
-                    // x[1,1] -> pixel * 0
-                    // y[1,1] -> pixel * 0
 
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x + 1));
-                    x_acc += pixel * -2; // x[1,2] -> pixel * -2
-                                         // y[1,2] -> pixel * 0
+            int theta = x_acc ? fast_atan2_deg(y_acc, x_acc) : 90;
 
-                    row_ptr += ptr->w;
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x - 1));
-                    x_acc += pixel * +1; // x[2,0] -> pixel * +1
-                    y_acc += pixel * -1; // y[2,0] -> pixel * -1
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
-                    // x[2,1] -> pixel * 0
-                    y_acc += pixel * -2; // y[2,1] -> pixel * -2
-
-                    pixel = COLOR_RGB565_TO_GRAYSCALE(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x + 1));
-                    x_acc += pixel * -1; // x[2,2] -> pixel * -1
-                    y_acc += pixel * -1; // y[2,2] -> pixel * -1
-
-                    row_ptr -= ptr->w;
-
-                    int theta = fast_roundf((x_acc ? fast_atan2f(y_acc, x_acc) : 1.570796f) * 57.295780) % 360; // * (180 / PI)
-                    if (theta < 0) {
-                        theta += 360;
-                    }
-                    int magnitude = fast_roundf(fast_sqrtf((x_acc * x_acc) + (y_acc * y_acc)));
-                    int index = (roi->w * (y - roi->y)) + (x - roi->x);
-
-                    theta_acc[index] = theta;
-                    magnitude_acc[index] = magnitude;
-                }
-            }
-            break;
-        }
-        default: {
-            break;
+            edges[edges_count++] = HOUGH_EDGE_PACK(x - roi->x, theta, magnitude);
         }
     }
 
+    edges_rows[roi->h] = edges_count;
+
+    fb_free(); // gy
+    fb_free(); // gx
+    fb_free(); // lines
+
     // Theta Direction (% 180)
     //
     // 0,0         X_MAX
@@ -742,13 +400,11 @@ void imlib_find_circles(list_t *out, image_t *ptr, rectangle_t *roi, unsigned in
         }
 
         for (int y = 0, yy = roi->h; y < yy; y++) {
-            for (int x = 0, xx = roi->w; x < xx; x++) {
-                int index = (roi->w * y) + x;
-                int theta = theta_acc[index];
-                int magnitude = magnitude_acc[index];
-                if (!magnitude) {
-                    continue;
-                }
+            for (uint32_t i = edges_rows[y], ii = edges_rows[y + 1]; i < ii; i++) {
+                uint32_t edge = edges[i];
+                int x = HOUGH_EDGE_X(edge);
+                int theta = HOUGH_EDGE_THETA(edge);
+                int magnitude = HOUGH_EDGE_MAGNITUDE(edge);
 
                 // We have to do the below step twice because the gradient may be pointing inside or outside the circle.
                 // Only graidents pointing inside of the circle sum up to produce a large magnitude.
@@ -822,8 +478,8 @@ void imlib_find_circles(list_t *out, image_t *ptr, rectangle_t *roi, unsigned in
         fb_free(); // acc
     }
 
-    fb_free(); // magnitude_acc
-    fb_free(); // theta_acc
+    fb_free(); // edges_rows
+    fb_free(); // edges
 
     for (;;) {
         // Merge overlapping.
@@ -18,6 +18,7 @@
 #include "imlib.h"
 #include "omv_common.h"
 #include "omv_boardconfig.h"
+#include "omv_memcpy.h"
 
 void imlib_init_all() {
     #if (OMV_JPEG_CODEC_ENABLE == 1)
@@ -270,6 +271,12 @@ size_t image_line_size(image_t *ptr) {
             // re-use
             return IMAGE_RGB565_LINE_LEN_BYTES(ptr);
         }
+        case PIXFORMAT_TENSOR_ANY: {
+            return IMAGE_TENSOR_LINE_LEN_BYTES(ptr);
+        }
+        case PIXFORMAT_RAW_ANY: {
+            return IMAGE_RAW_LINE_LEN_BYTES(ptr);
+        }
         default: {
             return 0;
         }
@@ -291,6 +298,12 @@ size_t image_size(image_t *ptr) {
             // re-use
             return IMAGE_RGB565_LINE_LEN_BYTES(ptr) * ptr->h;
         }
+        case PIXFORMAT_TENSOR_ANY: {
+            return IMAGE_TENSOR_LINE_LEN_BYTES(ptr) * ptr->h;
+        }
+        case PIXFORMAT_RAW_ANY: {
+            return IMAGE_RAW_LINE_LEN_BYTES(ptr) * ptr->h;
+        }
         case PIXFORMAT_COMPRESSED_ANY: {
             return ptr->size;
         }
@@ -300,6 +313,122 @@ size_t image_size(image_t *ptr) {
     }
 }
 
+#ifndef __weak
+#define __weak    __attribute__((weak))
+#endif
+
+// CRC-32 (IEEE 802.3, reflected, same as zlib's crc32()).
+static const uint32_t crc32_table[256] = {
+    0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F,
+    0xE963A535, 0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988,
+    0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91, 0x1DB71064, 0x6AB020F2,
+    0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+    0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9,
+    0xFA0F3D63, 0x8D080DF5, 0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172,
+    0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B, 0x35B5A8FA, 0x42B2986C,
+    0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+    0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423,
+    0xCFBA9599, 0xB8BDA50F, 0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924,
+    0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D, 0x76DC4190, 0x01DB7106,
+    0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+    0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D,
+    0x91646C97, 0xE6635C01, 0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E,
+    0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457, 0x65B0D9C6, 0x12B7E950,
+    0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+    0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7,
+    0xA4D1C46D, 0xD3D6F4FB, 0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0,
+    0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9, 0x5005713C, 0x270241AA,
+    0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+    0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81,
+    0xB7BD5C3B, 0xC0BA6CAD, 0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A,
+    0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683, 0xE3630B12, 0x94643B84,
+    0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+    0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB,
+    0x196C3671, 0x6E6B06E7, 0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC,
+    0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5, 0xD6D6A3E8, 0xA1D1937E,
+    0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+    0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55,
+    0x316E8EEF, 0x4669BE79, 0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236,
+    0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F, 0xC5BA3BBE, 0xB2BD0B28,
+    0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+    0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F,
+    0x72076785, 0x05005713, 0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38,
+    0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21, 0x86D3D2D4, 0xF1D4E242,
+    0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+    0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69,
+    0x616BFFD3, 0x166CCF45, 0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2,
+    0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB, 0xAED16A4A, 0xD9D65ADC,
+    0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+    0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693,
+    0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94,
+    0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+};
+
+// Returns the CRC of the data appended to data with a CRC of crc (0 to start). Ports
+// with a CRC unit override this.
+__weak uint32_t imlib_crc32(uint32_t crc, const void *data, size_t size) {
+    const uint8_t *ptr = (const uint8_t *) data;
+    crc = ~crc;
+
+    for (size_t i = 0; i < size; i++) {
+        crc = crc32_table[(crc ^ ptr[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+uint32_t image_crc32(image_t *ptr, rectangle_t *roi) {
+    if (ptr->is_compressed) {
+        return imlib_crc32(0, ptr->data, ptr->size);
+    }
+
+    size_t line_size = image_line_size(ptr);
+    size_t x_offset, x_size;
+
+    if (ptr->pixfmt == PIXFORMAT_BINARY) {
+        // Includes the rest of the words at the edges of the roi.
+        x_offset = (roi->x >> UINT32_T_SHIFT) * sizeof(uint32_t);
+        x_size = (((roi->x + roi->w + UINT32_T_MASK) >> UINT32_T_SHIFT) * sizeof(uint32_t)) - x_offset;
+    } else if ((ptr->pixfmt_id == PIXFORMAT_ID_RAW10) || (ptr->pixfmt_id == PIXFORMAT_ID_RAW12)) {
+        // Packed pixels, whole rows are hashed.
+        x_offset = 0;
+        x_size = line_size;
+    } else {
+        size_t bpp = line_size / ptr->w;
+        x_offset = roi->x * bpp;
+        x_size = roi->w * bpp;
+    }
+
+    uint8_t *data = ptr->data + (roi->y * line_size) + x_offset;
+
+    // Full width rows are contiguous and hashed in one go.
+    if (x_size == line_size) {
+        return imlib_crc32(0, data, x_size * roi->h);
+    }
+
+    uint32_t crc = 0;
+
+    for (int y = 0; y < roi->h; y++, data += line_size) {
+        crc = imlib_crc32(crc, data, x_size);
+    }
+
+    return crc;
+}
+
+size_t image_fingerprint_size(rectangle_t *roi, int tile) {
+    return ((roi->w + tile - 1) / tile) * ((roi->h + tile - 1) / tile);
+}
+
+void image_fingerprint(image_t *ptr, rectangle_t *roi, int tile, uint32_t *hashes) {
+    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += tile) {
+        for (int x = roi->x, xx = roi->x + roi->w; x < xx; x += tile) {
+            rectangle_t r;
+            rectangle_init(&r, x, y, IM_MIN(tile, xx - x), IM_MIN(tile, yy - y));
+            *hashes++ = image_crc32(ptr, &r);
+        }
+    }
+}
+
 bool image_get_mask_pixel(image_t *ptr, int x, int y) {
     if ((0 <= x) && (x < ptr->w) && (0 <= y) && (y < ptr->h)) {
         switch (ptr->pixfmt) {
@@ -321,6 +450,114 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y) {
     return false;
 }
 
+static inline bool mask_runs_pixel(image_t *mask, void *row_ptr, int x) {
+    switch (mask->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            return IMAGE_GET_BINARY_PIXEL_FAST((uint32_t *) row_ptr, x);
+        }
+        case PIXFORMAT_GRAYSCALE: {
+            return COLOR_GRAYSCALE_TO_BINARY(IMAGE_GET_GRAYSCALE_PIXEL_FAST((uint8_t *) row_ptr, x));
+        }
+        case PIXFORMAT_RGB565: {
+            return COLOR_RGB565_TO_BINARY(IMAGE_GET_RGB565_PIXEL_FAST((uint16_t *) row_ptr, x));
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+// Counts the runs, and stores them if rows and runs aren't NULL.
+static size_t mask_runs_build(image_t *mask, int w, int h, bool invert, uint32_t *rows, mask_run_t *runs) {
+    size_t n = 0;
+
+    #define MASK_RUNS_EMIT(start, end)     \
+    ({                                     \
+        if (runs) {                        \
+            runs[n].x = (start);           \
+            runs[n].x_end = (end);         \
+        }                                  \
+        n++;                               \
+    })
+
+    for (int y = 0; y < h; y++) {
+        int mask_w = (y < mask->h) ? IM_MIN(w, mask->w) : 0;
+        void *row_ptr = (y < mask->h) ? (mask->data + (image_line_size(mask) * y)) : NULL;
+        int x_start = -1;
+
+        if (rows) {
+            rows[y] = n;
+        }
+
+        for (int x = 0; x < w; x++) {
+            // Whole words of binary masks are skipped or added at once.
+            if ((mask->pixfmt == PIXFORMAT_BINARY) && (!(x & UINT32_T_MASK)) && ((x + UINT32_T_BITS) <= mask_w)) {
+                uint32_t word = ((uint32_t *) row_ptr)[x >> UINT32_T_SHIFT] ^ (invert ? 0xFFFFFFFF : 0);
+
+                if (!word) {
+                    if (x_start >= 0) {
+                        MASK_RUNS_EMIT(x_start, x);
+                        x_start = -1;
+                    }
+                    x += UINT32_T_BITS - 1;
+                    continue;
+                } else if (word == 0xFFFFFFFF) {
+                    if (x_start < 0) {
+                        x_start = x;
+                    }
+                    x += UINT32_T_BITS - 1;
+                    continue;
+                }
+            }
+
+            bool set = ((x < mask_w) && mask_runs_pixel(mask, row_ptr, x)) ^ invert;
+
+            if (set && (x_start < 0)) {
+                x_start = x;
+            } else if ((!set) && (x_start >= 0)) {
+                MASK_RUNS_EMIT(x_start, x);
+                x_start = -1;
+            }
+        }
+
+        if (x_start >= 0) {
+            MASK_RUNS_EMIT(x_start, w);
+        }
+    }
+
+    if (rows) {
+        rows[h] = n;
+    }
+
+    #undef MASK_RUNS_EMIT
+    return n;
+}
+
+void imlib_mask_runs_init(mask_runs_t *runs, image_t *mask, int w, int h, bool invert) {
+    size_t n = mask_runs_build(mask, w, h, invert, NULL, NULL);
+    runs->w = w;
+    runs->h = h;
+    runs->rows = fb_alloc(((h + 1) * sizeof(uint32_t)) + (n * sizeof(mask_run_t)), FB_ALLOC_NO_HINT);
+    runs->runs = (mask_run_t *) (runs->rows + h + 1);
+    mask_runs_build(mask, w, h, invert, runs->rows, runs->runs);
+}
+
+void imlib_mask_runs_free(mask_runs_t *runs) {
+    fb_free();
+}
+
+void imlib_mask_runs_row_bits(mask_runs_t *runs, int y, uint32_t *bits) {
+    memset(bits, 0, ((runs->w + UINT32_T_MASK) >> UINT32_T_SHIFT) * sizeof(uint32_t));
+
+    for (mask_run_t *r = MASK_RUNS_ROW_BEGIN(runs, y), *rr = MASK_RUNS_ROW_END(runs, y); r < rr; r++) {
+        for (int x = r->x; x < r->x_end; ) {
+            int i = x >> UINT32_T_SHIFT, b = x & UINT32_T_MASK, n = IM_MIN(32 - b, r->x_end - x);
+            bits[i] |= ((n == 32) ? 0xFFFFFFFF : ((1U << n) - 1)) << b;
+            x += n;
+        }
+    }
+}
+
 // Gamma uncompress
 extern const float xyz_table[256];
 
@@ -463,6 +700,105 @@ int8_t imlib_rgb565_to_b(uint16_t pixel) {
     return __SSAT(fast_floorf(200 * (y - z)), 8);
 }
 
+#if defined(IMLIB_ENABLE_LAB_LUT_COMPACT)
+// X/Xn, Y/Yn and Z/Zn contributions in Q16 of each R5 (0-31), G6 (32-95) and B5 (96-127) value.
+extern const uint16_t lab_xyz_table[128][3];
+// The CIELAB f(t) in Q15 for t in [0, 1] in 1024 steps.
+extern const uint16_t lab_f_table[1025];
+
+static inline int lab_f(int t) {
+    t = IM_MIN(t, 65535);
+    const uint16_t *f = lab_f_table + (t >> 6);
+    return f[0] + ((((f[1] - f[0]) * (t & 63)) + 32) >> 6);
+}
+#endif
+
+uint32_t imlib_rgb565_to_lab(uint16_t pixel) {
+    #if defined(IMLIB_ENABLE_LAB_LUT_COMPACT)
+    const uint16_t *r_xyz = lab_xyz_table[COLOR_RGB565_TO_R5(pixel)];
+    const uint16_t *g_xyz = lab_xyz_table[32 + COLOR_RGB565_TO_G6(pixel)];
+    const uint16_t *b_xyz = lab_xyz_table[96 + COLOR_RGB565_TO_B5(pixel)];
+
+    int x = lab_f(r_xyz[0] + g_xyz[0] + b_xyz[0]);
+    int y = lab_f(r_xyz[1] + g_xyz[1] + b_xyz[1]);
+    int z = lab_f(r_xyz[2] + g_xyz[2] + b_xyz[2]);
+
+    int l = (((116 * y) + 16384) >> 15) - 16;
+    int a = __SSAT(((500 * (x - y)) + 16384) >> 15, 8);
+    int b = __SSAT(((200 * (y - z)) + 16384) >> 15, 8);
+    return COLOR_LAB_PACK(l, a, b);
+    #else
+    return COLOR_LAB_PACK(imlib_rgb565_to_l(pixel), imlib_rgb565_to_a(pixel), imlib_rgb565_to_b(pixel));
+    #endif
+}
+
+// Sets the bits of pixels in [x_start, x_end) that pass the threshold in a binary row.
+void imlib_rgb565_threshold_row(uint32_t *bmp_row, uint16_t *row_ptr, int x_start, int x_end,
+                                color_thresholds_list_lnk_data_t *threshold, bool invert) {
+    int x = x_start;
+
+    #if defined(ARM_MATH_DSP)
+    // A and B are biased to unsigned so that L, A and B are compared at once using the GE flags
+    // (lab >= min and max >= lab). Byte 3 always passes.
+    uint32_t lab_min = COLOR_LAB_PACK(threshold->LMin, threshold->AMin ^ 0x80, threshold->BMin ^ 0x80);
+    uint32_t lab_max = COLOR_LAB_PACK(threshold->LMax, threshold->AMax ^ 0x80, threshold->BMax ^ 0x80) | 0xFF000000;
+
+    for (; x < x_end; x++) {
+        uint32_t lab = COLOR_RGB565_TO_LAB(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x)) ^ 0x00808000;
+        __USUB8(lab, lab_min);
+        uint32_t ge = __SEL(0xFFFFFFFF, 0);
+        __USUB8(lab_max, lab);
+        ge = __SEL(ge, 0);
+        bmp_row[x >> UINT32_T_SHIFT] |= ((ge == 0xFFFFFFFF) ^ invert) << (x & UINT32_T_MASK);
+    }
+    #endif
+
+    for (; x < x_end; x++) {
+        if (COLOR_THRESHOLD_RGB565(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x), threshold, invert)) {
+            IMAGE_SET_BINARY_PIXEL_FAST(bmp_row, x);
+        }
+    }
+}
+
+// Builds the per-channel masks of up to COLOR_THRESHOLDS_MASKS_MAX thresholds.
+void imlib_color_thresholds_masks_init(color_thresholds_masks_t *masks, list_t *thresholds) {
+    memset(masks, 0, sizeof(color_thresholds_masks_t));
+
+    int i = 0;
+    list_for_each(it, thresholds) {
+        if (i == COLOR_THRESHOLDS_MASKS_MAX) {
+            break;
+        }
+
+        color_thresholds_list_lnk_data_t *lnk_data = list_get_data(it);
+        uint32_t bit = 1 << i++;
+
+        for (int v = lnk_data->LMin; v <= lnk_data->LMax; v++) {
+            masks->l[v] |= bit;
+        }
+
+        // A and B are indexed by their two's complement byte.
+        for (int v = lnk_data->AMin; v <= lnk_data->AMax; v++) {
+            masks->a[v & 0xFF] |= bit;
+        }
+
+        for (int v = lnk_data->BMin; v <= lnk_data->BMax; v++) {
+            masks->b[v & 0xFF] |= bit;
+        }
+
+        masks->all |= bit;
+    }
+}
+
+uint32_t imlib_grayscale_thresholds_mask(const color_thresholds_masks_t *masks, uint8_t pixel) {
+    return masks->l[pixel];
+}
+
+uint32_t imlib_rgb565_thresholds_mask(const color_thresholds_masks_t *masks, uint16_t pixel) {
+    uint32_t lab = COLOR_RGB565_TO_LAB(pixel);
+    return masks->l[lab & 0xFF] & masks->a[(lab >> 8) & 0xFF] & masks->b[(lab >> 16) & 0xFF];
+}
+
 // https://en.wikipedia.org/wiki/Lab_color_space -> CIELAB-CIEXYZ conversions
 // https://en.wikipedia.org/wiki/SRGB -> Specification of the transformation
 uint16_t imlib_lab_to_rgb(uint8_t l, int8_t a, int8_t b) {
@@ -740,6 +1076,74 @@ void imlib_image_operation(image_t *img, const char *path, image_t *other, int s
     }
 }
 
+typedef struct imlib_mask_runs_line_op_state {
+    line_op_t op;
+    void *data;
+    mask_runs_t runs;
+    uint32_t *row;  // Binary row backup.
+    uint32_t *sel;  // Binary row runs.
+} imlib_mask_runs_line_op_state_t;
+
+// Skips rows without runs, does full rows unmasked and the runs of other rows as 1 line images.
+// Binary rows can't be split at any pixel, so they are done unmasked and the pixels outside the
+// runs are restored.
+static void imlib_mask_runs_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
+    imlib_mask_runs_line_op_state_t *state = (imlib_mask_runs_line_op_state_t *) data;
+    mask_run_t *r = MASK_RUNS_ROW_BEGIN(&state->runs, line);
+    mask_run_t *rr = MASK_RUNS_ROW_END(&state->runs, line);
+
+    if (r == rr) {
+        return;
+    }
+
+    if (((rr - r) == 1) && (r->x == 0) && (r->x_end == img->w)) {
+        state->op(img, line, other, state->data, vflipped);
+        return;
+    }
+
+    if (img->pixfmt == PIXFORMAT_BINARY) {
+        uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, line);
+        int words = IMAGE_BINARY_LINE_LEN(img);
+        memcpy(state->row, row_ptr, words * sizeof(uint32_t));
+        state->op(img, line, other, state->data, vflipped);
+        imlib_mask_runs_row_bits(&state->runs, line, state->sel);
+
+        for (int i = 0; i < words; i++) {
+            row_ptr[i] = (state->row[i] & ~state->sel[i]) | (row_ptr[i] & state->sel[i]);
+        }
+        return;
+    }
+
+    image_t span = *img;
+    span.h = 1;
+
+    for (; r < rr; r++) {
+        span.w = r->x_end - r->x;
+        span.data = img->data + (((img->w * line) + r->x) * img->bpp);
+        state->op(&span, 0, ((uint8_t *) other) + (r->x * img->bpp), state->data, vflipped);
+    }
+}
+
+// Same as imlib_image_operation() but op is only applied to the mask pixels, the line op must
+// ignore masks (its data is passed as is).
+void imlib_image_operation_mask(image_t *img, const char *path, image_t *other, int scalar,
+                                line_op_t op, void *data, image_t *mask) {
+    if (!mask) {
+        imlib_image_operation(img, path, other, scalar, op, data);
+        return;
+    }
+
+    imlib_mask_runs_line_op_state_t state;
+    state.op = op;
+    state.data = data;
+    imlib_mask_runs_init(&state.runs, mask, img->w, img->h, false);
+    state.row = fb_alloc(IMAGE_BINARY_LINE_LEN_BYTES(img) * 2, FB_ALLOC_NO_HINT);
+    state.sel = state.row + IMAGE_BINARY_LINE_LEN(img);
+    imlib_image_operation(img, path, other, scalar, imlib_mask_runs_line_op, &state);
+    fb_free(); // state.row
+    imlib_mask_runs_free(&state.runs);
+}
+
 #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
 void imlib_load_image(image_t *img, const char *path) {
     FIL fp;
@@ -820,36 +1224,31 @@ void imlib_save_image(image_t *img, const char *path, rectangle_t *roi, int qual
 ////////////////////////////////////////////////////////////////////////////////
 
 void imlib_zero(image_t *img, image_t *mask, bool invert) {
+    mask_runs_t runs;
+    imlib_mask_runs_init(&runs, mask, img->w, img->h, invert);
+
     switch (img->pixfmt) {
         case PIXFORMAT_BINARY: {
+            uint32_t *sel = fb_alloc(IMAGE_BINARY_LINE_LEN_BYTES(img), FB_ALLOC_NO_HINT);
             for (int y = 0, yy = img->h; y < yy; y++) {
-                uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
-                for (int x = 0, xx = img->w; x < xx; x++) {
-                    if (image_get_mask_pixel(mask, x, y) ^ invert) {
-                        IMAGE_PUT_BINARY_PIXEL_FAST(row_ptr, x, 0);
-                    }
+                if (MASK_RUNS_ROW_BEGIN(&runs, y) == MASK_RUNS_ROW_END(&runs, y)) {
+                    continue;
                 }
-            }
-            break;
-        }
-        case PIXFORMAT_GRAYSCALE: {
-            for (int y = 0, yy = img->h; y < yy; y++) {
-                uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
-                for (int x = 0, xx = img->w; x < xx; x++) {
-                    if (image_get_mask_pixel(mask, x, y) ^ invert) {
-                        IMAGE_PUT_GRAYSCALE_PIXEL_FAST(row_ptr, x, 0);
-                    }
+                uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
+                imlib_mask_runs_row_bits(&runs, y, sel);
+                for (int i = 0, ii = IMAGE_BINARY_LINE_LEN(img); i < ii; i++) {
+                    row_ptr[i] &= ~sel[i];
                 }
             }
+            fb_free();
             break;
         }
+        case PIXFORMAT_GRAYSCALE:
         case PIXFORMAT_RGB565: {
             for (int y = 0, yy = img->h; y < yy; y++) {
-                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
-                for (int x = 0, xx = img->w; x < xx; x++) {
-                    if (image_get_mask_pixel(mask, x, y) ^ invert) {
-                        IMAGE_PUT_RGB565_PIXEL_FAST(row_ptr, x, 0);
-                    }
+                uint8_t *row_ptr = img->data + (img->w * y * img->bpp);
+                for (mask_run_t *r = MASK_RUNS_ROW_BEGIN(&runs, y), *rr = MASK_RUNS_ROW_END(&runs, y); r < rr; r++) {
+                    memset(row_ptr + (r->x * img->bpp), 0, (r->x_end - r->x) * img->bpp);
                 }
             }
             break;
@@ -858,6 +1257,8 @@ void imlib_zero(image_t *img, image_t *mask, bool invert) {
             break;
         }
     }
+
+    imlib_mask_runs_free(&runs);
 }
 
 #ifdef IMLIB_ENABLE_LENS_CORR
@@ -879,7 +1280,7 @@ void imlib_lens_corr(image_t *img, float strength, float zoom, float x_corr, flo
     // Create a tmp copy of the image to pull pixels from.
     size_t size = image_size(img);
     void *data = fb_alloc(size, FB_ALLOC_NO_HINT);
-    memcpy(data, img->data, size);
+    omv_memcpy(data, img->data, size);
     memset(img->data, 0, size);
 
     int maximum_radius = fast_ceilf(maximum_diameter / 2) + 1; // +1 inclusive of final value
@@ -1060,6 +1461,459 @@ void imlib_lens_corr(image_t *img, float strength, float zoom, float x_corr, flo
 }
 #endif //IMLIB_ENABLE_LENS_CORR
 
+#ifdef IMLIB_ENABLE_REMAP
+// Source positions are clamped to +-8K pixels so grid differences fit in an int32.
+#define REMAP_LIMIT (8192.0f)
+
+static int32_t remap_fixed(float v) {
+    return fast_roundf(IM_MAX(IM_MIN(v, REMAP_LIMIT), -REMAP_LIMIT) * 65536.0f);
+}
+
+// Bilinear blend of 4 values with 8-bit fractions.
+static inline int remap_lerp(int p00, int p01, int p10, int p11, int fx, int fy) {
+    int top = (p00 << 8) + ((p01 - p00) * fx);
+    int bottom = (p10 << 8) + ((p11 - p10) * fx);
+    return ((top << 8) + ((bottom - top) * fy) + 32768) >> 16;
+}
+
+void imlib_remap_init(remap_t *map, int w, int h) {
+    map->w = w;
+    map->h = h;
+    // One grid point past the last pixel so every cell has a right and bottom edge.
+    map->grid_w = ((w - 1) >> REMAP_CELL_SHIFT) + 2;
+    map->grid_h = ((h - 1) >> REMAP_CELL_SHIFT) + 2;
+    map->grid = NULL;
+}
+
+size_t imlib_remap_size(remap_t *map) {
+    return map->grid_w * map->grid_h * 2 * sizeof(int32_t);
+}
+
+// Same mapping as imlib_lens_corr() but evaluated exactly at each grid point and centered
+// between the two middle pixels.
+void imlib_remap_lens_corr(remap_t *map, float strength, float zoom, float x_corr, float y_corr) {
+    float c_x = (map->w - 1) / 2.0f;
+    float c_y = (map->h - 1) / 2.0f;
+    float lens_corr_diameter = strength / fast_sqrtf((map->w * map->w) + (map->h * map->h));
+    float x_off = (int) (map->w * x_corr);
+    float y_off = (int) (map->h * y_corr);
+    zoom = 1 / zoom;
+
+    for (int gy = 0; gy < map->grid_h; gy++) {
+        int32_t *grid = map->grid + (gy * map->grid_w * 2);
+        float y = (gy << REMAP_CELL_SHIFT) - c_y;
+
+        for (int gx = 0; gx < map->grid_w; gx++) {
+            float x = (gx << REMAP_CELL_SHIFT) - c_x;
+            float r = lens_corr_diameter * fast_sqrtf((x * x) + (y * y));
+            float scale = (r > 0.0f) ? ((fast_atanf(r) / r) * zoom) : zoom;
+            grid[(gx * 2) + 0] = remap_fixed(c_x + x_off + (scale * x));
+            grid[(gx * 2) + 1] = remap_fixed(c_y + y_off + (scale * y));
+        }
+    }
+}
+
+// T is a row major 3x3 matrix mapping output pixels to source pixels.
+void imlib_remap_homography(remap_t *map, float *T) {
+    for (int gy = 0; gy < map->grid_h; gy++) {
+        int32_t *grid = map->grid + (gy * map->grid_w * 2);
+        float y = gy << REMAP_CELL_SHIFT;
+
+        for (int gx = 0; gx < map->grid_w; gx++) {
+            float x = gx << REMAP_CELL_SHIFT;
+            float z = (T[6] * x) + (T[7] * y) + T[8];
+
+            if (z > 0.0f) {
+                grid[(gx * 2) + 0] = remap_fixed(((T[0] * x) + (T[1] * y) + T[2]) / z);
+                grid[(gx * 2) + 1] = remap_fixed(((T[3] * x) + (T[4] * y) + T[5]) / z);
+            } else {
+                // Points at or behind the camera plane map outside of the image.
+                grid[(gx * 2) + 0] = remap_fixed(-REMAP_LIMIT);
+                grid[(gx * 2) + 1] = remap_fixed(-REMAP_LIMIT);
+            }
+        }
+    }
+}
+
+// Interpolates the source positions of one output row into xs and ys.
+static void remap_row(remap_t *map, int y, int32_t *xs, int32_t *ys) {
+    int gy = y >> REMAP_CELL_SHIFT;
+    int fy = y & (REMAP_CELL - 1);
+    int32_t *g0 = map->grid + (gy * map->grid_w * 2);
+    int32_t *g1 = g0 + (map->grid_w * 2);
+
+    int32_t x0 = g0[0] + (((g1[0] - g0[0]) >> REMAP_CELL_SHIFT) * fy);
+    int32_t y0 = g0[1] + (((g1[1] - g0[1]) >> REMAP_CELL_SHIFT) * fy);
+
+    for (int gx = 1, x = 0; x < map->w; gx++) {
+        int32_t x1 = g0[(gx * 2) + 0] + (((g1[(gx * 2) + 0] - g0[(gx * 2) + 0]) >> REMAP_CELL_SHIFT) * fy);
+        int32_t y1 = g0[(gx * 2) + 1] + (((g1[(gx * 2) + 1] - g0[(gx * 2) + 1]) >> REMAP_CELL_SHIFT) * fy);
+        int32_t dx = (x1 - x0) >> REMAP_CELL_SHIFT;
+        int32_t dy = (y1 - y0) >> REMAP_CELL_SHIFT;
+
+        for (int i = 0, sx = x0, sy = y0; (i < REMAP_CELL) && (x < map->w); i++, x++, sx += dx, sy += dy) {
+            xs[x] = sx;
+            ys[x] = sy;
+        }
+
+        x0 = x1;
+        y0 = y1;
+    }
+}
+
+// Looks up the source position of an arbitrary output position (16.16). Positions up to a
+// cell outside of the image are extrapolated from the border cells (the grid itself extends
+// past the last pixel), returns false for positions further out.
+static bool remap_lookup(remap_t *map, int32_t x, int32_t y, int32_t *sx, int32_t *sy) {
+    int ix = x >> 16, iy = y >> 16;
+
+    if ((ix < -REMAP_CELL) || (ix >= (map->w + REMAP_CELL)) || (iy < -REMAP_CELL) || (iy >= (map->h + REMAP_CELL))) {
+        return false;
+    }
+
+    int gx = IM_MAX(IM_MIN(ix >> REMAP_CELL_SHIFT, map->grid_w - 2), 0);
+    int gy = IM_MAX(IM_MIN(iy >> REMAP_CELL_SHIFT, map->grid_h - 2), 0);
+    float fx = (x - ((gx << REMAP_CELL_SHIFT) << 16)) / (float) (REMAP_CELL << 16);
+    float fy = (y - ((gy << REMAP_CELL_SHIFT) << 16)) / (float) (REMAP_CELL << 16);
+    int32_t *g00 = map->grid + (((gy * map->grid_w) + gx) * 2);
+    int32_t *g10 = g00 + (map->grid_w * 2);
+
+    float top = g00[0] + ((g00[2] - g00[0]) * fx);
+    float bottom = g10[0] + ((g10[2] - g10[0]) * fx);
+    *sx = top + ((bottom - top) * fy);
+
+    top = g00[1] + ((g00[3] - g00[1]) * fx);
+    bottom = g10[1] + ((g10[3] - g10[1]) * fx);
+    *sy = top + ((bottom - top) * fy);
+
+    return true;
+}
+
+// Applying dst is the same as applying first and then second.
+void imlib_remap_compose(remap_t *dst, remap_t *first, remap_t *second) {
+    int32_t out = remap_fixed(-REMAP_LIMIT);
+
+    for (int i = 0, ii = dst->grid_w * dst->grid_h * 2; i < ii; i += 2) {
+        if (!remap_lookup(first, second->grid[i + 0], second->grid[i + 1], dst->grid + i + 0, dst->grid + i + 1)) {
+            dst->grid[i + 0] = out;
+            dst->grid[i + 1] = out;
+        }
+    }
+}
+
+// Gathers one output row from the source positions in xs and ys (16.16). Only pixels in roi
+// are read, positions outside of it output 0.
+static void remap_gather(image_t *dst, int y, image_t *src, rectangle_t *roi,
+                         int32_t *xs, int32_t *ys, bool bilinear) {
+    int x0 = roi->x, x1 = roi->x + roi->w - 1;
+    int y0 = roi->y, y1 = roi->y + roi->h - 1;
+
+    // Nearest neighbour rounds instead of truncating.
+    int32_t round = bilinear ? 0 : 32768;
+
+    switch (dst->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(dst, y);
+
+            for (int x = 0; x < dst->w; x++) {
+                int sx = (xs[x] + 32768) >> 16, sy = (ys[x] + 32768) >> 16;
+                int pixel = 0;
+
+                if ((x0 <= sx) && (sx <= x1) && (y0 <= sy) && (sy <= y1)) {
+                    uint32_t *ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(src, sy);
+                    pixel = IMAGE_GET_BINARY_PIXEL_FAST(ptr, sx);
+                }
+
+                IMAGE_PUT_BINARY_PIXEL_FAST(row_ptr, x, pixel);
+            }
+            break;
+        }
+        case PIXFORMAT_GRAYSCALE: {
+            uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(dst, y);
+
+            for (int x = 0; x < dst->w; x++) {
+                int sx = (xs[x] + round) >> 16, sy = (ys[x] + round) >> 16;
+                int pixel = 0;
+
+                if ((x0 <= sx) && (sx <= x1) && (y0 <= sy) && (sy <= y1)) {
+                    uint8_t *ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src, sy);
+                    pixel = ptr[sx];
+
+                    if (bilinear) {
+                        int fx = (xs[x] >> 8) & 0xff, fy = (ys[x] >> 8) & 0xff;
+                        int sx1 = IM_MIN(sx + 1, x1);
+                        uint8_t *ptr1 = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src, IM_MIN(sy + 1, y1));
+                        pixel = remap_lerp(pixel, ptr[sx1], ptr1[sx], ptr1[sx1], fx, fy);
+                    }
+                }
+
+                row_ptr[x] = pixel;
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(dst, y);
+
+            for (int x = 0; x < dst->w; x++) {
+                int sx = (xs[x] + round) >> 16, sy = (ys[x] + round) >> 16;
+                int pixel = 0;
+
+                if ((x0 <= sx) && (sx <= x1) && (y0 <= sy) && (sy <= y1)) {
+                    uint16_t *ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(src, sy);
+                    pixel = ptr[sx];
+
+                    if (bilinear) {
+                        int fx = (xs[x] >> 8) & 0xff, fy = (ys[x] >> 8) & 0xff;
+                        int sx1 = IM_MIN(sx + 1, x1);
+                        uint16_t *ptr1 = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(src, IM_MIN(sy + 1, y1));
+                        int p00 = pixel, p01 = ptr[sx1], p10 = ptr1[sx], p11 = ptr1[sx1];
+                        int r5 = remap_lerp(COLOR_RGB565_TO_R5(p00), COLOR_RGB565_TO_R5(p01),
+                                            COLOR_RGB565_TO_R5(p10), COLOR_RGB565_TO_R5(p11), fx, fy);
+                        int g6 = remap_lerp(COLOR_RGB565_TO_G6(p00), COLOR_RGB565_TO_G6(p01),
+                                            COLOR_RGB565_TO_G6(p10), COLOR_RGB565_TO_G6(p11), fx, fy);
+                        int b5 = remap_lerp(COLOR_RGB565_TO_B5(p00), COLOR_RGB565_TO_B5(p01),
+                                            COLOR_RGB565_TO_B5(p10), COLOR_RGB565_TO_B5(p11), fx, fy);
+                        pixel = COLOR_R5_G6_B5_TO_RGB565(r5, g6, b5);
+                    }
+                }
+
+                row_ptr[x] = pixel;
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+void imlib_remap(image_t *img, remap_t *map, bool bilinear) {
+    int w = img->w;
+    int h = img->h;
+
+    // Create a tmp copy of the image to pull pixels from.
+    image_t src = *img;
+    size_t size = image_size(img);
+    src.data = fb_alloc(size, FB_ALLOC_NO_HINT);
+    omv_memcpy_t xfer;
+    omv_memcpy_start(&xfer, src.data, img->data, size);
+
+    int32_t *xs = fb_alloc(w * sizeof(int32_t), FB_ALLOC_NO_HINT);
+    int32_t *ys = fb_alloc(w * sizeof(int32_t), FB_ALLOC_NO_HINT);
+    rectangle_t roi = { 0, 0, w, h };
+
+    // The first row is mapped while the copy finishes.
+    remap_row(map, 0, xs, ys);
+    omv_memcpy_wait(&xfer);
+
+    for (int y = 0; y < h; y++) {
+        if (y) {
+            remap_row(map, y, xs, ys);
+        }
+
+        remap_gather(img, y, &src, &roi, xs, ys, bilinear);
+    }
+
+    fb_free(); // ys
+    fb_free(); // xs
+    fb_free(); // data
+}
+
+// Source positions of one output row. Affine rows are stepped in fixed-point from the row
+// start, perspective rows are divided every WARP_SPAN pixels and stepped linearly between.
+#define WARP_SPAN    (16)
+
+static void warp_row(float *T, bool affine, int y, int w, int32_t *xs, int32_t *ys) {
+    float u = (T[1] * y) + T[2];
+    float v = (T[4] * y) + T[5];
+
+    if (affine) {
+        int32_t sx = remap_fixed(u), dx = remap_fixed(T[0]);
+        int32_t sy = remap_fixed(v), dy = remap_fixed(T[3]);
+
+        for (int x = 0; x < w; x++, sx += dx, sy += dy) {
+            xs[x] = sx;
+            ys[x] = sy;
+        }
+
+        return;
+    }
+
+    float z = (T[7] * y) + T[8];
+    int32_t sx0 = 0, sy0 = 0;
+
+    for (int x = 0; x < w; x += WARP_SPAN) {
+        // Numerators and denominator step by a column of T per pixel.
+        int n = IM_MIN(WARP_SPAN, w - x);
+        float z0 = z + (T[6] * x), z1 = z + (T[6] * (x + n));
+        int32_t sx1, sy1;
+
+        if (!x) {
+            sx0 = (z0 > 0.0f) ? remap_fixed(u / z0) : remap_fixed(-REMAP_LIMIT);
+            sy0 = (z0 > 0.0f) ? remap_fixed(v / z0) : remap_fixed(-REMAP_LIMIT);
+        }
+
+        if ((z0 > 0.0f) && (z1 > 0.0f)) {
+            float r = 1.0f / z1;
+            sx1 = remap_fixed((u + (T[0] * (x + n))) * r);
+            sy1 = remap_fixed((v + (T[3] * (x + n))) * r);
+
+            int32_t dx = (sx1 - sx0) / n, dy = (sy1 - sy0) / n;
+
+            for (int i = 0, sx = sx0, sy = sy0; i < n; i++, sx += dx, sy += dy) {
+                xs[x + i] = sx;
+                ys[x + i] = sy;
+            }
+        } else {
+            // Spans crossing the horizon are divided per pixel, points at or behind the
+            // camera plane map outside of the image.
+            for (int i = 0; i < n; i++) {
+                float zi = z + (T[6] * (x + i));
+                xs[x + i] = (zi > 0.0f) ? remap_fixed((u + (T[0] * (x + i))) / zi) : remap_fixed(-REMAP_LIMIT);
+                ys[x + i] = (zi > 0.0f) ? remap_fixed((v + (T[3] * (x + i))) / zi) : remap_fixed(-REMAP_LIMIT);
+            }
+
+            sx1 = (z1 > 0.0f) ? remap_fixed((u + (T[0] * (x + n))) / z1) : remap_fixed(-REMAP_LIMIT);
+            sy1 = (z1 > 0.0f) ? remap_fixed((v + (T[3] * (x + n))) / z1) : remap_fixed(-REMAP_LIMIT);
+        }
+
+        sx0 = sx1;
+        sy0 = sy1;
+    }
+}
+
+// Prepares the matrix M of a w x h output for warp_row(), returns false if it's degenerate.
+static bool warp_init(float *M, int w, int h, bool *affine) {
+    *affine = (fast_fabsf(M[6]) < FLT_EPSILON) && (fast_fabsf(M[7]) < FLT_EPSILON);
+
+    // T and -T are the same transform, the output must be in front of the camera plane.
+    if (((M[6] * (w / 2)) + (M[7] * (h / 2)) + M[8]) < 0.0f) {
+        for (int i = 0; i < 9; i++) {
+            M[i] = -M[i];
+        }
+    }
+
+    if (*affine) {
+        if (fast_fabsf(M[8]) < FLT_EPSILON) {
+            return false;
+        }
+
+        for (int i = 0; i < 6; i++) {
+            M[i] /= M[8];
+        }
+    }
+
+    return true;
+}
+
+void imlib_warp(image_t *dst, image_t *src, rectangle_t *roi, float *T, bool bilinear) {
+    // Maps to roi relative positions, moved to image positions.
+    float M[9] = {
+        T[0] + (roi->x * T[6]), T[1] + (roi->x * T[7]), T[2] + (roi->x * T[8]),
+        T[3] + (roi->y * T[6]), T[4] + (roi->y * T[7]), T[5] + (roi->y * T[8]),
+        T[6], T[7], T[8]
+    };
+
+    bool affine;
+
+    if (!warp_init(M, dst->w, dst->h, &affine)) {
+        memset(dst->data, 0, image_size(dst));
+        return;
+    }
+
+    int32_t *xs = fb_alloc(dst->w * sizeof(int32_t), FB_ALLOC_NO_HINT);
+    int32_t *ys = fb_alloc(dst->w * sizeof(int32_t), FB_ALLOC_NO_HINT);
+
+    for (int y = 0; y < dst->h; y++) {
+        warp_row(M, affine, y, dst->w, xs, ys);
+        remap_gather(dst, y, src, roi, xs, ys, bilinear);
+    }
+
+    fb_free(); // ys
+    fb_free(); // xs
+}
+
+// Overlays a GRAYSCALE (thermal) image on an RGB565 image. Each dst pixel is mapped to thermal
+// positions by map, or by T (3x3 row major) if map is NULL, the sampled value is colored by the
+// palette and blended over the dst pixel. Pixels mapping outside of the thermal image are kept.
+void imlib_fuse(image_t *dst, image_t *thermal, remap_t *map, float *T, bool bilinear,
+                int alpha, const uint16_t *color_palette, const uint8_t *alpha_palette) {
+    float M[9];
+    bool affine = false;
+
+    if (!map) {
+        memcpy(M, T, sizeof(M));
+
+        if (!warp_init(M, dst->w, dst->h, &affine)) {
+            return;
+        }
+    }
+
+    // The palette color times its 5-bit alpha and the dst weight of each thermal value. Pixels
+    // are spread out as 0x07E0F81F (g << 16 | r << 11 | b) so that one multiply blends all of
+    // the channels, each has room for the 5 extra bits.
+    uint32_t *src_lut = fb_alloc(256 * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    uint8_t *dst_lut = fb_alloc(256, FB_ALLOC_NO_HINT);
+
+    for (int i = 0; i < 256; i++) {
+        uint32_t c = color_palette ? color_palette[i] : COLOR_Y_TO_RGB565(i);
+        int a = alpha >> 3;
+
+        if (alpha_palette) {
+            a = fast_roundf((a * alpha_palette[i]) / 255.f);
+        }
+
+        src_lut[i] = ((c | (c << 16)) & 0x07E0F81F) * a;
+        dst_lut[i] = 32 - a;
+    }
+
+    int32_t *xs = fb_alloc(dst->w * sizeof(int32_t), FB_ALLOC_NO_HINT);
+    int32_t *ys = fb_alloc(dst->w * sizeof(int32_t), FB_ALLOC_NO_HINT);
+    int x1 = thermal->w - 1, y1 = thermal->h - 1;
+
+    // Nearest neighbour rounds instead of truncating.
+    int32_t round = bilinear ? 0 : 32768;
+
+    for (int y = 0; y < dst->h; y++) {
+        if (map) {
+            remap_row(map, y, xs, ys);
+        } else {
+            warp_row(M, affine, y, dst->w, xs, ys);
+        }
+
+        uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(dst, y);
+
+        for (int x = 0; x < dst->w; x++) {
+            int sx = (xs[x] + round) >> 16, sy = (ys[x] + round) >> 16;
+
+            if ((sx < 0) || (sx > x1) || (sy < 0) || (sy > y1)) {
+                continue;
+            }
+
+            uint8_t *ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(thermal, sy);
+            int value = ptr[sx];
+
+            if (bilinear) {
+                int fx = (xs[x] >> 8) & 0xff, fy = (ys[x] >> 8) & 0xff;
+                int sx1 = IM_MIN(sx + 1, x1);
+                uint8_t *ptr1 = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(thermal, IM_MIN(sy + 1, y1));
+                value = remap_lerp(value, ptr[sx1], ptr1[sx], ptr1[sx1], fx, fy);
+            }
+
+            uint32_t pixel = row_ptr[x];
+            pixel = (pixel | (pixel << 16)) & 0x07E0F81F;
+            pixel = (((pixel * dst_lut[value]) + src_lut[value]) >> 5) & 0x07E0F81F;
+            row_ptr[x] = pixel | (pixel >> 16);
+        }
+    }
+
+    fb_free(); // ys
+    fb_free(); // xs
+    fb_free(); // dst_lut
+    fb_free(); // src_lut
+}
+#endif //IMLIB_ENABLE_REMAP
+
 ////////////////////////////////////////////////////////////////////////////////
 
 int imlib_image_mean(image_t *src, int *r_mean, int *g_mean, int *b_mean) {
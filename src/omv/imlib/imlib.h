@@ -159,6 +159,7 @@ void rectangle_intersected(rectangle_t *dst, rectangle_t *src);
 void rectangle_united(rectangle_t *dst, rectangle_t *src);
 float rectangle_iou(rectangle_t *r1, rectangle_t *r2);
 void rectangle_nms_add_bounding_box(list_t *bounding_boxes, bounding_box_lnk_data_t *box);
+void rectangle_nms_add_bounding_boxes(list_t *bounding_boxes, bounding_box_lnk_data_t *boxes, size_t n);
 int rectangle_nms_get_bounding_boxes(list_t *bounding_boxes, float threshold, float sigma);
 void rectangle_map_bounding_boxes(list_t *bounding_boxes, int window_w, int window_h, rectangle_t *roi);
 
@@ -173,6 +174,17 @@ typedef struct color_thresholds_list_lnk_data {
 }
 color_thresholds_list_lnk_data_t;
 
+// Bit i of l[L] & a[A] & b[B] is set if (L, A, B) passes threshold i. The L, A and B ranges of a
+// threshold are independent, so any number of thresholds (up to 32) is tested with 3 lookups.
+typedef struct color_thresholds_masks {
+    uint32_t all; // One bit per threshold.
+    uint32_t l[256]; // or grayscale
+    uint32_t a[256];
+    uint32_t b[256];
+} color_thresholds_masks_t;
+
+#define COLOR_THRESHOLDS_MASKS_MAX    (32)
+
 #define COLOR_THRESHOLD_BINARY(pixel, threshold, invert)                          \
     ({                                                                            \
         __typeof__ (pixel) _pixel = (pixel);                                      \
@@ -194,9 +206,10 @@ color_thresholds_list_lnk_data_t;
         __typeof__ (pixel) _pixel = (pixel);                              \
         __typeof__ (threshold) _threshold = (threshold);                  \
         __typeof__ (invert) _invert = (invert);                           \
-        uint8_t _l = COLOR_RGB565_TO_L(_pixel);                           \
-        int8_t _a = COLOR_RGB565_TO_A(_pixel);                            \
-        int8_t _b = COLOR_RGB565_TO_B(_pixel);                            \
+        uint32_t _lab = COLOR_RGB565_TO_LAB(_pixel);                      \
+        uint8_t _l = COLOR_LAB_TO_L(_lab);                                \
+        int8_t _a = COLOR_LAB_TO_A(_lab);                                 \
+        int8_t _b = COLOR_LAB_TO_B(_lab);                                 \
         ((_threshold->LMin <= _l) && (_l <= _threshold->LMax) &&          \
          (_threshold->AMin <= _a) && (_a <= _threshold->AMax) &&          \
          (_threshold->BMin <= _b) && (_b <= _threshold->BMax)) ^ _invert; \
@@ -295,6 +308,20 @@ color_thresholds_list_lnk_data_t;
 #define COLOR_R5_G6_B5_TO_RGB565(r5, g6, b5)    (((r5) << 11) | ((g6) << 5) | (b5))
 #define COLOR_R8_G8_B8_TO_RGB565(r8, g8, b8)    ((((r8) & 0xF8) << 8) | (((g8) & 0xFC) << 3) | ((b8) >> 3))
 
+#if defined(IMLIB_ENABLE_HELIUM)
+// The Helium kernels (math ops, YUV422 to RGB565 and grayscale area scaling) are selected per
+// board in imlib_config.h. No board builds for an M55 yet, so these paths are untested scaffolding.
+// Debayering and morphology still only have DSP paths.
+#if !defined(ARM_MATH_MVEI)
+#error "IMLIB_ENABLE_HELIUM requires an MVE target (CPU=cortex-m55)."
+#endif
+// Helium versions of the above for 8 RGB565 pixels at a time.
+#define MVE_RGB565_TO_R5(pixels)                vshrq_n_u16((pixels), 11)
+#define MVE_RGB565_TO_G6(pixels)                vandq_u16(vshrq_n_u16((pixels), 5), vdupq_n_u16(0x3F))
+#define MVE_RGB565_TO_B5(pixels)                vandq_u16((pixels), vdupq_n_u16(0x1F))
+#define MVE_R5_G6_B5_TO_RGB565(r5, g6, b5)      vorrq_u16(vorrq_u16(vshlq_n_u16((r5), 11), vshlq_n_u16((g6), 5)), (b5))
+#endif
+
 #define COLOR_RGB888_TO_Y(r8, g8, b8)           ((((r8) * 38) + ((g8) * 75) + ((b8) * 15)) >> 7) // 0.299R + 0.587G + 0.114B
 #define COLOR_RGB565_TO_Y(rgb565)                \
     ({                                           \
@@ -333,13 +360,27 @@ color_thresholds_list_lnk_data_t;
         COLOR_RGB888_TO_V(r, g, b);              \
     })
 
-extern const int8_t lab_table[196608 / 2];
+// The table is padded by one byte so that each L, A, B triplet can be read with one word load.
+extern const int8_t lab_table[(196608 / 2) + 1];
 
-#ifdef IMLIB_ENABLE_LAB_LUT
+// Packed L, A, B in bytes 0, 1 and 2 of a word. Byte 3 is undefined.
+#define COLOR_LAB_PACK(l, a, b)                 (((l) & 0xFF) | (((a) & 0xFF) << 8) | (((b) & 0xFF) << 16))
+#define COLOR_LAB_TO_L(lab)                     ((uint8_t) (lab))
+#define COLOR_LAB_TO_A(lab)                     ((int8_t) ((lab) >> 8))
+#define COLOR_LAB_TO_B(lab)                     ((int8_t) ((lab) >> 16))
+
+#if defined(IMLIB_ENABLE_LAB_LUT)
+#define COLOR_RGB565_TO_LAB(pixel)              __UNALIGNED_UINT32_READ(lab_table + (((pixel) >> 1) * 3))
 #define COLOR_RGB565_TO_L(pixel)                lab_table[((pixel >> 1) * 3) + 0]
 #define COLOR_RGB565_TO_A(pixel)                lab_table[((pixel >> 1) * 3) + 1]
 #define COLOR_RGB565_TO_B(pixel)                lab_table[((pixel >> 1) * 3) + 2]
+#elif defined(IMLIB_ENABLE_LAB_LUT_COMPACT)
+#define COLOR_RGB565_TO_LAB(pixel)              imlib_rgb565_to_lab(pixel)
+#define COLOR_RGB565_TO_L(pixel)                COLOR_LAB_TO_L(imlib_rgb565_to_lab(pixel))
+#define COLOR_RGB565_TO_A(pixel)                COLOR_LAB_TO_A(imlib_rgb565_to_lab(pixel))
+#define COLOR_RGB565_TO_B(pixel)                COLOR_LAB_TO_B(imlib_rgb565_to_lab(pixel))
 #else
+#define COLOR_RGB565_TO_LAB(pixel)              imlib_rgb565_to_lab(pixel)
 #define COLOR_RGB565_TO_L(pixel)                imlib_rgb565_to_l(pixel)
 #define COLOR_RGB565_TO_A(pixel)                imlib_rgb565_to_a(pixel)
 #define COLOR_RGB565_TO_B(pixel)                imlib_rgb565_to_b(pixel)
@@ -379,6 +420,9 @@ typedef enum {
     PIXFORMAT_ID_JPEG   = 6,
     PIXFORMAT_ID_PNG    = 7,
     PIXFORMAT_ID_ARGB8  = 8,
+    PIXFORMAT_ID_TENSOR = 9,
+    PIXFORMAT_ID_RAW10  = 10,
+    PIXFORMAT_ID_RAW12  = 11,
     /* Note: Update PIXFORMAT_IS_VALID when adding new formats */
 } pixformat_id_t;
 
@@ -392,6 +436,8 @@ typedef enum {
     SUBFORMAT_ID_RGGB   = 3,
     SUBFORMAT_ID_YUV422 = 0,
     SUBFORMAT_ID_YVU422 = 1,
+    SUBFORMAT_ID_TENSOR_UINT8 = 0,
+    SUBFORMAT_ID_TENSOR_INT8  = 1,
     /* Note: Update PIXFORMAT_IS_VALID when adding new formats */
 } subformat_id_t;
 
@@ -404,10 +450,14 @@ typedef enum {
     PIXFORMAT_BPP_BAYER  = 1,
     PIXFORMAT_BPP_YUV422 = 2,
     PIXFORMAT_BPP_ARGB8  = 4,
+    PIXFORMAT_BPP_TENSOR_GRAY = 1,
+    PIXFORMAT_BPP_TENSOR_RGB  = 3,
+    PIXFORMAT_BPP_RAW_PACKED  = 0,
     /* Note: Update PIXFORMAT_IS_VALID when adding new formats */
 } pixformat_bpp_t;
 
 // Pixel format flags.
+#define PIXFORMAT_FLAGS_T          (1 << 29) // Tensor format.
 #define PIXFORMAT_FLAGS_Y          (1 << 28) // YUV format.
 #define PIXFORMAT_FLAGS_M          (1 << 27) // Mutable format.
 #define PIXFORMAT_FLAGS_C          (1 << 26) // Colored format.
@@ -417,12 +467,13 @@ typedef enum {
 #define PIXFORMAT_FLAGS_CM         (PIXFORMAT_FLAGS_C | PIXFORMAT_FLAGS_M)
 #define PIXFORMAT_FLAGS_CR         (PIXFORMAT_FLAGS_C | PIXFORMAT_FLAGS_R)
 #define PIXFORMAT_FLAGS_CJ         (PIXFORMAT_FLAGS_C | PIXFORMAT_FLAGS_J)
+#define PIXFORMAT_FLAGS_CT         (PIXFORMAT_FLAGS_C | PIXFORMAT_FLAGS_T)
 #define IMLIB_IMAGE_MAX_SIZE(x)    ((x) & 0xFFFFFFFF)
 
 // *INDENT-OFF*
 // Each pixel format encodes flags, pixel format id and bpp as follows:
-// 31......29  28  27  26  25  24  23..........16  15...........8  7.............0
-// <RESERVED>  YF  MF  CF  JF  RF  <PIXFORMAT_ID>  <SUBFORMAT_ID>  <BYTES_PER_PIX>
+// 31......30  29  28  27  26  25  24  23..........16  15...........8  7.............0
+// <RESERVED>  TF  YF  MF  CF  JF  RF  <PIXFORMAT_ID>  <SUBFORMAT_ID>  <BYTES_PER_PIX>
 // NOTE: Bit 31-30 must Not be used for pixformat_t to be used as mp_int_t.
 typedef enum {
   PIXFORMAT_INVALID    = (0x00000000U),
@@ -440,6 +491,20 @@ typedef enum {
   PIXFORMAT_YVU422     = (PIXFORMAT_FLAGS_CY | (PIXFORMAT_ID_YUV422 << 16) | (SUBFORMAT_ID_YVU422 << 8) | PIXFORMAT_BPP_YUV422 ),
   PIXFORMAT_JPEG       = (PIXFORMAT_FLAGS_CJ | (PIXFORMAT_ID_JPEG   << 16) | (0                   << 8) | 0                    ),
   PIXFORMAT_PNG        = (PIXFORMAT_FLAGS_CJ | (PIXFORMAT_ID_PNG    << 16) | (0                   << 8) | 0                    ),
+  PIXFORMAT_TENSOR_UINT8     = (PIXFORMAT_FLAGS_T  | (PIXFORMAT_ID_TENSOR << 16) | (SUBFORMAT_ID_TENSOR_UINT8 << 8) | PIXFORMAT_BPP_TENSOR_GRAY),
+  PIXFORMAT_TENSOR_INT8      = (PIXFORMAT_FLAGS_T  | (PIXFORMAT_ID_TENSOR << 16) | (SUBFORMAT_ID_TENSOR_INT8  << 8) | PIXFORMAT_BPP_TENSOR_GRAY),
+  PIXFORMAT_TENSOR_RGB_UINT8 = (PIXFORMAT_FLAGS_CT | (PIXFORMAT_ID_TENSOR << 16) | (SUBFORMAT_ID_TENSOR_UINT8 << 8) | PIXFORMAT_BPP_TENSOR_RGB ),
+  PIXFORMAT_TENSOR_RGB_INT8  = (PIXFORMAT_FLAGS_CT | (PIXFORMAT_ID_TENSOR << 16) | (SUBFORMAT_ID_TENSOR_INT8  << 8) | PIXFORMAT_BPP_TENSOR_RGB ),
+  PIXFORMAT_RAW10      = (PIXFORMAT_FLAGS_C  | (PIXFORMAT_ID_RAW10  << 16) | (SUBFORMAT_ID_BGGR   << 8) | PIXFORMAT_BPP_RAW_PACKED),
+  PIXFORMAT_RAW10_BGGR = (PIXFORMAT_FLAGS_C  | (PIXFORMAT_ID_RAW10  << 16) | (SUBFORMAT_ID_BGGR   << 8) | PIXFORMAT_BPP_RAW_PACKED),
+  PIXFORMAT_RAW10_GBRG = (PIXFORMAT_FLAGS_C  | (PIXFORMAT_ID_RAW10  << 16) | (SUBFORMAT_ID_GBRG   << 8) | PIXFORMAT_BPP_RAW_PACKED),
+  PIXFORMAT_RAW10_GRBG = (PIXFORMAT_FLAGS_C  | (PIXFORMAT_ID_RAW10  << 16) | (SUBFORMAT_ID_GRBG   << 8) | PIXFORMAT_BPP_RAW_PACKED),
+  PIXFORMAT_RAW10_RGGB = (PIXFORMAT_FLAGS_C  | (PIXFORMAT_ID_RAW10  << 16) | (SUBFORMAT_ID_RGGB   << 8) | PIXFORMAT_BPP_RAW_PACKED),
+  PIXFORMAT_RAW12      = (PIXFORMAT_FLAGS_C  | (PIXFORMAT_ID_RAW12  << 16) | (SUBFORMAT_ID_BGGR   << 8) | PIXFORMAT_BPP_RAW_PACKED),
+  PIXFORMAT_RAW12_BGGR = (PIXFORMAT_FLAGS_C  | (PIXFORMAT_ID_RAW12  << 16) | (SUBFORMAT_ID_BGGR   << 8) | PIXFORMAT_BPP_RAW_PACKED),
+  PIXFORMAT_RAW12_GBRG = (PIXFORMAT_FLAGS_C  | (PIXFORMAT_ID_RAW12  << 16) | (SUBFORMAT_ID_GBRG   << 8) | PIXFORMAT_BPP_RAW_PACKED),
+  PIXFORMAT_RAW12_GRBG = (PIXFORMAT_FLAGS_C  | (PIXFORMAT_ID_RAW12  << 16) | (SUBFORMAT_ID_GRBG   << 8) | PIXFORMAT_BPP_RAW_PACKED),
+  PIXFORMAT_RAW12_RGGB = (PIXFORMAT_FLAGS_C  | (PIXFORMAT_ID_RAW12  << 16) | (SUBFORMAT_ID_RGGB   << 8) | PIXFORMAT_BPP_RAW_PACKED),
   PIXFORMAT_LAST       = (0xFFFFFFFFU),
 } pixformat_t;
 // *INDENT-ON*
@@ -460,10 +525,33 @@ typedef enum {
     PIXFORMAT_YUV422:     \
     case PIXFORMAT_YVU422 \
 
+// Packed 10/12-bit bayer images, in the MIPI CSI-2 RAW10/RAW12 layout. RAW10 stores the high
+// 8 bits of 4 pixels followed by a byte with their low 2 bits (pixel 0 in bits 1:0), RAW12 the
+// high 8 bits of 2 pixels followed by a byte with their low 4 bits (pixel 0 in bits 3:0). These
+// are not bayer (is_bayer) images, they are read with imlib_raw_*() and developed to 8-bit.
+#define PIXFORMAT_RAW_ANY      \
+    PIXFORMAT_RAW10_BGGR:      \
+    case PIXFORMAT_RAW10_GBRG: \
+    case PIXFORMAT_RAW10_GRBG: \
+    case PIXFORMAT_RAW10_RGGB: \
+    case PIXFORMAT_RAW12_BGGR: \
+    case PIXFORMAT_RAW12_GBRG: \
+    case PIXFORMAT_RAW12_GRBG: \
+    case PIXFORMAT_RAW12_RGGB  \
+
 #define PIXFORMAT_COMPRESSED_ANY \
     PIXFORMAT_JPEG:              \
     case PIXFORMAT_PNG           \
 
+// Quantized model tensors (HWC, 1 or 3 channels). Values are the 0->255 pixel values, minus
+// the zero point of 128 for int8 (so the sign bit is flipped), at a scale of 1. Tensors are
+// not mutable, they are written by imlib_draw_image() and read back as GRAYSCALE/RGB565.
+#define PIXFORMAT_TENSOR_ANY         \
+    PIXFORMAT_TENSOR_UINT8:          \
+    case PIXFORMAT_TENSOR_INT8:      \
+    case PIXFORMAT_TENSOR_RGB_UINT8: \
+    case PIXFORMAT_TENSOR_RGB_INT8   \
+
 #define IMLIB_PIXFORMAT_IS_VALID(x) \
     ((x == PIXFORMAT_BINARY)        \
      || (x == PIXFORMAT_GRAYSCALE)  \
@@ -476,7 +564,21 @@ typedef enum {
      || (x == PIXFORMAT_YUV422)     \
      || (x == PIXFORMAT_YVU422)     \
      || (x == PIXFORMAT_JPEG)       \
-     || (x == PIXFORMAT_PNG))       \
+     || (x == PIXFORMAT_PNG)        \
+     || (x == PIXFORMAT_RAW10_BGGR) \
+     || (x == PIXFORMAT_RAW10_GBRG) \
+     || (x == PIXFORMAT_RAW10_GRBG) \
+     || (x == PIXFORMAT_RAW10_RGGB) \
+     || (x == PIXFORMAT_RAW12_BGGR) \
+     || (x == PIXFORMAT_RAW12_GBRG) \
+     || (x == PIXFORMAT_RAW12_GRBG) \
+     || (x == PIXFORMAT_RAW12_RGGB)) \
+
+#define IMLIB_PIXFORMAT_IS_TENSOR(x)       \
+    ((x == PIXFORMAT_TENSOR_UINT8)         \
+     || (x == PIXFORMAT_TENSOR_INT8)       \
+     || (x == PIXFORMAT_TENSOR_RGB_UINT8)  \
+     || (x == PIXFORMAT_TENSOR_RGB_INT8))  \
 
 // *INDENT-OFF*
 #if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
@@ -492,7 +594,8 @@ struct {                            \
         uint32_t is_color       :1; \
         uint32_t is_mutable     :1; \
         uint32_t is_yuv         :1; \
-        uint32_t /*reserved*/   :3; \
+        uint32_t is_tensor      :1; \
+        uint32_t /*reserved*/   :2; \
     };                              \
     uint32_t pixfmt;                \
   };                                \
@@ -503,7 +606,8 @@ struct {                            \
 struct {                            \
   union {                           \
     struct {                        \
-        uint32_t /*reserved*/   :3; \
+        uint32_t /*reserved*/   :2; \
+        uint32_t is_tensor      :1; \
         uint32_t is_yuv         :1; \
         uint32_t is_mutable     :1; \
         uint32_t is_color       :1; \
@@ -538,6 +642,33 @@ size_t image_line_size(image_t *ptr);
 size_t image_size(image_t *ptr);
 bool image_get_mask_pixel(image_t *ptr, int x, int y);
 
+// A mask compiled to the runs of set pixels of each row, so masked code only visits the runs.
+typedef struct mask_run {
+    uint16_t x;
+    uint16_t x_end; // Exclusive.
+} mask_run_t;
+
+typedef struct mask_runs {
+    int w;
+    int h;
+    uint32_t *rows;     // Index of the first run of each row, h + 1 entries.
+    mask_run_t *runs;
+} mask_runs_t;
+
+// Compiles the mask pixels of a w by h image, pixels outside of the mask are clear (set if inverted).
+void imlib_mask_runs_init(mask_runs_t *runs, image_t *mask, int w, int h, bool invert);
+void imlib_mask_runs_free(mask_runs_t *runs);
+// Sets the bits of the runs of row y in a binary row.
+void imlib_mask_runs_row_bits(mask_runs_t *runs, int y, uint32_t *bits);
+
+#define MASK_RUNS_ROW_BEGIN(r, y)       ((r)->runs + (r)->rows[(y)])
+#define MASK_RUNS_ROW_END(r, y)         ((r)->runs + (r)->rows[(y) + 1])
+// Frame change detection (CRC-32, IEEE 802.3).
+uint32_t imlib_crc32(uint32_t crc, const void *data, size_t size);
+uint32_t image_crc32(image_t *ptr, rectangle_t *roi);
+size_t image_fingerprint_size(rectangle_t *roi, int tile);
+void image_fingerprint(image_t *ptr, rectangle_t *roi, int tile, uint32_t *hashes);
+
 #define IMAGE_BINARY_LINE_LEN(image)             (((image)->w + UINT32_T_MASK) >> UINT32_T_SHIFT)
 #define IMAGE_BINARY_LINE_LEN_BYTES(image)       (IMAGE_BINARY_LINE_LEN(image) * sizeof(uint32_t))
 
@@ -547,6 +678,13 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
 #define IMAGE_RGB565_LINE_LEN(image)             ((image)->w)
 #define IMAGE_RGB565_LINE_LEN_BYTES(image)       (IMAGE_RGB565_LINE_LEN(image) * sizeof(uint16_t))
 
+#define IMAGE_TENSOR_LINE_LEN(image)             ((image)->w * (image)->bpp)
+#define IMAGE_TENSOR_LINE_LEN_BYTES(image)       (IMAGE_TENSOR_LINE_LEN(image) * sizeof(uint8_t))
+
+#define IMAGE_RAW_BITS(image)                    (((image)->pixfmt_id == PIXFORMAT_ID_RAW10) ? 10 : 12)
+#define IMAGE_RAW_LINE_LEN_BYTES(image)          (((image)->pixfmt_id == PIXFORMAT_ID_RAW10) ? \
+                                                  ((((image)->w * 5) + 3) / 4) : ((((image)->w * 3) + 1) / 2))
+
 #define IMAGE_GET_BINARY_PIXEL(image, x, y)                                                                              \
     ({                                                                                                                   \
         __typeof__ (image) _image = (image);                                                                             \
@@ -723,6 +861,13 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         ((uint16_t *) _image->data) + (_image->w * _y); \
     })
 
+#define IMAGE_COMPUTE_TENSOR_PIXEL_ROW_PTR(image, y)                 \
+    ({                                                               \
+        __typeof__ (image) _image = (image);                         \
+        __typeof__ (y) _y = (y);                                     \
+        ((uint8_t *) _image->data) + (_image->w * _image->bpp * _y); \
+    })
+
 #define IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x)    \
     ({                                             \
         __typeof__ (row_ptr) _row_ptr = (row_ptr); \
@@ -745,6 +890,13 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         ((uint8_t *) _image->data) + (_image->w * _y); \
     })
 
+#define IMAGE_COMPUTE_RAW_PIXEL_ROW_PTR(image, y)                             \
+    ({                                                                        \
+        __typeof__ (image) _image = (image);                                  \
+        __typeof__ (y) _y = (y);                                              \
+        ((uint8_t *) _image->data) + (IMAGE_RAW_LINE_LEN_BYTES(_image) * _y); \
+    })
+
 #define IMAGE_COMPUTE_YUV_PIXEL_ROW_PTR(image, y)       \
     ({                                                  \
         __typeof__ (image) _image = (image);            \
@@ -770,6 +922,40 @@ typedef enum jpeg_subsampling {
     JPEG_SUBSAMPLING_420  = 0x22, // Chroma subsampling 4:2:0
 } jpeg_subsampling_t;
 
+// Called with the encoded bytes whenever the output buffer fills up, return false to stop.
+typedef bool (*jpeg_flush_callback_t) (const uint8_t *data, uint32_t size, void *arg);
+
+typedef struct jpeg_buf {
+    int idx;
+    int length;
+    uint8_t *buf;
+    int bitc, bitb;
+    bool realloc;
+    bool overflow;
+    jpeg_flush_callback_t flush; // Streams the buffer out when full instead of growing it.
+    void *flush_arg;
+    uint32_t flushed;            // Bytes already streamed out.
+} jpeg_buf_t;
+
+typedef struct jpeg_encoder {
+    jpeg_buf_t buf;
+    image_t *src;
+    jpeg_subsampling_t subsampling;
+    int mcu_h; // MCU row height
+    int mcu_rows;
+    int mcu_row; // next MCU row to write
+} jpeg_encoder_t;
+
+// Rate control, adjusts the quality from frame to frame toward a target size per frame or a
+// target bitrate (the frame size then follows the frame rate).
+typedef struct jpeg_rate {
+    uint32_t frame_size;    // Target size of a frame in bytes, or 0.
+    uint32_t bitrate;       // Target bits per second, or 0.
+    int quality_min, quality_max;
+    int quality;            // Quality of the next frame.
+    float scale;            // Quantization scale of the next frame.
+} jpeg_rate_t;
+
 // Old Image Macros - Will be refactor and removed. But, only after making sure through testing new macros work.
 
 // Image kernels
@@ -849,8 +1035,14 @@ typedef struct simple_color {
 
 typedef struct integral_image {
     int w;
-    int h;
-    uint32_t *data;
+    int h;          // Rows held, fewer than the source's for a stripe.
+    int y_base;     // First source row summed.
+    int y_next;     // Next source row to sum.
+    bool wide;      // 64-bit rows.
+    union {
+        uint32_t *data;
+        uint64_t *data64;
+    };
 } i_image_t;
 
 typedef struct {
@@ -861,6 +1053,7 @@ typedef struct {
     int y_ratio;
     uint32_t **data;
     uint32_t **swap;
+    uint16_t *x_map;
 } mw_image_t;
 
 typedef struct _vector {
@@ -875,8 +1068,15 @@ typedef struct cluster {
     array_t *points;
 } cluster_t;
 
-// Return the distance between a cluster centroid and some object.
-typedef float (*cluster_dist_t) (int cx, int cy, void *obj);
+// K-means over n points of 2 (positions) or 3 (colors) dimensions, stored as one array per
+// dimension. Centers are set to the initial guesses by the caller and hold the result.
+typedef struct kmeans {
+    int n, k, dims;
+    int16_t *points[3];
+    uint32_t *weights;  // Optional point weights, NULL weights all points 1.
+    int16_t *centers[3];
+    uint16_t *labels;   // Nearest center of each point.
+} kmeans_t;
 
 /* Keypoint */
 typedef struct kp {
@@ -889,14 +1089,57 @@ typedef struct kp {
     uint8_t desc[32];
 } kp_t;
 
+/* Keypoint descriptor index. Each table holds (substring << 16) | keypoint index, sorted. */
+typedef struct orb_index {
+    int size;
+    uint32_t *tables;
+} orb_index_t;
+
 typedef struct size {
     int w;
     int h;
 } wsize_t;
 
+/* Image pyramid */
+#define IMAGE_PYRAMID_MAX_LEVELS    8
+typedef struct image_pyramid {
+    int n_levels;                   // Number of valid levels.
+    float scale_factor;             // Scale between two consecutive levels.
+    void *src_data;                 // Source image the levels were computed from.
+    int src_w, src_h;
+    pixformat_t src_pixfmt;
+    bool copy;                      // Level 0 is always a copy, so it outlives the source frame.
+    image_t levels[IMAGE_PYRAMID_MAX_LEVELS]; // Grayscale, level 0 is full size.
+} image_pyramid_t;
+
+/* Optical flow */
+typedef struct flow_vector {
+    float x, y;     // Position in the full size frame.
+    float dx, dy;   // Motion since the previous frame.
+    bool valid;
+} flow_vector_t;
+
+/* Background model */
+typedef struct background_model {
+    int w, h;
+    int rate;                       // Learning rate is 1 / 2^rate.
+    uint32_t threshold;             // Foreground beyond sqrt(threshold) deviations, Q4.
+    uint16_t min_var;               // Variance floor, Q4.
+    uint32_t *state;                // Per pixel variance (Q4) << 16 | mean (Q8).
+    image_t mask;                   // Binary foreground mask of the last update.
+} background_model_t;
+
+/* Temporal noise filter */
+typedef struct temporal_filter {
+    int w, h;
+    pixformat_t pixfmt;
+    uint16_t weight[256];           // Blend weight by pixel difference, Q8.
+    int16_t delta[511];             // Grayscale blend step by pixel difference + 255.
+    image_t ref;                    // Filtered previous frame.
+} temporal_filter_t;
+
 /* Haar cascade struct */
 typedef struct cascade {
-    int std;                        // Image standard deviation.
     int step;                       // Image scanning factor.
     float threshold;                // Detection threshold.
     float scale_factor;             // Image scaling factor.
@@ -915,8 +1158,32 @@ typedef struct cascade {
     int8_t *num_rectangles_array;   // Number of rectangles per features (1 per feature).
     int8_t *weights_array;          // Rectangles weights (1 per rectangle).
     int8_t *rectangles_array;       // Rectangles array.
+    void *data;                     // Packed cascade the arrays point into, if loaded from a file.
 } cascade_t;
 
+// Packed cascades are stored little-endian with each array at a 4-byte aligned offset from the
+// start of the data, so they are used in place (e.g. from flash) without any parsing.
+#define CASCADE_PACKED_MAGIC        (0x43564D4F) // "OMVC"
+#define CASCADE_PACKED_VERSION      (1)
+
+typedef struct cascade_packed {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t n_stages;
+    uint16_t window_w;
+    uint16_t window_h;
+    uint32_t n_features;
+    uint32_t n_rectangles;
+    uint32_t stages_offset;         // uint8_t[n_stages]
+    uint32_t stages_thresh_offset;  // int16_t[n_stages]
+    uint32_t tree_thresh_offset;    // int16_t[n_features]
+    uint32_t alpha1_offset;         // int16_t[n_features]
+    uint32_t alpha2_offset;         // int16_t[n_features]
+    uint32_t num_rectangles_offset; // int8_t[n_features]
+    uint32_t weights_offset;        // int8_t[n_rectangles]
+    uint32_t rectangles_offset;     // int8_t[n_rectangles * 4]
+} cascade_packed_t;
+
 typedef struct bmp_read_settings {
     int32_t bmp_w;
     int32_t bmp_h;
@@ -995,6 +1262,69 @@ typedef struct histogram {
     float *BBins;
 } histogram_t;
 
+// Integral of per-tile histograms over the tile grid, any ROI is answered from the whole
+// tiles (4 lookups per bin) plus a scan of the partial tiles on its border.
+typedef struct histogram_cache {
+    int w, h;
+    pixformat_t pixfmt;
+    int tile;
+    int tiles_w, tiles_h;
+    int LBinCount;
+    int ABinCount;
+    int BBinCount;
+    uint32_t *data;         // (tiles_h + 1) x (tiles_w + 1) x (L + A + B) bins.
+} histogram_cache_t;
+
+// Remap table for geometric corrections. The source position of each output pixel is stored
+// every REMAP_CELL pixels on a grid covering the image, in 16.16 fixed-point, and linearly
+// interpolated in between.
+#define REMAP_CELL_SHIFT    (3)
+#define REMAP_CELL          (1 << REMAP_CELL_SHIFT)
+typedef struct remap {
+    int w, h;
+    int grid_w, grid_h;
+    int32_t *grid;          // grid_h x grid_w (x, y) source positions.
+} remap_t;
+
+// Debayers a bayer image row by row as it arrives, e.g. during capture. Only the last
+// DEBAYER_STREAM_ROWS raw rows are kept, in a ring of w byte rows.
+#define DEBAYER_STREAM_ROWS    (4)
+typedef struct debayer_stream {
+    int w, h;
+    pixformat_t pixfmt;     // Bayer pattern of the raw rows.
+    uint8_t *rows;
+} debayer_stream_t;
+
+// Fused ISP stage settings, see imlib_isp().
+typedef struct isp_config {
+    bool awb;               // Apply white balance gains computed from the statistics passed in.
+    bool awb_max;           // Collect white patch (max) instead of gray world (mean) statistics.
+    bool ccm_enable;
+    bool ccm_offset;
+    float ccm[12];          // 3x4 row-major, as for imlib_ccm().
+    float gamma, contrast, brightness;
+    int row_step;           // Statistics are collected on every row_step'th row (row pair for bayer).
+} isp_config_t;
+
+// White balance statistics in the units of imlib_awb_rgb_avg() or imlib_awb_rgb_max().
+typedef struct isp_stats {
+    uint32_t r, g, b;
+} isp_stats_t;
+
+// Per-pixel lookup table, see imlib_apply_lut(). Channel LUTs map the 8-bit gray or red, green
+// and blue values through their own tables (grayscale images use the red table). RGB565 LUTs map
+// each RGB565 pixel to another and only apply to RGB565 images.
+typedef enum {
+    LUT_TYPE_CHANNEL,
+    LUT_TYPE_RGB565,
+} lut_type_t;
+
+#define LUT_CHANNEL_SIZE    (256)
+typedef struct lut {
+    lut_type_t type;
+    uint8_t *table;         // 3x256 r, g, b entries or 65536 uint16_t RGB565 pixels.
+} lut_t;
+
 typedef struct percentile {
     uint8_t LValue;
     int8_t AValue;
@@ -1016,6 +1346,11 @@ typedef struct statistics {
 #define FIND_BLOBS_CORNERS_RESOLUTION    20 // multiple of 4
 #define FIND_BLOBS_ANGLE_RESOLUTION      (360 / FIND_BLOBS_CORNERS_RESOLUTION)
 
+// Optional blob properties, the rect, centroid, pixels and perimeter are always computed.
+#define FIND_BLOBS_PROP_CORNERS          (1 << 0) // all corners, else only the 4 bounding ones.
+#define FIND_BLOBS_PROP_MOMENTS          (1 << 1) // rotation and roundness, else 0.
+#define FIND_BLOBS_PROP_ALL              (FIND_BLOBS_PROP_CORNERS | FIND_BLOBS_PROP_MOMENTS)
+
 typedef struct find_blobs_list_lnk_data {
     point_t corners[FIND_BLOBS_CORNERS_RESOLUTION];
     rectangle_t rect;
@@ -1067,6 +1402,9 @@ typedef struct find_apriltags_list_lnk_data {
     uint8_t family, hamming;
     float centroid_x, centroid_y;
     float goodness, decision_margin;
+    // The pose is solved on demand from the homography, see imlib_apriltag_pose().
+    bool has_pose;
+    float pose_h[9];        // Homography scaled by the inverse camera matrix.
     float x_translation, y_translation, z_translation;
     float x_rotation, y_rotation, z_rotation;
 } find_apriltags_list_lnk_data_t;
@@ -1162,6 +1500,17 @@ void imlib_fill_image_from_float(image_t *img, int w, int h, float *data, float
 pixformat_t imlib_bayer_shift(pixformat_t pixfmt, int x, int y, bool transpose);
 void imlib_debayer_line(int x_start, int x_end, int y_row, void *dst_row_ptr, pixformat_t pixfmt, image_t *src);
 void imlib_debayer_image(image_t *dst, image_t *src);
+void imlib_debayer_stream_init(debayer_stream_t *stream, int w, int h, pixformat_t pixfmt, uint8_t *rows);
+void imlib_debayer_stream_push(debayer_stream_t *stream, int y, const uint8_t *src_row, image_t *dst);
+
+// Packed RAW Image Processing
+void imlib_raw_pack_row(pixformat_t pixfmt, int w, const uint16_t *src, uint8_t *dst);
+void imlib_raw_unpack_row(pixformat_t pixfmt, int w, const uint8_t *src, uint16_t *dst);
+int imlib_raw_get_pixel(image_t *img, int x, int y);
+void imlib_raw_stats(image_t *img, int row_step, uint32_t *mean, uint32_t *max, uint32_t *hist, int bins);
+void imlib_raw_luts(uint8_t *luts, int bits, int white, const float *gains,
+                    float gamma, float contrast, float brightness);
+void imlib_raw_develop(image_t *dst, image_t *src, const uint8_t *luts);
 
 // YUV Image Processing
 pixformat_t imlib_yuv_shift(pixformat_t pixfmt, int x);
@@ -1172,6 +1521,12 @@ void imlib_deyuv_image(image_t *dst, image_t *src);
 int8_t imlib_rgb565_to_l(uint16_t pixel);
 int8_t imlib_rgb565_to_a(uint16_t pixel);
 int8_t imlib_rgb565_to_b(uint16_t pixel);
+uint32_t imlib_rgb565_to_lab(uint16_t pixel);
+void imlib_rgb565_threshold_row(uint32_t *bmp_row, uint16_t *row_ptr, int x_start, int x_end,
+                                color_thresholds_list_lnk_data_t *threshold, bool invert);
+void imlib_color_thresholds_masks_init(color_thresholds_masks_t *masks, list_t *thresholds);
+uint32_t imlib_grayscale_thresholds_mask(const color_thresholds_masks_t *masks, uint8_t pixel);
+uint32_t imlib_rgb565_thresholds_mask(const color_thresholds_masks_t *masks, uint16_t pixel);
 uint16_t imlib_lab_to_rgb(uint8_t l, int8_t a, int8_t b);
 uint16_t imlib_yuv_to_rgb(uint8_t y, int8_t u, int8_t v);
 
@@ -1191,9 +1546,44 @@ void imlib_hardware_jpeg_deinit();
 void jpeg_get_mcu(image_t *src, int x_offset, int y_offset, int dx, int dy,
                   int8_t *Y0, int8_t *CB, int8_t *CR);
 void jpeg_decompress(image_t *dst, image_t *src);
+#if (OMV_JPEG_CODEC_ENABLE == 0)
+// Called for every decoded MCU row: rows [y_start, y_end) of img are valid, this includes up to
+// halo rows from the previous MCU row. Return false to stop decoding. With an roi only pixels
+// in the MCUs covering the roi are valid, and decoding stops after its last MCU row.
+typedef bool (*jpeg_decompress_rows_callback_t) (image_t *img, int y_start, int y_end, void *arg);
+void jpeg_decompress_rows(image_t *src, pixformat_t pixfmt, int halo, rectangle_t *roi,
+                          jpeg_decompress_rows_callback_t callback, void *callback_arg);
+#endif
 bool jpeg_compress(image_t *src, image_t *dst, int quality, bool realloc, jpeg_subsampling_t subsampling);
+#if (OMV_JPEG_CODEC_ENABLE == 0)
+// Compresses through a buffer of at least JPEG_STREAM_MIN_SIZE bytes, handing it to the
+// callback whenever it fills and once more at the end. Returns true on overflow or if the
+// callback failed, otherwise the total size is returned in size.
+#define JPEG_STREAM_MIN_SIZE    (1024)
+bool jpeg_compress_stream(image_t *src, int quality, jpeg_subsampling_t subsampling, uint8_t *buf, uint32_t length,
+                          jpeg_flush_callback_t flush, void *flush_arg, uint32_t *size);
+// Incremental encoder, emits one restart interval per MCU row. MCU rows can be encoded as the
+// source rows arrive (jpeg_encoder_write) or as independent strips into separate buffers that
+// are then appended in order (jpeg_encoder_strip/jpeg_encoder_append).
+bool jpeg_encoder_init(jpeg_encoder_t *enc, image_t *src, image_t *dst, int quality, bool realloc,
+                       jpeg_subsampling_t subsampling);
+bool jpeg_encoder_strip(jpeg_encoder_t *enc, jpeg_buf_t *jpeg_buf, int mcu_row_start, int mcu_row_end);
+bool jpeg_encoder_append(jpeg_encoder_t *enc, jpeg_buf_t *jpeg_buf, int mcu_rows);
+bool jpeg_encoder_write(jpeg_encoder_t *enc, int y_end);
+bool jpeg_encoder_finish(jpeg_encoder_t *enc, image_t *dst);
+#endif
 bool jpeg_is_valid(image_t *img);
-int jpeg_clean_trailing_bytes(int bpp, uint8_t *data);
+#ifdef IMLIB_ENABLE_IMAGE_IO
+// Lossless delta + LZ4 compression of uncompressed images. Returns 0 if the image doesn't
+// compress into out_size bytes or there's no frame buffer memory left to compress it.
+size_t imlib_lz4_compress(image_t *img, uint8_t *out, size_t out_size);
+// Decompresses into img->data, img must be the same size and format. Returns false if corrupt.
+bool imlib_lz4_decompress(image_t *img, const uint8_t *in, size_t in_size);
+#endif
+void jpeg_rate_init(jpeg_rate_t *rate, uint32_t frame_size, uint32_t bitrate, int quality_min, int quality_max);
+int jpeg_rate_update(jpeg_rate_t *rate, uint32_t size, bool overflow, uint32_t elapsed_us);
+// Returns the size up to the EOI marker if it's within the last search bytes, else size.
+int jpeg_clean_trailing_bytes(int size, uint8_t *data, int search);
 void jpeg_read_geometry(FIL *fp, image_t *img, const char *path, jpg_read_settings_t *rs);
 void jpeg_read_pixels(FIL *fp, image_t *img);
 void jpeg_read(image_t *img, const char *path);
@@ -1206,21 +1596,38 @@ void png_read(image_t *img, const char *path);
 void png_write(image_t *img, const char *path);
 bool imlib_read_geometry(FIL *fp, image_t *img, const char *path, img_read_settings_t *rs);
 void imlib_image_operation(image_t *img, const char *path, image_t *other, int scalar, line_op_t op, void *data);
+void imlib_image_operation_mask(image_t *img, const char *path, image_t *other, int scalar,
+                                line_op_t op, void *data, image_t *mask);
 void imlib_load_image(image_t *img, const char *path);
 void imlib_save_image(image_t *img, const char *path, rectangle_t *roi, int quality);
 
 /* GIF functions */
-void gif_open(FIL *fp, int width, int height, bool color, bool loop);
-void gif_add_frame(FIL *fp, image_t *img, uint16_t delay);
+void gif_open(FIL *fp, int width, int height, bool color, bool loop, bool transparency);
+void gif_add_frame(FIL *fp, image_t *img, uint16_t delay, uint8_t *prev, bool adaptive);
 void gif_close(FIL *fp);
 
 /* MJPEG functions */
-void mjpeg_open(FIL *fp, int width, int height);
-void mjpeg_write(FIL *fp, int width, int height, uint32_t *frames, uint32_t *bytes,
+typedef struct mjpeg {
+    uint32_t frames;        // frames written
+    uint32_t bytes;         // size of the frames written
+    uint32_t riff_offset;   // current RIFF chunk
+    uint32_t movi_offset;   // movi list of the current RIFF chunk
+    uint32_t riff_start;    // frames before the current RIFF chunk
+    uint32_t avi_frames;    // frames in the first RIFF chunk, once it's done
+    uint32_t *index;        // (offset, size) of the frames after the last index chunk
+    uint32_t index_count;
+    uint32_t *super_index;  // (offset, size, frames) of the index chunks
+    uint32_t super_count;
+    uint32_t super_synced;  // index chunks already in the header
+    bool has_idx1;          // the first RIFF chunk is done
+} mjpeg_t;
+
+void mjpeg_open(FIL *fp, mjpeg_t *mjpeg, int width, int height);
+void mjpeg_write(FIL *fp, mjpeg_t *mjpeg, int width, int height,
                  image_t *img, int quality, rectangle_t *roi, int rgb_channel, int alpha,
                  const uint16_t *color_palette, const uint8_t *alpha_palette, image_hint_t hint);
-void mjpeg_sync(FIL *fp, uint32_t frames, uint32_t bytes, uint32_t us_avg);
-void mjpeg_close(FIL *fp, uint32_t frames, uint32_t bytes, uint32_t us_avg);
+void mjpeg_sync(FIL *fp, mjpeg_t *mjpeg, uint32_t us_avg);
+void mjpeg_close(FIL *fp, mjpeg_t *mjpeg, uint32_t us_avg);
 
 /* Point functions */
 point_t *point_alloc(int16_t x, int16_t y);
@@ -1249,15 +1656,22 @@ float imlib_template_match_ds(image_t *image, image_t *t, rectangle_t *r);
 float imlib_template_match_ex(image_t *image, image_t *t, rectangle_t *roi, int step, rectangle_t *r);
 
 /* Clustering functions */
-array_t *cluster_kmeans(array_t *points, int k, cluster_dist_t dist_func);
+int kmeans_run(kmeans_t *km, int max_iterations, int min_delta);
+array_t *cluster_kmeans(array_t *points, int k);
 
 /* Integral image functions */
 void imlib_integral_image_alloc(struct integral_image *sum, int w, int h);
+void imlib_integral_image_alloc_sq(struct integral_image *sum, int w, int h, int area);
 void imlib_integral_image_free(struct integral_image *sum);
 void imlib_integral_image(struct image *src, struct integral_image *sum);
 void imlib_integral_image_sq(struct image *src, struct integral_image *sum);
+void imlib_integral_image_ss(struct image *src, struct integral_image *sum, struct integral_image *sumsq);
+void imlib_integral_image_rows(struct image *src, struct integral_image *sum, struct integral_image *sumsq, int y, int h);
 void imlib_integral_image_scaled(struct image *src, struct integral_image *sum);
-uint32_t imlib_integral_lookup(struct integral_image *src, int x, int y, int w, int h);
+void imlib_integral_row(const uint8_t *src, int w, uint32_t *sum, const uint32_t *prev);
+void imlib_integral_row_ss(const uint8_t *src, int w, uint32_t *sum, uint32_t *ssq,
+                           const uint32_t *sum_prev, const uint32_t *ssq_prev);
+uint64_t imlib_integral_lookup(struct integral_image *src, int x, int y, int w, int h);
 
 // Integral moving window
 void imlib_integral_mw_alloc(mw_image_t *sum, int w, int h);
@@ -1273,16 +1687,87 @@ long imlib_integral_mw_lookup(mw_image_t *sum, int x, int y, int w, int h);
 
 /* Haar/VJ */
 int imlib_load_cascade(struct cascade *cascade, const char *path);
-array_t *imlib_detect_objects(struct image *image, struct cascade *cascade, struct rectangle *roi);
+int imlib_load_cascade_from_buffer(struct cascade *cascade, const void *data, size_t size);
+array_t *imlib_detect_objects(struct image *image, struct cascade *cascade, struct rectangle *roi,
+                              image_pyramid_t *pyramid);
 
 /* Corner detectors */
 void fast_detect(image_t *image, array_t *keypoints, int threshold, rectangle_t *roi);
 void agast_detect(image_t *image, array_t *keypoints, int threshold, rectangle_t *roi);
 
+/* Strip-mined line operators */
+typedef void (*imlib_strip_cb_t)(image_t *band, void *arg);
+void imlib_strip_run(image_t *img, int radius, int rows, imlib_strip_cb_t cb, void *cb_arg);
+
+typedef enum imlib_pipeline_op_type {
+    IMLIB_PIPELINE_BINARY,
+    IMLIB_PIPELINE_INVERT,
+    IMLIB_PIPELINE_ERODE,
+    IMLIB_PIPELINE_DILATE,
+    IMLIB_PIPELINE_OPEN,
+    IMLIB_PIPELINE_CLOSE,
+    IMLIB_PIPELINE_MEAN,
+    IMLIB_PIPELINE_MEDIAN,
+    IMLIB_PIPELINE_MODE,
+    IMLIB_PIPELINE_MIDPOINT,
+} imlib_pipeline_op_type_t;
+
+typedef struct imlib_pipeline_op {
+    imlib_pipeline_op_type_t type;
+    int ksize;
+    int threshold;      // erode, dilate, open and close.
+    float arg;          // median percentile or midpoint bias.
+    bool invert;        // binary.
+    list_t thresholds;  // binary.
+} imlib_pipeline_op_t;
+
+typedef struct imlib_pipeline {
+    int n_ops;
+    int rows;
+    imlib_pipeline_op_t *ops;
+} imlib_pipeline_t;
+
+int imlib_pipeline_radius(const imlib_pipeline_op_t *ops, int n_ops);
+void imlib_pipeline_run(image_t *img, imlib_pipeline_t *pipeline);
+
+/* Image pyramid */
+void imlib_pyramid_init(image_pyramid_t *pyr);
+void imlib_pyramid_build(image_pyramid_t *pyr, image_t *img, int n_levels, float scale_factor);
+void imlib_pyramid_free(image_pyramid_t *pyr);
+bool imlib_pyramid_is_valid(image_pyramid_t *pyr, image_t *img);
+image_t *imlib_pyramid_get_level(image_pyramid_t *pyr, int level);
+void imlib_pyramid_scale(image_t *src, image_t *dst);
+
+/* Optical flow */
+void imlib_optflow_lk(image_pyramid_t *prev, image_pyramid_t *next, flow_vector_t *vectors, int n,
+                      int window, int iterations);
+int imlib_optflow_block(image_pyramid_t *prev, image_pyramid_t *next, int level, int block, int search,
+                        flow_vector_t *vectors, int max_n);
+
+/* Background model */
+void imlib_background_init(background_model_t *bg, image_t *img, int rate, float threshold, float min_std);
+void imlib_background_reset(background_model_t *bg, image_t *img);
+void imlib_background_free(background_model_t *bg);
+int imlib_background_update(background_model_t *bg, image_t *img, bool learn);
+
+/* Temporal noise filter */
+void imlib_temporal_filter_init(temporal_filter_t *tf, image_t *img, int strength, int threshold);
+void imlib_temporal_filter_reset(temporal_filter_t *tf, image_t *img);
+void imlib_temporal_filter_free(temporal_filter_t *tf);
+void imlib_temporal_filter_update(temporal_filter_t *tf, image_t *img);
+
+/* Exposure fusion */
+#define IMLIB_HDR_MAX_FRAMES    (8)
+// Fuses img with n (< IMLIB_HDR_MAX_FRAMES) other exposures of the same size and format into img.
+void imlib_hdr_fuse(image_t *img, image_t *frames, int n);
+
 /* ORB descriptor */
 array_t *orb_find_keypoints(image_t *image, bool normalized, int threshold,
-                            float scale_factor, int max_keypoints, corner_detector_t corner_detector, rectangle_t *roi);
-int orb_match_keypoints(array_t *kpts1, array_t *kpts2, int *match, int threshold, rectangle_t *r, point_t *c, int *angle);
+                            float scale_factor, int max_keypoints, corner_detector_t corner_detector, rectangle_t *roi,
+                            image_pyramid_t *pyramid);
+orb_index_t *orb_index_build(array_t *kpts);
+int orb_match_keypoints(array_t *kpts1, array_t *kpts2, orb_index_t *index1, orb_index_t *index2,
+                        int *match, int threshold, rectangle_t *r, point_t *c, int *angle);
 int orb_filter_keypoints(array_t *kpts, rectangle_t *r, point_t *c);
 int orb_save_descriptor(FIL *fp, array_t *kpts);
 int orb_load_descriptor(FIL *fp, array_t *kpts);
@@ -1291,6 +1776,7 @@ float orb_cluster_dist(int cx, int cy, void *kp);
 /* LBP Operator */
 uint8_t *imlib_lbp_desc(image_t *image, rectangle_t *roi);
 int imlib_lbp_desc_distance(uint8_t *d0, uint8_t *d1);
+int imlib_lbp_desc_match(uint8_t *desc, uint8_t **gallery, int n, int *distance);
 int imlib_lbp_desc_save(FIL *fp, uint8_t *desc);
 int imlib_lbp_desc_load(FIL *fp, uint8_t **desc);
 
@@ -1304,9 +1790,12 @@ void im_filter_skin(uint8_t *src, uint8_t *dst, int size, int bpp, void *args);
 // Edge detection
 void imlib_edge_simple(image_t *src, rectangle_t *roi, int low_thresh, int high_thresh);
 void imlib_edge_canny(image_t *src, rectangle_t *roi, int low_thresh, int high_thresh);
+void imlib_sobel_row(image_t *img, int y, int x_start, int x_end, uint8_t *lines, int16_t *gx, int16_t *gy);
 
 // HoG
 void imlib_find_hog(image_t *src, rectangle_t *roi, int cell_size);
+int imlib_hog_desc_size(rectangle_t *roi, int cell_size);
+void imlib_hog_desc(image_t *src, rectangle_t *roi, int cell_size, uint8_t *desc);
 
 // Helper Functions
 void imlib_zero(image_t *img, image_t *mask, bool invert);
@@ -1337,6 +1826,7 @@ void imlib_flood_fill_int(image_t *out, image_t *img, int x, int y,
 int imlib_get_pixel(image_t *img, int x, int y);
 int imlib_get_pixel_fast(image_t *img, const void *row_ptr, int x);
 void imlib_set_pixel(image_t *img, int x, int y, int p);
+void imlib_binary_fill_row(uint32_t *row_ptr, int x_start, int x_end, int v);
 void imlib_draw_line(image_t *img, int x0, int y0, int x1, int y1, int c, int thickness);
 void imlib_draw_rectangle(image_t *img, int rx, int ry, int rw, int rh, int c, int thickness, bool fill);
 void imlib_draw_circle(image_t *img, int cx, int cy, int r, int c, int thickness, bool fill);
@@ -1380,6 +1870,11 @@ void imlib_awb_rgb_max(image_t *img, uint32_t *r_out, uint32_t *g_out, uint32_t
 void imlib_awb(image_t *img, uint32_t r_out, uint32_t g_out, uint32_t b_out);
 void imlib_ccm(image_t *img, float *ccm, bool offset);
 void imlib_gamma(image_t *img, float gamma, float scale, float offset);
+void imlib_isp(image_t *img, const isp_config_t *config, isp_stats_t *stats);
+size_t imlib_lut_size(lut_type_t type);
+void imlib_lut_gamma(lut_t *lut, float gamma, float contrast, float brightness);
+void imlib_lut_compose(lut_t *dst, lut_t *first, lut_t *second);
+void imlib_apply_lut(image_t *img, lut_t *lut);
 // Binary Functions
 void imlib_zero_line_op(int x, int x_end, int y_row, imlib_draw_row_data_t *data);
 void imlib_mask_line_op(int x, int x_end, int y_row, imlib_draw_row_data_t *data);
@@ -1432,6 +1927,8 @@ void imlib_morph(image_t *img,
                  int offset,
                  bool invert,
                  image_t *mask);
+// Blurs with the ((ksize * 2) + 1)^2 binomial kernel, GRAYSCALE and RGB565 only.
+void imlib_gaussian_filter(image_t *img, const int ksize, bool threshold, int offset, bool invert);
 void imlib_bilateral_filter(image_t *img,
                             const int ksize,
                             float color_sigma,
@@ -1440,6 +1937,14 @@ void imlib_bilateral_filter(image_t *img,
                             int offset,
                             bool invert,
                             image_t *mask);
+// Constant time approximation of the bilateral filter, GRAYSCALE and RGB565 only.
+void imlib_bilateral_grid(image_t *img,
+                          const int ksize,
+                          float color_sigma,
+                          float space_sigma,
+                          bool threshold,
+                          int offset,
+                          bool invert);
 // Image Correction
 void imlib_logpolar_int(image_t *dst, image_t *src, rectangle_t *roi, bool linear, bool reverse); // helper/internal
 void imlib_logpolar(image_t *img, bool linear, bool reverse);
@@ -1448,6 +1953,19 @@ void imlib_lens_corr(image_t *img, float strength, float zoom, float x_corr, flo
 void imlib_rotation_corr(image_t *img, float x_rotation, float y_rotation,
                          float z_rotation, float x_translation, float y_translation,
                          float zoom, float fov, float *corners);
+void imlib_remap_init(remap_t *map, int w, int h);
+size_t imlib_remap_size(remap_t *map);
+void imlib_remap_lens_corr(remap_t *map, float strength, float zoom, float x_corr, float y_corr);
+void imlib_remap_homography(remap_t *map, float *T);
+void imlib_remap_rotation_corr(remap_t *map, float x_rotation, float y_rotation,
+                               float z_rotation, float x_translation,
+                               float y_translation, float zoom, float fov, float *corners);
+void imlib_remap_compose(remap_t *dst, remap_t *first, remap_t *second);
+void imlib_remap(image_t *img, remap_t *map, bool bilinear);
+// T is a row major 3x3 matrix mapping dst pixels to roi relative src pixels.
+void imlib_warp(image_t *dst, image_t *src, rectangle_t *roi, float *T, bool bilinear);
+void imlib_fuse(image_t *dst, image_t *thermal, remap_t *map, float *T, bool bilinear,
+                int alpha, const uint16_t *color_palette, const uint8_t *alpha_palette);
 // Statistics
 void imlib_get_similarity(image_t *img,
                           image_t *other,
@@ -1462,11 +1980,45 @@ void imlib_get_similarity(image_t *img,
                           const uint8_t *alpha_palette,
                           image_hint_t hint,
                           bool dssim,
+                          int step,
                           float *avg,
                           float *std,
                           float *min,
                           float *max);
-void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_t *thresholds, bool invert, image_t *other);
+void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_t *thresholds, bool invert, image_t *other,
+                         int x_stride, int y_stride);
+void imlib_histogram_cache_init(histogram_cache_t *cache, image_t *img, int tile, int l_bins, int a_bins, int b_bins);
+size_t imlib_histogram_cache_size(histogram_cache_t *cache);
+void imlib_histogram_cache_build(histogram_cache_t *cache, image_t *img);
+void imlib_histogram_cache_get(histogram_cache_t *cache, histogram_t *out, image_t *img, rectangle_t *roi);
+// Grayscale row band kernels, split with the Cortex-M4 on dual-core parts (see task.c).
+// The histogram has 256 bins and is added to, the LUT has 256 entries and is applied in-place.
+void imlib_task_histogram_grayscale(image_t *img, rectangle_t *roi, uint32_t *hist);
+void imlib_task_lut_grayscale(image_t *img, rectangle_t *roi, const uint8_t *lut);
+// Tile kernels, run on one band of the ROI per core with a result per tile (see task.c).
+typedef struct imlib_tile imlib_tile_t;
+typedef struct imlib_tile_kernel {
+    int halo;               // Rows above and below its tile that the kernel reads.
+    size_t result_size;
+    size_t scratch_size;    // Per-tile arena, see imlib_tile_alloc().
+    void (*init)(void *result, void *arg);  // Sets up a tile result, NULL to zero it.
+    void (*run)(imlib_tile_t *tile);        // Must not raise, call into MicroPython or fb_alloc.
+    void (*reduce)(void *result, const void *tile_result, void *arg);
+    int cm4_kernel;         // CM4 firmware kernel doing the same as run(), or -1.
+} imlib_tile_kernel_t;
+struct imlib_tile {
+    image_t *img;
+    rectangle_t rect;       // Rows of the ROI the tile owns.
+    void *result;
+    void *arg;
+    uint8_t *scratch;
+    size_t scratch_left;
+    const imlib_tile_kernel_t *kernel;
+};
+// Runs the kernel on the ROI and reduces each tile's result into result.
+void imlib_task_tiles(const imlib_tile_kernel_t *kernel, image_t *img, rectangle_t *roi, void *result, void *arg);
+// Allocates from the tile's scratch arena, returns NULL if it's exhausted.
+void *imlib_tile_alloc(imlib_tile_t *tile, size_t size);
 void imlib_get_percentile(percentile_t *out, pixformat_t pixfmt, histogram_t *ptr, float percentile);
 void imlib_get_threshold(threshold_t *out, pixformat_t pixfmt, histogram_t *ptr);
 void imlib_get_statistics(statistics_t *out, pixformat_t pixfmt, histogram_t *ptr);
@@ -1486,12 +2038,13 @@ void imlib_find_blobs(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int
                       bool merge, int margin,
                       bool (*threshold_cb) (void *, find_blobs_list_lnk_data_t *), void *threshold_cb_arg,
                       bool (*merge_cb) (void *, find_blobs_list_lnk_data_t *, find_blobs_list_lnk_data_t *), void *merge_cb_arg,
-                      unsigned int x_hist_bins_max, unsigned int y_hist_bins_max);
+                      unsigned int x_hist_bins_max, unsigned int y_hist_bins_max, unsigned int properties,
+                      pool_t *pool);
 // Shape Detection
 size_t trace_line(image_t *ptr, line_t *l, int *theta_buffer, uint32_t *mag_buffer, point_t *point_buffer); // helper/internal
 void merge_alot(list_t *out, int threshold, int theta_threshold); // helper/internal
 void imlib_find_lines(list_t *out, image_t *ptr, rectangle_t *roi, unsigned int x_stride, unsigned int y_stride,
-                      uint32_t threshold, unsigned int theta_margin, unsigned int rho_margin);
+                      uint32_t threshold, unsigned int theta_margin, unsigned int rho_margin, pool_t *pool);
 void imlib_lsd_find_line_segments(list_t *out,
                                   image_t *ptr,
                                   rectangle_t *roi,
@@ -1508,9 +2061,13 @@ void imlib_find_rects(list_t *out, image_t *ptr, rectangle_t *roi,
 // 1/2D Bar Codes
 void imlib_find_qrcodes(list_t *out, image_t *ptr, rectangle_t *roi);
 void imlib_find_apriltags(list_t *out, image_t *ptr, rectangle_t *roi, apriltag_families_t families,
-                          float fx, float fy, float cx, float cy);
-void imlib_find_datamatrices(list_t *out, image_t *ptr, rectangle_t *roi, int effort);
-void imlib_find_barcodes(list_t *out, image_t *ptr, rectangle_t *roi);
+                          float fx, float fy, float cx, float cy, int decimate, float sigma, bool refine_edges,
+                          bool pose, pool_t *pool, list_t *rects_out, uint32_t rects_threshold);
+// Solves the tag pose if it wasn't yet.
+void imlib_apriltag_pose(find_apriltags_list_lnk_data_t *tag);
+void imlib_find_datamatrices(list_t *out, image_t *ptr, rectangle_t *roi, int effort, uint32_t timeout_us,
+                             rectangle_t *hints, size_t hints_len);
+void imlib_find_barcodes(list_t *out, image_t *ptr, rectangle_t *roi, uint32_t types, int count);
 // Template Matching
 void imlib_phasecorrelate(image_t *img0,
                           image_t *img1,
@@ -1524,7 +2081,7 @@ void imlib_phasecorrelate(image_t *img0,
                           float *scale,
                           float *response);
 // Stereo Imaging
-void imlib_stereo_disparity(image_t *img, bool reversed, int max_disparity, int threshold);
+void imlib_stereo_disparity(image_t *img, bool reversed, int max_disparity, int threshold, bool census, bool lr_check);
 
 array_t *imlib_selective_search(image_t *src, float t, int min_size, float a1, float a2, float a3);
 #endif //__IMLIB_H__
@@ -7,17 +7,38 @@
  * This work is licensed under the MIT license, see the file LICENSE for details.
  *
  * Integral image.
+ *
+ * An integral image holds either all rows of the source image or a stripe of the last h rows
+ * summed, stored as a ring. A stripe sums the source rows from y_base on, lookups of windows
+ * starting at or below y_base stay valid while the window's rows are in the ring, and
+ * imlib_integral_image_rows() advances or restarts the stripe as needed.
+ *
+ * Rows are 32-bit and wrap around, lookups are modulo 2^32 so any window whose sum fits in 32
+ * bits is exact. Squared images of windows that may not fit (more than 66051 pixels) use 64-bit
+ * rows, imlib_integral_image_alloc_sq() picks the width from the largest window looked up.
  */
 #include <stdlib.h>
 #include <string.h>
 #include <arm_math.h>
 #include "imlib.h"
 #include "fb_alloc.h"
+#include "omv_common.h"
 
-void imlib_integral_image_alloc(i_image_t *sum, int w, int h) {
+static void integral_image_alloc(i_image_t *sum, int w, int h, bool wide) {
     sum->w = w;
     sum->h = h;
-    sum->data = fb_alloc(w * h * sizeof(*sum->data), FB_ALLOC_NO_HINT);
+    sum->y_base = 0;
+    sum->y_next = 0;
+    sum->wide = wide;
+    sum->data = fb_alloc(w * h * (wide ? sizeof(*sum->data64) : sizeof(*sum->data)), FB_ALLOC_NO_HINT);
+}
+
+void imlib_integral_image_alloc(i_image_t *sum, int w, int h) {
+    integral_image_alloc(sum, w, h, false);
+}
+
+void imlib_integral_image_alloc_sq(i_image_t *sum, int w, int h, int area) {
+    integral_image_alloc(sum, w, h, (((uint64_t) area) * (COLOR_GRAYSCALE_MAX * COLOR_GRAYSCALE_MAX)) > UINT32_MAX);
 }
 
 void imlib_integral_image_free(i_image_t *sum) {
@@ -25,27 +46,170 @@ void imlib_integral_image_free(i_image_t *sum) {
     fb_free();
 }
 
-void imlib_integral_image(image_t *src, i_image_t *sum) {
-    typeof(*src->data) * img_data = src->data;
-    typeof(*sum->data) * sum_data = sum->data;
+// Returns the ring slot of source row y.
+static inline int integral_image_slot(i_image_t *sum, int y) {
+    y -= sum->y_base;
+    return (y < sum->h) ? y : (y % sum->h);
+}
 
-    // Compute first column to avoid branching
-    for (int s = 0, x = 0; x < src->w; x++) {
-        /* sum of the current row (integer) */
-        s += img_data[x];
-        sum_data[x] = s;
+// Computes an integral row from a grayscale row, prev is the row above or NULL for the first row.
+OMV_ATTR_ALWAYS_INLINE static void integral_row(const uint8_t *src, int w, uint32_t *sum, const uint32_t *prev) {
+    uint32_t s = 0;
+    int x = 0;
+
+    #if defined(ARM_MATH_DSP)
+    // Four pixels per load, adding pixel pairs first halves the prefix sum dependency chain.
+    for (; (x + 4) <= w; x += 4) {
+        uint32_t p = *((uint32_t *) (src + x));
+        uint32_t p20 = __UXTB16(p);
+        uint32_t pairs = __UADD16(p20, __UXTB16_RORn(p, 8));
+        uint32_t s1 = s + (pairs & 0xFFFF);
+        uint32_t s0 = s + (p20 & 0xFFFF);
+        uint32_t s2 = s1 + (p20 >> 16);
+        s = s1 + (pairs >> 16);
+        sum[x + 0] = s0 + (prev ? prev[x + 0] : 0);
+        sum[x + 1] = s1 + (prev ? prev[x + 1] : 0);
+        sum[x + 2] = s2 + (prev ? prev[x + 2] : 0);
+        sum[x + 3] = s + (prev ? prev[x + 3] : 0);
     }
+    #endif
 
-    for (int y = 1; y < src->h; y++) {
-        /* loop over the number of columns */
-        for (int s = 0, x = 0; x < src->w; x++) {
-            /* sum of the current row (integer) */
-            s += img_data[y * src->w + x];
-            sum_data[y * src->w + x] = s + sum_data[(y - 1) * src->w + x];
-        }
+    for (; x < w; x++) {
+        s += src[x];
+        sum[x] = s + (prev ? prev[x] : 0);
+    }
+}
+
+// Same as above for the summed and squared images in one pass.
+OMV_ATTR_ALWAYS_INLINE static void integral_row_ss(const uint8_t *src, int w, uint32_t *sum, uint32_t *ssq,
+                                                   const uint32_t *sum_prev, const uint32_t *ssq_prev) {
+    uint32_t s = 0, sq = 0;
+    int x = 0;
+
+    #if defined(ARM_MATH_DSP)
+    for (; (x + 4) <= w; x += 4) {
+        uint32_t p = *((uint32_t *) (src + x));
+        uint32_t p20 = __UXTB16(p);
+        uint32_t p31 = __UXTB16_RORn(p, 8);
+        uint32_t pairs = __UADD16(p20, p31);
+        uint32_t p10 = __PKHBT(p20, p31, 16);
+        uint32_t p32 = __PKHTB(p31, p20, 16);
+        uint32_t s1 = s + (pairs & 0xFFFF);
+        uint32_t s0 = s + (p20 & 0xFFFF);
+        uint32_t s2 = s1 + (p20 >> 16);
+        s = s1 + (pairs >> 16);
+        uint32_t sq1 = sq + __SMUAD(p10, p10);
+        uint32_t sq0 = sq + ((p20 & 0xFFFF) * (p20 & 0xFFFF));
+        uint32_t sq2 = sq1 + ((p20 >> 16) * (p20 >> 16));
+        sq = sq1 + __SMUAD(p32, p32);
+        sum[x + 0] = s0 + (sum_prev ? sum_prev[x + 0] : 0);
+        sum[x + 1] = s1 + (sum_prev ? sum_prev[x + 1] : 0);
+        sum[x + 2] = s2 + (sum_prev ? sum_prev[x + 2] : 0);
+        sum[x + 3] = s + (sum_prev ? sum_prev[x + 3] : 0);
+        ssq[x + 0] = sq0 + (ssq_prev ? ssq_prev[x + 0] : 0);
+        ssq[x + 1] = sq1 + (ssq_prev ? ssq_prev[x + 1] : 0);
+        ssq[x + 2] = sq2 + (ssq_prev ? ssq_prev[x + 2] : 0);
+        ssq[x + 3] = sq + (ssq_prev ? ssq_prev[x + 3] : 0);
+    }
+    #endif
+
+    for (; x < w; x++) {
+        int pixel = src[x];
+        s += pixel;
+        sq += pixel * pixel;
+        sum[x] = s + (sum_prev ? sum_prev[x] : 0);
+        ssq[x] = sq + (ssq_prev ? ssq_prev[x] : 0);
+    }
+}
+
+void imlib_integral_row(const uint8_t *src, int w, uint32_t *sum, const uint32_t *prev) {
+    if (prev) {
+        integral_row(src, w, sum, prev);
+    } else {
+        integral_row(src, w, sum, NULL);
+    }
+}
+
+void imlib_integral_row_ss(const uint8_t *src, int w, uint32_t *sum, uint32_t *ssq,
+                           const uint32_t *sum_prev, const uint32_t *ssq_prev) {
+    if (sum_prev) {
+        integral_row_ss(src, w, sum, ssq, sum_prev, ssq_prev);
+    } else {
+        integral_row_ss(src, w, sum, ssq, NULL, NULL);
+    }
+}
+
+static void integral_row_sq(const uint8_t *src, int w, uint32_t *ssq, const uint32_t *prev) {
+    for (uint32_t sq = 0, x = 0; x < w; x++) {
+        sq += src[x] * src[x];
+        ssq[x] = sq + (prev ? prev[x] : 0);
     }
 }
 
+static void integral_row_sq64(const uint8_t *src, int w, uint64_t *ssq, const uint64_t *prev) {
+    for (uint64_t sq = 0, x = 0; x < w; x++) {
+        sq += src[x] * src[x];
+        ssq[x] = sq + (prev ? prev[x] : 0);
+    }
+}
+
+// Sums source row y into the next ring slot of sum and/or sumsq.
+static void integral_image_row(image_t *src, i_image_t *sum, i_image_t *sumsq, int y) {
+    i_image_t *ref = sum ? sum : sumsq;
+    const uint8_t *src_row = src->data + (y * src->w);
+    int row = integral_image_slot(ref, y) * ref->w;
+    int prev = (y > ref->y_base) ? (integral_image_slot(ref, y - 1) * ref->w) : -1;
+
+    if (sum && sumsq && !sumsq->wide) {
+        imlib_integral_row_ss(src_row, sum->w, sum->data + row, sumsq->data + row,
+                              (prev >= 0) ? (sum->data + prev) : NULL,
+                              (prev >= 0) ? (sumsq->data + prev) : NULL);
+        return;
+    }
+
+    if (sum) {
+        imlib_integral_row(src_row, sum->w, sum->data + row, (prev >= 0) ? (sum->data + prev) : NULL);
+    }
+
+    if (sumsq && sumsq->wide) {
+        integral_row_sq64(src_row, sumsq->w, sumsq->data64 + row, (prev >= 0) ? (sumsq->data64 + prev) : NULL);
+    } else if (sumsq) {
+        integral_row_sq(src_row, sumsq->w, sumsq->data + row, (prev >= 0) ? (sumsq->data + prev) : NULL);
+    }
+}
+
+void imlib_integral_image_rows(image_t *src, i_image_t *sum, i_image_t *sumsq, int y, int h) {
+    i_image_t *ref = sum ? sum : sumsq;
+    int y_end = y + h;
+
+    // Restart the stripe at y if the row above the window is gone, or if skipping rows.
+    if ((y < ref->y_base) || (y > ref->y_next) ||
+        ((y > ref->y_base) && ((y - 1) < (IM_MAX(ref->y_next, y_end) - ref->h)))) {
+        ref->y_base = ref->y_next = y;
+    }
+
+    for (; ref->y_next < y_end; ref->y_next++) {
+        integral_image_row(src, sum, sumsq, ref->y_next);
+    }
+
+    if (sum && sumsq) {
+        sumsq->y_base = sum->y_base;
+        sumsq->y_next = sum->y_next;
+    }
+}
+
+void imlib_integral_image(image_t *src, i_image_t *sum) {
+    imlib_integral_image_rows(src, sum, NULL, 0, sum->h);
+}
+
+void imlib_integral_image_sq(image_t *src, i_image_t *sum) {
+    imlib_integral_image_rows(src, NULL, sum, 0, sum->h);
+}
+
+void imlib_integral_image_ss(image_t *src, i_image_t *sum, i_image_t *sumsq) {
+    imlib_integral_image_rows(src, sum, sumsq, 0, sum->h);
+}
+
 void imlib_integral_image_scaled(image_t *src, i_image_t *sum) {
     typeof(*src->data) * img_data = src->data;
     typeof(*sum->data) * sum_data = sum->data;
@@ -72,41 +236,29 @@ void imlib_integral_image_scaled(image_t *src, i_image_t *sum) {
             sum_data[y * sum->w + x] = s + sum_data[(y - 1) * sum->w + x];
         }
     }
+
+    sum->y_next = sum->h;
 }
 
-void imlib_integral_image_sq(image_t *src, i_image_t *sum) {
-    typeof(*src->data) * img_data = src->data;
-    typeof(*sum->data) * sum_data = sum->data;
+uint64_t imlib_integral_lookup(i_image_t *sum, int x, int y, int w, int h) {
+    // Rows y - 1 and y + h - 1, the row above y_base is all zeros.
+    int top = (y > sum->y_base) ? (integral_image_slot(sum, y - 1) * sum->w) : -1;
+    int bottom = integral_image_slot(sum, y + h - 1) * sum->w;
+    int l = x - 1, r = x + w - 1;
 
-    // Compute first column to avoid branching
-    for (uint32_t s = 0, x = 0; x < src->w; x++) {
-        /* sum of the current row (integer) */
-        s += img_data[x] * img_data[x];
-        sum_data[x] = s;
-    }
-
-    for (uint32_t y = 1; y < src->h; y++) {
-        /* loop over the number of columns */
-        for (uint32_t s = 0, x = 0; x < src->w; x++) {
-            /* sum of the current row (integer) */
-            s += img_data[y * src->w + x] * img_data[y * src->w + x];
-            sum_data[y * src->w + x] = s + sum_data[(y - 1) * src->w + x];
+    if (sum->wide) {
+        uint64_t *data = sum->data64;
+        uint64_t s = data[bottom + r] - ((l >= 0) ? data[bottom + l] : 0);
+        if (top >= 0) {
+            s -= data[top + r] - ((l >= 0) ? data[top + l] : 0);
         }
-    }
-
-}
-
-uint32_t imlib_integral_lookup(i_image_t *sum, int x, int y, int w, int h) {
-#define PIXEL_AT(x, y) \
-    (sum->data[((y) - 1) * sum->w + ((x) - 1)])
-    if (x == 0 && y == 0) {
-        return PIXEL_AT(w, h);
-    } else if (y == 0) {
-        return PIXEL_AT(w + x, h) - PIXEL_AT(x, h);
-    } else if (x == 0) {
-        return PIXEL_AT(w, h + y) - PIXEL_AT(w, y);
+        return s;
     } else {
-        return PIXEL_AT(w + x, h + y) + PIXEL_AT(x, y) - PIXEL_AT(w + x, y) - PIXEL_AT(x, h + y);
+        uint32_t *data = sum->data;
+        uint32_t s = data[bottom + r] - ((l >= 0) ? data[bottom + l] : 0);
+        if (top >= 0) {
+            s -= data[top + r] - ((l >= 0) ? data[top + l] : 0);
+        }
+        return s;
     }
-#undef  PIXEL_AT
 }
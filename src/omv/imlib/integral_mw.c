@@ -46,6 +46,10 @@
  *
  *  Functions without a suffix compute/shift summed images, _sq suffix compute/shift
  *  summed squared images, and _ss compute/shift both summed and squared in a single pass.
+ *
+ *  The _ss functions sample source columns through x_map, which is computed once per
+ *  scale instead of once per pixel, and read each source row through a row pointer.
+ *  Unscaled grayscale rows share imlib_integral_row_ss() with the full integral image.
  */
 #include <stdlib.h>
 #include <stdio.h>
@@ -74,9 +78,16 @@ void imlib_integral_mw_alloc(mw_image_t *sum, int w, int h) {
     for (int i = 0; i < h; i++) {
         sum->data[i] = fb_alloc(w * sizeof(**sum->data), FB_ALLOC_NO_HINT);
     }
+
+    sum->x_map = fb_alloc(w * sizeof(*sum->x_map), FB_ALLOC_NO_HINT);
+
+    for (int x = 0; x < w; x++) {
+        sum->x_map[x] = (x * sum->x_ratio) >> 16;
+    }
 }
 
 void imlib_integral_mw_free(mw_image_t *sum) {
+    fb_free();  // Free x_map
     for (int i = 0; i < sum->h; i++) {
         fb_free();  // Free h lines
     }
@@ -93,6 +104,10 @@ void imlib_integral_mw_scale(rectangle_t *roi, mw_image_t *sum, int w, int h) {
     // Set scaling ratios
     sum->x_ratio = (int) ((roi->w << 16) / w) + 1;
     sum->y_ratio = (int) ((roi->h << 16) / h) + 1;
+
+    for (int x = 0; x < w; x++) {
+        sum->x_map[x] = (x * sum->x_ratio) >> 16;
+    }
 }
 
 void imlib_integral_mw(image_t *src, mw_image_t *sum) {
@@ -219,41 +234,52 @@ void imlib_integral_mw_shift_sq(image_t *src, mw_image_t *sum, int n) {
     }
 }
 
-void imlib_integral_mw_ss(image_t *src, mw_image_t *sum, mw_image_t *ssq, rectangle_t *roi) {
-    // Image data pointers
-    typeof(*sum->data) * sum_data = sum->data;
-    typeof(*sum->data) * ssq_data = ssq->data;
-
-    // Compute the first row to avoid branching
-    for (int sx, s = 0, sq = 0, x = 0; x < sum->w; x++) {
-        // X offset
-        sx = roi->x + ((x * sum->x_ratio) >> 16);
-
-        // Accumulate row data
-        s += IM_TO_GS_PIXEL(src, sx, roi->y);
-        sq += IM_TO_GS_PIXEL(src, sx, roi->y) * IM_TO_GS_PIXEL(src, sx, roi->y);
+// Computes row y of the summed and squared images from source row sy, starting at column x_offs.
+// Row y - 1 is added in unless y is 0.
+static void imlib_integral_mw_ss_row(image_t *src, mw_image_t *sum, mw_image_t *ssq, int x_offs, int sy, int y) {
+    uint32_t *sum_row = sum->data[y];
+    uint32_t *ssq_row = ssq->data[y];
+    uint16_t *x_map = sum->x_map;
+
+    if ((src->bpp == 1) && (sum->x_ratio == ((1 << 16) + 1))) {
+        // Unscaled, sum the source row directly.
+        imlib_integral_row_ss(src->pixels + (sy * src->w) + x_offs, sum->w, sum_row, ssq_row,
+                              (y > 0) ? sum->data[y - 1] : NULL, (y > 0) ? ssq->data[y - 1] : NULL);
+        return;
+    } else if (src->bpp == 1) {
+        uint8_t *src_row = src->pixels + (sy * src->w) + x_offs;
+        for (int s = 0, sq = 0, x = 0; x < sum->w; x++) {
+            int pixel = src_row[x_map[x]];
+            s += pixel;
+            sq += pixel * pixel;
+            sum_row[x] = s;
+            ssq_row[x] = sq;
+        }
+    } else {
+        uint16_t *src_row = ((uint16_t *) src->pixels) + (sy * src->w) + x_offs;
+        for (int s = 0, sq = 0, x = 0; x < sum->w; x++) {
+            int pixel = COLOR_RGB565_TO_Y(src_row[x_map[x]]);
+            s += pixel;
+            sq += pixel * pixel;
+            sum_row[x] = s;
+            ssq_row[x] = sq;
+        }
+    }
 
-        sum_data[0][x] = s;
-        ssq_data[0][x] = sq;
+    if (y > 0) {
+        uint32_t *sum_prev = sum->data[y - 1];
+        uint32_t *ssq_prev = ssq->data[y - 1];
+        for (int x = 0; x < sum->w; x++) {
+            sum_row[x] += sum_prev[x];
+            ssq_row[x] += ssq_prev[x];
+        }
     }
+}
 
-    // Compute the last n lines
-    for (int sy, y = 1; y < sum->h; y++) {
+void imlib_integral_mw_ss(image_t *src, mw_image_t *sum, mw_image_t *ssq, rectangle_t *roi) {
+    for (int y = 0; y < sum->h; y++) {
         // Y offset
-        sy = roi->y + ((y * sum->y_ratio) >> 16);
-
-        // Sum the current row
-        for (int sx, s = 0, sq = 0, x = 0; x < sum->w; x++) {
-            // X offset
-            sx = roi->x + ((x * sum->x_ratio) >> 16);
-
-            // Accumulate row data
-            s += IM_TO_GS_PIXEL(src, sx, sy);
-            sq += IM_TO_GS_PIXEL(src, sx, sy) * IM_TO_GS_PIXEL(src, sx, sy);
-
-            sum_data[y][x] = s + sum_data[y - 1][x];
-            ssq_data[y][x] = sq + ssq_data[y - 1][x];
-        }
+        imlib_integral_mw_ss_row(src, sum, ssq, roi->x, roi->y + ((y * sum->y_ratio) >> 16), y);
     }
 
     sum->y_offs = sum->h;
@@ -271,27 +297,10 @@ void imlib_integral_mw_shift_ss(image_t *src, mw_image_t *sum, mw_image_t *ssq,
     SWAP_PTRS(sum->data, sum->swap);
     SWAP_PTRS(ssq->data, ssq->swap);
 
-    // Pointer to the current sum and ssq data
-    typeof(*sum->data) * sum_data = sum->data;
-    typeof(*ssq->data) * ssq_data = ssq->data;
-
     // Compute the last n lines
-    for (int sy, y = (sum->h - n); y < sum->h; y++, sum->y_offs++, ssq->y_offs++) {
+    for (int y = (sum->h - n); y < sum->h; y++, sum->y_offs++, ssq->y_offs++) {
         // The y offset is set to the last line + 1
-        sy = roi->y + ((sum->y_offs * sum->y_ratio) >> 16);
-
-        // Sum of the current row
-        for (int sx, s = 0, sq = 0, x = 0; x < sum->w; x++) {
-            // X offset
-            sx = roi->x + ((x * sum->x_ratio) >> 16);
-
-            // Accumulate row data
-            s += IM_TO_GS_PIXEL(src, sx, sy);
-            sq += IM_TO_GS_PIXEL(src, sx, sy) * IM_TO_GS_PIXEL(src, sx, sy);
-
-            sum_data[y][x] = s + sum_data[y - 1][x];
-            ssq_data[y][x] = sq + ssq_data[y - 1][x];
-        }
+        imlib_integral_mw_ss_row(src, sum, ssq, roi->x, roi->y + ((sum->y_offs * sum->y_ratio) >> 16), y);
     }
 }
 
@@ -8,6 +8,7 @@
  *
  * AWB Functions
  */
+#include <string.h>
 #include "imlib.h"
 
 #ifdef IMLIB_ENABLE_ISP_OPS
@@ -1136,4 +1137,364 @@ void imlib_gamma(image_t *img, float gamma, float contrast, float brightness) {
     }
 }
 
+// Maps input level i of a bits wide channel through the white balance gain (Q5) and the
+// gamma/contrast/brightness curve of imlib_gamma().
+static int isp_level(int i, int bits, int gain, float gamma, float contrast, float brightness) {
+    int max = (1 << bits) - 1;
+    float scale = max;
+    float div = 1 / scale;
+    i = IM_MIN((i * gain) >> 5, max);
+    int p = ((fast_powf(i * div, gamma) * contrast) + brightness) * scale;
+    return IM_MAX(IM_MIN(p, max), 0);
+}
+
+static void isp_rgb565(image_t *img, const isp_config_t *config, int red_gain, int blue_gain,
+                       uint32_t *acc, int *max) {
+    float gamma = IM_DIV(1.0f, config->gamma);
+    float contrast = config->contrast, brightness = config->brightness;
+    bool ccm = config->ccm_enable;
+    int row_step = IM_MAX(config->row_step, 1);
+
+    // The output pixel is the OR of the 3 LUT entries. Without a CCM the gains are applied by
+    // the LUTs, otherwise they are folded into the CCM columns of red and blue.
+    uint16_t r_lut[COLOR_R5_MAX + 1], g_lut[COLOR_G6_MAX + 1], b_lut[COLOR_B5_MAX + 1];
+
+    for (int i = 0; i <= COLOR_R5_MAX; i++) {
+        r_lut[i] = isp_level(i, 5, ccm ? 32 : red_gain, gamma, contrast, brightness) << 11;
+        b_lut[i] = isp_level(i, 5, ccm ? 32 : blue_gain, gamma, contrast, brightness);
+    }
+
+    for (int i = 0; i <= COLOR_G6_MAX; i++) {
+        g_lut[i] = isp_level(i, 6, 32, gamma, contrast, brightness) << 5;
+    }
+
+    // Same scaling as imlib_ccm(), the red and blue columns can go up to 4x higher with gains.
+    const float *m = config->ccm;
+    float r_scale = ccm ? (red_gain * 2.0f) : 0.0f, b_scale = ccm ? (blue_gain * 2.0f) : 0.0f;
+    int i_rr = IM_MIN(fast_roundf(m[0] * r_scale), 4096);
+    int i_rg = IM_MIN(fast_roundf(m[1] * 32), 512);
+    int i_rb = IM_MIN(fast_roundf(m[2] * b_scale), 4096);
+    int i_gr = IM_MIN(fast_roundf(m[4] * r_scale), 4096);
+    int i_gg = IM_MIN(fast_roundf(m[5] * 32), 512);
+    int i_gb = IM_MIN(fast_roundf(m[6] * b_scale), 4096);
+    int i_br = IM_MIN(fast_roundf(m[8] * r_scale), 4096);
+    int i_bg = IM_MIN(fast_roundf(m[9] * 32), 512);
+    int i_bb = IM_MIN(fast_roundf(m[10] * b_scale), 4096);
+    int i_ro = config->ccm_offset ? IM_MIN(fast_roundf(m[3] * 64), 1024) : 0;
+    int i_go = config->ccm_offset ? IM_MIN(fast_roundf(m[7] * 32), 512) : 0;
+    int i_bo = config->ccm_offset ? IM_MIN(fast_roundf(m[11] * 64), 1024) : 0;
+
+    #if defined(ARM_MATH_DSP)
+    long smuad_rr_rb = __PKHBT(i_rb, i_rr, 16);
+    long smuad_gr_gb = __PKHBT(i_gb, i_gr, 16);
+    long smuad_br_bb = __PKHBT(i_bb, i_br, 16);
+    #endif
+
+    for (int y = 0, yy = img->h; y < yy; y++) {
+        uint16_t *ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+        bool sample = !(y % row_step);
+
+        if (sample) {
+            acc[3] += img->w;
+        }
+
+        for (int x = 0, xx = img->w; x < xx; x++) {
+            int pixel = ptr[x];
+            int r = COLOR_RGB565_TO_R5(pixel);
+            int g = COLOR_RGB565_TO_G6(pixel);
+            int b = COLOR_RGB565_TO_B5(pixel);
+
+            if (sample) {
+                acc[0] += r;
+                acc[1] += g;
+                acc[2] += b;
+                max[0] = IM_MAX(max[0], r);
+                max[1] = IM_MAX(max[1], g);
+                max[2] = IM_MAX(max[2], b);
+            }
+
+            if (ccm) {
+                #if defined(ARM_MATH_DSP)
+                int r_b = __PKHBT(b, r, 16);
+                int new_r = __USAT_ASR(__SMLAD(r_b, smuad_rr_rb, (i_rg * g) + i_ro), 5, 6);
+                int new_g = __USAT_ASR(__SMLAD(r_b, smuad_gr_gb, (i_gg * g) + i_go), 6, 5);
+                int new_b = __USAT_ASR(__SMLAD(r_b, smuad_br_bb, (i_bg * g) + i_bo), 5, 6);
+                #else
+                int new_r = __USAT_ASR((i_rr * r) + (i_rg * g) + (i_rb * b) + i_ro, 5, 6);
+                int new_g = __USAT_ASR((i_gr * r) + (i_gg * g) + (i_gb * b) + i_go, 6, 5);
+                int new_b = __USAT_ASR((i_br * r) + (i_bg * g) + (i_bb * b) + i_bo, 5, 6);
+                #endif
+                r = new_r;
+                g = new_g;
+                b = new_b;
+            }
+
+            ptr[x] = r_lut[r] | g_lut[g] | b_lut[b];
+        }
+    }
+}
+
+// Channel (0 = red, 1 = green, 2 = blue) of each site, indexed by [y % 2][x % 2].
+static const uint8_t isp_bayer_sites[4][2][2] = {
+    {{0, 1}, {1, 2}}, // PIXFORMAT_BAYER_BGGR
+    {{1, 0}, {2, 1}}, // PIXFORMAT_BAYER_GBRG
+    {{1, 2}, {0, 1}}, // PIXFORMAT_BAYER_GRBG
+    {{2, 1}, {1, 0}}, // PIXFORMAT_BAYER_RGGB
+};
+
+static void isp_bayer(image_t *img, const isp_config_t *config, int red_gain, int blue_gain,
+                      uint32_t *acc, int *max) {
+    float gamma = IM_DIV(1.0f, config->gamma);
+    int row_step = IM_MAX(config->row_step, 1);
+    int gains[3] = {red_gain, 32, blue_gain};
+    uint8_t *luts = fb_alloc(256 * 3, FB_ALLOC_NO_HINT);
+
+    for (int c = 0; c < 3; c++) {
+        for (int i = 0; i < 256; i++) {
+            luts[(c * 256) + i] = isp_level(i, 8, gains[c], gamma, config->contrast, config->brightness);
+        }
+    }
+
+    const uint8_t (*sites)[2] = isp_bayer_sites[0];
+
+    switch (img->pixfmt) {
+        case PIXFORMAT_BAYER_GBRG:
+            sites = isp_bayer_sites[1];
+            break;
+        case PIXFORMAT_BAYER_GRBG:
+            sites = isp_bayer_sites[2];
+            break;
+        case PIXFORMAT_BAYER_RGGB:
+            sites = isp_bayer_sites[3];
+            break;
+        default:
+            break;
+    }
+
+    for (int y = 0, yy = img->h; y < yy; y++) {
+        uint8_t *ptr = IMAGE_COMPUTE_BAYER_PIXEL_ROW_PTR(img, y);
+        int c0 = sites[y % 2][0], c1 = sites[y % 2][1];
+        const uint8_t *lut0 = luts + (c0 * 256), *lut1 = luts + (c1 * 256);
+        uint32_t acc0 = 0, acc1 = 0;
+        int max0 = max[c0], max1 = max[c1];
+        int x = 0, xx = img->w;
+
+        if (!((y / 2) % row_step)) {
+            for (; (x + 1) < xx; x += 2) {
+                int p0 = ptr[x], p1 = ptr[x + 1];
+                acc0 += p0;
+                acc1 += p1;
+                max0 = IM_MAX(max0, p0);
+                max1 = IM_MAX(max1, p1);
+                ptr[x] = lut0[p0];
+                ptr[x + 1] = lut1[p1];
+            }
+
+            if (x < xx) {
+                acc0 += ptr[x];
+                max0 = IM_MAX(max0, ptr[x]);
+            }
+
+            acc[c0] += acc0;
+            acc[c1] += acc1;
+            max[c0] = max0;
+            max[c1] = max1;
+            acc[3] += xx;
+        } else {
+            for (; (x + 1) < xx; x += 2) {
+                ptr[x] = lut0[ptr[x]];
+                ptr[x + 1] = lut1[ptr[x + 1]];
+            }
+        }
+
+        if (x < xx) {
+            ptr[x] = lut0[ptr[x]];
+        }
+    }
+
+    fb_free();
+}
+
+// Applies white balance gains, the CCM and gamma in a single pass over the image, and replaces
+// stats with the white balance statistics of the input, to give the gains of the next frame.
+// The CCM is only applied to RGB565 images, bayer images are corrected before demosaicing.
+void imlib_isp(image_t *img, const isp_config_t *config, isp_stats_t *stats) {
+    int red_gain = 32, blue_gain = 32;
+
+    // Gains are computed like imlib_awb(), but stay at 1x until statistics are available.
+    if (config->awb && stats->r && stats->b) {
+        red_gain = IM_DIV(stats->g * 32, stats->r);
+        red_gain = IM_MIN(red_gain, 128);
+        blue_gain = IM_DIV(stats->g * 32, stats->b);
+        blue_gain = IM_MIN(blue_gain, 128);
+    }
+
+    // Red, green and blue sums, and the number of pixels sampled.
+    uint32_t acc[4] = {0, 0, 0, 0};
+    int max[3] = {0, 0, 0};
+
+    switch (img->pixfmt) {
+        case PIXFORMAT_RGB565: {
+            isp_rgb565(img, config, red_gain, blue_gain, acc, max);
+            break;
+        }
+        case PIXFORMAT_BAYER_ANY: {
+            isp_bayer(img, config, red_gain, blue_gain, acc, max);
+            break;
+        }
+        default: {
+            return;
+        }
+    }
+
+    uint32_t area = acc[3];
+
+    if (!area) {
+        stats->r = stats->g = stats->b = 0;
+    } else if (config->awb_max) {
+        stats->r = img->is_bayer ? max[0] : (max[0] * 2);
+        stats->g = max[1];
+        stats->b = img->is_bayer ? max[2] : (max[2] * 2);
+    } else if (img->is_bayer) {
+        stats->r = ((acc[0] * 4) + (area >> 1)) / area;
+        stats->g = ((acc[1] * 2) + (area >> 1)) / area;
+        stats->b = ((acc[2] * 4) + (area >> 1)) / area;
+    } else {
+        stats->r = ((acc[0] * 2) + (area >> 1)) / area;
+        stats->g = (acc[1] + (area >> 1)) / area;
+        stats->b = ((acc[2] * 2) + (area >> 1)) / area;
+    }
+}
+
+size_t imlib_lut_size(lut_type_t type) {
+    return (type == LUT_TYPE_CHANNEL) ? (LUT_CHANNEL_SIZE * 3) : (65536 * sizeof(uint16_t));
+}
+
+// Channel LUT of the imlib_gamma() curve.
+void imlib_lut_gamma(lut_t *lut, float gamma, float contrast, float brightness) {
+    gamma = IM_DIV(1.0f, gamma);
+
+    for (int i = 0; i < LUT_CHANNEL_SIZE; i++) {
+        lut->table[i] = isp_level(i, 8, 32, gamma, contrast, brightness);
+    }
+
+    memcpy(lut->table + LUT_CHANNEL_SIZE, lut->table, LUT_CHANNEL_SIZE);
+    memcpy(lut->table + (LUT_CHANNEL_SIZE * 2), lut->table, LUT_CHANNEL_SIZE);
+}
+
+static int lut_rgb565(lut_t *lut, int pixel) {
+    if (lut->type == LUT_TYPE_RGB565) {
+        return ((uint16_t *) lut->table)[pixel];
+    }
+
+    return COLOR_R8_G8_B8_TO_RGB565(lut->table[COLOR_RGB565_TO_R8(pixel)],
+                                    lut->table[LUT_CHANNEL_SIZE + COLOR_RGB565_TO_G8(pixel)],
+                                    lut->table[(LUT_CHANNEL_SIZE * 2) + COLOR_RGB565_TO_B8(pixel)]);
+}
+
+// Applying dst is the same as applying first and then second. The caller sets the dst type,
+// which must be LUT_TYPE_RGB565 unless both LUTs are channel LUTs.
+void imlib_lut_compose(lut_t *dst, lut_t *first, lut_t *second) {
+    if (dst->type == LUT_TYPE_CHANNEL) {
+        for (int i = 0; i < (LUT_CHANNEL_SIZE * 3); i++) {
+            int offset = i & ~(LUT_CHANNEL_SIZE - 1);
+            dst->table[i] = second->table[offset + first->table[i]];
+        }
+    } else {
+        uint16_t *table = (uint16_t *) dst->table;
+        for (int i = 0; i < 65536; i++) {
+            table[i] = lut_rgb565(second, lut_rgb565(first, i));
+        }
+    }
+}
+
+// Pixels are read and written a 32-bit word at a time, a gather isn't any faster on these cores.
+void imlib_apply_lut(image_t *img, lut_t *lut) {
+    switch (img->pixfmt) {
+        case PIXFORMAT_GRAYSCALE: {
+            const uint8_t *table = lut->table;
+            uint8_t *ptr = img->data;
+            size_t n = img->w * img->h;
+
+            if (lut->type != LUT_TYPE_CHANNEL) {
+                break;
+            }
+
+            for (; n && (((uintptr_t) ptr) & 3); n--, ptr++) {
+                *ptr = table[*ptr];
+            }
+
+            for (uint32_t *ptr32 = (uint32_t *) ptr; n >= 4; n -= 4, ptr += 4) {
+                uint32_t p = *ptr32;
+                *ptr32++ = table[p & 0xFF] | (table[(p >> 8) & 0xFF] << 8) |
+                           (table[(p >> 16) & 0xFF] << 16) | (table[p >> 24] << 24);
+            }
+
+            for (; n; n--, ptr++) {
+                *ptr = table[*ptr];
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *ptr = (uint16_t *) img->data;
+            size_t n = img->w * img->h;
+
+            if (lut->type == LUT_TYPE_RGB565) {
+                const uint16_t *table = (uint16_t *) lut->table;
+
+                if (n && (((uintptr_t) ptr) & 3)) {
+                    *ptr = table[*ptr];
+                    ptr++;
+                    n--;
+                }
+
+                for (uint32_t *ptr32 = (uint32_t *) ptr; n >= 2; n -= 2, ptr += 2) {
+                    uint32_t p = *ptr32;
+                    *ptr32++ = table[p & 0xFFFF] | (table[p >> 16] << 16);
+                }
+
+                if (n) {
+                    *ptr = table[*ptr];
+                }
+            } else {
+                // The output pixel is the OR of the 3 LUT entries.
+                uint16_t r_lut[COLOR_R5_MAX + 1], g_lut[COLOR_G6_MAX + 1], b_lut[COLOR_B5_MAX + 1];
+
+                for (int i = 0; i <= COLOR_R5_MAX; i++) {
+                    r_lut[i] = COLOR_R8_G8_B8_TO_RGB565(lut->table[(i << 3) | (i >> 2)], 0, 0);
+                    b_lut[i] = COLOR_R8_G8_B8_TO_RGB565(0, 0, lut->table[(LUT_CHANNEL_SIZE * 2) + ((i << 3) | (i >> 2))]);
+                }
+
+                for (int i = 0; i <= COLOR_G6_MAX; i++) {
+                    g_lut[i] = COLOR_R8_G8_B8_TO_RGB565(0, lut->table[LUT_CHANNEL_SIZE + ((i << 2) | (i >> 4))], 0);
+                }
+
+                #define LUT_RGB565_CHANNELS(p) \
+                    (r_lut[COLOR_RGB565_TO_R5(p)] | g_lut[COLOR_RGB565_TO_G6(p)] | b_lut[COLOR_RGB565_TO_B5(p)])
+
+                if (n && (((uintptr_t) ptr) & 3)) {
+                    *ptr = LUT_RGB565_CHANNELS(*ptr);
+                    ptr++;
+                    n--;
+                }
+
+                for (uint32_t *ptr32 = (uint32_t *) ptr; n >= 2; n -= 2, ptr += 2) {
+                    uint32_t p = *ptr32;
+                    *ptr32++ = LUT_RGB565_CHANNELS(p & 0xFFFF) | (LUT_RGB565_CHANNELS(p >> 16) << 16);
+                }
+
+                if (n) {
+                    *ptr = LUT_RGB565_CHANNELS(*ptr);
+                }
+
+                #undef LUT_RGB565_CHANNELS
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
 #endif // IMLIB_ENABLE_ISP_OPS
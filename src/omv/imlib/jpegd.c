@@ -159,6 +159,8 @@ typedef struct jpeg_image_tag {
     int iVLCSize;                // current quantity of data in the VLC buffer
     int iResInterval, iResCount; // restart interval
     int iMaxMCUs;                // max MCUs of pixels per JPEGDraw call
+    int iWinX0, iWinY0;          // decode window in MCUs, [X0, X1) x [Y0, Y1),
+    int iWinX1, iWinY1;          // the whole image if X1 is 0
     JPEG_READ_CALLBACK *pfnRead;
     JPEG_SEEK_CALLBACK *pfnSeek;
     JPEG_DRAW_CALLBACK *pfnDraw;
@@ -2630,6 +2632,11 @@ static int DecodeJPEG(JPEGIMAGE *pJPEG) {
     iLum3 = MCU3;
     iErr = 0;
     pJPEG->iResCount = pJPEG->iResInterval;
+    if (pJPEG->iWinX1 == 0) {
+        pJPEG->iWinX0 = pJPEG->iWinY0 = 0;
+        pJPEG->iWinX1 = cx;
+        pJPEG->iWinY1 = cy;
+    }
     // Calculate how many MCUs we can fit in the pixel buffer to maximize LCD drawing speed
     iMCUCount = MAX_BUFFERED_PIXELS / (mcuCX * mcuCY);
     if (pJPEG->ucPixelType == EIGHT_BIT_GRAYSCALE) {
@@ -2646,10 +2653,35 @@ static int DecodeJPEG(JPEGIMAGE *pJPEG) {
         // dithered, override the max MCU count
         iMCUCount = cx; // do the whole row
     }
+    // Nothing past the last row of the decode window is needed.
+    if (cy > pJPEG->iWinY1) {
+        cy = pJPEG->iWinY1;
+    }
     for (y = 0; y < cy && bContinue; y++) {
         for (x = 0; x < cx && bContinue && iErr == 0; x++) {
             pJPEG->ucACTable = cACTable0;
             pJPEG->ucDCTable = cDCTable0;
+            if ((y < pJPEG->iWinY0) || (x < pJPEG->iWinX0) || (x >= pJPEG->iWinX1)) {
+                // Outside the decode window only entropy decode the MCU to keep
+                // the bit position and DC predictors, skipping the IDCT and output.
+                iErr = JPEGDecodeMCU(pJPEG, iLum0, &iDCPred0);
+                if (pJPEG->ucSubSample > 0x11) {
+                    iErr |= JPEGDecodeMCU(pJPEG, iLum1, &iDCPred0);
+                    if (pJPEG->ucSubSample == 0x22) {
+                        iErr |= JPEGDecodeMCU(pJPEG, iLum2, &iDCPred0);
+                        iErr |= JPEGDecodeMCU(pJPEG, iLum3, &iDCPred0);
+                    }
+                }
+                if (pJPEG->ucSubSample && pJPEG->ucNumComponents == 3) {
+                    pJPEG->ucACTable = cACTable1;
+                    pJPEG->ucDCTable = cDCTable1;
+                    iErr |= JPEGDecodeMCU(pJPEG, iCr, &iDCPred1);
+                    pJPEG->ucACTable = cACTable2;
+                    pJPEG->ucDCTable = cDCTable2;
+                    iErr |= JPEGDecodeMCU(pJPEG, iCb, &iDCPred2);
+                }
+                goto next_mcu;
+            }
             // do the first luminance component
             iErr = JPEGDecodeMCU(pJPEG, iLum0, &iDCPred0);
             if (pJPEG->ucMaxACCol == 0 || bThumbnail) {
@@ -2778,6 +2810,7 @@ static int DecodeJPEG(JPEGIMAGE *pJPEG) {
                         break;
                 } // switch on color option
             }
+next_mcu:
             if (pJPEG->iResInterval) {
                 if (--pJPEG->iResCount == 0) {
                     pJPEG->iResCount = pJPEG->iResInterval;
@@ -2794,6 +2827,19 @@ static int DecodeJPEG(JPEGIMAGE *pJPEG) {
                 JPEGGetMoreData(pJPEG); // need more 'filtered' VLC data
             }
         } // for x
+        if (pJPEG->pfnDraw && iErr == 0) {
+            // hand the finished MCU row to the caller
+            JPEGDRAW jd;
+            jd.x = 0;
+            jd.y = y * mcuCY;
+            jd.iWidth = pJPEG->iWidth;
+            jd.iHeight = IM_MIN(mcuCY, pJPEG->iHeight - jd.y);
+            jd.iBpp = (pJPEG->ucPixelType == ONE_BIT_GRAYSCALE) ? 1 :
+                      ((pJPEG->ucPixelType == EIGHT_BIT_GRAYSCALE) ? 8 : 16);
+            jd.pPixels = (uint16_t *) pJPEG->pImage;
+            jd.pUser = pJPEG->pUser;
+            bContinue = (*pJPEG->pfnDraw)(&jd);
+        }
     } // for y
     if (iErr != 0) {
         pJPEG->iError = JPEG_DECODE_ERROR;
@@ -2801,39 +2847,43 @@ static int DecodeJPEG(JPEGIMAGE *pJPEG) {
     return (iErr == 0);
 }
 
-void jpeg_decompress(image_t *dst, image_t *src) {
-    JPEGIMAGE jpg;
-
-    #if (TIME_JPEG == 1)
-    mp_uint_t start = mp_hal_ticks_ms();
-    #endif
-
+static void jpeg_decompress_setup(JPEGIMAGE *jpg, image_t *src, pixformat_t pixfmt, uint8_t *pImage) {
     // Supports decoding baseline JPEGs only.
     if (!jpeg_is_valid(src)) {
         mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Non-Baseline JPEGs are not supported."));
     }
 
-    if (JPEG_openRAM(&jpg, src->data, src->size, dst->data) == 0) {
+    if (JPEG_openRAM(jpg, src->data, src->size, pImage) == 0) {
         // failed to parse the header
         mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("JPEG decoder failed."));
     }
 
-    switch (dst->pixfmt) {
+    switch (pixfmt) {
         case PIXFORMAT_BINARY:
             // Force 1-bit (binary) output in the draw function.
-            jpg.ucPixelType = ONE_BIT_GRAYSCALE;
+            jpg->ucPixelType = ONE_BIT_GRAYSCALE;
             break;
         case PIXFORMAT_GRAYSCALE:
             // Force 8-bit grayscale output.
-            jpg.ucPixelType = EIGHT_BIT_GRAYSCALE;
+            jpg->ucPixelType = EIGHT_BIT_GRAYSCALE;
             break;
         case PIXFORMAT_RGB565:
             // Force output to be RGB565
-            jpg.ucPixelType = RGB565_LITTLE_ENDIAN;
+            jpg->ucPixelType = RGB565_LITTLE_ENDIAN;
             break;
         default:
             mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Unsupported format."));
     }
+}
+
+void jpeg_decompress(image_t *dst, image_t *src) {
+    JPEGIMAGE jpg;
+
+    #if (TIME_JPEG == 1)
+    mp_uint_t start = mp_hal_ticks_ms();
+    #endif
+
+    jpeg_decompress_setup(&jpg, src, dst->pixfmt, dst->data);
 
     // Set up dest image params
     jpg.pUser = (void *) dst;
@@ -2850,4 +2900,77 @@ void jpeg_decompress(image_t *dst, image_t *src) {
     printf("time: %u ms\n", mp_hal_ticks_ms() - start);
     #endif
 }
+
+typedef struct jpeg_decompress_rows_state {
+    JPEGIMAGE *jpg;
+    image_t band; // halo rows followed by one MCU row
+    image_t img; // full size view of the band, rebased for every MCU row
+    int halo;
+    int mcu_h;
+    jpeg_decompress_rows_callback_t callback;
+    void *callback_arg;
+} jpeg_decompress_rows_state_t;
+
+// Rebases the full size view so that row y lands right after the halo rows.
+static void jpeg_decompress_rows_rebase(jpeg_decompress_rows_state_t *state, int y) {
+    size_t line_size = image_line_size(&state->band);
+    state->img.data = state->band.data - ((y - state->halo) * (int) line_size);
+    state->jpg->pImage = state->img.data;
+}
+
+static int jpeg_decompress_rows_draw(JPEGDRAW *pDraw) {
+    jpeg_decompress_rows_state_t *state = (jpeg_decompress_rows_state_t *) pDraw->pUser;
+    size_t line_size = image_line_size(&state->band);
+    int y_end = pDraw->y + pDraw->iHeight;
+
+    if (!state->callback(&state->img, IM_MAX(pDraw->y - state->halo, 0), y_end, state->callback_arg)) {
+        return 0;
+    }
+
+    // Carry the last rows over as the halo of the next MCU row.
+    memmove(state->band.data, state->band.data + (state->mcu_h * line_size), state->halo * line_size);
+    memset(state->band.data + (state->halo * line_size), 0, state->mcu_h * line_size);
+    jpeg_decompress_rows_rebase(state, y_end);
+    return 1;
+}
+
+void jpeg_decompress_rows(image_t *src, pixformat_t pixfmt, int halo, rectangle_t *roi,
+                          jpeg_decompress_rows_callback_t callback, void *callback_arg) {
+    JPEGIMAGE jpg;
+    jpeg_decompress_rows_state_t state;
+
+    jpeg_decompress_setup(&jpg, src, pixfmt, NULL);
+
+    state.jpg = &jpg;
+    state.halo = halo;
+    state.mcu_h = ((jpg.ucSubSample == 0x12) || (jpg.ucSubSample == 0x22)) ? 16 : 8;
+
+    if (roi) {
+        // Only the MCUs covering the ROI are fully decoded.
+        int mcu_w = ((jpg.ucSubSample == 0x21) || (jpg.ucSubSample == 0x22)) ? 16 : 8;
+        jpg.iWinX0 = roi->x / mcu_w;
+        jpg.iWinY0 = roi->y / state.mcu_h;
+        jpg.iWinX1 = (roi->x + roi->w + mcu_w - 1) / mcu_w;
+        jpg.iWinY1 = (roi->y + roi->h + state.mcu_h - 1) / state.mcu_h;
+    }
+    state.callback = callback;
+    state.callback_arg = callback_arg;
+    state.img.w = state.band.w = jpg.iWidth;
+    state.img.h = jpg.iHeight;
+    state.band.h = halo + state.mcu_h;
+    state.img.pixfmt = state.band.pixfmt = pixfmt;
+    // JPEGPutMCU21() doesn't clip the MCU to the image width, so leave room for it to spill.
+    state.band.data = fb_alloc0(image_size(&state.band) + image_line_size(&state.band), FB_ALLOC_PREFER_SPEED);
+    jpeg_decompress_rows_rebase(&state, 0);
+
+    jpg.pUser = &state;
+    jpg.pfnDraw = jpeg_decompress_rows_draw;
+
+    // Start decoding, the callback is called once per MCU row.
+    if (JPEG_decode(&jpg, 0, 0, 0) == 0) {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("JPEG decoder failed."));
+    }
+
+    fb_free();
+}
 #endif
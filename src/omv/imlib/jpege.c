@@ -12,8 +12,10 @@
  */
 #include "file_utils.h"
 #include "imlib.h"
+#include "trace.h"
 
 #define TIME_JPEG                  (0)
+#define JPEG_WRITE_BUF_SIZE        (4096)
 #if (TIME_JPEG == 1)
 #include <stdio.h>
 #include "py/mphal.h"
@@ -976,15 +978,6 @@ void jpeg_get_mcu(image_t *src, int x_offset, int y_offset, int dx, int dy,
 #define DESCALE(x, y)      (x >> y)
 #define MULTIPLY(x, y)     DESCALE((x) * (y), 8)
 
-typedef struct {
-    int idx;
-    int length;
-    uint8_t *buf;
-    int bitc, bitb;
-    bool realloc;
-    bool overflow;
-} jpeg_buf_t;
-
 // Quantization tables
 static float fdtbl_Y[64], fdtbl_UV[64];
 static uint8_t YTable[64], UVTable[64];
@@ -1232,23 +1225,45 @@ static const uint16_t UVAC_HT[256][2] = {
     }                                                                                         \
     iLen += iNewLen; ulAcc |= (ulCode << (32 - iLen));
 
+// Makes room for size more bytes by streaming the buffer out, or by growing it if realloc
+// is enabled. Returns false and sets overflow if that's not possible.
+static bool jpeg_buf_make_room(jpeg_buf_t *jpeg_buf, int size) {
+    if (jpeg_buf->overflow) {
+        return false;
+    }
+
+    if (jpeg_buf->flush) {
+        if (!jpeg_buf->flush(jpeg_buf->buf, jpeg_buf->idx, jpeg_buf->flush_arg)) {
+            jpeg_buf->overflow = true;
+            return false;
+        }
+        jpeg_buf->flushed += jpeg_buf->idx;
+        jpeg_buf->idx = 0;
+    } else if (jpeg_buf->realloc) {
+        jpeg_buf->length += IM_MAX(size, 1024);
+        jpeg_buf->buf = xrealloc(jpeg_buf->buf, jpeg_buf->length);
+    } else {
+        jpeg_buf->overflow = true;
+        return false;
+    }
+
+    return (jpeg_buf->idx + size) < jpeg_buf->length;
+}
+
 //
 // See if we're close to filling up the output buffer
-// If so, allocate more space now so that we don't have
+// If so, make more space now so that we don't have
 // to check on every byte written
 //
-// If we're out of space and the realloc option is not available
-// return true to indicate that encoding has to halt
+// If we're out of space and the buffer can't be
+// flushed or realloc'd return true to indicate that
+// encoding has to halt
 //
 static int jpeg_check_highwater(jpeg_buf_t *jpeg_buf) {
     if ((jpeg_buf->idx + 1) >= jpeg_buf->length - 256) {
-        if (jpeg_buf->realloc == false) {
-            // Can't realloc buffer
-            jpeg_buf->overflow = true;
+        if (!jpeg_buf_make_room(jpeg_buf, 257)) {
             return 1; // failure
         }
-        jpeg_buf->length += 1024;
-        jpeg_buf->buf = xrealloc(jpeg_buf->buf, jpeg_buf->length);
     }
     return 0; // ok
 } /* jpeg_check_highwater() */
@@ -1274,13 +1289,9 @@ void jpeg_restore_buf(jpeg_buf_t *jpeg_buf, uint8_t *pOut, int iBitCount, uint32
 
 static void jpeg_put_char(jpeg_buf_t *jpeg_buf, char c) {
     if ((jpeg_buf->idx + 1) >= jpeg_buf->length) {
-        if (jpeg_buf->realloc == false) {
-            // Can't realloc buffer
-            jpeg_buf->overflow = true;
+        if (!jpeg_buf_make_room(jpeg_buf, 1)) {
             return;
         }
-        jpeg_buf->length += 1024;
-        jpeg_buf->buf = xrealloc(jpeg_buf->buf, jpeg_buf->length);
     }
 
     jpeg_buf->buf[jpeg_buf->idx++] = c;
@@ -1288,13 +1299,17 @@ static void jpeg_put_char(jpeg_buf_t *jpeg_buf, char c) {
 
 static void jpeg_put_bytes(jpeg_buf_t *jpeg_buf, const void *data, int size) {
     if ((jpeg_buf->idx + size) >= jpeg_buf->length) {
-        if (jpeg_buf->realloc == false) {
-            // Can't realloc buffer
-            jpeg_buf->overflow = true;
+        if (!jpeg_buf_make_room(jpeg_buf, size)) {
+            // Data larger than a streaming buffer goes straight to the sink.
+            if (jpeg_buf->flush && (!jpeg_buf->overflow)) {
+                if (!jpeg_buf->flush(data, size, jpeg_buf->flush_arg)) {
+                    jpeg_buf->overflow = true;
+                    return;
+                }
+                jpeg_buf->flushed += size;
+            }
             return;
         }
-        jpeg_buf->length += 1024;
-        jpeg_buf->buf = xrealloc(jpeg_buf->buf, jpeg_buf->length);
     }
 
     memcpy(jpeg_buf->buf + jpeg_buf->idx, data, size);
@@ -1510,7 +1525,8 @@ static void jpeg_init(int quality) {
     }
 }
 
-static void jpeg_write_headers(jpeg_buf_t *jpeg_buf, int w, int h, int bpp, jpeg_subsampling_t subsampling) {
+static void jpeg_write_headers(jpeg_buf_t *jpeg_buf, int w, int h, int bpp, jpeg_subsampling_t subsampling,
+                               int restart_interval) {
     // Number of components (1 or 3)
     uint8_t nr_comp = (bpp == 1)? 1 : 3;
 
@@ -1604,6 +1620,12 @@ static void jpeg_write_headers(jpeg_buf_t *jpeg_buf, int w, int h, int bpp, jpeg
         jpeg_put_bytes(jpeg_buf, std_ac_chrominance_values, sizeof(std_ac_chrominance_values));
     }
 
+    if (restart_interval) {
+        // Write DRI marker
+        jpeg_put_bytes(jpeg_buf, (uint8_t [6]) {0xFF, 0xDD, 0x00, 0x04,
+                                                restart_interval >> 8, restart_interval & 0xFF}, 6);
+    }
+
     // Write SOS marker
     jpeg_put_bytes(jpeg_buf, m_sos, sizeof(m_sos));
     for (int i = 0; i < nr_comp; i++) {
@@ -1614,52 +1636,10 @@ static void jpeg_write_headers(jpeg_buf_t *jpeg_buf, int w, int h, int bpp, jpeg
     jpeg_put_bytes(jpeg_buf, (uint8_t [3]) {0x00, 0x3F, 0x0}, 3);
 }
 
-bool jpeg_compress(image_t *src, image_t *dst, int quality, bool realloc, jpeg_subsampling_t subsampling) {
-    #if (TIME_JPEG == 1)
-    mp_uint_t start = mp_hal_ticks_ms();
-    #endif
-
-    if (!dst->data) {
-        uint32_t size = 0;
-        dst->data = fb_alloc_all(&size, FB_ALLOC_PREFER_SIZE | FB_ALLOC_CACHE_ALIGN);
-        dst->size = IMLIB_IMAGE_MAX_SIZE(size);
-    }
-
-    if (src->is_compressed) {
-        return true;
-    }
-
-    // JPEG buffer
-    jpeg_buf_t jpeg_buf = {
-        .idx = 0,
-        .buf = dst->pixels,
-        .length = dst->size,
-        .bitc = 0,
-        .bitb = 0,
-        .realloc = realloc,
-        .overflow = false,
-    };
-
-    // Initialize quantization tables
-    jpeg_init(quality);
-
-    if (src->is_color) {
-        if (subsampling == JPEG_SUBSAMPLING_AUTO) {
-            if (quality <= 35) {
-                subsampling = JPEG_SUBSAMPLING_420;
-            } else if (quality < 60) {
-                subsampling = JPEG_SUBSAMPLING_422;
-            } else {
-                subsampling = JPEG_SUBSAMPLING_444;
-            }
-        }
-    } else {
-        subsampling = JPEG_SUBSAMPLING_444;
-    }
-
-    jpeg_write_headers(&jpeg_buf, src->w, src->h, src->is_color ? 2 : 1, subsampling);
-
-    int DCY = 0, DCU = 0, DCV = 0;
+// Encodes the MCU row starting at y_offset, returns true if the buffer overflowed.
+static bool jpeg_compress_mcu_row(jpeg_buf_t *jpeg_buf, image_t *src, int y_offset,
+                                  jpeg_subsampling_t subsampling, int *DC) {
+    int DCY = DC[0], DCU = DC[1], DCV = DC[2];
 
     switch (subsampling) {
         // Quiet GCC compiler warning (this is never reached)
@@ -1671,23 +1651,17 @@ bool jpeg_compress(image_t *src, image_t *dst, int quality, bool realloc, jpeg_s
             int8_t UDU[JPEG_444_GS_MCU_SIZE];
             int8_t VDU[JPEG_444_GS_MCU_SIZE];
 
-            for (int y_offset = 0; y_offset < src->h; y_offset += JPEG_MCU_H) {
-                int dy = IM_MIN(JPEG_MCU_H, src->h - y_offset);
+            int dy = IM_MIN(JPEG_MCU_H, src->h - y_offset);
 
-                for (int x_offset = 0; x_offset < src->w; x_offset += JPEG_MCU_W) {
-                    int dx = IM_MIN(JPEG_MCU_W, src->w - x_offset);
+            for (int x_offset = 0; x_offset < src->w; x_offset += JPEG_MCU_W) {
+                int dx = IM_MIN(JPEG_MCU_W, src->w - x_offset);
 
-                    jpeg_get_mcu(src, x_offset, y_offset, dx, dy, YDU, UDU, VDU);
-                    DCY = jpeg_processDU(&jpeg_buf, YDU, fdtbl_Y, DCY, YDC_HT, YAC_HT);
-
-                    if (src->is_color) {
-                        DCU = jpeg_processDU(&jpeg_buf, UDU, fdtbl_UV, DCU, UVDC_HT, UVAC_HT);
-                        DCV = jpeg_processDU(&jpeg_buf, VDU, fdtbl_UV, DCV, UVDC_HT, UVAC_HT);
-                    }
-                }
+                jpeg_get_mcu(src, x_offset, y_offset, dx, dy, YDU, UDU, VDU);
+                DCY = jpeg_processDU(jpeg_buf, YDU, fdtbl_Y, DCY, YDC_HT, YAC_HT);
 
-                if (jpeg_buf.overflow) {
-                    return true;
+                if (src->is_color) {
+                    DCU = jpeg_processDU(jpeg_buf, UDU, fdtbl_UV, DCU, UVDC_HT, UVAC_HT);
+                    DCV = jpeg_processDU(jpeg_buf, VDU, fdtbl_UV, DCV, UVDC_HT, UVAC_HT);
                 }
             }
             break;
@@ -1700,99 +1674,93 @@ bool jpeg_compress(image_t *src, image_t *dst, int quality, bool realloc, jpeg_s
             int8_t UDU_avg[JPEG_444_GS_MCU_SIZE];
             int8_t VDU_avg[JPEG_444_GS_MCU_SIZE];
 
-            for (int y_offset = 0; y_offset < src->h; y_offset += JPEG_MCU_H) {
-                int dy = IM_MIN(JPEG_MCU_H, src->h - y_offset);
+            int dy = IM_MIN(JPEG_MCU_H, src->h - y_offset);
 
-                for (int x_offset = 0; x_offset < src->w; ) {
-                    for (int i = 0; i < (JPEG_444_GS_MCU_SIZE * 2);
-                         i += JPEG_444_GS_MCU_SIZE, x_offset += JPEG_MCU_W) {
-                        int dx = IM_MIN(JPEG_MCU_W, src->w - x_offset);
-
-                        if (dx > 0) {
-                            jpeg_get_mcu(src, x_offset, y_offset, dx, dy, YDU + i, UDU + i, VDU + i);
-                        } else {
-                            memset(YDU + i, 0, JPEG_444_GS_MCU_SIZE);
-                            memset(UDU + i, 0, JPEG_444_GS_MCU_SIZE);
-                            memset(VDU + i, 0, JPEG_444_GS_MCU_SIZE);
-                        }
+            for (int x_offset = 0; x_offset < src->w; ) {
+                for (int i = 0; i < (JPEG_444_GS_MCU_SIZE * 2);
+                     i += JPEG_444_GS_MCU_SIZE, x_offset += JPEG_MCU_W) {
+                    int dx = IM_MIN(JPEG_MCU_W, src->w - x_offset);
 
-                        DCY = jpeg_processDU(&jpeg_buf, YDU + i, fdtbl_Y, DCY, YDC_HT, YAC_HT);
+                    if (dx > 0) {
+                        jpeg_get_mcu(src, x_offset, y_offset, dx, dy, YDU + i, UDU + i, VDU + i);
+                    } else {
+                        memset(YDU + i, 0, JPEG_444_GS_MCU_SIZE);
+                        memset(UDU + i, 0, JPEG_444_GS_MCU_SIZE);
+                        memset(VDU + i, 0, JPEG_444_GS_MCU_SIZE);
                     }
 
-                    // horizontal subsampling of U & V
+                    DCY = jpeg_processDU(jpeg_buf, YDU + i, fdtbl_Y, DCY, YDC_HT, YAC_HT);
+                }
+
+                // horizontal subsampling of U & V
+                #if defined(ARM_MATH_DSP)
+                uint32_t *UDUp0 = (uint32_t *) UDU;
+                uint32_t *VDUp0 = (uint32_t *) VDU;
+                uint32_t *UDUp1 = (uint32_t *) (UDU + JPEG_444_GS_MCU_SIZE);
+                uint32_t *VDUp1 = (uint32_t *) (VDU + JPEG_444_GS_MCU_SIZE);
+                #else
+                int8_t *UDUp0 = UDU;
+                int8_t *VDUp0 = VDU;
+                int8_t *UDUp1 = UDUp0 + JPEG_444_GS_MCU_SIZE;
+                int8_t *VDUp1 = VDUp0 + JPEG_444_GS_MCU_SIZE;
+                #endif
+                for (int j = 0; j < JPEG_444_GS_MCU_SIZE; j += JPEG_MCU_W) {
                     #if defined(ARM_MATH_DSP)
-                    uint32_t *UDUp0 = (uint32_t *) UDU;
-                    uint32_t *VDUp0 = (uint32_t *) VDU;
-                    uint32_t *UDUp1 = (uint32_t *) (UDU + JPEG_444_GS_MCU_SIZE);
-                    uint32_t *VDUp1 = (uint32_t *) (VDU + JPEG_444_GS_MCU_SIZE);
+                    uint32_t UDUp0_3210 = *UDUp0++;
+                    uint32_t UDUp0_avg_32_10 = __SHADD8(UDUp0_3210, __UXTB16_RORn(UDUp0_3210, 8));
+                    UDU_avg[j] = UDUp0_avg_32_10;
+                    UDU_avg[j + 1] = UDUp0_avg_32_10 >> 16;
+
+                    uint32_t UDUp0_7654 = *UDUp0++;
+                    uint32_t UDUp0_avg_76_54 = __SHADD8(UDUp0_7654, __UXTB16_RORn(UDUp0_7654, 8));
+                    UDU_avg[j + 2] = UDUp0_avg_76_54;
+                    UDU_avg[j + 3] = UDUp0_avg_76_54 >> 16;
+
+                    uint32_t UDUp1_3210 = *UDUp1++;
+                    uint32_t UDUp1_avg_32_10 = __SHADD8(UDUp1_3210, __UXTB16_RORn(UDUp1_3210, 8));
+                    UDU_avg[j + 4] = UDUp1_avg_32_10;
+                    UDU_avg[j + 5] = UDUp1_avg_32_10 >> 16;
+
+                    uint32_t UDUp1_7654 = *UDUp1++;
+                    uint32_t UDUp1_avg_76_54 = __SHADD8(UDUp1_7654, __UXTB16_RORn(UDUp1_7654, 8));
+                    UDU_avg[j + 6] = UDUp1_avg_76_54;
+                    UDU_avg[j + 7] = UDUp1_avg_76_54 >> 16;
+
+                    uint32_t VDUp0_3210 = *VDUp0++;
+                    uint32_t VDUp0_avg_32_10 = __SHADD8(VDUp0_3210, __UXTB16_RORn(VDUp0_3210, 8));
+                    VDU_avg[j] = VDUp0_avg_32_10;
+                    VDU_avg[j + 1] = VDUp0_avg_32_10 >> 16;
+
+                    uint32_t VDUp0_7654 = *VDUp0++;
+                    uint32_t VDUp0_avg_76_54 = __SHADD8(VDUp0_7654, __UXTB16_RORn(VDUp0_7654, 8));
+                    VDU_avg[j + 2] = VDUp0_avg_76_54;
+                    VDU_avg[j + 3] = VDUp0_avg_76_54 >> 16;
+
+                    uint32_t VDUp1_3210 = *VDUp1++;
+                    uint32_t VDUp1_avg_32_10 = __SHADD8(VDUp1_3210, __UXTB16_RORn(VDUp1_3210, 8));
+                    VDU_avg[j + 4] = VDUp1_avg_32_10;
+                    VDU_avg[j + 5] = VDUp1_avg_32_10 >> 16;
+
+                    uint32_t VDUp1_7654 = *VDUp1++;
+                    uint32_t VDUp1_avg_76_54 = __SHADD8(VDUp1_7654, __UXTB16_RORn(VDUp1_7654, 8));
+                    VDU_avg[j + 6] = VDUp1_avg_76_54;
+                    VDU_avg[j + 7] = VDUp1_avg_76_54 >> 16;
                     #else
-                    int8_t *UDUp0 = UDU;
-                    int8_t *VDUp0 = VDU;
-                    int8_t *UDUp1 = UDUp0 + JPEG_444_GS_MCU_SIZE;
-                    int8_t *VDUp1 = VDUp0 + JPEG_444_GS_MCU_SIZE;
-                    #endif
-                    for (int j = 0; j < JPEG_444_GS_MCU_SIZE; j += JPEG_MCU_W) {
-                        #if defined(ARM_MATH_DSP)
-                        uint32_t UDUp0_3210 = *UDUp0++;
-                        uint32_t UDUp0_avg_32_10 = __SHADD8(UDUp0_3210, __UXTB16_RORn(UDUp0_3210, 8));
-                        UDU_avg[j] = UDUp0_avg_32_10;
-                        UDU_avg[j + 1] = UDUp0_avg_32_10 >> 16;
-
-                        uint32_t UDUp0_7654 = *UDUp0++;
-                        uint32_t UDUp0_avg_76_54 = __SHADD8(UDUp0_7654, __UXTB16_RORn(UDUp0_7654, 8));
-                        UDU_avg[j + 2] = UDUp0_avg_76_54;
-                        UDU_avg[j + 3] = UDUp0_avg_76_54 >> 16;
-
-                        uint32_t UDUp1_3210 = *UDUp1++;
-                        uint32_t UDUp1_avg_32_10 = __SHADD8(UDUp1_3210, __UXTB16_RORn(UDUp1_3210, 8));
-                        UDU_avg[j + 4] = UDUp1_avg_32_10;
-                        UDU_avg[j + 5] = UDUp1_avg_32_10 >> 16;
-
-                        uint32_t UDUp1_7654 = *UDUp1++;
-                        uint32_t UDUp1_avg_76_54 = __SHADD8(UDUp1_7654, __UXTB16_RORn(UDUp1_7654, 8));
-                        UDU_avg[j + 6] = UDUp1_avg_76_54;
-                        UDU_avg[j + 7] = UDUp1_avg_76_54 >> 16;
-
-                        uint32_t VDUp0_3210 = *VDUp0++;
-                        uint32_t VDUp0_avg_32_10 = __SHADD8(VDUp0_3210, __UXTB16_RORn(VDUp0_3210, 8));
-                        VDU_avg[j] = VDUp0_avg_32_10;
-                        VDU_avg[j + 1] = VDUp0_avg_32_10 >> 16;
-
-                        uint32_t VDUp0_7654 = *VDUp0++;
-                        uint32_t VDUp0_avg_76_54 = __SHADD8(VDUp0_7654, __UXTB16_RORn(VDUp0_7654, 8));
-                        VDU_avg[j + 2] = VDUp0_avg_76_54;
-                        VDU_avg[j + 3] = VDUp0_avg_76_54 >> 16;
-
-                        uint32_t VDUp1_3210 = *VDUp1++;
-                        uint32_t VDUp1_avg_32_10 = __SHADD8(VDUp1_3210, __UXTB16_RORn(VDUp1_3210, 8));
-                        VDU_avg[j + 4] = VDUp1_avg_32_10;
-                        VDU_avg[j + 5] = VDUp1_avg_32_10 >> 16;
-
-                        uint32_t VDUp1_7654 = *VDUp1++;
-                        uint32_t VDUp1_avg_76_54 = __SHADD8(VDUp1_7654, __UXTB16_RORn(VDUp1_7654, 8));
-                        VDU_avg[j + 6] = VDUp1_avg_76_54;
-                        VDU_avg[j + 7] = VDUp1_avg_76_54 >> 16;
-                        #else
-                        for (int i = 0; i < JPEG_MCU_W; i += 2) {
-                            UDU_avg[j + (i / 2)] = (UDUp0[i] + UDUp0[i + 1]) / 2;
-                            VDU_avg[j + (i / 2)] = (VDUp0[i] + VDUp0[i + 1]) / 2;
-                            UDU_avg[j + (i / 2) + (JPEG_MCU_W / 2)] = (UDUp1[i] + UDUp1[i + 1]) / 2;
-                            VDU_avg[j + (i / 2) + (JPEG_MCU_W / 2)] = (VDUp1[i] + VDUp1[i + 1]) / 2;
-                        }
-                        UDUp0 += JPEG_MCU_W;
-                        VDUp0 += JPEG_MCU_W;
-                        UDUp1 += JPEG_MCU_W;
-                        VDUp1 += JPEG_MCU_W;
-                        #endif
+                    for (int i = 0; i < JPEG_MCU_W; i += 2) {
+                        UDU_avg[j + (i / 2)] = (UDUp0[i] + UDUp0[i + 1]) / 2;
+                        VDU_avg[j + (i / 2)] = (VDUp0[i] + VDUp0[i + 1]) / 2;
+                        UDU_avg[j + (i / 2) + (JPEG_MCU_W / 2)] = (UDUp1[i] + UDUp1[i + 1]) / 2;
+                        VDU_avg[j + (i / 2) + (JPEG_MCU_W / 2)] = (VDUp1[i] + VDUp1[i + 1]) / 2;
                     }
-
-                    DCU = jpeg_processDU(&jpeg_buf, UDU_avg, fdtbl_UV, DCU, UVDC_HT, UVAC_HT);
-                    DCV = jpeg_processDU(&jpeg_buf, VDU_avg, fdtbl_UV, DCV, UVDC_HT, UVAC_HT);
+                    UDUp0 += JPEG_MCU_W;
+                    VDUp0 += JPEG_MCU_W;
+                    UDUp1 += JPEG_MCU_W;
+                    VDUp1 += JPEG_MCU_W;
+                    #endif
                 }
 
-                if (jpeg_buf.overflow) {
-                    return true;
-                }
+                DCU = jpeg_processDU(jpeg_buf, UDU_avg, fdtbl_UV, DCU, UVDC_HT, UVAC_HT);
+                DCV = jpeg_processDU(jpeg_buf, VDU_avg, fdtbl_UV, DCV, UVDC_HT, UVAC_HT);
             }
             break;
         }
@@ -1804,147 +1772,229 @@ bool jpeg_compress(image_t *src, image_t *dst, int quality, bool realloc, jpeg_s
             int8_t UDU_avg[JPEG_444_GS_MCU_SIZE];
             int8_t VDU_avg[JPEG_444_GS_MCU_SIZE];
 
-            for (int y_offset = 0; y_offset < src->h; ) {
-                for (int x_offset = 0; x_offset < src->w; ) {
-                    for (int j = 0; j < (JPEG_444_GS_MCU_SIZE * 4);
-                         j += (JPEG_444_GS_MCU_SIZE * 2), y_offset += JPEG_MCU_H) {
-                        int dy = IM_MIN(JPEG_MCU_H, src->h - y_offset);
+            for (int x_offset = 0; x_offset < src->w; ) {
+                for (int j = 0; j < (JPEG_444_GS_MCU_SIZE * 4);
+                     j += (JPEG_444_GS_MCU_SIZE * 2), y_offset += JPEG_MCU_H) {
+                    int dy = IM_MIN(JPEG_MCU_H, src->h - y_offset);
 
-                        for (int i = 0; i < (JPEG_444_GS_MCU_SIZE * 2);
-                             i += JPEG_444_GS_MCU_SIZE, x_offset += JPEG_MCU_W) {
-                            int dx = IM_MIN(JPEG_MCU_W, src->w - x_offset);
-
-                            if ((dx > 0) && (dy > 0)) {
-                                jpeg_get_mcu(src, x_offset, y_offset, dx, dy, YDU + i + j, UDU + i + j, VDU + i + j);
-                            } else {
-                                memset(YDU + i + j, 0, JPEG_444_GS_MCU_SIZE);
-                                memset(UDU + i + j, 0, JPEG_444_GS_MCU_SIZE);
-                                memset(VDU + i + j, 0, JPEG_444_GS_MCU_SIZE);
-                            }
+                    for (int i = 0; i < (JPEG_444_GS_MCU_SIZE * 2);
+                         i += JPEG_444_GS_MCU_SIZE, x_offset += JPEG_MCU_W) {
+                        int dx = IM_MIN(JPEG_MCU_W, src->w - x_offset);
 
-                            DCY = jpeg_processDU(&jpeg_buf, YDU + i + j, fdtbl_Y, DCY, YDC_HT, YAC_HT);
+                        if ((dx > 0) && (dy > 0)) {
+                            jpeg_get_mcu(src, x_offset, y_offset, dx, dy, YDU + i + j, UDU + i + j, VDU + i + j);
+                        } else {
+                            memset(YDU + i + j, 0, JPEG_444_GS_MCU_SIZE);
+                            memset(UDU + i + j, 0, JPEG_444_GS_MCU_SIZE);
+                            memset(VDU + i + j, 0, JPEG_444_GS_MCU_SIZE);
                         }
 
-                        // Reset back two columns.
-                        x_offset -= (JPEG_MCU_W * 2);
+                        DCY = jpeg_processDU(jpeg_buf, YDU + i + j, fdtbl_Y, DCY, YDC_HT, YAC_HT);
                     }
 
-                    // Advance to the next columns.
-                    x_offset += (JPEG_MCU_W * 2);
+                    // Reset back two columns.
+                    x_offset -= (JPEG_MCU_W * 2);
+                }
+
+                // Advance to the next columns.
+                x_offset += (JPEG_MCU_W * 2);
 
-                    // Reset back two rows.
-                    y_offset -= (JPEG_MCU_H * 2);
+                // Reset back two rows.
+                y_offset -= (JPEG_MCU_H * 2);
 
-                    // horizontal and vertical subsampling of U & V
+                // horizontal and vertical subsampling of U & V
+                #if defined(ARM_MATH_DSP)
+                uint32_t *UDUp = (uint32_t *) UDU;
+                uint32_t *VDUp = (uint32_t *) VDU;
+                #else
+                int8_t *UDUp0 = UDU;
+                int8_t *VDUp0 = VDU;
+                int8_t *UDUp1 = UDUp0 + JPEG_444_GS_MCU_SIZE;
+                int8_t *VDUp1 = VDUp0 + JPEG_444_GS_MCU_SIZE;
+                int8_t *UDUp2 = UDUp1 + JPEG_444_GS_MCU_SIZE;
+                int8_t *VDUp2 = VDUp1 + JPEG_444_GS_MCU_SIZE;
+                int8_t *UDUp3 = UDUp2 + JPEG_444_GS_MCU_SIZE;
+                int8_t *VDUp3 = VDUp2 + JPEG_444_GS_MCU_SIZE;
+                #endif
+                for (int j = 0, k = JPEG_444_GS_MCU_SIZE / 2; k < JPEG_444_GS_MCU_SIZE;
+                     j += JPEG_MCU_W, k += JPEG_MCU_W) {
                     #if defined(ARM_MATH_DSP)
-                    uint32_t *UDUp = (uint32_t *) UDU;
-                    uint32_t *VDUp = (uint32_t *) VDU;
+                    for (int i = 0; i < 4; i++) {
+                        int index = ((i & 2) ? k : j) + ((i & 1) * 4);
+
+                        uint32_t UDU_r0_3210 = UDUp[i * 16];
+                        uint32_t UDU_r0_avg_32_10 = __SHADD8(UDU_r0_3210, __UXTB16_RORn(UDU_r0_3210, 8));
+                        uint32_t UDU_r0_7654 = UDUp[(i * 16) + 1];
+                        uint32_t UDU_r0_avg_76_54 = __SHADD8(UDU_r0_7654, __UXTB16_RORn(UDU_r0_7654, 8));
+
+                        uint32_t UDU_r1_3210 = UDUp[(i * 16) + 2];
+                        uint32_t UDU_r1_avg_32_10 = __SHADD8(UDU_r1_3210, __UXTB16_RORn(UDU_r1_3210, 8));
+                        uint32_t UDU_r1_7654 = UDUp[(i * 16) + 3];
+                        uint32_t UDU_r1_avg_76_54 = __SHADD8(UDU_r1_7654, __UXTB16_RORn(UDU_r1_7654, 8));
+
+                        uint32_t UDU_r0_r1_avg_32_10 = __SHADD8(UDU_r0_avg_32_10, UDU_r1_avg_32_10);
+                        UDU_avg[index] = UDU_r0_r1_avg_32_10;
+                        UDU_avg[index + 1] = UDU_r0_r1_avg_32_10 >> 16;
+
+                        uint32_t UDU_r0_r1_avg_76_54 = __SHADD8(UDU_r0_avg_76_54, UDU_r1_avg_76_54);
+                        UDU_avg[index + 2] = UDU_r0_r1_avg_76_54;
+                        UDU_avg[index + 3] = UDU_r0_r1_avg_76_54 >> 16;
+
+                        uint32_t VDU_r0_3210 = VDUp[i * 16];
+                        uint32_t VDU_r0_avg_32_10 = __SHADD8(VDU_r0_3210, __UXTB16_RORn(VDU_r0_3210, 8));
+                        uint32_t VDU_r0_7654 = VDUp[(i * 16) + 1];
+                        uint32_t VDU_r0_avg_76_54 = __SHADD8(VDU_r0_7654, __UXTB16_RORn(VDU_r0_7654, 8));
+
+                        uint32_t VDU_r1_3210 = VDUp[(i * 16) + 2];
+                        uint32_t VDU_r1_avg_32_10 = __SHADD8(VDU_r1_3210, __UXTB16_RORn(VDU_r1_3210, 8));
+                        uint32_t VDU_r1_7654 = VDUp[(i * 16) + 3];
+                        uint32_t VDU_r1_avg_76_54 = __SHADD8(VDU_r1_7654, __UXTB16_RORn(VDU_r1_7654, 8));
+
+                        uint32_t VDU_r0_r1_avg_32_10 = __SHADD8(VDU_r0_avg_32_10, VDU_r1_avg_32_10);
+                        VDU_avg[index] = VDU_r0_r1_avg_32_10;
+                        VDU_avg[index + 1] = VDU_r0_r1_avg_32_10 >> 16;
+
+                        uint32_t VDU_r0_r1_avg_76_54 = __SHADD8(VDU_r0_avg_76_54, VDU_r1_avg_76_54);
+                        VDU_avg[index + 2] = VDU_r0_r1_avg_76_54;
+                        VDU_avg[index + 3] = VDU_r0_r1_avg_76_54 >> 16;
+                    }
+                    UDUp += 4;
+                    VDUp += 4;
                     #else
-                    int8_t *UDUp0 = UDU;
-                    int8_t *VDUp0 = VDU;
-                    int8_t *UDUp1 = UDUp0 + JPEG_444_GS_MCU_SIZE;
-                    int8_t *VDUp1 = VDUp0 + JPEG_444_GS_MCU_SIZE;
-                    int8_t *UDUp2 = UDUp1 + JPEG_444_GS_MCU_SIZE;
-                    int8_t *VDUp2 = VDUp1 + JPEG_444_GS_MCU_SIZE;
-                    int8_t *UDUp3 = UDUp2 + JPEG_444_GS_MCU_SIZE;
-                    int8_t *VDUp3 = VDUp2 + JPEG_444_GS_MCU_SIZE;
-                    #endif
-                    for (int j = 0, k = JPEG_444_GS_MCU_SIZE / 2; k < JPEG_444_GS_MCU_SIZE;
-                         j += JPEG_MCU_W, k += JPEG_MCU_W) {
-                        #if defined(ARM_MATH_DSP)
-                        for (int i = 0; i < 4; i++) {
-                            int index = ((i & 2) ? k : j) + ((i & 1) * 4);
-
-                            uint32_t UDU_r0_3210 = UDUp[i * 16];
-                            uint32_t UDU_r0_avg_32_10 = __SHADD8(UDU_r0_3210, __UXTB16_RORn(UDU_r0_3210, 8));
-                            uint32_t UDU_r0_7654 = UDUp[(i * 16) + 1];
-                            uint32_t UDU_r0_avg_76_54 = __SHADD8(UDU_r0_7654, __UXTB16_RORn(UDU_r0_7654, 8));
-
-                            uint32_t UDU_r1_3210 = UDUp[(i * 16) + 2];
-                            uint32_t UDU_r1_avg_32_10 = __SHADD8(UDU_r1_3210, __UXTB16_RORn(UDU_r1_3210, 8));
-                            uint32_t UDU_r1_7654 = UDUp[(i * 16) + 3];
-                            uint32_t UDU_r1_avg_76_54 = __SHADD8(UDU_r1_7654, __UXTB16_RORn(UDU_r1_7654, 8));
-
-                            uint32_t UDU_r0_r1_avg_32_10 = __SHADD8(UDU_r0_avg_32_10, UDU_r1_avg_32_10);
-                            UDU_avg[index] = UDU_r0_r1_avg_32_10;
-                            UDU_avg[index + 1] = UDU_r0_r1_avg_32_10 >> 16;
-
-                            uint32_t UDU_r0_r1_avg_76_54 = __SHADD8(UDU_r0_avg_76_54, UDU_r1_avg_76_54);
-                            UDU_avg[index + 2] = UDU_r0_r1_avg_76_54;
-                            UDU_avg[index + 3] = UDU_r0_r1_avg_76_54 >> 16;
-
-                            uint32_t VDU_r0_3210 = VDUp[i * 16];
-                            uint32_t VDU_r0_avg_32_10 = __SHADD8(VDU_r0_3210, __UXTB16_RORn(VDU_r0_3210, 8));
-                            uint32_t VDU_r0_7654 = VDUp[(i * 16) + 1];
-                            uint32_t VDU_r0_avg_76_54 = __SHADD8(VDU_r0_7654, __UXTB16_RORn(VDU_r0_7654, 8));
-
-                            uint32_t VDU_r1_3210 = VDUp[(i * 16) + 2];
-                            uint32_t VDU_r1_avg_32_10 = __SHADD8(VDU_r1_3210, __UXTB16_RORn(VDU_r1_3210, 8));
-                            uint32_t VDU_r1_7654 = VDUp[(i * 16) + 3];
-                            uint32_t VDU_r1_avg_76_54 = __SHADD8(VDU_r1_7654, __UXTB16_RORn(VDU_r1_7654, 8));
-
-                            uint32_t VDU_r0_r1_avg_32_10 = __SHADD8(VDU_r0_avg_32_10, VDU_r1_avg_32_10);
-                            VDU_avg[index] = VDU_r0_r1_avg_32_10;
-                            VDU_avg[index + 1] = VDU_r0_r1_avg_32_10 >> 16;
-
-                            uint32_t VDU_r0_r1_avg_76_54 = __SHADD8(VDU_r0_avg_76_54, VDU_r1_avg_76_54);
-                            VDU_avg[index + 2] = VDU_r0_r1_avg_76_54;
-                            VDU_avg[index + 3] = VDU_r0_r1_avg_76_54 >> 16;
-                        }
-                        UDUp += 4;
-                        VDUp += 4;
-                        #else
-                        for (int i = 0; i < JPEG_MCU_W; i += 2) {
-                            UDU_avg[j + (i / 2)] =
-                                (UDUp0[i] + UDUp0[i + 1] + UDUp0[i + JPEG_MCU_W] + UDUp0[i + 1 + JPEG_MCU_W]) / 4;
-                            VDU_avg[j + (i / 2)] =
-                                (VDUp0[i] + VDUp0[i + 1] + VDUp0[i + JPEG_MCU_W] + VDUp0[i + 1 + JPEG_MCU_W]) / 4;
-                            UDU_avg[j + (i / 2) + (JPEG_MCU_W / 2)] =
-                                (UDUp1[i] + UDUp1[i + 1] + UDUp1[i + JPEG_MCU_W] + UDUp1[i + 1 + JPEG_MCU_W]) / 4;
-                            VDU_avg[j + (i / 2) + (JPEG_MCU_W / 2)] =
-                                (VDUp1[i] + VDUp1[i + 1] + VDUp1[i + JPEG_MCU_W] + VDUp1[i + 1 + JPEG_MCU_W]) / 4;
-                            UDU_avg[k + (i / 2)] =
-                                (UDUp2[i] + UDUp2[i + 1] + UDUp2[i + JPEG_MCU_W] + UDUp2[i + 1 + JPEG_MCU_W]) / 4;
-                            VDU_avg[k + (i / 2)] =
-                                (VDUp2[i] + VDUp2[i + 1] + VDUp2[i + JPEG_MCU_W] + VDUp2[i + 1 + JPEG_MCU_W]) / 4;
-                            UDU_avg[k + (i / 2) + (JPEG_MCU_W / 2)] =
-                                (UDUp3[i] + UDUp3[i + 1] + UDUp3[i + JPEG_MCU_W] + UDUp3[i + 1 + JPEG_MCU_W]) / 4;
-                            VDU_avg[k + (i / 2) + (JPEG_MCU_W / 2)] =
-                                (VDUp3[i] + VDUp3[i + 1] + VDUp3[i + JPEG_MCU_W] + VDUp3[i + 1 + JPEG_MCU_W]) / 4;
-                        }
-                        UDUp0 += JPEG_MCU_W * 2;
-                        VDUp0 += JPEG_MCU_W * 2;
-                        UDUp1 += JPEG_MCU_W * 2;
-                        VDUp1 += JPEG_MCU_W * 2;
-                        UDUp2 += JPEG_MCU_W * 2;
-                        VDUp2 += JPEG_MCU_W * 2;
-                        UDUp3 += JPEG_MCU_W * 2;
-                        VDUp3 += JPEG_MCU_W * 2;
-                        #endif
+                    for (int i = 0; i < JPEG_MCU_W; i += 2) {
+                        UDU_avg[j + (i / 2)] =
+                            (UDUp0[i] + UDUp0[i + 1] + UDUp0[i + JPEG_MCU_W] + UDUp0[i + 1 + JPEG_MCU_W]) / 4;
+                        VDU_avg[j + (i / 2)] =
+                            (VDUp0[i] + VDUp0[i + 1] + VDUp0[i + JPEG_MCU_W] + VDUp0[i + 1 + JPEG_MCU_W]) / 4;
+                        UDU_avg[j + (i / 2) + (JPEG_MCU_W / 2)] =
+                            (UDUp1[i] + UDUp1[i + 1] + UDUp1[i + JPEG_MCU_W] + UDUp1[i + 1 + JPEG_MCU_W]) / 4;
+                        VDU_avg[j + (i / 2) + (JPEG_MCU_W / 2)] =
+                            (VDUp1[i] + VDUp1[i + 1] + VDUp1[i + JPEG_MCU_W] + VDUp1[i + 1 + JPEG_MCU_W]) / 4;
+                        UDU_avg[k + (i / 2)] =
+                            (UDUp2[i] + UDUp2[i + 1] + UDUp2[i + JPEG_MCU_W] + UDUp2[i + 1 + JPEG_MCU_W]) / 4;
+                        VDU_avg[k + (i / 2)] =
+                            (VDUp2[i] + VDUp2[i + 1] + VDUp2[i + JPEG_MCU_W] + VDUp2[i + 1 + JPEG_MCU_W]) / 4;
+                        UDU_avg[k + (i / 2) + (JPEG_MCU_W / 2)] =
+                            (UDUp3[i] + UDUp3[i + 1] + UDUp3[i + JPEG_MCU_W] + UDUp3[i + 1 + JPEG_MCU_W]) / 4;
+                        VDU_avg[k + (i / 2) + (JPEG_MCU_W / 2)] =
+                            (VDUp3[i] + VDUp3[i + 1] + VDUp3[i + JPEG_MCU_W] + VDUp3[i + 1 + JPEG_MCU_W]) / 4;
                     }
-
-                    DCU = jpeg_processDU(&jpeg_buf, UDU_avg, fdtbl_UV, DCU, UVDC_HT, UVAC_HT);
-                    DCV = jpeg_processDU(&jpeg_buf, VDU_avg, fdtbl_UV, DCV, UVDC_HT, UVAC_HT);
-                }
-
-                if (jpeg_buf.overflow) {
-                    return true;
+                    UDUp0 += JPEG_MCU_W * 2;
+                    VDUp0 += JPEG_MCU_W * 2;
+                    UDUp1 += JPEG_MCU_W * 2;
+                    VDUp1 += JPEG_MCU_W * 2;
+                    UDUp2 += JPEG_MCU_W * 2;
+                    VDUp2 += JPEG_MCU_W * 2;
+                    UDUp3 += JPEG_MCU_W * 2;
+                    VDUp3 += JPEG_MCU_W * 2;
+                    #endif
                 }
 
-                // Advance to the next rows.
-                y_offset += (JPEG_MCU_H * 2);
+                DCU = jpeg_processDU(jpeg_buf, UDU_avg, fdtbl_UV, DCU, UVDC_HT, UVAC_HT);
+                DCV = jpeg_processDU(jpeg_buf, VDU_avg, fdtbl_UV, DCV, UVDC_HT, UVAC_HT);
             }
             break;
         }
     }
 
+
+    DC[0] = DCY;
+    DC[1] = DCU;
+    DC[2] = DCV;
+    return jpeg_buf->overflow;
+}
+
+// Pads the current restart interval to a byte boundary and writes the RSTn marker.
+static void jpeg_write_restart(jpeg_buf_t *jpeg_buf, int n) {
+    static const uint16_t fillBits[] = {0x7F, 7};
+    jpeg_writeBits(jpeg_buf, fillBits);
+    jpeg_buf->bitc = 0;
+    jpeg_buf->bitb = 0;
+
+    jpeg_put_char(jpeg_buf, 0xFF);
+    jpeg_put_char(jpeg_buf, 0xD0 + (n & 7));
+}
+
+static jpeg_subsampling_t jpeg_get_subsampling(image_t *src, int quality, jpeg_subsampling_t subsampling) {
+    if (!src->is_color) {
+        return JPEG_SUBSAMPLING_444;
+    }
+
+    if (subsampling == JPEG_SUBSAMPLING_AUTO) {
+        if (quality <= 35) {
+            subsampling = JPEG_SUBSAMPLING_420;
+        } else if (quality < 60) {
+            subsampling = JPEG_SUBSAMPLING_422;
+        } else {
+            subsampling = JPEG_SUBSAMPLING_444;
+        }
+    }
+
+    return subsampling;
+}
+
+static void jpeg_write_eoi(jpeg_buf_t *jpeg_buf) {
     // Do the bit alignment of the EOI marker
     static const uint16_t fillBits[] = {0x7F, 7};
-    jpeg_writeBits(&jpeg_buf, fillBits);
+    jpeg_writeBits(jpeg_buf, fillBits);
 
     // EOI
-    jpeg_put_char(&jpeg_buf, 0xFF);
-    jpeg_put_char(&jpeg_buf, 0xD9);
+    jpeg_put_char(jpeg_buf, 0xFF);
+    jpeg_put_char(jpeg_buf, 0xD9);
+}
+
+// Encodes src into jpeg_buf, returns true if the buffer overflowed.
+static bool jpeg_compress_buf(image_t *src, jpeg_buf_t *jpeg_buf, int quality, jpeg_subsampling_t subsampling) {
+    // Initialize quantization tables
+    jpeg_init(quality);
+
+    subsampling = jpeg_get_subsampling(src, quality, subsampling);
+    jpeg_write_headers(jpeg_buf, src->w, src->h, src->is_color ? 2 : 1, subsampling, 0);
+
+    int DC[3] = {0, 0, 0};
+    int mcu_h = (subsampling == JPEG_SUBSAMPLING_420) ? (JPEG_MCU_H * 2) : JPEG_MCU_H;
+
+    for (int y_offset = 0; y_offset < src->h; y_offset += mcu_h) {
+        if (jpeg_compress_mcu_row(jpeg_buf, src, y_offset, subsampling, DC)) {
+            return true;
+        }
+    }
+
+    jpeg_write_eoi(jpeg_buf);
+    return jpeg_buf->overflow;
+}
+
+bool jpeg_compress(image_t *src, image_t *dst, int quality, bool realloc, jpeg_subsampling_t subsampling) {
+    TRACE_PROF_SCOPE(TRACE_PROF_JPEG_COMPRESS);
+
+    #if (TIME_JPEG == 1)
+    mp_uint_t start = mp_hal_ticks_ms();
+    #endif
+
+    if (!dst->data) {
+        uint32_t size = 0;
+        dst->data = fb_alloc_all(&size, FB_ALLOC_PREFER_SIZE | FB_ALLOC_CACHE_ALIGN);
+        dst->size = IMLIB_IMAGE_MAX_SIZE(size);
+    }
+
+    if (src->is_compressed) {
+        return true;
+    }
+
+    // JPEG buffer
+    jpeg_buf_t jpeg_buf = {
+        .idx = 0,
+        .buf = dst->pixels,
+        .length = dst->size,
+        .bitc = 0,
+        .bitb = 0,
+        .realloc = realloc,
+        .overflow = false,
+    };
+
+    if (jpeg_compress_buf(src, &jpeg_buf, quality, subsampling)) {
+        return true;
+    }
 
     dst->size = jpeg_buf.idx;
     dst->data = jpeg_buf.buf;
@@ -1956,6 +2006,131 @@ bool jpeg_compress(image_t *src, image_t *dst, int quality, bool realloc, jpeg_s
     return false;
 }
 
+bool jpeg_compress_stream(image_t *src, int quality, jpeg_subsampling_t subsampling, uint8_t *buf, uint32_t length,
+                          jpeg_flush_callback_t flush, void *flush_arg, uint32_t *size) {
+    TRACE_PROF_SCOPE(TRACE_PROF_JPEG_COMPRESS);
+
+    if (src->is_compressed || (length < JPEG_STREAM_MIN_SIZE)) {
+        return true;
+    }
+
+    jpeg_buf_t jpeg_buf = {
+        .idx = 0,
+        .buf = buf,
+        .length = length,
+        .bitc = 0,
+        .bitb = 0,
+        .realloc = false,
+        .overflow = false,
+        .flush = flush,
+        .flush_arg = flush_arg,
+        .flushed = 0,
+    };
+
+    if (jpeg_compress_buf(src, &jpeg_buf, quality, subsampling)
+        || (jpeg_buf.idx && (!flush(buf, jpeg_buf.idx, flush_arg)))) {
+        return true;
+    }
+
+    *size = jpeg_buf.flushed + jpeg_buf.idx;
+    return false;
+}
+
+bool jpeg_encoder_init(jpeg_encoder_t *enc, image_t *src, image_t *dst, int quality, bool realloc,
+                       jpeg_subsampling_t subsampling) {
+    if (!dst->data) {
+        uint32_t size = 0;
+        dst->data = fb_alloc_all(&size, FB_ALLOC_PREFER_SIZE | FB_ALLOC_CACHE_ALIGN);
+        dst->size = IMLIB_IMAGE_MAX_SIZE(size);
+    }
+
+    if (src->is_compressed) {
+        return true;
+    }
+
+    enc->buf = (jpeg_buf_t) {
+        .idx = 0,
+        .buf = dst->pixels,
+        .length = dst->size,
+        .bitc = 0,
+        .bitb = 0,
+        .realloc = realloc,
+        .overflow = false,
+    };
+    enc->src = src;
+    enc->subsampling = jpeg_get_subsampling(src, quality, subsampling);
+    enc->mcu_h = (enc->subsampling == JPEG_SUBSAMPLING_420) ? (JPEG_MCU_H * 2) : JPEG_MCU_H;
+    enc->mcu_rows = (src->h + enc->mcu_h - 1) / enc->mcu_h;
+    enc->mcu_row = 0;
+
+    // One restart interval per MCU row.
+    int mcu_w = (enc->subsampling == JPEG_SUBSAMPLING_444) ? JPEG_MCU_W : (JPEG_MCU_W * 2);
+    int restart_interval = (src->w + mcu_w - 1) / mcu_w;
+
+    jpeg_init(quality);
+    jpeg_write_headers(&enc->buf, src->w, src->h, src->is_color ? 2 : 1, enc->subsampling, restart_interval);
+    return enc->buf.overflow;
+}
+
+bool jpeg_encoder_strip(jpeg_encoder_t *enc, jpeg_buf_t *jpeg_buf, int mcu_row_start, int mcu_row_end) {
+    mcu_row_end = IM_MIN(mcu_row_end, enc->mcu_rows);
+
+    for (int i = mcu_row_start; i < mcu_row_end; i++) {
+        // Every restart interval starts with the DC predictors reset.
+        int DC[3] = {0, 0, 0};
+
+        if (jpeg_compress_mcu_row(jpeg_buf, enc->src, i * enc->mcu_h, enc->subsampling, DC)) {
+            return true;
+        }
+
+        if ((i + 1) < enc->mcu_rows) {
+            jpeg_write_restart(jpeg_buf, i);
+        }
+    }
+
+    return jpeg_buf->overflow;
+}
+
+bool jpeg_encoder_append(jpeg_encoder_t *enc, jpeg_buf_t *jpeg_buf, int mcu_rows) {
+    // Strips end with a restart marker so they're byte aligned, except for the last one
+    // which may leave a few bits pending.
+    jpeg_put_bytes(&enc->buf, jpeg_buf->buf, jpeg_buf->idx);
+    enc->buf.bitb = jpeg_buf->bitb;
+    enc->buf.bitc = jpeg_buf->bitc;
+    enc->mcu_row += mcu_rows;
+    return enc->buf.overflow;
+}
+
+bool jpeg_encoder_write(jpeg_encoder_t *enc, int y_end) {
+    // Only encode MCU rows that are complete.
+    int mcu_row_end = (y_end >= enc->src->h) ? enc->mcu_rows : (y_end / enc->mcu_h);
+
+    if (mcu_row_end > enc->mcu_row) {
+        if (jpeg_encoder_strip(enc, &enc->buf, enc->mcu_row, mcu_row_end)) {
+            return true;
+        }
+        enc->mcu_row = mcu_row_end;
+    }
+
+    return false;
+}
+
+bool jpeg_encoder_finish(jpeg_encoder_t *enc, image_t *dst) {
+    if (jpeg_encoder_write(enc, enc->src->h)) {
+        return true;
+    }
+
+    jpeg_write_eoi(&enc->buf);
+
+    if (enc->buf.overflow) {
+        return true;
+    }
+
+    dst->size = enc->buf.idx;
+    dst->data = enc->buf.buf;
+    return false;
+}
+
 #endif // (OMV_JPEG_CODEC_ENABLE == 0)
 
 bool jpeg_is_valid(image_t *img) {
@@ -1991,14 +2166,60 @@ bool jpeg_is_valid(image_t *img) {
     return false;
 }
 
-int jpeg_clean_trailing_bytes(int size, uint8_t *data) {
-    while ((size > 1) && ((data[size - 2] != 0xFF) || (data[size - 1] != 0xD9))) {
-        size -= 1;
+int jpeg_clean_trailing_bytes(int size, uint8_t *data, int search) {
+    for (int i = size, end = IM_MAX(size - search, 1); i > end; i--) {
+        if ((data[i - 2] == 0xFF) && (data[i - 1] == 0xD9)) {
+            return i;
+        }
     }
 
     return size;
 }
 
+// The quantization scale (percent of the standard tables) of a quality, see jpeg_init().
+static float jpeg_quality_to_scale(int quality) {
+    quality = IM_CLAMP(quality, 1, 100);
+    return IM_MAX((quality < 50) ? (5000.0f / quality) : (200.0f - (quality * 2)), 1.0f);
+}
+
+static int jpeg_scale_to_quality(float scale) {
+    int quality = fast_roundf((scale > 100.0f) ? (5000.0f / scale) : ((200.0f - scale) / 2.0f));
+    return IM_CLAMP(quality, 1, 100);
+}
+
+void jpeg_rate_init(jpeg_rate_t *rate, uint32_t frame_size, uint32_t bitrate, int quality_min, int quality_max) {
+    rate->frame_size = frame_size;
+    rate->bitrate = bitrate;
+    rate->quality_min = IM_CLAMP(quality_min, 1, 100);
+    rate->quality_max = IM_CLAMP(quality_max, rate->quality_min, 100);
+    rate->quality = (rate->quality_min + rate->quality_max) / 2;
+    rate->scale = jpeg_quality_to_scale(rate->quality);
+}
+
+// Frame size is roughly inversely proportional to the quantization scale, so the scale that
+// hits the target is the last scale times the ratio of the last size to the target. Only half
+// of the correction (in the log domain) is applied per frame to damp frame to frame noise.
+int jpeg_rate_update(jpeg_rate_t *rate, uint32_t size, bool overflow, uint32_t elapsed_us) {
+    uint32_t target = rate->frame_size;
+
+    // The bitrate's share for this frame, also capped by the frame size if both are set.
+    if (rate->bitrate && elapsed_us) {
+        uint32_t share = (((uint64_t) rate->bitrate) * elapsed_us) / 8000000;
+        target = target ? IM_MIN(target, share) : share;
+    }
+
+    if (target) {
+        // The size of a frame that didn't fit is unknown, so the scale is doubled.
+        float ratio = overflow ? 4.0f : (size / (float) target);
+        rate->scale = IM_CLAMP(rate->scale * fast_sqrtf(ratio),
+                               jpeg_quality_to_scale(rate->quality_max),
+                               jpeg_quality_to_scale(rate->quality_min));
+        rate->quality = jpeg_scale_to_quality(rate->scale);
+    }
+
+    return rate->quality;
+}
+
 #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
 // This function inits the geometry values of an image.
 void jpeg_read_geometry(FIL *fp, image_t *img, const char *path, jpg_read_settings_t *rs) {
@@ -2068,12 +2289,29 @@ void jpeg_read(image_t *img, const char *path) {
     file_close(&fp);
 }
 
+#if (OMV_JPEG_CODEC_ENABLE == 0)
+static bool jpeg_write_flush(const uint8_t *data, uint32_t size, void *arg) {
+    file_write((FIL *) arg, data, size);
+    return true;
+}
+#endif
+
 void jpeg_write(image_t *img, const char *path, int quality) {
     FIL fp;
     file_open(&fp, path, false, FA_WRITE | FA_CREATE_ALWAYS);
     if (IM_IS_JPEG(img)) {
         file_write(&fp, img->pixels, img->size);
     } else {
+        #if (OMV_JPEG_CODEC_ENABLE == 0)
+        // Stream the encoded data to the file through a small buffer.
+        uint32_t size;
+        uint8_t *buf = fb_alloc(JPEG_WRITE_BUF_SIZE, FB_ALLOC_CACHE_ALIGN);
+        if (jpeg_compress_stream(img, quality, JPEG_SUBSAMPLING_AUTO, buf, JPEG_WRITE_BUF_SIZE,
+                                 jpeg_write_flush, &fp, &size)) {
+            file_raise_format(&fp);
+        }
+        fb_free(); // buf
+        #else
         // alloc in jpeg compress
         image_t out = { .w = img->w, .h = img->h, .pixfmt = PIXFORMAT_JPEG, .size = 0, .pixels = NULL };
         // When jpeg_compress needs more memory than in currently allocated it
@@ -2082,6 +2320,7 @@ void jpeg_write(image_t *img, const char *path, int quality) {
         jpeg_compress(img, &out, quality, false, JPEG_SUBSAMPLING_AUTO);
         file_write(&fp, out.pixels, out.size);
         fb_free(); // frees alloc in jpeg_compress()
+        #endif
     }
     file_close(&fp);
 }
@@ -16,6 +16,8 @@
 #include "array.h"
 #include "xalloc.h"
 
+#define KMEANS_MAX_ITERATIONS    (32)
+
 extern uint32_t rng_randint(uint32_t min, uint32_t max);
 
 static cluster_t *cluster_alloc(int cx, int cy) {
@@ -37,99 +39,157 @@ static void cluster_free(void *c) {
     xfree(cl);
 }
 
-static void cluster_reset(array_t *clusters, array_t *points) {
-    // Reset all clusters
-    for (int j = 0; j < array_length(clusters); j++) {
-        cluster_t *cl = array_at(clusters, j);
-        while (array_length(cl->points)) {
-            array_push_back(points, array_pop_back(cl->points));
-        }
-        array_free(cl->points);
-        array_alloc(&cl->points, NULL);
+// Labels each point with its nearest center. Coordinates are packed 2 per word so that
+// a squared distance over 2 dimensions is one __SSUB16 and one __SMUAD.
+static void kmeans_assign(kmeans_t *km, uint32_t *packed) {
+    for (int j = 0; j < km->k; j++) {
+        packed[(j * 2) + 0] = ((uint16_t) km->centers[0][j]) | (((uint32_t) (uint16_t) km->centers[1][j]) << 16);
+        packed[(j * 2) + 1] = (km->dims > 2) ? ((uint16_t) km->centers[2][j]) : 0;
     }
-}
 
-static int cluster_update(array_t *clusters) {
-    // Update clusters
-    for (int j = 0; j < array_length(clusters); j++) {
-        cluster_t *cl = array_at(clusters, j);
-        int cx = cl->x, cy = cl->y;
-        int cl_size = array_length(cl->points);
-
-        // Sum all points in this cluster
-        for (int i = 0; i < cl_size; i++) {
-            kp_t *p = array_at(cl->points, i);
-            cl->x += p->x;
-            cl->y += p->y;
-            // Find out the max x and y while we're at it
-            if (p->x > cl->w) {
-                cl->w = p->x;
+    for (int i = 0; i < km->n; i++) {
+        int best = 0;
+        uint32_t best_d = UINT32_MAX;
+
+        #if defined(ARM_MATH_DSP)
+        uint32_t p0 = ((uint16_t) km->points[0][i]) | (((uint32_t) (uint16_t) km->points[1][i]) << 16);
+        if (km->dims == 2) {
+            for (int j = 0; j < km->k; j++) {
+                uint32_t d0 = __SSUB16(packed[j * 2], p0);
+                uint32_t d = __SMUAD(d0, d0);
+                if (d < best_d) {
+                    best = j;
+                    best_d = d;
+                }
             }
-            if (p->y > cl->h) {
-                cl->h = p->y;
+        } else {
+            uint32_t p1 = (uint16_t) km->points[2][i];
+            for (int j = 0; j < km->k; j++) {
+                uint32_t d0 = __SSUB16(packed[(j * 2) + 0], p0);
+                uint32_t d1 = __SSUB16(packed[(j * 2) + 1], p1);
+                uint32_t d = __SMLAD(d1, d1, __SMUAD(d0, d0));
+                if (d < best_d) {
+                    best = j;
+                    best_d = d;
+                }
             }
         }
-
-        // Update centroid
-        cl->x = cl->x / cl_size;
-        cl->y = cl->y / cl_size;
-        // Update cluster size
-        cl->w = (cl->w - cl->x) * 2;
-        cl->h = (cl->h - cl->y) * 2;
-        if (cl->x == cx && cl->y == cy) {
-            // Cluster centroid did not change
-            return 0;
+        #else
+        for (int j = 0; j < km->k; j++) {
+            uint32_t d = 0;
+            for (int c = 0; c < km->dims; c++) {
+                int diff = km->centers[c][j] - km->points[c][i];
+                d += diff * diff;
+            }
+            if (d < best_d) {
+                best = j;
+                best_d = d;
+            }
         }
-    }
+        #endif
 
-    return 1;
+        km->labels[i] = best;
+    }
 }
 
-static void cluster_points(array_t *clusters, array_t *points, cluster_dist_t dist_func) {
-    // Add objects to cluster
-    while (array_length(points)) {
-        float distance = FLT_MAX;
-        cluster_t *cl_nearest = NULL;
-        kp_t *p = array_pop_back(points);
-
-        for (int j = 0; j < array_length(clusters); j++) {
-            cluster_t *cl = array_at(clusters, j);
-            float d = dist_func(cl->x, cl->y, p);
-            if (d < distance) {
-                distance = d;
-                cl_nearest = cl;
+int kmeans_run(kmeans_t *km, int max_iterations, int min_delta) {
+    int iterations = 0;
+
+    fb_alloc_mark();
+    uint32_t *packed = fb_alloc(km->k * 2 * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    int32_t *sums = fb_alloc(km->k * km->dims * sizeof(int32_t), FB_ALLOC_NO_HINT);
+    uint32_t *counts = fb_alloc(km->k * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+
+    while (iterations < max_iterations) {
+        iterations++;
+        kmeans_assign(km, packed);
+
+        memset(sums, 0, km->k * km->dims * sizeof(int32_t));
+        memset(counts, 0, km->k * sizeof(uint32_t));
+
+        for (int i = 0; i < km->n; i++) {
+            int j = km->labels[i];
+            uint32_t w = km->weights ? km->weights[i] : 1;
+            for (int c = 0; c < km->dims; c++) {
+                sums[(j * km->dims) + c] += km->points[c][i] * w;
+            }
+            counts[j] += w;
+        }
+
+        // Move the centers to their means, empty clusters stay where they are.
+        int delta = 0;
+        for (int j = 0; j < km->k; j++) {
+            if (counts[j]) {
+                for (int c = 0; c < km->dims; c++) {
+                    int32_t sum = sums[(j * km->dims) + c];
+                    int center = (sum + ((sum < 0) ? -(counts[j] / 2) : (counts[j] / 2))) / (int32_t) counts[j];
+                    delta = IM_MAX(delta, abs(center - km->centers[c][j]));
+                    km->centers[c][j] = center;
+                }
             }
         }
-        // Add pointer to point to cluster.
-        // Note: Objects in the cluster are not free'd
-        array_push_back(cl_nearest->points, p);
+
+        if (delta <= min_delta) {
+            break;
+        }
+    }
+
+    // Labels must match the final centers.
+    if (iterations == max_iterations) {
+        kmeans_assign(km, packed);
     }
+
+    fb_alloc_free_till_mark();
+    return iterations;
 }
 
-array_t *cluster_kmeans(array_t *points, int k, cluster_dist_t dist_func) {
+array_t *cluster_kmeans(array_t *points, int k) {
     // Alloc clusters array
     array_t *clusters = NULL;
     array_alloc(&clusters, cluster_free);
 
-    // Select K clusters randomly
-    for (int i = 0; i < k; i++) {
-        int pidx = rng_randint(0, array_length(points) - 1);
-        kp_t *p = array_at(points, pidx);
-        array_push_back(clusters, cluster_alloc(p->x, p->y));
+    int n = array_length(points);
+    if ((!n) || (k <= 0)) {
+        return clusters;
+    }
+
+    fb_alloc_mark();
+    kmeans_t km = { .n = n, .k = k, .dims = 2, .weights = NULL };
+    for (int c = 0; c < 2; c++) {
+        km.points[c] = fb_alloc(n * sizeof(int16_t), FB_ALLOC_NO_HINT);
+        km.centers[c] = fb_alloc(k * sizeof(int16_t), FB_ALLOC_NO_HINT);
     }
+    km.labels = fb_alloc(n * sizeof(uint16_t), FB_ALLOC_NO_HINT);
 
-    int cl_changed = 1;
-    do {
-        // Reset clusters
-        cluster_reset(clusters, points);
+    for (int i = 0; i < n; i++) {
+        kp_t *p = array_at(points, i);
+        km.points[0][i] = p->x;
+        km.points[1][i] = p->y;
+    }
 
-        // Add points to clusters
-        cluster_points(clusters, points, dist_func);
+    // Select K clusters randomly
+    for (int j = 0; j < k; j++) {
+        int pidx = rng_randint(0, n - 1);
+        km.centers[0][j] = km.points[0][pidx];
+        km.centers[1][j] = km.points[1][pidx];
+    }
 
-        // Update centroids
-        cl_changed = cluster_update(clusters);
+    kmeans_run(&km, KMEANS_MAX_ITERATIONS, 0);
 
-    } while (cl_changed);
+    for (int j = 0; j < k; j++) {
+        array_push_back(clusters, cluster_alloc(km.centers[0][j], km.centers[1][j]));
+    }
+
+    // Add pointers to points to clusters, and find their extent while we're at it.
+    // Note: Objects in the cluster are not free'd
+    for (int i = 0; i < n; i++) {
+        cluster_t *cl = array_at(clusters, km.labels[i]);
+        kp_t *p = array_at(points, i);
+        array_push_back(cl->points, p);
+        cl->w = IM_MAX(cl->w, (p->x - cl->x) * 2);
+        cl->h = IM_MAX(cl->h, (p->y - cl->y) * 2);
+    }
 
+    fb_alloc_free_till_mark();
     return clusters;
 }
@@ -1,5 +1,5 @@
 #include <stdint.h>
-const int8_t lab_table[98304] = {
+const int8_t lab_table[98304 + 1] = {
     0,    0,   -1,     0,    3,   -9,     1,    8,  -21,     2,   16,  -31,
     4,   27,  -41,     6,   35,  -48,     8,   41,  -55,    11,   45,  -61,
     14,   50,  -67,    16,   54,  -73,    19,   58,  -79,    22,   62,  -84,
@@ -52,6 +52,14 @@ const static uint8_t uniform_tbl[256] = {
     47, 48, 58, 49, 58, 58, 58, 50, 51, 52, 58, 53, 54, 55, 56, 57
 };
 
+#if defined(ARM_MATH_DSP)
+// Returns bit in each lane where the neighbour n is >= the center p.
+static inline uint32_t lbp_bit_x4(uint32_t n, uint32_t p, uint32_t bit) {
+    __USUB8(n, p);
+    return __SEL(bit * 0x01010101, 0);
+}
+#endif
+
 uint8_t *imlib_lbp_desc(image_t *image, rectangle_t *roi) {
     int s = image->w; //stride
     int RX = roi->w / LBP_NUM_REGIONS;
@@ -59,37 +67,126 @@ uint8_t *imlib_lbp_desc(image_t *image, rectangle_t *roi) {
     uint8_t *data = image->data;
     uint8_t *desc = xalloc0(LBP_DESC_SIZE);
 
+    if ((!RX) || (!RY)) {
+        return desc;
+    }
+
+    // Region column of each pixel, clamped so leftover pixels join the last region.
+    uint8_t *x_region = fb_alloc(roi->w, FB_ALLOC_NO_HINT);
+    for (int x = 0; x < roi->w; x++) {
+        x_region[x] = IM_MIN(x / RX, LBP_NUM_REGIONS - 1);
+    }
+
     for (int y = roi->y; y < (roi->y + roi->h) - 3; y++) {
-        int y_idx = ((y - roi->y) / RY) * LBP_NUM_REGIONS;
-        for (int x = roi->x; x < (roi->x + roi->w) - 3; x++) {
+        uint8_t *hist = desc + (IM_MIN((y - roi->y) / RY, LBP_NUM_REGIONS - 1) * LBP_NUM_REGIONS * LBP_HIST_SIZE);
+        uint8_t *r0 = data + ((y + 0) * s);
+        uint8_t *r1 = data + ((y + 1) * s);
+        uint8_t *r2 = data + ((y + 2) * s);
+        int x = roi->x, x_end = (roi->x + roi->w) - 3;
+
+        #if defined(ARM_MATH_DSP)
+        // 4 centers per word, each neighbour compare sets its bit in all 4 codes at once.
+        for (; (x + 4) <= x_end; x += 4) {
+            uint32_t p = *((uint32_t *) (r1 + x + 1));
+            uint32_t lbp = 0;
+
+            lbp |= lbp_bit_x4(*((uint32_t *) (r0 + x + 0)), p, 1 << 0);
+            lbp |= lbp_bit_x4(*((uint32_t *) (r0 + x + 1)), p, 1 << 1);
+            lbp |= lbp_bit_x4(*((uint32_t *) (r0 + x + 2)), p, 1 << 2);
+            lbp |= lbp_bit_x4(*((uint32_t *) (r1 + x + 2)), p, 1 << 3);
+            lbp |= lbp_bit_x4(*((uint32_t *) (r2 + x + 2)), p, 1 << 4);
+            lbp |= lbp_bit_x4(*((uint32_t *) (r2 + x + 1)), p, 1 << 5);
+            lbp |= lbp_bit_x4(*((uint32_t *) (r2 + x + 0)), p, 1 << 6);
+            lbp |= lbp_bit_x4(*((uint32_t *) (r1 + x + 0)), p, 1 << 7);
+
+            for (int i = 0; i < 4; i++, lbp >>= 8) {
+                hist[(x_region[x + i - roi->x] * LBP_HIST_SIZE) + uniform_tbl[lbp & 0xff]]++;
+            }
+        }
+        #endif
+
+        for (; x < x_end; x++) {
             uint8_t lbp = 0;
-            uint8_t p = data[(y + 1) * s + x + 1];
-            int hist_idx = y_idx + (x - roi->x) / RX;
-
-            lbp |= (data[(y + 0) * s + x + 0] >= p) << 0;
-            lbp |= (data[(y + 0) * s + x + 1] >= p) << 1;
-            lbp |= (data[(y + 0) * s + x + 2] >= p) << 2;
-            lbp |= (data[(y + 1) * s + x + 2] >= p) << 3;
-            lbp |= (data[(y + 2) * s + x + 2] >= p) << 4;
-            lbp |= (data[(y + 2) * s + x + 1] >= p) << 5;
-            lbp |= (data[(y + 2) * s + x + 0] >= p) << 6;
-            lbp |= (data[(y + 1) * s + x + 0] >= p) << 7;
-
-            desc[hist_idx * LBP_HIST_SIZE + uniform_tbl[lbp]]++;
+            uint8_t p = r1[x + 1];
+
+            lbp |= (r0[x + 0] >= p) << 0;
+            lbp |= (r0[x + 1] >= p) << 1;
+            lbp |= (r0[x + 2] >= p) << 2;
+            lbp |= (r1[x + 2] >= p) << 3;
+            lbp |= (r2[x + 2] >= p) << 4;
+            lbp |= (r2[x + 1] >= p) << 5;
+            lbp |= (r2[x + 0] >= p) << 6;
+            lbp |= (r1[x + 0] >= p) << 7;
+
+            hist[(x_region[x - roi->x] * LBP_HIST_SIZE) + uniform_tbl[lbp]]++;
         }
     }
+
+    fb_free(); // x_region
     return desc;
 }
 
-int imlib_lbp_desc_distance(uint8_t *d0, uint8_t *d1) {
+// Weighted chi-square distance, gives up and returns early once the sum reaches limit.
+static uint32_t lbp_desc_distance(uint8_t *d0, uint8_t *d1, uint32_t limit) {
     uint32_t sum = 0;
-    for (int i = 0; i < LBP_DESC_SIZE; i++) {
-        int w = lbp_weights[i / LBP_HIST_SIZE];
-        sum += w * ((((d0[i] - d1[i]) * (d0[i] - d1[i])) / IM_MAX((d0[i] + d1[i]), 1)));
+
+    for (int r = 0; r < (LBP_NUM_REGIONS * LBP_NUM_REGIONS); r++, d0 += LBP_HIST_SIZE, d1 += LBP_HIST_SIZE) {
+        int w = lbp_weights[r];
+        uint32_t region_sum = 0;
+        int i = 0;
+
+        if (!w) {
+            continue;
+        }
+
+        // Most bins of two close faces match, skip them 4 at a time.
+        for (; (i + 4) <= LBP_HIST_SIZE; i += 4) {
+            if (*((uint32_t *) (d0 + i)) == *((uint32_t *) (d1 + i))) {
+                continue;
+            }
+
+            for (int j = i; j < (i + 4); j++) {
+                int d = d0[j] - d1[j];
+                region_sum += (d * d) / IM_MAX(d0[j] + d1[j], 1);
+            }
+        }
+
+        for (; i < LBP_HIST_SIZE; i++) {
+            int d = d0[i] - d1[i];
+            region_sum += (d * d) / IM_MAX(d0[i] + d1[i], 1);
+        }
+
+        sum += w * region_sum;
+
+        if (sum >= limit) {
+            break;
+        }
     }
+
     return sum;
 }
 
+int imlib_lbp_desc_distance(uint8_t *d0, uint8_t *d1) {
+    return lbp_desc_distance(d0, d1, UINT32_MAX);
+}
+
+int imlib_lbp_desc_match(uint8_t *desc, uint8_t **gallery, int n, int *distance) {
+    int best = -1;
+    uint32_t best_distance = UINT32_MAX;
+
+    // Terms are never negative, so a candidate is dropped as soon as it can't beat the best.
+    for (int i = 0; i < n; i++) {
+        uint32_t d = lbp_desc_distance(desc, gallery[i], best_distance);
+        if (d < best_distance) {
+            best = i;
+            best_distance = d;
+        }
+    }
+
+    *distance = best_distance;
+    return best;
+}
+
 int imlib_lbp_desc_save(FIL *fp, uint8_t *desc) {
     UINT bytes;
     // Write descriptor
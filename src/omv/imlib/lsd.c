@@ -36,10 +36,6 @@
 #pragma GCC diagnostic ignored "-Wunused-variable"
 
 #define error(msg)                fb_alloc_fail()
-#define free(ptr)                 ({ umm_free(ptr); })
-#define malloc(size)              ({ void *_r = umm_malloc(size); if (!_r) fb_alloc_fail(); _r; })
-#define realloc(ptr, size)        ({ void *_r = umm_realloc((ptr), (size)); if (!_r) fb_alloc_fail(); _r; })
-#define calloc(num, item_size)    ({ void *_r = umm_calloc((num), (item_size)); if (!_r) fb_alloc_fail(); _r; })
 #define sqrt(x)                   fast_sqrtf(x)
 #define floor(x)                  fast_floorf(x)
 #define ceil(x)                   fast_ceilf(x)
@@ -57,243 +53,6 @@
 #define radToDeg(x)               ((x) * (180.0f / PI))
 #define degToRad(x)               ((x) * (PI / 180.0f))
 
-/** LSD Full Interface
-
-    @param n_out       Pointer to an int where LSD will store the number of
-                       line segments detected.
-
-    @param img         Pointer to input image data. It must be an array of
-                       unsigned chars of size X x Y, and the pixel at coordinates
-                       (x,y) is obtained by img[x+y*X].
-
-    @param X           X size of the image: the number of columns.
-
-    @param Y           Y size of the image: the number of rows.
-
-    @param scale       When different from 1.0, LSD will scale the input image
-                       by 'scale' factor by Gaussian filtering, before detecting
-                       line segments.
-                       Example: if scale=0.8, the input image will be subsampled
-                       to 80% of its size, before the line segment detector
-                       is applied.
-                       Suggested value: 0.8
-
-    @param sigma_scale When scale!=1.0, the sigma of the Gaussian filter is:
-                       sigma = sigma_scale / scale,   if scale <  1.0
-                       sigma = sigma_scale,           if scale >= 1.0
-                       Suggested value: 0.6
-
-    @param quant       Bound to the quantization error on the gradient norm.
-                       Example: if gray levels are quantized to integer steps,
-                       the gradient (computed by finite differences) error
-                       due to quantization will be bounded by 2.0, as the
-                       worst case is when the error are 1 and -1, that
-                       gives an error of 2.0.
-                       Suggested value: 2.0
-
-    @param ang_th      Gradient angle tolerance in the region growing
-                       algorithm, in degrees.
-                       Suggested value: 22.5
-
-    @param log_eps     Detection threshold, accept if -log10(NFA) > log_eps.
-                       The larger the value, the more strict the detector is,
-                       and will result in less detections.
-                       (Note that the 'minus sign' makes that this
-                       behavior is opposite to the one of NFA.)
-                       The value -log10(NFA) is equivalent but more
-                       intuitive than NFA:
-                       - -1.0 gives an average of 10 false detections on noise
-                       -  0.0 gives an average of 1 false detections on noise
-                       -  1.0 gives an average of 0.1 false detections on nose
-                       -  2.0 gives an average of 0.01 false detections on noise
-                       .
-                       Suggested value: 0.0
-
-    @param density_th  Minimal proportion of 'supporting' points in a rectangle.
-                       Suggested value: 0.7
-
-    @param n_bins      Number of bins used in the pseudo-ordering of gradient
-                       modulus.
-                       Suggested value: 1024
-
-    @param reg_img     Optional output: if desired, LSD will return an
-                       int image where each pixel indicates the line segment
-                       to which it belongs. Unused pixels have the value '0',
-                       while the used ones have the number of the line segment,
-                       numbered 1,2,3,..., in the same order as in the
-                       output list. If desired, a non NULL int** pointer must
-                       be assigned, and LSD will make that the pointer point
-                       to an int array of size reg_x x reg_y, where the pixel
-                       value at (x,y) is obtained with (*reg_img)[x+y*reg_x].
-                       Note that the resulting image has the size of the image
-                       used for the processing, that is, the size of the input
-                       image scaled by the given factor 'scale'. If scale!=1
-                       this size differs from XxY and that is the reason why
-                       its value is given by reg_x and reg_y.
-                       Suggested value: NULL
-
-    @param reg_x       Pointer to an int where LSD will put the X size
-                       'reg_img' image, when asked for.
-                       Suggested value: NULL
-
-    @param reg_y       Pointer to an int where LSD will put the Y size
-                       'reg_img' image, when asked for.
-                       Suggested value: NULL
-
-    @return            A float array of size 7 x n_out, containing the list
-                       of line segments detected. The array contains first
-                       7 values of line segment number 1, then the 7 values
-                       of line segment number 2, and so on, and it finish
-                       by the 7 values of line segment number n_out.
-                       The seven values are:
-                       - x1,y1,x2,y2,width,p,-log10(NFA)
-                       .
-                       for a line segment from coordinates (x1,y1) to (x2,y2),
-                       a width 'width', an angle precision of p in (0,1) given
-                       by angle_tolerance/180 degree, and NFA value 'NFA'.
-                       If 'out' is the returned pointer, the 7 values of
-                       line segment number 'n+1' are obtained with
-                       'out[7*n+0]' to 'out[7*n+6]'.
- */
-float *LineSegmentDetection(int *n_out,
-                            unsigned char *img, int X, int Y,
-                            float scale, float sigma_scale, float quant,
-                            float ang_th, float log_eps, float density_th,
-                            int n_bins,
-                            int **reg_img, int *reg_x, int *reg_y);
-
-/** LSD Simple Interface with Scale and Region output.
-
-    @param n_out       Pointer to an int where LSD will store the number of
-                       line segments detected.
-
-    @param img         Pointer to input image data. It must be an array of
-                       unsigned chars of size X x Y, and the pixel at coordinates
-                       (x,y) is obtained by img[x+y*X].
-
-    @param X           X size of the image: the number of columns.
-
-    @param Y           Y size of the image: the number of rows.
-
-    @param scale       When different from 1.0, LSD will scale the input image
-                       by 'scale' factor by Gaussian filtering, before detecting
-                       line segments.
-                       Example: if scale=0.8, the input image will be subsampled
-                       to 80% of its size, before the line segment detector
-                       is applied.
-                       Suggested value: 0.8
-
-    @param reg_img     Optional output: if desired, LSD will return an
-                       int image where each pixel indicates the line segment
-                       to which it belongs. Unused pixels have the value '0',
-                       while the used ones have the number of the line segment,
-                       numbered 1,2,3,..., in the same order as in the
-                       output list. If desired, a non NULL int** pointer must
-                       be assigned, and LSD will make that the pointer point
-                       to an int array of size reg_x x reg_y, where the pixel
-                       value at (x,y) is obtained with (*reg_img)[x+y*reg_x].
-                       Note that the resulting image has the size of the image
-                       used for the processing, that is, the size of the input
-                       image scaled by the given factor 'scale'. If scale!=1
-                       this size differs from XxY and that is the reason why
-                       its value is given by reg_x and reg_y.
-                       Suggested value: NULL
-
-    @param reg_x       Pointer to an int where LSD will put the X size
-                       'reg_img' image, when asked for.
-                       Suggested value: NULL
-
-    @param reg_y       Pointer to an int where LSD will put the Y size
-                       'reg_img' image, when asked for.
-                       Suggested value: NULL
-
-    @return            A float array of size 7 x n_out, containing the list
-                       of line segments detected. The array contains first
-                       7 values of line segment number 1, then the 7 values
-                       of line segment number 2, and so on, and it finish
-                       by the 7 values of line segment number n_out.
-                       The seven values are:
-                       - x1,y1,x2,y2,width,p,-log10(NFA)
-                       .
-                       for a line segment from coordinates (x1,y1) to (x2,y2),
-                       a width 'width', an angle precision of p in (0,1) given
-                       by angle_tolerance/180 degree, and NFA value 'NFA'.
-                       If 'out' is the returned pointer, the 7 values of
-                       line segment number 'n+1' are obtained with
-                       'out[7*n+0]' to 'out[7*n+6]'.
- */
-float *lsd_scale_region(int *n_out,
-                        unsigned char *img, int X, int Y, float scale,
-                        int **reg_img, int *reg_x, int *reg_y);
-
-/** LSD Simple Interface with Scale
-
-    @param n_out       Pointer to an int where LSD will store the number of
-                       line segments detected.
-
-    @param img         Pointer to input image data. It must be an array of
-                       unsigned chars of size X x Y, and the pixel at coordinates
-                       (x,y) is obtained by img[x+y*X].
-
-    @param X           X size of the image: the number of columns.
-
-    @param Y           Y size of the image: the number of rows.
-
-    @param scale       When different from 1.0, LSD will scale the input image
-                       by 'scale' factor by Gaussian filtering, before detecting
-                       line segments.
-                       Example: if scale=0.8, the input image will be subsampled
-                       to 80% of its size, before the line segment detector
-                       is applied.
-                       Suggested value: 0.8
-
-    @return            A float array of size 7 x n_out, containing the list
-                       of line segments detected. The array contains first
-                       7 values of line segment number 1, then the 7 values
-                       of line segment number 2, and so on, and it finish
-                       by the 7 values of line segment number n_out.
-                       The seven values are:
-                       - x1,y1,x2,y2,width,p,-log10(NFA)
-                       .
-                       for a line segment from coordinates (x1,y1) to (x2,y2),
-                       a width 'width', an angle precision of p in (0,1) given
-                       by angle_tolerance/180 degree, and NFA value 'NFA'.
-                       If 'out' is the returned pointer, the 7 values of
-                       line segment number 'n+1' are obtained with
-                       'out[7*n+0]' to 'out[7*n+6]'.
- */
-float *lsd_scale(int *n_out, unsigned char *img, int X, int Y, float scale);
-
-/** LSD Simple Interface
-
-    @param n_out       Pointer to an int where LSD will store the number of
-                       line segments detected.
-
-    @param img         Pointer to input image data. It must be an array of
-                       unsigned chars of size X x Y, and the pixel at coordinates
-                       (x,y) is obtained by img[x+y*X].
-
-    @param X           X size of the image: the number of columns.
-
-    @param Y           Y size of the image: the number of rows.
-
-    @return            A float array of size 7 x n_out, containing the list
-                       of line segments detected. The array contains first
-                       7 values of line segment number 1, then the 7 values
-                       of line segment number 2, and so on, and it finish
-                       by the 7 values of line segment number n_out.
-                       The seven values are:
-                       - x1,y1,x2,y2,width,p,-log10(NFA)
-                       .
-                       for a line segment from coordinates (x1,y1) to (x2,y2),
-                       a width 'width', an angle precision of p in (0,1) given
-                       by angle_tolerance/180 degree, and NFA value 'NFA'.
-                       If 'out' is the returned pointer, the 7 values of
-                       line segment number 'n+1' are obtained with
-                       'out[7*n+0]' to 'out[7*n+6]'.
- */
-float *lsd(int *n_out, unsigned char *img, int X, int Y);
-
 /** ln(10) */
 #ifndef M_LN10
 #define M_LN10        2.30258509299404568402f
@@ -313,7 +72,7 @@ float *lsd(int *n_out, unsigned char *img, int X, int Y);
 #endif /* !TRUE */
 
 /** Label for pixels with undefined gradient. */
-#define NOTDEF        -512.0f // -1024.0f
+#define NOTDEF        -512.0f
 #define NOTDEF_INT    -29335
 
 /** 3/2 pi */
@@ -322,20 +81,6 @@ float *lsd(int *n_out, unsigned char *img, int X, int Y);
 /** 2 pi */
 #define M_2__PI       6.28318530718f
 
-/** Label for pixels not used in yet. */
-#define NOTUSED       0
-
-/** Label for pixels already used in detection. */
-#define USED          1
-
-/*----------------------------------------------------------------------------*/
-/** Chained list of coordinates.
- */
-struct coorlist {
-    int16_t x, y;
-    struct coorlist *next;
-};
-
 /*----------------------------------------------------------------------------*/
 /** A point (or pixel).
  */
@@ -397,230 +142,6 @@ static float dist(float x1, float y1, float x2, float y2) {
     return sqrt( (x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1) );
 }
 
-/*----------------------------------------------------------------------------*/
-/** 'list of n-tuple' data type
-
-    The i-th component of the j-th n-tuple of an n-tuple list 'ntl'
-    is accessed with:
-
-      ntl->values[ i + j * ntl->dim ]
-
-    The dimension of the n-tuple (n) is:
-
-      ntl->dim
-
-    The number of n-tuples in the list is:
-
-      ntl->size
-
-    The maximum number of n-tuples that can be stored in the
-    list with the allocated memory at a given time is given by:
-
-      ntl->max_size
- */
-typedef struct ntuple_list_s {
-    unsigned int size;
-    unsigned int max_size;
-    unsigned int dim;
-    float *values;
-} *ntuple_list;
-
-/** Free memory used in n-tuple 'in'.
- */
-static void free_ntuple_list(ntuple_list in) {
-    if (in == NULL || in->values == NULL) {
-        error("free_ntuple_list: invalid n-tuple input.");
-    }
-    free( (void *) in->values);
-    free( (void *) in);
-}
-
-/** Create an n-tuple list and allocate memory for one element.
-    @param dim the dimension (n) of the n-tuple.
- */
-static ntuple_list new_ntuple_list(unsigned int dim) {
-    ntuple_list n_tuple;
-
-    /* check parameters */
-    if (dim == 0) {
-        error("new_ntuple_list: 'dim' must be positive.");
-    }
-
-    /* get memory for list structure */
-    n_tuple = (ntuple_list) malloc(sizeof(struct ntuple_list_s) );
-    if (n_tuple == NULL) {
-        error("not enough memory.");
-    }
-
-    /* initialize list */
-    n_tuple->size = 0;
-    n_tuple->max_size = 1;
-    n_tuple->dim = dim;
-
-    /* get memory for tuples */
-    n_tuple->values = (float *) malloc(dim * n_tuple->max_size * sizeof(float) );
-    if (n_tuple->values == NULL) {
-        error("not enough memory.");
-    }
-
-    return n_tuple;
-}
-
-/** Enlarge the allocated memory of an n-tuple list.
- */
-static void enlarge_ntuple_list(ntuple_list n_tuple) {
-    /* check parameters */
-    if (n_tuple == NULL || n_tuple->values == NULL || n_tuple->max_size == 0) {
-        error("enlarge_ntuple_list: invalid n-tuple.");
-    }
-
-    /* duplicate number of tuples */
-    n_tuple->max_size *= 2;
-
-    /* realloc memory */
-    n_tuple->values = (float *) realloc( (void *) n_tuple->values,
-                                         n_tuple->dim * n_tuple->max_size * sizeof(float) );
-    if (n_tuple->values == NULL) {
-        error("not enough memory.");
-    }
-}
-
-/** Add a 7-tuple to an n-tuple list.
- */
-static void add_7tuple(ntuple_list out, float v1, float v2, float v3,
-                       float v4, float v5, float v6, float v7) {
-    /* check parameters */
-    if (out == NULL) {
-        error("add_7tuple: invalid n-tuple input.");
-    }
-    if (out->dim != 7) {
-        error("add_7tuple: the n-tuple must be a 7-tuple.");
-    }
-
-    /* if needed, alloc more tuples to 'out' */
-    if (out->size == out->max_size) {
-        enlarge_ntuple_list(out);
-    }
-    if (out->values == NULL) {
-        error("add_7tuple: invalid n-tuple input.");
-    }
-
-    /* add new 7-tuple */
-    out->values[ out->size * out->dim + 0 ] = v1;
-    out->values[ out->size * out->dim + 1 ] = v2;
-    out->values[ out->size * out->dim + 2 ] = v3;
-    out->values[ out->size * out->dim + 3 ] = v4;
-    out->values[ out->size * out->dim + 4 ] = v5;
-    out->values[ out->size * out->dim + 5 ] = v6;
-    out->values[ out->size * out->dim + 6 ] = v7;
-
-    /* update number of tuples counter */
-    out->size++;
-}
-
-
-/** char image data type
-
-    The pixel value at (x,y) is accessed by:
-
-      image->data[ x + y * image->xsize ]
-
-    with x and y integer.
- */
-typedef struct image_char_s {
-    unsigned char *data;
-    unsigned int xsize, ysize;
-} *image_char;
-
-/** Free memory used in image_char 'i'.
- */
-static void free_image_char(image_char i) {
-    if (i == NULL || i->data == NULL) {
-        error("free_image_char: invalid input image.");
-    }
-    free( (void *) i->data);
-    free( (void *) i);
-}
-
-/** Create a new image_char of size 'xsize' times 'ysize'.
- */
-static image_char new_image_char(unsigned int xsize, unsigned int ysize) {
-    image_char image;
-
-    /* check parameters */
-    if (xsize == 0 || ysize == 0) {
-        error("new_image_char: invalid image size.");
-    }
-
-    /* get memory */
-    image = (image_char) malloc(sizeof(struct image_char_s) );
-    if (image == NULL) {
-        error("not enough memory.");
-    }
-    image->data = (unsigned char *) calloc( (size_t) (xsize * ysize),
-                                            sizeof(unsigned char) );
-    if (image->data == NULL) {
-        error("not enough memory.");
-    }
-
-    /* set image size */
-    image->xsize = xsize;
-    image->ysize = ysize;
-
-    return image;
-}
-
-/** Create a new image_double of size 'xsize' times 'ysize'
-    with the data pointed by 'data'.
- */
-static image_char new_image_char_ptr(unsigned int xsize,
-                                     unsigned int ysize, unsigned char *data) {
-    image_char image;
-
-    /* check parameters */
-    if (xsize == 0 || ysize == 0) {
-        error("new_image_char_ptr: invalid image size.");
-    }
-    if (data == NULL) {
-        error("new_image_char_ptr: NULL data pointer.");
-    }
-
-    /* get memory */
-    image = (image_char) malloc(sizeof(struct image_char_s) );
-    if (image == NULL) {
-        error("not enough memory.");
-    }
-
-    /* set image */
-    image->xsize = xsize;
-    image->ysize = ysize;
-    image->data = data;
-
-    return image;
-}
-
-/** Create a new image_char of size 'xsize' times 'ysize',
-    initialized to the value 'fill_value'.
- */
-static image_char new_image_char_ini(unsigned int xsize, unsigned int ysize,
-                                     unsigned char fill_value) {
-    image_char image = new_image_char(xsize, ysize); /* create image */
-    unsigned int N = xsize * ysize;
-    unsigned int i;
-
-    /* check parameters */
-    if (image == NULL || image->data == NULL) {
-        error("new_image_char_ini: invalid image.");
-    }
-
-    /* initialize */
-    for (i = 0; i < N; i++) {
-        image->data[i] = fill_value;
-    }
-
-    return image;
-}
-
 /** int image data type
 
     The pixel value at (x,y) is accessed by:
@@ -634,427 +155,58 @@ typedef struct image_int_s {
     unsigned int xsize, ysize;
 } *image_int;
 
-/** Free memory used in image_int 'i'.
- */
-static void free_image_int(image_int i) {
-    if (i == NULL || i->data == NULL) {
-        error("free_image_int: invalid input image.");
-    }
-    free( (void *) i->data);
-    free( (void *) i);
-}
-
-/** Create a new image_int of size 'xsize' times 'ysize'.
- */
-static image_int new_image_int(unsigned int xsize, unsigned int ysize) {
-    image_int image;
-
-    /* check parameters */
-    if (xsize == 0 || ysize == 0) {
-        error("new_image_int: invalid image size.");
-    }
-
-    /* get memory */
-    image = (image_int) malloc(sizeof(struct image_int_s) );
-    if (image == NULL) {
-        error("not enough memory.");
-    }
-    image->data = (int16_t *) calloc( (size_t) (xsize * ysize), sizeof(int16_t) );
-    if (image->data == NULL) {
-        error("not enough memory.");
-    }
-
-    /* set image size */
-    image->xsize = xsize;
-    image->ysize = ysize;
-
-    return image;
-}
-
-/** Create a new image_int of size 'xsize' times 'ysize',
-    initialized to the value 'fill_value'.
+/** Bin of the pseudo-ordering of gradient modulus for the norm 'norm'.
  */
-static image_int new_image_int_ini(unsigned int xsize, unsigned int ysize,
-                                   int fill_value) {
-    image_int image = new_image_int(xsize, ysize); /* create image */
-    unsigned int N = xsize * ysize;
-    unsigned int i;
-
-    /* initialize */
-    for (i = 0; i < N; i++) {
-        image->data[i] = fill_value;
-    }
-
-    return image;
-}
-
-/** float image data type
-
-    The pixel value at (x,y) is accessed by:
-
-      image->data[ x + y * image->xsize ]
-
-    with x and y integer.
- */
-typedef struct image_double_s {
-    float *data;
-    unsigned int xsize, ysize;
-} *image_double;
-
-/** Free memory used in image_double 'i'.
- */
-static void free_image_double(image_double i) {
-    if (i == NULL || i->data == NULL) {
-        error("free_image_double: invalid input image.");
-    }
-    free( (void *) i->data);
-    free( (void *) i);
-}
-
-/** Create a new image_double of size 'xsize' times 'ysize'.
- */
-static image_double new_image_double(unsigned int xsize, unsigned int ysize) {
-    image_double image;
-
-    /* check parameters */
-    if (xsize == 0 || ysize == 0) {
-        error("new_image_double: invalid image size.");
-    }
-
-    /* get memory */
-    image = (image_double) malloc(sizeof(struct image_double_s) );
-    if (image == NULL) {
-        error("not enough memory.");
-    }
-    image->data = (float *) calloc( (size_t) (xsize * ysize), sizeof(float) );
-    if (image->data == NULL) {
-        error("not enough memory.");
-    }
-
-    /* set image size */
-    image->xsize = xsize;
-    image->ysize = ysize;
-
-    return image;
-}
-
-/** Create a new image_double of size 'xsize' times 'ysize'
-    with the data pointed by 'data'.
- */
-static image_double new_image_double_ptr(unsigned int xsize,
-                                         unsigned int ysize, float *data) {
-    image_double image;
-
-    /* check parameters */
-    if (xsize == 0 || ysize == 0) {
-        error("new_image_double_ptr: invalid image size.");
-    }
-    if (data == NULL) {
-        error("new_image_double_ptr: NULL data pointer.");
-    }
-
-    /* get memory */
-    image = (image_double) malloc(sizeof(struct image_double_s) );
-    if (image == NULL) {
-        error("not enough memory.");
-    }
-
-    /* set image */
-    image->xsize = xsize;
-    image->ysize = ysize;
-    image->data = data;
-
-    return image;
-}
-
-
-/** Compute a Gaussian kernel of length 'kernel->dim',
-    standard deviation 'sigma', and centered at value 'mean'.
-
-    For example, if mean=0.5, the Gaussian will be centered
-    in the middle point between values 'kernel->values[0]'
-    and 'kernel->values[1]'.
- */
-static void gaussian_kernel(ntuple_list kernel, float sigma, float mean) {
-    float sum = 0.0;
-    float val;
-    unsigned int i;
-
-    /* check parameters */
-    if (kernel == NULL || kernel->values == NULL) {
-        error("gaussian_kernel: invalid n-tuple 'kernel'.");
-    }
-    if (sigma <= 0.0) {
-        error("gaussian_kernel: 'sigma' must be positive.");
-    }
-
-    /* compute Gaussian kernel */
-    if (kernel->max_size < 1) {
-        enlarge_ntuple_list(kernel);
-    }
-    kernel->size = 1;
-    for (i = 0; i < kernel->dim; i++) {
-        val = ( (float) i - mean) / sigma;
-        kernel->values[i] = exp(-0.5 * val * val);
-        sum += kernel->values[i];
-    }
-
-    /* normalization */
-    if (sum >= 0.0f) {
-        for (i = 0; i < kernel->dim; i++) {
-            kernel->values[i] /= sum;
-        }
-    }
-}
-
-/** Scale the input image 'in' by a factor 'scale' by Gaussian sub-sampling.
-
-    For example, scale=0.8 will give a result at 80% of the original size.
-
-    The image is convolved with a Gaussian kernel
-    @f[
-        G(x,y) = \frac{1}{2\pi\sigma^2} e^{-\frac{x^2+y^2}{2\sigma^2}}
-    @f]
-    before the sub-sampling to prevent aliasing.
-
-    The standard deviation sigma given by:
-    -  sigma = sigma_scale / scale,   if scale <  1.0
-    -  sigma = sigma_scale,           if scale >= 1.0
-
-    To be able to sub-sample at non-integer steps, some interpolation
-    is needed. In this implementation, the interpolation is done by
-    the Gaussian kernel, so both operations (filtering and sampling)
-    are done at the same time. The Gaussian kernel is computed
-    centered on the coordinates of the required sample. In this way,
-    when applied, it gives directly the result of convolving the image
-    with the kernel and interpolated to that particular position.
-
-    A fast algorithm is done using the separability of the Gaussian
-    kernel. Applying the 2D Gaussian kernel is equivalent to applying
-    first a horizontal 1D Gaussian kernel and then a vertical 1D
-    Gaussian kernel (or the other way round). The reason is that
-    @f[
-        G(x,y) = G(x) * G(y)
-    @f]
-    where
-    @f[
-        G(x) = \frac{1}{\sqrt{2\pi}\sigma} e^{-\frac{x^2}{2\sigma^2}}.
-    @f]
-    The algorithm first applies a combined Gaussian kernel and sampling
-    in the x axis, and then the combined Gaussian kernel and sampling
-    in the y axis.
- */
-static image_double gaussian_sampler(image_double in, float scale,
-                                     float sigma_scale) {
-    image_double aux, out;
-    ntuple_list kernel;
-    unsigned int N, M, h, n, x, y, i;
-    int xc, yc, j, double_x_size, double_y_size;
-    float sigma, xx, yy, sum, prec;
-
-    /* check parameters */
-    if (in == NULL || in->data == NULL || in->xsize == 0 || in->ysize == 0) {
-        error("gaussian_sampler: invalid image.");
-    }
-    if (scale <= 0.0) {
-        error("gaussian_sampler: 'scale' must be positive.");
-    }
-    if (sigma_scale <= 0.0) {
-        error("gaussian_sampler: 'sigma_scale' must be positive.");
-    }
-
-    /* compute new image size and get memory for images */
-    if (in->xsize * scale > (float) UINT_MAX ||
-        in->ysize * scale > (float) UINT_MAX) {
-        error("gaussian_sampler: the output image size exceeds the handled size.");
-    }
-    N = (unsigned int) ceil(in->xsize * scale);
-    M = (unsigned int) ceil(in->ysize * scale);
-    aux = new_image_double(N, in->ysize);
-    out = new_image_double(N, M);
-
-    /* sigma, kernel size and memory for the kernel */
-    sigma = scale < 1.0 ? sigma_scale / scale : sigma_scale;
-    /*
-       The size of the kernel is selected to guarantee that the
-       the first discarded term is at least 10^prec times smaller
-       than the central value. For that, h should be larger than x, with
-         e^(-x^2/2sigma^2) = 1/10^prec.
-       Then,
-         x = sigma * sqrt( 2 * prec * ln(10) ).
-     */
-    prec = 3.0;
-    h = (unsigned int) ceil(sigma * sqrt(2.0 * prec * log(10.0) ) );
-    n = 1 + 2 * h; /* kernel size */
-    kernel = new_ntuple_list(n);
-
-    /* auxiliary float image size variables */
-    double_x_size = (int) (2 * in->xsize);
-    double_y_size = (int) (2 * in->ysize);
-
-    /* First subsampling: x axis */
-    for (x = 0; x < aux->xsize; x++) {
-        /*
-           x   is the coordinate in the new image.
-           xx  is the corresponding x-value in the original size image.
-           xc  is the integer value, the pixel coordinate of xx.
-         */
-        xx = (float) x / scale;
-        /* coordinate (0.0,0.0) is in the center of pixel (0,0),
-           so the pixel with xc=0 get the values of xx from -0.5 to 0.5 */
-        xc = (int) floor(xx + 0.5);
-        gaussian_kernel(kernel, sigma, (float) h + xx - (float) xc);
-        /* the kernel must be computed for each x because the fine
-           offset xx-xc is different in each case */
-
-        for (y = 0; y < aux->ysize; y++) {
-            sum = 0.0;
-            for (i = 0; i < kernel->dim; i++) {
-                j = xc - h + i;
-
-                /* symmetry boundary condition */
-                while (j < 0) {
-                    j += double_x_size;
-                }
-                while (j >= double_x_size) {
-                    j -= double_x_size;
-                }
-                if (j >= (int) in->xsize) {
-                    j = double_x_size - 1 - j;
-                }
-
-                sum += in->data[ j + y * in->xsize ] * kernel->values[i];
-            }
-            aux->data[ x + y * aux->xsize ] = sum;
-        }
-    }
-
-    /* Second subsampling: y axis */
-    for (y = 0; y < out->ysize; y++) {
-        /*
-           y   is the coordinate in the new image.
-           yy  is the corresponding x-value in the original size image.
-           yc  is the integer value, the pixel coordinate of xx.
-         */
-        yy = (float) y / scale;
-        /* coordinate (0.0,0.0) is in the center of pixel (0,0),
-           so the pixel with yc=0 get the values of yy from -0.5 to 0.5 */
-        yc = (int) floor(yy + 0.5);
-        gaussian_kernel(kernel, sigma, (float) h + yy - (float) yc);
-        /* the kernel must be computed for each y because the fine
-           offset yy-yc is different in each case */
-
-        for (x = 0; x < out->xsize; x++) {
-            sum = 0.0;
-            for (i = 0; i < kernel->dim; i++) {
-                j = yc - h + i;
-
-                /* symmetry boundary condition */
-                while (j < 0) {
-                    j += double_y_size;
-                }
-                while (j >= double_y_size) {
-                    j -= double_y_size;
-                }
-                if (j >= (int) in->ysize) {
-                    j = double_y_size - 1 - j;
-                }
-
-                sum += aux->data[ x + j * aux->xsize ] * kernel->values[i];
-            }
-            out->data[ x + y * out->xsize ] = sum;
-        }
-    }
-
-    /* free memory */
-    free_ntuple_list(kernel);
-    free_image_double(aux);
-
-    return out;
+static inline unsigned int lsd_norm_bin(float norm, float max_grad, unsigned int n_bins) {
+    unsigned int i = (unsigned int) (norm * (float) n_bins / max_grad);
+    return (i >= n_bins) ? (n_bins - 1) : i;
 }
 
 /** Computes the direction of the level line of 'in' at each point.
 
     The result is:
-    - an image_int with the angle at each pixel, or NOTDEF if not defined.
-    - the image_int 'modgrad' (a pointer is passed as argument)
-      with the gradient magnitude at each point.
-    - a list of pixels 'list_p' roughly ordered by decreasing
-      gradient magnitude. (The order is made by classifying points
-      into bins by gradient magnitude. The parameters 'n_bins' and
-      'max_grad' specify the number of bins and the gradient modulus
-      at the highest bin. The pixels in the list would be in
-      decreasing gradient magnitude, up to a precision of the size of
-      the bins.)
-    - a pointer 'mem_p' to the memory used by 'list_p' to be able to
-      free the memory when it is not used anymore.
+    - the image_int 'g' with the angle at each pixel in degrees, or
+      NOTDEF_INT if not defined.
+    - the image_int 'modgrad' with the gradient magnitude at each point.
+    - the 'list' of the 'list_size' pixels with a defined angle, roughly
+      ordered by decreasing gradient magnitude. (The order is made by
+      classifying points into 'n_bins' bins by gradient magnitude. The
+      pixels in the list would be in decreasing gradient magnitude, up
+      to a precision of the size of the bins.)
+
+    'g', 'modgrad' and 'list' must be allocated by the caller.
  */
-static image_int ll_angle(image_char in, float threshold,
-                          struct coorlist **list_p, void **mem_p,
-                          image_int *modgrad, unsigned int n_bins) {
-    image_int g;
+static void ll_angle(const unsigned char *in, float threshold,
+                     image_int g, image_int modgrad,
+                     struct lsd_point *list, int *list_size,
+                     unsigned int n_bins) {
     unsigned int n, p, x, y, adr, i;
-    float com1, com2, gx, gy, norm, norm2;
-    /* the rest of the variables are used for pseudo-ordering
-       the gradient magnitude values */
-    int list_count = 0;
-    struct coorlist *list;
-    struct coorlist **range_l_s; /* array of pointers to start of bin list */
-    struct coorlist **range_l_e; /* array of pointers to end of bin list */
-    struct coorlist *start;
-    struct coorlist *end;
-    float max_grad = 0.0;
+    float norm, max_grad = 0.0;
+    uint32_t *bins;
 
     /* check parameters */
-    if (in == NULL || in->data == NULL || in->xsize == 0 || in->ysize == 0) {
+    if (in == NULL || g->xsize == 0 || g->ysize == 0) {
         error("ll_angle: invalid image.");
     }
     if (threshold < 0.0) {
         error("ll_angle: 'threshold' must be positive.");
     }
-    if (list_p == NULL) {
-        error("ll_angle: NULL pointer 'list_p'.");
-    }
-    if (mem_p == NULL) {
-        error("ll_angle: NULL pointer 'mem_p'.");
-    }
-    if (modgrad == NULL) {
-        error("ll_angle: NULL pointer 'modgrad'.");
-    }
     if (n_bins == 0) {
         error("ll_angle: 'n_bins' must be positive.");
     }
 
     /* image size shortcuts */
-    n = in->ysize;
-    p = in->xsize;
-
-    /* allocate output image */
-    g = new_image_int(in->xsize, in->ysize);
-
-    /* get memory for the image of gradient modulus */
-    *modgrad = new_image_int(in->xsize, in->ysize);
-
-    /* get memory for "ordered" list of pixels */
-    list = (struct coorlist *) calloc( (size_t) (n * p), sizeof(struct coorlist) );
-    *mem_p = (void *) list;
-    range_l_s = (struct coorlist **) calloc( (size_t) n_bins,
-                                             sizeof(struct coorlist *) );
-    range_l_e = (struct coorlist **) calloc( (size_t) n_bins,
-                                             sizeof(struct coorlist *) );
-    if (list == NULL || range_l_s == NULL || range_l_e == NULL) {
-        error("not enough memory.");
-    }
-    for (i = 0; i < n_bins; i++) {
-        range_l_s[i] = range_l_e[i] = NULL;
-    }
+    n = g->ysize;
+    p = g->xsize;
 
     /* 'undefined' on the down and right boundaries */
     for (x = 0; x < p; x++) {
         g->data[(n - 1) * p + x] = NOTDEF;
+        modgrad->data[(n - 1) * p + x] = 0;
     }
     for (y = 0; y < n; y++) {
         g->data[p * y + p - 1] = NOTDEF;
+        modgrad->data[p * y + p - 1] = 0;
     }
 
     /* compute gradient on the remaining pixels */
@@ -1073,20 +225,20 @@ static image_int ll_angle(image_char in, float threshold,
                  gy = C+D - (A+B)   vertical difference
                com1 and com2 are just to avoid 2 additions.
              */
-            com1 = in->data[adr + p + 1] - in->data[adr];
-            com2 = in->data[adr + 1] - in->data[adr + p];
+            int com1 = in[adr + p + 1] - in[adr];
+            int com2 = in[adr + 1] - in[adr + p];
 
-            gx = com1 + com2; /* gradient x component */
-            gy = com1 - com2; /* gradient y component */
-            norm2 = gx * gx + gy * gy;
-            norm = sqrt(norm2 / 4.0); /* gradient norm */
+            int gx = com1 + com2; /* gradient x component */
+            int gy = com1 - com2; /* gradient y component */
+            int norm2 = gx * gx + gy * gy; /* exact, the float version was integral too */
+            norm = sqrt(norm2 / 4.0f); /* gradient norm */
 
-            (*modgrad)->data[adr] = norm; /* store gradient norm */
+            modgrad->data[adr] = norm; /* store gradient norm */
 
             if (norm <= threshold) {
                 /* norm too small, gradient no defined */
-                g->data[adr] = NOTDEF_INT; //radToDeg(NOTDEF); /* gradient angle not defined */
-            } else{
+                g->data[adr] = NOTDEF_INT; /* gradient angle not defined */
+            } else {
                 /* gradient angle computation */
                 g->data[adr] = radToDeg(atan2(gx, -gy));
 
@@ -1098,124 +250,61 @@ static image_int ll_angle(image_char in, float threshold,
         }
     }
 
-    /* compute histogram of gradient values */
+    *list_size = 0;
+
+    /* no pixel has a defined angle */
+    if (max_grad == 0.0f) {
+        return;
+    }
+
+    /* counting sort of the pixels by the bin of their norm, pixels are
+       visited column by column so each bin keeps that order */
+    bins = fb_alloc0(n_bins * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+
     for (x = 0; x < p - 1; x++) {
         for (y = 0; y < n - 1; y++) {
-            norm = (*modgrad)->data[y * p + x];
-
-            /* store the point in the right bin according to its norm */
-            i = (unsigned int) (norm * (float) n_bins / max_grad);
-            if (i >= n_bins) {
-                i = n_bins - 1;
-            }
-            if (range_l_e[i] == NULL) {
-                range_l_s[i] = range_l_e[i] = list + list_count++;
-            } else{
-                range_l_e[i]->next = list + list_count;
-                range_l_e[i] = list + list_count++;
+            adr = y * p + x;
+            if (g->data[adr] != NOTDEF_INT) {
+                bins[lsd_norm_bin(modgrad->data[adr], max_grad, n_bins)] += 1;
             }
-            range_l_e[i]->x = (int) x;
-            range_l_e[i]->y = (int) y;
-            range_l_e[i]->next = NULL;
         }
     }
 
-    /* Make the list of pixels (almost) ordered by norm value.
-       It starts by the larger bin, so the list starts by the
-       pixels with the highest gradient value. Pixels would be ordered
-       by norm value, up to a precision given by max_grad/n_bins.
-     */
-    for (i = n_bins - 1; i > 0 && range_l_s[i] == NULL; i--) {
-        ;
-    }
-    start = range_l_s[i];
-    end = range_l_e[i];
-    if (start != NULL) {
-        while (i > 0) {
-            --i;
-            if (range_l_s[i] != NULL) {
-                end->next = range_l_s[i];
-                end = range_l_e[i];
+    /* the list starts by the larger bin, so the list starts by the
+       pixels with the highest gradient value. */
+    for (i = n_bins; i-- > 0;) {
+        uint32_t count = bins[i];
+        bins[i] = *list_size;
+        *list_size += count;
+    }
+
+    for (x = 0; x < p - 1; x++) {
+        for (y = 0; y < n - 1; y++) {
+            adr = y * p + x;
+            if (g->data[adr] != NOTDEF_INT) {
+                unsigned int bin = lsd_norm_bin(modgrad->data[adr], max_grad, n_bins);
+                list[bins[bin]].x = x;
+                list[bins[bin]].y = y;
+                bins[bin] += 1;
             }
         }
     }
-    *list_p = start;
-
-    /* free memory */
-    free( (void *) range_l_s);
-    free( (void *) range_l_e);
 
-    return g;
+    fb_free(); // bins
 }
 
-/** Is point (x,y) aligned to angle theta, up to precision 'prec'?
+/** Is the level-line angle 'angle' (in degrees) aligned to angle theta,
+    up to precision 'prec'?
  */
-static int isaligned(int x, int y, image_int angles, float theta,
-                     float prec) {
-    float a;
-
-    /* check parameters */
-    if (angles == NULL || angles->data == NULL) {
-        error("isaligned: invalid image 'angles'.");
-    }
-    if (x < 0 || y < 0 || x >= (int) angles->xsize || y >= (int) angles->ysize) {
-        error("isaligned: (x,y) out of the image.");
-    }
-    if (prec < 0.0) {
-        error("isaligned: 'prec' must be positive.");
-    }
-
-    /* angle at pixel (x,y) */
-    a = degToRad(angles->data[ x + y * angles->xsize ]);
-
+static inline int isaligned_fast(int angle, float theta, float prec) {
     /* pixels whose level-line angle is not defined
        are considered as NON-aligned */
-    if (a == NOTDEF) {
-        return FALSE;              /* there is no need to call the function
-                                      'double_equal' here because there is
-                                      no risk of problems related to the
-                                      comparison doubles, we are only
-                                      interested in the exact NOTDEF value */
-
-    }
-    /* it is assumed that 'theta' and 'a' are in the range [-pi,pi] */
-    theta -= a;
-    if (theta < 0.0) {
-        theta = -theta;
-    }
-    if (theta > M_3_2_PI) {
-        theta -= M_2__PI;
-        if (theta < 0.0) {
-            theta = -theta;
-        }
-    }
-
-    return theta <= prec;
-}
-
-static int isaligned_fast(int angle, float theta,
-                          float prec) {
-    float a;
-
     if (angle == NOTDEF_INT) {
-        return FALSE;                    // faster to test the integer value
-
+        return FALSE;
     }
-    /* angle at pixel (x,y) */
-    a = degToRad(angle);
 
-    /* pixels whose level-line angle is not defined
-       are considered as NON-aligned */
-    if (a == NOTDEF) {
-        return FALSE;              /* there is no need to call the function
-                                      'double_equal' here because there is
-                                      no risk of problems related to the
-                                      comparison doubles, we are only
-                                      interested in the exact NOTDEF value */
-
-    }
     /* it is assumed that 'theta' and 'a' are in the range [-pi,pi] */
-    theta -= a;
+    theta -= degToRad(angle);
     if (theta < 0.0) {
         theta = -theta;
     }
@@ -1227,7 +316,7 @@ static int isaligned_fast(int angle, float theta,
     }
 
     return theta <= prec;
-} /* isaligned_fast() */
+}
 
 /*----------------------------------------------------------------------------*/
 /** Absolute value angle difference.
@@ -1502,17 +591,16 @@ static void rect_copy(struct rect *in, struct rect *out) {
 
     The integer coordinates of pixels inside a rectangle are
     iteratively explored. This structure keep track of the process and
-    functions ri_ini(), ri_inc(), ri_end(), and ri_del() are used in
+    functions ri_ini_fast(), ri_inc() and ri_end() are used in
     the process. An example of how to use the iterator is as follows:
     \code
 
       struct rect * rec = XXX; // some rectangle
-      rect_iter * i;
-      for( i=ri_ini(rec); !ri_end(i); ri_inc(i) )
+      rect_iter i;
+      for( ri_ini_fast(&i, rec); !ri_end(&i); ri_inc(&i) )
         {
-          // your code, using 'i->x' and 'i->y' as coordinates
+          // your code, using 'i.x' and 'i.y' as coordinates
         }
-      ri_del(i); // delete iterator
 
     \endcode
     The pixels are explored 'column' by 'column', where we call
@@ -1610,16 +698,6 @@ static float inter_hi(float x, float x1, float y1, float x2, float y2) {
     return result;
 }
 
-/*----------------------------------------------------------------------------*/
-/** Free memory used by a rectangle iterator.
- */
-static void ri_del(rect_iter *iter) {
-    if (iter == NULL) {
-        error("ri_del: NULL iterator.");
-    }
-    free( (void *) iter);
-}
-
 /*----------------------------------------------------------------------------*/
 /** Check if the iterator finished the full iteration.
 
@@ -1707,87 +785,11 @@ static void ri_inc(rect_iter *i) {
 }
 
 /*----------------------------------------------------------------------------*/
-/** Create and initialize a rectangle iterator.
+/** Initialize a rectangle iterator.
 
     See details in \ref rect_iter
  */
-static rect_iter *ri_ini(struct rect *r) {
-    float vx[4], vy[4];
-    int n, offset;
-    rect_iter *i;
-
-    /* check parameters */
-    if (r == NULL) {
-        error("ri_ini: invalid rectangle.");
-    }
-
-    /* get memory */
-    i = (rect_iter *) malloc(sizeof(rect_iter));
-    if (i == NULL) {
-        error("ri_ini: Not enough memory.");
-    }
-
-    /* build list of rectangle corners ordered
-       in a circular way around the rectangle */
-    vx[0] = r->x1 - r->dy * r->width / 2.0;
-    vy[0] = r->y1 + r->dx * r->width / 2.0;
-    vx[1] = r->x2 - r->dy * r->width / 2.0;
-    vy[1] = r->y2 + r->dx * r->width / 2.0;
-    vx[2] = r->x2 + r->dy * r->width / 2.0;
-    vy[2] = r->y2 - r->dx * r->width / 2.0;
-    vx[3] = r->x1 + r->dy * r->width / 2.0;
-    vy[3] = r->y1 - r->dx * r->width / 2.0;
-
-    /* compute rotation of index of corners needed so that the first
-       point has the smaller x.
-
-       if one side is vertical, thus two corners have the same smaller x
-       value, the one with the largest y value is selected as the first.
-     */
-    if (r->x1 < r->x2 && r->y1 <= r->y2) {
-        offset = 0;
-    } else if (r->x1 >= r->x2 && r->y1 < r->y2) {
-        offset = 1;
-    } else if (r->x1 > r->x2 && r->y1 >= r->y2) {
-        offset = 2;
-    } else {
-        offset = 3;
-    }
-
-    /* apply rotation of index. */
-    for (n = 0; n < 4; n++) {
-        i->vx[n] = vx[(offset + n) % 4];
-        i->vy[n] = vy[(offset + n) % 4];
-    }
-
-    /* Set an initial condition.
-
-       The values are set to values that will cause 'ri_inc' (that will
-       be called immediately) to initialize correctly the first 'column'
-       and compute the limits 'ys' and 'ye'.
-
-       'y' is set to the integer value of vy[0], the starting corner.
-
-       'ys' and 'ye' are set to very small values, so 'ri_inc' will
-       notice that it needs to start a new 'column'.
-
-       The smallest integer coordinate inside of the rectangle is
-       'ceil(vx[0])'. The current 'x' value is set to that value minus
-       one, so 'ri_inc' (that will increase x by one) will advance to
-       the first 'column'.
-     */
-    i->x = (int) ceil(i->vx[0]) - 1;
-    i->y = (int) ceil(i->vy[0]);
-    i->ys = i->ye = -FLT_MAX;
-
-    /* advance to the first pixel */
-    ri_inc(i);
-
-    return i;
-}
-// We don't need to spend time allocating and freeing the iterator structure
-// since we only use 1 at a time and it's small enough to safely use as a stack var
-void ri_ini_fast(rect_iter *i, struct rect *r) {
+static void ri_ini_fast(rect_iter *i, struct rect *r) {
     float vx[4], vy[4];
     int n, offset;
 
@@ -1865,12 +867,11 @@ static float rect_nfa(struct rect *rec, image_int angles, float logNT) {
         if (i.x >= 0 && i.y >= 0 &&
             i.x < xsize && i.y < ysize) {
             ++pts; /* total number of pixels counter */
-            if (isaligned_fast((float) angles->data[(i.y * xsize) + i.x], rec->theta, rec->prec) ) {
+            if (isaligned_fast(angles->data[(i.y * xsize) + i.x], rec->theta, rec->prec) ) {
                 ++alg; /* aligned points counter */
             }
         }
     }
-//  ri_del(i); /* delete iterator */
 
     return nfa(pts, alg, rec->p, logNT); /* compute NFA value */
 }
@@ -2100,15 +1101,16 @@ static void region2rect(struct lsd_point *reg, int reg_size,
     tolerance 'prec', starting at point (x,y).
  */
 static void region_grow(int x, int y, image_int angles, struct lsd_point *reg,
-                        int *reg_size, float *reg_angle, image_char used,
+                        int *reg_size, float *reg_angle, bitmap_t *used,
                         float prec) {
     float sumdx, sumdy;
     int xx, yy, i;
     int l_size; // local copy
     float l_angle; // local copy
-    int xsize = used->xsize;
+    int xsize = angles->xsize;
+    int ysize = angles->ysize;
     /* check parameters */
-    if (x < 0 || y < 0 || x >= (int) angles->xsize || y >= (int) angles->ysize) {
+    if (x < 0 || y < 0 || x >= xsize || y >= ysize) {
         error("region_grow: (x,y) out of the image.");
     }
 
@@ -2116,10 +1118,10 @@ static void region_grow(int x, int y, image_int angles, struct lsd_point *reg,
     l_size = 1;
     reg[0].x = x;
     reg[0].y = y;
-    l_angle = degToRad(angles->data[x + y * angles->xsize]); /* region's angle */
+    l_angle = degToRad(angles->data[x + y * xsize]); /* region's angle */
     sumdx = cos(l_angle);
     sumdy = sin(l_angle);
-    used->data[x + y * used->xsize] = USED;
+    bitmap_bit_set(used, x + y * xsize);
 
     /* try neighbors as new region points */
     for (i = 0; i < l_size; i++) {
@@ -2133,21 +1135,22 @@ static void region_grow(int x, int y, image_int angles, struct lsd_point *reg,
         }
         if (ty < 0) {
             ty = 0; dy--;
-        } else if (ty + dy >= used->ysize) {
+        } else if (ty + dy >= ysize) {
             dy--;
         }
         for (xx = tx; xx < tx + dx; xx++) {
             for (yy = ty; yy < ty + dy; yy++) {
-                if (used->data[xx + yy * xsize] != USED &&
-                    isaligned_fast((float) angles->data[(yy * xsize) + xx], l_angle, prec) ) {
+                int adr = xx + yy * xsize;
+                if (!bitmap_bit_get(used, adr) &&
+                    isaligned_fast(angles->data[adr], l_angle, prec) ) {
                     /* add point */
-                    used->data[xx + yy * xsize] = USED;
+                    bitmap_bit_set(used, adr);
                     reg[l_size].x = xx;
                     reg[l_size].y = yy;
                     ++l_size;
 
                     /* update region's angle */
-                    int16_t angle = angles->data[xx + yy * xsize] % 360;
+                    int angle = angles->data[adr] % 360;
                     if (angle < 0) {
                         angle += 360;
                     }
@@ -2278,7 +1281,7 @@ static float rect_improve(struct rect *rec, image_int angles,
 static int reduce_region_radius(struct lsd_point *reg, int *reg_size,
                                 image_int modgrad, float reg_angle,
                                 float prec, float p, struct rect *rec,
-                                image_char used, image_int angles,
+                                bitmap_t *used, image_int angles,
                                 float density_th) {
     float density, rad1, rad2, rad, xc, yc;
     int i;
@@ -2297,7 +1300,7 @@ static int reduce_region_radius(struct lsd_point *reg, int *reg_size,
         error("reduce_region_radius: invalid pointer 'rec'.");
     }
     if (used == NULL || used->data == NULL) {
-        error("reduce_region_radius: invalid image 'used'.");
+        error("reduce_region_radius: invalid bitmap 'used'.");
     }
     if (angles == NULL || angles->data == NULL) {
         error("reduce_region_radius: invalid image 'angles'.");
@@ -2326,8 +1329,8 @@ static int reduce_region_radius(struct lsd_point *reg, int *reg_size,
         /* remove points from the region and update 'used' map */
         for (i = 0; i < *reg_size; i++) {
             if (dist(xc, yc, (float) reg[i].x, (float) reg[i].y) > rad) {
-                /* point not kept, mark it as NOTUSED */
-                used->data[ reg[i].x + reg[i].y * used->xsize ] = NOTUSED;
+                /* point not kept, mark it as not used */
+                bitmap_bit_reset(used, reg[i].x + reg[i].y * angles->xsize);
                 /* remove point from the region */
                 reg[i].x = reg[*reg_size - 1].x; /* if i==*reg_size-1 copy itself */
                 reg[i].y = reg[*reg_size - 1].y;
@@ -2366,7 +1369,7 @@ static int reduce_region_radius(struct lsd_point *reg, int *reg_size,
  */
 static int refine(struct lsd_point *reg, int *reg_size, image_int modgrad,
                   float reg_angle, float prec, float p, struct rect *rec,
-                  image_char used, image_int angles, float density_th) {
+                  bitmap_t *used, image_int angles, float density_th) {
     float angle, ang_d, mean_angle, tau, density, xc, yc, ang_c, sum, s_sum;
     int i, n;
 
@@ -2384,7 +1387,7 @@ static int refine(struct lsd_point *reg, int *reg_size, image_int modgrad,
         error("refine: invalid pointer 'rec'.");
     }
     if (used == NULL || used->data == NULL) {
-        error("refine: invalid image 'used'.");
+        error("refine: invalid bitmap 'used'.");
     }
     if (angles == NULL || angles->data == NULL) {
         error("refine: invalid image 'angles'.");
@@ -2408,7 +1411,7 @@ static int refine(struct lsd_point *reg, int *reg_size, image_int modgrad,
     sum = s_sum = 0.0;
     n = 0;
     for (i = 0; i < *reg_size; i++) {
-        used->data[ reg[i].x + reg[i].y * used->xsize ] = NOTUSED;
+        bitmap_bit_reset(used, reg[i].x + reg[i].y * angles->xsize);
         if (dist(xc, yc, (float) reg[i].x, (float) reg[i].y) < rec->width) {
             angle = degToRad(angles->data[ reg[i].x + reg[i].y * angles->xsize ]);
             ang_d = angle_diff_signed(angle, ang_c);
@@ -2452,40 +1455,96 @@ static int refine(struct lsd_point *reg, int *reg_size, image_int modgrad,
 /*----------------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------------*/
+/** Add a line segment found in the 'roi' to 'out', if it's inside the 'roi'.
+ */
+static void lsd_add_line_segment(list_t *out, rectangle_t *roi, struct rect *rec, float log_nfa) {
+    find_lines_list_lnk_data_t lnk_line;
+
+    lnk_line.line.x1 = fast_roundf(rec->x1);
+    lnk_line.line.y1 = fast_roundf(rec->y1);
+    lnk_line.line.x2 = fast_roundf(rec->x2);
+    lnk_line.line.y2 = fast_roundf(rec->y2);
+
+    if (lb_clip_line(&lnk_line.line, 0, 0, roi->w, roi->h)) {
+        lnk_line.line.x1 += roi->x;
+        lnk_line.line.y1 += roi->y;
+        lnk_line.line.x2 += roi->x;
+        lnk_line.line.y2 += roi->y;
+
+        int dx = lnk_line.line.x2 - lnk_line.line.x1, mdx = lnk_line.line.x1 + (dx / 2);
+        int dy = lnk_line.line.y2 - lnk_line.line.y1, mdy = lnk_line.line.y1 + (dy / 2);
+        float rotation = (dx ? fast_atan2f(dy, dx) : 1.570796f) + 1.570796f; // PI/2
+
+        lnk_line.theta = fast_roundf(rotation * 57.295780) % 180; // * (180 / PI)
+        if (lnk_line.theta < 0) {
+            lnk_line.theta += 180;
+        }
+        lnk_line.rho = fast_roundf((mdx * cos_table[lnk_line.theta]) + (mdy * sin_table[lnk_line.theta]));
+
+        lnk_line.magnitude = fast_roundf(log_nfa);
+
+        list_push_back(out, &lnk_line);
+    }
+}
+
 /** LSD full interface.
+
+    @param out         List where the line segments found are added.
+
+    @param roi         Region of the source image 'img' was taken from.
+
+    @param img         Pointer to input image data. It must be an array of
+                       unsigned chars of size X x Y, and the pixel at coordinates
+                       (x,y) is obtained by img[x+y*X].
+
+    @param X           X size of the image: the number of columns.
+
+    @param Y           Y size of the image: the number of rows.
+
+    @param quant       Bound to the quantization error on the gradient norm.
+                       Example: if gray levels are quantized to integer steps,
+                       the gradient (computed by finite differences) error
+                       due to quantization will be bounded by 2.0, as the
+                       worst case is when the error are 1 and -1, that
+                       gives an error of 2.0.
+                       Suggested value: 2.0
+
+    @param ang_th      Gradient angle tolerance in the region growing
+                       algorithm, in degrees.
+                       Suggested value: 22.5
+
+    @param log_eps     Detection threshold, accept if -log10(NFA) > log_eps.
+                       The larger the value, the more strict the detector is,
+                       and will result in less detections.
+                       Suggested value: 0.0
+
+    @param density_th  Minimal proportion of 'supporting' points in a rectangle.
+                       Suggested value: 0.7
+
+    @param n_bins      Number of bins used in the pseudo-ordering of gradient
+                       modulus.
+                       Suggested value: 1024
+
+    All the working memory (about 13 bytes per pixel) is allocated up front
+    with fb_alloc, nothing is allocated while line segments are searched.
  */
-float *LineSegmentDetection(int *n_out,
-                            unsigned char *img, int X, int Y,
-                            float scale, float sigma_scale, float quant,
-                            float ang_th, float log_eps, float density_th,
-                            int n_bins,
-                            int **reg_img, int *reg_x, int *reg_y) {
-    image_char image;
-    ntuple_list out = new_ntuple_list(7);
-    float *return_value;
-    image_int scaled_image, angles, modgrad;
-    image_char used;
-    image_int region = NULL;
-    struct coorlist *list_p;
-    void *mem_p;
+static void LineSegmentDetection(list_t *out, rectangle_t *roi,
+                                 unsigned char *img, int X, int Y,
+                                 float quant, float ang_th, float log_eps,
+                                 float density_th, int n_bins) {
+    struct image_int_s angles_s, modgrad_s;
+    image_int angles = &angles_s, modgrad = &modgrad_s;
+    bitmap_t used;
+    struct lsd_point *list_p, *reg;
     struct rect rec;
-    struct lsd_point *reg;
-    int reg_size, min_reg_size, i;
+    int list_size, reg_size, min_reg_size, i;
     unsigned int xsize, ysize;
     float rho, reg_angle, prec, p, log_nfa, logNT;
-    int ls_count = 0;                 /* line segments are numbered 1,2,3,... */
-
 
     /* check parameters */
     if (img == NULL || X <= 0 || Y <= 0) {
         error("invalid image input.");
     }
-    if (scale <= 0.0) {
-        error("'scale' value must be positive.");
-    }
-    if (sigma_scale <= 0.0) {
-        error("'sigma_scale' value must be positive.");
-    }
     if (quant < 0.0) {
         error("'quant' value must be positive.");
     }
@@ -2499,19 +1558,21 @@ float *LineSegmentDetection(int *n_out,
         error("'n_bins' value must be positive.");
     }
 
-
     /* angle tolerance */
     prec = M_PI * ang_th / 180.0;
     p = ang_th / 180.0;
     rho = quant / sin(prec); /* gradient magnitude threshold */
 
+    xsize = angles->xsize = modgrad->xsize = X;
+    ysize = angles->ysize = modgrad->ysize = Y;
+    angles->data = fb_alloc(xsize * ysize * sizeof(int16_t), FB_ALLOC_NO_HINT);
+    modgrad->data = fb_alloc(xsize * ysize * sizeof(int16_t), FB_ALLOC_NO_HINT);
+    list_p = fb_alloc(xsize * ysize * sizeof(struct lsd_point), FB_ALLOC_NO_HINT);
+    reg = fb_alloc(xsize * ysize * sizeof(struct lsd_point), FB_ALLOC_NO_HINT);
+    bitmap_alloc(&used, xsize * ysize);
 
-    /* load and scale image (if necessary) and compute angle at each pixel */
-    image = new_image_char_ptr( (unsigned int) X, (unsigned int) Y, img);
-    angles = ll_angle(image, rho, &list_p, &mem_p, &modgrad,
-                      (unsigned int) n_bins);
-    xsize = angles->xsize;
-    ysize = angles->ysize;
+    /* compute angle at each pixel */
+    ll_angle(img, rho, angles, modgrad, list_p, &list_size, (unsigned int) n_bins);
 
     /* Number of Tests - NT
 
@@ -2531,24 +1592,12 @@ float *LineSegmentDetection(int *n_out,
     min_reg_size = (int) (-logNT / log10(p)); /* minimal number of points in region
                                                  that can give a meaningful event */
 
-
-//  /* initialize some structures */
-    used = new_image_char_ini(xsize, ysize, NOTUSED);
-    reg = (struct lsd_point *) calloc( (size_t) (xsize * ysize), sizeof(struct lsd_point) );
-    if (reg == NULL) {
-        error("not enough memory!");
-    }
-
-
     /* search for line segments */
-    for (; list_p != NULL; list_p = list_p->next) {
-        if (used->data[ list_p->x + list_p->y * used->xsize ] == NOTUSED &&
-            angles->data[ list_p->x + list_p->y * angles->xsize ] != NOTDEF_INT) {
-            /* there is no risk of float comparison problems here
-               because we are only interested in the exact NOTDEF value */
+    for (i = 0; i < list_size; i++) {
+        if (!bitmap_bit_get(&used, list_p[i].x + list_p[i].y * xsize)) {
             /* find the region of connected point and ~equal angle */
-            region_grow(list_p->x, list_p->y, angles, reg, &reg_size,
-                        &reg_angle, used, prec);
+            region_grow(list_p[i].x, list_p[i].y, angles, reg, &reg_size,
+                        &reg_angle, &used, prec);
 
             /* reject small regions */
             if (reg_size < min_reg_size) {
@@ -2568,7 +1617,7 @@ float *LineSegmentDetection(int *n_out,
                The original algorithm is obtained with density_th = 0.0.
              */
             if (!refine(reg, &reg_size, modgrad, reg_angle,
-                        prec, p, &rec, used, angles, density_th) ) {
+                        prec, p, &rec, &used, angles, density_th) ) {
                 continue;
             }
 
@@ -2578,9 +1627,6 @@ float *LineSegmentDetection(int *n_out,
                 continue;
             }
 
-            /* A New Line Segment was found! */
-            ++ls_count; /* increase line segment counter */
-
             /*
                The gradient was computed with a 2x2 mask, its value corresponds to
                points with an offset of (0.5,0.5), that should be added to output.
@@ -2589,102 +1635,17 @@ float *LineSegmentDetection(int *n_out,
             rec.x1 += 0.5; rec.y1 += 0.5;
             rec.x2 += 0.5; rec.y2 += 0.5;
 
-            /* scale the result values if a subsampling was performed */
-//        if( scale != 1.0 )
-//          {
-//            rec.x1 /= scale; rec.y1 /= scale;
-//            rec.x2 /= scale; rec.y2 /= scale;
-//            rec.width /= scale;
-//          }
-
-            /* add line segment found to output */
-            add_7tuple(out, rec.x1, rec.y1, rec.x2, rec.y2,
-                       rec.width, rec.p, log_nfa);
-
-//        /* add region number to 'region' image if needed */
-//        if( region != NULL )
-//          for(i=0; i<reg_size; i++)
-//            region->data[ reg[i].x + reg[i].y * region->xsize ] = ls_count;
+            /* A New Line Segment was found! */
+            lsd_add_line_segment(out, roi, &rec, log_nfa);
         }
     }
 
-
     /* free memory */
-    free( (void *) image);  /* only the char_image structure should be freed,
-                               the data pointer was provided to this functions
-                               and should not be destroyed.                 */
-    free_image_int(angles);
-    free_image_int(modgrad);
-    free_image_char(used);
-    free( (void *) reg);
-    free( (void *) mem_p);
-
-//  /* return the result */
-//  if( reg_img != NULL && reg_x != NULL && reg_y != NULL )
-//    {
-//      if( region == NULL ) error("'region' should be a valid image.");
-//      *reg_img = region->data;
-//      if( region->xsize > (unsigned int) INT_MAX ||
-//          region->xsize > (unsigned int) INT_MAX )
-//        error("region image to big to fit in INT sizes.");
-//      *reg_x = (int) (region->xsize);
-//      *reg_y = (int) (region->ysize);
-
-//      /* free the 'region' structure.
-//         we cannot use the function 'free_image_int' because we need to keep
-//         the memory with the image data to be returned by this function. */
-//      free( (void *) region );
-//    }
-    if (out->size > (unsigned int) INT_MAX) {
-        error("too many detections to fit in an INT.");
-    }
-    *n_out = (int) (out->size);
-
-    return_value = out->values;
-    free( (void *) out); /* only the 'ntuple_list' structure must be freed,
-                            but the 'values' pointer must be keep to return
-                            as a result. */
-
-    return return_value;
-}
-
-/*----------------------------------------------------------------------------*/
-/** LSD Simple Interface with Scale and Region output.
- */
-float *lsd_scale_region(int *n_out,
-                        unsigned char *img, int X, int Y, float scale,
-                        int **reg_img, int *reg_x, int *reg_y) {
-    /* LSD parameters */
-    float sigma_scale = 0.6; /* Sigma for Gaussian filter is computed as
-                                  sigma = sigma_scale/scale.                    */
-    float quant = 2.0;     /* Bound to the quantization error on the
-                                gradient norm.                                */
-    float ang_th = 22.5;   /* Gradient angle tolerance in degrees.           */
-    float log_eps = 0.0;   /* Detection threshold: -log10(NFA) > log_eps     */
-    float density_th = 0.7; /* Minimal density of region points in rectangle. */
-    int n_bins = 1024;      /* Number of bins in pseudo-ordering of gradient
-                               modulus.                                       */
-
-    return LineSegmentDetection(n_out, img, X, Y, scale, sigma_scale, quant,
-                                ang_th, log_eps, density_th, n_bins,
-                                reg_img, reg_x, reg_y);
-}
-
-/*----------------------------------------------------------------------------*/
-/** LSD Simple Interface with Scale.
- */
-float *lsd_scale(int *n_out, unsigned char *img, int X, int Y, float scale) {
-    return lsd_scale_region(n_out, img, X, Y, scale, NULL, NULL, NULL);
-}
-
-/*----------------------------------------------------------------------------*/
-/** LSD Simple Interface.
- */
-float *lsd(int *n_out, unsigned char *img, int X, int Y) {
-    /* LSD parameters */
-    float scale = 0.8;     /* Scale the image by Gaussian filter to 'scale'. */
-
-    return lsd_scale(n_out, img, X, Y, scale);
+    bitmap_free(&used);
+    fb_free(); // reg
+    fb_free(); // list_p
+    fb_free(); // modgrad
+    fb_free(); // angles
 }
 
 void imlib_lsd_find_line_segments(list_t *out,
@@ -2701,60 +1662,13 @@ void imlib_lsd_find_line_segments(list_t *out,
     img.data = grayscale_image;
     imlib_draw_image(&img, ptr, 0, 0, 1.f, 1.f, roi, -1, 256, NULL, NULL, 0, NULL, NULL, NULL);
 
-    umm_init_x(fb_avail());
-
-    int n_ls;
-    float *ls = LineSegmentDetection(&n_ls,
-                                     grayscale_image,
-                                     roi->w,
-                                     roi->h,
-                                     0.8,
-                                     0.6,
-                                     2.0,
-                                     22.5,
-                                     0.0,
-                                     0.7,
-                                     1024,
-                                     NULL,
-                                     NULL,
-                                     NULL);
     list_init(out, sizeof(find_lines_list_lnk_data_t));
-
-    for (int i = 0, j = n_ls; i < j; i++) {
-        find_lines_list_lnk_data_t lnk_line;
-
-        lnk_line.line.x1 = fast_roundf(ls[(7 * i) + 0]);
-        lnk_line.line.y1 = fast_roundf(ls[(7 * i) + 1]);
-        lnk_line.line.x2 = fast_roundf(ls[(7 * i) + 2]);
-        lnk_line.line.y2 = fast_roundf(ls[(7 * i) + 3]);
-
-        if (lb_clip_line(&lnk_line.line, 0, 0, roi->w, roi->h)) {
-            lnk_line.line.x1 += roi->x;
-            lnk_line.line.y1 += roi->y;
-            lnk_line.line.x2 += roi->x;
-            lnk_line.line.y2 += roi->y;
-
-            int dx = lnk_line.line.x2 - lnk_line.line.x1, mdx = lnk_line.line.x1 + (dx / 2);
-            int dy = lnk_line.line.y2 - lnk_line.line.y1, mdy = lnk_line.line.y1 + (dy / 2);
-            float rotation = (dx ? fast_atan2f(dy, dx) : 1.570796f) + 1.570796f; // PI/2
-
-            lnk_line.theta = fast_roundf(rotation * 57.295780) % 180; // * (180 / PI)
-            if (lnk_line.theta < 0) {
-                lnk_line.theta += 180;
-            }
-            lnk_line.rho = fast_roundf((mdx * cos_table[lnk_line.theta]) + (mdy * sin_table[lnk_line.theta]));
-
-            lnk_line.magnitude = fast_roundf(ls[(7 * i) + 6]);
-
-            list_push_back(out, &lnk_line);
-        }
-    }
+    LineSegmentDetection(out, roi, grayscale_image, roi->w, roi->h, 2.0, 22.5, 0.0, 0.7, 1024);
 
     if (merge_distance > 0) {
         merge_alot(out, merge_distance, max_theta_diff);
     }
 
-    fb_free(); // umm_init_x();
     fb_free(); // grayscale_image;
 }
 
@@ -0,0 +1,304 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Lossless image compression.
+ *
+ * Each pixel is replaced by its difference to the previous pixel of the same color in the
+ * row (the first pixels by their difference to the row above), which turns flat and smooth
+ * areas into runs of small repeating values. The differences are then compressed with the
+ * LZ4 block format. Binary images are compressed as is.
+ */
+#include <string.h>
+#include "imlib.h"
+#include "fb_alloc.h"
+
+#ifdef IMLIB_ENABLE_IMAGE_IO
+#define LZ4_HASH_BITS       (12)
+#define LZ4_MIN_MATCH       (4)
+#define LZ4_LAST_LITERALS   (5)     // The last bytes are always literals.
+#define LZ4_MF_LIMIT        (12)    // The last match starts at least this far from the end.
+#define LZ4_MAX_OFFSET      (65535)
+#define LZ4_SKIP_TRIGGER    (6)     // Search faster through data that doesn't compress.
+
+static inline uint32_t lz4_read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t lz4_hash(uint32_t v) {
+    return (v * 2654435761U) >> (32 - LZ4_HASH_BITS);
+}
+
+static uint8_t *lz4_put_length(uint8_t *op, size_t len) {
+    for (; len >= 255; len -= 255) {
+        *op++ = 255;
+    }
+
+    *op++ = len;
+    return op;
+}
+
+// Returns the compressed size, or 0 if it doesn't fit in dst_size bytes.
+static size_t lz4_compress(const uint8_t *src, size_t n, uint8_t *dst, size_t dst_size, uint32_t *table) {
+    const uint8_t *ip = src, *anchor = src, *end = src + n;
+    const uint8_t *mf_limit = end - LZ4_MF_LIMIT, *match_limit = end - LZ4_LAST_LITERALS;
+    uint8_t *op = dst, *op_end = dst + dst_size;
+
+    memset(table, 0, sizeof(uint32_t) << LZ4_HASH_BITS);
+
+    while ((n > LZ4_MF_LIMIT) && (ip < mf_limit)) {
+        uint32_t seq = lz4_read32(ip), h = lz4_hash(seq);
+        const uint8_t *ref = src + table[h];
+        table[h] = ip - src;
+
+        if ((ref >= ip) || ((ip - ref) > LZ4_MAX_OFFSET) || (lz4_read32(ref) != seq)) {
+            ip += 1 + ((ip - anchor) >> LZ4_SKIP_TRIGGER);
+            continue;
+        }
+
+        while ((ip > anchor) && (ref > src) && (ip[-1] == ref[-1])) {
+            ip--;
+            ref--;
+        }
+
+        const uint8_t *mp = ip + LZ4_MIN_MATCH, *mr = ref + LZ4_MIN_MATCH;
+        while ((mp < match_limit) && (*mp == *mr)) {
+            mp++;
+            mr++;
+        }
+
+        size_t literals = ip - anchor, match = mp - ip - LZ4_MIN_MATCH, offset = ip - ref;
+
+        if ((op + 1 + literals + (literals / 255) + 2 + (match / 255) + 1 + 1 + LZ4_LAST_LITERALS) > op_end) {
+            return 0;
+        }
+
+        uint8_t *token = op++;
+        *token = (IM_MIN(literals, (size_t) 15) << 4) | IM_MIN(match, (size_t) 15);
+
+        if (literals >= 15) {
+            op = lz4_put_length(op, literals - 15);
+        }
+
+        memcpy(op, anchor, literals);
+        op += literals;
+        *op++ = offset;
+        *op++ = offset >> 8;
+
+        if (match >= 15) {
+            op = lz4_put_length(op, match - 15);
+        }
+
+        ip = anchor = mp;
+    }
+
+    size_t literals = end - anchor;
+
+    if ((op + 1 + literals + (literals / 255) + 1) > op_end) {
+        return 0;
+    }
+
+    *op++ = IM_MIN(literals, (size_t) 15) << 4;
+
+    if (literals >= 15) {
+        op = lz4_put_length(op, literals - 15);
+    }
+
+    memcpy(op, anchor, literals);
+    return (op + literals) - dst;
+}
+
+static bool lz4_get_length(const uint8_t **ip, const uint8_t *ip_end, size_t *len) {
+    for (uint8_t b = 255; b == 255; *len += b) {
+        if (*ip >= ip_end) {
+            return false;
+        }
+        b = *(*ip)++;
+    }
+
+    return true;
+}
+
+// Returns false unless src decompresses to exactly dst_size bytes.
+static bool lz4_decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t dst_size) {
+    const uint8_t *ip = src, *ip_end = src + n;
+    uint8_t *op = dst, *op_end = dst + dst_size;
+
+    while (ip < ip_end) {
+        uint8_t token = *ip++;
+        size_t literals = token >> 4;
+
+        if ((literals == 15) && (!lz4_get_length(&ip, ip_end, &literals))) {
+            return false;
+        }
+
+        if ((literals > (ip_end - ip)) || (literals > (op_end - op))) {
+            return false;
+        }
+
+        memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+
+        // The last sequence has no match.
+        if (ip == ip_end) {
+            break;
+        }
+
+        if ((ip_end - ip) < 2) {
+            return false;
+        }
+
+        size_t offset = ip[0] | (ip[1] << 8), match = token & 15;
+        ip += 2;
+
+        if ((!offset) || (offset > (op - dst))) {
+            return false;
+        }
+
+        if ((match == 15) && (!lz4_get_length(&ip, ip_end, &match))) {
+            return false;
+        }
+
+        match += LZ4_MIN_MATCH;
+
+        if (match > (op_end - op)) {
+            return false;
+        }
+
+        const uint8_t *mp = op - offset;
+
+        if (offset >= match) {
+            memcpy(op, mp, match);
+            op += match;
+        } else {
+            // Overlapping matches repeat the last offset bytes.
+            while (match--) {
+                *op++ = *mp++;
+            }
+        }
+    }
+
+    return op == op_end;
+}
+
+// Replaces the pixels by their differences, see above.
+static void lz4_delta_encode(image_t *img, uint8_t *out) {
+    switch (img->pixfmt) {
+        case PIXFORMAT_GRAYSCALE: {
+            for (int y = 0; y < img->h; y++) {
+                uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+                uint8_t *out_ptr = out + (y * img->w);
+                out_ptr[0] = row_ptr[0] - (y ? row_ptr[-img->w] : 0);
+                for (int x = 1; x < img->w; x++) {
+                    out_ptr[x] = row_ptr[x] - row_ptr[x - 1];
+                }
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            for (int y = 0; y < img->h; y++) {
+                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+                uint16_t *out_ptr = ((uint16_t *) out) + (y * img->w);
+                out_ptr[0] = row_ptr[0] - (y ? row_ptr[-img->w] : 0);
+                for (int x = 1; x < img->w; x++) {
+                    out_ptr[x] = row_ptr[x] - row_ptr[x - 1];
+                }
+            }
+            break;
+        }
+        case PIXFORMAT_BAYER_ANY: {
+            // Same color pixels are 2 apart.
+            for (int y = 0; y < img->h; y++) {
+                uint8_t *row_ptr = IMAGE_COMPUTE_BAYER_PIXEL_ROW_PTR(img, y);
+                uint8_t *out_ptr = out + (y * img->w);
+                for (int x = 0; x < IM_MIN(img->w, 2); x++) {
+                    out_ptr[x] = row_ptr[x] - ((y >= 2) ? row_ptr[x - (img->w * 2)] : 0);
+                }
+                for (int x = 2; x < img->w; x++) {
+                    out_ptr[x] = row_ptr[x] - row_ptr[x - 2];
+                }
+            }
+            break;
+        }
+        default: {
+            memcpy(out, img->data, image_size(img));
+            break;
+        }
+    }
+}
+
+static void lz4_delta_decode(image_t *img) {
+    switch (img->pixfmt) {
+        case PIXFORMAT_GRAYSCALE: {
+            for (int y = 0; y < img->h; y++) {
+                uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+                row_ptr[0] += y ? row_ptr[-img->w] : 0;
+                for (int x = 1; x < img->w; x++) {
+                    row_ptr[x] += row_ptr[x - 1];
+                }
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            for (int y = 0; y < img->h; y++) {
+                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+                row_ptr[0] += y ? row_ptr[-img->w] : 0;
+                for (int x = 1; x < img->w; x++) {
+                    row_ptr[x] += row_ptr[x - 1];
+                }
+            }
+            break;
+        }
+        case PIXFORMAT_BAYER_ANY: {
+            for (int y = 0; y < img->h; y++) {
+                uint8_t *row_ptr = IMAGE_COMPUTE_BAYER_PIXEL_ROW_PTR(img, y);
+                for (int x = 0; x < IM_MIN(img->w, 2); x++) {
+                    row_ptr[x] += (y >= 2) ? row_ptr[x - (img->w * 2)] : 0;
+                }
+                for (int x = 2; x < img->w; x++) {
+                    row_ptr[x] += row_ptr[x - 2];
+                }
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+size_t imlib_lz4_compress(image_t *img, uint8_t *out, size_t out_size) {
+    size_t size = image_size(img);
+    size_t table_size = sizeof(uint32_t) << LZ4_HASH_BITS;
+
+    // Frames are stored uncompressed when there's no room to compress them.
+    if (img->is_compressed || (fb_avail() < (size + table_size + (4 * sizeof(uint32_t))))) {
+        return 0;
+    }
+
+    fb_alloc_mark();
+    uint8_t *delta = fb_alloc(size, FB_ALLOC_NO_HINT);
+    uint32_t *table = fb_alloc(table_size, FB_ALLOC_NO_HINT);
+
+    lz4_delta_encode(img, delta);
+    size_t out_len = lz4_compress(delta, size, out, out_size, table);
+    fb_alloc_free_till_mark();
+    return out_len;
+}
+
+bool imlib_lz4_decompress(image_t *img, const uint8_t *in, size_t in_size) {
+    if (!lz4_decompress(in, in_size, img->data, image_size(img))) {
+        return false;
+    }
+
+    lz4_delta_decode(img);
+    return true;
+}
+#endif // IMLIB_ENABLE_IMAGE_IO
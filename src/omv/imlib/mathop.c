@@ -11,6 +11,17 @@
 #include "imlib.h"
 
 #ifdef IMLIB_ENABLE_MATH_OPS
+#if defined(IMLIB_ENABLE_HELIUM)
+// Applies op to the R, G and B fields of 8 RGB565 pixels in place, for ops where the fields
+// can stay in position (min, max and absolute difference).
+#define MVE_RGB565_FIELD(op, p0, p1, mask) \
+    op(vandq_u16((p0), vdupq_n_u16(mask)), vandq_u16((p1), vdupq_n_u16(mask)))
+#define MVE_RGB565_FIELD_OP(op, p0, p1)                          \
+    vorrq_u16(vorrq_u16(MVE_RGB565_FIELD(op, p0, p1, 0xF800),    \
+                        MVE_RGB565_FIELD(op, p0, p1, 0x07E0)),   \
+              MVE_RGB565_FIELD(op, p0, p1, 0x001F))
+#endif
+
 typedef struct imlib_replace_line_op_state {
     bool hmirror, vflip, transpose;
     image_t *mask;
@@ -165,6 +176,13 @@ static void imlib_add_line_op(image_t *img, int line, void *other, void *data, b
 
             if (!mask) {
                 size_t x = 0;
+                #if defined(IMLIB_ENABLE_HELIUM)
+                for (; (img->w - x) >= 16; x += 16) {
+                    uint8x16_t p0 = vld1q_u8(row0 + x), p1 = vld1q_u8(row1 + x);
+                    vst1q_u8(row0 + x, vqaddq_u8(p0, p1));
+                }
+                #endif
+
                 #if defined(ARM_MATH_DSP)
                 for (; (img->w - x) >= 4; x += 4) {
                     uint32_t p0 = *((uint32_t *) (row0 + x));
@@ -197,6 +215,16 @@ static void imlib_add_line_op(image_t *img, int line, void *other, void *data, b
 
             if (!mask) {
                 size_t x = 0;
+                #if defined(IMLIB_ENABLE_HELIUM)
+                for (; (img->w - x) >= 8; x += 8) {
+                    uint16x8_t p0 = vld1q_u16(row0 + x), p1 = vld1q_u16(row1 + x);
+                    uint16x8_t r = vminq_u16(vaddq_u16(MVE_RGB565_TO_R5(p0), MVE_RGB565_TO_R5(p1)), vdupq_n_u16(0x1F));
+                    uint16x8_t g = vminq_u16(vaddq_u16(MVE_RGB565_TO_G6(p0), MVE_RGB565_TO_G6(p1)), vdupq_n_u16(0x3F));
+                    uint16x8_t b = vminq_u16(vaddq_u16(MVE_RGB565_TO_B5(p0), MVE_RGB565_TO_B5(p1)), vdupq_n_u16(0x1F));
+                    vst1q_u16(row0 + x, MVE_R5_G6_B5_TO_RGB565(r, g, b));
+                }
+                #endif
+
                 #if defined(ARM_MATH_DSP)
                 for (; (img->w - x) >= 2; x += 2) {
                     uint32_t p0 = *((uint32_t *) (row0 + x));
@@ -237,7 +265,7 @@ static void imlib_add_line_op(image_t *img, int line, void *other, void *data, b
 }
 
 void imlib_add(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_add_line_op, mask);
+    imlib_image_operation_mask(img, path, other, scalar, imlib_add_line_op, NULL, mask);
 }
 
 static void imlib_sub_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -282,6 +310,13 @@ static void imlib_sub_line_op(image_t *img, int line, void *other, void *data, b
 
             if (!mask) {
                 size_t x = 0;
+                #if defined(IMLIB_ENABLE_HELIUM)
+                for (; (img->w - x) >= 16; x += 16) {
+                    uint8x16_t p0 = vld1q_u8(row0 + x), p1 = vld1q_u8(row1 + x);
+                    vst1q_u8(row0 + x, vqsubq_u8(p0, p1));
+                }
+                #endif
+
                 #if defined(ARM_MATH_DSP)
                 for (; (img->w - x) >= 4; x += 4) {
                     uint32_t p0 = *((uint32_t *) (row0 + x));
@@ -314,6 +349,16 @@ static void imlib_sub_line_op(image_t *img, int line, void *other, void *data, b
 
             if (!mask) {
                 size_t x = 0;
+                #if defined(IMLIB_ENABLE_HELIUM)
+                for (; (img->w - x) >= 8; x += 8) {
+                    uint16x8_t p0 = vld1q_u16(row0 + x), p1 = vld1q_u16(row1 + x);
+                    uint16x8_t r = vqsubq_u16(MVE_RGB565_TO_R5(p0), MVE_RGB565_TO_R5(p1));
+                    uint16x8_t g = vqsubq_u16(MVE_RGB565_TO_G6(p0), MVE_RGB565_TO_G6(p1));
+                    uint16x8_t b = vqsubq_u16(MVE_RGB565_TO_B5(p0), MVE_RGB565_TO_B5(p1));
+                    vst1q_u16(row0 + x, MVE_R5_G6_B5_TO_RGB565(r, g, b));
+                }
+                #endif
+
                 #if defined(ARM_MATH_DSP)
                 for (; (img->w - x) >= 2; x += 2) {
                     uint32_t p0 = *((uint32_t *) (row0 + x));
@@ -395,6 +440,13 @@ static void imlib_rsub_line_op(image_t *img, int line, void *other, void *data,
 
             if (!mask) {
                 size_t x = 0;
+                #if defined(IMLIB_ENABLE_HELIUM)
+                for (; (img->w - x) >= 16; x += 16) {
+                    uint8x16_t p0 = vld1q_u8(row0 + x), p1 = vld1q_u8(row1 + x);
+                    vst1q_u8(row0 + x, vqsubq_u8(p1, p0));
+                }
+                #endif
+
                 #if defined(ARM_MATH_DSP)
                 for (; (img->w - x) >= 4; x += 4) {
                     uint32_t p0 = *((uint32_t *) (row0 + x));
@@ -427,6 +479,16 @@ static void imlib_rsub_line_op(image_t *img, int line, void *other, void *data,
 
             if (!mask) {
                 size_t x = 0;
+                #if defined(IMLIB_ENABLE_HELIUM)
+                for (; (img->w - x) >= 8; x += 8) {
+                    uint16x8_t p0 = vld1q_u16(row0 + x), p1 = vld1q_u16(row1 + x);
+                    uint16x8_t r = vqsubq_u16(MVE_RGB565_TO_R5(p1), MVE_RGB565_TO_R5(p0));
+                    uint16x8_t g = vqsubq_u16(MVE_RGB565_TO_G6(p1), MVE_RGB565_TO_G6(p0));
+                    uint16x8_t b = vqsubq_u16(MVE_RGB565_TO_B5(p1), MVE_RGB565_TO_B5(p0));
+                    vst1q_u16(row0 + x, MVE_R5_G6_B5_TO_RGB565(r, g, b));
+                }
+                #endif
+
                 #if defined(ARM_MATH_DSP)
                 for (; (img->w - x) >= 2; x += 2) {
                     uint32_t p0 = *((uint32_t *) (row0 + x));
@@ -467,7 +529,7 @@ static void imlib_rsub_line_op(image_t *img, int line, void *other, void *data,
 }
 
 void imlib_sub(image_t *img, const char *path, image_t *other, int scalar, bool reverse, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, reverse ? imlib_rsub_line_op : imlib_sub_line_op, mask);
+    imlib_image_operation_mask(img, path, other, scalar, reverse ? imlib_rsub_line_op : imlib_sub_line_op, NULL, mask);
 }
 
 static void imlib_min_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -483,6 +545,13 @@ static void imlib_min_line_op(image_t *img, int line, void *other, void *data, b
 
             if (!mask) {
                 size_t x = 0;
+                #if defined(IMLIB_ENABLE_HELIUM)
+                for (; (img->w - x) >= 16; x += 16) {
+                    uint8x16_t p0 = vld1q_u8(row0 + x), p1 = vld1q_u8(row1 + x);
+                    vst1q_u8(row0 + x, vminq_u8(p0, p1));
+                }
+                #endif
+
                 #if defined(ARM_MATH_DSP)
                 for (; (img->w - x) >= 4; x += 4) {
                     uint32_t p0 = *((uint32_t *) (row0 + x));
@@ -516,6 +585,13 @@ static void imlib_min_line_op(image_t *img, int line, void *other, void *data, b
 
             if (!mask) {
                 size_t x = 0;
+                #if defined(IMLIB_ENABLE_HELIUM)
+                for (; (img->w - x) >= 8; x += 8) {
+                    uint16x8_t p0 = vld1q_u16(row0 + x), p1 = vld1q_u16(row1 + x);
+                    vst1q_u16(row0 + x, MVE_RGB565_FIELD_OP(vminq_u16, p0, p1));
+                }
+                #endif
+
                 #if defined(ARM_MATH_DSP)
                 for (; (img->w - x) >= 2; x += 2) {
                     uint32_t p0 = *((uint32_t *) (row0 + x));
@@ -559,7 +635,7 @@ static void imlib_min_line_op(image_t *img, int line, void *other, void *data, b
 }
 
 void imlib_min(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_min_line_op, mask);
+    imlib_image_operation_mask(img, path, other, scalar, imlib_min_line_op, NULL, mask);
 }
 
 static void imlib_max_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -576,6 +652,13 @@ static void imlib_max_line_op(image_t *img, int line, void *other, void *data, b
 
             if (!mask) {
                 size_t x = 0;
+                #if defined(IMLIB_ENABLE_HELIUM)
+                for (; (img->w - x) >= 16; x += 16) {
+                    uint8x16_t p0 = vld1q_u8(row0 + x), p1 = vld1q_u8(row1 + x);
+                    vst1q_u8(row0 + x, vmaxq_u8(p0, p1));
+                }
+                #endif
+
                 #if defined(ARM_MATH_DSP)
                 for (; (img->w - x) >= 4; x += 4) {
                     uint32_t p0 = *((uint32_t *) (row0 + x));
@@ -609,6 +692,13 @@ static void imlib_max_line_op(image_t *img, int line, void *other, void *data, b
 
             if (!mask) {
                 size_t x = 0;
+                #if defined(IMLIB_ENABLE_HELIUM)
+                for (; (img->w - x) >= 8; x += 8) {
+                    uint16x8_t p0 = vld1q_u16(row0 + x), p1 = vld1q_u16(row1 + x);
+                    vst1q_u16(row0 + x, MVE_RGB565_FIELD_OP(vmaxq_u16, p0, p1));
+                }
+                #endif
+
                 #if defined(ARM_MATH_DSP)
                 for (; (img->w - x) >= 2; x += 2) {
                     uint32_t p0 = *((uint32_t *) (row0 + x));
@@ -652,7 +742,7 @@ static void imlib_max_line_op(image_t *img, int line, void *other, void *data, b
 }
 
 void imlib_max(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_max_line_op, mask);
+    imlib_image_operation_mask(img, path, other, scalar, imlib_max_line_op, NULL, mask);
 }
 
 static void imlib_difference_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -669,6 +759,13 @@ static void imlib_difference_line_op(image_t *img, int line, void *other, void *
 
             if (!mask) {
                 size_t x = 0;
+                #if defined(IMLIB_ENABLE_HELIUM)
+                for (; (img->w - x) >= 16; x += 16) {
+                    uint8x16_t p0 = vld1q_u8(row0 + x), p1 = vld1q_u8(row1 + x);
+                    vst1q_u8(row0 + x, vabdq_u8(p0, p1));
+                }
+                #endif
+
                 #if defined(ARM_MATH_DSP)
                 for (; (img->w - x) >= 4; x += 4) {
                     uint32_t p0 = *((uint32_t *) (row0 + x));
@@ -703,6 +800,13 @@ static void imlib_difference_line_op(image_t *img, int line, void *other, void *
 
             if (!mask) {
                 size_t x = 0;
+                #if defined(IMLIB_ENABLE_HELIUM)
+                for (; (img->w - x) >= 8; x += 8) {
+                    uint16x8_t p0 = vld1q_u16(row0 + x), p1 = vld1q_u16(row1 + x);
+                    vst1q_u16(row0 + x, MVE_RGB565_FIELD_OP(vabdq_u16, p0, p1));
+                }
+                #endif
+
                 #if defined(ARM_MATH_DSP)
                 for (; (img->w - x) >= 2; x += 2) {
                     uint32_t p0 = *((uint32_t *) (row0 + x));
@@ -748,16 +852,18 @@ static void imlib_difference_line_op(image_t *img, int line, void *other, void *
 }
 
 void imlib_difference(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_difference_line_op,  mask);
+    imlib_image_operation_mask(img, path, other, scalar, imlib_difference_line_op, NULL, mask);
 }
 
 typedef struct imlib_blend_line_op_state {
-    float alpha;
+    int alpha;
     image_t *mask;
 } imlib_blend_line_op_t;
 
+// The alpha is a 0-256 weight, so each blended channel is ((p0 * alpha) + (p1 * beta)) >> 8.
+// Channels are kept in 16-bit lanes, two per word, which can't overflow since alpha + beta = 256.
 static void imlib_blend_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
-    float alpha = ((imlib_blend_line_op_t *) data)->alpha, beta = 1 - alpha;
+    uint32_t alpha = ((imlib_blend_line_op_t *) data)->alpha, beta = 256 - alpha;
     image_t *mask = ((imlib_blend_line_op_t *) data)->mask;
 
     switch (img->pixfmt) {
@@ -765,36 +871,66 @@ static void imlib_blend_line_op(image_t *img, int line, void *other, void *data,
             uint32_t *data = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, line);
             for (int i = 0, j = img->w; i < j; i++) {
                 if ((!mask) || image_get_mask_pixel(mask, i, line)) {
-                    int dataPixel = IMAGE_GET_BINARY_PIXEL_FAST(data, i);
-                    int otherPixel = IMAGE_GET_BINARY_PIXEL_FAST(((uint32_t *) other), i);
-                    int p = (dataPixel * alpha) + (otherPixel * beta);
+                    uint32_t dataPixel = IMAGE_GET_BINARY_PIXEL_FAST(data, i);
+                    uint32_t otherPixel = IMAGE_GET_BINARY_PIXEL_FAST(((uint32_t *) other), i);
+                    uint32_t p = ((dataPixel * alpha) + (otherPixel * beta)) >> 8;
                     IMAGE_PUT_BINARY_PIXEL_FAST(data, i, p);
                 }
             }
             break;
         }
         case PIXFORMAT_GRAYSCALE: {
-            uint8_t *data = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, line);
-            for (int i = 0, j = img->w; i < j; i++) {
-                if ((!mask) || image_get_mask_pixel(mask, i, line)) {
-                    int dataPixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(data, i);
-                    int otherPixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(((uint8_t *) other), i);
-                    int p = (dataPixel * alpha) + (otherPixel * beta);
-                    IMAGE_PUT_GRAYSCALE_PIXEL_FAST(data, i, p);
+            uint8_t *row0 = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, line);
+            uint8_t *row1 = (uint8_t *) other;
+            size_t x = 0;
+
+            if (!mask) {
+                for (; (img->w - x) >= 4; x += 4) {
+                    uint32_t p0 = *((uint32_t *) (row0 + x));
+                    uint32_t p1 = *((uint32_t *) (row1 + x));
+                    uint32_t p02 = (((p0 & 0xff00ff) * alpha) + ((p1 & 0xff00ff) * beta)) >> 8;
+                    uint32_t p13 = ((((p0 >> 8) & 0xff00ff) * alpha) + (((p1 >> 8) & 0xff00ff) * beta)) >> 8;
+                    *((uint32_t *) (row0 + x)) = (p02 & 0xff00ff) | ((p13 & 0xff00ff) << 8);
+                }
+            }
+
+            for (; x < img->w; x++) {
+                if ((!mask) || image_get_mask_pixel(mask, x, line)) {
+                    uint32_t p0 = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row0, x);
+                    uint32_t p1 = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row1, x);
+                    uint32_t p = ((p0 * alpha) + (p1 * beta)) >> 8;
+                    IMAGE_PUT_GRAYSCALE_PIXEL_FAST(row0, x, p);
                 }
             }
             break;
         }
         case PIXFORMAT_RGB565: {
-            uint16_t *data = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, line);
-            for (int i = 0, j = img->w; i < j; i++) {
-                if ((!mask) || image_get_mask_pixel(mask, i, line)) {
-                    int dataPixel = IMAGE_GET_RGB565_PIXEL_FAST(data, i);
-                    int otherPixel = IMAGE_GET_RGB565_PIXEL_FAST(((uint16_t *) other), i);
-                    int r = (COLOR_RGB565_TO_R5(dataPixel) * alpha) + (COLOR_RGB565_TO_R5(otherPixel) * beta);
-                    int g = (COLOR_RGB565_TO_G6(dataPixel) * alpha) + (COLOR_RGB565_TO_G6(otherPixel) * beta);
-                    int b = (COLOR_RGB565_TO_B5(dataPixel) * alpha) + (COLOR_RGB565_TO_B5(otherPixel) * beta);
-                    IMAGE_PUT_RGB565_PIXEL_FAST(data, i, COLOR_R5_G6_B5_TO_RGB565(r, g, b));
+            uint16_t *row0 = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, line);
+            uint16_t *row1 = (uint16_t *) other;
+            size_t x = 0;
+
+            if (!mask) {
+                for (; (img->w - x) >= 2; x += 2) {
+                    uint32_t p0 = *((uint32_t *) (row0 + x));
+                    uint32_t p1 = *((uint32_t *) (row1 + x));
+                    uint32_t r = (((p0 >> 11) & 0x1f001f) * alpha) + (((p1 >> 11) & 0x1f001f) * beta);
+                    uint32_t g = (((p0 >> 5) & 0x3f003f) * alpha) + (((p1 >> 5) & 0x3f003f) * beta);
+                    uint32_t b = ((p0 & 0x1f001f) * alpha) + ((p1 & 0x1f001f) * beta);
+                    r = (r >> 8) & 0x1f001f;
+                    g = (g >> 8) & 0x3f003f;
+                    b = (b >> 8) & 0x1f001f;
+                    *((uint32_t *) (row0 + x)) = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
+                }
+            }
+
+            for (; x < img->w; x++) {
+                if ((!mask) || image_get_mask_pixel(mask, x, line)) {
+                    uint32_t p0 = IMAGE_GET_RGB565_PIXEL_FAST(row0, x);
+                    uint32_t p1 = IMAGE_GET_RGB565_PIXEL_FAST(row1, x);
+                    uint32_t r = ((COLOR_RGB565_TO_R5(p0) * alpha) + (COLOR_RGB565_TO_R5(p1) * beta)) >> 8;
+                    uint32_t g = ((COLOR_RGB565_TO_G6(p0) * alpha) + (COLOR_RGB565_TO_G6(p1) * beta)) >> 8;
+                    uint32_t b = ((COLOR_RGB565_TO_B5(p0) * alpha) + (COLOR_RGB565_TO_B5(p1) * beta)) >> 8;
+                    IMAGE_PUT_RGB565_PIXEL_FAST(row0, x, COLOR_R5_G6_B5_TO_RGB565(r, g, b));
                 }
             }
             break;
@@ -807,8 +943,8 @@ static void imlib_blend_line_op(image_t *img, int line, void *other, void *data,
 
 void imlib_blend(image_t *img, const char *path, image_t *other, int scalar, float alpha, image_t *mask) {
     imlib_blend_line_op_t state;
-    state.alpha = alpha;
-    state.mask = mask;
-    imlib_image_operation(img, path, other, scalar, imlib_blend_line_op, &state);
+    state.alpha = fast_roundf(alpha * 256);
+    state.mask = NULL;
+    imlib_image_operation_mask(img, path, other, scalar, imlib_blend_line_op, &state, mask);
 }
 #endif //IMLIB_ENABLE_MATH_OPS
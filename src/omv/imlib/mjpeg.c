@@ -13,24 +13,47 @@
 
 #include "file_utils.h"
 
+// The file is an OpenDML (AVI 2.0) file: the frames are indexed by standard index chunks
+// (ix00) written in the movi list every INDEX_SIZE frames, and a super index (indx) in the
+// header points to them. The first RIFF chunk also gets an idx1 index for older players,
+// and past RIFF_SIZE the frames go into AVIX RIFF chunks. Frames are only ever appended,
+// the header is updated by mjpeg_sync()/mjpeg_close() and when a RIFF chunk ends.
+#define RIFF_SIZE           (1024 * 1024 * 1024)
+#define INDEX_SIZE          (1024)
+#define SUPER_INDEX_SIZE    (1024)
+#define SUPER_INDEX_GROW    (16)
+
+#define AVIF_HASINDEX       (0x10)
+#define AVIIF_KEYFRAME      (0x10)
+#define AVI_INDEX_OF_INDEXES (0x00)
+#define AVI_INDEX_OF_CHUNKS (0x01)
+#define INDEX_HEADER_SIZE   (32)
+
 #define SIZE_OFFSET         (1 * 4)
 #define MICROS_OFFSET       (8 * 4)
-#define FRAMES_OFFSET       (12 * 4)
 #define RATE_0_OFFSET       (19 * 4)
 #define LENGTH_0_OFFSET     (21 * 4)
 #define RATE_1_OFFSET       (33 * 4)
 #define LENGTH_1_OFFSET     (35 * 4)
-#define MOVI_OFFSET         (54 * 4)
+#define INDX_COUNT_OFFSET   (56 * 4)
+#define INDX_OFFSET         (61 * 4)
+#define ODML_OFFSET         (INDX_OFFSET + (SUPER_INDEX_SIZE * 16))
+#define DMLH_FRAMES_OFFSET  (ODML_OFFSET + (5 * 4))
+#define MOVI_OFFSET         (ODML_OFFSET + (67 * 4))
 
 #define TIME_SCALE          (1000)
 
-void mjpeg_open(FIL *fp, int width, int height) {
+void mjpeg_open(FIL *fp, mjpeg_t *mjpeg, int width, int height) {
+    memset(mjpeg, 0, sizeof(mjpeg_t));
+    mjpeg->movi_offset = MOVI_OFFSET;
+    mjpeg->index = xalloc(INDEX_SIZE * 2 * sizeof(uint32_t));
+
     file_write(fp, "RIFF", 4); // FOURCC fcc; - 0
     file_write_long(fp, 0); // DWORD cb; size - updated on close - 1
     file_write(fp, "AVI ", 4); // FOURCC fcc; - 2
 
     file_write(fp, "LIST", 4); // FOURCC fcc; - 3
-    file_write_long(fp, 192); // DWORD cb; - 4
+    file_write_long(fp, 492 + (SUPER_INDEX_SIZE * 16)); // DWORD cb; - 4
     file_write(fp, "hdrl", 4); // FOURCC fcc; - 5
 
     file_write(fp, "avih", 4); // FOURCC fcc; - 6
@@ -38,8 +61,8 @@ void mjpeg_open(FIL *fp, int width, int height) {
     file_write_long(fp, 0); // DWORD dwMicroSecPerFrame; micros - updated on close - 8
     file_write_long(fp, 0); // DWORD dwMaxBytesPerSec; updated on close - 9
     file_write_long(fp, 4); // DWORD dwPaddingGranularity; - 10
-    file_write_long(fp, 0); // DWORD dwFlags; - 11
-    file_write_long(fp, 0); // DWORD dwTotalFrames; frames - updated on close - 12
+    file_write_long(fp, 0); // DWORD dwFlags; flags - updated on close - 11
+    file_write_long(fp, 0); // DWORD dwTotalFrames; frames (first RIFF) - updated on close - 12
     file_write_long(fp, 0); // DWORD dwInitialFrames; - 13
     file_write_long(fp, 1); // DWORD dwStreams; - 14
     file_write_long(fp, 0); // DWORD dwSuggestedBufferSize; - 15
@@ -51,7 +74,7 @@ void mjpeg_open(FIL *fp, int width, int height) {
     file_write_long(fp, 0); // DWORD dwLength; length - updated on close - 21
 
     file_write(fp, "LIST", 4); // FOURCC fcc; - 22
-    file_write_long(fp, 116); // DWORD cb; - 23
+    file_write_long(fp, 148 + (SUPER_INDEX_SIZE * 16)); // DWORD cb; - 23
     file_write(fp, "strl", 4); // FOURCC fcc; - 24
 
     file_write(fp, "strh", 4); // FOURCC fcc; - 25
@@ -88,12 +111,168 @@ void mjpeg_open(FIL *fp, int width, int height) {
     file_write_long(fp, 0); // DWORD biClrUsed; - 51
     file_write_long(fp, 0); // DWORD biClrImportant; - 52
 
-    file_write(fp, "LIST", 4); // FOURCC fcc; - 53
-    file_write_long(fp, 0); // DWORD cb; movi - updated on close - 54
-    file_write(fp, "movi", 4); // FOURCC fcc; - 55
+    file_write(fp, "indx", 4); // FOURCC fcc; - 53
+    file_write_long(fp, 24 + (SUPER_INDEX_SIZE * 16)); // DWORD cb; - 54
+    file_write_short(fp, 4); // WORD wLongsPerEntry; - 55
+    file_write_byte(fp, 0); // BYTE bIndexSubType; - 55.5
+    file_write_byte(fp, AVI_INDEX_OF_INDEXES); // BYTE bIndexType; - 55.75
+    file_write_long(fp, 0); // DWORD nEntriesInUse; index chunks - updated on close - 56
+    file_write(fp, "00dc", 4); // DWORD dwChunkId; - 57
+    file_write_long(fp, 0); // DWORD dwReserved[3]; - 58
+    file_write_long(fp, 0); // - 59
+    file_write_long(fp, 0); // - 60
+
+    // QWORD qwOffset; DWORD dwSize; DWORD dwDuration; - updated on close - 61
+    for (int i = 0; i < SUPER_INDEX_SIZE; i++) {
+        file_write(fp, "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 16);
+    }
+
+    // Longs below are counted from ODML_OFFSET.
+    file_write(fp, "LIST", 4); // FOURCC fcc; - 0
+    file_write_long(fp, 260); // DWORD cb; - 1
+    file_write(fp, "odml", 4); // FOURCC fcc; - 2
+
+    file_write(fp, "dmlh", 4); // FOURCC fcc; - 3
+    file_write_long(fp, 248); // DWORD cb; - 4
+    file_write_long(fp, 0); // DWORD dwTotalFrames; frames - updated on close - 5
+
+    for (int i = 6; i < 67; i++) {
+        file_write_long(fp, 0); // DWORD dwFuture[61]; - 6
+    }
+
+    file_write(fp, "LIST", 4); // FOURCC fcc; - 67
+    file_write_long(fp, 0); // DWORD cb; movi - updated on close - 68
+    file_write(fp, "movi", 4); // FOURCC fcc; - 69
+}
+
+// Writes the standard index chunk of the frames after the last one, if the super index
+// is full the frames are left out of the index (the super index covers over a million).
+static void mjpeg_write_index(FIL *fp, mjpeg_t *mjpeg) {
+    if (mjpeg->index_count && (mjpeg->super_count < SUPER_INDEX_SIZE)) {
+        if ((mjpeg->super_count % SUPER_INDEX_GROW) == 0) {
+            mjpeg->super_index = xrealloc(mjpeg->super_index,
+                                          (mjpeg->super_count + SUPER_INDEX_GROW) * 3 * sizeof(uint32_t));
+        }
+
+        uint32_t *entry = mjpeg->super_index + (mjpeg->super_count++ * 3);
+        entry[0] = file_tell(fp);
+        entry[1] = INDEX_HEADER_SIZE + (mjpeg->index_count * 8);
+        entry[2] = mjpeg->index_count;
+
+        file_write(fp, "ix00", 4); // FOURCC fcc;
+        file_write_long(fp, entry[1] - 8); // DWORD cb;
+        file_write_short(fp, 2); // WORD wLongsPerEntry;
+        file_write_byte(fp, 0); // BYTE bIndexSubType;
+        file_write_byte(fp, AVI_INDEX_OF_CHUNKS); // BYTE bIndexType;
+        file_write_long(fp, mjpeg->index_count); // DWORD nEntriesInUse;
+        file_write(fp, "00dc", 4); // DWORD dwChunkId;
+        file_write_long(fp, mjpeg->movi_offset + 8); // QWORD qwBaseOffset;
+        file_write_long(fp, 0);
+        file_write_long(fp, 0); // DWORD dwReserved3;
+        file_write(fp, mjpeg->index, mjpeg->index_count * 8);
+    }
+
+    mjpeg->index_count = 0;
+}
+
+// Writes the idx1 index of the first RIFF chunk from its standard index chunks.
+static void mjpeg_write_idx1(FIL *fp, mjpeg_t *mjpeg) {
+    uint32_t count = 0, position = file_tell(fp);
+
+    for (uint32_t i = 0; i < mjpeg->super_count; i++) {
+        count += mjpeg->super_index[(i * 3) + 2];
+    }
+
+    file_write(fp, "idx1", 4); // FOURCC fcc;
+    file_write_long(fp, count * 16); // DWORD cb;
+    position += 8;
+
+    for (uint32_t i = 0; i < mjpeg->super_count; i++) {
+        uint32_t *entry = mjpeg->super_index + (i * 3), entries[64 * 4];
+        file_seek(fp, entry[0] + INDEX_HEADER_SIZE);
+        file_read(fp, mjpeg->index, entry[2] * 8);
+        file_seek(fp, position);
+
+        for (uint32_t j = 0; j < entry[2]; ) {
+            uint32_t n = IM_MIN(entry[2] - j, 64u);
+
+            for (uint32_t k = 0; k < n; k++, j++) {
+                memcpy(entries + (k * 4), "00dc", 4); // DWORD ckid;
+                entries[(k * 4) + 1] = AVIIF_KEYFRAME; // DWORD dwFlags;
+                entries[(k * 4) + 2] = mjpeg->index[j * 2] - 8; // DWORD dwChunkOffset; - from movi
+                entries[(k * 4) + 3] = mjpeg->index[(j * 2) + 1]; // DWORD dwChunkLength;
+            }
+
+            file_write(fp, entries, n * 16);
+            position += n * 16;
+        }
+    }
+
+    mjpeg->has_idx1 = true;
+}
+
+// Updates the sizes of the current RIFF chunk and of its movi list.
+static void mjpeg_write_riff_size(FIL *fp, mjpeg_t *mjpeg, uint32_t movi_end, uint32_t riff_end) {
+    file_seek(fp, mjpeg->riff_offset + SIZE_OFFSET);
+    file_write_long(fp, riff_end - mjpeg->riff_offset - 8);
+    file_seek(fp, mjpeg->movi_offset + SIZE_OFFSET);
+    file_write_long(fp, movi_end - mjpeg->movi_offset - 8);
+}
+
+// Ends the current RIFF chunk and starts an AVIX RIFF chunk.
+static void mjpeg_write_riff(FIL *fp, mjpeg_t *mjpeg) {
+    mjpeg_write_index(fp, mjpeg);
+    uint32_t movi_end = file_tell(fp);
+
+    if (!mjpeg->has_idx1) {
+        mjpeg_write_idx1(fp, mjpeg);
+        mjpeg->avi_frames = mjpeg->frames;
+    }
+
+    uint32_t riff_end = file_tell(fp);
+    mjpeg_write_riff_size(fp, mjpeg, movi_end, riff_end);
+    file_seek(fp, riff_end);
+
+    mjpeg->riff_offset = riff_end;
+    mjpeg->movi_offset = riff_end + 12;
+    mjpeg->riff_start = mjpeg->frames;
+
+    file_write(fp, "RIFF", 4); // FOURCC fcc;
+    file_write_long(fp, 0); // DWORD cb; size - updated on close
+    file_write(fp, "AVIX", 4); // FOURCC fcc;
+    file_write(fp, "LIST", 4); // FOURCC fcc;
+    file_write_long(fp, 0); // DWORD cb; movi - updated on close
+    file_write(fp, "movi", 4); // FOURCC fcc;
 }
 
-void mjpeg_write(FIL *fp, int width, int height, uint32_t *frames, uint32_t *bytes,
+static void mjpeg_write_frame(FIL *fp, mjpeg_t *mjpeg, const void *data, uint32_t size) {
+    // Room for the frame, its index chunk and the idx1 index (in the first RIFF chunk).
+    uint32_t riff_size = file_tell(fp) - mjpeg->riff_offset + 8 + size +
+                         INDEX_HEADER_SIZE + ((mjpeg->index_count + 1) * 8) +
+                         (mjpeg->has_idx1 ? 0 : (8 + ((mjpeg->frames + 1) * 16)));
+
+    if ((riff_size > RIFF_SIZE) && (mjpeg->frames > mjpeg->riff_start)) {
+        mjpeg_write_riff(fp, mjpeg);
+    }
+
+    uint32_t position = file_tell(fp);
+    mjpeg->index[(mjpeg->index_count * 2) + 0] = position + 8 - (mjpeg->movi_offset + 8);
+    mjpeg->index[(mjpeg->index_count * 2) + 1] = size;
+    mjpeg->index_count += 1;
+
+    file_write(fp, "00dc", 4); // FOURCC fcc;
+    file_write_long(fp, size); // DWORD cb;
+    file_write(fp, data, size); // reading past okay
+
+    mjpeg->frames += 1;
+    mjpeg->bytes += size;
+
+    if (mjpeg->index_count == INDEX_SIZE) {
+        mjpeg_write_index(fp, mjpeg);
+    }
+}
+
+void mjpeg_write(FIL *fp, mjpeg_t *mjpeg, int width, int height,
                  image_t *img, int quality, rectangle_t *roi, int rgb_channel, int alpha,
                  const uint16_t *color_palette, const uint8_t *alpha_palette, image_hint_t hint) {
     float xscale = width / ((float) roi->w);
@@ -187,35 +366,26 @@ void mjpeg_write(FIL *fp, int width, int height, uint32_t *frames, uint32_t *byt
         dst_img.data = img->data;
     }
 
-    uint32_t size_padded = (((dst_img.size + 3) / 4) * 4);
-    file_write(fp, "00dc", 4); // FOURCC fcc;
-    file_write_long(fp, size_padded); // DWORD cb;
-    file_write(fp, dst_img.data, size_padded); // reading past okay
-
-    *frames += 1;
-    *bytes += size_padded;
-
+    mjpeg_write_frame(fp, mjpeg, dst_img.data, ((dst_img.size + 3) / 4) * 4);
     fb_alloc_free_till_mark();
 }
 
-void mjpeg_sync(FIL *fp, uint32_t frames, uint32_t bytes, uint32_t us_avg) {
-    uint32_t position = f_tell(fp);
+// Updates the headers, the frames after the last index chunk are indexed when it's written.
+static void mjpeg_write_header(FIL *fp, mjpeg_t *mjpeg, uint32_t us_avg) {
     // size of all mjpeg headers and jpegs.
-    uint32_t datasize = (frames * 8) + bytes;
+    uint32_t datasize = (mjpeg->frames * 8) + mjpeg->bytes;
     // frames_per_second == rate / scale
     uint32_t rate = IM_DIV((1000000 * TIME_SCALE), us_avg);
     // video length == frames / frames_per_second
-    uint32_t length = IM_DIV((((uint64_t) frames) * TIME_SCALE), rate);
-    // Needed
-    file_seek(fp, SIZE_OFFSET);
-    file_write_long(fp, 216 + datasize);
+    uint32_t length = IM_DIV((((uint64_t) mjpeg->frames) * TIME_SCALE), rate);
     // Needed
     file_seek(fp, MICROS_OFFSET);
     file_write_long(fp, us_avg);
-    file_write_long(fp, IM_DIV((((uint64_t) datasize) * us_avg), frames));
-    // Needed
-    file_seek(fp, FRAMES_OFFSET);
-    file_write_long(fp, frames);
+    file_write_long(fp, IM_DIV((((uint64_t) datasize) * us_avg), mjpeg->frames));
+    file_write_long(fp, 4);
+    file_write_long(fp, mjpeg->has_idx1 ? AVIF_HASINDEX : 0);
+    // Needed - frames in the first RIFF chunk.
+    file_write_long(fp, mjpeg->riff_offset ? mjpeg->avi_frames : mjpeg->frames);
     // Probably not needed but writing it just in case.
     file_seek(fp, RATE_0_OFFSET);
     file_write_long(fp, rate);
@@ -228,15 +398,45 @@ void mjpeg_sync(FIL *fp, uint32_t frames, uint32_t bytes, uint32_t us_avg) {
     // Probably not needed but writing it just in case.
     file_seek(fp, LENGTH_1_OFFSET);
     file_write_long(fp, length);
+    // Needed - the index chunks written since the last update.
+    file_seek(fp, INDX_COUNT_OFFSET);
+    file_write_long(fp, mjpeg->super_count);
+    file_seek(fp, INDX_OFFSET + (mjpeg->super_synced * 16));
+
+    for (; mjpeg->super_synced < mjpeg->super_count; mjpeg->super_synced++) {
+        uint32_t *entry = mjpeg->super_index + (mjpeg->super_synced * 3);
+        file_write_long(fp, entry[0]);
+        file_write_long(fp, 0);
+        file_write_long(fp, entry[1]);
+        file_write_long(fp, entry[2]);
+    }
+
     // Needed
-    file_seek(fp, MOVI_OFFSET);
-    file_write_long(fp, 4 + datasize);
+    file_seek(fp, DMLH_FRAMES_OFFSET);
+    file_write_long(fp, mjpeg->frames);
+}
+
+void mjpeg_sync(FIL *fp, mjpeg_t *mjpeg, uint32_t us_avg) {
+    uint32_t position = file_tell(fp);
+    mjpeg_write_header(fp, mjpeg, us_avg);
+    mjpeg_write_riff_size(fp, mjpeg, position, position);
     file_sync(fp);
     file_seek(fp, position);
 }
 
-void mjpeg_close(FIL *fp, uint32_t frames, uint32_t bytes, uint32_t us_avg) {
-    mjpeg_sync(fp, frames, bytes, us_avg);
+void mjpeg_close(FIL *fp, mjpeg_t *mjpeg, uint32_t us_avg) {
+    mjpeg_write_index(fp, mjpeg);
+    uint32_t movi_end = file_tell(fp);
+
+    if (!mjpeg->has_idx1) {
+        mjpeg_write_idx1(fp, mjpeg);
+    }
+
+    uint32_t riff_end = file_tell(fp);
+    mjpeg_write_header(fp, mjpeg, us_avg);
+    mjpeg_write_riff_size(fp, mjpeg, movi_end, riff_end);
+    // Preallocated files are truncated to the current position.
+    file_seek(fp, riff_end);
     file_close(fp);
 }
 
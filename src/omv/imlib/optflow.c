@@ -0,0 +1,241 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Optical flow between the image pyramids of two frames.
+ *
+ * Sparse flow tracks points with pyramidal Lucas-Kanade (see Jean-Yves Bouguet's "Pyramidal
+ * Implementation of the Lucas Kanade Feature Tracker"), dense flow block matches a grid of
+ * blocks on one of the smaller levels. Patches are sampled and compared in fixed-point.
+ */
+#include "imlib.h"
+
+#ifdef IMLIB_ENABLE_OPTICAL_FLOW
+#define LK_MAX_WINDOW       (15)
+#define LK_MIN_EIGEN        (1.0f)  // Smallest eigenvalue of the gradient matrix per pixel.
+#define LK_EPSILON          (0.01f) // Iterations stop once an update is smaller (pixels).
+#define LK_WEIGHT_BITS      (8)     // Bilinear weights, patches are in Q2.
+#define LK_PATCH_SHIFT      ((2 * LK_WEIGHT_BITS) - 2)
+
+// Samples the size x size patch of img centered at (x, y) with bilinear interpolation into Q2.
+// Pixels outside of the image repeat the edges.
+static void optflow_patch(image_t *img, float x, float y, int size, int16_t *patch) {
+    float x0 = x - (size / 2), y0 = y - (size / 2);
+    int ix = fast_floorf(x0), iy = fast_floorf(y0);
+    int ax = fast_roundf((x0 - ix) * (1 << LK_WEIGHT_BITS));
+    int ay = fast_roundf((y0 - iy) * (1 << LK_WEIGHT_BITS));
+    int w00 = ((1 << LK_WEIGHT_BITS) - ax) * ((1 << LK_WEIGHT_BITS) - ay);
+    int w01 = ax * ((1 << LK_WEIGHT_BITS) - ay);
+    int w10 = ((1 << LK_WEIGHT_BITS) - ax) * ay;
+    int w11 = ax * ay;
+    bool inside = (ix >= 0) && (iy >= 0) && ((ix + size) < img->w) && ((iy + size) < img->h);
+
+    for (int j = 0; j < size; j++) {
+        int y_0 = inside ? (iy + j) : IM_CLAMP(iy + j, 0, img->h - 1);
+        int y_1 = inside ? (iy + j + 1) : IM_CLAMP(iy + j + 1, 0, img->h - 1);
+        uint8_t *row_0 = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y_0);
+        uint8_t *row_1 = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y_1);
+
+        for (int i = 0; i < size; i++) {
+            int x_0 = inside ? (ix + i) : IM_CLAMP(ix + i, 0, img->w - 1);
+            int x_1 = inside ? (ix + i + 1) : IM_CLAMP(ix + i + 1, 0, img->w - 1);
+            int sum = (row_0[x_0] * w00) + (row_0[x_1] * w01) + (row_1[x_0] * w10) + (row_1[x_1] * w11);
+            *patch++ = (sum + (1 << (LK_PATCH_SHIFT - 1))) >> LK_PATCH_SHIFT;
+        }
+    }
+}
+
+// Tracks one point from level prev to level next, starting from the guess (gx, gy). Returns
+// false if the point can't be tracked.
+static bool optflow_lk_level(image_t *prev, image_t *next, float x, float y, int window, int iterations,
+                             float *gx, float *gy, int16_t *buf) {
+    int size = window + 2;
+    int n = window * window;
+    int16_t *patch = buf;
+    int16_t *ix = patch + (size * size);
+    int16_t *iy = ix + n;
+    int16_t *i0 = iy + n;
+    int16_t *j0 = i0 + n;
+
+    // Gradients of the previous frame over the window (from a patch with a 1 pixel border).
+    optflow_patch(prev, x, y, size, patch);
+
+    int32_t gxx = 0, gxy = 0, gyy = 0;
+    for (int j = 0, k = 0; j < window; j++) {
+        int16_t *row = patch + ((j + 1) * size) + 1;
+        for (int i = 0; i < window; i++, k++) {
+            ix[k] = (row[i + 1] - row[i - 1]) >> 1;
+            iy[k] = (row[i + size] - row[i - size]) >> 1;
+            i0[k] = row[i];
+            gxx += ix[k] * ix[k];
+            gxy += ix[k] * iy[k];
+            gyy += iy[k] * iy[k];
+        }
+    }
+
+    // The gradient matrix is Q4, flat or single edge windows can't be tracked.
+    float a = gxx, b = gxy, c = gyy;
+    float min_eigen = ((a + c) - fast_sqrtf(((a - c) * (a - c)) + (4.0f * b * b))) / 2.0f;
+    if (min_eigen < (LK_MIN_EIGEN * n * 16.0f)) {
+        return false;
+    }
+
+    float det = (a * c) - (b * b);
+    float vx = 0.0f, vy = 0.0f;
+
+    for (int iter = 0; iter < iterations; iter++) {
+        float nx = x + *gx + vx, ny = y + *gy + vy;
+        if ((nx < 0.0f) || (ny < 0.0f) || (nx >= next->w) || (ny >= next->h)) {
+            return false;
+        }
+
+        optflow_patch(next, nx, ny, window, j0);
+
+        int32_t bx = 0, by = 0;
+        for (int k = 0; k < n; k++) {
+            int d = i0[k] - j0[k];
+            bx += d * ix[k];
+            by += d * iy[k];
+        }
+
+        float dx = ((c * bx) - (b * by)) / det;
+        float dy = ((a * by) - (b * bx)) / det;
+        vx += dx;
+        vy += dy;
+
+        if (((dx * dx) + (dy * dy)) < (LK_EPSILON * LK_EPSILON)) {
+            break;
+        }
+    }
+
+    *gx += vx;
+    *gy += vy;
+    return true;
+}
+
+void imlib_optflow_lk(image_pyramid_t *prev, image_pyramid_t *next, flow_vector_t *vectors, int n,
+                      int window, int iterations) {
+    int n_levels = IM_MIN(prev->n_levels, next->n_levels);
+    window = IM_CLAMP(window | 1, 3, LK_MAX_WINDOW);
+
+    int16_t *buf = fb_alloc((((window + 2) * (window + 2)) + (window * window * 4)) * sizeof(int16_t),
+                            FB_ALLOC_NO_HINT);
+
+    for (int i = 0; i < n; i++) {
+        flow_vector_t *v = &vectors[i];
+        float gx = 0.0f, gy = 0.0f;
+        v->valid = true;
+
+        // Coarse to fine, the flow found on a level is the guess for the next bigger one.
+        for (int l = n_levels - 1; l >= 0; l--) {
+            image_t *prev_l = &prev->levels[l];
+            image_t *next_l = &next->levels[l];
+            float sx = prev_l->w / (float) prev->levels[0].w;
+            float sy = prev_l->h / (float) prev->levels[0].h;
+
+            if (!optflow_lk_level(prev_l, next_l, v->x * sx, v->y * sy, window, iterations, &gx, &gy, buf)) {
+                v->valid = false;
+                break;
+            }
+
+            if (l) {
+                gx *= prev->levels[l - 1].w / (float) prev_l->w;
+                gy *= prev->levels[l - 1].h / (float) prev_l->h;
+            }
+        }
+
+        v->dx = v->valid ? gx : 0.0f;
+        v->dy = v->valid ? gy : 0.0f;
+    }
+
+    fb_free(); // buf
+}
+
+// Sum of absolute differences between the block x block patches at a and b.
+static inline uint32_t optflow_sad(uint8_t *a, uint8_t *b, int stride, int block) {
+    uint32_t sad = 0;
+
+    for (int j = 0; j < block; j++, a += stride, b += stride) {
+        int i = 0;
+        #if defined(ARM_MATH_DSP)
+        for (; (i + 4) <= block; i += 4) {
+            sad = __USADA8(*((uint32_t *) (a + i)), *((uint32_t *) (b + i)), sad);
+        }
+        #endif
+        for (; i < block; i++) {
+            sad += abs(a[i] - b[i]);
+        }
+    }
+
+    return sad;
+}
+
+// Offset of the minimum of the parabola through 3 costs around the best one.
+static float optflow_subpixel(uint32_t c0, uint32_t c1, uint32_t c2) {
+    int den = c0 - (2 * c1) + c2;
+    return ((c0 >= c1) && (c2 >= c1) && (den > 0)) ? (((int) c0 - (int) c2) / (2.0f * den)) : 0.0f;
+}
+
+int imlib_optflow_block(image_pyramid_t *prev, image_pyramid_t *next, int level, int block, int search,
+                        flow_vector_t *vectors, int max_n) {
+    level = IM_CLAMP(level, 0, IM_MIN(prev->n_levels, next->n_levels) - 1);
+    image_t *prev_l = &prev->levels[level];
+    image_t *next_l = &next->levels[level];
+    float sx = prev->levels[0].w / (float) prev_l->w;
+    float sy = prev->levels[0].h / (float) prev_l->h;
+    int n_search = (search * 2) + 1;
+    int n = 0;
+
+    uint32_t *costs = fb_alloc(n_search * n_search * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+
+    // Blocks are tiled over the part of the level where the whole search window fits.
+    for (int y = search; ((y + block + search) <= prev_l->h) && (n < max_n); y += block) {
+        for (int x = search; ((x + block + search) <= prev_l->w) && (n < max_n); x += block) {
+            uint8_t *a = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(prev_l, y) + x;
+            uint32_t min_sad = UINT32_MAX;
+            int min_dx = 0, min_dy = 0;
+
+            for (int dy = -search; dy <= search; dy++) {
+                uint8_t *b = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(next_l, y + dy) + x;
+                for (int dx = -search; dx <= search; dx++) {
+                    uint32_t sad = optflow_sad(a, b + dx, prev_l->w, block);
+                    costs[((dy + search) * n_search) + dx + search] = sad;
+
+                    // Ties keep the smallest motion.
+                    if ((sad < min_sad) ||
+                        ((sad == min_sad) && ((abs(dx) + abs(dy)) < (abs(min_dx) + abs(min_dy))))) {
+                        min_sad = sad;
+                        min_dx = dx;
+                        min_dy = dy;
+                    }
+                }
+            }
+
+            float fx = min_dx, fy = min_dy;
+            uint32_t *c = costs + ((min_dy + search) * n_search) + min_dx + search;
+
+            if (abs(min_dx) < search) {
+                fx += optflow_subpixel(c[-1], c[0], c[1]);
+            }
+
+            if (abs(min_dy) < search) {
+                fy += optflow_subpixel(c[-n_search], c[0], c[n_search]);
+            }
+
+            flow_vector_t *v = &vectors[n++];
+            v->x = (x + (block / 2.0f)) * sx;
+            v->y = (y + (block / 2.0f)) * sy;
+            v->dx = fx * sx;
+            v->dy = fy * sy;
+            v->valid = true;
+        }
+    }
+
+    fb_free(); // costs
+    return n;
+}
+#endif // IMLIB_ENABLE_OPTICAL_FLOW
@@ -37,6 +37,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -46,11 +47,21 @@
 #include "xalloc.h"
 #include "fb_alloc.h"
 #include "file_utils.h"
+#include "rsort.h"
 #ifdef IMLIB_ENABLE_FIND_KEYPOINTS
 
 #define PATCH_SIZE     (31) // 31x31 pixels
 #define KDESC_SIZE     (32) // 32 bytes
 #define MAX_KP_DIST    (KDESC_SIZE * 8)
+#define ORB_INDEX_TABLES    (KDESC_SIZE / 2) // One table per 16-bit substring
+#define ORB_INDEX_MIN_SIZE  (32) // Smaller sets are searched exhaustively
+#define KDESC_RECORD_SIZE   (10 + KDESC_SIZE) // x, y, score, octave and angle then the descriptor
+#define KDESC_RECORDS_MAX   (64) // Records read or written at a time
+
+typedef struct {
+    uint16_t score;
+    kp_t *kp;
+} kp_rank_t;
 
 typedef struct {
     int x;
@@ -321,11 +332,6 @@ const static int sample_pattern[256 * 4] = {
     -1, -6, 0, -11/*mean (0.127148), correlation (0.547401)*/
 };
 
-static int kpt_comp(const kp_t *kp1, const kp_t *kp2) {
-    // Descending order
-    return kp2->score - kp1->score;
-}
-
 static int comp_angle(image_t *img, kp_t *kp, float *a, float *b) {
     int step = img->w;
     int half_k = 31 / 2;
@@ -363,21 +369,9 @@ static int comp_angle(image_t *img, kp_t *kp, float *a, float *b) {
     return angle;
 }
 
-static void image_scale(image_t *src, image_t *dst) {
-    int x_ratio = (int) ((src->w << 16) / dst->w) + 1;
-    int y_ratio = (int) ((src->h << 16) / dst->h) + 1;
-
-    for (int y = 0; y < dst->h; y++) {
-        int sy = (y * y_ratio) >> 16;
-        for (int x = 0; x < dst->w; x++) {
-            int sx = (x * x_ratio) >> 16;
-            dst->pixels[y * dst->w + x] = IM_TO_GS_PIXEL(src, sx, sy);
-        }
-    }
-}
-
 array_t *orb_find_keypoints(image_t *img, bool normalized, int threshold,
-                            float scale_factor, int max_keypoints, corner_detector_t corner_detector, rectangle_t *roi) {
+                            float scale_factor, int max_keypoints, corner_detector_t corner_detector, rectangle_t *roi,
+                            image_pyramid_t *pyramid) {
     array_t *kpts;
     array_alloc(&kpts, xfree);
 
@@ -405,8 +399,18 @@ array_t *orb_find_keypoints(image_t *img, bool normalized, int threshold,
         }
 
         img_scaled.pixels = fb_alloc(img_scaled.w * img_scaled.h, FB_ALLOC_NO_HINT);
-        // Down scale image
-        image_scale(img, &img_scaled);
+
+        // Copy the level from the pyramid if it has one, else down scale the image.
+        image_t *level = NULL;
+        if (pyramid && (pyramid->scale_factor == scale_factor)) {
+            level = imlib_pyramid_get_level(pyramid, octave - 1);
+        }
+
+        if (level && (level->w == img_scaled.w) && (level->h == img_scaled.h)) {
+            memcpy(img_scaled.pixels, level->pixels, img_scaled.w * img_scaled.h);
+        } else {
+            imlib_pyramid_scale(img, &img_scaled);
+        }
 
         // Gaussian smooth the image before extracting keypoints
         imlib_sepconv3(&img_scaled, kernel_gauss_3, 1.0f / 16.0f, 0.0f);
@@ -506,9 +510,26 @@ array_t *orb_find_keypoints(image_t *img, bool normalized, int threshold,
         }
     }
 
-    // Sort keypoints by score and return top n keypoints
-    array_sort(kpts, (array_comp_t) kpt_comp);
-    if (array_length(kpts) > max_keypoints) {
+    // Select the top n keypoints by score, sorted in descending order.
+    int size = array_length(kpts);
+    if (size > 1) {
+        kp_rank_t *ranks = fb_alloc(size * sizeof(kp_rank_t), FB_ALLOC_NO_HINT);
+
+        for (int i = 0; i < size; i++) {
+            ranks[i].kp = array_at(kpts, i);
+            ranks[i].score = ranks[i].kp->score;
+        }
+
+        rsort_top_k(ranks, size, sizeof(kp_rank_t), offsetof(kp_rank_t, score), RSORT_KEY_U16, max_keypoints);
+
+        for (int i = 0; i < size; i++) {
+            kpts->data[i] = ranks[i].kp;
+        }
+
+        fb_free();
+    }
+
+    if (size > max_keypoints) {
         array_resize(kpts, max_keypoints);
     }
 
@@ -524,36 +545,132 @@ static inline uint32_t popcount(uint32_t i) {
     return (((i + (i >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
 }
 
-static kp_t *find_best_match(kp_t *kp1, array_t *kpts, int *dist_out1, int *dist_out2, int *index) {
-    kp_t *min_kp = NULL;
-    int min_dist1 = MAX_KP_DIST;
-    int min_dist2 = MAX_KP_DIST;
-    int kpts_size = array_length(kpts);
+static inline int kp_dist(kp_t *kp1, kp_t *kp2) {
+    uint32_t *desc1 = (uint32_t *) kp1->desc;
+    uint32_t *desc2 = (uint32_t *) kp2->desc;
+    #if defined(ARM_MATH_DSP)
+    // Same count as popcount(), with the 4 byte counts of each word summed by USADA8.
+    uint32_t dist = 0;
+    for (int m = 0; m < (KDESC_SIZE / 4); m++) {
+        uint32_t i = desc1[m] ^ desc2[m];
+        i = (i | (i >> 1)) & 0x55555555;
+        i = (i & 0x33333333) + ((i >> 2) & 0x33333333);
+        dist = __USADA8((i + (i >> 4)) & 0x0F0F0F0F, 0, dist);
+    }
+    return dist;
+    #else
+    int dist = 0;
+    for (int m = 0; m < (KDESC_SIZE / 4); m++) {
+        dist += popcount(desc1[m] ^ desc2[m]);
+    }
+    return dist;
+    #endif
+}
 
-    for (int i = 0; i < kpts_size; i++) {
-        int dist = 0;
-        kp_t *kp2 = array_at(kpts, i);
+typedef struct {
+    int dist1, dist2;
+    int index1, index2;
+} kp_best_t;
+
+// Keeps the two nearest keypoints. Ties go to the lowest index, so the result does not depend
+// on the order keypoints are visited in.
+static inline void kp_best_update(kp_best_t *best, int dist, int i) {
+    if ((i == best->index1) || (i == best->index2)) {
+        return;
+    }
+
+    if ((dist < best->dist1) || ((dist == best->dist1) && (i < best->index1))) {
+        best->dist2 = best->dist1;
+        best->index2 = best->index1;
+        best->dist1 = dist;
+        best->index1 = i;
+    } else if (dist < best->dist2) {
+        best->dist2 = dist;
+        best->index2 = i;
+    }
+}
+
+orb_index_t *orb_index_build(array_t *kpts) {
+    int size = array_length(kpts);
+
+    if ((size < ORB_INDEX_MIN_SIZE) || (size > (UINT16_MAX + 1))) {
+        return NULL;
+    }
+
+    orb_index_t *index = xalloc(sizeof(orb_index_t));
+    index->size = size;
+    index->tables = xalloc(ORB_INDEX_TABLES * size * sizeof(uint32_t));
+
+    for (int t = 0; t < ORB_INDEX_TABLES; t++) {
+        uint32_t *table = index->tables + (t * size);
+        for (int i = 0; i < size; i++) {
+            kp_t *kp = array_at(kpts, i);
+            table[i] = (((uint16_t *) kp->desc)[t] << 16) | i;
+        }
+        rsort(table, size, sizeof(uint32_t), 0, RSORT_KEY_U32, false);
+    }
 
-        if (kp2->matched == 0) {
-            for (int m = 0; m < (KDESC_SIZE / 4); m++) {
-                dist += popcount(((uint32_t *) (kp1->desc))[m] ^ ((uint32_t *) (kp2->desc))[m]);
+    return index;
+}
+
+// Without an index all keypoints are searched. With an index only the keypoints that share at
+// least one 16-bit substring with kp1 are, so a keypoint with no such neighbour has no match.
+static kp_t *find_best_match(kp_t *kp1, array_t *kpts, orb_index_t *index, int *dist_out1, int *dist_out2,
+                             int *index_out) {
+    kp_best_t best = { MAX_KP_DIST, MAX_KP_DIST, -1, -1 };
+
+    if (index) {
+        for (int t = 0; t < ORB_INDEX_TABLES; t++) {
+            uint32_t *table = index->tables + (t * index->size);
+            uint32_t key = ((uint16_t *) kp1->desc)[t] << 16;
+            int lo = 0, hi = index->size;
+
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (table[mid] < key) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
             }
 
-            if (dist < min_dist1) {
-                *index = i;
-                min_kp = kp2;
-                min_dist2 = min_dist1;
-                min_dist1 = dist;
+            for (; (lo < index->size) && ((table[lo] & 0xFFFF0000) == key); lo++) {
+                int i = table[lo] & 0xFFFF;
+                kp_t *kp2 = array_at(kpts, i);
+                if (kp2->matched == 0) {
+                    kp_best_update(&best, kp_dist(kp1, kp2), i);
+                }
+            }
+        }
+    } else {
+        int kpts_size = array_length(kpts);
+        for (int i = 0; i < kpts_size; i++) {
+            kp_t *kp2 = array_at(kpts, i);
+            if (kp2->matched == 0) {
+                kp_best_update(&best, kp_dist(kp1, kp2), i);
             }
         }
     }
 
-    *dist_out1 = min_dist1;
-    *dist_out2 = min_dist2;
-    return min_kp;
+    *dist_out1 = best.dist1;
+    *dist_out2 = best.dist2;
+
+    if (best.index1 < 0) {
+        return NULL;
+    }
+
+    *index_out = best.index1;
+    return array_at(kpts, best.index1);
+}
+
+// True if the best match is not clearly better than the second best, i.e. (dist1 * 100 / dist2) >
+// threshold. Written without the division as dist2 is 0 when two keypoints match exactly.
+static inline bool kp_ratio_test_fail(int dist1, int dist2, int threshold) {
+    return (dist1 * 100) >= ((threshold + 1) * dist2);
 }
 
-int orb_match_keypoints(array_t *kpts1, array_t *kpts2, int *match, int threshold, rectangle_t *r, point_t *c, int *angle) {
+int orb_match_keypoints(array_t *kpts1, array_t *kpts2, orb_index_t *index1, orb_index_t *index2,
+                        int *match, int threshold, rectangle_t *r, point_t *c, int *angle) {
     int matches = 0;
     int cx = 0, cy = 0;
     uint16_t angles[360] = {0};
@@ -574,16 +691,16 @@ int orb_match_keypoints(array_t *kpts1, array_t *kpts2, int *match, int threshol
         kp_t *kp1 = array_at(kpts1, i);
 
         // Find the best match in second set
-        min_kp = find_best_match(kp1, kpts2, &min_dist1, &min_dist2, &kp_index2);
+        min_kp = find_best_match(kp1, kpts2, index2, &min_dist1, &min_dist2, &kp_index2);
         // Test the distance ratio between the best two matches
-        if ((min_dist1 * 100 / min_dist2) > threshold) {
+        if ((!min_kp) || kp_ratio_test_fail(min_dist1, min_dist2, threshold)) {
             continue;
         }
 
         // Cross-match the keypoint in the first set
-        kp_t *kp2 = find_best_match(min_kp, kpts1, &min_dist1, &min_dist2, &kp_index1);
+        kp_t *kp2 = find_best_match(min_kp, kpts1, index1, &min_dist1, &min_dist2, &kp_index1);
         // Test the distance ratio between the best two matches
-        if ((min_dist1 * 100 / min_dist2) > threshold) {
+        if ((!kp2) || kp_ratio_test_fail(min_dist1, min_dist2, threshold)) {
             continue;
         }
 
@@ -712,6 +829,26 @@ int orb_filter_keypoints(array_t *kpts, rectangle_t *r, point_t *c) {
 }
 
 #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
+// Keypoint records are stored packed and are read and written in bulk, not a field at a time.
+static void orb_descriptor_pack(uint8_t *record, kp_t *kp) {
+    memcpy(record + 0, &kp->x, sizeof(kp->x));
+    memcpy(record + 2, &kp->y, sizeof(kp->y));
+    memcpy(record + 4, &kp->score, sizeof(kp->score));
+    memcpy(record + 6, &kp->octave, sizeof(kp->octave));
+    memcpy(record + 8, &kp->angle, sizeof(kp->angle));
+    memcpy(record + 10, kp->desc, KDESC_SIZE);
+}
+
+static void orb_descriptor_unpack(kp_t *kp, const uint8_t *record) {
+    memcpy(&kp->x, record + 0, sizeof(kp->x));
+    memcpy(&kp->y, record + 2, sizeof(kp->y));
+    memcpy(&kp->score, record + 4, sizeof(kp->score));
+    memcpy(&kp->octave, record + 6, sizeof(kp->octave));
+    memcpy(&kp->angle, record + 8, sizeof(kp->angle));
+    memcpy(kp->desc, record + 10, KDESC_SIZE);
+    kp->matched = 0;
+}
+
 int orb_save_descriptor(FIL *fp, array_t *kpts) {
     UINT bytes;
     FRESULT res;
@@ -721,51 +858,27 @@ int orb_save_descriptor(FIL *fp, array_t *kpts) {
     // Write the number of keypoints
     res = file_ll_write(fp, &kpts_size, sizeof(kpts_size), &bytes);
     if (res != FR_OK || bytes != sizeof(kpts_size)) {
-        goto error;
+        return res;
     }
 
     // Write keypoints
-    for (int i = 0; i < kpts_size; i++) {
-        kp_t *kp = array_at(kpts, i);
+    fb_alloc_mark();
+    uint8_t *records = fb_alloc(KDESC_RECORDS_MAX * KDESC_RECORD_SIZE, FB_ALLOC_NO_HINT);
 
-        // Write X
-        res = file_ll_write(fp, &kp->x, sizeof(kp->x), &bytes);
-        if (res != FR_OK || bytes != sizeof(kp->x)) {
-            goto error;
-        }
-
-        // Write Y
-        res = file_ll_write(fp, &kp->y, sizeof(kp->y), &bytes);
-        if (res != FR_OK || bytes != sizeof(kp->y)) {
-            goto error;
-        }
-
-        // Write Score
-        res = file_ll_write(fp, &kp->score, sizeof(kp->score), &bytes);
-        if (res != FR_OK || bytes != sizeof(kp->score)) {
-            goto error;
-        }
+    for (int i = 0; i < kpts_size; i += KDESC_RECORDS_MAX) {
+        int n = IM_MIN(kpts_size - i, KDESC_RECORDS_MAX);
 
-        // Write Octave
-        res = file_ll_write(fp, &kp->octave, sizeof(kp->octave), &bytes);
-        if (res != FR_OK || bytes != sizeof(kp->octave)) {
-            goto error;
+        for (int j = 0; j < n; j++) {
+            orb_descriptor_pack(records + (j * KDESC_RECORD_SIZE), array_at(kpts, i + j));
         }
 
-        // Write Angle
-        res = file_ll_write(fp, &kp->angle, sizeof(kp->angle), &bytes);
-        if (res != FR_OK || bytes != sizeof(kp->angle)) {
-            goto error;
-        }
-
-        // Write descriptor
-        res = file_ll_write(fp, kp->desc, KDESC_SIZE, &bytes);
-        if (res != FR_OK || bytes != KDESC_SIZE) {
-            goto error;
+        res = file_ll_write(fp, records, n * KDESC_RECORD_SIZE, &bytes);
+        if (res != FR_OK || bytes != (n * KDESC_RECORD_SIZE)) {
+            break;
         }
     }
 
-error:
+    fb_alloc_free_till_mark();
     return res;
 }
 
@@ -778,55 +891,30 @@ int orb_load_descriptor(FIL *fp, array_t *kpts) {
     // Read number of keypoints
     res = file_ll_read(fp, &kpts_size, sizeof(kpts_size), &bytes);
     if (res != FR_OK || bytes != sizeof(kpts_size)) {
-        goto error;
+        return res;
     }
 
     // Read keypoints
-    for (int i = 0; i < kpts_size; i++) {
-        kp_t *kp = xalloc(sizeof(*kp));
-        kp->matched = 0;
+    fb_alloc_mark();
+    uint8_t *records = fb_alloc(KDESC_RECORDS_MAX * KDESC_RECORD_SIZE, FB_ALLOC_NO_HINT);
 
-        // Read X
-        res = file_ll_read(fp, &kp->x, sizeof(kp->x), &bytes);
-        if (res != FR_OK || bytes != sizeof(kp->x)) {
-            goto error;
-        }
-
-        // Read Y
-        res = file_ll_read(fp, &kp->y, sizeof(kp->y), &bytes);
-        if (res != FR_OK || bytes != sizeof(kp->y)) {
-            goto error;
-        }
-
-        // Read Score
-        res = file_ll_read(fp, &kp->score, sizeof(kp->score), &bytes);
-        if (res != FR_OK || bytes != sizeof(kp->score)) {
-            goto error;
-        }
+    for (int i = 0; i < kpts_size; i += KDESC_RECORDS_MAX) {
+        int n = IM_MIN(kpts_size - i, KDESC_RECORDS_MAX);
 
-        // Read Octave
-        res = file_ll_read(fp, &kp->octave, sizeof(kp->octave), &bytes);
-        if (res != FR_OK || bytes != sizeof(kp->octave)) {
-            goto error;
-        }
-
-        // Read Angle
-        res = file_ll_read(fp, &kp->angle, sizeof(kp->angle), &bytes);
-        if (res != FR_OK || bytes != sizeof(kp->angle)) {
-            goto error;
+        res = file_ll_read(fp, records, n * KDESC_RECORD_SIZE, &bytes);
+        if (res != FR_OK || bytes != (n * KDESC_RECORD_SIZE)) {
+            break;
         }
 
-        // Read descriptor
-        res = file_ll_read(fp, kp->desc,  KDESC_SIZE, &bytes);
-        if (res != FR_OK || bytes != KDESC_SIZE) {
-            goto error;
+        for (int j = 0; j < n; j++) {
+            kp_t *kp = xalloc(sizeof(*kp));
+            orb_descriptor_unpack(kp, records + (j * KDESC_RECORD_SIZE));
+            // Add keypoint to array
+            array_push_back(kpts, kp);
         }
-
-        // Add keypoint to array
-        array_push_back(kpts, kp);
     }
 
-error:
+    fb_alloc_free_till_mark();
     return res;
 }
 #endif  //IMLIB_ENABLE_IMAGE_FILE_IO
@@ -7,246 +7,1350 @@
  * This work is licensed under the MIT license, see the file LICENSE for details.
  *
  * PNG CODEC
+ *
+ * Rows are filtered (or unfiltered) and deflated (or inflated) as they are produced, so the
+ * only buffers needed besides the image are a few rows and the deflate window.
  */
 #include <stdio.h>
 #include "imlib.h"
 #include "py/mphal.h"
 #include "py/runtime.h"
+#include "fb_alloc.h"
 #include "file_utils.h"
+
+#define TIME_PNG                (0)
+
 #if defined(IMLIB_ENABLE_PNG_ENCODER) || defined(IMLIB_ENABLE_PNG_DECODER)
-#include "lodepng.h"
-#include "umm_malloc.h"
+#define PNG_CHUNK_IHDR          (0x49484452)
+#define PNG_CHUNK_PLTE          (0x504C5445)
+#define PNG_CHUNK_IDAT          (0x49444154)
+#define PNG_CHUNK_IEND          (0x49454E44)
+
+#define PNG_FILTER_NONE         (0)
+#define PNG_FILTER_SUB          (1)
+#define PNG_FILTER_UP           (2)
+#define PNG_FILTER_AVERAGE      (3)
+#define PNG_FILTER_PAETH        (4)
+
+#define PNG_COLOR_GRAYSCALE     (0)
+#define PNG_COLOR_RGB           (2)
+#define PNG_COLOR_PALETTE       (3)
+#define PNG_COLOR_GRAYSCALE_A   (4)
+#define PNG_COLOR_RGBA          (6)
+
+#define PNG_MIN_MATCH           (3)
+#define PNG_MAX_MATCH           (258)
+#define PNG_LIT_CODES           (286)
+#define PNG_FIXED_LIT_CODES     (288)   // Includes the two unused codes.
+#define PNG_DIST_CODES          (30)
+#define PNG_CL_CODES            (19)
+#define PNG_MAX_BITS            (15)
+
+static const uint8_t png_signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+static const uint16_t png_length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115,
+    131, 163, 195, 227, 258
+};
+
+static const uint8_t png_length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const uint16_t png_dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537,
+    2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+
+static const uint8_t png_dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Order of the code length code lengths in a dynamic block header.
+static const uint8_t png_cl_order[PNG_CL_CODES] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+static uint32_t png_crc32(uint32_t crc, const uint8_t *data, uint32_t size) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
 
-#define TIME_PNG    (0)
+    for (uint32_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0xF];
+        crc = (crc >> 4) ^ table[crc & 0xF];
+    }
 
-void *lodepng_malloc(size_t size) {
-    return umm_malloc(size);
+    return crc;
 }
 
-void *lodepng_realloc(void *ptr, size_t new_size) {
-    return umm_realloc(ptr, new_size);
+static inline uint32_t png_get_be32(const uint8_t *p) {
+    return (((uint32_t) p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
 }
 
-void lodepng_free(void *ptr) {
-    return umm_free(ptr);
+static inline void png_set_be32(uint8_t *p, uint32_t value) {
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
 }
 
-unsigned lodepng_convert_cb(unsigned char *out, const unsigned char *in,
-                            const LodePNGColorMode *mode_out, const LodePNGColorMode *mode_in, unsigned w, unsigned h) {
-    unsigned error = 0;
-    unsigned numpixels = w * h;
+// Code lengths of the fixed huffman codes.
+static void png_fixed_lengths(uint8_t *lit_len, uint8_t *dist_len) {
+    for (int i = 0; i < PNG_FIXED_LIT_CODES; i++) {
+        lit_len[i] = (i < 144) ? 8 : ((i < 256) ? 9 : ((i < 280) ? 7 : 8));
+    }
+    memset(dist_len, 5, PNG_DIST_CODES);
+}
 
-    if (mode_in->colortype == LCT_CUSTOM) {
-        // Compression.
-        // Note: we're always encoding to 8 bits.
-        switch (mode_in->customfmt) {
-            case PIXFORMAT_RGB565: {
-                uint16_t *pixels = (uint16_t *) in;
-                if (mode_out->colortype == LCT_RGB) {
-                    // RGB565 -> RGB888
-                    for (int i = 0; i < numpixels; i++, out += 3) {
-                        out[0] = COLOR_RGB565_TO_R8(pixels[i]);
-                        out[1] = COLOR_RGB565_TO_G8(pixels[i]);
-                        out[2] = COLOR_RGB565_TO_B8(pixels[i]);
-                    }
-                } else if (mode_out->colortype == LCT_RGBA) {
-                    // RGB565 -> RGBA888
-                    for (int i = 0; i < numpixels; i++, out += 4) {
-                        out[0] = COLOR_RGB565_TO_R8(pixels[i]);
-                        out[1] = COLOR_RGB565_TO_G8(pixels[i]);
-                        out[2] = COLOR_RGB565_TO_B8(pixels[i]);
-                        out[3] = 255;
-                    }
-                } else {
-                    error = 56; // unsupported color mode conversion.
-                }
-                break;
+static inline int png_paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    return ((pa <= pb) && (pa <= pc)) ? a : ((pb <= pc) ? b : c);
+}
+#endif // IMLIB_ENABLE_PNG_ENCODER || IMLIB_ENABLE_PNG_DECODER
+
+#if defined(IMLIB_ENABLE_PNG_ENCODER)
+#define PNG_CHUNK_SIZE          (4096)  // IDAT chunk size.
+#define PNG_WINDOW_SIZE         (4096)  // Deflate window, the input buffer is twice that.
+#define PNG_WINDOW_MASK         (PNG_WINDOW_SIZE - 1)
+#define PNG_HASH_SIZE           (4096)
+#define PNG_HASH_NIL            (0xFFFF)
+#define PNG_MAX_CHAIN           (16)    // Hash chain entries searched for a match.
+#define PNG_BLOCK_SYMBOLS       (4096)  // Literals and matches per deflate block.
+#define PNG_SYMBOL_MATCH        (0x80000000)
+
+#define PNG_HASH(p)             ((((p)[0] << 8) ^ ((p)[1] << 4) ^ (p)[2]) & (PNG_HASH_SIZE - 1))
+
+typedef struct png_encoder {
+    FIL *fp;            // File output, or
+    uint8_t *data;      // memory output.
+    uint32_t size;
+    uint32_t max_size;
+    bool overflow;
+    uint8_t *chunk;
+    uint32_t chunk_len;
+    uint32_t bits;
+    int n_bits;
+    uint32_t adler_a;
+    uint32_t adler_b;
+    uint8_t *window;
+    uint16_t *head;
+    uint16_t *prev;
+    uint32_t pos;
+    uint32_t end;
+    uint32_t *symbols;  // Literal, or PNG_SYMBOL_MATCH | (length << 16) | distance.
+    int n_symbols;
+    // Image rows.
+    int depth;
+    int color_type;
+    int bpp;
+    uint32_t row_bytes;
+    uint8_t *row;
+    uint8_t *prev_row;
+    uint8_t *best;
+    uint8_t *test;
+    uint16_t *line;
+} png_encoder_t;
+
+typedef struct png_huffman_sym {
+    uint32_t key;
+    uint16_t sym;
+} png_huffman_sym_t;
+
+static void png_encoder_put(png_encoder_t *enc, const void *data, uint32_t size) {
+    if (enc->fp) {
+        file_write(enc->fp, data, size);
+    } else if ((enc->size + size) <= enc->max_size) {
+        memcpy(enc->data + enc->size, data, size);
+    } else {
+        enc->overflow = true;
+        return;
+    }
+    enc->size += size;
+}
+
+static void png_write_chunk(png_encoder_t *enc, uint32_t type, const uint8_t *data, uint32_t size) {
+    uint32_t header[2] = {__builtin_bswap32(size), __builtin_bswap32(type)};
+    uint32_t crc = png_crc32(0xFFFFFFFF, (uint8_t *) &header[1], 4);
+    crc = __builtin_bswap32(png_crc32(crc, data, size) ^ 0xFFFFFFFF);
+
+    png_encoder_put(enc, header, 8);
+    if (size) {
+        png_encoder_put(enc, data, size);
+    }
+    png_encoder_put(enc, &crc, 4);
+}
+
+static void png_flush_idat(png_encoder_t *enc) {
+    if (enc->chunk_len) {
+        png_write_chunk(enc, PNG_CHUNK_IDAT, enc->chunk, enc->chunk_len);
+        enc->chunk_len = 0;
+    }
+}
+
+static inline void png_put_byte(png_encoder_t *enc, uint8_t b) {
+    enc->chunk[enc->chunk_len++] = b;
+    if (enc->chunk_len == PNG_CHUNK_SIZE) {
+        png_flush_idat(enc);
+    }
+}
+
+static inline void png_put_bits(png_encoder_t *enc, uint32_t value, int n) {
+    enc->bits |= value << enc->n_bits;
+    enc->n_bits += n;
+    while (enc->n_bits >= 8) {
+        png_put_byte(enc, enc->bits);
+        enc->bits >>= 8;
+        enc->n_bits -= 8;
+    }
+}
+
+static inline int png_length_code(int len) {
+    int l = len - PNG_MIN_MATCH;
+    if (len == PNG_MAX_MATCH) {
+        return 28;
+    } else if (l < 8) {
+        return l;
+    } else {
+        int log2 = 31 - __builtin_clz(l);
+        return ((log2 - 1) << 2) | ((l >> (log2 - 2)) & 3);
+    }
+}
+
+static inline int png_dist_code(int dist) {
+    int d = dist - 1;
+    if (d < 4) {
+        return d;
+    } else {
+        int log2 = 31 - __builtin_clz(d);
+        return (log2 << 1) | ((d >> (log2 - 1)) & 1);
+    }
+}
+
+// Code lengths (limited to max_bits) for the symbol frequencies. Uses the in-place minimum
+// redundancy algorithm of Moffat and Katajainen, then rebalances the length counts.
+static void png_huffman_lengths(const uint32_t *freq, int n, int max_bits, uint8_t *lengths) {
+    png_huffman_sym_t syms[PNG_LIT_CODES];
+    int n_syms = 0;
+
+    memset(lengths, 0, n);
+
+    // Sort the used symbols by frequency.
+    for (int i = 0; i < n; i++) {
+        if (freq[i]) {
+            int j = n_syms++;
+            for (; (j > 0) && (syms[j - 1].key > freq[i]); j--) {
+                syms[j] = syms[j - 1];
             }
-            case PIXFORMAT_YUV_ANY:
-            // YUV   -> RGB888
-            case PIXFORMAT_BAYER_ANY:
-            // BAYER -> RGB888
-            default:
-                error = 56; // unsupported color mode conversion.
+            syms[j] = (png_huffman_sym_t) { freq[i], i };
+        }
+    }
+
+    if (n_syms <= 1) {
+        if (n_syms) {
+            lengths[syms[0].sym] = 1;
+        }
+        return;
+    }
+
+    int root = 0, leaf = 2;
+    syms[0].key += syms[1].key;
+    for (int next = 1; next < (n_syms - 1); next++) {
+        if ((leaf >= n_syms) || (syms[root].key < syms[leaf].key)) {
+            syms[next].key = syms[root].key;
+            syms[root++].key = next;
+        } else {
+            syms[next].key = syms[leaf++].key;
+        }
+        if ((leaf >= n_syms) || ((root < next) && (syms[root].key < syms[leaf].key))) {
+            syms[next].key += syms[root].key;
+            syms[root++].key = next;
+        } else {
+            syms[next].key += syms[leaf++].key;
+        }
+    }
+
+    syms[n_syms - 2].key = 0;
+    for (int next = n_syms - 3; next >= 0; next--) {
+        syms[next].key = syms[syms[next].key].key + 1;
+    }
+
+    int avail = 1, used = 0, depth = 0, next = n_syms - 1;
+    root = n_syms - 2;
+    while (avail > 0) {
+        while ((root >= 0) && (syms[root].key == depth)) {
+            used++;
+            root--;
+        }
+        while (avail > used) {
+            syms[next--].key = depth;
+            avail--;
+        }
+        avail = 2 * used;
+        depth++;
+        used = 0;
+    }
+
+    // Move the codes longer than max_bits up, then make the code complete again.
+    int counts[32] = {0};
+    for (int i = 0; i < n_syms; i++) {
+        counts[IM_MIN(syms[i].key, 31u)] += 1;
+    }
+
+    for (int i = max_bits + 1; i < 32; i++) {
+        counts[max_bits] += counts[i];
+    }
+
+    uint32_t total = 0;
+    for (int i = max_bits; i > 0; i--) {
+        total += counts[i] << (max_bits - i);
+    }
+
+    for (; total != (1 << max_bits); total--) {
+        counts[max_bits] -= 1;
+        for (int i = max_bits - 1; i > 0; i--) {
+            if (counts[i]) {
+                counts[i] -= 1;
+                counts[i + 1] += 2;
                 break;
+            }
         }
-    } else if (mode_out->colortype == LCT_CUSTOM) {
-        // Decompression.
-        // NOTE: decode from 16 bits needs to be implemented.
-        switch (mode_out->customfmt) {
-            case PIXFORMAT_RGB565: {
-                uint16_t *pixels = (uint16_t *) out;
-                if (mode_in->colortype == LCT_RGB) {
-                    // RGB888 -> RGB565
-                    for (int i = 0; i < numpixels; i++, in += 3) {
-                        pixels[i] = COLOR_R8_G8_B8_TO_RGB565(in[0], in[1], in[2]);
-                    }
-                } else if (mode_in->colortype == LCT_RGBA) {
-                    // RGBA888 -> RGB565
-                    for (int i = 0; i < numpixels; i++, in += 4) {
-                        pixels[i] = COLOR_R8_G8_B8_TO_RGB565(in[0], in[1], in[2]);
+    }
+
+    // The most frequent symbols get the shortest codes.
+    for (int i = 1, j = n_syms; i <= max_bits; i++) {
+        for (int k = counts[i]; k > 0; k--) {
+            lengths[syms[--j].sym] = i;
+        }
+    }
+}
+
+// Canonical codes, bit reversed as deflate sends them LSB first.
+static void png_huffman_codes(const uint8_t *lengths, int n, uint16_t *codes) {
+    int counts[PNG_MAX_BITS + 1] = {0}, next[PNG_MAX_BITS + 1] = {0};
+
+    for (int i = 0; i < n; i++) {
+        counts[lengths[i]] += 1;
+    }
+
+    counts[0] = 0;
+    for (int i = 1, code = 0; i <= PNG_MAX_BITS; i++) {
+        code = (code + counts[i - 1]) << 1;
+        next[i] = code;
+    }
+
+    for (int i = 0; i < n; i++) {
+        int code = next[lengths[i]]++, rev = 0;
+        for (int j = 0; j < lengths[i]; j++) {
+            rev = (rev << 1) | ((code >> j) & 1);
+        }
+        codes[i] = rev;
+    }
+}
+
+// Writes the buffered symbols as a fixed or dynamic huffman block, whichever is smaller.
+static void png_deflate_block(png_encoder_t *enc, bool last) {
+    uint32_t lit_freq[PNG_LIT_CODES] = {0}, dist_freq[PNG_DIST_CODES] = {0}, cl_freq[PNG_CL_CODES] = {0};
+    uint8_t lit_len[PNG_FIXED_LIT_CODES], dist_len[PNG_DIST_CODES], cl_len[PNG_CL_CODES];
+    uint16_t lit_codes[PNG_FIXED_LIT_CODES], dist_codes[PNG_DIST_CODES], cl_codes[PNG_CL_CODES];
+    uint8_t lengths[PNG_LIT_CODES + PNG_DIST_CODES], rle[PNG_LIT_CODES + PNG_DIST_CODES];
+    uint8_t rle_extra[PNG_LIT_CODES + PNG_DIST_CODES];
+    int n_rle = 0;
+
+    for (int i = 0; i < enc->n_symbols; i++) {
+        uint32_t sym = enc->symbols[i];
+        if (sym & PNG_SYMBOL_MATCH) {
+            lit_freq[257 + png_length_code((sym >> 16) & 0x1FF)] += 1;
+            dist_freq[png_dist_code(sym & 0xFFFF)] += 1;
+        } else {
+            lit_freq[sym] += 1;
+        }
+    }
+
+    lit_freq[256] = 1; // end of block
+
+    png_huffman_lengths(lit_freq, PNG_LIT_CODES, PNG_MAX_BITS, lit_len);
+    lit_len[286] = lit_len[287] = 0;
+    png_huffman_lengths(dist_freq, PNG_DIST_CODES, PNG_MAX_BITS, dist_len);
+
+    int hlit = PNG_LIT_CODES, hdist = PNG_DIST_CODES, hclen = PNG_CL_CODES;
+    for (; (hlit > 257) && (!lit_len[hlit - 1]); hlit--) {
+    }
+    for (; (hdist > 1) && (!dist_len[hdist - 1]); hdist--) {
+    }
+
+    // Run length encode the code lengths.
+    memcpy(lengths, lit_len, hlit);
+    memcpy(lengths + hlit, dist_len, hdist);
+
+    for (int i = 0, n = hlit + hdist; i < n;) {
+        int len = lengths[i], run = 1;
+        for (; ((i + run) < n) && (lengths[i + run] == len); run++) {
+        }
+
+        if ((!len) && (run >= 3)) {
+            run = IM_MIN(run, 138);
+            rle[n_rle] = (run >= 11) ? 18 : 17;
+            rle_extra[n_rle++] = (run >= 11) ? (run - 11) : (run - 3);
+        } else if (len && (run >= 4)) {
+            run = IM_MIN(run - 1, 6);
+            rle[n_rle] = len;
+            rle_extra[n_rle++] = 0;
+            rle[n_rle] = 16;
+            rle_extra[n_rle++] = run - 3;
+            run += 1;
+        } else {
+            run = 1;
+            rle[n_rle] = len;
+            rle_extra[n_rle++] = 0;
+        }
+
+        i += run;
+    }
+
+    for (int i = 0; i < n_rle; i++) {
+        cl_freq[rle[i]] += 1;
+    }
+
+    png_huffman_lengths(cl_freq, PNG_CL_CODES, 7, cl_len);
+    for (; (hclen > 4) && (!cl_len[png_cl_order[hclen - 1]]); hclen--) {
+    }
+
+    // Compare the block sizes.
+    uint8_t fixed_lit_len[PNG_FIXED_LIT_CODES], fixed_dist_len[PNG_DIST_CODES];
+    png_fixed_lengths(fixed_lit_len, fixed_dist_len);
+
+    uint32_t dynamic_size = 14 + (hclen * 3), fixed_size = 0;
+    for (int i = 0; i < n_rle; i++) {
+        dynamic_size += cl_len[rle[i]] + ((rle[i] == 16) ? 2 : ((rle[i] == 17) ? 3 : ((rle[i] == 18) ? 7 : 0)));
+    }
+
+    for (int i = 0; i < PNG_LIT_CODES; i++) {
+        uint32_t extra = (i > 256) ? png_length_extra[i - 257] : 0;
+        dynamic_size += lit_freq[i] * (lit_len[i] + extra);
+        fixed_size += lit_freq[i] * (fixed_lit_len[i] + extra);
+    }
+
+    for (int i = 0; i < PNG_DIST_CODES; i++) {
+        dynamic_size += dist_freq[i] * (dist_len[i] + png_dist_extra[i]);
+        fixed_size += dist_freq[i] * (fixed_dist_len[i] + png_dist_extra[i]);
+    }
+
+    bool dynamic = dynamic_size < fixed_size;
+    png_put_bits(enc, last, 1);
+    png_put_bits(enc, dynamic ? 2 : 1, 2);
+
+    if (dynamic) {
+        png_huffman_codes(cl_len, PNG_CL_CODES, cl_codes);
+        png_put_bits(enc, hlit - 257, 5);
+        png_put_bits(enc, hdist - 1, 5);
+        png_put_bits(enc, hclen - 4, 4);
+
+        for (int i = 0; i < hclen; i++) {
+            png_put_bits(enc, cl_len[png_cl_order[i]], 3);
+        }
+
+        for (int i = 0; i < n_rle; i++) {
+            png_put_bits(enc, cl_codes[rle[i]], cl_len[rle[i]]);
+            if (rle[i] >= 16) {
+                png_put_bits(enc, rle_extra[i], (rle[i] == 16) ? 2 : ((rle[i] == 17) ? 3 : 7));
+            }
+        }
+    } else {
+        memcpy(lit_len, fixed_lit_len, PNG_FIXED_LIT_CODES);
+        memcpy(dist_len, fixed_dist_len, PNG_DIST_CODES);
+    }
+
+    png_huffman_codes(lit_len, PNG_FIXED_LIT_CODES, lit_codes);
+    png_huffman_codes(dist_len, PNG_DIST_CODES, dist_codes);
+
+    for (int i = 0; i < enc->n_symbols; i++) {
+        uint32_t sym = enc->symbols[i];
+        if (sym & PNG_SYMBOL_MATCH) {
+            int len = (sym >> 16) & 0x1FF, lc = png_length_code(len);
+            int dist = sym & 0xFFFF, dc = png_dist_code(dist);
+            png_put_bits(enc, lit_codes[257 + lc], lit_len[257 + lc]);
+            png_put_bits(enc, len - png_length_base[lc], png_length_extra[lc]);
+            png_put_bits(enc, dist_codes[dc], dist_len[dc]);
+            png_put_bits(enc, dist - png_dist_base[dc], png_dist_extra[dc]);
+        } else {
+            png_put_bits(enc, lit_codes[sym], lit_len[sym]);
+        }
+    }
+
+    png_put_bits(enc, lit_codes[256], lit_len[256]);
+    enc->n_symbols = 0;
+}
+
+static inline void png_deflate_symbol(png_encoder_t *enc, uint32_t sym) {
+    enc->symbols[enc->n_symbols++] = sym;
+    if (enc->n_symbols == PNG_BLOCK_SYMBOLS) {
+        png_deflate_block(enc, false);
+    }
+}
+
+static inline void png_deflate_insert(png_encoder_t *enc, uint32_t pos) {
+    uint32_t hash = PNG_HASH(enc->window + pos);
+    enc->prev[pos & PNG_WINDOW_MASK] = enc->head[hash];
+    enc->head[hash] = pos;
+}
+
+// Greedy LZ77 over the buffered input, keeps PNG_MAX_MATCH bytes of lookahead unless flushing.
+static void png_deflate_process(png_encoder_t *enc, bool flush) {
+    uint32_t lookahead = flush ? 1 : PNG_MAX_MATCH;
+
+    while ((enc->end - enc->pos) >= lookahead) {
+        uint32_t pos = enc->pos, avail = IM_MIN(enc->end - pos, (uint32_t) PNG_MAX_MATCH);
+        uint32_t best_len = 0, best_dist = 0;
+
+        if (avail >= PNG_MIN_MATCH) {
+            const uint8_t *p = enc->window + pos;
+            uint32_t match = enc->head[PNG_HASH(p)];
+
+            for (int chain = PNG_MAX_CHAIN;
+                 chain && (match != PNG_HASH_NIL) && ((pos - match) < PNG_WINDOW_SIZE); chain--) {
+                const uint8_t *m = enc->window + match;
+                if (m[best_len] == p[best_len]) {
+                    uint32_t len = 0;
+                    for (; (len < avail) && (m[len] == p[len]); len++) {
                     }
-                } else if (mode_in->colortype == LCT_GREY && mode_in->bitdepth == 8) {
-                    // GRAYSCALE -> RGB565
-                    for (int i = 0; i < numpixels; i++, in++) {
-                        pixels[i] = COLOR_R8_G8_B8_TO_RGB565(in[0], in[0], in[0]);
+                    if (len > best_len) {
+                        best_len = len;
+                        best_dist = pos - match;
+                        if (len == avail) {
+                            break;
+                        }
                     }
-                } else {
-                    error = 56; // unsupported color mode conversion.
                 }
-                break;
+                match = enc->prev[match & PNG_WINDOW_MASK];
             }
-            default:
-                error = 56; // unsupported color mode conversion.
-                break;
         }
 
-    } else {
-        error = 56; // unsupported color mode conversion.
+        if (best_len >= PNG_MIN_MATCH) {
+            png_deflate_symbol(enc, PNG_SYMBOL_MATCH | (best_len << 16) | best_dist);
+        } else {
+            best_len = 1;
+            png_deflate_symbol(enc, enc->window[pos]);
+        }
+
+        for (uint32_t i = 0; i < best_len; i++, pos++) {
+            if ((enc->end - pos) >= PNG_MIN_MATCH) {
+                png_deflate_insert(enc, pos);
+            }
+        }
+
+        enc->pos = pos;
     }
-    return error;
 }
 
-#if defined(IMLIB_ENABLE_PNG_ENCODER)
-bool png_compress(image_t *src, image_t *dst) {
-    #if (TIME_PNG == 1)
-    mp_uint_t start = mp_hal_ticks_ms();
-    #endif
+static void png_deflate_slide(png_encoder_t *enc) {
+    memcpy(enc->window, enc->window + PNG_WINDOW_SIZE, PNG_WINDOW_SIZE);
+    enc->pos -= PNG_WINDOW_SIZE;
+    enc->end -= PNG_WINDOW_SIZE;
 
-    if (src->is_compressed) {
-        return true;
+    for (int i = 0; i < PNG_HASH_SIZE; i++) {
+        enc->head[i] = ((enc->head[i] != PNG_HASH_NIL) && (enc->head[i] >= PNG_WINDOW_SIZE)) ?
+                       (enc->head[i] - PNG_WINDOW_SIZE) : PNG_HASH_NIL;
+    }
+
+    for (int i = 0; i < PNG_WINDOW_SIZE; i++) {
+        enc->prev[i] = ((enc->prev[i] != PNG_HASH_NIL) && (enc->prev[i] >= PNG_WINDOW_SIZE)) ?
+                       (enc->prev[i] - PNG_WINDOW_SIZE) : PNG_HASH_NIL;
+    }
+}
+
+static void png_deflate(png_encoder_t *enc, const uint8_t *data, uint32_t size) {
+    for (uint32_t i = 0; i < size; i++) {
+        enc->adler_a += data[i];
+        if (enc->adler_a >= 65521) {
+            enc->adler_a -= 65521;
+        }
+        enc->adler_b += enc->adler_a;
+        if (enc->adler_b >= 65521) {
+            enc->adler_b -= 65521;
+        }
+    }
+
+    while (size) {
+        if (enc->end == (PNG_WINDOW_SIZE * 2)) {
+            png_deflate_slide(enc);
+        }
+
+        uint32_t n = IM_MIN(size, (uint32_t) (PNG_WINDOW_SIZE * 2) - enc->end);
+        memcpy(enc->window + enc->end, data, n);
+        enc->end += n;
+        data += n;
+        size -= n;
+        png_deflate_process(enc, false);
     }
+}
 
-    umm_init_x(fb_avail());
+static void png_deflate_finish(png_encoder_t *enc) {
+    png_deflate_process(enc, true);
+    png_deflate_block(enc, true);
+
+    if (enc->n_bits) {
+        png_put_bits(enc, 0, 8 - enc->n_bits);
+    }
 
-    LodePNGState state;
-    lodepng_state_init(&state);
-    // Invoked on custom formats.
-    state.lodepng_convert = &lodepng_convert_cb;
-    // Faster compression.
-    state.encoder.zlibsettings.windowsize = 1024;
+    uint32_t adler = (enc->adler_b << 16) | enc->adler_a;
+    for (int i = 24; i >= 0; i -= 8) {
+        png_put_byte(enc, adler >> i);
+    }
+
+    png_flush_idat(enc);
+}
+
+// Carves the encoder buffers out of work, returns the size needed if work is NULL.
+static uint32_t png_encoder_alloc(png_encoder_t *enc, image_t *src, uint8_t *work) {
+    uint32_t row_size = (enc->row_bytes + 1 + 3) & ~3;
+    uint32_t sizes[] = {
+        PNG_CHUNK_SIZE,
+        PNG_WINDOW_SIZE * 2,
+        PNG_HASH_SIZE * sizeof(uint16_t),
+        PNG_WINDOW_SIZE * sizeof(uint16_t),
+        PNG_BLOCK_SYMBOLS * sizeof(uint32_t),
+        row_size,
+        row_size,
+        row_size,
+        row_size,
+        IM_IS_GS(src) ? 0 : ((src->w * sizeof(uint16_t) + 3) & ~3)
+    };
+    void **buffers[] = {
+        (void **) &enc->chunk,
+        (void **) &enc->window,
+        (void **) &enc->head,
+        (void **) &enc->prev,
+        (void **) &enc->symbols,
+        (void **) &enc->row,
+        (void **) &enc->prev_row,
+        (void **) &enc->best,
+        (void **) &enc->test,
+        (void **) &enc->line
+    };
+
+    uint32_t size = 0;
+    for (int i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); i++) {
+        if (work) {
+            *buffers[i] = work + size;
+        }
+        size += sizes[i];
+    }
+
+    return size;
+}
 
+static void png_encoder_init(png_encoder_t *enc, image_t *src) {
     switch (src->pixfmt) {
         case PIXFORMAT_BINARY:
-            state.info_raw.bitdepth = 1;
-            state.info_raw.colortype = LCT_GREY;
-
-            state.encoder.auto_convert = false;
-            state.info_png.color.bitdepth = 8;
-            state.info_png.color.colortype = LCT_GREY;
+            enc->depth = 1;
+            enc->color_type = PNG_COLOR_GRAYSCALE;
+            enc->bpp = 1;
+            enc->row_bytes = (src->w + 7) / 8;
             break;
         case PIXFORMAT_GRAYSCALE:
-            state.info_raw.bitdepth = 8;
-            state.info_raw.colortype = LCT_GREY;
-
-            state.encoder.auto_convert = false;
-            state.info_png.color.bitdepth = 8;
-            state.info_png.color.colortype = LCT_GREY;
+            enc->depth = 8;
+            enc->color_type = PNG_COLOR_GRAYSCALE;
+            enc->bpp = 1;
+            enc->row_bytes = src->w;
             break;
         case PIXFORMAT_RGB565:
-            state.info_raw.bitdepth = 16;
-            state.info_raw.colortype = LCT_CUSTOM;
-            state.info_raw.customfmt = PIXFORMAT_RGB565;
+        case PIXFORMAT_BAYER_ANY:
+        case PIXFORMAT_YUV_ANY:
+            enc->depth = 8;
+            enc->color_type = PNG_COLOR_RGB;
+            enc->bpp = 3;
+            enc->row_bytes = src->w * 3;
+            break;
+        default:
+            mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Input format is not supported"));
+            break;
+    }
+}
+
+static void png_encode_row(png_encoder_t *enc, image_t *src, int y) {
+    uint8_t *row = enc->row + 1;
 
-            state.encoder.auto_convert = false;
-            state.info_png.color.bitdepth = 8;
-            state.info_png.color.colortype = LCT_RGB;
+    switch (src->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(src, y);
+            memset(row, 0, enc->row_bytes);
+            for (int x = 0; x < src->w; x++) {
+                row[x >> 3] |= IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x) << (7 - (x & 7));
+            }
             break;
-        case PIXFORMAT_YUV_ANY:
-            mp_raise_msg_varg(&mp_type_RuntimeError, MP_ERROR_TEXT("Input format is not supported"));
+        }
+        case PIXFORMAT_GRAYSCALE: {
+            memcpy(row, IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(src, y), src->w);
             break;
-        case PIXFORMAT_BAYER_ANY:
-            mp_raise_msg_varg(&mp_type_RuntimeError, MP_ERROR_TEXT("Input format is not supported"));
+        }
+        default: {
+            uint16_t *row_ptr;
+            if (src->is_bayer) {
+                imlib_debayer_line(0, src->w, y, enc->line, PIXFORMAT_RGB565, src);
+                row_ptr = enc->line;
+            } else if (src->is_yuv) {
+                imlib_deyuv_line(0, src->w, y, enc->line, PIXFORMAT_RGB565, src);
+                row_ptr = enc->line;
+            } else {
+                row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(src, y);
+            }
+            for (int x = 0; x < src->w; x++, row += 3) {
+                row[0] = COLOR_RGB565_TO_R8(row_ptr[x]);
+                row[1] = COLOR_RGB565_TO_G8(row_ptr[x]);
+                row[2] = COLOR_RGB565_TO_B8(row_ptr[x]);
+            }
             break;
+        }
     }
 
-    size_t png_size = 0;
-    uint8_t *png_data = NULL;
-    unsigned error = lodepng_encode(&png_data, &png_size, src->data, src->w, src->h, &state);
-    lodepng_state_cleanup(&state);
-    if (error) {
-        mp_raise_msg(&mp_type_RuntimeError, (mp_rom_error_text_t) lodepng_error_text(error));
+    // Pick the filter with the smallest sum of absolute (signed) differences. Sub-byte
+    // pixels are not filtered, as recommended by the spec.
+    uint8_t *cur = enc->row + 1, *prev = enc->prev_row + 1;
+    uint32_t best_cost = UINT32_MAX;
+    int bpp = enc->bpp, n_filters = (enc->depth < 8) ? 1 : 5;
+
+    for (int filter = 0; filter < n_filters; filter++) {
+        uint8_t *out = enc->test + 1;
+        uint32_t cost = 0;
+
+        for (uint32_t i = 0; i < enc->row_bytes; i++) {
+            int a = (i >= bpp) ? cur[i - bpp] : 0;
+            int b = prev[i];
+            int c = (i >= bpp) ? prev[i - bpp] : 0;
+            switch (filter) {
+                case PNG_FILTER_NONE:
+                    out[i] = cur[i];
+                    break;
+                case PNG_FILTER_SUB:
+                    out[i] = cur[i] - a;
+                    break;
+                case PNG_FILTER_UP:
+                    out[i] = cur[i] - b;
+                    break;
+                case PNG_FILTER_AVERAGE:
+                    out[i] = cur[i] - ((a + b) >> 1);
+                    break;
+                default:
+                    out[i] = cur[i] - png_paeth(a, b, c);
+                    break;
+            }
+            cost += abs((int8_t) out[i]);
+        }
+
+        if (cost < best_cost) {
+            uint8_t *tmp = enc->best;
+            enc->best = enc->test;
+            enc->test = tmp;
+            enc->best[0] = filter;
+            best_cost = cost;
+        }
     }
 
-    if (dst->data == NULL) {
-        dst->data = png_data;
-        dst->size = png_size;
-        // fb_alloc() memory ill be free'd by called.
-    } else {
-        if (image_size(dst) <= png_size) {
-            dst->size = png_size;
-            memcpy(dst->data, png_data, png_size);
-        } else {
-            mp_raise_msg_varg(&mp_type_RuntimeError,
-                              MP_ERROR_TEXT("Failed to compress image in place"));
+    png_deflate(enc, enc->best, enc->row_bytes + 1);
+
+    uint8_t *tmp = enc->prev_row;
+    enc->prev_row = enc->row;
+    enc->row = tmp;
+}
+
+static void png_encode(png_encoder_t *enc, image_t *src) {
+    uint8_t ihdr[13];
+    png_set_be32(&ihdr[0], src->w);
+    png_set_be32(&ihdr[4], src->h);
+    ihdr[8] = enc->depth;
+    ihdr[9] = enc->color_type;
+    ihdr[10] = 0; // deflate
+    ihdr[11] = 0; // adaptive filtering
+    ihdr[12] = 0; // no interlace
+
+    png_encoder_put(enc, png_signature, sizeof(png_signature));
+    png_write_chunk(enc, PNG_CHUNK_IHDR, ihdr, sizeof(ihdr));
+
+    enc->chunk_len = 0;
+    enc->bits = 0;
+    enc->n_bits = 0;
+    enc->adler_a = 1;
+    enc->adler_b = 0;
+    enc->pos = 0;
+    enc->end = 0;
+    enc->n_symbols = 0;
+    memset(enc->head, 0xFF, PNG_HASH_SIZE * sizeof(uint16_t));
+    memset(enc->prev, 0xFF, PNG_WINDOW_SIZE * sizeof(uint16_t));
+    memset(enc->prev_row, 0, enc->row_bytes + 1);
+
+    // zlib header (deflate, 32K window).
+    png_put_byte(enc, 0x78);
+    png_put_byte(enc, 0x01);
+
+    for (int y = 0; (y < src->h) && (!enc->overflow); y++) {
+        png_encode_row(enc, src, y);
+    }
+
+    png_deflate_finish(enc);
+    png_write_chunk(enc, PNG_CHUNK_IEND, NULL, 0);
+}
+
+bool png_compress(image_t *src, image_t *dst) {
+    #if (TIME_PNG == 1)
+    mp_uint_t start = mp_hal_ticks_ms();
+    #endif
+
+    if (src->is_compressed) {
+        return true;
+    }
+
+    png_encoder_t enc = { 0 };
+    png_encoder_init(&enc, src);
+    uint32_t work_size = png_encoder_alloc(&enc, src, NULL);
+    bool in_place = dst->data != NULL;
+
+    if (!in_place) {
+        // The encoder's buffers go at the end of the output buffer.
+        uint32_t size = 0;
+        dst->data = fb_alloc_all(&size, FB_ALLOC_PREFER_SIZE);
+        if (size <= work_size) {
+            fb_alloc_fail();
         }
-        // free fb_alloc() memory used for umm_init_x().
-        fb_free(); // umm_init_x();
+        enc.max_size = (size - work_size) & ~3;
+        png_encoder_alloc(&enc, src, dst->data + enc.max_size);
+    } else {
+        enc.max_size = dst->size;
+        png_encoder_alloc(&enc, src, fb_alloc(work_size, FB_ALLOC_NO_HINT));
+    }
+
+    enc.data = dst->data;
+    png_encode(&enc, src);
+
+    if (in_place) {
+        fb_free(); // work
     }
 
+    dst->size = enc.size;
+
     #if (TIME_PNG == 1)
     printf("time: %u ms\n", mp_hal_ticks_ms() - start);
     #endif
 
-    return false;
+    return enc.overflow;
 }
 #endif // IMLIB_ENABLE_PNG_ENCODER
 
 #if defined(IMLIB_ENABLE_PNG_DECODER)
+#define PNG_INFLATE_WINDOW      (32768)
+
+typedef struct png_huffman {
+    uint16_t count[PNG_MAX_BITS + 1];
+    uint16_t symbol[PNG_FIXED_LIT_CODES];
+} png_huffman_t;
+
+typedef struct png_decoder {
+    const uint8_t *data;
+    uint32_t size;
+    uint32_t pos;
+    const uint8_t *idat;
+    uint32_t idat_left;
+    uint32_t bits;
+    int n_bits;
+    uint8_t *window;
+    uint32_t window_pos;
+    png_huffman_t lit;
+    png_huffman_t dist;
+    // Image rows.
+    image_t *dst;
+    const uint8_t *palette;
+    uint32_t palette_size;
+    int depth;
+    int color_type;
+    int channels;
+    int bpp;
+    bool interlace;
+    bool done;
+    int pass;
+    int pass_x;
+    int pass_y;
+    int pass_dx;
+    int pass_dy;
+    int pass_w;
+    int pass_h;
+    int row_y;
+    uint32_t row_bytes;
+    uint32_t row_pos;
+    uint8_t *row;
+    uint8_t *prev_row;
+} png_decoder_t;
+
+// Adam7 pass x, y, dx, dy.
+static const uint8_t png_adam7[7][4] = {
+    {0, 0, 8, 8}, {4, 0, 8, 8}, {0, 4, 4, 8}, {2, 0, 4, 4}, {0, 2, 2, 4}, {1, 0, 2, 2}, {0, 1, 1, 2}
+};
+
+NORETURN static void png_raise_corrupted() {
+    mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Corrupted PNG"));
+}
+
+// Returns the type and data of the next chunk, after checking its CRC.
+static uint32_t png_next_chunk(png_decoder_t *dec, const uint8_t **data, uint32_t *size) {
+    if ((dec->size - dec->pos) < 12) {
+        png_raise_corrupted();
+    }
+
+    const uint8_t *p = dec->data + dec->pos;
+    uint32_t len = png_get_be32(p);
+
+    if (len > (dec->size - dec->pos - 12)) {
+        png_raise_corrupted();
+    }
+
+    if ((png_crc32(0xFFFFFFFF, p + 4, len + 4) ^ 0xFFFFFFFF) != png_get_be32(p + 8 + len)) {
+        png_raise_corrupted();
+    }
+
+    *data = p + 8;
+    *size = len;
+    dec->pos += len + 12;
+    return png_get_be32(p + 4);
+}
+
+static inline uint32_t png_get_bits(png_decoder_t *dec, int n) {
+    while (dec->n_bits < n) {
+        while (!dec->idat_left) {
+            if (png_next_chunk(dec, &dec->idat, &dec->idat_left) != PNG_CHUNK_IDAT) {
+                png_raise_corrupted();
+            }
+        }
+        dec->bits |= *dec->idat++ << dec->n_bits;
+        dec->idat_left--;
+        dec->n_bits += 8;
+    }
+
+    uint32_t value = dec->bits & ((1 << n) - 1);
+    dec->bits >>= n;
+    dec->n_bits -= n;
+    return value;
+}
+
+static void png_huffman_build(png_huffman_t *h, const uint8_t *lengths, int n) {
+    uint16_t offsets[PNG_MAX_BITS + 1];
+    memset(h->count, 0, sizeof(h->count));
+
+    for (int i = 0; i < n; i++) {
+        h->count[lengths[i]] += 1;
+    }
+
+    // Incomplete codes are fine (as long as unused codes don't show up), over-subscribed are not.
+    for (int len = 1, left = 1; len <= PNG_MAX_BITS; len++) {
+        left = (left << 1) - h->count[len];
+        if (left < 0) {
+            png_raise_corrupted();
+        }
+    }
+
+    offsets[1] = 0;
+    for (int len = 1; len < PNG_MAX_BITS; len++) {
+        offsets[len + 1] = offsets[len] + h->count[len];
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (lengths[i]) {
+            h->symbol[offsets[lengths[i]]++] = i;
+        }
+    }
+}
+
+static int png_huffman_decode(png_decoder_t *dec, const png_huffman_t *h) {
+    int code = 0, first = 0, index = 0;
+
+    for (int len = 1; len <= PNG_MAX_BITS; len++) {
+        code |= png_get_bits(dec, 1);
+        int count = h->count[len];
+        if ((code - count) < first) {
+            return h->symbol[index + (code - first)];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+
+    png_raise_corrupted();
+}
+
+// Sets up the next (non-empty) pass, or flags the image as done.
+static void png_decoder_pass(png_decoder_t *dec) {
+    for (; dec->pass < (dec->interlace ? 7 : 1); dec->pass++) {
+        const uint8_t *adam7 = dec->interlace ? png_adam7[dec->pass] : (const uint8_t []) {0, 0, 1, 1};
+        dec->pass_x = adam7[0];
+        dec->pass_y = adam7[1];
+        dec->pass_dx = adam7[2];
+        dec->pass_dy = adam7[3];
+        dec->pass_w = (dec->dst->w > dec->pass_x) ? ((dec->dst->w - dec->pass_x + dec->pass_dx - 1) / dec->pass_dx) : 0;
+        dec->pass_h = (dec->dst->h > dec->pass_y) ? ((dec->dst->h - dec->pass_y + dec->pass_dy - 1) / dec->pass_dy) : 0;
+
+        if (dec->pass_w && dec->pass_h) {
+            dec->row_bytes = ((dec->pass_w * dec->channels * dec->depth) + 7) / 8;
+            dec->row_pos = 0;
+            dec->row_y = 0;
+            memset(dec->prev_row, 0, dec->row_bytes + 1);
+            return;
+        }
+    }
+
+    dec->done = true;
+}
+
+static inline int png_get_sample(const uint8_t *row, int i, int depth) {
+    switch (depth) {
+        case 16:
+            return row[i * 2]; // MSB
+        case 8:
+            return row[i];
+        default: {
+            int bit = i * depth;
+            return (row[bit >> 3] >> (8 - depth - (bit & 7))) & ((1 << depth) - 1);
+        }
+    }
+}
+
+static void png_decoder_row(png_decoder_t *dec) {
+    uint8_t *row = dec->row + 1, *prev = dec->prev_row + 1;
+    int bpp = dec->bpp;
+
+    switch (dec->row[0]) {
+        case PNG_FILTER_NONE:
+            break;
+        case PNG_FILTER_SUB:
+            for (uint32_t i = bpp; i < dec->row_bytes; i++) {
+                row[i] += row[i - bpp];
+            }
+            break;
+        case PNG_FILTER_UP:
+            for (uint32_t i = 0; i < dec->row_bytes; i++) {
+                row[i] += prev[i];
+            }
+            break;
+        case PNG_FILTER_AVERAGE:
+            for (uint32_t i = 0; i < dec->row_bytes; i++) {
+                row[i] += (((i >= bpp) ? row[i - bpp] : 0) + prev[i]) >> 1;
+            }
+            break;
+        case PNG_FILTER_PAETH:
+            for (uint32_t i = 0; i < dec->row_bytes; i++) {
+                row[i] += (i >= bpp) ? png_paeth(row[i - bpp], prev[i], prev[i - bpp]) : prev[i];
+            }
+            break;
+        default:
+            png_raise_corrupted();
+    }
+
+    image_t *dst = dec->dst;
+    int y = dec->pass_y + (dec->row_y * dec->pass_dy);
+
+    if ((!dec->interlace) && (dec->depth == 8) && (dec->color_type == PNG_COLOR_GRAYSCALE)
+        && (dst->pixfmt == PIXFORMAT_GRAYSCALE)) {
+        memcpy(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(dst, y), row, dst->w);
+    } else {
+        int max = (1 << IM_MIN(dec->depth, 8)) - 1;
+
+        for (int i = 0, x = dec->pass_x; i < dec->pass_w; i++, x += dec->pass_dx) {
+            int r, g, b, s = i * dec->channels;
+
+            switch (dec->color_type) {
+                case PNG_COLOR_PALETTE: {
+                    uint32_t index = png_get_sample(row, s, dec->depth);
+                    if (index >= dec->palette_size) {
+                        png_raise_corrupted();
+                    }
+                    r = dec->palette[(index * 3) + 0];
+                    g = dec->palette[(index * 3) + 1];
+                    b = dec->palette[(index * 3) + 2];
+                    break;
+                }
+                case PNG_COLOR_RGB:
+                case PNG_COLOR_RGBA:
+                    r = png_get_sample(row, s + 0, dec->depth);
+                    g = png_get_sample(row, s + 1, dec->depth);
+                    b = png_get_sample(row, s + 2, dec->depth);
+                    break;
+                default: // Grayscale (alpha is ignored).
+                    r = g = b = (png_get_sample(row, s, dec->depth) * 255) / max;
+                    break;
+            }
+
+            switch (dst->pixfmt) {
+                case PIXFORMAT_BINARY: {
+                    int gray = (r == g && g == b) ? g : COLOR_RGB888_TO_Y(r, g, b);
+                    IMAGE_PUT_BINARY_PIXEL(dst, x, y, COLOR_GRAYSCALE_TO_BINARY(gray));
+                    break;
+                }
+                case PIXFORMAT_GRAYSCALE: {
+                    int gray = (r == g && g == b) ? g : COLOR_RGB888_TO_Y(r, g, b);
+                    IMAGE_PUT_GRAYSCALE_PIXEL(dst, x, y, gray);
+                    break;
+                }
+                default:
+                    IMAGE_PUT_RGB565_PIXEL(dst, x, y, COLOR_R8_G8_B8_TO_RGB565(r, g, b));
+                    break;
+            }
+        }
+    }
+
+    uint8_t *tmp = dec->prev_row;
+    dec->prev_row = dec->row;
+    dec->row = tmp;
+    dec->row_pos = 0;
+
+    if (++dec->row_y == dec->pass_h) {
+        dec->pass++;
+        png_decoder_pass(dec);
+    }
+}
+
+static inline void png_decoder_put(png_decoder_t *dec, uint8_t b) {
+    dec->window[dec->window_pos++ & (PNG_INFLATE_WINDOW - 1)] = b;
+    if (!dec->done) {
+        dec->row[dec->row_pos++] = b;
+        if (dec->row_pos == (dec->row_bytes + 1)) {
+            png_decoder_row(dec);
+        }
+    }
+}
+
+static void png_inflate_stored(png_decoder_t *dec) {
+    // Discard the bits left in the current byte.
+    dec->bits = 0;
+    dec->n_bits = 0;
+
+    uint32_t len = png_get_bits(dec, 16);
+    if ((len ^ 0xFFFF) != png_get_bits(dec, 16)) {
+        png_raise_corrupted();
+    }
+
+    while (len-- && (!dec->done)) {
+        png_decoder_put(dec, png_get_bits(dec, 8));
+    }
+}
+
+static void png_inflate_codes(png_decoder_t *dec) {
+    while (!dec->done) {
+        int sym = png_huffman_decode(dec, &dec->lit);
+
+        if (sym < 256) {
+            png_decoder_put(dec, sym);
+        } else if (sym == 256) {
+            break;
+        } else {
+            sym -= 257;
+            if (sym >= 29) {
+                png_raise_corrupted();
+            }
+
+            int len = png_length_base[sym] + png_get_bits(dec, png_length_extra[sym]);
+            int dsym = png_huffman_decode(dec, &dec->dist);
+            if (dsym >= 30) {
+                png_raise_corrupted();
+            }
+
+            uint32_t dist = png_dist_base[dsym] + png_get_bits(dec, png_dist_extra[dsym]);
+            if (dist > dec->window_pos) {
+                png_raise_corrupted();
+            }
+
+            while (len--) {
+                png_decoder_put(dec, dec->window[(dec->window_pos - dist) & (PNG_INFLATE_WINDOW - 1)]);
+            }
+        }
+    }
+}
+
+static void png_inflate_fixed(png_decoder_t *dec) {
+    uint8_t lit_len[PNG_FIXED_LIT_CODES], dist_len[PNG_DIST_CODES];
+    png_fixed_lengths(lit_len, dist_len);
+    png_huffman_build(&dec->lit, lit_len, PNG_FIXED_LIT_CODES);
+    png_huffman_build(&dec->dist, dist_len, PNG_DIST_CODES);
+    png_inflate_codes(dec);
+}
+
+static void png_inflate_dynamic(png_decoder_t *dec) {
+    uint8_t lengths[PNG_LIT_CODES + PNG_DIST_CODES] = {0};
+    int hlit = png_get_bits(dec, 5) + 257;
+    int hdist = png_get_bits(dec, 5) + 1;
+    int hclen = png_get_bits(dec, 4) + 4;
+
+    if ((hlit > PNG_LIT_CODES) || (hdist > PNG_DIST_CODES)) {
+        png_raise_corrupted();
+    }
+
+    for (int i = 0; i < hclen; i++) {
+        lengths[png_cl_order[i]] = png_get_bits(dec, 3);
+    }
+
+    png_huffman_build(&dec->lit, lengths, PNG_CL_CODES);
+
+    for (int i = 0, n = hlit + hdist; i < n;) {
+        int sym = png_huffman_decode(dec, &dec->lit);
+
+        if (sym < 16) {
+            lengths[i++] = sym;
+        } else {
+            int len = 0, repeat;
+            if (sym == 16) {
+                if (!i) {
+                    png_raise_corrupted();
+                }
+                len = lengths[i - 1];
+                repeat = 3 + png_get_bits(dec, 2);
+            } else if (sym == 17) {
+                repeat = 3 + png_get_bits(dec, 3);
+            } else {
+                repeat = 11 + png_get_bits(dec, 7);
+            }
+
+            if ((i + repeat) > n) {
+                png_raise_corrupted();
+            }
+
+            while (repeat--) {
+                lengths[i++] = len;
+            }
+        }
+    }
+
+    if (!lengths[256]) {
+        png_raise_corrupted();
+    }
+
+    png_huffman_build(&dec->lit, lengths, hlit);
+    png_huffman_build(&dec->dist, lengths + hlit, hdist);
+    png_inflate_codes(dec);
+}
+
 void png_decompress(image_t *dst, image_t *src) {
     #if (TIME_PNG == 1)
     mp_uint_t start = mp_hal_ticks_ms();
     #endif
 
-    umm_init_x(fb_avail());
+    png_decoder_t dec = { .data = src->data, .size = src->size, .pos = sizeof(png_signature), .dst = dst };
+    const uint8_t *data;
+    uint32_t size;
+
+    if ((src->size < sizeof(png_signature)) || memcmp(src->data, png_signature, sizeof(png_signature))) {
+        png_raise_corrupted();
+    }
 
-    LodePNGState state;
-    lodepng_state_init(&state);
-    // Invoked on custom formats.
-    state.lodepng_convert = &lodepng_convert_cb;
+    if ((png_next_chunk(&dec, &data, &size) != PNG_CHUNK_IHDR) || (size != 13)) {
+        png_raise_corrupted();
+    }
 
-    switch (dst->pixfmt) {
-        case PIXFORMAT_BINARY:
-            state.info_raw.bitdepth = 1;
-            state.info_raw.colortype = LCT_GREY;
+    uint32_t w = png_get_be32(data), h = png_get_be32(data + 4);
+    dec.depth = data[8];
+    dec.color_type = data[9];
+    dec.interlace = data[12];
+
+    switch (dec.color_type) {
+        case PNG_COLOR_GRAYSCALE:
+            dec.channels = 1;
             break;
-        case PIXFORMAT_GRAYSCALE:
-            state.info_raw.bitdepth = 8;
-            state.info_raw.colortype = LCT_GREY;
+        case PNG_COLOR_RGB:
+            dec.channels = 3;
             break;
-        case PIXFORMAT_RGB565:
-            state.info_raw.bitdepth = 16;
-            state.info_raw.colortype = LCT_CUSTOM;
-            state.info_raw.customfmt = PIXFORMAT_RGB565;
+        case PNG_COLOR_PALETTE:
+            dec.channels = 1;
             break;
+        case PNG_COLOR_GRAYSCALE_A:
+            dec.channels = 2;
+            break;
+        case PNG_COLOR_RGBA:
+            dec.channels = 4;
+            break;
+        default:
+            png_raise_corrupted();
+    }
+
+    bool sub_byte = (dec.color_type == PNG_COLOR_GRAYSCALE) || (dec.color_type == PNG_COLOR_PALETTE);
+    if (((dec.depth != 8) && (dec.depth != 16) &&
+         ((!sub_byte) || ((dec.depth != 1) && (dec.depth != 2) && (dec.depth != 4))))
+        || ((dec.depth == 16) && (dec.color_type == PNG_COLOR_PALETTE))
+        || data[10] || data[11] || (data[12] > 1) || (!w) || (!h)) {
+        png_raise_corrupted();
     }
 
-    uint8_t *png_data = NULL;
+    dec.bpp = IM_MAX((dec.channels * dec.depth) / 8, 1);
+
     uint32_t img_size = image_size(dst);
-    unsigned error = lodepng_decode(&png_data, (unsigned *) &dst->w, (unsigned *) &dst->h, &state, src->data, src->size);
-    lodepng_state_cleanup(&state);
-    if (error) {
-        mp_raise_msg(&mp_type_RuntimeError, (mp_rom_error_text_t) lodepng_error_text(error));
+    dst->w = w;
+    dst->h = h;
+    if (image_size(dst) > img_size) {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Failed to decompress image in place"));
     }
 
-    uint32_t new_img_size = image_size(dst);
-    if (new_img_size <= img_size) {
-        memcpy(dst->data, png_data, new_img_size);
-    } else {
-        mp_raise_msg_varg(&mp_type_RuntimeError,
-                          MP_ERROR_TEXT("Failed to compress image in place"));
+    if ((dst->pixfmt != PIXFORMAT_BINARY) && (dst->pixfmt != PIXFORMAT_GRAYSCALE)
+        && (dst->pixfmt != PIXFORMAT_RGB565)) {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Output format is not supported"));
     }
 
-    // free fb_alloc() memory used for umm_init_x().
-    fb_free(); // umm_init_x();
+    // Everything up to the first IDAT.
+    for (uint32_t type; (type = png_next_chunk(&dec, &data, &size)) != PNG_CHUNK_IDAT;) {
+        if (type == PNG_CHUNK_PLTE) {
+            dec.palette = data;
+            dec.palette_size = size / 3;
+        } else if (type == PNG_CHUNK_IEND) {
+            png_raise_corrupted();
+        }
+    }
+
+    if ((dec.color_type == PNG_COLOR_PALETTE) && (!dec.palette)) {
+        png_raise_corrupted();
+    }
+
+    dec.idat = data;
+    dec.idat_left = size;
+
+    fb_alloc_mark();
+
+    uint32_t row_size = ((w * dec.channels * dec.depth) + 7) / 8 + 1;
+    dec.window = fb_alloc(PNG_INFLATE_WINDOW, FB_ALLOC_NO_HINT);
+    dec.row = fb_alloc(row_size, FB_ALLOC_NO_HINT);
+    dec.prev_row = fb_alloc(row_size, FB_ALLOC_NO_HINT);
+
+    png_decoder_pass(&dec);
+
+    // zlib header.
+    uint32_t cmf = png_get_bits(&dec, 8), flg = png_get_bits(&dec, 8);
+    if (((cmf & 0xF) != 8) || (((cmf << 8) | flg) % 31) || (flg & 0x20)) {
+        png_raise_corrupted();
+    }
+
+    for (bool last = false; (!last) && (!dec.done);) {
+        last = png_get_bits(&dec, 1);
+        switch (png_get_bits(&dec, 2)) {
+            case 0:
+                png_inflate_stored(&dec);
+                break;
+            case 1:
+                png_inflate_fixed(&dec);
+                break;
+            case 2:
+                png_inflate_dynamic(&dec);
+                break;
+            default:
+                png_raise_corrupted();
+        }
+    }
+
+    if (!dec.done) {
+        png_raise_corrupted();
+    }
+
+    fb_alloc_free_till_mark();
 
     #if (TIME_PNG == 1)
     printf("time: %u ms\n", mp_hal_ticks_ms() - start);
     #endif
 }
 #endif // IMLIB_ENABLE_PNG_DECODER
-#endif // IMLIB_ENABLE_PNG_ENCODER || IMLIB_ENABLE_PNG_DECODER
-
 
 #if !defined(IMLIB_ENABLE_PNG_ENCODER)
 bool png_compress(image_t *src, image_t *dst) {
@@ -316,10 +1420,16 @@ void png_write(image_t *img, const char *path) {
     if (img->pixfmt == PIXFORMAT_PNG) {
         file_write(&fp, img->pixels, img->size);
     } else {
-        image_t out = { .w = img->w, .h = img->h, .pixfmt = PIXFORMAT_PNG, .size = 0, .pixels = NULL }; // alloc in png compress
-        png_compress(img, &out);
-        file_write(&fp, out.pixels, out.size);
-        fb_free(); // frees alloc in png_compress()
+        #if defined(IMLIB_ENABLE_PNG_ENCODER)
+        // Stream the PNG to the file.
+        png_encoder_t enc = { .fp = &fp };
+        png_encoder_init(&enc, img);
+        png_encoder_alloc(&enc, img, fb_alloc(png_encoder_alloc(&enc, img, NULL), FB_ALLOC_NO_HINT));
+        png_encode(&enc, img);
+        fb_free(); // work
+        #else
+        png_compress(img, NULL);
+        #endif
     }
     file_close(&fp);
 }
@@ -0,0 +1,122 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Multi-scale grayscale image pyramid shared between detectors.
+ */
+#include "imlib.h"
+#include "xalloc.h"
+
+// Nearest neighbour downscale used for every pyramid level (and by ORB without a pyramid).
+void imlib_pyramid_scale(image_t *src, image_t *dst) {
+    int x_ratio = (int) ((src->w << 16) / dst->w) + 1;
+    int y_ratio = (int) ((src->h << 16) / dst->h) + 1;
+
+    for (int y = 0; y < dst->h; y++) {
+        int sy = (y * y_ratio) >> 16;
+        for (int x = 0; x < dst->w; x++) {
+            int sx = (x * x_ratio) >> 16;
+            dst->pixels[y * dst->w + x] = IM_TO_GS_PIXEL(src, sx, sy);
+        }
+    }
+}
+
+// Level sizes must match the ones computed by the detectors exactly.
+static int pyramid_geometry(image_t *img, int n_levels, float scale_factor, wsize_t *sizes) {
+    int n = 0;
+    for (float scale = 1.0f; n < n_levels; scale *= scale_factor, n++) {
+        sizes[n].w = (int) roundf(img->w / scale);
+        sizes[n].h = (int) roundf(img->h / scale);
+        if ((sizes[n].w <= 0) || (sizes[n].h <= 0)) {
+            break;
+        }
+    }
+    return n;
+}
+
+void imlib_pyramid_init(image_pyramid_t *pyr) {
+    memset(pyr, 0, sizeof(image_pyramid_t));
+}
+
+void imlib_pyramid_free(image_pyramid_t *pyr) {
+    bool copy = pyr->copy;
+    for (int i = 0; i < pyr->n_levels; i++) {
+        // Level 0 aliases grayscale sources.
+        if (pyr->levels[i].data && (pyr->levels[i].data != pyr->src_data)) {
+            xfree(pyr->levels[i].data);
+        }
+    }
+    imlib_pyramid_init(pyr);
+    pyr->copy = copy;
+}
+
+void imlib_pyramid_build(image_pyramid_t *pyr, image_t *img, int n_levels, float scale_factor) {
+    wsize_t sizes[IMAGE_PYRAMID_MAX_LEVELS];
+    n_levels = pyramid_geometry(img, IM_CLAMP(n_levels, 1, IMAGE_PYRAMID_MAX_LEVELS), scale_factor, sizes);
+    bool grayscale = img->pixfmt == PIXFORMAT_GRAYSCALE;
+    bool alias = grayscale && (!pyr->copy);
+
+    // Reuse the level buffers when only the pixels changed.
+    if ((pyr->n_levels != n_levels)
+        || (pyr->scale_factor != scale_factor)
+        || (pyr->src_w != img->w)
+        || (pyr->src_h != img->h)
+        || ((pyr->levels[0].data == pyr->src_data) != alias)) {
+        imlib_pyramid_free(pyr);
+
+        for (int i = 0; i < n_levels; i++) {
+            pyr->levels[i].w = sizes[i].w;
+            pyr->levels[i].h = sizes[i].h;
+            pyr->levels[i].pixfmt = PIXFORMAT_GRAYSCALE;
+            if (i || !alias) {
+                pyr->levels[i].data = xalloc(sizes[i].w * sizes[i].h);
+            }
+        }
+
+        pyr->n_levels = n_levels;
+        pyr->scale_factor = scale_factor;
+    }
+
+    pyr->src_w = img->w;
+    pyr->src_h = img->h;
+    pyr->src_pixfmt = img->pixfmt;
+
+    if (alias) {
+        pyr->levels[0].data = img->data;
+    } else if (grayscale) {
+        memcpy(pyr->levels[0].data, img->data, img->w * img->h);
+    } else {
+        for (int y = 0; y < img->h; y++) {
+            uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&pyr->levels[0], y);
+            for (int x = 0; x < img->w; x++) {
+                row_ptr[x] = IM_TO_GS_PIXEL(img, x, y);
+            }
+        }
+    }
+
+    pyr->src_data = img->data;
+
+    // Every level samples level 0 so results match scaling the source directly.
+    for (int i = 1; i < n_levels; i++) {
+        imlib_pyramid_scale(&pyr->levels[0], &pyr->levels[i]);
+    }
+}
+
+bool imlib_pyramid_is_valid(image_pyramid_t *pyr, image_t *img) {
+    return pyr->n_levels
+           && (pyr->src_data == img->data)
+           && (pyr->src_w == img->w)
+           && (pyr->src_h == img->h)
+           && (pyr->src_pixfmt == img->pixfmt);
+}
+
+image_t *imlib_pyramid_get_level(image_pyramid_t *pyr, int level) {
+    if ((level < 0) || (level >= pyr->n_levels)) {
+        return NULL;
+    }
+    return &pyr->levels[level];
+}
@@ -2957,8 +2957,129 @@ const char *quirc_strerror(quirc_decode_error_t err)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void imlib_find_qrcodes(list_t *out, image_t *ptr, rectangle_t *roi)
+// A scanline through a finder pattern stone crosses 1:1:3:1:1 dark/light/dark/light/dark runs.
+// The stone is at least 3 rows tall, so sampling every other row can't step over one.
+#define QRCODE_PRESCAN_Y_STEP 2
+
+// Thresholds every other row of the roi like threshold() and runs the finder_scan() ratio test
+// on it, reading the source image directly instead of building the full quirc buffer. Returns
+// false if no finder pattern was found, otherwise sets region to the part of the roi around them.
+static bool qrcode_prescan(image_t *ptr, rectangle_t *roi, rectangle_t *region)
+{
+    int w = roi->w;
+    int threshold_s = IM_MAX(w / THRESHOLD_S_DEN, THRESHOLD_S_MIN);
+    int fracmul = (32768 * (threshold_s - 1)) / threshold_s;
+    int fracmul2 = (0x100000 * (100 - THRESHOLD_T)) / (200 * threshold_s);
+    uint8_t *row = fb_alloc(w, FB_ALLOC_NO_HINT);
+    int *row_average = fb_alloc(w * sizeof(int), FB_ALLOC_NO_HINT);
+    int x_min = INT_MAX, x_max = INT_MIN, y_min = INT_MAX, y_max = INT_MIN, size_max = 0;
+
+    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += QRCODE_PRESCAN_Y_STEP) {
+        switch (ptr->pixfmt) {
+            case PIXFORMAT_BINARY: {
+                uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(ptr, y);
+                for (int x = 0; x < w; x++) {
+                    row[x] = COLOR_BINARY_TO_GRAYSCALE(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, roi->x + x));
+                }
+                break;
+            }
+            case PIXFORMAT_GRAYSCALE: {
+                memcpy(row, IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(ptr, y) + roi->x, w);
+                break;
+            }
+            case PIXFORMAT_RGB565: {
+                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(ptr, y) + roi->x;
+                for (int x = 0; x < w; x++) {
+                    row[x] = COLOR_RGB565_TO_Y(row_ptr[x]);
+                }
+                break;
+            }
+        }
+
+        int avg_w = 0, avg_u = 0;
+        memset(row_average, 0, w * sizeof(int));
+
+        for (int x = 0; x < w; x++) {
+            int u = w - 1 - x;
+            avg_w = ((avg_w * fracmul) >> 15) + row[x];
+            avg_u = ((avg_u * fracmul) >> 15) + row[u];
+            row_average[x] += avg_w;
+            row_average[u] += avg_u;
+        }
+
+        for (int x = 0; x < w; x++) {
+            row[x] = (row[x] < ((row_average[x] * fracmul2) >> 20)) ? QUIRC_PIXEL_BLACK : QUIRC_PIXEL_WHITE;
+        }
+
+        int pb[5] = {0, 0, 0, 0, 0};
+        int run_length = 1, run_count = 0;
+
+        for (int x = 1; x < w; x++) {
+            if (row[x] != row[x - 1]) {
+                memmove(pb, pb + 1, sizeof(pb[0]) * 4);
+                pb[4] = run_length;
+                run_length = 0;
+                run_count++;
+
+                if ((row[x] == QUIRC_PIXEL_WHITE) && (run_count >= 5)) {
+                    int avg = (pb[0] + pb[1] + pb[3] + pb[4]) / 4;
+                    int err = avg * 3 / 4;
+                    bool ok = true;
+
+                    for (int i = 0; i < 5; i++) {
+                        int check = (i == 2) ? 3 : 1;
+                        if ((pb[i] < ((check * avg) - err)) || (pb[i] > ((check * avg) + err))) {
+                            ok = false;
+                        }
+                    }
+
+                    if (ok) {
+                        int size = pb[0] + pb[1] + pb[2] + pb[3] + pb[4];
+                        x_min = IM_MIN(x_min, x - size);
+                        x_max = IM_MAX(x_max, x);
+                        y_min = IM_MIN(y_min, y);
+                        y_max = IM_MAX(y_max, y);
+                        size_max = IM_MAX(size_max, size);
+                    }
+                }
+            }
+
+            run_length++;
+        }
+    }
+
+    fb_free(); // row_average
+    fb_free(); // row
+
+    if (x_max < x_min) {
+        return false;
+    }
+
+    // Finder pattern centers are 3.5 modules inside the code corners and a finder pattern is 7
+    // modules wide, so a margin of one finder pattern covers the code and part of its quiet zone.
+    int margin = IM_MAX(size_max, 8);
+    int x0 = IM_MAX(roi->x + x_min - margin, roi->x);
+    int y0 = IM_MAX(y_min - margin, roi->y);
+    int x1 = IM_MIN(roi->x + x_max + margin, roi->x + roi->w);
+    int y1 = IM_MIN(y_max + margin, roi->y + roi->h);
+    rectangle_init(region, x0, y0, x1 - x0, y1 - y0);
+    return true;
+}
+
+void imlib_find_qrcodes(list_t *out, image_t *ptr, rectangle_t *roi_in)
 {
+    rectangle_t region, *roi = roi_in;
+    list_init(out, sizeof(find_qrcodes_list_lnk_data_t));
+
+    // Skip decoding entirely if no finder patterns are visible, otherwise only decode around them.
+    if ((ptr->pixfmt == PIXFORMAT_BINARY) || (ptr->pixfmt == PIXFORMAT_GRAYSCALE) || (ptr->pixfmt == PIXFORMAT_RGB565)) {
+        if (!qrcode_prescan(ptr, roi_in, &region)) {
+            return;
+        }
+
+        roi = &region;
+    }
+
     struct quirc *controller = quirc_new();
     quirc_resize(controller, roi->w, roi->h);
     uint8_t *grayscale_image = quirc_begin(controller, NULL, NULL);
@@ -2971,7 +3092,6 @@ void imlib_find_qrcodes(list_t *out, image_t *ptr, rectangle_t *roi)
     imlib_draw_image(&img, ptr, 0, 0, 1.f, 1.f, roi, -1, 256, NULL, NULL, 0, NULL, NULL, NULL);
 
     quirc_end(controller);
-    list_init(out, sizeof(find_qrcodes_list_lnk_data_t));
 
     for (int i = 0, j = quirc_count(controller); i < j; i++) {
         struct quirc_code *code = fb_alloc(sizeof(struct quirc_code), FB_ALLOC_NO_HINT);
@@ -0,0 +1,238 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Packed RAW10/RAW12 bayer images.
+ *
+ * Pixels are stored in groups (4 pixels in 5 bytes for RAW10, 2 pixels in 3 bytes for RAW12)
+ * of the high 8 bits of each pixel followed by a byte with their low bits. A partial group at
+ * the end of a row is stored the same way, with the low bits byte after its high bytes.
+ */
+#include <string.h>
+#include "imlib.h"
+#include "fb_alloc.h"
+#include "fmath.h"
+
+// Returns the number of pixels in a group and the number of low bits of each pixel.
+static int raw_group(pixformat_t pixfmt, int *shift) {
+    image_t img = { .pixfmt = pixfmt };
+    bool raw10 = img.pixfmt_id == PIXFORMAT_ID_RAW10;
+    *shift = raw10 ? 2 : 4;
+    return raw10 ? 4 : 2;
+}
+
+void imlib_raw_pack_row(pixformat_t pixfmt, int w, const uint16_t *src, uint8_t *dst) {
+    int shift, group = raw_group(pixfmt, &shift), mask = (1 << shift) - 1;
+
+    for (int x = 0; x < w; x += group) {
+        int n = IM_MIN(w - x, group), low = 0;
+
+        for (int i = 0; i < n; i++) {
+            int p = src[x + i];
+            *dst++ = p >> shift;
+            low |= (p & mask) << (i * shift);
+        }
+
+        *dst++ = low;
+    }
+}
+
+void imlib_raw_unpack_row(pixformat_t pixfmt, int w, const uint8_t *src, uint16_t *dst) {
+    int shift, group = raw_group(pixfmt, &shift), mask = (1 << shift) - 1;
+    int x = 0;
+
+    if (group == 4) {
+        for (; (x + 4) <= w; x += 4, src += 5) {
+            int low = src[4];
+            dst[x] = (src[0] << 2) | (low & 3);
+            dst[x + 1] = (src[1] << 2) | ((low >> 2) & 3);
+            dst[x + 2] = (src[2] << 2) | ((low >> 4) & 3);
+            dst[x + 3] = (src[3] << 2) | (low >> 6);
+        }
+    } else {
+        for (; (x + 2) <= w; x += 2, src += 3) {
+            int low = src[2];
+            dst[x] = (src[0] << 4) | (low & 15);
+            dst[x + 1] = (src[1] << 4) | (low >> 4);
+        }
+    }
+
+    // Partial last group.
+    if (x < w) {
+        for (int i = 0, n = w - x; i < n; i++) {
+            dst[x + i] = (src[i] << shift) | ((src[n] >> (i * shift)) & mask);
+        }
+    }
+}
+
+int imlib_raw_get_pixel(image_t *img, int x, int y) {
+    int shift, group = raw_group(img->pixfmt, &shift);
+    int n = IM_MIN(img->w - ((x / group) * group), group), i = x % group;
+    const uint8_t *ptr = IMAGE_COMPUTE_RAW_PIXEL_ROW_PTR(img, y) + ((x / group) * (group + 1));
+    return (ptr[i] << shift) | ((ptr[n] >> (i * shift)) & ((1 << shift) - 1));
+}
+
+#ifdef IMLIB_ENABLE_ISP_OPS
+// Channel (0 = red, 1 = green, 2 = blue) of each site as imlib_debayer_image() interpolates it,
+// indexed by [y % 2][x % 2].
+static const uint8_t raw_bayer_sites[4][2][2] = {
+    {{2, 1}, {1, 0}}, // SUBFORMAT_ID_BGGR
+    {{1, 2}, {0, 1}}, // SUBFORMAT_ID_GBRG
+    {{1, 0}, {2, 1}}, // SUBFORMAT_ID_GRBG
+    {{0, 1}, {1, 2}}, // SUBFORMAT_ID_RGGB
+};
+
+// Per channel means and maxima at the native bit depth, and, if hist isn't NULL, a histogram of
+// all pixels in bins (a power of 2) over the full range. Every row_step'th row pair is sampled.
+void imlib_raw_stats(image_t *img, int row_step, uint32_t *mean, uint32_t *max, uint32_t *hist, int bins) {
+    int hist_shift = IMAGE_RAW_BITS(img) - __builtin_ctz(bins);
+    uint64_t acc[3] = {0, 0, 0};
+    uint32_t count[3] = {0, 0, 0};
+    const uint8_t (*sites)[2] = raw_bayer_sites[img->subfmt_id];
+
+    row_step = IM_MAX(row_step, 1);
+    max[0] = max[1] = max[2] = 0;
+
+    if (hist) {
+        memset(hist, 0, bins * sizeof(uint32_t));
+    }
+
+    fb_alloc_mark();
+    uint16_t *row = fb_alloc(img->w * sizeof(uint16_t), FB_ALLOC_NO_HINT);
+
+    for (int y = 0; y < img->h; y++) {
+        if ((y / 2) % row_step) {
+            continue;
+        }
+
+        imlib_raw_unpack_row(img->pixfmt, img->w, IMAGE_COMPUTE_RAW_PIXEL_ROW_PTR(img, y), row);
+
+        int c0 = sites[y % 2][0], c1 = sites[y % 2][1];
+        uint32_t acc0 = 0, acc1 = 0;
+        int max0 = max[c0], max1 = max[c1];
+        int x = 0;
+
+        for (; (x + 1) < img->w; x += 2) {
+            int p0 = row[x], p1 = row[x + 1];
+            acc0 += p0;
+            acc1 += p1;
+            max0 = IM_MAX(max0, p0);
+            max1 = IM_MAX(max1, p1);
+
+            if (hist) {
+                hist[p0 >> hist_shift] += 1;
+                hist[p1 >> hist_shift] += 1;
+            }
+        }
+
+        if (x < img->w) {
+            acc0 += row[x];
+            max0 = IM_MAX(max0, (int) row[x]);
+
+            if (hist) {
+                hist[row[x] >> hist_shift] += 1;
+            }
+        }
+
+        acc[c0] += acc0;
+        acc[c1] += acc1;
+        count[c0] += (img->w + 1) / 2;
+        count[c1] += img->w / 2;
+        max[c0] = max0;
+        max[c1] = max1;
+    }
+
+    for (int c = 0; c < 3; c++) {
+        mean[c] = count[c] ? ((acc[c] + (count[c] / 2)) / count[c]) : 0;
+    }
+
+    fb_alloc_free_till_mark();
+}
+
+// Fills the red, green and blue LUTs (2^bits entries each) that tone map the input levels to
+// 8 bits. Levels are scaled by the channel gain so that white maps to 255, and then follow the
+// gamma/contrast/brightness curve of imlib_gamma().
+void imlib_raw_luts(uint8_t *luts, int bits, int white, const float *gains,
+                    float gamma, float contrast, float brightness) {
+    int levels = 1 << bits;
+    gamma = IM_DIV(1.0f, gamma);
+
+    for (int c = 0; c < 3; c++) {
+        float scale = gains[c] / IM_MAX(white, 1);
+
+        for (int i = 0; i < levels; i++) {
+            float v = IM_MIN(i * scale, 1.0f);
+            int p = ((fast_powf(v, gamma) * contrast) + brightness) * COLOR_GRAYSCALE_MAX;
+            luts[(c * levels) + i] = IM_MAX(IM_MIN(p, COLOR_GRAYSCALE_MAX), COLOR_GRAYSCALE_MIN);
+        }
+    }
+}
+
+// Tone maps row y to 8 bits through the LUTs of its even and odd sites, reading packed pixels.
+static void raw_tone_row(image_t *src, int y, const uint8_t *lut0, const uint8_t *lut1, uint8_t *dst) {
+    const uint8_t *ptr = IMAGE_COMPUTE_RAW_PIXEL_ROW_PTR(src, y);
+    int x = 0, w = src->w;
+
+    if (src->pixfmt_id == PIXFORMAT_ID_RAW10) {
+        for (; (x + 4) <= w; x += 4, ptr += 5) {
+            int low = ptr[4];
+            dst[x] = lut0[(ptr[0] << 2) | (low & 3)];
+            dst[x + 1] = lut1[(ptr[1] << 2) | ((low >> 2) & 3)];
+            dst[x + 2] = lut0[(ptr[2] << 2) | ((low >> 4) & 3)];
+            dst[x + 3] = lut1[(ptr[3] << 2) | (low >> 6)];
+        }
+    } else {
+        for (; (x + 2) <= w; x += 2, ptr += 3) {
+            int low = ptr[2];
+            dst[x] = lut0[(ptr[0] << 4) | (low & 15)];
+            dst[x + 1] = lut1[(ptr[1] << 4) | (low >> 4)];
+        }
+    }
+
+    if (x < w) {
+        uint16_t tail[4];
+        imlib_raw_unpack_row(src->pixfmt, w - x, ptr, tail);
+
+        for (int i = 0; (x + i) < w; i++) {
+            dst[x + i] = ((x + i) % 2) ? lut1[tail[i]] : lut0[tail[i]];
+        }
+    }
+}
+
+// Develops a packed image to a BAYER, GRAYSCALE or RGB565 image of the same size in one pass.
+// Each row is tone mapped to 8 bits with the channel LUTs of imlib_raw_luts() and debayered as
+// it goes, so the packed pixels are read once and never unpacked to 16 bits.
+void imlib_raw_develop(image_t *dst, image_t *src, const uint8_t *luts) {
+    int levels = 1 << IMAGE_RAW_BITS(src);
+    const uint8_t (*sites)[2] = raw_bayer_sites[src->subfmt_id];
+    debayer_stream_t stream;
+    uint8_t *row = NULL;
+
+    fb_alloc_mark();
+
+    if (!dst->is_bayer) {
+        image_t bayer = { .pixfmt = PIXFORMAT_BAYER };
+        bayer.subfmt_id = src->subfmt_id;
+        row = fb_alloc(src->w * (DEBAYER_STREAM_ROWS + 1), FB_ALLOC_NO_HINT);
+        imlib_debayer_stream_init(&stream, src->w, src->h, bayer.pixfmt, row + src->w);
+    }
+
+    for (int y = 0; y < src->h; y++) {
+        const uint8_t *lut0 = luts + (sites[y % 2][0] * levels);
+        const uint8_t *lut1 = luts + (sites[y % 2][1] * levels);
+
+        if (dst->is_bayer) {
+            raw_tone_row(src, y, lut0, lut1, IMAGE_COMPUTE_BAYER_PIXEL_ROW_PTR(dst, y));
+        } else {
+            raw_tone_row(src, y, lut0, lut1, row);
+            imlib_debayer_stream_push(&stream, y, row, dst);
+        }
+    }
+
+    fb_alloc_free_till_mark();
+}
+#endif // IMLIB_ENABLE_ISP_OPS
@@ -8,8 +8,11 @@
  *
  * Rectangle functions.
  */
+#include <stddef.h>
+#include <stdlib.h>
 #include "imlib.h"
 #include "array.h"
+#include "rsort.h"
 #include "xalloc.h"
 
 rectangle_t *rectangle_alloc(int16_t x, int16_t y, int16_t w, int16_t h) {
@@ -145,6 +148,21 @@ void rectangle_nms_add_bounding_box(list_t *bounding_boxes, bounding_box_lnk_dat
     }
 }
 
+// Sorts the boxes array by score and merges it into the sorted list of bounding boxes in one pass.
+void rectangle_nms_add_bounding_boxes(list_t *bounding_boxes, bounding_box_lnk_data_t *boxes, size_t n) {
+    rsort(boxes, n, sizeof(bounding_box_lnk_data_t), offsetof(bounding_box_lnk_data_t, score), RSORT_KEY_F32, true);
+
+    list_lnk_t *it = bounding_boxes->head;
+    for (size_t i = 0; i < n; i++) {
+        while (it && (((bounding_box_lnk_data_t *) it->data)->score >= boxes[i].score)) {
+            it = it->next;
+        }
+
+        // Pushes back if it is NULL.
+        list_insert(bounding_boxes, it, &boxes[i]);
+    }
+}
+
 // Soft non-max supress the list of bounding boxes. Returns the maximum label index of the new list.
 int rectangle_nms_get_bounding_boxes(list_t *bounding_boxes, float threshold, float sigma) {
     // Soft non-max suppression with a Gaussian is used below, as this provides the best results.
@@ -0,0 +1,196 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Radix and counting sorts of struct arrays by an integer or float key.
+ */
+#include <string.h>
+#include "fb_alloc.h"
+#include "rsort.h"
+
+#define RSORT_RADIX_BITS    (8)
+#define RSORT_RADIX_MASK    ((1 << RSORT_RADIX_BITS) - 1)
+
+static const uint8_t rsort_key_bits[] = {
+    [RSORT_KEY_U8] = 8,
+    [RSORT_KEY_U16] = 16,
+    [RSORT_KEY_U32] = 32,
+    [RSORT_KEY_I32] = 32,
+    [RSORT_KEY_F32] = 32,
+};
+
+// Loads the key of an element mapped to an unsigned integer that sorts in the same order.
+static inline uint32_t rsort_get_key(const uint8_t *element, size_t key_offset, rsort_key_t key) {
+    const uint8_t *ptr = element + key_offset;
+
+    if (key == RSORT_KEY_U8) {
+        return *ptr;
+    }
+
+    if (key == RSORT_KEY_U16) {
+        uint16_t value;
+        memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+
+    if (key == RSORT_KEY_I32) {
+        return value ^ 0x80000000;
+    }
+
+    // Negative floats sort in reverse order of their bits.
+    if (key == RSORT_KEY_F32) {
+        return value ^ ((value & 0x80000000) ? 0xFFFFFFFF : 0x80000000);
+    }
+
+    return value;
+}
+
+static inline uint32_t rsort_get_digit(const uint8_t *element, size_t key_offset, rsort_key_t key,
+                                       int shift, uint32_t mask, uint32_t digit_max, bool descending) {
+    uint32_t digit = (rsort_get_key(element, key_offset, key) >> shift) & mask;
+
+    if (digit > digit_max) {
+        digit = digit_max;
+    }
+
+    return descending ? (digit_max - digit) : digit;
+}
+
+// Counting sort of src into dst by one digit, counts must hold digit_max + 1 entries. Returns
+// false without writing dst when all elements have the same digit.
+static bool rsort_pass(const uint8_t *src, uint8_t *dst, size_t n, size_t size, size_t key_offset,
+                       rsort_key_t key, int shift, uint32_t mask, uint32_t digit_max, bool descending,
+                       uint32_t *counts) {
+    memset(counts, 0, (digit_max + 1) * sizeof(uint32_t));
+
+    for (size_t i = 0; i < n; i++) {
+        counts[rsort_get_digit(src + (i * size), key_offset, key, shift, mask, digit_max, descending)]++;
+    }
+
+    if (counts[rsort_get_digit(src, key_offset, key, shift, mask, digit_max, descending)] == n) {
+        return false;
+    }
+
+    for (uint32_t i = 0, sum = 0; i <= digit_max; i++) {
+        uint32_t count = counts[i];
+        counts[i] = sum;
+        sum += count;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t *element = src + (i * size);
+        uint32_t digit = rsort_get_digit(element, key_offset, key, shift, mask, digit_max, descending);
+        memcpy(dst + (counts[digit]++ * size), element, size);
+    }
+
+    return true;
+}
+
+void rsort(void *data, size_t n, size_t size, size_t key_offset, rsort_key_t key, bool descending) {
+    if (n < 2) {
+        return;
+    }
+
+    fb_alloc_mark();
+    uint8_t *src = data;
+    uint8_t *dst = fb_alloc(n * size, FB_ALLOC_NO_HINT);
+    uint32_t *counts = fb_alloc((RSORT_RADIX_MASK + 1) * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+
+    for (int shift = 0; shift < rsort_key_bits[key]; shift += RSORT_RADIX_BITS) {
+        if (rsort_pass(src, dst, n, size, key_offset, key, shift,
+                       RSORT_RADIX_MASK, RSORT_RADIX_MASK, descending, counts)) {
+            uint8_t *tmp = src;
+            src = dst;
+            dst = tmp;
+        }
+    }
+
+    if (src != data) {
+        memcpy(data, src, n * size);
+    }
+
+    fb_alloc_free_till_mark();
+}
+
+void csort(void *data, size_t n, size_t size, size_t key_offset, rsort_key_t key, uint32_t key_max, bool descending) {
+    if (n < 2) {
+        return;
+    }
+
+    fb_alloc_mark();
+    uint8_t *dst = fb_alloc(n * size, FB_ALLOC_NO_HINT);
+    uint32_t *counts = fb_alloc((key_max + 1) * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+
+    if (rsort_pass(data, dst, n, size, key_offset, key, 0, UINT32_MAX, key_max, descending, counts)) {
+        memcpy(data, dst, n * size);
+    }
+
+    fb_alloc_free_till_mark();
+}
+
+size_t rsort_top_k(void *data, size_t n, size_t size, size_t key_offset, rsort_key_t key, size_t k) {
+    if (k > n) {
+        k = n;
+    }
+
+    if (k && (k < n)) {
+        fb_alloc_mark();
+        uint32_t *counts = fb_alloc((RSORT_RADIX_MASK + 1) * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+        uint8_t *tmp = fb_alloc(size, FB_ALLOC_NO_HINT);
+
+        // Finds the key of the k-th largest element a digit at a time, starting with the most
+        // significant digit and only counting elements that match the digits found so far.
+        uint32_t threshold = 0, threshold_mask = 0;
+        size_t above = 0;
+
+        for (int shift = rsort_key_bits[key] - RSORT_RADIX_BITS; shift >= 0; shift -= RSORT_RADIX_BITS) {
+            memset(counts, 0, (RSORT_RADIX_MASK + 1) * sizeof(uint32_t));
+
+            for (size_t i = 0; i < n; i++) {
+                uint32_t value = rsort_get_key(((uint8_t *) data) + (i * size), key_offset, key);
+                if ((value & threshold_mask) == threshold) {
+                    counts[(value >> shift) & RSORT_RADIX_MASK]++;
+                }
+            }
+
+            uint32_t digit = RSORT_RADIX_MASK;
+            for (; digit && ((above + counts[digit]) < k); digit--) {
+                above += counts[digit];
+            }
+
+            threshold |= digit << shift;
+            threshold_mask |= ((uint32_t) RSORT_RADIX_MASK) << shift;
+        }
+
+        // Moves all elements above the threshold and enough equal to it to the front.
+        size_t ties = k - above;
+
+        for (size_t i = 0, j = 0; j < k; i++) {
+            uint8_t *element = ((uint8_t *) data) + (i * size);
+            uint32_t value = rsort_get_key(element, key_offset, key);
+
+            if ((value > threshold) || ((value == threshold) && ties && ties--)) {
+                if (i != j) {
+                    uint8_t *front = ((uint8_t *) data) + (j * size);
+                    memcpy(tmp, front, size);
+                    memcpy(front, element, size);
+                    memcpy(element, tmp, size);
+                }
+
+                j++;
+            }
+        }
+
+        fb_alloc_free_till_mark();
+    }
+
+    rsort(data, k, size, key_offset, key, true);
+    return k;
+}
@@ -0,0 +1,33 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Radix and counting sorts of struct arrays by an integer or float key.
+ */
+#ifndef __RSORT_H__
+#define __RSORT_H__
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Type of the key found at key_offset in each element.
+typedef enum rsort_key {
+    RSORT_KEY_U8,
+    RSORT_KEY_U16,
+    RSORT_KEY_U32,
+    RSORT_KEY_I32,
+    RSORT_KEY_F32,
+} rsort_key_t;
+
+// Stable LSD radix sort of n elements of size bytes. Temporaries are fb_alloc'd.
+void rsort(void *data, size_t n, size_t size, size_t key_offset, rsort_key_t key, bool descending);
+// Stable counting sort for keys in [0, key_max]. Temporaries are fb_alloc'd.
+void csort(void *data, size_t n, size_t size, size_t key_offset, rsort_key_t key, uint32_t key_max, bool descending);
+// Moves the k elements with the largest keys to the front of data, sorted in descending order,
+// without sorting the rest. Returns the number of elements moved (min(n, k)).
+size_t rsort_top_k(void *data, size_t n, size_t size, size_t key_offset, rsort_key_t key, size_t k);
+#endif /* __RSORT_H__ */
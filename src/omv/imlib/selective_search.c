@@ -17,7 +17,13 @@
 #include "xalloc.h"
 #ifdef IMLIB_ENABLE_SELECTIVE_SEARCH
 
-#define THRESHOLD(size, c)    (c / size)
+// Edge weights are the rounded RGB888 distance, at most sqrt(3 * 255^2).
+#define EDGE_WEIGHT_MAX       (442)
+// Thresholds are kept in Q8 so they can grow by fractions of c / size.
+#define THRESHOLD(size, c)    ((c) / (size))
+#define HISTOGRAM_BINS        (75)
+// Normalized histogram bins are in Q8, the largest bin of a region is 256.
+#define HISTOGRAM_ONE         (256)
 typedef struct {
     uint16_t y;
     uint16_t h;
@@ -37,7 +43,7 @@ typedef struct {
 } universe;
 
 typedef struct {
-    float w;
+    uint16_t w;
     uint16_t a;
     uint16_t b;
 } edge;
@@ -48,12 +54,6 @@ static inline int min(int a, int b) {
 static inline int max(int a, int b) {
     return (a > b) ? a : b;
 }
-static inline float minf(float a, float b) {
-    return (a < b) ? a : b;
-}
-static inline float maxf(float a, float b) {
-    return (a > b) ? a : b;
-}
 extern uint32_t rng_randint(uint32_t min, uint32_t max);
 
 static universe *universe_create(int elements) {
@@ -108,12 +108,12 @@ static void universe_set_id(universe *this, int x, int id) {
     this->elts[x].rank = id;
 }
 
-static inline float color_similarity(float *hist1, float *hist2) {
-    float sim = 0;
-    for (int i = 0; i < 75; ++i) {
-        sim += minf(hist1[i], hist2[i]);
+static inline float color_similarity(uint16_t *hist1, uint16_t *hist2) {
+    int sim = 0;
+    for (int i = 0; i < HISTOGRAM_BINS; ++i) {
+        sim += min(hist1[i], hist2[i]);
     }
-    return sim;
+    return sim / (float) HISTOGRAM_ONE;
 }
 
 static inline float size_similarity(int a, int b, int size) {
@@ -126,11 +126,7 @@ static inline float fill_similarity(region *ra, region *rb, int a, int b, int si
     return 1.0f - (width * height - a - b) / size;
 }
 
-static inline float square(float x) {
-    return x * x;
-};
-
-static inline float diff(image_t *img, int x1, int y1, int x2, int y2) {
+static inline int diff(image_t *img, int x1, int y1, int x2, int y2) {
     uint16_t p1 = IMAGE_GET_RGB565_PIXEL(img, x1, y1);
     uint16_t p2 = IMAGE_GET_RGB565_PIXEL(img, x2, y2);
     uint8_t r1 = COLOR_RGB565_TO_R8(p1);
@@ -142,38 +138,27 @@ static inline float diff(image_t *img, int x1, int y1, int x2, int y2) {
     uint8_t b1 = COLOR_RGB565_TO_B8(p1);
     uint8_t b2 = COLOR_RGB565_TO_B8(p2);
     // dissimilarity measure between pixels
-    return sqrtf((r1 - r2) * (r1 - r2) + (g1 - g2) * (g1 - g2) + (b1 - b2) * (b1 - b2));
-}
-
-int comp(const void *elem1, const void *elem2) {
-    edge *f = (edge *) elem1;
-    edge *s = (edge *) elem2;
-    if (f->w > s->w) {
-        return 1;
-    }
-    if (f->w < s->w) {
-        return -1;
-    }
-    return 0;
+    return fast_roundf(fast_sqrtf((r1 - r2) * (r1 - r2) + (g1 - g2) * (g1 - g2) + (b1 - b2) * (b1 - b2)));
 }
 
+// Edges must be sorted by weight.
 static void segment_graph(universe *u, int num_vertices, int num_edges, edge *edges, float c) {
-    qsort(edges, num_edges, sizeof(edge), comp);
-
-    float *threshold = fb_alloc(num_vertices * sizeof(float), FB_ALLOC_NO_HINT);
+    uint32_t c_q8 = fast_roundf(c * 256);
+    uint32_t *threshold = fb_alloc(num_vertices * sizeof(uint32_t), FB_ALLOC_NO_HINT);
     for (int i = 0; i < num_vertices; i++) {
-        threshold[i] = THRESHOLD(1, c);
+        threshold[i] = THRESHOLD(1, c_q8);
     }
 
     for (int i = 0; i < num_edges; i++) {
         edge *pedge = edges + i;
+        uint32_t w_q8 = pedge->w << 8;
         int a = universe_find(u, pedge->a);
         int b = universe_find(u, pedge->b);
         if (a != b) {
-            if ((pedge->w <= threshold[a]) && (pedge->w <= threshold[b])) {
+            if ((w_q8 <= threshold[a]) && (w_q8 <= threshold[b])) {
                 universe_join(u, a, b);
                 a = universe_find(u, a);
-                threshold[a] = pedge->w + THRESHOLD(universe_size(u, a), c);
+                threshold[a] = w_q8 + THRESHOLD(universe_size(u, a), c_q8);
             }
         }
     }
@@ -224,39 +209,53 @@ array_t *imlib_selective_search(image_t *src, float t, int min_size, float a1, f
 
     universe *u = universe_create(width * height);
     edge *edges = (edge *) fb_alloc(width * height * sizeof(edge) * 4, FB_ALLOC_NO_HINT);
-
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            if (x < width - 1) {
-                edges[num].a = y * width + x;
-                edges[num].b = y * width + (x + 1);
-                edges[num].w = diff(img, x, y, x + 1, y);
-                num++;
-            }
-
-            if (y < height - 1) {
-                edges[num].a = y * width + x;
-                edges[num].b = (y + 1) * width + x;
-                edges[num].w = diff(img, x, y, x, y + 1);
-                num++;
-            }
-
-            if ((x < width - 1) && (y < height - 1)) {
-                edges[num].a = y * width + x;
-                edges[num].b = (y + 1) * width + (x + 1);
-                edges[num].w = diff(img, x, y, x + 1, y + 1);
-                num++;
+    uint16_t *weights = (uint16_t *) fb_alloc(width * height * sizeof(uint16_t) * 4, FB_ALLOC_NO_HINT);
+    uint32_t *offsets = (uint32_t *) fb_alloc0(EDGE_WEIGHT_MAX * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+
+    // Weights are small integers, so the edges are counting sorted: the first pass computes and
+    // counts the weights, the second writes each edge straight to its sorted position.
+    for (int pass = 0; pass < 2; pass++) {
+        num = 0;
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                for (int k = 0; k < 4; k++) {
+                    // Right, down, down-right and up-right neighbours.
+                    int dx = (k == 1) ? 0 : 1;
+                    int dy = (k == 0) ? 0 : ((k == 3) ? -1 : 1);
+
+                    if (((x + dx) >= width) || ((y + dy) < 0) || ((y + dy) >= height)) {
+                        continue;
+                    }
+
+                    if (pass == 0) {
+                        weights[num] = diff(img, x, y, x + dx, y + dy);
+                        offsets[weights[num]]++;
+                    } else {
+                        edge *pedge = edges + offsets[weights[num]]++;
+                        pedge->w = weights[num];
+                        pedge->a = y * width + x;
+                        pedge->b = (y + dy) * width + (x + dx);
+                    }
+
+                    num++;
+                }
             }
+        }
 
-            if ((x < width - 1) && (y > 0)) {
-                edges[num].a = y * width + x;
-                edges[num].b = (y - 1) * width + (x + 1);
-                edges[num].w = diff(img, x, y, x + 1, y - 1);
-                num++;
+        if (pass == 0) {
+            for (uint32_t w = 0, sum = 0; w < EDGE_WEIGHT_MAX; w++) {
+                uint32_t count = offsets[w];
+                offsets[w] = sum;
+                sum += count;
             }
         }
     }
 
+    // Free offsets and weights.
+    fb_free();
+    fb_free();
+
     segment_graph(u, width * height, num, edges, t);
 
     for (i = 0; i < num; i++) {
@@ -281,25 +280,19 @@ array_t *imlib_selective_search(image_t *src, float t, int min_size, float a1, f
 
     int next_component = 0;
     int *counts = (int *) fb_alloc0(num_ccs * sizeof(int), FB_ALLOC_NO_HINT);
-    int *components = (int *) fb_alloc(num_ccs * sizeof(int), FB_ALLOC_NO_HINT);
-    float *histogram = (float *) fb_alloc0(num_ccs * sizeof(float) * 75, FB_ALLOC_NO_HINT);
+    uint32_t *histogram_counts = (uint32_t *) fb_alloc0(num_ccs * sizeof(uint32_t) * HISTOGRAM_BINS, FB_ALLOC_NO_HINT);
+    // Component id of each set root, so pixels are labelled without searching the components.
+    int16_t *root_ids = (int16_t *) fb_alloc(width * height * sizeof(int16_t), FB_ALLOC_NO_HINT);
+    memset(root_ids, -1, width * height * sizeof(int16_t));
 
     // Calc histograms
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
-            int component_id = -1;
             int comp = universe_find(u, y * width + x);
-            for (i = 0; i < next_component; i++) {
-                if (components[i] == comp) {
-                    component_id = i;
-                    break;
-                }
-            }
-            if (i == next_component) {
-                components[next_component] = comp;
-                component_id = next_component;
-                ++next_component;
+            if (root_ids[comp] < 0) {
+                root_ids[comp] = next_component++;
             }
+            int component_id = root_ids[comp];
             universe_set_id(u, y * width + x, component_id);
             region *r = regions + component_id;
             r->y = min(r->y, y);
@@ -312,21 +305,25 @@ array_t *imlib_selective_search(image_t *src, float t, int min_size, float a1, f
             int g_bin = min(COLOR_RGB565_TO_G8(p), 240) / 10;
             int b_bin = min(COLOR_RGB565_TO_B8(p), 240) / 10;
 
-            histogram[75 * component_id + 0 + r_bin]++;
-            histogram[75 * component_id + 25 + g_bin]++;
-            histogram[75 * component_id + 50 + b_bin]++;
+            histogram_counts[HISTOGRAM_BINS * component_id + 0 + r_bin]++;
+            histogram_counts[HISTOGRAM_BINS * component_id + 25 + g_bin]++;
+            histogram_counts[HISTOGRAM_BINS * component_id + 50 + b_bin]++;
             counts[component_id]++;
         }
     }
 
-    // Normalize histograms
+    // Free root ids.
+    fb_free();
+
+    // Normalize histograms (in place, the Q8 bins are stored over the counts).
+    uint16_t *histogram = (uint16_t *) histogram_counts;
     for (i = 0; i < num_ccs; i++) {
-        float max_val = 0;
-        for (j = 0; j < 75; j++) {
-            max_val = max(max_val, histogram[75 * i + j]);
+        uint32_t max_val = 1;
+        for (j = 0; j < HISTOGRAM_BINS; j++) {
+            max_val = IM_MAX(max_val, histogram_counts[HISTOGRAM_BINS * i + j]);
         }
-        for (j = 0; j < 75; j++) {
-            histogram[75 * i + j] /= max_val;
+        for (j = 0; j < HISTOGRAM_BINS; j++) {
+            histogram[HISTOGRAM_BINS * i + j] = (histogram_counts[HISTOGRAM_BINS * i + j] * HISTOGRAM_ONE) / max_val;
         }
     }
 
@@ -353,7 +350,7 @@ array_t *imlib_selective_search(image_t *src, float t, int min_size, float a1, f
     float *similarity_table = (float *) fb_alloc(num_ccs * num_ccs * sizeof(float), FB_ALLOC_NO_HINT);
     for (i = 0; i < num_ccs; ++i) {
         for (j = i + 1; j < num_ccs; ++j) {
-            float color_sim = a1 * color_similarity(histogram + 75 * i, histogram + 75 * j);
+            float color_sim = a1 * color_similarity(histogram + HISTOGRAM_BINS * i, histogram + HISTOGRAM_BINS * j);
             float size_sim = a2 * size_similarity(counts[i], counts[j], size);
             float fill_sim = a3 * fill_similarity(regions + i, regions + j, counts[i], counts[j], size);
             float similarity = color_sim + size_sim + fill_sim;
@@ -407,9 +404,10 @@ array_t *imlib_selective_search(image_t *src, float t, int min_size, float a1, f
         }
 
 
-        for (i = 0; i < 75; i++) {
-            histogram[75 * best_i + i] = (counts[best_i] * histogram[75 * best_i + i]
-                                          + counts[best_j] * histogram[75 * best_j + i]) / (counts[best_i] + counts[best_j]);
+        for (i = 0; i < HISTOGRAM_BINS; i++) {
+            histogram[HISTOGRAM_BINS * best_i + i] = (counts[best_i] * histogram[HISTOGRAM_BINS * best_i + i]
+                                                      + counts[best_j] * histogram[HISTOGRAM_BINS * best_j + i]) /
+                                                     (counts[best_i] + counts[best_j]);
         }
         counts[best_i] += counts[best_j];
 
@@ -424,7 +422,7 @@ array_t *imlib_selective_search(image_t *src, float t, int min_size, float a1, f
             if (adjacency[best_i * num_ccs + i] == 0) {
                 continue;
             }
-            float color_sim = a1 * color_similarity(histogram + 75 * i, histogram + 75 * best_i);
+            float color_sim = a1 * color_similarity(histogram + HISTOGRAM_BINS * i, histogram + HISTOGRAM_BINS * best_i);
             float size_sim = a2 * size_similarity(counts[i], counts[best_i], size);
             float fill_sim = a3 * fill_similarity(regions + i, regions + best_i, counts[i], counts[best_i], size);
             float similarity = color_sim + size_sim + fill_sim;
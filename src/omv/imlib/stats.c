@@ -11,68 +11,124 @@
 #include "imlib.h"
 
 #ifdef IMLIB_ENABLE_GET_SIMILARITY
+#define SSIM_WINDOW    8
+
+// SSIM over SSIM_WINDOW x SSIM_WINDOW windows placed every step pixels. Column sums of the moments
+// are kept over the last SSIM_WINDOW rows (the rows themselves are kept in a ring to subtract them
+// again) and turned into prefix sums along the row so every window costs the same no matter the step.
+// The sums are unsigned and only ever differenced, so wrapping around doesn't matter.
 typedef struct imlib_similarity_line_op_state {
     bool dssim;
-    int *sumBucketsOfX, *sumBucketsOfY, *sum2BucketsOfX, *sum2BucketsOfY, *sum2Buckets;
+    int step, w, h;
+    float c1, c2;
+    uint8_t *ring_x, *ring_y; // last SSIM_WINDOW rows of pixels
+    uint32_t *col; // column sums of x, y, x*x, y*y and x*y for rows [top, bottom)
+    uint32_t *sum; // prefix sums of the column sums, w + 1 entries each
+    int top, bottom, next_window_y;
     float similarity_sum, similarity_sum_2, similarity_min, similarity_max;
-    int lines_processed, lines;
+    int windows;
 } imlib_similarity_line_op_state_t;
 
+static void imlib_similarity_row_update(imlib_similarity_line_op_state_t *state, int y, bool add) {
+    uint8_t *x_vals = state->ring_x + ((y % SSIM_WINDOW) * state->w);
+    uint8_t *y_vals = state->ring_y + ((y % SSIM_WINDOW) * state->w);
+    uint32_t *col_x = state->col, *col_y = col_x + state->w, *col_xx = col_y + state->w;
+    uint32_t *col_yy = col_xx + state->w, *col_xy = col_yy + state->w;
+    int sign = add ? 1 : -1;
+
+    for (int i = 0; i < state->w; i++) {
+        int px = x_vals[i], py = y_vals[i];
+        col_x[i] += sign * px;
+        col_y[i] += sign * py;
+        col_xx[i] += sign * px * px;
+        col_yy[i] += sign * py * py;
+        col_xy[i] += sign * px * py;
+    }
+}
+
+// Scores all windows in rows [top, bottom).
+static void imlib_similarity_windows(imlib_similarity_line_op_state_t *state) {
+    int w = state->w, h = state->bottom - state->top;
+
+    for (int m = 0; m < 5; m++) {
+        uint32_t *col = state->col + (m * w), *sum = state->sum + (m * (w + 1));
+        sum[0] = 0;
+        for (int i = 0; i < w; i++) {
+            sum[i + 1] = sum[i] + col[i];
+        }
+    }
+
+    uint32_t *sum_x = state->sum, *sum_y = sum_x + (w + 1), *sum_xx = sum_y + (w + 1);
+    uint32_t *sum_yy = sum_xx + (w + 1), *sum_xy = sum_yy + (w + 1);
+
+    for (int x = 0; x < w; x += state->step) {
+        int x_end = IM_MIN(x + SSIM_WINDOW, w);
+        float size = (x_end - x) * h;
+
+        // Dividng the sum squared buckets by size causes a loss of accuracy which results in
+        // the single pass standard deviation formula giving the wrong answer. To bypass this
+        // vx, vy, vxy have been multiplied by size which will be divided back out in the final
+        // ssim calculation (given c1/c2 ~= 0).
+
+        float mx = (sum_x[x_end] - sum_x[x]) / size;
+        float my = (sum_y[x_end] - sum_y[x]) / size;
+        float vx = (sum_xx[x_end] - sum_xx[x]) - (size * mx * mx);
+        float vy = (sum_yy[x_end] - sum_yy[x]) - (size * my * my);
+        float vxy = (sum_xy[x_end] - sum_xy[x]) - (size * mx * my);
+
+        float ssim = (((2 * mx * my) + state->c1) * ((2 * vxy) + state->c2)) /
+                     (((mx * mx) + (my * my) + state->c1) * (vx + vy + state->c2));
+
+        if (state->dssim) {
+            ssim = (1.0f - ssim) / 2.0f;
+        }
+
+        state->similarity_sum += ssim;
+        state->similarity_sum_2 += ssim * ssim;
+        state->similarity_min = IM_MIN(state->similarity_min, ssim);
+        state->similarity_max = IM_MAX(state->similarity_max, ssim);
+        state->windows += 1;
+    }
+}
+
 static void imlib_similarity_line_op(int x, int x_end, int y_row, imlib_draw_row_data_t *data) {
     imlib_similarity_line_op_state_t *state = data->callback_arg;
-    float c1 = 0, c2 = 0;
+    int y = state->bottom;
+
+    // Drop the row that is about to be overwritten in the ring.
+    if ((y - state->top) >= SSIM_WINDOW) {
+        imlib_similarity_row_update(state, state->top++, false);
+    }
+
+    uint8_t *x_vals = state->ring_x + ((y % SSIM_WINDOW) * state->w);
+    uint8_t *y_vals = state->ring_y + ((y % SSIM_WINDOW) * state->w);
     int x_start = x;
+    x_end = IM_MIN(x_end, x + state->w);
 
     switch (data->dst_img->pixfmt) {
         case PIXFORMAT_BINARY: {
             uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(data->dst_img, y_row);
             uint32_t *other_row_ptr = (uint32_t *) data->dst_row_override;
             for (; x < x_end; x++) {
-                int pixel = IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x);
-                int other_pixel = IMAGE_GET_BINARY_PIXEL_FAST(other_row_ptr, x);
-                int bucket = (x - x_start) / 8;
-                state->sumBucketsOfX[bucket] += pixel;
-                state->sumBucketsOfY[bucket] += other_pixel;
-                state->sum2BucketsOfX[bucket] += pixel * pixel;
-                state->sum2BucketsOfY[bucket] += other_pixel * other_pixel;
-                state->sum2Buckets[bucket] += pixel * other_pixel;
+                x_vals[x - x_start] = IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x);
+                y_vals[x - x_start] = IMAGE_GET_BINARY_PIXEL_FAST(other_row_ptr, x);
             }
-            c1 = (COLOR_BINARY_MAX * 0.01f) * (COLOR_BINARY_MAX * 0.01f);
-            c2 = (COLOR_BINARY_MAX * 0.03f) * (COLOR_BINARY_MAX * 0.03f);
             break;
         }
         case PIXFORMAT_GRAYSCALE: {
             uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(data->dst_img, y_row);
             uint8_t *other_row_ptr = (uint8_t *) data->dst_row_override;
-            for (; x < x_end; x++) {
-                int pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
-                int other_pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(other_row_ptr, x);
-                int bucket = (x - x_start) / 8;
-                state->sumBucketsOfX[bucket] += pixel;
-                state->sumBucketsOfY[bucket] += other_pixel;
-                state->sum2BucketsOfX[bucket] += pixel * pixel;
-                state->sum2BucketsOfY[bucket] += other_pixel * other_pixel;
-                state->sum2Buckets[bucket] += pixel * other_pixel;
-            }
-            c1 = (COLOR_GRAYSCALE_MAX * 0.01f) * (COLOR_GRAYSCALE_MAX * 0.01f);
-            c2 = (COLOR_GRAYSCALE_MAX * 0.03f) * (COLOR_GRAYSCALE_MAX * 0.03f);
+            memcpy(x_vals, row_ptr + x, x_end - x);
+            memcpy(y_vals, other_row_ptr + x, x_end - x);
             break;
         }
         case PIXFORMAT_RGB565: {
             uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(data->dst_img, y_row);
             uint16_t *other_row_ptr = (uint16_t *) data->dst_row_override;
             for (; x < x_end; x++) {
-                int pixel = COLOR_RGB565_TO_Y(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
-                int other_pixel = COLOR_RGB565_TO_Y(IMAGE_GET_RGB565_PIXEL_FAST(other_row_ptr, x));
-                int bucket = (x - x_start) / 8;
-                state->sumBucketsOfX[bucket] += pixel;
-                state->sumBucketsOfY[bucket] += other_pixel;
-                state->sum2BucketsOfX[bucket] += pixel * pixel;
-                state->sum2BucketsOfY[bucket] += other_pixel * other_pixel;
-                state->sum2Buckets[bucket] += pixel * other_pixel;
+                x_vals[x - x_start] = COLOR_RGB565_TO_Y(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
+                y_vals[x - x_start] = COLOR_RGB565_TO_Y(IMAGE_GET_RGB565_PIXEL_FAST(other_row_ptr, x));
             }
-            c1 = (COLOR_Y_MAX * 0.01f) * (COLOR_Y_MAX * 0.01f);
-            c2 = (COLOR_Y_MAX * 0.03f) * (COLOR_Y_MAX * 0.03f);
             break;
         }
         default: {
@@ -80,46 +136,19 @@ static void imlib_similarity_line_op(int x, int x_end, int y_row, imlib_draw_row
         }
     }
 
-    // https://en.wikipedia.org/wiki/Structural_similarity
-    if ((!((state->lines_processed + 1) % 8)) || ((state->lines_processed + 1) == state->lines)) {
-        for (x = x_start; x < x_end; x += 8) {
-            int bucket = (x - x_start) / 8;
-            int w = IM_MIN((x_end - x), 8);
-            int h = IM_MIN((state->lines - state->lines_processed), 8);
-            float size = w * h;
-
-            // Dividng the sum squared buckets by size causes a loss of accuracy which results in
-            // the single pass standard deviation formula giving the wrong answer. To bypass this
-            // vx, vy, vxy have been multiplied by size which will be divided back out in the final
-            // ssim calculation (given c1/c2 ~= 0).
-
-            float mx = state->sumBucketsOfX[bucket] / size;
-            float my = state->sumBucketsOfY[bucket] / size;
-            float vx = state->sum2BucketsOfX[bucket] - (size * mx * mx);
-            float vy = state->sum2BucketsOfY[bucket] - (size * my * my);
-            float vxy = state->sum2Buckets[bucket] - (size * mx * my);
-
-            float ssim = (((2 * mx * my) + c1) * ((2 * vxy) + c2)) /
-                         (((mx * mx) + (my * my) + c1) * (vx + vy + c2));
-
-            if (state->dssim) {
-                ssim = (1.0f - ssim) / 2.0f;
-            }
-
-            state->similarity_sum += ssim;
-            state->similarity_sum_2 += ssim * ssim;
-            state->similarity_min = IM_MIN(state->similarity_min, ssim);
-            state->similarity_max = IM_MAX(state->similarity_max, ssim);
+    imlib_similarity_row_update(state, y, true);
+    state->bottom = y + 1;
 
-            state->sumBucketsOfX[bucket] = 0;
-            state->sumBucketsOfY[bucket] = 0;
-            state->sum2BucketsOfX[bucket] = 0;
-            state->sum2BucketsOfY[bucket] = 0;
-            state->sum2Buckets[bucket] = 0;
+    // Score every window row that is complete, the last rows also finish the clipped windows.
+    while ((state->next_window_y < state->h) &&
+           (((state->next_window_y + SSIM_WINDOW) <= state->bottom) || (state->bottom == state->h))) {
+        while (state->top < state->next_window_y) {
+            imlib_similarity_row_update(state, state->top++, false);
         }
-    }
 
-    state->lines_processed += 1;
+        imlib_similarity_windows(state);
+        state->next_window_y += state->step;
+    }
 }
 
 void imlib_get_similarity(image_t *img,
@@ -135,6 +164,7 @@ void imlib_get_similarity(image_t *img,
                           const uint8_t *alpha_palette,
                           image_hint_t hint,
                           bool dssim,
+                          int step,
                           float *avg,
                           float *std,
                           float *min,
@@ -142,67 +172,184 @@ void imlib_get_similarity(image_t *img,
     point_t p0, p1;
     imlib_draw_image_get_bounds(img, other, x_start, y_start, x_scale, y_scale, roi,
                                 alpha, alpha_palette, hint, &p0, &p1);
-    int h_blocks = ((p1.x - p0.x) + 7) / 8;
-    int v_blocks = ((p1.y - p0.y) + 7) / 8;
-    int blocks = h_blocks * v_blocks;
 
-    if (!blocks) {
+    imlib_similarity_line_op_state_t state;
+    state.dssim = dssim;
+    state.step = step;
+    state.w = p1.x - p0.x;
+    state.h = p1.y - p0.y;
+
+    if ((state.w <= 0) || (state.h <= 0)) {
         return;
     }
 
-    int int_h_blocks = h_blocks * sizeof(int);
-    imlib_similarity_line_op_state_t state;
-    state.dssim = dssim;
-    state.sumBucketsOfX = fb_alloc0(int_h_blocks * 5, FB_ALLOC_NO_HINT);
-    state.sumBucketsOfY = state.sumBucketsOfX + int_h_blocks;
-    state.sum2BucketsOfX = state.sumBucketsOfY + int_h_blocks;
-    state.sum2BucketsOfY = state.sum2BucketsOfX + int_h_blocks;
-    state.sum2Buckets = state.sum2BucketsOfY + int_h_blocks;
+    switch (img->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            state.c1 = (COLOR_BINARY_MAX * 0.01f) * (COLOR_BINARY_MAX * 0.01f);
+            state.c2 = (COLOR_BINARY_MAX * 0.03f) * (COLOR_BINARY_MAX * 0.03f);
+            break;
+        }
+        case PIXFORMAT_GRAYSCALE: {
+            state.c1 = (COLOR_GRAYSCALE_MAX * 0.01f) * (COLOR_GRAYSCALE_MAX * 0.01f);
+            state.c2 = (COLOR_GRAYSCALE_MAX * 0.03f) * (COLOR_GRAYSCALE_MAX * 0.03f);
+            break;
+        }
+        default: {
+            state.c1 = (COLOR_Y_MAX * 0.01f) * (COLOR_Y_MAX * 0.01f);
+            state.c2 = (COLOR_Y_MAX * 0.03f) * (COLOR_Y_MAX * 0.03f);
+            break;
+        }
+    }
+
+    state.ring_x = fb_alloc(SSIM_WINDOW * state.w * 2, FB_ALLOC_NO_HINT);
+    state.ring_y = state.ring_x + (SSIM_WINDOW * state.w);
+    state.col = fb_alloc0(5 * state.w * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    state.sum = fb_alloc(5 * (state.w + 1) * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    state.top = 0;
+    state.bottom = 0;
+    state.next_window_y = 0;
     state.similarity_sum = 0.0f;
     state.similarity_sum_2 = 0.0f;
     state.similarity_min = FLT_MAX;
     state.similarity_max = -FLT_MAX;
-    state.lines_processed = 0;
-    state.lines = p1.y - p0.y;
+    state.windows = 0;
 
     void *dst_row_override = fb_alloc0(image_line_size(img), FB_ALLOC_CACHE_ALIGN);
     imlib_draw_image(img, other, x_start, y_start, x_scale, y_scale, roi,
                      rgb_channel, alpha, color_palette, alpha_palette,
                      hint, imlib_similarity_line_op, &state, dst_row_override);
 
-    *avg = state.similarity_sum / blocks;
-    *std = fast_sqrtf((state.similarity_sum_2 / blocks) - ((*avg) * (*avg)));
-    *min = state.similarity_min;
-    *max = state.similarity_max;
+    if (state.windows) {
+        *avg = state.similarity_sum / state.windows;
+        *std = fast_sqrtf((state.similarity_sum_2 / state.windows) - ((*avg) * (*avg)));
+        *min = state.similarity_min;
+        *max = state.similarity_max;
+    }
 
     fb_free(); // dst_row_override
-    fb_free(); // sumBucketsOfX
+    fb_free(); // sum
+    fb_free(); // col
+    fb_free(); // ring_x
 }
 #endif // IMLIB_ENABLE_GET_SIMILARITY
 
-void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_t *thresholds, bool invert, image_t *other) {
+// Maps channel values to bin indices, the A and B bins follow the L bins.
+static void imlib_histogram_luts(pixformat_t pixfmt, int l_bins, int a_bins, int b_bins,
+                                 uint16_t *l_lut, uint16_t *a_lut, uint16_t *b_lut) {
+    switch (pixfmt) {
+        case PIXFORMAT_BINARY: {
+            float mult = (l_bins - 1) / ((float) (COLOR_BINARY_MAX - COLOR_BINARY_MIN));
+            for (int i = 0, ii = COLOR_BINARY_MAX - COLOR_BINARY_MIN + 1; i < ii; i++) {
+                l_lut[i] = fast_roundf(i * mult);
+            }
+            break;
+        }
+        case PIXFORMAT_GRAYSCALE: {
+            float mult = (l_bins - 1) / ((float) (COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN));
+            for (int i = 0, ii = COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN + 1; i < ii; i++) {
+                l_lut[i] = fast_roundf(i * mult);
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            float l_mult = (l_bins - 1) / ((float) (COLOR_L_MAX - COLOR_L_MIN));
+            float a_mult = (a_bins - 1) / ((float) (COLOR_A_MAX - COLOR_A_MIN));
+            float b_mult = (b_bins - 1) / ((float) (COLOR_B_MAX - COLOR_B_MIN));
+            for (int i = 0, ii = COLOR_L_MAX - COLOR_L_MIN + 1; i < ii; i++) {
+                l_lut[i] = fast_roundf(i * l_mult);
+            }
+            for (int i = 0, ii = COLOR_A_MAX - COLOR_A_MIN + 1; i < ii; i++) {
+                a_lut[i] = fast_roundf(i * a_mult) + l_bins;
+            }
+            for (int i = 0, ii = COLOR_B_MAX - COLOR_B_MIN + 1; i < ii; i++) {
+                b_lut[i] = fast_roundf(i * b_mult) + l_bins + a_bins;
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+// Counts every x_stride pixel in [x, x + w) of row y into bins.
+static void imlib_histogram_count(image_t *img, const uint16_t *l_lut, const uint16_t *a_lut, const uint16_t *b_lut,
+                                  int x, int y, int w, int x_stride, uint32_t *bins) {
+    switch (img->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
+            for (int xx = x + w; x < xx; x += x_stride) {
+                bins[l_lut[IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x) - COLOR_BINARY_MIN]]++;
+            }
+            break;
+        }
+        case PIXFORMAT_GRAYSCALE: {
+            uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+            for (int xx = x + w; x < xx; x += x_stride) {
+                bins[l_lut[IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x) - COLOR_GRAYSCALE_MIN]]++;
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+            for (int xx = x + w; x < xx; x += x_stride) {
+                uint32_t lab = COLOR_RGB565_TO_LAB(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x));
+                bins[l_lut[COLOR_LAB_TO_L(lab) - COLOR_L_MIN]]++;
+                bins[a_lut[COLOR_LAB_TO_A(lab) - COLOR_A_MIN]]++;
+                bins[b_lut[COLOR_LAB_TO_B(lab) - COLOR_B_MIN]]++;
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+// Integer histogram of every x_stride pixel of every y_stride row of the ROI, the bin indices come
+// from LUTs so there's no float math per pixel. Leaves the counts in the bins.
+static void imlib_histogram_count_roi(histogram_t *out, image_t *ptr, rectangle_t *roi, int x_stride, int y_stride) {
+    int bins = out->LBinCount + out->ABinCount + out->BBinCount;
+    uint32_t *counts = fb_alloc0(bins * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    uint16_t *luts = fb_alloc(3 * 256 * sizeof(uint16_t), FB_ALLOC_NO_HINT);
+    imlib_histogram_luts(ptr->pixfmt, out->LBinCount, out->ABinCount, out->BBinCount, luts, luts + 256, luts + 512);
+
+    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
+        imlib_histogram_count(ptr, luts, luts + 256, luts + 512, roi->x, y, roi->w, x_stride, counts);
+    }
+
+    memcpy(out->LBins, counts, out->LBinCount * sizeof(uint32_t));
+
+    if (out->ABinCount) {
+        memcpy(out->ABins, counts + out->LBinCount, out->ABinCount * sizeof(uint32_t));
+    }
+
+    if (out->BBinCount) {
+        memcpy(out->BBins, counts + out->LBinCount + out->ABinCount, out->BBinCount * sizeof(uint32_t));
+    }
+
+    fb_free(); // luts
+    fb_free(); // counts
+}
+
+void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_t *thresholds, bool invert, image_t *other,
+                         int x_stride, int y_stride) {
     switch (ptr->pixfmt) {
         case PIXFORMAT_BINARY: {
             memset(out->LBins, 0, out->LBinCount * sizeof(uint32_t));
 
-            int pixel_count = roi->w * roi->h;
+            int pixel_count = ((roi->w + x_stride - 1) / x_stride) * ((roi->h + y_stride - 1) / y_stride);
             float mult = (out->LBinCount - 1) / ((float) (COLOR_BINARY_MAX - COLOR_BINARY_MIN));
 
             if ((!thresholds) || (!list_size(thresholds))) {
                 // Fast histogram code when no color thresholds list...
                 if (!other) {
-                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
-                        uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(ptr, y);
-                        for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
-                            int pixel = IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x);
-                            ((uint32_t *) out->LBins)[fast_roundf((pixel - COLOR_BINARY_MIN) * mult)]++;
-                        }
-                    }
+                    imlib_histogram_count_roi(out, ptr, roi, x_stride, y_stride);
                 } else {
-                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
                         uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(ptr, y),
                                  *other_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(other, y);
-                        for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                        for (int x = roi->x, xx = roi->x + roi->w; x < xx; x += x_stride) {
                             int pixel = IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x) ^ IMAGE_GET_BINARY_PIXEL_FAST(other_row_ptr, x);
                             ((uint32_t *) out->LBins)[fast_roundf((pixel - COLOR_BINARY_MIN) * mult)]++;
                         }
@@ -214,9 +361,9 @@ void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_
                 if (!other) {
                     list_for_each(it, thresholds) {
                         color_thresholds_list_lnk_data_t *lnk_data = list_get_data(it);
-                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
                             uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(ptr, y);
-                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x += x_stride) {
                                 int pixel = IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x);
                                 if (COLOR_THRESHOLD_BINARY(pixel, lnk_data, invert)) {
                                     ((uint32_t *) out->LBins)[fast_roundf((pixel - COLOR_BINARY_MIN) * mult)]++;
@@ -229,10 +376,10 @@ void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_
                     list_for_each(it, thresholds) {
                         color_thresholds_list_lnk_data_t *lnk_data = list_get_data(it);
 
-                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
                             uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(ptr, y),
                                      *other_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(other, y);
-                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x += x_stride) {
                                 int pixel = IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x) ^ IMAGE_GET_BINARY_PIXEL_FAST(other_row_ptr,
                                                                                                                   x);
                                 if (COLOR_THRESHOLD_BINARY(pixel, lnk_data, invert)) {
@@ -256,24 +403,27 @@ void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_
         case PIXFORMAT_GRAYSCALE: {
             memset(out->LBins, 0, out->LBinCount * sizeof(uint32_t));
 
-            int pixel_count = roi->w * roi->h;
+            int pixel_count = ((roi->w + x_stride - 1) / x_stride) * ((roi->h + y_stride - 1) / y_stride);
             float mult = (out->LBinCount - 1) / ((float) (COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN));
 
             if ((!thresholds) || (!list_size(thresholds))) {
                 // Fast histogram code when no color thresholds list...
-                if (!other) {
-                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
-                        uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(ptr, y);
-                        for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
-                            int pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
-                            ((uint32_t *) out->LBins)[fast_roundf((pixel - COLOR_GRAYSCALE_MIN) * mult)]++;
-                        }
+                if ((!other) && ((x_stride > 1) || (y_stride > 1))) {
+                    imlib_histogram_count_roi(out, ptr, roi, x_stride, y_stride);
+                } else if (!other) {
+                    // Count all 256 values (possibly on both cores) then fold them into the bins.
+                    uint32_t *hist = fb_alloc0((COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN + 1) * sizeof(uint32_t),
+                                               FB_ALLOC_NO_HINT);
+                    imlib_task_histogram_grayscale(ptr, roi, hist);
+                    for (int i = 0, ii = COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN + 1; i < ii; i++) {
+                        ((uint32_t *) out->LBins)[fast_roundf(i * mult)] += hist[i];
                     }
+                    fb_free(); // hist
                 } else {
-                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
                         uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(ptr, y),
                                 *other_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(other, y);
-                        for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                        for (int x = roi->x, xx = roi->x + roi->w; x < xx; x += x_stride) {
                             int pixel =
                                 abs(IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x) - IMAGE_GET_GRAYSCALE_PIXEL_FAST(other_row_ptr,
                                                                                                                 x));
@@ -288,9 +438,9 @@ void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_
                     list_for_each(it, thresholds) {
                         color_thresholds_list_lnk_data_t *lnk_data = list_get_data(it);
 
-                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
                             uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(ptr, y);
-                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x += x_stride) {
                                 int pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x);
                                 if (COLOR_THRESHOLD_GRAYSCALE(pixel, lnk_data, invert)) {
                                     ((uint32_t *) out->LBins)[fast_roundf((pixel - COLOR_GRAYSCALE_MIN) * mult)]++;
@@ -303,10 +453,10 @@ void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_
                     list_for_each(it, thresholds) {
                         color_thresholds_list_lnk_data_t *lnk_data = list_get_data(it);
 
-                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
                             uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(ptr, y),
                                     *other_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(other, y);
-                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x += x_stride) {
                                 int pixel =
                                     abs(IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr,
                                                                        x) - IMAGE_GET_GRAYSCALE_PIXEL_FAST(other_row_ptr,
@@ -334,7 +484,7 @@ void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_
             memset(out->ABins, 0, out->ABinCount * sizeof(uint32_t));
             memset(out->BBins, 0, out->BBinCount * sizeof(uint32_t));
 
-            int pixel_count = roi->w * roi->h;
+            int pixel_count = ((roi->w + x_stride - 1) / x_stride) * ((roi->h + y_stride - 1) / y_stride);
             float l_mult = (out->LBinCount - 1) / ((float) (COLOR_L_MAX - COLOR_L_MIN));
             float a_mult = (out->ABinCount - 1) / ((float) (COLOR_A_MAX - COLOR_A_MIN));
             float b_mult = (out->BBinCount - 1) / ((float) (COLOR_B_MAX - COLOR_B_MIN));
@@ -342,29 +492,22 @@ void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_
             if ((!thresholds) || (!list_size(thresholds))) {
                 // Fast histogram code when no color thresholds list...
                 if (!other) {
-                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
-                        uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(ptr, y);
-                        for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
-                            int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
-                            ((uint32_t *) out->LBins)[fast_roundf((COLOR_RGB565_TO_L(pixel) - COLOR_L_MIN) * l_mult)]++;
-                            ((uint32_t *) out->ABins)[fast_roundf((COLOR_RGB565_TO_A(pixel) - COLOR_A_MIN) * a_mult)]++;
-                            ((uint32_t *) out->BBins)[fast_roundf((COLOR_RGB565_TO_B(pixel) - COLOR_B_MIN) * b_mult)]++;
-                        }
-                    }
+                    imlib_histogram_count_roi(out, ptr, roi, x_stride, y_stride);
                 } else {
-                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
                         uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(ptr, y),
                                  *other_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(other, y);
-                        for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                        for (int x = roi->x, xx = roi->x + roi->w; x < xx; x += x_stride) {
                             int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
                             int other_pixel = IMAGE_GET_RGB565_PIXEL_FAST(other_row_ptr, x);
                             int r = abs(COLOR_RGB565_TO_R5(pixel) - COLOR_RGB565_TO_R5(other_pixel));
                             int g = abs(COLOR_RGB565_TO_G6(pixel) - COLOR_RGB565_TO_G6(other_pixel));
                             int b = abs(COLOR_RGB565_TO_B5(pixel) - COLOR_RGB565_TO_B5(other_pixel));
                             pixel = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
-                            ((uint32_t *) out->LBins)[fast_roundf((COLOR_RGB565_TO_L(pixel) - COLOR_L_MIN) * l_mult)]++;
-                            ((uint32_t *) out->ABins)[fast_roundf((COLOR_RGB565_TO_A(pixel) - COLOR_A_MIN) * a_mult)]++;
-                            ((uint32_t *) out->BBins)[fast_roundf((COLOR_RGB565_TO_B(pixel) - COLOR_B_MIN) * b_mult)]++;
+                            uint32_t lab = COLOR_RGB565_TO_LAB(pixel);
+                            ((uint32_t *) out->LBins)[fast_roundf((COLOR_LAB_TO_L(lab) - COLOR_L_MIN) * l_mult)]++;
+                            ((uint32_t *) out->ABins)[fast_roundf((COLOR_LAB_TO_A(lab) - COLOR_A_MIN) * a_mult)]++;
+                            ((uint32_t *) out->BBins)[fast_roundf((COLOR_LAB_TO_B(lab) - COLOR_B_MIN) * b_mult)]++;
                         }
                     }
                 }
@@ -375,14 +518,15 @@ void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_
                     list_for_each(it, thresholds) {
                         color_thresholds_list_lnk_data_t *lnk_data = list_get_data(it);
 
-                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
                             uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(ptr, y);
-                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x += x_stride) {
                                 int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
                                 if (COLOR_THRESHOLD_RGB565(pixel, lnk_data, invert)) {
-                                    ((uint32_t *) out->LBins)[fast_roundf((COLOR_RGB565_TO_L(pixel) - COLOR_L_MIN) * l_mult)]++;
-                                    ((uint32_t *) out->ABins)[fast_roundf((COLOR_RGB565_TO_A(pixel) - COLOR_A_MIN) * a_mult)]++;
-                                    ((uint32_t *) out->BBins)[fast_roundf((COLOR_RGB565_TO_B(pixel) - COLOR_B_MIN) * b_mult)]++;
+                                    uint32_t lab = COLOR_RGB565_TO_LAB(pixel);
+                                    ((uint32_t *) out->LBins)[fast_roundf((COLOR_LAB_TO_L(lab) - COLOR_L_MIN) * l_mult)]++;
+                                    ((uint32_t *) out->ABins)[fast_roundf((COLOR_LAB_TO_A(lab) - COLOR_A_MIN) * a_mult)]++;
+                                    ((uint32_t *) out->BBins)[fast_roundf((COLOR_LAB_TO_B(lab) - COLOR_B_MIN) * b_mult)]++;
                                     pixel_count++;
                                 }
                             }
@@ -392,10 +536,10 @@ void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_
                     list_for_each(it, thresholds) {
                         color_thresholds_list_lnk_data_t *lnk_data = list_get_data(it);
 
-                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
                             uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(ptr, y),
                                      *other_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(other, y);
-                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x += x_stride) {
                                 int pixel = IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x);
                                 int other_pixel = IMAGE_GET_RGB565_PIXEL_FAST(other_row_ptr, x);
                                 int r = abs(COLOR_RGB565_TO_R5(pixel) - COLOR_RGB565_TO_R5(other_pixel));
@@ -403,9 +547,10 @@ void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_
                                 int b = abs(COLOR_RGB565_TO_B5(pixel) - COLOR_RGB565_TO_B5(other_pixel));
                                 pixel = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
                                 if (COLOR_THRESHOLD_RGB565(pixel, lnk_data, invert)) {
-                                    ((uint32_t *) out->LBins)[fast_roundf((COLOR_RGB565_TO_L(pixel) - COLOR_L_MIN) * l_mult)]++;
-                                    ((uint32_t *) out->ABins)[fast_roundf((COLOR_RGB565_TO_A(pixel) - COLOR_A_MIN) * a_mult)]++;
-                                    ((uint32_t *) out->BBins)[fast_roundf((COLOR_RGB565_TO_B(pixel) - COLOR_B_MIN) * b_mult)]++;
+                                    uint32_t lab = COLOR_RGB565_TO_LAB(pixel);
+                                    ((uint32_t *) out->LBins)[fast_roundf((COLOR_LAB_TO_L(lab) - COLOR_L_MIN) * l_mult)]++;
+                                    ((uint32_t *) out->ABins)[fast_roundf((COLOR_LAB_TO_A(lab) - COLOR_A_MIN) * a_mult)]++;
+                                    ((uint32_t *) out->BBins)[fast_roundf((COLOR_LAB_TO_B(lab) - COLOR_B_MIN) * b_mult)]++;
                                     pixel_count++;
                                 }
                             }
@@ -436,6 +581,129 @@ void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_
     }
 }
 
+#ifdef IMLIB_ENABLE_HISTOGRAM_CACHE
+void imlib_histogram_cache_init(histogram_cache_t *cache, image_t *img, int tile, int l_bins, int a_bins, int b_bins) {
+    cache->w = img->w;
+    cache->h = img->h;
+    cache->pixfmt = img->pixfmt;
+    cache->tile = tile;
+    cache->tiles_w = img->w / tile;
+    cache->tiles_h = img->h / tile;
+    cache->LBinCount = l_bins;
+    cache->ABinCount = a_bins;
+    cache->BBinCount = b_bins;
+    cache->data = NULL;
+}
+
+size_t imlib_histogram_cache_size(histogram_cache_t *cache) {
+    int bins = cache->LBinCount + cache->ABinCount + cache->BBinCount;
+    return (cache->tiles_w + 1) * (cache->tiles_h + 1) * bins * sizeof(uint32_t);
+}
+
+void imlib_histogram_cache_build(histogram_cache_t *cache, image_t *img) {
+    int bins = cache->LBinCount + cache->ABinCount + cache->BBinCount;
+    int row_size = (cache->tiles_w + 1) * bins;
+    uint16_t *luts = fb_alloc(3 * 256 * sizeof(uint16_t), FB_ALLOC_NO_HINT);
+    imlib_histogram_luts(cache->pixfmt, cache->LBinCount, cache->ABinCount, cache->BBinCount,
+                         luts, luts + 256, luts + 512);
+
+    // The first row and column of the integral are zero.
+    memset(cache->data, 0, (cache->tiles_h + 1) * row_size * sizeof(uint32_t));
+
+    for (int ty = 0; ty < cache->tiles_h; ty++) {
+        uint32_t *prev_row = cache->data + (ty * row_size);
+        uint32_t *row = prev_row + row_size;
+
+        // Count each tile into its own entry first...
+        for (int y = ty * cache->tile, yy = y + cache->tile; y < yy; y++) {
+            for (int tx = 0; tx < cache->tiles_w; tx++) {
+                imlib_histogram_count(img, luts, luts + 256, luts + 512,
+                                            tx * cache->tile, y, cache->tile, 1, row + ((tx + 1) * bins));
+            }
+        }
+
+        // ...then integrate along the row and add the row above.
+        for (int tx = 1; tx <= cache->tiles_w; tx++) {
+            for (int i = 0; i < bins; i++) {
+                row[(tx * bins) + i] += row[((tx - 1) * bins) + i];
+            }
+        }
+
+        for (int i = bins; i < row_size; i++) {
+            row[i] += prev_row[i];
+        }
+    }
+
+    fb_free(); // luts
+}
+
+void imlib_histogram_cache_get(histogram_cache_t *cache, histogram_t *out, image_t *img, rectangle_t *roi) {
+    int bins = cache->LBinCount + cache->ABinCount + cache->BBinCount;
+    int row_size = (cache->tiles_w + 1) * bins;
+    uint32_t *counts = fb_alloc0(bins * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    uint16_t *luts = fb_alloc(3 * 256 * sizeof(uint16_t), FB_ALLOC_NO_HINT);
+    imlib_histogram_luts(cache->pixfmt, cache->LBinCount, cache->ABinCount, cache->BBinCount,
+                         luts, luts + 256, luts + 512);
+
+    // Whole tiles inside the ROI.
+    int tx0 = (roi->x + cache->tile - 1) / cache->tile;
+    int ty0 = (roi->y + cache->tile - 1) / cache->tile;
+    int tx1 = IM_MIN((roi->x + roi->w) / cache->tile, cache->tiles_w);
+    int ty1 = IM_MIN((roi->y + roi->h) / cache->tile, cache->tiles_h);
+
+    if ((tx0 >= tx1) || (ty0 >= ty1)) {
+        // Not a single whole tile, just scan the ROI.
+        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+            imlib_histogram_count(img, luts, luts + 256, luts + 512, roi->x, y, roi->w, 1, counts);
+        }
+    } else {
+        uint32_t *i00 = cache->data + (ty0 * row_size) + (tx0 * bins);
+        uint32_t *i01 = cache->data + (ty0 * row_size) + (tx1 * bins);
+        uint32_t *i10 = cache->data + (ty1 * row_size) + (tx0 * bins);
+        uint32_t *i11 = cache->data + (ty1 * row_size) + (tx1 * bins);
+
+        for (int i = 0; i < bins; i++) {
+            counts[i] = i11[i] - i01[i] - i10[i] + i00[i];
+        }
+
+        int x0 = tx0 * cache->tile, x1 = tx1 * cache->tile;
+        int y0 = ty0 * cache->tile, y1 = ty1 * cache->tile;
+
+        // Top and bottom strips.
+        for (int y = roi->y; y < y0; y++) {
+            imlib_histogram_count(img, luts, luts + 256, luts + 512, roi->x, y, roi->w, 1, counts);
+        }
+
+        for (int y = y1, yy = roi->y + roi->h; y < yy; y++) {
+            imlib_histogram_count(img, luts, luts + 256, luts + 512, roi->x, y, roi->w, 1, counts);
+        }
+
+        // Left and right strips.
+        for (int y = y0; y < y1; y++) {
+            imlib_histogram_count(img, luts, luts + 256, luts + 512, roi->x, y, x0 - roi->x, 1, counts);
+            imlib_histogram_count(img, luts, luts + 256, luts + 512, x1, y, roi->x + roi->w - x1, 1, counts);
+        }
+    }
+
+    float pixels = IM_DIV(1, ((float) (roi->w * roi->h)));
+
+    for (int i = 0, j = out->LBinCount; i < j; i++) {
+        out->LBins[i] = counts[i] * pixels;
+    }
+
+    for (int i = 0, j = out->ABinCount; i < j; i++) {
+        out->ABins[i] = counts[out->LBinCount + i] * pixels;
+    }
+
+    for (int i = 0, j = out->BBinCount; i < j; i++) {
+        out->BBins[i] = counts[out->LBinCount + out->ABinCount + i] * pixels;
+    }
+
+    fb_free(); // luts
+    fb_free(); // counts
+}
+#endif // IMLIB_ENABLE_HISTOGRAM_CACHE
+
 void imlib_get_percentile(percentile_t *out, pixformat_t pixfmt, histogram_t *ptr, float percentile) {
     memset(out, 0, sizeof(percentile_t));
     switch (pixfmt) {
@@ -842,18 +1110,30 @@ static int get_median(int *array, int array_sum, int array_len) {
     return array_len - 1;
 }
 
-static int get_median_l(long long *array, long long array_sum, int array_len) {
-    const long long median_threshold = (array_sum + 1) / 2;
-    long long median_count = 0;
+// The robust fit uses at most this many points, which bounds the pairwise slope pass.
+#define REGRESSION_ROBUST_POINTS    256
+
+typedef struct regression_sample {
+    point_t *points;
+    int count, stride, skip;
+} regression_sample_t;
+
+// Keeps every stride-th point found, dropping every other point and doubling the stride when
+// full. The pairwise deltas below depend on the points being in scan order which this preserves.
+static inline void regression_sample(regression_sample_t *sample, int x, int y) {
+    if (!sample->skip--) {
+        if (sample->count == REGRESSION_ROBUST_POINTS) {
+            for (int i = 0, j = REGRESSION_ROBUST_POINTS / 2; i < j; i++) {
+                sample->points[i] = sample->points[i * 2];
+            }
 
-    for (int i = 0; i < array_len; i++) {
-        if ((median_count < median_threshold) && (median_threshold <= (median_count + array[i]))) {
-            return i;
+            sample->count = REGRESSION_ROBUST_POINTS / 2;
+            sample->stride *= 2;
         }
-        median_count += array[i];
-    }
 
-    return array_len - 1;
+        point_init(&sample->points[sample->count++], x, y);
+        sample->skip = sample->stride - 1;
+    }
 }
 
 bool imlib_get_regression(find_lines_list_lnk_data_t *out,
@@ -1025,157 +1305,146 @@ bool imlib_get_regression(find_lines_list_lnk_data_t *out,
         // Theil-Sen Estimator
         int *x_histogram = fb_alloc0(ptr->w * sizeof(int), FB_ALLOC_NO_HINT);
         int *y_histogram = fb_alloc0(ptr->h * sizeof(int), FB_ALLOC_NO_HINT);
-        long long *x_delta_histogram = fb_alloc0((2 * ptr->w) * sizeof(long long), FB_ALLOC_NO_HINT);
-        long long *y_delta_histogram = fb_alloc0((2 * ptr->h) * sizeof(long long), FB_ALLOC_NO_HINT);
-
-        uint32_t size;
-        point_t *points = (point_t *) fb_alloc_all(&size, FB_ALLOC_NO_HINT);
-        size_t points_max = size / sizeof(point_t);
-        size_t points_count = 0;
-
-        if (points_max) {
-            int blob_x1 = roi->x + roi->w - 1;
-            int blob_y1 = roi->y + roi->h - 1;
-            int blob_x2 = roi->x;
-            int blob_y2 = roi->y;
-            int blob_pixels = 0;
-
-            list_for_each(it, thresholds) {
-                color_thresholds_list_lnk_data_t *lnk_data = list_get_data(it);
-
-                switch (ptr->pixfmt) {
-                    case PIXFORMAT_BINARY: {
-                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
-                            uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(ptr, y);
-                            for (int x = roi->x + (y % x_stride), xx = roi->x + roi->w; x < xx; x += x_stride) {
-                                if (COLOR_THRESHOLD_BINARY(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
-                                    blob_x1 = IM_MIN(blob_x1, x);
-                                    blob_y1 = IM_MIN(blob_y1, y);
-                                    blob_x2 = IM_MAX(blob_x2, x);
-                                    blob_y2 = IM_MAX(blob_y2, y);
-                                    blob_pixels += 1;
-                                    x_histogram[x]++;
-                                    y_histogram[y]++;
-
-                                    if (points_count < points_max) {
-                                        point_init(&points[points_count], x, y);
-                                        points_count += 1;
-                                    }
-                                }
+        int *x_delta_histogram = fb_alloc0((2 * ptr->w) * sizeof(int), FB_ALLOC_NO_HINT);
+        int *y_delta_histogram = fb_alloc0((2 * ptr->h) * sizeof(int), FB_ALLOC_NO_HINT);
+        regression_sample_t sample = {
+            .points = fb_alloc(REGRESSION_ROBUST_POINTS * sizeof(point_t), FB_ALLOC_NO_HINT),
+            .count = 0,
+            .stride = 1,
+            .skip = 0,
+        };
+
+        int blob_x1 = roi->x + roi->w - 1;
+        int blob_y1 = roi->y + roi->h - 1;
+        int blob_x2 = roi->x;
+        int blob_y2 = roi->y;
+        int blob_pixels = 0;
+
+        list_for_each(it, thresholds) {
+            color_thresholds_list_lnk_data_t *lnk_data = list_get_data(it);
+
+            switch (ptr->pixfmt) {
+                case PIXFORMAT_BINARY: {
+                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
+                        uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(ptr, y);
+                        for (int x = roi->x + (y % x_stride), xx = roi->x + roi->w; x < xx; x += x_stride) {
+                            if (COLOR_THRESHOLD_BINARY(IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
+                                blob_x1 = IM_MIN(blob_x1, x);
+                                blob_y1 = IM_MIN(blob_y1, y);
+                                blob_x2 = IM_MAX(blob_x2, x);
+                                blob_y2 = IM_MAX(blob_y2, y);
+                                regression_sample(&sample, x, y);
+                                blob_pixels += 1;
+                                x_histogram[x]++;
+                                y_histogram[y]++;
                             }
                         }
-                        break;
                     }
-                    case PIXFORMAT_GRAYSCALE: {
-                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
-                            uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(ptr, y);
-                            for (int x = roi->x + (y % x_stride), xx = roi->x + roi->w; x < xx; x += x_stride) {
-                                if (COLOR_THRESHOLD_GRAYSCALE(IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
-                                    blob_x1 = IM_MIN(blob_x1, x);
-                                    blob_y1 = IM_MIN(blob_y1, y);
-                                    blob_x2 = IM_MAX(blob_x2, x);
-                                    blob_y2 = IM_MAX(blob_y2, y);
-                                    blob_pixels += 1;
-                                    x_histogram[x]++;
-                                    y_histogram[y]++;
-
-                                    if (points_count < points_max) {
-                                        point_init(&points[points_count], x, y);
-                                        points_count += 1;
-                                    }
-                                }
+                    break;
+                }
+                case PIXFORMAT_GRAYSCALE: {
+                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
+                        uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(ptr, y);
+                        for (int x = roi->x + (y % x_stride), xx = roi->x + roi->w; x < xx; x += x_stride) {
+                            if (COLOR_THRESHOLD_GRAYSCALE(IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
+                                blob_x1 = IM_MIN(blob_x1, x);
+                                blob_y1 = IM_MIN(blob_y1, y);
+                                blob_x2 = IM_MAX(blob_x2, x);
+                                blob_y2 = IM_MAX(blob_y2, y);
+                                regression_sample(&sample, x, y);
+                                blob_pixels += 1;
+                                x_histogram[x]++;
+                                y_histogram[y]++;
                             }
                         }
-                        break;
                     }
-                    case PIXFORMAT_RGB565: {
-                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
-                            uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(ptr, y);
-                            for (int x = roi->x + (y % x_stride), xx = roi->x + roi->w; x < xx; x += x_stride) {
-                                if (COLOR_THRESHOLD_RGB565(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
-                                    blob_x1 = IM_MIN(blob_x1, x);
-                                    blob_y1 = IM_MIN(blob_y1, y);
-                                    blob_x2 = IM_MAX(blob_x2, x);
-                                    blob_y2 = IM_MAX(blob_y2, y);
-                                    blob_pixels += 1;
-                                    x_histogram[x]++;
-                                    y_histogram[y]++;
-
-                                    if (points_count < points_max) {
-                                        point_init(&points[points_count], x, y);
-                                        points_count += 1;
-                                    }
-                                }
+                    break;
+                }
+                case PIXFORMAT_RGB565: {
+                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
+                        uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(ptr, y);
+                        for (int x = roi->x + (y % x_stride), xx = roi->x + roi->w; x < xx; x += x_stride) {
+                            if (COLOR_THRESHOLD_RGB565(IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x), lnk_data, invert)) {
+                                blob_x1 = IM_MIN(blob_x1, x);
+                                blob_y1 = IM_MIN(blob_y1, y);
+                                blob_x2 = IM_MAX(blob_x2, x);
+                                blob_y2 = IM_MAX(blob_y2, y);
+                                regression_sample(&sample, x, y);
+                                blob_pixels += 1;
+                                x_histogram[x]++;
+                                y_histogram[y]++;
                             }
                         }
-                        break;
-                    }
-                    default: {
-                        break;
                     }
+                    break;
+                }
+                default: {
+                    break;
                 }
             }
+        }
 
-            int w = blob_x2 - blob_x1;
-            int h = blob_y2 - blob_y1;
-            if (blob_pixels && ((w * h) >= area_threshold) && (blob_pixels >= pixels_threshold)) {
-                long long delta_sum = (points_count * (points_count - 1)) / 2;
-
-                if (delta_sum) {
-                    // The code below computes the average slope between all pairs of points.
-                    // This is a N^2 operation that can easily blow up if the image is not threshold carefully...
-
-                    for (int i = 0; i < points_count; i++) {
-                        point_t *p0 = &points[i];
-                        for (int j = i + 1; j < points_count; j++) {
-                            point_t *p1 = &points[j];
-                            // Note we allocated 1 extra above so we can do ptr->w instead of (ptr->w-1).
-                            x_delta_histogram[p0->x - p1->x + ptr->w]++;
-                            // Note we allocated 1 extra above so we can do ptr->h instead of (ptr->h-1).
-                            y_delta_histogram[p0->y - p1->y + ptr->h]++;
-                        }
+        int w = blob_x2 - blob_x1;
+        int h = blob_y2 - blob_y1;
+        if (blob_pixels && ((w * h) >= area_threshold) && (blob_pixels >= pixels_threshold)) {
+            point_t *points = sample.points;
+            int points_count = sample.count;
+            int delta_sum = (points_count * (points_count - 1)) / 2;
+
+            if (delta_sum) {
+                // The code below computes the median slope between all pairs of sampled points,
+                // the sample size bounds this N^2 loop no matter how many pixels pass the threshold.
+
+                for (int i = 0; i < points_count; i++) {
+                    point_t *p0 = &points[i];
+                    for (int j = i + 1; j < points_count; j++) {
+                        point_t *p1 = &points[j];
+                        // Note we allocated 1 extra above so we can do ptr->w instead of (ptr->w-1).
+                        x_delta_histogram[p0->x - p1->x + ptr->w]++;
+                        // Note we allocated 1 extra above so we can do ptr->h instead of (ptr->h-1).
+                        y_delta_histogram[p0->y - p1->y + ptr->h]++;
                     }
+                }
 
-                    int mx = get_median(x_histogram, blob_pixels, ptr->w); // Output doesn't need adjustment.
-                    int my = get_median(y_histogram, blob_pixels, ptr->h); // Output doesn't need adjustment.
-                    int mdx = get_median_l(x_delta_histogram, delta_sum, 2 * ptr->w) - ptr->w; // Fix offset.
-                    int mdy = get_median_l(y_delta_histogram, delta_sum, 2 * ptr->h) - ptr->h; // Fix offset.
+                int mx = get_median(x_histogram, blob_pixels, ptr->w); // Output doesn't need adjustment.
+                int my = get_median(y_histogram, blob_pixels, ptr->h); // Output doesn't need adjustment.
+                int mdx = get_median(x_delta_histogram, delta_sum, 2 * ptr->w) - ptr->w; // Fix offset.
+                int mdy = get_median(y_delta_histogram, delta_sum, 2 * ptr->h) - ptr->h; // Fix offset.
 
-                    float rotation = (mdx ? fast_atan2f(mdy, mdx) : 1.570796f) + 1.570796f; // PI/2
+                float rotation = (mdx ? fast_atan2f(mdy, mdx) : 1.570796f) + 1.570796f; // PI/2
 
-                    out->theta = fast_roundf(rotation * 57.295780) % 180; // * (180 / PI)
-                    if (out->theta < 0) {
-                        out->theta += 180;
-                    }
-                    out->rho = fast_roundf(((mx - roi->x) * cos_table[out->theta]) + ((my - roi->y) * sin_table[out->theta]));
-
-                    out->magnitude = fast_roundf(fast_sqrtf((mdx * mdx) + (mdy * mdy)));
-
-                    if ((45 <= out->theta) && (out->theta < 135)) {
-                        // y = (r - x cos(t)) / sin(t)
-                        out->line.x1 = 0;
-                        out->line.y1 = fast_roundf((out->rho - (out->line.x1 * cos_table[out->theta])) / sin_table[out->theta]);
-                        out->line.x2 = roi->w - 1;
-                        out->line.y2 = fast_roundf((out->rho - (out->line.x2 * cos_table[out->theta])) / sin_table[out->theta]);
-                    } else {
-                        // x = (r - y sin(t)) / cos(t);
-                        out->line.y1 = 0;
-                        out->line.x1 = fast_roundf((out->rho - (out->line.y1 * sin_table[out->theta])) / cos_table[out->theta]);
-                        out->line.y2 = roi->h - 1;
-                        out->line.x2 = fast_roundf((out->rho - (out->line.y2 * sin_table[out->theta])) / cos_table[out->theta]);
-                    }
+                out->theta = fast_roundf(rotation * 57.295780) % 180; // * (180 / PI)
+                if (out->theta < 0) {
+                    out->theta += 180;
+                }
+                out->rho = fast_roundf(((mx - roi->x) * cos_table[out->theta]) + ((my - roi->y) * sin_table[out->theta]));
 
-                    if (lb_clip_line(&out->line, 0, 0, roi->w, roi->h)) {
-                        out->line.x1 += roi->x;
-                        out->line.y1 += roi->y;
-                        out->line.x2 += roi->x;
-                        out->line.y2 += roi->y;
-                        // Move rho too.
-                        out->rho += fast_roundf((roi->x * cos_table[out->theta]) + (roi->y * sin_table[out->theta]));
-                        result = true;
-                    } else {
-                        memset(out, 0, sizeof(find_lines_list_lnk_data_t));
-                    }
+                out->magnitude = fast_roundf(fast_sqrtf((mdx * mdx) + (mdy * mdy)));
+
+                if ((45 <= out->theta) && (out->theta < 135)) {
+                    // y = (r - x cos(t)) / sin(t)
+                    out->line.x1 = 0;
+                    out->line.y1 = fast_roundf((out->rho - (out->line.x1 * cos_table[out->theta])) / sin_table[out->theta]);
+                    out->line.x2 = roi->w - 1;
+                    out->line.y2 = fast_roundf((out->rho - (out->line.x2 * cos_table[out->theta])) / sin_table[out->theta]);
+                } else {
+                    // x = (r - y sin(t)) / cos(t);
+                    out->line.y1 = 0;
+                    out->line.x1 = fast_roundf((out->rho - (out->line.y1 * sin_table[out->theta])) / cos_table[out->theta]);
+                    out->line.y2 = roi->h - 1;
+                    out->line.x2 = fast_roundf((out->rho - (out->line.y2 * sin_table[out->theta])) / cos_table[out->theta]);
+                }
+
+                if (lb_clip_line(&out->line, 0, 0, roi->w, roi->h)) {
+                    out->line.x1 += roi->x;
+                    out->line.y1 += roi->y;
+                    out->line.x2 += roi->x;
+                    out->line.y2 += roi->y;
+                    // Move rho too.
+                    out->rho += fast_roundf((roi->x * cos_table[out->theta]) + (roi->y * sin_table[out->theta]));
+                    result = true;
+                } else {
+                    memset(out, 0, sizeof(find_lines_list_lnk_data_t));
                 }
             }
         }
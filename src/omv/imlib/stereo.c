@@ -20,109 +20,86 @@
 #define BLOCK_H_U     (((BLOCK_H) / 2) - 1)
 #define BLOCK_H_D     ((BLOCK_H) / 2)
 
-#define BLOCK_SIZE    ((BLOCK_W) *(BLOCK_H))
-
-static inline void shift(uint8_t *data, image_t *img, int x, int y) {
-#if defined(ARM_MATH_DSP) && (!(BLOCK_SIZE % 4))
-    int x_2 = x + BLOCK_W_R;
-    uint32_t *data_32 = (uint32_t *) data;
-
-    #if BLOCK_SIZE == 4
-    uint32_t temp = __UXTB16_RORn(*data_32, 8);
-    temp |= IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y) << 8;
-    temp |= IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y + 1) << 24;
-    *data_32 = temp;
-    #elif BLOCK_SIZE == 16
-    data_32[0] = (data_32[0] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y - 1) << 24);
-    data_32[1] = (data_32[1] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y) << 24);
-    data_32[2] = (data_32[2] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y + 1) << 24);
-    data_32[3] = (data_32[3] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y + 2) << 24);
-    #elif BLOCK_SIZE == 64
-    data_32[0] = (data_32[0] >> 8) | (data_32[1] << 24);
-    data_32[1] = (data_32[1] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y - 3) << 24);
-    data_32[2] = (data_32[2] >> 8) | (data_32[3] << 24);
-    data_32[3] = (data_32[3] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y - 2) << 24);
-    data_32[4] = (data_32[4] >> 8) | (data_32[5] << 24);
-    data_32[5] = (data_32[5] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y - 1) << 24);
-    data_32[6] = (data_32[6] >> 8) | (data_32[7] << 24);
-    data_32[7] = (data_32[7] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y) << 24);
-    data_32[8] = (data_32[8] >> 8) | (data_32[9] << 24);
-    data_32[9] = (data_32[9] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y + 1) << 24);
-    data_32[10] = (data_32[10] >> 8) | (data_32[11] << 24);
-    data_32[11] = (data_32[11] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y + 2) << 24);
-    data_32[12] = (data_32[12] >> 8) | (data_32[13] << 24);
-    data_32[13] = (data_32[13] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y + 3) << 24);
-    data_32[14] = (data_32[14] >> 8) | (data_32[15] << 24);
-    data_32[15] = (data_32[15] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y + 4) << 24);
-    #else
-    for (int j = -BLOCK_H_U, last = (BLOCK_W / sizeof(uint32_t)) - 1; j <= BLOCK_H_D; j++, data_32 += last + 1) {
-        for (int i = 0; i < last; i++) {
-            data_32[i] = (data_32[i] >> 8) | (data_32[i + 1] << 24);
-        }
-        data_32[last] = (data_32[last] >> 8) | (IMAGE_GET_GRAYSCALE_PIXEL(img, x_2, y + j) << 24);
+// The cost of a block is the sum of the costs of its rows, so moving down one row only adds the
+// row entering the block and subtracts the row leaving it. Each row cost is one BLOCK_W wide
+// window: the SAD of the intensities, or the Hamming distance of 3x3 census codes.
+static inline uint32_t stereo_row_cost(const uint8_t *l, const uint8_t *r, bool census) {
+    uint32_t cost = 0;
+
+#if defined(ARM_MATH_DSP) && (!(BLOCK_W % 4))
+    for (int i = 0; i < BLOCK_W; i += 4) {
+        uint32_t l_32 = *((uint32_t *) (l + i));
+        uint32_t r_32 = *((uint32_t *) (r + i));
+        cost = census ? (cost + __builtin_popcount(l_32 ^ r_32)) : __USADA8(l_32, r_32, cost);
     }
-    #endif
 #else
-    for (int i = 0, j = -BLOCK_H_U; j <= BLOCK_H_D; j++) {
-        int y_p = y + j;
-        uint8_t *k_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y_p);
-        for (int k = -BLOCK_W_L; k <= BLOCK_W_R; k++) {
-            int x_p = x + k;
-            data[i++] = IMAGE_GET_GRAYSCALE_PIXEL_FAST(k_row_ptr, x_p);
-        }
+    for (int i = 0; i < BLOCK_W; i++) {
+        cost += census ? __builtin_popcount(l[i] ^ r[i]) : abs(l[i] - r[i]);
     }
 #endif
+
+    return cost;
 }
 
-static inline uint32_t sad(uint8_t *data_l, uint8_t *data_r) {
-    uint32_t diff = 0;
-
-#if defined(ARM_MATH_DSP) && (!(BLOCK_SIZE % 4))
-    uint32_t *data_l_32 = (uint32_t *) data_l;
-    uint32_t *data_r_32 = (uint32_t *) data_r;
-
-    #if BLOCK_SIZE == 4
-    diff = __USADA8(*data_l_32, *data_r_32, diff);
-    #elif BLOCK_SIZE == 16
-    diff = __USADA8(data_l_32[0], data_r_32[0], diff);
-    diff = __USADA8(data_l_32[1], data_r_32[1], diff);
-    diff = __USADA8(data_l_32[2], data_r_32[2], diff);
-    diff = __USADA8(data_l_32[3], data_r_32[3], diff);
-    #elif BLOCK_SIZE == 64
-    diff = __USADA8(data_l_32[0],  data_r_32[0],  diff);
-    diff = __USADA8(data_l_32[1],  data_r_32[1],  diff);
-    diff = __USADA8(data_l_32[2],  data_r_32[2],  diff);
-    diff = __USADA8(data_l_32[3],  data_r_32[3],  diff);
-    diff = __USADA8(data_l_32[4],  data_r_32[4],  diff);
-    diff = __USADA8(data_l_32[5],  data_r_32[5],  diff);
-    diff = __USADA8(data_l_32[6],  data_r_32[6],  diff);
-    diff = __USADA8(data_l_32[7],  data_r_32[7],  diff);
-    diff = __USADA8(data_l_32[8],  data_r_32[8],  diff);
-    diff = __USADA8(data_l_32[9],  data_r_32[9],  diff);
-    diff = __USADA8(data_l_32[10], data_r_32[10], diff);
-    diff = __USADA8(data_l_32[11], data_r_32[11], diff);
-    diff = __USADA8(data_l_32[12], data_r_32[12], diff);
-    diff = __USADA8(data_l_32[13], data_r_32[13], diff);
-    diff = __USADA8(data_l_32[14], data_r_32[14], diff);
-    diff = __USADA8(data_l_32[15], data_r_32[15], diff);
-    #else
-    for (int i = 0; i < (BLOCK_SIZE / sizeof(uint32_t)); i++) {
-        diff = __USADA8(data_l_32[i], data_r_32[i], diff);
+// Copies row y (clamped) of the half at x_offset into row, or its census codes, with the edge
+// pixels repeated BLOCK_W_L times on the left and BLOCK_W_R times on the right.
+static void stereo_get_row(image_t *img, int y, int x_offset, int width, bool census, uint8_t *row) {
+    uint8_t *out = row + BLOCK_W_L;
+    uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, IM_CLAMP(y, 0, img->h - 1)) + x_offset;
+
+    if (!census) {
+        memcpy(out, row_ptr, width);
+    } else {
+        uint8_t *row_ptr_u = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, IM_CLAMP(y - 1, 0, img->h - 1)) + x_offset;
+        uint8_t *row_ptr_d = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, IM_CLAMP(y + 1, 0, img->h - 1)) + x_offset;
+
+        for (int x = 0; x < width; x++) {
+            int x_l = IM_MAX(x - 1, 0), x_r = IM_MIN(x + 1, width - 1);
+            int p = row_ptr[x];
+            out[x] = ((row_ptr_u[x_l] >= p) << 0) | ((row_ptr_u[x] >= p) << 1) |
+                     ((row_ptr_u[x_r] >= p) << 2) | ((row_ptr[x_r] >= p) << 3) |
+                     ((row_ptr_d[x_r] >= p) << 4) | ((row_ptr_d[x] >= p) << 5) |
+                     ((row_ptr_d[x_l] >= p) << 6) | ((row_ptr[x_l] >= p) << 7);
+        }
     }
-    #endif
-#else
-    for (int i = 0; i < BLOCK_SIZE; i++) {
-        int d = data_l[i] - data_r[i];
-        diff += abs(d);
+
+    memset(row, out[0], BLOCK_W_L);
+    memset(out + width, out[width - 1], BLOCK_W_R);
+}
+
+// Adds the costs of row y_in to and subtracts the costs of row y_out (if >= -BLOCK_H_U - 1)
+// from the block costs of every pixel and disparity.
+static void stereo_update_costs(image_t *img, int y_in, int y_out, int xl_offset, int xr_offset,
+                                int width, int max_disparity, bool census, uint8_t *rows, uint16_t *costs) {
+    int row_w = width + BLOCK_W - 1;
+    uint8_t *l_in = rows, *r_in = rows + row_w, *l_out = rows + (row_w * 2), *r_out = rows + (row_w * 3);
+    bool out = y_out >= (-BLOCK_H_U - 1);
+
+    stereo_get_row(img, y_in, xl_offset, width, census, l_in);
+    stereo_get_row(img, y_in, xr_offset, width, census, r_in);
+
+    if (out) {
+        stereo_get_row(img, y_out, xl_offset, width, census, l_out);
+        stereo_get_row(img, y_out, xr_offset, width, census, r_out);
     }
-#endif
 
-    return diff;
+    for (int xl = 0; xl < width; xl++, costs += max_disparity + 1) {
+        for (int d = 0, dd = IM_MIN(max_disparity, width - 1 - xl); d <= dd; d++) {
+            int cost = stereo_row_cost(l_in + xl, r_in + xl + d, census);
+
+            if (out) {
+                cost -= stereo_row_cost(l_out + xl, r_out + xl + d, census);
+            }
+
+            costs[d] += cost;
+        }
+    }
 }
 
-void imlib_stereo_disparity(image_t *img, bool reversed, int max_disparity, int threshold) {
-    int width_2 = img->w / 2, width_2_m_1 = width_2 - 1;
-    int height_1 = img->h, height_1_m_1 = height_1 - 1;
+void imlib_stereo_disparity(image_t *img, bool reversed, int max_disparity, int threshold, bool census, bool lr_check) {
+    int width_2 = img->w / 2;
+    int height_1 = img->h;
+    int n_disparities = max_disparity + 1;
 
     int xl_offset = 0;
     int xr_offset = width_2;
@@ -132,106 +109,124 @@ void imlib_stereo_disparity(image_t *img, bool reversed, int max_disparity, int
         xr_offset = 0;
     }
 
+    if (img->pixfmt != PIXFORMAT_GRAYSCALE) {
+        return;
+    }
+
     float disparity_scale = COLOR_GRAYSCALE_MAX / max_disparity;
 
+    // Output rows are delayed until no later block (or census code) reads the source row.
     image_t buf;
     buf.w = width_2;
-    buf.h = BLOCK_H_D;
+    buf.h = BLOCK_H + 1;
     buf.pixfmt = img->pixfmt;
+    buf.data = fb_alloc(IMAGE_GRAYSCALE_LINE_LEN_BYTES(&buf) * buf.h, FB_ALLOC_NO_HINT);
+
+    uint16_t *costs = fb_alloc0(width_2 * n_disparities * sizeof(uint16_t), FB_ALLOC_NO_HINT);
+    uint8_t *rows = fb_alloc((width_2 + BLOCK_W - 1) * 4, FB_ALLOC_NO_HINT);
+    uint8_t *disparity_l = fb_alloc(width_2, FB_ALLOC_NO_HINT);
+    uint8_t *disparity_r = fb_alloc(width_2, FB_ALLOC_NO_HINT);
 
-    switch (img->pixfmt) {
-        case PIXFORMAT_BINARY: {
-            break;
+    // The block rows of the first row, the rows above the image repeat row 0.
+    for (int j = -BLOCK_H_U; j <= BLOCK_H_D; j++) {
+        stereo_update_costs(img, j, INT_MIN, xl_offset, xr_offset, width_2, max_disparity, census, rows, costs);
+    }
+
+    for (int y = 0; y < height_1; y++) {
+        if (y) {
+            stereo_update_costs(img, y + BLOCK_H_D, y - BLOCK_H_U - 1, xl_offset, xr_offset,
+                                width_2, max_disparity, census, rows, costs);
         }
-        case PIXFORMAT_GRAYSCALE: {
-            buf.data = fb_alloc(IMAGE_GRAYSCALE_LINE_LEN_BYTES(&buf) * BLOCK_H_D, FB_ALLOC_NO_HINT);
-            uint8_t *data_l = fb_alloc(BLOCK_SIZE, FB_ALLOC_NO_HINT);
-            uint8_t *data_r = fb_alloc(BLOCK_SIZE, FB_ALLOC_NO_HINT);
-
-            for (int y = 0, yy = height_1 - BLOCK_H_D; y < height_1; y++) {
-                for (int xl = 0, xx = width_2 - BLOCK_W_R; xl < width_2; xl++) {
-                    if ((xl >= BLOCK_W_L) && (xl < xx) && (y >= BLOCK_H_U) && (y < yy)) {
-                        // fast way
-                        shift(data_l, img, xl + xl_offset, y);
-                    } else {
-                        // slow way
-                        for (int i = 0, j = -BLOCK_H_U; j <= BLOCK_H_D; j++) {
-                            int y_p = y + j;
-                            int y = IM_CLAMP(y_p, 0, height_1_m_1);
-                            uint8_t *k_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
-                            for (int k = -BLOCK_W_L; k <= BLOCK_W_R; k++) {
-                                int x_p = xl + k;
-                                int x = IM_CLAMP(x_p, 0, width_2_m_1) + xl_offset;
-                                data_l[i++] = IMAGE_GET_GRAYSCALE_PIXEL_FAST(k_row_ptr, x);
-                            }
-                        }
-                    }
 
-                    uint32_t min_diff = UINT32_MAX;
-                    int min_disparity = 0;
-
-                    for (int xr = xl, disparity = 0;
-                         (xr < width_2) && (disparity <= max_disparity); xr++, disparity++) {
-                        if (disparity && (xr >= BLOCK_W_L) && (xr < xx) && (y >= BLOCK_H_U) && (y < yy)) {
-                            // fast way
-                            shift(data_r, img, xr + xr_offset, y);
-                        } else {
-                            // slow way
-                            for (int i = 0, j = -BLOCK_H_U; j <= BLOCK_H_D; j++) {
-                                int y_p = y + j;
-                                int y = IM_CLAMP(y_p, 0, height_1_m_1);
-                                uint8_t *k_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
-                                for (int k = -BLOCK_W_L; k <= BLOCK_W_R; k++) {
-                                    int x_p = xr + k;
-                                    int x = IM_CLAMP(x_p, 0, width_2_m_1) + xr_offset;
-                                    data_r[i++] = IMAGE_GET_GRAYSCALE_PIXEL_FAST(k_row_ptr, x);
-                                }
-                            }
-                        }
-
-                        // Record the closest matching block in the scan line.
-                        uint32_t diff = sad(data_l, data_r);
-                        if (diff < min_diff) {
-                            min_diff = diff;
-                            min_disparity = disparity;
-                        }
-
-                        if (min_diff <= threshold) {
-                            break;
-                        }
-                    }
+        // Closest matching block in the scan line of each left pixel.
+        for (int xl = 0; xl < width_2; xl++) {
+            uint16_t *xl_costs = costs + (xl * n_disparities);
+            uint32_t min_diff = UINT32_MAX;
+            int min_disparity = 0;
 
-                    uint8_t *buf_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&buf, (y % BLOCK_H_D));
-                    IMAGE_PUT_GRAYSCALE_PIXEL_FAST(buf_row_ptr, xl, fast_floorf(min_disparity * disparity_scale));
+            for (int d = 0, dd = IM_MIN(max_disparity, width_2 - 1 - xl); d <= dd; d++) {
+                if (xl_costs[d] < min_diff) {
+                    min_diff = xl_costs[d];
+                    min_disparity = d;
                 }
 
-                if (y >= BLOCK_H_U) {
-                    // Transfer buffer lines...
-                    memcpy(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, (y - BLOCK_H_U)) + xr_offset,
-                           IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&buf, ((y - BLOCK_H_U) % BLOCK_H_D)),
-                           IMAGE_GRAYSCALE_LINE_LEN_BYTES(&buf));
+                if (min_diff <= threshold) {
+                    break;
                 }
             }
 
-            // Copy any remaining lines from the buffer image...
-            for (int y = IM_MAX(height_1 - BLOCK_H_U, 0); y < height_1; y++) {
-                memcpy(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y) + xr_offset,
-                       IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&buf, (y % BLOCK_H_D)),
-                       IMAGE_GRAYSCALE_LINE_LEN_BYTES(&buf));
-            }
+            disparity_l[xl] = min_disparity;
+        }
 
-            fb_free(); // data_r
-            fb_free(); // data_l
-            fb_free(); // buf
-            break;
+        // Closest matching block in the scan line of each right pixel.
+        if (lr_check) {
+            for (int xr = 0; xr < width_2; xr++) {
+                uint32_t min_diff = UINT32_MAX;
+                int min_disparity = 0;
+
+                for (int d = 0, dd = IM_MIN(max_disparity, xr); d <= dd; d++) {
+                    uint32_t diff = costs[((xr - d) * n_disparities) + d];
+                    if (diff < min_diff) {
+                        min_diff = diff;
+                        min_disparity = d;
+                    }
+
+                    if (min_diff <= threshold) {
+                        break;
+                    }
+                }
+
+                disparity_r[xr] = min_disparity;
+            }
         }
-        case PIXFORMAT_RGB565: {
-            break;
+
+        uint8_t *buf_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&buf, (y % buf.h));
+
+        for (int xl = 0; xl < width_2; xl++) {
+            uint16_t *xl_costs = costs + (xl * n_disparities);
+            int d = disparity_l[xl];
+            int dd = IM_MIN(max_disparity, width_2 - 1 - xl);
+            float disparity = d;
+
+            // Matches the two views don't agree on are occlusions or mismatches.
+            if (lr_check && (abs(disparity_r[xl + d] - d) > 1)) {
+                IMAGE_PUT_GRAYSCALE_PIXEL_FAST(buf_row_ptr, xl, 0);
+                continue;
+            }
+
+            // Sub-pixel disparity from the parabola through the costs around the minimum.
+            if ((d > 0) && (d < dd)) {
+                int c0 = xl_costs[d - 1], c1 = xl_costs[d], c2 = xl_costs[d + 1];
+                int den = c0 - (2 * c1) + c2;
+                if ((c0 >= c1) && (c2 >= c1) && (den > 0)) {
+                    disparity += (c0 - c2) / (2.0f * den);
+                }
+            }
+
+            int pixel = fast_roundf(disparity * disparity_scale);
+            IMAGE_PUT_GRAYSCALE_PIXEL_FAST(buf_row_ptr, xl, IM_CLAMP(pixel, COLOR_GRAYSCALE_MIN, COLOR_GRAYSCALE_MAX));
         }
-        default: {
-            break;
+
+        if (y >= BLOCK_H) {
+            // Transfer buffer lines...
+            memcpy(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, (y - BLOCK_H)) + xr_offset,
+                   IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&buf, ((y - BLOCK_H) % buf.h)),
+                   IMAGE_GRAYSCALE_LINE_LEN_BYTES(&buf));
         }
     }
+
+    // Copy any remaining lines from the buffer image...
+    for (int y = IM_MAX(height_1 - BLOCK_H, 0); y < height_1; y++) {
+        memcpy(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y) + xr_offset,
+               IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&buf, (y % buf.h)),
+               IMAGE_GRAYSCALE_LINE_LEN_BYTES(&buf));
+    }
+
+    fb_free(); // disparity_r
+    fb_free(); // disparity_l
+    fb_free(); // rows
+    fb_free(); // costs
+    fb_free(); // buf
 }
 
 #endif // IMLIB_ENABLE_STEREO_DISPARITY
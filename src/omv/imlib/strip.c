@@ -0,0 +1,158 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Strip-mined execution of chained line operators and operator pipelines.
+ *
+ * The image is processed in bands of rows which are copied into fast frame buffer stack memory
+ * (SRAM/DTCM on boards with overlay memory) along with a halo of radius rows above and below.
+ * The callback runs any number of line operators on the band in place and only the band rows
+ * (not the halo) are written back. So, N chained filters touch the frame in SDRAM once instead
+ * of N times. The halo must be at least the sum of the radii of the chained operators for the
+ * result to match running each operator over the whole image.
+ */
+#include "imlib.h"
+
+void imlib_strip_run(image_t *img, int radius, int rows, imlib_strip_cb_t cb, void *cb_arg) {
+    size_t line_size = image_line_size(img);
+    radius = IM_MAX(radius, 0);
+    // The halo saved below must come from the previous band only.
+    rows = IM_MIN(IM_MAX(rows, IM_MAX(radius, 1)), img->h);
+
+    image_t band = {
+        .w = img->w,
+        .h = 0,
+        .pixfmt = img->pixfmt,
+        .data = fb_alloc(line_size * (rows + (radius * 2)), FB_ALLOC_PREFER_SPEED)
+    };
+
+    // Original (unprocessed) rows above the current band.
+    uint8_t *halo = fb_alloc(line_size * radius, FB_ALLOC_PREFER_SPEED);
+
+    for (int y = 0; y < img->h; y += rows) {
+        int y_end = IM_MIN(y + rows, img->h);
+        int top = IM_MIN(radius, y);
+        int bot = IM_MIN(y_end + radius, img->h);
+
+        if (top) {
+            memcpy(band.data, halo + (line_size * (radius - top)), line_size * top);
+        }
+
+        memcpy(band.data + (line_size * top), img->data + (line_size * y), line_size * (bot - y));
+        band.h = top + (bot - y);
+
+        cb(&band, cb_arg);
+
+        if (radius && (y_end < img->h)) {
+            memcpy(halo, img->data + (line_size * (y_end - radius)), line_size * radius);
+        }
+
+        memcpy(img->data + (line_size * y), band.data + (line_size * top), line_size * (y_end - y));
+    }
+
+    if (halo) {
+        fb_free();
+    }
+    fb_free();
+}
+
+// Kernel rows each operator needs above and below any output row.
+static int imlib_pipeline_op_radius(const imlib_pipeline_op_t *op) {
+    switch (op->type) {
+        case IMLIB_PIPELINE_BINARY:
+        case IMLIB_PIPELINE_INVERT: {
+            return 0;
+        }
+        case IMLIB_PIPELINE_OPEN:
+        case IMLIB_PIPELINE_CLOSE: {
+            return op->ksize * 2;
+        }
+        default: {
+            return op->ksize;
+        }
+    }
+}
+
+int imlib_pipeline_radius(const imlib_pipeline_op_t *ops, int n_ops) {
+    int radius = 0;
+    for (int i = 0; i < n_ops; i++) {
+        radius += imlib_pipeline_op_radius(&ops[i]);
+    }
+    return radius;
+}
+
+static void imlib_pipeline_band(image_t *band, void *arg) {
+    imlib_pipeline_t *pipeline = arg;
+
+    for (int i = 0; i < pipeline->n_ops; i++) {
+        imlib_pipeline_op_t *op = &pipeline->ops[i];
+        // Operators must not free the band and halo buffers below them.
+        fb_alloc_mark();
+        switch (op->type) {
+            #ifdef IMLIB_ENABLE_BINARY_OPS
+            case IMLIB_PIPELINE_BINARY: {
+                imlib_binary(band, band, &op->thresholds, op->invert, false, NULL);
+                break;
+            }
+            case IMLIB_PIPELINE_INVERT: {
+                imlib_invert(band);
+                break;
+            }
+            case IMLIB_PIPELINE_ERODE: {
+                imlib_erode(band, op->ksize, op->threshold, NULL);
+                break;
+            }
+            case IMLIB_PIPELINE_DILATE: {
+                imlib_dilate(band, op->ksize, op->threshold, NULL);
+                break;
+            }
+            case IMLIB_PIPELINE_OPEN: {
+                imlib_open(band, op->ksize, op->threshold, NULL);
+                break;
+            }
+            case IMLIB_PIPELINE_CLOSE: {
+                imlib_close(band, op->ksize, op->threshold, NULL);
+                break;
+            }
+            #endif
+            #ifdef IMLIB_ENABLE_MEAN
+            case IMLIB_PIPELINE_MEAN: {
+                imlib_mean_filter(band, op->ksize, false, 0, false, NULL);
+                break;
+            }
+            #endif
+            #ifdef IMLIB_ENABLE_MEDIAN
+            case IMLIB_PIPELINE_MEDIAN: {
+                imlib_median_filter(band, op->ksize, op->arg, false, 0, false, NULL);
+                break;
+            }
+            #endif
+            #ifdef IMLIB_ENABLE_MODE
+            case IMLIB_PIPELINE_MODE: {
+                imlib_mode_filter(band, op->ksize, false, 0, false, NULL);
+                break;
+            }
+            #endif
+            #ifdef IMLIB_ENABLE_MIDPOINT
+            case IMLIB_PIPELINE_MIDPOINT: {
+                imlib_midpoint_filter(band, op->ksize, op->arg, false, 0, false, NULL);
+                break;
+            }
+            #endif
+            default: {
+                break;
+            }
+        }
+        fb_alloc_free_till_mark();
+    }
+}
+
+// Runs all of the pipeline operators band by band, so the image is read and written once.
+void imlib_pipeline_run(image_t *img, imlib_pipeline_t *pipeline) {
+    imlib_strip_run(img, imlib_pipeline_radius(pipeline->ops, pipeline->n_ops),
+                    pipeline->rows, imlib_pipeline_band, pipeline);
+}
@@ -0,0 +1,276 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2023 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2023 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Row band kernels, split between the caller and a second core if there's one: the Cortex-M4
+ * on dual-core STM32H7 parts, which runs kernels built into its own firmware, or RP2040 core1,
+ * which runs the same code as the caller.
+ *
+ * Tile kernels (imlib_task_tiles()) split the ROI into one band of rows per core. Each tile
+ * gets its own result and scratch arena, the results are then merged by the kernel's reducer.
+ * Tile kernels only read the image (plus halo rows around their band) and write their result.
+ */
+#include "imlib.h"
+#include "omv_boardconfig.h"
+#if OMV_ENABLE_CM4
+#include CMSIS_MCU_H
+#include "cm4_ipc.h"
+#include "omv_cache.h"
+#elif OMV_CORE1_ENABLE
+#include "omv_core1.h"
+#endif
+
+#define IMLIB_TASK_MIN_ROWS     (16)    // Smaller ROIs are not worth the round trip.
+#define IMLIB_TASK_TIMEOUT      (1000)  // ms
+#define IMLIB_TASK_CACHE_LINE   (32)
+#define IMLIB_TASK_TILES_MAX    (2)
+
+#if OMV_ENABLE_CM4
+// Queues rows [y_start, y_end) of the ROI on the CM4, returns NULL if it can't.
+static cm4_job_t *imlib_task_submit(cm4_kernel_t kernel, image_t *img, rectangle_t *roi,
+                                    int y_start, int y_end, void *arg0, void *arg1) {
+    int stride = image_line_size(img);
+    uint8_t *band = img->data + (y_start * stride);
+    uint32_t size = (y_end - y_start) * stride;
+
+    if (!cm4_ipc_accessible(img->data, image_size(img))) {
+        return NULL;
+    }
+
+    // Write back (and drop) the band so neither core sees stale lines.
+    omv_cache_clean_invalidate(band, size);
+
+    uint32_t args[] = {
+        (uint32_t) img->data, stride, roi->x, roi->w, y_start, y_end, (uint32_t) arg0, (uint32_t) arg1
+    };
+    return cm4_ipc_submit(kernel, args, sizeof(args) / sizeof(args[0]));
+}
+#elif OMV_CORE1_ENABLE
+static void imlib_task_core1_job(void *arg) {
+    imlib_tile_t *tile = (imlib_tile_t *) arg;
+    tile->kernel->run(tile);
+}
+#endif
+
+void *imlib_tile_alloc(imlib_tile_t *tile, size_t size) {
+    size = (size + 3) & ~3;
+
+    if (size > tile->scratch_left) {
+        return NULL;
+    }
+
+    void *ptr = tile->scratch;
+    tile->scratch += size;
+    tile->scratch_left -= size;
+    return ptr;
+}
+
+static void imlib_task_tile_reset(imlib_tile_t *tile, uint8_t *scratch) {
+    const imlib_tile_kernel_t *kernel = tile->kernel;
+
+    if (kernel->init) {
+        kernel->init(tile->result, tile->arg);
+    } else {
+        memset(tile->result, 0, kernel->result_size);
+    }
+
+    tile->scratch = scratch;
+    tile->scratch_left = kernel->scratch_size;
+}
+
+// Starts a tile on the second core, returns false if it can't.
+static bool imlib_task_tile_submit(imlib_tile_t *tile, void **job) {
+    #if OMV_ENABLE_CM4
+    const imlib_tile_kernel_t *kernel = tile->kernel;
+    int y_start = IM_MAX(tile->rect.y - kernel->halo, 0);
+    int y_end = IM_MIN(tile->rect.y + tile->rect.h + kernel->halo, tile->img->h);
+
+    if ((kernel->cm4_kernel < 0) ||
+        (!cm4_ipc_accessible(tile->result, kernel->result_size)) ||
+        (tile->arg && (!cm4_ipc_accessible(tile->arg, 1)))) {
+        return false;
+    }
+
+    int stride = image_line_size(tile->img);
+
+    // The result is written by the CM4, so no dirty lines of it may be evicted over it.
+    omv_cache_clean_invalidate(tile->result, kernel->result_size);
+    // The halo rows are only read, the band is written back by imlib_task_submit().
+    omv_cache_clean(tile->img->data + (y_start * stride), (tile->rect.y - y_start) * stride);
+    omv_cache_clean(tile->img->data + ((tile->rect.y + tile->rect.h) * stride),
+                    (y_end - tile->rect.y - tile->rect.h) * stride);
+
+    *job = imlib_task_submit(kernel->cm4_kernel, tile->img, &tile->rect, tile->rect.y,
+                             tile->rect.y + tile->rect.h, tile->result, tile->arg);
+    return *job != NULL;
+    #elif OMV_CORE1_ENABLE
+    return omv_core1_exec(imlib_task_core1_job, tile);
+    #else
+    return false;
+    #endif
+}
+
+// Waits for a tile started on the second core, returns false if it didn't finish.
+static bool imlib_task_tile_wait(imlib_tile_t *tile, void *job) {
+    #if OMV_ENABLE_CM4
+    if (cm4_ipc_wait(job, IMLIB_TASK_TIMEOUT)) {
+        omv_cache_invalidate(tile->result, tile->kernel->result_size);
+        return true;
+    }
+    return false;
+    #elif OMV_CORE1_ENABLE
+    omv_core1_wait();
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+static int imlib_task_tiles_count(const imlib_tile_kernel_t *kernel, rectangle_t *roi) {
+    if (roi->h < IMLIB_TASK_MIN_ROWS) {
+        return 1;
+    }
+
+    #if OMV_ENABLE_CM4
+    return ((kernel->cm4_kernel >= 0) && cm4_ipc_ready()) ? 2 : 1;
+    #elif OMV_CORE1_ENABLE
+    return 2;
+    #else
+    return 1;
+    #endif
+}
+
+void imlib_task_tiles(const imlib_tile_kernel_t *kernel, image_t *img, rectangle_t *roi, void *result, void *arg) {
+    imlib_tile_t tiles[IMLIB_TASK_TILES_MAX];
+    int n = imlib_task_tiles_count(kernel, roi);
+    // Results are cache line aligned, so a core writing one never touches another's.
+    size_t result_size = (kernel->result_size + IMLIB_TASK_CACHE_LINE - 1) & ~(IMLIB_TASK_CACHE_LINE - 1);
+    uint8_t *buf = fb_alloc(IM_MAX(n * (result_size + kernel->scratch_size), (size_t) 1), FB_ALLOC_CACHE_ALIGN);
+    uint8_t *scratch = buf + (n * result_size);
+
+    for (int i = 0, y = roi->y; i < n; i++) {
+        int h = (i == (n - 1)) ? (roi->y + roi->h - y) : (roi->h / n);
+        tiles[i].img = img;
+        tiles[i].kernel = kernel;
+        tiles[i].arg = arg;
+        tiles[i].result = buf + (i * result_size);
+        rectangle_init(&tiles[i].rect, roi->x, y, roi->w, h);
+        imlib_task_tile_reset(&tiles[i], scratch + (i * kernel->scratch_size));
+        y += h;
+    }
+
+    void *job = NULL;
+    bool submitted = (n > 1) && imlib_task_tile_submit(&tiles[1], &job);
+
+    kernel->run(&tiles[0]);
+
+    if (n > 1) {
+        if (!(submitted && imlib_task_tile_wait(&tiles[1], job))) {
+            // The second core never started the tile (the job was revoked), run it here.
+            imlib_task_tile_reset(&tiles[1], scratch + kernel->scratch_size);
+            kernel->run(&tiles[1]);
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        kernel->reduce(result, tiles[i].result, arg);
+    }
+
+    fb_free(); // buf
+}
+
+static void imlib_task_histogram_grayscale_run(imlib_tile_t *tile) {
+    uint32_t *hist = (uint32_t *) tile->result;
+    for (int y = tile->rect.y, yy = tile->rect.y + tile->rect.h; y < yy; y++) {
+        uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(tile->img, y) + tile->rect.x;
+        for (int x = 0; x < tile->rect.w; x++) {
+            hist[row_ptr[x]] += 1;
+        }
+    }
+}
+
+static void imlib_task_histogram_grayscale_reduce(void *result, const void *tile_result, void *arg) {
+    for (int i = 0; i < 256; i++) {
+        ((uint32_t *) result)[i] += ((const uint32_t *) tile_result)[i];
+    }
+}
+
+static const imlib_tile_kernel_t imlib_task_histogram_grayscale_kernel = {
+    .halo = 0,
+    .result_size = 256 * sizeof(uint32_t),
+    .scratch_size = 0,
+    .init = NULL,
+    .run = imlib_task_histogram_grayscale_run,
+    .reduce = imlib_task_histogram_grayscale_reduce,
+    #if OMV_ENABLE_CM4
+    .cm4_kernel = CM4_KERNEL_HISTOGRAM_GRAYSCALE,
+    #else
+    .cm4_kernel = -1,
+    #endif
+};
+
+static void imlib_task_lut_grayscale_rows(image_t *img, rectangle_t *roi,
+                                          int y_start, int y_end, const uint8_t *lut) {
+    for (int y = y_start; y < y_end; y++) {
+        uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y) + roi->x;
+        for (int x = 0; x < roi->w; x++) {
+            row_ptr[x] = lut[row_ptr[x]];
+        }
+    }
+}
+
+void imlib_task_histogram_grayscale(image_t *img, rectangle_t *roi, uint32_t *hist) {
+    imlib_task_tiles(&imlib_task_histogram_grayscale_kernel, img, roi, hist, NULL);
+}
+
+void imlib_task_lut_grayscale(image_t *img, rectangle_t *roi, const uint8_t *lut) {
+    int y_mid = roi->y + roi->h;
+    int y_defer = y_mid;
+
+    #if OMV_ENABLE_CM4
+    cm4_job_t *job = NULL;
+    uint8_t *cm4_lut = NULL;
+
+    if ((roi->h >= IMLIB_TASK_MIN_ROWS) && cm4_ipc_ready()) {
+        // The LUT may be on the stack (DTCM), which the CM4 can't read.
+        cm4_lut = fb_alloc(256, FB_ALLOC_CACHE_ALIGN);
+        memcpy(cm4_lut, lut, 256);
+        omv_cache_clean(cm4_lut, 256);
+        y_mid = roi->y + (roi->h / 2);
+        job = imlib_task_submit(CM4_KERNEL_LUT_GRAYSCALE, img, roi, y_mid, roi->y + roi->h, cm4_lut, NULL);
+        if (job) {
+            // Rows near a cache line of the CM4 band are done after the CM4 is, otherwise
+            // evicting (or invalidating) those lines would clobber one core's results.
+            int stride = image_line_size(img);
+            y_defer = IM_MAX(y_mid - (((IMLIB_TASK_CACHE_LINE * 2) + stride - 1) / stride), roi->y);
+        } else {
+            y_mid = roi->y + roi->h;
+        }
+    }
+    #endif
+
+    imlib_task_lut_grayscale_rows(img, roi, roi->y, y_defer, lut);
+
+    #if OMV_ENABLE_CM4
+    if (job) {
+        if (cm4_ipc_wait(job, IMLIB_TASK_TIMEOUT)) {
+            int stride = image_line_size(img);
+            omv_cache_invalidate(img->data + (y_mid * stride),
+                                 (roi->y + roi->h - y_mid) * stride);
+        } else {
+            // The CM4 never started on the band (the job was revoked), map its rows here.
+            imlib_task_lut_grayscale_rows(img, roi, y_mid, roi->y + roi->h, lut);
+        }
+    }
+
+    if (cm4_lut) {
+        fb_free(); // cm4_lut
+    }
+    #endif
+
+    imlib_task_lut_grayscale_rows(img, roi, y_defer, y_mid, lut);
+}
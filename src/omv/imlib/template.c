@@ -19,6 +19,7 @@
 
 #include "imlib.h"
 #include "xalloc.h"
+#include "fb_alloc.h"
 
 static void set_dsp(int cx, int cy, point_t *pts, bool sdsp, int step) {
     if (sdsp) {
@@ -211,68 +212,152 @@ float imlib_template_match_ds(image_t *f, image_t *t, rectangle_t *r) {
     return max_xc;
 }
 
+// Template prepared once per search. The data holds the template minus its (integer) mean, so
+// the numerator of the NCC can be taken directly against the image pixels and corrected with
+// the patch sum afterwards instead of subtracting the patch mean from every pixel.
+typedef struct ncc_template {
+    int w, h, n, stride;
+    int16_t *data;
+    int sum;    // Sum of data (the integer mean leaves a remainder).
+    float den;  // Square root of the template variance times n.
+} ncc_template_t;
+
+// Allocates the template data with fb_alloc, the caller frees it.
+static void ncc_template_init(ncc_template_t *nt, image_t *t) {
+    int t_mean = 0;
+    imlib_image_mean(t, &t_mean, &t_mean, &t_mean);
+
+    nt->w = t->w;
+    nt->h = t->h;
+    nt->n = t->w * t->h;
+    // Rows start word aligned for the DSP loads.
+    nt->stride = (t->w + 1) & ~1;
+    nt->data = fb_alloc(nt->stride * t->h * sizeof(int16_t), FB_ALLOC_NO_HINT);
+
+    int sum = 0;
+    uint32_t sumsq = 0;
+
+    for (int y = 0; y < t->h; y++) {
+        uint8_t *t_row = t->data + (y * t->w);
+        int16_t *nt_row = nt->data + (y * nt->stride);
+        for (int x = 0; x < t->w; x++) {
+            int c = t_row[x] - t_mean;
+            int i = x;
+            #if defined(ARM_MATH_DSP)
+            // Groups of 4 are stored as (0, 2, 1, 3) to line up with the even and odd bytes
+            // of an image word.
+            if (x < (t->w & ~3)) {
+                i = (x & ~3) + ((x & 1) << 1) + ((x & 2) >> 1);
+            }
+            #endif
+            nt_row[i] = c;
+            sum += c;
+            sumsq += c * c;
+        }
+    }
+
+    nt->sum = sum;
+    nt->den = fast_sqrtf(sumsq - ((sum * (float) sum) / nt->n));
+}
+
+// Returns the sum of the image times the template data over the block at (u, v).
+static int ncc_template_dot(image_t *f, ncc_template_t *nt, int u, int v) {
+    int num = 0;
+
+    for (int y = 0; y < nt->h; y++) {
+        uint8_t *f_row = f->data + ((v + y) * f->w) + u;
+        int16_t *nt_row = nt->data + (y * nt->stride);
+        int x = 0;
+
+        #if defined(ARM_MATH_DSP)
+        for (; (x + 4) <= nt->w; x += 4) {
+            uint32_t f4 = *((uint32_t *) (f_row + x));
+            num = __SMLAD(__UXTB16(f4), *((uint32_t *) (nt_row + x)), num);
+            num = __SMLAD(__UXTB16_RORn(f4, 8), *((uint32_t *) (nt_row + x + 2)), num);
+        }
+        #endif
+
+        for (; x < nt->w; x++) {
+            num += f_row[x] * nt_row[x];
+        }
+    }
+
+    return num;
+}
+
+static float ncc_template_score(image_t *f, i_image_t *sum, i_image_t *sumsq, ncc_template_t *nt, int u, int v) {
+    uint32_t f_sum = imlib_integral_lookup(sum, u, v, nt->w, nt->h);
+    uint64_t f_sumsq = imlib_integral_lookup(sumsq, u, v, nt->w, nt->h);
+
+    // Patch variance times n, exact in integers.
+    int64_t den_a = (((int64_t) f_sumsq) * nt->n) - (((int64_t) f_sum) * f_sum);
+    float num = ncc_template_dot(f, nt, u, v) - ((f_sum * (float) nt->sum) / nt->n);
+
+    // Find normalized cross-correlation
+    return num / (fast_sqrtf(den_a / (float) nt->n) * nt->den);
+}
+
 /* The NCC can be optimized using integral images and rectangular basis functions.
  * See Kai Briechle's paper "Template Matching using Fast Normalized Cross Correlation".
  *
- * NOTE: only the denominator is optimized.
+ * The denominator comes from the integral images of f and f^2. The numerator still needs one
+ * multiply-accumulate per template pixel, but against a zero mean template so the patch mean
+ * only enters as a single correction term.
+ *
+ * When step > 1 the step grid is searched first and then every position around the best grid
+ * point that the grid skipped.
  *
+ * The integral images are stripes of the template height plus one rows, advanced per search row.
  */
 float imlib_template_match_ex(image_t *f, image_t *t, rectangle_t *roi, int step, rectangle_t *r) {
-    int den_b = 0;
     float corr = 0.0f;
+    int u_end = roi->x + roi->w - t->w;
+    int v_end = roi->y + roi->h - t->h;
 
     // Integral images
     i_image_t sum;
     i_image_t sumsq;
 
-    imlib_integral_image_alloc(&sum, f->w, f->h);
-    imlib_integral_image_alloc(&sumsq, f->w, f->h);
-
-    imlib_integral_image(f, &sum);
-    imlib_integral_image_sq(f, &sumsq);
-
-    // Normalized sum of squares of the template
-    int t_mean = 0;
-    imlib_image_mean(t, &t_mean, &t_mean, &t_mean);
+    imlib_integral_image_alloc(&sum, f->w, t->h + 1);
+    imlib_integral_image_alloc_sq(&sumsq, f->w, t->h + 1, t->w * t->h);
 
-    for (int i = 0; i < (t->w * t->h); i++) {
-        int c = (int) t->data[i] - t_mean;
-        den_b += c * c;
-    }
+    ncc_template_t nt;
+    ncc_template_init(&nt, t);
 
-    for (int v = roi->y; v <= (roi->y + roi->h - t->h); v += step) {
-        for (int u = roi->x; u <= (roi->x + roi->w - t->w); u += step) {
-            int num = 0;
-            // The mean of the current patch
-            uint32_t f_sum = imlib_integral_lookup(&sum, u, v, t->w, t->h);
-            uint32_t f_sumsq = imlib_integral_lookup(&sumsq, u, v, t->w, t->h);
-            uint32_t f_mean = f_sum / (float) (t->w * t->h);
-
-            // Normalized sum of squares of the image
-            for (int y = v; y < (v + t->h); y++) {
-                for (int x = u; x < (u + t->w); x++) {
-                    int a = (int) f->data[y * f->w + x] - f_mean;
-                    int b = (int) t->data[(y - v) * t->w + (x - u)] - t_mean;
-                    num += a * b;
-                }
-            }
-
-            uint32_t den_a = f_sumsq - f_sum * (f_sum / (float) (t->w * t->h));
-
-            // Find normalized cross-correlation
-            float c = num / (fast_sqrtf(den_a) * fast_sqrtf(den_b));
+    r->x = roi->x;
+    r->y = roi->y;
+    r->w = t->w;
+    r->h = t->h;
 
+    for (int v = roi->y; v <= v_end; v += step) {
+        imlib_integral_image_rows(f, &sum, &sumsq, v, t->h);
+        for (int u = roi->x; u <= u_end; u += step) {
+            float c = ncc_template_score(f, &sum, &sumsq, &nt, u, v);
             if (c > corr) {
                 corr = c;
                 r->x = u;
                 r->y = v;
-                r->w = t->w;
-                r->h = t->h;
             }
         }
     }
 
-    imlib_integral_image_free(&sum);
+    if ((step > 1) && (corr > 0.0f)) {
+        int u_c = r->x, v_c = r->y;
+        for (int v = IM_MAX(v_c - step + 1, roi->y), vv = IM_MIN(v_c + step - 1, v_end); v <= vv; v++) {
+            imlib_integral_image_rows(f, &sum, &sumsq, v, t->h);
+            for (int u = IM_MAX(u_c - step + 1, roi->x), uu = IM_MIN(u_c + step - 1, u_end); u <= uu; u++) {
+                float c = ncc_template_score(f, &sum, &sumsq, &nt, u, v);
+                if (c > corr) {
+                    corr = c;
+                    r->x = u;
+                    r->y = v;
+                }
+            }
+        }
+    }
+
+    fb_free(); // nt.data
     imlib_integral_image_free(&sumsq);
+    imlib_integral_image_free(&sum);
     return corr;
 }
@@ -0,0 +1,104 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Temporal noise reduction with a motion adaptive IIR filter.
+ */
+#include "imlib.h"
+#include "xalloc.h"
+
+void imlib_temporal_filter_init(temporal_filter_t *tf, image_t *img, int strength, int threshold) {
+    tf->w = img->w;
+    tf->h = img->h;
+    tf->pixfmt = img->pixfmt;
+    tf->ref.w = img->w;
+    tf->ref.h = img->h;
+    tf->ref.pixfmt = img->pixfmt;
+    tf->ref.data = xalloc(image_size(&tf->ref));
+
+    // Static pixels move 1 / 2^strength of the way to the new frame, the weight ramps up
+    // with the squared difference so noise stays filtered and differences at or above
+    // threshold are motion which passes through.
+    int base = 256 >> IM_CLAMP(strength, 0, 8);
+    threshold = IM_CLAMP(threshold, 1, 255);
+
+    for (int i = 0; i < 256; i++) {
+        tf->weight[i] = (i >= threshold) ? 256 : (base + (((256 - base) * i * i) / (threshold * threshold)));
+    }
+
+    // Grayscale pixels look up the whole blend step.
+    for (int d = -255; d <= 255; d++) {
+        tf->delta[d + 255] = ((d * tf->weight[abs(d)]) + 128) >> 8;
+    }
+
+    // The first frame is the reference.
+    imlib_temporal_filter_reset(tf, img);
+}
+
+void imlib_temporal_filter_reset(temporal_filter_t *tf, image_t *img) {
+    memcpy(tf->ref.data, img->data, image_size(&tf->ref));
+}
+
+void imlib_temporal_filter_free(temporal_filter_t *tf) {
+    xfree(tf->ref.data);
+    tf->ref.data = NULL;
+}
+
+void imlib_temporal_filter_update(temporal_filter_t *tf, image_t *img) {
+    switch (img->pixfmt) {
+        case PIXFORMAT_GRAYSCALE: {
+            const int16_t *delta = tf->delta + 255;
+
+            for (int y = 0; y < tf->h; y++) {
+                uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+                uint8_t *ref_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&tf->ref, y);
+
+                for (int x = 0; x < tf->w; x++) {
+                    int ref = ref_row_ptr[x];
+                    int pixel = ref + delta[row_ptr[x] - ref];
+                    ref_row_ptr[x] = pixel;
+                    row_ptr[x] = pixel;
+                }
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            for (int y = 0; y < tf->h; y++) {
+                uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+                uint16_t *ref_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(&tf->ref, y);
+
+                for (int x = 0; x < tf->w; x++) {
+                    int p = row_ptr[x], q = ref_row_ptr[x];
+
+                    if (p == q) {
+                        continue;
+                    }
+
+                    int r = COLOR_RGB565_TO_R5(q), dr = COLOR_RGB565_TO_R5(p) - r;
+                    int g = COLOR_RGB565_TO_G6(q), dg = COLOR_RGB565_TO_G6(p) - g;
+                    int b = COLOR_RGB565_TO_B5(q), db = COLOR_RGB565_TO_B5(p) - b;
+
+                    // One weight for all channels keeps the filter from shifting colors.
+                    int motion = IM_MAX(IM_MAX(abs(dr) << 3, abs(dg) << 2), abs(db) << 3);
+                    int weight = tf->weight[motion];
+
+                    r += ((dr * weight) + 128) >> 8;
+                    g += ((dg * weight) + 128) >> 8;
+                    b += ((db * weight) + 128) >> 8;
+
+                    int pixel = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
+                    ref_row_ptr[x] = pixel;
+                    row_ptr[x] = pixel;
+                }
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
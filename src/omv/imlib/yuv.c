@@ -9,6 +9,7 @@
  * Deyuv Functions
  */
 #include "imlib.h"
+#include "unaligned_memcpy.h"
 
 pixformat_t imlib_yuv_shift(pixformat_t pixfmt, int x) {
     if (x % 2) {
@@ -18,6 +19,121 @@ pixformat_t imlib_yuv_shift(pixformat_t pixfmt, int x) {
     return pixfmt;
 }
 
+#if defined(ARM_MATH_DSP)
+// Converts a Y0 U Y1 V (or Y0 V Y1 U) word to two RGB565 pixels. The chroma matrix runs on
+// both chroma bytes at once with SMUAD and the two pixels are saturated and packed in parallel.
+static inline uint32_t deyuv_pair_rgb565(uint32_t row_yuv, uint32_t k_r, uint32_t k_g, uint32_t k_b) {
+    uint32_t y = __UXTB16(row_yuv);
+    uint32_t uv = __SXTB16(__ROR(row_yuv ^ 0x80008000, 8));
+
+    int ry = ((int32_t) __SMUAD(uv, k_r)) >> 7;
+    int gy = ((int32_t) __SMUAD(uv, k_g)) >> 7;
+    int by = ((int32_t) __SMUAD(uv, k_b)) >> 7;
+
+    uint32_t r = __USAT16(__QADD16(y, __PKHBT(ry, ry, 16)), 8);
+    uint32_t g = __USAT16(__QSUB16(y, __PKHBT(gy, gy, 16)), 8);
+    uint32_t b = __USAT16(__QADD16(y, __PKHBT(by, by, 16)), 8);
+
+    return ((r << 8) & 0xF800F800) | ((g << 3) & 0x07E007E0) | ((b >> 3) & 0x001F001F);
+}
+#endif
+
+#if defined(IMLIB_ENABLE_HELIUM)
+// Converts 8 Y values sharing the given chroma terms to RGB565.
+static inline uint16x8_t deyuv_mve_rgb565(int16x8_t y, int16x8_t ry, int16x8_t gy, int16x8_t by) {
+    int16x8_t lo = vdupq_n_s16(0), hi = vdupq_n_s16(255);
+    uint16x8_t r = vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(vaddq_s16(y, ry), lo), hi));
+    uint16x8_t g = vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(vsubq_s16(y, gy), lo), hi));
+    uint16x8_t b = vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(vaddq_s16(y, by), lo), hi));
+    return MVE_R5_G6_B5_TO_RGB565(vshrq_n_u16(r, 3), vshrq_n_u16(g, 2), vshrq_n_u16(b, 3));
+}
+#endif
+
+// Converts the pixel pairs of [x_start, x_end) that are fully inside the row and returns where
+// it stopped. The format is dispatched once per row instead of once per pixel pair.
+static int deyuv_line_fast(int x_start, int x_end, int w_limit, uint16_t *rowptr_yuv,
+                           void *dst_row_ptr, pixformat_t pixfmt, int shift) {
+    int x = x_start;
+    int x_limit = IM_MIN(x_end, w_limit);
+
+    switch (pixfmt) {
+        case PIXFORMAT_GRAYSCALE: {
+            int n = ((x_limit - x_start) + 1) & ~1;
+
+            if (n > 0) {
+                unaligned_2_to_1_memcpy(((uint8_t *) dst_row_ptr) + x_start, rowptr_yuv + x_start, n);
+                x += n;
+            }
+
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *row_ptr_16 = (uint16_t *) dst_row_ptr;
+            #if defined(IMLIB_ENABLE_HELIUM)
+            // 16 pixels at a time, the Y and chroma bytes are split apart by the load and the
+            // even pixels (and first chroma bytes) are in the bottom byte lanes.
+            for (; (x_limit - x) >= 16; x += 16) {
+                uint8x16x2_t yc = vld2q_u8((uint8_t *) (rowptr_yuv + x));
+                int16x8_t c0 = vsubq_n_s16(vreinterpretq_s16_u16(vmovlbq_u8(yc.val[1])), 128);
+                int16x8_t c1 = vsubq_n_s16(vreinterpretq_s16_u16(vmovltq_u8(yc.val[1])), 128);
+                int16x8_t u = c1, v = c0;
+
+                if (shift) {
+                    u = c0;
+                    v = c1;
+                }
+
+                int16x8_t ry = vshrq_n_s16(vmulq_n_s16(u, 179), 7);
+                int16x8_t gy = vshrq_n_s16(vaddq_s16(vmulq_n_s16(v, 44), vmulq_n_s16(u, 91)), 7);
+                int16x8_t by = vshrq_n_s16(vmulq_n_s16(v, 227), 7);
+
+                uint16x8x2_t rgb565;
+                rgb565.val[0] = deyuv_mve_rgb565(vreinterpretq_s16_u16(vmovlbq_u8(yc.val[0])), ry, gy, by);
+                rgb565.val[1] = deyuv_mve_rgb565(vreinterpretq_s16_u16(vmovltq_u8(yc.val[0])), ry, gy, by);
+                vst2q_u16(row_ptr_16 + x, rgb565);
+            }
+            #endif
+
+            #if defined(ARM_MATH_DSP)
+            // R = Y + ((179 * U) >> 7), G = Y - (((44 * V) + (91 * U)) >> 7), B = Y + ((227 * V) >> 7)
+            // with U in the low half-word of the chroma word for YUV422 and in the high one for YVU422.
+            uint32_t k_r = shift ? 179 : (179 << 16);
+            uint32_t k_g = shift ? ((44 << 16) | 91) : ((91 << 16) | 44);
+            uint32_t k_b = shift ? (227 << 16) : 227;
+
+            for (; x < x_limit; x += 2) {
+                uint32_t rgb565 = deyuv_pair_rgb565(*((uint32_t *) (rowptr_yuv + x)), k_r, k_g, k_b);
+                row_ptr_16[x] = rgb565;
+                row_ptr_16[x + 1] = rgb565 >> 16;
+            }
+            #else
+            for (; x < x_limit; x += 2) {
+                int32_t row_yuv = *((uint32_t *) (rowptr_yuv + x)); // signed
+                int y0 = row_yuv & 0xff, y1 = (row_yuv >> 16) & 0xff;
+
+                row_yuv ^= 0x80008000;
+
+                int u = (row_yuv << shift) >> 24; // signed bit extraction
+                int v = (row_yuv << (16 - shift)) >> 24; // signed bit extraction
+
+                int ry = (179 * u) >> 7;
+                int gy = ((44 * v) + (91 * u)) >> 7;
+                int by = (227 * v) >> 7;
+
+                row_ptr_16[x] = COLOR_R8_G8_B8_TO_RGB565(__USAT(y0 + ry, 8), __USAT(y0 - gy, 8), __USAT(y0 + by, 8));
+                row_ptr_16[x + 1] = COLOR_R8_G8_B8_TO_RGB565(__USAT(y1 + ry, 8), __USAT(y1 - gy, 8), __USAT(y1 + by, 8));
+            }
+            #endif
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+
+    return x;
+}
+
 void imlib_deyuv_line(int x_start, int x_end, int y_row, void *dst_row_ptr, pixformat_t pixfmt, image_t *src) {
     int shift = (src->pixfmt == PIXFORMAT_YUV422) ? 16 : 0;
     int src_w = src->w, w_limit = src_w - 1;
@@ -25,7 +141,8 @@ void imlib_deyuv_line(int x_start, int x_end, int y_row, void *dst_row_ptr, pixf
     uint16_t *rowptr_yuv = ((uint16_t *) src->data) + (y_row * src_w);
 
     // If the image is an odd width this will go for the last loop and we drop the last column.
-    for (int x = x_start; x < x_end; x += 2) {
+    for (int x = deyuv_line_fast(x_start, x_end, w_limit, rowptr_yuv, dst_row_ptr, pixfmt, shift);
+         x < x_end; x += 2) {
         int32_t row_yuv; // signed
 
         // keep pixels in bounds
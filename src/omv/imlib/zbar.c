@@ -8711,7 +8711,16 @@ void zbar_scanner_get_state (const zbar_scanner_t *scn,
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void imlib_find_barcodes(list_t *out, image_t *ptr, rectangle_t *roi)
+// Indexed by barcodes_t.
+static const zbar_symbol_type_t imlib_barcode_zbar_types[] = {
+    ZBAR_EAN2, ZBAR_EAN5, ZBAR_EAN8, ZBAR_UPCE, ZBAR_ISBN10, ZBAR_UPCA, ZBAR_EAN13, ZBAR_ISBN13,
+    ZBAR_I25, ZBAR_DATABAR, ZBAR_DATABAR_EXP, ZBAR_CODABAR, ZBAR_CODE39, ZBAR_PDF417, ZBAR_CODE93, ZBAR_CODE128
+};
+
+// The first pass when a code count is given only scans every Nth row and column.
+#define BARCODES_SPARSE_DENSITY 4
+
+void imlib_find_barcodes(list_t *out, image_t *ptr, rectangle_t *roi, uint32_t types, int count)
 {
     uint8_t *grayscale_image = (ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? ptr->data : fb_alloc(roi->w * roi->h, FB_ALLOC_NO_HINT);
 
@@ -8727,7 +8736,19 @@ void imlib_find_barcodes(list_t *out, image_t *ptr, rectangle_t *roi)
     umm_init_x(fb_avail());
 
     zbar_image_scanner_t *scanner = zbar_image_scanner_create();
-    zbar_image_scanner_set_config(scanner, 0, ZBAR_CFG_ENABLE, 1);
+    zbar_image_scanner_set_config(scanner, 0, ZBAR_CFG_ENABLE, 0);
+
+    // Disabled decoders are skipped per edge, so only run the ones asked for.
+    for (size_t i = 0; i < (sizeof(imlib_barcode_zbar_types) / sizeof(imlib_barcode_zbar_types[0])); i++) {
+        if (types & (1 << i)) {
+            zbar_image_scanner_set_config(scanner, imlib_barcode_zbar_types[i], ZBAR_CFG_ENABLE, 1);
+        }
+    }
+
+    // UPC-A and ISBN are reported as subsets of EAN-13 decoding.
+    if (types & ((1 << BARCODE_UPCA) | (1 << BARCODE_ISBN10) | (1 << BARCODE_ISBN13))) {
+        zbar_image_scanner_set_config(scanner, ZBAR_EAN13, ZBAR_CFG_ENABLE, 1);
+    }
 
     zbar_image_t image;
     image.format = *((int *) "Y800");
@@ -8745,7 +8766,23 @@ void imlib_find_barcodes(list_t *out, image_t *ptr, rectangle_t *roi)
 
     list_init(out, sizeof(find_barcodes_list_lnk_data_t));
 
-    if (zbar_scan_image(scanner, &image) > 0) {
+    // Try a sparse scan first and only rescan at full density if it found fewer codes than expected.
+    int density = (count > 0) ? BARCODES_SPARSE_DENSITY : 1;
+    int n;
+
+    for (;;) {
+        zbar_image_scanner_set_config(scanner, 0, ZBAR_CFG_X_DENSITY, density);
+        zbar_image_scanner_set_config(scanner, 0, ZBAR_CFG_Y_DENSITY, density);
+        n = zbar_scan_image(scanner, &image);
+
+        if ((density == 1) || (n >= count)) {
+            break;
+        }
+
+        density = 1;
+    }
+
+    if (n > 0) {
         for (const zbar_symbol_t *symbol = (image.syms) ? image.syms->head : NULL; symbol; symbol = zbar_symbol_next(symbol)) {
             if (zbar_symbol_get_loc_size(symbol) > 0) {
                 find_barcodes_list_lnk_data_t lnk_data;
@@ -8798,6 +8835,10 @@ void imlib_find_barcodes(list_t *out, image_t *ptr, rectangle_t *roi)
                     default: continue;
                 }
 
+                if (!(types & (1 << lnk_data.type))) {
+                    continue;
+                }
+
                 switch (zbar_symbol_get_orientation(symbol)) {
                     case ZBAR_ORIENT_UP: lnk_data.rotation = 0; break;
                     case ZBAR_ORIENT_RIGHT: lnk_data.rotation = 270; break;
@@ -8857,7 +8898,7 @@ void imlib_find_barcodes(list_t *out, image_t *ptr, rectangle_t *roi)
     }
 
     zbar_image_scanner_destroy(scanner);
-    fb_free(); // umm_init_x();
+    umm_deinit();
     if (ptr->pixfmt != PIXFORMAT_GRAYSCALE) {
         fb_free(); // grayscale_image;
     }
@@ -20,6 +20,7 @@
 #include "py_helper.h"
 #include "py_image.h"
 #include "py_display.h"
+#include "trace.h"
 
 STATIC mp_obj_t py_display_width(mp_obj_t self_in) {
     py_display_obj_t *self = MP_OBJ_TO_PTR(self_in);
@@ -169,8 +170,11 @@ STATIC mp_obj_t py_display_write(uint n_args, const mp_obj_t *pos_args, mp_map_t
     const uint8_t *alpha_palette = py_helper_arg_to_palette(args[ARG_alpha_palette].u_obj, PIXFORMAT_GRAYSCALE);
 
     py_display_p_t *display_p = (py_display_p_t *) MP_OBJ_TYPE_GET_SLOT(self->base.type, protocol);
-    display_p->write(self, image, args[ARG_x].u_int, args[ARG_y].u_int, x_scale, y_scale, &roi,
-                     args[ARG_channel].u_int, args[ARG_alpha].u_int, color_palette, alpha_palette, args[ARG_hint].u_int);
+    {
+        TRACE_PROF_SCOPE(TRACE_PROF_DISPLAY_WRITE);
+        display_p->write(self, image, args[ARG_x].u_int, args[ARG_y].u_int, x_scale, y_scale, &roi,
+                         args[ARG_channel].u_int, args[ARG_alpha].u_int, color_palette, alpha_palette, args[ARG_hint].u_int);
+    }
     fb_alloc_free_till_mark();
 
     return mp_const_none;
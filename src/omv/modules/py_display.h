@@ -55,10 +55,20 @@ typedef struct _py_display_obj_t {
     mp_obj_t bl_controller;
     #if defined(OMV_SPI_DISPLAY_CONTROLLER)
     omv_spi_t spi_bus;
+    omv_spi_chain_t spi_chain;
+    omv_spi_segment_t spi_segment;
     bool spi_tx_running;
     uint32_t spi_baudrate;
+    bool spi_partial;                   // Send only the window that changed since the last frame.
+    bool spi_partial_valid;             // The display shows the head frame buffer.
+    volatile bool spi_partial_busy;     // A window is being sent.
+    rectangle_t spi_partial_rect;
+    #if defined(OMV_SPI_DISPLAY_TE_PIN)
+    volatile bool spi_te_wait;          // A frame was sent, the next one starts on the TE edge.
+    #endif
     #endif
     bool triple_buffer;
+    bool direct;                        // Scan out RGB565 images in place instead of copying them.
     uint32_t framebuffer_tail;
     volatile uint32_t framebuffer_head;
     uint16_t *framebuffers[FRAMEBUFFER_COUNT];
@@ -8,7 +8,10 @@
  *
  * FIR Python module.
  */
+#include <math.h>
+#include <string.h>
 #include "py/runtime.h"
+#include "py/mphal.h"
 #include "py/objlist.h"
 #include "omv_boardconfig.h"
 
@@ -149,24 +152,128 @@ static void fir_MLX90621_get_frame(float *Ta, float *To) {
 #endif
 
 #if (OMV_FIR_MLX90640_ENABLE == 1)
+#define MLX90640_PIXELS                 (MLX90640_WIDTH * MLX90640_HEIGHT)
+
+// The per-pixel calibration scales are folded into floats once at init so that compensating a
+// sub-page is single-precision with no divisions or pow() per pixel. The temperatures of both
+// sub-pages are kept so each frame only waits for and compensates the newest sub-page.
+typedef struct fir_mlx90640_data {
+    paramsMLX90640 params;
+    float kta[MLX90640_PIXELS];
+    float kv[MLX90640_PIXELS];
+    float alpha[MLX90640_PIXELS];
+    float to[MLX90640_PIXELS];
+    float ta;
+    uint32_t subpages;
+    uint32_t ticks;
+} fir_mlx90640_data_t;
+
+static void fir_MLX90640_fold_parameters(fir_mlx90640_data_t *mlx) {
+    const paramsMLX90640 *params = &mlx->params;
+    float kta_scale = 1.0f / (1 << params->ktaScale);
+    float kv_scale = 1.0f / (1 << params->kvScale);
+    float alpha_scale = SCALEALPHA * (1ULL << params->alphaScale);
+
+    for (int i = 0; i < MLX90640_PIXELS; i++) {
+        mlx->kta[i] = params->kta[i] * kta_scale;
+        mlx->kv[i] = params->kv[i] * kv_scale;
+        mlx->alpha[i] = alpha_scale / params->alpha[i];
+    }
+
+    mlx->subpages = 0;
+}
+
+// Same as MLX90640_CalculateTo() for the frame's sub-page, with the per-frame terms hoisted.
+static void fir_MLX90640_calculate_to(uint16_t *frame, fir_mlx90640_data_t *mlx, float ta, float emissivity, float tr) {
+    const paramsMLX90640 *params = &mlx->params;
+    int subpage = frame[833];
+    float vdd = MLX90640_GetVdd(frame, params);
+    float dta = ta - 25.0f;
+    float dvdd = vdd - 3.3f;
+
+    float ta4 = ta + 273.15f;
+    ta4 = ta4 * ta4;
+    ta4 = ta4 * ta4;
+    float tr4 = tr + 273.15f;
+    tr4 = tr4 * tr4;
+    tr4 = tr4 * tr4;
+    float ta_tr = tr4 - (tr4 - ta4) / emissivity;
+
+    float alpha_corr[4];
+    alpha_corr[0] = 1.0f / (1.0f + params->ksTo[0] * 40.0f);
+    alpha_corr[1] = 1.0f;
+    alpha_corr[2] = (1.0f + params->ksTo[1] * params->ct[2]);
+    alpha_corr[3] = alpha_corr[2] * (1.0f + params->ksTo[2] * (params->ct[3] - params->ct[2]));
+
+    float gain = params->gainEE / (float) ((int16_t) frame[778]);
+    uint8_t mode = (frame[832] & 0x1000) >> 5;
+    bool chess_corr = (mode != params->calibrationModeEE);
+
+    float cp_comp = (1.0f + params->cpKta * dta) * (1.0f + params->cpKv * dvdd);
+    float cp = ((int16_t) frame[subpage ? 808 : 776]) * gain;
+    cp -= (params->cpOffset[subpage] + ((subpage && chess_corr) ? params->ilChessC[0] : 0.0f)) * cp_comp;
+    cp *= params->tgc;
+
+    float inv_emissivity = 1.0f / emissivity;
+    float ks_ta = 1.0f + params->KsTa * dta;
+    float ks_to_273 = 1.0f - params->ksTo[1] * 273.15f;
+
+    for (int i = 0; i < MLX90640_PIXELS; i++) {
+        int il_pattern = (i >> 5) & 1;
+        int pattern = mode ? (il_pattern ^ (i & 1)) : il_pattern;
+
+        if (pattern != subpage) {
+            continue;
+        }
+
+        float ir = ((int16_t) frame[i]) * gain;
+        ir -= params->offset[i] * (1.0f + mlx->kta[i] * dta) * (1.0f + mlx->kv[i] * dvdd);
+
+        if (chess_corr) {
+            int conversion_pattern = ((i + 2) / 4 - (i + 3) / 4 + (i + 1) / 4 - i / 4) * (1 - 2 * il_pattern);
+            ir += params->ilChessC[2] * (2 * il_pattern - 1) - params->ilChessC[1] * conversion_pattern;
+        }
+
+        ir = (ir - cp) * inv_emissivity;
+
+        float alpha = mlx->alpha[i] * ks_ta;
+        float sx = alpha * alpha * alpha * (ir + alpha * ta_tr);
+        sx = sqrtf(sqrtf(sx)) * params->ksTo[1];
+        float to = sqrtf(sqrtf(ir / (alpha * ks_to_273 + sx) + ta_tr)) - 273.15f;
+
+        int range = (to < params->ct[1]) ? 0 : (to < params->ct[2]) ? 1 : (to < params->ct[3]) ? 2 : 3;
+        mlx->to[i] = sqrtf(sqrtf(ir / (alpha * alpha_corr[range] *
+                                      (1.0f + params->ksTo[range] * (to - params->ct[range]))) + ta_tr)) - 273.15f;
+    }
+
+    mlx->ta = ta;
+}
+
 static void fir_MLX90640_get_frame(float *Ta, float *To) {
+    fir_mlx90640_data_t *mlx = MP_STATE_PORT(fir_mlx_data);
     uint16_t *data = fb_alloc(MLX90640_FRAME_DATA_SIZE * sizeof(uint16_t), FB_ALLOC_NO_HINT);
 
-    // Wait for a new data to be available before calling GetFrameData.
-    MLX90640_SynchFrame(MLX90640_ADDR);
-
-    // Calculate 1st sub-frame...
-    PY_ASSERT_TRUE_MSG(MLX90640_GetFrameData(MLX90640_ADDR, data) >= 0,
-                       "Failed to read the MLX90640 sensor data!");
-    *Ta = MLX90640_GetTa(data, MP_STATE_PORT(fir_mlx_data));
-    MLX90640_CalculateTo(data, MP_STATE_PORT(fir_mlx_data), 0.95f, *Ta - 8, To);
+    // Sub-page period, the refresh rate is 2^(n-1) Hz.
+    uint32_t period_ms = fir_ir_fresh_rate ? (1000 >> (fir_ir_fresh_rate - 1)) : 2000;
 
-    // Calculate 2nd sub-frame...
-    PY_ASSERT_TRUE_MSG(MLX90640_GetFrameData(MLX90640_ADDR, data) >= 0,
-                       "Failed to read the MLX90640 sensor data!");
-    *Ta = MLX90640_GetTa(data, MP_STATE_PORT(fir_mlx_data));
-    MLX90640_CalculateTo(data, MP_STATE_PORT(fir_mlx_data), 0.95f, *Ta - 8, To);
+    // Read both sub-pages if the other one is older than a frame, otherwise only the next one.
+    if ((mlx->subpages != 0x3) || ((mp_hal_ticks_ms() - mlx->ticks) > (period_ms * 2))) {
+        // Wait for a new data to be available before calling GetFrameData.
+        MLX90640_SynchFrame(MLX90640_ADDR);
+        mlx->subpages = 0;
+    }
 
+    do {
+        int subpage = MLX90640_GetFrameData(MLX90640_ADDR, data);
+        PY_ASSERT_TRUE_MSG(subpage >= 0, "Failed to read the MLX90640 sensor data!");
+        float ta = MLX90640_GetTa(data, &mlx->params);
+        fir_MLX90640_calculate_to(data, mlx, ta, 0.95f, ta - 8);
+        mlx->subpages |= 1 << subpage;
+    } while (mlx->subpages != 0x3);
+
+    mlx->ticks = mp_hal_ticks_ms();
+    memcpy(To, mlx->to, MLX90640_PIXELS * sizeof(float));
+    *Ta = mlx->ta;
     fb_free();
 }
 #endif
@@ -448,7 +555,7 @@ mp_obj_t py_fir_init(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
             ir_fresh_rate = __CLZ(__RBIT((ir_fresh_rate > 64) ? 64 : ((ir_fresh_rate < 1) ? 1 : ir_fresh_rate))) + 1;
             adc_resolution = ((adc_resolution > 19) ? 19 : ((adc_resolution < 16) ? 16 : adc_resolution)) - 16;
 
-            MP_STATE_PORT(fir_mlx_data) = xalloc(sizeof(paramsMLX90640));
+            MP_STATE_PORT(fir_mlx_data) = xalloc(sizeof(fir_mlx90640_data_t));
 
             fir_sensor = FIR_MLX90640;
             FIR_MLX90640_RETRY:
@@ -461,6 +568,7 @@ mp_obj_t py_fir_init(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
             error |= MLX90640_SetRefreshRate(MLX90640_ADDR, ir_fresh_rate);
             error |= MLX90640_SetResolution(MLX90640_ADDR, adc_resolution);
             error |= MLX90640_ExtractParameters(eeprom, MP_STATE_PORT(fir_mlx_data));
+            fir_MLX90640_fold_parameters(MP_STATE_PORT(fir_mlx_data));
             fb_alloc_free_till_mark();
 
             if (error != 0) {
@@ -30,6 +30,8 @@ typedef struct py_gif_obj {
     uint32_t height;
     bool color;
     bool loop;
+    bool adaptive;
+    uint8_t *prev; // Last drawn pixels for transparency (or NULL).
     FIL fp;
 } py_gif_obj_t;
 
@@ -88,7 +90,7 @@ static mp_obj_t py_gif_add_frame(uint n_args, const mp_obj_t *pos_args, mp_map_t
         mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Image format is not supported"));
     }
 
-    gif_add_frame(&self->fp, image, args[ARG_delay].u_int);
+    gif_add_frame(&self->fp, image, args[ARG_delay].u_int, self->prev, self->adaptive);
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_gif_add_frame_obj, 2, py_gif_add_frame);
@@ -101,12 +103,14 @@ STATIC mp_obj_t py_gif_close(mp_obj_t self_in) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_gif_close_obj, py_gif_close);
 
 static mp_obj_t py_gif_open(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
-    enum { ARG_width, ARG_height, ARG_color, ARG_loop };
+    enum { ARG_width, ARG_height, ARG_color, ARG_loop, ARG_transparency, ARG_adaptive };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_width, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = -1 } },
         { MP_QSTR_height, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = -1 } },
         { MP_QSTR_color, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = -1 } },
         { MP_QSTR_loop, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_bool = true } },
+        { MP_QSTR_transparency, MP_ARG_BOOL | MP_ARG_KW_ONLY,  {.u_bool = false } },
+        { MP_QSTR_adaptive, MP_ARG_BOOL | MP_ARG_KW_ONLY,  {.u_bool = false } },
     };
 
     // Parse args.
@@ -120,9 +124,17 @@ static mp_obj_t py_gif_open(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_
     gif->height = (args[ARG_height].u_int == -1) ? framebuffer_get_height() : args[ARG_height].u_int;
     gif->color = (args[ARG_color].u_int == -1) ? (framebuffer_get_depth() >= 2) : args[ARG_color].u_bool;
     gif->loop = args[ARG_loop].u_bool;
+    gif->adaptive = args[ARG_adaptive].u_bool;
+    gif->prev = NULL;
+
+    if (args[ARG_transparency].u_bool) {
+        // Pixels are encoded as transparent when unchanged since they were last drawn.
+        gif->prev = m_new(uint8_t, gif->width * gif->height);
+        memset(gif->prev, 0xFF, gif->width * gif->height);
+    }
 
     file_open(&gif->fp, path, false, FA_WRITE | FA_CREATE_ALWAYS);
-    gif_open(&gif->fp, gif->width, gif->height, gif->color, gif->loop);
+    gif_open(&gif->fp, gif->width, gif->height, gif->color, gif->loop, gif->prev != NULL);
     return gif;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_gif_open_obj, 1, py_gif_open);
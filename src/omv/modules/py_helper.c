@@ -18,6 +18,7 @@
 #endif
 
 extern void *py_image_cobj(mp_obj_t img_obj);
+extern void py_image_written(mp_obj_t img_obj);
 
 mp_obj_t py_func_unavailable(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     PY_ASSERT_TRUE_MSG(false, "This function is unavailable on your OpenMV Cam.");
@@ -42,6 +43,9 @@ image_t *py_helper_arg_to_image(const mp_obj_t arg, uint32_t flags) {
         #endif // IMLIB_ENABLE_IMAGE_FILE_IO
     } else {
         image = py_image_cobj(arg);
+        if (flags & ARG_IMAGE_WRITE) {
+            py_image_written(arg);
+        }
     }
     if (flags) {
         if ((flags & ARG_IMAGE_MUTABLE) && !image->is_mutable) {
@@ -156,6 +160,53 @@ void py_helper_arg_to_float_array(const mp_obj_t arg, float *array, size_t size)
     }
 }
 
+// Parses a 3x3 or 3x4 color correction matrix into ccm[12], returns true if it has offsets.
+bool py_helper_arg_to_ccm(const mp_obj_t arg, float *ccm) {
+    bool offset = false;
+
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_get_array(arg, &len, &items);
+
+    // Form [[rr, rg, rb], [gr, gg, gb], [br, bg, bb]]
+    // Form [[rr, rg, rb], [gr, gg, gb], [br, bg, bb], [xx, xx, xx]]
+    // Form [[rr, rg, rb, ro], [gr, gg, gb, go], [br, bg, bb, bo]]
+    // Form [[rr, rg, rb, ro], [gr, gg, gb, go], [br, bg, bb, bo], [xx, xx, xx, xx]]
+    if ((len == 3) || (len == 4)) {
+        for (size_t i = 0; i < 3; i++) {
+            size_t row_len;
+            mp_obj_t *row_items;
+            mp_obj_get_array(items[i], &row_len, &row_items);
+            offset = offset || (row_len == 4);
+            if ((row_len == 3) || (row_len == 4)) {
+                for (size_t j = 0; j < row_len; j++) {
+                    ccm[(i * 4) + j] = mp_obj_get_float(row_items[j]);
+                }
+            } else {
+                mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Unexpected matrix dimensions!"));
+            }
+        }
+        // Form [rr, rg, rb, gr, gg, gb, br, bg, bb]
+    } else if (len == 9) {
+        for (size_t i = 0; i < 3; i++) {
+            for (size_t j = 0; j < 3; j++) {
+                ccm[(i * 4) + j] = mp_obj_get_float(items[(i * 3) + j]);
+            }
+        }
+        // Form [rr, rg, rb, ro, gr, gg, gb, go, br, bg, bb, bo]
+        // Form [rr, rg, rb, ro, gr, gg, gb, go, br, bg, bb, bo, xx, xx, xx, xx]
+    } else if (len == 12 || len == 16) {
+        offset = true;
+        for (size_t i = 0; i < 12; i++) {
+            ccm[i] = mp_obj_get_float(items[i]);
+        }
+    } else {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Unexpected matrix dimensions!"));
+    }
+
+    return offset;
+}
+
 image_t *py_helper_keyword_to_image(uint n_args, const mp_obj_t *args, uint arg_index,
                                     mp_map_t *kw_args, mp_obj_t kw, image_t *default_val) {
     mp_map_elem_t *kw_arg = mp_map_lookup(kw_args, kw, MP_MAP_LOOKUP);
@@ -533,3 +584,14 @@ void py_helper_set_to_framebuffer(image_t *img) {
     framebuffer_init_from_image(img);
     img->data = framebuffer_get_buffer(framebuffer->head)->data;
 }
+
+// Image copies go on the frame arena's stack while one is open, otherwise on the heap.
+void *py_helper_image_alloc(size_t size) {
+    void *data = fb_alloc_arena(size, FB_ALLOC_NO_HINT);
+    return data ? data : xalloc(size);
+}
+
+void *py_helper_image_alloc0(size_t size) {
+    void *data = fb_alloc_arena(size, FB_ALLOC_NO_HINT);
+    return data ? memset(data, 0, size) : xalloc0(size);
+}
@@ -17,7 +17,8 @@ typedef enum py_helper_arg_image_flags {
     ARG_IMAGE_MUTABLE      = (1 << 0),
     ARG_IMAGE_UNCOMPRESSED = (1 << 1),
     ARG_IMAGE_GRAYSCALE    = (1 << 2),
-    ARG_IMAGE_ALLOC        = (1 << 3)
+    ARG_IMAGE_ALLOC        = (1 << 3),
+    ARG_IMAGE_WRITE        = (1 << 4)  // The caller writes the pixels.
 } py_helper_arg_image_flags_t;
 
 extern const mp_obj_fun_builtin_var_t py_func_unavailable_obj;
@@ -30,6 +31,7 @@ void py_helper_arg_to_minmax(const mp_obj_t minmax, float *min, float *max,
                              const mp_obj_t *array, size_t array_size);
 float py_helper_arg_to_float(const mp_obj_t arg, float default_value);
 void py_helper_arg_to_float_array(const mp_obj_t arg, float *array, size_t size);
+bool py_helper_arg_to_ccm(const mp_obj_t arg, float *ccm);
 
 image_t *py_helper_keyword_to_image(uint n_args, const mp_obj_t *args, uint arg_index,
                                     mp_map_t *kw_args, mp_obj_t kw, image_t *default_val);
@@ -67,4 +69,6 @@ const uint8_t *py_helper_keyword_alpha_palette(uint n_args, const mp_obj_t *args
 bool py_helper_is_equal_to_framebuffer(image_t *img);
 void py_helper_update_framebuffer(image_t *img);
 void py_helper_set_to_framebuffer(image_t *img);
+void *py_helper_image_alloc(size_t size);
+void *py_helper_image_alloc0(size_t size);
 #endif // __PY_HELPER__
@@ -27,6 +27,7 @@
 #include "xalloc.h"
 #include "fb_alloc.h"
 #include "framebuffer.h"
+#include "omv_memcpy.h"
 #include "py_assert.h"
 #include "py_helper.h"
 #include "py_image.h"
@@ -49,6 +50,7 @@ static const mp_obj_type_t py_cascade_type;
 typedef struct _py_cascade_obj_t {
     mp_obj_base_t base;
     struct cascade _cobj;
+    mp_obj_t buffer; // Packed cascade the arrays point into, if loaded from a buffer.
 } py_cascade_obj_t;
 
 void *py_cascade_cobj(mp_obj_t cascade) {
@@ -78,6 +80,7 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
 typedef struct _py_kp_obj_t {
     mp_obj_base_t base;
     array_t *kpts;
+    orb_index_t *index; // Built on the first match and reused after.
     int threshold;
     bool normalized;
 } py_kp_obj_t;
@@ -135,6 +138,206 @@ py_kp_obj_t *py_kpts_obj(mp_obj_t kpts_obj) {
 
 #endif // IMLIB_ENABLE_FIND_KEYPOINTS
 
+// Image pyramid object ///////////////////////////////////////////////////////
+
+static uint32_t py_image_write_seq(mp_obj_t img_obj);
+
+typedef struct _py_pyramid_obj_t {
+    mp_obj_base_t base;
+    image_pyramid_t _cobj;
+    int n_levels;           // Requested number of levels.
+    uint32_t frame_seq;     // Frame the pyramid was built from.
+    uint32_t write_seq;     // Write sequence number of the image it was built from.
+} py_pyramid_obj_t;
+
+static void py_pyramid_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    py_pyramid_obj_t *self = self_in;
+    mp_printf(print, "{\"levels\":%d, \"scale_factor\":%f, \"width\":%d, \"height\":%d}",
+              self->_cobj.n_levels, (double) self->_cobj.scale_factor, self->_cobj.src_w, self->_cobj.src_h);
+}
+
+static void py_pyramid_build(py_pyramid_obj_t *self, mp_obj_t img_obj) {
+    image_t *img = py_helper_arg_to_image(img_obj, ARG_IMAGE_UNCOMPRESSED);
+    imlib_pyramid_build(&self->_cobj, img, self->n_levels, self->_cobj.scale_factor);
+    self->frame_seq = framebuffer->frame_seq;
+    self->write_seq = py_image_write_seq(img_obj);
+}
+
+static mp_obj_t py_pyramid_levels(mp_obj_t self_in) {
+    return mp_obj_new_int(((py_pyramid_obj_t *) self_in)->_cobj.n_levels);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_pyramid_levels_obj, py_pyramid_levels);
+
+static mp_obj_t py_pyramid_scale_factor(mp_obj_t self_in) {
+    return mp_obj_new_float(((py_pyramid_obj_t *) self_in)->_cobj.scale_factor);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_pyramid_scale_factor_obj, py_pyramid_scale_factor);
+
+static mp_obj_t py_pyramid_level(mp_obj_t self_in, mp_obj_t level_obj) {
+    py_pyramid_obj_t *self = self_in;
+    image_t *level = imlib_pyramid_get_level(&self->_cobj, mp_obj_get_int(level_obj));
+    if (!level) {
+        mp_raise_msg(&mp_type_IndexError, MP_ERROR_TEXT("Pyramid level out of range"));
+    }
+    // Levels are copied, their buffers are reallocated when the pyramid is rebuilt (and level 0
+    // may be the source image itself).
+    uint8_t *pixels = xalloc(image_size(level));
+    memcpy(pixels, level->data, image_size(level));
+    return py_image(level->w, level->h, PIXFORMAT_GRAYSCALE, 0, pixels);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_pyramid_level_obj, py_pyramid_level);
+
+static mp_obj_t py_pyramid_update(mp_obj_t self_in, mp_obj_t img_obj) {
+    py_pyramid_build(self_in, img_obj);
+    return self_in;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_pyramid_update_obj, py_pyramid_update);
+
+STATIC const mp_rom_map_elem_t py_pyramid_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_levels), MP_ROM_PTR(&py_pyramid_levels_obj) },
+    { MP_ROM_QSTR(MP_QSTR_scale_factor), MP_ROM_PTR(&py_pyramid_scale_factor_obj) },
+    { MP_ROM_QSTR(MP_QSTR_level), MP_ROM_PTR(&py_pyramid_level_obj) },
+    { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&py_pyramid_update_obj) }
+};
+
+STATIC MP_DEFINE_CONST_DICT(py_pyramid_locals_dict, py_pyramid_locals_dict_table);
+
+STATIC MP_DEFINE_CONST_OBJ_TYPE(
+    py_pyramid_type,
+    MP_QSTR_pyramid,
+    MP_TYPE_FLAG_NONE,
+    print, py_pyramid_print,
+    locals_dict, &py_pyramid_locals_dict
+    );
+
+#if defined(IMLIB_ENABLE_FIND_KEYPOINTS) || defined(IMLIB_ENABLE_OPTICAL_FLOW) || defined(IMLIB_ENABLE_FEATURES)
+static bool py_pyramid_in_framebuffer(image_t *img) {
+    return (img->data >= framebuffer_get_buffer(0)->data) && (img->data < (uint8_t *) framebuffer_get_buffers_end());
+}
+
+// Returns the pyramid for img_obj, rebuilding it if it was computed from another image or
+// frame, or if the image was written since.
+static image_pyramid_t *py_pyramid_for_image(mp_obj_t pyr_obj, mp_obj_t img_obj) {
+    PY_ASSERT_TYPE(pyr_obj, &py_pyramid_type);
+    py_pyramid_obj_t *self = pyr_obj;
+    image_t *img = py_image_cobj(img_obj);
+
+    if ((!imlib_pyramid_is_valid(&self->_cobj, img))
+        || (self->write_seq != py_image_write_seq(img_obj))
+        || (py_pyramid_in_framebuffer(img) && (self->frame_seq != framebuffer->frame_seq))) {
+        py_pyramid_build(self, img_obj);
+    }
+
+    return &self->_cobj;
+}
+#endif // IMLIB_ENABLE_FIND_KEYPOINTS || IMLIB_ENABLE_OPTICAL_FLOW || IMLIB_ENABLE_FEATURES
+
+// Background model object ////////////////////////////////////////////////////
+
+typedef struct _py_background_obj_t {
+    mp_obj_base_t base;
+    background_model_t _cobj;
+} py_background_obj_t;
+
+static void py_background_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    py_background_obj_t *self = self_in;
+    mp_printf(print, "{\"w\":%d, \"h\":%d, \"rate\":%d}", self->_cobj.w, self->_cobj.h, self->_cobj.rate);
+}
+
+static image_t *py_background_arg_image(py_background_obj_t *self, mp_obj_t img_obj) {
+    image_t *img = py_helper_arg_to_image(img_obj, ARG_IMAGE_UNCOMPRESSED);
+    PY_ASSERT_TRUE_MSG((img->w == self->_cobj.w) && (img->h == self->_cobj.h),
+                       "Image size does not match the background model!");
+    return img;
+}
+
+static mp_obj_t py_background_update(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    py_background_obj_t *self = args[0];
+    image_t *img = py_background_arg_image(self, args[1]);
+    bool learn =
+        py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_learn), true);
+
+    imlib_background_update(&self->_cobj, img, learn);
+    return py_image_from_struct(&self->_cobj.mask);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_background_update_obj, 2, py_background_update);
+
+static mp_obj_t py_background_mask(mp_obj_t self_in) {
+    return py_image_from_struct(&((py_background_obj_t *) self_in)->_cobj.mask);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_background_mask_obj, py_background_mask);
+
+static mp_obj_t py_background_reset(mp_obj_t self_in, mp_obj_t img_obj) {
+    py_background_obj_t *self = self_in;
+    imlib_background_reset(&self->_cobj, py_background_arg_image(self, img_obj));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_background_reset_obj, py_background_reset);
+
+STATIC const mp_rom_map_elem_t py_background_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&py_background_update_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mask), MP_ROM_PTR(&py_background_mask_obj) },
+    { MP_ROM_QSTR(MP_QSTR_reset), MP_ROM_PTR(&py_background_reset_obj) }
+};
+
+STATIC MP_DEFINE_CONST_DICT(py_background_locals_dict, py_background_locals_dict_table);
+
+STATIC MP_DEFINE_CONST_OBJ_TYPE(
+    py_background_type,
+    MP_QSTR_background_model,
+    MP_TYPE_FLAG_NONE,
+    print, py_background_print,
+    locals_dict, &py_background_locals_dict
+    );
+
+// Temporal filter object ////////////////////////////////////////////////////
+
+typedef struct _py_temporal_filter_obj_t {
+    mp_obj_base_t base;
+    temporal_filter_t _cobj;
+} py_temporal_filter_obj_t;
+
+static void py_temporal_filter_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    py_temporal_filter_obj_t *self = self_in;
+    mp_printf(print, "{\"w\":%d, \"h\":%d}", self->_cobj.w, self->_cobj.h);
+}
+
+static image_t *py_temporal_filter_arg_image(py_temporal_filter_obj_t *self, mp_obj_t img_obj) {
+    image_t *img = py_helper_arg_to_image(img_obj, ARG_IMAGE_UNCOMPRESSED);
+    PY_ASSERT_TRUE_MSG((img->w == self->_cobj.w) && (img->h == self->_cobj.h) && (img->pixfmt == self->_cobj.pixfmt),
+                       "Image does not match the temporal filter!");
+    return img;
+}
+
+static mp_obj_t py_temporal_filter_update(mp_obj_t self_in, mp_obj_t img_obj) {
+    py_temporal_filter_obj_t *self = self_in;
+    imlib_temporal_filter_update(&self->_cobj, py_temporal_filter_arg_image(self, img_obj));
+    return img_obj;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_temporal_filter_update_obj, py_temporal_filter_update);
+
+static mp_obj_t py_temporal_filter_reset(mp_obj_t self_in, mp_obj_t img_obj) {
+    py_temporal_filter_obj_t *self = self_in;
+    imlib_temporal_filter_reset(&self->_cobj, py_temporal_filter_arg_image(self, img_obj));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_temporal_filter_reset_obj, py_temporal_filter_reset);
+
+STATIC const mp_rom_map_elem_t py_temporal_filter_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&py_temporal_filter_update_obj) },
+    { MP_ROM_QSTR(MP_QSTR_reset), MP_ROM_PTR(&py_temporal_filter_reset_obj) }
+};
+
+STATIC MP_DEFINE_CONST_DICT(py_temporal_filter_locals_dict, py_temporal_filter_locals_dict_table);
+
+STATIC MP_DEFINE_CONST_OBJ_TYPE(
+    py_temporal_filter_type,
+    MP_QSTR_temporal_filter,
+    MP_TYPE_FLAG_NONE,
+    print, py_temporal_filter_print,
+    locals_dict, &py_temporal_filter_locals_dict
+    );
+
 // LBP descriptor /////////////////////////////////////////////////////////////
 
 #ifdef IMLIB_ENABLE_FIND_LBP
@@ -290,6 +493,12 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
 typedef struct _py_image_obj_t {
     mp_obj_base_t base;
     image_t _cobj;
+    vbuffer_t *pinned; // set if the pixels are a pinned frame buffer.
+    uint32_t arena; // id of the frame arena holding the pixels, 0 if none.
+    void *buffer; // pixels of an output image (copy_to=/into=) and their size, outputs may be smaller.
+    uint32_t buffer_size;
+    frame_info_t info; // capture metadata of camera frames, seq is 0 otherwise.
+    uint32_t write_seq; // changes whenever the pixels are written.
 } py_image_obj_t;
 
 typedef struct _mp_obj_py_image_it_t {
@@ -301,7 +510,66 @@ typedef struct _mp_obj_py_image_it_t {
 
 void *py_image_cobj(mp_obj_t img_obj) {
     PY_ASSERT_TYPE(img_obj, &py_image_type);
-    return &((py_image_obj_t *) img_obj)->_cobj;
+    py_image_obj_t *o = (py_image_obj_t *) img_obj;
+    if (o->arena && !fb_alloc_arena_is_open(o->arena)) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Image was freed by its frame arena"));
+    }
+    return &o->_cobj;
+}
+
+// Every image gets a new write sequence number when created or written, so a number
+// identifies the pixels of one image at one point in time.
+static uint32_t py_image_next_write_seq() {
+    static uint32_t write_seq = 0;
+    return ++write_seq;
+}
+
+void py_image_written(mp_obj_t img_obj) {
+    ((py_image_obj_t *) img_obj)->write_seq = py_image_next_write_seq();
+}
+
+static uint32_t py_image_write_seq(mp_obj_t img_obj) {
+    return ((py_image_obj_t *) img_obj)->write_seq;
+}
+
+// Returns the pixels of an output image after checking img fits in them.
+static void *py_image_output_buffer(mp_obj_t img_obj, const image_t *img) {
+    py_image_obj_t *o = MP_OBJ_TO_PTR(img_obj);
+    image_t *image = py_image_cobj(img_obj);
+    py_image_written(img_obj);
+
+    if (o->buffer != image->data) {
+        o->buffer = image->data;
+        o->buffer_size = image_size(image);
+    }
+
+    PY_ASSERT_TRUE_MSG(o->buffer && (image_size(img) <= o->buffer_size), "The image doesn't fit in the output image!");
+    return o->buffer;
+}
+
+static bool py_image_is_framebuffer(const void *data) {
+    return framebuffer && (((const uint8_t *) data) >= framebuffer->data)
+           && (((const char *) data) < framebuffer_get_buffers_end());
+}
+
+mp_obj_t py_image_reuse(mp_obj_t img_obj, image_t *img) {
+    py_image_obj_t *o = MP_OBJ_TO_PTR(img_obj);
+    image_t *image = py_image_cobj(img_obj);
+    PY_ASSERT_TRUE_MSG(!o->pinned, "Can't reuse a pinned image!");
+    py_image_written(img_obj);
+
+    if (py_image_is_framebuffer(image->data)) {
+        o->_cobj = *img;
+    } else {
+        void *buffer = py_image_output_buffer(img_obj, img);
+        omv_memcpy(buffer, img->data, image_size(img));
+        o->_cobj = *img;
+        o->_cobj.data = buffer;
+    }
+
+    o->arena = fb_alloc_arena_id(o->_cobj.data);
+    o->info = (frame_info_t) {};
+    return img_obj;
 }
 
 mp_obj_t py_image_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
@@ -408,7 +676,19 @@ static void py_image_print(const mp_print_t *print, mp_obj_t self, mp_print_kind
                   (image->pixfmt == PIXFORMAT_YUV422)     ? "yuv422" :
                   (image->pixfmt == PIXFORMAT_YVU422)     ? "yvu422" :
                   (image->pixfmt == PIXFORMAT_JPEG)       ? "jpeg" :
-                  (image->pixfmt == PIXFORMAT_PNG)        ? "png" : "unknown",
+                  (image->pixfmt == PIXFORMAT_PNG)        ? "png" :
+                  (image->pixfmt == PIXFORMAT_RAW10_BGGR) ? "raw10_bggr" :
+                  (image->pixfmt == PIXFORMAT_RAW10_GBRG) ? "raw10_gbrg" :
+                  (image->pixfmt == PIXFORMAT_RAW10_GRBG) ? "raw10_grbg" :
+                  (image->pixfmt == PIXFORMAT_RAW10_RGGB) ? "raw10_rggb" :
+                  (image->pixfmt == PIXFORMAT_RAW12_BGGR) ? "raw12_bggr" :
+                  (image->pixfmt == PIXFORMAT_RAW12_GBRG) ? "raw12_gbrg" :
+                  (image->pixfmt == PIXFORMAT_RAW12_GRBG) ? "raw12_grbg" :
+                  (image->pixfmt == PIXFORMAT_RAW12_RGGB) ? "raw12_rggb" :
+                  (image->pixfmt == PIXFORMAT_TENSOR_UINT8)     ? "tensor_uint8" :
+                  (image->pixfmt == PIXFORMAT_TENSOR_INT8)      ? "tensor_int8" :
+                  (image->pixfmt == PIXFORMAT_TENSOR_RGB_UINT8) ? "tensor_rgb_uint8" :
+                  (image->pixfmt == PIXFORMAT_TENSOR_RGB_INT8)  ? "tensor_rgb_int8" : "unknown",
                   image_size(image));
     }
 }
@@ -510,6 +790,7 @@ static mp_obj_t py_image_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t value
         }
     } else {
         // store
+        py_image_written(self_in);
         switch (image->pixfmt) {
             case PIXFORMAT_BINARY: {
                 if (MP_OBJ_IS_TYPE(index, &mp_type_slice)) {
@@ -661,10 +942,10 @@ static mp_obj_t py_image_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t value
 }
 
 static mp_int_t py_image_get_buffer(mp_obj_t self_in, mp_buffer_info_t *bufinfo, mp_uint_t flags) {
-    py_image_obj_t *self = self_in;
     if (flags == MP_BUFFER_READ) {
-        bufinfo->buf = self->_cobj.data;
-        bufinfo->len = image_size(&self->_cobj);
+        image_t *image = py_image_cobj(self_in);
+        bufinfo->buf = image->data;
+        bufinfo->len = image_size(image);
         bufinfo->typecode = 'b';
         return 0;
     } else {
@@ -707,6 +988,8 @@ static mp_obj_t py_image_format(mp_obj_t img_obj) {
             return mp_obj_new_int(PIXFORMAT_JPEG);
         case PIXFORMAT_PNG:
             return mp_obj_new_int(PIXFORMAT_PNG);
+        case PIXFORMAT_RAW_ANY:
+            return mp_obj_new_int((image->pixfmt_id == PIXFORMAT_ID_RAW10) ? PIXFORMAT_RAW10 : PIXFORMAT_RAW12);
         default:
             return mp_obj_new_int(PIXFORMAT_INVALID);
     }
@@ -724,6 +1007,50 @@ static mp_obj_t py_image_bytearray(mp_obj_t img_obj) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_bytearray_obj, py_image_bytearray);
 
+// Returns the capture metadata of a camera frame as a dict, or None for other images.
+static mp_obj_t py_image_get_frame_info(mp_obj_t img_obj) {
+    const frame_info_t *info = py_image_frame_info(img_obj);
+
+    if (!info) {
+        return mp_const_none;
+    }
+
+    mp_obj_t dict = mp_obj_new_dict(8);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_seq), mp_obj_new_int_from_uint(info->seq));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_sync_seq), mp_obj_new_int_from_uint(info->sync_seq));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_sof_us), mp_obj_new_int_from_uint(info->sof_us));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_eof_us), mp_obj_new_int_from_uint(info->eof_us));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_exposure_us), mp_obj_new_int(info->exposure_us));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_gain_db), mp_obj_new_float(info->gain_db));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_age_us), mp_obj_new_int_from_uint(info->age_us));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_dropped), mp_obj_new_int_from_uint(info->dropped));
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_get_frame_info_obj, py_image_get_frame_info);
+
+// Returns a ulab ndarray of shape (h, w) that aliases the pixel buffer. GRAYSCALE and Bayer images
+// are uint8, RGB565 and YUV422 images are uint16 (native byte order).
+static mp_obj_t py_image_to_ndarray(mp_obj_t img_obj) {
+    image_t *arg_img = py_helper_arg_to_image(img_obj, ARG_IMAGE_UNCOMPRESSED);
+
+    if (arg_img->pixfmt == PIXFORMAT_BINARY) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Binary images are not supported"));
+    }
+
+    mp_obj_t np = mp_load_attr(mp_import_name(MP_QSTR_ulab, mp_const_none, MP_OBJ_NEW_SMALL_INT(0)), MP_QSTR_numpy);
+    mp_obj_t dtype = mp_load_attr(np, (arg_img->bpp == 2) ? MP_QSTR_uint16 : MP_QSTR_uint8);
+
+    // frombuffer() and reshape() of a dense array both return views.
+    mp_obj_t array = mp_call_function_n_kw(mp_load_attr(np, MP_QSTR_frombuffer), 1, 1,
+                                           (mp_obj_t []) {img_obj, MP_OBJ_NEW_QSTR(MP_QSTR_dtype), dtype});
+
+    mp_obj_t dest[3];
+    mp_load_method(array, MP_QSTR_reshape, dest);
+    dest[2] = mp_obj_new_tuple(2, (mp_obj_t []) {mp_obj_new_int(arg_img->h), mp_obj_new_int(arg_img->w)});
+    return mp_call_method_n_kw(1, 0, dest);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_to_ndarray_obj, py_image_to_ndarray);
+
 STATIC mp_obj_t py_image_get_pixel(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_UNCOMPRESSED);
 
@@ -798,13 +1125,16 @@ STATIC mp_obj_t py_image_get_pixel(uint n_args, const mp_obj_t *args, mp_map_t *
             } else {
                 return mp_obj_new_int(IMAGE_GET_YUV_PIXEL(arg_img, arg_x, arg_y));
             }
+        case PIXFORMAT_RAW_ANY:
+            // The native depth value of the site.
+            return mp_obj_new_int(imlib_raw_get_pixel(arg_img, arg_x, arg_y));
         default: return mp_const_none;
     }
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_get_pixel_obj, 2, py_image_get_pixel);
 
 STATIC mp_obj_t py_image_set_pixel(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_UNCOMPRESSED);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_UNCOMPRESSED | ARG_IMAGE_WRITE);
 
     const mp_obj_t *arg_vec;
     uint offset = py_helper_consume_array(n_args, args, 1, 2, &arg_vec);
@@ -844,7 +1174,7 @@ static mp_obj_t py_image_to(pixformat_t pixfmt, mp_rom_obj_t default_color_palet
                             uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     enum {
         ARG_x_scale, ARG_y_scale, ARG_roi, ARG_channel, ARG_alpha, ARG_color_palette, ARG_alpha_palette, ARG_hint,
-        ARG_copy, ARG_copy_to_fb, ARG_quality, ARG_encode_for_ide, ARG_subsampling
+        ARG_copy, ARG_copy_to_fb, ARG_copy_to, ARG_quality, ARG_encode_for_ide, ARG_subsampling, ARG_signed
     };
     const mp_arg_t allowed_args[] = {
         { MP_QSTR_x_scale, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
@@ -857,9 +1187,11 @@ static mp_obj_t py_image_to(pixformat_t pixfmt, mp_rom_obj_t default_color_palet
         { MP_QSTR_hint, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = 0 } },
         { MP_QSTR_copy, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = default_copy} },
         { MP_QSTR_copy_to_fb, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+        { MP_QSTR_copy_to, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
         { MP_QSTR_quality, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 90} },
         { MP_QSTR_encode_for_ide, MP_ARG_BOOL | MP_ARG_KW_ONLY,  {.u_bool = false} },
         { MP_QSTR_subsampling, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = JPEG_SUBSAMPLING_AUTO} },
+        { MP_QSTR_signed, MP_ARG_BOOL | MP_ARG_KW_ONLY,  {.u_bool = true} },
     };
 
     // Parse args.
@@ -897,6 +1229,16 @@ static mp_obj_t py_image_to(pixformat_t pixfmt, mp_rom_obj_t default_color_palet
         framebuffer_update_jpeg_buffer();
     }
 
+    // Tensors have as many channels as the drawn image.
+    if (IMLIB_PIXFORMAT_IS_TENSOR(pixfmt)) {
+        bool color = (src_img->is_color && (args[ARG_channel].u_int == -1)) || (color_palette != NULL);
+        if (args[ARG_signed].u_bool) {
+            pixfmt = color ? PIXFORMAT_TENSOR_RGB_INT8 : PIXFORMAT_TENSOR_INT8;
+        } else {
+            pixfmt = color ? PIXFORMAT_TENSOR_RGB_UINT8 : PIXFORMAT_TENSOR_UINT8;
+        }
+    }
+
     image_t dst_img = {
         .w = fast_floorf(roi.w * x_scale),
         .h = fast_floorf(roi.h * y_scale),
@@ -961,7 +1303,7 @@ static mp_obj_t py_image_to(pixformat_t pixfmt, mp_rom_obj_t default_color_palet
             image_t temp;
             memcpy(&temp, src_img, sizeof(image_t));
 
-            if (src_img->is_compressed || (!simple)) {
+            if (src_img->is_compressed || src_img->is_tensor || (!simple)) {
                 temp.w = dst_img.w;
                 temp.h = dst_img.h;
                 temp.pixfmt = src_img->is_color ? PIXFORMAT_RGB565 : PIXFORMAT_GRAYSCALE;
@@ -979,7 +1321,7 @@ static mp_obj_t py_image_to(pixformat_t pixfmt, mp_rom_obj_t default_color_palet
             }
         } else if (args[ARG_encode_for_ide].u_bool) {
             dst_img_tmp.data = fb_alloc(image_size(&dst_img_tmp), FB_ALLOC_NO_HINT);
-            memcpy(dst_img_tmp.data, src_img->data, dst_img_tmp.size);
+            omv_memcpy(dst_img_tmp.data, src_img->data, dst_img_tmp.size);
         } else {
             dst_img_tmp.data = src_img->data;
         }
@@ -992,13 +1334,18 @@ static mp_obj_t py_image_to(pixformat_t pixfmt, mp_rom_obj_t default_color_palet
     }
 
     uint32_t size = image_size(&dst_img);
+    bool copy_to = args[ARG_copy_to].u_obj != mp_const_none;
 
     if (args[ARG_copy_to_fb].u_bool) {
         // Convert to FB.
         py_helper_set_to_framebuffer(&dst_img);
+    } else if (copy_to) {
+        // Convert into an existing image.
+        dst_img.data = py_image_output_buffer(args[ARG_copy_to].u_obj, &dst_img);
+        PY_ASSERT_TRUE_MSG((dst_img.data != src_img->data), "Can't copy to the source image!");
     } else if (args[ARG_copy].u_bool) {
         // Create dynamic copy.
-        dst_img.data = xalloc(size);
+        dst_img.data = py_helper_image_alloc(size);
     } else {
         // Convert in place.
         bool fb = py_helper_is_equal_to_framebuffer(src_img);
@@ -1011,7 +1358,7 @@ static mp_obj_t py_image_to(pixformat_t pixfmt, mp_rom_obj_t default_color_palet
         if (args[ARG_encode_for_ide].u_bool) {
             fb_encode_for_ide(dst_img.data, &dst_img_tmp);
         } else if (dst_img.data != dst_img_tmp.data) {
-            memcpy(dst_img.data, dst_img_tmp.data, dst_img.size);
+            omv_memcpy(dst_img.data, dst_img_tmp.data, dst_img.size);
         }
         fb_alloc_free_till_mark();
     } else {
@@ -1022,9 +1369,14 @@ static mp_obj_t py_image_to(pixformat_t pixfmt, mp_rom_obj_t default_color_palet
         fb_alloc_free_till_mark();
     }
 
-    if ((!args[ARG_copy_to_fb].u_bool) && (!args[ARG_copy].u_bool)) {
+    if (copy_to) {
+        py_helper_update_framebuffer(&dst_img);
+        memcpy(py_image_cobj(args[ARG_copy_to].u_obj), &dst_img, sizeof(image_t));
+        return args[ARG_copy_to].u_obj;
+    } else if ((!args[ARG_copy_to_fb].u_bool) && (!args[ARG_copy].u_bool)) {
         py_helper_update_framebuffer(&dst_img);
         memcpy(src_img, &dst_img, sizeof(image_t));
+        py_image_written(pos_args[0]);
     }
 
     return py_image_from_struct(&dst_img);
@@ -1065,6 +1417,11 @@ static mp_obj_t py_image_to_png(uint n_args, const mp_obj_t *args, mp_map_t *kw_
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_to_png_obj, 1, py_image_to_png);
 
+static mp_obj_t py_image_to_tensor(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    return py_image_to(PIXFORMAT_TENSOR_INT8, MP_ROM_NONE, false, n_args, args, kw_args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_to_tensor_obj, 1, py_image_to_tensor);
+
 static mp_obj_t py_image_copy(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     return py_image_to(PIXFORMAT_INVALID, MP_ROM_NONE, true, n_args, args, kw_args);
 }
@@ -1100,12 +1457,26 @@ static mp_obj_t py_image_flush(mp_obj_t img_obj) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_flush_obj, py_image_flush);
 
+static mp_obj_t py_image_release(mp_obj_t img_obj) {
+    py_image_obj_t *self = MP_OBJ_TO_PTR(img_obj);
+    if (self->pinned) {
+        // A no-op if the pin was dropped by laying the buffers out again.
+        framebuffer_release_buffer(&self->_cobj);
+        self->pinned = NULL;
+        // The pixels now belong to the frame buffer again.
+        memset(&self->_cobj, 0, sizeof(image_t));
+        self->_cobj.pixfmt = PIXFORMAT_INVALID;
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_release_obj, py_image_release);
+
 //////////////////
 // Drawing Methods
 //////////////////
 
 STATIC mp_obj_t py_image_clear(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_UNCOMPRESSED);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_UNCOMPRESSED | ARG_IMAGE_WRITE);
 
     image_t *arg_msk =
         py_helper_keyword_to_image(n_args, args, 1, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
@@ -1121,7 +1492,7 @@ STATIC mp_obj_t py_image_clear(uint n_args, const mp_obj_t *args, mp_map_t *kw_a
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_clear_obj, 1, py_image_clear);
 
 STATIC mp_obj_t py_image_draw_line(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
 
     const mp_obj_t *arg_vec;
     uint offset = py_helper_consume_array(n_args, args, 1, 4, &arg_vec);
@@ -1141,7 +1512,7 @@ STATIC mp_obj_t py_image_draw_line(uint n_args, const mp_obj_t *args, mp_map_t *
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_draw_line_obj, 2, py_image_draw_line);
 
 STATIC mp_obj_t py_image_draw_rectangle(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
 
     const mp_obj_t *arg_vec;
     uint offset = py_helper_consume_array(n_args, args, 1, 4, &arg_vec);
@@ -1163,7 +1534,7 @@ STATIC mp_obj_t py_image_draw_rectangle(uint n_args, const mp_obj_t *args, mp_ma
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_draw_rectangle_obj, 2, py_image_draw_rectangle);
 
 STATIC mp_obj_t py_image_draw_circle(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
 
     const mp_obj_t *arg_vec;
     uint offset = py_helper_consume_array(n_args, args, 1, 3, &arg_vec);
@@ -1184,7 +1555,7 @@ STATIC mp_obj_t py_image_draw_circle(uint n_args, const mp_obj_t *args, mp_map_t
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_draw_circle_obj, 2, py_image_draw_circle);
 
 STATIC mp_obj_t py_image_draw_ellipse(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
 
     const mp_obj_t *arg_vec;
     uint offset = py_helper_consume_array(n_args, args, 1, 5, &arg_vec);
@@ -1207,7 +1578,7 @@ STATIC mp_obj_t py_image_draw_ellipse(uint n_args, const mp_obj_t *args, mp_map_
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_draw_ellipse_obj, 2, py_image_draw_ellipse);
 
 STATIC mp_obj_t py_image_draw_string(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
 
     const mp_obj_t *arg_vec;
     uint offset = py_helper_consume_array(n_args, args, 1, 3, &arg_vec);
@@ -1248,7 +1619,7 @@ STATIC mp_obj_t py_image_draw_string(uint n_args, const mp_obj_t *args, mp_map_t
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_draw_string_obj, 2, py_image_draw_string);
 
 STATIC mp_obj_t py_image_draw_cross(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
 
     const mp_obj_t *arg_vec;
     uint offset = py_helper_consume_array(n_args, args, 1, 2, &arg_vec);
@@ -1268,8 +1639,111 @@ STATIC mp_obj_t py_image_draw_cross(uint n_args, const mp_obj_t *args, mp_map_t
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_draw_cross_obj, 2, py_image_draw_cross);
 
+// Primitive types for draw_batch().
+typedef enum {
+    DRAW_BATCH_LINE,
+    DRAW_BATCH_RECTANGLE,
+    DRAW_BATCH_CIRCLE,
+    DRAW_BATCH_ELLIPSE,
+    DRAW_BATCH_CROSS,
+    DRAW_BATCH_STRING,
+} draw_batch_type_t;
+
+static int py_image_draw_batch_int(size_t n_args, const mp_obj_t *args, uint arg_index, int default_val) {
+    return (n_args > arg_index) ? mp_obj_get_int(args[arg_index]) : default_val;
+}
+
+// Draws a list of (type, *args) tuples in one call. Arguments past the geometry are
+// positional and default to the keyword arguments passed to draw_batch() itself.
+STATIC mp_obj_t py_image_draw_batch(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
+
+    int arg_c =
+        py_helper_keyword_color(arg_img, n_args, args, 2, kw_args, -1); // White.
+    int arg_thickness =
+        py_helper_keyword_int(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_thickness), 1);
+    bool arg_fill =
+        py_helper_keyword_int(n_args, args, 4, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_fill), false);
+
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_get_array(args[1], &len, &items);
+
+    for (size_t i = 0; i < len; i++) {
+        size_t n;
+        mp_obj_t *item;
+        mp_obj_get_array(items[i], &n, &item);
+        PY_ASSERT_TRUE_MSG(n >= 3, "Expected a (type, ...) tuple");
+
+        switch (mp_obj_get_int(item[0])) {
+            case DRAW_BATCH_LINE: {
+                PY_ASSERT_TRUE_MSG(n >= 5, "Expected (DRAW_LINE, x0, y0, x1, y1, ...)");
+                imlib_draw_line(arg_img, mp_obj_get_int(item[1]), mp_obj_get_int(item[2]),
+                                mp_obj_get_int(item[3]), mp_obj_get_int(item[4]),
+                                py_helper_keyword_color(arg_img, n, item, 5, NULL, arg_c),
+                                py_image_draw_batch_int(n, item, 6, arg_thickness));
+                break;
+            }
+            case DRAW_BATCH_RECTANGLE: {
+                PY_ASSERT_TRUE_MSG(n >= 5, "Expected (DRAW_RECTANGLE, x, y, w, h, ...)");
+                imlib_draw_rectangle(arg_img, mp_obj_get_int(item[1]), mp_obj_get_int(item[2]),
+                                     mp_obj_get_int(item[3]), mp_obj_get_int(item[4]),
+                                     py_helper_keyword_color(arg_img, n, item, 5, NULL, arg_c),
+                                     py_image_draw_batch_int(n, item, 6, arg_thickness),
+                                     py_image_draw_batch_int(n, item, 7, arg_fill));
+                break;
+            }
+            case DRAW_BATCH_CIRCLE: {
+                PY_ASSERT_TRUE_MSG(n >= 4, "Expected (DRAW_CIRCLE, x, y, r, ...)");
+                imlib_draw_circle(arg_img, mp_obj_get_int(item[1]), mp_obj_get_int(item[2]),
+                                  mp_obj_get_int(item[3]),
+                                  py_helper_keyword_color(arg_img, n, item, 4, NULL, arg_c),
+                                  py_image_draw_batch_int(n, item, 5, arg_thickness),
+                                  py_image_draw_batch_int(n, item, 6, arg_fill));
+                break;
+            }
+            case DRAW_BATCH_ELLIPSE: {
+                PY_ASSERT_TRUE_MSG(n >= 6, "Expected (DRAW_ELLIPSE, x, y, rx, ry, rotation, ...)");
+                imlib_draw_ellipse(arg_img, mp_obj_get_int(item[1]), mp_obj_get_int(item[2]),
+                                   mp_obj_get_int(item[3]), mp_obj_get_int(item[4]),
+                                   mp_obj_get_int(item[5]),
+                                   py_helper_keyword_color(arg_img, n, item, 6, NULL, arg_c),
+                                   py_image_draw_batch_int(n, item, 7, arg_thickness),
+                                   py_image_draw_batch_int(n, item, 8, arg_fill));
+                break;
+            }
+            case DRAW_BATCH_CROSS: {
+                int x = mp_obj_get_int(item[1]);
+                int y = mp_obj_get_int(item[2]);
+                int c = py_helper_keyword_color(arg_img, n, item, 3, NULL, arg_c);
+                int s = py_image_draw_batch_int(n, item, 4, 5);
+                int thickness = py_image_draw_batch_int(n, item, 5, arg_thickness);
+                imlib_draw_line(arg_img, x - s, y, x + s, y, c, thickness);
+                imlib_draw_line(arg_img, x, y - s, x, y + s, c, thickness);
+                break;
+            }
+            case DRAW_BATCH_STRING: {
+                PY_ASSERT_TRUE_MSG(n >= 4, "Expected (DRAW_STRING, x, y, text, ...)");
+                float scale = (n > 5) ? mp_obj_get_float(item[5]) : 1.0f;
+                PY_ASSERT_TRUE_MSG(0 < scale, "Error: 0 < scale!");
+                imlib_draw_string(arg_img, mp_obj_get_int(item[1]), mp_obj_get_int(item[2]),
+                                  mp_obj_str_get_str(item[3]),
+                                  py_helper_keyword_color(arg_img, n, item, 4, NULL, arg_c), scale, 0, 0, true,
+                                  0, false, false, 0, false, false);
+                break;
+            }
+            default: {
+                mp_raise_ValueError(MP_ERROR_TEXT("Unknown draw type"));
+            }
+        }
+    }
+
+    return args[0];
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_draw_batch_obj, 2, py_image_draw_batch);
+
 STATIC mp_obj_t py_image_draw_arrow(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
 
     const mp_obj_t *arg_vec;
     uint offset = py_helper_consume_array(n_args, args, 1, 4, &arg_vec);
@@ -1307,7 +1781,7 @@ STATIC mp_obj_t py_image_draw_arrow(uint n_args, const mp_obj_t *args, mp_map_t
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_draw_arrow_obj, 2, py_image_draw_arrow);
 
 STATIC mp_obj_t py_image_draw_edges(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
 
     mp_obj_t *corners, *p0, *p1, *p2, *p3;
     mp_obj_get_array_fixed_n(args[1], 4, &corners);
@@ -1353,7 +1827,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_draw_edges_obj, 2, py_image_draw_edge
 
 STATIC mp_obj_t py_image_draw_image(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     fb_alloc_mark();
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     image_t *arg_other = py_helper_arg_to_image(args[1], ARG_IMAGE_ANY | ARG_IMAGE_ALLOC);
 
     const mp_obj_t *arg_vec;
@@ -1440,7 +1914,7 @@ STATIC mp_obj_t py_image_draw_image(uint n_args, const mp_obj_t *args, mp_map_t
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_draw_image_obj, 3, py_image_draw_image);
 
 STATIC mp_obj_t py_image_draw_keypoints(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
 
     int arg_c =
         py_helper_keyword_color(arg_img, n_args, args, 2, kw_args, -1); // White.
@@ -1489,7 +1963,7 @@ STATIC mp_obj_t py_image_draw_keypoints(uint n_args, const mp_obj_t *args, mp_ma
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_draw_keypoints_obj, 2, py_image_draw_keypoints);
 
 STATIC mp_obj_t py_image_mask_rectangle(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     int arg_rx;
     int arg_ry;
     int arg_rw;
@@ -1525,7 +1999,7 @@ STATIC mp_obj_t py_image_mask_rectangle(uint n_args, const mp_obj_t *args, mp_ma
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_mask_rectangle_obj, 1, py_image_mask_rectangle);
 
 STATIC mp_obj_t py_image_mask_circle(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     int arg_cx;
     int arg_cy;
     int arg_cr;
@@ -1558,7 +2032,7 @@ STATIC mp_obj_t py_image_mask_circle(uint n_args, const mp_obj_t *args, mp_map_t
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_mask_circle_obj, 1, py_image_mask_circle);
 
 STATIC mp_obj_t py_image_mask_ellipse(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     int arg_cx;
     int arg_cy;
     int arg_rx;
@@ -1598,7 +2072,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_mask_ellipse_obj, 1, py_image_mask_el
 
 #ifdef IMLIB_ENABLE_FLOOD_FILL
 STATIC mp_obj_t py_image_flood_fill(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
 
     const mp_obj_t *arg_vec;
     uint offset = py_helper_consume_array(n_args, args, 1, 2, &arg_vec);
@@ -1666,47 +2140,7 @@ STATIC mp_obj_t py_ccm(mp_obj_t img_obj, mp_obj_t ccm_obj) {
     image_t *image = py_helper_arg_to_image(img_obj, ARG_IMAGE_MUTABLE);
 
     float ccm[12] = {};
-    bool offset = false;
-
-    size_t len;
-    mp_obj_t *items;
-    mp_obj_get_array(ccm_obj, &len, &items);
-
-    // Form [[rr, rg, rb], [gr, gg, gb], [br, bg, bb]]
-    // Form [[rr, rg, rb], [gr, gg, gb], [br, bg, bb], [xx, xx, xx]]
-    // Form [[rr, rg, rb, ro], [gr, gg, gb, go], [br, bg, bb, bo]]
-    // Form [[rr, rg, rb, ro], [gr, gg, gb, go], [br, bg, bb, bo], [xx, xx, xx, xx]]
-    if ((len == 3) || (len == 4)) {
-        for (size_t i = 0; i < 3; i++) {
-            size_t row_len;
-            mp_obj_t *row_items;
-            mp_obj_get_array(items[i], &row_len, &row_items);
-            offset = offset || (row_len == 4);
-            if ((row_len == 3) || (row_len == 4)) {
-                for (size_t j = 0; j < row_len; j++) {
-                    ccm[(i * 4) + j] = mp_obj_get_float(row_items[j]);
-                }
-            } else {
-                mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Unexpected matrix dimensions!"));
-            }
-        }
-        // Form [rr, rg, rb, gr, gg, gb, br, bg, bb]
-    } else if (len == 9) {
-        for (size_t i = 0; i < 3; i++) {
-            for (size_t j = 0; j < 3; j++) {
-                ccm[(i * 4) + j] = mp_obj_get_float(items[(i * 3) + j]);
-            }
-        }
-        // Form [rr, rg, rb, ro, gr, gg, gb, go, br, bg, bb, bo]
-        // Form [rr, rg, rb, ro, gr, gg, gb, go, br, bg, bb, bo, xx, xx, xx, xx]
-    } else if (len == 12 || len == 16) {
-        offset = true;
-        for (size_t i = 0; i < 12; i++) {
-            ccm[i] = mp_obj_get_float(items[i]);
-        }
-    } else {
-        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Unexpected matrix dimensions!"));
-    }
+    bool offset = py_helper_arg_to_ccm(ccm_obj, ccm);
 
     imlib_ccm(image, ccm, offset);
     return img_obj;
@@ -1722,7 +2156,7 @@ STATIC mp_obj_t py_image_gamma(uint n_args, const mp_obj_t *pos_args, mp_map_t *
     };
 
     // Parse args.
-    image_t *image = py_helper_arg_to_image(pos_args[0], ARG_IMAGE_UNCOMPRESSED);
+    image_t *image = py_helper_arg_to_image(pos_args[0], ARG_IMAGE_UNCOMPRESSED | ARG_IMAGE_WRITE);
     mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
     mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
 
@@ -1737,95 +2171,429 @@ STATIC mp_obj_t py_image_gamma(uint n_args, const mp_obj_t *pos_args, mp_map_t *
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_gamma_obj, 1, py_image_gamma);
 
-#endif // IMLIB_ENABLE_ISP_OPS
-
-#ifdef IMLIB_ENABLE_BINARY_OPS
-/////////////////
-// Binary Methods
-/////////////////
-
-STATIC mp_obj_t py_image_binary(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
-    enum { ARG_thresholds, ARG_invert, ARG_zero, ARG_mask, ARG_to_bitmap, ARG_copy };
+STATIC mp_obj_t py_image_isp(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_awb, ARG_max, ARG_ccm, ARG_gamma, ARG_contrast, ARG_brightness, ARG_row_step };
     static const mp_arg_t allowed_args[] = {
-        { MP_QSTR_thresholds, MP_ARG_OBJ | MP_ARG_REQUIRED, },
-        { MP_QSTR_invert, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
-        { MP_QSTR_zero, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
-        { MP_QSTR_mask, MP_ARG_OBJ | MP_ARG_KW_ONLY,  {.u_rom_obj = MP_ROM_NONE} },
-        { MP_QSTR_to_bitmap, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
-        { MP_QSTR_copy, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+        { MP_QSTR_awb, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_max, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+        { MP_QSTR_ccm, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_gamma, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_contrast, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_brightness, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_row_step, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 1 } },
     };
 
     // Parse args.
-    image_t *image = py_helper_arg_to_image(pos_args[0], ARG_IMAGE_MUTABLE);
+    image_t *image = py_helper_arg_to_image(pos_args[0], ARG_IMAGE_UNCOMPRESSED | ARG_IMAGE_WRITE);
     mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
     mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
 
-    if (args[ARG_to_bitmap].u_int && (image->pixfmt != PIXFORMAT_BINARY) &&
-        (args[ARG_zero].u_int || (args[ARG_mask].u_obj != mp_const_none))) {
-        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Incompatible arguments!"));
-    }
+    isp_config_t config = {
+        .awb = args[ARG_awb].u_obj != mp_const_none,
+        .awb_max = args[ARG_max].u_bool,
+        .ccm_enable = args[ARG_ccm].u_obj != mp_const_none,
+        .gamma = py_helper_arg_to_float(args[ARG_gamma].u_obj, 1.0f),
+        .contrast = py_helper_arg_to_float(args[ARG_contrast].u_obj, 1.0f),
+        .brightness = py_helper_arg_to_float(args[ARG_brightness].u_obj, 0.0f),
+        .row_step = args[ARG_row_step].u_int,
+    };
 
-    if (args[ARG_to_bitmap].u_int && (!args[ARG_copy].u_int)) {
-        switch (image->pixfmt) {
-            case PIXFORMAT_GRAYSCALE: {
-                PY_ASSERT_TRUE_MSG((image->w >= 4), "Can't convert to bitmap in place!");
-                break;
-            }
-            case PIXFORMAT_RGB565: {
-                PY_ASSERT_TRUE_MSG((image->w >= 2), "Can't convert to bitmap in place!");
-                break;
-            }
-            default: {
-                break;
-            }
-        }
+    if (config.ccm_enable) {
+        config.ccm_offset = py_helper_arg_to_ccm(args[ARG_ccm].u_obj, config.ccm);
     }
 
-    list_t thresholds;
-    list_init(&thresholds, sizeof(color_thresholds_list_lnk_data_t));
-    py_helper_arg_to_thresholds(args[ARG_thresholds].u_obj, &thresholds);
-
-    image_t out;
-    out.w = image->w;
-    out.h = image->h;
-    out.pixfmt = args[ARG_to_bitmap].u_int ? PIXFORMAT_BINARY : image->pixfmt;
-    out.data = args[ARG_copy].u_int ? xalloc(image_size(&out)) : image->pixels;
+    // awb is the (r, g, b) statistics tuple returned for the previous frame.
+    isp_stats_t stats = {};
 
-    fb_alloc_mark();
-    image_t *mask = NULL;
-    if (args[ARG_mask].u_obj != mp_const_none) {
-        mask = py_helper_arg_to_image(args[ARG_mask].u_obj, ARG_IMAGE_MUTABLE | ARG_IMAGE_ALLOC);
+    if (config.awb) {
+        mp_obj_t *awb;
+        mp_obj_get_array_fixed_n(args[ARG_awb].u_obj, 3, &awb);
+        stats.r = mp_obj_get_int(awb[0]);
+        stats.g = mp_obj_get_int(awb[1]);
+        stats.b = mp_obj_get_int(awb[2]);
     }
 
-    imlib_binary(&out, image, &thresholds, args[ARG_invert].u_int, args[ARG_zero].u_int, mask);
+    fb_alloc_mark();
+    imlib_isp(image, &config, &stats);
     fb_alloc_free_till_mark();
 
-    list_free(&thresholds);
+    return mp_obj_new_tuple(3, (mp_obj_t []) {
+        mp_obj_new_int(stats.r),
+        mp_obj_new_int(stats.g),
+        mp_obj_new_int(stats.b)
+    });
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_isp_obj, 1, py_image_isp);
 
-    if (args[ARG_to_bitmap].u_int && (!args[ARG_copy].u_int)) {
-        image->pixfmt = PIXFORMAT_BINARY;
-        py_helper_update_framebuffer(&out);
-    }
+// LUT Object //
+static const mp_obj_type_t py_lut_type;
 
-    return py_image_from_struct(&out);
+typedef struct py_lut_obj {
+    mp_obj_base_t base;
+    lut_t lut;
+} py_lut_obj_t;
+
+static void py_lut_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    py_lut_obj_t *self = self_in;
+    mp_printf(print, "{\"type\":\"%s\", \"size\":%d}",
+              (self->lut.type == LUT_TYPE_CHANNEL) ? "channel" : "rgb565", imlib_lut_size(self->lut.type));
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_binary_obj, 1, py_image_binary);
 
-STATIC mp_obj_t py_image_invert(mp_obj_t img_obj) {
-    imlib_invert(py_helper_arg_to_image(img_obj, ARG_IMAGE_MUTABLE));
-    return img_obj;
+static py_lut_obj_t *py_lut_new(lut_type_t type) {
+    py_lut_obj_t *o = m_new_obj(py_lut_obj_t);
+    o->base.type = &py_lut_type;
+    o->lut.type = type;
+    o->lut.table = m_new(uint8_t, imlib_lut_size(type));
+    return o;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_invert_obj, py_image_invert);
 
-STATIC mp_obj_t py_image_b_and(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
-    image_t *arg_msk =
-        py_helper_keyword_to_image(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
+static mp_obj_t py_lut_compose(mp_obj_t self_in, mp_obj_t other_in) {
+    py_lut_obj_t *self = self_in;
+    PY_ASSERT_TYPE(other_in, &py_lut_type);
+    py_lut_obj_t *other = other_in;
 
-    fb_alloc_mark();
+    bool channel = (self->lut.type == LUT_TYPE_CHANNEL) && (other->lut.type == LUT_TYPE_CHANNEL);
+    py_lut_obj_t *o = py_lut_new(channel ? LUT_TYPE_CHANNEL : LUT_TYPE_RGB565);
+    imlib_lut_compose(&o->lut, &self->lut, &other->lut);
+    return o;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_lut_compose_obj, py_lut_compose);
 
-    if (MP_OBJ_IS_STR(args[1])) {
+// The table can be saved and loaded back with image.lut().
+static mp_int_t py_lut_get_buffer(mp_obj_t self_in, mp_buffer_info_t *bufinfo, mp_uint_t flags) {
+    py_lut_obj_t *self = self_in;
+    bufinfo->buf = self->lut.table;
+    bufinfo->len = imlib_lut_size(self->lut.type);
+    bufinfo->typecode = (self->lut.type == LUT_TYPE_CHANNEL) ? 'B' : 'H';
+    return 0;
+}
+
+STATIC const mp_rom_map_elem_t py_lut_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_compose), MP_ROM_PTR(&py_lut_compose_obj) }
+};
+
+STATIC MP_DEFINE_CONST_DICT(py_lut_locals_dict, py_lut_locals_dict_table);
+
+STATIC MP_DEFINE_CONST_OBJ_TYPE(
+    py_lut_type,
+    MP_QSTR_lut,
+    MP_TYPE_FLAG_NONE,
+    print, py_lut_print,
+    buffer, py_lut_get_buffer,
+    locals_dict, &py_lut_locals_dict
+    );
+
+// Fills 256 channel LUT entries from a sequence.
+static void py_lut_channel_from_obj(mp_obj_t obj, uint8_t *table) {
+    mp_obj_t *items;
+    mp_obj_get_array_fixed_n(obj, LUT_CHANNEL_SIZE, &items);
+
+    for (int i = 0; i < LUT_CHANNEL_SIZE; i++) {
+        table[i] = IM_MAX(IM_MIN(mp_obj_get_int(items[i]), COLOR_GRAYSCALE_MAX), COLOR_GRAYSCALE_MIN);
+    }
+}
+
+// Returns a LUT made from table, which is a buffer or sequence of 256 (gray or all channels),
+// 3x256 (red, green and blue) or 65536 (RGB565 pixels) entries, or else of the gamma curve.
+STATIC mp_obj_t py_image_lut(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_table, ARG_gamma, ARG_contrast, ARG_brightness };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_table, MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_gamma, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_contrast, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_brightness, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+    };
+
+    // Parse args.
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_obj_t table = args[ARG_table].u_obj;
+    mp_buffer_info_t bufinfo;
+    py_lut_obj_t *o;
+
+    if (table == mp_const_none) {
+        o = py_lut_new(LUT_TYPE_CHANNEL);
+        imlib_lut_gamma(&o->lut,
+                        py_helper_arg_to_float(args[ARG_gamma].u_obj, 1.0f),
+                        py_helper_arg_to_float(args[ARG_contrast].u_obj, 1.0f),
+                        py_helper_arg_to_float(args[ARG_brightness].u_obj, 0.0f));
+    } else if (mp_get_buffer(table, &bufinfo, MP_BUFFER_READ)) {
+        if (bufinfo.len == imlib_lut_size(LUT_TYPE_RGB565)) {
+            o = py_lut_new(LUT_TYPE_RGB565);
+        } else if ((bufinfo.len == LUT_CHANNEL_SIZE) || (bufinfo.len == imlib_lut_size(LUT_TYPE_CHANNEL))) {
+            o = py_lut_new(LUT_TYPE_CHANNEL);
+        } else {
+            mp_raise_ValueError(MP_ERROR_TEXT("Expected 256, 768 or 131072 bytes"));
+        }
+
+        for (size_t i = 0, size = imlib_lut_size(o->lut.type); i < size; i += bufinfo.len) {
+            memcpy(o->lut.table + i, bufinfo.buf, bufinfo.len);
+        }
+    } else {
+        size_t len;
+        mp_obj_t *items;
+        mp_obj_get_array(table, &len, &items);
+
+        if (len == 65536) {
+            o = py_lut_new(LUT_TYPE_RGB565);
+            uint16_t *lut_table = (uint16_t *) o->lut.table;
+            for (size_t i = 0; i < len; i++) {
+                lut_table[i] = mp_obj_get_int(items[i]);
+            }
+        } else if (len == LUT_CHANNEL_SIZE) {
+            o = py_lut_new(LUT_TYPE_CHANNEL);
+            for (int c = 0; c < 3; c++) {
+                py_lut_channel_from_obj(table, o->lut.table + (c * LUT_CHANNEL_SIZE));
+            }
+        } else if (len == 3) {
+            o = py_lut_new(LUT_TYPE_CHANNEL);
+            for (int c = 0; c < 3; c++) {
+                py_lut_channel_from_obj(items[c], o->lut.table + (c * LUT_CHANNEL_SIZE));
+            }
+        } else {
+            mp_raise_ValueError(MP_ERROR_TEXT("Expected 256, 3x256 or 65536 entries"));
+        }
+    }
+
+    return o;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_lut_obj, 0, py_image_lut);
+
+STATIC mp_obj_t py_image_apply_lut(mp_obj_t img_obj, mp_obj_t lut_obj) {
+    image_t *image = py_helper_arg_to_image(img_obj, ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
+    PY_ASSERT_TYPE(lut_obj, &py_lut_type);
+    py_lut_obj_t *lut = lut_obj;
+
+    PY_ASSERT_TRUE_MSG((image->pixfmt == PIXFORMAT_GRAYSCALE) || (image->pixfmt == PIXFORMAT_RGB565),
+                       "Image format is not supported!");
+    PY_ASSERT_TRUE_MSG((image->pixfmt == PIXFORMAT_RGB565) || (lut->lut.type == LUT_TYPE_CHANNEL),
+                       "RGB565 LUTs only apply to RGB565 images!");
+
+    imlib_apply_lut(image, &lut->lut);
+    return img_obj;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_image_apply_lut_obj, py_image_apply_lut);
+
+// Develops a packed RAW10/RAW12 image to 8 bits, white (default the full scale) maps to 255.
+STATIC mp_obj_t py_image_develop(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_pixformat, ARG_white, ARG_gains, ARG_gamma, ARG_contrast, ARG_brightness, ARG_copy_to };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_pixformat, MP_ARG_INT, {.u_int = PIXFORMAT_RGB565} },
+        { MP_QSTR_white, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 0} },
+        { MP_QSTR_gains, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_gamma, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_contrast, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_brightness, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_copy_to, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+    };
+
+    // Parse args.
+    image_t *src = py_helper_arg_to_image(pos_args[0], ARG_IMAGE_ANY);
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    PY_ASSERT_TRUE_MSG((src->pixfmt_id == PIXFORMAT_ID_RAW10) || (src->pixfmt_id == PIXFORMAT_ID_RAW12),
+                       "Expected a RAW10 or RAW12 image!");
+
+    image_t dst = {
+        .w = src->w,
+        .h = src->h,
+        .pixfmt = args[ARG_pixformat].u_int,
+    };
+
+    PY_ASSERT_TRUE_MSG((dst.pixfmt == PIXFORMAT_GRAYSCALE) || (dst.pixfmt == PIXFORMAT_RGB565) ||
+                       (dst.pixfmt == PIXFORMAT_BAYER), "Expected GRAYSCALE, RGB565 or BAYER!");
+
+    if (dst.is_bayer) {
+        dst.subfmt_id = src->subfmt_id;
+    }
+
+    int bits = IMAGE_RAW_BITS(src);
+    int white = args[ARG_white].u_int ? args[ARG_white].u_int : ((1 << bits) - 1);
+    float gains[3] = {1.0f, 1.0f, 1.0f};
+
+    if (args[ARG_gains].u_obj != mp_const_none) {
+        mp_obj_t *items;
+        mp_obj_get_array_fixed_n(args[ARG_gains].u_obj, 3, &items);
+        for (int i = 0; i < 3; i++) {
+            gains[i] = mp_obj_get_float(items[i]);
+        }
+    }
+
+    bool copy_to = args[ARG_copy_to].u_obj != mp_const_none;
+    if (copy_to) {
+        dst.data = py_image_output_buffer(args[ARG_copy_to].u_obj, &dst);
+        PY_ASSERT_TRUE_MSG((dst.data != src->data), "Can't copy to the source image!");
+    } else {
+        dst.data = py_helper_image_alloc(image_size(&dst));
+    }
+
+    fb_alloc_mark();
+    uint8_t *luts = fb_alloc(3 << bits, FB_ALLOC_NO_HINT);
+    imlib_raw_luts(luts, bits, white, gains,
+                   py_helper_arg_to_float(args[ARG_gamma].u_obj, 1.0f),
+                   py_helper_arg_to_float(args[ARG_contrast].u_obj, 1.0f),
+                   py_helper_arg_to_float(args[ARG_brightness].u_obj, 0.0f));
+    imlib_raw_develop(&dst, src, luts);
+    fb_alloc_free_till_mark();
+
+    if (copy_to) {
+        py_helper_update_framebuffer(&dst);
+        memcpy(py_image_cobj(args[ARG_copy_to].u_obj), &dst, sizeof(image_t));
+        return args[ARG_copy_to].u_obj;
+    }
+
+    return py_image_from_struct(&dst);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_develop_obj, 1, py_image_develop);
+
+// Returns the (r, g, b) means and maxima of a RAW10/RAW12 image and a histogram of all pixels.
+STATIC mp_obj_t py_image_raw_stats(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_bins, ARG_row_step };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_bins, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 256 } },
+        { MP_QSTR_row_step, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 1 } },
+    };
+
+    // Parse args.
+    image_t *image = py_helper_arg_to_image(pos_args[0], ARG_IMAGE_ANY);
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    PY_ASSERT_TRUE_MSG((image->pixfmt_id == PIXFORMAT_ID_RAW10) || (image->pixfmt_id == PIXFORMAT_ID_RAW12),
+                       "Expected a RAW10 or RAW12 image!");
+
+    int bins = args[ARG_bins].u_int;
+    PY_ASSERT_TRUE_MSG((bins >= 2) && (bins <= (1 << IMAGE_RAW_BITS(image))) && !(bins & (bins - 1)),
+                       "bins must be a power of 2 up to the number of levels!");
+
+    uint32_t mean[3], max[3];
+    fb_alloc_mark();
+    uint32_t *hist = fb_alloc(bins * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    imlib_raw_stats(image, args[ARG_row_step].u_int, mean, max, hist, bins);
+
+    mp_obj_t hist_list = mp_obj_new_list(bins, NULL);
+    for (int i = 0; i < bins; i++) {
+        ((mp_obj_list_t *) hist_list)->items[i] = mp_obj_new_int(hist[i]);
+    }
+
+    fb_alloc_free_till_mark();
+
+    return mp_obj_new_tuple(3, (mp_obj_t []) {
+        mp_obj_new_tuple(3, (mp_obj_t []) {
+            mp_obj_new_int(mean[0]), mp_obj_new_int(mean[1]), mp_obj_new_int(mean[2])
+        }),
+        mp_obj_new_tuple(3, (mp_obj_t []) {
+            mp_obj_new_int(max[0]), mp_obj_new_int(max[1]), mp_obj_new_int(max[2])
+        }),
+        hist_list
+    });
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_raw_stats_obj, 1, py_image_raw_stats);
+
+#endif // IMLIB_ENABLE_ISP_OPS
+
+#ifdef IMLIB_ENABLE_BINARY_OPS
+/////////////////
+// Binary Methods
+/////////////////
+
+STATIC mp_obj_t py_image_binary(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_thresholds, ARG_invert, ARG_zero, ARG_mask, ARG_to_bitmap, ARG_copy, ARG_copy_to };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_thresholds, MP_ARG_OBJ | MP_ARG_REQUIRED, },
+        { MP_QSTR_invert, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+        { MP_QSTR_zero, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+        { MP_QSTR_mask, MP_ARG_OBJ | MP_ARG_KW_ONLY,  {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_to_bitmap, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+        { MP_QSTR_copy, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+        { MP_QSTR_copy_to, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+    };
+
+    // Parse args.
+    image_t *image = py_helper_arg_to_image(pos_args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    bool copy_to = args[ARG_copy_to].u_obj != mp_const_none;
+    args[ARG_copy].u_int |= copy_to;
+
+    if (args[ARG_to_bitmap].u_int && (image->pixfmt != PIXFORMAT_BINARY) &&
+        (args[ARG_zero].u_int || (args[ARG_mask].u_obj != mp_const_none))) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Incompatible arguments!"));
+    }
+
+    if (args[ARG_to_bitmap].u_int && (!args[ARG_copy].u_int)) {
+        switch (image->pixfmt) {
+            case PIXFORMAT_GRAYSCALE: {
+                PY_ASSERT_TRUE_MSG((image->w >= 4), "Can't convert to bitmap in place!");
+                break;
+            }
+            case PIXFORMAT_RGB565: {
+                PY_ASSERT_TRUE_MSG((image->w >= 2), "Can't convert to bitmap in place!");
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+
+    list_t thresholds;
+    list_init(&thresholds, sizeof(color_thresholds_list_lnk_data_t));
+    py_helper_arg_to_thresholds(args[ARG_thresholds].u_obj, &thresholds);
+
+    image_t out;
+    out.w = image->w;
+    out.h = image->h;
+    out.pixfmt = args[ARG_to_bitmap].u_int ? PIXFORMAT_BINARY : image->pixfmt;
+    if (copy_to) {
+        out.data = py_image_output_buffer(args[ARG_copy_to].u_obj, &out);
+        PY_ASSERT_TRUE_MSG((out.data != image->data), "Can't copy to the source image!");
+    } else {
+        out.data = args[ARG_copy].u_int ? py_helper_image_alloc(image_size(&out)) : image->pixels;
+    }
+
+    fb_alloc_mark();
+    image_t *mask = NULL;
+    if (args[ARG_mask].u_obj != mp_const_none) {
+        mask = py_helper_arg_to_image(args[ARG_mask].u_obj, ARG_IMAGE_MUTABLE | ARG_IMAGE_ALLOC);
+    }
+
+    imlib_binary(&out, image, &thresholds, args[ARG_invert].u_int, args[ARG_zero].u_int, mask);
+    fb_alloc_free_till_mark();
+
+    list_free(&thresholds);
+
+    if (args[ARG_to_bitmap].u_int && (!args[ARG_copy].u_int)) {
+        image->pixfmt = PIXFORMAT_BINARY;
+        py_helper_update_framebuffer(&out);
+    }
+
+    if (copy_to) {
+        py_helper_update_framebuffer(&out);
+        memcpy(py_image_cobj(args[ARG_copy_to].u_obj), &out, sizeof(image_t));
+        return args[ARG_copy_to].u_obj;
+    }
+
+    return py_image_from_struct(&out);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_binary_obj, 1, py_image_binary);
+
+STATIC mp_obj_t py_image_invert(mp_obj_t img_obj) {
+    imlib_invert(py_helper_arg_to_image(img_obj, ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE));
+    return img_obj;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_invert_obj, py_image_invert);
+
+STATIC mp_obj_t py_image_b_and(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img =
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
+    image_t *arg_msk =
+        py_helper_keyword_to_image(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
+
+    fb_alloc_mark();
+
+    if (MP_OBJ_IS_STR(args[1])) {
         imlib_b_and(arg_img, mp_obj_str_get_str(args[1]), NULL, 0, arg_msk);
     } else if (MP_OBJ_IS_TYPE(args[1], &py_image_type)) {
         imlib_b_and(arg_img, NULL, py_helper_arg_to_image(args[1], ARG_IMAGE_MUTABLE), 0, arg_msk);
@@ -1843,7 +2611,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_b_and_obj, 2, py_image_b_and);
 
 STATIC mp_obj_t py_image_b_nand(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     image_t *arg_msk =
         py_helper_keyword_to_image(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
 
@@ -1867,7 +2635,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_b_nand_obj, 2, py_image_b_nand);
 
 STATIC mp_obj_t py_image_b_or(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     image_t *arg_msk =
         py_helper_keyword_to_image(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
 
@@ -1891,7 +2659,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_b_or_obj, 2, py_image_b_or);
 
 STATIC mp_obj_t py_image_b_nor(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     image_t *arg_msk =
         py_helper_keyword_to_image(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
 
@@ -1915,7 +2683,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_b_nor_obj, 2, py_image_b_nor);
 
 STATIC mp_obj_t py_image_b_xor(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     image_t *arg_msk =
         py_helper_keyword_to_image(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
 
@@ -1939,7 +2707,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_b_xor_obj, 2, py_image_b_xor);
 
 STATIC mp_obj_t py_image_b_xnor(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     image_t *arg_msk =
         py_helper_keyword_to_image(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
 
@@ -1970,7 +2738,7 @@ static mp_obj_t py_image_binary_morph_op(uint n_args, const mp_obj_t *pos_args,
     };
 
     // Parse args.
-    image_t *image = py_helper_arg_to_image(pos_args[0], ARG_IMAGE_MUTABLE);
+    image_t *image = py_helper_arg_to_image(pos_args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     int ksize = py_helper_arg_to_ksize(pos_args[1]);
     mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
     mp_arg_parse_all(n_args - 2, pos_args + 2, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
@@ -2014,7 +2782,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_close_obj, 2, py_image_close);
 
 STATIC mp_obj_t py_image_replace(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     bool arg_hmirror =
         py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_hmirror), false);
     bool arg_vflip =
@@ -2061,7 +2829,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_replace_obj, 1, py_image_replace);
 
 STATIC mp_obj_t py_image_add(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     image_t *arg_msk =
         py_helper_keyword_to_image(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
 
@@ -2085,7 +2853,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_add_obj, 2, py_image_add);
 
 STATIC mp_obj_t py_image_sub(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     bool arg_reverse =
         py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_reverse), false);
     image_t *arg_msk =
@@ -2111,7 +2879,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_sub_obj, 2, py_image_sub);
 
 STATIC mp_obj_t py_image_min(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     image_t *arg_msk =
         py_helper_keyword_to_image(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
 
@@ -2135,7 +2903,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_min_obj, 2, py_image_min);
 
 STATIC mp_obj_t py_image_max(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     image_t *arg_msk =
         py_helper_keyword_to_image(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
 
@@ -2159,7 +2927,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_max_obj, 2, py_image_max);
 
 STATIC mp_obj_t py_image_difference(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     image_t *arg_msk =
         py_helper_keyword_to_image(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
 
@@ -2183,7 +2951,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_difference_obj, 2, py_image_differenc
 
 STATIC mp_obj_t py_image_blend(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     float arg_alpha =
         py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_alpha), 128) / 256.0f;
     PY_ASSERT_TRUE_MSG((0 <= arg_alpha) && (arg_alpha <= 1), "Error: 0 <= alpha <= 256!");
@@ -2227,7 +2995,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_black_hat_obj, 2, py_image_black_hat)
 
 static mp_obj_t py_image_histeq(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     bool arg_adaptive =
         py_helper_keyword_int(n_args, args, 1, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_adaptive), false);
     float arg_clip_limit =
@@ -2249,7 +3017,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_histeq_obj, 1, py_image_histeq);
 #ifdef IMLIB_ENABLE_MEAN
 STATIC mp_obj_t py_image_mean(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     int arg_ksize =
         py_helper_arg_to_ksize(args[1]);
     bool arg_threshold =
@@ -2272,7 +3040,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_mean_obj, 2, py_image_mean);
 #ifdef IMLIB_ENABLE_MEDIAN
 STATIC mp_obj_t py_image_median(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     int arg_ksize =
         py_helper_arg_to_ksize(args[1]);
     float arg_percentile =
@@ -2298,7 +3066,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_median_obj, 2, py_image_median);
 #ifdef IMLIB_ENABLE_MODE
 STATIC mp_obj_t py_image_mode(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     int arg_ksize =
         py_helper_arg_to_ksize(args[1]);
     bool arg_threshold =
@@ -2321,7 +3089,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_mode_obj, 2, py_image_mode);
 #ifdef IMLIB_ENABLE_MIDPOINT
 STATIC mp_obj_t py_image_midpoint(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     int arg_ksize =
         py_helper_arg_to_ksize(args[1]);
     float arg_bias =
@@ -2347,7 +3115,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_midpoint_obj, 2, py_image_midpoint);
 #ifdef IMLIB_ENABLE_MORPH
 STATIC mp_obj_t py_image_morph(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     int arg_ksize =
         py_helper_arg_to_ksize(args[1]);
 
@@ -2393,7 +3161,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_morph_obj, 3, py_image_morph);
 #ifdef IMLIB_ENABLE_GAUSSIAN
 STATIC mp_obj_t py_image_gaussian(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     int arg_ksize =
         py_helper_arg_to_ksize(args[1]);
 
@@ -2421,7 +3189,10 @@ STATIC mp_obj_t py_image_gaussian(uint n_args, const mp_obj_t *args, mp_map_t *k
         }
     }
 
-    if (py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_unsharp), false)) {
+    bool arg_unsharp =
+        py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_unsharp), false);
+
+    if (arg_unsharp) {
         arg_krn[((n / 2) * n) + (n / 2)] -= arg_m * 2;
         arg_m = -arg_m;
     }
@@ -2439,7 +3210,14 @@ STATIC mp_obj_t py_image_gaussian(uint n_args, const mp_obj_t *args, mp_map_t *k
     image_t *arg_msk =
         py_helper_keyword_to_image(n_args, args, 8, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
 
-    imlib_morph(arg_img, arg_ksize, arg_krn, arg_mul, arg_add, arg_threshold, arg_offset, arg_invert, arg_msk);
+    // Plain blurs are separable.
+    if ((!arg_unsharp) && (arg_mul == (1.0f / arg_m)) && (arg_add == 0.0f) && (!arg_msk)
+        && ((arg_img->pixfmt == PIXFORMAT_GRAYSCALE) || (arg_img->pixfmt == PIXFORMAT_RGB565))) {
+        imlib_gaussian_filter(arg_img, arg_ksize, arg_threshold, arg_offset, arg_invert);
+    } else {
+        imlib_morph(arg_img, arg_ksize, arg_krn, arg_mul, arg_add, arg_threshold, arg_offset, arg_invert, arg_msk);
+    }
+
     fb_alloc_free_till_mark();
     return args[0];
 }
@@ -2449,7 +3227,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_gaussian_obj, 2, py_image_gaussian);
 #ifdef IMLIB_ENABLE_LAPLACIAN
 STATIC mp_obj_t py_image_laplacian(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     int arg_ksize =
         py_helper_arg_to_ksize(args[1]);
 
@@ -2507,7 +3285,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_laplacian_obj, 2, py_image_laplacian)
 #ifdef IMLIB_ENABLE_BILATERAL
 STATIC mp_obj_t py_image_bilateral(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     int arg_ksize =
         py_helper_arg_to_ksize(args[1]);
     float arg_color_sigma =
@@ -2522,16 +3300,297 @@ STATIC mp_obj_t py_image_bilateral(uint n_args, const mp_obj_t *args, mp_map_t *
         py_helper_keyword_int(n_args, args, 6, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_invert), false);
     image_t *arg_msk =
         py_helper_keyword_to_image(n_args, args, 7, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_mask), NULL);
+    bool arg_grid =
+        py_helper_keyword_int(n_args, args, 8, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_grid), false);
 
     fb_alloc_mark();
-    imlib_bilateral_filter(arg_img, arg_ksize, arg_color_sigma, arg_space_sigma, arg_threshold, arg_offset, arg_invert,
-                           arg_msk);
+
+    // The grid doesn't support masks or binary images, these use the exact filter.
+    if (arg_grid && (!arg_msk)
+        && ((arg_img->pixfmt == PIXFORMAT_GRAYSCALE) || (arg_img->pixfmt == PIXFORMAT_RGB565))) {
+        imlib_bilateral_grid(arg_img, arg_ksize, arg_color_sigma, arg_space_sigma, arg_threshold, arg_offset, arg_invert);
+    } else {
+        imlib_bilateral_filter(arg_img, arg_ksize, arg_color_sigma, arg_space_sigma, arg_threshold, arg_offset,
+                               arg_invert, arg_msk);
+    }
+
     fb_alloc_free_till_mark();
     return args[0];
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_bilateral_obj, 2, py_image_bilateral);
 #endif // IMLIB_ENABLE_BILATERAL
 
+// The band memory is gone once chain() returns or raises, don't let the callback keep using it.
+static void py_image_chain_release(py_image_obj_t *band_obj) {
+    memset(&band_obj->_cobj, 0, sizeof(image_t));
+    band_obj->_cobj.pixfmt = PIXFORMAT_INVALID;
+}
+
+static void py_image_chain_cb(image_t *band, void *arg) {
+    mp_obj_t *cb_args = arg;
+    py_image_obj_t *band_obj = MP_OBJ_TO_PTR(cb_args[1]);
+    band_obj->_cobj = *band;
+    mp_call_function_1(cb_args[0], cb_args[1]);
+
+    // The band is written back with its original geometry, so the callback must not
+    // reformat, resize or reallocate it (e.g. with to() or scale()).
+    image_t *out = &band_obj->_cobj;
+    if ((out->w != band->w) || (out->h != band->h) || (out->pixfmt != band->pixfmt) || (out->data != band->data)) {
+        py_image_chain_release(band_obj);
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("The callback must not change the band size or format"));
+    }
+}
+
+// Runs callback(band) on bands of rows copied into fast memory so chained filters
+// only make one pass over the frame buffer. radius must cover all chained kernels.
+STATIC mp_obj_t py_image_chain(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img =
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
+    mp_obj_t arg_cb = args[1];
+    PY_ASSERT_TRUE_MSG(mp_obj_is_callable(arg_cb), "Callback must be callable!");
+    int arg_radius =
+        py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_radius), 1);
+    PY_ASSERT_TRUE_MSG(arg_radius >= 0, "Radius must be >= 0!");
+    int arg_rows =
+        py_helper_keyword_int(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_rows), 16);
+    PY_ASSERT_TRUE_MSG(arg_rows > 0, "Rows must be > 0!");
+
+    mp_obj_t cb_args[2] = { arg_cb, py_image_from_struct(arg_img) };
+
+    fb_alloc_mark();
+    imlib_strip_run(arg_img, arg_radius, arg_rows, py_image_chain_cb, cb_args);
+    fb_alloc_free_till_mark();
+
+    py_image_chain_release(MP_OBJ_TO_PTR(cb_args[1]));
+    return args[0];
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_chain_obj, 2, py_image_chain);
+
+// Pipeline Object //
+// A list of operators compiled once and run band by band on each frame, like chain() but
+// without calling back into Python. The halo radius is the sum of the operator radii.
+typedef struct py_pipeline_obj {
+    mp_obj_base_t base;
+    imlib_pipeline_t pipeline;
+} py_pipeline_obj_t;
+
+static void py_pipeline_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    py_pipeline_obj_t *self = self_in;
+    mp_printf(print,
+              "{\"ops\":%d, \"radius\":%d, \"rows\":%d}",
+              self->pipeline.n_ops,
+              imlib_pipeline_radius(self->pipeline.ops, self->pipeline.n_ops),
+              self->pipeline.rows);
+}
+
+// Ops are tuples of the method name and its positional arguments, e.g. ("median", 1, 0.5).
+static void py_pipeline_parse_op(mp_obj_t arg, imlib_pipeline_op_t *op) {
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_get_array(arg, &len, &items);
+    PY_ASSERT_TRUE_MSG(len >= 1, "Expected an operator tuple!");
+
+    qstr name = mp_obj_str_get_qstr(items[0]);
+    size_t n_args = 1;
+
+    op->ksize = 0;
+    op->threshold = 0;
+    op->arg = 0.5f;
+    op->invert = false;
+    list_init(&op->thresholds, sizeof(color_thresholds_list_lnk_data_t));
+
+    if (0) {
+    #ifdef IMLIB_ENABLE_BINARY_OPS
+    } else if (name == MP_QSTR_binary) {
+        PY_ASSERT_TRUE_MSG(len >= 2, "binary expects thresholds!");
+        op->type = IMLIB_PIPELINE_BINARY;
+        py_helper_arg_to_thresholds(items[1], &op->thresholds);
+        op->invert = (len >= 3) && mp_obj_is_true(items[2]);
+        n_args = 3;
+    } else if (name == MP_QSTR_invert) {
+        op->type = IMLIB_PIPELINE_INVERT;
+    } else if ((name == MP_QSTR_erode) || (name == MP_QSTR_dilate) ||
+               (name == MP_QSTR_open) || (name == MP_QSTR_close)) {
+        op->type = (name == MP_QSTR_erode) ? IMLIB_PIPELINE_ERODE :
+                   (name == MP_QSTR_dilate) ? IMLIB_PIPELINE_DILATE :
+                   (name == MP_QSTR_open) ? IMLIB_PIPELINE_OPEN : IMLIB_PIPELINE_CLOSE;
+        op->threshold = (len >= 3) ? mp_obj_get_int(items[2]) : 0;
+        n_args = 3;
+    #endif
+    #ifdef IMLIB_ENABLE_MEAN
+    } else if (name == MP_QSTR_mean) {
+        op->type = IMLIB_PIPELINE_MEAN;
+        n_args = 2;
+    #endif
+    #ifdef IMLIB_ENABLE_MEDIAN
+    } else if (name == MP_QSTR_median) {
+        op->type = IMLIB_PIPELINE_MEDIAN;
+        n_args = 3;
+    #endif
+    #ifdef IMLIB_ENABLE_MODE
+    } else if (name == MP_QSTR_mode) {
+        op->type = IMLIB_PIPELINE_MODE;
+        n_args = 2;
+    #endif
+    #ifdef IMLIB_ENABLE_MIDPOINT
+    } else if (name == MP_QSTR_midpoint) {
+        op->type = IMLIB_PIPELINE_MIDPOINT;
+        n_args = 3;
+    #endif
+    } else {
+        mp_raise_msg_varg(&mp_type_ValueError, MP_ERROR_TEXT("Unsupported pipeline operator %s"), qstr_str(name));
+    }
+
+    PY_ASSERT_TRUE_MSG(len <= n_args, "Too many operator arguments!");
+
+    if ((op->type != IMLIB_PIPELINE_BINARY) && (op->type != IMLIB_PIPELINE_INVERT)) {
+        PY_ASSERT_TRUE_MSG(len >= 2, "Expected a kernel size!");
+        op->ksize = py_helper_arg_to_ksize(items[1]);
+    }
+
+    if (((op->type == IMLIB_PIPELINE_MEDIAN) || (op->type == IMLIB_PIPELINE_MIDPOINT)) && (len >= 3)) {
+        op->arg = mp_obj_get_float(items[2]);
+        PY_ASSERT_TRUE_MSG((0.0f <= op->arg) && (op->arg <= 1.0f), "Argument must be between 0 and 1!");
+    }
+}
+
+static mp_obj_t py_pipeline_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    enum { ARG_ops, ARG_rows };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_ops, MP_ARG_REQUIRED | MP_ARG_OBJ },
+        { MP_QSTR_rows, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 16 } },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    PY_ASSERT_TRUE_MSG(args[ARG_rows].u_int > 0, "Rows must be > 0!");
+
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_get_array(args[ARG_ops].u_obj, &len, &items);
+
+    py_pipeline_obj_t *self = m_new_obj(py_pipeline_obj_t);
+    self->base.type = type;
+    self->pipeline.n_ops = len;
+    self->pipeline.rows = args[ARG_rows].u_int;
+    self->pipeline.ops = m_new(imlib_pipeline_op_t, len);
+
+    for (size_t i = 0; i < len; i++) {
+        py_pipeline_parse_op(items[i], &self->pipeline.ops[i]);
+    }
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+// Runs the pipeline on the image in place.
+static mp_obj_t py_pipeline_run(mp_obj_t self_in, mp_obj_t img_obj) {
+    py_pipeline_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    image_t *img = py_helper_arg_to_image(img_obj, ARG_IMAGE_MUTABLE);
+
+    fb_alloc_mark();
+    imlib_pipeline_run(img, &self->pipeline);
+    fb_alloc_free_till_mark();
+    return img_obj;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_pipeline_run_obj, py_pipeline_run);
+
+STATIC const mp_rom_map_elem_t py_pipeline_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_run), MP_ROM_PTR(&py_pipeline_run_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(py_pipeline_locals_dict, py_pipeline_locals_dict_table);
+
+STATIC MP_DEFINE_CONST_OBJ_TYPE(
+    py_pipeline_type,
+    MP_QSTR_Pipeline,
+    MP_TYPE_FLAG_NONE,
+    print, py_pipeline_print,
+    make_new, py_pipeline_make_new,
+    locals_dict, &py_pipeline_locals_dict
+    );
+
+// JPEGRate Object //
+// Picks the quality of each compress() from the size of the last one, toward a size per frame
+// and/or a bitrate, for links with a fixed bandwidth.
+typedef struct py_jpeg_rate_obj {
+    mp_obj_base_t base;
+    jpeg_rate_t rate;
+    uint32_t last_us;
+} py_jpeg_rate_obj_t;
+
+static void py_jpeg_rate_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    py_jpeg_rate_obj_t *self = self_in;
+    mp_printf(print,
+              "{\"frame_size\":%u, \"bitrate\":%u, \"quality\":%d}",
+              self->rate.frame_size,
+              self->rate.bitrate,
+              self->rate.quality);
+}
+
+static mp_obj_t py_jpeg_rate_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    enum { ARG_frame_size, ARG_bitrate, ARG_quality_min, ARG_quality_max };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_frame_size, MP_ARG_INT, {.u_int = 0 } },
+        { MP_QSTR_bitrate, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 0 } },
+        { MP_QSTR_quality_min, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 10 } },
+        { MP_QSTR_quality_max, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 90 } },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    PY_ASSERT_TRUE_MSG((args[ARG_frame_size].u_int > 0) || (args[ARG_bitrate].u_int > 0),
+                       "Expected a frame size or a bitrate!");
+    PY_ASSERT_TRUE_MSG((args[ARG_frame_size].u_int >= 0) && (args[ARG_bitrate].u_int >= 0),
+                       "Targets must be >= 0!");
+    PY_ASSERT_TRUE_MSG((1 <= args[ARG_quality_min].u_int)
+                       && (args[ARG_quality_min].u_int <= args[ARG_quality_max].u_int)
+                       && (args[ARG_quality_max].u_int <= 100), "Invalid quality range!");
+
+    py_jpeg_rate_obj_t *self = m_new_obj(py_jpeg_rate_obj_t);
+    self->base.type = type;
+    self->last_us = 0;
+    jpeg_rate_init(&self->rate, args[ARG_frame_size].u_int, args[ARG_bitrate].u_int,
+                   args[ARG_quality_min].u_int, args[ARG_quality_max].u_int);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+// Quality to compress the next frame with.
+static mp_obj_t py_jpeg_rate_quality(mp_obj_t self_in) {
+    py_jpeg_rate_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_int(self->rate.quality);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_jpeg_rate_quality_obj, py_jpeg_rate_quality);
+
+// Learns from the compressed frame (or its size in bytes, 0 if it didn't fit) and returns the
+// quality of the next frame.
+static mp_obj_t py_jpeg_rate_update(mp_obj_t self_in, mp_obj_t frame) {
+    py_jpeg_rate_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    uint32_t size = mp_obj_is_int(frame) ? mp_obj_get_int(frame) :
+                    py_helper_arg_to_image(frame, ARG_IMAGE_ANY)->size;
+
+    uint32_t now_us = mp_hal_ticks_us();
+    uint32_t elapsed_us = self->last_us ? (now_us - self->last_us) : 0;
+    self->last_us = now_us;
+    return mp_obj_new_int(jpeg_rate_update(&self->rate, size, !size, elapsed_us));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_jpeg_rate_update_obj, py_jpeg_rate_update);
+
+STATIC const mp_rom_map_elem_t py_jpeg_rate_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_quality), MP_ROM_PTR(&py_jpeg_rate_quality_obj) },
+    { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&py_jpeg_rate_update_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(py_jpeg_rate_locals_dict, py_jpeg_rate_locals_dict_table);
+
+STATIC MP_DEFINE_CONST_OBJ_TYPE(
+    py_jpeg_rate_type,
+    MP_QSTR_JPEGRate,
+    MP_TYPE_FLAG_NONE,
+    print, py_jpeg_rate_print,
+    make_new, py_jpeg_rate_make_new,
+    locals_dict, &py_jpeg_rate_locals_dict
+    );
+
 ////////////////////
 // Geometric Methods
 ////////////////////
@@ -2539,7 +3598,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_bilateral_obj, 2, py_image_bilateral)
 #ifdef IMLIB_ENABLE_LINPOLAR
 static mp_obj_t py_image_linpolar(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     PY_ASSERT_FALSE_MSG(arg_img->w % 2, "Width must be even!");
     PY_ASSERT_FALSE_MSG(arg_img->h % 2, "Height must be even!");
     bool arg_reverse =
@@ -2556,7 +3615,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_linpolar_obj, 1, py_image_linpolar);
 #ifdef IMLIB_ENABLE_LOGPOLAR
 static mp_obj_t py_image_logpolar(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
     PY_ASSERT_FALSE_MSG(arg_img->w % 2, "Width must be even!");
     PY_ASSERT_FALSE_MSG(arg_img->h % 2, "Height must be even!");
     bool arg_reverse =
@@ -2571,25 +3630,31 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_logpolar_obj, 1, py_image_logpolar);
 #endif // IMLIB_ENABLE_LOGPOLAR
 
 #ifdef IMLIB_ENABLE_LENS_CORR
-STATIC mp_obj_t py_image_lens_corr(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
-    PY_ASSERT_FALSE_MSG(arg_img->w % 2, "Width must be even!");
-    PY_ASSERT_FALSE_MSG(arg_img->h % 2, "Height must be even!");
-    float arg_strength =
+// Parses strength, zoom, x_corr and y_corr.
+static void py_image_lens_corr_args(uint n_args, const mp_obj_t *args, mp_map_t *kw_args, float *lens_args) {
+    lens_args[0] =
         py_helper_keyword_float(n_args, args, 1, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_strength), 1.8f);
-    PY_ASSERT_TRUE_MSG(arg_strength > 0.0f, "Strength must be > 0!");
-    float arg_zoom =
+    PY_ASSERT_TRUE_MSG(lens_args[0] > 0.0f, "Strength must be > 0!");
+    lens_args[1] =
         py_helper_keyword_float(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_zoom), 1.0f);
-    PY_ASSERT_TRUE_MSG(arg_zoom > 0.0f, "Zoom must be > 0!");
+    PY_ASSERT_TRUE_MSG(lens_args[1] > 0.0f, "Zoom must be > 0!");
 
-    float arg_x_corr =
+    lens_args[2] =
         py_helper_keyword_float(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_x_corr), 0.0f);
-    float arg_y_corr =
+    lens_args[3] =
         py_helper_keyword_float(n_args, args, 4, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_y_corr), 0.0f);
+}
+
+STATIC mp_obj_t py_image_lens_corr(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img =
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
+    PY_ASSERT_FALSE_MSG(arg_img->w % 2, "Width must be even!");
+    PY_ASSERT_FALSE_MSG(arg_img->h % 2, "Height must be even!");
+    float lens_args[4];
+    py_image_lens_corr_args(n_args, args, kw_args, lens_args);
 
     fb_alloc_mark();
-    imlib_lens_corr(arg_img, arg_strength, arg_zoom, arg_x_corr, arg_y_corr);
+    imlib_lens_corr(arg_img, lens_args[0], lens_args[1], lens_args[2], lens_args[3]);
     fb_alloc_free_till_mark();
     return args[0];
 }
@@ -2597,37 +3662,287 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_lens_corr_obj, 1, py_image_lens_corr)
 #endif // IMLIB_ENABLE_LENS_CORR
 
 #ifdef IMLIB_ENABLE_ROTATION_CORR
-STATIC mp_obj_t py_image_rotation_corr(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img =
-        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
-    float arg_x_rotation =
+// Parses x_rotation, y_rotation, z_rotation, x_translation, y_translation, zoom, fov and corners.
+static void py_image_rotation_corr_args(uint n_args, const mp_obj_t *args, mp_map_t *kw_args,
+                                        float *rot_args, float **corners) {
+    rot_args[0] =
         IM_DEG2RAD(py_helper_keyword_float(n_args, args, 1, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_x_rotation), 0.0f));
-    float arg_y_rotation =
+    rot_args[1] =
         IM_DEG2RAD(py_helper_keyword_float(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_y_rotation), 0.0f));
-    float arg_z_rotation =
+    rot_args[2] =
         IM_DEG2RAD(py_helper_keyword_float(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_z_rotation), 0.0f));
-    float arg_x_translation =
+    rot_args[3] =
         py_helper_keyword_float(n_args, args, 4, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_x_translation), 0.0f);
-    float arg_y_translation =
+    rot_args[4] =
         py_helper_keyword_float(n_args, args, 5, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_y_translation), 0.0f);
-    float arg_zoom =
+    rot_args[5] =
         py_helper_keyword_float(n_args, args, 6, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_zoom), 1.0f);
-    PY_ASSERT_TRUE_MSG(arg_zoom > 0.0f, "Zoom must be > 0!");
-    float arg_fov =
+    PY_ASSERT_TRUE_MSG(rot_args[5] > 0.0f, "Zoom must be > 0!");
+    rot_args[6] =
         IM_DEG2RAD(py_helper_keyword_float(n_args, args, 7, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_fov), 60.0f));
-    PY_ASSERT_TRUE_MSG((0.0f < arg_fov) && (arg_fov < 180.0f), "FOV must be > 0 and < 180!");
-    float *arg_corners = py_helper_keyword_corner_array(n_args, args, 8, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_corners));
+    PY_ASSERT_TRUE_MSG((0.0f < rot_args[6]) && (rot_args[6] < 180.0f), "FOV must be > 0 and < 180!");
+    *corners = py_helper_keyword_corner_array(n_args, args, 8, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_corners));
+}
+
+STATIC mp_obj_t py_image_rotation_corr(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img =
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
+    float rot_args[7], *arg_corners;
+    py_image_rotation_corr_args(n_args, args, kw_args, rot_args, &arg_corners);
+
+    fb_alloc_mark();
+    imlib_rotation_corr(arg_img,
+                        rot_args[0], rot_args[1], rot_args[2],
+                        rot_args[3], rot_args[4],
+                        rot_args[5], rot_args[6], arg_corners);
+    fb_alloc_free_till_mark();
+    return args[0];
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_rotation_corr_obj, 1, py_image_rotation_corr);
+#endif // IMLIB_ENABLE_ROTATION_CORR
+
+#ifdef IMLIB_ENABLE_REMAP
+// Remap Object //
+static const mp_obj_type_t py_remap_type;
+
+typedef struct py_remap_obj {
+    mp_obj_base_t base;
+    remap_t map;
+} py_remap_obj_t;
+
+static void py_remap_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    py_remap_obj_t *self = self_in;
+    mp_printf(print, "{\"w\":%d, \"h\":%d, \"cell\":%d}", self->map.w, self->map.h, REMAP_CELL);
+}
+
+static py_remap_obj_t *py_remap_new(int w, int h) {
+    py_remap_obj_t *o = m_new_obj(py_remap_obj_t);
+    o->base.type = &py_remap_type;
+    imlib_remap_init(&o->map, w, h);
+    o->map.grid = m_new(int32_t, imlib_remap_size(&o->map) / sizeof(int32_t));
+    return o;
+}
+
+static mp_obj_t py_remap_compose(mp_obj_t self_in, mp_obj_t other_in) {
+    py_remap_obj_t *self = self_in;
+    PY_ASSERT_TYPE(other_in, &py_remap_type);
+    py_remap_obj_t *other = other_in;
+    PY_ASSERT_TRUE_MSG((self->map.w == other->map.w) && (self->map.h == other->map.h),
+                       "Remap sizes must match!");
+
+    py_remap_obj_t *o = py_remap_new(self->map.w, self->map.h);
+    imlib_remap_compose(&o->map, &self->map, &other->map);
+    return o;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_remap_compose_obj, py_remap_compose);
+
+STATIC const mp_rom_map_elem_t py_remap_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_compose), MP_ROM_PTR(&py_remap_compose_obj) }
+};
+
+STATIC MP_DEFINE_CONST_DICT(py_remap_locals_dict, py_remap_locals_dict_table);
+
+STATIC MP_DEFINE_CONST_OBJ_TYPE(
+    py_remap_type,
+    MP_QSTR_remap,
+    MP_TYPE_FLAG_NONE,
+    print, py_remap_print,
+    locals_dict, &py_remap_locals_dict
+    );
+
+#ifdef IMLIB_ENABLE_LENS_CORR
+STATIC mp_obj_t py_image_lens_corr_map(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img =
+        py_helper_arg_to_image(args[0], ARG_IMAGE_ANY);
+    float lens_args[4];
+    py_image_lens_corr_args(n_args, args, kw_args, lens_args);
+
+    py_remap_obj_t *o = py_remap_new(arg_img->w, arg_img->h);
+    imlib_remap_lens_corr(&o->map, lens_args[0], lens_args[1], lens_args[2], lens_args[3]);
+    return o;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_lens_corr_map_obj, 1, py_image_lens_corr_map);
+#endif // IMLIB_ENABLE_LENS_CORR
+
+#ifdef IMLIB_ENABLE_ROTATION_CORR
+STATIC mp_obj_t py_image_rotation_corr_map(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img =
+        py_helper_arg_to_image(args[0], ARG_IMAGE_ANY);
+    float rot_args[7], *arg_corners;
+    py_image_rotation_corr_args(n_args, args, kw_args, rot_args, &arg_corners);
+
+    py_remap_obj_t *o = py_remap_new(arg_img->w, arg_img->h);
+    fb_alloc_mark();
+    imlib_remap_rotation_corr(&o->map,
+                              rot_args[0], rot_args[1], rot_args[2],
+                              rot_args[3], rot_args[4],
+                              rot_args[5], rot_args[6], arg_corners);
+    fb_alloc_free_till_mark();
+    return o;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_rotation_corr_map_obj, 1, py_image_rotation_corr_map);
+#endif // IMLIB_ENABLE_ROTATION_CORR
+
+STATIC mp_obj_t py_image_remap(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img =
+        py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
+    PY_ASSERT_TYPE(args[1], &py_remap_type);
+    py_remap_obj_t *arg_map = args[1];
+    PY_ASSERT_TRUE_MSG((arg_map->map.w == arg_img->w) && (arg_map->map.h == arg_img->h),
+                       "Remap size must match the image!");
+    bool arg_bilinear =
+        py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_bilinear), true);
+
+    fb_alloc_mark();
+    imlib_remap(arg_img, &arg_map->map, arg_bilinear);
+    fb_alloc_free_till_mark();
+    return args[0];
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_remap_obj, 2, py_image_remap);
+
+// Parses a 3x3 or 2x3 (affine) matrix, nested or flat, into a row major 3x3 matrix.
+static void py_image_warp_matrix(mp_obj_t arg, float *T) {
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_get_array(arg, &len, &items);
+
+    T[6] = 0.0f;
+    T[7] = 0.0f;
+    T[8] = 1.0f;
+
+    if ((len == 2) || (len == 3)) {
+        for (size_t i = 0; i < len; i++) {
+            py_helper_arg_to_float_array(items[i], T + (i * 3), 3);
+        }
+    } else if ((len == 6) || (len == 9)) {
+        for (size_t i = 0; i < len; i++) {
+            T[i] = mp_obj_get_float(items[i]);
+        }
+    } else {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Expected a 3x3 or 2x3 matrix!"));
+    }
+}
+
+// Returns a new out_size image with each pixel pulled from the roi through the matrix, only
+// the output pixels are computed.
+STATIC mp_obj_t py_image_warp(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_matrix, ARG_roi, ARG_out_size, ARG_bilinear, ARG_copy_to };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_matrix, MP_ARG_OBJ | MP_ARG_REQUIRED, },
+        { MP_QSTR_roi, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_out_size, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_bilinear, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = true} },
+        { MP_QSTR_copy_to, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+    };
+
+    // Parse args.
+    image_t *src = py_helper_arg_to_image(pos_args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    PY_ASSERT_TRUE_MSG((src->pixfmt == PIXFORMAT_BINARY) || (src->pixfmt == PIXFORMAT_GRAYSCALE) ||
+                       (src->pixfmt == PIXFORMAT_RGB565), "Expected a BINARY, GRAYSCALE or RGB565 image!");
+
+    float T[9];
+    py_image_warp_matrix(args[ARG_matrix].u_obj, T);
+    rectangle_t roi = py_helper_arg_to_roi(args[ARG_roi].u_obj, src);
+
+    image_t dst = {
+        .w = roi.w,
+        .h = roi.h,
+        .pixfmt = src->pixfmt,
+    };
+
+    if (args[ARG_out_size].u_obj != mp_const_none) {
+        mp_obj_t *size;
+        mp_obj_get_array_fixed_n(args[ARG_out_size].u_obj, 2, &size);
+        dst.w = mp_obj_get_int(size[0]);
+        dst.h = mp_obj_get_int(size[1]);
+        PY_ASSERT_TRUE_MSG((dst.w > 0) && (dst.h > 0), "Invalid output size!");
+    }
+
+    bool copy_to = args[ARG_copy_to].u_obj != mp_const_none;
+    if (copy_to) {
+        dst.data = py_image_output_buffer(args[ARG_copy_to].u_obj, &dst);
+        PY_ASSERT_TRUE_MSG((dst.data != src->data), "Can't copy to the source image!");
+    } else {
+        dst.data = py_helper_image_alloc(image_size(&dst));
+    }
+
+    fb_alloc_mark();
+    imlib_warp(&dst, src, &roi, T, args[ARG_bilinear].u_bool);
+    fb_alloc_free_till_mark();
+
+    if (copy_to) {
+        py_helper_update_framebuffer(&dst);
+        memcpy(py_image_cobj(args[ARG_copy_to].u_obj), &dst, sizeof(image_t));
+        return args[ARG_copy_to].u_obj;
+    }
+
+    return py_image_from_struct(&dst);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_warp_obj, 2, py_image_warp);
+
+// Returns a remap of the image size pulling pixels through the matrix, e.g. to compose with
+// a lens correction map.
+STATIC mp_obj_t py_image_warp_map(mp_obj_t img_obj, mp_obj_t matrix_obj) {
+    image_t *arg_img = py_helper_arg_to_image(img_obj, ARG_IMAGE_ANY);
+    float T[9];
+    py_image_warp_matrix(matrix_obj, T);
+
+    py_remap_obj_t *o = py_remap_new(arg_img->w, arg_img->h);
+    imlib_remap_homography(&o->map, T);
+    return o;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_image_warp_map_obj, py_image_warp_map);
+
+// Overlays a thermal image colored by the palette. The registration is a remap object of the
+// image size or a matrix, both mapping image pixels to thermal pixels, computed once.
+STATIC mp_obj_t py_image_fuse(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_thermal, ARG_registration, ARG_alpha, ARG_color_palette, ARG_alpha_palette, ARG_bilinear };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_thermal, MP_ARG_OBJ | MP_ARG_REQUIRED, },
+        { MP_QSTR_registration, MP_ARG_OBJ | MP_ARG_REQUIRED, },
+        { MP_QSTR_alpha, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 128} },
+        { MP_QSTR_color_palette, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_INT(COLOR_PALETTE_IRONBOW)} },
+        { MP_QSTR_alpha_palette, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_bilinear, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = true} },
+    };
+
+    // Parse args.
+    image_t *image = py_helper_arg_to_image(pos_args[0], ARG_IMAGE_MUTABLE | ARG_IMAGE_WRITE);
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    PY_ASSERT_TRUE_MSG(image->pixfmt == PIXFORMAT_RGB565, "Expected an RGB565 image!");
+
+    image_t *thermal = py_helper_arg_to_image(args[ARG_thermal].u_obj, ARG_IMAGE_GRAYSCALE);
+
+    if ((args[ARG_alpha].u_int < 0) || (256 < args[ARG_alpha].u_int)) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("0 <= alpha <= 256!"));
+    }
+
+    const uint16_t *color_palette = py_helper_arg_to_palette(args[ARG_color_palette].u_obj, PIXFORMAT_RGB565);
+    const uint8_t *alpha_palette = py_helper_arg_to_palette(args[ARG_alpha_palette].u_obj, PIXFORMAT_GRAYSCALE);
+
+    remap_t *map = NULL;
+    float T[9];
+
+    if (mp_obj_is_type(args[ARG_registration].u_obj, &py_remap_type)) {
+        py_remap_obj_t *arg_map = args[ARG_registration].u_obj;
+        PY_ASSERT_TRUE_MSG((arg_map->map.w == image->w) && (arg_map->map.h == image->h),
+                           "Remap size must match the image!");
+        map = &arg_map->map;
+    } else {
+        py_image_warp_matrix(args[ARG_registration].u_obj, T);
+    }
 
     fb_alloc_mark();
-    imlib_rotation_corr(arg_img,
-                        arg_x_rotation, arg_y_rotation, arg_z_rotation,
-                        arg_x_translation, arg_y_translation,
-                        arg_zoom, arg_fov, arg_corners);
+    imlib_fuse(image, thermal, map, T, args[ARG_bilinear].u_bool,
+               args[ARG_alpha].u_int, color_palette, alpha_palette);
     fb_alloc_free_till_mark();
-    return args[0];
+    return pos_args[0];
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_rotation_corr_obj, 1, py_image_rotation_corr);
-#endif // IMLIB_ENABLE_ROTATION_CORR
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_fuse_obj, 3, py_image_fuse);
+#endif // IMLIB_ENABLE_REMAP
 
 //////////////
 // Get Methods
@@ -2715,7 +4030,7 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
 static mp_obj_t py_image_get_similarity(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     enum {
         ARG_image, ARG_x, ARG_y, ARG_x_scale, ARG_y_scale, ARG_roi,
-        ARG_channel, ARG_alpha, ARG_color_palette, ARG_alpha_palette, ARG_hint, ARG_dssim
+        ARG_channel, ARG_alpha, ARG_color_palette, ARG_alpha_palette, ARG_hint, ARG_dssim, ARG_step
     };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_image, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_rom_obj = MP_ROM_NONE} },
@@ -2730,6 +4045,7 @@ static mp_obj_t py_image_get_similarity(uint n_args, const mp_obj_t *pos_args, m
         { MP_QSTR_alpha_palette, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
         { MP_QSTR_hint, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = 0 } },
         { MP_QSTR_dssim, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false } },
+        { MP_QSTR_step, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = 8 } },
     };
 
     // Parse args.
@@ -2749,6 +4065,10 @@ static mp_obj_t py_image_get_similarity(uint n_args, const mp_obj_t *pos_args, m
         mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Alpha ranges between 0 and 256"));
     }
 
+    if (args[ARG_step].u_int < 1) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Step must be > 0"));
+    }
+
     float x_scale = 1.0f;
     float y_scale = 1.0f;
     py_helper_arg_to_scale(args[ARG_x_scale].u_obj, args[ARG_y_scale].u_obj, &x_scale, &y_scale);
@@ -2760,7 +4080,7 @@ static mp_obj_t py_image_get_similarity(uint n_args, const mp_obj_t *pos_args, m
     imlib_get_similarity(image, other, args[ARG_x].u_int, args[ARG_y].u_int, x_scale, y_scale, &roi,
                          args[ARG_channel].u_int, args[ARG_alpha].u_int, color_palette, alpha_palette,
                          args[ARG_hint].u_int | IMAGE_HINT_BLACK_BACKGROUND, args[ARG_dssim].u_bool,
-                         &avg, &std, &min, &max);
+                         args[ARG_step].u_int, &avg, &std, &min, &max);
 
     fb_alloc_free_till_mark();
     py_similarity_obj_t *o = m_new_obj(py_similarity_obj_t);
@@ -3530,6 +4850,30 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
     locals_dict, &py_histogram_locals_dict
     );
 
+static mp_obj_t py_histogram_new(pixformat_t pixfmt, histogram_t *hist) {
+    py_histogram_obj_t *o = m_new_obj(py_histogram_obj_t);
+    o->base.type = &py_histogram_type;
+    o->pixfmt = pixfmt;
+
+    o->LBins = mp_obj_new_list(hist->LBinCount, NULL);
+    o->ABins = mp_obj_new_list(hist->ABinCount, NULL);
+    o->BBins = mp_obj_new_list(hist->BBinCount, NULL);
+
+    for (int i = 0; i < hist->LBinCount; i++) {
+        ((mp_obj_list_t *) o->LBins)->items[i] = mp_obj_new_float(hist->LBins[i]);
+    }
+
+    for (int i = 0; i < hist->ABinCount; i++) {
+        ((mp_obj_list_t *) o->ABins)->items[i] = mp_obj_new_float(hist->ABins[i]);
+    }
+
+    for (int i = 0; i < hist->BBinCount; i++) {
+        ((mp_obj_list_t *) o->BBins)->items[i] = mp_obj_new_float(hist->BBins[i]);
+    }
+
+    return o;
+}
+
 static mp_obj_t py_image_get_histogram(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
 
@@ -3542,6 +4886,11 @@ static mp_obj_t py_image_get_histogram(uint n_args, const mp_obj_t *args, mp_map
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 3, kw_args, &roi);
 
+    int x_stride = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_x_stride), 1);
+    PY_ASSERT_TRUE_MSG(x_stride > 0, "x_stride must not be zero.");
+    int y_stride = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_y_stride), 1);
+    PY_ASSERT_TRUE_MSG(y_stride > 0, "y_stride must not be zero.");
+
     histogram_t hist;
     switch (arg_img->pixfmt) {
         case PIXFORMAT_BINARY: {
@@ -3556,7 +4905,7 @@ static mp_obj_t py_image_get_histogram(uint n_args, const mp_obj_t *args, mp_map
             hist.LBins = fb_alloc(hist.LBinCount * sizeof(float), FB_ALLOC_NO_HINT);
             hist.ABins = NULL;
             hist.BBins = NULL;
-            imlib_get_histogram(&hist, arg_img, &roi, &thresholds, invert, other);
+            imlib_get_histogram(&hist, arg_img, &roi, &thresholds, invert, other, x_stride, y_stride);
             list_free(&thresholds);
             break;
         }
@@ -3572,7 +4921,7 @@ static mp_obj_t py_image_get_histogram(uint n_args, const mp_obj_t *args, mp_map
             hist.LBins = fb_alloc(hist.LBinCount * sizeof(float), FB_ALLOC_NO_HINT);
             hist.ABins = NULL;
             hist.BBins = NULL;
-            imlib_get_histogram(&hist, arg_img, &roi, &thresholds, invert, other);
+            imlib_get_histogram(&hist, arg_img, &roi, &thresholds, invert, other, x_stride, y_stride);
             list_free(&thresholds);
             break;
         }
@@ -3596,7 +4945,7 @@ static mp_obj_t py_image_get_histogram(uint n_args, const mp_obj_t *args, mp_map
             hist.LBins = fb_alloc(hist.LBinCount * sizeof(float), FB_ALLOC_NO_HINT);
             hist.ABins = fb_alloc(hist.ABinCount * sizeof(float), FB_ALLOC_NO_HINT);
             hist.BBins = fb_alloc(hist.BBinCount * sizeof(float), FB_ALLOC_NO_HINT);
-            imlib_get_histogram(&hist, arg_img, &roi, &thresholds, invert, other);
+            imlib_get_histogram(&hist, arg_img, &roi, &thresholds, invert, other, x_stride, y_stride);
             list_free(&thresholds);
             break;
         }
@@ -3605,32 +4954,46 @@ static mp_obj_t py_image_get_histogram(uint n_args, const mp_obj_t *args, mp_map
         }
     }
 
-    py_histogram_obj_t *o = m_new_obj(py_histogram_obj_t);
-    o->base.type = &py_histogram_type;
-    o->pixfmt = arg_img->pixfmt;
-
-    o->LBins = mp_obj_new_list(hist.LBinCount, NULL);
-    o->ABins = mp_obj_new_list(hist.ABinCount, NULL);
-    o->BBins = mp_obj_new_list(hist.BBinCount, NULL);
-
-    for (int i = 0; i < hist.LBinCount; i++) {
-        ((mp_obj_list_t *) o->LBins)->items[i] = mp_obj_new_float(hist.LBins[i]);
-    }
-
-    for (int i = 0; i < hist.ABinCount; i++) {
-        ((mp_obj_list_t *) o->ABins)->items[i] = mp_obj_new_float(hist.ABins[i]);
-    }
-
-    for (int i = 0; i < hist.BBinCount; i++) {
-        ((mp_obj_list_t *) o->BBins)->items[i] = mp_obj_new_float(hist.BBins[i]);
-    }
-
+    mp_obj_t o = py_histogram_new(arg_img->pixfmt, &hist);
     fb_alloc_free_till_mark();
 
     return o;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_get_histogram_obj, 1, py_image_get_histogram);
 
+static mp_obj_t py_statistics_new(pixformat_t pixfmt, statistics_t *stats) {
+    py_statistics_obj_t *o = m_new_obj(py_statistics_obj_t);
+    o->base.type = &py_statistics_type;
+    o->pixfmt = pixfmt;
+
+    o->LMean = mp_obj_new_int(stats->LMean);
+    o->LMedian = mp_obj_new_int(stats->LMedian);
+    o->LMode = mp_obj_new_int(stats->LMode);
+    o->LSTDev = mp_obj_new_int(stats->LSTDev);
+    o->LMin = mp_obj_new_int(stats->LMin);
+    o->LMax = mp_obj_new_int(stats->LMax);
+    o->LLQ = mp_obj_new_int(stats->LLQ);
+    o->LUQ = mp_obj_new_int(stats->LUQ);
+    o->AMean = mp_obj_new_int(stats->AMean);
+    o->AMedian = mp_obj_new_int(stats->AMedian);
+    o->AMode = mp_obj_new_int(stats->AMode);
+    o->ASTDev = mp_obj_new_int(stats->ASTDev);
+    o->AMin = mp_obj_new_int(stats->AMin);
+    o->AMax = mp_obj_new_int(stats->AMax);
+    o->ALQ = mp_obj_new_int(stats->ALQ);
+    o->AUQ = mp_obj_new_int(stats->AUQ);
+    o->BMean = mp_obj_new_int(stats->BMean);
+    o->BMedian = mp_obj_new_int(stats->BMedian);
+    o->BMode = mp_obj_new_int(stats->BMode);
+    o->BSTDev = mp_obj_new_int(stats->BSTDev);
+    o->BMin = mp_obj_new_int(stats->BMin);
+    o->BMax = mp_obj_new_int(stats->BMax);
+    o->BLQ = mp_obj_new_int(stats->BLQ);
+    o->BUQ = mp_obj_new_int(stats->BUQ);
+
+    return o;
+}
+
 static mp_obj_t py_image_get_statistics(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
 
@@ -3643,6 +5006,11 @@ static mp_obj_t py_image_get_statistics(uint n_args, const mp_obj_t *args, mp_ma
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 3, kw_args, &roi);
 
+    int x_stride = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_x_stride), 1);
+    PY_ASSERT_TRUE_MSG(x_stride > 0, "x_stride must not be zero.");
+    int y_stride = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_y_stride), 1);
+    PY_ASSERT_TRUE_MSG(y_stride > 0, "y_stride must not be zero.");
+
     histogram_t hist;
     switch (arg_img->pixfmt) {
         case PIXFORMAT_BINARY: {
@@ -3657,7 +5025,7 @@ static mp_obj_t py_image_get_statistics(uint n_args, const mp_obj_t *args, mp_ma
             hist.LBins = fb_alloc(hist.LBinCount * sizeof(float), FB_ALLOC_NO_HINT);
             hist.ABins = NULL;
             hist.BBins = NULL;
-            imlib_get_histogram(&hist, arg_img, &roi, &thresholds, invert, other);
+            imlib_get_histogram(&hist, arg_img, &roi, &thresholds, invert, other, x_stride, y_stride);
             list_free(&thresholds);
             break;
         }
@@ -3673,7 +5041,7 @@ static mp_obj_t py_image_get_statistics(uint n_args, const mp_obj_t *args, mp_ma
             hist.LBins = fb_alloc(hist.LBinCount * sizeof(float), FB_ALLOC_NO_HINT);
             hist.ABins = NULL;
             hist.BBins = NULL;
-            imlib_get_histogram(&hist, arg_img, &roi, &thresholds, invert, other);
+            imlib_get_histogram(&hist, arg_img, &roi, &thresholds, invert, other, x_stride, y_stride);
             list_free(&thresholds);
             break;
         }
@@ -3697,7 +5065,7 @@ static mp_obj_t py_image_get_statistics(uint n_args, const mp_obj_t *args, mp_ma
             hist.LBins = fb_alloc(hist.LBinCount * sizeof(float), FB_ALLOC_NO_HINT);
             hist.ABins = fb_alloc(hist.ABinCount * sizeof(float), FB_ALLOC_NO_HINT);
             hist.BBins = fb_alloc(hist.BBinCount * sizeof(float), FB_ALLOC_NO_HINT);
-            imlib_get_histogram(&hist, arg_img, &roi, &thresholds, invert, other);
+            imlib_get_histogram(&hist, arg_img, &roi, &thresholds, invert, other, x_stride, y_stride);
             list_free(&thresholds);
             break;
         }
@@ -3710,38 +5078,184 @@ static mp_obj_t py_image_get_statistics(uint n_args, const mp_obj_t *args, mp_ma
     imlib_get_statistics(&stats, arg_img->pixfmt, &hist);
     fb_alloc_free_till_mark();
 
-    py_statistics_obj_t *o = m_new_obj(py_statistics_obj_t);
-    o->base.type = &py_statistics_type;
-    o->pixfmt = arg_img->pixfmt;
+    return py_statistics_new(arg_img->pixfmt, &stats);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_get_statistics_obj, 1, py_image_get_statistics);
 
-    o->LMean = mp_obj_new_int(stats.LMean);
-    o->LMedian = mp_obj_new_int(stats.LMedian);
-    o->LMode = mp_obj_new_int(stats.LMode);
-    o->LSTDev = mp_obj_new_int(stats.LSTDev);
-    o->LMin = mp_obj_new_int(stats.LMin);
-    o->LMax = mp_obj_new_int(stats.LMax);
-    o->LLQ = mp_obj_new_int(stats.LLQ);
-    o->LUQ = mp_obj_new_int(stats.LUQ);
-    o->AMean = mp_obj_new_int(stats.AMean);
-    o->AMedian = mp_obj_new_int(stats.AMedian);
-    o->AMode = mp_obj_new_int(stats.AMode);
-    o->ASTDev = mp_obj_new_int(stats.ASTDev);
-    o->AMin = mp_obj_new_int(stats.AMin);
-    o->AMax = mp_obj_new_int(stats.AMax);
-    o->ALQ = mp_obj_new_int(stats.ALQ);
-    o->AUQ = mp_obj_new_int(stats.AUQ);
-    o->BMean = mp_obj_new_int(stats.BMean);
-    o->BMedian = mp_obj_new_int(stats.BMedian);
-    o->BMode = mp_obj_new_int(stats.BMode);
-    o->BSTDev = mp_obj_new_int(stats.BSTDev);
-    o->BMin = mp_obj_new_int(stats.BMin);
-    o->BMax = mp_obj_new_int(stats.BMax);
-    o->BLQ = mp_obj_new_int(stats.BLQ);
-    o->BUQ = mp_obj_new_int(stats.BUQ);
+#ifdef IMLIB_ENABLE_HISTOGRAM_CACHE
+// Histogram Cache Object //
+typedef struct py_histogram_cache_obj {
+    mp_obj_base_t base;
+    mp_obj_t img;
+    histogram_cache_t cache;
+} py_histogram_cache_obj_t;
+
+static void py_histogram_cache_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    py_histogram_cache_obj_t *self = self_in;
+    mp_printf(print,
+              "{\"tile\":%d, \"l_bins\":%d, \"a_bins\":%d, \"b_bins\":%d}",
+              self->cache.tile,
+              self->cache.LBinCount,
+              self->cache.ABinCount,
+              self->cache.BBinCount);
+}
+
+// Computes the ROI histogram into fb_alloc memory, the caller frees it.
+static void py_histogram_cache_get(py_histogram_cache_obj_t *self, uint n_args, const mp_obj_t *args,
+                                   mp_map_t *kw_args, histogram_t *hist) {
+    image_t *arg_img = py_helper_arg_to_image(self->img, ARG_IMAGE_MUTABLE);
+
+    if ((arg_img->w != self->cache.w) || (arg_img->h != self->cache.h) || (arg_img->pixfmt != self->cache.pixfmt)) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Image changed, rebuild the histogram cache"));
+    }
+
+    rectangle_t roi;
+    py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
+
+    hist->LBinCount = self->cache.LBinCount;
+    hist->ABinCount = self->cache.ABinCount;
+    hist->BBinCount = self->cache.BBinCount;
+    hist->LBins = fb_alloc(hist->LBinCount * sizeof(float), FB_ALLOC_NO_HINT);
+    hist->ABins = hist->ABinCount ? fb_alloc(hist->ABinCount * sizeof(float), FB_ALLOC_NO_HINT) : NULL;
+    hist->BBins = hist->BBinCount ? fb_alloc(hist->BBinCount * sizeof(float), FB_ALLOC_NO_HINT) : NULL;
+    imlib_histogram_cache_get(&self->cache, hist, arg_img, &roi);
+}
+
+static mp_obj_t py_histogram_cache_get_histogram(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    py_histogram_cache_obj_t *self = args[0];
+
+    histogram_t hist;
+    fb_alloc_mark();
+    py_histogram_cache_get(self, n_args, args, kw_args, &hist);
+    mp_obj_t o = py_histogram_new(self->cache.pixfmt, &hist);
+    fb_alloc_free_till_mark();
 
     return o;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_get_statistics_obj, 1, py_image_get_statistics);
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_histogram_cache_get_histogram_obj, 1, py_histogram_cache_get_histogram);
+
+static mp_obj_t py_histogram_cache_get_statistics(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    py_histogram_cache_obj_t *self = args[0];
+
+    histogram_t hist;
+    fb_alloc_mark();
+    py_histogram_cache_get(self, n_args, args, kw_args, &hist);
+    statistics_t stats;
+    imlib_get_statistics(&stats, self->cache.pixfmt, &hist);
+    fb_alloc_free_till_mark();
+
+    return py_statistics_new(self->cache.pixfmt, &stats);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_histogram_cache_get_statistics_obj, 1, py_histogram_cache_get_statistics);
+
+STATIC const mp_rom_map_elem_t py_histogram_cache_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_get_hist), MP_ROM_PTR(&py_histogram_cache_get_histogram_obj) },
+    { MP_ROM_QSTR(MP_QSTR_get_histogram), MP_ROM_PTR(&py_histogram_cache_get_histogram_obj) },
+    { MP_ROM_QSTR(MP_QSTR_get_stats), MP_ROM_PTR(&py_histogram_cache_get_statistics_obj) },
+    { MP_ROM_QSTR(MP_QSTR_get_statistics), MP_ROM_PTR(&py_histogram_cache_get_statistics_obj) }
+};
+
+STATIC MP_DEFINE_CONST_DICT(py_histogram_cache_locals_dict, py_histogram_cache_locals_dict_table);
+
+STATIC MP_DEFINE_CONST_OBJ_TYPE(
+    py_histogram_cache_type,
+    MP_QSTR_histogram_cache,
+    MP_TYPE_FLAG_NONE,
+    print, py_histogram_cache_print,
+    locals_dict, &py_histogram_cache_locals_dict
+    );
+
+static mp_obj_t py_image_get_histogram_cache(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
+
+    int tile = py_helper_keyword_int(n_args, args, 1, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_tile), 32);
+    PY_ASSERT_TRUE_MSG(tile >= 1, "tile must be >= 1");
+
+    int l_bins = 0, a_bins = 0, b_bins = 0;
+    switch (arg_img->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            int bins = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_bins),
+                                             (COLOR_BINARY_MAX - COLOR_BINARY_MIN + 1));
+            PY_ASSERT_TRUE_MSG(bins >= 2, "bins must be >= 2");
+            l_bins = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_l_bins), bins);
+            PY_ASSERT_TRUE_MSG(l_bins >= 2, "l_bins must be >= 2");
+            break;
+        }
+        case PIXFORMAT_GRAYSCALE: {
+            int bins = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_bins),
+                                             (COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN + 1));
+            PY_ASSERT_TRUE_MSG(bins >= 2, "bins must be >= 2");
+            l_bins = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_l_bins), bins);
+            PY_ASSERT_TRUE_MSG(l_bins >= 2, "l_bins must be >= 2");
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            l_bins = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_bins),
+                                           (COLOR_L_MAX - COLOR_L_MIN + 1));
+            PY_ASSERT_TRUE_MSG(l_bins >= 2, "bins must be >= 2");
+            l_bins = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_l_bins), l_bins);
+            PY_ASSERT_TRUE_MSG(l_bins >= 2, "l_bins must be >= 2");
+            a_bins = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_bins),
+                                           (COLOR_A_MAX - COLOR_A_MIN + 1));
+            PY_ASSERT_TRUE_MSG(a_bins >= 2, "bins must be >= 2");
+            a_bins = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_a_bins), a_bins);
+            PY_ASSERT_TRUE_MSG(a_bins >= 2, "a_bins must be >= 2");
+            b_bins = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_bins),
+                                           (COLOR_B_MAX - COLOR_B_MIN + 1));
+            PY_ASSERT_TRUE_MSG(b_bins >= 2, "bins must be >= 2");
+            b_bins = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_b_bins), b_bins);
+            PY_ASSERT_TRUE_MSG(b_bins >= 2, "b_bins must be >= 2");
+            break;
+        }
+        default: {
+            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Unsupported pixel format"));
+        }
+    }
+
+    py_histogram_cache_obj_t *o = m_new_obj(py_histogram_cache_obj_t);
+    o->base.type = &py_histogram_cache_type;
+    o->img = args[0];
+    imlib_histogram_cache_init(&o->cache, arg_img, tile, l_bins, a_bins, b_bins);
+    o->cache.data = m_new(uint32_t, imlib_histogram_cache_size(&o->cache) / sizeof(uint32_t));
+
+    fb_alloc_mark();
+    imlib_histogram_cache_build(&o->cache, arg_img);
+    fb_alloc_free_till_mark();
+
+    return o;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_get_histogram_cache_obj, 1, py_image_get_histogram_cache);
+#endif // IMLIB_ENABLE_HISTOGRAM_CACHE
+
+static mp_obj_t py_image_fingerprint(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_ANY);
+
+    rectangle_t roi;
+    py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
+
+    int tile = py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_tile), 0);
+    PY_ASSERT_TRUE_MSG(tile >= 0, "tile must be >= 0");
+
+    // Compressed images are hashed as a whole.
+    if ((!tile) || arg_img->is_compressed) {
+        return mp_obj_new_int_from_uint(image_crc32(arg_img, &roi));
+    }
+
+    size_t n = image_fingerprint_size(&roi, tile);
+    mp_obj_list_t *list = mp_obj_new_list(n, NULL);
+
+    fb_alloc_mark();
+    uint32_t *hashes = fb_alloc(n * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    image_fingerprint(arg_img, &roi, tile, hashes);
+
+    for (size_t i = 0; i < n; i++) {
+        list->items[i] = mp_obj_new_int_from_uint(hashes[i]);
+    }
+
+    fb_alloc_free_till_mark();
+    return list;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_fingerprint_obj, 1, py_image_fingerprint);
 
 // Line Object //
 #define py_line_obj_size    8
@@ -3922,13 +5436,16 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_get_regression_obj, 2, py_image_get_r
 
 // Blob Object //
 #define py_blob_obj_size    12
+// Results are kept packed, the Python objects are created when a field is read.
 typedef struct py_blob_obj {
     mp_obj_base_t base;
-    mp_obj_t corners;
-    mp_obj_t min_corners;
-    mp_obj_t x, y, w, h, pixels, cx, cy, rotation, code, count, perimeter, roundness;
-    mp_obj_t x_hist_bins;
-    mp_obj_t y_hist_bins;
+    rectangle_t rect;
+    point_t corners[4];
+    point_t min_corners[4];
+    uint32_t pixels, perimeter, code, count;
+    float cx, cy, rotation, roundness;
+    uint16_t x_hist_bins_count, y_hist_bins_count;
+    uint16_t hist_bins[];   // x_hist_bins followed by y_hist_bins.
 } py_blob_obj_t;
 
 static void py_blob_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
@@ -3937,18 +5454,35 @@ static void py_blob_print(const mp_print_t *print, mp_obj_t self_in, mp_print_ki
               "{\"x\":%d, \"y\":%d, \"w\":%d, \"h\":%d,"
               " \"pixels\":%d, \"cx\":%d, \"cy\":%d, \"rotation\":%f, \"code\":%d, \"count\":%d,"
               " \"perimeter\":%d, \"roundness\":%f}",
-              mp_obj_get_int(self->x),
-              mp_obj_get_int(self->y),
-              mp_obj_get_int(self->w),
-              mp_obj_get_int(self->h),
-              mp_obj_get_int(self->pixels),
-              fast_roundf(mp_obj_get_float(self->cx)),
-              fast_roundf(mp_obj_get_float(self->cy)),
-              (double) mp_obj_get_float(self->rotation),
-              mp_obj_get_int(self->code),
-              mp_obj_get_int(self->count),
-              mp_obj_get_int(self->perimeter),
-              (double) mp_obj_get_float(self->roundness));
+              self->rect.x,
+              self->rect.y,
+              self->rect.w,
+              self->rect.h,
+              self->pixels,
+              fast_roundf(self->cx),
+              fast_roundf(self->cy),
+              (double) self->rotation,
+              self->code,
+              self->count,
+              self->perimeter,
+              (double) self->roundness);
+}
+
+static mp_obj_t py_blob_field(py_blob_obj_t *self, size_t index) {
+    switch (index) {
+        case 0: return mp_obj_new_int(self->rect.x);
+        case 1: return mp_obj_new_int(self->rect.y);
+        case 2: return mp_obj_new_int(self->rect.w);
+        case 3: return mp_obj_new_int(self->rect.h);
+        case 4: return mp_obj_new_int(self->pixels);
+        case 5: return mp_obj_new_int(fast_roundf(self->cx));
+        case 6: return mp_obj_new_int(fast_roundf(self->cy));
+        case 7: return mp_obj_new_float(self->rotation);
+        case 8: return mp_obj_new_int(self->code);
+        case 9: return mp_obj_new_int(self->count);
+        case 10: return mp_obj_new_int(self->perimeter);
+        default: return mp_obj_new_float(self->roundness);
+    }
 }
 
 static mp_obj_t py_blob_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t value) {
@@ -3961,138 +5495,144 @@ static mp_obj_t py_blob_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t value)
                 mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("only slices with step=1 (aka None) are supported"));
             }
             mp_obj_tuple_t *result = mp_obj_new_tuple(slice.stop - slice.start, NULL);
-            mp_seq_copy(result->items, &(self->x) + slice.start, result->len, mp_obj_t);
+            for (size_t i = 0; i < result->len; i++) {
+                result->items[i] = py_blob_field(self, slice.start + i);
+            }
             return result;
         }
-        switch (mp_get_index(self->base.type, py_blob_obj_size, index, false)) {
-            case 0: return self->x;
-            case 1: return self->y;
-            case 2: return self->w;
-            case 3: return self->h;
-            case 4: return self->pixels;
-            case 5: return mp_obj_new_int(fast_roundf(mp_obj_get_float(self->cx)));
-            case 6: return mp_obj_new_int(fast_roundf(mp_obj_get_float(self->cy)));
-            case 7: return self->rotation;
-            case 8: return self->code;
-            case 9: return self->count;
-            case 10: return self->perimeter;
-            case 11: return self->roundness;
-        }
+        return py_blob_field(self, mp_get_index(self->base.type, py_blob_obj_size, index, false));
     }
     return MP_OBJ_NULL; // op not supported
 }
 
+static mp_obj_t py_blob_new_corners(point_t *corners) {
+    return mp_obj_new_tuple(4, (mp_obj_t []) {
+        mp_obj_new_tuple(2, (mp_obj_t []) {mp_obj_new_int(corners[0].x), mp_obj_new_int(corners[0].y)}),
+        mp_obj_new_tuple(2, (mp_obj_t []) {mp_obj_new_int(corners[1].x), mp_obj_new_int(corners[1].y)}),
+        mp_obj_new_tuple(2, (mp_obj_t []) {mp_obj_new_int(corners[2].x), mp_obj_new_int(corners[2].y)}),
+        mp_obj_new_tuple(2, (mp_obj_t []) {mp_obj_new_int(corners[3].x), mp_obj_new_int(corners[3].y)})
+    });
+}
+
+static mp_obj_t py_blob_new_hist_bins(uint16_t *bins, size_t count) {
+    mp_obj_list_t *list = mp_obj_new_list(count, NULL);
+    for (size_t i = 0; i < count; i++) {
+        list->items[i] = mp_obj_new_int(bins[i]);
+    }
+    return list;
+}
+
 mp_obj_t py_blob_corners(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->corners;
+    return py_blob_new_corners(((py_blob_obj_t *) self_in)->corners);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_corners_obj, py_blob_corners);
 
 mp_obj_t py_blob_min_corners(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->min_corners;
+    return py_blob_new_corners(((py_blob_obj_t *) self_in)->min_corners);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_min_corners_obj, py_blob_min_corners);
 
 mp_obj_t py_blob_rect(mp_obj_t self_in) {
-    return mp_obj_new_tuple(4, (mp_obj_t []) {((py_blob_obj_t *) self_in)->x,
-                                              ((py_blob_obj_t *) self_in)->y,
-                                              ((py_blob_obj_t *) self_in)->w,
-                                              ((py_blob_obj_t *) self_in)->h});
+    return mp_obj_new_tuple(4, (mp_obj_t []) {py_blob_field(self_in, 0),
+                                              py_blob_field(self_in, 1),
+                                              py_blob_field(self_in, 2),
+                                              py_blob_field(self_in, 3)});
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_rect_obj, py_blob_rect);
 
 mp_obj_t py_blob_x(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->x;
+    return mp_obj_new_int(((py_blob_obj_t *) self_in)->rect.x);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_x_obj, py_blob_x);
 
 mp_obj_t py_blob_y(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->y;
+    return mp_obj_new_int(((py_blob_obj_t *) self_in)->rect.y);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_y_obj, py_blob_y);
 
 mp_obj_t py_blob_w(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->w;
+    return mp_obj_new_int(((py_blob_obj_t *) self_in)->rect.w);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_w_obj, py_blob_w);
 
 mp_obj_t py_blob_h(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->h;
+    return mp_obj_new_int(((py_blob_obj_t *) self_in)->rect.h);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_h_obj, py_blob_h);
 
 mp_obj_t py_blob_pixels(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->pixels;
+    return mp_obj_new_int(((py_blob_obj_t *) self_in)->pixels);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_pixels_obj, py_blob_pixels);
 
 mp_obj_t py_blob_cx(mp_obj_t self_in) {
-    return mp_obj_new_int(fast_roundf(mp_obj_get_float(((py_blob_obj_t *) self_in)->cx)));
+    return mp_obj_new_int(fast_roundf(((py_blob_obj_t *) self_in)->cx));
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_cx_obj, py_blob_cx);
 
 mp_obj_t py_blob_cxf(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->cx;
+    return mp_obj_new_float(((py_blob_obj_t *) self_in)->cx);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_cxf_obj, py_blob_cxf);
 
 mp_obj_t py_blob_cy(mp_obj_t self_in) {
-    return mp_obj_new_int(fast_roundf(mp_obj_get_float(((py_blob_obj_t *) self_in)->cy)));
+    return mp_obj_new_int(fast_roundf(((py_blob_obj_t *) self_in)->cy));
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_cy_obj, py_blob_cy);
 
 mp_obj_t py_blob_cyf(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->cy;
+    return mp_obj_new_float(((py_blob_obj_t *) self_in)->cy);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_cyf_obj, py_blob_cyf);
 
 mp_obj_t py_blob_rotation(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->rotation;
+    return mp_obj_new_float(((py_blob_obj_t *) self_in)->rotation);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_rotation_obj, py_blob_rotation);
 
 mp_obj_t py_blob_rotation_deg(mp_obj_t self_in) {
-    return mp_obj_new_int(IM_RAD2DEG(mp_obj_get_float(((py_blob_obj_t *) self_in)->rotation)));
+    return mp_obj_new_int(IM_RAD2DEG(((py_blob_obj_t *) self_in)->rotation));
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_rotation_deg_obj, py_blob_rotation_deg);
 
 mp_obj_t py_blob_rotation_rad(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->rotation;
+    return mp_obj_new_float(((py_blob_obj_t *) self_in)->rotation);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_rotation_rad_obj, py_blob_rotation_rad);
 
 mp_obj_t py_blob_code(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->code;
+    return mp_obj_new_int(((py_blob_obj_t *) self_in)->code);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_code_obj, py_blob_code);
 
 mp_obj_t py_blob_count(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->count;
+    return mp_obj_new_int(((py_blob_obj_t *) self_in)->count);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_count_obj, py_blob_count);
 
 mp_obj_t py_blob_perimeter(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->perimeter;
+    return mp_obj_new_int(((py_blob_obj_t *) self_in)->perimeter);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_perimeter_obj, py_blob_perimeter);
 
 mp_obj_t py_blob_roundness(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->roundness;
+    return mp_obj_new_float(((py_blob_obj_t *) self_in)->roundness);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_roundness_obj, py_blob_roundness);
 
 mp_obj_t py_blob_elongation(mp_obj_t self_in) {
-    return mp_obj_new_float(1 - mp_obj_get_float(((py_blob_obj_t *) self_in)->roundness));
+    return mp_obj_new_float(1 - ((py_blob_obj_t *) self_in)->roundness);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_elongation_obj, py_blob_elongation);
 
 mp_obj_t py_blob_area(mp_obj_t self_in) {
-    return mp_obj_new_int(mp_obj_get_int(((py_blob_obj_t *) self_in)->w) * mp_obj_get_int(((py_blob_obj_t *) self_in)->h));
+    return mp_obj_new_int(((py_blob_obj_t *) self_in)->rect.w * ((py_blob_obj_t *) self_in)->rect.h);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_area_obj, py_blob_area);
 
 mp_obj_t py_blob_density(mp_obj_t self_in) {
-    int area = mp_obj_get_int(((py_blob_obj_t *) self_in)->w) * mp_obj_get_int(((py_blob_obj_t *) self_in)->h);
-    int pixels = mp_obj_get_int(((py_blob_obj_t *) self_in)->pixels);
+    int area = ((py_blob_obj_t *) self_in)->rect.w * ((py_blob_obj_t *) self_in)->rect.h;
+    int pixels = ((py_blob_obj_t *) self_in)->pixels;
     return mp_obj_new_float(IM_DIV(pixels, ((float) area)));
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_density_obj, py_blob_density);
@@ -4102,60 +5642,50 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_density_obj, py_blob_density);
 // Rect-perimeter versus pixels (e.g. blob area) -> Basically the same as the above with a different scale factor.
 // Rect-perimeter versus perimeter -> Basically the same as the above with a different scale factor.
 mp_obj_t py_blob_compactness(mp_obj_t self_in) {
-    int pixels = mp_obj_get_int(((py_blob_obj_t *) self_in)->pixels);
-    float perimeter = mp_obj_get_int(((py_blob_obj_t *) self_in)->perimeter);
+    int pixels = ((py_blob_obj_t *) self_in)->pixels;
+    float perimeter = ((py_blob_obj_t *) self_in)->perimeter;
     return mp_obj_new_float(IM_DIV((pixels * 4 * M_PI), (perimeter * perimeter)));
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_compactness_obj, py_blob_compactness);
 
 mp_obj_t py_blob_solidity(mp_obj_t self_in) {
-    mp_obj_t *corners, *p0, *p1, *p2, *p3;
-    mp_obj_get_array_fixed_n(((py_blob_obj_t *) self_in)->min_corners, 4, &corners);
-    mp_obj_get_array_fixed_n(corners[0], 2, &p0);
-    mp_obj_get_array_fixed_n(corners[1], 2, &p1);
-    mp_obj_get_array_fixed_n(corners[2], 2, &p2);
-    mp_obj_get_array_fixed_n(corners[3], 2, &p3);
+    point_t *corners = ((py_blob_obj_t *) self_in)->min_corners;
 
     int x0, y0, x1, y1, x2, y2, x3, y3;
-    x0 = mp_obj_get_int(p0[0]);
-    y0 = mp_obj_get_int(p0[1]);
-    x1 = mp_obj_get_int(p1[0]);
-    y1 = mp_obj_get_int(p1[1]);
-    x2 = mp_obj_get_int(p2[0]);
-    y2 = mp_obj_get_int(p2[1]);
-    x3 = mp_obj_get_int(p3[0]);
-    y3 = mp_obj_get_int(p3[1]);
+    x0 = corners[0].x;
+    y0 = corners[0].y;
+    x1 = corners[1].x;
+    y1 = corners[1].y;
+    x2 = corners[2].x;
+    y2 = corners[2].y;
+    x3 = corners[3].x;
+    y3 = corners[3].y;
 
     // Shoelace Formula
     float min_area = (((x0 * y1) + (x1 * y2) + (x2 * y3) + (x3 * y0)) - ((y0 * x1) + (y1 * x2) + (y2 * x3) + (y3 * x0))) / 2.0f;
-    int pixels = mp_obj_get_int(((py_blob_obj_t *) self_in)->pixels);
+    int pixels = ((py_blob_obj_t *) self_in)->pixels;
     return mp_obj_new_float(IM_MIN(IM_DIV(pixels, min_area), 1));
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_solidity_obj, py_blob_solidity);
 
 mp_obj_t py_blob_convexity(mp_obj_t self_in) {
-    mp_obj_t *corners, *p0, *p1, *p2, *p3;
-    mp_obj_get_array_fixed_n(((py_blob_obj_t *) self_in)->min_corners, 4, &corners);
-    mp_obj_get_array_fixed_n(corners[0], 2, &p0);
-    mp_obj_get_array_fixed_n(corners[1], 2, &p1);
-    mp_obj_get_array_fixed_n(corners[2], 2, &p2);
-    mp_obj_get_array_fixed_n(corners[3], 2, &p3);
+    point_t *corners = ((py_blob_obj_t *) self_in)->min_corners;
 
     int x0, y0, x1, y1, x2, y2, x3, y3;
-    x0 = mp_obj_get_int(p0[0]);
-    y0 = mp_obj_get_int(p0[1]);
-    x1 = mp_obj_get_int(p1[0]);
-    y1 = mp_obj_get_int(p1[1]);
-    x2 = mp_obj_get_int(p2[0]);
-    y2 = mp_obj_get_int(p2[1]);
-    x3 = mp_obj_get_int(p3[0]);
-    y3 = mp_obj_get_int(p3[1]);
+    x0 = corners[0].x;
+    y0 = corners[0].y;
+    x1 = corners[1].x;
+    y1 = corners[1].y;
+    x2 = corners[2].x;
+    y2 = corners[2].y;
+    x3 = corners[3].x;
+    y3 = corners[3].y;
 
     float d0 = fast_sqrtf(((x0 - x1) * (x0 - x1)) + ((y0 - y1) * (y0 - y1)));
     float d1 = fast_sqrtf(((x1 - x2) * (x1 - x2)) + ((y1 - y2) * (y1 - y2)));
     float d2 = fast_sqrtf(((x2 - x3) * (x2 - x3)) + ((y2 - y3) * (y2 - y3)));
     float d3 = fast_sqrtf(((x3 - x0) * (x3 - x0)) + ((y3 - y0) * (y3 - y0)));
-    int perimeter = mp_obj_get_int(((py_blob_obj_t *) self_in)->perimeter);
+    int perimeter = ((py_blob_obj_t *) self_in)->perimeter;
     return mp_obj_new_float(IM_MIN(IM_DIV(d0 + d1 + d2 + d3, perimeter), 1));
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_convexity_obj, py_blob_convexity);
@@ -4165,32 +5695,29 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_convexity_obj, py_blob_convexity);
 // Min rect-perimeter versus perimeter -> Above
 
 mp_obj_t py_blob_x_hist_bins(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->x_hist_bins;
+    py_blob_obj_t *self = self_in;
+    return py_blob_new_hist_bins(self->hist_bins, self->x_hist_bins_count);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_x_hist_bins_obj, py_blob_x_hist_bins);
 
 mp_obj_t py_blob_y_hist_bins(mp_obj_t self_in) {
-    return ((py_blob_obj_t *) self_in)->y_hist_bins;
+    py_blob_obj_t *self = self_in;
+    return py_blob_new_hist_bins(self->hist_bins + self->x_hist_bins_count, self->y_hist_bins_count);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_y_hist_bins_obj, py_blob_y_hist_bins);
 
 mp_obj_t py_blob_major_axis_line(mp_obj_t self_in) {
-    mp_obj_t *corners, *p0, *p1, *p2, *p3;
-    mp_obj_get_array_fixed_n(((py_blob_obj_t *) self_in)->min_corners, 4, &corners);
-    mp_obj_get_array_fixed_n(corners[0], 2, &p0);
-    mp_obj_get_array_fixed_n(corners[1], 2, &p1);
-    mp_obj_get_array_fixed_n(corners[2], 2, &p2);
-    mp_obj_get_array_fixed_n(corners[3], 2, &p3);
+    point_t *corners = ((py_blob_obj_t *) self_in)->min_corners;
 
     int x0, y0, x1, y1, x2, y2, x3, y3;
-    x0 = mp_obj_get_int(p0[0]);
-    y0 = mp_obj_get_int(p0[1]);
-    x1 = mp_obj_get_int(p1[0]);
-    y1 = mp_obj_get_int(p1[1]);
-    x2 = mp_obj_get_int(p2[0]);
-    y2 = mp_obj_get_int(p2[1]);
-    x3 = mp_obj_get_int(p3[0]);
-    y3 = mp_obj_get_int(p3[1]);
+    x0 = corners[0].x;
+    y0 = corners[0].y;
+    x1 = corners[1].x;
+    y1 = corners[1].y;
+    x2 = corners[2].x;
+    y2 = corners[2].y;
+    x3 = corners[3].x;
+    y3 = corners[3].y;
 
     int m0x = (x0 + x1) / 2;
     int m0y = (y0 + y1) / 2;
@@ -4219,22 +5746,17 @@ mp_obj_t py_blob_major_axis_line(mp_obj_t self_in) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_major_axis_line_obj, py_blob_major_axis_line);
 
 mp_obj_t py_blob_minor_axis_line(mp_obj_t self_in) {
-    mp_obj_t *corners, *p0, *p1, *p2, *p3;
-    mp_obj_get_array_fixed_n(((py_blob_obj_t *) self_in)->min_corners, 4, &corners);
-    mp_obj_get_array_fixed_n(corners[0], 2, &p0);
-    mp_obj_get_array_fixed_n(corners[1], 2, &p1);
-    mp_obj_get_array_fixed_n(corners[2], 2, &p2);
-    mp_obj_get_array_fixed_n(corners[3], 2, &p3);
+    point_t *corners = ((py_blob_obj_t *) self_in)->min_corners;
 
     int x0, y0, x1, y1, x2, y2, x3, y3;
-    x0 = mp_obj_get_int(p0[0]);
-    y0 = mp_obj_get_int(p0[1]);
-    x1 = mp_obj_get_int(p1[0]);
-    y1 = mp_obj_get_int(p1[1]);
-    x2 = mp_obj_get_int(p2[0]);
-    y2 = mp_obj_get_int(p2[1]);
-    x3 = mp_obj_get_int(p3[0]);
-    y3 = mp_obj_get_int(p3[1]);
+    x0 = corners[0].x;
+    y0 = corners[0].y;
+    x1 = corners[1].x;
+    y1 = corners[1].y;
+    x2 = corners[2].x;
+    y2 = corners[2].y;
+    x3 = corners[3].x;
+    y3 = corners[3].y;
 
     int m0x = (x0 + x1) / 2;
     int m0y = (y0 + y1) / 2;
@@ -4259,26 +5781,21 @@ mp_obj_t py_blob_minor_axis_line(mp_obj_t self_in) {
                                                   mp_obj_new_int(m3x),
                                                   mp_obj_new_int(m3y)});
     }
-}
-STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_minor_axis_line_obj, py_blob_minor_axis_line);
-
-mp_obj_t py_blob_enclosing_circle(mp_obj_t self_in) {
-    mp_obj_t *corners, *p0, *p1, *p2, *p3;
-    mp_obj_get_array_fixed_n(((py_blob_obj_t *) self_in)->min_corners, 4, &corners);
-    mp_obj_get_array_fixed_n(corners[0], 2, &p0);
-    mp_obj_get_array_fixed_n(corners[1], 2, &p1);
-    mp_obj_get_array_fixed_n(corners[2], 2, &p2);
-    mp_obj_get_array_fixed_n(corners[3], 2, &p3);
-
-    int x0, y0, x1, y1, x2, y2, x3, y3;
-    x0 = mp_obj_get_int(p0[0]);
-    y0 = mp_obj_get_int(p0[1]);
-    x1 = mp_obj_get_int(p1[0]);
-    y1 = mp_obj_get_int(p1[1]);
-    x2 = mp_obj_get_int(p2[0]);
-    y2 = mp_obj_get_int(p2[1]);
-    x3 = mp_obj_get_int(p3[0]);
-    y3 = mp_obj_get_int(p3[1]);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_minor_axis_line_obj, py_blob_minor_axis_line);
+
+mp_obj_t py_blob_enclosing_circle(mp_obj_t self_in) {
+    point_t *corners = ((py_blob_obj_t *) self_in)->min_corners;
+
+    int x0, y0, x1, y1, x2, y2, x3, y3;
+    x0 = corners[0].x;
+    y0 = corners[0].y;
+    x1 = corners[1].x;
+    y1 = corners[1].y;
+    x2 = corners[2].x;
+    y2 = corners[2].y;
+    x3 = corners[3].x;
+    y3 = corners[3].y;
 
     int cx = (x0 + x1 + x2 + x3) / 4;
     int cy = (y0 + y1 + y2 + y3) / 4;
@@ -4296,22 +5813,17 @@ mp_obj_t py_blob_enclosing_circle(mp_obj_t self_in) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_blob_enclosing_circle_obj, py_blob_enclosing_circle);
 
 mp_obj_t py_blob_enclosed_ellipse(mp_obj_t self_in) {
-    mp_obj_t *corners, *p0, *p1, *p2, *p3;
-    mp_obj_get_array_fixed_n(((py_blob_obj_t *) self_in)->min_corners, 4, &corners);
-    mp_obj_get_array_fixed_n(corners[0], 2, &p0);
-    mp_obj_get_array_fixed_n(corners[1], 2, &p1);
-    mp_obj_get_array_fixed_n(corners[2], 2, &p2);
-    mp_obj_get_array_fixed_n(corners[3], 2, &p3);
+    point_t *corners = ((py_blob_obj_t *) self_in)->min_corners;
 
     int x0, y0, x1, y1, x2, y2, x3, y3;
-    x0 = mp_obj_get_int(p0[0]);
-    y0 = mp_obj_get_int(p0[1]);
-    x1 = mp_obj_get_int(p1[0]);
-    y1 = mp_obj_get_int(p1[1]);
-    x2 = mp_obj_get_int(p2[0]);
-    y2 = mp_obj_get_int(p2[1]);
-    x3 = mp_obj_get_int(p3[0]);
-    y3 = mp_obj_get_int(p3[1]);
+    x0 = corners[0].x;
+    y0 = corners[0].y;
+    x1 = corners[1].x;
+    y1 = corners[1].y;
+    x2 = corners[2].x;
+    y2 = corners[2].y;
+    x3 = corners[3].x;
+    y3 = corners[3].y;
 
     int m0x = (x0 + x1) / 2;
     int m0y = (y0 + y1) / 2;
@@ -4397,61 +5909,86 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
     locals_dict, &py_blob_locals_dict
     );
 
-#define NEW_CORNER_TUPLE(corners, index) \
-    mp_obj_new_tuple(2, (mp_obj_t []) {mp_obj_new_int(corners[(index)].x), mp_obj_new_int(corners[(index)].y)})
-
 static py_blob_obj_t *py_blob_new(find_blobs_list_lnk_data_t *blob) {
-    point_t min_corners[4];
+    size_t hist_bins_count = blob->x_hist_bins_count + blob->y_hist_bins_count;
 
-    py_blob_obj_t *o = m_new_obj(py_blob_obj_t);
+    py_blob_obj_t *o = m_malloc(sizeof(py_blob_obj_t) + (hist_bins_count * sizeof(uint16_t)));
     o->base.type = &py_blob_type;
 
-    o->x = mp_obj_new_int(blob->rect.x);
-    o->y = mp_obj_new_int(blob->rect.y);
-    o->w = mp_obj_new_int(blob->rect.w);
-    o->h = mp_obj_new_int(blob->rect.h);
-
-    o->cx = mp_obj_new_float(blob->centroid_x);
-    o->cy = mp_obj_new_float(blob->centroid_y);
-
-    o->pixels = mp_obj_new_int(blob->pixels);
-    o->rotation = mp_obj_new_float(blob->rotation);
-
-    o->code = mp_obj_new_int(blob->code);
-    o->count = mp_obj_new_int(blob->count);
+    o->rect = blob->rect;
 
-    o->perimeter = mp_obj_new_int(blob->perimeter);
-    o->roundness = mp_obj_new_float(blob->roundness);
+    for (int i = 0; i < 4; i++) {
+        o->corners[i] = blob->corners[(FIND_BLOBS_CORNERS_RESOLUTION * i) / 4];
+    }
 
-    o->x_hist_bins = mp_obj_new_list(blob->x_hist_bins_count, NULL);
-    o->y_hist_bins = mp_obj_new_list(blob->y_hist_bins_count, NULL);
+    point_min_area_rectangle(blob->corners, o->min_corners, FIND_BLOBS_CORNERS_RESOLUTION);
 
-    o->corners = mp_obj_new_tuple(4, (mp_obj_t []) {
-        NEW_CORNER_TUPLE(blob->corners, ((FIND_BLOBS_CORNERS_RESOLUTION * 0) / 4)),
-        NEW_CORNER_TUPLE(blob->corners, ((FIND_BLOBS_CORNERS_RESOLUTION * 1) / 4)),
-        NEW_CORNER_TUPLE(blob->corners, ((FIND_BLOBS_CORNERS_RESOLUTION * 2) / 4)),
-        NEW_CORNER_TUPLE(blob->corners, ((FIND_BLOBS_CORNERS_RESOLUTION * 3) / 4))
-    });
+    o->pixels = blob->pixels;
+    o->perimeter = blob->perimeter;
+    o->code = blob->code;
+    o->count = blob->count;
 
-    point_min_area_rectangle(blob->corners, min_corners, FIND_BLOBS_CORNERS_RESOLUTION);
+    o->cx = blob->centroid_x;
+    o->cy = blob->centroid_y;
+    o->rotation = blob->rotation;
+    o->roundness = blob->roundness;
 
-    o->min_corners = mp_obj_new_tuple(4, (mp_obj_t []) {
-        NEW_CORNER_TUPLE(min_corners, 0),
-        NEW_CORNER_TUPLE(min_corners, 1),
-        NEW_CORNER_TUPLE(min_corners, 2),
-        NEW_CORNER_TUPLE(min_corners, 3)
-    });
+    o->x_hist_bins_count = blob->x_hist_bins_count;
+    o->y_hist_bins_count = blob->y_hist_bins_count;
 
     for (int i = 0; i < blob->x_hist_bins_count; i++) {
-        ((mp_obj_list_t *) o->x_hist_bins)->items[i] = mp_obj_new_int(blob->x_hist_bins[i]);
+        o->hist_bins[i] = blob->x_hist_bins[i];
     }
 
     for (int i = 0; i < blob->y_hist_bins_count; i++) {
-        ((mp_obj_list_t *) o->y_hist_bins)->items[i] = mp_obj_new_int(blob->y_hist_bins[i]);
+        o->hist_bins[blob->x_hist_bins_count + i] = blob->y_hist_bins[i];
     }
 
     return o;
 }
+// Returns the find_blobs() properties needed by a list of blob method names.
+static unsigned int py_blob_arg_to_properties(mp_obj_t arg) {
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_get_array(arg, &len, &items);
+    unsigned int properties = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        qstr name = mp_obj_str_get_qstr(items[i]);
+
+        if (!mp_map_lookup((mp_map_t *) &py_blob_locals_dict.map, MP_OBJ_NEW_QSTR(name), MP_MAP_LOOKUP)) {
+            mp_raise_msg_varg(&mp_type_ValueError, MP_ERROR_TEXT("Unknown blob property %q"), name);
+        }
+
+        switch (name) {
+            // These use the min area rect of all the corners.
+            case MP_QSTR_min_corners:
+            case MP_QSTR_solidity:
+            case MP_QSTR_convexity:
+            case MP_QSTR_major_axis_line:
+            case MP_QSTR_minor_axis_line:
+            case MP_QSTR_enclosing_circle:
+            case MP_QSTR_enclosed_ellipse: {
+                properties |= FIND_BLOBS_PROP_CORNERS;
+                break;
+            }
+            case MP_QSTR_rotation:
+            case MP_QSTR_rotation_deg:
+            case MP_QSTR_rotation_rad:
+            case MP_QSTR_roundness:
+            case MP_QSTR_elongation: {
+                properties |= FIND_BLOBS_PROP_MOMENTS;
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+
+    return properties;
+}
+
 static bool py_image_find_blobs_threshold_cb(void *fun_obj, find_blobs_list_lnk_data_t *blob) {
     return mp_obj_is_true(mp_call_function_1(fun_obj, py_blob_new(blob)));
 }
@@ -4496,9 +6033,16 @@ static mp_obj_t py_image_find_blobs(uint n_args, const mp_obj_t *args, mp_map_t
         py_helper_keyword_int(n_args, args, 12, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_x_hist_bins_max), 0);
     unsigned int y_hist_bins_max =
         py_helper_keyword_int(n_args, args, 13, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_y_hist_bins_max), 0);
+    // Blob methods the script uses, properties no method needs are not computed.
+    mp_obj_t properties_obj =
+        py_helper_keyword_object(n_args, args, 14, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_properties), NULL);
+    unsigned int properties = properties_obj ? py_blob_arg_to_properties(properties_obj) : FIND_BLOBS_PROP_ALL;
 
+    // The result links come from a pool on the frame buffer stack instead of the heap.
     list_t out;
+    pool_t pool;
     fb_alloc_mark();
+    list_pool_alloc(&pool, sizeof(find_blobs_list_lnk_data_t));
     imlib_find_blobs(&out,
                      arg_img,
                      &roi,
@@ -4515,8 +6059,9 @@ static mp_obj_t py_image_find_blobs(uint n_args, const mp_obj_t *args, mp_map_t
                      py_image_find_blobs_merge_cb,
                      merge_cb,
                      x_hist_bins_max,
-                     y_hist_bins_max);
-    fb_alloc_free_till_mark();
+                     y_hist_bins_max,
+                     properties,
+                     &pool);
     list_free(&thresholds);
 
     mp_obj_list_t *objects_list = mp_obj_new_list(list_size(&out), NULL);
@@ -4531,6 +6076,7 @@ static mp_obj_t py_image_find_blobs(uint n_args, const mp_obj_t *args, mp_map_t
             xfree(lnk_data.y_hist_bins);
         }
     }
+    fb_alloc_free_till_mark();
 
     return objects_list;
 }
@@ -4552,9 +6098,10 @@ static mp_obj_t py_image_find_lines(uint n_args, const mp_obj_t *args, mp_map_t
     unsigned int rho_margin = py_helper_keyword_int(n_args, args, 6, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_rho_margin), 25);
 
     list_t out;
+    pool_t pool;
     fb_alloc_mark();
-    imlib_find_lines(&out, arg_img, &roi, x_stride, y_stride, threshold, theta_margin, rho_margin);
-    fb_alloc_free_till_mark();
+    list_pool_alloc(&pool, sizeof(find_lines_list_lnk_data_t));
+    imlib_find_lines(&out, arg_img, &roi, x_stride, y_stride, threshold, theta_margin, rho_margin, &pool);
 
     mp_obj_list_t *objects_list = mp_obj_new_list(list_size(&out), NULL);
     for (size_t i = 0; list_size(&out); i++) {
@@ -4576,6 +6123,7 @@ static mp_obj_t py_image_find_lines(uint n_args, const mp_obj_t *args, mp_map_t
 
         objects_list->items[i] = o;
     }
+    fb_alloc_free_till_mark();
 
     return objects_list;
 }
@@ -4859,23 +6407,11 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
     locals_dict, &py_rect_locals_dict
     );
 
-static mp_obj_t py_image_find_rects(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_image_cobj(args[0]);
-
-    rectangle_t roi;
-    py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
-
-    uint32_t threshold = py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_threshold), 1000);
-
-    list_t out;
-    fb_alloc_mark();
-    imlib_find_rects(&out, arg_img, &roi, threshold);
-    fb_alloc_free_till_mark();
-
-    mp_obj_list_t *objects_list = mp_obj_new_list(list_size(&out), NULL);
-    for (size_t i = 0; list_size(&out); i++) {
+// Appends the rect objects in out to objects_list, emptying out.
+static void py_image_rects_append(mp_obj_t objects_list, list_t *out) {
+    while (list_size(out)) {
         find_rects_list_lnk_data_t lnk_data;
-        list_pop_front(&out, &lnk_data);
+        list_pop_front(out, &lnk_data);
 
         py_rect_obj_t *o = m_new_obj(py_rect_obj_t);
         o->base.type = &py_rect_type;
@@ -4898,9 +6434,25 @@ static mp_obj_t py_image_find_rects(uint n_args, const mp_obj_t *args, mp_map_t
         o->h = mp_obj_new_int(lnk_data.rect.h);
         o->magnitude = mp_obj_new_int(lnk_data.magnitude);
 
-        objects_list->items[i] = o;
+        mp_obj_list_append(objects_list, o);
     }
+}
+
+static mp_obj_t py_image_find_rects(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img = py_image_cobj(args[0]);
+
+    rectangle_t roi;
+    py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
+
+    uint32_t threshold = py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_threshold), 1000);
+
+    list_t out;
+    fb_alloc_mark();
+    imlib_find_rects(&out, arg_img, &roi, threshold);
+    fb_alloc_free_till_mark();
 
+    mp_obj_t objects_list = mp_obj_new_list(0, NULL);
+    py_image_rects_append(objects_list, &out);
     return objects_list;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_rects_obj, 1, py_image_find_rects);
@@ -5128,39 +6680,66 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_qrcodes_obj, 1, py_image_find_qr
 #ifdef IMLIB_ENABLE_APRILTAGS
 // AprilTag Object //
 #define py_apriltag_obj_size    18
+// Results are kept packed, the Python objects are created when a field is read.
 typedef struct py_apriltag_obj {
     mp_obj_base_t base;
-    mp_obj_t corners;
-    mp_obj_t x, y, w, h, id, family, cx, cy, rotation, decision_margin, hamming, goodness;
-    mp_obj_t x_translation, y_translation, z_translation;
-    mp_obj_t x_rotation, y_rotation, z_rotation;
+    find_apriltags_list_lnk_data_t tag;
 } py_apriltag_obj_t;
 
 static void py_apriltag_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
     py_apriltag_obj_t *self = self_in;
+    imlib_apriltag_pose(&self->tag);
     mp_printf(print,
               "{\"x\":%d, \"y\":%d, \"w\":%d, \"h\":%d, \"id\":%d,"
               " \"family\":%d, \"cx\":%d, \"cy\":%d, \"rotation\":%f, \"decision_margin\":%f, \"hamming\":%d, \"goodness\":%f,"
               " \"x_translation\":%f, \"y_translation\":%f, \"z_translation\":%f,"
               " \"x_rotation\":%f, \"y_rotation\":%f, \"z_rotation\":%f}",
-              mp_obj_get_int(self->x),
-              mp_obj_get_int(self->y),
-              mp_obj_get_int(self->w),
-              mp_obj_get_int(self->h),
-              mp_obj_get_int(self->id),
-              mp_obj_get_int(self->family),
-              mp_obj_get_int(self->cx),
-              mp_obj_get_int(self->cy),
-              (double) mp_obj_get_float(self->rotation),
-              (double) mp_obj_get_float(self->decision_margin),
-              mp_obj_get_int(self->hamming),
-              (double) mp_obj_get_float(self->goodness),
-              (double) mp_obj_get_float(self->x_translation),
-              (double) mp_obj_get_float(self->y_translation),
-              (double) mp_obj_get_float(self->z_translation),
-              (double) mp_obj_get_float(self->x_rotation),
-              (double) mp_obj_get_float(self->y_rotation),
-              (double) mp_obj_get_float(self->z_rotation));
+              self->tag.rect.x,
+              self->tag.rect.y,
+              self->tag.rect.w,
+              self->tag.rect.h,
+              self->tag.id,
+              self->tag.family,
+              (int) self->tag.centroid_x,
+              (int) self->tag.centroid_y,
+              (double) self->tag.z_rotation,
+              (double) self->tag.decision_margin,
+              self->tag.hamming,
+              (double) self->tag.goodness,
+              (double) self->tag.x_translation,
+              (double) self->tag.y_translation,
+              (double) self->tag.z_translation,
+              (double) self->tag.x_rotation,
+              (double) self->tag.y_rotation,
+              (double) self->tag.z_rotation);
+}
+
+static mp_obj_t py_apriltag_field(py_apriltag_obj_t *self, size_t index) {
+    // The rotation and pose fields solve the pose on first access.
+    if ((index == 8) || (index >= 12)) {
+        imlib_apriltag_pose(&self->tag);
+    }
+
+    switch (index) {
+        case 0: return mp_obj_new_int(self->tag.rect.x);
+        case 1: return mp_obj_new_int(self->tag.rect.y);
+        case 2: return mp_obj_new_int(self->tag.rect.w);
+        case 3: return mp_obj_new_int(self->tag.rect.h);
+        case 4: return mp_obj_new_int(self->tag.id);
+        case 5: return mp_obj_new_int(self->tag.family);
+        case 6: return mp_obj_new_int(self->tag.centroid_x);
+        case 7: return mp_obj_new_int(self->tag.centroid_y);
+        case 8: return mp_obj_new_float(self->tag.z_rotation);
+        case 9: return mp_obj_new_float(self->tag.decision_margin);
+        case 10: return mp_obj_new_int(self->tag.hamming);
+        case 11: return mp_obj_new_float(self->tag.goodness);
+        case 12: return mp_obj_new_float(self->tag.x_translation);
+        case 13: return mp_obj_new_float(self->tag.y_translation);
+        case 14: return mp_obj_new_float(self->tag.z_translation);
+        case 15: return mp_obj_new_float(self->tag.x_rotation);
+        case 16: return mp_obj_new_float(self->tag.y_rotation);
+        default: return mp_obj_new_float(self->tag.z_rotation);
+    }
 }
 
 static mp_obj_t py_apriltag_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t value) {
@@ -5173,143 +6752,132 @@ static mp_obj_t py_apriltag_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t va
                 mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("only slices with step=1 (aka None) are supported"));
             }
             mp_obj_tuple_t *result = mp_obj_new_tuple(slice.stop - slice.start, NULL);
-            mp_seq_copy(result->items, &(self->x) + slice.start, result->len, mp_obj_t);
+            for (size_t i = 0; i < result->len; i++) {
+                result->items[i] = py_apriltag_field(self, slice.start + i);
+            }
             return result;
         }
-        switch (mp_get_index(self->base.type, py_apriltag_obj_size, index, false)) {
-            case 0: return self->x;
-            case 1: return self->y;
-            case 2: return self->w;
-            case 3: return self->h;
-            case 4: return self->id;
-            case 5: return self->family;
-            case 6: return self->cx;
-            case 7: return self->cy;
-            case 8: return self->rotation;
-            case 9: return self->decision_margin;
-            case 10: return self->hamming;
-            case 11: return self->goodness;
-            case 12: return self->x_translation;
-            case 13: return self->y_translation;
-            case 14: return self->z_translation;
-            case 15: return self->x_rotation;
-            case 16: return self->y_rotation;
-            case 17: return self->z_rotation;
-        }
+        return py_apriltag_field(self, mp_get_index(self->base.type, py_apriltag_obj_size, index, false));
     }
     return MP_OBJ_NULL; // op not supported
 }
 
 mp_obj_t py_apriltag_corners(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->corners;
+    point_t *corners = ((py_apriltag_obj_t *) self_in)->tag.corners;
+    return mp_obj_new_tuple(4, (mp_obj_t []) {
+        mp_obj_new_tuple(2, (mp_obj_t []) {mp_obj_new_int(corners[0].x), mp_obj_new_int(corners[0].y)}),
+        mp_obj_new_tuple(2, (mp_obj_t []) {mp_obj_new_int(corners[1].x), mp_obj_new_int(corners[1].y)}),
+        mp_obj_new_tuple(2, (mp_obj_t []) {mp_obj_new_int(corners[2].x), mp_obj_new_int(corners[2].y)}),
+        mp_obj_new_tuple(2, (mp_obj_t []) {mp_obj_new_int(corners[3].x), mp_obj_new_int(corners[3].y)})
+    });
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_corners_obj, py_apriltag_corners);
 
 mp_obj_t py_apriltag_rect(mp_obj_t self_in) {
-    return mp_obj_new_tuple(4, (mp_obj_t []) {((py_apriltag_obj_t *) self_in)->x,
-                                              ((py_apriltag_obj_t *) self_in)->y,
-                                              ((py_apriltag_obj_t *) self_in)->w,
-                                              ((py_apriltag_obj_t *) self_in)->h});
+    return mp_obj_new_tuple(4, (mp_obj_t []) {py_apriltag_field(self_in, 0),
+                                              py_apriltag_field(self_in, 1),
+                                              py_apriltag_field(self_in, 2),
+                                              py_apriltag_field(self_in, 3)});
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_rect_obj, py_apriltag_rect);
 
 mp_obj_t py_apriltag_x(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->x;
+    return py_apriltag_field(self_in, 0);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_x_obj, py_apriltag_x);
 
 mp_obj_t py_apriltag_y(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->y;
+    return py_apriltag_field(self_in, 1);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_y_obj, py_apriltag_y);
 
 mp_obj_t py_apriltag_w(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->w;
+    return py_apriltag_field(self_in, 2);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_w_obj, py_apriltag_w);
 
 mp_obj_t py_apriltag_h(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->h;
+    return py_apriltag_field(self_in, 3);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_h_obj, py_apriltag_h);
 
 mp_obj_t py_apriltag_id(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->id;
+    return py_apriltag_field(self_in, 4);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_id_obj, py_apriltag_id);
 
 mp_obj_t py_apriltag_family(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->family;
+    return py_apriltag_field(self_in, 5);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_family_obj, py_apriltag_family);
 
 mp_obj_t py_apriltag_cx(mp_obj_t self_in) {
-    return mp_obj_new_int(fast_roundf(mp_obj_get_float(((py_apriltag_obj_t *) self_in)->cx)));
+    return py_apriltag_field(self_in, 6);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_cx_obj, py_apriltag_cx);
 
 mp_obj_t py_apriltag_cxf(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->cx;
+    return py_apriltag_field(self_in, 6);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_cxf_obj, py_apriltag_cxf);
 
 mp_obj_t py_apriltag_cy(mp_obj_t self_in) {
-    return mp_obj_new_int(fast_roundf(mp_obj_get_float(((py_apriltag_obj_t *) self_in)->cy)));
+    return py_apriltag_field(self_in, 7);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_cy_obj, py_apriltag_cy);
 
 mp_obj_t py_apriltag_cyf(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->cy;
+    return py_apriltag_field(self_in, 7);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_cyf_obj, py_apriltag_cyf);
 
 mp_obj_t py_apriltag_rotation(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->rotation;
+    return py_apriltag_field(self_in, 8);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_rotation_obj, py_apriltag_rotation);
 
 mp_obj_t py_apriltag_decision_margin(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->decision_margin;
+    return py_apriltag_field(self_in, 9);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_decision_margin_obj, py_apriltag_decision_margin);
 
 mp_obj_t py_apriltag_hamming(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->hamming;
+    return py_apriltag_field(self_in, 10);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_hamming_obj, py_apriltag_hamming);
 
 mp_obj_t py_apriltag_goodness(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->goodness;
+    return py_apriltag_field(self_in, 11);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_goodness_obj, py_apriltag_goodness);
 
 mp_obj_t py_apriltag_x_translation(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->x_translation;
+    return py_apriltag_field(self_in, 12);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_x_translation_obj, py_apriltag_x_translation);
 
 mp_obj_t py_apriltag_y_translation(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->y_translation;
+    return py_apriltag_field(self_in, 13);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_y_translation_obj, py_apriltag_y_translation);
 
 mp_obj_t py_apriltag_z_translation(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->z_translation;
+    return py_apriltag_field(self_in, 14);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_z_translation_obj, py_apriltag_z_translation);
 
 mp_obj_t py_apriltag_x_rotation(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->x_rotation;
+    return py_apriltag_field(self_in, 15);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_x_rotation_obj, py_apriltag_x_rotation);
 
 mp_obj_t py_apriltag_y_rotation(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->y_rotation;
+    return py_apriltag_field(self_in, 16);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_y_rotation_obj, py_apriltag_y_rotation);
 
 mp_obj_t py_apriltag_z_rotation(mp_obj_t self_in) {
-    return ((py_apriltag_obj_t *) self_in)->z_rotation;
+    return py_apriltag_field(self_in, 17);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_apriltag_z_rotation_obj, py_apriltag_z_rotation);
 
@@ -5354,10 +6922,18 @@ static mp_obj_t py_image_find_apriltags(uint n_args, const mp_obj_t *args, mp_ma
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
+
+    // Quads are found on the decimated image, the tags are decoded at full resolution.
+    int decimate = py_helper_keyword_int(n_args, args, 7, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_decimate), 1);
+    PY_ASSERT_TRUE_MSG(decimate >= 1, "decimate must be >= 1");
+    float sigma = py_helper_keyword_float(n_args, args, 8, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_sigma), 0.0f);
+    bool refine_edges = py_helper_keyword_int(n_args, args, 9, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_refine_edges), true);
+
 #ifndef IMLIB_ENABLE_HIGH_RES_APRILTAGS
-    PY_ASSERT_TRUE_MSG((roi.w * roi.h) < 65536, "The maximum supported resolution for find_apriltags() is < 64K pixels.");
+    PY_ASSERT_TRUE_MSG(((roi.w / decimate) * (roi.h / decimate)) < 65536,
+                       "The maximum supported resolution for find_apriltags() is < 64K pixels (after decimation).");
 #endif
-    if ((roi.w < 4) || (roi.h < 4)) {
+    if (((roi.w / decimate) < 4) || ((roi.h / decimate) < 4)) {
         return mp_obj_new_list(0, NULL);
     }
 
@@ -5371,52 +6947,46 @@ static mp_obj_t py_image_find_apriltags(uint n_args, const mp_obj_t *args, mp_ma
     // Use the image versus the roi here since the image should be projected from the camera center.
     float cy = py_helper_keyword_float(n_args, args, 6, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_cy), arg_img->h * 0.5);
 
+    // find_rects() results are appended to this list, reusing the tag quads when not decimating or blurring.
+    list_t rects_out, *rects_out_ptr = NULL;
+    uint32_t rects_threshold = 0;
+    mp_obj_t rects_list =
+        py_helper_keyword_object(n_args, args, 10, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_rects), mp_const_none);
+    if (rects_list != mp_const_none) {
+        #ifdef IMLIB_ENABLE_FIND_RECTS
+        PY_ASSERT_TRUE_MSG(MP_OBJ_IS_TYPE(rects_list, &mp_type_list), "rects must be a list");
+        rects_threshold = py_helper_keyword_int(n_args, args, 11, kw_args,
+                                                MP_OBJ_NEW_QSTR(MP_QSTR_rects_threshold), 1000);
+        rects_out_ptr = &rects_out;
+        #else
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("find_rects() is not supported"));
+        #endif
+    }
+
+    // Solves the pose of every tag now instead of on first access.
+    bool pose = py_helper_keyword_int(n_args, args, 12, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_pose), false);
+
     list_t out;
+    pool_t pool;
     fb_alloc_mark();
-    imlib_find_apriltags(&out, arg_img, &roi, families, fx, fy, cx, cy);
-    fb_alloc_free_till_mark();
+    list_pool_alloc(&pool, sizeof(find_apriltags_list_lnk_data_t));
+    imlib_find_apriltags(&out, arg_img, &roi, families, fx, fy, cx, cy, decimate, sigma, refine_edges, pose, &pool,
+                         rects_out_ptr, rects_threshold);
+
+    #ifdef IMLIB_ENABLE_FIND_RECTS
+    if (rects_out_ptr) {
+        py_image_rects_append(rects_list, rects_out_ptr);
+    }
+    #endif
 
     mp_obj_list_t *objects_list = mp_obj_new_list(list_size(&out), NULL);
     for (size_t i = 0; list_size(&out); i++) {
-        find_apriltags_list_lnk_data_t lnk_data;
-        list_pop_front(&out, &lnk_data);
-
         py_apriltag_obj_t *o = m_new_obj(py_apriltag_obj_t);
         o->base.type = &py_apriltag_type;
-        o->corners = mp_obj_new_tuple(4, (mp_obj_t [])
-                                      {mp_obj_new_tuple(2,
-                                                        (mp_obj_t []) {mp_obj_new_int(lnk_data.corners[0].x),
-                                                                       mp_obj_new_int(lnk_data.corners[0].y)}),
-                                       mp_obj_new_tuple(2,
-                                                        (mp_obj_t []) {mp_obj_new_int(lnk_data.corners[1].x),
-                                                                       mp_obj_new_int(lnk_data.corners[1].y)}),
-                                       mp_obj_new_tuple(2,
-                                                        (mp_obj_t []) {mp_obj_new_int(lnk_data.corners[2].x),
-                                                                       mp_obj_new_int(lnk_data.corners[2].y)}),
-                                       mp_obj_new_tuple(2,
-                                                        (mp_obj_t []) {mp_obj_new_int(lnk_data.corners[3].x),
-                                                                       mp_obj_new_int(lnk_data.corners[3].y)})});
-        o->x = mp_obj_new_int(lnk_data.rect.x);
-        o->y = mp_obj_new_int(lnk_data.rect.y);
-        o->w = mp_obj_new_int(lnk_data.rect.w);
-        o->h = mp_obj_new_int(lnk_data.rect.h);
-        o->id = mp_obj_new_int(lnk_data.id);
-        o->family = mp_obj_new_int(lnk_data.family);
-        o->cx = mp_obj_new_int(lnk_data.centroid_x);
-        o->cy = mp_obj_new_int(lnk_data.centroid_y);
-        o->rotation = mp_obj_new_float(lnk_data.z_rotation);
-        o->decision_margin = mp_obj_new_float(lnk_data.decision_margin);
-        o->hamming = mp_obj_new_int(lnk_data.hamming);
-        o->goodness = mp_obj_new_float(lnk_data.goodness);
-        o->x_translation = mp_obj_new_float(lnk_data.x_translation);
-        o->y_translation = mp_obj_new_float(lnk_data.y_translation);
-        o->z_translation = mp_obj_new_float(lnk_data.z_translation);
-        o->x_rotation = mp_obj_new_float(lnk_data.x_rotation);
-        o->y_rotation = mp_obj_new_float(lnk_data.y_rotation);
-        o->z_rotation = mp_obj_new_float(lnk_data.z_rotation);
-
+        list_pop_front(&out, &o->tag);
         objects_list->items[i] = o;
     }
+    fb_alloc_free_till_mark();
 
     return objects_list;
 }
@@ -5574,10 +7144,29 @@ static mp_obj_t py_image_find_datamatrices(uint n_args, const mp_obj_t *args, mp
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
 
     int effort = py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_effort), 200);
+    // Search time budget in microseconds, 0 for none.
+    uint32_t timeout = py_helper_keyword_int(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_timeout), 0);
+
+    // (x, y, w, h) areas to search first, such as the rect() of the previous frame's codes.
+    size_t hints_len = 0;
+    rectangle_t *hints = NULL;
+    mp_obj_t hints_obj = py_helper_keyword_object(n_args, args, 4, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_hints), mp_const_none);
+    if (hints_obj != mp_const_none) {
+        mp_obj_t *hints_items;
+        mp_obj_get_array(hints_obj, &hints_len, &hints_items);
+        hints = m_new(rectangle_t, hints_len);
+
+        for (size_t i = 0; i < hints_len; i++) {
+            mp_obj_t *rect;
+            mp_obj_get_array_fixed_n(hints_items[i], 4, &rect);
+            rectangle_init(&hints[i], mp_obj_get_int(rect[0]), mp_obj_get_int(rect[1]),
+                           mp_obj_get_int(rect[2]), mp_obj_get_int(rect[3]));
+        }
+    }
 
     list_t out;
     fb_alloc_mark();
-    imlib_find_datamatrices(&out, arg_img, &roi, effort);
+    imlib_find_datamatrices(&out, arg_img, &roi, effort, timeout, hints, hints_len);
     fb_alloc_free_till_mark();
 
     mp_obj_list_t *objects_list = mp_obj_new_list(list_size(&out), NULL);
@@ -5754,9 +7343,28 @@ static mp_obj_t py_image_find_barcodes(uint n_args, const mp_obj_t *args, mp_map
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
 
+    // Bit mask of the barcodes_t types to decode, all by default.
+    uint32_t types = UINT32_MAX;
+    mp_obj_t types_obj = py_helper_keyword_object(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_types), mp_const_none);
+    if (types_obj != mp_const_none) {
+        size_t types_len;
+        mp_obj_t *types_items;
+        mp_obj_get_array(types_obj, &types_len, &types_items);
+        types = 0;
+
+        for (size_t i = 0; i < types_len; i++) {
+            int type = mp_obj_get_int(types_items[i]);
+            PY_ASSERT_TRUE_MSG((BARCODE_EAN2 <= type) && (type <= BARCODE_CODE128), "Invalid barcode type");
+            types |= 1 << type;
+        }
+    }
+
+    // Number of codes expected, scanning stops early once found.
+    int count = py_helper_keyword_int(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_count), 0);
+
     list_t out;
     fb_alloc_mark();
-    imlib_find_barcodes(&out, arg_img, &roi);
+    imlib_find_barcodes(&out, arg_img, &roi, types, count);
     fb_alloc_free_till_mark();
 
     mp_obj_list_t *objects_list = mp_obj_new_list(list_size(&out), NULL);
@@ -5979,9 +7587,17 @@ static mp_obj_t py_image_find_features(uint n_args, const mp_obj_t *args, mp_map
     PY_ASSERT_TRUE_MSG((roi.w > cascade->window.w && roi.h > cascade->window.h),
                        "Region of interest is smaller than detector window!");
 
+    // Optional shared pyramid, rebuilt here if it is stale.
+    image_pyramid_t *pyramid = NULL;
+    mp_obj_t pyramid_obj =
+        py_helper_keyword_object(n_args, args, 5, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_pyramid), mp_const_none);
+    if (pyramid_obj != mp_const_none) {
+        pyramid = py_pyramid_for_image(pyramid_obj, args[0]);
+    }
+
     // Detect objects
     fb_alloc_mark();
-    array_t *objects_array = imlib_detect_objects(arg_img, cascade, &roi);
+    array_t *objects_array = imlib_detect_objects(arg_img, cascade, &roi, pyramid);
     fb_alloc_free_till_mark();
 
     // Add detected objects to a new Python list...
@@ -6035,6 +7651,183 @@ static mp_obj_t py_image_find_lbp(uint n_args, const mp_obj_t *args, mp_map_t *k
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_lbp_obj, 2, py_image_find_lbp);
 #endif // IMLIB_ENABLE_FIND_LBP
 
+static mp_obj_t py_image_pyramid(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_UNCOMPRESSED);
+
+    int levels =
+        py_helper_keyword_int(n_args, args, 1, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_levels), 4);
+    PY_ASSERT_TRUE_MSG((1 <= levels) && (levels <= IMAGE_PYRAMID_MAX_LEVELS), "Invalid number of levels!");
+    float scale_factor =
+        py_helper_keyword_float(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_scale_factor), 1.5f);
+    PY_ASSERT_TRUE_MSG(scale_factor > 1.0f, "Scale factor must be greater than 1!");
+    // Copied pyramids keep the frame after the next snapshot, e.g. as the previous frame for find_flow().
+    bool copy =
+        py_helper_keyword_int(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_copy), false);
+
+    py_pyramid_obj_t *o = m_new_obj(py_pyramid_obj_t);
+    o->base.type = &py_pyramid_type;
+    imlib_pyramid_init(&o->_cobj);
+    o->_cobj.copy = copy;
+    o->_cobj.scale_factor = scale_factor;
+    o->n_levels = levels;
+    py_pyramid_build(o, args[0]);
+    return o;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_pyramid_obj, 1, py_image_pyramid);
+
+static mp_obj_t py_image_background_model(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_UNCOMPRESSED);
+    PY_ASSERT_TRUE_MSG((arg_img->pixfmt == PIXFORMAT_GRAYSCALE) || (arg_img->pixfmt == PIXFORMAT_RGB565),
+                       "Image format is not supported!");
+
+    int rate =
+        py_helper_keyword_int(n_args, args, 1, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_rate), 5);
+    PY_ASSERT_TRUE_MSG((0 <= rate) && (rate <= 15), "Rate must be between 0 and 15!");
+    float threshold =
+        py_helper_keyword_float(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_threshold), 3.0f);
+    PY_ASSERT_TRUE_MSG(threshold > 0.0f, "Threshold must be greater than 0!");
+    float min_std =
+        py_helper_keyword_float(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_min_std), 4.0f);
+
+    py_background_obj_t *o = m_new_obj(py_background_obj_t);
+    o->base.type = &py_background_type;
+    imlib_background_init(&o->_cobj, arg_img, rate, threshold, min_std);
+    return o;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_background_model_obj, 1, py_image_background_model);
+
+static mp_obj_t py_image_temporal_filter(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_UNCOMPRESSED);
+    PY_ASSERT_TRUE_MSG((arg_img->pixfmt == PIXFORMAT_GRAYSCALE) || (arg_img->pixfmt == PIXFORMAT_RGB565),
+                       "Image format is not supported!");
+
+    int strength =
+        py_helper_keyword_int(n_args, args, 1, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_strength), 2);
+    PY_ASSERT_TRUE_MSG((0 <= strength) && (strength <= 8), "Strength must be between 0 and 8!");
+    int threshold =
+        py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_threshold), 32);
+    PY_ASSERT_TRUE_MSG((1 <= threshold) && (threshold <= 255), "Threshold must be between 1 and 255!");
+
+    py_temporal_filter_obj_t *o = m_new_obj(py_temporal_filter_obj_t);
+    o->base.type = &py_temporal_filter_type;
+    imlib_temporal_filter_init(&o->_cobj, arg_img, strength, threshold);
+    return o;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_temporal_filter_obj, 1, py_image_temporal_filter);
+
+#ifdef IMLIB_ENABLE_OPTICAL_FLOW
+// Returns a flow vector positioned at each point, from keypoints or a sequence of (x, y) tuples.
+static flow_vector_t *py_image_flow_points(mp_obj_t points_obj, size_t *n) {
+    flow_vector_t *vectors;
+
+    #ifdef IMLIB_ENABLE_FIND_KEYPOINTS
+    if (MP_OBJ_IS_TYPE(points_obj, &py_kp_type)) {
+        array_t *kpts = ((py_kp_obj_t *) points_obj)->kpts;
+        *n = array_length(kpts);
+        vectors = m_new(flow_vector_t, *n);
+        for (size_t i = 0; i < *n; i++) {
+            kp_t *kp = array_at(kpts, i);
+            vectors[i].x = kp->x;
+            vectors[i].y = kp->y;
+        }
+        return vectors;
+    }
+    #endif
+
+    mp_obj_t *points;
+    mp_obj_get_array(points_obj, n, &points);
+    vectors = m_new(flow_vector_t, *n);
+    for (size_t i = 0; i < *n; i++) {
+        size_t len;
+        mp_obj_t *point;
+        mp_obj_get_array(points[i], &len, &point);
+        PY_ASSERT_TRUE_MSG(len >= 2, "Expected points as (x, y) tuples!");
+        vectors[i].x = mp_obj_get_float(point[0]);
+        vectors[i].y = mp_obj_get_float(point[1]);
+    }
+    return vectors;
+}
+
+static mp_obj_t py_image_find_flow(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_UNCOMPRESSED);
+    PY_ASSERT_TYPE(args[1], &py_pyramid_type);
+    image_pyramid_t *prev = &((py_pyramid_obj_t *) args[1])->_cobj;
+
+    mp_obj_t points_obj =
+        py_helper_keyword_object(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_points), mp_const_none);
+    mp_obj_t pyramid_obj =
+        py_helper_keyword_object(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_pyramid), mp_const_none);
+    int window =
+        py_helper_keyword_int(n_args, args, 4, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_window), 9);
+    int iterations =
+        py_helper_keyword_int(n_args, args, 5, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_iterations), 10);
+    int level =
+        py_helper_keyword_int(n_args, args, 6, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_level), 1);
+    int block =
+        py_helper_keyword_int(n_args, args, 7, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_block), 8);
+    int search =
+        py_helper_keyword_int(n_args, args, 8, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_search), 4);
+    PY_ASSERT_TRUE_MSG((block > 0) && (search > 0) && (iterations > 0), "Invalid flow parameters!");
+
+    // The current frame's pyramid, rebuilt here if it is stale.
+    image_pyramid_t *next;
+    if (pyramid_obj != mp_const_none) {
+        next = py_pyramid_for_image(pyramid_obj, args[0]);
+    } else {
+        py_pyramid_obj_t *o = m_new_obj(py_pyramid_obj_t);
+        o->base.type = &py_pyramid_type;
+        imlib_pyramid_init(&o->_cobj);
+        o->_cobj.scale_factor = prev->scale_factor;
+        o->n_levels = prev->n_levels;
+        py_pyramid_build(o, args[0]);
+        next = &o->_cobj;
+    }
+
+    PY_ASSERT_TRUE_MSG((prev->n_levels == next->n_levels) && (prev->scale_factor == next->scale_factor)
+                       && (prev->levels[0].w == next->levels[0].w) && (prev->levels[0].h == next->levels[0].h),
+                       "Pyramids of both frames must have the same geometry!");
+
+    mp_obj_t list = mp_obj_new_list(0, NULL);
+    flow_vector_t *vectors;
+    size_t n;
+
+    if (points_obj != mp_const_none) {
+        // Sparse flow, None for points that were lost.
+        vectors = py_image_flow_points(points_obj, &n);
+        fb_alloc_mark();
+        imlib_optflow_lk(prev, next, vectors, n, window, iterations);
+        fb_alloc_free_till_mark();
+    } else {
+        // Dense flow, one vector per block of the level.
+        image_t *level_img = imlib_pyramid_get_level(prev, IM_CLAMP(level, 0, prev->n_levels - 1));
+        size_t max_n = ((level_img->w / block) + 1) * ((level_img->h / block) + 1);
+        vectors = m_new(flow_vector_t, max_n);
+        fb_alloc_mark();
+        n = imlib_optflow_block(prev, next, level, block, search, vectors, max_n);
+        fb_alloc_free_till_mark();
+    }
+
+    if (pyramid_obj == mp_const_none) {
+        imlib_pyramid_free(next);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        flow_vector_t *v = &vectors[i];
+        if (!v->valid) {
+            mp_obj_list_append(list, mp_const_none);
+        } else {
+            mp_obj_list_append(list, mp_obj_new_tuple(4, (mp_obj_t []) {mp_obj_new_float(v->x),
+                                                                         mp_obj_new_float(v->y),
+                                                                         mp_obj_new_float(v->dx),
+                                                                         mp_obj_new_float(v->dy)}));
+        }
+    }
+
+    return list;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_flow_obj, 2, py_image_find_flow);
+#endif // IMLIB_ENABLE_OPTICAL_FLOW
+
 #ifdef IMLIB_ENABLE_FIND_KEYPOINTS
 static mp_obj_t py_image_find_keypoints(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_MUTABLE);
@@ -6058,15 +7851,25 @@ static mp_obj_t py_image_find_keypoints(uint n_args, const mp_obj_t *args, mp_ma
     corner_detector = CORNER_AGAST;
     #endif
 
+    // Optional shared pyramid, rebuilt here if it is stale.
+    image_pyramid_t *pyramid = NULL;
+    mp_obj_t pyramid_obj =
+        py_helper_keyword_object(n_args, args, 7, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_pyramid), mp_const_none);
+    if (pyramid_obj != mp_const_none) {
+        pyramid = py_pyramid_for_image(pyramid_obj, args[0]);
+    }
+
     // Find keypoints
     fb_alloc_mark();
-    array_t *kpts = orb_find_keypoints(arg_img, normalized, threshold, scale_factor, max_keypoints, corner_detector, &roi);
+    array_t *kpts = orb_find_keypoints(arg_img, normalized, threshold, scale_factor, max_keypoints, corner_detector, &roi,
+                                       pyramid);
     fb_alloc_free_till_mark();
 
     if (array_length(kpts)) {
         py_kp_obj_t *kp_obj = m_new_obj(py_kp_obj_t);
         kp_obj->base.type = &py_kp_type;
         kp_obj->kpts = kpts;
+        kp_obj->index = NULL;
         kp_obj->threshold = threshold;
         kp_obj->normalized = normalized;
         return kp_obj;
@@ -6078,7 +7881,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_keypoints_obj, 1, py_image_find_
 
 #ifdef IMLIB_ENABLE_BINARY_OPS
 static mp_obj_t py_image_find_edges(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_GRAYSCALE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_GRAYSCALE | ARG_IMAGE_WRITE);
     edge_detector_t edge_type = mp_obj_get_int(args[1]);
 
     rectangle_t roi;
@@ -6117,12 +7920,28 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_edges_obj, 2, py_image_find_edge
 
 #ifdef IMLIB_ENABLE_HOG
 static mp_obj_t py_image_find_hog(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_GRAYSCALE);
+    image_t *arg_img = py_helper_arg_to_image(args[0], ARG_IMAGE_GRAYSCALE | ARG_IMAGE_WRITE);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
 
     int size = py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_size), 8);
+    PY_ASSERT_TRUE_MSG(size > 0, "Size must be > 0");
+
+    bool descriptor = py_helper_keyword_int(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_descriptor), false);
+
+    // Returns the block descriptor of the roi as a bytearray instead of drawing it.
+    if (descriptor) {
+        int desc_size = imlib_hog_desc_size(&roi, size);
+        PY_ASSERT_TRUE_MSG(desc_size > 0, "ROI must be at least 2x2 cells");
+
+        uint8_t *desc = m_new(uint8_t, desc_size);
+        fb_alloc_mark();
+        imlib_hog_desc(arg_img, &roi, size, desc);
+        fb_alloc_free_till_mark();
+
+        return mp_obj_new_bytearray_by_ref(desc_size, desc);
+    }
 
     fb_alloc_mark();
     imlib_find_hog(arg_img, &roi, size);
@@ -6164,7 +7983,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_selective_search_obj, 1, py_image_sel
 
 #ifdef IMLIB_ENABLE_STEREO_DISPARITY
 static mp_obj_t py_image_stereo_disparity(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *img = py_helper_arg_to_image(args[0], ARG_IMAGE_GRAYSCALE);
+    image_t *img = py_helper_arg_to_image(args[0], ARG_IMAGE_GRAYSCALE | ARG_IMAGE_WRITE);
 
     if (img->w % 2) {
         mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Image width must be even!"));
@@ -6173,6 +7992,8 @@ static mp_obj_t py_image_stereo_disparity(uint n_args, const mp_obj_t *args, mp_
     int reversed = py_helper_keyword_int(n_args, args, 1, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_reversed), false);
     int max_disparity = py_helper_keyword_int(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_max_disparity), 64);
     int threshold = py_helper_keyword_int(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_threshold), 64);
+    bool census = py_helper_keyword_int(n_args, args, 4, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_census), false);
+    bool lr_check = py_helper_keyword_int(n_args, args, 5, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_lr_check), false);
 
     if ((max_disparity < 1) || (255 < max_disparity)) {
         mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("1 <= max_disparity <= 255!"));
@@ -6183,7 +8004,7 @@ static mp_obj_t py_image_stereo_disparity(uint n_args, const mp_obj_t *args, mp_
     }
 
     fb_alloc_mark();
-    imlib_stereo_disparity(img, reversed, max_disparity, threshold);
+    imlib_stereo_disparity(img, reversed, max_disparity, threshold, census, lr_check);
     fb_alloc_free_till_mark();
 
     return args[0];
@@ -6198,6 +8019,8 @@ static const mp_rom_map_elem_t locals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_format),              MP_ROM_PTR(&py_image_format_obj)},
     {MP_ROM_QSTR(MP_QSTR_size),                MP_ROM_PTR(&py_image_size_obj)},
     {MP_ROM_QSTR(MP_QSTR_bytearray),           MP_ROM_PTR(&py_image_bytearray_obj)},
+    {MP_ROM_QSTR(MP_QSTR_frame_info),          MP_ROM_PTR(&py_image_get_frame_info_obj)},
+    {MP_ROM_QSTR(MP_QSTR_to_ndarray),          MP_ROM_PTR(&py_image_to_ndarray_obj)},
     {MP_ROM_QSTR(MP_QSTR_get_pixel),           MP_ROM_PTR(&py_image_get_pixel_obj)},
     {MP_ROM_QSTR(MP_QSTR_set_pixel),           MP_ROM_PTR(&py_image_set_pixel_obj)},
     {MP_ROM_QSTR(MP_QSTR_to_bitmap),           MP_ROM_PTR(&py_image_to_bitmap_obj)},
@@ -6207,6 +8030,7 @@ static const mp_rom_map_elem_t locals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_to_ironbow),          MP_ROM_PTR(&py_image_to_ironbow_obj)},
     {MP_ROM_QSTR(MP_QSTR_to_jpeg),             MP_ROM_PTR(&py_image_to_jpeg_obj)},
     {MP_ROM_QSTR(MP_QSTR_to_png),              MP_ROM_PTR(&py_image_to_png_obj)},
+    {MP_ROM_QSTR(MP_QSTR_to_tensor),           MP_ROM_PTR(&py_image_to_tensor_obj)},
     {MP_ROM_QSTR(MP_QSTR_compress),            MP_ROM_PTR(&py_image_to_jpeg_obj)},
     {MP_ROM_QSTR(MP_QSTR_copy),                MP_ROM_PTR(&py_image_copy_obj)},
     {MP_ROM_QSTR(MP_QSTR_crop),                MP_ROM_PTR(&py_image_crop_obj)},
@@ -6217,6 +8041,8 @@ static const mp_rom_map_elem_t locals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_save),                MP_ROM_PTR(&py_func_unavailable_obj)},
     #endif
     {MP_ROM_QSTR(MP_QSTR_flush),               MP_ROM_PTR(&py_image_flush_obj)},
+    {MP_ROM_QSTR(MP_QSTR_release),             MP_ROM_PTR(&py_image_release_obj)},
+    {MP_ROM_QSTR(MP_QSTR___del__),             MP_ROM_PTR(&py_image_release_obj)},
     /* Drawing Methods */
     {MP_ROM_QSTR(MP_QSTR_clear),               MP_ROM_PTR(&py_image_clear_obj)},
     {MP_ROM_QSTR(MP_QSTR_draw_line),           MP_ROM_PTR(&py_image_draw_line_obj)},
@@ -6225,6 +8051,7 @@ static const mp_rom_map_elem_t locals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_draw_ellipse),        MP_ROM_PTR(&py_image_draw_ellipse_obj)},
     {MP_ROM_QSTR(MP_QSTR_draw_string),         MP_ROM_PTR(&py_image_draw_string_obj)},
     {MP_ROM_QSTR(MP_QSTR_draw_cross),          MP_ROM_PTR(&py_image_draw_cross_obj)},
+    {MP_ROM_QSTR(MP_QSTR_draw_batch),          MP_ROM_PTR(&py_image_draw_batch_obj)},
     {MP_ROM_QSTR(MP_QSTR_draw_arrow),          MP_ROM_PTR(&py_image_draw_arrow_obj)},
     {MP_ROM_QSTR(MP_QSTR_draw_edges),          MP_ROM_PTR(&py_image_draw_edges_obj)},
     {MP_ROM_QSTR(MP_QSTR_draw_image),          MP_ROM_PTR(&py_image_draw_image_obj)},
@@ -6243,11 +8070,17 @@ static const mp_rom_map_elem_t locals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_ccm),                 MP_ROM_PTR(&py_ccm_obj)},
     {MP_ROM_QSTR(MP_QSTR_gamma),               MP_ROM_PTR(&py_image_gamma_obj)},
     {MP_ROM_QSTR(MP_QSTR_gamma_corr),          MP_ROM_PTR(&py_image_gamma_obj)},
+    {MP_ROM_QSTR(MP_QSTR_isp),                 MP_ROM_PTR(&py_image_isp_obj)},
+    {MP_ROM_QSTR(MP_QSTR_apply_lut),           MP_ROM_PTR(&py_image_apply_lut_obj)},
+    {MP_ROM_QSTR(MP_QSTR_develop),             MP_ROM_PTR(&py_image_develop_obj)},
+    {MP_ROM_QSTR(MP_QSTR_raw_stats),           MP_ROM_PTR(&py_image_raw_stats_obj)},
     #else
     {MP_ROM_QSTR(MP_QSTR_awb),                 MP_ROM_PTR(&py_func_unavailable_obj)},
     {MP_ROM_QSTR(MP_QSTR_ccm),                 MP_ROM_PTR(&py_func_unavailable_obj)},
     {MP_ROM_QSTR(MP_QSTR_gamma),               MP_ROM_PTR(&py_func_unavailable_obj)},
     {MP_ROM_QSTR(MP_QSTR_gamma_corr),          MP_ROM_PTR(&py_func_unavailable_obj)},
+    {MP_ROM_QSTR(MP_QSTR_isp),                 MP_ROM_PTR(&py_func_unavailable_obj)},
+    {MP_ROM_QSTR(MP_QSTR_apply_lut),           MP_ROM_PTR(&py_func_unavailable_obj)},
     #endif // IMLIB_ENABLE_ISP_OPS
     /* Binary Methods */
     #ifdef IMLIB_ENABLE_BINARY_OPS
@@ -6366,6 +8199,7 @@ static const mp_rom_map_elem_t locals_dict_table[] = {
     #else
     {MP_ROM_QSTR(MP_QSTR_bilateral),           MP_ROM_PTR(&py_func_unavailable_obj)},
     #endif
+    {MP_ROM_QSTR(MP_QSTR_chain),               MP_ROM_PTR(&py_image_chain_obj)},
     /* Geometric Methods */
     #ifdef IMLIB_ENABLE_LINPOLAR
     {MP_ROM_QSTR(MP_QSTR_linpolar),            MP_ROM_PTR(&py_image_linpolar_obj)},
@@ -6387,6 +8221,27 @@ static const mp_rom_map_elem_t locals_dict_table[] = {
     #else
     {MP_ROM_QSTR(MP_QSTR_rotation_corr),       MP_ROM_PTR(&py_func_unavailable_obj)},
     #endif
+    #if defined(IMLIB_ENABLE_REMAP) && defined(IMLIB_ENABLE_LENS_CORR)
+    {MP_ROM_QSTR(MP_QSTR_lens_corr_map),       MP_ROM_PTR(&py_image_lens_corr_map_obj)},
+    #else
+    {MP_ROM_QSTR(MP_QSTR_lens_corr_map),       MP_ROM_PTR(&py_func_unavailable_obj)},
+    #endif
+    #if defined(IMLIB_ENABLE_REMAP) && defined(IMLIB_ENABLE_ROTATION_CORR)
+    {MP_ROM_QSTR(MP_QSTR_rotation_corr_map),   MP_ROM_PTR(&py_image_rotation_corr_map_obj)},
+    #else
+    {MP_ROM_QSTR(MP_QSTR_rotation_corr_map),   MP_ROM_PTR(&py_func_unavailable_obj)},
+    #endif
+    #ifdef IMLIB_ENABLE_REMAP
+    {MP_ROM_QSTR(MP_QSTR_remap),               MP_ROM_PTR(&py_image_remap_obj)},
+    {MP_ROM_QSTR(MP_QSTR_warp),                MP_ROM_PTR(&py_image_warp_obj)},
+    {MP_ROM_QSTR(MP_QSTR_warp_map),            MP_ROM_PTR(&py_image_warp_map_obj)},
+    {MP_ROM_QSTR(MP_QSTR_fuse),                MP_ROM_PTR(&py_image_fuse_obj)},
+    #else
+    {MP_ROM_QSTR(MP_QSTR_remap),               MP_ROM_PTR(&py_func_unavailable_obj)},
+    {MP_ROM_QSTR(MP_QSTR_warp),                MP_ROM_PTR(&py_func_unavailable_obj)},
+    {MP_ROM_QSTR(MP_QSTR_warp_map),            MP_ROM_PTR(&py_func_unavailable_obj)},
+    {MP_ROM_QSTR(MP_QSTR_fuse),                MP_ROM_PTR(&py_func_unavailable_obj)},
+    #endif
     /* Get Methods */
     #ifdef IMLIB_ENABLE_GET_SIMILARITY
     {MP_ROM_QSTR(MP_QSTR_get_similarity),      MP_ROM_PTR(&py_image_get_similarity_obj)},
@@ -6399,7 +8254,13 @@ static const mp_rom_map_elem_t locals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_get_stats),           MP_ROM_PTR(&py_image_get_statistics_obj)},
     {MP_ROM_QSTR(MP_QSTR_get_statistics),      MP_ROM_PTR(&py_image_get_statistics_obj)},
     {MP_ROM_QSTR(MP_QSTR_statistics),          MP_ROM_PTR(&py_image_get_statistics_obj)},
+    #ifdef IMLIB_ENABLE_HISTOGRAM_CACHE
+    {MP_ROM_QSTR(MP_QSTR_get_histogram_cache), MP_ROM_PTR(&py_image_get_histogram_cache_obj)},
+    #else
+    {MP_ROM_QSTR(MP_QSTR_get_histogram_cache), MP_ROM_PTR(&py_func_unavailable_obj)},
+    #endif
     {MP_ROM_QSTR(MP_QSTR_get_regression),      MP_ROM_PTR(&py_image_get_regression_obj)},
+    {MP_ROM_QSTR(MP_QSTR_fingerprint),         MP_ROM_PTR(&py_image_fingerprint_obj)},
     /* Find Methods */
     {MP_ROM_QSTR(MP_QSTR_find_blobs),          MP_ROM_PTR(&py_image_find_blobs_obj)},
     #ifdef IMLIB_ENABLE_FIND_LINES
@@ -6463,6 +8324,14 @@ static const mp_rom_map_elem_t locals_dict_table[] = {
     #else
     {MP_ROM_QSTR(MP_QSTR_find_lbp),            MP_ROM_PTR(&py_func_unavailable_obj)},
     #endif
+    {MP_ROM_QSTR(MP_QSTR_pyramid),             MP_ROM_PTR(&py_image_pyramid_obj)},
+    {MP_ROM_QSTR(MP_QSTR_background_model),    MP_ROM_PTR(&py_image_background_model_obj)},
+    {MP_ROM_QSTR(MP_QSTR_temporal_filter),     MP_ROM_PTR(&py_image_temporal_filter_obj)},
+    #ifdef IMLIB_ENABLE_OPTICAL_FLOW
+    {MP_ROM_QSTR(MP_QSTR_find_flow),           MP_ROM_PTR(&py_image_find_flow_obj)},
+    #else
+    {MP_ROM_QSTR(MP_QSTR_find_flow),           MP_ROM_PTR(&py_func_unavailable_obj)},
+    #endif
     #ifdef IMLIB_ENABLE_FIND_KEYPOINTS
     {MP_ROM_QSTR(MP_QSTR_find_keypoints),      MP_ROM_PTR(&py_image_find_keypoints_obj)},
     #else
@@ -6734,6 +8603,11 @@ mp_obj_t py_image(int w, int h, pixformat_t pixfmt, uint32_t size, void *pixels)
     o->_cobj.size = size;
     o->_cobj.pixfmt = pixfmt;
     o->_cobj.pixels = pixels;
+    o->pinned = NULL;
+    o->arena = fb_alloc_arena_id(pixels);
+    o->buffer = NULL;
+    o->info = (frame_info_t) {};
+    o->write_seq = py_image_next_write_seq();
     return o;
 }
 
@@ -6741,9 +8615,86 @@ mp_obj_t py_image_from_struct(image_t *img) {
     py_image_obj_t *o = m_new_obj(py_image_obj_t);
     o->base.type = &py_image_type;
     o->_cobj = *img;
+    o->pinned = NULL;
+    o->arena = fb_alloc_arena_id(img->data);
+    o->buffer = NULL;
+    o->info = (frame_info_t) {};
+    o->write_seq = py_image_next_write_seq();
     return o;
 }
 
+void py_image_set_frame_info(mp_obj_t img_obj, const frame_info_t *info) {
+    ((py_image_obj_t *) img_obj)->info = *info;
+}
+
+const frame_info_t *py_image_frame_info(mp_obj_t img_obj) {
+    if (!MP_OBJ_IS_TYPE(img_obj, &py_image_type)) {
+        return NULL;
+    }
+
+    frame_info_t *info = &((py_image_obj_t *) img_obj)->info;
+    return info->seq ? info : NULL;
+}
+
+mp_obj_t py_image_from_vbuffer(image_t *img) {
+    // Only pinned images need a finaliser to return the buffer when collected.
+    py_image_obj_t *o = m_new_obj_with_finaliser(py_image_obj_t);
+    o->base.type = &py_image_type;
+    o->_cobj = *img;
+    o->arena = 0;
+    o->buffer = NULL;
+    o->info = (frame_info_t) {};
+    o->write_seq = py_image_next_write_seq();
+    // Pinned after allocating so that the frame buffer can invalidate the image it points to.
+    o->pinned = framebuffer_pin_current_buffer(&o->_cobj);
+    return o->pinned ? o : MP_OBJ_NULL;
+}
+
+// Sets up image to alias an array of shape (h, w) or (h, w, 1). uint8 arrays are GRAYSCALE images
+// and uint16 arrays are RGB565 images. Returns false if obj isn't an array with a shape.
+static bool py_image_load_ndarray(mp_obj_t obj, image_t *image) {
+    mp_buffer_info_t bufinfo;
+    mp_obj_t dest[2];
+
+    if (!mp_get_buffer(obj, &bufinfo, MP_BUFFER_READ)) {
+        return false;
+    }
+
+    mp_load_method_maybe(obj, MP_QSTR_shape, dest);
+    if (dest[0] == MP_OBJ_NULL) {
+        return false;
+    }
+
+    size_t shape_len;
+    mp_obj_t *shape;
+    mp_obj_get_array(dest[0], &shape_len, &shape);
+
+    if ((shape_len != 2) && ((shape_len != 3) || (mp_obj_get_int(shape[2]) != 1))) {
+        mp_raise_ValueError(MP_ERROR_TEXT("Expected an array of shape (h, w) or (h, w, 1)"));
+    }
+
+    image->h = mp_obj_get_int(shape[0]);
+    PY_ASSERT_TRUE_MSG(image->h > 0, "Image height must be > 0");
+
+    image->w = mp_obj_get_int(shape[1]);
+    PY_ASSERT_TRUE_MSG(image->w > 0, "Image width must be > 0");
+
+    if (bufinfo.typecode == 'B') {
+        image->pixfmt = PIXFORMAT_GRAYSCALE;
+    } else if (bufinfo.typecode == 'H') {
+        image->pixfmt = PIXFORMAT_RGB565;
+    } else {
+        mp_raise_ValueError(MP_ERROR_TEXT("Expected a uint8 or uint16 array"));
+    }
+
+    if (bufinfo.len < image_size(image)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("Array too small"));
+    }
+
+    image->data = bufinfo.buf;
+    return true;
+}
+
 mp_obj_t py_image_load_image(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     enum { ARG_height, ARG_pixformat, ARG_buffer, ARG_copy_to_fb, ARG_shape, ARG_strides, ARG_scale};
     static const mp_arg_t allowed_args[] = {
@@ -6774,7 +8725,7 @@ mp_obj_t py_image_load_image(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw
         if (args[ARG_copy_to_fb].u_bool) {
             py_helper_set_to_framebuffer(&image);
         } else {
-            image.data = xalloc(image_size(&image));
+            image.data = py_helper_image_alloc(image_size(&image));
         }
 
         imlib_load_image(&image, path);
@@ -6857,7 +8808,7 @@ mp_obj_t py_image_load_image(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw
         if (args[ARG_copy_to_fb].u_bool) {
             py_helper_set_to_framebuffer(&image);
         } else {
-            image.data = xalloc(image_size(&image));
+            image.data = py_helper_image_alloc(image_size(&image));
         }
 
         if (channels == 1) {
@@ -6872,6 +8823,13 @@ mp_obj_t py_image_load_image(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw
                 ((uint16_t *) image.data)[i] = COLOR_R8_G8_B8_TO_RGB565(r, g, b);
             }
         }
+    } else if ((!mp_obj_is_int(pos_args[0])) && py_image_load_ndarray(pos_args[0], &image)) {
+        // Dense uint8/uint16 arrays with a shape, such as ulab ndarrays, are used in place.
+        if (args[ARG_copy_to_fb].u_bool) {
+            void *data = image.data;
+            py_helper_set_to_framebuffer(&image);
+            memcpy(image.data, data, image_size(&image));
+        }
     } else {
         image.w = mp_obj_get_int(pos_args[0]);
         PY_ASSERT_TRUE_MSG(image.w > 0, "Image width must be > 0");
@@ -6880,7 +8838,8 @@ mp_obj_t py_image_load_image(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw
         PY_ASSERT_TRUE_MSG(image.h > 0, "Image height must be > 0");
 
         image.pixfmt = args[ARG_pixformat].u_int;
-        PY_ASSERT_TRUE_MSG(IMLIB_PIXFORMAT_IS_VALID(image.pixfmt), "Pixel format is not set or unsupported");
+        PY_ASSERT_TRUE_MSG(IMLIB_PIXFORMAT_IS_VALID(image.pixfmt) || IMLIB_PIXFORMAT_IS_TENSOR(image.pixfmt),
+                           "Pixel format is not set or unsupported");
 
         mp_buffer_info_t bufinfo = {0};
         if (args[ARG_buffer].u_obj != mp_const_none) {
@@ -6900,7 +8859,7 @@ mp_obj_t py_image_load_image(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw
         } else if (bufinfo.buf != NULL) {
             image.data = bufinfo.buf;
         } else {
-            image.data = xalloc0(image_size(&image));
+            image.data = py_helper_image_alloc0(image_size(&image));
         }
     }
 
@@ -6914,10 +8873,19 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_load_image_obj, 1, py_image_load_imag
 #ifdef IMLIB_ENABLE_FEATURES
 mp_obj_t py_image_load_cascade(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     cascade_t cascade;
-    const char *path = mp_obj_str_get_str(args[0]);
+    mp_buffer_info_t bufinfo;
+    int res = FR_OK;
+
+    if ((!mp_obj_is_str(args[0])) && mp_get_buffer(args[0], &bufinfo, MP_BUFFER_READ)) {
+        // Packed cascades are used in place, e.g. from a bytes object frozen into flash.
+        if (imlib_load_cascade_from_buffer(&cascade, bufinfo.buf, bufinfo.len) != 0) {
+            mp_raise_ValueError(MP_ERROR_TEXT("Invalid packed cascade"));
+        }
+    } else {
+        // Load cascade from file or flash
+        res = imlib_load_cascade(&cascade, mp_obj_str_get_str(args[0]));
+    }
 
-    // Load cascade from file or flash
-    int res = imlib_load_cascade(&cascade, path);
     if (res != FR_OK) {
         #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
         // cascade is not built-in and failed to load it from file.
@@ -6939,6 +8907,7 @@ mp_obj_t py_image_load_cascade(uint n_args, const mp_obj_t *args, mp_map_t *kw_a
     py_cascade_obj_t *o = m_new_obj(py_cascade_obj_t);
     o->base.type = &py_cascade_type;
     o->_cobj = cascade;
+    o->buffer = mp_obj_is_str(args[0]) ? mp_const_none : args[0];
     return o;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_load_cascade_obj, 1, py_image_load_cascade);
@@ -6984,6 +8953,7 @@ mp_obj_t py_image_load_descriptor(uint n_args, const mp_obj_t *args, mp_map_t *k
                 py_kp_obj_t *kp_obj = m_new_obj(py_kp_obj_t);
                 kp_obj->base.type = &py_kp_type;
                 kp_obj->kpts = kpts;
+                kp_obj->index = NULL;
                 kp_obj->threshold = 10;
                 kp_obj->normalized = false;
                 desc = kp_obj;
@@ -7068,6 +9038,33 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_save_descriptor_obj, 2, py_image_save
 
 static mp_obj_t py_image_match_descriptor(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     mp_obj_t match_obj = mp_const_none;
+
+    #if defined(IMLIB_ENABLE_FIND_LBP)
+    // Matching one LBP descriptor against a list of enrolled ones returns (index, distance) of the closest.
+    if ((mp_obj_get_type(args[0]) == &py_lbp_type) &&
+        (mp_obj_is_type(args[1], &mp_type_list) || mp_obj_is_type(args[1], &mp_type_tuple))) {
+        size_t gallery_len;
+        mp_obj_t *gallery_obj;
+        mp_obj_get_array(args[1], &gallery_len, &gallery_obj);
+
+        uint8_t **gallery = m_new(uint8_t *, gallery_len);
+        for (size_t i = 0; i < gallery_len; i++) {
+            PY_ASSERT_TYPE(gallery_obj[i], &py_lbp_type);
+            gallery[i] = ((py_lbp_obj_t *) gallery_obj[i])->hist;
+        }
+
+        int distance;
+        int index = imlib_lbp_desc_match(((py_lbp_obj_t *) args[0])->hist, gallery, gallery_len, &distance);
+
+        if (index < 0) {
+            return mp_const_none;
+        }
+
+        mp_obj_t tuple[2] = {mp_obj_new_int(index), mp_obj_new_int(distance)};
+        return mp_obj_new_tuple(2, tuple);
+    }
+    #endif //IMLIB_ENABLE_FIND_LBP
+
     const mp_obj_type_t *desc1_type = mp_obj_get_type(args[0]);
     const mp_obj_type_t *desc2_type = mp_obj_get_type(args[1]);
     PY_ASSERT_TRUE_MSG((desc1_type == desc2_type), "Descriptors have different types!");
@@ -7108,8 +9105,18 @@ static mp_obj_t py_image_match_descriptor(uint n_args, const mp_obj_t *args, mp_
             fb_alloc_mark();
             int *match = fb_alloc(array_length(kpts1->kpts) * sizeof(int) * 2, FB_ALLOC_NO_HINT);
 
+            // Index each keypoint set once, so matching against many sets stays cheap.
+            if (!kpts1->index) {
+                kpts1->index = orb_index_build(kpts1->kpts);
+            }
+
+            if (!kpts2->index) {
+                kpts2->index = orb_index_build(kpts2->kpts);
+            }
+
             // Match the two keypoint sets
-            count = orb_match_keypoints(kpts1->kpts, kpts2->kpts, match, threshold, &r, &c, &theta);
+            count = orb_match_keypoints(kpts1->kpts, kpts2->kpts, kpts1->index, kpts2->index,
+                                        match, threshold, &r, &c, &theta);
 
             // Add matching keypoints to Python list.
             for (int i = 0; i < count * 2; i += 2) {
@@ -7153,7 +9160,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_match_descriptor_obj, 2, py_image_mat
 #if defined(IMLIB_ENABLE_FIND_KEYPOINTS) && defined(IMLIB_ENABLE_IMAGE_FILE_IO)
 int py_image_descriptor_from_roi(image_t *img, const char *path, rectangle_t *roi) {
     FIL fp;
-    array_t *kpts = orb_find_keypoints(img, false, 20, 1.5f, 100, CORNER_AGAST, roi);
+    array_t *kpts = orb_find_keypoints(img, false, 20, 1.5f, 100, CORNER_AGAST, roi, NULL);
     if (array_length(kpts)) {
         file_open(&fp, path, false, FA_WRITE | FA_CREATE_ALWAYS);
         FRESULT res = orb_save_descriptor(&fp, kpts);
@@ -7177,6 +9184,12 @@ static const mp_rom_map_elem_t globals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_YUV422),              MP_ROM_INT(PIXFORMAT_YUV422)},   /* 2BPP/YUV422*/
     {MP_ROM_QSTR(MP_QSTR_JPEG),                MP_ROM_INT(PIXFORMAT_JPEG)},     /* JPEG/COMPRESSED*/
     {MP_ROM_QSTR(MP_QSTR_PNG),                 MP_ROM_INT(PIXFORMAT_PNG)},      /* PNG/COMPRESSED*/
+    {MP_ROM_QSTR(MP_QSTR_RAW10),               MP_ROM_INT(PIXFORMAT_RAW10)},    /* 10-bit/PACKED*/
+    {MP_ROM_QSTR(MP_QSTR_RAW12),               MP_ROM_INT(PIXFORMAT_RAW12)},    /* 12-bit/PACKED*/
+    {MP_ROM_QSTR(MP_QSTR_TENSOR_UINT8),        MP_ROM_INT(PIXFORMAT_TENSOR_UINT8)},     /* 1BPP/TENSOR*/
+    {MP_ROM_QSTR(MP_QSTR_TENSOR_INT8),         MP_ROM_INT(PIXFORMAT_TENSOR_INT8)},      /* 1BPP/TENSOR*/
+    {MP_ROM_QSTR(MP_QSTR_TENSOR_RGB_UINT8),    MP_ROM_INT(PIXFORMAT_TENSOR_RGB_UINT8)}, /* 3BPP/TENSOR*/
+    {MP_ROM_QSTR(MP_QSTR_TENSOR_RGB_INT8),     MP_ROM_INT(PIXFORMAT_TENSOR_RGB_INT8)},  /* 3BPP/TENSOR*/
     {MP_ROM_QSTR(MP_QSTR_PALETTE_RAINBOW),     MP_ROM_INT(COLOR_PALETTE_RAINBOW)},
     {MP_ROM_QSTR(MP_QSTR_PALETTE_IRONBOW),     MP_ROM_INT(COLOR_PALETTE_IRONBOW)},
     {MP_ROM_QSTR(MP_QSTR_AREA),                MP_ROM_INT(IMAGE_HINT_AREA)},
@@ -7194,6 +9207,12 @@ static const mp_rom_map_elem_t globals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_ROTATE_90),           MP_ROM_INT(IMAGE_HINT_VFLIP | IMAGE_HINT_TRANSPOSE)},
     {MP_ROM_QSTR(MP_QSTR_ROTATE_180),          MP_ROM_INT(IMAGE_HINT_HMIRROR | IMAGE_HINT_VFLIP)},
     {MP_ROM_QSTR(MP_QSTR_ROTATE_270),          MP_ROM_INT(IMAGE_HINT_HMIRROR | IMAGE_HINT_TRANSPOSE)},
+    {MP_ROM_QSTR(MP_QSTR_DRAW_LINE),           MP_ROM_INT(DRAW_BATCH_LINE)},
+    {MP_ROM_QSTR(MP_QSTR_DRAW_RECTANGLE),      MP_ROM_INT(DRAW_BATCH_RECTANGLE)},
+    {MP_ROM_QSTR(MP_QSTR_DRAW_CIRCLE),         MP_ROM_INT(DRAW_BATCH_CIRCLE)},
+    {MP_ROM_QSTR(MP_QSTR_DRAW_ELLIPSE),        MP_ROM_INT(DRAW_BATCH_ELLIPSE)},
+    {MP_ROM_QSTR(MP_QSTR_DRAW_CROSS),          MP_ROM_INT(DRAW_BATCH_CROSS)},
+    {MP_ROM_QSTR(MP_QSTR_DRAW_STRING),         MP_ROM_INT(DRAW_BATCH_STRING)},
     {MP_ROM_QSTR(MP_QSTR_JPEG_SUBSAMPLING_AUTO), MP_ROM_INT(JPEG_SUBSAMPLING_AUTO)},
     {MP_ROM_QSTR(MP_QSTR_JPEG_SUBSAMPLING_444), MP_ROM_INT(JPEG_SUBSAMPLING_444)},
     {MP_ROM_QSTR(MP_QSTR_JPEG_SUBSAMPLING_422), MP_ROM_INT(JPEG_SUBSAMPLING_422)},
@@ -7258,6 +9277,13 @@ static const mp_rom_map_elem_t globals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_yuv_to_rgb),          MP_ROM_PTR(&py_image_yuv_to_rgb_obj)},
     {MP_ROM_QSTR(MP_QSTR_yuv_to_lab),          MP_ROM_PTR(&py_image_yuv_to_lab_obj)},
     {MP_ROM_QSTR(MP_QSTR_Image),               MP_ROM_PTR(&py_image_load_image_obj)},
+    {MP_ROM_QSTR(MP_QSTR_Pipeline),            MP_ROM_PTR(&py_pipeline_type)},
+    {MP_ROM_QSTR(MP_QSTR_JPEGRate),            MP_ROM_PTR(&py_jpeg_rate_type)},
+    #ifdef IMLIB_ENABLE_ISP_OPS
+    {MP_ROM_QSTR(MP_QSTR_lut),                 MP_ROM_PTR(&py_image_lut_obj)},
+    #else
+    {MP_ROM_QSTR(MP_QSTR_lut),                 MP_ROM_PTR(&py_func_unavailable_obj)},
+    #endif
     #ifdef IMLIB_ENABLE_FEATURES
     {MP_ROM_QSTR(MP_QSTR_HaarCascade),         MP_ROM_PTR(&py_image_load_cascade_obj)},
     #endif
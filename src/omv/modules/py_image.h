@@ -11,8 +11,16 @@
 #ifndef __PY_IMAGE_H__
 #define __PY_IMAGE_H__
 #include "imlib.h"
+#include "framebuffer.h"
 mp_obj_t py_image(int width, int height, pixformat_t pixfmt, uint32_t size, void *pixels);
 mp_obj_t py_image_from_struct(image_t *img);
+mp_obj_t py_image_from_vbuffer(image_t *img);
 void *py_image_cobj(mp_obj_t img_obj);
+// Marks the pixels of img_obj as written, data cached from them (e.g. pyramids) is rebuilt.
+void py_image_written(mp_obj_t img_obj);
+// Reuses img_obj for img, frame buffer images are pointed at img and other images get a copy of it.
+mp_obj_t py_image_reuse(mp_obj_t img_obj, image_t *img);
+void py_image_set_frame_info(mp_obj_t img_obj, const frame_info_t *info);
+const frame_info_t *py_image_frame_info(mp_obj_t img_obj);
 int py_image_descriptor_from_roi(image_t *img, const char *path, rectangle_t *roi);
 #endif // __PY_IMAGE_H__
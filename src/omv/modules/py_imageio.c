@@ -23,6 +23,7 @@
 
 #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
 #include "file_utils.h"
+#include "softtimer.h"
 #endif
 #include "framebuffer.h"
 #include "omv_boardconfig.h"
@@ -36,10 +37,32 @@
 #define MAGIC_SIZE              16
 #define ALIGN_SIZE              16
 #define AFTER_SIZE_PADDING      12
+#define PREFETCH_POLL_MS        (5)
 
 #define ORIGINAL_VER            10
 #define RGB565_FIXED_VER        11
 #define NEW_PIXFORMAT_VER       20
+#define INDEXED_VER             21
+#define COMPRESSED_VER          22
+
+// V2.2 streams replace the first 8 bytes of the frame header padding with the frame encoding
+// and its encoded size. Frames that don't compress are stored raw. V2.2 is only used by
+// streams opened with compress=True so that other streams still play on older firmware.
+#define ENCODING_RAW            0
+#define ENCODING_LZ4            1 // Lossless, see imlib_lz4_compress().
+
+// V2.1 streams have a frame index. Every INDEX_PAGE_SIZE frames a page of (offset, ms)
+// entries is written to the stream as an index chunk (pixformat == PIXFORMAT_INVALID),
+// and closing or syncing the stream appends a directory of the pages followed by the
+// footer. A stream without a valid footer gets its index rebuilt when it's opened.
+#define INDEX_PAGE_SIZE         256
+#define INDEX_PAGE_BYTES        (INDEX_PAGE_SIZE * 2 * sizeof(uint32_t))
+#define INDEX_PAGES_GROW        16
+#define INDEX_PAGE_CHUNK        0
+#define INDEX_DIR_CHUNK         1
+#define INDEX_HEADER_SIZE       (20 + AFTER_SIZE_PADDING)
+#define INDEX_FOOTER_SIZE       16
+#define INDEX_FOOTER_MAGIC      "OMV IDX "
 
 #ifndef __DCACHE_PRESENT
 #define IMAGE_ALIGNMENT         32 // Use 32-byte alignment on MCUs with no cache for DMA buffer alignment.
@@ -67,16 +90,31 @@ typedef struct py_imageio_obj {
     uint32_t count;
     uint32_t offset;
     uint32_t ms;
+    uint32_t us; // start of the last frame written
     union {
         #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
         struct {
             FIL fp;
             int version;
+            uint32_t *index_pages; // offsets of the index pages in the stream
+            uint32_t *index_tail; // (offset, ms) of the frames after the last page
+            uint32_t index_n_pages;
+            uint32_t index_n_tail;
+            uint32_t index_ms; // ms offset of the last frame from the start of the stream
+            uint32_t data_end; // end of the frames, the directory goes here
+            bool index_dirty;
+            bool prefetched; // frames are read ahead by the background task
+            soft_timer_entry_t timer;
         };
         #endif
         struct {
             uint32_t size;
             uint8_t *buffer;
+            // Ring streams append frames over the oldest ones, "count" is the number of frames
+            // held in the "slots" of the buffer and "head" is the slot of the oldest frame.
+            bool ring;
+            uint32_t slots;
+            uint32_t head;
         };
     };
 } py_imageio_obj_t;
@@ -91,11 +129,17 @@ STATIC py_imageio_obj_t *py_imageio_obj(mp_obj_t self) {
     return stream;
 }
 
+// Returns the slot of frame "i" of a memory stream.
+STATIC uint8_t *int_py_imageio_slot(py_imageio_obj_t *stream, uint32_t i) {
+    return stream->buffer + (((stream->head + i) % stream->slots) * stream->size);
+}
+
 STATIC void py_imageio_print(const mp_print_t *print, mp_obj_t self, mp_print_kind_t kind) {
     py_imageio_obj_t *stream = MP_OBJ_TO_PTR(self);
     mp_printf(print, "{\"type\":%s, \"closed\":%s, \"count\":%u, \"offset\":%u, "
               "\"version\":%u, \"buffer_size\":%u, \"size\":%u}",
-              (stream->type == IMAGE_IO_FILE_STREAM) ? "\"file stream\"" : "\"memory stream\"",
+              (stream->type == IMAGE_IO_FILE_STREAM) ? "\"file stream\"" :
+              (stream->ring ? "\"ring stream\"" : "\"memory stream\""),
               stream->closed ? "\"true\"" : "\"false\"",
               stream->count,
               stream->offset,
@@ -112,6 +156,270 @@ STATIC void py_imageio_print(const mp_print_t *print, mp_obj_t self, mp_print_ki
               #endif
 }
 
+#if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
+STATIC bool int_py_imageio_eof(FIL *fp) {
+    return file_tell(fp) >= file_size(fp);
+}
+
+STATIC uint32_t int_py_imageio_align(uint32_t size) {
+    return ((size + ALIGN_SIZE - 1) / ALIGN_SIZE) * ALIGN_SIZE;
+}
+
+STATIC void int_py_imageio_write_padding(FIL *fp, uint32_t size) {
+    char padding[ALIGN_SIZE] = {};
+
+    if (size % ALIGN_SIZE) {
+        file_write(fp, padding, ALIGN_SIZE - (size % ALIGN_SIZE));
+    }
+}
+
+STATIC void int_py_imageio_write_index_header(FIL *fp, uint32_t type, uint32_t entries, uint32_t size) {
+    char padding[AFTER_SIZE_PADDING] = {};
+    file_write_long(fp, 0);
+    file_write_long(fp, type);
+    file_write_long(fp, entries);
+    file_write_long(fp, PIXFORMAT_INVALID);
+    file_write_long(fp, size);
+    file_write(fp, padding, AFTER_SIZE_PADDING);
+}
+
+STATIC uint32_t int_py_imageio_index_count(py_imageio_obj_t *stream) {
+    return (stream->index_n_pages * INDEX_PAGE_SIZE) + stream->index_n_tail;
+}
+
+STATIC void int_py_imageio_index_push(py_imageio_obj_t *stream, uint32_t offset, uint32_t elapsed_ms) {
+    stream->index_ms += elapsed_ms;
+    stream->index_tail[(stream->index_n_tail * 2) + 0] = offset;
+    stream->index_tail[(stream->index_n_tail * 2) + 1] = stream->index_ms;
+    stream->index_n_tail += 1;
+    stream->index_dirty = true;
+}
+
+STATIC void int_py_imageio_index_add_page(py_imageio_obj_t *stream, uint32_t offset) {
+    if ((stream->index_n_pages % INDEX_PAGES_GROW) == 0) {
+        stream->index_pages = m_renew(uint32_t, stream->index_pages, stream->index_n_pages,
+                                      stream->index_n_pages + INDEX_PAGES_GROW);
+    }
+
+    stream->index_pages[stream->index_n_pages++] = offset;
+    stream->index_n_tail = 0;
+}
+
+// Writes the full tail as a page at the end of the frames.
+STATIC void int_py_imageio_index_flush(py_imageio_obj_t *stream) {
+    FIL *fp = &stream->fp;
+    uint32_t offset = stream->data_end;
+
+    file_seek(fp, offset);
+    int_py_imageio_write_index_header(fp, INDEX_PAGE_CHUNK, INDEX_PAGE_SIZE, INDEX_PAGE_BYTES);
+    file_write(fp, stream->index_tail, INDEX_PAGE_BYTES);
+    int_py_imageio_index_add_page(stream, offset);
+    stream->data_end = file_tell(fp);
+}
+
+// Returns the offset of frame "i" (and its ms offset), reads at most one entry from the stream.
+STATIC uint32_t int_py_imageio_index_get(py_imageio_obj_t *stream, uint32_t i, uint32_t *ms) {
+    uint32_t page = i / INDEX_PAGE_SIZE, entry[2];
+
+    if (page < stream->index_n_pages) {
+        file_seek(&stream->fp, stream->index_pages[page] + INDEX_HEADER_SIZE +
+                  ((i % INDEX_PAGE_SIZE) * sizeof(entry)));
+        file_read(&stream->fp, entry, sizeof(entry));
+    } else {
+        memcpy(entry, stream->index_tail + ((i % INDEX_PAGE_SIZE) * 2), sizeof(entry));
+    }
+
+    if (ms) {
+        *ms = entry[1];
+    }
+
+    return entry[0];
+}
+
+// Drops the frames from "count" onwards (the caller overwrites them).
+STATIC void int_py_imageio_index_truncate(py_imageio_obj_t *stream, uint32_t count) {
+    uint32_t page = count / INDEX_PAGE_SIZE;
+    uint32_t ms = 0;
+
+    if (count) {
+        int_py_imageio_index_get(stream, count - 1, &ms);
+    }
+
+    // The page chunk is after its frames so it's overwritten too, move it back to the tail.
+    if (page < stream->index_n_pages) {
+        file_seek(&stream->fp, stream->index_pages[page] + INDEX_HEADER_SIZE);
+        file_read(&stream->fp, stream->index_tail, INDEX_PAGE_BYTES);
+        stream->index_n_pages = page;
+    }
+
+    stream->index_n_tail = count % INDEX_PAGE_SIZE;
+    stream->index_ms = ms;
+    stream->index_dirty = true;
+}
+
+// Writes the directory and the footer after the frames.
+STATIC void int_py_imageio_write_index(py_imageio_obj_t *stream) {
+    FIL *fp = &stream->fp;
+    uint32_t pages_size = stream->index_n_pages * sizeof(uint32_t);
+    uint32_t tail_size = stream->index_n_tail * 2 * sizeof(uint32_t);
+    uint32_t offset = file_tell(fp);
+
+    file_seek(fp, stream->data_end);
+    int_py_imageio_write_index_header(fp, INDEX_DIR_CHUNK, int_py_imageio_index_count(stream), pages_size + tail_size);
+
+    if (pages_size) {
+        file_write(fp, stream->index_pages, pages_size);
+    }
+
+    if (tail_size) {
+        file_write(fp, stream->index_tail, tail_size);
+    }
+
+    int_py_imageio_write_padding(fp, pages_size + tail_size);
+    file_write_long(fp, stream->data_end);
+    file_write_long(fp, int_py_imageio_index_count(stream));
+    file_write(fp, INDEX_FOOTER_MAGIC, INDEX_FOOTER_SIZE - 8);
+
+    if (!f_eof(fp)) {
+        file_truncate(fp);
+    }
+
+    file_seek(fp, offset);
+    stream->index_dirty = false;
+}
+
+STATIC bool int_py_imageio_read_index_dir(py_imageio_obj_t *stream) {
+    FIL *fp = &stream->fp;
+    uint32_t size = f_size(fp), footer[2], header[5];
+    char magic[INDEX_FOOTER_SIZE - 8];
+
+    if (size < (MAGIC_SIZE + INDEX_HEADER_SIZE + INDEX_FOOTER_SIZE)) {
+        return false;
+    }
+
+    file_seek(fp, size - INDEX_FOOTER_SIZE);
+    file_read(fp, footer, sizeof(footer));
+    file_read(fp, magic, sizeof(magic));
+
+    if (memcmp(magic, INDEX_FOOTER_MAGIC, sizeof(magic))
+        || (footer[0] < MAGIC_SIZE)
+        || (footer[0] > (size - INDEX_HEADER_SIZE - INDEX_FOOTER_SIZE))) {
+        return false;
+    }
+
+    uint32_t n_pages = footer[1] / INDEX_PAGE_SIZE;
+    uint32_t n_tail = footer[1] % INDEX_PAGE_SIZE;
+    uint32_t pages_size = n_pages * sizeof(uint32_t);
+    uint32_t tail_size = n_tail * 2 * sizeof(uint32_t);
+
+    file_seek(fp, footer[0]);
+    file_read(fp, header, sizeof(header));
+
+    if ((header[1] != INDEX_DIR_CHUNK)
+        || (header[2] != footer[1])
+        || (header[3] != PIXFORMAT_INVALID)
+        || (header[4] != (pages_size + tail_size))
+        || ((footer[0] + INDEX_HEADER_SIZE + int_py_imageio_align(header[4]) + INDEX_FOOTER_SIZE) != size)) {
+        return false;
+    }
+
+    file_seek(fp, footer[0] + INDEX_HEADER_SIZE);
+    stream->index_pages = m_new(uint32_t, ((n_pages / INDEX_PAGES_GROW) + 1) * INDEX_PAGES_GROW);
+    stream->index_n_pages = n_pages;
+
+    if (pages_size) {
+        file_read(fp, stream->index_pages, pages_size);
+    }
+
+    if (tail_size) {
+        file_read(fp, stream->index_tail, tail_size);
+    }
+
+    stream->index_n_tail = n_tail;
+    stream->data_end = footer[0];
+
+    if (footer[1]) {
+        int_py_imageio_index_get(stream, footer[1] - 1, &stream->index_ms);
+    }
+
+    return true;
+}
+
+// Loads the index of a V2.1 stream, or rebuilds it if the stream wasn't closed.
+STATIC void int_py_imageio_read_index(py_imageio_obj_t *stream) {
+    FIL *fp = &stream->fp;
+
+    stream->index_tail = m_new(uint32_t, INDEX_PAGE_SIZE * 2);
+
+    if (int_py_imageio_read_index_dir(stream)) {
+        return;
+    }
+
+    stream->index_n_pages = 0;
+    stream->index_n_tail = 0;
+    stream->index_ms = 0;
+    stream->data_end = MAGIC_SIZE;
+
+    // Walk the chunks up to the first one that's cut short or out of place.
+    for (uint32_t pos = MAGIC_SIZE, size = f_size(fp); (pos + INDEX_HEADER_SIZE) <= size; ) {
+        uint32_t header[7] = {}, chunk_size;
+        file_seek(fp, pos);
+        file_read(fp, header, (stream->version >= COMPRESSED_VER) ? sizeof(header) : (sizeof(uint32_t) * 5));
+
+        if (header[3] == PIXFORMAT_INVALID) {
+            if ((header[1] != INDEX_PAGE_CHUNK) || (stream->index_n_tail != INDEX_PAGE_SIZE)) {
+                break;
+            }
+            chunk_size = int_py_imageio_align(header[4]);
+        } else {
+            if ((!IMLIB_PIXFORMAT_IS_VALID(header[3]))
+                || (header[5] > ENCODING_LZ4)
+                || (stream->index_n_tail == INDEX_PAGE_SIZE)) {
+                break;
+            }
+            image_t image = { .w = header[1], .h = header[2], .pixfmt = header[3], .size = header[4] };
+            chunk_size = int_py_imageio_align((header[5] == ENCODING_LZ4) ? header[6] : image_size(&image));
+        }
+
+        if ((chunk_size > size) || ((pos + INDEX_HEADER_SIZE + chunk_size) > size)) {
+            break;
+        }
+
+        if (header[3] == PIXFORMAT_INVALID) {
+            int_py_imageio_index_add_page(stream, pos);
+        } else {
+            int_py_imageio_index_push(stream, pos, header[0]);
+        }
+
+        pos += INDEX_HEADER_SIZE + chunk_size;
+        stream->data_end = pos;
+    }
+
+    // The stream ended before the page of its last frames.
+    if (stream->index_n_tail == INDEX_PAGE_SIZE) {
+        int_py_imageio_index_flush(stream);
+    }
+
+    // Drop the partial chunk (if any) and write the index to repair the stream.
+    int_py_imageio_write_index(stream);
+}
+
+// Skips the index chunks before the next frame of a V2.1 stream.
+STATIC void int_py_imageio_skip_index(FIL *fp) {
+    for (;;) {
+        uint32_t pos = file_tell(fp), header[5];
+        file_read(fp, header, sizeof(header));
+
+        if (header[3] != PIXFORMAT_INVALID) {
+            file_seek(fp, pos);
+            return;
+        }
+
+        file_seek(fp, pos + INDEX_HEADER_SIZE + int_py_imageio_align(header[4]));
+    }
+}
+#endif
+
 STATIC mp_obj_t py_imageio_get_type(mp_obj_t self) {
     py_imageio_obj_t *stream = MP_OBJ_TO_PTR(self);
     return mp_obj_new_int(stream->type);
@@ -170,73 +478,151 @@ STATIC mp_obj_t py_imageio_size(mp_obj_t self) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_imageio_size_obj, py_imageio_size);
 
-STATIC mp_obj_t py_imageio_write(mp_obj_t self, mp_obj_t img_obj) {
-    py_imageio_obj_t *stream = py_imageio_obj(self);
-    image_t *image = py_image_cobj(img_obj);
+#if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
+// Writes a frame at the offset of a file stream.
+STATIC void int_py_imageio_write_file(py_imageio_obj_t *stream, image_t *image, uint32_t elapsed_ms) {
+    FIL *fp = &stream->fp;
 
-    uint32_t ms = mp_hal_ticks_ms(), elapsed_ms = ms - stream->ms;
-    stream->ms = ms;
+    if (stream->version >= INDEXED_VER) {
+        uint32_t offset = stream->data_end;
 
-    if (0) {
-    #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
-    } else if (stream->type == IMAGE_IO_FILE_STREAM) {
-        FIL *fp = &stream->fp;
+        if (stream->offset < int_py_imageio_index_count(stream)) {
+            offset = int_py_imageio_index_get(stream, stream->offset, NULL);
+            int_py_imageio_index_truncate(stream, stream->offset);
+        }
 
-        file_write_long(fp, elapsed_ms);
-        file_write_long(fp, image->w);
-        file_write_long(fp, image->h);
-
-        char padding[ALIGN_SIZE] = {};
-
-        if (stream->version < NEW_PIXFORMAT_VER) {
-            if (image->pixfmt == PIXFORMAT_BINARY) {
-                file_write_long(fp, OLD_BINARY_BPP);
-            } else if (image->pixfmt == PIXFORMAT_GRAYSCALE) {
-                file_write_long(fp, OLD_GRAYSCALE_BPP);
-            } else if (image->pixfmt == PIXFORMAT_RGB565) {
-                file_write_long(fp, OLD_RGB565_BPP);
-            } else if (image->pixfmt == PIXFORMAT_BAYER) {
-                file_write_long(fp, OLD_BAYER_BPP);
-            } else if (image->pixfmt == PIXFORMAT_JPEG) {
-                file_write_long(fp, image->size);
-            } else {
-                mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid image stream bpp"));
-            }
-        } else {
-            file_write_long(fp, image->pixfmt);
+        file_seek(fp, offset);
+        int_py_imageio_index_push(stream, offset, elapsed_ms);
+    }
+
+    file_write_long(fp, elapsed_ms);
+    file_write_long(fp, image->w);
+    file_write_long(fp, image->h);
+
+    char padding[ALIGN_SIZE] = {};
+
+    if (stream->version < NEW_PIXFORMAT_VER) {
+        if (image->pixfmt == PIXFORMAT_BINARY) {
+            file_write_long(fp, OLD_BINARY_BPP);
+        } else if (image->pixfmt == PIXFORMAT_GRAYSCALE) {
+            file_write_long(fp, OLD_GRAYSCALE_BPP);
+        } else if (image->pixfmt == PIXFORMAT_RGB565) {
+            file_write_long(fp, OLD_RGB565_BPP);
+        } else if (image->pixfmt == PIXFORMAT_BAYER) {
+            file_write_long(fp, OLD_BAYER_BPP);
+        } else if (image->pixfmt == PIXFORMAT_JPEG) {
             file_write_long(fp, image->size);
-            file_write(fp, padding, AFTER_SIZE_PADDING);
+        } else {
+            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid image stream bpp"));
         }
+    } else {
+        file_write_long(fp, image->pixfmt);
+        file_write_long(fp, image->size);
+    }
 
-        uint32_t size = image_size(image);
-        file_write(fp, image->data, size);
+    uint32_t size = image_size(image);
+    uint8_t *data = image->data;
 
-        if (size % ALIGN_SIZE) {
-            file_write(fp, padding, ALIGN_SIZE - (size % ALIGN_SIZE));
+    if (stream->version >= COMPRESSED_VER) {
+        uint32_t encoding = ENCODING_RAW, encoded_size = 0;
+        fb_alloc_mark();
+
+        // Compressed frames must be smaller than raw ones, otherwise the frame is stored raw.
+        if ((!image->is_compressed) && (fb_avail() > (size + (2 * sizeof(uint32_t))))) {
+            uint8_t *buffer = fb_alloc(size, FB_ALLOC_NO_HINT);
+            encoded_size = imlib_lz4_compress(image, buffer, size - 1);
+
+            if (encoded_size) {
+                encoding = ENCODING_LZ4;
+                data = buffer;
+                size = encoded_size;
+            }
         }
 
-        // Seeking to the middle of a file and writing data corrupts the remainder of the file. So,
-        // truncate the rest of the file when this happens to prevent crashing because of this.
-        if (!f_eof(fp)) {
-            file_truncate(fp);
+        file_write_long(fp, encoding);
+        file_write_long(fp, encoded_size);
+        file_write(fp, padding, AFTER_SIZE_PADDING - 8);
+    } else if (stream->version >= NEW_PIXFORMAT_VER) {
+        file_write(fp, padding, AFTER_SIZE_PADDING);
+    }
+
+    file_write(fp, data, size);
+
+    if (size % ALIGN_SIZE) {
+        file_write(fp, padding, ALIGN_SIZE - (size % ALIGN_SIZE));
+    }
+
+    if (stream->version >= COMPRESSED_VER) {
+        fb_alloc_free_till_mark();
+    }
+
+    if (stream->version >= INDEXED_VER) {
+        stream->data_end = file_tell(fp);
+
+        if (stream->index_n_tail == INDEX_PAGE_SIZE) {
+            int_py_imageio_index_flush(stream);
         }
+    }
+
+    // Seeking to the middle of a file and writing data corrupts the remainder of the file. So,
+    // truncate the rest of the file when this happens to prevent crashing because of this.
+    if (!f_eof(fp)) {
+        file_truncate(fp);
+    }
+
+    stream->count = stream->offset + 1;
+}
+#endif
+
+// Writes a frame at the end of a ring stream, over the oldest frame once the ring is full.
+STATIC void int_py_imageio_write_ring(py_imageio_obj_t *stream, image_t *image, uint32_t elapsed_ms) {
+    if (stream->count < stream->slots) {
+        stream->count += 1;
+    } else {
+        stream->head = (stream->head + 1) % stream->slots;
+    }
+
+    uint8_t *slot = int_py_imageio_slot(stream, stream->count - 1);
+    *((uint32_t *) slot) = elapsed_ms;
+    memcpy(slot + sizeof(uint32_t), image, sizeof(image_t));
+    memcpy(slot + IMAGE_T_SIZE_ALIGNED, image->data, image_size(image));
+    stream->offset = stream->count;
+}
+
+STATIC mp_obj_t py_imageio_write(mp_obj_t self, mp_obj_t img_obj) {
+    py_imageio_obj_t *stream = py_imageio_obj(self);
+    image_t *image = py_image_cobj(img_obj);
 
-        stream->count = stream->offset + 1;
+    // Camera frames are timed by their start of frame instead of by when they are written.
+    const frame_info_t *info = py_image_frame_info(img_obj);
+    uint32_t us = info ? info->sof_us : mp_hal_ticks_us(), elapsed_ms = (us - stream->us) / 1000;
+    stream->us = us;
+
+    if (0) {
+    #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
+    } else if (stream->type == IMAGE_IO_FILE_STREAM) {
+        int_py_imageio_write_file(stream, image, elapsed_ms);
     #endif
     } else if (stream->type == IMAGE_IO_MEMORY_STREAM) {
-        if (stream->offset == stream->count) {
+        if ((!stream->ring) && (stream->offset == stream->count)) {
             mp_raise_msg(&mp_type_EOFError, MP_ERROR_TEXT("End of stream"));
         }
 
         uint32_t size = image_size(image);
 
-        if (stream->size < size) {
+        if (stream->size < (IMAGE_T_SIZE_ALIGNED + size)) {
             mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid frame size"));
         }
 
-        *((uint32_t *) (stream->buffer + (stream->offset * stream->size))) = elapsed_ms;
-        memcpy(stream->buffer + (stream->offset * stream->size) + sizeof(uint32_t), image, sizeof(image_t));
-        memcpy(stream->buffer + (stream->offset * stream->size) + IMAGE_T_SIZE_ALIGNED, image->data, size);
+        if (stream->ring) {
+            int_py_imageio_write_ring(stream, image, elapsed_ms);
+            return self;
+        }
+
+        uint8_t *slot = int_py_imageio_slot(stream, stream->offset);
+        *((uint32_t *) slot) = elapsed_ms;
+        memcpy(slot + sizeof(uint32_t), image, sizeof(image_t));
+        memcpy(slot + IMAGE_T_SIZE_ALIGNED, image->data, size);
     }
 
     stream->offset += 1;
@@ -254,7 +640,7 @@ STATIC void int_py_imageio_pause(py_imageio_obj_t *stream, bool pause) {
         file_read(&stream->fp, &elapsed_ms, 4);
     #endif
     } else if (stream->type == IMAGE_IO_MEMORY_STREAM) {
-        elapsed_ms = *((uint32_t *) (stream->buffer + (stream->offset * stream->size)));
+        elapsed_ms = *((uint32_t *) int_py_imageio_slot(stream, stream->offset));
     }
 
     while (pause && ((mp_hal_ticks_ms() - stream->ms) < elapsed_ms)) {
@@ -265,10 +651,17 @@ STATIC void int_py_imageio_pause(py_imageio_obj_t *stream, bool pause) {
 }
 
 #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
-STATIC void int_py_imageio_read_chunk(py_imageio_obj_t *stream, image_t *image, bool pause) {
+// Reads a frame header, returns the encoded size of the frame data or 0 if it's stored raw.
+STATIC uint32_t int_py_imageio_read_chunk(py_imageio_obj_t *stream, image_t *image, bool pause) {
     FIL *fp = &stream->fp;
 
-    if (f_eof(fp)) {
+    if (stream->version >= INDEXED_VER) {
+        if (stream->offset >= int_py_imageio_index_count(stream)) {
+            mp_raise_msg(&mp_type_EOFError, MP_ERROR_TEXT("End of stream"));
+        }
+
+        int_py_imageio_skip_index(fp);
+    } else if (int_py_imageio_eof(fp)) {
         mp_raise_msg(&mp_type_EOFError, MP_ERROR_TEXT("End of stream"));
     }
 
@@ -277,7 +670,7 @@ STATIC void int_py_imageio_read_chunk(py_imageio_obj_t *stream, image_t *image,
     file_read(fp, &image->w, 4);
     file_read(fp, &image->h, 4);
 
-    uint32_t bpp;
+    uint32_t bpp, encoded_size = 0;
     file_read(fp, &bpp, 4);
 
     if (stream->version < NEW_PIXFORMAT_VER) {
@@ -303,17 +696,32 @@ STATIC void int_py_imageio_read_chunk(py_imageio_obj_t *stream, image_t *image,
         file_read(fp, &image->size, 4);
 
         char ignore[AFTER_SIZE_PADDING];
-        file_read(fp, ignore, AFTER_SIZE_PADDING);
+
+        if (stream->version >= COMPRESSED_VER) {
+            uint32_t encoding;
+            file_read(fp, &encoding, 4);
+            file_read(fp, &encoded_size, 4);
+            file_read(fp, ignore, AFTER_SIZE_PADDING - 8);
+
+            if ((encoding > ENCODING_LZ4) || ((encoding == ENCODING_LZ4) == (!encoded_size))) {
+                mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Invalid image stream encoding"));
+            }
+        } else {
+            file_read(fp, ignore, AFTER_SIZE_PADDING);
+        }
     }
+
+    return encoded_size;
 }
 #endif
 
 STATIC mp_obj_t py_imageio_read(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
-    enum { ARG_copy_to_fb, ARG_loop, ARG_pause };
+    enum { ARG_copy_to_fb, ARG_loop, ARG_pause, ARG_pixformat };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_copy_to_fb, MP_ARG_INT,  {.u_bool = true } },
         { MP_QSTR_loop, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_bool = true } },
         { MP_QSTR_pause, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_bool = true } },
+        { MP_QSTR_pixformat, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = PIXFORMAT_INVALID } },
     };
 
     // Parse args.
@@ -322,13 +730,15 @@ STATIC mp_obj_t py_imageio_read(uint n_args, const mp_obj_t *pos_args, mp_map_t
     mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
 
     image_t image = { 0 };
+    uint32_t encoded_size = 0;
 
     if (0) {
     #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
     } else if (stream->type == IMAGE_IO_FILE_STREAM) {
         FIL *fp = &stream->fp;
+        bool indexed = stream->version >= INDEXED_VER;
 
-        if (f_eof(fp)) {
+        if (indexed ? (stream->offset >= int_py_imageio_index_count(stream)) : int_py_imageio_eof(fp)) {
             if (args[ARG_loop].u_bool == false) {
                 return mp_const_none;
             }
@@ -337,13 +747,13 @@ STATIC mp_obj_t py_imageio_read(uint n_args, const mp_obj_t *pos_args, mp_map_t
 
             stream->offset = 0;
 
-            if (f_eof(fp)) {
+            if (indexed ? (!int_py_imageio_index_count(stream)) : int_py_imageio_eof(fp)) {
                 // Empty file
                 return mp_const_none;
             }
         }
 
-        int_py_imageio_read_chunk(stream, &image, args[ARG_pause].u_bool);
+        encoded_size = int_py_imageio_read_chunk(stream, &image, args[ARG_pause].u_bool);
     #endif
     } else if (stream->type == IMAGE_IO_MEMORY_STREAM) {
         if (stream->offset == stream->count) {
@@ -351,25 +761,65 @@ STATIC mp_obj_t py_imageio_read(uint n_args, const mp_obj_t *pos_args, mp_map_t
         }
 
         int_py_imageio_pause(stream, args[ARG_pause].u_bool);
-        memcpy(&image, stream->buffer + (stream->offset * stream->size) + sizeof(uint32_t), sizeof(image_t));
+        memcpy(&image, int_py_imageio_slot(stream, stream->offset) + sizeof(uint32_t), sizeof(image_t));
     }
 
     uint32_t size = image_size(&image);
 
+    // JPEG frames (e.g. MJPEG playback) are decoded straight into the frame buffer in the
+    // requested format. The JPEG is read into a cache aligned buffer padded for the hardware
+    // decoder's input FIFO so it decodes it in place without another copy or allocation.
+    pixformat_t pixformat = args[ARG_pixformat].u_int;
+    image_t jpeg = image;
+
+    if ((image.pixfmt == PIXFORMAT_JPEG) && (pixformat != PIXFORMAT_INVALID)) {
+        if ((pixformat != PIXFORMAT_BINARY) && (pixformat != PIXFORMAT_GRAYSCALE) && (pixformat != PIXFORMAT_RGB565)) {
+            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Expected BINARY, GRAYSCALE or RGB565"));
+        }
+
+        image.pixfmt = pixformat;
+        image.size = 0;
+    } else {
+        pixformat = PIXFORMAT_INVALID;
+    }
+
     if (args[ARG_copy_to_fb].u_bool) {
         py_helper_set_to_framebuffer(&image);
     } else {
-        image.data = xalloc(size);
+        image.data = xalloc(image_size(&image));
+    }
+
+    if (pixformat != PIXFORMAT_INVALID) {
+        fb_alloc_mark();
+        jpeg.data = fb_alloc(image_size_aligned(&jpeg), FB_ALLOC_CACHE_ALIGN);
+        memset(jpeg.data + size, 0, image_size_aligned(&jpeg) - size);
+    } else {
+        jpeg.data = image.data;
     }
 
     if (0) {
     #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
     } else if (stream->type == IMAGE_IO_FILE_STREAM) {
         FIL *fp = &stream->fp;
-        file_read(fp, image.data, size);
+
+        if (encoded_size) {
+            fb_alloc_mark();
+            uint8_t *buffer = fb_alloc(encoded_size, FB_ALLOC_NO_HINT);
+            file_read(fp, buffer, encoded_size);
+            bool ok = imlib_lz4_decompress(&image, buffer, encoded_size);
+            fb_alloc_free_till_mark();
+
+            if (!ok) {
+                mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Corrupt image stream frame"));
+            }
+
+            size = encoded_size;
+        } else {
+            file_read(fp, jpeg.data, size);
+        }
 
         // Check if original byte reversed data.
-        if ((image.pixfmt == PIXFORMAT_RGB565) && (stream->version == ORIGINAL_VER)) {
+        if ((image.pixfmt == PIXFORMAT_RGB565) && (stream->version == ORIGINAL_VER) && (pixformat == PIXFORMAT_INVALID)) {
             uint32_t *data_ptr = (uint32_t *) image.data;
             size_t data_len = image.w * image.h;
 
@@ -392,7 +842,12 @@ STATIC mp_obj_t py_imageio_read(uint n_args, const mp_obj_t *pos_args, mp_map_t
         }
     #endif
     } else if (stream->type == IMAGE_IO_MEMORY_STREAM) {
-        memcpy(image.data, stream->buffer + (stream->offset * stream->size) + IMAGE_T_SIZE_ALIGNED, size);
+        memcpy(jpeg.data, int_py_imageio_slot(stream, stream->offset) + IMAGE_T_SIZE_ALIGNED, size);
+    }
+
+    if (pixformat != PIXFORMAT_INVALID) {
+        jpeg_decompress(&image, &jpeg);
+        fb_alloc_free_till_mark();
     }
 
     stream->offset += 1;
@@ -417,18 +872,34 @@ STATIC mp_obj_t py_imageio_seek(mp_obj_t self, mp_obj_t offs) {
     #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
     if (stream->type == IMAGE_IO_FILE_STREAM) {
         FIL *fp = &stream->fp;
+
+        if (stream->version >= INDEXED_VER) {
+            uint32_t count = int_py_imageio_index_count(stream);
+
+            if (count < offset) {
+                mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid stream offset"));
+            }
+
+            file_seek(fp, (offset < count) ? int_py_imageio_index_get(stream, offset, NULL) : stream->data_end);
+            stream->offset = offset;
+            return self;
+        }
+
         file_seek(fp, MAGIC_SIZE); // skip past the file header
 
         for (int i = 0; i < offset; i++) {
             image_t image = {};
-            int_py_imageio_read_chunk(stream, &image, false);
-            uint32_t size = image_size(&image);
+            uint32_t size = int_py_imageio_read_chunk(stream, &image, false);
+
+            if (!size) {
+                size = image_size(&image);
+            }
 
             if (size % ALIGN_SIZE) {
                 size += ALIGN_SIZE - (size % ALIGN_SIZE);
             }
 
-            file_seek(fp, f_tell(fp) + size);
+            file_seek(fp, file_tell(fp) + size);
         }
 
         if (stream->offset >= stream->count) {
@@ -448,6 +919,9 @@ STATIC mp_obj_t py_imageio_sync(mp_obj_t self) {
     py_imageio_obj_t *stream = py_imageio_obj(self);
 
     if (stream->type == IMAGE_IO_FILE_STREAM) {
+        if ((stream->version >= INDEXED_VER) && stream->index_dirty) {
+            int_py_imageio_write_index(stream);
+        }
         file_sync(&stream->fp);
     }
     #endif
@@ -456,13 +930,88 @@ STATIC mp_obj_t py_imageio_sync(mp_obj_t self) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_imageio_sync_obj, py_imageio_sync);
 
+#if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
+// Appends the frames of a ring stream to a file stream, oldest first, and empties the ring.
+// The file stream stays open so the frames after the trigger can be written right after them.
+STATIC mp_obj_t py_imageio_save(mp_obj_t self, mp_obj_t file_obj) {
+    py_imageio_obj_t *stream = py_imageio_obj(self);
+
+    if ((stream->type != IMAGE_IO_MEMORY_STREAM) || (!stream->ring)) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Expected a ring stream"));
+    }
+
+    if ((!mp_obj_is_type(file_obj, &py_imageio_type))
+        || (((py_imageio_obj_t *) MP_OBJ_TO_PTR(file_obj))->type != IMAGE_IO_FILE_STREAM)) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Expected a file stream"));
+    }
+
+    py_imageio_obj_t *file = py_imageio_obj(file_obj);
+
+    // The oldest frame is timed from the last frame written to the file, if any.
+    uint32_t us = stream->us;
+
+    for (uint32_t i = 1; i < stream->count; i++) {
+        us -= *((uint32_t *) int_py_imageio_slot(stream, i)) * 1000;
+    }
+
+    int32_t first_ms = file->offset ? (((int32_t) (us - file->us)) / 1000) : 0;
+
+    for (uint32_t i = 0; i < stream->count; i++) {
+        uint8_t *slot = int_py_imageio_slot(stream, i);
+        uint32_t elapsed_ms = i ? *((uint32_t *) slot) : IM_MAX(first_ms, 0);
+
+        image_t image;
+        memcpy(&image, slot + sizeof(uint32_t), sizeof(image_t));
+        image.data = slot + IMAGE_T_SIZE_ALIGNED;
+
+        int_py_imageio_write_file(file, &image, elapsed_ms);
+        file->offset += 1;
+    }
+
+    if (stream->count) {
+        file->us = stream->us;
+    }
+
+    stream->count = 0;
+    stream->head = 0;
+    stream->offset = 0;
+
+    return self;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_imageio_save_obj, py_imageio_save);
+#endif
+
+#if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
+// Background task for prefetched streams: reads the frames ahead of the stream offset from
+// the scheduler so read() copies them from RAM instead of waiting for the card.
+STATIC mp_obj_t py_imageio_prefetch_task(mp_obj_t timer) {
+    py_imageio_obj_t *stream = (py_imageio_obj_t *) (((uint8_t *) MP_OBJ_TO_PTR(timer)) - offsetof(py_imageio_obj_t, timer));
+
+    if (!stream->closed) {
+        file_prefetch_step(&stream->fp);
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_imageio_prefetch_task_obj, py_imageio_prefetch_task);
+#endif
+
 STATIC mp_obj_t py_imageio_close(mp_obj_t self) {
     py_imageio_obj_t *stream = py_imageio_obj(self);
 
     if (0) {
     #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
     } else if (stream->type == IMAGE_IO_FILE_STREAM) {
+        if (stream->prefetched) {
+            soft_timer_remove(&stream->timer);
+        }
+        if ((stream->version >= INDEXED_VER) && stream->index_dirty) {
+            int_py_imageio_write_index(stream);
+        }
         file_close(&stream->fp);
+        if (stream->prefetched) {
+            fb_alloc_free_till_mark_past_mark_permanent();
+        }
     #endif
     } else if (stream->type == IMAGE_IO_MEMORY_STREAM) {
         fb_alloc_free_till_mark_past_mark_permanent();
@@ -474,8 +1023,28 @@ STATIC mp_obj_t py_imageio_close(mp_obj_t self) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_imageio_close_obj, py_imageio_close);
 
-STATIC mp_obj_t py_imageio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
-    mp_arg_check_num(n_args, n_kw, 2, 2, false);
+STATIC mp_obj_t py_imageio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    enum { ARG_stream, ARG_mode, ARG_ring, ARG_read_ahead, ARG_compress };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_stream, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_mode, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_ring, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+        { MP_QSTR_read_ahead, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 0} },
+        { MP_QSTR_compress, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+    };
+
+    mp_arg_val_t parsed[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, parsed);
+    mp_obj_t args[2] = { parsed[ARG_stream].u_obj, parsed[ARG_mode].u_obj };
+
+    if (parsed[ARG_ring].u_bool && (!mp_obj_is_type(args[0], &mp_type_tuple))) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Ring mode requires a memory stream"));
+    }
+
+    if (parsed[ARG_compress].u_bool && (!mp_obj_is_str(args[0]))) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Compression requires a file stream"));
+    }
+
     py_imageio_obj_t *stream = m_new_obj_with_finaliser(py_imageio_obj_t);
     stream->base.type = &py_imageio_type;
     stream->closed = false;
@@ -487,13 +1056,19 @@ STATIC mp_obj_t py_imageio_make_new(const mp_obj_type_t *type, size_t n_args, si
         FIL *fp = &stream->fp;
         stream->type = IMAGE_IO_FILE_STREAM;
         stream->count = 0;
+        stream->prefetched = false;
 
         char mode = mp_obj_str_get_str(args[1])[0];
 
         if ((mode == 'W') || (mode == 'w')) {
             file_open(fp, mp_obj_str_get_str(args[0]), false, FA_READ | FA_WRITE | FA_OPEN_ALWAYS);
-            const char string[] = "OMV IMG STR V2.0";
-            stream->version = NEW_PIXFORMAT_VER;
+            char string[] = "OMV IMG STR V2.1";
+            stream->version = INDEXED_VER;
+
+            if (parsed[ARG_compress].u_bool) {
+                string[MAGIC_SIZE - 1] = '2';
+                stream->version = COMPRESSED_VER;
+            }
 
             // Overwrite if file is too small.
             if (f_size(fp) < MAGIC_SIZE) {
@@ -512,7 +1087,9 @@ STATIC mp_obj_t py_imageio_make_new(const mp_obj_type_t *type, size_t n_args, si
                     || (period != ((uint8_t) '.'))
                     || (version != ORIGINAL_VER)
                     || (version != RGB565_FIXED_VER)
-                    || (version != NEW_PIXFORMAT_VER)) {
+                    || (version != NEW_PIXFORMAT_VER)
+                    || (version != INDEXED_VER)
+                    || (version != COMPRESSED_VER)) {
                     file_seek(fp, 0);
                     file_write(fp, string, sizeof(string) - 1); // exclude null terminator
                 } else {
@@ -522,6 +1099,16 @@ STATIC mp_obj_t py_imageio_make_new(const mp_obj_type_t *type, size_t n_args, si
             }
         }
 
+        if ((mode == 'W') || (mode == 'w')) {
+            stream->index_pages = NULL;
+            stream->index_tail = m_new(uint32_t, INDEX_PAGE_SIZE * 2);
+            stream->index_n_pages = 0;
+            stream->index_n_tail = 0;
+            stream->index_ms = 0;
+            stream->data_end = MAGIC_SIZE;
+            stream->index_dirty = true;
+        }
+
         if ((mode == 'R') || (mode == 'r')) {
             uint8_t version_hi, version_lo;
             file_open(fp, mp_obj_str_get_str(args[0]), false, FA_READ | FA_WRITE | FA_OPEN_EXISTING);
@@ -535,8 +1122,33 @@ STATIC mp_obj_t py_imageio_make_new(const mp_obj_type_t *type, size_t n_args, si
 
             if ((stream->version != ORIGINAL_VER)
                 && (stream->version != RGB565_FIXED_VER)
-                && (stream->version != NEW_PIXFORMAT_VER)) {
-                mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Expected version V1.0, V1.1, or V2.0"));
+                && (stream->version != NEW_PIXFORMAT_VER)
+                && (stream->version != INDEXED_VER)
+                && (stream->version != COMPRESSED_VER)) {
+                mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Expected version V1.0, V1.1, V2.0, V2.1, or V2.2"));
+            }
+
+            if (stream->version >= INDEXED_VER) {
+                stream->index_pages = NULL;
+                stream->index_dirty = false;
+                int_py_imageio_read_index(stream);
+                stream->count = int_py_imageio_index_count(stream);
+                file_seek(fp, MAGIC_SIZE);
+            }
+
+            if (parsed[ARG_read_ahead].u_int > 0) {
+                // e.g. a couple of frames, read in cluster aligned chunks between read() calls.
+                fb_alloc_mark();
+                uint8_t *buffer = fb_alloc(parsed[ARG_read_ahead].u_int, FB_ALLOC_PREFER_SIZE | FB_ALLOC_CACHE_ALIGN);
+                file_prefetch_on(fp, buffer, parsed[ARG_read_ahead].u_int);
+                fb_alloc_mark_permanent();
+
+                stream->prefetched = true;
+                stream->timer.flags = SOFT_TIMER_FLAG_PY_CALLBACK;
+                stream->timer.mode = SOFT_TIMER_MODE_PERIODIC;
+                stream->timer.delta_ms = PREFETCH_POLL_MS;
+                stream->timer.py_callback = MP_OBJ_FROM_PTR(&py_imageio_prefetch_task_obj);
+                soft_timer_insert(&stream->timer, PREFETCH_POLL_MS);
             }
         } else if ((mode != 'W') && (mode != 'w')) {
             mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid stream mode, expected 'R/r' or 'W/w'"));
@@ -564,11 +1176,20 @@ STATIC mp_obj_t py_imageio_make_new(const mp_obj_type_t *type, size_t n_args, si
             image.pixfmt = PIXFORMAT_BINARY;
         }
 
-        stream->count = mp_obj_get_int(args[1]);
+        int count = mp_obj_get_int(args[1]);
+
+        if (count <= 0) {
+            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid stream count"));
+        }
+
+        stream->ring = parsed[ARG_ring].u_bool;
+        stream->slots = count;
+        stream->head = 0;
+        stream->count = stream->ring ? 0 : count;
         stream->size = IMAGE_T_SIZE_ALIGNED + image_size_aligned(&image);
 
         fb_alloc_mark();
-        stream->buffer = fb_alloc(stream->count * stream->size, FB_ALLOC_PREFER_SIZE | FB_ALLOC_CACHE_ALIGN);
+        stream->buffer = fb_alloc(stream->slots * stream->size, FB_ALLOC_PREFER_SIZE | FB_ALLOC_CACHE_ALIGN);
         fb_alloc_mark_permanent();
     } else {
         mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid stream type"));
@@ -576,6 +1197,7 @@ STATIC mp_obj_t py_imageio_make_new(const mp_obj_type_t *type, size_t n_args, si
 
     stream->offset = 0;
     stream->ms = mp_hal_ticks_ms();
+    stream->us = mp_hal_ticks_us();
 
     return MP_OBJ_FROM_PTR(stream);
 }
@@ -600,6 +1222,11 @@ STATIC const mp_rom_map_elem_t py_imageio_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_read),            MP_ROM_PTR(&py_imageio_read_obj)        },
     { MP_ROM_QSTR(MP_QSTR_seek),            MP_ROM_PTR(&py_imageio_seek_obj)        },
     { MP_ROM_QSTR(MP_QSTR_sync),            MP_ROM_PTR(&py_imageio_sync_obj)        },
+    #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
+    { MP_ROM_QSTR(MP_QSTR_save),            MP_ROM_PTR(&py_imageio_save_obj)        },
+    #else
+    { MP_ROM_QSTR(MP_QSTR_save),            MP_ROM_PTR(&py_func_unavailable_obj)    },
+    #endif
     { MP_ROM_QSTR(MP_QSTR_close),           MP_ROM_PTR(&py_imageio_close_obj)       }
 };
 
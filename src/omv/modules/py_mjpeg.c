@@ -15,6 +15,7 @@
 #include "py/nlr.h"
 #include "py/mphal.h"
 #include "py/runtime.h"
+#include "softtimer.h"
 
 #include "py_assert.h"
 #include "py_helper.h"
@@ -22,19 +23,26 @@
 
 #include "file_utils.h"
 #include "framebuffer.h"
+#include "fb_alloc.h"
 #include "omv_boardconfig.h"
 
+#define MJPEG_QUEUE_POLL_MS     (5)
+#define MJPEG_CHECKPOINT_MS     (1000)
+
 static const mp_obj_type_t py_mjpeg_type;
 
 typedef struct py_mjpeg_obj {
     mp_obj_base_t base;
-    uint32_t frames;
-    uint32_t bytes;
+    mjpeg_t mjpeg;
     uint32_t us_old;
     uint32_t us_avg;
     uint32_t width;
     uint32_t height;
     bool closed;
+    bool queued;
+    bool checkpoint;
+    uint32_t checkpoint_ms;
+    soft_timer_entry_t timer;
     FIL fp;
 } py_mjpeg_obj_t;
 
@@ -44,8 +52,8 @@ STATIC void py_mjpeg_print(const mp_print_t *print, mp_obj_t self_in, mp_print_k
               self->closed ? "\"true\"" : "\"false\"",
               self->width,
               self->height,
-              self->frames,
-              f_size(&self->fp));
+              self->mjpeg.frames,
+              file_size(&self->fp));
 }
 
 STATIC mp_obj_t py_mjpeg_is_closed(mp_obj_t self_in) {
@@ -68,16 +76,39 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_mjpeg_height_obj, py_mjpeg_height);
 
 STATIC mp_obj_t py_mjpeg_count(mp_obj_t self_in) {
     py_mjpeg_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    return mp_obj_new_int(self->frames);
+    return mp_obj_new_int(self->mjpeg.frames);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_mjpeg_count_obj, py_mjpeg_count);
 
 STATIC mp_obj_t py_mjpeg_size(mp_obj_t self_in) {
     py_mjpeg_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    return mp_obj_new_int(f_size(&self->fp));
+    return mp_obj_new_int(file_size(&self->fp));
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_mjpeg_size_obj, py_mjpeg_size);
 
+// Background task for queued streams: drains the queue from the scheduler, and updates
+// the headers (mjpeg_sync) once everything queued before a checkpoint is on the card.
+STATIC mp_obj_t py_mjpeg_queue_task(mp_obj_t timer) {
+    py_mjpeg_obj_t *self = (py_mjpeg_obj_t *) (((uint8_t *) MP_OBJ_TO_PTR(timer)) - offsetof(py_mjpeg_obj_t, timer));
+
+    if (self->closed || file_queue_step(&self->fp)) {
+        return mp_const_none;
+    }
+
+    if ((mp_hal_ticks_ms() - self->checkpoint_ms) >= MJPEG_CHECKPOINT_MS) {
+        self->checkpoint = true;
+    }
+
+    if (self->checkpoint && (self->mjpeg.frames > 1)) {
+        mjpeg_sync(&self->fp, &self->mjpeg, self->us_avg);
+        self->checkpoint = false;
+        self->checkpoint_ms = mp_hal_ticks_ms();
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_mjpeg_queue_task_obj, py_mjpeg_queue_task);
+
 STATIC mp_obj_t py_mjpeg_write(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     enum { ARG_roi, ARG_channel, ARG_alpha, ARG_color_palette, ARG_alpha_palette, ARG_hint, ARG_quality };
     static const mp_arg_t allowed_args[] = {
@@ -118,20 +149,22 @@ STATIC mp_obj_t py_mjpeg_write(uint n_args, const mp_obj_t *pos_args, mp_map_t *
     const uint16_t *color_palette = py_helper_arg_to_palette(args[ARG_color_palette].u_obj, PIXFORMAT_RGB565);
     const uint8_t *alpha_palette = py_helper_arg_to_palette(args[ARG_alpha_palette].u_obj, PIXFORMAT_GRAYSCALE);
 
-    mjpeg_write(&self->fp, self->width, self->height, &self->frames, &self->bytes,
+    mjpeg_write(&self->fp, &self->mjpeg, self->width, self->height,
                 image, args[ARG_quality].u_int, &roi, args[ARG_channel].u_int,
                 args[ARG_alpha].u_int, color_palette, alpha_palette, args[ARG_hint].u_int);
 
-    uint32_t ticks = mp_hal_ticks_us();
+    // Camera frames are timed by their start of frame instead of by when they are written.
+    const frame_info_t *info = py_image_frame_info(pos_args[1]);
+    uint32_t ticks = info ? info->sof_us : mp_hal_ticks_us();
 
-    if (self->frames > 1) {
-        uint32_t ticks_diff = mp_hal_ticks_us() - self->us_old;
+    if (self->mjpeg.frames > 1) {
+        uint32_t ticks_diff = ticks - self->us_old;
 
-        if (self->frames <= 2) {
+        if (self->mjpeg.frames <= 2) {
             self->us_avg = ticks_diff;
         } else {
-            uint64_t cumulative_average_n = ((uint64_t) self->us_avg) * (self->frames - 1);
-            self->us_avg = (cumulative_average_n + ticks_diff) / self->frames;
+            uint64_t cumulative_average_n = ((uint64_t) self->us_avg) * (self->mjpeg.frames - 1);
+            self->us_avg = (cumulative_average_n + ticks_diff) / self->mjpeg.frames;
         }
     }
 
@@ -146,7 +179,12 @@ STATIC mp_obj_t py_mjpeg_sync(mp_obj_t self_in) {
     if (self->closed) {
         mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("MJPEG stream is closed"));
     }
-    mjpeg_sync(&self->fp, self->frames, self->bytes, self->us_avg);
+    if (self->queued) {
+        // Done by the background task at the next checkpoint.
+        self->checkpoint = true;
+    } else {
+        mjpeg_sync(&self->fp, &self->mjpeg, self->us_avg);
+    }
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_mjpeg_sync_obj, py_mjpeg_sync);
@@ -154,18 +192,26 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_mjpeg_sync_obj, py_mjpeg_sync);
 STATIC mp_obj_t py_mjpeg_close(mp_obj_t self_in) {
     py_mjpeg_obj_t *self = MP_OBJ_TO_PTR(self_in);
     if (!self->closed) {
-        mjpeg_close(&self->fp, self->frames, self->bytes, self->us_avg);
+        self->closed = true;
+        if (self->queued) {
+            soft_timer_remove(&self->timer);
+        }
+        mjpeg_close(&self->fp, &self->mjpeg, self->us_avg);
+        if (self->queued) {
+            fb_alloc_free_till_mark_past_mark_permanent();
+        }
     }
-    self->closed = true;
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_mjpeg_close_obj, py_mjpeg_close);
 
 STATIC mp_obj_t py_mjpeg_open(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
-    enum { ARG_width, ARG_height };
+    enum { ARG_width, ARG_height, ARG_queue_size, ARG_preallocate };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_width, MP_ARG_INT,  {.u_int = -1 } },
         { MP_QSTR_height, MP_ARG_INT,  {.u_int = -1 } },
+        { MP_QSTR_queue_size, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = 0 } },
+        { MP_QSTR_preallocate, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = 0 } },
     };
 
     // Parse args.
@@ -179,8 +225,42 @@ STATIC mp_obj_t py_mjpeg_open(uint n_args, const mp_obj_t *pos_args, mp_map_t *k
     mjpeg->width = (args[ARG_width].u_int == -1) ? framebuffer_get_width() : args[ARG_width].u_int;
     mjpeg->height = (args[ARG_height].u_int == -1) ? framebuffer_get_height() : args[ARG_height].u_int;
 
-    file_open(&mjpeg->fp, path, false, FA_WRITE | FA_CREATE_ALWAYS);
-    mjpeg_open(&mjpeg->fp, mjpeg->width, mjpeg->height);
+    // The idx1 index is made from the index chunks read back from the file.
+    file_open(&mjpeg->fp, path, false, FA_READ | FA_WRITE | FA_CREATE_ALWAYS);
+    mjpeg_open(&mjpeg->fp, &mjpeg->mjpeg, mjpeg->width, mjpeg->height);
+
+    if (args[ARG_preallocate].u_int > 0) {
+        // e.g. seconds * bitrate / 8, the unused space is given back on close.
+        file_preallocate(&mjpeg->fp, args[ARG_preallocate].u_int);
+    }
+
+    if (args[ARG_queue_size].u_int > 0) {
+        fb_alloc_mark();
+
+        nlr_buf_t nlr;
+        if (nlr_push(&nlr) == 0) {
+            uint8_t *buffer = fb_alloc(args[ARG_queue_size].u_int, FB_ALLOC_PREFER_SIZE | FB_ALLOC_CACHE_ALIGN);
+            file_queue_on(&mjpeg->fp, buffer, args[ARG_queue_size].u_int);
+            nlr_pop();
+        } else {
+            // Give back the queue buffer and the file, __del__ must not touch them again.
+            fb_alloc_free_till_mark();
+            mjpeg->closed = true;
+            file_close(&mjpeg->fp);
+            nlr_jump(nlr.ret_val);
+        }
+
+        fb_alloc_mark_permanent();
+
+        mjpeg->queued = true;
+        mjpeg->checkpoint_ms = mp_hal_ticks_ms();
+        mjpeg->timer.flags = SOFT_TIMER_FLAG_PY_CALLBACK;
+        mjpeg->timer.mode = SOFT_TIMER_MODE_PERIODIC;
+        mjpeg->timer.delta_ms = MJPEG_QUEUE_POLL_MS;
+        mjpeg->timer.py_callback = MP_OBJ_FROM_PTR(&py_mjpeg_queue_task_obj);
+        soft_timer_insert(&mjpeg->timer, MJPEG_QUEUE_POLL_MS);
+    }
+
     return mjpeg;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_mjpeg_open_obj, 1, py_mjpeg_open);
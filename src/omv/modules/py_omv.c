@@ -12,9 +12,19 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include "py/obj.h"
+#include "py/runtime.h"
 #include "usbdbg.h"
 #include "framebuffer.h"
+#include "fb_alloc.h"
+#include "umm_malloc.h"
 #include "omv_boardconfig.h"
+#include "py_assert.h"
+#include "py_helper.h"
+#include "trace.h"
+#include "omv_energy.h"
+#if OMV_PROFILE_ENABLE
+#include CMSIS_MCU_H
+#endif
 
 static mp_obj_t py_omv_version_string() {
     char str[12];
@@ -57,6 +67,188 @@ static mp_obj_t py_omv_disable_fb(uint n_args, const mp_obj_t *args) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(py_omv_disable_fb_obj, 0, 1, py_omv_disable_fb);
 
+// Sets the target size per frame and/or bitrate of the frames sent to the IDE, 0 to disable.
+static mp_obj_t py_omv_jpeg_rate(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    int frame_size = py_helper_keyword_int(n_args, args, 0, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_frame_size), 0);
+    int bitrate = py_helper_keyword_int(n_args, args, 1, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_bitrate), 0);
+    PY_ASSERT_TRUE_MSG((frame_size >= 0) && (bitrate >= 0), "Targets must be >= 0!");
+    framebuffer_set_jpeg_rate(frame_size, bitrate);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_omv_jpeg_rate_obj, 0, py_omv_jpeg_rate);
+
+static mp_obj_t py_omv_fb_alloc_peak(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    mp_obj_t peak = mp_obj_new_int(fb_alloc_peak());
+    if (py_helper_keyword_int(n_args, args, 0, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_reset), false)) {
+        fb_alloc_reset_peak();
+    }
+    return peak;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_omv_fb_alloc_peak_obj, 0, py_omv_fb_alloc_peak);
+
+// Image copies made inside a `with omv.frame_arena():` block are allocated on the fb_alloc stack
+// and all freed when the block exits, images that outlive the block raise an error when used.
+typedef struct py_omv_frame_arena_obj {
+    mp_obj_base_t base;
+    uint32_t id;
+} py_omv_frame_arena_obj_t;
+
+static mp_obj_t py_omv_frame_arena_enter(mp_obj_t self_in) {
+    py_omv_frame_arena_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    PY_ASSERT_TRUE_MSG(!self->id, "Frame arena is already open!");
+    self->id = fb_alloc_arena_open();
+    return self_in;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_omv_frame_arena_enter_obj, py_omv_frame_arena_enter);
+
+static mp_obj_t py_omv_frame_arena_exit(size_t n_args, const mp_obj_t *args) {
+    py_omv_frame_arena_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    fb_alloc_arena_close(self->id);
+    self->id = 0;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(py_omv_frame_arena_exit_obj, 1, 4, py_omv_frame_arena_exit);
+
+STATIC const mp_rom_map_elem_t py_omv_frame_arena_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___enter__),       MP_ROM_PTR(&py_omv_frame_arena_enter_obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__),        MP_ROM_PTR(&py_omv_frame_arena_exit_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(py_omv_frame_arena_locals_dict, py_omv_frame_arena_locals_dict_table);
+
+STATIC MP_DEFINE_CONST_OBJ_TYPE(
+    py_omv_frame_arena_type,
+    MP_QSTR_frame_arena,
+    MP_TYPE_FLAG_NONE,
+    locals_dict, &py_omv_frame_arena_locals_dict
+    );
+
+static mp_obj_t py_omv_frame_arena() {
+    py_omv_frame_arena_obj_t *o = m_new_obj(py_omv_frame_arena_obj_t);
+    o->base.type = &py_omv_frame_arena_type;
+    o->id = 0;
+    return MP_OBJ_FROM_PTR(o);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_omv_frame_arena_obj, py_omv_frame_arena);
+
+static mp_obj_t py_omv_umm_stats(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    umm_stats_t stats;
+    umm_stats(&stats, py_helper_keyword_int(n_args, args, 0, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_reset), false));
+
+    // (heap_size, used, peak, free, largest_free, failures, fragmentation), fragmentation
+    // is the fraction of free memory that's not in the largest free block.
+    mp_obj_t tuple[7] = {
+        mp_obj_new_int(stats.heap_size),
+        mp_obj_new_int(stats.used),
+        mp_obj_new_int(stats.peak),
+        mp_obj_new_int(stats.free),
+        mp_obj_new_int(stats.largest_free),
+        mp_obj_new_int(stats.failures),
+        mp_obj_new_float(stats.free ? (1.0f - (stats.largest_free / (float) stats.free)) : 0.0f)
+    };
+
+    return mp_obj_new_tuple(7, tuple);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_omv_umm_stats_obj, 0, py_omv_umm_stats);
+
+#if OMV_FB_ALLOC_TAGS_ENABLE
+static mp_obj_t py_omv_fb_alloc_stack(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    const fb_alloc_tag_t *tags;
+    bool peak = py_helper_keyword_int(n_args, args, 0, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_peak), false);
+    int count = fb_alloc_get_tags(&tags, peak);
+    mp_obj_t list = mp_obj_new_list(0, NULL);
+
+    // [(call site address, bytes), ...] oldest first.
+    for (int i = 0; i < count; i++) {
+        mp_obj_t tuple[2] = {
+            mp_obj_new_int_from_uint((uint32_t) tags[i].tag),
+            mp_obj_new_int(tags[i].size)
+        };
+        mp_obj_list_append(list, mp_obj_new_tuple(2, tuple));
+    }
+
+    return list;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_omv_fb_alloc_stack_obj, 0, py_omv_fb_alloc_stack);
+#endif // OMV_FB_ALLOC_TAGS_ENABLE
+
+#if OMV_PROFILE_ENABLE
+static mp_obj_t py_omv_profile(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    bool reset = py_helper_keyword_int(n_args, args, 0, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_reset), false);
+    float cycles_per_us = SystemCoreClock / 1000000.0f;
+    mp_obj_t dict = mp_obj_new_dict(TRACE_PROF_MAX);
+
+    for (int i = 0; i < TRACE_PROF_MAX; i++) {
+        const trace_prof_t *prof = trace_prof_get(i);
+        mp_obj_t hist[TRACE_PROF_HIST_BINS];
+        for (int j = 0; j < TRACE_PROF_HIST_BINS; j++) {
+            hist[j] = mp_obj_new_int(prof->hist[j]);
+        }
+
+        // (count, min_us, avg_us, max_us, hist), hist bin j counts calls of [4^j, 4^(j+1)) cycles.
+        mp_obj_t stats[5] = {
+            mp_obj_new_int(prof->count),
+            mp_obj_new_float(prof->count ? (prof->min / cycles_per_us) : 0.0f),
+            mp_obj_new_float(prof->count ? (prof->total / (cycles_per_us * prof->count)) : 0.0f),
+            mp_obj_new_float(prof->max / cycles_per_us),
+            mp_obj_new_tuple(TRACE_PROF_HIST_BINS, hist)
+        };
+
+        const char *name = trace_prof_name(i);
+        mp_obj_dict_store(dict, mp_obj_new_str(name, strlen(name)), mp_obj_new_tuple(5, stats));
+    }
+
+    if (reset) {
+        trace_prof_reset();
+    }
+
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_omv_profile_obj, 0, py_omv_profile);
+#endif // OMV_PROFILE_ENABLE
+
+// Returns the energy accounting stats as a dict, times are in ms and energies in mJ.
+static mp_obj_t py_omv_energy(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    bool reset = py_helper_keyword_int(n_args, args, 0, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_reset), false);
+    const omv_energy_stats_t *stats = omv_energy_get();
+    mp_obj_t dict = mp_obj_new_dict(8);
+
+    mp_obj_t cpu = mp_obj_new_dict(OMV_ENERGY_CPU_FREQS);
+    for (int i = 0; (i < OMV_ENERGY_CPU_FREQS) && stats->cpu_mhz[i]; i++) {
+        mp_obj_dict_store(cpu, mp_obj_new_int(stats->cpu_mhz[i]), mp_obj_new_float(stats->cpu_us[i] / 1000.0f));
+    }
+
+    mp_obj_t sensor = mp_obj_new_dict(OMV_ENERGY_SENSOR_STATES);
+    mp_obj_dict_store(sensor, MP_OBJ_NEW_QSTR(MP_QSTR_on),
+                      mp_obj_new_float(stats->sensor_us[OMV_ENERGY_SENSOR_ON] / 1000.0f));
+    mp_obj_dict_store(sensor, MP_OBJ_NEW_QSTR(MP_QSTR_sleep),
+                      mp_obj_new_float(stats->sensor_us[OMV_ENERGY_SENSOR_SLEEP] / 1000.0f));
+    mp_obj_dict_store(sensor, MP_OBJ_NEW_QSTR(MP_QSTR_shutdown),
+                      mp_obj_new_float(stats->sensor_us[OMV_ENERGY_SENSOR_OFF] / 1000.0f));
+
+    mp_obj_t periph = mp_obj_new_dict(OMV_ENERGY_PERIPH_MAX);
+    mp_obj_dict_store(periph, MP_OBJ_NEW_QSTR(MP_QSTR_wifi),
+                      mp_obj_new_float(stats->periph_us[OMV_ENERGY_PERIPH_WIFI] / 1000.0f));
+    mp_obj_dict_store(periph, MP_OBJ_NEW_QSTR(MP_QSTR_display),
+                      mp_obj_new_float(stats->periph_us[OMV_ENERGY_PERIPH_DISPLAY] / 1000.0f));
+
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_frame_mj), mp_obj_new_float(stats->frame_nj / 1000000.0f));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_frame_ms), mp_obj_new_float(stats->frame_us / 1000.0f));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_frames), mp_obj_new_int_from_uint(stats->frames));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_total_mj), mp_obj_new_float(stats->total_nj / 1000000.0f));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_measured), mp_obj_new_bool(stats->measured));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_cpu_ms), cpu);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_sensor_ms), sensor);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_periph_ms), periph);
+
+    if (reset) {
+        omv_energy_reset();
+    }
+
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_omv_energy_obj, 0, py_omv_energy);
+
 static const mp_rom_map_elem_t globals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__),        MP_OBJ_NEW_QSTR(MP_QSTR_omv) },
     { MP_ROM_QSTR(MP_QSTR_version_major),   MP_ROM_INT(FIRMWARE_VERSION_MAJOR) },
@@ -66,7 +258,22 @@ static const mp_rom_map_elem_t globals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_arch),            MP_ROM_PTR(&py_omv_arch_obj) },
     { MP_ROM_QSTR(MP_QSTR_board_type),      MP_ROM_PTR(&py_omv_board_type_obj) },
     { MP_ROM_QSTR(MP_QSTR_board_id),        MP_ROM_PTR(&py_omv_board_id_obj) },
-    { MP_ROM_QSTR(MP_QSTR_disable_fb),      MP_ROM_PTR(&py_omv_disable_fb_obj) }
+    { MP_ROM_QSTR(MP_QSTR_disable_fb),      MP_ROM_PTR(&py_omv_disable_fb_obj) },
+    { MP_ROM_QSTR(MP_QSTR_jpeg_rate),       MP_ROM_PTR(&py_omv_jpeg_rate_obj) },
+    { MP_ROM_QSTR(MP_QSTR_fb_alloc_peak),   MP_ROM_PTR(&py_omv_fb_alloc_peak_obj) },
+    { MP_ROM_QSTR(MP_QSTR_umm_stats),       MP_ROM_PTR(&py_omv_umm_stats_obj) },
+    { MP_ROM_QSTR(MP_QSTR_frame_arena),     MP_ROM_PTR(&py_omv_frame_arena_obj) },
+    { MP_ROM_QSTR(MP_QSTR_energy),          MP_ROM_PTR(&py_omv_energy_obj) },
+    #if OMV_FB_ALLOC_TAGS_ENABLE
+    { MP_ROM_QSTR(MP_QSTR_fb_alloc_stack),  MP_ROM_PTR(&py_omv_fb_alloc_stack_obj) },
+    #else
+    { MP_ROM_QSTR(MP_QSTR_fb_alloc_stack),  MP_ROM_PTR(&py_func_unavailable_obj) },
+    #endif
+    #if OMV_PROFILE_ENABLE
+    { MP_ROM_QSTR(MP_QSTR_profile),         MP_ROM_PTR(&py_omv_profile_obj) },
+    #else
+    { MP_ROM_QSTR(MP_QSTR_profile),         MP_ROM_PTR(&py_func_unavailable_obj) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(globals_dict, globals_dict_table);
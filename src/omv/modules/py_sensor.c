@@ -27,11 +27,25 @@
 #include "omv_i2c.h"
 #include "py_helper.h"
 #include "framebuffer.h"
+#include "trace.h"
+#include "omv_energy.h"
 
 extern sensor_t sensor;
 static mp_obj_t vsync_callback = mp_const_none;
 static mp_obj_t frame_callback = mp_const_none;
 
+// Frames completed longer ago than this are dropped by snapshot(), -1 to disable.
+static int32_t max_frame_age_us = -1;
+// Sequence number of the last frame returned by snapshot().
+static uint32_t last_frame_seq = 0;
+
+#ifdef IMLIB_ENABLE_ISP_OPS
+// Fused ISP stage run on each snapshot, the white balance gains come from the previous frame.
+static bool isp_enable = false;
+static isp_config_t isp_config;
+static isp_stats_t isp_stats;
+#endif
+
 #define sensor_raise_error(err) mp_raise_msg(&mp_type_RuntimeError, (mp_rom_error_text_t) sensor_strerror(err))
 #define sensor_print_error(op)  printf("\x1B[31mWARNING: %s control is not supported by this image sensor.\x1B[0m\n", op);
 
@@ -85,6 +99,13 @@ static mp_obj_t py_sensor_reset() {
     if (error != 0) {
         sensor_raise_error(error);
     }
+    omv_energy_set_sensor(OMV_ENERGY_SENSOR_ON);
+    framebuffer_set_latest(false);
+    max_frame_age_us = -1;
+    last_frame_seq = 0;
+    #ifdef IMLIB_ENABLE_ISP_OPS
+    isp_enable = false;
+    #endif
     #if MICROPY_PY_IMU
     // +-10 degree dead-zone around pitch 90/270.
     // +-45 degree active-zone around roll 0/90/180/270/360.
@@ -98,22 +119,78 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_reset_obj, py_sensor_reset);
 
 static mp_obj_t py_sensor_sleep(mp_obj_t enable) {
     PY_ASSERT_FALSE_MSG(sensor_sleep(mp_obj_is_true(enable)) != 0, "Sleep Failed");
+    omv_energy_set_sensor(mp_obj_is_true(enable) ? OMV_ENERGY_SENSOR_SLEEP : OMV_ENERGY_SENSOR_ON);
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_sensor_sleep_obj, py_sensor_sleep);
 
 static mp_obj_t py_sensor_shutdown(mp_obj_t enable) {
     PY_ASSERT_FALSE_MSG(sensor_shutdown(mp_obj_is_true(enable)) != 0, "Shutdown Failed");
+    omv_energy_set_sensor(mp_obj_is_true(enable) ? OMV_ENERGY_SENSOR_OFF : OMV_ENERGY_SENSOR_ON);
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_sensor_shutdown_obj, py_sensor_shutdown);
 
+static mp_obj_t py_sensor_wait_for_motion(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_timeout, ARG_stop_mode };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_timeout, MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_stop_mode, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+    };
+
+    // Parse args.
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    int timeout = args[ARG_timeout].u_int;
+    int error = sensor_wait_for_motion((timeout > 0) ? timeout : 0, args[ARG_stop_mode].u_bool);
+    if ((error != 0) && (error != SENSOR_ERROR_CAPTURE_TIMEOUT)) {
+        sensor_raise_error(error);
+    }
+    return mp_obj_new_bool(error == 0);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_sensor_wait_for_motion_obj, 0, py_sensor_wait_for_motion);
+
+static mp_obj_t py_sensor_set_trigger(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_enable, ARG_master };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_enable, MP_ARG_REQUIRED | MP_ARG_BOOL },
+        { MP_QSTR_master, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+    };
+
+    // Parse args.
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    int error = sensor_set_trigger(args[ARG_enable].u_bool, args[ARG_master].u_bool);
+    if (error != 0) {
+        sensor_raise_error(error);
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_sensor_set_trigger_obj, 1, py_sensor_set_trigger);
+
+static mp_obj_t py_sensor_get_trigger() {
+    return mp_obj_new_bool(sensor.trigger);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_get_trigger_obj, py_sensor_get_trigger);
+
+static mp_obj_t py_sensor_get_timestamp() {
+    return mp_obj_new_int_from_uint(framebuffer_get_current_buffer()->info.sof_us);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_get_timestamp_obj, py_sensor_get_timestamp);
+
 static mp_obj_t py_sensor_flush() {
     framebuffer_update_jpeg_buffer();
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_flush_obj, py_sensor_flush);
 
+// Ports that don't timestamp the end of frame report an age of 0.
+static uint32_t py_sensor_frame_age_us(const frame_info_t *info) {
+    return info->eof_us ? (mp_hal_ticks_us() - info->eof_us) : 0;
+}
+
 static mp_obj_t py_sensor_snapshot(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     #if MICROPY_PY_IMU
     // +-10 degree dead-zone around pitch 90/270.
@@ -123,15 +200,91 @@ static mp_obj_t py_sensor_snapshot(uint n_args, const mp_obj_t *args, mp_map_t *
     // We're not setting the full range on roll to prevent oscillation.
     #endif // MICROPY_PY_IMU
 
-    mp_obj_t image = py_image(0, 0, 0, 0, 0);
-    int error = sensor.snapshot(&sensor, (image_t *) py_image_cobj(image), 0);
+    // Note: skip_frames() calls snapshot without a keyword map.
+    bool pin = (kw_args != NULL) && py_helper_keyword_int(n_args, args, 0, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_pin), false);
+    mp_map_elem_t *into = (kw_args != NULL) ? mp_map_lookup(kw_args, MP_ROM_QSTR(MP_QSTR_into), MP_MAP_LOOKUP) : NULL;
+    PY_ASSERT_TRUE_MSG(!(pin && into), "Can't pin a frame captured into an image!");
+
+    image_t frame = {};
+    int error;
+    {
+        TRACE_PROF_SCOPE(TRACE_PROF_SNAPSHOT);
+        error = sensor.snapshot(&sensor, &frame, 0);
+
+        // Drop frames that missed the deadline. Each retry releases the stale frame so capture
+        // can resume, after a buffer's worth of retries the frames are new captures.
+        for (int i = 0; (!error) && (max_frame_age_us >= 0) && (i < framebuffer->n_buffers); i++) {
+            if (py_sensor_frame_age_us(&framebuffer_get_current_buffer()->info) <= ((uint32_t) max_frame_age_us)) {
+                break;
+            }
+            error = sensor.snapshot(&sensor, &frame, 0);
+        }
+    }
     if (error != 0) {
         sensor_raise_error(error);
     }
+
+    frame_info_t *info = &framebuffer_get_current_buffer()->info;
+    info->age_us = py_sensor_frame_age_us(info);
+    info->dropped = (last_frame_seq && (info->seq > last_frame_seq)) ? (info->seq - last_frame_seq - 1) : 0;
+    last_frame_seq = info->seq;
+
+    omv_energy_frame();
+
+    // Meter the frame as captured, before the ISP stage changes its brightness.
+    sensor_update_ae(&frame);
+
+    #ifdef IMLIB_ENABLE_ISP_OPS
+    if (isp_enable) {
+        fb_alloc_mark();
+        imlib_isp(&frame, &isp_config, &isp_stats);
+        fb_alloc_free_till_mark();
+    }
+    #endif
+
+    mp_obj_t image;
+    if (pin) {
+        // Hand the vbuffer itself to the image. Capture skips it until the image is released.
+        image = py_image_from_vbuffer(&frame);
+        if (image == MP_OBJ_NULL) {
+            mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Pinning requires triple buffering and no other pinned frames"));
+        }
+    } else if (into) {
+        // Reuse the image object (and its pixels if it has its own) instead of allocating one.
+        image = py_image_reuse(into->value, &frame);
+    } else {
+        image = py_image_from_struct(&frame);
+    }
+
+    py_image_set_frame_info(image, info);
     return image;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_sensor_snapshot_obj, 0, py_sensor_snapshot);
 
+static mp_obj_t py_sensor_snapshot_hdr(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_get_array(args[0], &len, &items);
+    PY_ASSERT_TRUE_MSG((2 <= len) && (len <= IMLIB_HDR_MAX_FRAMES), "Expected 2 to 8 exposures!");
+
+    int exposures_us[IMLIB_HDR_MAX_FRAMES];
+    for (size_t i = 0; i < len; i++) {
+        exposures_us[i] = mp_obj_get_int(items[i]);
+    }
+
+    int latency = py_helper_keyword_int(n_args, args, 1, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_latency), 1);
+
+    mp_obj_t image = py_image(0, 0, 0, 0, 0);
+    int error = sensor_snapshot_hdr((image_t *) py_image_cobj(image), exposures_us, len, latency);
+    if (error != 0) {
+        sensor_raise_error(error);
+    }
+
+    py_image_set_frame_info(image, &framebuffer_get_current_buffer()->info);
+    return image;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_sensor_snapshot_hdr_obj, 1, py_sensor_snapshot_hdr);
+
 static mp_obj_t py_sensor_skip_frames(uint n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     mp_map_elem_t *kw_arg = mp_map_lookup(kw_args, MP_ROM_QSTR(MP_QSTR_time), MP_MAP_LOOKUP);
     mp_int_t time = 300; // OV Recommended.
@@ -182,6 +335,16 @@ static mp_obj_t py_sensor_get_fb() {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_get_fb_obj, py_sensor_get_fb);
 
+static mp_obj_t py_sensor_get_dual_fb() {
+    image_t image;
+    if (sensor_get_dual_image(&image) != 0) {
+        return mp_const_none;
+    }
+
+    return py_image_from_struct(&image);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_get_dual_fb_obj, py_sensor_get_dual_fb);
+
 static mp_obj_t py_sensor_get_id() {
     return mp_obj_new_int(sensor_get_id());
 }
@@ -485,6 +648,32 @@ static mp_obj_t py_sensor_get_exposure_us() {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_get_exposure_us_obj, py_sensor_get_exposure_us);
 
+static mp_obj_t py_sensor_set_ae(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_target, ARG_exposure_us_max, ARG_gain_db_ceiling };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_target, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 128} },
+        { MP_QSTR_exposure_us_max, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = -1} },
+        { MP_QSTR_gain_db_ceiling, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+    };
+
+    // Parse args.
+    int enable = mp_obj_get_int(pos_args[0]);
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    float gain_db_ceiling = py_helper_arg_to_float(args[ARG_gain_db_ceiling].u_obj, 24.0f);
+
+    int error = sensor_set_ae(enable, args[ARG_target].u_int, args[ARG_exposure_us_max].u_int, gain_db_ceiling);
+    if (error != 0) {
+        if (error != SENSOR_ERROR_CTL_UNSUPPORTED) {
+            sensor_raise_error(error);
+        }
+        sensor_print_error("Firmware Auto Exposure");
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_sensor_set_ae_obj, 1, py_sensor_set_ae);
+
 static mp_obj_t py_sensor_set_auto_whitebal(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     enum { ARG_rgb_gain_db };
     static const mp_arg_t allowed_args[] = {
@@ -524,6 +713,45 @@ static mp_obj_t py_sensor_get_rgb_gain_db() {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_get_rgb_gain_db_obj, py_sensor_get_rgb_gain_db);
 
+#ifdef IMLIB_ENABLE_ISP_OPS
+static mp_obj_t py_sensor_set_isp(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_max, ARG_ccm, ARG_gamma, ARG_contrast, ARG_brightness, ARG_row_step };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_max, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
+        { MP_QSTR_ccm, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_gamma, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_contrast, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_brightness, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_row_step, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 4} },
+    };
+
+    // Parse args.
+    bool enable = mp_obj_is_true(pos_args[0]);
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    isp_config = (isp_config_t) {
+        .awb = true,
+        .awb_max = args[ARG_max].u_bool,
+        .ccm_enable = args[ARG_ccm].u_obj != mp_const_none,
+        .gamma = py_helper_arg_to_float(args[ARG_gamma].u_obj, 1.0f),
+        .contrast = py_helper_arg_to_float(args[ARG_contrast].u_obj, 1.0f),
+        .brightness = py_helper_arg_to_float(args[ARG_brightness].u_obj, 0.0f),
+        .row_step = args[ARG_row_step].u_int,
+    };
+
+    if (isp_config.ccm_enable) {
+        isp_config.ccm_offset = py_helper_arg_to_ccm(args[ARG_ccm].u_obj, isp_config.ccm);
+    }
+
+    // Gains start at 1x until the next snapshot collects statistics.
+    isp_stats = (isp_stats_t) {};
+    isp_enable = enable;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_sensor_set_isp_obj, 1, py_sensor_set_isp);
+#endif // IMLIB_ENABLE_ISP_OPS
+
 static mp_obj_t py_sensor_set_auto_blc(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     enum { ARG_enable, ARG_regs };
     static const mp_arg_t allowed_args[] = {
@@ -627,6 +855,36 @@ static mp_obj_t py_sensor_get_auto_rotation() {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_get_auto_rotation_obj, py_sensor_get_auto_rotation);
 
+static mp_obj_t py_sensor_set_debayer(mp_obj_t pixformat) {
+    int error = sensor_set_debayer((pixformat == mp_const_none) ? 0 : mp_obj_get_int(pixformat));
+    if (error != 0) {
+        sensor_raise_error(error);
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_sensor_set_debayer_obj, py_sensor_set_debayer);
+
+static mp_obj_t py_sensor_get_debayer() {
+    pixformat_t pixformat = sensor_get_debayer();
+    return pixformat ? mp_obj_new_int(pixformat) : mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_get_debayer_obj, py_sensor_get_debayer);
+
+static mp_obj_t py_sensor_set_dual_output(mp_obj_t scale) {
+    int error = sensor_set_dual_output((scale == mp_const_none) ? 0 : mp_obj_get_int(scale));
+    if (error != 0) {
+        sensor_raise_error(error);
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_sensor_set_dual_output_obj, py_sensor_set_dual_output);
+
+static mp_obj_t py_sensor_get_dual_output() {
+    uint32_t scale = sensor_get_dual_output();
+    return scale ? mp_obj_new_int(scale) : mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_get_dual_output_obj, py_sensor_get_dual_output);
+
 static mp_obj_t py_sensor_set_framebuffers(mp_obj_t count) {
     mp_int_t c = mp_obj_get_int(count);
 
@@ -652,6 +910,30 @@ static mp_obj_t py_sensor_get_framebuffers() {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_get_framebuffers_obj, py_sensor_get_framebuffers);
 
+// Low latency acquisition: snapshot() returns the newest frame and with 3 or more frame buffers
+// capture never waits for unread frames. Frames older than max_age_us are dropped too.
+static mp_obj_t py_sensor_set_latest_frame(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_enable, ARG_max_age_us };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_enable, MP_ARG_REQUIRED | MP_ARG_BOOL, {.u_bool = true} },
+        { MP_QSTR_max_age_us, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = -1} },
+    };
+
+    // Parse args.
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    framebuffer_set_latest(args[ARG_enable].u_bool);
+    max_frame_age_us = args[ARG_enable].u_bool ? args[ARG_max_age_us].u_int : -1;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_sensor_set_latest_frame_obj, 1, py_sensor_set_latest_frame);
+
+static mp_obj_t py_sensor_get_latest_frame() {
+    return mp_obj_new_bool(framebuffer_get_latest());
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_sensor_get_latest_frame_obj, py_sensor_get_latest_frame);
+
 static mp_obj_t py_sensor_disable_delays(uint n_args, const mp_obj_t *args) {
     if (!n_args) {
         return mp_obj_new_bool(sensor.disable_delays);
@@ -760,7 +1042,8 @@ static mp_obj_t py_sensor_ioctl(uint n_args, const mp_obj_t *args) {
             break;
         }
 
-        case IOCTL_GET_READOUT_WINDOW: {
+        case IOCTL_GET_READOUT_WINDOW:
+        case IOCTL_GET_OUTPUT_WINDOW: {
             int x, y, w, h;
             error = sensor_ioctl(request, &x, &y, &w, &h);
             if (error == 0) {
@@ -1044,6 +1327,8 @@ STATIC const mp_rom_map_elem_t globals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_BAYER),               MP_ROM_INT(PIXFORMAT_BAYER)},       /* 1BPP/RAW*/
     { MP_ROM_QSTR(MP_QSTR_YUV422),              MP_ROM_INT(PIXFORMAT_YUV422)},      /* 2BPP/YUV422*/
     { MP_ROM_QSTR(MP_QSTR_JPEG),                MP_ROM_INT(PIXFORMAT_JPEG)},        /* JPEG/COMPRESSED*/
+    { MP_ROM_QSTR(MP_QSTR_RAW10),               MP_ROM_INT(PIXFORMAT_RAW10)},       /* 10-bit/PACKED*/
+    { MP_ROM_QSTR(MP_QSTR_RAW12),               MP_ROM_INT(PIXFORMAT_RAW12)},       /* 12-bit/PACKED*/
 
     // Image Sensors
     { MP_ROM_QSTR(MP_QSTR_OV2640),              MP_ROM_INT(OV2640_ID)},
@@ -1120,6 +1405,7 @@ STATIC const mp_rom_map_elem_t globals_dict_table[] = {
     // IOCTLs
     { MP_ROM_QSTR(MP_QSTR_IOCTL_SET_READOUT_WINDOW),            MP_ROM_INT(IOCTL_SET_READOUT_WINDOW)},
     { MP_ROM_QSTR(MP_QSTR_IOCTL_GET_READOUT_WINDOW),            MP_ROM_INT(IOCTL_GET_READOUT_WINDOW)},
+    { MP_ROM_QSTR(MP_QSTR_IOCTL_GET_OUTPUT_WINDOW),             MP_ROM_INT(IOCTL_GET_OUTPUT_WINDOW)},
     { MP_ROM_QSTR(MP_QSTR_IOCTL_SET_TRIGGERED_MODE),            MP_ROM_INT(IOCTL_SET_TRIGGERED_MODE)},
     { MP_ROM_QSTR(MP_QSTR_IOCTL_GET_TRIGGERED_MODE),            MP_ROM_INT(IOCTL_GET_TRIGGERED_MODE)},
     { MP_ROM_QSTR(MP_QSTR_IOCTL_SET_FOV_WIDE),                  MP_ROM_INT(IOCTL_SET_FOV_WIDE)},
@@ -1159,12 +1445,18 @@ STATIC const mp_rom_map_elem_t globals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_reset),               MP_ROM_PTR(&py_sensor_reset_obj) },
     { MP_ROM_QSTR(MP_QSTR_sleep),               MP_ROM_PTR(&py_sensor_sleep_obj) },
     { MP_ROM_QSTR(MP_QSTR_shutdown),            MP_ROM_PTR(&py_sensor_shutdown_obj) },
+    { MP_ROM_QSTR(MP_QSTR_wait_for_motion),     MP_ROM_PTR(&py_sensor_wait_for_motion_obj) },
+    { MP_ROM_QSTR(MP_QSTR_set_trigger),         MP_ROM_PTR(&py_sensor_set_trigger_obj) },
+    { MP_ROM_QSTR(MP_QSTR_get_trigger),         MP_ROM_PTR(&py_sensor_get_trigger_obj) },
+    { MP_ROM_QSTR(MP_QSTR_get_timestamp),       MP_ROM_PTR(&py_sensor_get_timestamp_obj) },
     { MP_ROM_QSTR(MP_QSTR_flush),               MP_ROM_PTR(&py_sensor_flush_obj) },
     { MP_ROM_QSTR(MP_QSTR_snapshot),            MP_ROM_PTR(&py_sensor_snapshot_obj) },
+    { MP_ROM_QSTR(MP_QSTR_snapshot_hdr),        MP_ROM_PTR(&py_sensor_snapshot_hdr_obj) },
     { MP_ROM_QSTR(MP_QSTR_skip_frames),         MP_ROM_PTR(&py_sensor_skip_frames_obj) },
     { MP_ROM_QSTR(MP_QSTR_width),               MP_ROM_PTR(&py_sensor_width_obj) },
     { MP_ROM_QSTR(MP_QSTR_height),              MP_ROM_PTR(&py_sensor_height_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_fb),              MP_ROM_PTR(&py_sensor_get_fb_obj) },
+    { MP_ROM_QSTR(MP_QSTR_get_dual_fb),         MP_ROM_PTR(&py_sensor_get_dual_fb_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_id),              MP_ROM_PTR(&py_sensor_get_id_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_frame_available), MP_ROM_PTR(&py_sensor_get_frame_available_obj) },
     { MP_ROM_QSTR(MP_QSTR_alloc_extra_fb),      MP_ROM_PTR(&py_sensor_alloc_extra_fb_obj) },
@@ -1187,8 +1479,12 @@ STATIC const mp_rom_map_elem_t globals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_get_gain_db),         MP_ROM_PTR(&py_sensor_get_gain_db_obj) },
     { MP_ROM_QSTR(MP_QSTR_set_auto_exposure),   MP_ROM_PTR(&py_sensor_set_auto_exposure_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_exposure_us),     MP_ROM_PTR(&py_sensor_get_exposure_us_obj) },
+    { MP_ROM_QSTR(MP_QSTR_set_ae),              MP_ROM_PTR(&py_sensor_set_ae_obj) },
     { MP_ROM_QSTR(MP_QSTR_set_auto_whitebal),   MP_ROM_PTR(&py_sensor_set_auto_whitebal_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_rgb_gain_db),     MP_ROM_PTR(&py_sensor_get_rgb_gain_db_obj) },
+    #ifdef IMLIB_ENABLE_ISP_OPS
+    { MP_ROM_QSTR(MP_QSTR_set_isp),             MP_ROM_PTR(&py_sensor_set_isp_obj) },
+    #endif
     { MP_ROM_QSTR(MP_QSTR_set_auto_blc),        MP_ROM_PTR(&py_sensor_set_auto_blc_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_blc_regs),        MP_ROM_PTR(&py_sensor_get_blc_regs_obj) },
     { MP_ROM_QSTR(MP_QSTR_set_hmirror),         MP_ROM_PTR(&py_sensor_set_hmirror_obj) },
@@ -1199,8 +1495,14 @@ STATIC const mp_rom_map_elem_t globals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_get_transpose),       MP_ROM_PTR(&py_sensor_get_transpose_obj) },
     { MP_ROM_QSTR(MP_QSTR_set_auto_rotation),   MP_ROM_PTR(&py_sensor_set_auto_rotation_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_auto_rotation),   MP_ROM_PTR(&py_sensor_get_auto_rotation_obj) },
+    { MP_ROM_QSTR(MP_QSTR_set_debayer),         MP_ROM_PTR(&py_sensor_set_debayer_obj) },
+    { MP_ROM_QSTR(MP_QSTR_get_debayer),         MP_ROM_PTR(&py_sensor_get_debayer_obj) },
+    { MP_ROM_QSTR(MP_QSTR_set_dual_output),     MP_ROM_PTR(&py_sensor_set_dual_output_obj) },
+    { MP_ROM_QSTR(MP_QSTR_get_dual_output),     MP_ROM_PTR(&py_sensor_get_dual_output_obj) },
     { MP_ROM_QSTR(MP_QSTR_set_framebuffers),    MP_ROM_PTR(&py_sensor_set_framebuffers_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_framebuffers),    MP_ROM_PTR(&py_sensor_get_framebuffers_obj) },
+    { MP_ROM_QSTR(MP_QSTR_set_latest_frame),    MP_ROM_PTR(&py_sensor_set_latest_frame_obj) },
+    { MP_ROM_QSTR(MP_QSTR_get_latest_frame),    MP_ROM_PTR(&py_sensor_get_latest_frame_obj) },
     { MP_ROM_QSTR(MP_QSTR_disable_delays),      MP_ROM_PTR(&py_sensor_disable_delays_obj) },
     { MP_ROM_QSTR(MP_QSTR_disable_full_flush),  MP_ROM_PTR(&py_sensor_disable_full_flush_obj) },
     { MP_ROM_QSTR(MP_QSTR_set_special_effect),  MP_ROM_PTR(&py_sensor_set_special_effect_obj) },
@@ -20,10 +20,14 @@
 #include "py_image.h"
 #include "omv_gpio.h"
 #include "omv_spi.h"
+#include "omv_cache.h"
+#include "omv_energy.h"
 #include "py_display.h"
 
 #define LCD_COMMAND_DISPOFF         (0x28)
 #define LCD_COMMAND_DISPON          (0x29)
+#define LCD_COMMAND_CASET           (0x2A)
+#define LCD_COMMAND_RASET           (0x2B)
 #define LCD_COMMAND_RAMWR           (0x2C)
 #define LCD_COMMAND_SLPOUT          (0x11)
 #define LCD_COMMAND_MADCTL          (0x36)
@@ -87,54 +91,44 @@ static void spi_display_command(py_display_obj_t *self, uint8_t cmd, uint8_t arg
     spi_write(self, cmd, &arg, (arg > 0) ? 1 : 0, false);
 }
 
+static void spi_display_callback(omv_spi_t *spi, void *userdata, void *buf);
+
+// Sends the tail frame buffer as one chained transfer.
+static void spi_display_frame_start(py_display_obj_t *self) {
+    self->spi_segment.txbuf = self->framebuffers[self->framebuffer_tail];
+    self->spi_segment.size = self->width * self->height * sizeof(uint16_t);
+    self->spi_segment.rows = 1;
+    self->spi_segment.stride = 0;
+    self->spi_chain.callback = spi_display_callback;
+    self->framebuffer_head = self->framebuffer_tail;
+    omv_spi_chain_start(&self->spi_bus, &self->spi_chain);
+}
+
+// Called from the IRQ at the end of each frame.
 static void spi_display_callback(omv_spi_t *spi, void *userdata, void *buf) {
     py_display_obj_t *self = (py_display_obj_t *) userdata;
 
-    static uint8_t *spi_state_write_addr = NULL;
-    static size_t spi_state_write_count = 0;
-
-    // If userdata is not null then it means that we are being kicked off.
-    if (buf == NULL) {
-        spi_state_write_count = 0;
-    }
-
-    if (!spi_state_write_count) {
-        spi_state_write_addr = (uint8_t *) self->framebuffers[self->framebuffer_tail];
-        spi_state_write_count = self->width * self->height;
-
-        if (self->byte_swap) {
-            spi_state_write_count *= 2;
-        }
-
-        self->framebuffer_head = self->framebuffer_tail;
-    }
-
-    size_t spi_state_write_limit = (!self->byte_swap) ? OMV_SPI_MAX_16BIT_XFER : OMV_SPI_MAX_8BIT_XFER;
-    uint8_t *addr = spi_state_write_addr;
-    size_t count = IM_MIN(spi_state_write_count, spi_state_write_limit);
+    #if defined(OMV_SPI_DISPLAY_TE_PIN)
+    // Stop after each frame. The next frame starts at the panel's tearing effect edge, so
+    // the write pointer stays ahead of the scan and a new frame is never queued behind a
+    // resend of the old one.
+    self->spi_te_wait = true;
+    #else
+    spi_display_frame_start(self);
+    #endif
+}
 
-    spi_state_write_addr += (!self->byte_swap) ? (count * 2) : count;
-    spi_state_write_count -= count;
+#if defined(OMV_SPI_DISPLAY_TE_PIN)
+static void spi_display_te_callback(void *data) {
+    py_display_obj_t *self = (py_display_obj_t *) data;
 
-    // When starting the interrupt chain the first transfer is not executed in interrupt context.
-    // So, disable interrupts for the first transfer so that it completes first and unlocks the
-    // SPI bus before allowing the interrupt it causes to trigger starting the interrupt chain.
-    omv_spi_transfer_t spi_xfer = {
-        .txbuf = addr,
-        .size = count,
-        .flags = OMV_SPI_XFER_DMA,
-        .userdata = self,
-        .callback = spi_display_callback,
-    };
-
-    if (buf == NULL) {
-        uint32_t irq_state = disable_irq();
-        omv_spi_transfer_start(&self->spi_bus, &spi_xfer);
-        enable_irq(irq_state);
-    } else {
-        omv_spi_transfer_start(&self->spi_bus, &spi_xfer);
+    // Only send frames the display doesn't already show.
+    if (self->spi_te_wait && (self->framebuffer_tail != self->framebuffer_head)) {
+        self->spi_te_wait = false;
+        spi_display_frame_start(self);
     }
 }
+#endif
 
 static void spi_display_kick(py_display_obj_t *self) {
     if (!self->spi_tx_running) {
@@ -158,7 +152,134 @@ static void spi_display_kick(py_display_obj_t *self) {
 
         // Kickoff interrupt driven image update.
         self->spi_tx_running = true;
-        spi_display_callback(&self->spi_bus, self, NULL);
+        #if defined(OMV_SPI_DISPLAY_TE_PIN)
+        // The first frame was just sent, wait for the next one.
+        self->framebuffer_head = self->framebuffer_tail;
+        self->spi_te_wait = true;
+        omv_gpio_irq_enable(OMV_SPI_DISPLAY_TE_PIN, true);
+        #else
+        spi_display_frame_start(self);
+        #endif
+    }
+}
+
+// Called from the IRQ once the window is sent.
+static void spi_display_partial_callback(omv_spi_t *spi, void *userdata, void *buf) {
+    py_display_obj_t *self = (py_display_obj_t *) userdata;
+    self->spi_partial_busy = false;
+}
+
+// Sends the window in spi_partial_rect of the head frame buffer. Each window row is a row of
+// the chain segment unless the window is full width, in which case the rows are contiguous.
+static void spi_display_partial_start(py_display_obj_t *self) {
+    rectangle_t *r = &self->spi_partial_rect;
+    self->spi_segment.txbuf = self->framebuffers[self->framebuffer_head] + (r->y * self->width) + r->x;
+    self->spi_segment.size = r->w * sizeof(uint16_t);
+    self->spi_segment.rows = r->h;
+    self->spi_segment.stride = self->width * sizeof(uint16_t);
+
+    if (r->w == self->width) {
+        self->spi_segment.size *= r->h;
+        self->spi_segment.rows = 1;
+    }
+
+    self->spi_chain.callback = spi_display_partial_callback;
+    omv_spi_chain_start(&self->spi_bus, &self->spi_chain);
+}
+
+// Waits for the last window to be sent and returns the bus to command mode.
+static void spi_display_partial_sync(py_display_obj_t *self) {
+    while (self->spi_partial_busy) {
+        __WFI();
+    }
+
+    if (self->spi_tx_running) {
+        self->spi_tx_running = false;
+        spi_switch_mode(self, 8, false);
+        omv_gpio_write(OMV_SPI_DISPLAY_SSEL_PIN, 1);
+    }
+}
+
+// Returns the bounds of the pixels that differ between two frame buffers, or false if equal.
+static bool spi_display_dirty_rect(py_display_obj_t *self, uint16_t *old_fb, uint16_t *new_fb, rectangle_t *r) {
+    int w = self->width, y_start = 0, y_end = self->height;
+    size_t row_size = w * sizeof(uint16_t);
+
+    while ((y_start < y_end) && (!memcmp(old_fb + (y_start * w), new_fb + (y_start * w), row_size))) {
+        y_start++;
+    }
+
+    if (y_start == y_end) {
+        return false;
+    }
+
+    while (!memcmp(old_fb + ((y_end - 1) * w), new_fb + ((y_end - 1) * w), row_size)) {
+        y_end--;
+    }
+
+    int x_start = w, x_end = 0;
+
+    for (int y = y_start; y < y_end; y++) {
+        uint16_t *old_row = old_fb + (y * w), *new_row = new_fb + (y * w);
+        int x = 0;
+
+        while ((x < x_start) && (old_row[x] == new_row[x])) {
+            x++;
+        }
+
+        x_start = x;
+        x = w;
+
+        while ((x > x_end) && (old_row[x - 1] == new_row[x - 1])) {
+            x--;
+        }
+
+        x_end = x;
+    }
+
+    r->x = x_start;
+    r->y = y_start;
+    r->w = x_end - x_start;
+    r->h = y_end - y_start;
+    return true;
+}
+
+// Sends the part of the new frame buffer that differs from the frame on the display using a
+// CASET/RASET window. Unlike the triple buffer refresh loop the bus is idle once it's sent.
+static void spi_display_partial_update(py_display_obj_t *self, int framebuffer) {
+    rectangle_t *r = &self->spi_partial_rect;
+
+    spi_display_partial_sync(self);
+
+    if (!self->spi_partial_valid) {
+        r->x = 0;
+        r->y = 0;
+        r->w = self->width;
+        r->h = self->height;
+    } else if (!spi_display_dirty_rect(self, self->framebuffers[self->framebuffer_head],
+                                       self->framebuffers[framebuffer], r)) {
+        return;
+    }
+
+    self->framebuffer_tail = framebuffer;
+    self->framebuffer_head = framebuffer;
+
+    int x_end = r->x + r->w - 1, y_end = r->y + r->h - 1;
+    spi_write(self, LCD_COMMAND_CASET, (uint8_t []) { r->x >> 8, r->x, x_end >> 8, x_end }, 4, false);
+    spi_write(self, LCD_COMMAND_RASET, (uint8_t []) { r->y >> 8, r->y, y_end >> 8, y_end }, 4, false);
+    spi_display_command(self, LCD_COMMAND_RAMWR, 0);
+    spi_switch_mode(self, (!self->byte_swap) ? 16 : 8, true);
+    omv_gpio_write(OMV_SPI_DISPLAY_SSEL_PIN, 0);
+
+    self->spi_tx_running = true;
+    self->spi_partial_busy = true;
+    spi_display_partial_start(self);
+
+    // Turn the display on once the first frame is sent.
+    if (!self->spi_partial_valid) {
+        spi_display_partial_sync(self);
+        spi_display_command(self, LCD_COMMAND_DISPON, 0);
+        self->spi_partial_valid = true;
     }
 }
 
@@ -261,10 +382,13 @@ static void spi_display_write(py_display_obj_t *self, image_t *src_img, int dst_
             }
         }
 
-        #ifdef __DCACHE_PRESENT
         // Flush data for DMA
-        SCB_CleanDCache_by_Addr((uint32_t *) dst_img.data, image_size(&dst_img));
-        #endif
+        omv_cache_clean(dst_img.data, image_size(&dst_img));
+
+        if (self->spi_partial) {
+            spi_display_partial_update(self, new_framebuffer_tail);
+            return;
+        }
 
         // Update tail which means a new image is ready.
         self->framebuffer_tail = new_framebuffer_tail;
@@ -278,12 +402,23 @@ static void spi_display_clear(py_display_obj_t *self, bool display_off) {
     if (display_off) {
         // turns the display off (may not be black)
         if (self->spi_tx_running) {
-            omv_spi_transfer_abort(&self->spi_bus);
+            #if defined(OMV_SPI_DISPLAY_TE_PIN)
+            omv_gpio_irq_enable(OMV_SPI_DISPLAY_TE_PIN, false);
+            self->spi_te_wait = false;
+            #endif
+            omv_spi_chain_abort(&self->spi_bus, &self->spi_chain);
             self->spi_tx_running = false;
             spi_switch_mode(self, 8, false);
             omv_gpio_write(OMV_SPI_DISPLAY_SSEL_PIN, 1);
         }
+        // An aborted window leaves the display partially updated.
+        self->spi_partial_busy = false;
+        self->spi_partial_valid = false;
     } else {
+        if (self->spi_partial) {
+            spi_display_partial_sync(self);
+            self->spi_partial_valid = false;
+        }
         spi_display_command(self, LCD_COMMAND_DISPOFF, 0);
         fb_alloc_mark();
         spi_display_write(self, NULL, 0, 0, 1.f, 1.f, NULL, 0, 0, NULL, NULL, 0);
@@ -300,22 +435,29 @@ static void spi_display_set_backlight(py_display_obj_t *self, uint32_t intensity
 
 static void spi_display_deinit(py_display_obj_t *self) {
     if (self->triple_buffer) {
-        omv_spi_transfer_abort(&self->spi_bus);
+        #if defined(OMV_SPI_DISPLAY_TE_PIN)
+        omv_gpio_irq_enable(OMV_SPI_DISPLAY_TE_PIN, false);
+        #endif
+        omv_spi_chain_abort(&self->spi_bus, &self->spi_chain);
         fb_alloc_free_till_mark_past_mark_permanent();
     }
 
     omv_spi_deinit(&self->spi_bus);
+    omv_energy_set_periph(OMV_ENERGY_PERIPH_DISPLAY, false);
     omv_gpio_deinit(OMV_SPI_DISPLAY_RS_PIN);
     omv_gpio_deinit(OMV_SPI_DISPLAY_RST_PIN);
     #ifdef OMV_SPI_DISPLAY_BL_PIN
     omv_gpio_deinit(OMV_SPI_DISPLAY_BL_PIN);
     #endif
+    #if defined(OMV_SPI_DISPLAY_TE_PIN)
+    omv_gpio_deinit(OMV_SPI_DISPLAY_TE_PIN);
+    #endif
 }
 
 mp_obj_t spi_display_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
     enum {
         ARG_width, ARG_height, ARG_refresh, ARG_bgr, ARG_byte_swap, ARG_triple_buffer,
-        ARG_controller, ARG_backlight
+        ARG_controller, ARG_backlight, ARG_partial
     };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_width,         MP_ARG_INT,  {.u_int = 128  } },
@@ -326,6 +468,7 @@ mp_obj_t spi_display_make_new(const mp_obj_type_t *type, size_t n_args, size_t n
         { MP_QSTR_triple_buffer, MP_ARG_BOOL, {.u_bool = LCD_TRIPLE_BUFFER_DEFAULT} },
         { MP_QSTR_controller,    MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
         { MP_QSTR_backlight,     MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_partial,       MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
     };
 
     // Parse args.
@@ -341,6 +484,10 @@ mp_obj_t spi_display_make_new(const mp_obj_type_t *type, size_t n_args, size_t n
     if ((args[ARG_refresh].u_int < 30) || (args[ARG_refresh].u_int > 120)) {
         mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Invalid Refresh Rate!"));
     }
+    // Partial updates diff against the frame on the display which needs the frame buffers.
+    if (args[ARG_partial].u_bool && (!args[ARG_triple_buffer].u_bool)) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Partial updates require triple buffering!"));
+    }
 
     py_display_obj_t *self = m_new_obj_with_finaliser(py_display_obj_t);
     self->base.type = &py_spi_display_type;
@@ -354,6 +501,22 @@ mp_obj_t spi_display_make_new(const mp_obj_type_t *type, size_t n_args, size_t n
     self->byte_swap = args[ARG_byte_swap].u_bool;
     self->controller = args[ARG_controller].u_obj;
     self->bl_controller = args[ARG_backlight].u_obj;
+    self->spi_tx_running = false;
+    self->spi_partial = args[ARG_partial].u_bool;
+    self->spi_partial_valid = false;
+    self->spi_partial_busy = false;
+    #if defined(OMV_SPI_DISPLAY_TE_PIN)
+    self->spi_te_wait = false;
+    #endif
+
+    // Frame buffers are sent with one chained transfer.
+    self->spi_chain.segments = &self->spi_segment;
+    self->spi_chain.n_segments = 1;
+    self->spi_chain.frame_size = (!self->byte_swap) ? sizeof(uint16_t) : sizeof(uint8_t);
+    self->spi_chain.max_size = (!self->byte_swap) ? OMV_SPI_MAX_16BIT_XFER : OMV_SPI_MAX_8BIT_XFER;
+    self->spi_chain.dc_pin = NULL;
+    self->spi_chain.userdata = self;
+    self->spi_chain.busy = false;
 
     omv_spi_config_t spi_config;
     omv_spi_default_config(&spi_config, OMV_SPI_DISPLAY_CONTROLLER);
@@ -402,8 +565,15 @@ mp_obj_t spi_display_make_new(const mp_obj_type_t *type, size_t n_args, size_t n
             self->framebuffers[i] = (uint16_t *) fb_alloc0(fb_size, FB_ALLOC_CACHE_ALIGN);
         }
         fb_alloc_mark_permanent();
+
+        #if defined(OMV_SPI_DISPLAY_TE_PIN)
+        // The IRQ is enabled once the refresh loop starts.
+        omv_gpio_config(OMV_SPI_DISPLAY_TE_PIN, OMV_GPIO_MODE_IT_RISE, OMV_GPIO_PULL_NONE, OMV_GPIO_SPEED_LOW, -1);
+        omv_gpio_irq_register(OMV_SPI_DISPLAY_TE_PIN, spi_display_te_callback, self);
+        #endif
     }
 
+    omv_energy_set_periph(OMV_ENERGY_PERIPH_DISPLAY, true);
     return MP_OBJ_FROM_PTR(self);
 }
 
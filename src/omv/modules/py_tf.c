@@ -14,14 +14,17 @@
 #include "py/objlist.h"
 #include "py/objtuple.h"
 #include "py/binary.h"
+#include "py/gc.h"
 
 #include "py_helper.h"
 #include "imlib_config.h"
 
 #ifdef IMLIB_ENABLE_TF
 #include "py_image.h"
+#include "omv_memcpy.h"
 #include "file_utils.h"
 #include "py_tf.h"
+#include "trace.h"
 #include "libtf_builtin_models.h"
 
 #define PY_TF_LOG_BUFFER_SIZE           (512)
@@ -51,6 +54,22 @@ void libtf_log_handler(const char *s) {
     }
 }
 
+STATIC int py_tf_invoke(py_tf_model_obj_t *model,
+                        uint8_t *tensor_arena,
+                        libtf_input_data_callback_t input_callback,
+                        void *input_callback_data,
+                        libtf_output_data_callback_t output_callback,
+                        void *output_callback_data) {
+    TRACE_PROF_SCOPE(TRACE_PROF_TF_INVOKE);
+    return libtf_invoke(model->data,
+                        tensor_arena,
+                        &model->params,
+                        input_callback,
+                        input_callback_data,
+                        output_callback,
+                        output_callback_data);
+}
+
 STATIC const char *py_tf_map_datatype(libtf_datatype_t datatype) {
     if (datatype == LIBTF_DATATYPE_UINT8) {
         return "uint8";
@@ -61,14 +80,6 @@ STATIC const char *py_tf_map_datatype(libtf_datatype_t datatype) {
     }
 }
 
-// TF Model Output Object.
-typedef struct py_tf_model_output_obj {
-    mp_obj_base_t base;
-    void *model_output;
-    libtf_parameters_t *params;
-    size_t output_size;
-} py_tf_model_output_obj_t;
-
 STATIC mp_obj_t py_tf_model_output_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t value) {
     if (value == MP_OBJ_SENTINEL) {
         // load
@@ -121,11 +132,12 @@ STATIC mp_obj_t py_tf_model_output_subscr(mp_obj_t self_in, mp_obj_t index, mp_o
 }
 
 STATIC mp_obj_t py_tf_model_output_get_image(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
-    enum { ARG_channel, ARG_roi, ARG_scale };
+    enum { ARG_channel, ARG_roi, ARG_scale, ARG_copy };
     static const mp_arg_t allowed_args[] = {
-        { MP_QSTR_channel, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0} },
+        { MP_QSTR_channel, MP_ARG_INT, {.u_int = 0} },
         { MP_QSTR_roi, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
         { MP_QSTR_scale, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = PY_TF_SCALE_0_1} },
+        { MP_QSTR_copy, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = true} },
     };
 
     // Parse args.
@@ -134,6 +146,28 @@ STATIC mp_obj_t py_tf_model_output_get_image(uint n_args, const mp_obj_t *pos_ar
 
     py_tf_model_output_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
 
+    // Returns the whole uint8/int8 output as a tensor image without converting it. Like the output
+    // object, the image points to the tensor arena and is only valid inside the callback.
+    if (!args[ARG_copy].u_bool) {
+        libtf_datatype_t datatype = self->params->output_datatype;
+        int channels = self->params->output_channels;
+
+        if ((datatype == LIBTF_DATATYPE_FLOAT) || ((channels != 1) && (channels != 3))) {
+            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Expected a uint8/int8 output with 1 or 3 channels!"));
+        }
+
+        image_t img = {
+            .w = self->params->output_width,
+            .h = self->params->output_height,
+            .pixfmt = (datatype == LIBTF_DATATYPE_INT8) ?
+                      ((channels == 1) ? PIXFORMAT_TENSOR_INT8 : PIXFORMAT_TENSOR_RGB_INT8) :
+                      ((channels == 1) ? PIXFORMAT_TENSOR_UINT8 : PIXFORMAT_TENSOR_RGB_UINT8),
+            .pixels = self->model_output
+        };
+
+        return py_image_from_struct(&img);
+    }
+
     image_t temp = {.w = self->params->output_width, .h = self->params->output_height};
     rectangle_t roi = py_helper_arg_to_roi(args[ARG_roi].u_obj, &temp);
 
@@ -192,7 +226,7 @@ STATIC const mp_rom_map_elem_t py_tf_model_output_locals_dict_table[] = {
 
 STATIC MP_DEFINE_CONST_DICT(py_tf_model_output_locals_dict, py_tf_model_output_locals_dict_table);
 
-STATIC MP_DEFINE_CONST_OBJ_TYPE(
+MP_DEFINE_CONST_OBJ_TYPE(
     py_tf_model_output_type,
     MP_QSTR_tf_model_output,
     MP_TYPE_FLAG_NONE,
@@ -209,12 +243,85 @@ typedef struct py_tf_input_callback_data {
     float stdev[3];
 } py_tf_input_callback_data_t;
 
+// Row state for converting the scaled input image into the model input one row at a time.
+typedef struct py_tf_input_row_data {
+    void *model_input;
+    int width;
+    float fscale[3];
+    float fadd[3];
+} py_tf_input_row_data_t;
+
+// GRAYSCALE float: drawn into the row buffer, normalized into the model input.
+STATIC void py_tf_input_row_grayscale_f32(int x_start, int x_end, int y_row, imlib_draw_row_data_t *data) {
+    py_tf_input_row_data_t *arg = (py_tf_input_row_data_t *) data->callback_arg;
+    uint8_t *src_u8 = (uint8_t *) data->dst_row_override;
+    float *row_f32 = ((float *) arg->model_input) + (y_row * arg->width);
+    float fscale = arg->fscale[0], fadd = arg->fadd[0];
+
+    for (int x = 0; x < arg->width; x++) {
+        row_f32[x] = (src_u8[x] * fscale) + fadd;
+    }
+}
+
+// RGB888 float: drawn into the row buffer as RGB565, normalized into the model input.
+STATIC void py_tf_input_row_rgb888_f32(int x_start, int x_end, int y_row, imlib_draw_row_data_t *data) {
+    py_tf_input_row_data_t *arg = (py_tf_input_row_data_t *) data->callback_arg;
+    uint16_t *src_u16 = (uint16_t *) data->dst_row_override;
+    float *row_f32 = ((float *) arg->model_input) + (y_row * arg->width * 3);
+    float fscale_r = arg->fscale[0], fadd_r = arg->fadd[0];
+    float fscale_g = arg->fscale[1], fadd_g = arg->fadd[1];
+    float fscale_b = arg->fscale[2], fadd_b = arg->fadd[2];
+
+    for (int x = 0; x < arg->width; x++, row_f32 += 3) {
+        int pixel = src_u16[x];
+        row_f32[0] = (COLOR_RGB565_TO_R8(pixel) * fscale_r) + fadd_r;
+        row_f32[1] = (COLOR_RGB565_TO_G8(pixel) * fscale_g) + fadd_g;
+        row_f32[2] = (COLOR_RGB565_TO_B8(pixel) * fscale_b) + fadd_b;
+    }
+}
+
+// Returns the image pixel format of a uint8/int8 model input, or PIXFORMAT_INVALID.
+STATIC pixformat_t py_tf_input_pixformat(libtf_parameters_t *params) {
+    if (params->input_datatype == LIBTF_DATATYPE_UINT8) {
+        return (params->input_channels == 1) ? PIXFORMAT_GRAYSCALE :
+               ((params->input_channels == 3) ? PIXFORMAT_TENSOR_RGB_UINT8 : PIXFORMAT_INVALID);
+    } else if (params->input_datatype == LIBTF_DATATYPE_INT8) {
+        return (params->input_channels == 1) ? PIXFORMAT_TENSOR_INT8 :
+               ((params->input_channels == 3) ? PIXFORMAT_TENSOR_RGB_INT8 : PIXFORMAT_INVALID);
+    }
+
+    return PIXFORMAT_INVALID;
+}
+
+// uint8/int8 inputs are drawn directly into the model input as tensor images, or copied if the
+// image already is one of the model input size (see image.to_tensor()). Float inputs are scaled
+// with imlib_draw_image() one row at a time into a row buffer and each row is normalized into
+// the model input while it's still in cache.
 STATIC void py_tf_input_callback(void *callback_data,
                                  void *model_input,
                                  libtf_parameters_t *params) {
     py_tf_input_callback_data_t *arg = (py_tf_input_callback_data_t *) callback_data;
+    image_t dst_img = {
+        .w = params->input_width,
+        .h = params->input_height,
+        .pixfmt = py_tf_input_pixformat(params),
+        .data = (uint8_t *) model_input
+    };
+
+    if (dst_img.pixfmt != PIXFORMAT_INVALID) {
+        if ((arg->img->pixfmt == dst_img.pixfmt) && (arg->img->w == dst_img.w) && (arg->img->h == dst_img.h)
+            && (!arg->roi->x) && (!arg->roi->y) && (arg->roi->w == dst_img.w) && (arg->roi->h == dst_img.h)) {
+            omv_memcpy(dst_img.data, arg->img->data, image_size(&dst_img));
+        } else {
+            // IMAGE_HINT_SCALE_ASPECT_EXPAND covers every row and column of the model input.
+            imlib_draw_image(&dst_img, arg->img, 0, 0, 1.0f, 1.0f, arg->roi,
+                             -1, 256, NULL, NULL, IMAGE_HINT_BILINEAR | IMAGE_HINT_CENTER |
+                             IMAGE_HINT_SCALE_ASPECT_EXPAND | IMAGE_HINT_BLACK_BACKGROUND,
+                             NULL, NULL, NULL);
+        }
+        return;
+    }
 
-    int shift = (params->input_datatype == LIBTF_DATATYPE_INT8) ? PY_TF_GRAYSCALE_MID : 0;
     float fscale = 1.0f, fadd = 0.0f;
 
     switch (arg->scale) {
@@ -233,102 +340,43 @@ STATIC void py_tf_input_callback(void *callback_data,
             break;
     }
 
-    float fscale_r = fscale, fadd_r = fadd;
-    float fscale_g = fscale, fadd_g = fadd;
-    float fscale_b = fscale, fadd_b = fadd;
-
-    // To normalize the input image we need to subtract the mean and divide by the standard deviation.
-    // We can do this by applying the normalization to fscale and fadd outside the loop.
-
-    // Red
-    fadd_r = (fadd_r - arg->mean[0]) / arg->stdev[0];
-    fscale_r /= arg->stdev[0];
-
-    // Green
-    fadd_g = (fadd_g - arg->mean[1]) / arg->stdev[1];
-    fscale_g /= arg->stdev[1];
-
-    // Blue
-    fadd_b = (fadd_b - arg->mean[2]) / arg->stdev[2];
-    fscale_b /= arg->stdev[2];
-
-    // Grayscale -> Y = 0.299R + 0.587G + 0.114B
-    float mean = (arg->mean[0] * 0.299f) + (arg->mean[1] * 0.587f) + (arg->mean[2] * 0.114f);
-    float std = (arg->stdev[0] * 0.299f) + (arg->stdev[1] * 0.587f) + (arg->stdev[2] * 0.114f);
-    fadd = (fadd - mean) / std;
-    fscale /= std;
+    py_tf_input_row_data_t row_data = {
+        .model_input = model_input,
+        .width = params->input_width
+    };
 
-    image_t dst_img;
-    dst_img.w = params->input_width;
-    dst_img.h = params->input_height;
-    dst_img.data = (uint8_t *) model_input;
+    imlib_draw_row_callback_t row_callback = NULL;
 
     if (params->input_channels == 1) {
+        // Grayscale -> Y = 0.299R + 0.587G + 0.114B
+        float mean = (arg->mean[0] * 0.299f) + (arg->mean[1] * 0.587f) + (arg->mean[2] * 0.114f);
+        float std = (arg->stdev[0] * 0.299f) + (arg->stdev[1] * 0.587f) + (arg->stdev[2] * 0.114f);
+        row_data.fadd[0] = (fadd - mean) / std;
+        row_data.fscale[0] = fscale / std;
+        row_callback = py_tf_input_row_grayscale_f32;
         dst_img.pixfmt = PIXFORMAT_GRAYSCALE;
     } else if (params->input_channels == 3) {
+        // To normalize the input image we need to subtract the mean and divide by the standard deviation.
+        // We can do this by applying the normalization to fscale and fadd outside the loop.
+        for (int i = 0; i < 3; i++) {
+            row_data.fadd[i] = (fadd - arg->mean[i]) / arg->stdev[i];
+            row_data.fscale[i] = fscale / arg->stdev[i];
+        }
+        row_callback = py_tf_input_row_rgb888_f32;
         dst_img.pixfmt = PIXFORMAT_RGB565;
     } else {
         mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Expected model input channels to be 1 or 3!"));
     }
 
+    void *row_buffer = fb_alloc0(image_line_size(&dst_img), FB_ALLOC_PREFER_SPEED | FB_ALLOC_CACHE_ALIGN);
+
+    // IMAGE_HINT_SCALE_ASPECT_EXPAND covers every row and column of the model input.
     imlib_draw_image(&dst_img, arg->img, 0, 0, 1.0f, 1.0f, arg->roi,
                      -1, 256, NULL, NULL, IMAGE_HINT_BILINEAR | IMAGE_HINT_CENTER |
-                     IMAGE_HINT_SCALE_ASPECT_EXPAND | IMAGE_HINT_BLACK_BACKGROUND, NULL, NULL, NULL);
-
-    int size = (params->input_width * params->input_height) - 1; // must be int per countdown loop
-
-    if (params->input_channels == 1) {
-        // GRAYSCALE
-        if (params->input_datatype == LIBTF_DATATYPE_FLOAT) {
-            // convert u8 -> f32
-            uint8_t *model_input_u8 = (uint8_t *) model_input;
-            float *model_input_f32 = (float *) model_input;
-
-            for (; size >= 0; size -= 1) {
-                model_input_f32[size] = (model_input_u8[size] * fscale) + fadd;
-            }
-        } else {
-            if (shift) {
-                // convert u8 -> s8
-                uint8_t *model_input_8 = (uint8_t *) model_input;
-
-                #if (__ARM_ARCH > 6)
-                for (; size >= 3; size -= 4) {
-                    *((uint32_t *) (model_input_8 + size - 3)) ^= 0x80808080;
-                }
-                #endif
-
-                for (; size >= 0; size -= 1) {
-                    model_input_8[size] ^= PY_TF_GRAYSCALE_MID;
-                }
-            }
-        }
-    } else if (params->input_channels == 3) {
-        // RGB888
-        int rgb_size = size * 3; // must be int per countdown loop
-
-        if (params->input_datatype == LIBTF_DATATYPE_FLOAT) {
-            uint16_t *model_input_u16 = (uint16_t *) model_input;
-            float *model_input_f32 = (float *) model_input;
-
-            for (; size >= 0; size -= 1, rgb_size -= 3) {
-                int pixel = model_input_u16[size];
-                model_input_f32[rgb_size] = (COLOR_RGB565_TO_R8(pixel) * fscale_r) + fadd_r;
-                model_input_f32[rgb_size + 1] = (COLOR_RGB565_TO_G8(pixel) * fscale_g) + fadd_g;
-                model_input_f32[rgb_size + 2] = (COLOR_RGB565_TO_B8(pixel) * fscale_b) + fadd_b;
-            }
-        } else {
-            uint16_t *model_input_u16 = (uint16_t *) model_input;
-            uint8_t *model_input_8 = (uint8_t *) model_input;
+                     IMAGE_HINT_SCALE_ASPECT_EXPAND | IMAGE_HINT_BLACK_BACKGROUND,
+                     row_callback, &row_data, row_buffer);
 
-            for (; size >= 0; size -= 1, rgb_size -= 3) {
-                int pixel = model_input_u16[size];
-                model_input_8[rgb_size] = COLOR_RGB565_TO_R8(pixel) ^ shift;
-                model_input_8[rgb_size + 1] = COLOR_RGB565_TO_G8(pixel) ^ shift;
-                model_input_8[rgb_size + 2] = COLOR_RGB565_TO_B8(pixel) ^ shift;
-            }
-        }
-    }
+    fb_free(); // row_buffer
 }
 
 STATIC void py_tf_output_callback(void *callback_data,
@@ -358,6 +406,28 @@ STATIC void py_tf_output_callback(void *callback_data,
     }
 }
 
+// Writes the dequantized output to *callback_data and advances it past the output.
+STATIC void py_tf_packed_output_callback(void *callback_data,
+                                         void *model_output,
+                                         libtf_parameters_t *params) {
+    float **out = (float **) callback_data;
+    size_t len = params->output_height * params->output_width * params->output_channels;
+
+    if (params->output_datatype == LIBTF_DATATYPE_FLOAT) {
+        memcpy(*out, model_output, len * sizeof(float));
+    } else if (params->output_datatype == LIBTF_DATATYPE_INT8) {
+        for (size_t i = 0; i < len; i++) {
+            (*out)[i] = ((float) (((int8_t *) model_output)[i] - params->output_zero_point)) * params->output_scale;
+        }
+    } else {
+        for (size_t i = 0; i < len; i++) {
+            (*out)[i] = ((float) (((uint8_t *) model_output)[i] - params->output_zero_point)) * params->output_scale;
+        }
+    }
+
+    *out += len;
+}
+
 STATIC void py_tf_regression_input_callback(void *callback_data,
                                             void *model_input,
                                             libtf_parameters_t *params) {
@@ -509,16 +579,15 @@ STATIC mp_obj_t py_tf_model_predict(uint n_args, const mp_obj_t *pos_args, mp_ma
     int invoke_result;
 
     if (MP_OBJ_IS_TYPE(pos_args[1], &mp_type_tuple) || MP_OBJ_IS_TYPE(pos_args[1], &mp_type_list)) {
-        invoke_result = libtf_invoke(model->data,
+        invoke_result = py_tf_invoke(model,
                                      tensor_arena,
-                                     &model->params,
                                      py_tf_regression_input_callback,
                                      (void *) &pos_args[1],
                                      py_tf_output_callback,
                                      &output_callback_data);
     } else {
         image_t *image = py_helper_arg_to_image(pos_args[1], ARG_IMAGE_ANY);
-        rectangle_t roi = py_helper_arg_to_roi(args[ARG_roi].u_obj, image);
+        rectangle_t roi;
         py_tf_input_callback_data_t py_tf_input_callback_data = {
             .img = image,
             .roi = &roi,
@@ -529,27 +598,57 @@ STATIC mp_obj_t py_tf_model_predict(uint n_args, const mp_obj_t *pos_args, mp_ma
         py_helper_arg_to_float_array(args[ARG_mean].u_obj, py_tf_input_callback_data.mean, 3);
         py_helper_arg_to_float_array(args[ARG_stdev].u_obj, py_tf_input_callback_data.stdev, 3);
 
-        if (args[ARG_callback].u_obj != mp_const_none) {
-            py_tf_predict_callback_data_t py_tf_predict_output_callback_data;
-            py_tf_predict_output_callback_data.model = model;
-            py_tf_predict_output_callback_data.roi = &roi;
-            py_tf_predict_output_callback_data.callback = args[ARG_callback].u_obj;
-            py_tf_predict_output_callback_data.out = &output_callback_data;
-            invoke_result = libtf_invoke(model->data,
-                                         tensor_arena,
-                                         &model->params,
-                                         py_tf_input_callback,
-                                         &py_tf_input_callback_data,
-                                         py_tf_predict_output_callback,
-                                         &py_tf_predict_output_callback_data);
-        } else {
-            invoke_result = libtf_invoke(model->data,
-                                         tensor_arena,
-                                         &model->params,
-                                         py_tf_input_callback,
-                                         &py_tf_input_callback_data,
-                                         py_tf_output_callback,
-                                         &output_callback_data);
+        // A list of rois runs the model on each roi and returns a list of results. The log
+        // buffer and tensor arena are set up once for all of them.
+        size_t n_rois = 1;
+        mp_obj_t *rois = &args[ARG_roi].u_obj;
+        mp_obj_t results = MP_OBJ_NULL;
+
+        if (MP_OBJ_IS_TYPE(args[ARG_roi].u_obj, &mp_type_tuple) || MP_OBJ_IS_TYPE(args[ARG_roi].u_obj, &mp_type_list)) {
+            size_t len;
+            mp_obj_t *items;
+            mp_obj_get_array(args[ARG_roi].u_obj, &len, &items);
+            if (len && (!mp_obj_is_int(items[0]))) {
+                n_rois = len;
+                rois = items;
+                results = mp_obj_new_list(0, NULL);
+            }
+        }
+
+        invoke_result = 0;
+        output_callback_data = mp_const_none;
+
+        for (size_t i = 0; (i < n_rois) && (!invoke_result); i++) {
+            roi = py_helper_arg_to_roi(rois[i], image);
+
+            if (args[ARG_callback].u_obj != mp_const_none) {
+                py_tf_predict_callback_data_t py_tf_predict_output_callback_data;
+                py_tf_predict_output_callback_data.model = model;
+                py_tf_predict_output_callback_data.roi = &roi;
+                py_tf_predict_output_callback_data.callback = args[ARG_callback].u_obj;
+                py_tf_predict_output_callback_data.out = &output_callback_data;
+                invoke_result = py_tf_invoke(model,
+                                             tensor_arena,
+                                             py_tf_input_callback,
+                                             &py_tf_input_callback_data,
+                                             py_tf_predict_output_callback,
+                                             &py_tf_predict_output_callback_data);
+            } else {
+                invoke_result = py_tf_invoke(model,
+                                             tensor_arena,
+                                             py_tf_input_callback,
+                                             &py_tf_input_callback_data,
+                                             py_tf_output_callback,
+                                             &output_callback_data);
+            }
+
+            if (results != MP_OBJ_NULL) {
+                mp_obj_list_append(results, output_callback_data);
+            }
+        }
+
+        if (results != MP_OBJ_NULL) {
+            output_callback_data = results;
         }
     }
 
@@ -564,6 +663,261 @@ STATIC mp_obj_t py_tf_model_predict(uint n_args, const mp_obj_t *pos_args, mp_ma
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_tf_model_predict_obj, 2, py_tf_model_predict);
 
+// Runs the model on each roi and returns the outputs packed in a bytearray of floats, one row of
+// output_height * output_width * output_channels floats per roi. No objects are created per roi.
+STATIC mp_obj_t py_tf_model_predict_batch(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_scale, ARG_mean, ARG_stdev };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_scale, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = PY_TF_SCALE_0_1} },
+        { MP_QSTR_mean, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_stdev, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+    };
+
+    // Parse args.
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 3, pos_args + 3, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    py_tf_model_obj_t *model = MP_OBJ_TO_PTR(pos_args[0]);
+    image_t *image = py_helper_arg_to_image(pos_args[1], ARG_IMAGE_ANY);
+
+    size_t n_rois;
+    mp_obj_t *rois;
+    mp_obj_get_array(pos_args[2], &n_rois, &rois);
+
+    rectangle_t roi;
+    py_tf_input_callback_data_t py_tf_input_callback_data = {
+        .img = image,
+        .roi = &roi,
+        .scale = args[ARG_scale].u_int,
+        .mean = {0.0f, 0.0f, 0.0f},
+        .stdev = {1.0f, 1.0f, 1.0f}
+    };
+    py_helper_arg_to_float_array(args[ARG_mean].u_obj, py_tf_input_callback_data.mean, 3);
+    py_helper_arg_to_float_array(args[ARG_stdev].u_obj, py_tf_input_callback_data.stdev, 3);
+
+    size_t output_size = model->params.output_height * model->params.output_width * model->params.output_channels;
+    float *results = m_new(float, n_rois * output_size);
+    float *out = results;
+
+    fb_alloc_mark();
+    py_tf_alloc_log_buffer();
+
+    uint8_t *tensor_arena = fb_alloc(model->params.tensor_arena_size, FB_ALLOC_PREFER_SPEED | FB_ALLOC_CACHE_ALIGN);
+
+    for (size_t i = 0; i < n_rois; i++) {
+        roi = py_helper_arg_to_roi(rois[i], image);
+
+        if (py_tf_invoke(model,
+                         tensor_arena,
+                         py_tf_input_callback,
+                         &py_tf_input_callback_data,
+                         py_tf_packed_output_callback,
+                         &out) != 0) {
+            // Note can't use MP_ERROR_TEXT here.
+            mp_raise_msg(&mp_type_OSError, (mp_rom_error_text_t) py_tf_log_buffer);
+        }
+    }
+
+    fb_alloc_free_till_mark();
+
+    return mp_obj_new_bytearray_by_ref(n_rois * output_size * sizeof(float), results);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_tf_model_predict_batch_obj, 3, py_tf_model_predict_batch);
+
+#if OMV_PROFILE_ENABLE
+// libtf doesn't expose its interpreter's profiler, so an invoke is split into stages at the input and
+// output callbacks. Interpreter setup and tensor allocation run before the input callback, and all of
+// the model's operators run between the input and output callbacks.
+#define PY_TF_PROFILE_PATTERN   (0xDEADBEEF)
+
+typedef enum {
+    PY_TF_PROFILE_SETUP,
+    PY_TF_PROFILE_INPUT,
+    PY_TF_PROFILE_INVOKE,
+    PY_TF_PROFILE_OUTPUT,
+    PY_TF_PROFILE_TEARDOWN,
+    PY_TF_PROFILE_MAX
+} py_tf_profile_stage_t;
+
+static const char *const py_tf_profile_names[PY_TF_PROFILE_MAX] = {
+    [PY_TF_PROFILE_SETUP] = "setup",
+    [PY_TF_PROFILE_INPUT] = "input",
+    [PY_TF_PROFILE_INVOKE] = "invoke",
+    [PY_TF_PROFILE_OUTPUT] = "output",
+    [PY_TF_PROFILE_TEARDOWN] = "teardown",
+};
+
+typedef struct py_tf_profile_data {
+    libtf_input_data_callback_t input_callback;
+    void *input_callback_data;
+    mp_obj_t output;
+    uint32_t *arena;
+    size_t arena_words;
+    uint32_t start;
+    uint32_t cycles[PY_TF_PROFILE_MAX];
+    size_t arena_used[PY_TF_PROFILE_MAX];
+} py_tf_profile_data_t;
+
+// Ends a stage. The arena is filled with a pattern before the invoke, so the bytes that no longer
+// match are the bytes used so far. The scan isn't counted in the next stage.
+STATIC void py_tf_profile_mark(py_tf_profile_data_t *data, py_tf_profile_stage_t stage) {
+    data->cycles[stage] = TRACE_DWT_CYCCNT - data->start;
+
+    size_t used = 0;
+    for (size_t i = 0; i < data->arena_words; i++) {
+        used += data->arena[i] != PY_TF_PROFILE_PATTERN;
+    }
+
+    data->arena_used[stage] = used * sizeof(uint32_t);
+    data->start = TRACE_DWT_CYCCNT;
+}
+
+STATIC void py_tf_profile_input_callback(void *callback_data,
+                                         void *model_input,
+                                         libtf_parameters_t *params) {
+    py_tf_profile_data_t *data = (py_tf_profile_data_t *) callback_data;
+    py_tf_profile_mark(data, PY_TF_PROFILE_SETUP);
+    data->input_callback(data->input_callback_data, model_input, params);
+    py_tf_profile_mark(data, PY_TF_PROFILE_INPUT);
+}
+
+STATIC void py_tf_profile_output_callback(void *callback_data,
+                                          void *model_output,
+                                          libtf_parameters_t *params) {
+    py_tf_profile_data_t *data = (py_tf_profile_data_t *) callback_data;
+    py_tf_profile_mark(data, PY_TF_PROFILE_INVOKE);
+    py_tf_output_callback(&data->output, model_output, params);
+    py_tf_profile_mark(data, PY_TF_PROFILE_OUTPUT);
+}
+
+// Runs the model once like predict() and returns a list of (stage, cycles, arena_bytes) tuples,
+// where arena_bytes is the tensor arena used by the end of the stage.
+STATIC mp_obj_t py_tf_model_profile(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_roi, ARG_scale, ARG_mean, ARG_stdev };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_roi, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_scale, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = PY_TF_SCALE_0_1} },
+        { MP_QSTR_mean, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_stdev, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+    };
+
+    // Parse args.
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 2, pos_args + 2, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    py_tf_model_obj_t *model = MP_OBJ_TO_PTR(pos_args[0]);
+    rectangle_t roi;
+    py_tf_input_callback_data_t py_tf_input_callback_data;
+    py_tf_profile_data_t data = {};
+
+    if (MP_OBJ_IS_TYPE(pos_args[1], &mp_type_tuple) || MP_OBJ_IS_TYPE(pos_args[1], &mp_type_list)) {
+        data.input_callback = py_tf_regression_input_callback;
+        data.input_callback_data = (void *) &pos_args[1];
+    } else {
+        image_t *image = py_helper_arg_to_image(pos_args[1], ARG_IMAGE_ANY);
+        roi = py_helper_arg_to_roi(args[ARG_roi].u_obj, image);
+        py_tf_input_callback_data = (py_tf_input_callback_data_t) {
+            .img = image,
+            .roi = &roi,
+            .scale = args[ARG_scale].u_int,
+            .mean = {0.0f, 0.0f, 0.0f},
+            .stdev = {1.0f, 1.0f, 1.0f}
+        };
+        py_helper_arg_to_float_array(args[ARG_mean].u_obj, py_tf_input_callback_data.mean, 3);
+        py_helper_arg_to_float_array(args[ARG_stdev].u_obj, py_tf_input_callback_data.stdev, 3);
+        data.input_callback = py_tf_input_callback;
+        data.input_callback_data = &py_tf_input_callback_data;
+    }
+
+    fb_alloc_mark();
+    py_tf_alloc_log_buffer();
+
+    uint8_t *tensor_arena = fb_alloc(model->params.tensor_arena_size, FB_ALLOC_PREFER_SPEED | FB_ALLOC_CACHE_ALIGN);
+    data.arena = (uint32_t *) tensor_arena;
+    data.arena_words = model->params.tensor_arena_size / sizeof(uint32_t);
+
+    for (size_t i = 0; i < data.arena_words; i++) {
+        data.arena[i] = PY_TF_PROFILE_PATTERN;
+    }
+
+    data.start = TRACE_DWT_CYCCNT;
+
+    if (py_tf_invoke(model,
+                     tensor_arena,
+                     py_tf_profile_input_callback,
+                     &data,
+                     py_tf_profile_output_callback,
+                     &data) != 0) {
+        // Note can't use MP_ERROR_TEXT here.
+        mp_raise_msg(&mp_type_OSError, (mp_rom_error_text_t) py_tf_log_buffer);
+    }
+
+    py_tf_profile_mark(&data, PY_TF_PROFILE_TEARDOWN);
+    fb_alloc_free_till_mark();
+
+    mp_obj_list_t *list = MP_OBJ_TO_PTR(mp_obj_new_list(PY_TF_PROFILE_MAX, NULL));
+    for (size_t i = 0; i < PY_TF_PROFILE_MAX; i++) {
+        const char *name = py_tf_profile_names[i];
+        list->items[i] = mp_obj_new_tuple(3, (mp_obj_t []) {mp_obj_new_str(name, strlen(name)),
+                                                            mp_obj_new_int_from_uint(data.cycles[i]),
+                                                            mp_obj_new_int(data.arena_used[i])});
+    }
+
+    return MP_OBJ_FROM_PTR(list);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_tf_model_profile_obj, 2, py_tf_model_profile);
+#endif // OMV_PROFILE_ENABLE
+
+// Asynchronous predictions.
+//
+// predict_async() starts the inference right away and returns a future holding its output. These
+// MCUs have one core and no worker to hand the inference to, so it runs to completion on the
+// calling thread before predict_async() returns. The sensor keeps capturing the next frame into
+// its other buffers by DMA meanwhile, so capture of frame N+1 overlaps inference on frame N, and
+// result() never blocks.
+typedef struct py_tf_future_obj {
+    mp_obj_base_t base;
+    mp_obj_t result;
+} py_tf_future_obj_t;
+
+STATIC void py_tf_future_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    mp_print_str(print, "{\"done\":1}");
+}
+
+STATIC mp_obj_t py_tf_future_done(mp_obj_t self_in) {
+    return mp_const_true;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_tf_future_done_obj, py_tf_future_done);
+
+STATIC mp_obj_t py_tf_future_result(mp_obj_t self_in) {
+    return ((py_tf_future_obj_t *) MP_OBJ_TO_PTR(self_in))->result;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_tf_future_result_obj, py_tf_future_result);
+
+STATIC const mp_rom_map_elem_t py_tf_future_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_done),                MP_ROM_PTR(&py_tf_future_done_obj) },
+    { MP_ROM_QSTR(MP_QSTR_result),              MP_ROM_PTR(&py_tf_future_result_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(py_tf_future_locals_dict, py_tf_future_locals_dict_table);
+
+STATIC MP_DEFINE_CONST_OBJ_TYPE(
+    py_tf_future_type,
+    MP_QSTR_tf_future,
+    MP_TYPE_FLAG_NONE,
+    print, py_tf_future_print,
+    locals_dict, &py_tf_future_locals_dict
+    );
+
+// Takes the same arguments as predict().
+STATIC mp_obj_t py_tf_model_predict_async(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    py_tf_future_obj_t *o = m_new_obj(py_tf_future_obj_t);
+    o->base.type = &py_tf_future_type;
+    o->result = py_tf_model_predict(n_args, pos_args, kw_args);
+    return MP_OBJ_FROM_PTR(o);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_tf_model_predict_async_obj, 2, py_tf_model_predict_async);
+
 STATIC void py_tf_model_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest) {
     py_tf_model_obj_t *self = MP_OBJ_TO_PTR(self_in);
     const char *str;
@@ -626,15 +980,27 @@ mp_obj_t py_tf_model_make_new(const mp_obj_type_t *type, size_t n_args, size_t n
 
     fb_alloc_mark();
 
-    const char *path = mp_obj_str_get_str(args[ARG_path].u_obj);
-
     py_tf_model_obj_t *model = m_new_obj_with_finaliser(py_tf_model_obj_t);
     model->base.type = &py_tf_model_type;
     model->data = NULL;
     model->fb_alloc = args[ARG_load_to_fb].u_int;
     mp_obj_list_t *labels = NULL;
 
-    for (int i = 0; i < MP_ARRAY_SIZE(libtf_builtin_models); i++) {
+    // Models passed as a buffer are used in place, e.g. uctypes.bytearray_at() over memory-mapped
+    // QSPI/FlexSPI flash. Only the tensor arena is allocated in RAM.
+    mp_buffer_info_t bufinfo;
+    if ((!mp_obj_is_str(args[ARG_path].u_obj)) && mp_get_buffer(args[ARG_path].u_obj, &bufinfo, MP_BUFFER_READ)) {
+        if (((uintptr_t) bufinfo.buf) % 16) {
+            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Model data must be 16-byte aligned!"));
+        }
+        model->size = bufinfo.len;
+        model->data = bufinfo.buf;
+        model->fb_alloc = false;
+    }
+
+    const char *path = (model->data == NULL) ? mp_obj_str_get_str(args[ARG_path].u_obj) : NULL;
+
+    for (int i = 0; (model->data == NULL) && (i < MP_ARRAY_SIZE(libtf_builtin_models)); i++) {
         const libtf_builtin_model_t *_model = &libtf_builtin_models[i];
         if (!strcmp(path, _model->name)) {
             // Load model data.
@@ -710,6 +1076,13 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_tf_model_deinit_obj, py_tf_model_deinit);
 STATIC const mp_rom_map_elem_t py_tf_model_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR___del__),             MP_ROM_PTR(&py_tf_model_deinit_obj) },
     { MP_ROM_QSTR(MP_QSTR_predict),             MP_ROM_PTR(&py_tf_model_predict_obj) },
+    { MP_ROM_QSTR(MP_QSTR_predict_batch),       MP_ROM_PTR(&py_tf_model_predict_batch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_predict_async),       MP_ROM_PTR(&py_tf_model_predict_async_obj) },
+    #if OMV_PROFILE_ENABLE
+    { MP_ROM_QSTR(MP_QSTR_profile),             MP_ROM_PTR(&py_tf_model_profile_obj) },
+    #else
+    { MP_ROM_QSTR(MP_QSTR_profile),             MP_ROM_PTR(&py_func_unavailable_obj) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(py_tf_model_locals_dict, py_tf_model_locals_dict_table);
@@ -25,6 +25,16 @@ typedef struct py_tf_model_obj {
     libtf_parameters_t params;
 } py_tf_model_obj_t;
 
+// TF Model Output Object.
+typedef struct py_tf_model_output_obj {
+    mp_obj_base_t base;
+    void *model_output;
+    libtf_parameters_t *params;
+    size_t output_size;
+} py_tf_model_output_obj_t;
+
+extern const mp_obj_type_t py_tf_model_output_type;
+
 extern char *py_tf_log_buffer;
 void py_tf_alloc_log_buffer();
 
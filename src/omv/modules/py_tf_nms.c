@@ -13,6 +13,8 @@
 #ifdef IMLIB_ENABLE_TF
 #include "py/runtime.h"
 #include "py_helper.h"
+#include "fb_alloc.h"
+#include "py_tf.h"
 
 // TF NMS Object.
 typedef struct py_tf_nms_obj {
@@ -25,6 +27,21 @@ typedef struct py_tf_nms_obj {
 
 const mp_obj_type_t py_tf_nms_type;
 
+// Clips the box to the window. Returns false if nothing is left of it.
+STATIC bool py_tf_nms_clip_bounding_box(py_tf_nms_obj_t *self_in, float xmin, float ymin, float xmax, float ymax,
+                                        bounding_box_lnk_data_t *lnk_data) {
+    xmin = IM_CLAMP(xmin, 0.0f, ((float) self_in->window_w));
+    ymin = IM_CLAMP(ymin, 0.0f, ((float) self_in->window_h));
+    xmax = IM_CLAMP(xmax, 0.0f, ((float) self_in->window_w));
+    ymax = IM_CLAMP(ymax, 0.0f, ((float) self_in->window_h));
+
+    lnk_data->rect.w = fast_floorf(xmax - xmin);
+    lnk_data->rect.h = fast_floorf(ymax - ymin);
+    lnk_data->rect.x = fast_floorf(xmin);
+    lnk_data->rect.y = fast_floorf(ymin);
+    return (lnk_data->rect.w > 0) && (lnk_data->rect.h > 0);
+}
+
 // The use of mp_arg_parse_all() is deliberately avoided here to ensure this method remains fast.
 STATIC mp_obj_t py_tf_nms_add_bounding_box(uint n_args, const mp_obj_t *pos_args) {
     enum { ARG_self, ARG_xmin, ARG_ymin, ARG_xmax, ARG_ymax, ARG_score, ARG_label_index };
@@ -34,17 +51,12 @@ STATIC mp_obj_t py_tf_nms_add_bounding_box(uint n_args, const mp_obj_t *pos_args
     lnk_data.score = mp_obj_get_float(pos_args[ARG_score]);
 
     if ((lnk_data.score >= 0.0f) && (lnk_data.score <= 1.0f)) {
-        float xmin = IM_CLAMP(mp_obj_get_float(pos_args[ARG_xmin]), 0.0f, ((float) self_in->window_w));
-        float ymin = IM_CLAMP(mp_obj_get_float(pos_args[ARG_ymin]), 0.0f, ((float) self_in->window_h));
-        float xmax = IM_CLAMP(mp_obj_get_float(pos_args[ARG_xmax]), 0.0f, ((float) self_in->window_w));
-        float ymax = IM_CLAMP(mp_obj_get_float(pos_args[ARG_ymax]), 0.0f, ((float) self_in->window_h));
-
-        lnk_data.rect.w = fast_floorf(xmax - xmin);
-        lnk_data.rect.h = fast_floorf(ymax - ymin);
-
-        if ((lnk_data.rect.w > 0) && (lnk_data.rect.h > 0)) {
-            lnk_data.rect.x = fast_floorf(xmin);
-            lnk_data.rect.y = fast_floorf(ymin);
+        if (py_tf_nms_clip_bounding_box(self_in,
+                                        mp_obj_get_float(pos_args[ARG_xmin]),
+                                        mp_obj_get_float(pos_args[ARG_ymin]),
+                                        mp_obj_get_float(pos_args[ARG_xmax]),
+                                        mp_obj_get_float(pos_args[ARG_ymax]),
+                                        &lnk_data)) {
             lnk_data.label_index = mp_obj_get_int(pos_args[ARG_label_index]);
             rectangle_nms_add_bounding_box(&self_in->bounding_boxes, &lnk_data);
         }
@@ -54,6 +66,142 @@ STATIC mp_obj_t py_tf_nms_add_bounding_box(uint n_args, const mp_obj_t *pos_args
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(py_tf_nms_add_bounding_box_obj, 7, 7, py_tf_nms_add_bounding_box);
 
+static inline float py_tf_nms_dequantize(libtf_parameters_t *params, void *model_output, size_t i) {
+    switch (params->output_datatype) {
+        case LIBTF_DATATYPE_INT8: {
+            return (((int8_t *) model_output)[i] - params->output_zero_point) * params->output_scale;
+        }
+        case LIBTF_DATATYPE_UINT8: {
+            return (((uint8_t *) model_output)[i] - params->output_zero_point) * params->output_scale;
+        }
+        default: {
+            return ((float *) model_output)[i];
+        }
+    }
+}
+
+// Min-heap on score of the best top_k boxes seen so far.
+STATIC void py_tf_nms_heap_push(bounding_box_lnk_data_t *heap, size_t n, bounding_box_lnk_data_t *box) {
+    size_t i = n;
+    for (; i && (heap[(i - 1) / 2].score > box->score); i = (i - 1) / 2) {
+        heap[i] = heap[(i - 1) / 2];
+    }
+    heap[i] = *box;
+}
+
+STATIC void py_tf_nms_heap_replace_min(bounding_box_lnk_data_t *heap, size_t n, bounding_box_lnk_data_t *box) {
+    size_t i = 0;
+    for (size_t child = 1; child < n; i = child, child = (2 * child) + 1) {
+        if (((child + 1) < n) && (heap[child + 1].score < heap[child].score)) {
+            child += 1;
+        }
+        if (heap[child].score >= box->score) {
+            break;
+        }
+        heap[i] = heap[child];
+    }
+    heap[i] = *box;
+}
+
+// Decodes a YOLOv5 style model output of rows of [cx, cy, w, h, objectness, class scores...], with
+// box coordinates normalized to 0->1 of the window. Rows are rejected on objectness before anything
+// else is dequantized. For quantized outputs this is done on the raw values.
+STATIC mp_obj_t py_tf_nms_add_yolo(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_threshold, ARG_top_k };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_threshold,  MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE } },
+        { MP_QSTR_top_k,  MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 0 } },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 2, pos_args + 2, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    py_tf_nms_obj_t *self_in = MP_OBJ_TO_PTR(pos_args[0]);
+
+    if (!MP_OBJ_IS_TYPE(pos_args[1], &py_tf_model_output_type)) {
+        mp_raise_msg(&mp_type_TypeError, MP_ERROR_TEXT("Expected a model output!"));
+    }
+
+    py_tf_model_output_obj_t *output = MP_OBJ_TO_PTR(pos_args[1]);
+    libtf_parameters_t *params = output->params;
+    void *model_output = output->model_output;
+    size_t cols = params->output_channels;
+    size_t rows = params->output_height * params->output_width;
+
+    if (cols < 6) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Expected model output channels to be at least 6!"));
+    }
+
+    float threshold = py_helper_arg_to_float(args[ARG_threshold].u_obj, 0.6f);
+    size_t top_k = ((args[ARG_top_k].u_int > 0) && (((size_t) args[ARG_top_k].u_int) < rows))
+                   ? args[ARG_top_k].u_int : rows;
+
+    // Smallest raw objectness that dequantizes to at least the threshold.
+    int q_threshold = 0;
+    if (params->output_datatype != LIBTF_DATATYPE_FLOAT) {
+        q_threshold = fast_ceilf(threshold / params->output_scale) + params->output_zero_point;
+    }
+
+    fb_alloc_mark();
+    bounding_box_lnk_data_t *boxes = fb_alloc(top_k * sizeof(bounding_box_lnk_data_t), FB_ALLOC_NO_HINT);
+    size_t n = 0;
+
+    for (size_t i = 0; i < (rows * cols); i += cols) {
+        if (params->output_datatype == LIBTF_DATATYPE_INT8) {
+            if (((int8_t *) model_output)[i + 4] < q_threshold) {
+                continue;
+            }
+        } else if (params->output_datatype == LIBTF_DATATYPE_UINT8) {
+            if (((uint8_t *) model_output)[i + 4] < q_threshold) {
+                continue;
+            }
+        }
+
+        float objectness = py_tf_nms_dequantize(params, model_output, i + 4);
+
+        if (objectness < threshold) {
+            continue;
+        }
+
+        bounding_box_lnk_data_t lnk_data = { .score = 0.0f, .label_index = 0 };
+
+        for (size_t j = 5; j < cols; j++) {
+            float score = py_tf_nms_dequantize(params, model_output, i + j);
+            if (score > lnk_data.score) {
+                lnk_data.score = score;
+                lnk_data.label_index = j - 5;
+            }
+        }
+
+        lnk_data.score *= objectness;
+
+        if ((lnk_data.score < threshold) || ((n == top_k) && (lnk_data.score <= boxes[0].score))) {
+            continue;
+        }
+
+        float cx = py_tf_nms_dequantize(params, model_output, i) * self_in->window_w;
+        float cy = py_tf_nms_dequantize(params, model_output, i + 1) * self_in->window_h;
+        float w_2 = py_tf_nms_dequantize(params, model_output, i + 2) * self_in->window_w * 0.5f;
+        float h_2 = py_tf_nms_dequantize(params, model_output, i + 3) * self_in->window_h * 0.5f;
+
+        if (!py_tf_nms_clip_bounding_box(self_in, cx - w_2, cy - h_2, cx + w_2, cy + h_2, &lnk_data)) {
+            continue;
+        }
+
+        if (n < top_k) {
+            py_tf_nms_heap_push(boxes, n++, &lnk_data);
+        } else {
+            py_tf_nms_heap_replace_min(boxes, n, &lnk_data);
+        }
+    }
+
+    rectangle_nms_add_bounding_boxes(&self_in->bounding_boxes, boxes, n);
+    fb_alloc_free_till_mark();
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_tf_nms_add_yolo_obj, 2, py_tf_nms_add_yolo);
+
 STATIC mp_obj_t py_tf_nms_get_bounding_boxes(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     enum { ARG_threshold, ARG_sigma };
     static const mp_arg_t allowed_args[] = {
@@ -127,6 +275,7 @@ mp_obj_t py_tf_nms_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_k
 
 STATIC const mp_rom_map_elem_t py_tf_nms_locals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_add_bounding_box),    MP_ROM_PTR(&py_tf_nms_add_bounding_box_obj) },
+    { MP_ROM_QSTR(MP_QSTR_add_yolo),            MP_ROM_PTR(&py_tf_nms_add_yolo_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_bounding_boxes),  MP_ROM_PTR(&py_tf_nms_get_bounding_boxes_obj) },
 };
 
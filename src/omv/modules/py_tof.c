@@ -20,6 +20,8 @@
 #include "py_helper.h"
 #include "py_image.h"
 #include "framebuffer.h"
+#include "softtimer.h"
+#include "py_tof.h"
 
 #if (OMV_TOF_VL53L5CX_ENABLE == 1)
 #include "vl53l5cx_api.h"
@@ -30,6 +32,9 @@
 #define VL53L5CX_HEIGHT             8
 #define VL53L5CX_FRAME_DATA_SIZE    64
 
+#define TOF_STREAM_FRAMES           2
+#define TOF_STREAM_POLL_MS          10
+
 static omv_i2c_t tof_bus = {};
 
 typedef enum tof_type {
@@ -51,6 +56,15 @@ static VL53L5CX_Configuration vl53l5cx_dev = {
         .address = VL53L5CX_ADDR,
     }
 };
+
+// In streaming mode a soft timer polls the sensor from the scheduler and keeps the
+// last frames in a ring, so reading the depth doesn't wait for the sensor.
+static soft_timer_entry_t tof_stream_timer = {};
+static VL53L5CX_ResultsData tof_stream_data;
+static int16_t tof_stream_ring[TOF_STREAM_FRAMES][VL53L5CX_FRAME_DATA_SIZE];
+static int tof_stream_head = -1; // The latest frame in the ring, -1 if none.
+static bool tof_streaming = false;
+static bool tof_stream_error = false;
 #endif
 
 // img->w == data_w && img->h == data_h && img->pixfmt == PIXFORMAT_GRAYSCALE
@@ -84,47 +98,108 @@ static void tof_fill_image_float_obj(image_t *img, mp_obj_t *data, float min, fl
 }
 
 #if (OMV_TOF_VL53L5CX_ENABLE == 1)
-static void tof_vl53l5cx_get_depth(VL53L5CX_Configuration *vl53l5cx_dev, float *frame, uint32_t timeout) {
+STATIC mp_obj_t tof_vl53l5cx_stream_callback(mp_obj_t unused) {
+    uint8_t frame_ready = 0;
+
+    if (!tof_streaming) {
+        return mp_const_none;
+    }
+
+    if ((vl53l5cx_check_data_ready(&vl53l5cx_dev, &frame_ready) != 0)
+        || (frame_ready && (vl53l5cx_get_ranging_data(&vl53l5cx_dev, &tof_stream_data) != 0))) {
+        tof_stream_error = true;
+    } else if (frame_ready) {
+        int next = (tof_stream_head + 1) % TOF_STREAM_FRAMES;
+        memcpy(tof_stream_ring[next], tof_stream_data.distance_mm, sizeof(tof_stream_ring[next]));
+        tof_stream_head = next;
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(tof_vl53l5cx_stream_callback_obj, tof_vl53l5cx_stream_callback);
+
+static void tof_vl53l5cx_stream_start() {
+    tof_stream_head = -1;
+    tof_stream_error = false;
+    tof_streaming = true;
+
+    tof_stream_timer.flags = SOFT_TIMER_FLAG_PY_CALLBACK;
+    tof_stream_timer.mode = SOFT_TIMER_MODE_PERIODIC;
+    tof_stream_timer.delta_ms = TOF_STREAM_POLL_MS;
+    tof_stream_timer.py_callback = (mp_obj_t) &tof_vl53l5cx_stream_callback_obj;
+    soft_timer_insert(&tof_stream_timer, TOF_STREAM_POLL_MS);
+}
+
+static void tof_vl53l5cx_stream_stop() {
+    if (tof_streaming) {
+        soft_timer_remove(&tof_stream_timer);
+        tof_streaming = false;
+    }
+}
+
+static void tof_vl53l5cx_get_depth(VL53L5CX_Configuration *vl53l5cx_dev, int16_t *frame, uint32_t timeout) {
     uint8_t frame_ready = 0;
+    const int16_t *distance_mm = NULL;
     // Note depending on the config in platform.h, this struct can be too big to alloc on the stack.
     VL53L5CX_ResultsData ranging_data;
 
-    for (mp_uint_t start = mp_hal_ticks_ms(); !frame_ready; mp_hal_delay_ms(1)) {
-        if (vl53l5cx_check_data_ready(vl53l5cx_dev, &frame_ready) != 0) {
+    if (tof_streaming) {
+        // Only the first frame needs waiting for, after that the latest one is returned.
+        for (mp_uint_t start = mp_hal_ticks_ms(); tof_stream_head < 0; mp_hal_delay_ms(1)) {
+            if (tof_stream_error) {
+                break;
+            }
+
+            if ((mp_hal_ticks_ms() - start) >= timeout) {
+                mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("VL53L5CX ranging timeout"));
+            }
+        }
+
+        if (tof_stream_error) {
+            tof_stream_error = false;
             mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("VL53L5CX ranging failed"));
         }
 
-        if ((mp_hal_ticks_ms() - start) >= timeout) {
-            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("VL53L5CX ranging timeout"));
+        distance_mm = tof_stream_ring[tof_stream_head];
+    } else {
+        for (mp_uint_t start = mp_hal_ticks_ms(); !frame_ready; mp_hal_delay_ms(1)) {
+            if (vl53l5cx_check_data_ready(vl53l5cx_dev, &frame_ready) != 0) {
+                mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("VL53L5CX ranging failed"));
+            }
+
+            if ((mp_hal_ticks_ms() - start) >= timeout) {
+                mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("VL53L5CX ranging timeout"));
+            }
         }
-    }
 
-    if (vl53l5cx_get_ranging_data(vl53l5cx_dev, &ranging_data) != 0) {
-        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("VL53L5CX ranging failed"));
-    }
+        if (vl53l5cx_get_ranging_data(vl53l5cx_dev, &ranging_data) != 0) {
+            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("VL53L5CX ranging failed"));
+        }
 
-    for (int i = 0, ii = VL53L5CX_WIDTH * VL53L5CX_HEIGHT; i < ii; i++) {
-        frame[i] = (float) ranging_data.distance_mm[i];
+        distance_mm = ranging_data.distance_mm;
     }
+
+    memcpy(frame, distance_mm, VL53L5CX_WIDTH * VL53L5CX_HEIGHT * sizeof(int16_t));
 }
 
-static mp_obj_t tof_get_depth_obj(int w, int h, float *frame, bool mirror, bool flip, bool dst_transpose, bool src_transpose) {
+// Depths are whole millimeters returned as small ints, which aren't allocated on the heap.
+static mp_obj_t tof_get_depth_obj(int w, int h, const int16_t *frame, bool mirror, bool flip, bool dst_transpose, bool src_transpose) {
     mp_obj_list_t *list = (mp_obj_list_t *) mp_obj_new_list(w * h, NULL);
-    float min = FLT_MAX;
-    float max = -FLT_MAX;
+    int min = INT16_MAX;
+    int max = INT16_MIN;
     int w_1 = w - 1;
     int h_1 = h - 1;
 
     if (!src_transpose) {
         for (int y = 0; y < h; y++) {
             int y_dst = flip ? (h_1 - y) : y;
-            float *raw_row = frame + (y * w);
+            const int16_t *raw_row = frame + (y * w);
             mp_obj_t *list_row = list->items + (y_dst * w);
             mp_obj_t *t_list_row = list->items + y_dst;
 
             for (int x = 0; x < w; x++) {
                 int x_dst = mirror ? (w_1 - x) : x;
-                float raw = raw_row[x];
+                int raw = raw_row[x];
 
                 if (raw < min) {
                     min = raw;
@@ -134,7 +209,7 @@ static mp_obj_t tof_get_depth_obj(int w, int h, float *frame, bool mirror, bool
                     max = raw;
                 }
 
-                mp_obj_t f = mp_obj_new_float(raw);
+                mp_obj_t f = MP_OBJ_NEW_SMALL_INT(raw);
 
                 if (!dst_transpose) {
                     list_row[x_dst] = f;
@@ -146,13 +221,13 @@ static mp_obj_t tof_get_depth_obj(int w, int h, float *frame, bool mirror, bool
     } else {
         for (int x = 0; x < w; x++) {
             int x_dst = mirror ? (w_1 - x) : x;
-            float *raw_row = frame + (x * h);
+            const int16_t *raw_row = frame + (x * h);
             mp_obj_t *t_list_row = list->items + (x_dst * h);
             mp_obj_t *list_row = list->items + x_dst;
 
             for (int y = 0; y < h; y++) {
                 int y_dst = flip ? (h_1 - y) : y;
-                float raw = raw_row[y];
+                int raw = raw_row[y];
 
                 if (raw < min) {
                     min = raw;
@@ -162,7 +237,7 @@ static mp_obj_t tof_get_depth_obj(int w, int h, float *frame, bool mirror, bool
                     max = raw;
                 }
 
-                mp_obj_t f = mp_obj_new_float(raw);
+                mp_obj_t f = MP_OBJ_NEW_SMALL_INT(raw);
 
                 if (!dst_transpose) {
                     list_row[y_dst * w] = f;
@@ -175,11 +250,28 @@ static mp_obj_t tof_get_depth_obj(int w, int h, float *frame, bool mirror, bool
 
     mp_obj_t tuple[3] = {
         MP_OBJ_FROM_PTR(list),
-        mp_obj_new_float(min),
-        mp_obj_new_float(max)
+        MP_OBJ_NEW_SMALL_INT(min),
+        MP_OBJ_NEW_SMALL_INT(max)
     };
     return mp_obj_new_tuple(3, tuple);
 }
+
+// Same layout as tof_get_depth_obj() but written as int16 into a caller-provided buffer.
+static void tof_get_depth_buffer(int w, int h, const int16_t *frame, bool mirror, bool flip, bool dst_transpose,
+                                 bool src_transpose, int16_t *out) {
+    int w_1 = w - 1;
+    int h_1 = h - 1;
+
+    for (int y = 0; y < h; y++) {
+        int y_dst = flip ? (h_1 - y) : y;
+
+        for (int x = 0; x < w; x++) {
+            int x_dst = mirror ? (w_1 - x) : x;
+            int16_t raw = src_transpose ? frame[(x * h) + y] : frame[(y * w) + x];
+            out[dst_transpose ? ((x_dst * h) + y_dst) : ((y_dst * w) + x_dst)] = raw;
+        }
+    }
+}
 #endif
 
 static mp_obj_t py_tof_deinit() {
@@ -190,6 +282,7 @@ static mp_obj_t py_tof_deinit() {
     if (tof_sensor != TOF_NONE) {
         #if (OMV_TOF_VL53L5CX_ENABLE == 1)
         if (tof_sensor == TOF_VL53L5CX) {
+            tof_vl53l5cx_stream_stop();
             vl53l5cx_stop_ranging(&vl53l5cx_dev);
         }
         #endif
@@ -202,9 +295,10 @@ static mp_obj_t py_tof_deinit() {
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_tof_deinit_obj, py_tof_deinit);
 
 mp_obj_t py_tof_init(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
-    enum { ARG_type };
+    enum { ARG_type, ARG_stream };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_type, MP_ARG_INT,  {.u_int = -1 } },
+        { MP_QSTR_stream, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_bool = false } },
     };
 
     // Parse args.
@@ -291,6 +385,9 @@ mp_obj_t py_tof_init(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
             tof_sensor = TOF_VL53L5CX;
             tof_width = VL53L5CX_WIDTH;
             tof_height = VL53L5CX_HEIGHT;
+            if (args[ARG_stream].u_bool) {
+                tof_vl53l5cx_stream_start();
+            }
             break;
         }
         #endif
@@ -340,12 +437,13 @@ static mp_obj_t py_tof_refresh() {
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_tof_refresh_obj, py_tof_refresh);
 
 mp_obj_t py_tof_read_depth(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
-    enum { ARG_hmirror, ARG_vflip, ARG_transpose, ARG_timeout };
+    enum { ARG_hmirror, ARG_vflip, ARG_transpose, ARG_timeout, ARG_buffer };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_hmirror, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_bool = false } },
         { MP_QSTR_vflip, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_bool = false } },
         { MP_QSTR_transpose, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_bool = false } },
         { MP_QSTR_timeout, MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = -1 } },
+        { MP_QSTR_buffer, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
     };
 
     // Parse args.
@@ -358,10 +456,24 @@ mp_obj_t py_tof_read_depth(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_a
         #if (OMV_TOF_VL53L5CX_ENABLE == 1)
         case TOF_VL53L5CX: {
             fb_alloc_mark();
-            float *frame = fb_alloc(VL53L5CX_WIDTH * VL53L5CX_HEIGHT * sizeof(float), FB_ALLOC_PREFER_SPEED);
+            int16_t *frame = fb_alloc(VL53L5CX_WIDTH * VL53L5CX_HEIGHT * sizeof(int16_t), FB_ALLOC_PREFER_SPEED);
             tof_vl53l5cx_get_depth(&vl53l5cx_dev, frame, args[ARG_timeout].u_int);
-            mp_obj_t result = tof_get_depth_obj(VL53L5CX_WIDTH, VL53L5CX_HEIGHT, frame, !args[ARG_hmirror].u_bool,
-                                                args[ARG_vflip].u_bool, args[ARG_transpose].u_bool, true);
+            mp_obj_t result = args[ARG_buffer].u_obj;
+
+            if (result == mp_const_none) {
+                result = tof_get_depth_obj(VL53L5CX_WIDTH, VL53L5CX_HEIGHT, frame, !args[ARG_hmirror].u_bool,
+                                           args[ARG_vflip].u_bool, args[ARG_transpose].u_bool, true);
+            } else {
+                // The depths are written into the caller's buffer as int16, nothing is allocated.
+                mp_buffer_info_t bufinfo;
+                mp_get_buffer_raise(result, &bufinfo, MP_BUFFER_WRITE);
+                if (bufinfo.len < (VL53L5CX_WIDTH * VL53L5CX_HEIGHT * sizeof(int16_t))) {
+                    mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Buffer is too small"));
+                }
+                tof_get_depth_buffer(VL53L5CX_WIDTH, VL53L5CX_HEIGHT, frame, !args[ARG_hmirror].u_bool,
+                                     args[ARG_vflip].u_bool, args[ARG_transpose].u_bool, true, bufinfo.buf);
+            }
+
             fb_alloc_free_till_mark();
             return result;
         }
@@ -528,8 +640,12 @@ mp_obj_t py_tof_snapshot(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_arg
     switch (tof_sensor) {
         #if (OMV_TOF_VL53L5CX_ENABLE == 1)
         case TOF_VL53L5CX: {
+            int16_t *depth = fb_alloc(VL53L5CX_WIDTH * VL53L5CX_HEIGHT * sizeof(int16_t), FB_ALLOC_PREFER_SPEED);
             float *frame = fb_alloc(VL53L5CX_WIDTH * VL53L5CX_HEIGHT * sizeof(float), FB_ALLOC_PREFER_SPEED);
-            tof_vl53l5cx_get_depth(&vl53l5cx_dev, frame, args[ARG_timeout].u_int);
+            tof_vl53l5cx_get_depth(&vl53l5cx_dev, depth, args[ARG_timeout].u_int);
+            for (int i = 0, ii = VL53L5CX_WIDTH * VL53L5CX_HEIGHT; i < ii; i++) {
+                frame[i] = depth[i];
+            }
             if (args[ARG_scale].u_obj == mp_const_none) {
                 fast_get_min_max(frame, VL53L5CX_WIDTH * VL53L5CX_HEIGHT, &min, &max);
             }
@@ -556,6 +672,10 @@ mp_obj_t py_tof_snapshot(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_arg
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_tof_snapshot_obj, 0, py_tof_snapshot);
 
+void py_tof_init0() {
+    py_tof_deinit();
+}
+
 STATIC const mp_rom_map_elem_t globals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__),            MP_ROM_QSTR(MP_QSTR_tof)                },
     { MP_ROM_QSTR(MP_QSTR_TOF_NONE),            MP_ROM_INT(TOF_NONE)                    },
@@ -426,7 +426,7 @@ static void spi_config_init(bool triple_buffer) {
 
     spi_config.baudrate = TV_BAUDRATE;
     spi_config.nss_enable = false;
-    spi_config.dma_flags = triple_buffer ? OMV_SPI_DMA_NORMAL : 0;
+    spi_config.dma_flags = OMV_SPI_DMA_NORMAL;
     omv_spi_init(&spi_bus, &spi_config);
 
     omv_gpio_write(OMV_SPI_DISPLAY_SSEL_PIN, 1);
@@ -571,16 +571,90 @@ static void spi_tv_draw_image_cb_convert_rgb565(uint16_t *row_pointer_i, uint8_t
     }
 }
 
+// Lines are converted into a ring of line buffers which are sent by DMA while the next lines
+// are drawn and converted. Lines are sent in order, line n uses buffer n % TV_LINE_COUNT.
+#define TV_LINE_COUNT    4
+static uint8_t *tv_lines[TV_LINE_COUNT] = {};
+static uint8_t *tv_line_queue[TV_LINE_COUNT] = {};
+static volatile uint32_t tv_line_head = 0; // lines queued
+static volatile uint32_t tv_line_tail = 0; // lines sent
+static volatile bool tv_line_busy = false;
+
+static void spi_tv_line_start();
+
+static void spi_tv_line_callback(omv_spi_t *spi, void *userdata, void *buf) {
+    tv_line_tail += 1;
+
+    if (tv_line_tail != tv_line_head) {
+        spi_tv_line_start();
+    } else {
+        tv_line_busy = false;
+    }
+}
+
+static void spi_tv_line_start() {
+    omv_spi_transfer_t spi_xfer = {
+        .txbuf = tv_line_queue[tv_line_tail % TV_LINE_COUNT],
+        .size = PICLINE_LENGTH_BYTES,
+        .flags = OMV_SPI_XFER_DMA,
+        .callback = spi_tv_line_callback,
+    };
+
+    if (omv_spi_transfer_start(&spi_bus, &spi_xfer) != 0) {
+        // Drop the queued lines so the writer doesn't wait forever.
+        tv_line_tail = tv_line_head;
+        tv_line_busy = false;
+    }
+}
+
+// Waits for a free line buffer and returns the buffer of the next line.
+static uint8_t *spi_tv_line_get() {
+    while ((tv_line_head - tv_line_tail) >= TV_LINE_COUNT) {
+        __WFI();
+    }
+
+    return tv_lines[tv_line_head % TV_LINE_COUNT];
+}
+
+// Queues the next line, which is either the buffer returned by spi_tv_line_get() or a constant line.
+static void spi_tv_line_put(uint8_t *line) {
+    #ifdef __DCACHE_PRESENT
+    // Flush data for DMA
+    SCB_CleanDCache_by_Addr((uint32_t *) line, PICLINE_LENGTH_BYTES);
+    #endif
+
+    spi_tv_line_get();
+    tv_line_queue[tv_line_head % TV_LINE_COUNT] = line;
+
+    uint32_t irq_state = MICROPY_BEGIN_ATOMIC_SECTION();
+    tv_line_head += 1;
+
+    if (!tv_line_busy) {
+        tv_line_busy = true;
+        spi_tv_line_start();
+    }
+
+    MICROPY_END_ATOMIC_SECTION(irq_state);
+}
+
+static void spi_tv_line_sync() {
+    while (tv_line_busy) {
+        __WFI();
+    }
+}
+
+// The row is drawn into dst_row_override (whose left/right parts stay zeroed) and converted into
+// the next line buffer, so the row buffer is never touched by DMA.
 static void spi_tv_draw_image_cb_grayscale(int x_start, int x_end, int y_row, imlib_draw_row_data_t *data) {
-    memset(((uint8_t *) data->dst_row_override) + x_end, 0, TV_WIDTH - x_end); // clear trailing bytes.
-    spi_tv_draw_image_cb_convert_grayscale((uint8_t *) data->dst_row_override, (uint8_t *) data->dst_row_override);
-    SpiTransmitReceivePacket(data->dst_row_override, NULL, PICLINE_LENGTH_BYTES, false);
+    uint8_t *line = spi_tv_line_get();
+    spi_tv_draw_image_cb_convert_grayscale((uint8_t *) data->dst_row_override, line);
+    spi_tv_line_put(line);
 }
 
 static void spi_tv_draw_image_cb_rgb565(int x_start, int x_end, int y_row, imlib_draw_row_data_t *data) {
-    memset(data->dst_row_override, 0, x_start * sizeof(uint16_t)); // clear leading bytes.
-    spi_tv_draw_image_cb_convert_rgb565((uint16_t *) data->dst_row_override, (uint8_t *) data->dst_row_override);
-    SpiTransmitReceivePacket(data->dst_row_override, NULL, PICLINE_LENGTH_BYTES, false);
+    uint8_t *line = spi_tv_line_get();
+    spi_tv_draw_image_cb_convert_rgb565((uint16_t *) data->dst_row_override, line);
+    spi_tv_line_put(line);
 }
 
 static void spi_tv_display(image_t *src_img, int dst_x_start, int dst_y_start, float x_scale, float y_scale,
@@ -601,38 +675,44 @@ static void spi_tv_display(image_t *src_img, int dst_x_start, int dst_y_start, f
     bool black = p0.x == -1;
 
     if (!tv_triple_buffer) {
-        dst_img.data = fb_alloc0(TV_WIDTH_RGB565, FB_ALLOC_NO_HINT);
+        fb_alloc_mark();
+        dst_img.data = fb_alloc0(TV_WIDTH_RGB565, FB_ALLOC_CACHE_ALIGN);
+        uint8_t *zero_line = fb_alloc0(PICLINE_LENGTH_BYTES, FB_ALLOC_CACHE_ALIGN);
+
+        for (int i = 0; i < TV_LINE_COUNT; i++) {
+            tv_lines[i] = fb_alloc(PICLINE_LENGTH_BYTES, FB_ALLOC_CACHE_ALIGN);
+        }
+
+        tv_line_head = 0;
+        tv_line_tail = 0;
 
         SpiTransmitReceivePacket((uint8_t *) write_sram, NULL, sizeof(write_sram), false);
 
         if (black) {
             // zero the whole image
             for (int i = 0; i < TV_HEIGHT; i++) {
-                SpiTransmitReceivePacket(dst_img.data, NULL, PICLINE_LENGTH_BYTES, false);
+                spi_tv_line_put(zero_line);
             }
         } else {
             // Zero the top rows
             for (int i = 0; i < p0.y; i++) {
-                SpiTransmitReceivePacket(dst_img.data, NULL, PICLINE_LENGTH_BYTES, false);
+                spi_tv_line_put(zero_line);
             }
 
-            // Transmits left/right parts already zeroed...
+            // Left/right parts of the row buffer stay zeroed...
             imlib_draw_image(&dst_img, src_img, dst_x_start, dst_y_start, x_scale, y_scale, roi,
                              rgb_channel, alpha, color_palette, alpha_palette, hint | IMAGE_HINT_BLACK_BACKGROUND,
                              cb, NULL, dst_img.data);
 
             // Zero the bottom rows
-            if (p1.y < TV_HEIGHT) {
-                memset(dst_img.data, 0, TV_WIDTH_RGB565);
-            }
-
             for (int i = p1.y; i < TV_HEIGHT; i++) {
-                SpiTransmitReceivePacket(dst_img.data, NULL, PICLINE_LENGTH_BYTES, false);
+                spi_tv_line_put(zero_line);
             }
         }
 
+        spi_tv_line_sync();
         omv_gpio_write(OMV_SPI_DISPLAY_SSEL_PIN, 1);
-        fb_free();
+        fb_alloc_free_till_mark();
     } else {
         // For triple buffering we are never drawing where head or tail (which may instantly update to
         // to be equal to head) is.
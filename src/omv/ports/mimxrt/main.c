@@ -30,6 +30,7 @@
 
 #include "py_fir.h"
 #include "py_tv.h"
+#include "py_tof.h"
 
 #if MICROPY_PY_LWIP
 #include "lwip/init.h"
@@ -53,6 +54,7 @@
 
 #include "omv_boardconfig.h"
 #include "framebuffer.h"
+#include "trace.h"
 #include "sensor.h"
 #include "usbdbg.h"
 #include "tinyusb_debug.h"
@@ -87,12 +89,16 @@ soft_reset:
     #if MICROPY_PY_TV
     py_tv_init0();
     #endif
+    #if MICROPY_PY_TOF
+    py_tof_init0();
+    #endif
     #if MICROPY_PY_BUZZER
     py_buzzer_init0();
     #endif // MICROPY_PY_BUZZER
     imlib_init_all();
     readline_init0();
     fb_alloc_init0();
+    trace_init();
     framebuffer_init0();
     sensor_init0();
     //dma_alloc_init0();
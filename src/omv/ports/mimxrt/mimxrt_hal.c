@@ -17,6 +17,7 @@
 #include "fsl_lpi2c.h"
 #include "fsl_romapi.h"
 #include "fsl_dmamux.h"
+#include "fsl_edma.h"
 #include "fsl_usb_phy.h"
 #include "fsl_device_registers.h"
 #include CLOCK_CONFIG_H
@@ -24,13 +25,64 @@
 #include CMSIS_MCU_H
 
 #include "omv_boardconfig.h"
+#include "omv_common.h"
 // Define pin objects in this file.
 #define OMV_GPIO_DEFINE_PINS    (1)
 #include "omv_gpio.h"
 #include "mimxrt_hal.h"
+#include "omv_memcpy.h"
 
 const uint8_t dcd_data[] = {0};
 
+#if defined(OMV_MEMCPY_DMA)
+#define EDMA_MEMCPY_MINOR_SIZE      (32U)       // Bytes per request, the arbitration granularity.
+#define EDMA_MEMCPY_MAJOR_COUNT     (32767U)    // Max CITER without channel linking.
+
+static bool edma_memcpy_active;
+
+// Memory copies request continuously, so the channel is given the lowest fixed priority to not
+// hold off the peripheral channels. Priorities must be unique, so the two channels swap them.
+static void mimxrt_hal_memcpy_dma_init() {
+    uint8_t prio = DMA_DCHPRIn(OMV_MEMCPY_DMA, OMV_MEMCPY_DMA_CHANNEL) & DMA_DCHPRI0_CHPRI_MASK;
+
+    for (uint32_t i = 0; prio && (i < FSL_FEATURE_EDMA_MODULE_CHANNEL); i++) {
+        if (!(DMA_DCHPRIn(OMV_MEMCPY_DMA, i) & DMA_DCHPRI0_CHPRI_MASK)) {
+            DMA_DCHPRIn(OMV_MEMCPY_DMA, OMV_MEMCPY_DMA_CHANNEL) &= ~DMA_DCHPRI0_CHPRI_MASK;
+            DMA_DCHPRIn(OMV_MEMCPY_DMA, i) |= prio;
+            break;
+        }
+    }
+
+    DMAMUX_EnableAlwaysOn(OMV_MEMCPY_DMA_MUX, OMV_MEMCPY_DMA_CHANNEL, true);
+    DMAMUX_EnableChannel(OMV_MEMCPY_DMA_MUX, OMV_MEMCPY_DMA_CHANNEL);
+}
+
+size_t omv_memcpy_dma_start(void *dst, const void *src, size_t size) {
+    edma_transfer_config_t config;
+    uint32_t count = OMV_MIN(size / EDMA_MEMCPY_MINOR_SIZE, EDMA_MEMCPY_MAJOR_COUNT);
+    // The destination is cache line aligned, the source is read with the widest beats it allows.
+    uint32_t src_width = 1 << __builtin_ctz(((uint32_t) src) | EDMA_MEMCPY_MINOR_SIZE);
+
+    EDMA_ResetChannel(OMV_MEMCPY_DMA, OMV_MEMCPY_DMA_CHANNEL);
+    EDMA_PrepareTransfer(&config, (void *) src, src_width, dst, EDMA_MEMCPY_MINOR_SIZE,
+                         EDMA_MEMCPY_MINOR_SIZE, count * EDMA_MEMCPY_MINOR_SIZE, kEDMA_MemoryToMemory);
+    EDMA_SetTransferConfig(OMV_MEMCPY_DMA, OMV_MEMCPY_DMA_CHANNEL, &config, NULL);
+    // The always-on request is dropped when the major loop completes.
+    EDMA_EnableAutoStopRequest(OMV_MEMCPY_DMA, OMV_MEMCPY_DMA_CHANNEL, true);
+    edma_memcpy_active = true;
+    EDMA_EnableChannelRequest(OMV_MEMCPY_DMA, OMV_MEMCPY_DMA_CHANNEL);
+    return count * EDMA_MEMCPY_MINOR_SIZE;
+}
+
+bool omv_memcpy_dma_busy() {
+    if (edma_memcpy_active
+        && (EDMA_GetChannelStatusFlags(OMV_MEMCPY_DMA, OMV_MEMCPY_DMA_CHANNEL) & kEDMA_DoneFlag)) {
+        edma_memcpy_active = false;
+    }
+    return edma_memcpy_active;
+}
+#endif // OMV_MEMCPY_DMA
+
 void mimxrt_hal_init() {
     // Configure and enable clocks.
     BOARD_BootClockRUN();
@@ -92,6 +144,10 @@ void mimxrt_hal_init() {
     edma_config_t edma_config = {0};
     EDMA_GetDefaultConfig(&edma_config);
     EDMA_Init(DMA0, &edma_config);
+
+    #if defined(OMV_MEMCPY_DMA)
+    mimxrt_hal_memcpy_dma_init();
+    #endif
 }
 
 void mimxrt_hal_bootloader() {
@@ -102,6 +102,7 @@ endif
 #------------- Firmware Objects ----------------#
 FIRM_OBJ += $(wildcard $(BUILD)/$(CMSIS_DIR)/src/dsp/CommonTables/*.o)
 FIRM_OBJ += $(wildcard $(BUILD)/$(CMSIS_DIR)/src/dsp/FastMathFunctions/*.o)
+FIRM_OBJ += $(wildcard $(BUILD)/$(CMSIS_DIR)/src/dsp/TransformFunctions/*.o)
 
 FIRM_OBJ += $(wildcard $(BUILD)/$(HAL_DIR)/drivers/*.o)
 FIRM_OBJ += $(wildcard $(BUILD)/$(LEPTON_DIR)/src/*.o)
@@ -134,7 +135,13 @@ FIRM_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/common/, \
 	ringbuf.o                   \
 	trace.o                     \
 	mutex.o                     \
+	omv_cache.o                 \
+	omv_energy.o                \
+	omv_memcpy.o                \
+	omv_i2c_queue.o             \
+	omv_spi_chain.o             \
 	vospi.o                     \
+	omv_job.o                   \
 	pendsv.o                    \
 	usbdbg.o                    \
 	tinyusb_debug.o             \
@@ -162,8 +169,9 @@ FIRM_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/sensors/,   \
    )
 
 FIRM_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/imlib/, \
-	agast.o                     \
 	apriltag.o                  \
+	apriltag_tab.o              \
+	background.o                \
 	bayer.o                     \
 	binary.o                    \
 	blob.o                      \
@@ -183,6 +191,7 @@ FIRM_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/imlib/, \
 	fsort.o                     \
 	gif.o                       \
 	haar.o                      \
+	hdr.o                       \
 	hog.o                       \
 	hough.o                     \
 	imlib.o                     \
@@ -191,27 +200,34 @@ FIRM_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/imlib/, \
 	isp.o                       \
 	jpegd.o                     \
 	jpege.o                     \
-	lodepng.o                   \
 	png.o                       \
 	kmeans.o                    \
 	lab_tab.o                   \
 	lbp.o                       \
 	line.o                      \
 	lsd.o                       \
+	lz4.o                       \
 	mathop.o                    \
 	mjpeg.o                     \
+	optflow.o                   \
 	orb.o                       \
 	phasecorrelation.o          \
 	point.o                     \
 	ppm.o                       \
+	pyramid.o                   \
 	qrcode.o                    \
 	qsort.o                     \
 	rainbow_tab.o               \
+	raw.o                       \
 	rectangle.o                 \
+	rsort.o                     \
 	selective_search.o          \
 	sincos_tab.o                \
 	stats.o                     \
+	strip.o                     \
 	stereo.o                    \
+	task.o                      \
+	temporal.o                  \
 	template.o                  \
 	xyz_tab.o                   \
 	yuv.o                       \
@@ -526,6 +542,7 @@ UVC_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/imlib/,\
 	lab_tab.o                               \
 	xyz_tab.o                               \
 	rainbow_tab.o                           \
+	raw.o                                   \
 	jpeg.o                                  \
 	fmath.o                                 \
 	imlib.o                                 \
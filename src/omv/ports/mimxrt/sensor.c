@@ -23,6 +23,7 @@
 #include "sensor.h"
 #include "framebuffer.h"
 #include "unaligned_memcpy.h"
+#include "omv_job.h"
 
 #define DMA_LENGTH_ALIGNMENT     (8)
 #define SENSOR_TIMEOUT_MS        (3000)
@@ -196,7 +197,7 @@ void sensor_sof_callback() {
     vbuffer_t *buffer = framebuffer_get_tail(FB_PEEK);
     if (buffer == NULL) {
         sensor_abort(false, true);
-    } else if (buffer->offset < resolution[sensor.framesize][1]) {
+    } else if (buffer->offset < sensor_get_src_height()) {
         // Missed a few lines, reset buffer state and continue.
         buffer->reset_state = true;
     }
@@ -212,25 +213,12 @@ int sensor_dma_memcpy(void *dma, void *dst, void *src, int bpp, bool transposed)
         return -1;
     }
 
+    // The rest of the TCD is the same for every line and was set up by edma_config_tcd(), so only
+    // the line addresses are written here.
     edma_handle_t *handle = dma;
-    edma_transfer_config_t config;
-    EDMA_PrepareTransferConfig(&config,
-                               src, // srcAddr
-                               src_size, // srcWidth
-                               src_inc, // srcOffset
-                               dst, // destAddr
-                               transposed ? bpp : dest_inc_size, // destWidth
-                               transposed ? (MAIN_FB()->v * bpp) : dest_inc_size, // destOffset
-                               MAIN_FB()->u * bpp, // bytesEachRequest
-                               MAIN_FB()->u * bpp); // transferBytes
+    volatile edma_tcd_t *tcd = (volatile edma_tcd_t *) &handle->base->TCD[handle->channel];
 
-    size_t retry = 3;
-    status_t status = kStatus_EDMA_Busy;
-    while (status == kStatus_EDMA_Busy) {
-        status = EDMA_SubmitTransfer(handle, &config);
-        if (status == kStatus_Success) {
-            break;
-        }
+    for (size_t retry = 3; (tcd->CSR & DMA_CSR_ACTIVE_MASK) || (tcd->CITER != tcd->BITER); ) {
         if (--retry == 0) {
             // Drop the frame if EDMA is not keeping up as the image will be corrupt.
             sensor.drop_frame = true;
@@ -238,6 +226,8 @@ int sensor_dma_memcpy(void *dma, void *dst, void *src, int bpp, bool transposed)
         }
     }
 
+    tcd->SADDR = (uint32_t) src;
+    tcd->DADDR = (uint32_t) dst;
     EDMA_TriggerChannelStart(handle->base, handle->channel);
     return 0;
 }
@@ -304,17 +294,18 @@ void sensor_line_callback(uint32_t addr) {
     }
 
     if (sensor.drop_frame) {
-        if (++buffer->offset == resolution[sensor.framesize][1]) {
+        if (++buffer->offset == sensor_get_src_height()) {
             buffer->offset = 0;
             CSI_REG_CR3(CSI) &= ~CSI_CR3_DMA_REQ_EN_RFF_MASK;
         }
         return;
     }
 
-    if ((MAIN_FB()->y <= buffer->offset) && (buffer->offset < (MAIN_FB()->y + MAIN_FB()->v))) {
+    uint32_t src_y = sensor_get_src_y();
+    if ((src_y <= buffer->offset) && (buffer->offset < (src_y + MAIN_FB()->v))) {
         // Copy from DMA buffer to framebuffer.
         uint32_t bytes_per_pixel = sensor_get_src_bpp();
-        uint8_t *src = ((uint8_t *) addr) + (MAIN_FB()->x * bytes_per_pixel);
+        uint8_t *src = ((uint8_t *) addr) + (sensor_get_src_x() * bytes_per_pixel);
         uint8_t *dst = buffer->data;
 
         // Adjust BPP for Grayscale.
@@ -323,9 +314,9 @@ void sensor_line_callback(uint32_t addr) {
         }
 
         if (sensor.transpose) {
-            dst += bytes_per_pixel * (buffer->offset - MAIN_FB()->y);
+            dst += bytes_per_pixel * (buffer->offset - src_y);
         } else {
-            dst += MAIN_FB()->u * bytes_per_pixel * (buffer->offset - MAIN_FB()->y);
+            dst += MAIN_FB()->u * bytes_per_pixel * (buffer->offset - src_y);
         }
 
         #if defined(OMV_CSI_DMA)
@@ -338,7 +329,7 @@ void sensor_line_callback(uint32_t addr) {
         #endif
     }
 
-    if (++buffer->offset == resolution[sensor.framesize][1]) {
+    if (++buffer->offset == sensor_get_src_height()) {
         // Release the current framebuffer.
         framebuffer_get_tail(FB_NO_FLAGS);
         CSI_REG_CR3(CSI) &= ~CSI_CR3_DMA_REQ_EN_RFF_MASK;
@@ -350,7 +341,7 @@ void sensor_line_callback(uint32_t addr) {
 
 #if defined(OMV_CSI_DMA)
 static void edma_config(sensor_t *sensor, uint32_t bytes_per_pixel) {
-    uint32_t line_offset_bytes = MAIN_FB()->x * bytes_per_pixel;
+    uint32_t line_offset_bytes = sensor_get_src_x() * bytes_per_pixel;
     uint32_t line_width_bytes = MAIN_FB()->u * bytes_per_pixel;
 
     // YUV422 Source -> Y Destination
@@ -386,6 +377,23 @@ static void edma_config(sensor_t *sensor, uint32_t bytes_per_pixel) {
         src_size = 1;
     }
 }
+
+// Sets up everything but the addresses of each channel's TCD once per capture, so the line callback
+// doesn't have to rebuild the whole TCD for every line.
+static void edma_config_tcd(sensor_t *sensor, uint32_t channel) {
+    uint32_t bpp = ((sensor->pixformat == PIXFORMAT_GRAYSCALE) || (sensor->pixformat == PIXFORMAT_BAYER)) ? 1 : 2;
+    edma_transfer_config_t config;
+    EDMA_PrepareTransferConfig(&config,
+                               NULL, // srcAddr
+                               src_size, // srcWidth
+                               src_inc, // srcOffset
+                               NULL, // destAddr
+                               sensor->transpose ? bpp : dest_inc_size, // destWidth
+                               sensor->transpose ? (MAIN_FB()->v * bpp) : dest_inc_size, // destOffset
+                               MAIN_FB()->u * bpp, // bytesEachRequest
+                               MAIN_FB()->u * bpp); // transferBytes
+    EDMA_SetTransferConfig(OMV_CSI_DMA, channel, &config, NULL);
+}
 #endif
 
 // This is the default snapshot function, which can be replaced in sensor_init functions.
@@ -419,7 +427,7 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
 
         // Re/configure and re/start the CSI.
         uint32_t bytes_per_pixel = sensor_get_src_bpp();
-        uint32_t dma_line_bytes = resolution[sensor->framesize][0] * bytes_per_pixel;
+        uint32_t dma_line_bytes = sensor_get_src_width() * bytes_per_pixel;
         uint32_t length = dma_line_bytes * h;
 
         // Error out if the transfer size is not compatible with DMA transfer restrictions.
@@ -438,6 +446,7 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
             for (int i = 0; i < OMV_CSI_DMA_CHANNEL_COUNT; i++) {
                 EDMA_CreateHandle(&CSI_EDMA_Handle[i], OMV_CSI_DMA, OMV_CSI_DMA_CHANNEL_START + i);
                 EDMA_DisableChannelInterrupts(OMV_CSI_DMA, OMV_CSI_DMA_CHANNEL_START + i, kEDMA_MajorInterruptEnable);
+                edma_config_tcd(sensor, OMV_CSI_DMA_CHANNEL_START + i);
             }
         }
         #endif
@@ -471,6 +480,7 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
     vbuffer_t *buffer = framebuffer_get_head(FB_NO_FLAGS);
     // Wait for the DMA to finish the transfer.
     for (mp_uint_t ticks = mp_hal_ticks_ms(); buffer == NULL;) {
+        omv_job_run();
         MICROPY_EVENT_POLL_HOOK
         if ((mp_hal_ticks_ms() - ticks) > SENSOR_TIMEOUT_MS) {
             sensor_abort(true, false);
@@ -536,7 +546,7 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
             }
             // Clean trailing data after 0xFFD9 at the end of the jpeg byte stream.
             MAIN_FB()->pixfmt = PIXFORMAT_JPEG;
-            MAIN_FB()->size = jpeg_clean_trailing_bytes(size, buffer->data);
+            MAIN_FB()->size = jpeg_clean_trailing_bytes(size, buffer->data, SENSOR_JPEG_EOI_SEARCH);
             break;
         }
         default:
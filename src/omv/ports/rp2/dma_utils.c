@@ -0,0 +1,43 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * RP2 DMA helper functions.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/dma.h"
+#include "omv_boardconfig.h"
+#include "omv_memcpy.h"
+
+#if defined(OMV_MEMCPY_DMA_CHANNEL)
+static bool dma_memcpy_claimed;
+
+size_t omv_memcpy_dma_start(void *dst, const void *src, size_t size) {
+    // The channel is claimed on first use, it's left to the CPU if something else claimed it.
+    if (!dma_memcpy_claimed) {
+        if (dma_channel_is_claimed(OMV_MEMCPY_DMA_CHANNEL)) {
+            return 0;
+        }
+        dma_channel_claim(OMV_MEMCPY_DMA_CHANNEL);
+        dma_memcpy_claimed = true;
+    }
+
+    // The destination is aligned, words are only used if the source is too.
+    enum dma_channel_transfer_size width = (((uint32_t) src) & 3) ? DMA_SIZE_8 : DMA_SIZE_32;
+    dma_channel_config config = dma_channel_get_default_config(OMV_MEMCPY_DMA_CHANNEL);
+    channel_config_set_transfer_data_size(&config, width);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, true);
+    dma_channel_configure(OMV_MEMCPY_DMA_CHANNEL, &config, dst, src, size >> width, true);
+    return size;
+}
+
+bool omv_memcpy_dma_busy() {
+    return dma_memcpy_claimed && dma_channel_is_busy(OMV_MEMCPY_DMA_CHANNEL);
+}
+#endif // OMV_MEMCPY_DMA_CHANNEL
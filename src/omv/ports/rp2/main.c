@@ -57,6 +57,7 @@
 #include "omv_boardconfig.h"
 #include "framebuffer.h"
 #include "omv_i2c.h"
+#include "omv_core1.h"
 #include "sensor.h"
 #include "usbdbg.h"
 #include "tinyusb_debug.h"
@@ -173,6 +174,7 @@ soft_reset:
     framebuffer_init0();
 
     py_fir_init0();
+    omv_core1_init0();
 
     #if MICROPY_PY_SENSOR
     if (sensor_init() != 0) {
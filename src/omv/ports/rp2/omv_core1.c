@@ -0,0 +1,114 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Core1 job worker.
+ *
+ * Core0 passes a job to core1 as two words (function, argument) over the SIO FIFO and
+ * core1 answers with one word when the job is done. Only one job is in flight at a time.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include "hardware/structs/sio.h"
+
+#include "omv_boardconfig.h"
+#include "omv_core1.h"
+
+#if OMV_CORE1_ENABLE
+static volatile bool core1_running = false;
+static volatile bool core1_busy = false;
+
+// The idle loop runs from RAM and doesn't use the SDK FIFO helpers, which live in flash,
+// so that flash can be written by core0 while core1 waits for a job.
+static uint32_t __not_in_flash_func(core1_fifo_pop)() {
+    while (!(sio_hw->fifo_st & SIO_FIFO_ST_VLD_BITS)) {
+        __wfe();
+    }
+    return sio_hw->fifo_rd;
+}
+
+static void __not_in_flash_func(core1_main)() {
+    core1_running = true;
+
+    for (;;) {
+        omv_core1_job_t func = (omv_core1_job_t) core1_fifo_pop();
+        void *arg = (void *) core1_fifo_pop();
+        func(arg);
+
+        while (!(sio_hw->fifo_st & SIO_FIFO_ST_RDY_BITS)) {
+            tight_loop_contents();
+        }
+        sio_hw->fifo_wr = 1;
+        __sev();
+    }
+}
+
+// _thread takes over core1 with multicore_launch_core1(), which also stops the worker.
+// Its entry point registers core1 as a lockout victim, which the worker never does.
+static bool core1_owned_by_thread() {
+    return multicore_lockout_victim_is_initialized(1);
+}
+
+void omv_core1_init0() {
+    if (core1_owned_by_thread()) {
+        core1_running = false;
+    } else if (!core1_running) {
+        multicore_launch_core1(core1_main);
+        while (!core1_running) {
+            tight_loop_contents();
+        }
+    }
+    core1_busy = false;
+}
+
+void omv_core1_deinit() {
+    if (core1_running) {
+        multicore_reset_core1();
+        multicore_fifo_drain();
+        core1_running = false;
+        core1_busy = false;
+    }
+}
+
+bool omv_core1_exec(omv_core1_job_t func, void *arg) {
+    if (core1_running && core1_owned_by_thread()) {
+        core1_running = false;
+    }
+
+    if (!core1_running || core1_busy) {
+        return false;
+    }
+
+    core1_busy = true;
+    multicore_fifo_push_blocking((uint32_t) func);
+    multicore_fifo_push_blocking((uint32_t) arg);
+    return true;
+}
+
+void omv_core1_wait() {
+    if (core1_busy) {
+        multicore_fifo_pop_blocking();
+        core1_busy = false;
+    }
+}
+#else
+void omv_core1_init0() {
+}
+
+void omv_core1_deinit() {
+}
+
+bool omv_core1_exec(omv_core1_job_t func, void *arg) {
+    return false;
+}
+
+void omv_core1_wait() {
+}
+#endif // OMV_CORE1_ENABLE
@@ -0,0 +1,26 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Core1 job worker.
+ */
+#ifndef __OMV_CORE1_H__
+#define __OMV_CORE1_H__
+#include <stdbool.h>
+
+// Jobs run on core1 must not call into MicroPython (gc, exceptions) or fb_alloc, they
+// should only work on buffers set up by the caller, such as one half of the frame.
+typedef void (*omv_core1_job_t) (void *arg);
+
+void omv_core1_init0();
+void omv_core1_deinit();
+// Starts func(arg) on core1, returns false if the worker isn't running or is busy,
+// in which case the caller should run the job itself.
+bool omv_core1_exec(omv_core1_job_t func, void *arg);
+// Waits for the job started by omv_core1_exec() to finish.
+void omv_core1_wait();
+#endif // __OMV_CORE1_H__
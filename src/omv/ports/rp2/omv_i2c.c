@@ -25,6 +25,9 @@
 int omv_i2c_init(omv_i2c_t *i2c, uint32_t bus_id, uint32_t speed) {
     i2c->id = bus_id;
     i2c->initialized = false;
+    i2c->xfer_head = NULL;
+    i2c->xfer_tail = NULL;
+    i2c->xfer_busy = false;
 
     switch (speed) {
         case OMV_I2C_SPEED_STANDARD:
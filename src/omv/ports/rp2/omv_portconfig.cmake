@@ -38,6 +38,7 @@ target_compile_definitions(${MICROPY_TARGET} PRIVATE
 
 target_link_libraries(${MICROPY_TARGET}
     pico_bootsel_via_double_reset
+    pico_multicore
 )
 
 # Linker script
@@ -59,7 +60,7 @@ pico_set_linker_script(${MICROPY_TARGET} ${BUILD}/rp2.ld)
 file(GLOB OMV_SRC_QSTR1 ${TOP_DIR}/${OMV_DIR}/modules/*.c)
 file(GLOB OMV_SRC_QSTR2 ${TOP_DIR}/${OMV_DIR}/ports/${PORT}/modules/*.c)
 list(APPEND MICROPY_SOURCE_QSTR ${OMV_SRC_QSTR1} ${OMV_SRC_QSTR2})
-set(MPY_PENDSV_ENTRIES PENDSV_DISPATCH_CDC,)
+set(MPY_PENDSV_ENTRIES PENDSV_DISPATCH_CDC,PENDSV_DISPATCH_JOB,)
 
 target_include_directories(${MICROPY_TARGET} PRIVATE
     ${TOP_DIR}/${CMSIS_DIR}/include/
@@ -102,6 +103,11 @@ target_sources(${MICROPY_TARGET} PRIVATE
     ${TOP_DIR}/${OMV_DIR}/common/ringbuf.c
     ${TOP_DIR}/${OMV_DIR}/common/trace.c
     ${TOP_DIR}/${OMV_DIR}/common/mutex.c
+    ${TOP_DIR}/${OMV_DIR}/common/omv_cache.c
+    ${TOP_DIR}/${OMV_DIR}/common/omv_energy.c
+    ${TOP_DIR}/${OMV_DIR}/common/omv_memcpy.c
+    ${TOP_DIR}/${OMV_DIR}/common/omv_i2c_queue.c
+    ${TOP_DIR}/${OMV_DIR}/common/omv_job.c
     ${TOP_DIR}/${OMV_DIR}/common/pendsv.c
     ${TOP_DIR}/${OMV_DIR}/common/usbdbg.c
     ${TOP_DIR}/${OMV_DIR}/common/tinyusb_debug.c
@@ -121,8 +127,9 @@ target_sources(${MICROPY_TARGET} PRIVATE
     ${TOP_DIR}/${OMV_DIR}/sensors/hm01b0.c
     ${TOP_DIR}/${OMV_DIR}/sensors/gc2145.c
 
-    ${TOP_DIR}/${OMV_DIR}/imlib/agast.c
     ${TOP_DIR}/${OMV_DIR}/imlib/apriltag.c
+    ${TOP_DIR}/${OMV_DIR}/imlib/apriltag_tab.c
+    ${TOP_DIR}/${OMV_DIR}/imlib/background.c
     ${TOP_DIR}/${OMV_DIR}/imlib/bayer.c
     ${TOP_DIR}/${OMV_DIR}/imlib/binary.c
     ${TOP_DIR}/${OMV_DIR}/imlib/blob.c
@@ -142,6 +149,7 @@ target_sources(${MICROPY_TARGET} PRIVATE
     ${TOP_DIR}/${OMV_DIR}/imlib/fsort.c
     ${TOP_DIR}/${OMV_DIR}/imlib/gif.c
     ${TOP_DIR}/${OMV_DIR}/imlib/haar.c
+    ${TOP_DIR}/${OMV_DIR}/imlib/hdr.c
     ${TOP_DIR}/${OMV_DIR}/imlib/hog.c
     ${TOP_DIR}/${OMV_DIR}/imlib/hough.c
     ${TOP_DIR}/${OMV_DIR}/imlib/imlib.c
@@ -150,36 +158,45 @@ target_sources(${MICROPY_TARGET} PRIVATE
     ${TOP_DIR}/${OMV_DIR}/imlib/isp.c
     ${TOP_DIR}/${OMV_DIR}/imlib/jpegd.c
     ${TOP_DIR}/${OMV_DIR}/imlib/jpege.c
-    ${TOP_DIR}/${OMV_DIR}/imlib/lodepng.c
     ${TOP_DIR}/${OMV_DIR}/imlib/png.c
     ${TOP_DIR}/${OMV_DIR}/imlib/kmeans.c
     ${TOP_DIR}/${OMV_DIR}/imlib/lab_tab.c
     ${TOP_DIR}/${OMV_DIR}/imlib/lbp.c
     ${TOP_DIR}/${OMV_DIR}/imlib/line.c
     ${TOP_DIR}/${OMV_DIR}/imlib/lsd.c
+    ${TOP_DIR}/${OMV_DIR}/imlib/lz4.c
     ${TOP_DIR}/${OMV_DIR}/imlib/mathop.c
     ${TOP_DIR}/${OMV_DIR}/imlib/mjpeg.c
+    ${TOP_DIR}/${OMV_DIR}/imlib/optflow.c
     ${TOP_DIR}/${OMV_DIR}/imlib/orb.c
     ${TOP_DIR}/${OMV_DIR}/imlib/phasecorrelation.c
     ${TOP_DIR}/${OMV_DIR}/imlib/point.c
     ${TOP_DIR}/${OMV_DIR}/imlib/ppm.c
+    ${TOP_DIR}/${OMV_DIR}/imlib/pyramid.c
     ${TOP_DIR}/${OMV_DIR}/imlib/qrcode.c
     ${TOP_DIR}/${OMV_DIR}/imlib/qsort.c
     ${TOP_DIR}/${OMV_DIR}/imlib/rainbow_tab.c
+    ${TOP_DIR}/${OMV_DIR}/imlib/raw.c
     ${TOP_DIR}/${OMV_DIR}/imlib/rectangle.c
+    ${TOP_DIR}/${OMV_DIR}/imlib/rsort.c
     ${TOP_DIR}/${OMV_DIR}/imlib/selective_search.c
     ${TOP_DIR}/${OMV_DIR}/imlib/sincos_tab.c
     ${TOP_DIR}/${OMV_DIR}/imlib/stats.c
+    ${TOP_DIR}/${OMV_DIR}/imlib/strip.c
     ${TOP_DIR}/${OMV_DIR}/imlib/stereo.c
+    ${TOP_DIR}/${OMV_DIR}/imlib/task.c
+    ${TOP_DIR}/${OMV_DIR}/imlib/temporal.c
     ${TOP_DIR}/${OMV_DIR}/imlib/template.c
     ${TOP_DIR}/${OMV_DIR}/imlib/xyz_tab.c
     ${TOP_DIR}/${OMV_DIR}/imlib/yuv.c
     ${TOP_DIR}/${OMV_DIR}/imlib/zbar.c
 
     ${TOP_DIR}/${OMV_DIR}/ports/${PORT}/main.c
+    ${TOP_DIR}/${OMV_DIR}/ports/${PORT}/dma_utils.c
     ${TOP_DIR}/${OMV_DIR}/ports/${PORT}/sensor.c
     ${TOP_DIR}/${OMV_DIR}/ports/${PORT}/omv_gpio.c
     ${TOP_DIR}/${OMV_DIR}/ports/${PORT}/omv_i2c.c
+    ${TOP_DIR}/${OMV_DIR}/ports/${PORT}/omv_core1.c
 
     ${OMV_USER_MODULES}
 )
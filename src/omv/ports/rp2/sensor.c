@@ -25,6 +25,7 @@
 #include "hardware/irq.h"
 #include "omv_boardconfig.h"
 #include "unaligned_memcpy.h"
+#include "omv_job.h"
 #include "dcmi.pio.h"
 
 // Sensor struct.
@@ -247,6 +248,7 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
 
     // Wait for the DMA to finish the transfer.
     for (mp_uint_t ticks = mp_hal_ticks_ms(); buffer == NULL;) {
+        omv_job_run();
         buffer = framebuffer_get_head(FB_NO_FLAGS);
         if ((mp_hal_ticks_ms() - ticks) > 3000) {
             sensor_abort(true, false);
@@ -0,0 +1,127 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2023 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2023 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * CM7 side of the CM4 job queue.
+ *
+ * No board enables OMV_ENABLE_CM4 yet, so the queue hasn't run on hardware. Until it has been
+ * validated on a dual-core H747 board imlib runs every kernel on the CM7.
+ */
+#if OMV_ENABLE_CM4
+#include <stdbool.h>
+#include "py/mphal.h"
+
+#include "omv_boardconfig.h"
+#include "cm4_ipc.h"
+#include "omv_cache.h"
+
+// The CM4 can't access the ITCM/DTCM.
+#define CM4_IPC_DTCM_START  (0x20000000)
+#define CM4_IPC_DTCM_END    (0x20020000)
+#define CM4_IPC_ITCM_END    (0x00010000)
+
+static void cm4_ipc_invalidate(void *addr, uint32_t size) {
+    omv_cache_invalidate(addr, size);
+}
+
+static void cm4_ipc_clean(void *addr, uint32_t size) {
+    omv_cache_clean(addr, size);
+}
+
+bool cm4_ipc_ready() {
+    cm4_ipc_t *ipc = CM4_IPC;
+    cm4_ipc_invalidate((void *) &ipc->magic, sizeof(ipc->magic));
+    return ipc->magic == CM4_IPC_MAGIC;
+}
+
+bool cm4_ipc_accessible(const void *addr, uint32_t size) {
+    uint32_t start = (uint32_t) addr;
+    uint32_t end = start + size;
+    return (start >= CM4_IPC_ITCM_END) && ((end <= CM4_IPC_DTCM_START) || (start >= CM4_IPC_DTCM_END));
+}
+
+cm4_job_t *cm4_ipc_submit(cm4_kernel_t kernel, const uint32_t *args, int n_args) {
+    if (!cm4_ipc_ready() || (n_args > CM4_IPC_JOB_ARGS)) {
+        return NULL;
+    }
+
+    cm4_ipc_t *ipc = CM4_IPC;
+    for (int i = 0; i < CM4_IPC_JOBS; i++) {
+        cm4_job_t *job = &ipc->jobs[i];
+        cm4_ipc_invalidate(job, sizeof(cm4_job_t));
+        if (job->state != CM4_JOB_FREE) {
+            continue;
+        }
+
+        job->kernel = kernel;
+        for (int j = 0; j < n_args; j++) {
+            job->args[j] = args[j];
+        }
+
+        // Publish the arguments before the state.
+        cm4_ipc_clean(job, sizeof(cm4_job_t));
+        __DSB();
+        job->state = CM4_JOB_PENDING;
+        cm4_ipc_clean(job, sizeof(cm4_job_t));
+        __DSB();
+
+        // Releasing the semaphore raises the CM4 notification interrupt.
+        if (HAL_HSEM_FastTake(CM4_IPC_HSEM_ID) == HAL_OK) {
+            HAL_HSEM_Release(CM4_IPC_HSEM_ID, 0);
+        }
+        return job;
+    }
+
+    return NULL;
+}
+
+static void cm4_ipc_lock() {
+    while (HAL_HSEM_FastTake(CM4_IPC_LOCK_HSEM_ID) != HAL_OK) {
+    }
+}
+
+static void cm4_ipc_unlock() {
+    HAL_HSEM_Release(CM4_IPC_LOCK_HSEM_ID, 0);
+}
+
+static void cm4_ipc_free(cm4_job_t *job) {
+    job->state = CM4_JOB_FREE;
+    cm4_ipc_clean(job, sizeof(cm4_job_t));
+    __DSB();
+}
+
+bool cm4_ipc_wait(cm4_job_t *job, uint32_t timeout) {
+    for (mp_uint_t start = mp_hal_ticks_ms(); (mp_hal_ticks_ms() - start) < timeout;) {
+        cm4_ipc_invalidate(job, sizeof(cm4_job_t));
+        if (job->state == CM4_JOB_DONE) {
+            cm4_ipc_free(job);
+            return true;
+        }
+    }
+
+    // Revoke the job if the CM4 hasn't claimed it yet, so it never touches the job's buffers.
+    cm4_ipc_lock();
+    cm4_ipc_invalidate(job, sizeof(cm4_job_t));
+    bool revoked = (job->state == CM4_JOB_PENDING);
+    if (revoked) {
+        cm4_ipc_free(job);
+    }
+    cm4_ipc_unlock();
+
+    if (revoked) {
+        return false;
+    }
+
+    // The CM4 is running the job and using its buffers, which can't be freed before it's done.
+    do {
+        cm4_ipc_invalidate(job, sizeof(cm4_job_t));
+    } while (job->state != CM4_JOB_DONE);
+
+    cm4_ipc_free(job);
+    return true;
+}
+#endif // OMV_ENABLE_CM4
@@ -14,6 +14,7 @@
 #include "omv_boardconfig.h"
 #include "omv_common.h"
 #include "dma_utils.h"
+#include "omv_memcpy.h"
 
 // Defined in micropython/ports/stm32/dma.c
 // or in uvc/src/main.c
@@ -173,3 +174,49 @@ int dma_utils_set_irq_descr(DMA_Stream_TypeDef *dma_channel, DMA_HandleTypeDef *
     }
     return -1;
 }
+
+#if defined(OMV_MDMA_CHANNEL_MEMCPY)
+#define MDMA_MEMCPY_BLOCK_SIZE      (4096U)
+#define MDMA_MEMCPY_BLOCK_COUNT     (4096U) // Max block repeat count.
+#define MDMA_MEMCPY_BUFFER_SIZE     (128)  // Max buffer transfer length.
+
+static MDMA_HandleTypeDef mdma_memcpy_handle;
+
+size_t omv_memcpy_dma_start(void *dst, const void *src, size_t size) {
+    MDMA_HandleTypeDef *handle = &mdma_memcpy_handle;
+    uint32_t block = OMV_MIN(size, MDMA_MEMCPY_BLOCK_SIZE);
+    uint32_t count = OMV_MIN(size / block, MDMA_MEMCPY_BLOCK_COUNT);
+    // The destination is cache line aligned, the source is read with the widest beats it allows.
+    uint32_t src_shift = __builtin_ctz(((uint32_t) src) | 8);
+
+    handle->Instance = MDMA_CHAN_TO_INSTANCE(OMV_MDMA_CHANNEL_MEMCPY);
+    handle->Init.Request = MDMA_REQUEST_SW;
+    handle->Init.TransferTriggerMode = MDMA_FULL_TRANSFER;
+    handle->Init.Priority = MDMA_PRIORITY_LOW;
+    handle->Init.Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
+    handle->Init.SourceInc = MDMA_CTCR_SINC_1 | (src_shift << MDMA_CTCR_SINCOS_Pos);
+    handle->Init.DestinationInc = MDMA_DEST_INC_DOUBLEWORD;
+    handle->Init.SourceDataSize = src_shift << MDMA_CTCR_SSIZE_Pos;
+    handle->Init.DestDataSize = MDMA_DEST_DATASIZE_DOUBLEWORD;
+    handle->Init.DataAlignment = MDMA_DATAALIGN_PACKENABLE;
+    handle->Init.BufferTransferLength = MDMA_MEMCPY_BUFFER_SIZE;
+    handle->Init.SourceBurst = __builtin_ctz(MDMA_MEMCPY_BUFFER_SIZE >> src_shift) << MDMA_CTCR_SBURST_Pos;
+    handle->Init.DestBurst = MDMA_DEST_BURST_16BEATS;
+    handle->Init.SourceBlockAddressOffset = 0;
+    handle->Init.DestBlockAddressOffset = 0;
+    HAL_MDMA_Init(handle);
+
+    // Nothing completes the transfer through the IRQ handler, so the handle is always reset here.
+    __HAL_UNLOCK(handle);
+    handle->State = HAL_MDMA_STATE_READY;
+    if (HAL_MDMA_Start(handle, (uint32_t) src, (uint32_t) dst, block, count) != HAL_OK) {
+        return 0;
+    }
+
+    return block * count;
+}
+
+bool omv_memcpy_dma_busy() {
+    return mdma_memcpy_handle.Instance && (mdma_memcpy_handle.Instance->CCR & MDMA_CCR_EN);
+}
+#endif // OMV_MDMA_CHANNEL_MEMCPY
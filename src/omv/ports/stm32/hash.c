@@ -8,13 +8,42 @@
  *
  * Hash functions.
  */
-#if (OMV_ENABLE_HASH == 1)
 #include STM32_HAL_H
 #include <stdbool.h>
 #include <stdio.h>
 #include "hash.h"
 #include "fb_alloc.h"
 #include "file_utils.h"
+#include "imlib.h"
+
+#if defined(CRC_CR_REV_IN)
+// Overrides the imlib software CRC-32 with the CRC unit, which is configured for the
+// IEEE 802.3 polynomial with reflected input/output (zlib's crc32()). Whole words are
+// written with word bit-reversal and the trailing bytes with byte bit-reversal.
+uint32_t imlib_crc32(uint32_t crc, const void *data, size_t size) {
+    const uint8_t *ptr = (const uint8_t *) data;
+
+    __HAL_RCC_CRC_CLK_ENABLE();
+    CRC->POL = 0x04C11DB7;
+    CRC->INIT = __RBIT(~crc);
+    CRC->CR = CRC_CR_REV_IN | CRC_CR_REV_OUT | CRC_CR_RESET;
+
+    for (; size >= 4; size -= 4, ptr += 4) {
+        CRC->DR = __UNALIGNED_UINT32_READ(ptr);
+    }
+
+    if (size) {
+        CRC->CR = CRC_CR_REV_IN_0 | CRC_CR_REV_OUT;
+        for (; size; size--, ptr++) {
+            *((__IO uint8_t *) &CRC->DR) = *ptr;
+        }
+    }
+
+    return ~CRC->DR;
+}
+#endif // defined(CRC_CR_REV_IN)
+
+#if (OMV_ENABLE_HASH == 1)
 
 #define BLOCK_SIZE    (512)
 static HASH_HandleTypeDef hhash;
@@ -11,6 +11,7 @@
 #include "omv_boardconfig.h"
 #if (OMV_JPEG_CODEC_ENABLE == 1)
 #include "imlib.h"
+#include "trace.h"
 
 #include "py/mphal.h"
 #include "py/runtime.h"
@@ -18,6 +19,7 @@
 #include STM32_HAL_H
 #include "irq.h"
 #include "dma_utils.h"
+#include "omv_cache.h"
 
 #define TIME_JPEG                   (0)
 #if (TIME_JPEG == 1)
@@ -97,7 +99,7 @@ static void jpeg_compress_data_ready(JPEG_HandleTypeDef *hjpeg, uint8_t *pDataOu
         // buffer for the initial DMA chunks. So, this code below will do that and then only
         // invalidate aligned regions when the processor is moving the final parts of the image.
         if (!(((uint32_t) new_pDataOut) % __SCB_DCACHE_LINE_SIZE)) {
-            SCB_InvalidateDCache_by_Addr((uint32_t *) new_pDataOut, JPEG_OUTPUT_CHUNK_SIZE);
+            omv_cache_invalidate(new_pDataOut, JPEG_OUTPUT_CHUNK_SIZE);
         }
 
         // We are ok to receive more data.
@@ -106,6 +108,8 @@ static void jpeg_compress_data_ready(JPEG_HandleTypeDef *hjpeg, uint8_t *pDataOu
 }
 
 bool jpeg_compress(image_t *src, image_t *dst, int quality, bool realloc, jpeg_subsampling_t subsampling) {
+    TRACE_PROF_SCOPE(TRACE_PROF_JPEG_COMPRESS);
+
     #if (TIME_JPEG == 1)
     mp_uint_t start = mp_hal_ticks_ms();
     #endif
@@ -294,11 +298,11 @@ bool jpeg_compress(image_t *src, image_t *dst, int quality, bool realloc, jpeg_s
         }
 
         // Flush the MCU row for DMA...
-        SCB_CleanDCache_by_Addr((uint32_t *) mcu_row_buffer_ptr, src_w_mcus_bytes);
+        omv_cache_clean(mcu_row_buffer_ptr, src_w_mcus_bytes);
 
         if (!y_offset) {
             // Invalidate the output buffer.
-            SCB_InvalidateDCache_by_Addr(dma_buffer, JPEG_OUTPUT_CHUNK_SIZE);
+            omv_cache_invalidate(dma_buffer, JPEG_OUTPUT_CHUNK_SIZE);
             // Start the DMA process off on the first row of MCUs.
             HAL_JPEG_Encode_DMA(&JPEG_state.jpeg_descr, mcu_row_buffer_ptr, src_w_mcus_bytes, dma_buffer,
                                 JPEG_OUTPUT_CHUNK_SIZE);
@@ -358,7 +362,7 @@ bool jpeg_compress(image_t *src, image_t *dst, int quality, bool realloc, jpeg_s
     memset(dst->data + sizeof(uint32_t) + sizeof(JPEG_APP0), 0, app0_padding_size - sizeof(uint16_t)); // data
 
     // Clean trailing data after 0xFFD9 at the end of the jpeg byte stream.
-    dst->size = jpeg_clean_trailing_bytes(dst->size, dst->data);
+    dst->size = jpeg_clean_trailing_bytes(dst->size, dst->data, dst->size);
 
     #if (TIME_JPEG == 1)
     printf("compress time: %u ms\n", mp_hal_ticks_ms() - start);
@@ -507,7 +511,7 @@ void jpeg_decompress(image_t *dst, image_t *src) {
             HAL_DMA2D_ConfigLayer(&DMA2D_Handle, 1);
 
             // Invalidate the dst image for DMA2D.
-            SCB_InvalidateDCache_by_Addr((uint32_t *) dst->data, image_size(dst));
+            omv_cache_invalidate(dst->data, image_size(dst));
         }
     } else if (JPEG_state.jpeg_descr.Conf.ColorSpace == JPEG_CMYK_COLORSPACE) {
         if (((uint32_t) src->data) % __SCB_DCACHE_LINE_SIZE) {
@@ -527,9 +531,9 @@ void jpeg_decompress(image_t *dst, image_t *src) {
     uint8_t *mcu_row_buffer = fb_alloc(dst_w_mcus_bytes_2, FB_ALLOC_PREFER_SPEED | FB_ALLOC_CACHE_ALIGN);
 
     // Flush input.
-    SCB_CleanDCache_by_Addr((uint32_t *) JPEG_state.jpeg_descr.pJpegInBuffPtr, JPEG_state.in_data_len);
+    omv_cache_clean(JPEG_state.jpeg_descr.pJpegInBuffPtr, JPEG_state.in_data_len);
     // Invalidate the MCU row for DMA.
-    SCB_InvalidateDCache_by_Addr((uint32_t *) mcu_row_buffer, dst_w_mcus_bytes);
+    omv_cache_invalidate(mcu_row_buffer, dst_w_mcus_bytes);
     // Start the DMA process on the image.
     HAL_JPEG_Decode_DMA(&JPEG_state.jpeg_descr,
                         JPEG_state.jpeg_descr.pJpegInBuffPtr, IM_MIN(JPEG_state.in_data_len, JPEG_MAX_MDMA_BLOCK_SIZE),
@@ -544,7 +548,7 @@ void jpeg_decompress(image_t *dst, image_t *src) {
         if ((y_offset + mcu_h) < src->h) {
             // not last row
             // Invalidate the MCU row for DMA.
-            SCB_InvalidateDCache_by_Addr((uint32_t *) next_mcu_row_buffer_ptr, dst_w_mcus_bytes);
+            omv_cache_invalidate(next_mcu_row_buffer_ptr, dst_w_mcus_bytes);
         }
 
         // Wait for the MCUs to be processed.
@@ -709,7 +713,7 @@ void jpeg_decompress(image_t *dst, image_t *src) {
                 }
                 case PIXFORMAT_RGB565: {
                     uint16_t *rp = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(dst, y_offset);
-                    SCB_InvalidateDCache_by_Addr((uint32_t *) rp, dst->w * dy * sizeof(uint16_t));
+                    omv_cache_invalidate(rp, dst->w * dy * sizeof(uint16_t));
                     HAL_DMA2D_Start(&DMA2D_Handle, (uint32_t) this_mcu_row_buffer_ptr, (uint32_t) rp, dst->w, dy);
                     HAL_DMA2D_PollForTransfer(&DMA2D_Handle, JPEG_CODEC_TIMEOUT);
                     break;
@@ -56,6 +56,7 @@
 #include "sensor.h"
 #include "usbdbg.h"
 #include "wifidbg.h"
+#include "msc_storage.h"
 #include "sdram.h"
 #include "fb_alloc.h"
 #include "dma_alloc.h"
@@ -69,11 +70,13 @@
 #include "py_image.h"
 #include "py_fir.h"
 #include "py_tv.h"
+#include "py_tof.h"
 #include "py_buzzer.h"
 #include "py_imu.h"
 #include "py_audio.h"
 
 #include "framebuffer.h"
+#include "trace.h"
 
 #include "ini.h"
 #include "omv_boardconfig.h"
@@ -167,6 +170,7 @@ void NORETURN __stack_chk_fail(void) {
 typedef struct openmv_config {
     bool wifidbg;
     wifidbg_config_t wifidbg_config;
+    int msc_partition;
 } openmv_config_t;
 
 int ini_handler_callback(void *user, const char *section, const char *name, const char *value) {
@@ -187,6 +191,8 @@ int ini_handler_callback(void *user, const char *section, const char *name, cons
         }
     } else if (MATCH("BoardConfig", "WiFiDebug")) {
         openmv_config->wifidbg = ini_is_true(value);
+    } else if (MATCH("BoardConfig", "MSCPartition")) {
+        openmv_config->msc_partition = ini_atoi(value);
     } else if (MATCH("WiFiConfig", "Mode")) {
         openmv_config->wifidbg_config.mode = ini_atoi(value);
     } else if (MATCH("WiFiConfig", "ClientSSID")) {
@@ -207,6 +213,8 @@ int ini_handler_callback(void *user, const char *section, const char *name, cons
         openmv_config->wifidbg_config.access_point_channel = ini_atoi(value);
     } else if (MATCH("WiFiConfig", "BoardName")) {
         strncpy(openmv_config->wifidbg_config.board_name,  value, WINC_MAX_BOARD_NAME_LEN);
+    } else if (MATCH("WiFiConfig", "MJPEGPort")) {
+        openmv_config->wifidbg_config.mjpeg_port = ini_atoi(value);
     } else {
         return 0;
     }
@@ -290,6 +298,9 @@ soft_reset:
     #if MICROPY_PY_TV
     py_tv_init0();
     #endif
+    #if MICROPY_PY_TOF
+    py_tof_init0();
+    #endif
     #if MICROPY_PY_BUZZER
     py_buzzer_init0();
     #endif // MICROPY_PY_BUZZER
@@ -305,6 +316,7 @@ soft_reset:
     spi_init0();
     uart_init0();
     fb_alloc_init0();
+    trace_init();
     omv_gpio_init0();
     framebuffer_init0();
     sensor_init0();
@@ -457,6 +469,13 @@ else {
     if (!(pyb_usb_flags & PYB_USB_FLAG_USB_MODE_CALLED)) {
         pyb_usb_dev_init(pyb_usb_dev_detect(), MICROPY_HW_USB_VID,
                          MICROPY_HW_USB_PID_CDC_MSC, USBD_MODE_CDC_MSC, 0, NULL, NULL);
+
+        #if MICROPY_HW_ENABLE_SDCARD
+        // Serve the SD card with read-ahead, optionally exporting only one partition.
+        if (sdcard_mounted) {
+            msc_storage_init(openmv_config.msc_partition);
+        }
+        #endif
     }
 
     // report if SDRAM failed
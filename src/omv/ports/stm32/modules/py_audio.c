@@ -24,6 +24,8 @@
 #include "fb_alloc.h"
 #include "omv_boardconfig.h"
 #include "omv_common.h"
+#include "omv_cache.h"
+#include "omv_job.h"
 #include "dma_utils.h"
 
 #if MICROPY_PY_AUDIO
@@ -45,14 +47,23 @@ static DMA_HandleTypeDef hdma_filter[OMV_AUDIO_MAX_CHANNELS];
 // NOTE: placed in D2 memory.
 #define PDM_BUFFER_SIZE      (512 * 2)
 int32_t OMV_ATTR_SECTION(OMV_ATTR_ALIGNED(PDM_BUFFER[PDM_BUFFER_SIZE], 32), ".d2_dma_buffer");
-#define SaturaLH(N, L, H)    (((N) < (L))?(L):(((N) > (H))?(H):(N)))
 #else
 #error "No audio driver defined for this board"
 #endif
 
+// PCM blocks are converted by background jobs queued from the DMA IRQ, one per PDM buffer half,
+// into a ring of PCM_BUFFER_COUNT blocks, so the user callback can run late by up to
+// PCM_BUFFER_COUNT - 1 blocks without losing audio. The jobs only write pcm_head and the
+// scheduled task only writes pcm_tail.
+#define PCM_BUFFER_COUNT     (4)
+
 static volatile uint32_t xfer_status = 0;
+static volatile uint32_t pcm_head = 0;
+static volatile uint32_t pcm_tail = 0;
+static uint32_t pcm_block_size = 0;
 static int g_channels = OMV_AUDIO_MAX_CHANNELS;
 static mp_sched_node_t audio_task_sched_node;
+static omv_job_t audio_convert_jobs[2];
 
 #define DMA_XFER_NONE              (0x00U)
 #define DMA_XFER_HALF              (0x01U)
@@ -72,6 +83,32 @@ void OMV_DFSDM_FLT0_IRQHandler() {
 }
 #endif  // defined(OMV_SAI)
 
+// Converts half of the PDM buffer into the next free PCM block and schedules the user callback.
+// If the ring is full the new block is dropped. Runs as a job to keep the filter out of the IRQ.
+static void audio_convert_block(void *arg) {
+    uint32_t offset = (uint32_t) arg;
+
+    if ((pcm_head - pcm_tail) < PCM_BUFFER_COUNT) {
+        int16_t *pcmbuf = ((int16_t *) MP_STATE_PORT(audio_pcm_buffer)) +
+                          ((pcm_head % PCM_BUFFER_COUNT) * pcm_block_size);
+
+        #if defined(OMV_SAI)
+        // Convert PDM samples to PCM.
+        for (int i = 0; i < g_channels; i++) {
+            PDM_Filter(&((uint8_t *) PDM_BUFFER)[offset + i], &pcmbuf[i], &PDM_FilterHandler[i]);
+        }
+        #elif defined(OMV_DFSDM)
+        for (int i = 0; i < PDM_BUFFER_SIZE / 2; i++) {
+            pcmbuf[i] = __SSAT(PDM_BUFFER[offset + i] >> 8, 16);
+        }
+        #endif
+
+        pcm_head += 1;
+    }
+
+    mp_sched_schedule_node(&audio_task_sched_node, audio_task_callback);
+}
+
 #if defined(OMV_SAI)
 void HAL_SAI_RxHalfCpltCallback(SAI_HandleTypeDef *hsai)
 #elif defined(OMV_DFSDM)
@@ -79,9 +116,9 @@ void HAL_DFSDM_FilterRegConvHalfCpltCallback(DFSDM_Filter_HandleTypeDef *hdfsdm_
 #endif
 {
     xfer_status |= DMA_XFER_HALF;
-    SCB_InvalidateDCache_by_Addr((uint32_t *) (&PDM_BUFFER[0]), sizeof(PDM_BUFFER) / 2);
+    omv_cache_invalidate(&PDM_BUFFER[0], sizeof(PDM_BUFFER) / 2);
     if (MP_STATE_PORT(audio_callback) != mp_const_none) {
-        mp_sched_schedule_node(&audio_task_sched_node, audio_task_callback);
+        omv_job_submit(&audio_convert_jobs[0], audio_convert_block, (void *) 0);
     }
 }
 
@@ -92,9 +129,9 @@ void HAL_DFSDM_FilterRegConvCpltCallback(DFSDM_Filter_HandleTypeDef *hdfsdm_filt
 #endif
 {
     xfer_status |= DMA_XFER_FULL;
-    SCB_InvalidateDCache_by_Addr((uint32_t *) (&PDM_BUFFER[PDM_BUFFER_SIZE / 2]), sizeof(PDM_BUFFER) / 2);
+    omv_cache_invalidate(&PDM_BUFFER[PDM_BUFFER_SIZE / 2], sizeof(PDM_BUFFER) / 2);
     if (MP_STATE_PORT(audio_callback) != mp_const_none) {
-        mp_sched_schedule_node(&audio_task_sched_node, audio_task_callback);
+        omv_job_submit(&audio_convert_jobs[1], audio_convert_block, (void *) (PDM_BUFFER_SIZE / 2));
     }
 }
 
@@ -327,10 +364,16 @@ static mp_obj_t py_audio_init(uint n_args, const mp_obj_t *pos_args, mp_map_t *k
     uint32_t samples_per_channel = PDM_BUFFER_SIZE / 2; // Half a transfer
     #endif  // defined(OMV_SAI)
 
-    // Allocate global PCM buffer.
-    MP_STATE_PORT(audio_pcm_buffer) = m_new(int16_t, samples_per_channel * g_channels);
-    MP_STATE_PORT(audio_pcm_array) = mp_obj_new_bytearray_by_ref(samples_per_channel * g_channels * sizeof(int16_t),
-                                                                 MP_STATE_PORT(audio_pcm_buffer));
+    // Allocate the global PCM ring and a bytearray per block, passed to the user callback.
+    pcm_block_size = samples_per_channel * g_channels;
+    MP_STATE_PORT(audio_pcm_buffer) = m_new(int16_t, pcm_block_size * PCM_BUFFER_COUNT);
+
+    mp_obj_tuple_t *pcm_arrays = MP_OBJ_TO_PTR(mp_obj_new_tuple(PCM_BUFFER_COUNT, NULL));
+    for (int i = 0; i < PCM_BUFFER_COUNT; i++) {
+        pcm_arrays->items[i] = mp_obj_new_bytearray_by_ref(pcm_block_size * sizeof(int16_t),
+                                                           MP_STATE_PORT(audio_pcm_buffer) + (i * pcm_block_size));
+    }
+    MP_STATE_PORT(audio_pcm_array) = MP_OBJ_FROM_PTR(pcm_arrays);
 
     return mp_const_none;
 }
@@ -375,6 +418,9 @@ void py_audio_deinit() {
     }
     #endif
 
+    omv_job_wait(&audio_convert_jobs[0]);
+    omv_job_wait(&audio_convert_jobs[1]);
+
     g_channels = 0;
     MP_STATE_PORT(audio_pcm_buffer) = NULL;
     MP_STATE_PORT(audio_pcm_array) = mp_const_none;
@@ -382,42 +428,13 @@ void py_audio_deinit() {
 }
 
 static void audio_task_callback(mp_sched_node_t *node) {
-    int16_t *pcmbuf = (int16_t *) MP_STATE_PORT(audio_pcm_buffer);
-
-    // Check for half transfer complete.
-    if ((xfer_status & DMA_XFER_HALF)) {
-        // Clear buffer state.
-        xfer_status &= ~(DMA_XFER_HALF);
-
-        #if defined(OMV_SAI)
-        // Convert PDM samples to PCM.
-        for (int i = 0; i < g_channels; i++) {
-            PDM_Filter(&((uint8_t *) PDM_BUFFER)[i], &pcmbuf[i], &PDM_FilterHandler[i]);
-        }
-        #elif defined(OMV_DFSDM)
-        for (int i = 0; i < PDM_BUFFER_SIZE / 2; i++) {
-            pcmbuf[i] = SaturaLH((PDM_BUFFER[i] >> 8), -32768, 32767);
-        }
-        #endif
-    } else if ((xfer_status & DMA_XFER_FULL)) {
-        // Check for transfer complete.
-        // Clear buffer state.
-        xfer_status &= ~(DMA_XFER_FULL);
+    mp_obj_tuple_t *pcm_arrays = MP_OBJ_TO_PTR(MP_STATE_PORT(audio_pcm_array));
 
-        #if defined(OMV_SAI)
-        // Convert PDM samples to PCM.
-        for (int i = 0; i < g_channels; i++) {
-            PDM_Filter(&((uint8_t *) PDM_BUFFER)[PDM_BUFFER_SIZE / 2 + i], &pcmbuf[i], &PDM_FilterHandler[i]);
-        }
-        #elif defined(OMV_DFSDM)
-        for (int i = 0; i < PDM_BUFFER_SIZE / 2; i++) {
-            pcmbuf[i] = SaturaLH((PDM_BUFFER[PDM_BUFFER_SIZE / 2 + i] >> 8), -32768, 32767);
-        }
-        #endif
+    // Call the user callback for every block converted since the last call.
+    while ((pcm_tail != pcm_head) && (MP_STATE_PORT(audio_callback) != mp_const_none)) {
+        mp_call_function_1(MP_STATE_PORT(audio_callback), pcm_arrays->items[pcm_tail % PCM_BUFFER_COUNT]);
+        pcm_tail += 1;
     }
-
-    // Call user callback
-    mp_call_function_1(MP_STATE_PORT(audio_callback), MP_STATE_PORT(audio_pcm_array));
 }
 
 static mp_obj_t py_audio_start_streaming(mp_obj_t callback_obj) {
@@ -425,10 +442,12 @@ static mp_obj_t py_audio_start_streaming(mp_obj_t callback_obj) {
         RAISE_OS_EXCEPTION("Invalid callback object!");
     }
 
-    MP_STATE_PORT(audio_callback) = callback_obj;
-
     // Clear DMA buffer status
     xfer_status &= DMA_XFER_NONE;
+    pcm_head = 0;
+    pcm_tail = 0;
+
+    MP_STATE_PORT(audio_callback) = callback_obj;
 
     #if defined(OMV_SAI)
     // Start DMA transfer
@@ -458,6 +477,9 @@ static mp_obj_t py_audio_stop_streaming() {
         HAL_DFSDM_FilterRegularStop_DMA(&hdfsdm_filter[0]);
     }
     #endif
+    // Let in-flight conversions finish before the callback goes away.
+    omv_job_wait(&audio_convert_jobs[0]);
+    omv_job_wait(&audio_convert_jobs[1]);
     MP_STATE_PORT(audio_callback) = mp_const_none;
     return mp_const_none;
 }
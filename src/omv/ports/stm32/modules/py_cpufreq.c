@@ -13,10 +13,14 @@
 #include <math.h>
 #include "py/obj.h"
 #include "py/runtime.h"
+#include "py/mphal.h"
 
 #include "py_cpufreq.h"
 #include "py_helper.h"
 #include "omv_boardconfig.h"
+#include "omv_common.h"
+#include "sensor.h"
+#include "omv_energy.h"
 #include STM32_HAL_H
 
 #if defined(STM32F7) || defined(STM32H7)
@@ -100,35 +104,44 @@ mp_obj_t py_cpufreq_get_supported_frequencies() {
     return freq_list;
 }
 
-mp_obj_t py_cpufreq_set_frequency(mp_obj_t cpufreq_obj) {
-    RCC_ClkInitTypeDef RCC_ClkInitStruct;
-    #if defined(STM32F7)
-    RCC_OscInitTypeDef RCC_OscInitStruct;
-    #endif
-
-    // Check if frequency is supported
-    int cpufreq_idx = -1;
-    uint32_t cpufreq = mp_obj_get_int(cpufreq_obj);
+static int cpufreq_get_index(uint32_t cpufreq) {
     #if defined(STM32H7)
     const uint32_t *cpufreq_freqs = cpufreq_get_frequencies();
     #endif
     for (int i = 0; i < N_FREQUENCIES; i++) {
         if (cpufreq == cpufreq_freqs[i]) {
-            cpufreq_idx = i;
-            break;
+            return i;
         }
     }
+    return -1;
+}
+
+// Returns 0 on success, CPUFREQ_ERROR_FREQ if the frequency isn't supported or
+// CPUFREQ_ERROR_OSC/CPUFREQ_ERROR_CLK if the clocks can't be configured.
+static int cpufreq_set_frequency(uint32_t cpufreq) {
+    RCC_ClkInitTypeDef RCC_ClkInitStruct;
+    #if defined(STM32F7)
+    RCC_OscInitTypeDef RCC_OscInitStruct;
+    #endif
+
+    // Check if frequency is supported
+    int cpufreq_idx = cpufreq_get_index(cpufreq);
 
     // Frequency is Not supported.
     if (cpufreq_idx == -1) {
-        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Unsupported frequency!"));
+        return CPUFREQ_ERROR_FREQ;
     }
 
     // Return if frequency hasn't changed.
     if (cpufreq == (cpufreq_get_cpuclk() / (1000000))) {
-        return mp_const_true;
+        return 0;
     }
 
+    // The sensor clock is derived from the APB timer clock, which may change below.
+    #if MICROPY_PY_SENSOR
+    uint32_t xclk = sensor_is_detected() ? sensor_get_xclk_frequency() : 0;
+    #endif
+
     #if defined(STM32H7)
     uint32_t flatency = FLASH_LATENCY_2;
     RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
@@ -177,8 +190,7 @@ mp_obj_t py_cpufreq_set_frequency(mp_obj_t cpufreq_obj) {
             break;
 
         default:
-            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Unsupported frequency!"));
-            break;
+            return CPUFREQ_ERROR_FREQ;
     }
 
     #elif defined(STM32F7)
@@ -192,7 +204,7 @@ mp_obj_t py_cpufreq_set_frequency(mp_obj_t cpufreq_obj) {
     RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV2;
     if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_7) != HAL_OK) {
         // Initialization Error
-        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("RCC CLK Initialization Error!!"));
+        return CPUFREQ_ERROR_CLK;
     }
 
     // Enable HSE Oscillator and activate PLL with HSE as source
@@ -207,7 +219,7 @@ mp_obj_t py_cpufreq_set_frequency(mp_obj_t cpufreq_obj) {
 
     if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
         // Initialization Error
-        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("RCC OSC Initialization Error!!"));
+        return CPUFREQ_ERROR_OSC;
     }
 
     // Select PLL as system clock source
@@ -218,14 +230,133 @@ mp_obj_t py_cpufreq_set_frequency(mp_obj_t cpufreq_obj) {
 
     if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, flatency) != HAL_OK) {
         // Initialization Error
-        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("RCC CLK Initialization Error!!"));
+        return CPUFREQ_ERROR_CLK;
+    }
+
+    // Keep the sensor clock (and so the frame rate) the same.
+    #if MICROPY_PY_SENSOR
+    if (xclk) {
+        sensor_set_xclk_frequency(xclk);
+    }
+    #endif
+    omv_energy_set_cpu(cpufreq);
+    return 0;
+}
+
+mp_obj_t py_cpufreq_set_frequency(mp_obj_t cpufreq_obj) {
+    switch (cpufreq_set_frequency(mp_obj_get_int(cpufreq_obj))) {
+        case CPUFREQ_ERROR_FREQ:
+            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Unsupported frequency!"));
+        case CPUFREQ_ERROR_OSC:
+            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("RCC OSC Initialization Error!!"));
+        case CPUFREQ_ERROR_CLK:
+            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("RCC CLK Initialization Error!!"));
+        default:
+            return mp_const_true;
     }
-    return mp_const_true;
+}
+
+// The governor measures how long sensor.snapshot() waits for frames over a window of frames.
+// If the frame time would still leave enough idle time at the next lower frequency (the
+// pipeline is sensor-bound) it steps down, if there's almost no idle time (compute-bound) it
+// steps up. Bus clocks are the same from the maximum down to the default minimum, so only
+// the core clock changes. Below that APB peripherals other than the sensor clock (UART, SPI
+// and timers) are not reconfigured.
+#define CPUFREQ_GOVERNOR_WINDOW    (8)
+
+static struct {
+    bool enabled;
+    int min_idx;
+    int max_idx;
+    uint32_t frames;
+    uint32_t last_us;
+    uint32_t wait_us;
+    uint32_t period_us;
+} cpufreq_governor;
+
+void cpufreq_governor_update(uint32_t wait_us) {
+    if (!cpufreq_governor.enabled) {
+        return;
+    }
+
+    uint32_t now = mp_hal_ticks_us();
+    cpufreq_governor.period_us += now - cpufreq_governor.last_us;
+    cpufreq_governor.wait_us += wait_us;
+    cpufreq_governor.last_us = now;
+
+    if (++cpufreq_governor.frames < CPUFREQ_GOVERNOR_WINDOW) {
+        return;
+    }
+
+    #if defined(STM32H7)
+    const uint32_t *cpufreq_freqs = cpufreq_get_frequencies();
+    #endif
+    int idx = cpufreq_get_index(cpufreq_get_cpuclk() / 1000000);
+    uint64_t period = cpufreq_governor.period_us;
+    uint64_t wait = OMV_MIN(cpufreq_governor.wait_us, cpufreq_governor.period_us);
+    uint64_t busy = period - wait;
+    int new_idx = (idx < 0) ? cpufreq_governor.max_idx : idx;
+
+    if (idx > cpufreq_governor.min_idx
+        && ((busy * cpufreq_freqs[idx] / cpufreq_freqs[idx - 1]) < (period * 3 / 4))) {
+        // Keep 25% idle time at the lower frequency to avoid switching back right away.
+        new_idx = idx - 1;
+    } else if (idx < cpufreq_governor.max_idx && wait < (period / 16)) {
+        new_idx = idx + 1;
+    }
+
+    cpufreq_governor.frames = 0;
+    cpufreq_governor.wait_us = 0;
+    cpufreq_governor.period_us = 0;
+
+    if (new_idx != idx) {
+        cpufreq_set_frequency(cpufreq_freqs[new_idx]);
+        cpufreq_governor.last_us = mp_hal_ticks_us();
+    }
+}
+
+mp_obj_t py_cpufreq_set_governor(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_enable, ARG_min_freq, ARG_max_freq };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_enable, MP_ARG_REQUIRED | MP_ARG_BOOL },
+        { MP_QSTR_min_freq, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = -1 } },
+        { MP_QSTR_max_freq, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = -1 } },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    #if defined(STM32H7)
+    // Below this the AHB and APB clocks are divided down too.
+    int min_idx = (args[ARG_min_freq].u_int == -1) ? 2 : cpufreq_get_index(args[ARG_min_freq].u_int);
+    #else
+    // Every step changes the APB clocks, min_freq must be passed to scale.
+    int min_idx = (args[ARG_min_freq].u_int == -1) ? (N_FREQUENCIES - 1) : cpufreq_get_index(args[ARG_min_freq].u_int);
+    #endif
+    int max_idx = (args[ARG_max_freq].u_int == -1) ? (N_FREQUENCIES - 1) : cpufreq_get_index(args[ARG_max_freq].u_int);
+
+    if (min_idx < 0 || max_idx < 0 || min_idx > max_idx) {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Unsupported frequency!"));
+    }
+
+    cpufreq_governor.enabled = false;
+    cpufreq_governor.min_idx = min_idx;
+    cpufreq_governor.max_idx = max_idx;
+    cpufreq_governor.frames = 0;
+    cpufreq_governor.wait_us = 0;
+    cpufreq_governor.period_us = 0;
+    cpufreq_governor.last_us = mp_hal_ticks_us();
+    cpufreq_governor.enabled = args[ARG_enable].u_bool;
+    return mp_const_none;
 }
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_cpufreq_set_frequency_obj, py_cpufreq_set_frequency);
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_cpufreq_get_current_frequencies_obj, py_cpufreq_get_current_frequencies);
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_cpufreq_get_supported_frequencies_obj, py_cpufreq_get_supported_frequencies);
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_cpufreq_set_governor_obj, 1, py_cpufreq_set_governor);
+#else
+void cpufreq_governor_update(uint32_t wait_us) {
+}
 #endif // defined(STM32F7) || defined(STM32H7)
 
 static const mp_map_elem_t globals_dict_table[] = {
@@ -234,10 +365,12 @@ static const mp_map_elem_t globals_dict_table[] = {
     { MP_OBJ_NEW_QSTR(MP_QSTR_set_frequency),             (mp_obj_t) &py_cpufreq_set_frequency_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_get_current_frequencies),   (mp_obj_t) &py_cpufreq_get_current_frequencies_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_get_supported_frequencies), (mp_obj_t) &py_cpufreq_get_supported_frequencies_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_set_governor),              (mp_obj_t) &py_cpufreq_set_governor_obj },
     #else
     { MP_OBJ_NEW_QSTR(MP_QSTR_set_frequency),             (mp_obj_t) &py_func_unavailable_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_get_current_frequencies),   (mp_obj_t) &py_func_unavailable_obj },
     { MP_OBJ_NEW_QSTR(MP_QSTR_get_supported_frequencies), (mp_obj_t) &py_func_unavailable_obj },
+    { MP_OBJ_NEW_QSTR(MP_QSTR_set_governor),              (mp_obj_t) &py_func_unavailable_obj },
     #endif
     { NULL, NULL },
 };
@@ -10,5 +10,11 @@
  */
 #ifndef __PY_CPUFREQ_H__
 #define __PY_CPUFREQ_H__
+#include <stdint.h>
+#define CPUFREQ_ERROR_FREQ    (-1)
+#define CPUFREQ_ERROR_OSC     (-2)
+#define CPUFREQ_ERROR_CLK     (-3)
 void py_cpufreq_init0();
+// Called by sensor_snapshot() with the time it waited for the frame.
+void cpufreq_governor_update(uint32_t wait_us);
 #endif // __PY_CPUFREQ_H__
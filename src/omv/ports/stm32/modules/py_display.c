@@ -17,10 +17,12 @@
 #include "py/obj.h"
 #include "py/runtime.h"
 #include "mphal.h"
+#include "dma.h"
 
 #include "py_helper.h"
 #include "py_image.h"
 #include "omv_gpio.h"
+#include "omv_cache.h"
 #include "py_display.h"
 
 #if defined(OMV_DSI_DISPLAY_BL_PIN)
@@ -422,6 +424,32 @@ static void display_write(py_display_obj_t *self, image_t *src_img, int dst_x_st
     }
     dst_img.data = (uint8_t *) self->framebuffers[tail];
 
+    // An unscaled RGB565 image that is fully on screen is scanned out by the layer in place. The
+    // layer alpha still blends it with the black background. The layer is swapped on the next
+    // vertical blanking period so the image is shown without being copied.
+    if (self->direct && (!black)
+        && (src_img->pixfmt == PIXFORMAT_RGB565)
+        && (x_scale == 1.f) && (y_scale == 1.f) && (rgb_channel < 0)
+        && (!color_palette) && (!alpha_palette)
+        && (!(hint & (IMAGE_HINT_HMIRROR | IMAGE_HINT_VFLIP | IMAGE_HINT_TRANSPOSE)))
+        && (roi->x == 0) && (roi->y == 0) && (roi->w == src_img->w) && (roi->h == src_img->h)
+        && ((p1.x - p0.x) == src_img->w) && ((p1.y - p0.y) == src_img->h)
+        && DMA_BUFFER(src_img->data)) {
+        display.framebuffer_layers[tail].WindowX0 = p0.x;
+        display.framebuffer_layers[tail].WindowX1 = p1.x;
+        display.framebuffer_layers[tail].WindowY0 = p0.y;
+        display.framebuffer_layers[tail].WindowY1 = p1.y;
+        display.framebuffer_layers[tail].Alpha = fast_roundf((alpha * 255) / 256.f);
+        display.framebuffer_layers[tail].FBStartAdress = (uint32_t) src_img->data;
+        display.framebuffer_layers[tail].ImageWidth = src_img->w;
+        display.framebuffer_layers[tail].ImageHeight = src_img->h;
+
+        omv_cache_clean(src_img->data, image_size(src_img));
+
+        self->framebuffer_tail = tail;
+        return;
+    }
+
     // Set default values for the layer to display the whole framebuffer.
     display.framebuffer_layers[tail].WindowX0 = black ? 0 : p0.x;
     display.framebuffer_layers[tail].WindowX1 = black ? self->width : p1.x;
@@ -440,12 +468,10 @@ static void display_write(py_display_obj_t *self, image_t *src_img, int dst_x_st
                          alpha_palette, hint | IMAGE_HINT_BLACK_BACKGROUND, NULL, NULL, NULL);
     }
 
-    #ifdef __DCACHE_PRESENT
     // Flush data for DMA
     if (!black) {
-        SCB_CleanDCache_by_Addr((uint32_t *) dst_img.data, image_size(&dst_img));
+        omv_cache_clean(dst_img.data, image_size(&dst_img));
     }
-    #endif
 
     // Update tail which means a new image is ready.
     self->framebuffer_tail = tail;
@@ -553,7 +579,7 @@ static void display_deinit(py_display_obj_t *self) {
 mp_obj_t display_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
     enum {
         ARG_framesize, ARG_refresh, ARG_display_on, ARG_triple_buffer,
-        ARG_portrait, ARG_channel, ARG_controller, ARG_backlight
+        ARG_portrait, ARG_channel, ARG_controller, ARG_backlight, ARG_direct
     };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_framesize,     MP_ARG_INT,  {.u_int = DISPLAY_RESOLUTION_FWVGA  } },
@@ -564,6 +590,7 @@ mp_obj_t display_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw,
         { MP_QSTR_channel,       MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 0  } },
         { MP_QSTR_controller,    MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
         { MP_QSTR_backlight,     MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_direct,        MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false} },
     };
 
     // Parse args.
@@ -588,6 +615,7 @@ mp_obj_t display_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw,
     self->display_on = args[ARG_display_on].u_bool;
     self->bgr = false;
     self->triple_buffer = args[ARG_triple_buffer].u_bool;
+    self->direct = args[ARG_direct].u_bool;
     self->framebuffer_tail = 0;
     self->framebuffer_head = 0;
     self->framesize = args[ARG_framesize].u_int;
@@ -11,6 +11,7 @@
 #include "omv_boardconfig.h"
 
 #if MICROPY_PY_IMU
+#include <string.h>
 #include STM32_HAL_H
 
 #include "py/obj.h"
@@ -21,6 +22,7 @@
 #include "py_imu.h"
 #include "omv_gpio.h"
 #include "omv_spi.h"
+#include "omv_job.h"
 
 #if defined(IMU_CHIP_LSM6DS3)
 #include "lsm6ds3tr_c_reg.h"
@@ -69,6 +71,8 @@ typedef union {
 #endif  // IMU chip
 
 static bool imu_initialized = false;
+// Non-zero while the main thread is using the IMU, the FIFO job doesn't touch the bus then.
+static volatile uint32_t imu_busy = 0;
 
 #if defined(IMU_SPI_ID)
 
@@ -105,6 +109,7 @@ static int32_t platform_write(void *imubus, uint8_t Reg, uint8_t *Bufp, uint16_t
         .userdata = NULL,
     };
 
+    imu_busy++;
     omv_gpio_write(spi_bus->cs, 0);
 
     spi_xfer.size = 1;
@@ -118,6 +123,7 @@ static int32_t platform_write(void *imubus, uint8_t Reg, uint8_t *Bufp, uint16_t
     omv_spi_transfer_start(spi_bus, &spi_xfer);
 
     omv_gpio_write(spi_bus->cs, 1);
+    imu_busy--;
     return 0;
 }
 
@@ -132,6 +138,7 @@ static int32_t platform_read(void *imubus, uint8_t Reg, uint8_t *Bufp, uint16_t
         .userdata = NULL,
     };
 
+    imu_busy++;
     omv_gpio_write(spi_bus->cs, 0);
     spi_xfer.size = 1;
     spi_xfer.txbuf = &Reg;
@@ -144,6 +151,7 @@ static int32_t platform_read(void *imubus, uint8_t Reg, uint8_t *Bufp, uint16_t
     omv_spi_transfer_start(spi_bus, &spi_xfer);
 
     omv_gpio_write(spi_bus->cs, 1);
+    imu_busy--;
     return 0;
 }
 #elif defined(IMU_I2C)
@@ -170,12 +178,16 @@ static void platform_deinit(void *imubus) {
 }
 
 static int32_t platform_write(void *imubus, uint8_t reg, uint8_t *bufp, uint16_t len) {
+    imu_busy++;
     HAL_I2C_Mem_Write(imubus, LSM6DS3TR_C_I2C_ADD_L, reg, I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+    imu_busy--;
     return 0;
 }
 
 static int32_t platform_read(void *imubus, uint8_t reg, uint8_t *bufp, uint16_t len) {
+    imu_busy++;
     HAL_I2C_Mem_Read(imubus, LSM6DS3TR_C_I2C_ADD_L, reg, I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+    imu_busy--;
     return 0;
 }
 #else
@@ -353,6 +365,238 @@ static mp_obj_t py_imu_read_reg(mp_obj_t addr) {
 }
 static MP_DEFINE_CONST_FUN_OBJ_1(py_imu_read_reg_obj, py_imu_read_reg);
 
+#if defined(IMU_CHIP_LSM6DSOX)
+#ifndef IMU_FIFO_SAMPLES
+#define IMU_FIFO_SAMPLES            (512)
+#endif
+#define IMU_FIFO_WATERMARK          (96)    // FIFO words, 32 accel, gyro and timestamp triplets.
+#define IMU_FIFO_WORD_SIZE          (7)     // Tag and 6 data bytes.
+#define IMU_TIMESTAMP_LSB_US        (25)
+
+typedef struct imu_sample {
+    uint32_t ticks_us;
+    int16_t xl[3];
+    int16_t gy[3];
+} imu_sample_t;
+
+static bool imu_fifo_enabled = false;
+static imu_sample_t imu_fifo[IMU_FIFO_SAMPLES];
+static uint32_t imu_fifo_head = 0;
+static uint32_t imu_fifo_tail = 0;
+// Sample being assembled from FIFO words, the IMU batches accel, gyro and timestamp separately.
+static imu_sample_t imu_fifo_sample;
+static uint32_t imu_fifo_sample_mask = 0;
+
+#if defined(OMV_IMU_INT_PIN)
+static omv_job_t imu_fifo_job;
+#endif
+
+static const uint16_t imu_fifo_rates[] = { 13, 26, 52, 104, 208, 417, 833, 1667 };
+
+static void imu_fifo_push(imu_sample_t *sample) {
+    // The oldest samples are overwritten when the ring is full.
+    if ((imu_fifo_head - imu_fifo_tail) == IMU_FIFO_SAMPLES) {
+        imu_fifo_tail += 1;
+    }
+    imu_fifo[imu_fifo_head % IMU_FIFO_SAMPLES] = *sample;
+    imu_fifo_head += 1;
+}
+
+// Moves the FIFO contents to the ring. IMU timestamps are converted to mp_hal_ticks_us() time
+// by reading the IMU timer and ticks together, so samples line up with frame timestamps.
+static void imu_fifo_drain() {
+    uint16_t level = 0;
+    uint32_t timestamp = 0;
+
+    LSM_FUNC(fifo_data_level_get) (&dev_ctx, &level);
+    LSM_FUNC(timestamp_raw_get) (&dev_ctx, &timestamp);
+    uint32_t ticks_us = mp_hal_ticks_us();
+
+    for (int i = 0; i < level; i++) {
+        uint8_t word[IMU_FIFO_WORD_SIZE];
+        platform_read(dev_ctx.handle, LSM_CONST(FIFO_DATA_OUT_TAG), word, sizeof(word));
+
+        int16_t data[3] = {
+            (int16_t) (word[1] | (word[2] << 8)),
+            (int16_t) (word[3] | (word[4] << 8)),
+            (int16_t) (word[5] | (word[6] << 8)),
+        };
+
+        switch (word[0] >> 3) {
+            case LSM_CONST(TIMESTAMP_TAG): {
+                uint32_t sample_timestamp = word[1] | (word[2] << 8) | (word[3] << 16) | ((uint32_t) word[4] << 24);
+                imu_fifo_sample.ticks_us = ticks_us - ((timestamp - sample_timestamp) * IMU_TIMESTAMP_LSB_US);
+                imu_fifo_sample_mask |= 1;
+                break;
+            }
+            case LSM_CONST(XL_NC_TAG): {
+                memcpy(imu_fifo_sample.xl, data, sizeof(data));
+                imu_fifo_sample_mask |= 2;
+                break;
+            }
+            case LSM_CONST(GYRO_NC_TAG): {
+                memcpy(imu_fifo_sample.gy, data, sizeof(data));
+                imu_fifo_sample_mask |= 4;
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+
+        // A sample is complete once both sensors are batched, it keeps the last timestamp.
+        if (imu_fifo_sample_mask == 7) {
+            imu_fifo_push(&imu_fifo_sample);
+            imu_fifo_sample_mask = 1;
+        }
+    }
+}
+
+#if defined(OMV_IMU_INT_PIN)
+static void imu_fifo_job_func(void *arg) {
+    // Skipped if the main thread was interrupted using the IMU, it drains the FIFO itself.
+    if (imu_fifo_enabled && !imu_busy) {
+        imu_fifo_drain();
+    }
+}
+
+static void imu_fifo_callback(void *data) {
+    omv_job_submit(&imu_fifo_job, imu_fifo_job_func, NULL);
+}
+#endif
+
+static mp_obj_t py_imu_fifo_enable(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_enable, ARG_rate };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_enable, MP_ARG_REQUIRED | MP_ARG_BOOL },
+        { MP_QSTR_rate, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 833 } },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    error_on_not_ready();
+
+    // Both sensors run and are batched at the lowest supported rate >= rate.
+    int odr = MP_ARRAY_SIZE(imu_fifo_rates);
+    for (int i = 0; i < MP_ARRAY_SIZE(imu_fifo_rates); i++) {
+        if (imu_fifo_rates[i] >= args[ARG_rate].u_int) {
+            odr = i + 1;
+            break;
+        }
+    }
+
+    imu_busy++;
+    imu_fifo_enabled = false;
+
+    #if defined(OMV_IMU_INT_PIN)
+    omv_gpio_irq_enable(OMV_IMU_INT_PIN, false);
+    #endif
+
+    LSM_FUNC(fifo_mode_set) (&dev_ctx, LSM_CONST(BYPASS_MODE));
+    imu_fifo_head = 0;
+    imu_fifo_tail = 0;
+    imu_fifo_sample_mask = 0;
+
+    if (args[ARG_enable].u_bool) {
+        LSM_FUNC(xl_data_rate_set) (&dev_ctx, (lsm6dsox_odr_xl_t) odr);
+        LSM_FUNC(gy_data_rate_set) (&dev_ctx, (lsm6dsox_odr_g_t) odr);
+        LSM_FUNC(fifo_watermark_set) (&dev_ctx, IMU_FIFO_WATERMARK);
+        LSM_FUNC(fifo_xl_batch_set) (&dev_ctx, (lsm6dsox_bdr_xl_t) odr);
+        LSM_FUNC(fifo_gy_batch_set) (&dev_ctx, (lsm6dsox_bdr_gy_t) odr);
+        LSM_FUNC(timestamp_set) (&dev_ctx, PROPERTY_ENABLE);
+        LSM_FUNC(fifo_timestamp_decimation_set) (&dev_ctx, LSM_CONST(DEC_1));
+        LSM_FUNC(fifo_mode_set) (&dev_ctx, LSM_CONST(STREAM_MODE));
+
+        #if defined(OMV_IMU_INT_PIN)
+        lsm6dsox_pin_int1_route_t int1_route = { .fifo_th = 1 };
+        LSM_FUNC(pin_int1_route_set) (&dev_ctx, int1_route);
+        omv_gpio_config(OMV_IMU_INT_PIN, OMV_GPIO_MODE_IT_RISE, OMV_GPIO_PULL_NONE, OMV_GPIO_SPEED_LOW, -1);
+        omv_gpio_irq_register(OMV_IMU_INT_PIN, imu_fifo_callback, NULL);
+        omv_gpio_irq_enable(OMV_IMU_INT_PIN, true);
+        #endif
+
+        imu_fifo_enabled = true;
+    } else {
+        #if defined(OMV_IMU_INT_PIN)
+        lsm6dsox_pin_int1_route_t int1_route = { 0 };
+        LSM_FUNC(pin_int1_route_set) (&dev_ctx, int1_route);
+        #endif
+        LSM_FUNC(fifo_xl_batch_set) (&dev_ctx, LSM_CONST(XL_NOT_BATCHED));
+        LSM_FUNC(fifo_gy_batch_set) (&dev_ctx, LSM_CONST(GY_NOT_BATCHED));
+        LSM_FUNC(fifo_timestamp_decimation_set) (&dev_ctx, LSM_CONST(NO_DECIMATION));
+        LSM_FUNC(xl_data_rate_set) (&dev_ctx, LSM_CONST(XL_ODR_52Hz));
+        LSM_FUNC(gy_data_rate_set) (&dev_ctx, LSM_CONST(GY_ODR_52Hz));
+    }
+
+    imu_busy--;
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(py_imu_fifo_enable_obj, 1, py_imu_fifo_enable);
+
+static mp_obj_t py_imu_fifo_read(uint n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_start_us, ARG_end_us };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_start_us, MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_end_us, MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    error_on_not_ready();
+
+    if (!imu_fifo_enabled) {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("IMU FIFO is not enabled"));
+    }
+
+    bool has_start = args[ARG_start_us].u_obj != mp_const_none;
+    bool has_end = args[ARG_end_us].u_obj != mp_const_none;
+    uint32_t start_us = has_start ? mp_obj_get_int_truncated(args[ARG_start_us].u_obj) : 0;
+    uint32_t end_us = has_end ? mp_obj_get_int_truncated(args[ARG_end_us].u_obj) : 0;
+    mp_obj_t list = mp_obj_new_list(0, NULL);
+
+    imu_busy++;
+    imu_fifo_drain();
+
+    // The ring is read with imu_busy held so the FIFO job can't push samples meanwhile.
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) != 0) {
+        imu_busy--;
+        nlr_jump(nlr.ret_val);
+    }
+
+    // Samples before start_us are dropped, samples at or after end_us are kept for the next call.
+    for (; imu_fifo_tail != imu_fifo_head; imu_fifo_tail++) {
+        imu_sample_t *sample = &imu_fifo[imu_fifo_tail % IMU_FIFO_SAMPLES];
+
+        if (has_end && ((int32_t) (sample->ticks_us - end_us)) >= 0) {
+            break;
+        }
+
+        if (has_start && ((int32_t) (sample->ticks_us - start_us)) < 0) {
+            continue;
+        }
+
+        mp_obj_t tuple[3] = {
+            mp_obj_new_int_from_uint(sample->ticks_us),
+            py_imu_tuple(lsm_from_fs8_to_mg(sample->xl[0]),
+                         lsm_from_fs8_to_mg(sample->xl[1]),
+                         lsm_from_fs8_to_mg(sample->xl[2])),
+            py_imu_tuple(lsm_from_fs2000_to_mdps(sample->gy[0]),
+                         lsm_from_fs2000_to_mdps(sample->gy[1]),
+                         lsm_from_fs2000_to_mdps(sample->gy[2])),
+        };
+        mp_obj_list_append(list, mp_obj_new_tuple(3, tuple));
+    }
+
+    nlr_pop();
+    imu_busy--;
+    return list;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(py_imu_fifo_read_obj, 0, py_imu_fifo_read);
+#endif // IMU_CHIP_LSM6DSOX
+
 static const mp_rom_map_elem_t globals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__),            MP_OBJ_NEW_QSTR(MP_QSTR_imu) },
     { MP_ROM_QSTR(MP_QSTR_acceleration_mg),     MP_ROM_PTR(&py_imu_acceleration_mg_obj) },
@@ -361,6 +605,10 @@ static const mp_rom_map_elem_t globals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_roll),                MP_ROM_PTR(&py_imu_roll_obj) },
     { MP_ROM_QSTR(MP_QSTR_pitch),               MP_ROM_PTR(&py_imu_pitch_obj) },
     { MP_ROM_QSTR(MP_QSTR_sleep),               MP_ROM_PTR(&py_imu_sleep_obj) },
+    #if defined(IMU_CHIP_LSM6DSOX)
+    { MP_ROM_QSTR(MP_QSTR_fifo_enable),         MP_ROM_PTR(&py_imu_fifo_enable_obj) },
+    { MP_ROM_QSTR(MP_QSTR_fifo_read),           MP_ROM_PTR(&py_imu_fifo_read_obj) },
+    #endif
     { MP_ROM_QSTR(MP_QSTR___write_reg),         MP_ROM_PTR(&py_imu_write_reg_obj) },
     { MP_ROM_QSTR(MP_QSTR___read_reg),          MP_ROM_PTR(&py_imu_read_reg_obj) },
 };
@@ -376,6 +624,10 @@ void py_imu_init() {
     uint8_t rst = 1;
     uint8_t whoamI = 0;
 
+    #if defined(IMU_CHIP_LSM6DSOX)
+    imu_fifo_enabled = false;
+    #endif
+
     platform_init(&imubus);
 
     // Try to read device id...
@@ -38,9 +38,12 @@
 #define kAverageWindowSamples      (1020 / kFeatureSliceDurationMs)
 #define RAISE_OS_EXCEPTION(msg)    mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT(msg))
 
+// The spectrogram is a ring of feature slices, slice_index is the next slice to write and once
+// the ring is full, also the oldest slice.
 typedef struct _py_micro_speech_obj {
     mp_obj_base_t base;
     uint32_t n_slices;
+    uint32_t slice_index;
     bool new_slices;
     int8_t spectrogram[kFeatureElementCount];
 } py_micro_speech_obj_t;
@@ -59,6 +62,7 @@ mp_obj_t py_micro_speech_make_new(const mp_obj_type_t *type, size_t n_args, size
     py_micro_speech_obj_t *o = m_new_obj(py_micro_speech_obj_t);
     o->base.type = &py_micro_speech_type;
     o->n_slices = 0;
+    o->slice_index = 0;
     o->new_slices = false;
     memset(o->spectrogram, 0, kFeatureElementCount);
     if (libtf_initialize_micro_features() != 0) {
@@ -76,43 +80,33 @@ mp_obj_t py_micro_speech_audio_callback(mp_obj_t self_in, mp_obj_t buf_in) {
         RAISE_OS_EXCEPTION("Audio data size too small!");
     }
 
-    uint32_t slice_index = 0;
-    if (microspeech->n_slices < kFeatureSliceCount) {
-        slice_index = microspeech->n_slices++;
-    } else {
-        // Spectrogram is full, move old data up in the spectrogram
-        // and put the new slice at the end of the spectrogram.
-        // +-----------+             +-----------+
-        // | data@20ms |         --> | data@40ms |
-        // +-----------+       --    +-----------+
-        // | data@40ms |     --  --> | data@60ms |
-        // +-----------+   --  --    +-----------+
-        // | data@60ms | --  --      | data@80ms |
-        // +-----------+   --        +-----------+
-        // | data@80ms | --          |<new slice>|
-        // +-----------+             +-----------+
-        slice_index = (kFeatureSliceCount - 1);
-        memmove(microspeech->spectrogram,
-                microspeech->spectrogram + kFeatureSliceSize,
-                kFeatureElementCount - kFeatureSliceSize);
-        microspeech->new_slices = true;
-    }
-
+    // Only the new slice is computed, it overwrites the oldest slice once the ring is full.
     size_t num_samples_read;
-    int8_t *new_slice = microspeech->spectrogram + (slice_index * kFeatureSliceSize);
+    int8_t *new_slice = microspeech->spectrogram + (microspeech->slice_index * kFeatureSliceSize);
     if (libtf_generate_micro_features((int16_t *) pcmbuf.buf,
                                       kMaxAudioSampleSize, kFeatureSliceSize, new_slice, &num_samples_read)) {
         RAISE_OS_EXCEPTION("Feature generation failed!");
     }
+
+    microspeech->slice_index = (microspeech->slice_index + 1) % kFeatureSliceCount;
+
+    if (microspeech->n_slices < kFeatureSliceCount) {
+        microspeech->n_slices++;
+    }
+
+    microspeech->new_slices = (microspeech->n_slices == kFeatureSliceCount);
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_micro_speech_audio_callback_obj, py_micro_speech_audio_callback);
 
 STATIC void py_tf_input_callback(void *callback_data, void *model_input, libtf_parameters_t *params) {
-    // Copy feature buffer to input tensor
-    for (int i = 0; i < kFeatureElementCount; i++) {
-        ((int8_t *) model_input)[i] = ((int8_t *) callback_data)[i];
-    }
+    py_micro_speech_obj_t *microspeech = (py_micro_speech_obj_t *) callback_data;
+
+    // Unroll the ring into the input tensor, oldest slice first. The audio callback is scheduled
+    // so it can't run while the model is invoked.
+    size_t oldest = microspeech->slice_index * kFeatureSliceSize;
+    memcpy(model_input, microspeech->spectrogram + oldest, kFeatureElementCount - oldest);
+    memcpy(((int8_t *) model_input) + kFeatureElementCount - oldest, microspeech->spectrogram, oldest);
 }
 
 STATIC void py_tf_output_callback(void *callback_data, void *model_output, libtf_parameters_t *params) {
@@ -166,8 +160,6 @@ STATIC mp_obj_t py_micro_speech_listen(uint n_args, const mp_obj_t *pos_args, mp
     memset(previous_scores, 0, kAverageWindowSamples * kCategoryCount);
     memset(average_scores, 0, kCategoryCount * sizeof(*average_scores));
 
-    int8_t spectrogram[kFeatureElementCount];
-
     fb_alloc_mark();
     py_tf_alloc_log_buffer();
     uint8_t *tensor_arena = fb_alloc(model->params.tensor_arena_size, FB_ALLOC_PREFER_SPEED | FB_ALLOC_CACHE_ALIGN);
@@ -180,18 +172,14 @@ STATIC mp_obj_t py_micro_speech_listen(uint n_args, const mp_obj_t *pos_args, mp
             continue;
         }
 
-        // Copy spectrogram atomically
-        __disable_irq();
         microspeech->new_slices = false;
-        memcpy(spectrogram, microspeech->spectrogram, kFeatureElementCount);
-        __enable_irq();
 
         // Run model on updated spectrogram
         if (libtf_invoke(model->data,
                          tensor_arena,
                          &model->params,
                          py_tf_input_callback,
-                         spectrogram,
+                         microspeech,
                          py_tf_output_callback,
                          previous_scores[results_count]) != 0) {
             mp_raise_msg(&mp_type_OSError, (mp_rom_error_text_t) py_tf_log_buffer);
@@ -236,10 +224,9 @@ STATIC mp_obj_t py_micro_speech_listen(uint n_args, const mp_obj_t *pos_args, mp
                 if (command_filtered == false) {
                     return_label = highest_index;
                     // Clear spectrogram
-                    __disable_irq();
                     microspeech->n_slices = 0;
+                    microspeech->slice_index = 0;
                     microspeech->new_slices = false;
-                    __enable_irq();
                     break;
                 }
             }
@@ -25,6 +25,7 @@
 #include "omv_common.h"
 #include "py_helper.h"
 #include "file_utils.h"
+#include "omv_energy.h"
 
 #include "winc.h"
 #include "socket/include/socket.h"
@@ -85,6 +86,7 @@ static mp_obj_t py_winc_make_new(const mp_obj_type_t *type, mp_uint_t n_args, mp
                           MP_ERROR_TEXT("Failed to initialize WINC1500 module: %s\n"), winc_strerror(error));
     }
     winc_obj.active = true;
+    omv_energy_set_periph(OMV_ENERGY_PERIPH_WIFI, true);
 
     switch (winc_obj.itf) {
         case WINC_MODE_BSP:
@@ -122,6 +124,7 @@ static mp_obj_t py_winc_active(size_t n_args, const mp_obj_t *args) {
             winc_init(WINC_MODE_BSP);
         }
         self->active = mp_obj_is_true(args[1]);
+        omv_energy_set_periph(OMV_ENERGY_PERIPH_WIFI, self->active);
     }
     return mp_obj_new_bool(self->active);
 }
@@ -0,0 +1,259 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * SD card USB MSC storage with read-ahead.
+ *
+ * The MSC BOT layer requests a few blocks at a time, which the default storage turns into as
+ * many small SDMMC transfers. These storage ops detect sequential reads and read ahead with one
+ * multi-block DMA transfer into the cache, doubling the read-ahead up to the cache size while the
+ * host keeps reading sequentially, so bulk copies are served from the cache. Random reads (e.g.
+ * FAT and directory lookups) only read the requested blocks. Writes go straight to the card and
+ * drop any cached blocks they overlap.
+ *
+ * Optionally, only one partition of the card is exported (as a partitionless volume), so that the
+ * host can read and write it while scripts keep recording to the camera's filesystem.
+ */
+#include STM32_HAL_H
+#include <stdbool.h>
+#include <string.h>
+#include "py/mphal.h"
+#include "irq.h"
+#include "usb.h"
+#include "sdcard.h"
+#include "usbd_core.h"
+#include "usbd_cdc_msc_hid.h"
+#include "omv_boardconfig.h"
+#include "omv_common.h"
+#include "msc_storage.h"
+
+#if MICROPY_HW_ENABLE_SDCARD && defined(OMV_MSC_CACHE_MEMORY)
+#define MSC_BLOCK_SIZE          (SDCARD_BLOCK_SIZE)
+#define MSC_CACHE_BLOCKS        ((uint32_t) (_msc_cache_end - _msc_cache_start) / MSC_BLOCK_SIZE)
+#define MSC_MBR_PARTITIONS      (446)   // Offset of the MBR partition table.
+
+typedef struct msc_storage {
+    bool started;
+    uint32_t base;          // First block of the exported blocks.
+    uint32_t blocks;        // Number of exported blocks.
+    uint32_t next;          // The block following the last read.
+    uint32_t readahead;     // Current read-ahead in blocks.
+    uint32_t cache_addr;    // First cached block.
+    uint32_t cache_count;   // Number of cached blocks.
+} msc_storage_t;
+
+static msc_storage_t msc_storage;
+extern uint8_t _msc_cache_start[];
+extern uint8_t _msc_cache_end[];
+
+#if MICROPY_HW_USB_FS
+extern PCD_HandleTypeDef pcd_fs_handle;
+#endif
+#if MICROPY_HW_USB_HS
+extern PCD_HandleTypeDef pcd_hs_handle;
+#endif
+
+static const uint8_t msc_storage_inquiry_data[36] = {
+    0x00, // peripheral qualifier; peripheral device type
+    0x80, // 0x00 for a fixed drive, 0x80 for a removable drive
+    0x02, // version
+    0x02, // response data format
+    (sizeof(msc_storage_inquiry_data) - 5), // additional length
+    0x00, // various flags
+    0x00, // various flags
+    0x00, // various flags
+    'O', 'p', 'e', 'n', 'M', 'V', ' ', ' ', // Manufacturer : 8 bytes
+    'S', 'D', ' ', 'C', 'a', 'r', 'd', ' ', // Product      : 16 Bytes
+    'S', 't', 'o', 'r', 'a', 'g', 'e', ' ',
+    '1', '.', '0', '0', // Version      : 4 Bytes
+};
+
+static int8_t msc_storage_init_lun(uint8_t lun) {
+    return sdcard_power_on() ? 0 : -1;
+}
+
+static int msc_storage_inquiry(uint8_t lun, const uint8_t *params, uint8_t *data_out) {
+    if (params[1] & 1) {
+        // EVPD set, only the supported VPD pages page is supported.
+        if (params[2] != 0x00) {
+            return -1;
+        }
+
+        data_out[0] = params[0] & 0xe0;
+        data_out[1] = 0x00;
+        data_out[2] = 0x00;
+        data_out[3] = 1;
+        data_out[4] = 0x00;
+        return 5;
+    }
+
+    int len = OMV_MIN((int) sizeof(msc_storage_inquiry_data), (params[3] << 8) | params[4]);
+    memcpy(data_out, msc_storage_inquiry_data, len);
+    return len;
+}
+
+static int8_t msc_storage_get_capacity(uint8_t lun, uint32_t *block_num, uint16_t *block_size) {
+    *block_num = msc_storage.blocks;
+    *block_size = MSC_BLOCK_SIZE;
+    return 0;
+}
+
+static int8_t msc_storage_is_ready(uint8_t lun) {
+    return (msc_storage.started && sdcard_is_present()) ? 0 : -1;
+}
+
+static int8_t msc_storage_is_write_protected(uint8_t lun) {
+    return 0;
+}
+
+static int8_t msc_storage_start_stop_unit(uint8_t lun, uint8_t started) {
+    msc_storage.started = started;
+    msc_storage.cache_count = 0;
+    return 0;
+}
+
+static int8_t msc_storage_prevent_allow_medium_removal(uint8_t lun, uint8_t param0) {
+    return 0;
+}
+
+static int8_t msc_storage_read(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len) {
+    if ((blk_addr + blk_len) > msc_storage.blocks) {
+        return -1;
+    }
+
+    // Grow the read-ahead while the host reads sequentially, reset it on random reads.
+    if (blk_addr == msc_storage.next) {
+        msc_storage.readahead = OMV_MIN(msc_storage.readahead * 2, MSC_CACHE_BLOCKS);
+    } else {
+        msc_storage.readahead = 1;
+    }
+
+    msc_storage.next = blk_addr + blk_len;
+    blk_addr += msc_storage.base;
+
+    for (uint32_t n; blk_len; blk_addr += n, blk_len -= n, buf += n * MSC_BLOCK_SIZE) {
+        if ((blk_addr < msc_storage.cache_addr) ||
+            (blk_addr >= (msc_storage.cache_addr + msc_storage.cache_count))) {
+            uint32_t count = OMV_MAX(msc_storage.readahead, blk_len);
+            count = OMV_MIN(count, MSC_CACHE_BLOCKS);
+            count = OMV_MIN(count, (msc_storage.base + msc_storage.blocks) - blk_addr);
+
+            msc_storage.cache_count = 0;
+
+            if (sdcard_read_blocks(_msc_cache_start, blk_addr, count) != 0) {
+                return -1;
+            }
+
+            msc_storage.cache_addr = blk_addr;
+            msc_storage.cache_count = count;
+        }
+
+        uint32_t offset = blk_addr - msc_storage.cache_addr;
+        n = OMV_MIN(blk_len, msc_storage.cache_count - offset);
+        memcpy(buf, _msc_cache_start + (offset * MSC_BLOCK_SIZE), n * MSC_BLOCK_SIZE);
+    }
+
+    return 0;
+}
+
+static int8_t msc_storage_write(uint8_t lun, uint8_t *buf, uint32_t blk_addr, uint16_t blk_len) {
+    if ((blk_addr + blk_len) > msc_storage.blocks) {
+        return -1;
+    }
+
+    blk_addr += msc_storage.base;
+
+    if ((blk_addr < (msc_storage.cache_addr + msc_storage.cache_count)) &&
+        ((blk_addr + blk_len) > msc_storage.cache_addr)) {
+        msc_storage.cache_count = 0;
+    }
+
+    return (sdcard_write_blocks(buf, blk_addr, blk_len) != 0) ? -1 : 0;
+}
+
+static int8_t msc_storage_get_max_lun(void) {
+    return 0;
+}
+
+static const USBD_StorageTypeDef msc_storage_fops = {
+    .Init = msc_storage_init_lun,
+    .Inquiry = msc_storage_inquiry,
+    .GetCapacity = msc_storage_get_capacity,
+    .IsReady = msc_storage_is_ready,
+    .IsWriteProtected = msc_storage_is_write_protected,
+    .StartStopUnit = msc_storage_start_stop_unit,
+    .PreventAllowMediumRemoval = msc_storage_prevent_allow_medium_removal,
+    .Read = msc_storage_read,
+    .Write = msc_storage_write,
+    .GetMaxLun = msc_storage_get_max_lun,
+};
+
+static USBD_HandleTypeDef *msc_storage_usbd(void) {
+    #if MICROPY_HW_USB_HS
+    if (pyb_usb_dev_detect() == USB_PHY_HS_ID) {
+        return pcd_hs_handle.pData;
+    }
+    #endif
+    #if MICROPY_HW_USB_FS
+    return pcd_fs_handle.pData;
+    #else
+    return NULL;
+    #endif
+}
+
+// Replaces the storage ops of the USB MSC interface. If partition is non-zero, only that MBR
+// partition (1-4) is exported. Must be called after the USB device is initialized.
+int msc_storage_init(int partition) {
+    USBD_HandleTypeDef *usbd = msc_storage_usbd();
+
+    if (!usbd || !usbd->pClassData || !sdcard_is_present() || (partition < 0) || (partition > 4)) {
+        return -1;
+    }
+
+    uint32_t base = 0, blocks = sdcard_get_capacity_in_bytes() / MSC_BLOCK_SIZE;
+
+    if (partition) {
+        const uint8_t *mbr = _msc_cache_start;
+        const uint8_t *entry = mbr + MSC_MBR_PARTITIONS + ((partition - 1) * 16);
+
+        if (sdcard_read_blocks(_msc_cache_start, 0, 1) != 0) {
+            return -1;
+        }
+
+        // Partition type 0 is an unused entry.
+        if ((mbr[510] != 0x55) || (mbr[511] != 0xAA) || (!entry[4])) {
+            return -1;
+        }
+
+        uint32_t start = __UNALIGNED_UINT32_READ(entry + 8);
+        uint32_t count = __UNALIGNED_UINT32_READ(entry + 12);
+
+        if ((!count) || (start >= blocks) || (count > (blocks - start))) {
+            return -1;
+        }
+
+        base = start;
+        blocks = count;
+    }
+
+    uint32_t irq_state = disable_irq();
+    msc_storage.started = true;
+    msc_storage.base = base;
+    msc_storage.blocks = blocks;
+    msc_storage.next = 0;
+    msc_storage.readahead = 1;
+    msc_storage.cache_addr = 0;
+    msc_storage.cache_count = 0;
+    USBD_MSC_RegisterStorage(usbd->pClassData, (USBD_StorageTypeDef *) &msc_storage_fops);
+    enable_irq(irq_state);
+    return 0;
+}
+#else
+int msc_storage_init(int partition) {
+    return -1;
+}
+#endif // MICROPY_HW_ENABLE_SDCARD && defined(OMV_MSC_CACHE_MEMORY)
@@ -0,0 +1,14 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * SD card USB MSC storage with read-ahead.
+ */
+#ifndef __MSC_STORAGE_H__
+#define __MSC_STORAGE_H__
+int msc_storage_init(int partition);
+#endif /* __MSC_STORAGE_H__ */
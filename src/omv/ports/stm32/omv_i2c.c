@@ -79,6 +79,9 @@ void I2C4_ER_IRQHandler(void) {
 #endif
 #endif // I2C4
 
+// Buses with a queued transfer running in the background, for the HAL callbacks.
+static omv_i2c_t *omv_i2c_async[4];
+
 static const uint32_t omv_i2c_timing[OMV_I2C_SPEED_MAX] = {
 #if defined(STM32F4)
     100000U, 400000U, 400000U,
@@ -98,6 +101,9 @@ int omv_i2c_init(omv_i2c_t *i2c, uint32_t bus_id, uint32_t speed) {
     i2c->initialized = false;
     i2c->scl_pin = NULL;
     i2c->sda_pin = NULL;
+    i2c->xfer_head = NULL;
+    i2c->xfer_tail = NULL;
+    i2c->xfer_busy = false;
 
     switch (bus_id) {
         #if defined(OMV_I2C1_ID)
@@ -434,6 +440,81 @@ int omv_i2c_write_bytes(omv_i2c_t *i2c, uint8_t slv_addr, uint8_t *buf, int len,
     return ret;
 }
 
+int omv_i2c_transfer_start(omv_i2c_t *i2c, omv_i2c_transfer_t *xfer) {
+    HAL_StatusTypeDef status;
+
+    omv_i2c_async[i2c->id - 1] = i2c;
+    omv_i2c_set_irq_state(i2c, true);
+
+    // The read, if any, is started from the write complete callback.
+    if (xfer->wlen) {
+        status = HAL_I2C_Master_Seq_Transmit_IT(i2c->inst, xfer->slv_addr, xfer->wbuf, xfer->wlen,
+                                                xfer->rlen ? I2C_FIRST_FRAME : I2C_FIRST_AND_LAST_FRAME);
+    } else {
+        status = HAL_I2C_Master_Seq_Receive_IT(i2c->inst, xfer->slv_addr, xfer->rbuf, xfer->rlen,
+                                               I2C_FIRST_AND_LAST_FRAME);
+    }
+
+    if (status != HAL_OK) {
+        omv_i2c_async[i2c->id - 1] = NULL;
+        omv_i2c_set_irq_state(i2c, false);
+        return -1;
+    }
+
+    return 1;
+}
+
+void omv_i2c_transfer_stop(omv_i2c_t *i2c) {
+    omv_i2c_async[i2c->id - 1] = NULL;
+    omv_i2c_set_irq_state(i2c, false);
+
+    // Re-initializing the bus releases it from the aborted transfer.
+    HAL_I2C_DeInit(i2c->inst);
+    HAL_I2C_Init(i2c->inst);
+}
+
+static omv_i2c_t *omv_i2c_async_lookup(I2C_HandleTypeDef *hi2c) {
+    for (size_t i = 0; i < sizeof(omv_i2c_async) / sizeof(omv_i2c_async[0]); i++) {
+        if (omv_i2c_async[i] && omv_i2c_async[i]->inst == hi2c) {
+            return omv_i2c_async[i];
+        }
+    }
+    return NULL;
+}
+
+static void omv_i2c_async_done(omv_i2c_t *i2c, int status) {
+    omv_i2c_async[i2c->id - 1] = NULL;
+    omv_i2c_set_irq_state(i2c, false);
+    omv_i2c_transfer_complete(i2c, status);
+}
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    omv_i2c_t *i2c = omv_i2c_async_lookup(hi2c);
+    if (i2c) {
+        omv_i2c_transfer_t *xfer = i2c->xfer_head;
+        if (!xfer->rlen) {
+            omv_i2c_async_done(i2c, 0);
+        } else if (HAL_I2C_Master_Seq_Receive_IT(hi2c, xfer->slv_addr, xfer->rbuf,
+                                                 xfer->rlen, I2C_LAST_FRAME) != HAL_OK) {
+            omv_i2c_async_done(i2c, -1);
+        }
+    }
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    omv_i2c_t *i2c = omv_i2c_async_lookup(hi2c);
+    if (i2c) {
+        omv_i2c_async_done(i2c, 0);
+    }
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+    omv_i2c_t *i2c = omv_i2c_async_lookup(hi2c);
+    if (i2c) {
+        omv_i2c_async_done(i2c, -1);
+    }
+}
+
 int omv_i2c_pulse_scl(omv_i2c_t *i2c) {
     if (i2c->initialized && i2c->scl_pin) {
         // Configure SCL as GPIO
@@ -80,7 +80,8 @@ UVC_LDFLAGS = -mcpu=$(CPU) -mabi=aapcs-linux -mthumb -mfpu=$(FPU) -mfloat-abi=ha
 endif
 
 ifeq ($(OMV_ENABLE_CM4), 1)
-CFLAGS     += -DM4_APP_ADDR=$(M4_APP_ADDR)
+CFLAGS     += -DM4_APP_ADDR=$(M4_APP_ADDR) -DOMV_ENABLE_CM4=1
+CFLAGS     += -I$(TOP_DIR)/$(CM4_DIR)/include/
 ifeq ($(DEBUG), 1)
 CM4_CFLAGS += -Og -ggdb3 -Wno-maybe-uninitialized
 else
@@ -150,7 +151,13 @@ FIRM_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/common/, \
 	ringbuf.o                   \
 	trace.o                     \
 	mutex.o                     \
+	omv_cache.o                 \
+	omv_energy.o                \
+	omv_memcpy.o                \
+	omv_i2c_queue.o             \
+	omv_spi_chain.o             \
 	vospi.o                     \
+	omv_job.o                   \
 	pendsv.o                    \
 	usbdbg.o                    \
 	file_utils.o                \
@@ -177,8 +184,9 @@ FIRM_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/sensors/,   \
    )
 
 FIRM_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/imlib/, \
-	agast.o                     \
 	apriltag.o                  \
+	apriltag_tab.o              \
+	background.o                \
 	bayer.o                     \
 	binary.o                    \
 	blob.o                      \
@@ -198,6 +206,7 @@ FIRM_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/imlib/, \
 	fsort.o                     \
 	gif.o                       \
 	haar.o                      \
+	hdr.o                       \
 	hog.o                       \
 	hough.o                     \
 	imlib.o                     \
@@ -206,27 +215,34 @@ FIRM_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/imlib/, \
 	isp.o                       \
 	jpegd.o                     \
 	jpege.o                     \
-	lodepng.o                   \
 	png.o                       \
 	kmeans.o                    \
 	lab_tab.o                   \
 	lbp.o                       \
 	line.o                      \
 	lsd.o                       \
+	lz4.o                       \
 	mathop.o                    \
 	mjpeg.o                     \
+	optflow.o                   \
 	orb.o                       \
 	phasecorrelation.o          \
 	point.o                     \
 	ppm.o                       \
+	pyramid.o                   \
 	qrcode.o                    \
 	qsort.o                     \
 	rainbow_tab.o               \
+	raw.o                       \
 	rectangle.o                 \
+	rsort.o                     \
 	selective_search.o          \
 	sincos_tab.o                \
 	stats.o                     \
+	strip.o                     \
 	stereo.o                    \
+	task.o                      \
+	temporal.o                  \
 	template.o                  \
 	xyz_tab.o                   \
 	yuv.o                       \
@@ -548,6 +564,9 @@ UVC_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/common/, \
 	array.o                                 \
 	trace.o                                 \
 	mutex.o                                 \
+	omv_cache.o                             \
+	omv_memcpy.o                            \
+	omv_i2c_queue.o                         \
 	sensor_utils.o                          \
 	vospi.o                                 \
 	)
@@ -575,6 +594,7 @@ UVC_OBJ += $(addprefix $(BUILD)/$(OMV_DIR)/imlib/,\
 	lab_tab.o                               \
 	xyz_tab.o                               \
 	rainbow_tab.o                           \
+	raw.o                                   \
 	jpege.o                                 \
 	fmath.o                                 \
 	imlib.o                                 \
@@ -17,17 +17,28 @@
 #include "framebuffer.h"
 #include "omv_boardconfig.h"
 #include "unaligned_memcpy.h"
+#include "omv_job.h"
 #include "omv_gpio.h"
 #include "omv_i2c.h"
 #include "dma_utils.h"
+#include "powerctrl.h"
+#include "py_cpufreq.h"
+#include "trace.h"
 
 #define MDMA_BUFFER_SIZE         (64)
 #define DMA_MAX_XFER_SIZE        (0xFFFF * 4)
 #define DMA_MAX_XFER_SIZE_DBL    ((DMA_MAX_XFER_SIZE) * 2)
 #define DMA_LENGTH_ALIGNMENT     (16)
 #define SENSOR_TIMEOUT_MS        (3000)
+#define SENSOR_INFO_MS           (100)
 #define ARRAY_SIZE(a)            (sizeof(a) / sizeof((a)[0]))
 
+// First of the two RTC backup registers holding the probe results (they survive resets,
+// standby and, with VBAT, power loss). F4 parts only have 20 of them.
+#ifndef OMV_CSI_PROBE_CACHE_BKP
+#define OMV_CSI_PROBE_CACHE_BKP  (16)
+#endif
+
 sensor_t sensor = {};
 static TIM_HandleTypeDef TIMHandle = {};
 static DMA_HandleTypeDef DMAHandle = {};
@@ -37,6 +48,9 @@ static MDMA_HandleTypeDef DCMI_MDMA_Handle0;
 static MDMA_HandleTypeDef DCMI_MDMA_Handle1;
 #endif
 
+// Raw rows of the BAYER frame being debayered during capture.
+static debayer_stream_t debayer_stream;
+
 extern uint8_t _line_buf;
 extern uint32_t hal_get_exti_gpio(uint32_t line);
 
@@ -112,6 +126,29 @@ void sensor_init0() {
 
     // Disable Frame callback.
     sensor_set_frame_callback(NULL);
+
+    // Disable the trigger IRQ.
+    if (sensor.trigger) {
+        sensor_set_trigger(false, false);
+    }
+}
+
+void sensor_probe_cache_load(uint32_t cache[2]) {
+    #if defined(MCU_SERIES_H7)
+    __HAL_RCC_RTC_CLK_ENABLE();
+    #endif
+    volatile uint32_t *bkp = &RTC->BKP0R + OMV_CSI_PROBE_CACHE_BKP;
+    cache[0] = bkp[0];
+    cache[1] = bkp[1];
+}
+
+void sensor_probe_cache_store(const uint32_t cache[2]) {
+    volatile uint32_t *bkp = &RTC->BKP0R + OMV_CSI_PROBE_CACHE_BKP;
+    if ((bkp[0] != cache[0]) || (bkp[1] != cache[1])) {
+        HAL_PWR_EnableBkUpAccess();
+        bkp[0] = cache[0];
+        bkp[1] = cache[1];
+    }
 }
 
 int sensor_init() {
@@ -125,6 +162,18 @@ int sensor_init() {
         #endif
     };
 
+    // Start with the bus the sensor was on last time.
+    int cached_bus = sensor_probe_cache_bus();
+    for (uint32_t i = 1; i < ARRAY_SIZE(buses); i++) {
+        if ((cached_bus >= 0) && (buses[i][0] == (uint32_t) cached_bus)) {
+            uint32_t tmp[2] = {buses[0][0], buses[0][1]};
+            buses[0][0] = buses[i][0];
+            buses[0][1] = buses[i][1];
+            buses[i][0] = tmp[0];
+            buses[i][1] = tmp[1];
+        }
+    }
+
     // Reset the sensor state
     memset(&sensor, 0, sizeof(sensor_t));
 
@@ -216,6 +265,17 @@ int sensor_config(sensor_config_t config) {
     } else if (config == SENSOR_CONFIG_PIXFORMAT) {
         DCMI->CR &= ~(DCMI_CR_JPEG_Msk << DCMI_CR_JPEG_Pos);
         DCMI->CR |= (sensor.pixformat == PIXFORMAT_JPEG) ? DCMI_JPEG_ENABLE : DCMI_JPEG_DISABLE;
+        #if defined(MCU_SERIES_F7) || defined(MCU_SERIES_H7)
+        // Grayscale from a YUV422 sensor: keep only the Y byte of each pixel clock pair so that
+        // half the data is moved by DMA and the line buffers hold 1BPP lines.
+        sensor.byte_select = (sensor.pixformat == PIXFORMAT_GRAYSCALE) && (sensor.hw_flags.gs_bpp == 2);
+        DCMI->CR &= ~(DCMI_CR_BSM | DCMI_CR_OEBS);
+        DCMI->CR |= sensor.byte_select ? (DCMI_BSM_OTHER | DCMI_OEBS_ODD) : DCMI_BSM_ALL;
+        #endif
+        // Packed RAW frames are captured one 16-bit word per pixel and packed line by line.
+        DCMI->CR &= ~DCMI_CR_EDM;
+        DCMI->CR |= (sensor.pixformat == PIXFORMAT_RAW10) ? DCMI_EXTEND_DATA_10B :
+                    (sensor.pixformat == PIXFORMAT_RAW12) ? DCMI_EXTEND_DATA_12B : DCMI_EXTEND_DATA_8B;
     }
     return 0;
 }
@@ -256,6 +316,15 @@ int sensor_abort(bool fifo_flush, bool in_irq) {
     return 0;
 }
 
+void sensor_wait_for_interrupt(bool stop_mode) {
+    if (stop_mode) {
+        // Clocks are restored on wakeup, the sensor interrupt (EXTI) wakes the MCU.
+        powerctrl_enter_stop_mode();
+    } else {
+        MICROPY_EVENT_POLL_HOOK
+    }
+}
+
 uint32_t sensor_get_xclk_frequency() {
     return (OMV_CSI_TIM_PCLK_FREQ() * 2) / (TIMHandle.Init.Period + 1);
 }
@@ -373,12 +442,84 @@ int sensor_set_vsync_callback(vsync_cb_t vsync_cb) {
     return 0;
 }
 
+#if defined(OMV_CSI_TRIGGER_PIN) && defined(OMV_CSI_FSYNC_PIN)
+// Starts the exposure as soon as the trigger fires, the capture is already armed by snapshot.
+static void sensor_trigger_callback(void *data) {
+    // Pulses are counted even when no capture is armed to stay in step with the master.
+    sensor.sync_seq += 1;
+    if (!sensor.triggered) {
+        omv_gpio_write(OMV_CSI_FSYNC_PIN, 1);
+        sensor.trigger_us = mp_hal_ticks_us();
+        sensor.triggered = true;
+    }
+}
+#endif
+
+int sensor_set_trigger(bool enable, bool master) {
+    #if defined(OMV_CSI_TRIGGER_PIN) && defined(OMV_CSI_FSYNC_PIN)
+    // Disable any ongoing frame capture.
+    sensor_abort(true, false);
+
+    if (!sensor.hw_flags.fsync) {
+        return SENSOR_ERROR_CTL_UNSUPPORTED;
+    }
+
+    // The sensor must only start a frame on the frame sync pin.
+    if (sensor_ioctl(IOCTL_SET_TRIGGERED_MODE, enable) != 0) {
+        return SENSOR_ERROR_CTL_FAILED;
+    }
+
+    sensor.trigger = enable;
+    sensor.trigger_master = enable && master;
+    sensor.triggered = false;
+    sensor.sync_seq = 0;
+    omv_gpio_write(OMV_CSI_FSYNC_PIN, 0);
+
+    // The master drives the sync pulses from snapshot, it doesn't listen to the trigger pin.
+    if (enable && (!master)) {
+        omv_gpio_config(OMV_CSI_TRIGGER_PIN, OMV_GPIO_MODE_IT_RISE, OMV_GPIO_PULL_NONE, OMV_GPIO_SPEED_LOW, -1);
+        omv_gpio_irq_register(OMV_CSI_TRIGGER_PIN, sensor_trigger_callback, NULL);
+        omv_gpio_irq_enable(OMV_CSI_TRIGGER_PIN, true);
+    } else if (!enable) {
+        omv_gpio_irq_enable(OMV_CSI_TRIGGER_PIN, false);
+        omv_gpio_deinit(OMV_CSI_TRIGGER_PIN);
+    }
+
+    return 0;
+    #else
+    return SENSOR_ERROR_CTL_UNSUPPORTED;
+    #endif
+}
+
+static void sensor_sample_exposure(sensor_t *sensor) {
+    uint32_t tick = mp_hal_ticks_ms();
+
+    if ((tick - sensor->info_ms) < SENSOR_INFO_MS) {
+        return;
+    }
+
+    sensor->info_ms = tick;
+
+    int exposure_us;
+    if ((!sensor->get_exposure_us) || (sensor->get_exposure_us(sensor, &exposure_us) != 0)) {
+        exposure_us = -1;
+    }
+
+    float gain_db;
+    if ((!sensor->get_gain_db) || (sensor->get_gain_db(sensor, &gain_db) != 0)) {
+        gain_db = 0.0f;
+    }
+
+    sensor->exposure_us = exposure_us;
+    sensor->gain_db = gain_db;
+}
+
 // If we are cropping the image by more than 1 word in width we can align the line start to
 // a word address to improve copy performance. Do not crop by more than 1 word as this will
 // result in less time between DMA transfers complete interrupts on 16-byte boundaries.
 static uint32_t get_dcmi_hw_crop(uint32_t bytes_per_pixel) {
-    uint32_t byte_x_offset = (MAIN_FB()->x * bytes_per_pixel) % sizeof(uint32_t);
-    uint32_t width_remainder = (resolution[sensor.framesize][0] - (MAIN_FB()->x + MAIN_FB()->u)) * bytes_per_pixel;
+    uint32_t byte_x_offset = (sensor_get_src_x() * bytes_per_pixel) % sizeof(uint32_t);
+    uint32_t width_remainder = (sensor_get_src_width() - (sensor_get_src_x() + MAIN_FB()->u)) * bytes_per_pixel;
     uint32_t x_crop = 0;
 
     if (byte_x_offset && (width_remainder >= (sizeof(uint32_t) - byte_x_offset))) {
@@ -414,6 +555,22 @@ void HAL_DCMI_FrameEventCallback(DCMI_HandleTypeDef *hdcmi) {
         return;
     }
 
+    vbuffer_t *buffer = framebuffer_get_tail(FB_PEEK);
+    if (buffer) {
+        TRACE_EVENT(TRACE_PROF_FRAME_END, TRACE_EVENT_INSTANT);
+        buffer->info.eof_us = mp_hal_ticks_us();
+        buffer->info.exposure_us = sensor.exposure_us;
+        buffer->info.gain_db = sensor.gain_db;
+    }
+
+    #if defined(OMV_CSI_FSYNC_PIN)
+    // End the exposure so the next trigger can start a new frame.
+    if (sensor.triggered) {
+        omv_gpio_write(OMV_CSI_FSYNC_PIN, 0);
+        sensor.triggered = false;
+    }
+    #endif
+
     framebuffer_get_tail(FB_NO_FLAGS);
 
     if (sensor.frame_callback) {
@@ -444,9 +601,19 @@ int sensor_dma_memcpy(void *dma, void *dst, void *src, int bpp, bool transposed)
 }
 #endif
 
+#if defined(OMV_MDMA_CHANNEL_DCMI_0)
+// MDMA can move whole frames without line interrupts unless each line needs CPU work.
+static bool mdma_full_offload(sensor_t *sensor) {
+    return (!sensor->transpose) && (!sensor->debayer) && (!sensor->dual_scale)
+           && (sensor->pixformat != PIXFORMAT_RAW10) && (sensor->pixformat != PIXFORMAT_RAW12);
+}
+#endif
+
 // This function is called back after each line transfer is complete, with a pointer to the
 // buffer that was used. At this point the DMA transfers the next line to the next buffer.
 void DCMI_DMAConvCpltUser(uint32_t addr) {
+    bool first_line = !sensor.first_line;
+
     // Throttle frames to match the current frame rate.
     sensor_throttle_framerate();
 
@@ -454,7 +621,7 @@ void DCMI_DMAConvCpltUser(uint32_t addr) {
         // If we're dropping a frame in full offload mode it's safe to disable this interrupt saving
         // ourselves from having to service the DMA complete callback.
         #if defined(OMV_MDMA_CHANNEL_DCMI_0)
-        if (!sensor.transpose) {
+        if (mdma_full_offload(&sensor)) {
             HAL_NVIC_DisableIRQ(DMA2_Stream1_IRQn);
         }
         #endif
@@ -470,6 +637,13 @@ void DCMI_DMAConvCpltUser(uint32_t addr) {
         return;
     }
 
+    // A triggered exposure starts at the trigger, before the first line is read out.
+    if (first_line) {
+        TRACE_EVENT(TRACE_PROF_FRAME_START, TRACE_EVENT_INSTANT);
+        buffer->info.sof_us = sensor.triggered ? sensor.trigger_us : mp_hal_ticks_us();
+        buffer->info.sync_seq = sensor.trigger ? sensor.sync_seq : 0;
+    }
+
     // We are transferring the image from the DCMI hardware to line buffers so that we have more
     // control to post process the image data before writing it to the frame buffer. This requires
     // more CPU, but, allows us to crop and rotate the image as the data is received.
@@ -523,23 +697,74 @@ void DCMI_DMAConvCpltUser(uint32_t addr) {
     // DCMI_DMAXferCplt in the HAL DCMI driver always calls DCMI_DMAConvCpltUser with the other
     // MAR register. So, we have to fix the address in full MDMA offload mode...
     #if defined(OMV_MDMA_CHANNEL_DCMI_0)
-    if (!sensor.transpose) {
+    if (mdma_full_offload(&sensor)) {
         addr = (uint32_t) &_line_buf;
     }
     #endif
 
     uint32_t bytes_per_pixel = sensor_get_src_bpp();
-    uint8_t *src = ((uint8_t *) addr) + (MAIN_FB()->x * bytes_per_pixel) - get_dcmi_hw_crop(bytes_per_pixel);
+    uint8_t *src = ((uint8_t *) addr) + (sensor_get_src_x() * bytes_per_pixel) - get_dcmi_hw_crop(bytes_per_pixel);
     uint8_t *dst = buffer->data;
 
     if (sensor.pixformat == PIXFORMAT_GRAYSCALE) {
         bytes_per_pixel = sizeof(uint8_t);
     }
 
+    // Packed RAW frames are packed one line at a time from the line buffers into the frame buffer.
+    if ((sensor.pixformat == PIXFORMAT_RAW10) || (sensor.pixformat == PIXFORMAT_RAW12)) {
+        image_t raw = {
+            .w = MAIN_FB()->u,
+            .h = 1,
+            .pixfmt = sensor.pixformat
+        };
+
+        dst += buffer->offset++ * image_line_size(&raw);
+        imlib_raw_pack_row(raw.pixfmt, raw.w, (uint16_t *) src, dst);
+        return;
+    }
+
+    // YUV422 frames are converted one line at a time from the line buffers into the frame buffer.
+    if (sensor.debayer && (sensor.pixformat == PIXFORMAT_YUV422)) {
+        image_t yuv = {
+            .w = MAIN_FB()->u,
+            .h = 1,
+            .pixfmt = PIXFORMAT_YUV,
+            .data = src
+        };
+
+        yuv.subfmt_id = sensor.hw_flags.yuv_order;
+        yuv.pixfmt = imlib_yuv_shift(yuv.pixfmt, MAIN_FB()->x);
+        dst += buffer->offset++ * MAIN_FB()->u * ((sensor.debayer == PIXFORMAT_RGB565) ? 2 : 1);
+        imlib_deyuv_line(0, yuv.w, 0, dst, sensor.debayer, &yuv);
+        return;
+    }
+
+    // Debayer mode demosaics each row pair from the line buffers straight into the frame buffer.
+    // The raw rows are kept in a small ring after the image since each output row needs the
+    // rows above and below it.
+    if (sensor.debayer) {
+        image_t img = {
+            .w = MAIN_FB()->u,
+            .h = MAIN_FB()->v,
+            .pixfmt = sensor.debayer,
+            .data = dst
+        };
+
+        if (!buffer->offset) {
+            image_t raw = { .pixfmt = PIXFORMAT_BAYER };
+            raw.subfmt_id = sensor.hw_flags.bayer;
+            raw.pixfmt = imlib_bayer_shift(raw.pixfmt, MAIN_FB()->x, MAIN_FB()->y, false);
+            imlib_debayer_stream_init(&debayer_stream, img.w, img.h, raw.pixfmt, dst + image_size(&img));
+        }
+
+        imlib_debayer_stream_push(&debayer_stream, buffer->offset++, src, &img);
+        return;
+    }
+
     // For all non-JPEG and non-transposed modes we can completely offload image capture to MDMA
     // and we do not need to receive any line interrupts for the rest of the frame until it ends.
     #if defined(OMV_MDMA_CHANNEL_DCMI_0)
-    if (!sensor.transpose) {
+    if (mdma_full_offload(&sensor)) {
         // NOTE: We're starting MDMA here because it gives the maximum amount of time before we
         // have to drop the frame if there's no space. If you use the FRAME/VSYNC callbacks then
         // you will have to drop the frame earlier than necessary if there's no space resulting
@@ -560,6 +785,11 @@ void DCMI_DMAConvCpltUser(uint32_t addr) {
     }
     #endif
 
+    // The decimated copy is sampled from the line buffer since the line copy may still be running.
+    if (sensor.dual_scale) {
+        sensor_dual_copy_line(src, buffer->offset, dst);
+    }
+
     if (!sensor.transpose) {
         dst += MAIN_FB()->u * bytes_per_pixel * buffer->offset++;
     } else {
@@ -597,7 +827,7 @@ static void mdma_config(MDMA_InitTypeDef *init, sensor_t *sensor, uint32_t bytes
         init->Endianness = MDMA_LITTLE_ENDIANNESS_PRESERVE;
     }
 
-    uint32_t line_offset_bytes = (MAIN_FB()->x * bytes_per_pixel) - get_dcmi_hw_crop(bytes_per_pixel);
+    uint32_t line_offset_bytes = (sensor_get_src_x() * bytes_per_pixel) - get_dcmi_hw_crop(bytes_per_pixel);
     uint32_t line_width_bytes = MAIN_FB()->u * bytes_per_pixel;
 
     if (sensor->transpose) {
@@ -606,7 +836,7 @@ static void mdma_config(MDMA_InitTypeDef *init, sensor_t *sensor, uint32_t bytes
     }
 
     // YUV422 Source -> Y Destination
-    if ((sensor->pixformat == PIXFORMAT_GRAYSCALE) && (sensor->hw_flags.gs_bpp == 2)) {
+    if ((sensor->pixformat == PIXFORMAT_GRAYSCALE) && (sensor->hw_flags.gs_bpp == 2) && (!sensor->byte_select)) {
         line_width_bytes /= 2;
         if (sensor->transpose) {
             init->DestBlockAddressOffset /= 2;
@@ -643,22 +873,88 @@ static void mdma_config(MDMA_InitTypeDef *init, sensor_t *sensor, uint32_t bytes
     }
 
     // YUV422 Source -> Y Destination
-    if ((sensor->pixformat == PIXFORMAT_GRAYSCALE) && (sensor->hw_flags.gs_bpp == 2)) {
+    if ((sensor->pixformat == PIXFORMAT_GRAYSCALE) && (sensor->hw_flags.gs_bpp == 2) && (!sensor->byte_select)) {
         init->SourceInc = MDMA_SRC_INC_HALFWORD;
         init->SourceDataSize = MDMA_SRC_DATASIZE_BYTE;
     }
 }
 #endif
 
+int sensor_set_debayer(pixformat_t pixformat) {
+    // Check if the value has changed.
+    if (sensor.debayer == pixformat) {
+        return 0;
+    }
+
+    // Disable any ongoing frame capture.
+    sensor_abort(true, false);
+
+    if (pixformat && (((sensor.pixformat != PIXFORMAT_BAYER) && (sensor.pixformat != PIXFORMAT_YUV422)) ||
+                      sensor.transpose || sensor.auto_rotation ||
+                      ((pixformat != PIXFORMAT_GRAYSCALE) && (pixformat != PIXFORMAT_RGB565)))) {
+        return SENSOR_ERROR_PIXFORMAT_UNSUPPORTED;
+    }
+
+    // Byte swapped YUV422 is only fixed up by the copy paths that YUV conversion bypasses.
+    if (pixformat && (sensor.pixformat == PIXFORMAT_YUV422) && sensor.hw_flags.yuv_swap) {
+        return SENSOR_ERROR_PIXFORMAT_UNSUPPORTED;
+    }
+
+    // Set the new control value.
+    sensor.debayer = pixformat;
+
+    // Skip the first frame.
+    MAIN_FB()->pixfmt = PIXFORMAT_INVALID;
+
+    // The frame size changes with the output format.
+    framebuffer_auto_adjust_buffers();
+    return 0;
+}
+
+int sensor_set_dual_output(uint32_t scale) {
+    // Check if the value has changed.
+    if (sensor.dual_scale == scale) {
+        return 0;
+    }
+
+    // Disable any ongoing frame capture.
+    sensor_abort(true, false);
+
+    if (scale && (((sensor.pixformat != PIXFORMAT_GRAYSCALE) && (sensor.pixformat != PIXFORMAT_RGB565)) ||
+                  sensor.transpose || sensor.auto_rotation || (scale < 2) ||
+                  (scale > MAIN_FB()->u) || (scale > MAIN_FB()->v))) {
+        return SENSOR_ERROR_PIXFORMAT_UNSUPPORTED;
+    }
+
+    // Set the new control value.
+    sensor.dual_scale = scale;
+
+    // The decimated copy is stored after the image.
+    framebuffer_auto_adjust_buffers();
+    return 0;
+}
+
 // This is the default snapshot function, which can be replaced in sensor_init functions. This function
 // uses the DCMI and DMA to capture frames and each line is processed in the DCMI_DMAConvCpltUser function.
+// Compresses the head frame for the IDE preview and returns its buffer to the FIFO.
+static void sensor_release_head_buffer() {
+    framebuffer_update_jpeg_buffer();
+    framebuffer_free_current_buffer();
+}
+
 int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
     uint32_t length = 0;
 
+    // With more than one vbuffer the DMA never writes to the head buffer. So, the next frame
+    // capture can be started first and the current frame compressed while it's being captured.
+    bool overlap_jpeg = MAIN_FB()->n_buffers > 1;
+
     // Compress the framebuffer for the IDE preview, only if it's not the first frame,
     // the framebuffer is enabled and the image sensor does not support JPEG encoding.
     // Note: This doesn't run unless the IDE is connected and the framebuffer is enabled.
-    framebuffer_update_jpeg_buffer();
+    if (!overlap_jpeg) {
+        framebuffer_update_jpeg_buffer();
+    }
 
     // Make sure the raw frame fits into the FB. It will be switched from RGB565 to BAYER
     // first to save space before being cropped until it fits.
@@ -667,14 +963,21 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
     // The user may have changed the MAIN_FB width or height on the last image so we need
     // to restore that here. We don't have to restore bpp because that's taken care of
     // already in the code below. Note that we do the JPEG compression above first to save
-    // the FB of whatever the user set it to and now we restore.
+    // the FB of whatever the user set it to and now we restore. When the compression is
+    // deferred this still holds: if the auto crop has to change the pixformat or window, the
+    // setters compress the frame first and then invalidate it, leaving nothing to compress
+    // later. They may also reallocate the vbuffers, so the overlap is only kept if there's
+    // still more than one.
+    overlap_jpeg = overlap_jpeg && (MAIN_FB()->n_buffers > 1);
     uint32_t w = MAIN_FB()->u;
     uint32_t h = MAIN_FB()->v;
 
     // If DCMI_DMAConvCpltUser() happens before framebuffer_free_current_buffer(); below then the
     // transfer is stopped and it will be re-enabled again right afterwards in the single vbuffer
     // case. We know the transfer was stopped by checking DCMI_CR_ENABLE.
-    framebuffer_free_current_buffer();
+    if (!overlap_jpeg) {
+        framebuffer_free_current_buffer();
+    }
 
     // We can be in one of the following two states:
     // 1. No ongoing transfer, and DCMI_CR_ENABLE is cleared.
@@ -695,11 +998,14 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
 
         // Error out if the pixformat is not set.
         if (!bytes_per_pixel) {
+            if (overlap_jpeg) {
+                sensor_release_head_buffer();
+            }
             return SENSOR_ERROR_INVALID_PIXFORMAT;
         }
 
         uint32_t x_crop = get_dcmi_hw_crop(bytes_per_pixel);
-        uint32_t dma_line_width_bytes = resolution[sensor->framesize][0] * bytes_per_pixel;
+        uint32_t dma_line_width_bytes = sensor_get_src_width() * bytes_per_pixel;
 
         // Shrink the captured pixel count by one word to allow cropping to fix alignment.
         if (x_crop) {
@@ -714,6 +1020,9 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
             || (dma_line_width_bytes > (OMV_LINE_BUF_SIZE / 2))
             || (!length)
             || (length % DMA_LENGTH_ALIGNMENT)) {
+            if (overlap_jpeg) {
+                sensor_release_head_buffer();
+            }
             return SENSOR_ERROR_INVALID_FRAMESIZE;
         }
 
@@ -721,6 +1030,9 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
         vbuffer_t *buffer = framebuffer_get_tail(FB_PEEK);
 
         if ((sensor->pixformat == PIXFORMAT_JPEG) && (sensor->chip_id == OV2640_ID) && (!buffer)) {
+            if (overlap_jpeg) {
+                sensor_release_head_buffer();
+            }
             return SENSOR_ERROR_FRAMEBUFFER_ERROR;
         }
 
@@ -732,7 +1044,7 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
             HAL_MDMA_Init(&DCMI_MDMA_Handle0);
 
             // If we are not transposing the image we can fully offload image capture from the CPU.
-            if (!sensor->transpose) {
+            if (mdma_full_offload(sensor)) {
                 // MDMA will trigger on each TC from DMA and transfer one line to the frame buffer.
                 DCMI_MDMA_Handle1.Init.Request = MDMA_REQUEST_DMA2_Stream1_TC;
                 DCMI_MDMA_Handle1.Init.TransferTriggerMode = MDMA_BLOCK_TRANSFER;
@@ -749,8 +1061,11 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
 
         HAL_DCMI_DisableCrop(&DCMIHandle);
         if (sensor->pixformat != PIXFORMAT_JPEG) {
-            // Vertically crop the image. Horizontal cropping is done in software.
-            HAL_DCMI_ConfigCrop(&DCMIHandle, x_crop, MAIN_FB()->y, dma_line_width_bytes - 1, h - 1);
+            // Vertically crop the image. Horizontal cropping is done in software. The crop window
+            // counts pixel clocks, which is two per captured byte when byte select is enabled.
+            uint32_t pclks_per_byte = sensor->byte_select ? 2 : 1;
+            HAL_DCMI_ConfigCrop(&DCMIHandle, x_crop * pclks_per_byte, sensor_get_src_y(),
+                                (dma_line_width_bytes * pclks_per_byte) - 1, h - 1);
             HAL_DCMI_EnableCrop(&DCMIHandle);
         }
 
@@ -791,7 +1106,7 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
             }
         #if defined(OMV_MDMA_CHANNEL_DCMI_0)
             // Special transfer mode with MDMA that completely offloads the line capture load.
-        } else if ((sensor->pixformat != PIXFORMAT_JPEG) && (!sensor->transpose)) {
+        } else if ((sensor->pixformat != PIXFORMAT_JPEG) && mdma_full_offload(sensor)) {
             // DMA to circular mode writing the same line over and over again.
             ((DMA_Stream_TypeDef *) DMAHandle.Instance)->CR |= DMA_SxCR_CIRC;
             // DCMI will transfer to same line and MDMA will move to final location.
@@ -808,9 +1123,15 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
         }
     }
 
-    // Let the camera know we want to trigger it now.
+    // Let the camera know we want to trigger it now, unless the trigger pin does it. The master
+    // pulse also triggers the other cameras.
     #if defined(OMV_CSI_FSYNC_PIN)
-    if (sensor->hw_flags.fsync) {
+    if (sensor->hw_flags.fsync && ((!sensor->trigger) || sensor->trigger_master)) {
+        if (sensor->trigger_master) {
+            sensor->sync_seq += 1;
+            sensor->trigger_us = mp_hal_ticks_us();
+            sensor->triggered = true;
+        }
         omv_gpio_write(OMV_CSI_FSYNC_PIN, 1);
     }
     #endif
@@ -825,12 +1146,29 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
         __HAL_DCMI_ENABLE_IT(&DCMIHandle, DCMI_IT_FRAME);
     }
 
+    // Capture is running now, compress the previous frame for the IDE while DMA fills the next
+    // vbuffer and only then return the head buffer to the FIFO. Every return above this point
+    // must do the same or the head buffer is never returned.
+    if (overlap_jpeg) {
+        sensor_release_head_buffer();
+    }
+
     vbuffer_t *buffer = NULL;
+    uint32_t wait_start_us = mp_hal_ticks_us();
     // Wait for the frame data. __WFI() below will exit right on time because of DCMI_IT_FRAME.
     // While waiting SysTick will trigger allowing us to timeout.
     for (uint32_t tick_start = HAL_GetTick(); !(buffer = framebuffer_get_head(FB_NO_FLAGS)); ) {
+        // Run queued background jobs before sleeping.
+        omv_job_run();
         __WFI();
 
+        // In trigger mode the timeout starts with the trigger.
+        if (sensor->trigger && (!sensor->triggered)) {
+            tick_start = HAL_GetTick();
+            MICROPY_EVENT_POLL_HOOK
+            continue;
+        }
+
         // If we haven't exited this loop before the timeout then we need to abort the transfer.
         if ((HAL_GetTick() - tick_start) > SENSOR_TIMEOUT_MS) {
             sensor_abort(true, false);
@@ -841,6 +1179,7 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
             }
             #endif
 
+            sensor->triggered = false;
             return SENSOR_ERROR_CAPTURE_TIMEOUT;
         }
     }
@@ -864,6 +1203,10 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
         return SENSOR_ERROR_JPEG_OVERFLOW;
     }
 
+    // Exposure and gain are read back over I2C, so they are only sampled every
+    // SENSOR_INFO_MS in thread mode and attached to the frames received after that.
+    sensor_sample_exposure(sensor);
+
     // Prepare the frame buffer w/h/bpp values given the image type.
 
     if (!sensor->transpose) {
@@ -883,11 +1226,28 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
             MAIN_FB()->pixfmt = PIXFORMAT_RGB565;
             break;
         case PIXFORMAT_BAYER:
+            if (sensor->debayer) {
+                MAIN_FB()->pixfmt = sensor->debayer;
+                break;
+            }
             MAIN_FB()->pixfmt = PIXFORMAT_BAYER;
             MAIN_FB()->subfmt_id = sensor->hw_flags.bayer;
             MAIN_FB()->pixfmt = imlib_bayer_shift(MAIN_FB()->pixfmt, MAIN_FB()->x, MAIN_FB()->y, sensor->transpose);
             break;
+        case PIXFORMAT_RAW10:
+        case PIXFORMAT_RAW12: {
+            image_t bayer = { .pixfmt = PIXFORMAT_BAYER };
+            bayer.subfmt_id = sensor->hw_flags.bayer;
+            bayer.pixfmt = imlib_bayer_shift(bayer.pixfmt, MAIN_FB()->x, MAIN_FB()->y, false);
+            MAIN_FB()->pixfmt = sensor->pixformat;
+            MAIN_FB()->subfmt_id = bayer.subfmt_id;
+            break;
+        }
         case PIXFORMAT_YUV422: {
+            if (sensor->debayer) {
+                MAIN_FB()->pixfmt = sensor->debayer;
+                break;
+            }
             MAIN_FB()->pixfmt = PIXFORMAT_YUV;
             MAIN_FB()->subfmt_id = sensor->hw_flags.yuv_order;
             MAIN_FB()->pixfmt = imlib_yuv_shift(MAIN_FB()->pixfmt, MAIN_FB()->x);
@@ -911,13 +1271,16 @@ int sensor_snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
             }
             // Clean trailing data after 0xFFD9 at the end of the jpeg byte stream.
             MAIN_FB()->pixfmt = PIXFORMAT_JPEG;
-            MAIN_FB()->size = jpeg_clean_trailing_bytes(size, buffer->data);
+            MAIN_FB()->size = jpeg_clean_trailing_bytes(size, buffer->data, SENSOR_JPEG_EOI_SEARCH);
             break;
         }
         default:
             break;
     }
 
+    // Let the governor scale the CPU clock with the time spent waiting for the frame.
+    cpufreq_governor_update(mp_hal_ticks_us() - wait_start_us);
+
     // Set the user image.
     framebuffer_init_image(image);
     return 0;
@@ -13,6 +13,7 @@
 #include "imlib.h"
 #include "irq.h"
 #include "omv_boardconfig.h"
+#include "omv_cache.h"
 #include "omv_common.h"
 // Define pin objects in this file.
 #define OMV_GPIO_DEFINE_PINS    (1)
@@ -25,55 +26,8 @@ void HAL_MspInit(void) {
     /* Set the system clock */
     SystemClock_Config();
 
-    #if defined(OMV_DMA_REGION_D1_BASE) \
-    || defined(OMV_DMA_REGION_D2_BASE)  \
-    || defined(OMV_DMA_REGION_D3_BASE)
-    __DSB(); __ISB();
-    HAL_MPU_Disable();
-
-    // Configure the MPU attributes to disable caching DMA buffers.
-    MPU_Region_InitTypeDef MPU_InitStruct;
-    MPU_InitStruct.AccessPermission = MPU_REGION_FULL_ACCESS;
-    MPU_InitStruct.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
-    MPU_InitStruct.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
-    MPU_InitStruct.IsShareable = MPU_ACCESS_NOT_SHAREABLE;
-    MPU_InitStruct.TypeExtField = MPU_TEX_LEVEL1;
-    MPU_InitStruct.SubRegionDisable = 0x00;
-    MPU_InitStruct.DisableExec = MPU_INSTRUCTION_ACCESS_ENABLE;
-
-    // Disable all regions.
-    for (int i = MPU_REGION_NUMBER0; i < MPU_REGION_NUMBER15; i++) {
-        MPU_InitStruct.Number = i;
-        MPU_InitStruct.Enable = MPU_REGION_DISABLE;
-        HAL_MPU_ConfigRegion(&MPU_InitStruct);
-    }
-
-    MPU_InitStruct.Enable = MPU_REGION_ENABLE;
-    #if defined(OMV_DMA_REGION_D1_BASE)
-    MPU_InitStruct.Number = MPU_REGION_NUMBER15;
-    MPU_InitStruct.BaseAddress = OMV_DMA_REGION_D1_BASE;
-    MPU_InitStruct.Size = OMV_DMA_REGION_D1_SIZE;
-    HAL_MPU_ConfigRegion(&MPU_InitStruct);
-    #endif // defined(OMV_DMA_REGION_D1_BASE)
-
-    #if defined(OMV_DMA_REGION_D2_BASE)
-    MPU_InitStruct.Number = MPU_REGION_NUMBER14;
-    MPU_InitStruct.BaseAddress = OMV_DMA_REGION_D2_BASE;
-    MPU_InitStruct.Size = OMV_DMA_REGION_D2_SIZE;
-    HAL_MPU_ConfigRegion(&MPU_InitStruct);
-    #endif // defined(OMV_DMA_REGION_D2_BASE)
-
-    #if defined(OMV_DMA_REGION_D3_BASE)
-    MPU_InitStruct.Number = MPU_REGION_NUMBER13;
-    MPU_InitStruct.BaseAddress = OMV_DMA_REGION_D3_BASE;
-    MPU_InitStruct.Size = OMV_DMA_REGION_D3_SIZE;
-    HAL_MPU_ConfigRegion(&MPU_InitStruct);
-    #endif // defined(OMV_DMA_REGION_D3_BASE)
-
-    // Enable the MPU.
-    HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
-    __DSB(); __ISB();
-    #endif // defined(OMV_DMA_REGION_D1_BASE || OMV_DMA_REGION_D2_BASE || OMV_DMA_REGION_D3_BASE)
+    // Configure the MPU regions and their cache policies.
+    omv_cache_mpu_init();
 
     // Enable I/D cache.
     #if defined(MCU_SERIES_F7) || defined(MCU_SERIES_H7)
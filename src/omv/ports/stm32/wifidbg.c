@@ -47,6 +47,16 @@
 
 #define WIFIDBG_SOCKET_TIMEOUT(x)    (x == -ETIMEDOUT || x == SOCK_ERR_TIMEOUT)
 
+#define WIFIDBG_MJPEG_CLIENTS        (2)
+#define WIFIDBG_MJPEG_BOUNDARY       "openmv"
+#define WIFIDBG_MJPEG_RESPONSE       "HTTP/1.0 200 OK\r\n" \
+                                     "Cache-Control: no-cache\r\n" \
+                                     "Content-Type: multipart/x-mixed-replace; boundary=" WIFIDBG_MJPEG_BOUNDARY "\r\n\r\n"
+#define WIFIDBG_MJPEG_PART           "--" WIFIDBG_MJPEG_BOUNDARY "\r\n" \
+                                     "Content-Type: image/jpeg\r\n" \
+                                     "Content-Length: %ld\r\n\r\n"
+#define WIFIDBG_MJPEG_PART_SIZE      (sizeof(WIFIDBG_MJPEG_PART) + 10)
+
 typedef struct wifidbg {
     int client_fd;
     int server_fd;
@@ -56,6 +66,9 @@ typedef struct wifidbg {
     uint8_t ipaddr[WINC_IPV4_ADDR_LEN];
     char bcast_packet[WIFIDBG_BCAST_STRING_SIZE];
     winc_socket_buf_t sockbuf;
+    uint16_t mjpeg_port;
+    int mjpeg_fd;
+    int mjpeg_client_fd[WIFIDBG_MJPEG_CLIENTS];
 } wifidbg_t;
 
 static wifidbg_t wifidbg;
@@ -81,6 +94,126 @@ int wifidbg_broadcast(wifidbg_t *wifidbg) {
     return 0;
 }
 
+static void wifidbg_mjpeg_close_client(wifidbg_t *wifidbg, int i) {
+    winc_socket_close(wifidbg->mjpeg_client_fd[i]);
+    wifidbg->mjpeg_client_fd[i] = -1;
+
+    for (int j = 0; j < WIFIDBG_MJPEG_CLIENTS; j++) {
+        if (wifidbg->mjpeg_client_fd[j] >= 0) {
+            return;
+        }
+    }
+
+    // Stop encoding frames when nobody is watching (unless the IDE is connected).
+    if (wifidbg->client_fd < 0) {
+        JPEG_FB()->enabled = 0;
+    }
+}
+
+// Streams the JPEG frame buffer to HTTP clients as multipart/x-mixed-replace. Each frame is
+// encoded once by the frame buffer update and sent to every client, the frame itself with a
+// single send which the driver splits into the largest packets the module accepts. Frames are
+// only streamed while the IDE isn't connected, since reading a frame releases it.
+static void wifidbg_mjpeg_dispatch(wifidbg_t *wifidbg) {
+    int ret;
+
+    if (!wifidbg->mjpeg_port) {
+        return;
+    }
+
+    if (wifidbg->mjpeg_fd < 0) {
+        MAKE_SOCKADDR(mjpeg_sockaddr, wifidbg->ipaddr, wifidbg->mjpeg_port);
+
+        if ((wifidbg->mjpeg_fd = winc_socket_socket(SOCK_STREAM)) < 0) {
+            goto exit_mjpeg_error;
+        }
+
+        if ((ret = winc_socket_bind(wifidbg->mjpeg_fd, &mjpeg_sockaddr)) < 0) {
+            goto exit_mjpeg_error;
+        }
+
+        if ((ret = winc_socket_listen(wifidbg->mjpeg_fd, WIFIDBG_MJPEG_CLIENTS)) < 0) {
+            goto exit_mjpeg_error;
+        }
+    }
+
+    bool streaming = false;
+
+    for (int i = 0; i < WIFIDBG_MJPEG_CLIENTS; i++) {
+        if (wifidbg->mjpeg_client_fd[i] >= 0) {
+            streaming = true;
+            continue;
+        }
+
+        // The request itself is not parsed, any request gets the stream.
+        sockaddr client_sockaddr;
+        ret = winc_socket_accept(wifidbg->mjpeg_fd, &client_sockaddr, &wifidbg->mjpeg_client_fd[i], 1);
+        if (WIFIDBG_SOCKET_TIMEOUT(ret)) {
+            wifidbg->mjpeg_client_fd[i] = -1;
+            break;
+        } else if (ret < 0) {
+            goto exit_mjpeg_error;
+        }
+
+        if (winc_socket_send(wifidbg->mjpeg_client_fd[i], (uint8_t *) WIFIDBG_MJPEG_RESPONSE,
+                             sizeof(WIFIDBG_MJPEG_RESPONSE) - 1, 500) < 0) {
+            wifidbg_mjpeg_close_client(wifidbg, i);
+            continue;
+        }
+
+        if (wifidbg->client_fd < 0) {
+            // Whole JPEG frames, not delta packets.
+            JPEG_FB()->delta_tile = 0;
+            JPEG_FB()->enabled = 1;
+        }
+
+        // The new client needs a whole frame even if it's unchanged.
+        JPEG_FB()->delta_valid = 0;
+        streaming = true;
+        break;
+    }
+
+    if ((!streaming) || (wifidbg->client_fd >= 0)) {
+        return;
+    }
+
+    jpegbuffer_slot_t *slot = framebuffer_jpeg_read_begin();
+
+    if (!slot) {
+        return;
+    }
+
+    int32_t size = slot->size;
+
+    // Skip anything but a JPEG (e.g. PNG frames).
+    if ((size > 2) && (slot->pixels[0] == 0xFF) && (slot->pixels[1] == 0xD8)) {
+        char part[WIFIDBG_MJPEG_PART_SIZE];
+        int part_len = snprintf(part, sizeof(part), WIFIDBG_MJPEG_PART, (long) size);
+
+        for (int i = 0; i < WIFIDBG_MJPEG_CLIENTS; i++) {
+            int fd = wifidbg->mjpeg_client_fd[i];
+            if ((fd >= 0) &&
+                ((winc_socket_send(fd, (uint8_t *) part, part_len, 500) < 0) ||
+                 (winc_socket_send(fd, slot->pixels, size, 500) < 0) ||
+                 (winc_socket_send(fd, (uint8_t *) "\r\n", 2, 500) < 0))) {
+                wifidbg_mjpeg_close_client(wifidbg, i);
+            }
+        }
+    }
+
+    framebuffer_jpeg_read_end();
+    return;
+
+exit_mjpeg_error:
+    for (int i = 0; i < WIFIDBG_MJPEG_CLIENTS; i++) {
+        if (wifidbg->mjpeg_client_fd[i] >= 0) {
+            wifidbg_mjpeg_close_client(wifidbg, i);
+        }
+    }
+    winc_socket_close(wifidbg->mjpeg_fd);
+    wifidbg->mjpeg_fd = -1;
+}
+
 void wifidbg_pendsv_callback(void) {
     int ret = 0;
     uint32_t request = 0;
@@ -175,6 +308,8 @@ void wifidbg_pendsv_callback(void) {
 exit_dispatch_error:
     wifidbg_close_sockets(&wifidbg);
 exit_dispatch:
+    wifidbg_mjpeg_dispatch(&wifidbg);
+
     if (usbdbg_get_irq_enabled()) {
         // Re-enable Systick dispatch if IDE interrupts are still enabled.
         wifidbg_set_irq_enabled(true);
@@ -196,6 +331,11 @@ int wifidbg_init(wifidbg_config_t *config) {
     wifidbg.client_fd = -1;
     wifidbg.server_fd = -1;
     wifidbg.bcast_fd = -1;
+    wifidbg.mjpeg_port = config->mjpeg_port;
+    wifidbg.mjpeg_fd = -1;
+    for (int i = 0; i < WIFIDBG_MJPEG_CLIENTS; i++) {
+        wifidbg.mjpeg_client_fd[i] = -1;
+    }
 
     if (!config->mode) {
         // STA Mode
@@ -19,6 +19,7 @@ typedef struct wifidbg_config {
     char client_ssid[WINC_MAX_SSID_LEN + 1], access_point_ssid[WINC_MAX_SSID_LEN + 1];
     uint8_t client_channel, access_point_channel;
     char board_name[WINC_MAX_BOARD_NAME_LEN + 1];
+    uint16_t mjpeg_port;    // MJPEG over HTTP server port, 0 to disable.
 } wifidbg_config_t;
 
 void wifidbg_dispatch();
@@ -0,0 +1,400 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Host imlib benchmarks.
+ *
+ * Runs the same kernels as scripts/unittest/benchmark on every resolution and pixel format
+ * they support, the source image is scaled into a new image before every iteration. Prints
+ * the average ms/iteration, the fb_alloc high-water mark and the heap high-water mark, or
+ * with -j one JSON object per line in the format of the on-device benchmarks.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "py/runtime.h"
+#include "py/mphal.h"
+#include "py/gc.h"
+#include "imlib.h"
+#include "omv_common.h"
+
+#define BENCH_QQVGA         (1 << 0)
+#define BENCH_QVGA          (1 << 1)
+#define BENCH_VGA           (1 << 2)
+#define BENCH_RESOLUTIONS   (BENCH_QQVGA | BENCH_QVGA | BENCH_VGA)
+#define BENCH_GRAYSCALE     (1 << 0)
+#define BENCH_RGB565        (1 << 1)
+#define BENCH_PIXFORMATS    (BENCH_GRAYSCALE | BENCH_RGB565)
+
+typedef struct {
+    const char *name;
+    int w, h;
+} bench_resolution_t;
+
+typedef struct {
+    const char *name;
+    pixformat_t pixfmt;
+} bench_pixformat_t;
+
+// Each run gets the scaled image and the images made by setup(), which are freed after.
+typedef struct bench_args {
+    image_t *img;
+    image_t aux[2];
+} bench_args_t;
+
+typedef struct bench {
+    const char *name;
+    const char *source;
+    uint32_t resolutions;
+    uint32_t pixformats;
+    void (*setup) (bench_args_t *args);
+    void (*run) (bench_args_t *args);
+} bench_t;
+
+static const bench_resolution_t bench_resolutions[] = {
+    { "QQVGA", 160, 120 },
+    { "QVGA", 320, 240 },
+    { "VGA", 640, 480 },
+};
+
+static const bench_pixformat_t bench_pixformats[] = {
+    { "GRAYSCALE", PIXFORMAT_GRAYSCALE },
+    { "RGB565", PIXFORMAT_RGB565 },
+};
+
+static void bench_mean(bench_args_t *args) {
+    imlib_mean_filter(args->img, 1, false, 0, false, NULL);
+}
+
+static void bench_gaussian(bench_args_t *args) {
+    imlib_gaussian_filter(args->img, 1, false, 0, false);
+}
+
+static void bench_median(bench_args_t *args) {
+    imlib_median_filter(args->img, 1, 0.5f, false, 0, false, NULL);
+}
+
+static void bench_erode(bench_args_t *args) {
+    imlib_erode(args->img, 1, 0, NULL);
+}
+
+static void bench_dilate(bench_args_t *args) {
+    imlib_dilate(args->img, 1, 0, NULL);
+}
+
+static void bench_find_blobs(bench_args_t *args) {
+    static const color_thresholds_list_lnk_data_t colors[] = {
+        { 0, 100, 56, 95, 41, 74 },     // generic_red_thresholds
+        { 0, 100, -128, -22, -128, 99 },// generic_green_thresholds
+        { 0, 100, -128, 98, -128, -16 } // generic_blue_thresholds
+    };
+
+    list_t thresholds, out;
+    list_init(&thresholds, sizeof(color_thresholds_list_lnk_data_t));
+    for (int i = 0; i < OMV_ARRAY_SIZE(colors); i++) {
+        list_push_back(&thresholds, (void *) &colors[i]);
+    }
+
+    rectangle_t roi = { 0, 0, args->img->w, args->img->h };
+    pool_t pool;
+    fb_alloc_mark();
+    list_pool_alloc(&pool, sizeof(find_blobs_list_lnk_data_t));
+    imlib_find_blobs(&out, args->img, &roi, 2, 1, &thresholds, false, 200, 200, false, 0,
+                     NULL, NULL, NULL, NULL, 0, 0, FIND_BLOBS_PROP_ALL, &pool);
+    list_free(&out);
+    fb_alloc_free_till_mark();
+    list_free(&thresholds);
+}
+
+static void bench_find_apriltags(bench_args_t *args) {
+    image_t *img = args->img;
+    rectangle_t roi = { 0, 0, img->w, img->h };
+    list_t out;
+    pool_t pool;
+    fb_alloc_mark();
+    list_pool_alloc(&pool, sizeof(find_apriltags_list_lnk_data_t));
+    imlib_find_apriltags(&out, img, &roi, TAG36H11, (2.8f / 3.984f) * img->w, (2.8f / 2.952f) * img->h,
+                         img->w * 0.5f, img->h * 0.5f, 1, 0.0f, true, false, &pool, NULL, 0);
+    list_free(&out);
+    fb_alloc_free_till_mark();
+}
+
+static void bench_find_qrcodes(bench_args_t *args) {
+    rectangle_t roi = { 0, 0, args->img->w, args->img->h };
+    list_t out;
+    imlib_find_qrcodes(&out, args->img, &roi);
+    while (list_size(&out)) {
+        find_qrcodes_list_lnk_data_t lnk_data;
+        list_pop_front(&out, &lnk_data);
+        xfree(lnk_data.payload);
+    }
+}
+
+// The JPEG buffer is allocated up front (and grown if needed) instead of taking all of fb_alloc.
+static void bench_jpeg_setup(bench_args_t *args) {
+    image_t *jpg = &args->aux[0];
+    image_init(jpg, args->img->w, args->img->h, PIXFORMAT_JPEG, image_size(args->img), NULL);
+    jpg->data = xalloc(jpg->size);
+}
+
+static void bench_jpeg_encode(bench_args_t *args) {
+    jpeg_compress(args->img, &args->aux[0], 90, true, JPEG_SUBSAMPLING_AUTO);
+}
+
+static void bench_jpeg_decode_setup(bench_args_t *args) {
+    bench_jpeg_setup(args);
+    bench_jpeg_encode(args);
+
+    image_t *dst = &args->aux[1];
+    image_init(dst, args->img->w, args->img->h, PIXFORMAT_RGB565, 0, NULL);
+    dst->data = xalloc(image_size(dst));
+}
+
+static void bench_jpeg_decode(bench_args_t *args) {
+    jpeg_decompress(&args->aux[1], &args->aux[0]);
+}
+
+static void bench_draw_image_setup(bench_args_t *args) {
+    image_t *small = &args->aux[0];
+    image_init(small, args->img->w / 2, args->img->h / 2, args->img->pixfmt, 0, NULL);
+    small->data = xalloc(image_size(small));
+    imlib_draw_image(small, args->img, 0, 0, 0.5f, 0.5f, NULL, -1, 256, NULL, NULL, 0, NULL, NULL, NULL);
+}
+
+static void bench_draw_image(bench_args_t *args) {
+    imlib_draw_image(args->img, &args->aux[0], 0, 0, 2.0f, 2.0f, NULL, -1, 256, NULL, NULL,
+                     IMAGE_HINT_BILINEAR, NULL, NULL, NULL);
+}
+
+static void bench_histeq(bench_args_t *args) {
+    imlib_histeq(args->img, NULL);
+}
+
+static void bench_lens_corr(bench_args_t *args) {
+    imlib_lens_corr(args->img, 1.8f, 1.0f, 0.0f, 0.0f);
+}
+
+static void bench_find_lines(bench_args_t *args) {
+    rectangle_t roi = { 0, 0, args->img->w, args->img->h };
+    list_t out;
+    pool_t pool;
+    fb_alloc_mark();
+    list_pool_alloc(&pool, sizeof(find_lines_list_lnk_data_t));
+    imlib_find_lines(&out, args->img, &roi, 2, 1, 1000, 25, 25, &pool);
+    list_free(&out);
+    fb_alloc_free_till_mark();
+}
+
+// Keep the names in sync with scripts/unittest/benchmark so the results can be compared.
+static const bench_t benchmarks[] = {
+    { "00-mean", "blobs.ppm", BENCH_RESOLUTIONS, BENCH_PIXFORMATS, NULL, bench_mean },
+    { "01-gaussian", "blobs.ppm", BENCH_RESOLUTIONS, BENCH_PIXFORMATS, NULL, bench_gaussian },
+    { "02-median", "blobs.ppm", BENCH_RESOLUTIONS, BENCH_PIXFORMATS, NULL, bench_median },
+    { "03-erode", "blobs.ppm", BENCH_RESOLUTIONS, BENCH_PIXFORMATS, NULL, bench_erode },
+    { "04-dilate", "blobs.ppm", BENCH_RESOLUTIONS, BENCH_PIXFORMATS, NULL, bench_dilate },
+    { "05-find_blobs", "blobs.ppm", BENCH_RESOLUTIONS, BENCH_PIXFORMATS, NULL, bench_find_blobs },
+    { "06-find_apriltags", "apriltags.pgm", BENCH_QQVGA | BENCH_QVGA, BENCH_GRAYSCALE, NULL, bench_find_apriltags },
+    { "07-find_qrcodes", "qrcode.pgm", BENCH_RESOLUTIONS, BENCH_GRAYSCALE, NULL, bench_find_qrcodes },
+    { "08-jpeg_encode", "blobs.ppm", BENCH_RESOLUTIONS, BENCH_PIXFORMATS, bench_jpeg_setup, bench_jpeg_encode },
+    { "09-jpeg_decode", "blobs.ppm", BENCH_RESOLUTIONS, BENCH_PIXFORMATS, bench_jpeg_decode_setup, bench_jpeg_decode },
+    { "10-draw_image", "blobs.ppm", BENCH_RESOLUTIONS, BENCH_PIXFORMATS, bench_draw_image_setup, bench_draw_image },
+    { "11-histeq", "blobs.ppm", BENCH_RESOLUTIONS, BENCH_PIXFORMATS, NULL, bench_histeq },
+    { "12-lens_corr", "blobs.ppm", BENCH_RESOLUTIONS, BENCH_PIXFORMATS, NULL, bench_lens_corr },
+    { "13-find_lines", "shapes.ppm", BENCH_RESOLUTIONS, BENCH_PIXFORMATS, NULL, bench_find_lines },
+};
+
+typedef struct {
+    const char *data_dir;
+    const char *filter;
+    int iterations;
+    bool json;
+    bool tags;
+} bench_options_t;
+
+typedef struct {
+    const char *status;
+    const char *error;
+    double ms;
+    uint32_t fb_alloc_peak;
+    size_t heap_peak;
+} bench_result_t;
+
+static void bench_free_args(bench_args_t *args) {
+    for (int i = 0; i < OMV_ARRAY_SIZE(args->aux); i++) {
+        xfree(args->aux[i].data);
+        args->aux[i].data = NULL;
+    }
+    if (args->img) {
+        xfree(args->img->data);
+        args->img->data = NULL;
+    }
+}
+
+static void bench_print_tags() {
+    #if OMV_FB_ALLOC_TAGS_ENABLE
+    const fb_alloc_tag_t *tags;
+    int n = fb_alloc_get_tags(&tags, true);
+    for (int i = 0; i < n; i++) {
+        // Use addr2line -f -e build/imlib_bench <tag> to find the call site.
+        printf("    fb_alloc %p %10u bytes\n", tags[i].tag, (unsigned) tags[i].size);
+    }
+    #endif
+}
+
+static void bench_run(const bench_t *bench, const bench_resolution_t *res, const bench_pixformat_t *fmt,
+                      image_t *src, const bench_options_t *opts, bench_result_t *result) {
+    image_t img = { 0 };
+    bench_args_t args = { .img = &img };
+    uint64_t total_us = 0;
+    nlr_buf_t nlr;
+
+    result->status = "PASSED";
+    result->error = NULL;
+    result->fb_alloc_peak = 0;
+    result->heap_peak = 0;
+
+    if (nlr_push(&nlr) == 0) {
+        for (int i = 0; i < opts->iterations; i++) {
+            image_init(&img, res->w, res->h, fmt->pixfmt, 0, NULL);
+            img.data = xalloc(image_size(&img));
+            imlib_draw_image(&img, src, 0, 0, res->w / (float) src->w, res->h / (float) src->h,
+                             NULL, -1, 256, NULL, NULL, 0, NULL, NULL, NULL);
+
+            memset(args.aux, 0, sizeof(args.aux));
+            if (bench->setup) {
+                bench->setup(&args);
+            }
+
+            fb_alloc_reset_peak();
+            size_t heap_used = gc_used();
+            gc_reset_peak();
+
+            mp_uint_t start = mp_hal_ticks_us();
+            bench->run(&args);
+            total_us += mp_hal_ticks_us() - start;
+
+            result->fb_alloc_peak = IM_MAX(result->fb_alloc_peak, fb_alloc_peak());
+            result->heap_peak = IM_MAX(result->heap_peak, gc_peak() - heap_used);
+            bench_free_args(&args);
+        }
+        nlr_pop();
+        result->ms = total_us / (opts->iterations * 1000.0);
+    } else {
+        mp_obj_exception_t *e = nlr.ret_val;
+        result->status = "SKIPPED";
+        result->error = e->msg;
+        fb_alloc_init0();
+        bench_free_args(&args);
+    }
+}
+
+static void bench_print(const bench_t *bench, const bench_resolution_t *res, const bench_pixformat_t *fmt,
+                        const bench_options_t *opts, const bench_result_t *result) {
+    bool passed = !result->error;
+
+    if (opts->json) {
+        printf("{\"board\": \"%s\", \"firmware\": \"host\", \"test\": \"%s\", \"resolution\": \"%s\", "
+               "\"pixformat\": \"%s\", \"status\": \"%s\"", OMV_BOARD_TYPE, bench->name, res->name, fmt->name,
+               result->status);
+        if (passed) {
+            printf(", \"ms\": %.3f, \"fb_alloc_peak\": %u, \"heap_peak\": %zu}\n",
+                   result->ms, (unsigned) result->fb_alloc_peak, result->heap_peak);
+        } else {
+            printf(", \"error\": \"%s\"}\n", result->error);
+        }
+    } else if (passed) {
+        printf("%-24s %-6s %-10s %-8s %10.3f ms %10u bytes %10zu bytes\n", bench->name, res->name, fmt->name,
+               result->status, result->ms, (unsigned) result->fb_alloc_peak, result->heap_peak);
+    } else {
+        printf("%-24s %-6s %-10s %-8s %s\n", bench->name, res->name, fmt->name, result->status, result->error);
+    }
+
+    if (opts->tags && passed) {
+        bench_print_tags();
+    }
+}
+
+static void bench_usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-d data_dir] [-n iterations] [-f filter] [-j] [-t]\n"
+            "  -d  directory with the unit test images (default: scripts/unittest/data)\n"
+            "  -n  iterations per benchmark (default: 10)\n"
+            "  -f  only run the benchmarks whose name contains filter\n"
+            "  -j  print one JSON object per line, like the on-device benchmarks\n"
+            "  -t  print the fb_alloc blocks live at the high-water mark\n", prog);
+}
+
+int main(int argc, char **argv) {
+    bench_options_t opts = { "scripts/unittest/data", NULL, 10, false, false };
+
+    for (int c; (c = getopt(argc, argv, "d:n:f:jth")) != -1;) {
+        switch (c) {
+            case 'd':
+                opts.data_dir = optarg;
+                break;
+            case 'n':
+                opts.iterations = IM_MAX(atoi(optarg), 1);
+                break;
+            case 'f':
+                opts.filter = optarg;
+                break;
+            case 'j':
+                opts.json = true;
+                break;
+            case 't':
+                opts.tags = true;
+                break;
+            default:
+                bench_usage(argv[0]);
+                return (c == 'h') ? 0 : 1;
+        }
+    }
+
+    fb_alloc_init0();
+    int failed = 0;
+
+    if (!opts.json) {
+        printf("%-24s %-6s %-10s %-8s %13s %16s %16s\n", "test", "res", "pixformat", "status",
+               "time", "fb_alloc_peak", "heap_peak");
+    }
+
+    for (int b = 0; b < OMV_ARRAY_SIZE(benchmarks); b++) {
+        const bench_t *bench = &benchmarks[b];
+        if (opts.filter && !strstr(bench->name, opts.filter)) {
+            continue;
+        }
+
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", opts.data_dir, bench->source);
+
+        image_t src = { 0 };
+        nlr_buf_t nlr;
+        if (nlr_push(&nlr) == 0) {
+            imlib_load_image(&src, path);
+            nlr_pop();
+        } else {
+            fprintf(stderr, "%s: %s\n", path, ((mp_obj_exception_t *) nlr.ret_val)->msg);
+            return 1;
+        }
+
+        for (int r = 0; r < OMV_ARRAY_SIZE(bench_resolutions); r++) {
+            for (int p = 0; p < OMV_ARRAY_SIZE(bench_pixformats); p++) {
+                if ((bench->resolutions & (1 << r)) && (bench->pixformats & (1 << p))) {
+                    bench_result_t result;
+                    bench_run(bench, &bench_resolutions[r], &bench_pixformats[p], &src, &opts, &result);
+                    bench_print(bench, &bench_resolutions[r], &bench_pixformats[p], &opts, &result);
+                    failed += !!result.error;
+                }
+            }
+        }
+
+        xfree(src.data);
+    }
+
+    return failed ? 1 : 0;
+}
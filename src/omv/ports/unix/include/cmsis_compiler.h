@@ -0,0 +1,140 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * CMSIS compiler definitions for the host build.
+ *
+ * Replaces CMSIS's cmsis_compiler.h with portable C versions of the core intrinsics imlib
+ * uses outside of ARM_MATH_DSP code (which isn't built on the host).
+ */
+#ifndef __CMSIS_COMPILER_H
+#define __CMSIS_COMPILER_H
+#include <stdint.h>
+#include <string.h>
+
+#ifndef __ASM
+#define __ASM                        __asm
+#endif
+#ifndef __INLINE
+#define __INLINE                     inline
+#endif
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE              static inline
+#endif
+#ifndef __STATIC_FORCEINLINE
+#define __STATIC_FORCEINLINE         __attribute__((always_inline)) static inline
+#endif
+#ifndef __NO_RETURN
+#define __NO_RETURN                  __attribute__((__noreturn__))
+#endif
+#ifndef __USED
+#define __USED                       __attribute__((used))
+#endif
+#ifndef __WEAK
+#define __WEAK                       __attribute__((weak))
+#endif
+#ifndef __PACKED
+#define __PACKED                     __attribute__((packed, aligned(1)))
+#endif
+#ifndef __PACKED_STRUCT
+#define __PACKED_STRUCT              struct __attribute__((packed, aligned(1)))
+#endif
+#ifndef __ALIGNED
+#define __ALIGNED(x)                 __attribute__((aligned(x)))
+#endif
+#ifndef __RESTRICT
+#define __RESTRICT                   __restrict
+#endif
+
+__STATIC_FORCEINLINE uint32_t __UNALIGNED_UINT32_READ(const void *addr) {
+    uint32_t v;
+    memcpy(&v, addr, sizeof(v));
+    return v;
+}
+
+__STATIC_FORCEINLINE void __UNALIGNED_UINT32_WRITE(void *addr, uint32_t val) {
+    memcpy(addr, &val, sizeof(val));
+}
+
+__STATIC_FORCEINLINE uint16_t __UNALIGNED_UINT16_READ(const void *addr) {
+    uint16_t v;
+    memcpy(&v, addr, sizeof(v));
+    return v;
+}
+
+__STATIC_FORCEINLINE void __UNALIGNED_UINT16_WRITE(void *addr, uint16_t val) {
+    memcpy(addr, &val, sizeof(val));
+}
+
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t value) {
+    return __builtin_bswap32(value);
+}
+
+__STATIC_FORCEINLINE uint32_t __REV16(uint32_t value) {
+    return ((value & 0xFF00FF00) >> 8) | ((value & 0x00FF00FF) << 8);
+}
+
+__STATIC_FORCEINLINE int16_t __REVSH(int16_t value) {
+    return (int16_t) __builtin_bswap16(value);
+}
+
+__STATIC_FORCEINLINE uint32_t __ROR(uint32_t op1, uint32_t op2) {
+    op2 %= 32U;
+    return op2 ? ((op1 >> op2) | (op1 << (32U - op2))) : op1;
+}
+
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value) {
+    uint32_t result = 0;
+    for (int i = 0; i < 32; i++, value >>= 1) {
+        result = (result << 1) | (value & 1);
+    }
+    return result;
+}
+
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t value) {
+    return value ? __builtin_clz(value) : 32;
+}
+
+__STATIC_FORCEINLINE int32_t __SSAT(int32_t val, uint32_t sat) {
+    if ((sat >= 1U) && (sat <= 32U)) {
+        const int32_t max = (int32_t) ((1U << (sat - 1U)) - 1U);
+        const int32_t min = -1 - max;
+        if (val > max) {
+            return max;
+        } else if (val < min) {
+            return min;
+        }
+    }
+    return val;
+}
+
+__STATIC_FORCEINLINE uint32_t __USAT(int32_t val, uint32_t sat) {
+    if (sat <= 31U) {
+        const uint32_t max = ((1U << sat) - 1U);
+        if (val > (int32_t) max) {
+            return max;
+        } else if (val < 0) {
+            return 0U;
+        }
+    }
+    return (uint32_t) val;
+}
+
+__STATIC_FORCEINLINE void __NOP(void) {
+}
+
+__STATIC_FORCEINLINE void __DSB(void) {
+    __sync_synchronize();
+}
+
+__STATIC_FORCEINLINE void __DMB(void) {
+    __sync_synchronize();
+}
+
+__STATIC_FORCEINLINE void __ISB(void) {
+}
+#endif // __CMSIS_COMPILER_H
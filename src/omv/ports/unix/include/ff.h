@@ -0,0 +1,62 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * FatFs types for the host build, files are stdio streams.
+ */
+#ifndef __FF_H__
+#define __FF_H__
+#include <stdio.h>
+#include <stdint.h>
+
+typedef char TCHAR;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef unsigned int UINT;
+typedef uint32_t FSIZE_t;
+
+typedef enum {
+    FR_OK = 0,
+    FR_DISK_ERR,
+    FR_INT_ERR,
+    FR_NOT_READY,
+    FR_NO_FILE,
+    FR_NO_PATH,
+    FR_INVALID_NAME,
+    FR_DENIED,
+    FR_EXIST,
+    FR_INVALID_OBJECT,
+} FRESULT;
+
+#define FA_READ             0x01
+#define FA_WRITE            0x02
+#define FA_OPEN_EXISTING    0x00
+#define FA_CREATE_NEW       0x04
+#define FA_CREATE_ALWAYS    0x08
+#define FA_OPEN_ALWAYS      0x10
+#define FA_OPEN_APPEND      0x30
+
+typedef struct {
+    FILE *fp;
+    FSIZE_t size;
+} FIL;
+
+typedef struct {
+    void *dir;
+} FF_DIR;
+
+typedef struct {
+    FSIZE_t fsize;
+    BYTE fattrib;
+    TCHAR fname[256];
+} FILINFO;
+
+#define f_size(fp)    ((fp)->size)
+#define f_tell(fp)    ((FSIZE_t) ftell((fp)->fp))
+#define f_eof(fp)     (f_tell(fp) >= f_size(fp))
+#endif // __FF_H__
@@ -0,0 +1,36 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Board configuration for the host build.
+ */
+#ifndef __OMV_BOARDCONFIG_H__
+#define __OMV_BOARDCONFIG_H__
+
+// Architecture info
+#define OMV_BOARD_ARCH                        "OMV UNIX" // 33 chars max
+#define OMV_BOARD_TYPE                        "UNIX"
+
+// Flags and features
+#define OMV_PROFILE_ENABLE                    (0)
+#define OMV_FB_ALLOC_TAGS_ENABLE              (1)
+
+// JPEG configuration (software codec only).
+#define OMV_JPEG_CODEC_ENABLE                 (0)
+#define OMV_JPEG_QUALITY_LOW                  (50)
+#define OMV_JPEG_QUALITY_HIGH                 (90)
+#define OMV_JPEG_QUALITY_THRESHOLD            (320 * 240 * 2)
+
+#define OMV_UMM_BLOCK_SIZE                    16
+
+// Memory configuration, fb_alloc is carved from the top of the frame buffer memory.
+#define OMV_FB_SIZE                           (4 * 1024 * 1024) // Framebuffer, fb_alloc
+#define OMV_FB_ALLOC_SIZE                     (3 * 1024 * 1024) // minimum fb alloc size
+#define OMV_JPEG_BUF_SIZE                     (32 * 1024) // IDE JPEG buffer (header + data).
+#define OMV_HEAP_SIZE                         (32 * 1024 * 1024) // xalloc heap.
+
+#endif //__OMV_BOARDCONFIG_H__
@@ -0,0 +1,35 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * MicroPython GC shim for the host build, the heap is malloc() with a byte count.
+ */
+#ifndef __PY_GC_H__
+#define __PY_GC_H__
+#include "py/runtime.h"
+
+typedef struct _gc_info_t {
+    size_t total;
+    size_t used;
+    size_t free;
+    size_t max_free;
+    size_t num_1block;
+    size_t num_2block;
+    size_t max_block;
+} gc_info_t;
+
+void *gc_alloc(size_t n_bytes, unsigned int alloc_flags);
+void gc_free(void *ptr);
+void *gc_realloc(void *ptr, size_t n_bytes, bool allow_move);
+void gc_info(gc_info_t *info);
+void gc_collect();
+
+// Bytes allocated now and at the high-water mark.
+size_t gc_used();
+size_t gc_peak();
+void gc_reset_peak();
+#endif // __PY_GC_H__
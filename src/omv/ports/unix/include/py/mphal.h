@@ -0,0 +1,19 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * MicroPython HAL shim for the host build.
+ */
+#ifndef __PY_MPHAL_H__
+#define __PY_MPHAL_H__
+#include "py/runtime.h"
+
+mp_uint_t mp_hal_ticks_ms();
+mp_uint_t mp_hal_ticks_us();
+void mp_hal_delay_ms(mp_uint_t ms);
+void mp_hal_delay_us(mp_uint_t us);
+#endif // __PY_MPHAL_H__
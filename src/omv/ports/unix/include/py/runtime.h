@@ -0,0 +1,65 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * MicroPython runtime shim for the host build.
+ *
+ * Exceptions raised by imlib unwind to the innermost nlr_push() with longjmp().
+ */
+#ifndef __PY_RUNTIME_H__
+#define __PY_RUNTIME_H__
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+#define NORETURN                __attribute__((noreturn))
+#define MP_WEAK                 __attribute__((weak))
+#define STATIC                  static
+#define MP_ERROR_TEXT(s)        (s)
+#define MP_OBJ_TO_PTR(o)        ((void *) (o))
+#define MP_OBJ_FROM_PTR(p)      ((mp_obj_t) (p))
+#define MP_STACK_CHECK()
+
+typedef intptr_t mp_int_t;
+typedef uintptr_t mp_uint_t;
+typedef unsigned int uint;
+typedef void *mp_obj_t;
+
+typedef struct _mp_obj_type_t {
+    const char *name;
+} mp_obj_type_t;
+
+typedef struct _mp_obj_exception_t {
+    const mp_obj_type_t *type;
+    char msg[128];
+} mp_obj_exception_t;
+
+typedef struct _nlr_buf_t {
+    struct _nlr_buf_t *prev;
+    void *ret_val;
+    jmp_buf jmpbuf;
+} nlr_buf_t;
+
+extern const mp_obj_type_t mp_type_Exception;
+extern const mp_obj_type_t mp_type_MemoryError;
+extern const mp_obj_type_t mp_type_OSError;
+extern const mp_obj_type_t mp_type_RuntimeError;
+extern const mp_obj_type_t mp_type_TypeError;
+extern const mp_obj_type_t mp_type_ValueError;
+
+nlr_buf_t **nlr_top();
+#define nlr_push(buf)    ((buf)->prev = *nlr_top(), *nlr_top() = (buf), setjmp((buf)->jmpbuf))
+void nlr_pop();
+NORETURN void nlr_jump(void *val);
+
+mp_obj_t mp_obj_new_exception_msg(const mp_obj_type_t *type, const char *msg);
+NORETURN void mp_raise_msg(const mp_obj_type_t *type, const char *msg);
+NORETURN void mp_raise_msg_varg(const mp_obj_type_t *type, const char *fmt, ...);
+NORETURN void mp_raise_ValueError(const char *msg);
+NORETURN void mp_raise_TypeError(const char *msg);
+#endif // __PY_RUNTIME_H__
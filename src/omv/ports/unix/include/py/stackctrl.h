@@ -0,0 +1,14 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * MicroPython stackctrl.h shim for the host build.
+ */
+#ifndef __PY_STACKCTRL_H__
+#define __PY_STACKCTRL_H__
+#include "py/runtime.h"
+#endif // __PY_STACKCTRL_H__
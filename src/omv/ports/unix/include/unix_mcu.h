@@ -0,0 +1,14 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * MCU header for the host build (CMSIS_MCU_H), there are no peripherals.
+ */
+#ifndef __UNIX_MCU_H__
+#define __UNIX_MCU_H__
+#include "cmsis_compiler.h"
+#endif // __UNIX_MCU_H__
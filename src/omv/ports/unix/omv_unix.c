@@ -0,0 +1,371 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Host runtime for imlib: the MicroPython exception, GC and HAL functions imlib calls, the
+ * fb_alloc memory and the file API over stdio.
+ */
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "py/runtime.h"
+#include "py/mphal.h"
+#include "py/gc.h"
+#include "omv_boardconfig.h"
+#include "omv_common.h"
+#include "file_utils.h"
+#include "fb_alloc.h"
+
+#define STR_(x)    #x
+#define STR(x)     STR_(x)
+
+// fb_alloc grows down from _fballoc, the end of the frame buffer memory.
+char omv_unix_fb_memory[OMV_FB_SIZE] __attribute__((aligned(32)));
+__asm__ (".globl _fballoc\n.set _fballoc, omv_unix_fb_memory + " STR(OMV_FB_SIZE));
+
+char *framebuffer_get_buffers_end() {
+    return omv_unix_fb_memory;
+}
+
+/******************************************************************************/
+// Exceptions
+
+const mp_obj_type_t mp_type_Exception = { "Exception" };
+const mp_obj_type_t mp_type_MemoryError = { "MemoryError" };
+const mp_obj_type_t mp_type_OSError = { "OSError" };
+const mp_obj_type_t mp_type_RuntimeError = { "RuntimeError" };
+const mp_obj_type_t mp_type_TypeError = { "TypeError" };
+const mp_obj_type_t mp_type_ValueError = { "ValueError" };
+
+static nlr_buf_t *nlr_top_buf;
+static mp_obj_exception_t nlr_exception;
+
+nlr_buf_t **nlr_top() {
+    return &nlr_top_buf;
+}
+
+void nlr_pop() {
+    nlr_top_buf = nlr_top_buf->prev;
+}
+
+NORETURN void nlr_jump(void *val) {
+    nlr_buf_t *top = nlr_top_buf;
+
+    if (!top) {
+        mp_obj_exception_t *e = val;
+        fprintf(stderr, "Uncaught %s: %s\n", e->type->name, e->msg);
+        abort();
+    }
+
+    top->ret_val = val;
+    nlr_top_buf = top->prev;
+    longjmp(top->jmpbuf, 1);
+}
+
+// Only one exception is in flight at a time, so it doesn't need to be allocated.
+mp_obj_t mp_obj_new_exception_msg(const mp_obj_type_t *type, const char *msg) {
+    nlr_exception.type = type;
+    snprintf(nlr_exception.msg, sizeof(nlr_exception.msg), "%s", msg);
+    return &nlr_exception;
+}
+
+NORETURN void mp_raise_msg(const mp_obj_type_t *type, const char *msg) {
+    nlr_jump(mp_obj_new_exception_msg(type, msg));
+}
+
+NORETURN void mp_raise_msg_varg(const mp_obj_type_t *type, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    nlr_exception.type = type;
+    vsnprintf(nlr_exception.msg, sizeof(nlr_exception.msg), fmt, args);
+    va_end(args);
+    nlr_jump(&nlr_exception);
+}
+
+NORETURN void mp_raise_ValueError(const char *msg) {
+    mp_raise_msg(&mp_type_ValueError, msg);
+}
+
+NORETURN void mp_raise_TypeError(const char *msg) {
+    mp_raise_msg(&mp_type_TypeError, msg);
+}
+
+/******************************************************************************/
+// HAL
+
+static uint64_t ticks_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+mp_uint_t mp_hal_ticks_ms() {
+    return ticks_ns() / 1000000;
+}
+
+mp_uint_t mp_hal_ticks_us() {
+    return ticks_ns() / 1000;
+}
+
+void mp_hal_delay_ms(mp_uint_t ms) {
+    mp_hal_delay_us(ms * 1000);
+}
+
+void mp_hal_delay_us(mp_uint_t us) {
+    struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+// Returns a number in [min:max], seeded the same on every run so benchmarks are repeatable.
+uint32_t rng_randint(uint32_t min, uint32_t max) {
+    static uint32_t state = 2463534242;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (min == max) ? min : (min + (state % (max - min + 1)));
+}
+
+/******************************************************************************/
+// GC heap, each block is prefixed with its size so the used bytes can be tracked.
+
+typedef struct {
+    size_t size;
+    size_t pad; // Keeps blocks 16-byte aligned.
+} gc_block_t;
+
+static size_t gc_used_bytes;
+static size_t gc_peak_bytes;
+
+void *gc_alloc(size_t n_bytes, unsigned int alloc_flags) {
+    if ((!n_bytes) || ((gc_used_bytes + n_bytes) > OMV_HEAP_SIZE)) {
+        return NULL;
+    }
+
+    gc_block_t *block = malloc(sizeof(gc_block_t) + n_bytes);
+    if (!block) {
+        return NULL;
+    }
+
+    block->size = n_bytes;
+    gc_used_bytes += n_bytes;
+    gc_peak_bytes = (gc_used_bytes > gc_peak_bytes) ? gc_used_bytes : gc_peak_bytes;
+    return block + 1;
+}
+
+void gc_free(void *ptr) {
+    if (ptr) {
+        gc_block_t *block = ((gc_block_t *) ptr) - 1;
+        gc_used_bytes -= block->size;
+        free(block);
+    }
+}
+
+void *gc_realloc(void *ptr, size_t n_bytes, bool allow_move) {
+    if (!ptr) {
+        return gc_alloc(n_bytes, 0);
+    }
+
+    if (!n_bytes) {
+        gc_free(ptr);
+        return NULL;
+    }
+
+    gc_block_t *block = ((gc_block_t *) ptr) - 1;
+    size_t old_size = block->size;
+    if ((gc_used_bytes - old_size + n_bytes) > OMV_HEAP_SIZE) {
+        return NULL;
+    }
+
+    block = realloc(block, sizeof(gc_block_t) + n_bytes);
+    if (!block) {
+        return NULL;
+    }
+
+    block->size = n_bytes;
+    gc_used_bytes += n_bytes - old_size;
+    gc_peak_bytes = (gc_used_bytes > gc_peak_bytes) ? gc_used_bytes : gc_peak_bytes;
+    return block + 1;
+}
+
+void gc_info(gc_info_t *info) {
+    memset(info, 0, sizeof(gc_info_t));
+    info->total = OMV_HEAP_SIZE;
+    info->used = gc_used_bytes;
+    info->free = OMV_HEAP_SIZE - gc_used_bytes;
+    info->max_free = info->free;
+    info->max_block = info->free;
+}
+
+void gc_collect() {
+}
+
+size_t gc_used() {
+    return gc_used_bytes;
+}
+
+size_t gc_peak() {
+    return gc_peak_bytes;
+}
+
+void gc_reset_peak() {
+    gc_peak_bytes = gc_used_bytes;
+}
+
+/******************************************************************************/
+// File API, stdio does the buffering so file_buffer_on()/off() don't use fb_alloc.
+
+const char *ffs_strerror(FRESULT res) {
+    static const char *const strings[] = {
+        "Succeeded",
+        "A hard error occurred in the low level disk I/O layer",
+        "Assertion failed",
+        "The physical drive cannot work",
+        "Could not find the file",
+        "Could not find the path",
+        "The path name format is invalid",
+        "Access denied",
+        "Access denied, the object already exists",
+        "The file/directory object is invalid",
+    };
+    return ((unsigned) res < OMV_ARRAY_SIZE(strings)) ? strings[res] : "Unknown error";
+}
+
+NORETURN static void file_fail(FIL *fp, const char *msg) {
+    if (fp && fp->fp) {
+        fclose(fp->fp);
+        fp->fp = NULL;
+    }
+    mp_raise_msg(&mp_type_OSError, msg);
+}
+
+NORETURN void file_raise_format(FIL *fp) {
+    file_fail(fp, MP_ERROR_TEXT("Unsupported format!"));
+}
+
+NORETURN void file_raise_corrupted(FIL *fp) {
+    file_fail(fp, MP_ERROR_TEXT("File corrupted!"));
+}
+
+NORETURN void file_raise_error(FIL *fp, FRESULT res) {
+    file_fail(fp, ffs_strerror(res));
+}
+
+FRESULT file_ll_open(FIL *fp, const TCHAR *path, BYTE mode) {
+    const char *stdio_mode = (mode & FA_WRITE) ? ((mode & FA_READ) ? "w+b" : "wb") : "rb";
+    fp->fp = fopen(path, stdio_mode);
+    if (!fp->fp) {
+        return FR_NO_FILE;
+    }
+
+    fseek(fp->fp, 0, SEEK_END);
+    fp->size = ftell(fp->fp);
+    fseek(fp->fp, 0, SEEK_SET);
+    return FR_OK;
+}
+
+FRESULT file_ll_close(FIL *fp) {
+    FRESULT res = (fp->fp && (!fclose(fp->fp))) ? FR_OK : FR_DISK_ERR;
+    fp->fp = NULL;
+    return res;
+}
+
+FRESULT file_ll_read(FIL *fp, void *buff, UINT btr, UINT *br) {
+    *br = fread(buff, 1, btr, fp->fp);
+    return ferror(fp->fp) ? FR_DISK_ERR : FR_OK;
+}
+
+FRESULT file_ll_write(FIL *fp, const void *buff, UINT btw, UINT *bw) {
+    *bw = fwrite(buff, 1, btw, fp->fp);
+    return ferror(fp->fp) ? FR_DISK_ERR : FR_OK;
+}
+
+void file_buffer_on(FIL *fp) {
+}
+
+void file_buffer_off(FIL *fp) {
+}
+
+void file_open(FIL *fp, const char *path, bool buffered, uint32_t flags) {
+    FRESULT res = file_ll_open(fp, path, flags);
+    if (res != FR_OK) {
+        file_raise_error(NULL, res);
+    }
+}
+
+void file_close(FIL *fp) {
+    if (file_ll_close(fp) != FR_OK) {
+        file_raise_error(NULL, FR_DISK_ERR);
+    }
+}
+
+void file_seek(FIL *fp, UINT offset) {
+    if (fseek(fp->fp, offset, SEEK_SET)) {
+        file_raise_error(fp, FR_DISK_ERR);
+    }
+}
+
+void file_truncate(FIL *fp) {
+}
+
+void file_sync(FIL *fp) {
+    fflush(fp->fp);
+}
+
+uint32_t file_tell(FIL *fp) {
+    return ftell(fp->fp);
+}
+
+uint32_t file_size(FIL *fp) {
+    long pos = ftell(fp->fp);
+    fseek(fp->fp, 0, SEEK_END);
+    long size = ftell(fp->fp);
+    fseek(fp->fp, pos, SEEK_SET);
+    return size;
+}
+
+void file_read(FIL *fp, void *data, size_t size) {
+    if (data == NULL) {
+        if (fseek(fp->fp, size, SEEK_CUR) || (ftell(fp->fp) > f_size(fp))) {
+            file_fail(fp, MP_ERROR_TEXT("Failed to read requested bytes!"));
+        }
+    } else if (fread(data, 1, size, fp->fp) != size) {
+        file_fail(fp, MP_ERROR_TEXT("Failed to read requested bytes!"));
+    }
+}
+
+void file_write(FIL *fp, const void *data, size_t size) {
+    if (fwrite(data, 1, size, fp->fp) != size) {
+        file_fail(fp, MP_ERROR_TEXT("Failed to write requested bytes!"));
+    }
+}
+
+void file_write_byte(FIL *fp, uint8_t value) {
+    file_write(fp, &value, 1);
+}
+
+void file_write_short(FIL *fp, uint16_t value) {
+    file_write(fp, &value, 2);
+}
+
+void file_write_long(FIL *fp, uint32_t value) {
+    file_write(fp, &value, 4);
+}
+
+void file_read_check(FIL *fp, const void *data, size_t size) {
+    uint8_t buf[16];
+    while (size) {
+        size_t len = (size < sizeof(buf)) ? size : sizeof(buf);
+        file_read(fp, buf, len);
+        if (memcmp(data, buf, len)) {
+            file_fail(fp, MP_ERROR_TEXT("Unexpected value read!"));
+        }
+        size -= len;
+        data = ((uint8_t *) data) + len;
+    }
+}
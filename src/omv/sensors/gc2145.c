@@ -731,9 +731,7 @@ static int reset(sensor_t *sensor) {
     fov_wide = false;
 
     // Write default registers
-    for (int i = 0; default_regs[i][0]; i++) {
-        ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, default_regs[i][0], default_regs[i][1]);
-    }
+    ret |= sensor_write_regs(sensor, &default_regs[0][0], SENSOR_REGS_PAGE_REG(0xFE) | SENSOR_REGS_BURST);
 
     // Delay 10 ms
     mp_hal_delay_ms(10);
@@ -800,30 +798,12 @@ static int set_pixformat(sensor_t *sensor, pixformat_t pixformat) {
     return ret;
 }
 
-static int set_window(sensor_t *sensor, uint16_t reg, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
-    int ret = 0;
-
-    // P0 regs
-    ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, 0xFE, 0x00);
-
-    // Y/row offset
-    ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, reg++, y >> 8);
-    ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, reg++, y & 0xff);
-
-    // X/col offset
-    ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, reg++, x >> 8);
-    ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, reg++, x & 0xff);
-
-    // Window height
-    ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, reg++, h >> 8);
-    ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, reg++, h & 0xff);
-
-    // Window width
-    ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, reg++, w >> 8);
-    ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, reg++, w & 0xff);
-
-    return ret;
-}
+// Y/row offset, X/col offset, window height and window width registers starting at reg.
+#define WINDOW_REGS(reg, x, y, w, h)                                      \
+    SENSOR_REG8((reg) + 0, (y) >> 8), SENSOR_REG8((reg) + 1, (y) & 0xff), \
+    SENSOR_REG8((reg) + 2, (x) >> 8), SENSOR_REG8((reg) + 3, (x) & 0xff), \
+    SENSOR_REG8((reg) + 4, (h) >> 8), SENSOR_REG8((reg) + 5, (h) & 0xff), \
+    SENSOR_REG8((reg) + 6, (w) >> 8), SENSOR_REG8((reg) + 7, (w) & 0xff)
 
 static int set_framesize(sensor_t *sensor, framesize_t framesize) {
     int ret = 0;
@@ -872,20 +852,25 @@ static int set_framesize(sensor_t *sensor, framesize_t framesize) {
     uint16_t sensor_y = IM_CLAMP((((ACTIVE_SENSOR_HEIGHT - sensor_h) / 4) - (readout_y / 2)) * 2,
                                  -(DUMMY_HEIGHT_BUFFER / 2), ACTIVE_SENSOR_HEIGHT - sensor_h) + DUMMY_LINES; // must be multiple of 2
 
-    // Step 3: Write regs.
-
-    // Set Readout window first.
-    ret |= set_window(sensor, 0x09, sensor_x, sensor_y, sensor_w, sensor_h);
-
-    // Set cropping window next.
-    ret |= set_window(sensor, 0x91, 0, 0, w, h);
-
-    // Enable crop
-    ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, 0x90, 0x01);
-
-    // Set Sub-sampling ratio and mode
-    ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, 0x99, ((ratio << 4) | (ratio)));
-    ret |= omv_i2c_writeb(&sensor->i2c_bus, sensor->slv_addr, 0x9A, 0x0E);
+    // Step 3: Write regs, only the ones that changed since the last mode.
+
+    const uint8_t window_regs[][2] = {
+        // P0 regs
+        SENSOR_REG8(0xFE, 0x00),
+        // Readout window
+        WINDOW_REGS(0x09, sensor_x, sensor_y, sensor_w, sensor_h),
+        // Enable crop
+        SENSOR_REG8(0x90, 0x01),
+        // Cropping window
+        WINDOW_REGS(0x91, 0, 0, w, h),
+        // Sub-sampling ratio and mode
+        SENSOR_REG8(0x99, ((ratio << 4) | (ratio))),
+        SENSOR_REG8(0x9A, 0x0E),
+        {0x00, 0x00},
+    };
+
+    ret |= sensor_write_regs(sensor, &window_regs[0][0],
+                             SENSOR_REGS_PAGE_REG(0xFE) | SENSOR_REGS_CACHED | SENSOR_REGS_BURST);
 
     return ret;
 }
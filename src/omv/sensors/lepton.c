@@ -19,6 +19,7 @@
 #include "omv_gpio.h"
 #include "omv_i2c.h"
 #include "framebuffer.h"
+#include "fb_alloc.h"
 
 #include "LEPTON_SDK.h"
 #include "LEPTON_AGC.h"
@@ -414,66 +415,88 @@ static int snapshot(sensor_t *sensor, image_t *image, uint32_t flags) {
     // The code below upscales the source image to the requested frame size
     // and then crops it to the window set by the user.
 
-    LEP_SYS_FPA_TEMPERATURE_KELVIN_T kelvin;
+    LEP_SYS_FPA_TEMPERATURE_KELVIN_T kelvin = 0;
     if (lepton.measurement_mode && (!lepton.radiometry)) {
         if (LEP_GetSysFpaTemperatureKelvin(&lepton.port, &kelvin) != LEP_OK) {
             return -1;
         }
     }
 
-    for (int y = y_offset, yy = fast_ceilf(lepton.v_res * scale) + y_offset; y < yy; y++) {
-        if ((MAIN_FB()->y <= y) && (y < (MAIN_FB()->y + MAIN_FB()->v))) {
-            // user window cropping
-
-            uint16_t *row_ptr = _vospi_buf + (fast_floorf(y * scale_inv) * lepton.h_res);
-
-            for (int x = x_offset, xx = fast_ceilf(lepton.h_res * scale) + x_offset; x < xx; x++) {
-                if ((MAIN_FB()->x <= x) && (x < (MAIN_FB()->x + MAIN_FB()->u))) {
-                    // user window cropping
-
-                    // Value is the 14/16-bit value from the FLIR IR camera.
-                    // However, with AGC enabled only the bottom 8-bits are non-zero.
-                    int value = row_ptr[fast_floorf(x * scale_inv)];
-
-                    if (lepton.measurement_mode) {
-                        // Need to convert 14/16-bits to 8-bits ourselves...
-                        if (!lepton.radiometry) {
-                            value = (value - 8192) + kelvin;
-                        }
-                        float celsius = (value * 0.01f) - 273.15f;
-                        celsius = IM_CLAMP(celsius, lepton.min_temp, lepton.max_temp);
-                        value = __USAT(IM_DIV(((celsius - lepton.min_temp) * 255),
-                                              (lepton.max_temp - lepton.min_temp)), 8);
-                    }
+    int x_end = fast_ceilf(lepton.h_res * scale) + x_offset;
+    int y_end = fast_ceilf(lepton.v_res * scale) + y_offset;
 
-                    int t_x = x - MAIN_FB()->x;
-                    int t_y = y - MAIN_FB()->y;
+    fb_alloc_mark();
+    // Source column of each (mirrored) output column, or -1 if it's outside of the image.
+    int16_t *x_map = fb_alloc(MAIN_FB()->u * sizeof(int16_t), FB_ALLOC_PREFER_SPEED);
+    // The current source row mapped to 8-bits.
+    uint8_t *src_row = fb_alloc(lepton.h_res, FB_ALLOC_PREFER_SPEED);
 
-                    if (lepton.hmirror) {
-                        t_x = MAIN_FB()->u - t_x - 1;
-                    }
-                    if (lepton.vflip) {
-                        t_y = MAIN_FB()->v - t_y - 1;
+    for (int t_x = 0; t_x < MAIN_FB()->u; t_x++) {
+        int x = t_x + MAIN_FB()->x;
+        int d_x = lepton.hmirror ? (MAIN_FB()->u - t_x - 1) : t_x;
+        x_map[d_x] = ((x_offset <= x) && (x < x_end)) ? fast_floorf(x * scale_inv) : -1;
+    }
+
+    int last_y = -1;
+    for (int t_y = 0; t_y < MAIN_FB()->v; t_y++) {
+        int y = t_y + MAIN_FB()->y;
+        if ((y < y_offset) || (y_end <= y)) {
+            continue;
+        }
+
+        int d_y = lepton.vflip ? (MAIN_FB()->v - t_y - 1) : t_y;
+        int s_y = fast_floorf(y * scale_inv);
+
+        // Each source row is converted once however many times it's upscaled.
+        if (s_y != last_y) {
+            uint16_t *row_ptr = _vospi_buf + (s_y * lepton.h_res);
+            for (int x = 0; x < lepton.h_res; x++) {
+                // Value is the 14/16-bit value from the FLIR IR camera.
+                // However, with AGC enabled only the bottom 8-bits are non-zero.
+                int value = row_ptr[x];
+
+                if (lepton.measurement_mode) {
+                    // Need to convert 14/16-bits to 8-bits ourselves...
+                    if (!lepton.radiometry) {
+                        value = (value - 8192) + kelvin;
                     }
+                    float celsius = (value * 0.01f) - 273.15f;
+                    celsius = IM_CLAMP(celsius, lepton.min_temp, lepton.max_temp);
+                    value = __USAT(IM_DIV(((celsius - lepton.min_temp) * 255),
+                                          (lepton.max_temp - lepton.min_temp)), 8);
+                }
 
-                    switch (sensor->pixformat) {
-                        case PIXFORMAT_GRAYSCALE: {
-                            IMAGE_PUT_GRAYSCALE_PIXEL(image, t_x, t_y, value & 0xFF);
-                            break;
-                        }
-                        case PIXFORMAT_RGB565: {
-                            IMAGE_PUT_RGB565_PIXEL(image, t_x, t_y, sensor->color_palette[value & 0xFF]);
-                            break;
-                        }
-                        default: {
-                            break;
-                        }
+                src_row[x] = value;
+            }
+            last_y = s_y;
+        }
+
+        switch (sensor->pixformat) {
+            case PIXFORMAT_GRAYSCALE: {
+                uint8_t *dst_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(image, d_y);
+                for (int x = 0; x < MAIN_FB()->u; x++) {
+                    if (x_map[x] >= 0) {
+                        dst_ptr[x] = src_row[x_map[x]];
                     }
                 }
+                break;
+            }
+            case PIXFORMAT_RGB565: {
+                uint16_t *dst_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(image, d_y);
+                for (int x = 0; x < MAIN_FB()->u; x++) {
+                    if (x_map[x] >= 0) {
+                        dst_ptr[x] = sensor->color_palette[src_row[x_map[x]]];
+                    }
+                }
+                break;
+            }
+            default: {
+                break;
             }
         }
     }
 
+    fb_alloc_free_till_mark();
     return 0;
 }
 
@@ -31,6 +31,12 @@
 static int16_t readout_x = 0;
 static int16_t readout_y = 0;
 
+// Output window in frame size coordinates (zero width/height outputs the whole frame).
+static uint16_t output_x = 0;
+static uint16_t output_y = 0;
+static uint16_t output_w = 0;
+static uint16_t output_h = 0;
+
 static enum {
     MONO_CFA, RCCC_CFA, BAYER_CFA
 }
@@ -49,6 +55,11 @@ static int reset(sensor_t *sensor) {
     readout_x = 0;
     readout_y = 0;
 
+    output_x = 0;
+    output_y = 0;
+    output_w = 0;
+    output_h = 0;
+
     ret |= omv_i2c_writew(&sensor->i2c_bus, sensor->slv_addr, MT9V0XX_RESET, MT9V0XX_RESET_SOFT_RESET);
 
     if (is_mt9v0x4(sensor)) {
@@ -167,6 +178,11 @@ static int set_framesize(sensor_t *sensor, framesize_t framesize) {
         return -1;
     }
 
+    // A new frame size drops the output window.
+    if (framesize != sensor->framesize) {
+        output_w = output_h = 0;
+    }
+
     if (omv_i2c_readw(&sensor->i2c_bus, sensor->slv_addr, MT9V0XX_CHIP_CONTROL, &chip_control) != 0) {
         return -1;
     }
@@ -204,10 +220,20 @@ static int set_framesize(sensor_t *sensor, framesize_t framesize) {
     readout_x = IM_CLAMP(readout_x, -readout_x_max, readout_x_max);
     readout_y = IM_CLAMP(readout_y, -readout_y_max, readout_y_max);
 
-    ret |= omv_i2c_writew(&sensor->i2c_bus, sensor->slv_addr, col_start_addr,
-                          readout_x_max - readout_x + MT9V0XX_COL_START_MIN); // sensor is mirrored by default
-    ret |= omv_i2c_writew(&sensor->i2c_bus, sensor->slv_addr, row_start_addr,
-                          readout_y_max - readout_y + MT9V0XX_ROW_START_MIN); // sensor is mirrored by default
+    int col_start = readout_x_max - readout_x + MT9V0XX_COL_START_MIN; // sensor is mirrored by default
+    int row_start = readout_y_max - readout_y + MT9V0XX_ROW_START_MIN; // sensor is mirrored by default
+
+    // Only read out (and bin) the rows/columns of the output window. The window is placed
+    // in array coordinates so it has to account for the active flips.
+    if (output_w && output_h) {
+        col_start += ((read_mode & MT9V0XX_READ_MODE_COL_FLIP) ? (w - output_x - output_w) : output_x) * read_mode_mul;
+        row_start += ((read_mode & MT9V0XX_READ_MODE_ROW_FLIP) ? (h - output_y - output_h) : output_y) * read_mode_mul;
+        w = output_w;
+        h = output_h;
+    }
+
+    ret |= omv_i2c_writew(&sensor->i2c_bus, sensor->slv_addr, col_start_addr, col_start);
+    ret |= omv_i2c_writew(&sensor->i2c_bus, sensor->slv_addr, row_start_addr, row_start);
     ret |= omv_i2c_writew(&sensor->i2c_bus, sensor->slv_addr, window_width_addr, w * read_mode_mul);
     ret |= omv_i2c_writew(&sensor->i2c_bus, sensor->slv_addr, window_height_addr, h * read_mode_mul);
 
@@ -397,6 +423,11 @@ static int set_hmirror(sensor_t *sensor, int enable) {
                               (read_mode & (~MT9V0XX_READ_MODE_COL_FLIP)) | ((enable == 0) ? MT9V0XX_READ_MODE_COL_FLIP : 0));
     }
 
+    // The output window moves with the flip.
+    if (output_w && output_h) {
+        ret |= set_framesize(sensor, sensor->framesize);
+    }
+
     if (!sensor->disable_delays) {
         ret |= sensor->snapshot(sensor, NULL, 0); // Force shadow mode register to update...
     }
@@ -415,6 +446,11 @@ static int set_vflip(sensor_t *sensor, int enable) {
                               (read_mode & (~MT9V0XX_READ_MODE_ROW_FLIP)) | ((enable == 0) ? MT9V0XX_READ_MODE_ROW_FLIP : 0));
     }
 
+    // The output window moves with the flip.
+    if (output_w && output_h) {
+        ret |= set_framesize(sensor, sensor->framesize);
+    }
+
     if (!sensor->disable_delays) {
         ret |= sensor->snapshot(sensor, NULL, 0); // Force shadow mode register to update...
     }
@@ -468,6 +504,37 @@ static int ioctl(sensor_t *sensor, int request, va_list ap) {
             *va_arg(ap, int *) = tmp_readout_h;
             break;
         }
+        case IOCTL_SET_OUTPUT_WINDOW: {
+            int x = va_arg(ap, int);
+            int y = va_arg(ap, int);
+            int w = va_arg(ap, int);
+            int h = va_arg(ap, int);
+            if (sensor->framesize == FRAMESIZE_INVALID) {
+                ret = -1;
+                break;
+            }
+            if ((!w) || (!h)) {
+                x = y = w = h = 0;
+            } else if ((x < 0) || (y < 0) || (w < 0) || (h < 0) || (x % 2) || (y % 2) ||
+                       ((x + w) > resolution[sensor->framesize][0]) ||
+                       ((y + h) > resolution[sensor->framesize][1])) {
+                ret = -1;
+                break;
+            }
+            output_x = x;
+            output_y = y;
+            output_w = w;
+            output_h = h;
+            ret |= set_framesize(sensor, sensor->framesize);
+            break;
+        }
+        case IOCTL_GET_OUTPUT_WINDOW: {
+            *va_arg(ap, int *) = output_x;
+            *va_arg(ap, int *) = output_y;
+            *va_arg(ap, int *) = output_w;
+            *va_arg(ap, int *) = output_h;
+            break;
+        }
         case IOCTL_SET_TRIGGERED_MODE: {
             int enable = va_arg(ap, int);
             ret = omv_i2c_readw(&sensor->i2c_bus, sensor->slv_addr, MT9V0XX_CHIP_CONTROL, &chip_control);
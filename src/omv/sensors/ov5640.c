@@ -45,6 +45,12 @@ static int16_t readout_y = 0;
 static uint16_t readout_w = ACTIVE_SENSOR_WIDTH;
 static uint16_t readout_h = ACTIVE_SENSOR_HEIGHT;
 
+// Output window in frame size coordinates (zero width/height outputs the whole frame).
+static uint16_t output_x = 0;
+static uint16_t output_y = 0;
+static uint16_t output_w = 0;
+static uint16_t output_h = 0;
+
 static uint16_t hts_target = 0;
 
 static const uint8_t default_regs[][3] = {
@@ -650,6 +656,11 @@ static int reset(sensor_t *sensor) {
     readout_w = ACTIVE_SENSOR_WIDTH;
     readout_h = ACTIVE_SENSOR_HEIGHT;
 
+    output_x = 0;
+    output_y = 0;
+    output_w = 0;
+    output_h = 0;
+
     hts_target = 0;
 
     // Reset all registers
@@ -660,26 +671,21 @@ static int reset(sensor_t *sensor) {
     mp_hal_delay_ms(5);
 
     // Write default registers
-    for (int i = 0; default_regs[i][0]; i++) {
-        int addr = (default_regs[i][0] << 8) | (default_regs[i][1] << 0);
-        int data = default_regs[i][2];
-
-        #if (OMV_OV5640_REV_Y_CHECK == 1)
-        // Rev V (480 MHz / 20) -> 24 MHz PCLK / 3 * 100 = 800 MHz / 10 = 80 MHz PCLK.
-        // Rev Y (400 MHz / 16) -> 25 MHz PCLK / 3 * 84 = 700 MHz / 10 = 70 MHz PCLK.
-        if (HAL_GetREVID() < 0x2003) {
-            // Is this REV Y?
-            if (addr == SC_PLL_CONTRL2) {
-                data = OMV_OV5640_REV_Y_CTRL2;
-            }
-            if (addr == SC_PLL_CONTRL3) {
-                data = OMV_OV5640_REV_Y_CTRL3;
-            }
-        }
-        #endif
-
-        ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, addr, data);
+    ret |= sensor_write_regs(sensor, &default_regs[0][0], SENSOR_REGS_ADDR16 | SENSOR_REGS_BURST);
+
+    #if (OMV_OV5640_REV_Y_CHECK == 1)
+    // Rev V (480 MHz / 20) -> 24 MHz PCLK / 3 * 100 = 800 MHz / 10 = 80 MHz PCLK.
+    // Rev Y (400 MHz / 16) -> 25 MHz PCLK / 3 * 84 = 700 MHz / 10 = 70 MHz PCLK.
+    if (HAL_GetREVID() < 0x2003) {
+        // Is this REV Y?
+        const uint8_t rev_y_regs[][3] = {
+            SENSOR_REG16(SC_PLL_CONTRL2, OMV_OV5640_REV_Y_CTRL2),
+            SENSOR_REG16(SC_PLL_CONTRL3, OMV_OV5640_REV_Y_CTRL3),
+            {0x00, 0x00, 0x00},
+        };
+        ret |= sensor_write_regs(sensor, &rev_y_regs[0][0], SENSOR_REGS_ADDR16 | SENSOR_REGS_BURST);
     }
+    #endif
 
     #if (OMV_OV5640_AF_ENABLE == 1)
     ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, SYSTEM_RESET_00, 0x20); // force mcu reset
@@ -834,10 +840,15 @@ static int set_pixformat(sensor_t *sensor, pixformat_t pixformat) {
                         (reg & 0xD7) | ((pixformat == PIXFORMAT_JPEG) ? 0x28 : 0x00));
 
     if (hts_target) {
-        uint16_t sensor_hts = calculate_hts(sensor, resolution[sensor->framesize][0]);
+        uint16_t sensor_hts = calculate_hts(sensor, output_w ? output_w : resolution[sensor->framesize][0]);
 
-        ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_HTS_H, sensor_hts >> 8);
-        ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_HTS_L, sensor_hts);
+        const uint8_t hts_regs[][3] = {
+            SENSOR_REG16(TIMING_HTS_H, sensor_hts >> 8),
+            SENSOR_REG16(TIMING_HTS_L, sensor_hts),
+            {0x00, 0x00, 0x00},
+        };
+
+        ret |= sensor_write_regs(sensor, &hts_regs[0][0], SENSOR_REGS_ADDR16 | SENSOR_REGS_BURST);
     }
 
     return ret;
@@ -879,6 +890,11 @@ static int set_framesize(sensor_t *sensor, framesize_t framesize) {
         return -1;
     }
 
+    // A new frame size drops the output window.
+    if (framesize != sensor->framesize) {
+        output_w = output_h = 0;
+    }
+
     // Step 0: Clamp readout settings.
 
     readout_w = IM_MAX(readout_w, w);
@@ -899,31 +915,48 @@ static int set_framesize(sensor_t *sensor, framesize_t framesize) {
         sensor_div = 2;
     }
 
-    // Step 2: Determine horizontal and vertical start and end points.
+    float ratio = IM_MIN((readout_w / sensor_div) / ((float) w), (readout_h / sensor_div) / ((float) h));
+
+    // Step 2: Shrink the readout area to the part of the array the output window maps to.
+
+    int16_t window_x = readout_x;
+    int16_t window_y = readout_y;
+    uint16_t window_w = readout_w;
+    uint16_t window_h = readout_h;
+
+    if (output_w && output_h) {
+        float scale = ratio * sensor_div;
+        window_w = IM_MIN(((int) (output_w * scale) + 3) & ~3, readout_w); // must be multiple of 4
+        window_h = IM_MIN(((int) (output_h * scale) + 3) & ~3, readout_h); // must be multiple of 4
+        window_x += ((output_x + (output_w / 2)) - (w / 2)) * scale;
+        window_y += ((output_y + (output_h / 2)) - (h / 2)) * scale;
+        w = output_w;
+        h = output_h;
+    }
+
+    // Step 3: Determine horizontal and vertical start and end points.
 
-    uint16_t sensor_w = readout_w + DUMMY_WIDTH_BUFFER; // camera hardware needs dummy pixels to sync
-    uint16_t sensor_h = readout_h + DUMMY_HEIGHT_BUFFER; // camera hardware needs dummy lines to sync
+    uint16_t sensor_w = window_w + DUMMY_WIDTH_BUFFER; // camera hardware needs dummy pixels to sync
+    uint16_t sensor_h = window_h + DUMMY_HEIGHT_BUFFER; // camera hardware needs dummy lines to sync
 
     uint16_t sensor_ws =
-        IM_CLAMP((((ACTIVE_SENSOR_WIDTH - sensor_w) / 4) + (readout_x / 2)) * 2, -(DUMMY_WIDTH_BUFFER / 2),
+        IM_CLAMP((((ACTIVE_SENSOR_WIDTH - sensor_w) / 4) + (window_x / 2)) * 2, -(DUMMY_WIDTH_BUFFER / 2),
                  ACTIVE_SENSOR_WIDTH - sensor_w) + DUMMY_COLUMNS; // must be multiple of 2
     uint16_t sensor_we = sensor_ws + sensor_w - 1;
 
     uint16_t sensor_hs =
-        IM_CLAMP((((ACTIVE_SENSOR_HEIGHT - sensor_h) / 4) - (readout_y / 2)) * 2, -(DUMMY_HEIGHT_BUFFER / 2),
+        IM_CLAMP((((ACTIVE_SENSOR_HEIGHT - sensor_h) / 4) - (window_y / 2)) * 2, -(DUMMY_HEIGHT_BUFFER / 2),
                  ACTIVE_SENSOR_HEIGHT - sensor_h) + DUMMY_LINES; // must be multiple of 2
     uint16_t sensor_he = sensor_hs + sensor_h - 1;
 
-    // Step 3: Determine scaling window offset.
-
-    float ratio = IM_MIN((readout_w / sensor_div) / ((float) w), (readout_h / sensor_div) / ((float) h));
+    // Step 4: Determine scaling window offset.
 
     uint16_t w_mul = w * ratio;
     uint16_t h_mul = h * ratio;
     uint16_t x_off = ((sensor_w / sensor_div) - w_mul) / 2;
     uint16_t y_off = ((sensor_h / sensor_div) - h_mul) / 2;
 
-    // Step 4: Compute total frame time.
+    // Step 5: Compute total frame time.
 
     hts_target = sensor_w / sensor_div;
 
@@ -933,40 +966,39 @@ static int set_framesize(sensor_t *sensor, framesize_t framesize) {
     uint16_t sensor_x_inc = (((sensor_div * 2) - 1) << 4) | (1 << 0); // odd[7:4]/even[3:0] pixel inc on the bayer pattern
     uint16_t sensor_y_inc = (((sensor_div * 2) - 1) << 4) | (1 << 0); // odd[7:4]/even[3:0] pixel inc on the bayer pattern
 
-    // Step 5: Write regs.
-
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_HS_H, sensor_ws >> 8);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_HS_L, sensor_ws);
-
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_VS_H, sensor_hs >> 8);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_VS_L, sensor_hs);
-
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_HW_H, sensor_we >> 8);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_HW_L, sensor_we);
-
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_VH_H, sensor_he >> 8);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_VH_L, sensor_he);
-
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_DVPHO_H, w >> 8);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_DVPHO_L, w);
-
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_DVPVO_H, h >> 8);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_DVPVO_L, h);
-
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_HTS_H, sensor_hts >> 8);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_HTS_L, sensor_hts);
-
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_VTS_H, sensor_vts >> 8);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_VTS_L, sensor_vts);
-
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_HOFFSET_H, x_off >> 8);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_HOFFSET_L, x_off);
-
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_VOFFSET_H, y_off >> 8);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_VOFFSET_L, y_off);
-
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_X_INC, sensor_x_inc);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_Y_INC, sensor_y_inc);
+    // Step 6: Write regs, only the ones that changed since the last mode.
+
+    const uint8_t timing_regs[][3] = {
+        SENSOR_REG16(TIMING_HS_H, sensor_ws >> 8),
+        SENSOR_REG16(TIMING_HS_L, sensor_ws),
+        SENSOR_REG16(TIMING_VS_H, sensor_hs >> 8),
+        SENSOR_REG16(TIMING_VS_L, sensor_hs),
+        SENSOR_REG16(TIMING_HW_H, sensor_we >> 8),
+        SENSOR_REG16(TIMING_HW_L, sensor_we),
+        SENSOR_REG16(TIMING_VH_H, sensor_he >> 8),
+        SENSOR_REG16(TIMING_VH_L, sensor_he),
+        SENSOR_REG16(TIMING_DVPHO_H, w >> 8),
+        SENSOR_REG16(TIMING_DVPHO_L, w),
+        SENSOR_REG16(TIMING_DVPVO_H, h >> 8),
+        SENSOR_REG16(TIMING_DVPVO_L, h),
+        SENSOR_REG16(TIMING_HTS_H, sensor_hts >> 8),
+        SENSOR_REG16(TIMING_HTS_L, sensor_hts),
+        SENSOR_REG16(TIMING_VTS_H, sensor_vts >> 8),
+        SENSOR_REG16(TIMING_VTS_L, sensor_vts),
+        SENSOR_REG16(TIMING_HOFFSET_H, x_off >> 8),
+        SENSOR_REG16(TIMING_HOFFSET_L, x_off),
+        SENSOR_REG16(TIMING_VOFFSET_H, y_off >> 8),
+        SENSOR_REG16(TIMING_VOFFSET_L, y_off),
+        SENSOR_REG16(TIMING_X_INC, sensor_x_inc),
+        SENSOR_REG16(TIMING_Y_INC, sensor_y_inc),
+        SENSOR_REG16(VFIFO_HSIZE_H, w >> 8),
+        SENSOR_REG16(VFIFO_HSIZE_L, w),
+        SENSOR_REG16(VFIFO_VSIZE_H, h >> 8),
+        SENSOR_REG16(VFIFO_VSIZE_L, h),
+        {0x00, 0x00, 0x00},
+    };
+
+    ret |= sensor_write_regs(sensor, &timing_regs[0][0], SENSOR_REGS_ADDR16 | SENSOR_REGS_CACHED | SENSOR_REGS_BURST);
 
     ret |= omv_i2c_readb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_TC_REG_20, &reg);
     ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_TC_REG_20, (reg & 0xFE) | (sensor_div > 1));
@@ -974,12 +1006,6 @@ static int set_framesize(sensor_t *sensor, framesize_t framesize) {
     ret |= omv_i2c_readb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_TC_REG_21, &reg);
     ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_TC_REG_21, (reg & 0xFE) | (sensor_div > 1));
 
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, VFIFO_HSIZE_H, w >> 8);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, VFIFO_HSIZE_L, w);
-
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, VFIFO_VSIZE_H, h >> 8);
-    ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, VFIFO_VSIZE_L, h);
-
     return ret;
 }
 
@@ -1167,8 +1193,14 @@ static int set_auto_exposure(sensor_t *sensor, int enable, int exposure_us) {
         ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, AEC_PK_EXPOSURE_1, exposure >> 4);
         ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, AEC_PK_EXPOSURE_2, exposure << 4);
 
-        ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_VTS_H, new_vts >> 8);
-        ret |= omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, TIMING_VTS_L, new_vts);
+        // Keep the register cache in sync with the new frame time.
+        const uint8_t vts_regs[][3] = {
+            SENSOR_REG16(TIMING_VTS_H, new_vts >> 8),
+            SENSOR_REG16(TIMING_VTS_L, new_vts),
+            {0x00, 0x00, 0x00},
+        };
+
+        ret |= sensor_write_regs(sensor, &vts_regs[0][0], SENSOR_REGS_ADDR16 | SENSOR_REGS_BURST);
     }
 
     return ret;
@@ -1362,6 +1394,37 @@ static int ioctl(sensor_t *sensor, int request, va_list ap) {
             *va_arg(ap, int *) = readout_h;
             break;
         }
+        case IOCTL_SET_OUTPUT_WINDOW: {
+            int x = va_arg(ap, int);
+            int y = va_arg(ap, int);
+            int w = va_arg(ap, int);
+            int h = va_arg(ap, int);
+            if ((sensor->framesize == FRAMESIZE_INVALID) || (sensor->pixformat == PIXFORMAT_JPEG)) {
+                ret = -1;
+                break;
+            }
+            if ((!w) || (!h)) {
+                x = y = w = h = 0;
+            } else if ((x < 0) || (y < 0) || (w < 0) || (h < 0) || (x % 2) || (y % 2) ||
+                       ((x + w) > resolution[sensor->framesize][0]) ||
+                       ((y + h) > resolution[sensor->framesize][1])) {
+                ret = -1;
+                break;
+            }
+            output_x = x;
+            output_y = y;
+            output_w = w;
+            output_h = h;
+            ret = set_framesize(sensor, sensor->framesize);
+            break;
+        }
+        case IOCTL_GET_OUTPUT_WINDOW: {
+            *va_arg(ap, int *) = output_x;
+            *va_arg(ap, int *) = output_y;
+            *va_arg(ap, int *) = output_w;
+            *va_arg(ap, int *) = output_h;
+            break;
+        }
     #if (OMV_OV5640_AF_ENABLE == 1)
         case IOCTL_TRIGGER_AUTO_FOCUS: {
             ret = omv_i2c_writeb2(&sensor->i2c_bus, sensor->slv_addr, AF_CMD_MAIN, 0x03);
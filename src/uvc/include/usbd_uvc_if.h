@@ -51,6 +51,7 @@ extern USBD_UVC_ItfTypeDef  USBD_Interface_fops_FS;
   * @{
   */ 
 uint8_t UVC_Transmit_FS(uint8_t* Buf, uint16_t Len);
+uint8_t UVC_TransmitBusy_FS(void);
 
 /**
   * @}
@@ -10,6 +10,7 @@
  */
 #include STM32_HAL_H
 #include <stdbool.h>
+#include <string.h>
 #include "sdram.h"
 #include "usbd_core.h"
 #include "usbd_desc.h"
@@ -140,43 +141,58 @@ static uint8_t uvc_header[2] = { 2, 0 };
 static uint8_t packet[VIDEO_PACKET_SIZE];
 uint32_t packet_size = VIDEO_PACKET_SIZE-2;
 
+// Packets are sent straight from the frame buffer. The 2-byte payload header of each packet is
+// written over the last 2 bytes of the previous packet's payload once that packet has been sent,
+// so only the first packet, which has nothing before it, is copied.
 bool process_frame(image_t *image)
 {
-    uint32_t xfer_size = 0;
-    uint32_t xfer_bytes = 0;
-    uint8_t *dst = packet + 2;
+    uint32_t xfer_size = image->w * image->h * image->bpp;
+    uint8_t *pixels = image->pixels;
+
+    switch (videoCommitControl.bFormatIndex) {
+        case VS_FMT_INDEX(YUYV):
+        case VS_FMT_INDEX(RGB565): {
+            // Swap the bytes of each 16-bit pixel in place, two pixels at a time.
+            uint32_t *pixels32 = (uint32_t *) pixels;
+            for (int i=0; i<(xfer_size/4); i++) {
+                pixels32[i] = __REV16(pixels32[i]);
+            }
+            if (xfer_size % 4) {
+                uint8_t tmp = pixels[xfer_size-2];
+                pixels[xfer_size-2] = pixels[xfer_size-1];
+                pixels[xfer_size-1] = tmp;
+            }
+            break;
+        }
+        default:
+            break;
+    }
 
-    xfer_size = image->w * image->h * image->bpp;
+    for (uint32_t xfer_bytes = 0; xfer_bytes < xfer_size; ) {
+        uint32_t size = MIN(xfer_size - xfer_bytes, packet_size);
+        uint8_t *buf = packet;
 
-    while (xfer_bytes < xfer_size) {
-        packet[0] = uvc_header[0];
-        packet[1] = uvc_header[1];
+        // Wait for the previous packet before overwriting the end of its payload.
+        while (UVC_TransmitBusy_FS()) {
+            __WFI();
+        }
 
-        switch (videoCommitControl.bFormatIndex) {
-            case VS_FMT_INDEX(GREY): {
-                for (int i=0; i<packet_size; i++, xfer_bytes+=image->bpp) {
-                    dst[i+0] = image->pixels[xfer_bytes+0];
-                }
-                break;
-            }
-            case VS_FMT_INDEX(YUYV):
-            case VS_FMT_INDEX(RGB565): {
-                for (int i=0; i<packet_size; i+=2, xfer_bytes+=2) {
-                    dst[i+0] = image->pixels[xfer_bytes+1];
-                    dst[i+1] = image->pixels[xfer_bytes+0];
-                }
-                break;
-            }
-            default:
-                break;
+        if (xfer_bytes) {
+            buf = pixels + xfer_bytes - 2;
+        } else {
+            memcpy(packet + 2, pixels, size);
         }
 
+        buf[0] = uvc_header[0];
+        buf[1] = uvc_header[1];
+        xfer_bytes += size;
+
         if (xfer_bytes == xfer_size) {
-            packet[1] |= 0x2;    // Flag end of frame
+            buf[1] |= 0x2;    // Flag end of frame
             uvc_header[1] ^= 1;  // Toggle bit 0 for next new frame
         }
 
-        while (UVC_Transmit_FS(packet, VIDEO_PACKET_SIZE) != USBD_OK) {
+        while (UVC_Transmit_FS(buf, size + 2) != USBD_OK) {
             __WFI();
         }
     }
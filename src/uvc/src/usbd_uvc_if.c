@@ -395,4 +395,16 @@ uint8_t UVC_Transmit_FS(uint8_t* Buf, uint16_t Len)
   return result;
 }
 
+/**
+  * @brief  UVC_TransmitBusy_FS
+  *         Returns non-zero while a packet passed to UVC_Transmit_FS is being sent.
+  * @param  None
+  * @retval Transmit state
+  */
+uint8_t UVC_TransmitBusy_FS(void)
+{
+  USBD_UVC_HandleTypeDef *hcdc = (USBD_UVC_HandleTypeDef*) hUsbDevice_0->pClassData;
+  return (hcdc != NULL) && (hcdc->TxState != 0);
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
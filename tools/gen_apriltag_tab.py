@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# This file is part of the OpenMV project.
+#
+# Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+# Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+#
+# This work is licensed under the MIT license, see the file LICENSE for details.
+#
+# This script generates the AprilTag family code hash tables (imlib/apriltag_tab.c) from the
+# families in imlib/apriltag.c, e.g.:
+#
+#   python3 gen_apriltag_tab.py ../src/omv/imlib/apriltag.c > ../src/omv/imlib/apriltag_tab.c
+#
+# Each table has a power of two number of slots (at least 1.5x the codes). A code is stored as
+# its index at slot (code * APRILTAG_HASH_MULT) >> (64 - bits), or the next free slot after it.
+
+import re
+import sys
+
+APRILTAG_HASH_MULT = 0x9E3779B97F4A7C15
+APRILTAG_HASH_EMPTY = 0xFFFF
+
+
+def read_families(path):
+    with open(path, "r") as f:
+        source = f.read()
+
+    families = []
+    for m in re.finditer(r"const apriltag_family_t (\w+) = \{(.*?)\n\};", source, re.S):
+        codes = [int(c, 16) for c in re.findall(r"(0x[0-9a-fA-F]+)UL", m.group(2))]
+        ncodes = int(re.search(r"\.ncodes = (\d+)", m.group(2)).group(1))
+        if len(codes) != ncodes:
+            sys.exit("%s: expected %d codes, found %d" % (m.group(1), ncodes, len(codes)))
+        families.append((m.group(1), codes))
+
+    return families
+
+
+def hash_table(codes):
+    bits = 1
+    while (1 << bits) < ((len(codes) * 3) // 2):
+        bits += 1
+
+    mask = (1 << bits) - 1
+    table = [APRILTAG_HASH_EMPTY] * (1 << bits)
+    for i, code in enumerate(codes):
+        slot = ((code * APRILTAG_HASH_MULT) & 0xFFFFFFFFFFFFFFFF) >> (64 - bits)
+        while table[slot] != APRILTAG_HASH_EMPTY:
+            slot = (slot + 1) & mask
+        table[slot] = i
+
+    return bits, table
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: gen_apriltag_tab.py apriltag.c")
+
+    sys.stdout.write("#include <stdint.h>\n")
+
+    for name, codes in read_families(sys.argv[1]):
+        bits, table = hash_table(codes)
+        sys.stdout.write("\n")
+        sys.stdout.write("const uint16_t %s_hash[%d] = {\n" % (name, len(table)))
+        for i in range(len(table)):
+            if not (i % 8):
+                sys.stdout.write("    ")
+            sys.stdout.write("0x%04X" % table[i])
+            if (i + 1) % 8:
+                sys.stdout.write(", ")
+            elif i != (len(table) - 1):
+                sys.stdout.write(",\n")
+            else:
+                sys.stdout.write("\n};\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -18,7 +18,7 @@ sys.stdout.write("#include <stdint.h>\n")
 l_list = []
 a_list = []
 b_list = []
-sys.stdout.write("const int8_t lab_table[98304] = {\n") # 65536 * 3 / 2
+sys.stdout.write("const int8_t lab_table[98304 + 1] = {\n") # 65536 * 3 / 2 + 1 pad byte for word loads
 for i in range(65536):
 
     r = ((((i >> 11) & 31) * 255) + 15.5) // 31
@@ -74,3 +74,38 @@ for i in range(256):
         sys.stdout.write(",\n")
     else:
         sys.stdout.write("\n};\n")
+
+# Compact tables for IMLIB_ENABLE_LAB_LUT_COMPACT. X/Xn, Y/Yn and Z/Zn are sums of per-channel
+# contributions in Q16 and f(t) is linearly interpolated from 1024 steps in Q15.
+sys.stdout.write("const uint16_t lab_xyz_table[128][3] = {\n")
+i = 0
+for (ch, n) in ((0, 32), (1, 64), (2, 32)):
+    for c in range(n):
+        c_lin = lin((((c * 255) + ((n - 1) / 2.0)) // (n - 1)) / 255.0)
+        xyz = (((0.4124, 0.3576, 0.1805)[ch] / 095.047),
+               ((0.2126, 0.7152, 0.0722)[ch] / 100.000),
+               ((0.0193, 0.1192, 0.9505)[ch] / 108.883))
+        if not (i % 4):
+            sys.stdout.write("    ")
+        sys.stdout.write("{%5d, %5d, %5d}" % tuple(int(round(c_lin * k * 65536)) for k in xyz))
+        i += 1
+        if i % 4:
+            sys.stdout.write(", ")
+        elif i != 128:
+            sys.stdout.write(",\n")
+        else:
+            sys.stdout.write("\n};\n")
+
+sys.stdout.write("const uint16_t lab_f_table[1025] = {\n")
+for i in range(1025):
+    t = i / 1024.0
+    f = pow(t, (1/3.0)) if (t>0.008856) else ((7.787037*t)+0.137931)
+    if not (i % 12):
+        sys.stdout.write("    ")
+    sys.stdout.write("%5d" % int(round(f * 32768)))
+    if i == 1024:
+        sys.stdout.write("\n};\n")
+    elif (i + 1) % 12:
+        sys.stdout.write(", ")
+    else:
+        sys.stdout.write(",\n")
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+# This file is part of the OpenMV project.
+#
+# Copyright (c) 2013-2024 Ibrahim Abdelkader <iabdalkader@openmv.io>
+# Copyright (c) 2013-2024 Kwabena W. Agyeman <kwagyeman@openmv.io>
+#
+# This work is licensed under the MIT license, see the file LICENSE for details.
+#
+# This script converts a Haar cascade to the packed format (see cascade_packed_t in imlib.h),
+# which the camera loads with a single read, or uses in place from a bytes object, e.g.:
+#
+#   python3 pack_cascade.py frontalface.cascade frontalface.pcascade
+#   python3 pack_cascade.py --python frontalface.cascade frontalface_cascade.py
+#
+# The Python output can be frozen into the firmware so the cascade is used from flash:
+#
+#   import image, frontalface_cascade
+#   cascade = image.HaarCascade(frontalface_cascade.data)
+
+import argparse
+import struct
+import sys
+
+CASCADE_PACKED_MAGIC = 0x43564D4F  # "OMVC"
+CASCADE_PACKED_VERSION = 1
+CASCADE_PACKED_HEADER = "<IHHHHII8I"
+
+
+def read_cascade(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if struct.unpack_from("<I", data)[0] == CASCADE_PACKED_MAGIC:
+        sys.exit("%s is already packed" % path)
+
+    offset = 0
+
+    def take(fmt, n):
+        nonlocal offset
+        values = list(struct.unpack_from("<%d%s" % (n, fmt), data, offset))
+        offset += struct.calcsize("<%d%s" % (n, fmt))
+        return values
+
+    window_w, window_h, n_stages = take("i", 3)
+    stages = take("B", n_stages)
+    n_features = sum(stages)
+    stages_thresh = take("h", n_stages)
+    tree_thresh = take("h", n_features)
+    alpha1 = take("h", n_features)
+    alpha2 = take("h", n_features)
+    num_rectangles = take("b", n_features)
+    n_rectangles = sum(num_rectangles)
+    weights = take("b", n_rectangles)
+    rectangles = take("b", n_rectangles * 4)
+
+    return (window_w, window_h, [("B", stages), ("h", stages_thresh), ("h", tree_thresh),
+                                 ("h", alpha1), ("h", alpha2), ("b", num_rectangles),
+                                 ("b", weights), ("b", rectangles)])
+
+
+def pack_cascade(window_w, window_h, arrays):
+    body = b""
+    offsets = []
+    offset = struct.calcsize(CASCADE_PACKED_HEADER)
+
+    for fmt, values in arrays:
+        array = struct.pack("<%d%s" % (len(values), fmt), *values)
+        array += b"\0" * (-len(array) % 4)
+        offsets.append(offset)
+        offset += len(array)
+        body += array
+
+    n_stages = len(arrays[0][1])
+    n_features = len(arrays[2][1])
+    n_rectangles = len(arrays[6][1])
+    header = struct.pack(CASCADE_PACKED_HEADER, CASCADE_PACKED_MAGIC, CASCADE_PACKED_VERSION,
+                         n_stages, window_w, window_h, n_features, n_rectangles, *offsets)
+    return header + body
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Converts a Haar cascade to the packed format.")
+    parser.add_argument("--python", action="store_true", help="Write a Python module instead.")
+    parser.add_argument("input", help="Input cascade.")
+    parser.add_argument("output", help="Output file.")
+    args = parser.parse_args()
+
+    data = pack_cascade(*read_cascade(args.input))
+
+    if args.python:
+        with open(args.output, "w") as f:
+            f.write("# Packed Haar cascade generated by pack_cascade.py.\n")
+            f.write("data = %r\n" % data)
+    else:
+        with open(args.output, "wb") as f:
+            f.write(data)
+
+    print("%s: %d bytes" % (args.output, len(data)))
+
+
+if __name__ == "__main__":
+    main()
@@ -8,6 +8,7 @@
 #
 # Openmv module.
 
+import json
 import struct
 import sys,time
 import serial
@@ -17,6 +18,11 @@ from PIL import Image
 
 __serial = None
 __FB_HDR_SIZE   =12
+__FB_STREAM_HDR_SIZE=16
+__fb_stream_credit = __FB_STREAM_HDR_SIZE
+__FB_DELTA_MAGIC=0x44564D4F
+__fb_delta_tile = 0
+__fb_delta_frame = None
 
 # USB Debug commands
 __USBDBG_CMD            = 48
@@ -37,6 +43,18 @@ __USBDBG_SYS_RESET_TO_BL= 0x0E
 __USBDBG_FB_ENABLE      = 0x0D
 __USBDBG_TX_BUF_LEN     = 0x8E
 __USBDBG_TX_BUF         = 0x8F
+__USBDBG_PROFILE_SIZE   = 0x93
+__USBDBG_PROFILE_DUMP   = 0x94
+__USBDBG_FB_ALLOC_SIZE  = 0x95
+__USBDBG_FB_ALLOC_DUMP  = 0x96
+__USBDBG_FB_DELTA       = 0x17
+__USBDBG_FRAME_STREAM   = 0x97
+__USBDBG_TIMELINE_SIZE  = 0x98
+__USBDBG_TIMELINE_DUMP  = 0x99
+
+# Profiler probe names in enum order, keep in sync with trace.h.
+PROBE_NAMES = ["sensor_snapshot", "imlib_find_blobs", "imlib_draw_image", "jpeg_compress", "libtf_invoke",
+               "display_write", "frame_start", "frame_end", "usbdbg_send", "power_state"]
 
 ATTR_CONTRAST   =0
 ATTR_BRIGHTNESS =1
@@ -71,6 +89,7 @@ def fb_size():
     return struct.unpack("III", __serial.read(12))
 
 def fb_dump():
+    global __fb_delta_frame
     size = fb_size()
 
     if (not size[0]):
@@ -85,7 +104,37 @@ def fb_dump():
     # read fb data
     __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_FRAME_DUMP, num_bytes))
     buff = __serial.read(num_bytes)
+    return __fb_decode(size, buff)
+
+def fb_stream():
+    # Like fb_dump() but reads the header and the frame with a single command. The amount
+    # requested is sized from the last frame, only the part of a bigger frame that didn't fit
+    # is read with a second command. Returns (w, h, buff, seq), seq is the frame's capture sequence number.
+    global __fb_stream_credit
+    credit = __fb_stream_credit
+    __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_FRAME_STREAM, credit))
+    buff = __serial.read(credit)
+    seq, w, h, bpp = struct.unpack_from("<IIII", buff)
+
+    if (not w):
+        # frame not ready, only ask for the header until it is.
+        __fb_stream_credit = __FB_STREAM_HDR_SIZE
+        return None
+
+    num_bytes = bpp if (bpp > 2) else (w*h*bpp)
+    buff = buff[__FB_STREAM_HDR_SIZE:__FB_STREAM_HDR_SIZE+num_bytes]
+    if (len(buff) < num_bytes):
+        __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_FRAME_DUMP, num_bytes - len(buff)))
+        buff += __serial.read(num_bytes - len(buff))
+
+    # Leave room for the next frame to grow a little.
+    __fb_stream_credit = __FB_STREAM_HDR_SIZE + num_bytes + (num_bytes // 8)
+
+    frame = __fb_decode((w, h, bpp), buff)
+    return (frame + (seq,)) if frame else None
 
+def __fb_decode(size, buff):
+    global __fb_delta_frame
     if size[2] == 1:  # Grayscale
         y = np.fromstring(buff, dtype=np.uint8)
         buff = np.column_stack((y, y, y))
@@ -95,7 +144,9 @@ def fb_dump():
         g = (((arr & 0x07E0) >>5) *255.0/63.0).astype(np.uint8)
         b = (((arr & 0x001F) >>0) *255.0/31.0).astype(np.uint8)
         buff = np.column_stack((r,g,b))
-    else: # JPEG
+    else: # JPEG or delta packet
+        if (len(buff) >= 12 and struct.unpack_from("<I", buff)[0] == __FB_DELTA_MAGIC):
+            return __fb_delta_update(size[0], size[1], buff)
         try:
             buff = np.asarray(Image.frombuffer("RGB", size[0:2], buff, "jpeg", "RGB", ""))
         except Exception as e:
@@ -105,7 +156,40 @@ def fb_dump():
     if (buff.size != (size[0]*size[1]*3)):
         return None
 
-    return (size[0], size[1], buff.reshape((size[1], size[0], 3)))
+    buff = buff.reshape((size[1], size[0], 3))
+    if (__fb_delta_tile):
+        # Key frame, the next delta packets are applied to it.
+        __fb_delta_frame = buff.copy()
+
+    return (size[0], size[1], buff)
+
+def __fb_delta_update(w, h, buff):
+    # Pastes the changed tiles of a delta packet into the last frame.
+    global __fb_delta_frame
+    tile, n, offset = struct.unpack_from("<HHI", buff, 4)
+    if (__fb_delta_frame is None or __fb_delta_frame.shape[0:2] != (h, w)):
+        # Missed the key frame, request a new one.
+        enable_fb_delta(__fb_delta_tile)
+        return None
+
+    index = struct.unpack_from("<%dH"%(n), buff, 12)
+    tiles_w = (w + tile - 1) // tile
+    cols = min(n, tiles_w)
+    rows = (n + cols - 1) // cols
+    try:
+        mosaic = np.asarray(Image.frombuffer("RGB", (cols*tile, rows*tile), buff[offset:], "jpeg", "RGB", ""))
+        mosaic = mosaic.reshape((rows*tile, cols*tile, 3))
+    except Exception as e:
+        print ("JPEG decode error (%s)"%(e))
+        return None
+
+    for i, k in enumerate(index):
+        x, y = (k % tiles_w) * tile, (k // tiles_w) * tile
+        mx, my = (i % cols) * tile, (i // cols) * tile
+        tw, th = min(tile, w - x), min(tile, h - y)
+        __fb_delta_frame[y:y+th, x:x+tw] = mosaic[my:my+th, mx:mx+tw]
+
+    return (w, h, __fb_delta_frame.copy())
 
 def exec_script(buf):
     __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_SCRIPT_EXEC, len(buf)))
@@ -171,10 +255,78 @@ def enable_fb(enable):
     __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_FB_ENABLE, 4))
     __serial.write(struct.pack("<I", enable))
 
+def enable_fb_delta(tile):
+    # Only send the changed tiles of each frame (tile is 16 or 32, 0 to send whole frames).
+    # fb_dump() keeps returning whole frames.
+    global __fb_delta_tile, __fb_delta_frame
+    __fb_delta_tile = tile
+    __fb_delta_frame = None
+    __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_FB_DELTA, 4))
+    __serial.write(struct.pack("<I", tile))
+
 def arch_str():
     __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_ARCH_STR, 64))
     return __serial.read(64).split('\0', 1)[0]
 
+def profile():
+    # Returns the cycle counter clock and (count, min, avg, max, hist) cycles per probe (enum order).
+    __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_PROFILE_SIZE, 12))
+    n_probes, record_size, clock = struct.unpack("III", __serial.read(12))
+    if (not n_probes):
+        return (clock, [])
+
+    __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_PROFILE_DUMP, n_probes * record_size))
+    buff = __serial.read(n_probes * record_size)
+
+    probes = []
+    for i in range(n_probes):
+        record = struct.unpack_from("<QIII16I", buff, i * record_size)
+        total, count, min_cycles, max_cycles = record[0:4]
+        avg_cycles = (total // count) if count else 0
+        probes.append((count, min_cycles if count else 0, avg_cycles, max_cycles, record[4:]))
+    return (clock, probes)
+
+def fb_alloc_stack():
+    # Returns the fb_alloc high-water mark and the live and high-water [(call site, bytes)] lists.
+    __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_FB_ALLOC_SIZE, 12))
+    peak, n_live, n_peak = struct.unpack("III", __serial.read(12))
+    if (not (n_live + n_peak)):
+        return (peak, [], [])
+
+    __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_FB_ALLOC_DUMP, (n_live + n_peak) * 8))
+    buff = struct.unpack("<%dI" % ((n_live + n_peak) * 2), __serial.read((n_live + n_peak) * 8))
+    tags = list(zip(buff[0::2], buff[1::2]))
+    return (peak, tags[:n_live], tags[n_live:])
+
+def timeline():
+    # Returns the cycle counter clock and the [(cycles, probe, phase, irq)] events, oldest first.
+    # Recording pauses during the transfer and restarts with an empty ring.
+    __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_TIMELINE_SIZE, 12))
+    n_events, record_size, clock = struct.unpack("III", __serial.read(12))
+    if (not n_events):
+        return (clock, [])
+
+    __serial.write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_TIMELINE_DUMP, n_events * record_size))
+    buff = __serial.read(n_events * record_size)
+    return (clock, [struct.unpack_from("<IBBH", buff, i * record_size) for i in range(n_events)])
+
+def timeline_to_chrome(clock, events):
+    # Converts timeline() events to a Chrome trace (chrome://tracing, Perfetto) JSON string.
+    # Cycle counts are unwrapped assuming less than one counter period between events.
+    trace = []
+    t = 0
+    last = events[0][0] if events else 0
+    for cycles, probe, phase, irq in events:
+        t += (cycles - last) & 0xFFFFFFFF
+        last = cycles
+        name = PROBE_NAMES[probe] if probe < len(PROBE_NAMES) else ("probe_%d" % probe)
+        event = {"name": name, "ph": "BEi"[phase], "ts": t * 1000000.0 / clock, "pid": 0,
+                 "tid": ("irq_%d" % irq) if irq else "main"}
+        if (phase == 2):
+            event["s"] = "g"
+        trace.append(event)
+    return json.dumps({"traceEvents": trace, "displayTimeUnit": "ms"})
+
 if __name__ == '__main__':
     if len(sys.argv)!= 3:
         print ('usage: pyopenmv.py <port> <script>')
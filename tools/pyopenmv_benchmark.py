@@ -0,0 +1,65 @@
+#!/usr/bin/env python
+# This file is part of the OpenMV project.
+#
+# Copyright (c) 2013-2023 Ibrahim Abdelkader <iabdalkader@openmv.io>
+# Copyright (c) 2013-2023 Kwabena W. Agyeman <kwagyeman@openmv.io>
+#
+# This work is licensed under the MIT license, see the file LICENSE for details.
+#
+# This script runs the on-device benchmarks and saves the results as JSON.
+# Copy scripts/unittest to the camera's storage first.
+
+import sys
+import json
+import argparse
+import pyopenmv
+from time import sleep, time
+
+DONE_MARKER = "All benchmarks done."
+
+def main():
+    # CMD args parser
+    parser = argparse.ArgumentParser(description='openmv benchmarks')
+    parser.add_argument("-p", "--port",    action = "store", default = "/dev/openmvcam", help = "OpenMV serial port")
+    parser.add_argument("-o", "--output",  action = "store", default = "benchmarks.json", help = "Output JSON file")
+    parser.add_argument("-t", "--timeout", action = "store", default = 600, help = "Max time to wait for the benchmarks (s)")
+    parser.add_argument("-s", "--script",  action = "store",\
+            default="../scripts/examples/50-OpenMV-Boards/99-Tests/benchmarks.py", help = "Benchmark runner script")
+
+    # Parse CMD args
+    args = parser.parse_args()
+
+    with open(args.script, "r") as f:
+        script = f.read()
+
+    pyopenmv.init(args.port, baudrate=921600, timeout=0.500)
+    pyopenmv.stop_script()
+    pyopenmv.enable_fb(False)
+    pyopenmv.exec_script(script)
+
+    output = ""
+    start = time()
+    while (DONE_MARKER not in output) and ((time() - start) < float(args.timeout)):
+        tx_len = pyopenmv.tx_buf_len()
+        if (tx_len):
+            output += pyopenmv.tx_buf(tx_len).decode()
+        else:
+            sleep(0.100)
+
+    pyopenmv.stop_script()
+    pyopenmv.disconnect()
+
+    results = [json.loads(line) for line in output.splitlines() if line.startswith("{")]
+    for r in results:
+        print("%-24s %-6s %-10s %-8s %10s ms %10s bytes" % (r["test"], r["resolution"], r["pixformat"],
+              r["status"], "%.2f" % r["ms"] if "ms" in r else "-", r.get("fb_alloc_peak", "-")))
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=2)
+
+    if DONE_MARKER not in output:
+        print("Timed out waiting for the benchmarks to finish.")
+        sys.exit(1)
+
+if __name__ == '__main__':
+    main()
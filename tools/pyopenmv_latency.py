@@ -0,0 +1,115 @@
+#!/usr/bin/env python
+# This file is part of the OpenMV project.
+#
+# Copyright (c) 2013-2023 Ibrahim Abdelkader <iabdalkader@openmv.io>
+# Copyright (c) 2013-2023 Kwabena W. Agyeman <kwagyeman@openmv.io>
+#
+# This work is licensed under the MIT license, see the file LICENSE for details.
+#
+# This script runs the glass-to-glass latency test and saves the samples and the latency
+# distributions as JSON. Settings of the test script can be overridden, e.g.:
+#
+#   python pyopenmv_latency.py -D FRAMESIZE='"VGA"' -D OUTPUT='"display"' -o vga_display.json
+#
+# All times are relative to the LED turning on:
+#   sof     - start of the first frame that shows the LED (negative if exposing already).
+#   eof     - end of that frame, it's in memory.
+#   detect  - the script found the LED in the frame.
+#   output  - the frame was sent to the output.
+
+import re
+import sys
+import json
+import argparse
+import pyopenmv
+from time import sleep, time
+
+DONE_MARKER = "All samples done."
+STAGES = ("sof", "eof", "detect", "output")
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(round((p / 100.0) * (len(values) - 1))))]
+
+def distribution(values):
+    return {
+        "count": len(values),
+        "min": min(values),
+        "mean": sum(values) / len(values),
+        "p50": percentile(values, 50),
+        "p90": percentile(values, 90),
+        "p99": percentile(values, 99),
+        "max": max(values),
+    }
+
+def main():
+    # CMD args parser
+    parser = argparse.ArgumentParser(description='openmv latency test')
+    parser.add_argument("-p", "--port",    action = "store", default = "/dev/openmvcam", help = "OpenMV serial port")
+    parser.add_argument("-o", "--output",  action = "store", default = "latency.json", help = "Output JSON file")
+    parser.add_argument("-t", "--timeout", action = "store", default = 600, help = "Max time to wait for the test (s)")
+    parser.add_argument("-D", "--define",  action = "append", default = [], help = "Override a script setting NAME=VALUE")
+    parser.add_argument("-s", "--script",  action = "store",\
+            default="../scripts/examples/50-OpenMV-Boards/99-Tests/latency.py", help = "Latency test script")
+
+    # Parse CMD args
+    args = parser.parse_args()
+
+    with open(args.script, "r") as f:
+        script = f.read()
+
+    for define in args.define:
+        name, value = define.split("=", 1)
+        script, n = re.subn(r"^%s = .*$" % re.escape(name), "%s = %s" % (name, value), script, flags=re.M)
+        if not n:
+            print("Unknown setting %s." % name)
+            sys.exit(1)
+
+    pyopenmv.init(args.port, baudrate=921600, timeout=0.500)
+    pyopenmv.stop_script()
+    # The IDE output is measured up to the frame buffer being ready, not read.
+    pyopenmv.enable_fb(True)
+    pyopenmv.exec_script(script)
+
+    output = ""
+    start = time()
+    while (DONE_MARKER not in output) and ((time() - start) < float(args.timeout)):
+        tx_len = pyopenmv.tx_buf_len()
+        if (tx_len):
+            output += pyopenmv.tx_buf(tx_len).decode()
+        else:
+            # Keep the frame buffer drained like the IDE would.
+            pyopenmv.fb_dump()
+            sleep(0.010)
+
+    pyopenmv.stop_script()
+    pyopenmv.disconnect()
+
+    samples = [json.loads(line) for line in output.splitlines() if line.startswith("{")]
+    ok = [s for s in samples if s["status"] == "OK"]
+
+    summary = {}
+    if samples:
+        summary = {k: samples[0][k] for k in ("board", "firmware", "framesize", "pixformat", "output")}
+    summary["timeouts"] = len(samples) - len(ok)
+
+    if ok:
+        summary["frames"] = distribution([s["frames"] for s in ok])
+        print("%-8s %8s %10s %10s %10s %10s %10s %10s" % ("stage", "count", "min", "mean", "p50", "p90", "p99", "max"))
+        for stage in STAGES:
+            d = distribution([s[stage + "_us"] / 1000.0 for s in ok])
+            summary[stage + "_ms"] = d
+            print("%-8s %8d %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f" % (stage, d["count"], d["min"], d["mean"],
+                  d["p50"], d["p90"], d["p99"], d["max"]))
+
+    print("%d samples, %d timeouts" % (len(samples), summary["timeouts"]))
+
+    with open(args.output, "w") as f:
+        json.dump({"summary": summary, "samples": samples}, f, indent=2)
+
+    if DONE_MARKER not in output:
+        print("Timed out waiting for the latency test to finish.")
+        sys.exit(1)
+
+if __name__ == '__main__':
+    main()
@@ -12,13 +12,23 @@ import struct
 import sys,time
 import serial
 import platform
+import threading
 import numpy as np
 from PIL import Image
+try:
+    import queue
+except ImportError:
+    import Queue as queue
 
 __serial = []
 __port = []
+__fb_stream_credit = {}
+__fb_stream_threads = []
+__fb_stream_queue = None
+__fb_stream_stop = threading.Event()
 
 __FB_HDR_SIZE   =12
+__FB_STREAM_HDR_SIZE=16
 
 # USB Debug commands
 __USBDBG_CMD            = 48
@@ -26,6 +36,7 @@ __USBDBG_FW_VERSION     = 0x80
 __USBDBG_FRAME_SIZE     = 0x81
 __USBDBG_FRAME_DUMP     = 0x82
 __USBDBG_ARCH_STR       = 0x83
+__USBDBG_FRAME_STREAM   = 0x97
 __USBDBG_SCRIPT_EXEC    = 0x05
 __USBDBG_SCRIPT_STOP    = 0x06
 __USBDBG_SCRIPT_SAVE    = 0x07
@@ -102,30 +113,150 @@ def fb_dump(port):
         # read fb data
         __serial[idx].write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_FRAME_DUMP, num_bytes))
         buff = __serial[idx].read(num_bytes)
+        return __fb_decode(size, buff)
+    except:
+        return None
 
-        if size[2] == 1:  # Grayscale
-            y = np.fromstring(buff, dtype=np.uint8)
-            buff = np.column_stack((y, y, y))
-        elif size[2] == 2: # RGB565
-            arr = np.fromstring(buff, dtype=np.uint16).newbyteorder('S')
-            r = (((arr & 0xF800) >>11)*255.0/31.0).astype(np.uint8)
-            g = (((arr & 0x07E0) >>5) *255.0/63.0).astype(np.uint8)
-            b = (((arr & 0x001F) >>0) *255.0/31.0).astype(np.uint8)
-            buff = np.column_stack((r,g,b))
-        else: # JPEG
-            try:
-                buff = np.asarray(Image.frombuffer("RGB", size[0:2], buff, "jpeg", "RGB", ""))
-            except Exception as e:
-                print ("JPEG decode error (%s)"%(e))
-                return None
-
-        if (buff.size != (size[0]*size[1]*3)):
-            return None
+def __fb_stream_read(port):
+    # Reads a raw frame with USBDBG_FRAME_STREAM, returns (w, h, bpp, buff, seq) or None.
+    idx = __port.index(port)
+    credit = __fb_stream_credit.get(port, __FB_STREAM_HDR_SIZE)
+    __serial[idx].write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_FRAME_STREAM, credit))
+    buff = __serial[idx].read(credit)
+    seq, w, h, bpp = struct.unpack_from("<IIII", buff)
+
+    if (not w):
+        # frame not ready, only ask for the header until it is.
+        __fb_stream_credit[port] = __FB_STREAM_HDR_SIZE
+        return None
 
-        return (size[0], size[1], buff.reshape((size[1], size[0], 3)))
+    num_bytes = bpp if (bpp > 2) else (w*h*bpp)
+    buff = buff[__FB_STREAM_HDR_SIZE:__FB_STREAM_HDR_SIZE+num_bytes]
+    if (len(buff) < num_bytes):
+        __serial[idx].write(struct.pack("<BBI", __USBDBG_CMD, __USBDBG_FRAME_DUMP, num_bytes - len(buff)))
+        buff += __serial[idx].read(num_bytes - len(buff))
+
+    # Leave room for the next frame to grow a little.
+    __fb_stream_credit[port] = __FB_STREAM_HDR_SIZE + num_bytes + (num_bytes // 8)
+    return (w, h, bpp, buff, seq)
+
+def fb_stream(port):
+    # Like fb_dump() but reads the header and the frame with a single command, see pyopenmv.py.
+    # Returns (w, h, buff, seq), seq is the capture sequence number of the frame. Cameras that
+    # are synchronized with sensor.set_trigger() number frames by frame sync pulse.
+    try:
+        raw = __fb_stream_read(port)
+        if (not raw):
+            return None
+        frame = __fb_decode(raw[0:3], raw[3])
+        return (frame + (raw[4],)) if frame else None
     except:
         return None
 
+def __fb_stream_put(q, item):
+    # Blocks while the queue is full (so nothing is dropped) unless streaming is stopped.
+    while (not __fb_stream_stop.is_set()):
+        try:
+            q.put(item, timeout=0.1)
+            return True
+        except queue.Full:
+            pass
+    return False
+
+def __fb_stream_reader(port, raw_queue):
+    while (not __fb_stream_stop.is_set()):
+        try:
+            raw = __fb_stream_read(port)
+        except Exception:
+            raw = None
+        if (raw is None):
+            time.sleep(0.001)
+        elif (not __fb_stream_put(raw_queue, raw + (time.time(),))):
+            break
+    __fb_stream_put(raw_queue, None)
+
+def __fb_stream_decoder(port, raw_queue):
+    while (not __fb_stream_stop.is_set()):
+        try:
+            raw = raw_queue.get(timeout=0.1)
+        except queue.Empty:
+            continue
+        if (raw is None):
+            break
+        # PIL and numpy release the GIL, frames decode while the readers wait on USB.
+        frame = __fb_decode(raw[0:3], raw[3])
+        if (frame and not __fb_stream_put(__fb_stream_queue, (port,) + frame + raw[4:6])):
+            break
+
+def fb_stream_start(ports, queue_size=8):
+    # Streams frames from all ports in the background. Each port has a reader thread that
+    # requests the next frame as soon as the last one is read and a decoder thread, so the
+    # cameras are read in parallel and decoding doesn't hold up USB. Frames are read with
+    # fb_stream_get(), no other commands may be sent to the ports until fb_stream_stop().
+    global __fb_stream_queue
+    fb_stream_stop()
+    __fb_stream_stop.clear()
+    __fb_stream_queue = queue.Queue(queue_size * len(ports))
+    for port in ports:
+        raw_queue = queue.Queue(queue_size)
+        for target in (__fb_stream_reader, __fb_stream_decoder):
+            thread = threading.Thread(target=target, args=(port, raw_queue))
+            thread.daemon = True
+            thread.start()
+            __fb_stream_threads.append(thread)
+
+def fb_stream_get(timeout=None):
+    # Returns the next (port, w, h, buff, seq, timestamp) frame, timestamp is the host time
+    # the frame was read at, or None on timeout. Frames of one port are returned in order.
+    try:
+        return __fb_stream_queue.get(timeout=timeout)
+    except (queue.Empty, AttributeError):
+        return None
+
+def fb_stream_stop():
+    __fb_stream_stop.set()
+    while (__fb_stream_threads):
+        __fb_stream_threads.pop().join()
+
+def fb_sync(ports, timeout=1.0):
+    # Reads frames from all ports until they are all of the same frame sync pulse. Returns a
+    # dict of port -> (w, h, buff, seq), or None if no matched set is read within timeout.
+    frames = {}
+    deadline = time.time() + timeout
+    while (time.time() < deadline):
+        for port in ports:
+            # Only the ports behind the newest frame read on are read again.
+            newest = max([f[3] for f in frames.values()] or [0])
+            if (port not in frames) or (frames[port][3] < newest):
+                frame = fb_stream(port)
+                if frame:
+                    frames[port] = frame
+        if (len(frames) == len(ports)) and (len(set(f[3] for f in frames.values())) == 1):
+            return frames
+    return None
+
+def __fb_decode(size, buff):
+    if size[2] == 1:  # Grayscale
+        y = np.fromstring(buff, dtype=np.uint8)
+        buff = np.column_stack((y, y, y))
+    elif size[2] == 2: # RGB565
+        arr = np.fromstring(buff, dtype=np.uint16).newbyteorder('S')
+        r = (((arr & 0xF800) >>11)*255.0/31.0).astype(np.uint8)
+        g = (((arr & 0x07E0) >>5) *255.0/63.0).astype(np.uint8)
+        b = (((arr & 0x001F) >>0) *255.0/31.0).astype(np.uint8)
+        buff = np.column_stack((r,g,b))
+    else: # JPEG
+        try:
+            buff = np.asarray(Image.frombuffer("RGB", size[0:2], buff, "jpeg", "RGB", ""))
+        except Exception as e:
+            print ("JPEG decode error (%s)"%(e))
+            return None
+
+    if (buff.size != (size[0]*size[1]*3)):
+        return None
+
+    return (size[0], size[1], buff.reshape((size[1], size[0], 3)))
+
 def exec_script(port, buf):
     try:
         idx = __port.index(port)
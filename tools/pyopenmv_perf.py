@@ -0,0 +1,129 @@
+#!/usr/bin/env python
+# This file is part of the OpenMV project.
+#
+# Copyright (c) 2013-2023 Ibrahim Abdelkader <iabdalkader@openmv.io>
+# Copyright (c) 2013-2023 Kwabena W. Agyeman <kwagyeman@openmv.io>
+#
+# This work is licensed under the MIT license, see the file LICENSE for details.
+#
+# This script runs the on-device performance regression suite, saves the results as JSON
+# and compares them to the board's baseline in the baselines dir (<board>.json). It exits
+# with an error if a stage got slower, or a memory peak grew, by more than the tolerance.
+# Copy scripts/unittest and the recorded datasets to the camera's storage first. Use -u
+# to save the results as the new baseline.
+
+import os
+import sys
+import json
+import argparse
+import pyopenmv
+from time import sleep, time
+
+DONE_MARKER = "All pipelines done."
+
+def compare(name, value, base, tolerance, slack):
+    # Returns an error string if value regressed past base.
+    limit = base * (1.0 + tolerance / 100.0) + slack
+    if value > limit:
+        return "%s: %.2f > %.2f (baseline %.2f)" % (name, value, limit, base)
+    return None
+
+def check(result, baseline, args):
+    errors = []
+    base = baseline.get(result["test"])
+    if base is None or base["status"] != "PASSED":
+        return errors
+    if result["status"] != "PASSED":
+        return ["status %s: %s" % (result["status"], result.get("error", ""))]
+    for stage, (mean, _, _) in base["stages"].items():
+        if stage not in result["stages"]:
+            errors.append("%s: missing stage" % stage)
+            continue
+        errors.append(compare(stage + " ms", result["stages"][stage][0], mean, args.tolerance, args.slack_ms))
+    errors.append(compare("total ms", result["ms"], base["ms"], args.tolerance, args.slack_ms))
+    for peak in ("fb_alloc_peak", "heap_peak"):
+        errors.append(compare(peak, result[peak], base[peak], args.mem_tolerance, 0))
+    return [e for e in errors if e]
+
+def main():
+    # CMD args parser
+    parser = argparse.ArgumentParser(description='openmv performance regression suite')
+    parser.add_argument("-p", "--port",      action = "store", default = "/dev/openmvcam", help = "OpenMV serial port")
+    parser.add_argument("-o", "--output",    action = "store", default = "perf.json", help = "Output JSON file")
+    parser.add_argument("-b", "--baselines", action = "store", default = "perf_baselines", help = "Per-board baselines dir")
+    parser.add_argument("-u", "--update",    action = "store_true", help = "Save the results as the baseline")
+    parser.add_argument("-T", "--tolerance", action = "store", type = float, default = 10.0, help = "Time tolerance (%%)")
+    parser.add_argument("-m", "--mem-tolerance", action = "store", type = float, default = 0.0, help = "Memory tolerance (%%)")
+    parser.add_argument("-S", "--slack-ms",  action = "store", type = float, default = 0.1, help = "Absolute time slack (ms)")
+    parser.add_argument("-t", "--timeout",   action = "store", default = 1800, help = "Max time to wait for the suite (s)")
+    parser.add_argument("-s", "--script",    action = "store",\
+            default="../scripts/examples/50-OpenMV-Boards/99-Tests/perf.py", help = "Perf suite runner script")
+
+    # Parse CMD args
+    args = parser.parse_args()
+
+    with open(args.script, "r") as f:
+        script = f.read()
+
+    pyopenmv.init(args.port, baudrate=921600, timeout=0.500)
+    pyopenmv.stop_script()
+    # Streaming pipelines flush frames, drain them like the IDE would.
+    pyopenmv.enable_fb(True)
+    pyopenmv.exec_script(script)
+
+    output = ""
+    start = time()
+    while (DONE_MARKER not in output) and ((time() - start) < float(args.timeout)):
+        tx_len = pyopenmv.tx_buf_len()
+        if (tx_len):
+            output += pyopenmv.tx_buf(tx_len).decode()
+        else:
+            pyopenmv.fb_dump()
+            sleep(0.010)
+
+    pyopenmv.stop_script()
+    pyopenmv.disconnect()
+
+    results = [json.loads(line) for line in output.splitlines() if line.startswith("{")]
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=2)
+
+    if DONE_MARKER not in output:
+        print("Timed out waiting for the perf suite to finish.")
+        sys.exit(1)
+
+    if not results:
+        print("No results.")
+        sys.exit(1)
+
+    path = os.path.join(args.baselines, results[0]["board"] + ".json")
+    if args.update:
+        os.makedirs(args.baselines, exist_ok=True)
+        with open(path, "w") as f:
+            json.dump({r["test"]: r for r in results}, f, indent=2)
+        print("Saved baseline %s." % path)
+
+    baseline = {}
+    if os.path.exists(path):
+        with open(path, "r") as f:
+            baseline = json.load(f)
+    else:
+        print("No baseline %s, nothing to compare." % path)
+
+    failed = 0
+    for r in results:
+        errors = check(r, baseline, args)
+        failed += bool(errors)
+        print("%-24s %-8s %10s ms %10s bytes %10s bytes %s" % (r["test"], r["status"],
+              "%.2f" % r["ms"] if "ms" in r else "-", r.get("fb_alloc_peak", "-"), r.get("heap_peak", "-"),
+              "REGRESSED" if errors else ""))
+        for e in errors:
+            print("    " + e)
+
+    if failed:
+        print("%d pipelines regressed." % failed)
+        sys.exit(1)
+
+if __name__ == '__main__':
+    main()